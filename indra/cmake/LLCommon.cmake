@@ -6,3 +6,10 @@ include(EXPAT)
 include(Tracy)
 include(xxHash)
 include(ZLIBNG)
+
+# <FS> Compile out the non-essential LLTrace stats, see indra/llcommon/lltrace.h
+option(LL_TRACE_ESSENTIAL_ONLY "Record only the essential LLTrace stats, without block timers." OFF)
+if (LL_TRACE_ESSENTIAL_ONLY)
+  add_compile_definitions(LL_TRACE_ESSENTIAL_ONLY=1)
+endif ()
+# </FS>
@@ -926,6 +926,7 @@ LLVector4a *LLPolyMesh::getWritableCoords()
 //-----------------------------------------------------------------------------
 LLVector4a *LLPolyMesh::getWritableNormals()
 {
+        updateNormals(); // <FS/> Deferred morph normals
         return mNormals;
 }
 
@@ -934,6 +935,7 @@ LLVector4a *LLPolyMesh::getWritableNormals()
 //-----------------------------------------------------------------------------
 LLVector4a *LLPolyMesh::getWritableBinormals()
 {
+        updateNormals(); // <FS/> Deferred morph normals
         return mBinormals;
 }
 
@@ -987,7 +989,42 @@ void LLPolyMesh::initializeForMorph()
     {
         mClothingWeights[i].clear();
     }
+
+    // <FS> Deferred morph normals, back to the base normals
+    mDirtyNormals.clear();
+    mNormalIsDirty.clear();
+    // </FS>
+}
+
+// <FS> Deferred morph normals
+void LLPolyMesh::dirtyNormal(U32 vert)
+{
+    llassert(!isLOD());
+    if (mNormalIsDirty.empty())
+    {
+        mNormalIsDirty.resize(mSharedData->mNumVertices, 0);
+    }
+
+    llassert(vert < mNormalIsDirty.size());
+    if (!mNormalIsDirty[vert])
+    {
+        mNormalIsDirty[vert] = 1;
+        mDirtyNormals.push_back(vert);
+    }
+}
+
+void LLPolyMesh::flushNormals() const
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    for (U32 vert : mDirtyNormals)
+    {
+        computeNormal(mNormals[vert], mBinormals[vert], mScaledNormals[vert], mScaledBinormals[vert]);
+        mNormalIsDirty[vert] = 0;
+    }
+    mDirtyNormals.clear();
 }
+// </FS>
 
 //-----------------------------------------------------------------------------
 // getMorphData()
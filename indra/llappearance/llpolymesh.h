@@ -29,6 +29,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include "llstl.h"
 
 #include "v3math.h"
@@ -225,11 +226,13 @@ public:
 
     // Get normals
     const LLVector4a    *getNormals() const{
+        updateNormals(); // <FS/> Deferred morph normals
         return mNormals;
     }
 
     // Get normals
     const LLVector4a    *getBinormals() const{
+        updateNormals(); // <FS/> Deferred morph normals
         return mBinormals;
     }
 
@@ -252,6 +255,36 @@ public:
     LLVector4a *getWritableBinormals();
     LLVector4a *getScaledBinormals();
 
+    // <FS> Deferred morph normals
+    // Morph targets that change the scaled normals of a vertex only mark it,
+    // its output normal and binormal are computed once from the final scaled
+    // ones when they are next read, rather than again for every morph.
+    void dirtyNormal(U32 vert);
+
+    // Bring the output normals and binormals of the marked vertices up to date
+    void updateNormals() const
+    {
+        const LLPolyMesh* owner = (mReferenceMesh && mSharedData->isLOD()) ? mReferenceMesh : this;
+        if (!owner->mDirtyNormals.empty())
+        {
+            owner->flushNormals();
+        }
+    }
+
+    // normal and binormal from the morphed ones, as LLPolyMorphTarget::apply() always did
+    static void computeNormal(LLVector4a& normal, LLVector4a& binormal, const LLVector4a& scaled_normal, const LLVector4a& scaled_binormal)
+    {
+        LLVector4a norm = scaled_normal;
+        norm.normalize3fast();
+        normal = norm;
+
+        LLVector4a tangent;
+        tangent.setCross3(scaled_binormal, norm);
+        binormal.setCross3(norm, tangent);
+        binormal.normalize3fast();
+    }
+    // </FS>
+
     // Get texCoords
     const LLVector2 *getTexCoords() const {
         return mTexCoords;
@@ -356,6 +389,13 @@ protected:
 
     LLPolyMesh              *mReferenceMesh;
 
+    // <FS> Deferred morph normals
+    void flushNormals() const;
+
+    mutable std::vector<U32>    mDirtyNormals;      // vertices
+    mutable std::vector<U8>     mNormalIsDirty;     // per vertex
+    // </FS>
+
     // global mesh list
     typedef std::map<std::string, LLPolyMeshSharedData*> LLPolyMeshSharedDataTable;
     static LLPolyMeshSharedDataTable sGlobalSharedMeshList;
@@ -41,6 +41,8 @@
 
 const F32 NORMAL_SOFTEN_FACTOR = 0.65f;
 
+bool LLPolyMorphTarget::sDeferNormals = true; // <FS/> Deferred morph normals
+
 //-----------------------------------------------------------------------------
 // LLPolyMorphData()
 //-----------------------------------------------------------------------------
@@ -567,7 +569,16 @@ void LLPolyMorphTarget::apply( ESex avatar_sex )
     // store last weight
     mLastWeight += delta_weight;
 
-    if (delta_weight != 0.f)
+    // <FS> Deferred morph normals
+    //if (delta_weight != 0.f)
+    if (delta_weight != 0.f && sDeferNormals)
+    {
+        llassert(!mMesh->isLOD());
+        applyDeferred(delta_weight);
+        applyVolumeChanges(delta_weight);
+    }
+    else if (delta_weight != 0.f)
+    // </FS>
     {
         llassert(!mMesh->isLOD());
         LLVector4a *coords = mMesh->getWritableCoords();
@@ -658,6 +669,74 @@ void LLPolyMorphTarget::apply( ESex avatar_sex )
     }
 }
 
+// <FS> Deferred morph normals
+void LLPolyMorphTarget::applyDeferred(F32 delta_weight)
+{
+    LLVector4a* coords = mMesh->getWritableCoords();
+    LLVector4a* scaled_normals = mMesh->getScaledNormals();
+    LLVector4a* scaled_binormals = mMesh->getScaledBinormals();
+    LLVector4a* clothing_weights = getInfo()->mIsClothingMorph ? mMesh->getWritableClothingWeights() : NULL;
+    LLVector2* tex_coords = mMesh->getWritableTexCoords();
+
+    const F32* mask_weights = mVertMask ? mVertMask->getMorphMaskWeights() : NULL;
+
+    LLVector4a one_x;
+    one_x.set(1.f, 0.f, 0.f, 1.f);
+
+    for (U32 vert_index_morph = 0; vert_index_morph < mMorphData->mNumIndices; vert_index_morph++)
+    {
+        const S32 vert_index_mesh = mMorphData->mVertexIndices[vert_index_morph];
+        const F32 mask_weight = mask_weights ? mask_weights[vert_index_morph] : 1.f;
+        const F32 weight = delta_weight * mask_weight;
+
+        if (clothing_weights)
+        {
+            clothing_weights[vert_index_mesh].getF32ptr()[VW] = mask_weight;
+        }
+
+        // the output normals still follow whatever applyMask() took away
+        mMesh->dirtyNormal(vert_index_mesh);
+
+        if (weight == 0.f)
+        { // masked out, nothing moves
+            continue;
+        }
+
+        LLVector4a w;
+        w.splat(weight);
+
+        LLVector4a offset;
+        offset.setMul(mMorphData->mCoords[vert_index_morph], w);
+        coords[vert_index_mesh].add(offset);
+
+        if (clothing_weights)
+        { // xyz only, w holds the mask weight
+            const F32 mask_w = clothing_weights[vert_index_mesh].getF32ptr()[VW];
+            clothing_weights[vert_index_mesh].add(offset);
+            clothing_weights[vert_index_mesh].getF32ptr()[VW] = mask_w;
+        }
+
+        LLVector4a soft_w;
+        soft_w.splat(weight * NORMAL_SOFTEN_FACTOR);
+
+        LLVector4a norm;
+        norm.setMul(mMorphData->mNormals[vert_index_morph], soft_w);
+        scaled_normals[vert_index_mesh].add(norm);
+
+        // guard against degenerate input data before we create NaNs in LLPolyMesh::computeNormal()
+        LLVector4a binorm = mMorphData->mBinormals[vert_index_morph];
+        if (!binorm.isFinite3() || (binorm.dot3(binorm).getF32() <= F_APPROXIMATELY_ZERO))
+        {
+            binorm = one_x;
+        }
+        binorm.mul(soft_w);
+        scaled_binormals[vert_index_mesh].add(binorm);
+
+        tex_coords[vert_index_mesh] += mMorphData->mTexCoords[vert_index_morph] * delta_weight * mask_weight;
+    }
+}
+// </FS>
+
 //-----------------------------------------------------------------------------
 // applyMask()
 //-----------------------------------------------------------------------------
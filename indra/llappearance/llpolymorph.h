@@ -175,9 +175,17 @@ public:
 
     void    applyVolumeChanges(F32 delta_weight); // SL-315 - for resetSkeleton()
 
+    // <FS> Deferred morph normals
+    // When set, apply() leaves the output normals of the vertices it moves
+    // to LLPolyMesh::updateNormals() and skips the vertices its mask rules out
+    static bool sDeferNormals;
+    // </FS>
+
 protected:
     LLPolyMorphTarget(const LLPolyMorphTarget& pOther);
 
+    void    applyDeferred(F32 delta_weight); // <FS/> Deferred morph normals
+
     LLPolyMorphData*                mMorphData;
     LLPolyMesh*                     mMesh;
     LLPolyVertexMask *              mVertMask;
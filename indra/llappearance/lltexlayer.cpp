@@ -975,6 +975,7 @@ LLTexLayer::~LLTexLayer()
         ll_aligned_free_32(alpha_data);
     }
 
+    releaseMorphReadback(); // <FS/> Async morph mask readback
 }
 
 void LLTexLayer::asLLSD(LLSD& sd) const
@@ -1080,7 +1081,10 @@ bool LLTexLayer::render(S32 x, S32 y, S32 width, S32 height, LLRenderTarget* bou
         }//*/
 
         const bool force_render = true;
-        renderMorphMasks(x, y, width, height, net_color, bound_target, force_render);
+        // <FS> Async morph mask readback
+        //renderMorphMasks(x, y, width, height, net_color, bound_target, force_render);
+        renderMorphMasks(x, y, width, height, net_color, bound_target, force_render, sAsyncMorphReadback);
+        // </FS>
         alpha_mask_specified = true;
         gGL.flush();
         gGL.blendFunc(LLRender::BF_DEST_ALPHA, LLRender::BF_ONE_MINUS_DEST_ALPHA);
@@ -1296,7 +1300,10 @@ bool LLTexLayer::blendAlphaTexture(S32 x, S32 y, S32 width, S32 height)
     addAlphaMask(data, originX, originY, width, height, bound_target);
 }
 
-void LLTexLayer::renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, LLRenderTarget* bound_target, bool force_render)
+// <FS> Async morph mask readback
+//void LLTexLayer::renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, LLRenderTarget* bound_target, bool force_render)
+void LLTexLayer::renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, LLRenderTarget* bound_target, bool force_render, bool async)
+// </FS>
 {
     if (!force_render && !hasMorph())
     {
@@ -1406,6 +1413,16 @@ void LLTexLayer::renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLC
         }
 
         U32 cache_index = alpha_mask_crc.getCRC();
+
+        // <FS> Async morph mask readback
+        // the Intel work-around reads the whole texture back, it stays synchronous
+        if (async && !gGLManager.mIsIntel && !LLRender::sNsightDebugSupport)
+        {
+            startMorphReadback(cache_index, x, y, width, height);
+            return;
+        }
+        // </FS>
+
         U8* alpha_data = NULL;
                 // We believe we need to generate morph masks, do not assume that the cached version is accurate.
                 // We can get bad morph masks during login, on minimize, and occasional gl errors.
@@ -1552,6 +1569,149 @@ void LLTexLayer::renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLC
     }
 }
 
+// <FS> Async morph mask readback
+bool LLTexLayer::sAsyncMorphReadback = true;
+std::set<LLTexLayer*> LLTexLayer::sReadbackLayers;
+
+void LLTexLayer::startMorphReadback(U32 cache_index, S32 x, S32 y, S32 width, S32 height)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    // only the latest masks matter, an older readback still in flight is dropped
+    if (mReadback.mFence)
+    {
+        glDeleteSync(mReadback.mFence);
+        mReadback.mFence = nullptr;
+    }
+
+    // We just want GL_ALPHA, but that isn't supported in OGL core profile 4.
+    const U32 size = (U32)(width * height * 4);
+    if (!mReadback.mBuffer)
+    {
+        glGenBuffers(1, &mReadback.mBuffer);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, mReadback.mBuffer);
+    if (size > mReadback.mBufferSize)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        mReadback.mBufferSize = size;
+    }
+    glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    mReadback.mFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    mReadback.mCacheIndex = cache_index;
+    mReadback.mWidth = width;
+    mReadback.mHeight = height;
+
+    sReadbackLayers.insert(this);
+}
+
+void LLTexLayer::finishMorphReadback()
+{
+    if (!mReadback.mFence)
+    {
+        return;
+    }
+
+    const GLenum status = glClientWaitSync(mReadback.mFence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED;
+
+    glDeleteSync(mReadback.mFence);
+    mReadback.mFence = nullptr;
+
+    const S32 width = mReadback.mWidth;
+    const S32 height = mReadback.mHeight;
+    const size_t pixels = (size_t)width * height;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, mReadback.mBuffer);
+    const U8* temp_data = (const U8*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, pixels * 4, GL_MAP_READ_BIT);
+    if (!temp_data)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        LL_WARNS() << "Could not map the morph mask readback of " << getName() << LL_ENDL;
+        return;
+    }
+
+    alpha_cache_t::iterator cached = mAlphaCache.find(mReadback.mCacheIndex);
+    if (cached != mAlphaCache.end())
+    {
+        ll_aligned_free_32(cached->second);
+        mAlphaCache.erase(cached);
+    }
+
+    U8* alpha_data = allocateAlphaCacheEntry(width, height);
+    for (size_t pixel = 0; pixel < pixels; pixel++)
+    {
+        alpha_data[pixel] = temp_data[(pixel * 4) + 3];
+    }
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    mAlphaCache[mReadback.mCacheIndex] = alpha_data;
+
+    getTexLayerSet()->getAvatarAppearance()->dirtyMesh();
+
+    mMorphMasksValid = true;
+    getTexLayerSet()->applyMorphMask(alpha_data, width, height, 1);
+}
+
+U8* LLTexLayer::allocateAlphaCacheEntry(S32 width, S32 height)
+{
+    // clear out a slot if we have filled our cache
+    S32 max_cache_entries = getTexLayerSet()->getAvatarAppearance()->isSelf() ? 4 : 1;
+    while ((S32)mAlphaCache.size() >= max_cache_entries)
+    {
+        alpha_cache_t::iterator iter = mAlphaCache.begin(); // arbitrarily grab the first entry
+        ll_aligned_free_32(iter->second);
+        mAlphaCache.erase(iter);
+    }
+
+    size_t row_size = (width + 3) & ~0x3; // OpenGL 4-byte row align (even for things < 4 bpp...)
+    return (U8*)ll_aligned_malloc_32(row_size * height);
+}
+
+void LLTexLayer::releaseMorphReadback()
+{
+    sReadbackLayers.erase(this);
+
+    if (mReadback.mFence)
+    {
+        glDeleteSync(mReadback.mFence);
+    }
+    if (mReadback.mBuffer)
+    {
+        glDeleteBuffers(1, &mReadback.mBuffer);
+    }
+    mReadback = MorphReadback();
+}
+
+// static
+void LLTexLayer::updateMorphReadbacks()
+{
+    for (LLTexLayer* layer : sReadbackLayers)
+    {
+        layer->finishMorphReadback();
+    }
+}
+
+// static
+void LLTexLayer::cancelMorphReadbacks()
+{
+    while (!sReadbackLayers.empty())
+    {
+        (*sReadbackLayers.begin())->releaseMorphReadback();
+    }
+}
+// </FS>
+
 void LLTexLayer::addAlphaMask(U8 *data, S32 originX, S32 originY, S32 width, S32 height, LLRenderTarget* bound_target)
 {
     LL_PROFILE_ZONE_SCOPED;
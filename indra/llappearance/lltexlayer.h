@@ -28,6 +28,7 @@
 #define LL_LLTEXLAYER_H
 
 #include <deque>
+#include <set> // <FS/> Async morph mask readback
 #include "llglslshader.h"
 #include "llgltexture.h"
 #include "llavatarappearancedefines.h"
@@ -160,7 +161,10 @@ public:
     bool                    findNetColor(LLColor4* color) const;
     /*virtual*/ bool        blendAlphaTexture(S32 x, S32 y, S32 width, S32 height); // Multiplies a single alpha texture against the frame buffer
     /*virtual*/ void        gatherAlphaMasks(U8 *data, S32 originX, S32 originY, S32 width, S32 height, LLRenderTarget* bound_target);
-    void                    renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, LLRenderTarget* bound_target, bool force_render);
+    // <FS> Async morph mask readback
+    //void                    renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, LLRenderTarget* bound_target, bool force_render);
+    void                    renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, LLRenderTarget* bound_target, bool force_render, bool async = false);
+    // </FS>
     void                    addAlphaMask(U8 *data, S32 originX, S32 originY, S32 width, S32 height, LLRenderTarget* bound_target);
     /*virtual*/ bool        isInvisibleAlphaMask() const;
 
@@ -170,11 +174,46 @@ public:
     /*virtual*/ void        asLLSD(LLSD& sd) const;
 
     static void             calculateTexLayerColor(const param_color_list_t &param_list, LLColor4 &net_color);
+
+    // <FS> Async morph mask readback
+    // When set, the morph masks rendered with the composite are read back
+    // through a pixel buffer and applied a frame or more later, once the GPU
+    // is done with them, instead of stalling the frame on glReadPixels.
+    static bool             sAsyncMorphReadback;
+
+    // Threads:  Tmain
+    // Apply the morph masks whose readback has landed, once per frame
+    static void             updateMorphReadbacks();
+
+    // Drop the readbacks in flight and their buffers, before the GL context goes
+    static void             cancelMorphReadbacks();
+    // </FS>
 protected:
     LLUUID                  getUUID() const;
     typedef std::map<U32, U8*> alpha_cache_t;
     alpha_cache_t           mAlphaCache;
     LLLocalTextureObject*   mLocalTextureObject;
+
+    // <FS> Async morph mask readback
+private:
+    struct MorphReadback
+    {
+        U32     mCacheIndex = 0;
+        U32     mBuffer = 0;    // GL_PIXEL_PACK_BUFFER, kept for the next readback
+        U32     mBufferSize = 0;
+        GLsync  mFence = nullptr;   // null when nothing is in flight
+        S32     mWidth = 0;
+        S32     mHeight = 0;
+    };
+
+    void                    startMorphReadback(U32 cache_index, S32 x, S32 y, S32 width, S32 height);
+    void                    finishMorphReadback();
+    void                    releaseMorphReadback();
+    U8*                     allocateAlphaCacheEntry(S32 width, S32 height);
+
+    MorphReadback           mReadback;
+    static std::set<LLTexLayer*> sReadbackLayers;   // with a readback buffer
+    // </FS>
 };
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -44,6 +44,7 @@
 #include "vorbis/vorbisfile.h"
 #include <iterator>
 #include <deque>
+#include <algorithm> // <FS/> Decode priority
 
 extern LLAudioEngine *gAudiop;
 
@@ -80,6 +81,8 @@ public:
     bool isValid() const                { return mValid; }
     bool isDone() const                 { return mDone; }
     const LLUUID &getUUID() const       { return mUUID; }
+    // <FS/> Decoded sound cache: hands over the decoded WAV image once finished
+    std::vector<U8>&& takeWAVBuffer()   { return std::move(mWAVBuffer); }
 
 protected:
     virtual ~LLVorbisDecodeState();
@@ -595,6 +598,25 @@ void LLAudioDecodeMgr::Impl::startMoreDecodes()
     // -Cosmic,2022-05-11
     const size_t max_decodes = general_thread_pool->getWidth() * 2;
 
+    // <FS> Decode priority
+    // Start with the sounds of the sources closest to the listener, sounds
+    // nothing is playing yet keep their order behind them
+    if (mDecodeQueue.size() > 1 && mDecodes.size() < max_decodes)
+    {
+        std::map<LLUUID, F32> priorities;
+        gAudiop->getSoundPriorities(priorities);
+        auto priority_of = [&priorities](const LLUUID& id)
+        {
+            auto it = priorities.find(id);
+            return it != priorities.end() ? it->second : 0.f;
+        };
+        std::stable_sort(mDecodeQueue.begin(), mDecodeQueue.end(), [&priority_of](const LLUUID& a, const LLUUID& b)
+        {
+            return priority_of(a) > priority_of(b);
+        });
+    }
+    // </FS>
+
     while (!mDecodeQueue.empty() && mDecodes.size() < max_decodes)
     {
         const LLUUID decode_id = mDecodeQueue.front();
@@ -767,6 +789,8 @@ bool tryFinishAudio(const LLUUID &decode_id, LLPointer<LLVorbisDecodeState> deco
     if (valid)
     {
         adp->setHasWAVLoadFailed(false);
+        // <FS/> Decoded sound cache: the disk write is done, keep the result in memory for the first load
+        gAudiop->cacheDecodedWAV(decode_id, decode_state->takeWAVBuffer());
     }
 
     return true;
@@ -37,6 +37,8 @@
 
 #include "llfilesystem.h"
 #include "lldir.h"
+#include "llfile.h" // <FS/> Decoded sound cache
+#include "llmemory.h" // <FS/> Memory accounting
 #include "llaudiodecodemgr.h"
 #include "llassetstorage.h"
 
@@ -46,6 +48,11 @@ extern void request_sound(const LLUUID &sound_guid);
 
 LLAudioEngine* gAudiop = NULL;
 
+// <FS> Decoded sound cache
+// Until the viewer sets its own, enough for a few dozen short sounds
+static const size_t DEFAULT_DECODED_CACHE_LIMIT = 32 * 1024 * 1024;
+// </FS>
+
 // NaCl - Sound explorer
 S32 LLAudioSource::sSoundHistoryPruneCounter;
 // NaCl End
@@ -107,6 +114,13 @@ void LLAudioEngine::setDefaults()
 
     for (U32 i = 0; i < LLAudioEngine::AUDIO_TYPE_COUNT; i++)
         mSecondaryGain[i] = 1.0f;
+
+    // <FS> Decoded sound cache
+    mDecodedLRU.clear();
+    mDecodedIndex.clear();
+    mDecodedBytes = 0;
+    mDecodedLimit = DEFAULT_DECODED_CACHE_LIMIT;
+    // </FS>
 }
 
 
@@ -148,6 +162,13 @@ void LLAudioEngine::shutdown()
         delete data_pair.second;
     }
 
+    // <FS> Decoded sound cache
+    LLMemAccounting::disclaim(LLMemTag::AUDIO, (S64)mDecodedBytes);
+    mDecodedLRU.clear();
+    mDecodedIndex.clear();
+    mDecodedBytes = 0;
+    // </FS>
+
 
     // Clean up channels
     S32 i;
@@ -1027,6 +1048,85 @@ bool LLAudioEngine::hasLocalFile(const LLUUID &uuid)
     return have_local;
 }
 
+// <FS> Decoded sound cache
+void LLAudioEngine::setDecodedCacheLimit(size_t bytes)
+{
+    mDecodedLimit = bytes;
+    while (mDecodedBytes > mDecodedLimit && !mDecodedLRU.empty())
+    {
+        removeCachedDecodedWAV(mDecodedLRU.back().first);
+    }
+}
+
+void LLAudioEngine::cacheDecodedWAV(const LLUUID &uuid, std::vector<U8>&& wav)
+{
+    removeCachedDecodedWAV(uuid);
+    if (wav.empty() || wav.size() > mDecodedLimit)
+    {
+        return;
+    }
+
+    while (mDecodedBytes + wav.size() > mDecodedLimit && !mDecodedLRU.empty())
+    {
+        removeCachedDecodedWAV(mDecodedLRU.back().first);
+    }
+
+    mDecodedBytes += wav.size();
+    LLMemAccounting::claim(LLMemTag::AUDIO, (S64)wav.size());
+    mDecodedLRU.emplace_front(uuid, std::move(wav));
+    mDecodedIndex[uuid] = mDecodedLRU.begin();
+}
+
+const std::vector<U8>* LLAudioEngine::getCachedDecodedWAV(const LLUUID &uuid)
+{
+    auto it = mDecodedIndex.find(uuid);
+    if (it == mDecodedIndex.end())
+    {
+        return nullptr;
+    }
+
+    // Move to the front, iterators into the list stay valid
+    mDecodedLRU.splice(mDecodedLRU.begin(), mDecodedLRU, it->second);
+    return &it->second->second;
+}
+
+void LLAudioEngine::removeCachedDecodedWAV(const LLUUID &uuid)
+{
+    auto it = mDecodedIndex.find(uuid);
+    if (it == mDecodedIndex.end())
+    {
+        return;
+    }
+
+    mDecodedBytes -= it->second->second.size();
+    LLMemAccounting::disclaim(LLMemTag::AUDIO, (S64)it->second->second.size());
+    mDecodedLRU.erase(it->second);
+    mDecodedIndex.erase(it);
+}
+
+void LLAudioEngine::getSoundPriorities(std::map<LLUUID, F32>& priorities) const
+{
+    for (const source_map::value_type& src_pair : mAllSources)
+    {
+        LLAudioSource* sourcep = src_pair.second;
+        if (!sourcep)
+        {
+            continue;
+        }
+
+        LLAudioData* data[] = { sourcep->getCurrentData(), sourcep->getQueuedData() };
+        for (LLAudioData* adp : data)
+        {
+            if (adp)
+            {
+                F32& priority = priorities[adp->getID()];
+                priority = llmax(priority, sourcep->getPriority());
+            }
+        }
+    }
+}
+// </FS>
+
 void LLAudioEngine::startNextTransfer()
 {
     //LL_INFOS() << "LLAudioEngine::startNextTransfer()" << LL_ENDL;
@@ -1967,7 +2067,10 @@ bool LLAudioData::load()
     wav_path= gDirUtilp->getExpandedFilename(LL_PATH_FS_SOUND_CACHE,uuid_str) + ".dsf";
     // </FS:Ansariel>
 
-    mHasWAVLoadFailed = !mBufferp->loadWAV(wav_path);
+    // <FS> Decoded sound cache
+    //mHasWAVLoadFailed = !mBufferp->loadWAV(wav_path);
+    mHasWAVLoadFailed = !loadCachedWAV(wav_path) && !mBufferp->loadWAV(wav_path);
+    // </FS>
     if (mHasWAVLoadFailed)
     {
         // Hrm.  Right now, let's unset the buffer, since it's empty.
@@ -2002,6 +2105,48 @@ bool LLAudioData::load()
     return true;
 }
 
+// <FS> Decoded sound cache
+bool LLAudioData::loadCachedWAV(const std::string& wav_path)
+{
+    if (const std::vector<U8>* wav = gAudiop->getCachedDecodedWAV(mID))
+    {
+        return mBufferp->loadWAVFromMemory(wav->data(), wav->size());
+    }
+
+    if (!gAudiop->getDecodedCacheLimit())
+    {
+        return false;
+    }
+
+    // Read the file ourselves, so the next load of this sound comes from
+    // memory. Anything going wrong here is left to loadWAV() to report.
+    LLFILE* fp = LLFile::fopen(wav_path, "rb");
+    if (!fp)
+    {
+        return false;
+    }
+
+    std::vector<U8> wav;
+    fseek(fp, 0, SEEK_END);
+    long length = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (length > 0)
+    {
+        wav.resize(length);
+        wav.resize(fread(wav.data(), 1, length, fp));
+    }
+    fclose(fp);
+
+    if (wav.empty() || !mBufferp->loadWAVFromMemory(wav.data(), wav.size()))
+    {
+        return false;
+    }
+
+    gAudiop->cacheDecodedWAV(mID, std::move(wav));
+    return true;
+}
+// </FS>
+
 // <FS:ND> Protect against corrupted sounds
 
 const U32 ND_MAX_SOUNDRETRIES = 25;
@@ -2082,5 +2227,7 @@ void LLAudioEngine::removeAudioData(const LLUUID& audio_uuid)
 
         mAllData.erase(audio_uuid);
     }
+
+    removeCachedDecodedWAV(audio_uuid); // <FS/> Decoded sound cache
 }
 // </FS:Ansariel>
@@ -31,6 +31,7 @@
 #include <list>
 #include <map>
 #include <array>
+#include <vector> // <FS/> Decoded sound cache
 
 #include "v3math.h"
 #include "v3dmath.h"
@@ -180,6 +181,21 @@ public:
     bool hasDecodedFile(const LLUUID &uuid);
     bool hasLocalFile(const LLUUID &uuid);
 
+    // <FS> Decoded sound cache
+    // Keeps the decoded WAV images of recently played sounds in memory, so
+    // sounds that are triggered again and again skip the disk cache when
+    // their buffer has been recycled. Least recently used sounds are dropped
+    // once the cache holds more than the limit. Main thread only.
+    void setDecodedCacheLimit(size_t bytes);
+    size_t getDecodedCacheLimit() const { return mDecodedLimit; }
+    void cacheDecodedWAV(const LLUUID &uuid, std::vector<U8>&& wav);
+    const std::vector<U8>* getCachedDecodedWAV(const LLUUID &uuid);
+    void removeCachedDecodedWAV(const LLUUID &uuid);
+
+    // Highest priority of the sources playing or queueing each sound
+    void getSoundPriorities(std::map<LLUUID, F32>& priorities) const;
+    // </FS>
+
     bool updateBufferForData(LLAudioData *adp, const LLUUID &audio_uuid = LLUUID::null);
 
 
@@ -271,6 +287,14 @@ protected:
     // <FS:Ansariel> Output device selection
     output_device_list_changed_callback_t mOutputDeviceListChangedCallback;
 
+    // <FS> Decoded sound cache
+    typedef std::list<std::pair<LLUUID, std::vector<U8> > > decoded_lru_t;
+    decoded_lru_t mDecodedLRU;  // Most recently used first
+    std::map<LLUUID, decoded_lru_t::iterator> mDecodedIndex;
+    size_t mDecodedBytes;
+    size_t mDecodedLimit;
+    // </FS>
+
 private:
     void setDefaults();
     LLStreamingAudioInterface *mStreamingAudioImpl;
@@ -441,6 +465,8 @@ class LLAudioData
     friend class LLAudioEngine;  // Severe laziness, bad.
 
   protected:
+    bool loadCachedWAV(const std::string& wav_path); // <FS/> Decoded sound cache
+
     LLUUID         mID;
     LLAudioBuffer *mBufferp;             // If this data is being used by the audio system, a pointer to the buffer will be set here.
     bool           mHasLocalData;        // Set true if the encoded sound asset file is available locally
@@ -505,6 +531,10 @@ class LLAudioBuffer
 public:
     virtual ~LLAudioBuffer() {};
     virtual bool loadWAV(const std::string& filename) = 0;
+    // <FS> Decoded sound cache
+    // Loads a WAV image already in memory, the buffer keeps its own copy
+    virtual bool loadWAVFromMemory(const U8* data, size_t size) { return false; }
+    // </FS>
     virtual U32 getLength() = 0;
 
     friend class LLAudioEngine;
@@ -849,6 +849,39 @@ bool LLAudioBufferFMODSTUDIO::loadWAV(const std::string& filename)
 }
 
 
+bool LLAudioBufferFMODSTUDIO::loadWAVFromMemory(const U8* data, size_t size)
+{
+    if (!data || !size)
+    {
+        return false;
+    }
+
+    if (mSoundp)
+    {
+        // If there's already something loaded in this buffer, clean it up.
+        Check_FMOD_Error(mSoundp->release(), "FMOD::Sound::release");
+        mSoundp = NULL;
+    }
+
+    FMOD_MODE base_mode = FMOD_LOOP_NORMAL | FMOD_OPENMEMORY; // FMOD copies the data for samples
+    FMOD_CREATESOUNDEXINFO exinfo;
+    memset(&exinfo, 0, sizeof(exinfo));
+    exinfo.cbsize = sizeof(exinfo);
+    exinfo.length = (unsigned int)size;
+    exinfo.suggestedsoundtype = FMOD_SOUND_TYPE_WAV;
+    FMOD_RESULT result = getSystem()->createSound((const char*)data, base_mode, &exinfo, &mSoundp);
+
+    if (result != FMOD_OK)
+    {
+        LL_WARNS() << "Could not load " << size << " bytes of sound data: " << FMOD_ErrorString(result) << LL_ENDL;
+        mSoundp = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+
 U32 LLAudioBufferFMODSTUDIO::getLength()
 {
     if (!mSoundp)
@@ -133,6 +133,7 @@ public:
     virtual ~LLAudioBufferFMODSTUDIO();
 
     /*virtual*/ bool loadWAV(const std::string& filename);
+    /*virtual*/ bool loadWAVFromMemory(const U8* data, size_t size);
     /*virtual*/ U32 getLength();
     friend class LLAudioChannelFMODSTUDIO;
 protected:
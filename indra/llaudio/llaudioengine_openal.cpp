@@ -379,6 +379,22 @@ bool LLAudioBufferOpenAL::loadWAV(const std::string& filename)
     return true;
 }
 
+// <FS> Decoded sound cache
+bool LLAudioBufferOpenAL::loadWAVFromMemory(const U8* data, size_t size)
+{
+    cleanup();
+    mALBuffer = alutCreateBufferFromFileImage(data, (ALsizei)size);
+    if (mALBuffer == AL_NONE)
+    {
+        LL_WARNS() << "LLAudioBufferOpenAL::loadWAVFromMemory() Error loading "
+                   << size << " bytes " << alutGetErrorString(alutGetError()) << LL_ENDL;
+        return false;
+    }
+
+    return true;
+}
+// </FS>
+
 U32 LLAudioBufferOpenAL::getLength()
 {
     if(mALBuffer == AL_NONE)
@@ -95,6 +95,7 @@ class LLAudioBufferOpenAL : public LLAudioBuffer{
         virtual ~LLAudioBufferOpenAL();
 
         bool loadWAV(const std::string& filename);
+        bool loadWAVFromMemory(const U8* data, size_t size); // <FS/> Decoded sound cache
         U32 getLength();
 
         friend class LLAudioChannelOpenAL;
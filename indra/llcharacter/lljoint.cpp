@@ -35,20 +35,28 @@
 #include <boost/algorithm/string.hpp>
 
 //<FS:ND> Query by JointKey rather than just a string, the key can be a U32 index for faster lookup
-#include <unordered_map>
+// <FS> Lock-free intern table: skin info is read on the mesh threads too
+//#include <unordered_map>
+//
+//std::unordered_map<std::string, U32> mpStringToKeys;
+#include "llinterntable.h"
 
-std::unordered_map<std::string, U32> mpStringToKeys;
+static LLInternTable sJointKeys(64);
+// </FS>
 
 JointKey JointKey::construct(const std::string& aName)
 {
-    if (const auto itr = mpStringToKeys.find(aName); itr != mpStringToKeys.end())
-    {
-        return { aName, itr->second };
-    }
-
-    U32 size = static_cast<U32>(mpStringToKeys.size()) + 1;
-    mpStringToKeys.try_emplace(aName, size);
-    return { aName, size };
+    // <FS> Lock-free intern table
+    //if (const auto itr = mpStringToKeys.find(aName); itr != mpStringToKeys.end())
+    //{
+    //    return { aName, itr->second };
+    //}
+    //
+    //U32 size = static_cast<U32>(mpStringToKeys.size()) + 1;
+    //mpStringToKeys.try_emplace(aName, size);
+    //return { aName, size };
+    return { aName, sJointKeys.intern(aName)->mId };
+    // </FS>
 }
 // </FS:ND>
 
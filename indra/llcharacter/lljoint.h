@@ -174,6 +174,7 @@ public:
     joints_t mChildren;
 
     // debug statics
+    // <FS/> Parallel avatar updates: the counts are approximate while skeletons update on several threads
     static S32      sNumTouches;
     static S32      sNumUpdates;
     typedef std::set<std::string> debug_joint_name_t;
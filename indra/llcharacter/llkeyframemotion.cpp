@@ -75,7 +75,8 @@ LLKeyframeMotion::JointMotionList::JointMotionList()
       mEaseOutDuration(0.f),
       mBasePriority(LLJoint::LOW_PRIORITY),
       mHandPose(LLHandMotion::HAND_POSE_SPREAD),
-      mMaxPriority(LLJoint::LOW_PRIORITY)
+      mMaxPriority(LLJoint::LOW_PRIORITY),
+      mSampleTime(0.f) // <FS/> Shared keyframe evaluation
 {
 }
 
@@ -123,12 +124,145 @@ U32 LLKeyframeMotion::JointMotionList::dumpDiagInfo()
     return total_size;
 }
 
+// <FS> Shared keyframe evaluation
+//-----------------------------------------------------------------------------
+// JointMotionList::sample()
+//-----------------------------------------------------------------------------
+const std::vector<LLKeyframeMotion::JointMotion::Sample>& LLKeyframeMotion::JointMotionList::sample(F32 time)
+{
+    if (mSamples.size() == mJointMotionArray.size() && time == mSampleTime)
+    {
+        return mSamples;
+    }
+
+    mSamples.resize(mJointMotionArray.size());
+    for (U32 i = 0; i < getNumJointMotions(); ++i)
+    {
+        mJointMotionArray[i]->sample(mSamples[i], time, mDuration);
+    }
+    mSampleTime = time;
+
+    return mSamples;
+}
+// </FS>
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 // ****Curve classes
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 
+// <FS> Shared keyframe evaluation
+//-----------------------------------------------------------------------------
+// KeyTable::build()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::KeyTable::build(std::vector<F32>&& times)
+{
+    mTimes = std::move(times);
+    mBuckets.clear();
+    mBucketScale = 0.f;
+
+    if (mTimes.size() < 2 || mTimes.back() <= 0.f)
+    {
+        return;
+    }
+
+    // About one key per bucket
+    const U32 num_buckets = (U32)mTimes.size();
+    mBucketScale = (F32)num_buckets / mTimes.back();
+    mBuckets.resize(num_buckets);
+
+    U32 key = 0;
+    for (U32 bucket = 0; bucket < num_buckets; ++bucket)
+    {
+        const F32 start = (F32)bucket / mBucketScale;
+        while (key < mTimes.size() && mTimes[key] < start)
+        {
+            ++key;
+        }
+        mBuckets[bucket] = key;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// KeyTable::find()
+//-----------------------------------------------------------------------------
+U32 LLKeyframeMotion::KeyTable::find(F32 time, U32& after, F32& u) const
+{
+    const U32 num_keys = (U32)mTimes.size();
+    u = 0.f;
+
+    // Past the last key, or the only one
+    if (num_keys < 2 || time > mTimes.back())
+    {
+        after = num_keys - 1;
+        return after;
+    }
+
+    U32 right = 0;
+    if (!mBuckets.empty())
+    {
+        const F32 bucket = time * mBucketScale;
+        if (bucket > 0.f)   // also false for NaN
+        {
+            right = mBuckets[bucket >= (F32)mBuckets.size() ? mBuckets.size() - 1 : (U32)bucket];
+        }
+    }
+    // the bucket starts are rounded, don't trust them to the last bit
+    while (right > 0 && mTimes[right - 1] >= time)
+    {
+        --right;
+    }
+    while (mTimes[right] < time)
+    {
+        ++right;
+    }
+
+    // Before the first key or exactly on a key
+    if (right == 0 || mTimes[right] == time)
+    {
+        after = right;
+        return right;
+    }
+
+    // Between two keys
+    after = right;
+    u = (time - mTimes[right - 1]) / (mTimes[right] - mTimes[right - 1]);
+    return right - 1;
+}
+
+namespace
+{
+    // The keys of a curve as its KeyTable times and values. A curve whose
+    // keys all hold the same value is kept as its first key, every time
+    // gives that value.
+    template <typename KEY_MAP, typename VALUE, typename GET>
+    void flatten_keys(const KEY_MAP& keys, LLKeyframeMotion::KeyTable& table, std::vector<VALUE>& values, GET get)
+    {
+        std::vector<F32> times;
+        times.reserve(keys.size());
+        values.clear();
+        values.reserve(keys.size());
+
+        bool constant = true;
+        for (const auto& key : keys)
+        {
+            times.push_back(key.first);
+            values.push_back(get(key.second));
+            constant = constant && values.back() == values.front();
+        }
+
+        if (constant && values.size() > 1)
+        {
+            times.resize(1);
+            values.resize(1);
+        }
+
+        table.build(std::move(times));
+    }
+}
+// </FS>
+
 
 //-----------------------------------------------------------------------------
 // ScaleCurve::ScaleCurve()
@@ -153,6 +287,20 @@ LLKeyframeMotion::ScaleCurve::~ScaleCurve()
 //-----------------------------------------------------------------------------
 LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration)
 {
+    // <FS> Shared keyframe evaluation
+    if (!mValues.empty())
+    {
+        U32 after;
+        F32 u;
+        const U32 before = mTable.find(time, after, u);
+        if (after == before || mInterpolationType == IT_STEP)
+        {
+            return mValues[before];
+        }
+        return lerp(mValues[before], mValues[after], u);
+    }
+    // </FS>
+
     LLVector3 value;
 
     if (mKeys.empty())
@@ -193,6 +341,16 @@ LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration)
     return value;
 }
 
+// <FS> Shared keyframe evaluation
+//-----------------------------------------------------------------------------
+// ScaleCurve::buildTable()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::ScaleCurve::buildTable()
+{
+    flatten_keys(mKeys, mTable, mValues, [](const ScaleKey& key) { return key.mScale; });
+}
+// </FS>
+
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
@@ -233,6 +391,20 @@ LLKeyframeMotion::RotationCurve::~RotationCurve()
 //-----------------------------------------------------------------------------
 LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration)
 {
+    // <FS> Shared keyframe evaluation
+    if (!mValues.empty())
+    {
+        U32 after;
+        F32 u;
+        const U32 before = mTable.find(time, after, u);
+        if (after == before || mInterpolationType == IT_STEP)
+        {
+            return mValues[before];
+        }
+        return nlerp(u, mValues[before], mValues[after]);
+    }
+    // </FS>
+
     LLQuaternion value;
 
     if (mKeys.empty())
@@ -273,6 +445,16 @@ LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration)
     return value;
 }
 
+// <FS> Shared keyframe evaluation
+//-----------------------------------------------------------------------------
+// RotationCurve::buildTable()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::RotationCurve::buildTable()
+{
+    flatten_keys(mKeys, mTable, mValues, [](const RotationKey& key) { return key.mRotation; });
+}
+// </FS>
+
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
@@ -314,6 +496,20 @@ LLKeyframeMotion::PositionCurve::~PositionCurve()
 //-----------------------------------------------------------------------------
 LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration)
 {
+    // <FS> Shared keyframe evaluation
+    if (!mValues.empty())
+    {
+        U32 after;
+        F32 u;
+        const U32 before = mTable.find(time, after, u);
+        if (after == before || mInterpolationType == IT_STEP)
+        {
+            return mValues[before];
+        }
+        return lerp(mValues[before], mValues[after], u);
+    }
+    // </FS>
+
     LLVector3 value;
 
     if (mKeys.empty())
@@ -357,6 +553,16 @@ LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration)
     return value;
 }
 
+// <FS> Shared keyframe evaluation
+//-----------------------------------------------------------------------------
+// PositionCurve::buildTable()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::PositionCurve::buildTable()
+{
+    flatten_keys(mKeys, mTable, mValues, [](const PositionKey& key) { return key.mPosition; });
+}
+// </FS>
+
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
@@ -419,6 +625,57 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
     }
 }
 
+// <FS> Shared keyframe evaluation
+//-----------------------------------------------------------------------------
+// JointMotion::sample()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::JointMotion::sample(Sample& sample, F32 time, F32 duration)
+{
+    // Curves without keys are never applied
+    if (mScaleCurve.mNumKeys)
+    {
+        sample.mScale = mScaleCurve.getValue(time, duration);
+    }
+    if (mRotationCurve.mNumKeys)
+    {
+        sample.mRotation = mRotationCurve.getValue(time, duration);
+    }
+    if (mPositionCurve.mNumKeys)
+    {
+        sample.mPosition = mPositionCurve.getValue(time, duration);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// JointMotion::apply()
+//-----------------------------------------------------------------------------
+void LLKeyframeMotion::JointMotion::apply(LLJointState* joint_state, const Sample& sample) const
+{
+    // As update() does
+    if ( joint_state == NULL )
+    {
+        return;
+    }
+
+    U32 usage = joint_state->getUsage();
+
+    if ((usage & LLJointState::SCALE) && mScaleCurve.mNumKeys)
+    {
+        joint_state->setScale(sample.mScale);
+    }
+
+    if ((usage & LLJointState::ROT) && mRotationCurve.mNumKeys)
+    {
+        joint_state->setRotation(sample.mRotation);
+    }
+
+    if ((usage & LLJointState::POS) && mPositionCurve.mNumKeys)
+    {
+        joint_state->setPosition(sample.mPosition);
+    }
+}
+// </FS>
+
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
@@ -543,7 +800,10 @@ LLMotion::LLMotionInitStatus LLKeyframeMotion::onInitialize(LLCharacter *charact
         for(U32 i = 0; i < mJointMotionList->getNumJointMotions(); i++)
         {
             JointMotion* joint_motion = mJointMotionList->getJointMotion(i);
-            if (LLJoint *joint = mCharacter->getJoint(joint_motion->mJointName))
+            // <FS> Shared keyframe evaluation
+            //if (LLJoint *joint = mCharacter->getJoint(joint_motion->mJointName))
+            if (LLJoint *joint = mCharacter->getJoint(joint_motion->mJointKey))
+            // </FS>
             {
                 LLPointer<LLJointState> joint_state = new LLJointState;
                 mJointStates.push_back(joint_state);
@@ -738,12 +998,19 @@ bool LLKeyframeMotion::onUpdate(F32 time, U8* joint_mask)
 void LLKeyframeMotion::applyKeyframes(F32 time)
 {
     llassert_always (mJointMotionList->getNumJointMotions() <= mJointStates.size());
+    // <FS> Shared keyframe evaluation
+    //for (U32 i=0; i<mJointMotionList->getNumJointMotions(); i++)
+    //{
+    //    mJointMotionList->getJointMotion(i)->update(mJointStates[i],
+    //                                                  time,
+    //                                                  mJointMotionList->mDuration );
+    //}
+    const std::vector<JointMotion::Sample>& samples = mJointMotionList->sample(time);
     for (U32 i=0; i<mJointMotionList->getNumJointMotions(); i++)
     {
-        mJointMotionList->getJointMotion(i)->update(mJointStates[i],
-                                                      time,
-                                                      mJointMotionList->mDuration );
+        mJointMotionList->getJointMotion(i)->apply(mJointStates[i], samples[i]);
     }
+    // </FS>
 
     LLJoint::JointPriority* pose_priority = (LLJoint::JointPriority* )mCharacter->getAnimationData("Hand Pose Priority");
     if (pose_priority)
@@ -1509,6 +1776,7 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
         }
 
         joint_motion->mJointName = joint_name;
+        joint_motion->mJointKey = JointKey::construct(joint_name); // <FS/> Shared keyframe evaluation
 
         LLPointer<LLJointState> joint_state = new LLJointState;
         mJointStates.push_back(joint_state);
@@ -1789,6 +2057,12 @@ bool LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id, boo
         }
 
         joint_motion->mUsage = joint_state->getUsage();
+
+        // <FS> Shared keyframe evaluation
+        joint_motion->mScaleCurve.buildTable();
+        joint_motion->mRotationCurve.buildTable();
+        joint_motion->mPositionCurve.buildTable();
+        // </FS>
     }
 
     if (rotation_duplicates > 0)
@@ -317,6 +317,31 @@ public:
         LLVector3   mPosition;
     };
 
+    // <FS> Shared keyframe evaluation
+    //-------------------------------------------------------------------------
+    // KeyTable
+    // The key times of a curve flattened once the motion is loaded. Bucket b
+    // holds the first key at or after b / mBucketScale, so finding the keys
+    // around a time is a short scan from its bucket instead of a walk down
+    // the key map.
+    //-------------------------------------------------------------------------
+    class KeyTable
+    {
+    public:
+        KeyTable() : mBucketScale(0.f) {}
+
+        void build(std::vector<F32>&& times);
+
+        // The keys around time as the curves' getValue() picks them, after
+        // == before when time is before the first, after the last or on a key
+        U32 find(F32 time, U32& after, F32& u) const;
+
+        std::vector<F32>    mTimes;
+        std::vector<U32>    mBuckets;
+        F32                 mBucketScale;   // buckets per second
+    };
+    // </FS>
+
     //-------------------------------------------------------------------------
     // ScaleCurve
     //-------------------------------------------------------------------------
@@ -334,6 +359,13 @@ public:
         key_map_t           mKeys;
         ScaleKey            mLoopInKey;
         ScaleKey            mLoopOutKey;
+        // <FS> Shared keyframe evaluation
+        // Flatten mKeys for getValue(), once they are all in
+        void buildTable();
+
+        KeyTable                mTable;
+        std::vector<LLVector3>  mValues;    // of the keys in mTable
+        // </FS>
     };
 
     //-------------------------------------------------------------------------
@@ -353,6 +385,13 @@ public:
         key_map_t       mKeys;
         RotationKey     mLoopInKey;
         RotationKey     mLoopOutKey;
+        // <FS> Shared keyframe evaluation
+        // Flatten mKeys for getValue(), once they are all in
+        void buildTable();
+
+        KeyTable                mTable;
+        std::vector<LLQuaternion> mValues; // of the keys in mTable
+        // </FS>
     };
 
     //-------------------------------------------------------------------------
@@ -372,6 +411,13 @@ public:
         key_map_t       mKeys;
         PositionKey     mLoopInKey;
         PositionKey     mLoopOutKey;
+        // <FS> Shared keyframe evaluation
+        // Flatten mKeys for getValue(), once they are all in
+        void buildTable();
+
+        KeyTable                mTable;
+        std::vector<LLVector3>  mValues;    // of the keys in mTable
+        // </FS>
     };
 
     //-------------------------------------------------------------------------
@@ -388,6 +434,20 @@ public:
         LLJoint::JointPriority  mPriority;
 
         void update(LLJointState* joint_state, F32 time, F32 duration);
+
+        // <FS> Shared keyframe evaluation
+        struct Sample
+        {
+            LLVector3       mPosition;
+            LLQuaternion    mRotation;
+            LLVector3       mScale;
+        };
+
+        void sample(Sample& sample, F32 time, F32 duration);
+        void apply(LLJointState* joint_state, const Sample& sample) const;
+
+        JointKey        mJointKey;  // of mJointName, for mapping the joints of every instance
+        // </FS>
     };
 
     //-------------------------------------------------------------------------
@@ -421,6 +481,17 @@ public:
         U32 dumpDiagInfo();
         JointMotion* getJointMotion(U32 index) const { llassert(index < mJointMotionArray.size()); return mJointMotionArray[index]; }
         U32 getNumJointMotions() const { return static_cast<U32>(mJointMotionArray.size()); }
+
+        // <FS> Shared keyframe evaluation
+        // The curves of all joint motions at time. The last sample is kept
+        // for the next instance that asks for the same time, as every avatar
+        // holding the same pose does.
+        const std::vector<JointMotion::Sample>& sample(F32 time);
+
+    private:
+        std::vector<JointMotion::Sample>    mSamples;
+        F32                                 mSampleTime;
+        // </FS>
     };
 
 protected:
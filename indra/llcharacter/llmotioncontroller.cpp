@@ -140,6 +140,8 @@ LLMotionController::LLMotionController()
       mTimeStep(0.f),
       mTimeStepCount(0),
       mLastInterp(0.f),
+      mDeferPoseApply(false), // <FS/> Parallel avatar updates
+      mPosePending(false), // <FS/> Parallel avatar updates
       mIsSelf(false),
       mLastCountAfterPurge(0)
 {
@@ -821,6 +823,12 @@ void LLMotionController::updateLoadingMotions()
 void LLMotionController::updateMotions(bool force_update)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+
+    // <FS> Parallel avatar updates
+    // A pose nobody applied still goes to the joints before it is replaced
+    applyPendingPose();
+    // </FS>
+
     // SL-763: "Distant animated objects run at super fast speed"
     // The use_quantum optimization or possibly the associated code in setTimeStamp()
     // does not work as implemented.
@@ -900,16 +908,80 @@ void LLMotionController::updateMotions(bool force_update)
         {
             mPoseBlender.blendAndCache(true);
         }
+        // <FS> Parallel avatar updates
+        //else
+        //{
+        //    mPoseBlender.blendAndApply();
+        //}
+        else if (mDeferPoseApply)
+        {
+            mPosePending = true;
+        }
         else
         {
             mPoseBlender.blendAndApply();
         }
+        // </FS>
     }
 
     mHasRunOnce = true;
 //  LL_INFOS() << "Motion controller time " << motionTimer.getElapsedTimeF32() << LL_ENDL;
 }
 
+// <FS> Parallel avatar updates
+//-----------------------------------------------------------------------------
+// applyPendingPose()
+//-----------------------------------------------------------------------------
+void LLMotionController::applyPendingPose()
+{
+    if (mPosePending)
+    {
+        LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+        mPoseBlender.blendAndApply();
+        mPosePending = false;
+    }
+}
+// </FS>
+
+// <FS> Shared animesh poses
+//-----------------------------------------------------------------------------
+// getCurrentAnimTime()
+//-----------------------------------------------------------------------------
+F32 LLMotionController::getCurrentAnimTime() const
+{
+    if (mPaused)
+    {
+        return mAnimTime;
+    }
+    F32 delta_time = mTimer.getElapsedTimeF32() - mPrevTimerElapsed;
+    return mAnimTime + delta_time * mTimeFactor * mUpdateFactor;
+}
+
+//-----------------------------------------------------------------------------
+// getMotionTime()
+//-----------------------------------------------------------------------------
+F32 LLMotionController::getMotionTime(const LLMotion* motion) const
+{
+    return getCurrentAnimTime() - motion->mActivationTimestamp;
+}
+
+//-----------------------------------------------------------------------------
+// advanceTime()
+//-----------------------------------------------------------------------------
+void LLMotionController::advanceTime()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    F32 anim_time = getCurrentAnimTime();
+    mPrevTimerElapsed = mTimer.getElapsedTimeF32();
+    mLastTime = mAnimTime;
+    mAnimTime = anim_time;
+
+    purgeExcessMotions();
+    updateLoadingMotions();
+    mHasRunOnce = true;
+}
+// </FS>
+
 //-----------------------------------------------------------------------------
 // updateMotionsMinimal()
 // minimal update (e.g. while hidden)
@@ -137,6 +137,29 @@ public:
 
     void clearBlenders() { mPoseBlender.clearBlenders(); }
 
+    // <FS> Parallel avatar updates
+    // While set, updateMotions() leaves the blended pose for
+    // applyPendingPose() instead of applying it to the joints
+    void setDeferPoseApply(bool defer) { mDeferPoseApply = defer; }
+
+    // Threads:  any
+    // Apply the pose left by updateMotions(). Writes to the joints of this
+    // character only, so characters can be applied side by side.
+    void applyPendingPose();
+    // </FS>
+
+    // <FS> Shared animesh poses
+    // Animation time updateMotions() would use if it ran now
+    F32 getCurrentAnimTime() const;
+
+    // How long a motion has been playing at getCurrentAnimTime()
+    F32 getMotionTime(const LLMotion* motion) const;
+
+    // Advance the animation time like updateMotions() without evaluating
+    // any motion, for a character that copies its pose from another one
+    void advanceTime();
+    // </FS>
+
     // flush motions
     // releases all motion instances
     void flushAllMotions();
@@ -230,6 +253,8 @@ protected:
     F32                 mTimeStep;
     S32                 mTimeStepCount;
     F32                 mLastInterp;
+    bool                mDeferPoseApply;    // <FS/> Parallel avatar updates
+    bool                mPosePending;       // <FS/> Parallel avatar updates
 
     U8                  mJointSignature[2][LL_CHARACTER_MAX_ANIMATED_JOINTS];
 private:
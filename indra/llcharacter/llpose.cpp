@@ -34,10 +34,153 @@
 #include "llmotion.h"
 #include "llmath.h"
 #include "llstl.h"
+#include "llvector4a.h" // <FS/> Vector pose blending
 
 //-----------------------------------------------------------------------------
 // Static
 //-----------------------------------------------------------------------------
+bool LLPoseBlender::sVectorBlend = true; // <FS/> Vector pose blending
+
+// <FS> Vector pose blending
+// Joint states of four blenders in SIMD lanes, one component per
+// LLVector4a. The math is the same as LLJointStateBlender::blendJointStates()
+// step by step, with the branches of the scalar code turned into masks.
+namespace
+{
+    inline LLVector4Logical mask_and(const LLVector4Logical& a, const LLVector4Logical& b)
+    {
+        return _mm_and_ps(a, b);
+    }
+
+    inline LLVector4Logical mask_or(const LLVector4Logical& a, const LLVector4Logical& b)
+    {
+        return _mm_or_ps(a, b);
+    }
+
+    // a and not b
+    inline LLVector4Logical mask_andnot(const LLVector4Logical& a, const LLVector4Logical& b)
+    {
+        return _mm_andnot_ps(b, a);
+    }
+
+    // Lane i set when bit i of bits is
+    inline LLVector4Logical mask_from_bits(U32 bits)
+    {
+        return _mm_castsi128_ps(_mm_set_epi32((bits & 8) ? -1 : 0, (bits & 4) ? -1 : 0, (bits & 2) ? -1 : 0, (bits & 1) ? -1 : 0));
+    }
+
+    inline void set_lane(LLVector4a* v, U32 components, U32 lane, const F32* src)
+    {
+        for (U32 c = 0; c < components; ++c)
+        {
+            v[c].getF32ptr()[lane] = src[c];
+        }
+    }
+
+    // out = a * b as LLQuaternion's operator*
+    void quat_mul4(const LLVector4a* a, const LLVector4a* b, LLVector4a* out)
+    {
+        LLVector4a r[4], t;
+
+        r[VX].setMul(b[VW], a[VX]);
+        t.setMul(b[VX], a[VW]); r[VX].add(t);
+        t.setMul(b[VY], a[VZ]); r[VX].add(t);
+        t.setMul(b[VZ], a[VY]); r[VX].sub(t);
+
+        r[VY].setMul(b[VW], a[VY]);
+        t.setMul(b[VY], a[VW]); r[VY].add(t);
+        t.setMul(b[VZ], a[VX]); r[VY].add(t);
+        t.setMul(b[VX], a[VZ]); r[VY].sub(t);
+
+        r[VZ].setMul(b[VW], a[VZ]);
+        t.setMul(b[VZ], a[VW]); r[VZ].add(t);
+        t.setMul(b[VX], a[VY]); r[VZ].add(t);
+        t.setMul(b[VY], a[VX]); r[VZ].sub(t);
+
+        r[VW].setMul(b[VW], a[VW]);
+        t.setMul(b[VX], a[VX]); r[VW].sub(t);
+        t.setMul(b[VY], a[VY]); r[VW].sub(t);
+        t.setMul(b[VZ], a[VZ]); r[VW].sub(t);
+
+        for (U32 c = 0; c < 4; ++c)
+        {
+            out[c] = r[c];
+        }
+    }
+
+    // out = nlerp(t, a, b) as LLQuaternion's nlerp(). Lanes where a and b are
+    // on opposite hemispheres take the scalar slerp like nlerp() does, those
+    // are rare between joint states of the same joint.
+    void quat_nlerp4(const LLVector4a& t, const LLVector4a* a, const LLVector4a* b, LLVector4a* out)
+    {
+        LLVector4a zero, one;
+        zero.clear();
+        one.splat(1.f);
+
+        LLVector4a dot, tmp;
+        dot.setMul(a[VX], b[VX]);
+        tmp.setMul(a[VY], b[VY]); dot.add(tmp);
+        tmp.setMul(a[VZ], b[VZ]); dot.add(tmp);
+        tmp.setMul(a[VW], b[VW]); dot.add(tmp);
+
+        // lerp(t, a, b), then LLQuaternion::normalize()
+        LLVector4a inv_t;
+        inv_t.setSub(one, t);
+
+        LLVector4a r[4];
+        for (U32 c = 0; c < 4; ++c)
+        {
+            r[c].setMul(t, b[c]);
+            tmp.setMul(inv_t, a[c]);
+            r[c].add(tmp);
+        }
+
+        LLVector4a mag;
+        mag.setMul(r[VX], r[VX]);
+        tmp.setMul(r[VY], r[VY]); mag.add(tmp);
+        tmp.setMul(r[VZ], r[VZ]); mag.add(tmp);
+        tmp.setMul(r[VW], r[VW]); mag.add(tmp);
+        mag = _mm_sqrt_ps(mag);
+
+        LLVector4a threshold, unit_tolerance, off_unit;
+        threshold.splat(FP_MAG_THRESHOLD);
+        unit_tolerance.splat(ONE_PART_IN_A_MILLION);
+        off_unit.setSub(one, mag);
+        off_unit.setAbs(off_unit);
+
+        const LLVector4Logical valid = mag.greaterThan(threshold);
+        const LLVector4Logical rescale = mask_and(valid, off_unit.greaterThan(unit_tolerance));
+
+        LLVector4a oomag;
+        oomag.setDiv(one, mag);
+        oomag.setSelectWithMask(rescale, oomag, one);
+
+        for (U32 c = 0; c < 4; ++c)
+        {
+            r[c].mul(oomag);
+            // a very bad quaternion becomes identity
+            r[c].setSelectWithMask(valid, r[c], c == VW ? one : zero);
+        }
+
+        U32 flipped = dot.lessThan(zero).getGatheredBits();
+        for (U32 lane = 0; flipped; ++lane, flipped >>= 1)
+        {
+            if (flipped & 1)
+            {
+                LLQuaternion qa(a[VX][lane], a[VY][lane], a[VZ][lane], a[VW][lane]);
+                LLQuaternion qb(b[VX][lane], b[VY][lane], b[VZ][lane], b[VW][lane]);
+                LLQuaternion q = nlerp(t[lane], qa, qb);
+                set_lane(r, 4, lane, q.mQ);
+            }
+        }
+
+        for (U32 c = 0; c < 4; ++c)
+        {
+            out[c] = r[c];
+        }
+    }
+}
+// </FS>
 
 //-----------------------------------------------------------------------------
 // LLPose
@@ -176,6 +319,7 @@ S32 LLPose::getNumJointStates() const
 //-----------------------------------------------------------------------------
 
 LLJointStateBlender::LLJointStateBlender()
+    : mIsActive(false) // <FS/> Vector pose blending
 {
     for(S32 i = 0; i < JSB_NUM_JOINT_STATES; i++)
     {
@@ -399,6 +543,314 @@ void LLJointStateBlender::blendJointStates(bool apply_now)
     }
 }
 
+// <FS> Vector pose blending
+//-----------------------------------------------------------------------------
+// blendJointStates4()
+//-----------------------------------------------------------------------------
+// static
+void LLJointStateBlender::blendJointStates4(LLJointStateBlender* const* blenders, U32 count, bool apply_now)
+{
+    llassert(count <= 4);
+
+    LLJoint* target_joints[4] = { nullptr, nullptr, nullptr, nullptr };
+
+    LLVector4a zero, one;
+    zero.clear();
+    one.splat(1.f);
+
+    // Blended and added transforms, identity in the lanes without a joint
+    LLVector4a blended_pos[3], blended_rot[4], blended_scale[3];
+    LLVector4a added_pos[3], added_rot[4], added_scale[3];
+    for (U32 c = 0; c < 3; ++c)
+    {
+        blended_pos[c].clear();
+        blended_scale[c] = one;
+        added_pos[c].clear();
+        added_scale[c].clear();
+    }
+    for (U32 c = 0; c < 4; ++c)
+    {
+        blended_rot[c] = c == VW ? one : zero;
+        added_rot[c] = c == VW ? one : zero;
+    }
+
+    U32 lanes = 0;
+    for (U32 lane = 0; lane < count; ++lane)
+    {
+        LLJointStateBlender* blender = blenders[lane];
+        // instead of resetting joint state to default, just leave it unchanged from last frame
+        if (blender->mJointStates[0].isNull())
+        {
+            continue;
+        }
+
+        LLJoint* target_joint = apply_now ? blender->mJointStates[0]->getJoint() : &blender->mJointCache;
+        target_joints[lane] = target_joint;
+        lanes |= 1 << lane;
+
+        set_lane(blended_pos, 3, lane, target_joint->getPosition().mV);
+        set_lane(blended_rot, 4, lane, target_joint->getRotation().mQ);
+        set_lane(blended_scale, 3, lane, target_joint->getScale().mV);
+    }
+
+    if (!lanes)
+    {
+        return;
+    }
+
+    LLVector4a sum_pos, sum_rot, sum_scale;
+    sum_pos.clear();
+    sum_rot.clear();
+    sum_scale.clear();
+
+    // sum_usage of the scalar code
+    LLVector4Logical has_pos, has_rot, has_scale;
+    has_pos.clear();
+    has_rot.clear();
+    has_scale.clear();
+
+    for (S32 joint_state_index = 0; joint_state_index < JSB_NUM_JOINT_STATES; ++joint_state_index)
+    {
+        // Gather this slot of every lane. Slots are filled from zero, a lane
+        // without a state here has none further on either and sits out with
+        // a zero weight.
+        LLVector4a weight, pos[3], rot[4], scale[3];
+        weight.clear();
+        for (U32 c = 0; c < 3; ++c)
+        {
+            pos[c].clear();
+            scale[c] = one;
+        }
+        for (U32 c = 0; c < 4; ++c)
+        {
+            rot[c] = c == VW ? one : zero;
+        }
+
+        U32 present = 0, additive = 0, use_pos = 0, use_rot = 0, use_scale = 0;
+        for (U32 lane = 0; lane < count; ++lane)
+        {
+            if (!(lanes & (1 << lane)))
+            {
+                continue;
+            }
+
+            LLJointStateBlender* blender = blenders[lane];
+            LLJointState* jsp = blender->mJointStates[joint_state_index];
+            if (!jsp)
+            {
+                continue;
+            }
+
+            present |= 1 << lane;
+            weight.getF32ptr()[lane] = jsp->getWeight();
+
+            const U32 usage = jsp->getUsage();
+            if (blender->mAdditiveBlends[joint_state_index])
+            {
+                additive |= 1 << lane;
+            }
+            if (usage & LLJointState::POS)
+            {
+                use_pos |= 1 << lane;
+                set_lane(pos, 3, lane, jsp->getPosition().mV);
+            }
+            if (usage & LLJointState::ROT)
+            {
+                use_rot |= 1 << lane;
+                set_lane(rot, 4, lane, jsp->getRotation().mQ);
+            }
+            if (usage & LLJointState::SCALE)
+            {
+                use_scale |= 1 << lane;
+                set_lane(scale, 3, lane, jsp->getScale().mV);
+            }
+        }
+
+        if (!present)
+        {
+            break;
+        }
+
+        // states with no weight are skipped
+        const LLVector4Logical active = mask_and(mask_from_bits(present), weight.equal(zero).invert());
+        const LLVector4Logical additive_lanes = mask_and(active, mask_from_bits(additive));
+        const LLVector4Logical blend_lanes = mask_andnot(active, mask_from_bits(additive));
+        const LLVector4Logical pos_lanes = mask_from_bits(use_pos);
+        const LLVector4Logical rot_lanes = mask_from_bits(use_rot);
+        const LLVector4Logical scale_lanes = mask_from_bits(use_scale);
+
+        // Additive states, modulated by what weight is left
+        {
+            LLVector4a new_weight_sum, factor;
+
+            const LLVector4Logical add_pos = mask_and(additive_lanes, pos_lanes);
+            if (add_pos.areAnySet())
+            {
+                new_weight_sum.setAdd(weight, sum_pos);
+                new_weight_sum.setMin(new_weight_sum, one);
+                factor.setSub(new_weight_sum, sum_pos);
+                for (U32 c = 0; c < 3; ++c)
+                {
+                    LLVector4a added;
+                    added.setMul(pos[c], factor);
+                    added.add(added_pos[c]);
+                    added_pos[c].setSelectWithMask(add_pos, added, added_pos[c]);
+                }
+            }
+
+            const LLVector4Logical add_scale = mask_and(additive_lanes, scale_lanes);
+            if (add_scale.areAnySet())
+            {
+                new_weight_sum.setAdd(weight, sum_scale);
+                new_weight_sum.setMin(new_weight_sum, one);
+                factor.setSub(new_weight_sum, sum_scale);
+                for (U32 c = 0; c < 3; ++c)
+                {
+                    LLVector4a added;
+                    added.setMul(scale[c], factor);
+                    added.add(added_scale[c]);
+                    added_scale[c].setSelectWithMask(add_scale, added, added_scale[c]);
+                }
+            }
+
+            const LLVector4Logical add_rot = mask_and(additive_lanes, rot_lanes);
+            if (add_rot.areAnySet())
+            {
+                new_weight_sum.setAdd(weight, sum_rot);
+                new_weight_sum.setMin(new_weight_sum, one);
+                factor.setSub(new_weight_sum, sum_rot);
+
+                LLVector4a added[4];
+                quat_nlerp4(factor, added_rot, rot, added);
+                quat_mul4(added, added_rot, added);
+                for (U32 c = 0; c < 4; ++c)
+                {
+                    added_rot[c].setSelectWithMask(add_rot, added[c], added_rot[c]);
+                }
+            }
+        }
+
+        // Regular states, blended with what came before or copied when first
+        {
+            LLVector4a new_weight_sum, u;
+
+            const LLVector4Logical blend_pos = mask_and(blend_lanes, pos_lanes);
+            if (blend_pos.areAnySet())
+            {
+                const LLVector4Logical lerp_pos = mask_and(blend_pos, has_pos);
+                new_weight_sum.setAdd(weight, sum_pos);
+                new_weight_sum.setMin(new_weight_sum, one);
+                u.setDiv(sum_pos, new_weight_sum);
+                for (U32 c = 0; c < 3; ++c)
+                {
+                    // lerp(pos, blended_pos, u)
+                    LLVector4a lerped;
+                    lerped.setSub(blended_pos[c], pos[c]);
+                    lerped.mul(u);
+                    lerped.add(pos[c]);
+                    lerped.setSelectWithMask(lerp_pos, lerped, pos[c]);
+                    blended_pos[c].setSelectWithMask(blend_pos, lerped, blended_pos[c]);
+                }
+                new_weight_sum.setSelectWithMask(lerp_pos, new_weight_sum, weight);
+                sum_pos.setSelectWithMask(blend_pos, new_weight_sum, sum_pos);
+            }
+
+            const LLVector4Logical blend_scale = mask_and(blend_lanes, scale_lanes);
+            if (blend_scale.areAnySet())
+            {
+                const LLVector4Logical lerp_scale = mask_and(blend_scale, has_scale);
+                new_weight_sum.setAdd(weight, sum_scale);
+                new_weight_sum.setMin(new_weight_sum, one);
+                u.setDiv(sum_scale, new_weight_sum);
+                for (U32 c = 0; c < 3; ++c)
+                {
+                    LLVector4a lerped;
+                    lerped.setSub(blended_scale[c], scale[c]);
+                    lerped.mul(u);
+                    lerped.add(scale[c]);
+                    lerped.setSelectWithMask(lerp_scale, lerped, scale[c]);
+                    blended_scale[c].setSelectWithMask(blend_scale, lerped, blended_scale[c]);
+                }
+                new_weight_sum.setSelectWithMask(lerp_scale, new_weight_sum, weight);
+                sum_scale.setSelectWithMask(blend_scale, new_weight_sum, sum_scale);
+            }
+
+            const LLVector4Logical blend_rot = mask_and(blend_lanes, rot_lanes);
+            if (blend_rot.areAnySet())
+            {
+                const LLVector4Logical lerp_rot = mask_and(blend_rot, has_rot);
+                new_weight_sum.setAdd(weight, sum_rot);
+                new_weight_sum.setMin(new_weight_sum, one);
+
+                LLVector4a blended[4];
+                if (lerp_rot.areAnySet())
+                {
+                    u.setDiv(sum_rot, new_weight_sum);
+                    quat_nlerp4(u, rot, blended_rot, blended);
+                }
+                for (U32 c = 0; c < 4; ++c)
+                {
+                    if (lerp_rot.areAnySet())
+                    {
+                        blended[c].setSelectWithMask(lerp_rot, blended[c], rot[c]);
+                    }
+                    else
+                    {
+                        blended[c] = rot[c];
+                    }
+                    blended_rot[c].setSelectWithMask(blend_rot, blended[c], blended_rot[c]);
+                }
+                new_weight_sum.setSelectWithMask(lerp_rot, new_weight_sum, weight);
+                sum_rot.setSelectWithMask(blend_rot, new_weight_sum, sum_rot);
+            }
+
+            // update resulting usage mask
+            has_pos = mask_or(has_pos, blend_pos);
+            has_rot = mask_or(has_rot, blend_rot);
+            has_scale = mask_or(has_scale, blend_scale);
+        }
+    }
+
+    LLVector4a rotation[4];
+    quat_mul4(added_rot, blended_rot, rotation);
+
+    for (U32 lane = 0; lane < count; ++lane)
+    {
+        LLJoint* target_joint = target_joints[lane];
+        if (!target_joint)
+        {
+            continue;
+        }
+
+        LLVector3 added_scale_lane(added_scale[VX][lane], added_scale[VY][lane], added_scale[VZ][lane]);
+        if (!added_scale_lane.isFinite())
+        {
+            added_scale_lane.clearVec();
+        }
+
+        LLVector3 blended_scale_lane(blended_scale[VX][lane], blended_scale[VY][lane], blended_scale[VZ][lane]);
+        if (!blended_scale_lane.isFinite())
+        {
+            blended_scale_lane.setVec(1,1,1);
+        }
+
+        // apply transforms
+        // SL-315
+        target_joint->setPosition(LLVector3(blended_pos[VX][lane] + added_pos[VX][lane],
+                                            blended_pos[VY][lane] + added_pos[VY][lane],
+                                            blended_pos[VZ][lane] + added_pos[VZ][lane]));
+        target_joint->setScale(blended_scale_lane + added_scale_lane);
+        target_joint->setRotation(LLQuaternion(rotation[VX][lane], rotation[VY][lane], rotation[VZ][lane], rotation[VW][lane]));
+
+        if (apply_now)
+        {
+            // now clear joint states
+            blenders[lane]->clear();
+        }
+    }
+}
+// </FS>
+
 //-----------------------------------------------------------------------------
 // interpolate()
 //-----------------------------------------------------------------------------
@@ -476,7 +928,11 @@ bool LLPoseBlender::addMotion(LLMotion* motion)
     {
         LLJoint *jointp = jsp->getJoint();
         LLJointStateBlender* joint_blender;
-        if (mJointStateBlenderPool.find(jointp) == mJointStateBlenderPool.end())
+        // <FS> Vector pose blending
+        //if (mJointStateBlenderPool.find(jointp) == mJointStateBlenderPool.end())
+        blender_map_t::iterator found = mJointStateBlenderPool.find(jointp);
+        if (found == mJointStateBlenderPool.end())
+        // </FS>
         {
             // this is the first time we are animating this joint
             // so create new jointblender and add it to our pool
@@ -485,7 +941,10 @@ bool LLPoseBlender::addMotion(LLMotion* motion)
         }
         else
         {
-            joint_blender = mJointStateBlenderPool[jointp];
+            // <FS> Vector pose blending
+            //joint_blender = mJointStateBlenderPool[jointp];
+            joint_blender = found->second;
+            // </FS>
         }
 
         if (jsp->getPriority() == LLJoint::USE_MOTION_PRIORITY)
@@ -498,10 +957,18 @@ bool LLPoseBlender::addMotion(LLMotion* motion)
         }
 
         // add it to our list of active blenders
-        if (std::find(mActiveBlenders.begin(), mActiveBlenders.end(), joint_blender) == mActiveBlenders.end())
+        // <FS> Vector pose blending
+        //if (std::find(mActiveBlenders.begin(), mActiveBlenders.end(), joint_blender) == mActiveBlenders.end())
+        //{
+        //    mActiveBlenders.push_front(joint_blender);
+        //}
+        // A flag instead of searching the list, which went quadratic in the joints
+        if (!joint_blender->mIsActive)
         {
-            mActiveBlenders.push_front(joint_blender);
+            joint_blender->mIsActive = true;
+            mActiveBlenders.push_back(joint_blender);
         }
+        // </FS>
     }
     return true;
 }
@@ -511,12 +978,34 @@ bool LLPoseBlender::addMotion(LLMotion* motion)
 //-----------------------------------------------------------------------------
 void LLPoseBlender::blendAndApply()
 {
-    for (blender_list_t::iterator iter = mActiveBlenders.begin();
-         iter != mActiveBlenders.end(); )
+    // <FS> Vector pose blending
+    //for (blender_list_t::iterator iter = mActiveBlenders.begin();
+    //     iter != mActiveBlenders.end(); )
+    //{
+    //    LLJointStateBlender* jsbp = *iter++;
+    //    jsbp->blendJointStates();
+    //}
+    const U32 count = (U32)mActiveBlenders.size();
+    if (sVectorBlend)
     {
-        LLJointStateBlender* jsbp = *iter++;
-        jsbp->blendJointStates();
+        for (U32 i = 0; i < count; i += 4)
+        {
+            LLJointStateBlender::blendJointStates4(&mActiveBlenders[i], llmin(count - i, 4U), true);
+        }
+    }
+    else
+    {
+        for (LLJointStateBlender* jsbp : mActiveBlenders)
+        {
+            jsbp->blendJointStates();
+        }
+    }
+
+    for (LLJointStateBlender* jsbp : mActiveBlenders)
+    {
+        jsbp->mIsActive = false;
     }
+    // </FS>
 
     // we're done now so there are no more active blenders for this frame
     mActiveBlenders.clear();
@@ -527,16 +1016,41 @@ void LLPoseBlender::blendAndApply()
 //-----------------------------------------------------------------------------
 void LLPoseBlender::blendAndCache(bool reset_cached_joints)
 {
-    for (blender_list_t::iterator iter = mActiveBlenders.begin();
-         iter != mActiveBlenders.end(); ++iter)
+    // <FS> Vector pose blending
+    //for (blender_list_t::iterator iter = mActiveBlenders.begin();
+    //     iter != mActiveBlenders.end(); ++iter)
+    //{
+    //    LLJointStateBlender* jsbp = *iter;
+    //    if (reset_cached_joints)
+    //    {
+    //        jsbp->resetCachedJoint();
+    //    }
+    //    jsbp->blendJointStates(false);
+    //}
+    const U32 count = (U32)mActiveBlenders.size();
+    if (reset_cached_joints)
     {
-        LLJointStateBlender* jsbp = *iter;
-        if (reset_cached_joints)
+        for (LLJointStateBlender* jsbp : mActiveBlenders)
         {
             jsbp->resetCachedJoint();
         }
-        jsbp->blendJointStates(false);
     }
+
+    if (sVectorBlend)
+    {
+        for (U32 i = 0; i < count; i += 4)
+        {
+            LLJointStateBlender::blendJointStates4(&mActiveBlenders[i], llmin(count - i, 4U), false);
+        }
+    }
+    else
+    {
+        for (LLJointStateBlender* jsbp : mActiveBlenders)
+        {
+            jsbp->blendJointStates(false);
+        }
+    }
+    // </FS>
 }
 
 //-----------------------------------------------------------------------------
@@ -562,6 +1076,7 @@ void LLPoseBlender::clearBlenders()
     {
         LLJointStateBlender* jsbp = *iter;
         jsbp->clear();
+        jsbp->mIsActive = false; // <FS/> Vector pose blending
     }
 
     mActiveBlenders.clear();
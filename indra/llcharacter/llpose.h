@@ -37,6 +37,7 @@
 
 #include <map>
 #include <string>
+#include <vector> // <FS/> Vector pose blending
 
 
 //-----------------------------------------------------------------------------
@@ -97,6 +98,14 @@ public:
     void clear();
     void resetCachedJoint();
 
+    // <FS> Vector pose blending
+    // blendJointStates() of count blenders, up to four, side by side in
+    // SIMD lanes
+    static void blendJointStates4(LLJointStateBlender* const* blenders, U32 count, bool apply_now);
+
+    bool            mIsActive;  // in the active blenders of its LLPoseBlender
+    // </FS>
+
 public:
     LL_ALIGN_16(LLJoint mJointCache);
 } LL_ALIGN_POSTFIX(16);
@@ -106,7 +115,10 @@ class LLMotion;
 class LLPoseBlender
 {
 protected:
-    typedef std::list<LLJointStateBlender*> blender_list_t;
+    // <FS> Vector pose blending
+    //typedef std::list<LLJointStateBlender*> blender_list_t;
+    typedef std::vector<LLJointStateBlender*> blender_list_t;
+    // </FS>
     typedef std::map<LLJoint*,LLJointStateBlender*> blender_map_t;
     blender_map_t mJointStateBlenderPool;
     blender_list_t mActiveBlenders;
@@ -135,6 +147,11 @@ public:
     void interpolate(F32 u);
 
     LLPose* getBlendedPose() { return &mBlendedPose; }
+
+    // <FS> Vector pose blending
+    // Blend four joints at a time in SIMD lanes instead of one by one
+    static bool sVectorBlend;
+    // </FS>
 };
 
 #endif // LL_LLPOSE_H
@@ -344,6 +344,8 @@ void LLApp::setErrorHandler(LLAppErrorHandler handler)
 // static
 void LLApp::runErrorHandler()
 {
+    LLError::flushLogs(); // <FS/> Async logging
+
     if (LLApp::sErrorHandler)
     {
         LLApp::sErrorHandler();
@@ -61,6 +61,114 @@
 #include <excpt.h>
 #endif
 
+// <FS> Pooled coroutine stacks
+#include <map>
+#include <mutex>
+
+namespace
+{
+
+// Keeps the stacks of finished coroutines for the next launch asking for
+// the same size, which saves mapping, guarding and unmapping a stack for
+// every launch. Shared by all threads.
+class LLCoroStackPool
+{
+public:
+    static constexpr size_t MAX_FREE_PER_SIZE = 32;
+
+    // Never destroyed: coroutines may still end during static destruction
+    static LLCoroStackPool& instance()
+    {
+        static LLCoroStackPool* sPool = new LLCoroStackPool;
+        return *sPool;
+    }
+
+    boost::context::stack_context allocate(size_t size)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            std::vector<boost::context::stack_context>& stacks = mFree[size];
+            if (!stacks.empty())
+            {
+                boost::context::stack_context sctx = stacks.back();
+                stacks.pop_back();
+                ++mReused;
+                return sctx;
+            }
+            ++mAllocated;
+        }
+        // protected_fixedsize_stack puts a guard page past the end of the
+        // stack; pooled stacks keep it.
+        return boost::fibers::protected_fixedsize_stack(size).allocate();
+    }
+
+    void deallocate(size_t size, boost::context::stack_context& sctx) noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            std::vector<boost::context::stack_context>& stacks = mFree[size];
+            if (stacks.size() < MAX_FREE_PER_SIZE)
+            {
+                if (stacks.capacity() < MAX_FREE_PER_SIZE)
+                {
+                    try
+                    {
+                        stacks.reserve(MAX_FREE_PER_SIZE);
+                    }
+                    catch (const std::bad_alloc&)
+                    {
+                    }
+                }
+                if (stacks.size() < stacks.capacity())
+                {
+                    stacks.push_back(sctx);
+                    return;
+                }
+            }
+        }
+        // the size does not matter for freeing, sctx knows it
+        boost::fibers::protected_fixedsize_stack(size).deallocate(sctx);
+    }
+
+    void getCounts(U64& allocated, U64& reused)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        allocated = mAllocated;
+        reused = mReused;
+    }
+
+private:
+    std::mutex mMutex;
+    std::map<size_t, std::vector<boost::context::stack_context>> mFree;
+    U64 mAllocated = 0;
+    U64 mReused = 0;
+};
+
+// StackAllocator for boost::fibers::fiber on top of LLCoroStackPool
+class LLCoroPooledStack
+{
+public:
+    LLCoroPooledStack(size_t size):
+        mSize(size)
+    {}
+
+    boost::context::stack_context allocate()
+    {
+        return LLCoroStackPool::instance().allocate(mSize);
+    }
+
+    void deallocate(boost::context::stack_context& sctx) noexcept
+    {
+        LLCoroStackPool::instance().deallocate(mSize, sctx);
+    }
+
+private:
+    size_t mSize;
+};
+
+} // anonymous namespace
+// </FS>
+
 // static
 bool LLCoros::on_main_coro()
 {
@@ -157,6 +265,11 @@ void LLCoros::cleanupSingleton()
     // origin singletons, so clean coros before deleting those
 
     printActiveCoroutines("at entry to ~LLCoros()");
+    // <FS> Pooled coroutine stacks
+    U64 allocated, reused;
+    LLCoroStackPool::instance().getCounts(allocated, reused);
+    LL_INFOS("LLCoros") << "Coroutine stacks: " << allocated << " allocated, " << reused << " reused" << LL_ENDL;
+    // </FS>
     // Other LLApp status-change listeners do things like close
     // work queues and inject the Stop exception into pending
     // promises, to force coroutines waiting on those things to
@@ -269,7 +382,10 @@ void LLCoros::printActiveCoroutines(const std::string& when)
     }
 }
 
-std::string LLCoros::launch(const std::string& prefix, const callable_t& callable)
+// <FS> Pooled coroutine stacks
+//std::string LLCoros::launch(const std::string& prefix, const callable_t& callable)
+std::string LLCoros::launch(const std::string& prefix, const callable_t& callable, StackSize stack_size)
+// </FS>
 {
     std::string name(generateDistinctName(prefix));
     // 'dispatch' means: enter the new fiber immediately, returning here only
@@ -280,12 +396,21 @@ std::string LLCoros::launch(const std::string& prefix, const callable_t& callabl
     // stack so that stack underflow will result in an access violation
     // instead of weird, subtle, possibly undiagnosed memory stomps.
 
+    // <FS> Pooled coroutine stacks
+    size_t size = (stack_size == STACK_SMALL) ? mStackSize / 2 : mStackSize;
+    // </FS>
     try
     {
+        // <FS> Pooled coroutine stacks
+        //boost::fibers::fiber newCoro(boost::fibers::launch::dispatch,
+        //    std::allocator_arg,
+        //    boost::fibers::protected_fixedsize_stack(mStackSize),
+        //    [this, &name, &callable]() { toplevel(name, callable); });
         boost::fibers::fiber newCoro(boost::fibers::launch::dispatch,
             std::allocator_arg,
-            boost::fibers::protected_fixedsize_stack(mStackSize),
+            LLCoroPooledStack(size),
             [this, &name, &callable]() { toplevel(name, callable); });
+        // </FS>
 
         // You have two choices with a fiber instance: you can join() it or you
         // can detach() it. If you try to destroy the instance before doing
@@ -150,8 +150,23 @@ public:
      * existing coroutine instance, creates the coroutine instance, registers
      * it with the tweaked name and runs it until its first wait. At that
      * point it returns the tweaked name.
+     *
+     * <FS> Pooled coroutine stacks
+     * Stacks come from a pool and go back to it when the coroutine ends.
+     * Pass STACK_SMALL for short-lived coroutines that don't recurse
+     * deeply, e.g. one-off HTTP requests; it gets half the configured
+     * stack size.
+     * </FS>
      */
-    std::string launch(const std::string& prefix, const callable_t& callable);
+    // <FS> Pooled coroutine stacks
+    enum StackSize
+    {
+        STACK_DEFAULT,
+        STACK_SMALL
+    };
+    //std::string launch(const std::string& prefix, const callable_t& callable);
+    std::string launch(const std::string& prefix, const callable_t& callable, StackSize stack_size = STACK_DEFAULT);
+    // </FS>
 
     /**
      * Abort a running coroutine by name. Normally, when a coroutine either
@@ -56,6 +56,13 @@
 #include "llstl.h"
 #include "lltimer.h"
 #include "llprofiler.h"
+// <FS> Async logging
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+// </FS>
 
 // On Mac, got:
 // #error "Boost.Stacktrace requires `_Unwind_Backtrace` function. Define
@@ -130,8 +137,15 @@ namespace {
     class RecordToFile : public LLError::Recorder
     {
     public:
-        RecordToFile(const std::string& filename):
-            mName(filename)
+        // <FS> Async logging
+        //RecordToFile(const std::string& filename):
+        //    mName(filename)
+        RecordToFile(const std::string& filename, bool async):
+            mName(filename),
+            mHead(0),
+            mTail(0),
+            mRunning(false)
+        // </FS>
         {
             // <FS:Ansariel> Don't screw up log file output
             this->showMultiline(true);
@@ -146,11 +160,31 @@ namespace {
                 {
                     mFile.sync_with_stdio(false);
                 }
+                // <FS> Async logging
+                if (async)
+                {
+                    mRing.reset(new char[RING_SIZE]);
+                    mRunning = true;
+                    mWriter = std::thread([this]() { writerLoop(); });
+                    sActive = this;
+                }
+                // </FS>
             }
         }
 
         ~RecordToFile()
         {
+            // <FS> Async logging
+            if (mWriter.joinable())
+            {
+                RecordToFile* self = this;
+                sActive.compare_exchange_strong(self, nullptr);
+                mRunning = false;
+                mWake.notify_one();
+                mWriter.join();
+                flush();
+            }
+            // </FS>
             mFile.close();
         }
 
@@ -171,6 +205,14 @@ namespace {
                                     const std::string& message) override
         {
             LL_PROFILE_ZONE_SCOPED_CATEGORY_LOGGING;
+            // <FS> Async logging
+            if (mRing)
+            {
+                push(message.data(), message.size());
+                push("\n", 1);
+                return;
+            }
+            // </FS>
             if (LLError::getAlwaysFlush())
             {
                 mFile << message << std::endl;
@@ -181,11 +223,113 @@ namespace {
             }
         }
 
+        // <FS> Async logging
+        // Writes out everything recorded so far, from any thread. Gives up
+        // after a while when the writer thread doesn't let go of the file,
+        // it may be the one that crashed.
+        void flush()
+        {
+            std::unique_lock<std::timed_mutex> lock(mDrainMutex, std::chrono::milliseconds(500));
+            if (lock)
+            {
+                drain();
+            }
+        }
+
+        // The recorder writing asynchronously, if any
+        static std::atomic<RecordToFile*> sActive;
+        // </FS>
+
     private:
+        // <FS> Async logging
+        // Messages go into a byte ring and a writer thread appends them to
+        // the file, so logging threads never wait for the disk. Recorders
+        // are called under the recorder mutex, which makes the ring single
+        // producer. The consumer side runs under mDrainMutex, either on the
+        // writer thread or in flush().
+        static constexpr size_t RING_SIZE = 1024 * 1024; // Power of two
+        static constexpr auto WRITE_INTERVAL = std::chrono::milliseconds(100);
+
+        void push(const char* data, size_t size)
+        {
+            while (size)
+            {
+                const size_t head = mHead.load(std::memory_order_relaxed);
+                const size_t space = RING_SIZE - (head - mTail.load(std::memory_order_acquire));
+                if (!space)
+                {
+                    // The disk can't keep up, wait for the writer rather
+                    // than dropping messages
+                    mWake.notify_one();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    continue;
+                }
+
+                const size_t count = llmin(size, space);
+                const size_t pos = head & (RING_SIZE - 1);
+                const size_t first = llmin(count, RING_SIZE - pos);
+                memcpy(&mRing[pos], data, first);
+                memcpy(&mRing[0], data + first, count - first);
+                mHead.store(head + count, std::memory_order_release);
+                data += count;
+                size -= count;
+
+                if (head + count - mTail.load(std::memory_order_relaxed) > RING_SIZE / 2)
+                {
+                    mWake.notify_one();
+                }
+            }
+        }
+
+        void drain()
+        {
+            const size_t tail = mTail.load(std::memory_order_relaxed);
+            const size_t head = mHead.load(std::memory_order_acquire);
+            if (head == tail)
+            {
+                return;
+            }
+
+            const size_t pos = tail & (RING_SIZE - 1);
+            const size_t first = llmin(head - tail, RING_SIZE - pos);
+            mFile.write(&mRing[pos], first);
+            mFile.write(&mRing[0], head - tail - first);
+            mFile.flush();
+            mTail.store(head, std::memory_order_release);
+        }
+
+        void writerLoop()
+        {
+            LL_PROFILER_SET_THREAD_NAME("Log writer");
+            while (mRunning)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mWakeMutex);
+                    mWake.wait_for(lock, WRITE_INTERVAL);
+                }
+                std::lock_guard<std::timed_mutex> lock(mDrainMutex);
+                drain();
+            }
+        }
+        // </FS>
+
         const std::string mName;
         llofstream mFile;
+
+        // <FS> Async logging
+        std::unique_ptr<char[]>     mRing;
+        std::atomic<size_t>         mHead;  // Next byte to write, only advanced by the producer
+        std::atomic<size_t>         mTail;  // Next byte to read, only advanced by the consumer
+        std::timed_mutex            mDrainMutex;
+        std::mutex                  mWakeMutex;
+        std::condition_variable     mWake;
+        std::atomic<bool>           mRunning;
+        std::thread                 mWriter;
+        // </FS>
     };
 
+    std::atomic<RecordToFile*> RecordToFile::sActive{ nullptr }; // <FS/> Async logging
+
 
     class RecordToStderr : public LLError::Recorder
     {
@@ -499,6 +643,7 @@ namespace
         LLError::ELevel                     mDefaultLevel;
 
         bool                                mLogAlwaysFlush;
+        bool                                mLogAsync; // <FS/> Async logging
 
         U32                                 mEnabledLogTypesMask;
 
@@ -526,6 +671,7 @@ namespace
         : LLRefCount(),
         mDefaultLevel(LLError::LEVEL_DEBUG),
         mLogAlwaysFlush(true),
+        mLogAsync(false), // <FS/> Async logging
         mEnabledLogTypesMask(255),
         mFunctionLevelMap(),
         mClassLevelMap(),
@@ -840,6 +986,20 @@ namespace LLError
         return s->mLogAlwaysFlush;
     }
 
+    // <FS> Async logging
+    void setAsyncLogging(bool async)
+    {
+        SettingsConfigPtr s = Globals::getInstance()->getSettingsConfig();
+        s->mLogAsync = async;
+    }
+
+    bool getAsyncLogging()
+    {
+        SettingsConfigPtr s = Globals::getInstance()->getSettingsConfig();
+        return s->mLogAsync;
+    }
+    // </FS>
+
     void setEnabledLogTypesMask(U32 mask)
     {
         SettingsConfigPtr s = Globals::getInstance()->getSettingsConfig();
@@ -940,6 +1100,12 @@ namespace LLError
         {
             setAlwaysFlush(config["log-always-flush"]);
         }
+        // <FS> Async logging
+        if (config.has("log-async"))
+        {
+            setAsyncLogging(config["log-async"]);
+        }
+        // </FS>
         if (config.has("enabled-log-types-mask"))
         {
             setEnabledLogTypesMask(config["enabled-log-types-mask"].asInteger());
@@ -1145,7 +1311,10 @@ namespace LLError
 
         if (!file_name.empty())
         {
-            std::shared_ptr<RecordToFile> recordToFile(new RecordToFile(file_name));
+            // <FS> Async logging
+            //std::shared_ptr<RecordToFile> recordToFile(new RecordToFile(file_name));
+            std::shared_ptr<RecordToFile> recordToFile(new RecordToFile(file_name, getAsyncLogging()));
+            // </FS>
             if (recordToFile->okay())
             {
                 addRecorder(recordToFile);
@@ -1159,6 +1328,17 @@ namespace LLError
         return found? found->getFilename() : std::string();
     }
 
+    // <FS> Async logging
+    void flushLogs()
+    {
+        // Not through the recorder list, whoever crashed may hold its lock
+        if (RecordToFile* recorder = RecordToFile::sActive.load())
+        {
+            recorder->flush();
+        }
+    }
+    // </FS>
+
     void logToStderr()
     {
         if (! findRecorder<RecordToStderr>())
@@ -1450,6 +1630,7 @@ namespace LLError
         if (site.mLevel == LEVEL_ERROR)
         {
             g->mFatalMessage = message;
+            flushLogs(); // <FS/> Async logging
             if (s->mCrashFunction)
             {
                 s->mCrashFunction(message);
@@ -75,6 +75,12 @@ namespace LLError
     LL_COMMON_API ELevel getDefaultLevel();
     LL_COMMON_API void setAlwaysFlush(bool flush);
     LL_COMMON_API bool getAlwaysFlush();
+    // <FS> Async logging
+    // Whether log files opened from now on are written by a background
+    // thread, see flushLogs()
+    LL_COMMON_API void setAsyncLogging(bool async);
+    LL_COMMON_API bool getAsyncLogging();
+    // </FS>
     LL_COMMON_API void setEnabledLogTypesMask(U32 mask);
     LL_COMMON_API U32 getEnabledLogTypesMask();
     LL_COMMON_API void setFunctionLevel(const std::string& function_name, LLError::ELevel);
@@ -226,6 +232,9 @@ namespace LLError
         // Passing the empty string or NULL to just removes any prior.
     LL_COMMON_API std::string logFileName();
         // returns name of current logging file, empty string if none
+    LL_COMMON_API void flushLogs(); // <FS/> Async logging
+        // writes out what an asynchronous log file has queued, safe to
+        // call from crash handlers
 
 
     /*
@@ -35,7 +35,14 @@
 #include <intrin.h>
 #endif
 
+// <FS> Block timers are not recorded in essential only builds
+//#define LL_FAST_TIMER_ON 1
+#if LL_TRACE_ESSENTIAL_ONLY
+#define LL_FAST_TIMER_ON 0
+#else
 #define LL_FAST_TIMER_ON 1
+#endif
+// </FS>
 #define LL_FASTTIMER_USE_RDTSC 1
 
 // NOTE: Also see llprofiler.h
@@ -0,0 +1,257 @@
+/**
+ * @file llframepump.h
+ * @brief Lightweight pump for per-frame notifications
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFRAMEPUMP_H
+#define LL_LLFRAMEPUMP_H
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern LL_COMMON_API bool on_main_thread();
+
+// A pump for notifications posted every frame, where LLEventPump costs
+// more than the listeners do. Listeners live in a flat vector and are
+// called in the order they were added, with a typed payload instead of an
+// LLSD. There is no dependency sorting and no stopping propagation.
+//
+// Everything happens on the main thread, which is what saves the locking.
+// Listeners added while a post() is running are called from the next one,
+// listeners disconnected while it runs are not called again.
+template <typename PAYLOAD>
+class LLFramePump
+{
+    struct State;
+
+public:
+    typedef std::function<void(const PAYLOAD&)> listener_t;
+
+    class Connection
+    {
+    public:
+        Connection() = default;
+
+        void disconnect();
+        bool connected() const;
+
+    private:
+        friend class LLFramePump;
+        Connection(const std::shared_ptr<State>& state, U32 id) : mState(state), mID(id) {}
+
+        std::weak_ptr<State>    mState;
+        U32                     mID = 0;
+    };
+
+    // Disconnects when it goes away, like LLTempBoundListener
+    class TempConnection : public Connection
+    {
+    public:
+        TempConnection() = default;
+        TempConnection(const Connection& connection) : Connection(connection) {}
+        ~TempConnection() { this->disconnect(); }
+
+        TempConnection& operator=(const Connection& connection)
+        {
+            this->disconnect();
+            Connection::operator=(connection);
+            return *this;
+        }
+
+        TempConnection(const TempConnection&) = delete;
+        TempConnection& operator=(const TempConnection&) = delete;
+    };
+
+    LLFramePump(const std::string& name) :
+        mName(name),
+        mState(std::make_shared<State>())
+    {
+    }
+
+    const std::string& getName() const { return mName; }
+
+    // The name is only used for logging
+    Connection listen(const std::string& name, const listener_t& listener);
+
+    void post(const PAYLOAD& payload);
+
+    // Listeners added outside of a post() so far
+    size_t size() const { return mState->mListeners.size(); }
+
+private:
+    struct Listener
+    {
+        U32         mID;    // 0 once disconnected
+        std::string mName;
+        listener_t  mFunc;
+    };
+
+    struct State
+    {
+        std::vector<Listener>   mListeners;
+        std::vector<Listener>   mAdded;         // During a post()
+        bool                    mDispatching = false;
+        bool                    mRemoved = false;
+        U32                     mNextID = 1;
+
+        void remove(U32 id);
+        void finishDispatch();
+    };
+
+    std::string             mName;
+    std::shared_ptr<State>  mState;
+};
+
+template <typename PAYLOAD>
+void LLFramePump<PAYLOAD>::Connection::disconnect()
+{
+    if (std::shared_ptr<State> state = mState.lock())
+    {
+        state->remove(mID);
+    }
+    mState.reset();
+    mID = 0;
+}
+
+template <typename PAYLOAD>
+bool LLFramePump<PAYLOAD>::Connection::connected() const
+{
+    return mID != 0 && !mState.expired();
+}
+
+template <typename PAYLOAD>
+typename LLFramePump<PAYLOAD>::Connection LLFramePump<PAYLOAD>::listen(const std::string& name, const listener_t& listener)
+{
+    llassert(on_main_thread());
+
+    const U32 id = mState->mNextID++;
+    if (mState->mDispatching)
+    {
+        // Don't move the vector under the running post()
+        mState->mAdded.push_back({ id, name, listener });
+    }
+    else
+    {
+        mState->mListeners.push_back({ id, name, listener });
+    }
+    return Connection(mState, id);
+}
+
+template <typename PAYLOAD>
+void LLFramePump<PAYLOAD>::post(const PAYLOAD& payload)
+{
+    llassert(on_main_thread());
+    llassert(!mState->mDispatching);
+
+    // Keep the state alive while listeners run, one of them may destroy
+    // the pump
+    std::shared_ptr<State> state(mState);
+    state->mDispatching = true;
+    try
+    {
+        for (const Listener& listener : state->mListeners)
+        {
+            if (listener.mID)
+            {
+                listener.mFunc(payload);
+            }
+        }
+    }
+    catch (...)
+    {
+        state->finishDispatch();
+        throw;
+    }
+    state->finishDispatch();
+}
+
+template <typename PAYLOAD>
+void LLFramePump<PAYLOAD>::State::remove(U32 id)
+{
+    llassert(on_main_thread());
+
+    auto find = [id](const Listener& listener) { return listener.mID == id; };
+    auto it = std::find_if(mListeners.begin(), mListeners.end(), find);
+    if (it != mListeners.end())
+    {
+        if (mDispatching)
+        {
+            // Might be the listener that is running, only mark it
+            it->mID = 0;
+            mRemoved = true;
+        }
+        else
+        {
+            mListeners.erase(it);
+        }
+        return;
+    }
+
+    it = std::find_if(mAdded.begin(), mAdded.end(), find);
+    if (it != mAdded.end())
+    {
+        mAdded.erase(it);
+    }
+}
+
+template <typename PAYLOAD>
+void LLFramePump<PAYLOAD>::State::finishDispatch()
+{
+    mDispatching = false;
+    if (mRemoved)
+    {
+        mListeners.erase(std::remove_if(mListeners.begin(), mListeners.end(), [](const Listener& listener) { return listener.mID == 0; }),
+                         mListeners.end());
+        mRemoved = false;
+    }
+    for (Listener& listener : mAdded)
+    {
+        mListeners.push_back(std::move(listener));
+    }
+    mAdded.clear();
+}
+
+// Payload of the frame pump
+struct LLFrameTick
+{
+    U32 mFrame = 0;
+};
+
+// Posted once per frame by the main loop, right before the "mainloop"
+// LLEventPump. Listeners that only want to be called every frame should
+// use it, "mainloop" stays for coroutines, LEAP and listeners that want
+// its LLSD.
+class LL_COMMON_API LLFrameTickPump : public LLFramePump<LLFrameTick>
+{
+public:
+    static LLFrameTickPump& instance();
+
+private:
+    LLFrameTickPump();
+};
+
+#endif // LL_LLFRAMEPUMP_H
@@ -0,0 +1,148 @@
+/**
+ * @file llinterntable.cpp
+ * @brief Sharded string intern table with lock-free lookups
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llinterntable.h"
+
+#include <functional>
+
+LLInternTable::Slots::Slots(U32 capacity) :
+    mMask(capacity - 1),
+    mSlots(new std::atomic<const Entry*>[capacity])
+{
+    for (U32 i = 0; i < capacity; ++i)
+    {
+        mSlots[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+LLInternTable::LLInternTable(U32 shard_capacity) :
+    mNextId(1)
+{
+    U32 capacity = 8;
+    while (capacity < shard_capacity)
+    {
+        capacity <<= 1;
+    }
+
+    for (Shard& shard : mShards)
+    {
+        shard.mTables.push_back(std::make_unique<Slots>(capacity));
+        shard.mCurrent.store(shard.mTables.back().get(), std::memory_order_release);
+    }
+}
+
+LLInternTable::~LLInternTable()
+{
+}
+
+// static
+U64 LLInternTable::hash(std::string_view str)
+{
+    // The shard comes from the top bits and the slot from the bottom ones,
+    // mix so both are worth using whatever std::hash does
+    U64 h = (U64)std::hash<std::string_view>()(str);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// static
+const LLInternTable::Entry* LLInternTable::probe(const Slots* slots, const Key& key)
+{
+    for (U32 i = (U32)key.mHash & slots->mMask; ; i = (i + 1) & slots->mMask)
+    {
+        const Entry* entry = slots->mSlots[i].load(std::memory_order_acquire);
+        if (!entry)
+        {
+            return nullptr;
+        }
+        if (entry->mHash == key.mHash && entry->mString == key.mString)
+        {
+            return entry;
+        }
+    }
+}
+
+// static
+void LLInternTable::insert(Slots* slots, const Entry* entry)
+{
+    U32 i = (U32)entry->mHash & slots->mMask;
+    while (slots->mSlots[i].load(std::memory_order_relaxed))
+    {
+        i = (i + 1) & slots->mMask;
+    }
+    // Publishes the entry, pairs with the acquire of probe()
+    slots->mSlots[i].store(entry, std::memory_order_release);
+}
+
+const LLInternTable::Entry* LLInternTable::find(const Key& key) const
+{
+    const Shard& shard = getShard(key.mHash);
+    return probe(shard.mCurrent.load(std::memory_order_acquire), key);
+}
+
+const LLInternTable::Entry* LLInternTable::intern(const Key& key)
+{
+    Shard& shard = getShard(key.mHash);
+    if (const Entry* entry = probe(shard.mCurrent.load(std::memory_order_acquire), key))
+    {
+        return entry;
+    }
+
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+    // Somebody may have added it meanwhile
+    Slots* slots = shard.mCurrent.load(std::memory_order_relaxed);
+    if (const Entry* entry = probe(slots, key))
+    {
+        return entry;
+    }
+
+    // At most half full, so probes stay short and always end
+    if ((shard.mEntries.size() + 1) * 2 > (size_t)slots->mMask + 1)
+    {
+        shard.mTables.push_back(std::make_unique<Slots>((slots->mMask + 1) * 2));
+        Slots* grown = shard.mTables.back().get();
+        for (const auto& entry : shard.mEntries)
+        {
+            insert(grown, entry.get());
+        }
+        shard.mCurrent.store(grown, std::memory_order_release);
+        slots = grown;
+    }
+
+    shard.mEntries.push_back(std::make_unique<Entry>());
+    Entry* entry = shard.mEntries.back().get();
+    entry->mHash = key.mHash;
+    entry->mId = mNextId.fetch_add(1, std::memory_order_relaxed);
+    entry->mString.assign(key.mString.data(), key.mString.size());
+    insert(slots, entry);
+    return entry;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file llinterntable.h
+ * @brief Sharded string intern table with lock-free lookups
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINTERNTABLE_H
+#define LL_LLINTERNTABLE_H
+
+#include "stdtypes.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Interns strings: the same text always gives back the same Entry, which
+// stays put for the lifetime of the table, with a small id that is unique
+// within the table. Strings are never removed.
+//
+// The table is split into SHARD_COUNT shards by the top bits of the hash.
+// Each shard is an open addressing array of entry pointers. Looking up a
+// string that is there takes no lock; adding one locks its shard only.
+// A shard that fills up gets a new array twice the size, the old one is
+// kept until the table goes away since readers may still be probing it.
+//
+// Names that are looked up again and again can be hashed once into a Key.
+class LL_COMMON_API LLInternTable
+{
+public:
+    static constexpr U32 SHARD_BITS = 4;
+    static constexpr U32 SHARD_COUNT = 1 << SHARD_BITS;
+
+    struct Entry
+    {
+        U64         mHash;
+        U32         mId;    // from 1 up, in the order of interning
+        std::string mString;
+    };
+
+    class Key
+    {
+    public:
+        Key(std::string_view str) : mString(str), mHash(LLInternTable::hash(str)) {}
+        Key(const std::string& str) : Key(std::string_view(str)) {}
+        Key(const char* str) : Key(std::string_view(str)) {}
+
+        std::string_view    mString;
+        U64                 mHash;
+    };
+
+    // shard_capacity is the initial number of slots of each shard
+    LLInternTable(U32 shard_capacity = 64);
+    ~LLInternTable();
+
+    // Threads:  any
+    // The entry for key, nullptr if it hasn't been interned. Takes no lock.
+    const Entry* find(const Key& key) const;
+
+    // Threads:  any
+    // The entry for key, added if need be. Takes no lock when it is there.
+    const Entry* intern(const Key& key);
+
+    // Threads:  any
+    U32 size() const { return mNextId.load(std::memory_order_relaxed) - 1; }
+
+    static U64 hash(std::string_view str);
+
+private:
+    struct Slots
+    {
+        Slots(U32 capacity);
+
+        U32                                 mMask;
+        std::unique_ptr<std::atomic<const Entry*>[]> mSlots;
+    };
+
+    // Own cache line each, so adding to one doesn't slow the lookups of
+    // its neighbours
+    struct alignas(64) Shard
+    {
+        std::atomic<Slots*>                 mCurrent{ nullptr };
+        std::mutex                          mMutex;
+        // Both under mMutex
+        std::vector<std::unique_ptr<Slots>> mTables;        // current one last
+        std::vector<std::unique_ptr<Entry>> mEntries;
+    };
+
+    static const Entry* probe(const Slots* slots, const Key& key);
+    static void insert(Slots* slots, const Entry* entry);
+
+    Shard& getShard(U64 hash) const { return mShards[hash >> (64 - SHARD_BITS)]; }
+
+    mutable Shard       mShards[SHARD_COUNT];
+    std::atomic<U32>    mNextId;
+
+    LLInternTable(const LLInternTable&) = delete;
+    LLInternTable& operator=(const LLInternTable&) = delete;
+};
+
+#endif // LL_LLINTERNTABLE_H
@@ -17,6 +17,15 @@
 // std headers
 // external library headers
 // other Linden headers
+#include "workqueue.h"              // <FS/> Batched dispatch
 
-// This file is required by our CMake integration-test machinery. It
-// contributes no code to the viewer executable.
+// <FS> Batched dispatch
+//// This file is required by our CMake integration-test machinery. It
+//// contributes no code to the viewer executable.
+// static
+bool LLMainThreadTask::postToMainLoop(const std::function<void()>& work)
+{
+    auto queue = LL::WorkQueue::getInstance("mainloop");
+    return queue && queue->post(work);
+}
+// </FS>
@@ -16,7 +16,9 @@
 #include "lleventtimer.h"
 #include "llthread.h"
 #include "llmake.h"
+#include <functional>               // <FS/> Batched dispatch
 #include <future>
+#include <memory>                   // <FS/> Batched dispatch
 #include <type_traits>              // std::result_of
 
 /**
@@ -40,6 +42,11 @@
  * will fulfill a future with its result. Meanwhile the requesting thread
  * blocks on that future. As soon as it is set, the requesting thread wakes up
  * with the task result.
+ *
+ * <FS> Batched dispatch: once the viewer's "mainloop" WorkQueue exists, the
+ * task is posted to it instead, so the main thread picks up pending tasks in
+ * batches along with the rest of its queued work. The LLEventTimer remains
+ * for when there is no such queue, e.g. early on or in tests. </FS>
  */
 class LLMainThreadTask
 {
@@ -59,25 +66,53 @@ public:
         }
         else
         {
-            // It's essential to construct LLEventTimer subclass instances on
-            // the heap because, on completion, LLEventTimer deletes them.
-            // Once we enable C++17, we can use Class Template Argument
-            // Deduction. Until then, use llmake_heap().
-            auto* task = llmake_heap<Task>(std::forward<CALLABLE>(callable));
-            auto future = task->mTask.get_future();
+            // <FS> Batched dispatch
+            //// It's essential to construct LLEventTimer subclass instances on
+            //// the heap because, on completion, LLEventTimer deletes them.
+            //// Once we enable C++17, we can use Class Template Argument
+            //// Deduction. Until then, use llmake_heap().
+            //auto* task = llmake_heap<Task>(std::forward<CALLABLE>(callable));
+            //auto future = task->mTask.get_future();
+            // Given arbitrary CALLABLE, which might be a lambda, how are we
+            // supposed to obtain its signature for std::packaged_task? It seems
+            // redundant to have to add an argument list to engage invoke_result_t, then
+            // add the argument list again to complete the signature. At least we
+            // only support a nullary CALLABLE.
+            auto task = std::make_shared<std::packaged_task<std::invoke_result_t<CALLABLE>()>>(
+                std::forward<CALLABLE>(callable));
+            auto future = task->get_future();
+            std::function<void()> work([task]() { (*task)(); });
+            if (! postToMainLoop(work))
+            {
+                // It's essential to construct LLEventTimer subclass instances
+                // on the heap because, on completion, LLEventTimer deletes them.
+                new Task(std::move(work));
+            }
+            // </FS>
             // Now simply block on the future.
             return future.get();
         }
     }
 
 private:
-    template <typename CALLABLE>
+    // <FS> Batched dispatch
+    // Post work to the "mainloop" WorkQueue, false if there is none
+    LL_COMMON_API static bool postToMainLoop(const std::function<void()>& work);
+    // </FS>
+
+    // <FS> Batched dispatch: the task is type erased, the future stays with
+    // dispatch()
+    //template <typename CALLABLE>
+    // </FS>
     struct Task: public LLEventTimer
     {
-        Task(CALLABLE&& callable):
+        // <FS> Batched dispatch
+        //Task(CALLABLE&& callable):
+        Task(std::function<void()>&& work):
+        // </FS>
             // no wait time: call tick() next chance we get
             LLEventTimer(0),
-            mTask(std::forward<CALLABLE>(callable))
+            mTask(std::move(work)) // <FS/> Batched dispatch
         {}
         bool tick() override
         {
@@ -87,12 +122,10 @@ private:
             // tell LLEventTimer we're done (one shot)
             return true;
         }
-        // Given arbitrary CALLABLE, which might be a lambda, how are we
-        // supposed to obtain its signature for std::packaged_task? It seems
-        // redundant to have to add an argument list to engage invoke_result_t, then
-        // add the argument list again to complete the signature. At least we
-        // only support a nullary CALLABLE.
-        std::packaged_task<std::invoke_result_t<CALLABLE>()> mTask;
+        // <FS> Batched dispatch
+        //std::packaged_task<std::invoke_result_t<CALLABLE>()> mTask;
+        std::function<void()> mTask;
+        // </FS>
     };
 };
 
@@ -48,6 +48,9 @@
 #include "llframetimer.h"
 #include "lltrace.h"
 #include "llerror.h"
+// <FS> Memory accounting
+#include <vector>
+// </FS>
 //----------------------------------------------------------------------------
 
 //static
@@ -349,3 +352,165 @@ void ll_aligned_free_fallback( void* ptr )
 }
 
 #endif
+
+// <FS> Memory accounting
+//--------------------------------------------------------------------
+// LLMemAccounting
+
+namespace
+{
+    // Also the names of the profiler pools and plots, which have to stay
+    // valid for the whole run
+    const char* MEM_TAG_NAMES[] =
+    {
+        "Mem Textures",
+        "Mem Mesh",
+        "Mem LLSD",
+        "Mem UI",
+        "Mem Inventory",
+        "Mem Objects",
+        "Mem Audio",
+        "Mem Frame"
+    };
+    static_assert(LL_ARRAY_SIZE(MEM_TAG_NAMES) == (size_t)LLMemTag::COUNT, "MEM_TAG_NAMES out of sync with LLMemTag");
+}
+
+LLMemAccounting::Counter LLMemAccounting::sCounters[(size_t)LLMemTag::COUNT];
+
+// static
+const char* LLMemAccounting::getName(LLMemTag tag)
+{
+    return (tag < LLMemTag::COUNT) ? MEM_TAG_NAMES[(size_t)tag] : "Mem Unknown";
+}
+
+// static
+void LLMemAccounting::plot()
+{
+    for (size_t i = 0; i < (size_t)LLMemTag::COUNT; ++i)
+    {
+        LL_PROFILE_PLOT(MEM_TAG_NAMES[i], (int64_t)sCounters[i].mBytes.load(std::memory_order_relaxed));
+    }
+}
+
+//--------------------------------------------------------------------
+// LLFrameArena
+
+namespace
+{
+    struct FrameChunk
+    {
+        U8*     mData;
+        size_t  mSize;
+    };
+
+    struct FrameArenaState
+    {
+        std::vector<FrameChunk> mChunks;    // CHUNK_SIZE each, kept across frames
+        std::vector<FrameChunk> mOversized; // Released on reset
+        size_t  mCurrent = 0;               // Chunk allocated from
+        size_t  mOffset = 0;                // In the current chunk
+        size_t  mUsed = 0;
+        size_t  mHighWater = 0;
+
+        ~FrameArenaState()
+        {
+            for (const FrameChunk& chunk : mChunks)
+            {
+                ll_aligned_free_16(chunk.mData);
+            }
+            for (const FrameChunk& chunk : mOversized)
+            {
+                ll_aligned_free_16(chunk.mData);
+            }
+        }
+    };
+
+    FrameArenaState& frame_arena()
+    {
+        static FrameArenaState sState;
+        return sState;
+    }
+
+    FrameChunk frame_chunk_alloc(size_t size)
+    {
+        FrameChunk chunk{ (U8*)ll_aligned_malloc_16(size), size };
+        if (!chunk.mData)
+        {
+            LLError::LLUserWarningMsg::showOutOfMemory();
+            LL_ERRS() << "Out of memory allocating a frame arena chunk of " << size << " bytes" << LL_ENDL;
+        }
+        LLMemAccounting::claim(LLMemTag::FRAME, chunk.mData, size);
+        return chunk;
+    }
+
+    void frame_chunk_free(const FrameChunk& chunk)
+    {
+        LLMemAccounting::disclaim(LLMemTag::FRAME, chunk.mData, chunk.mSize);
+        ll_aligned_free_16(chunk.mData);
+    }
+}
+
+// static
+void* LLFrameArena::allocate(size_t size, size_t align)
+{
+    FrameArenaState& state = frame_arena();
+    // Chunks are 16 byte aligned, anything asking for more pads its size
+    // so it can be aligned in place
+    const size_t padded = (align > 16) ? size + align - 16 : size;
+    state.mUsed += size;
+    state.mHighWater = llmax(state.mHighWater, state.mUsed);
+
+    if (padded > CHUNK_SIZE / 4)
+    {
+        FrameChunk chunk = frame_chunk_alloc(padded);
+        state.mOversized.push_back(chunk);
+        return (void*)(((uintptr_t)chunk.mData + align - 1) & ~(uintptr_t)(align - 1));
+    }
+
+    while (true)
+    {
+        if (state.mCurrent < state.mChunks.size())
+        {
+            const uintptr_t base = (uintptr_t)state.mChunks[state.mCurrent].mData;
+            const uintptr_t start = (base + state.mOffset + align - 1) & ~(uintptr_t)(align - 1);
+            if (start + size <= base + CHUNK_SIZE)
+            {
+                state.mOffset = start + size - base;
+                return (void*)start;
+            }
+            // Try the next one, what is left in this one is wasted until
+            // the next frame
+            ++state.mCurrent;
+            state.mOffset = 0;
+            continue;
+        }
+        state.mChunks.push_back(frame_chunk_alloc(CHUNK_SIZE));
+    }
+}
+
+// static
+void LLFrameArena::reset()
+{
+    FrameArenaState& state = frame_arena();
+    for (const FrameChunk& chunk : state.mOversized)
+    {
+        frame_chunk_free(chunk);
+    }
+    state.mOversized.clear();
+    state.mCurrent = 0;
+    state.mOffset = 0;
+    state.mUsed = 0;
+}
+
+// static
+size_t LLFrameArena::getUsed()
+{
+    return frame_arena().mUsed;
+}
+
+// static
+size_t LLFrameArena::getHighWater()
+{
+    return frame_arena().mHighWater;
+}
+// </FS>
@@ -32,6 +32,11 @@
 #if !LL_WINDOWS
 #include <stdint.h>
 #endif
+// <FS> Memory accounting
+#include <atomic>
+#include <cstddef>
+#include <memory>
+// </FS>
 
 class LLMutex ;
 
@@ -416,6 +421,158 @@ private:
     static U32Kilobytes sMaxHeapSizeInKB;
 };
 
+// <FS> Memory accounting
+// Subsystems memory is accounted to
+enum class LLMemTag : U8
+{
+    TEXTURES,
+    MESH,
+    LLSD,
+    UI,
+    INVENTORY,
+    OBJECTS,
+    AUDIO,
+    FRAME,
+    COUNT
+};
+
+// Bytes each subsystem currently holds, with the peak and the number of
+// allocations made so far. The allocation sites of a subsystem claim what they allocate
+// and disclaim the same amount when they free it. Counters are relaxed
+// atomics on a cache line per tag, so claiming from worker threads costs an
+// uncontended atomic add.
+//
+// The overloads taking a pointer also report the allocation to the
+// profiler as a named memory pool per tag, plot() sends the current bytes
+// of every tag as plots.
+class LL_COMMON_API LLMemAccounting
+{
+public:
+    static void claim(LLMemTag tag, S64 bytes)
+    {
+        Counter& counter = sCounters[(size_t)tag];
+        const S64 now = counter.mBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        counter.mAllocations.fetch_add(1, std::memory_order_relaxed);
+        S64 peak = counter.mPeak.load(std::memory_order_relaxed);
+        while (now > peak && !counter.mPeak.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    static void disclaim(LLMemTag tag, S64 bytes)
+    {
+        sCounters[(size_t)tag].mBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    static void claim(LLMemTag tag, const void* ptr, size_t bytes)
+    {
+        claim(tag, (S64)bytes);
+        LL_PROFILE_ALLOC_NAMED(ptr, bytes, getName(tag));
+    }
+
+    static void disclaim(LLMemTag tag, const void* ptr, size_t bytes)
+    {
+        LL_PROFILE_FREE_NAMED(ptr, getName(tag));
+        disclaim(tag, (S64)bytes);
+    }
+
+    static S64 getBytes(LLMemTag tag) { return sCounters[(size_t)tag].mBytes.load(std::memory_order_relaxed); }
+    static S64 getPeakBytes(LLMemTag tag) { return sCounters[(size_t)tag].mPeak.load(std::memory_order_relaxed); }
+    static U64 getAllocations(LLMemTag tag) { return sCounters[(size_t)tag].mAllocations.load(std::memory_order_relaxed); }
+    static const char* getName(LLMemTag tag);
+
+    // Once per frame
+    static void plot();
+
+private:
+    struct alignas(64) Counter
+    {
+        std::atomic<S64>    mBytes{ 0 };
+        std::atomic<S64>    mPeak{ 0 };
+        std::atomic<U64>    mAllocations{ 0 };
+    };
+    static Counter sCounters[(size_t)LLMemTag::COUNT];
+};
+
+// Standard allocator accounting to a tag, for containers owned by a
+// subsystem
+template <typename T, LLMemTag TAG>
+class LLTaggedAllocator
+{
+public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef LLTaggedAllocator<U, TAG> other;
+    };
+
+    LLTaggedAllocator() noexcept = default;
+    template <typename U>
+    LLTaggedAllocator(const LLTaggedAllocator<U, TAG>&) noexcept {}
+
+    T* allocate(size_t n)
+    {
+        T* ret = std::allocator<T>().allocate(n);
+        LLMemAccounting::claim(TAG, ret, n * sizeof(T));
+        return ret;
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        LLMemAccounting::disclaim(TAG, p, n * sizeof(T));
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const LLTaggedAllocator<U, TAG>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const LLTaggedAllocator<U, TAG>&) const noexcept { return false; }
+};
+
+// Bump allocator for scratch memory that is only needed during the current
+// frame, like the temporary lists of an update pass. Allocating is moving
+// a pointer and freeing does nothing; reset() at the end of every frame
+// hands all of it back at once. Chunks are kept for the next frame, only
+// requests too big for a chunk get memory of their own and release it on
+// reset(). Main thread only.
+class LL_COMMON_API LLFrameArena
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 256 * 1024;
+
+    static void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+    // Everything allocated since the last reset is gone
+    static void reset();
+
+    // Bytes handed out this frame, and the most of any frame so far
+    static size_t getUsed();
+    static size_t getHighWater();
+};
+
+// Standard allocator on LLFrameArena, for containers that don't outlive
+// the frame they are created in
+template <typename T>
+class LLFrameAllocator
+{
+public:
+    typedef T value_type;
+
+    LLFrameAllocator() noexcept = default;
+    template <typename U>
+    LLFrameAllocator(const LLFrameAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) { return static_cast<T*>(LLFrameArena::allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const LLFrameAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const LLFrameAllocator<U>&) const noexcept { return false; }
+};
+// </FS>
+
 // LLRefCount moved to llrefcount.h
 
 // LLPointer moved to llpointer.h
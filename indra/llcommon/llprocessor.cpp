@@ -123,6 +123,8 @@ namespace
         eSSE4_1_Features = 38,
         eSSE4_2_Features = 39,
         eSSE4a_Features = 40,
+        eAVX2_Features = 41, // <FS> AVX2/FMA detection
+        eFMA_Features = 42,  // <FS> AVX2/FMA detection
     };
 
     const char* cpu_feature_names[] =
@@ -170,6 +172,8 @@ namespace
         "SSE4.1 Instructions",
         "SSE4.2 Instructions",
         "SSE4a Instructions",
+        "AVX2 Instructions", // <FS> AVX2/FMA detection
+        "FMA3 Instructions", // <FS> AVX2/FMA detection
     };
 
     std::string intel_CPUFamilyName(int composed_family)
@@ -288,6 +292,18 @@ public:
         return hasExtension("Altivec");
     }
 
+    // <FS> AVX2/FMA detection
+    bool hasAVX2() const
+    {
+        return hasExtension(cpu_feature_names[eAVX2_Features]);
+    }
+
+    bool hasFMA() const
+    {
+        return hasExtension(cpu_feature_names[eFMA_Features]);
+    }
+    // </FS>
+
     std::string getCPUFamilyName() const { return getInfo(eFamilyName, "Unset family").asString(); }
     std::string getCPUBrandName() const { return getInfo(eBrandName, "Unset brand").asString(); }
 
@@ -513,6 +529,11 @@ private:
             is_amd = true;
         }
 
+        // <FS> AVX2/FMA detection
+        // AVX state has to be enabled by the OS (OSXSAVE + XCR0) as well
+        bool os_avx = false;
+        // </FS>
+
         // Get the information associated with each valid Id
         for(unsigned int i=0; i<=ids; ++i)
         {
@@ -572,6 +593,18 @@ private:
                     setExtension(cpu_feature_names[eSSE4_2_Features]);
                 }
 
+                // <FS> AVX2/FMA detection
+                if ((cpu_info[2] & 0x18000000) == 0x18000000)
+                {
+                    os_avx = (_xgetbv(0) & 0x6) == 0x6;
+                }
+
+                if (os_avx && (cpu_info[2] & 0x1000))
+                {
+                    setExtension(cpu_feature_names[eFMA_Features]);
+                }
+                // </FS>
+
                 unsigned int feature_info = (unsigned int) cpu_info[3];
                 for(unsigned int index = 0, bit = 1; index < eSSE3_Features; ++index, bit <<= 1)
                 {
@@ -581,6 +614,16 @@ private:
                     }
                 }
             }
+            // <FS> AVX2/FMA detection
+            else if (i == 7)
+            {
+                __cpuidex(cpu_info, 7, 0);
+                if (os_avx && (cpu_info[1] & 0x20))
+                {
+                    setExtension(cpu_feature_names[eAVX2_Features]);
+                }
+            }
+            // </FS>
         }
 
         // Calling __cpuid with 0x80000000 as the InfoType argument
@@ -790,6 +833,26 @@ private:
             // Not supposed to happen?
             setExtension(cpu_feature_names[eSSE4a_Features]);
         }
+
+        // <FS> AVX2/FMA detection
+        if (cpu_features_str.find(" FMA ") != std::string::npos)
+        {
+            setExtension(cpu_feature_names[eFMA_Features]);
+        }
+
+        char cpu_leaf7_features[1024];
+        len = sizeof(cpu_leaf7_features);
+        memset(cpu_leaf7_features, 0, len);
+        sysctlbyname("machdep.cpu.leaf7_features", (void*)cpu_leaf7_features, &len, NULL, 0);
+
+        std::string cpu_leaf7_features_str(cpu_leaf7_features);
+        cpu_leaf7_features_str = " " + cpu_leaf7_features_str + " ";
+
+        if (cpu_leaf7_features_str.find(" AVX2 ") != std::string::npos)
+        {
+            setExtension(cpu_feature_names[eAVX2_Features]);
+        }
+        // </FS>
     }
 };
 
@@ -923,6 +986,18 @@ private:
         {
             setExtension(cpu_feature_names[eSSE4a_Features]);
         }
+
+        // <FS> AVX2/FMA detection
+        if (flags.find(" avx2 ") != std::string::npos)
+        {
+            setExtension(cpu_feature_names[eAVX2_Features]);
+        }
+
+        if (flags.find(" fma ") != std::string::npos)
+        {
+            setExtension(cpu_feature_names[eFMA_Features]);
+        }
+        // </FS>
     }
 
     std::string getCPUFeatureDescription() const
@@ -987,6 +1062,8 @@ bool LLProcessorInfo::hasSSE41() const { return mImpl->hasSSE41(); }
 bool LLProcessorInfo::hasSSE42() const { return mImpl->hasSSE42(); }
 bool LLProcessorInfo::hasSSE4a() const { return mImpl->hasSSE4a(); }
 bool LLProcessorInfo::hasAltivec() const { return mImpl->hasAltivec(); }
+bool LLProcessorInfo::hasAVX2() const { return mImpl->hasAVX2(); } // <FS/> AVX2/FMA detection
+bool LLProcessorInfo::hasFMA() const { return mImpl->hasFMA(); } // <FS/> AVX2/FMA detection
 std::string LLProcessorInfo::getCPUFamilyName() const { return mImpl->getCPUFamilyName(); }
 std::string LLProcessorInfo::getCPUBrandName() const { return mImpl->getCPUBrandName(); }
 std::string LLProcessorInfo::getCPUFeatureDescription() const { return mImpl->getCPUFeatureDescription(); }
@@ -60,6 +60,8 @@ public:
     bool hasSSE42() const;
     bool hasSSE4a() const;
     bool hasAltivec() const;
+    bool hasAVX2() const; // <FS/> AVX2/FMA detection
+    bool hasFMA() const; // <FS/> AVX2/FMA detection
     std::string getCPUFamilyName() const;
     std::string getCPUBrandName() const;
     std::string getCPUFeatureDescription() const;
@@ -244,6 +244,10 @@ namespace LLProfiler
 // disable memory tracking (incompatible with GPU tracing
 #define LL_PROFILE_ALLOC(ptr, size)             (void)(ptr); (void)(size);
 #define LL_PROFILE_FREE(ptr)                    (void)(ptr);
+// <FS> Memory accounting
+#define LL_PROFILE_ALLOC_NAMED(ptr, size, name) (void)(ptr); (void)(size); (void)(name);
+#define LL_PROFILE_FREE_NAMED(ptr, name)        (void)(ptr); (void)(name);
+// </FS>
 #else
 #define LL_PROFILE_GPU_ZONE(name)        (void)name;
 #define LL_PROFILE_GPU_ZONEC(name,color) (void)name;(void)color;
@@ -256,9 +260,18 @@ namespace LLProfiler
 #if !LL_DARWIN && LL_PROFILER_CONFIGURATION > 1
 #define LL_PROFILE_ALLOC(ptr, size)             TracyAlloc(ptr, size);
 #define LL_PROFILE_FREE(ptr)                    TracyFree(ptr);
+// <FS> Memory accounting
+// Named memory pools, name has to stay valid for the whole run
+#define LL_PROFILE_ALLOC_NAMED(ptr, size, name) TracyAllocN(ptr, size, name);
+#define LL_PROFILE_FREE_NAMED(ptr, name)        TracyFreeN(ptr, name);
+// </FS>
 #else
 #define LL_PROFILE_ALLOC(ptr, size)             (void)(ptr); (void)(size);
 #define LL_PROFILE_FREE(ptr)                    (void)(ptr);
+// <FS> Memory accounting
+#define LL_PROFILE_ALLOC_NAMED(ptr, size, name) (void)(ptr); (void)(size); (void)(name);
+#define LL_PROFILE_FREE_NAMED(ptr, name)        (void)(ptr); (void)(name);
+// </FS>
 #endif
 
 #endif
@@ -0,0 +1,107 @@
+/**
+ * @file llradixsort.h
+ * @brief Radix sort of 64 bit keys
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLRADIXSORT_H
+#define LL_LLRADIXSORT_H
+
+#include "stdtypes.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Sorts are done on flat arrays of keys that pack everything the order
+// depends on, most significant first, usually with an index into the array
+// of what is being sorted in the low bits. The radix sort makes one pass per
+// byte, least significant first, and skips the bytes that are the same in
+// every key, so keys that use few bits sort in few passes.
+
+// Unsigned key that orders the same as f, -0 before +0 and NaNs last
+inline U32 ll_float_sort_key(F32 f)
+{
+    U32 bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+}
+
+// Sort keys in ascending order. scratch is resized to the size of keys and
+// can be kept around between calls.
+inline void ll_radix_sort(std::vector<U64>& keys, std::vector<U64>& scratch)
+{
+    const size_t count = keys.size();
+
+    // the histograms cost more than comparing a handful of keys
+    if (count < 64)
+    {
+        std::sort(keys.begin(), keys.end());
+        return;
+    }
+
+    scratch.resize(count);
+
+    size_t histograms[8][256] = {};
+    for (U64 key : keys)
+    {
+        for (U32 byte = 0; byte < 8; ++byte)
+        {
+            ++histograms[byte][(key >> (byte * 8)) & 0xFF];
+        }
+    }
+
+    U64* src = keys.data();
+    U64* dst = scratch.data();
+    for (U32 byte = 0; byte < 8; ++byte)
+    {
+        size_t* histogram = histograms[byte];
+        if (histogram[(src[0] >> (byte * 8)) & 0xFF] == count)
+        { // every key has the same digit, the pass would not move anything
+            continue;
+        }
+
+        size_t offset = 0;
+        for (U32 digit = 0; digit < 256; ++digit)
+        {
+            size_t digit_count = histogram[digit];
+            histogram[digit] = offset;
+            offset += digit_count;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            U64 key = src[i];
+            dst[histogram[(key >> (byte * 8)) & 0xFF]++] = key;
+        }
+
+        std::swap(src, dst);
+    }
+
+    if (src != keys.data())
+    {
+        keys.swap(scratch);
+    }
+}
+
+#endif // LL_LLRADIXSORT_H
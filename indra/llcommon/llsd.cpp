@@ -36,6 +36,7 @@
 #include "llformat.h"
 #include "llsdserialize.h"
 #include "stringize.h"
+#include "llsdarena.h" // <FS/> LLSD arena
 
 #include <limits>
 
@@ -76,6 +77,12 @@ S32 sLLSDNetObjects = 0;
 
 } // namespace llsd
 
+// <FS> LLSD arena
+// The block the last Impl on this thread was allocated from the arena, so
+// its constructor knows
+static thread_local void* sArenaAllocation = nullptr;
+// </FS>
+
 #define ALLOC_LLSD_OBJECT           { llsd::sLLSDNetObjects++;  llsd::sLLSDAllocationCount++;   }
 #define FREE_LLSD_OBJECT            { llsd::sLLSDNetObjects--;                                  }
 
@@ -102,7 +109,20 @@ protected:
 
     U32 mUseCount;
 
+    // <FS> LLSD arena
+    // Impls from an LLSDArena are destroyed in place and given back to it
+    static void destroy(Impl* impl);
+
+    bool mInArena;
+    // </FS>
+
 public:
+    // <FS> LLSD arena
+    // From the innermost LLSDArena of the thread when there is one
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr);
+    // </FS>
+
     static void reset(Impl*& var, Impl* impl);
         ///< safely set var to refer to the new impl (possibly shared)
 
@@ -748,6 +768,7 @@ namespace
 
 LLSD::Impl::Impl()
     : mUseCount(0)
+    , mInArena(this == sArenaAllocation) // <FS/> LLSD arena
 {
     ++sAllocationCount;
     ++sOutstandingCount;
@@ -755,6 +776,7 @@ LLSD::Impl::Impl()
 
 LLSD::Impl::Impl(StaticAllocationMarker)
     : mUseCount(0)
+    , mInArena(false) // <FS/> LLSD arena
 {
 }
 
@@ -771,7 +793,10 @@ void LLSD::Impl::reset(Impl*& var, Impl* impl)
     }
     if (var  &&  var->mUseCount != STATIC_USAGE_COUNT && --var->mUseCount == 0)
     {
-        delete var;
+        // <FS> LLSD arena
+        //delete var;
+        destroy(var);
+        // </FS>
     }
     var = impl;
 }
@@ -780,12 +805,55 @@ void LLSD::Impl::move(Impl*& var, Impl*& impl)
 {
     if (var && var->mUseCount != STATIC_USAGE_COUNT && --var->mUseCount == 0)
     {
-        delete var; // destroy var if usage falls to 0 and not static
+        // <FS> LLSD arena
+        //delete var; // destroy var if usage falls to 0 and not static
+        destroy(var); // destroy var if usage falls to 0 and not static
+        // </FS>
     }
     var = impl; // Steal impl to var without incrementing use since this is a move
     impl = nullptr; // null out old-impl pointer
 }
 
+// <FS> LLSD arena
+// static
+void* LLSD::Impl::operator new(size_t size)
+{
+    void* block = LLSDArena::allocate(size);
+    sArenaAllocation = block;
+    return block ? block : ::operator new(size);
+}
+
+// static
+void LLSD::Impl::operator delete(void* ptr)
+{
+    // Only reached for arena blocks when a constructor threw, nothing was
+    // allocated since then
+    if (ptr && ptr == sArenaAllocation)
+    {
+        sArenaAllocation = nullptr;
+        LLSDArena::release(ptr);
+    }
+    else
+    {
+        ::operator delete(ptr);
+    }
+}
+
+// static
+void LLSD::Impl::destroy(Impl* impl)
+{
+    if (impl->mInArena)
+    {
+        impl->~Impl();
+        LLSDArena::release(impl);
+    }
+    else
+    {
+        delete impl;
+    }
+}
+// </FS>
+
 LLSD::Impl& LLSD::Impl::safe(Impl* impl)
 {
     static Impl theUndefined(STATIC_USAGE_COUNT);
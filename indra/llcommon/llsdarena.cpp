@@ -0,0 +1,171 @@
+/**
+ * @file llsdarena.cpp
+ * @brief Bump allocation of the LLSD nodes of parsed trees
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "llsdarena.h"
+
+#include "llmemory.h"
+
+#include <atomic>
+
+// The header at the start of every chunk
+struct LLSDArena::Chunk
+{
+    // blocks not released yet, plus one while the arena allocates from it
+    std::atomic<U32>    mLive;
+};
+
+namespace
+{
+    constexpr size_t HEADER_SIZE = 16;
+    constexpr size_t ALIGNMENT = 16;
+
+    thread_local LLSDArena* sCurrent = nullptr;
+    std::atomic<size_t> sChunkCount(0);
+
+    void* chunk_malloc()
+    {
+        // aligned to its size, so the chunk of a block is found from its address
+#if defined(LL_WINDOWS)
+        void* ret = _aligned_malloc(LLSDArena::CHUNK_SIZE, LLSDArena::CHUNK_SIZE);
+#elif defined(LL_DARWIN)
+        void* ret = ll_aligned_malloc_fallback(LLSDArena::CHUNK_SIZE, LLSDArena::CHUNK_SIZE);
+#else
+        void* ret;
+        if (0 != posix_memalign(&ret, LLSDArena::CHUNK_SIZE, LLSDArena::CHUNK_SIZE))
+            return nullptr;
+#endif
+        LL_PROFILE_ALLOC(ret, LLSDArena::CHUNK_SIZE);
+        if (ret)
+        {
+            LLMemAccounting::claim(LLMemTag::LLSD, ret, LLSDArena::CHUNK_SIZE);
+        }
+        return ret;
+    }
+
+    void chunk_free(void* p)
+    {
+        LL_PROFILE_FREE(p);
+        LLMemAccounting::disclaim(LLMemTag::LLSD, p, LLSDArena::CHUNK_SIZE);
+#if defined(LL_WINDOWS)
+        _aligned_free(p);
+#elif defined(LL_DARWIN)
+        ll_aligned_free_fallback(p);
+#else
+        free(p);
+#endif
+    }
+}
+
+LLSDArena::LLSDArena()
+:   mChunk(nullptr),
+    mNext(nullptr),
+    mEnd(nullptr),
+    mPrevious(sCurrent)
+{
+    static_assert(sizeof(Chunk) <= HEADER_SIZE, "chunk header too big");
+    sCurrent = this;
+}
+
+LLSDArena::~LLSDArena()
+{
+    llassert(sCurrent == this);
+    sCurrent = mPrevious;
+    retireChunk();
+}
+
+// static
+void* LLSDArena::allocate(size_t size)
+{
+    LLSDArena* arena = sCurrent;
+    return arena ? arena->allocateBlock(size) : nullptr;
+}
+
+// static
+void LLSDArena::release(void* ptr)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    Chunk* chunk = (Chunk*)((uintptr_t)ptr & ~(uintptr_t)(CHUNK_SIZE - 1));
+    if (chunk->mLive.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        chunk_free(chunk);
+        --sChunkCount;
+    }
+}
+
+// static
+size_t LLSDArena::getChunkCount()
+{
+    return sChunkCount;
+}
+
+void* LLSDArena::allocateBlock(size_t size)
+{
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (size == 0 || size > CHUNK_SIZE - HEADER_SIZE)
+    {
+        return nullptr;
+    }
+
+    if (!mChunk || (size_t)(mEnd - mNext) < size)
+    {
+        retireChunk();
+
+        void* chunk = chunk_malloc();
+        if (!chunk)
+        {
+            return nullptr;
+        }
+        mChunk = new (chunk) Chunk;
+        mChunk->mLive.store(1, std::memory_order_relaxed);
+        mNext = (U8*)chunk + HEADER_SIZE;
+        mEnd = (U8*)chunk + CHUNK_SIZE;
+        ++sChunkCount;
+    }
+
+    // only the allocating thread adds to the count, others may be releasing
+    mChunk->mLive.fetch_add(1, std::memory_order_relaxed);
+    void* block = mNext;
+    mNext += size;
+    return block;
+}
+
+void LLSDArena::retireChunk()
+{
+    if (mChunk)
+    {
+        // drops the arena's own hold, frees it if no block is left
+        release(mChunk);
+        mChunk = nullptr;
+        mNext = mEnd = nullptr;
+    }
+}
@@ -0,0 +1,80 @@
+/**
+ * @file llsdarena.h
+ * @brief Bump allocation of the LLSD nodes of parsed trees
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+
+#ifndef LL_LLSDARENA_H
+#define LL_LLSDARENA_H
+
+// While an LLSDArena is alive, the LLSD nodes created on its thread (by a
+// parser or otherwise) come from chunks of CHUNK_SIZE bytes handed out with a
+// pointer bump, instead of one heap allocation each. Destroying a node only
+// counts it off its chunk. A chunk goes back to the heap at once when its
+// last node is gone and the arena has moved past it, so a parsed tree is
+// released with a handful of frees however many nodes it has.
+//
+// Nodes can outlive the arena and be handed to other threads like any
+// other LLSD, but a single node kept around keeps its whole chunk. Meant for
+// big trees that are parsed, read and dropped, like large HTTP responses.
+//
+// Arenas nest, the innermost one on a thread is used. What a node holds
+// besides itself (strings, map and array storage) still comes from the heap.
+class LL_COMMON_API LLSDArena
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    LLSDArena();
+    ~LLSDArena();
+
+    // Threads:  any
+    // A block of size bytes, 16 byte aligned, from the innermost arena of
+    // the calling thread. nullptr when there is none or size is too big.
+    static void* allocate(size_t size);
+
+    // Threads:  any
+    // Give back a block from allocate(), the node has been destroyed.
+    static void release(void* ptr);
+
+    // Chunks currently allocated, by all arenas
+    static size_t getChunkCount();
+
+private:
+    struct Chunk;
+
+    void* allocateBlock(size_t size);
+    void retireChunk();
+
+    Chunk*      mChunk;     // current one, held until the arena moves on
+    U8*         mNext;
+    U8*         mEnd;
+    LLSDArena*  mPrevious;  // of the thread
+
+    LLSDArena(const LLSDArena&) = delete;
+    LLSDArena& operator=(const LLSDArena&) = delete;
+};
+
+#endif // LL_LLSDARENA_H
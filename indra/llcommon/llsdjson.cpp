@@ -36,6 +36,10 @@
 #include "../llmath/llmath.h"
 
 #include <boost/json/src.hpp>
+// <FS> Streaming LLSD parse
+#include "llsdsink.h"
+#include <boost/json/basic_parser_impl.hpp>
+// </FS>
 
 //=========================================================================
 LLSD LlsdFromJson(const boost::json::value& val)
@@ -141,3 +145,100 @@ boost::json::value LlsdToJson(const LLSD &val)
 
     return result;
 }
+
+// <FS> Streaming LLSD parse
+//=========================================================================
+namespace
+{
+    // boost::json::basic_parser handler forwarding to an LLSDSink
+    class JsonSinkHandler
+    {
+    public:
+        static constexpr std::size_t max_object_size = std::size_t(-1);
+        static constexpr std::size_t max_array_size = std::size_t(-1);
+        static constexpr std::size_t max_key_size = std::size_t(-1);
+        static constexpr std::size_t max_string_size = std::size_t(-1);
+
+        JsonSinkHandler(LLSDSink& sink) : mSink(sink) {}
+
+        bool on_document_begin(boost::json::error_code&)                { return true; }
+        bool on_document_end(boost::json::error_code&)                  { return true; }
+
+        bool on_object_begin(boost::json::error_code&)                  { mSink.onBeginMap(); return true; }
+        bool on_object_end(std::size_t, boost::json::error_code&)       { mSink.onEndMap(); return true; }
+        bool on_array_begin(boost::json::error_code&)                   { mSink.onBeginArray(); return true; }
+        bool on_array_end(std::size_t, boost::json::error_code&)        { mSink.onEndArray(); return true; }
+
+        bool on_key_part(boost::json::string_view s, std::size_t, boost::json::error_code&)
+        {
+            mText.append(s.data(), s.size());
+            return true;
+        }
+
+        bool on_key(boost::json::string_view s, std::size_t, boost::json::error_code&)
+        {
+            mText.append(s.data(), s.size());
+            mSink.onMapKey(mText);
+            mText.clear();
+            return true;
+        }
+
+        bool on_string_part(boost::json::string_view s, std::size_t, boost::json::error_code&)
+        {
+            mText.append(s.data(), s.size());
+            return true;
+        }
+
+        bool on_string(boost::json::string_view s, std::size_t, boost::json::error_code&)
+        {
+            mText.append(s.data(), s.size());
+            mSink.onString(mText);
+            mText.clear();
+            return true;
+        }
+
+        bool on_number_part(boost::json::string_view, boost::json::error_code&) { return true; }
+
+        bool on_int64(std::int64_t i, boost::json::string_view, boost::json::error_code&)
+        {
+            mSink.onInteger((LLSD::Integer)i);
+            return true;
+        }
+
+        bool on_uint64(std::uint64_t u, boost::json::string_view, boost::json::error_code&)
+        {
+            mSink.onInteger((LLSD::Integer)u);
+            return true;
+        }
+
+        bool on_double(double d, boost::json::string_view, boost::json::error_code&)
+        {
+            mSink.onReal(d);
+            return true;
+        }
+
+        bool on_bool(bool b, boost::json::error_code&)                  { mSink.onBoolean(b); return true; }
+        bool on_null(boost::json::error_code&)                          { mSink.onUndefined(); return true; }
+
+        bool on_comment_part(boost::json::string_view, boost::json::error_code&) { return true; }
+        bool on_comment(boost::json::string_view, boost::json::error_code&) { return true; }
+
+    private:
+        LLSDSink&   mSink;
+        std::string mText;  // key or string being assembled from its parts
+    };
+}
+
+bool LlsdJsonToSink(const char* text, size_t length, LLSDSink& sink)
+{
+    boost::json::basic_parser<JsonSinkHandler> parser(boost::json::parse_options(), sink);
+    boost::json::error_code ec;
+    parser.write_some(false, text, length, ec);
+    if (ec)
+    {
+        LL_WARNS("LlsdJsonToSink") << "Failed to parse JSON: " << ec.message() << LL_ENDL;
+        return false;
+    }
+    return true;
+}
+// </FS>
@@ -74,4 +74,15 @@ LLSD LlsdFromJson(const boost::json::value &val);
 /// TypeBinary    | unsupported
 boost::json::value LlsdToJson(const LLSD &val);
 
+// <FS> Streaming LLSD parse
+class LLSDSink;
+
+/// Parse JSON text straight into the events of sink, without building a
+/// boost::json::value or an LLSD tree in between. Types are converted as
+/// by LlsdFromJson(), object members are sent in document order.
+/// Returns false when the text isn't valid JSON, the sink has then seen the
+/// values up to the error.
+bool LlsdJsonToSink(const char* text, size_t length, LLSDSink& sink);
+// </FS>
+
 #endif // LL_LLSDJSON_H
@@ -50,6 +50,7 @@
 #include "lldate.h"
 #include "llmemorystream.h"
 #include "llsd.h"
+#include "llsdsink.h" // <FS/> Streaming LLSD parse
 #include "llstring.h"
 #include "lluri.h"
 
@@ -404,6 +405,27 @@ S32 LLSDParser::parseLines(std::istream& istr, LLSD& data)
     return doParse(istr, data);
 }
 
+// <FS> Streaming LLSD parse
+S32 LLSDParser::parse(std::istream& istr, LLSDSink& sink, llssize max_bytes, S32 max_depth)
+{
+    mCheckLimits = LLSDSerialize::SIZE_UNLIMITED != max_bytes;
+    mMaxBytesLeft = max_bytes;
+    return doParseToSink(istr, sink, max_depth);
+}
+
+// virtual
+S32 LLSDParser::doParseToSink(std::istream& istr, LLSDSink& sink, S32 max_depth) const
+{
+    LLSD data;
+    S32 parse_count = doParse(istr, data, max_depth);
+    if (parse_count > 0)
+    {
+        LLSDSink::replay(data, sink);
+    }
+    return parse_count;
+}
+// </FS>
+
 
 int LLSDParser::get(std::istream& istr) const
 {
@@ -1276,6 +1298,268 @@ S32 LLSDBinaryParser::parseArray(std::istream& istr, LLSD& array, S32 max_depth)
     return parse_count;
 }
 
+// <FS> Streaming LLSD parse
+// virtual
+S32 LLSDBinaryParser::doParseToSink(std::istream& istr, LLSDSink& sink, S32 max_depth) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+    // Same format and checks as doParse()
+    char c;
+    c = get(istr);
+    if(!istr.good())
+    {
+        return 0;
+    }
+    if (max_depth == 0)
+    {
+        return PARSE_FAILURE;
+    }
+    S32 parse_count = 1;
+    switch(c)
+    {
+    case '{':
+    {
+        S32 child_count = parseMapToSink(istr, sink, max_depth - 1);
+        if(child_count == PARSE_FAILURE || istr.fail())
+        {
+            parse_count = PARSE_FAILURE;
+        }
+        else
+        {
+            parse_count += child_count;
+        }
+        break;
+    }
+
+    case '[':
+    {
+        S32 child_count = parseArrayToSink(istr, sink, max_depth - 1);
+        if(child_count == PARSE_FAILURE || istr.fail())
+        {
+            parse_count = PARSE_FAILURE;
+        }
+        else
+        {
+            parse_count += child_count;
+        }
+        break;
+    }
+
+    case '!':
+        sink.onUndefined();
+        break;
+
+    case '0':
+        sink.onBoolean(false);
+        break;
+
+    case '1':
+        sink.onBoolean(true);
+        break;
+
+    case 'i':
+    {
+        U32 value_nbo = 0;
+        read(istr, (char*)&value_nbo, sizeof(U32));  /*Flawfinder: ignore*/
+        sink.onInteger((S32)ntohl(value_nbo));
+        break;
+    }
+
+    case 'r':
+    {
+        F64 real_nbo = 0.0;
+        read(istr, (char*)&real_nbo, sizeof(F64));   /*Flawfinder: ignore*/
+        sink.onReal(ll_ntohd(real_nbo));
+        break;
+    }
+
+    case 'u':
+    {
+        LLUUID id;
+        read(istr, (char*)(&id.mData), UUID_BYTES);  /*Flawfinder: ignore*/
+        sink.onUUID(id);
+        break;
+    }
+
+    case '\'':
+    case '"':
+    {
+        std::string value;
+        auto cnt = deserialize_string_delim(istr, value, c);
+        if(PARSE_FAILURE == cnt || istr.fail())
+        {
+            parse_count = PARSE_FAILURE;
+        }
+        else
+        {
+            account(cnt);
+            sink.onString(value);
+        }
+        break;
+    }
+
+    case 's':
+    {
+        std::string value;
+        if(parseString(istr, value) && !istr.fail())
+        {
+            sink.onString(value);
+        }
+        else
+        {
+            parse_count = PARSE_FAILURE;
+        }
+        break;
+    }
+
+    case 'l':
+    {
+        std::string value;
+        if(parseString(istr, value) && !istr.fail())
+        {
+            sink.onURI(LLURI(value));
+        }
+        else
+        {
+            parse_count = PARSE_FAILURE;
+        }
+        break;
+    }
+
+    case 'd':
+    {
+        F64 real = 0.0;
+        read(istr, (char*)&real, sizeof(F64));   /*Flawfinder: ignore*/
+        if(istr.fail())
+        {
+            parse_count = PARSE_FAILURE;
+        }
+        else
+        {
+            sink.onDate(LLDate(real));
+        }
+        break;
+    }
+
+    case 'b':
+    {
+        U32 size_nbo = 0;
+        read(istr, (char*)&size_nbo, sizeof(U32));  /*Flawfinder: ignore*/
+        S32 size = (S32)ntohl(size_nbo);
+        if(mCheckLimits && (size > mMaxBytesLeft))
+        {
+            parse_count = PARSE_FAILURE;
+        }
+        else
+        {
+            std::vector<U8> value;
+            if(size > 0)
+            {
+                value.resize(size);
+                account(fullread(istr, (char*)&value[0], size));
+            }
+            if(istr.fail())
+            {
+                parse_count = PARSE_FAILURE;
+            }
+            else
+            {
+                sink.onBinary(value);
+            }
+        }
+        break;
+    }
+
+    default:
+        parse_count = PARSE_FAILURE;
+        LL_INFOS() << "Unrecognized character while parsing: int(" << int(c)
+            << ")" << LL_ENDL;
+        break;
+    }
+    return parse_count;
+}
+
+S32 LLSDBinaryParser::parseMapToSink(std::istream& istr, LLSDSink& sink, S32 max_depth) const
+{
+    sink.onBeginMap();
+    U32 value_nbo = 0;
+    read(istr, (char*)&value_nbo, sizeof(U32));      /*Flawfinder: ignore*/
+    S32 size = (S32)ntohl(value_nbo);
+    S32 parse_count = 0;
+    S32 count = 0;
+    char c = get(istr);
+    while(c != '}' && (count < size) && istr.good())
+    {
+        std::string name;
+        switch(c)
+        {
+        case 'k':
+            if(!parseString(istr, name))
+            {
+                return PARSE_FAILURE;
+            }
+            break;
+        case '\'':
+        case '"':
+        {
+            auto cnt = deserialize_string_delim(istr, name, c);
+            if(PARSE_FAILURE == cnt) return PARSE_FAILURE;
+            account(cnt);
+            break;
+        }
+        }
+        sink.onMapKey(name);
+        S32 child_count = doParseToSink(istr, sink, max_depth);
+        if(child_count > 0)
+        {
+            // There must be a value for every key
+            parse_count += child_count;
+        }
+        else
+        {
+            return PARSE_FAILURE;
+        }
+        ++count;
+        c = get(istr);
+    }
+    if((c != '}') || (count < size))
+    {
+        return PARSE_FAILURE;
+    }
+    sink.onEndMap();
+    return parse_count;
+}
+
+S32 LLSDBinaryParser::parseArrayToSink(std::istream& istr, LLSDSink& sink, S32 max_depth) const
+{
+    sink.onBeginArray();
+    U32 value_nbo = 0;
+    read(istr, (char*)&value_nbo, sizeof(U32));      /*Flawfinder: ignore*/
+    S32 size = (S32)ntohl(value_nbo);
+    S32 parse_count = 0;
+    S32 count = 0;
+    char c = istr.peek();
+    while((c != ']') && (count < size) && istr.good())
+    {
+        S32 child_count = doParseToSink(istr, sink, max_depth);
+        if(PARSE_FAILURE == child_count)
+        {
+            return PARSE_FAILURE;
+        }
+        parse_count += child_count;
+        ++count;
+        c = istr.peek();
+    }
+    c = get(istr);
+    if((c != ']') || (count < size))
+    {
+        return PARSE_FAILURE;
+    }
+    sink.onEndArray();
+    return parse_count;
+}
+// </FS>
+
 bool LLSDBinaryParser::parseString(
     std::istream& istr,
     std::string& value) const
@@ -34,6 +34,8 @@
 #include "llrefcount.h"
 #include "llsd.h"
 
+class LLSDSink; // <FS/> Streaming LLSD parse
+
 /**
  * @class LLSDParser
  * @brief Abstract base class for LLSD parsers.
@@ -85,6 +87,18 @@ public:
      */
     S32 parseLines(std::istream& istr, LLSD& data);
 
+    // <FS> Streaming LLSD parse
+    /**
+     * @brief Like parse(), but the values are sent to sink as they are
+     * read instead of building an LLSD tree.
+     *
+     * @return Returns the number of LLSD objects parsed. Returns
+     * PARSE_FAILURE (-1) on parse failure, the sink has then seen the
+     * values up to the failure.
+     */
+    S32 parse(std::istream& istr, LLSDSink& sink, llssize max_bytes, S32 max_depth = -1);
+    // </FS>
+
     /**
      * @brief Resets the parser so parse() or parseLines() can be called again for another <llsd> chunk.
      */
@@ -110,6 +124,16 @@ protected:
      */
     virtual S32 doParse(std::istream& istr, LLSD& data, S32 max_depth = -1) const = 0;
 
+    // <FS> Streaming LLSD parse
+    /**
+     * @brief Virtual base for the parse to a sink.
+     *
+     * The default parses into an LLSD tree with doParse() and replays it
+     * to the sink, for parsers without a streaming implementation.
+     */
+    virtual S32 doParseToSink(std::istream& istr, LLSDSink& sink, S32 max_depth) const;
+    // </FS>
+
     /**
      * @brief Virtual default function for resetting the parser
      */
@@ -327,6 +351,10 @@ protected:
      */
     virtual S32 doParse(std::istream& istr, LLSD& data, S32 max_depth = -1) const;
 
+    // <FS> Streaming LLSD parse
+    virtual S32 doParseToSink(std::istream& istr, LLSDSink& sink, S32 max_depth) const;
+    // </FS>
+
     /**
      * @brief Virtual default function for resetting the parser
      */
@@ -377,6 +405,10 @@ protected:
      */
     virtual S32 doParse(std::istream& istr, LLSD& data, S32 max_depth = -1) const;
 
+    // <FS> Streaming LLSD parse
+    virtual S32 doParseToSink(std::istream& istr, LLSDSink& sink, S32 max_depth) const;
+    // </FS>
+
 private:
     /**
      * @brief Parse a map from the istream
@@ -406,6 +438,14 @@ private:
      * @return Retuns true if a complete string was parsed.
      */
     bool parseString(std::istream& istr, std::string& value) const;
+
+    // <FS> Streaming LLSD parse
+    /**
+     * @brief Like parseMap() and parseArray(), sending the values to sink.
+     */
+    S32 parseMapToSink(std::istream& istr, LLSDSink& sink, S32 max_depth) const;
+    S32 parseArrayToSink(std::istream& istr, LLSDSink& sink, S32 max_depth) const;
+    // </FS>
 };
 
 
@@ -33,6 +33,7 @@
 #include "apr_base64.h"
 #include <boost/regex.hpp>
 #include <stack>
+#include "llsdsink.h" // <FS/> Streaming LLSD parse
 
 extern "C"
 {
@@ -269,6 +270,7 @@ public:
 
     S32 parse(std::istream& input, LLSD& data);
     S32 parseLines(std::istream& input, LLSD& data);
+    S32 parseToSink(std::istream& input, LLSDSink& sink, bool lines); // <FS/> Streaming LLSD parse
 
     void parsePart(const char *buf, llssize len);
 
@@ -308,6 +310,11 @@ private:
 
     static const XML_Char* findAttribute(const XML_Char* name, const XML_Char** pairs);
 
+    // <FS> Streaming LLSD parse
+    void startSinkValue(Element element);
+    void endSinkValue(Element element);
+    // </FS>
+
     bool mEmitErrors;
 
     XML_Parser  mParser;
@@ -328,11 +335,17 @@ private:
 
     std::string mCurrentKey;        // Current XML <tag>
     std::string mCurrentContent;    // String data between <tag> and </tag>
+
+    // <FS> Streaming LLSD parse
+    LLSDSink* mSink;                    // instead of mResult when set
+    std::vector<Element> mSinkStack;    // open values, what mStack is to mResult
+    // </FS>
 };
 
 
 LLSDXMLParser::Impl::Impl(bool emit_errors)
     : mEmitErrors(emit_errors)
+    , mSink(nullptr) // <FS/> Streaming LLSD parse
 {
     mParser = XML_ParserCreate(NULL);
     reset();
@@ -517,10 +530,25 @@ S32 LLSDXMLParser::Impl::parseLines(std::istream& input, LLSD& data)
 }
 
 
+// <FS> Streaming LLSD parse
+S32 LLSDXMLParser::Impl::parseToSink(std::istream& input, LLSDSink& sink, bool lines)
+{
+    mSink = &sink;
+    mSinkStack.clear();
+
+    LLSD unused;
+    S32 parse_count = lines ? parseLines(input, unused) : parse(input, unused);
+
+    mSink = nullptr;
+    return parse_count;
+}
+// </FS>
+
 void LLSDXMLParser::Impl::reset()
 {
     mResult.clear();
     mParseCount = 0;
+    mSinkStack.clear(); // <FS/> Streaming LLSD parse
 
     mInLLSDElement = false;
     mDepth = 0;
@@ -632,7 +660,11 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
             return;
 
         case ELEMENT_KEY:
-            if (mStack.empty()  ||  !(mStack.back()->isMap()))
+            // <FS> Streaming LLSD parse
+            //if (mStack.empty()  ||  !(mStack.back()->isMap()))
+            if (mSink ? (mSinkStack.empty() || mSinkStack.back() != ELEMENT_MAP)
+                      : (mStack.empty()  ||  !(mStack.back()->isMap())))
+            // </FS>
             {
                 mStackElements.pop();
                 return startSkipping();
@@ -662,6 +694,13 @@ void LLSDXMLParser::Impl::startElementHandler(const XML_Char* name, const XML_Ch
         return startSkipping();
     }
 
+    // <FS> Streaming LLSD parse
+    if (mSink)
+    {
+        return startSinkValue(element);
+    }
+    // </FS>
+
     if (mStack.empty())
     {
         mStack.push_back(&mResult);
@@ -754,6 +793,13 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
 
     if (!mInLLSDElement) { return; }
 
+    // <FS> Streaming LLSD parse
+    if (mSink)
+    {
+        return endSinkValue(element);
+    }
+    // </FS>
+
     LLSD& value = *mStack.back();
     mStack.pop_back();
 
@@ -846,6 +892,123 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
     mCurrentContent.clear();
 }
 
+// <FS> Streaming LLSD parse
+void LLSDXMLParser::Impl::startSinkValue(Element element)
+{
+    // Same nesting rules as the tree in startElementHandler()
+    if (!mSinkStack.empty())
+    {
+        if (mSinkStack.back() == ELEMENT_MAP)
+        {
+            if (mCurrentKey.empty())
+            {
+                mStackElements.pop();
+                return startSkipping();
+            }
+            mSink->onMapKey(mCurrentKey);
+            mCurrentKey.clear();
+        }
+        else if (mSinkStack.back() != ELEMENT_ARRAY)
+        {
+            // improperly nested value in a non-structure
+            mStackElements.pop();
+            return startSkipping();
+        }
+    }
+
+    ++mParseCount;
+    mSinkStack.push_back(element);
+    switch (element)
+    {
+        case ELEMENT_MAP:
+            mSink->onBeginMap();
+            break;
+
+        case ELEMENT_ARRAY:
+            mSink->onBeginArray();
+            break;
+
+        default:
+            // all the other values are sent in endSinkValue()
+            ;
+    }
+}
+
+void LLSDXMLParser::Impl::endSinkValue(Element element)
+{
+    mSinkStack.pop_back();
+
+    // Same conversions as endElementHandler()
+    switch (element)
+    {
+        case ELEMENT_MAP:
+            mSink->onEndMap();
+            break;
+
+        case ELEMENT_ARRAY:
+            mSink->onEndArray();
+            break;
+
+        case ELEMENT_BOOL:
+            mSink->onBoolean(mCurrentContent == "true" || mCurrentContent == "1");
+            break;
+
+        case ELEMENT_INTEGER:
+            {
+                S32 i;
+                if ( sscanf(mCurrentContent.c_str(), "%d", &i ) != 1 )
+                {
+                    i = LLSD(mCurrentContent).asInteger();
+                }
+                mSink->onInteger(i);
+            }
+            break;
+
+        case ELEMENT_REAL:
+            mSink->onReal(LLSD(mCurrentContent).asReal());
+            break;
+
+        case ELEMENT_STRING:
+            mSink->onString(mCurrentContent);
+            break;
+
+        case ELEMENT_UUID:
+            mSink->onUUID(LLSD(mCurrentContent).asUUID());
+            break;
+
+        case ELEMENT_DATE:
+            mSink->onDate(LLSD(mCurrentContent).asDate());
+            break;
+
+        case ELEMENT_URI:
+            mSink->onURI(LLSD(mCurrentContent).asURI());
+            break;
+
+        case ELEMENT_BINARY:
+        {
+            boost::regex r;
+            r.assign("\\s");
+            std::string stripped = boost::regex_replace(mCurrentContent, r, "");
+            S32 len = apr_base64_decode_len(stripped.c_str());
+            std::vector<U8> data;
+            data.resize(len);
+            len = apr_base64_decode_binary(&data[0], stripped.c_str());
+            data.resize(len);
+            mSink->onBinary(data);
+            break;
+        }
+
+        case ELEMENT_UNDEF:
+        case ELEMENT_UNKNOWN:
+        default:
+            mSink->onUndefined();
+            break;
+    }
+
+    mCurrentContent.clear();
+}
+// </FS>
+
 void LLSDXMLParser::Impl::characterDataHandler(const XML_Char* data, int length)
 {
     #ifdef XML_PARSER_PERFORMANCE_TESTS
@@ -980,6 +1143,15 @@ S32 LLSDXMLParser::doParse(std::istream& input, LLSD& data, S32 max_depth) const
     return impl.parse(input, data);
 }
 
+// <FS> Streaming LLSD parse
+// virtual
+S32 LLSDXMLParser::doParseToSink(std::istream& input, LLSDSink& sink, S32 max_depth) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+    return impl.parseToSink(input, sink, mParseLines);
+}
+// </FS>
+
 //  virtual
 void LLSDXMLParser::doReset()
 {
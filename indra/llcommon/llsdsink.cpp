@@ -0,0 +1,83 @@
+/**
+ * @file llsdsink.cpp
+ * @brief Event interface for streaming LLSD parses
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "llsdsink.h"
+
+// static
+void LLSDSink::replay(const LLSD& value, LLSDSink& sink)
+{
+    switch (value.type())
+    {
+    case LLSD::TypeBoolean:
+        sink.onBoolean(value.asBoolean());
+        break;
+    case LLSD::TypeInteger:
+        sink.onInteger(value.asInteger());
+        break;
+    case LLSD::TypeReal:
+        sink.onReal(value.asReal());
+        break;
+    case LLSD::TypeString:
+        sink.onString(value.asStringRef());
+        break;
+    case LLSD::TypeUUID:
+        sink.onUUID(value.asUUID());
+        break;
+    case LLSD::TypeDate:
+        sink.onDate(value.asDate());
+        break;
+    case LLSD::TypeURI:
+        sink.onURI(value.asURI());
+        break;
+    case LLSD::TypeBinary:
+        sink.onBinary(value.asBinary());
+        break;
+    case LLSD::TypeMap:
+        sink.onBeginMap();
+        for (LLSD::map_const_iterator it = value.beginMap(); it != value.endMap(); ++it)
+        {
+            sink.onMapKey(it->first);
+            replay(it->second, sink);
+        }
+        sink.onEndMap();
+        break;
+    case LLSD::TypeArray:
+        sink.onBeginArray();
+        for (LLSD::array_const_iterator it = value.beginArray(); it != value.endArray(); ++it)
+        {
+            replay(*it, sink);
+        }
+        sink.onEndArray();
+        break;
+    case LLSD::TypeUndefined:
+    default:
+        sink.onUndefined();
+        break;
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * @file llsdsink.h
+ * @brief Event interface for streaming LLSD parses
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+
+#ifndef LL_LLSDSINK_H
+#define LL_LLSDSINK_H
+
+#include "llsd.h"
+
+// Receives an LLSD document one value at a time, in document order, from a
+// streaming parse (LLSDParser::parse() with a sink, LlsdJsonToSink()) or
+// from replay() of a tree. Consumers that turn a document into their own
+// structures can build them directly, without the intermediate LLSD tree.
+//
+// Every value of a map comes right after its onMapKey(). Maps and arrays
+// are bracketed by their begin and end calls, with their values in between.
+// A sink only overrides what it cares about, the rest is ignored.
+//
+// A parse that fails stops at the point of failure; the sink has seen the
+// events up to there and should drop what it built.
+class LL_COMMON_API LLSDSink
+{
+public:
+    virtual ~LLSDSink() {}
+
+    virtual void onUndefined()                          {}
+    virtual void onBoolean(LLSD::Boolean)               {}
+    virtual void onInteger(LLSD::Integer)               {}
+    virtual void onReal(LLSD::Real)                     {}
+    virtual void onString(const LLSD::String&)          {}
+    virtual void onUUID(const LLSD::UUID&)              {}
+    virtual void onDate(const LLSD::Date&)              {}
+    virtual void onURI(const LLSD::URI&)                {}
+    virtual void onBinary(const LLSD::Binary&)          {}
+
+    virtual void onBeginMap()                           {}
+    virtual void onMapKey(const LLSD::String&)          {}
+    virtual void onEndMap()                             {}
+    virtual void onBeginArray()                         {}
+    virtual void onEndArray()                           {}
+
+    // Send one value to sink, whole trees depth first
+    static void replay(const LLSD& value, LLSDSink& sink);
+};
+
+#endif // LL_LLSDSINK_H
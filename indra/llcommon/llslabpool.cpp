@@ -0,0 +1,233 @@
+/**
+ * @file llslabpool.cpp
+ * @brief Size class slab allocator for objects created and destroyed in bulk
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "llslabpool.h"
+
+// static
+bool LLSlabPool::sEnabled = true;
+
+// The header at the start of every slab, padded to a cache line so the
+// blocks after it stay aligned
+struct LLSlabPool::Slab
+{
+    Slab*   mPrev;      // in the list of slabs with room left
+    Slab*   mNext;
+    void*   mFree;      // freed blocks, each pointing to the next one
+    U32     mBump;      // offset of the first block never handed out
+    U32     mUsed;      // blocks
+    U32     mCapacity;  // blocks
+    U32     mBlockSize;
+    U32     mClass;
+    bool    mLinked;
+};
+
+namespace
+{
+    constexpr size_t HEADER_SIZE = 64;
+
+    void* slab_malloc()
+    {
+        // aligned to its size, so the slab of a block is found from its address
+#if defined(LL_WINDOWS)
+        void* ret = _aligned_malloc(LLSlabPool::SLAB_SIZE, LLSlabPool::SLAB_SIZE);
+#elif defined(LL_DARWIN)
+        void* ret = ll_aligned_malloc_fallback(LLSlabPool::SLAB_SIZE, LLSlabPool::SLAB_SIZE);
+#else
+        void* ret;
+        if (0 != posix_memalign(&ret, LLSlabPool::SLAB_SIZE, LLSlabPool::SLAB_SIZE))
+            return nullptr;
+#endif
+        LL_PROFILE_ALLOC(ret, LLSlabPool::SLAB_SIZE);
+        return ret;
+    }
+
+    void slab_free(void* p)
+    {
+        LL_PROFILE_FREE(p);
+#if defined(LL_WINDOWS)
+        _aligned_free(p);
+#elif defined(LL_DARWIN)
+        ll_aligned_free_fallback(p);
+#else
+        free(p);
+#endif
+    }
+}
+
+LLSlabPool::LLSlabPool(size_t max_size, bool enabled, LLMemTag tag)
+:   mMaxSize(llmin((max_size + GRANULARITY - 1) / GRANULARITY * GRANULARITY, (SLAB_SIZE - HEADER_SIZE) / 2)),
+    mEnabled(enabled),
+    mTag(tag),
+    mSlabCount(0)
+{
+    static_assert(sizeof(Slab) <= HEADER_SIZE, "slab header too big");
+    mPartial.resize(mMaxSize / GRANULARITY, nullptr);
+}
+
+LLSlabPool::~LLSlabPool()
+{
+    // full slabs would still hold live blocks, there are none left by now
+    for (Slab* slab : mPartial)
+    {
+        while (slab)
+        {
+            Slab* next = slab->mNext;
+            slab_free(slab);
+            slab = next;
+        }
+    }
+}
+
+void* LLSlabPool::allocate(size_t size)
+{
+    LLMemAccounting::claim(mTag, (S64)size);
+    if (!mEnabled || size > mMaxSize || size == 0)
+    {
+        return ll_aligned_malloc_16(size);
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_MEMORY;
+    const U32 size_class = (U32)((size - 1) / GRANULARITY);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Slab* slab = mPartial[size_class];
+    if (!slab)
+    {
+        slab = (Slab*)slab_malloc();
+        if (!slab)
+        {
+            return nullptr;
+        }
+        slab->mPrev = nullptr;
+        slab->mNext = nullptr;
+        slab->mFree = nullptr;
+        slab->mBump = HEADER_SIZE;
+        slab->mUsed = 0;
+        slab->mBlockSize = (size_class + 1) * GRANULARITY;
+        slab->mCapacity = (U32)((SLAB_SIZE - HEADER_SIZE) / slab->mBlockSize);
+        slab->mClass = size_class;
+        slab->mLinked = false;
+        linkSlab(size_class, slab);
+        ++mSlabCount;
+    }
+
+    void* block;
+    if (slab->mFree)
+    {
+        block = slab->mFree;
+        slab->mFree = *(void**)block;
+    }
+    else
+    {
+        block = (U8*)slab + slab->mBump;
+        slab->mBump += slab->mBlockSize;
+    }
+
+    if (++slab->mUsed == slab->mCapacity)
+    {
+        unlinkSlab(size_class, slab);
+    }
+    return block;
+}
+
+void LLSlabPool::deallocate(void* ptr, size_t size)
+{
+    if (!ptr)
+    {
+        return;
+    }
+    LLMemAccounting::disclaim(mTag, (S64)size);
+    if (!mEnabled || size > mMaxSize || size == 0)
+    {
+        ll_aligned_free_16(ptr);
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_MEMORY;
+    Slab* slab = (Slab*)((uintptr_t)ptr & ~(uintptr_t)(SLAB_SIZE - 1));
+    llassert(slab->mClass == (size - 1) / GRANULARITY);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    *(void**)ptr = slab->mFree;
+    slab->mFree = ptr;
+    --slab->mUsed;
+
+    const U32 size_class = slab->mClass;
+    if (!slab->mLinked)
+    {
+        linkSlab(size_class, slab);
+    }
+
+    // keep one empty slab around, objects tend to come and go in waves
+    if (slab->mUsed == 0 && (mPartial[size_class] != slab || slab->mNext))
+    {
+        unlinkSlab(size_class, slab);
+        slab_free(slab);
+        --mSlabCount;
+    }
+}
+
+size_t LLSlabPool::getSlabCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSlabCount;
+}
+
+void LLSlabPool::linkSlab(U32 size_class, Slab* slab)
+{
+    slab->mPrev = nullptr;
+    slab->mNext = mPartial[size_class];
+    if (slab->mNext)
+    {
+        slab->mNext->mPrev = slab;
+    }
+    mPartial[size_class] = slab;
+    slab->mLinked = true;
+}
+
+void LLSlabPool::unlinkSlab(U32 size_class, Slab* slab)
+{
+    if (slab->mPrev)
+    {
+        slab->mPrev->mNext = slab->mNext;
+    }
+    else
+    {
+        mPartial[size_class] = slab->mNext;
+    }
+    if (slab->mNext)
+    {
+        slab->mNext->mPrev = slab->mPrev;
+    }
+    slab->mPrev = nullptr;
+    slab->mNext = nullptr;
+    slab->mLinked = false;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file llslabpool.h
+ * @brief Size class slab allocator for objects created and destroyed in bulk
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLSLABPOOL_H
+#define LL_LLSLABPOOL_H
+
+#include "llmemory.h"
+
+#include <mutex>
+#include <vector>
+
+// Hands out 16 byte aligned blocks of up to a maximum size from slabs of
+// SLAB_SIZE bytes, one size class every GRANULARITY bytes. Each slab holds
+// blocks of one size class only, so objects of a kind end up packed next to
+// each other and a freed block is reused by the next object of the same
+// size instead of splitting the general heap. A slab goes back to the heap
+// when its last block is freed, unless it is the only one of its class with
+// room left.
+//
+// Bigger blocks, and all of them when the pool is disabled, come from
+// ll_aligned_malloc_16(). The size passed to deallocate() has to be the one
+// passed to allocate(), which is what a class specific sized operator delete
+// gets, see LL_SLAB_POOL_NEW.
+//
+// Blocks handed out are accounted to the tag of the pool, see
+// LLMemAccounting.
+//
+// A pool must outlive every block it handed out.
+class LL_COMMON_API LLSlabPool
+{
+public:
+    static constexpr size_t SLAB_SIZE = 64 * 1024;
+    static constexpr size_t GRANULARITY = 16;
+
+    LLSlabPool(size_t max_size, bool enabled = sEnabled, LLMemTag tag = LLMemTag::OBJECTS);
+    ~LLSlabPool();
+
+    void* allocate(size_t size);
+    void deallocate(void* ptr, size_t size);
+
+    size_t getSlabCount() const;
+    bool isEnabled() const { return mEnabled; }
+
+    // Whether pools created from now on use slabs
+    static bool sEnabled;
+
+private:
+    struct Slab;
+
+    void linkSlab(U32 size_class, Slab* slab);
+    void unlinkSlab(U32 size_class, Slab* slab);
+
+    std::vector<Slab*>  mPartial;   // per size class, the slabs with room left
+    const size_t        mMaxSize;
+    const bool          mEnabled;
+    const LLMemTag      mTag;
+    size_t              mSlabCount;
+    mutable std::mutex  mMutex;
+};
+
+// Class specific operator new and delete taking the objects from pool. The
+// destructor of a class hierarchy has to be virtual: delete then hands over
+// the size of the most derived class, so one pool serves all of them.
+#define LL_SLAB_POOL_NEW(pool)                      \
+public:                                             \
+    void* operator new(size_t size)                 \
+    {                                               \
+        return (pool).allocate(size);               \
+    }                                               \
+                                                    \
+    void operator delete(void* ptr, size_t size)    \
+    {                                               \
+        (pool).deallocate(ptr, size);               \
+    }                                               \
+                                                    \
+    void* operator new[](size_t size)               \
+    {                                               \
+        return ll_aligned_malloc_16(size);          \
+    }                                               \
+                                                    \
+    void operator delete[](void* ptr)               \
+    {                                               \
+        ll_aligned_free_16(ptr);                    \
+    }
+
+#endif // LL_LLSLABPOOL_H
@@ -42,6 +42,7 @@
 #include "llprocessor.h"
 #include "llerrorcontrol.h"
 #include "llevents.h"
+#include "llframepump.h" // <FS/> Frame pump
 #include "llformat.h"
 #include "llregex.h"
 #include "lltimer.h"
@@ -1207,9 +1208,12 @@ class FrameWatcher
 public:
     FrameWatcher():
         // Hooking onto the "mainloop" event pump gets us one call per frame.
-        mConnection(LLEventPumps::instance()
-                    .obtain("mainloop")
-                    .listen("FrameWatcher", boost::bind(&FrameWatcher::tick, this, _1))),
+        // <FS> Frame pump
+        //mConnection(LLEventPumps::instance()
+        //            .obtain("mainloop")
+        //            .listen("FrameWatcher", boost::bind(&FrameWatcher::tick, this, _1))),
+        mConnection(LLFrameTickPump::instance().listen("FrameWatcher", [this](const LLFrameTick&) { tick(LLSD()); })),
+        // </FS>
         // Initializing mSampleStart to an invalid timestamp alerts us to skip
         // trying to compute framerate on the first call.
         mSampleStart(-1),
@@ -1324,7 +1328,10 @@ public:
 private:
     // Storing the connection in an LLTempBoundListener ensures it will be
     // disconnected when we're destroyed.
-    LLTempBoundListener mConnection;
+    // <FS> Frame pump
+    //LLTempBoundListener mConnection;
+    LLFrameTickPump::TempConnection mConnection;
+    // </FS>
     // Track elapsed time
     LLTimer mTimer;
     // Some of what you see here is in fact redundant with functionality you
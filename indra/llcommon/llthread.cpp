@@ -366,6 +366,8 @@ void LLThread::checkPause()
 
     mDataLock->unlock();
 
+    LLTrace::ThreadRecorder::pushCurrentToParentIfDue(); // <FS/> Push thread stats to the parent
+
     LL_PROFILER_THREAD_END(mName.c_str());
 }
 
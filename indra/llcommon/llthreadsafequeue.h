@@ -36,6 +36,7 @@
 #include <chrono>
 #include <queue>
 #include <string>
+#include <vector> // <FS/> Batched dispatch
 
 /*****************************************************************************
 *   LLThreadSafeQueue
@@ -100,6 +101,15 @@ public:
     template <typename T>
     bool pushIfOpen(T&& element);
 
+    // <FS> Batched dispatch
+    // Add the elements of a range to the queue, moving them, under a single
+    // lock and with a single wakeup of the consumers. Blocks while the queue
+    // is full. Returns how many were added, which is fewer than the range
+    // holds only when the queue is closed before all of them fit.
+    template <typename IT>
+    size_t pushManyIfOpen(IT begin, IT end);
+    // </FS>
+
     // Try to add an element to the queue without blocking. Returns
     // true only if the element was actually added.
     template <typename T>
@@ -143,6 +153,13 @@ public:
     // legacy name
     bool tryPopBack(ElementT & element) { return tryPop(element); }
 
+    // <FS> Batched dispatch
+    // Pop up to max ready elements from the head of the queue under a single
+    // lock, appending them to elements. Does not block. Returns how many
+    // were popped.
+    size_t tryPopMany(std::vector<ElementT>& elements, size_t max);
+    // </FS>
+
     // Pop the element at the head of the queue, blocking if empty, with
     // timeout after specified duration. Returns true if an element was popped.
     template <typename Rep, typename Period>
@@ -347,6 +364,43 @@ bool LLThreadSafeQueue<ElementT, QueueT>::pushIfOpen(T&& element)
 }
 
 
+// <FS> Batched dispatch
+template <typename ElementT, typename QueueT>
+template <typename IT>
+size_t LLThreadSafeQueue<ElementT, QueueT>::pushManyIfOpen(IT begin, IT end)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    size_t pushed = 0;
+    lock_t lock1(mLock);
+    while (begin != end && !mClosed)
+    {
+        if (mStorage.size() >= mCapacity)
+        {
+            // Let the consumers at what is there before waiting for room
+            mEmptyCond.notify_all();
+            mCapacityCond.wait(lock1);
+            continue;
+        }
+
+        mStorage.push(std::move(*begin));
+        ++begin;
+        ++pushed;
+    }
+    lock1.unlock();
+
+    if (pushed == 1)
+    {
+        mEmptyCond.notify_one();
+    }
+    else if (pushed > 1)
+    {
+        mEmptyCond.notify_all();
+    }
+    return pushed;
+}
+// </FS>
+
+
 template <typename ElementT, typename QueueT>
 template<typename T>
 void LLThreadSafeQueue<ElementT, QueueT>::push(T&& element)
@@ -437,7 +491,10 @@ LLThreadSafeQueue<ElementT, QueueT>::pop_(lock_t& lock, ElementT& element)
         return WAITING;
 
     // std::queue::front() is the element about to pop()
-    element = mStorage.front();
+    // <FS> Batched dispatch: move, a copy of a std::function may allocate
+    //element = mStorage.front();
+    element = std::move(mStorage.front());
+    // </FS>
     mStorage.pop();
     lock.unlock();
     // now that we've popped, if somebody's been waiting to push, signal them
@@ -492,6 +549,35 @@ bool LLThreadSafeQueue<ElementT, QueueT>::tryPop(ElementT & element)
 }
 
 
+// <FS> Batched dispatch
+template<typename ElementT, typename QueueT>
+size_t LLThreadSafeQueue<ElementT, QueueT>::tryPopMany(std::vector<ElementT>& elements, size_t max)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    size_t popped = 0;
+    tryLock(
+        [this, &elements, max, &popped](lock_t& lock)
+        {
+            while (popped < max && !mStorage.empty() && canPop(mStorage.front()))
+            {
+                elements.push_back(std::move(mStorage.front()));
+                mStorage.pop();
+                ++popped;
+            }
+            lock.unlock();
+            // now that we've popped, if somebody's been waiting to push,
+            // signal them
+            if (popped)
+            {
+                mCapacityCond.notify_all();
+            }
+            return popped > 0;
+        });
+    return popped;
+}
+// </FS>
+
+
 template <typename ElementT, typename QueueT>
 template <typename Rep, typename Period>
 bool LLThreadSafeQueue<ElementT, QueueT>::tryPopFor(
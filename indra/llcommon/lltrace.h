@@ -40,6 +40,15 @@
 
 #define LL_TRACE_ENABLED 1
 
+// <FS> Compile time switch for the non-essential stats. Block timers only
+// feed the fast timer view; with LL_TRACE_ESSENTIAL_ONLY they are compiled
+// out and only the counts, samples and events the statistics floater and
+// the viewer stats report are recorded.
+#ifndef LL_TRACE_ESSENTIAL_ONLY
+#define LL_TRACE_ESSENTIAL_ONLY 0
+#endif
+// </FS>
+
 namespace LLTrace
 {
 class Recording;
@@ -87,6 +96,17 @@ public:
         return accumulator_storage ? accumulator_storage[mAccumulatorIndex] : (*AccumulatorBuffer<ACCUMULATOR>::getDefaultBuffer())[mAccumulatorIndex];
     }
 
+    // <FS> Accumulator of the calling thread, NULL on threads without a
+    // ThreadRecorder. Writing into the default buffer from those threads
+    // would race with every other such thread and leak into the initial
+    // values of each new buffer, so their samples are dropped instead.
+    LL_FORCE_INLINE ACCUMULATOR* getThreadAccumulator() const
+    {
+        ACCUMULATOR* accumulator_storage = LLThreadLocalSingletonPointer<ACCUMULATOR>::getInstance();
+        return accumulator_storage ? &accumulator_storage[mAccumulatorIndex] : NULL;
+    }
+    // </FS>
+
     size_t getIndex() const { return mAccumulatorIndex; }
     static size_t getNumIndices() { return AccumulatorBuffer<ACCUMULATOR>::getNumIndices(); }
 
@@ -138,8 +158,15 @@ template<typename T, typename VALUE_T>
 void record(EventStatHandle<T>& measurement, VALUE_T value)
 {
 #if LL_TRACE_ENABLED
-    T converted_value(value);
-    measurement.getCurrentAccumulator().record(storage_value(converted_value));
+    // <FS> Only record into the buffers of the calling thread
+    //T converted_value(value);
+    //measurement.getCurrentAccumulator().record(storage_value(converted_value));
+    if (EventAccumulator* accumulator = measurement.getThreadAccumulator())
+    {
+        T converted_value(value);
+        accumulator->record(storage_value(converted_value));
+    }
+    // </FS>
 #endif
 }
 
@@ -163,8 +190,15 @@ template<typename T, typename VALUE_T>
 void sample(SampleStatHandle<T>& measurement, VALUE_T value)
 {
 #if LL_TRACE_ENABLED
-    T converted_value(value);
-    measurement.getCurrentAccumulator().sample(storage_value(converted_value));
+    // <FS> Only record into the buffers of the calling thread
+    //T converted_value(value);
+    //measurement.getCurrentAccumulator().sample(storage_value(converted_value));
+    if (SampleAccumulator* accumulator = measurement.getThreadAccumulator())
+    {
+        T converted_value(value);
+        accumulator->sample(storage_value(converted_value));
+    }
+    // </FS>
 #endif
 }
 
@@ -179,35 +213,48 @@ public:
 
     CountStatHandle(const char* name, const char* description = NULL)
     :   stat_t(name, description)
-    , mTotalSamplesCount(0)
-    , mTotalSamples(0.0)
+    // <FS> The lifetime totals were written by every recording thread into
+    // the shared handle and nothing reads them
+    //, mTotalSamplesCount(0)
+    //, mTotalSamples(0.0)
+    // </FS>
     {}
 
     /*virtual*/ const char* getUnitLabel() const { return LLGetUnitLabel<T>::getUnitLabel(); }
 
-    // <FS:ND> Add a stats global count. Which will accumulate all samples over the applicaton lifetime.
-    void add( T const &samples )
-    {
-        ++mTotalSamplesCount;
-        mTotalSamples += samples;
-    }
-
-    T getTotalSamples() const { return mTotalSamples; }
-    U64 getTotalSampleCount() const { return mTotalSamplesCount; }
-
-private:
-    U64 mTotalSamplesCount;
-    T mTotalSamples;
-    // </FS:ND>
+    // <FS> The lifetime totals were written by every recording thread into
+    // the shared handle and nothing reads them
+    //// <FS:ND> Add a stats global count. Which will accumulate all samples over the applicaton lifetime.
+    //void add( T const &samples )
+    //{
+    //    ++mTotalSamplesCount;
+    //    mTotalSamples += samples;
+    //}
+
+    //T getTotalSamples() const { return mTotalSamples; }
+    //U64 getTotalSampleCount() const { return mTotalSamplesCount; }
+
+//private:
+    //U64 mTotalSamplesCount;
+    //T mTotalSamples;
+    //// </FS:ND>
+    // </FS>
 };
 
 template<typename T, typename VALUE_T>
 void add(CountStatHandle<T>& count, VALUE_T value)
 {
 #if LL_TRACE_ENABLED
-    T converted_value(value);
-    count.getCurrentAccumulator().add(storage_value(converted_value));
-    count.add( value ); // <FS:ND/> Add a stats global count. Which will accumulate all samples over the applicaton lifetime.
+    // <FS> Only record into the buffers of the calling thread
+    //T converted_value(value);
+    //count.getCurrentAccumulator().add(storage_value(converted_value));
+    //count.add( value ); // <FS:ND/> Add a stats global count. Which will accumulate all samples over the applicaton lifetime.
+    if (CountAccumulator* accumulator = count.getThreadAccumulator())
+    {
+        T converted_value(value);
+        accumulator->add(storage_value(converted_value));
+    }
+    // </FS>
 #endif
 }
 
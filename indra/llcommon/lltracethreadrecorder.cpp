@@ -36,12 +36,18 @@ namespace LLTrace
 
 static ThreadRecorder* sMasterThreadRecorder = NULL;
 
+// <FS> How often child threads hand their buffers to the parent. The main
+// thread pulls them in once per frame.
+static const U64 PUSH_TO_PARENT_INTERVAL_USEC = 50000;
+// </FS>
+
 ///////////////////////////////////////////////////////////////////////
 // ThreadRecorder
 ///////////////////////////////////////////////////////////////////////
 
 ThreadRecorder::ThreadRecorder()
-:   mParentRecorder(NULL)
+:   mParentRecorder(NULL),
+    mLastPushTime(0) // <FS/> Push child thread buffers to the parent
 {
     init();
 }
@@ -89,7 +95,8 @@ void ThreadRecorder::init()
 
 
 ThreadRecorder::ThreadRecorder( ThreadRecorder& parent )
-:   mParentRecorder(&parent)
+:   mParentRecorder(&parent),
+    mLastPushTime(0) // <FS/> Push child thread buffers to the parent
 {
     init();
     mParentRecorder->addChildRecorder(this);
@@ -120,6 +127,13 @@ ThreadRecorder::~ThreadRecorder()
 
     if (mParentRecorder)
     {
+        // <FS> Hand what was recorded since the last push to the parent,
+        // removeChildRecorder() keeps it for the next pull
+        {
+            LLMutexLock lock(&mSharedRecordingMutex);
+            mSharedRecordingBuffers.append(mThreadRecordingBuffers);
+        }
+        // </FS>
         mParentRecorder->removeChildRecorder(this);
     }
 #endif
@@ -259,6 +273,13 @@ void ThreadRecorder::removeChildRecorder(ThreadRecorder* child)
 #if LL_TRACE_ENABLED
     LLMutexLock lock(&mChildListMutex);
     mChildThreadRecorders.remove(child);
+    // <FS> Keep the last data of the child for the next pull
+    {
+        LLMutexLock child_lock(&child->mSharedRecordingMutex);
+        mRetiredRecordingBuffers.merge(child->mSharedRecordingBuffers);
+        child->mSharedRecordingBuffers.reset();
+    }
+    // </FS>
 #endif
 }
 
@@ -275,6 +296,38 @@ void ThreadRecorder::pushToParent()
 #endif
 }
 
+// <FS> Called by child threads from their loops. Recording only touches the
+// buffers of the thread, they are merged into the parent a few times per
+// frame instead of sharing any state while recording.
+void ThreadRecorder::pushToParentIfDue()
+{
+#if LL_TRACE_ENABLED
+    if (!mParentRecorder)
+    {
+        return;
+    }
+
+    U64 now = totalTime();
+    if (now - mLastPushTime >= PUSH_TO_PARENT_INTERVAL_USEC)
+    {
+        mLastPushTime = now;
+        pushToParent();
+    }
+#endif
+}
+
+// static
+void ThreadRecorder::pushCurrentToParentIfDue()
+{
+#if LL_TRACE_ENABLED
+    if (ThreadRecorder* recorder = LLTrace::get_thread_recorder())
+    {
+        recorder->pushToParentIfDue();
+    }
+#endif
+}
+// </FS>
+
 
 void ThreadRecorder::pullFromChildren()
 {
@@ -291,6 +344,10 @@ void ThreadRecorder::pullFromChildren()
             target_recording_buffers.merge(rec->mSharedRecordingBuffers);
             rec->mSharedRecordingBuffers.reset();
         }
+        // <FS> Last data of child threads that have ended since
+        target_recording_buffers.merge(mRetiredRecordingBuffers);
+        mRetiredRecordingBuffers.reset();
+        // </FS>
     }
 #endif
 }
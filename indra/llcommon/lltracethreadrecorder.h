@@ -56,6 +56,10 @@ namespace LLTrace
         // call this periodically to gather stats data from child threads
         void pullFromChildren();
         void pushToParent();
+        // <FS> Rate limited pushToParent() for the loops of child threads
+        void pushToParentIfDue();
+        static void pushCurrentToParentIfDue();
+        // </FS>
 
         TimeBlockTreeNode* getTimeBlockTreeNode(size_t index);
 
@@ -88,6 +92,10 @@ namespace LLTrace
         LLMutex                         mSharedRecordingMutex;
         AccumulatorBufferGroup          mSharedRecordingBuffers;
         ThreadRecorder*                 mParentRecorder;
+        // <FS> Push child thread buffers to the parent
+        U64                             mLastPushTime;              // child side, in microseconds
+        AccumulatorBufferGroup          mRetiredRecordingBuffers;   // parent side, protected by mChildListMutex
+        // </FS>
 
     };
 
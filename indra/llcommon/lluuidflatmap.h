@@ -0,0 +1,49 @@
+/**
+ * @file lluuidflatmap.h
+ * @brief Open addressing hash map and set keyed by LLUUID
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLUUIDFLATMAP_H
+#define LL_LLUUIDFLATMAP_H
+
+#include "lluuid.h"
+
+#include <boost/unordered/unordered_flat_map.hpp>
+#include <boost/unordered/unordered_flat_set.hpp>
+
+// Hash containers for LLUUID keys that keep keys and values in one open
+// addressing array, so a lookup touches a cache line or two instead of
+// walking tree nodes or bucket chains. Keys are hashed with FSUUIDHash,
+// the first word of the id, which boost mixes itself since the hash isn't
+// marked as avalanching.
+//
+// Unlike std::map, iteration order is unspecified and an insertion may
+// move every element: keep neither iterators nor pointers to elements
+// across one. Erasing leaves the other elements where they are.
+template <typename T>
+using LLUUIDFlatMap = boost::unordered_flat_map<LLUUID, T, FSUUIDHash>;
+
+using LLUUIDFlatSet = boost::unordered_flat_set<LLUUID, FSUUIDHash>;
+
+#endif // LL_LLUUIDFLATMAP_H
@@ -33,6 +33,7 @@
 #include "../llerror.h"
 
 #include "../llerrorcontrol.h"
+#include "../llfile.h"
 #include "../llsd.h"
 
 #include "../test/lltut.h"
@@ -919,6 +920,41 @@ namespace tut
         ensure_message_field_equals(0, MSG_FIELD, expected);
         ensure("fatal callback called", fatalWasCalled);
     }
+
+    template<> template<>
+    void ErrorTestObject::test<19>()
+        // an asynchronous log file has everything after flushLogs()
+    {
+        const std::string filename("llerror_test_async.log");
+        LLFile::remove(filename);
+        LLError::setAsyncLogging(true);
+        LLError::logToFile(filename);
+        ensure_equals("log file name", LLError::logFileName(), filename);
+
+        for (int i = 0; i < 5000; ++i)
+        {
+            LL_INFOS("AsyncLog") << "async line " << i << LL_ENDL;
+        }
+        LLError::flushLogs();
+
+        int count = 0;
+        std::string line, last;
+        llifstream file(filename.c_str());
+        while (std::getline(file, line))
+        {
+            if (line.find("async line ") != std::string::npos)
+            {
+                ++count;
+                last = line;
+            }
+        }
+        file.close();
+        LLError::logToFile("");
+        LLFile::remove(filename);
+
+        ensure_equals("lines written", count, 5000);
+        ensure_contains("in order", last, "async line 4999");
+    }
 }
 
 /* Tests left:
@@ -0,0 +1,142 @@
+/**
+ * @file llframepump_test.cpp
+ * @brief Tests for LLFramePump
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llframepump.h"
+
+#include "../test/lltut.h"
+
+#include <vector>
+
+namespace
+{
+    struct Tick
+    {
+        S32 mValue = 0;
+    };
+    typedef LLFramePump<Tick> pump_t;
+}
+
+namespace tut
+{
+    struct frame_pump
+    {
+    };
+    typedef test_group<frame_pump> frame_pump_t;
+    typedef frame_pump_t::object frame_pump_object_t;
+    tut::frame_pump_t tut_frame_pump("LLFramePump");
+
+    template<> template<>
+    void frame_pump_object_t::test<1>()
+    {
+        set_test_name("listeners are called in order with the payload");
+
+        pump_t pump("test");
+        std::vector<S32> calls;
+        pump_t::TempConnection first(pump.listen("first", [&calls](const Tick& tick) { calls.push_back(tick.mValue); }));
+        pump_t::TempConnection second(pump.listen("second", [&calls](const Tick& tick) { calls.push_back(tick.mValue * 10); }));
+        ensure_equals("listeners", pump.size(), (size_t)2);
+
+        pump.post({ 3 });
+        ensure_equals("calls", calls.size(), (size_t)2);
+        ensure_equals("first", calls[0], 3);
+        ensure_equals("second", calls[1], 30);
+    }
+
+    template<> template<>
+    void frame_pump_object_t::test<2>()
+    {
+        set_test_name("disconnect and TempConnection");
+
+        pump_t pump("test");
+        S32 calls = 0;
+        pump_t::Connection connection = pump.listen("counter", [&calls](const Tick&) { ++calls; });
+        {
+            pump_t::TempConnection temp(pump.listen("temp", [&calls](const Tick&) { calls += 100; }));
+            pump.post({});
+            ensure_equals("both called", calls, 101);
+        }
+        pump.post({});
+        ensure_equals("temp gone", calls, 102);
+
+        ensure("connected", connection.connected());
+        connection.disconnect();
+        ensure("disconnected", !connection.connected());
+        pump.post({});
+        ensure_equals("none left", calls, 102);
+        ensure_equals("empty", pump.size(), (size_t)0);
+
+        // Twice is harmless
+        connection.disconnect();
+    }
+
+    template<> template<>
+    void frame_pump_object_t::test<3>()
+    {
+        set_test_name("changes during post");
+
+        pump_t pump("test");
+        std::vector<std::string> calls;
+        pump_t::Connection self;
+        pump_t::Connection victim;
+        pump_t::TempConnection added;
+
+        self = pump.listen("self", [&](const Tick&)
+        {
+            calls.push_back("self");
+            // Disconnect ourselves and the next one, and add a new one
+            self.disconnect();
+            victim.disconnect();
+            added = pump.listen("added", [&calls](const Tick&) { calls.push_back("added"); });
+        });
+        victim = pump.listen("victim", [&calls](const Tick&) { calls.push_back("victim"); });
+
+        pump.post({});
+        ensure_equals("calls in the first post", calls.size(), (size_t)1);
+        ensure_equals("self ran", calls[0], std::string("self"));
+        ensure_equals("only the new one is left", pump.size(), (size_t)1);
+
+        pump.post({});
+        ensure_equals("calls in the second post", calls.size(), (size_t)2);
+        ensure_equals("added ran", calls[1], std::string("added"));
+    }
+
+    template<> template<>
+    void frame_pump_object_t::test<4>()
+    {
+        set_test_name("connection outlives the pump");
+
+        pump_t::TempConnection connection;
+        {
+            pump_t pump("test");
+            connection = pump.listen("late", [](const Tick&) {});
+            ensure("connected", connection.connected());
+        }
+        ensure("pump gone", !connection.connected());
+        // ~TempConnection must not touch the dead pump
+    }
+}
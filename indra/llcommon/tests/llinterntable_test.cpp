@@ -0,0 +1,119 @@
+/**
+ * @file llinterntable_test.cpp
+ * @brief Tests for the string intern table
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+
+#include "linden_common.h"
+
+#include "../llinterntable.h"
+#include "../llstring.h"
+
+#include "../test/lltut.h"
+
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace tut
+{
+    struct intern_table
+    {
+    };
+    typedef test_group<intern_table> intern_table_t;
+    typedef intern_table_t::object intern_table_object_t;
+    tut::intern_table_t tut_intern_table("LLInternTable");
+
+    // same text, same entry, across growing shards
+    template<> template<>
+    void intern_table_object_t::test<1>()
+    {
+        LLInternTable table(8);
+        ensure("empty", table.find("mPelvis") == nullptr);
+
+        std::vector<const LLInternTable::Entry*> entries;
+        for (U32 i = 0; i < 2000; ++i)
+        {
+            entries.push_back(table.intern(llformat("joint %u", i)));
+        }
+        ensure_equals("size", table.size(), 2000U);
+
+        std::set<U32> ids;
+        for (U32 i = 0; i < 2000; ++i)
+        {
+            const std::string name = llformat("joint %u", i);
+            ensure("same entry", table.intern(name) == entries[i]);
+            ensure("found", table.find(name) == entries[i]);
+            ensure_equals("text", entries[i]->mString, name);
+            ids.insert(entries[i]->mId);
+        }
+        ensure_equals("still the same size", table.size(), 2000U);
+        ensure_equals("ids distinct", ids.size(), (size_t)2000);
+        ensure_equals("ids from 1", *ids.begin(), 1U);
+        ensure_equals("ids dense", *ids.rbegin(), 2000U);
+
+        // a Key hashes once
+        LLInternTable::Key key("joint 7");
+        ensure("key", table.find(key) == entries[7]);
+        ensure("not a prefix", table.find("joint") == nullptr);
+    }
+
+    // threads interning the same names end up with the same entries
+    template<> template<>
+    void intern_table_object_t::test<2>()
+    {
+        LLInternTable table(8);
+        constexpr U32 THREADS = 4;
+        constexpr U32 NAMES = 5000;
+        std::vector<std::vector<const LLInternTable::Entry*>> seen(THREADS);
+        std::vector<std::thread> threads;
+        for (U32 t = 0; t < THREADS; ++t)
+        {
+            threads.emplace_back([&table, &seen, t]()
+            {
+                for (U32 i = 0; i < NAMES; ++i)
+                {
+                    // each thread in another order
+                    const U32 n = (i * (2 * t + 1)) % NAMES;
+                    seen[t].push_back(table.intern(llformat("name %u", n)));
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        ensure_equals("size", table.size(), NAMES);
+        for (U32 t = 0; t < THREADS; ++t)
+        {
+            for (U32 i = 0; i < NAMES; ++i)
+            {
+                const U32 n = (i * (2 * t + 1)) % NAMES;
+                ensure("same entry for every thread", seen[t][i] == table.find(llformat("name %u", n)));
+            }
+        }
+    }
+}
@@ -0,0 +1,135 @@
+/**
+ * @file llmemory_test.cpp
+ * @brief Tests for memory accounting and the frame arena
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llmemory.h"
+
+#include "../test/lltut.h"
+
+#include <cstring>
+#include <vector>
+
+namespace tut
+{
+    struct memory_data
+    {
+    };
+    typedef test_group<memory_data> memory_t;
+    typedef memory_t::object memory_object_t;
+    tut::memory_t tut_memory("LLMemory");
+
+    // claims and disclaims add up per tag, the peak stays
+    template<> template<>
+    void memory_object_t::test<1>()
+    {
+        const S64 bytes = LLMemAccounting::getBytes(LLMemTag::AUDIO);
+        const S64 other = LLMemAccounting::getBytes(LLMemTag::MESH);
+        const U64 allocations = LLMemAccounting::getAllocations(LLMemTag::AUDIO);
+
+        LLMemAccounting::claim(LLMemTag::AUDIO, 1000);
+        LLMemAccounting::claim(LLMemTag::AUDIO, 500);
+        ensure_equals("claimed", LLMemAccounting::getBytes(LLMemTag::AUDIO), bytes + 1500);
+        ensure_equals("allocations", LLMemAccounting::getAllocations(LLMemTag::AUDIO), allocations + 2);
+        ensure("peak", LLMemAccounting::getPeakBytes(LLMemTag::AUDIO) >= bytes + 1500);
+
+        LLMemAccounting::disclaim(LLMemTag::AUDIO, 1500);
+        ensure_equals("disclaimed", LLMemAccounting::getBytes(LLMemTag::AUDIO), bytes);
+        ensure("peak kept", LLMemAccounting::getPeakBytes(LLMemTag::AUDIO) >= bytes + 1500);
+        ensure_equals("other tag untouched", LLMemAccounting::getBytes(LLMemTag::MESH), other);
+    }
+
+    // containers on a tagged allocator account their storage
+    template<> template<>
+    void memory_object_t::test<2>()
+    {
+        const S64 bytes = LLMemAccounting::getBytes(LLMemTag::INVENTORY);
+        {
+            std::vector<U32, LLTaggedAllocator<U32, LLMemTag::INVENTORY> > values;
+            values.reserve(1000);
+            ensure_equals("storage claimed", LLMemAccounting::getBytes(LLMemTag::INVENTORY), bytes + (S64)(1000 * sizeof(U32)));
+            values.resize(5000);
+            ensure_equals("regrown storage claimed", LLMemAccounting::getBytes(LLMemTag::INVENTORY),
+                          bytes + (S64)(values.capacity() * sizeof(U32)));
+        }
+        ensure_equals("storage disclaimed", LLMemAccounting::getBytes(LLMemTag::INVENTORY), bytes);
+    }
+
+    // frame arena blocks are aligned, don't overlap and are reused after reset
+    template<> template<>
+    void memory_object_t::test<3>()
+    {
+        LLFrameArena::reset();
+        U8* first = (U8*)LLFrameArena::allocate(100);
+        U8* second = (U8*)LLFrameArena::allocate(100, 64);
+        ensure("aligned", ((uintptr_t)first & 0xF) == 0);
+        ensure("over aligned", ((uintptr_t)second & 0x3F) == 0);
+        ensure("no overlap", second >= first + 100);
+        memset(first, 1, 100);
+        memset(second, 2, 100);
+        ensure_equals("used", LLFrameArena::getUsed(), (size_t)200);
+
+        // more than a chunk, and one too big for any chunk
+        std::vector<void*> blocks;
+        for (U32 i = 0; i < 100; ++i)
+        {
+            blocks.push_back(LLFrameArena::allocate(4096));
+            memset(blocks.back(), i, 4096);
+        }
+        void* big = LLFrameArena::allocate(LLFrameArena::CHUNK_SIZE * 2);
+        memset(big, 3, LLFrameArena::CHUNK_SIZE * 2);
+        ensure("high water", LLFrameArena::getHighWater() >= LLFrameArena::CHUNK_SIZE * 2);
+        ensure("frame memory accounted", LLMemAccounting::getBytes(LLMemTag::FRAME) >= (S64)(LLFrameArena::CHUNK_SIZE * 3));
+
+        const S64 accounted = LLMemAccounting::getBytes(LLMemTag::FRAME);
+        LLFrameArena::reset();
+        ensure_equals("used after reset", LLFrameArena::getUsed(), (size_t)0);
+        ensure("oversized block released", LLMemAccounting::getBytes(LLMemTag::FRAME) < accounted);
+        ensure("chunk reused", LLFrameArena::allocate(100) == first);
+        LLFrameArena::reset();
+    }
+
+    // containers on the frame allocator
+    template<> template<>
+    void memory_object_t::test<4>()
+    {
+        LLFrameArena::reset();
+        std::vector<U32, LLFrameAllocator<U32> > values;
+        for (U32 i = 0; i < 10000; ++i)
+        {
+            values.push_back(i);
+        }
+        U32 sum = 0;
+        for (U32 value : values)
+        {
+            sum += value;
+        }
+        ensure_equals("values kept", sum, (U32)(9999 * 10000 / 2));
+        values.clear();
+        values.shrink_to_fit();
+        LLFrameArena::reset();
+    }
+}
@@ -0,0 +1,121 @@
+/**
+ * @file llradixsort_test.cpp
+ * @brief Tests for the radix sort of 64 bit keys
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llradixsort.h"
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+    struct radix_sort
+    {
+        // small deterministic generator, the keys must be the same on every run
+        U64 mState = 0x9E3779B97F4A7C15ULL;
+
+        U64 next()
+        {
+            mState ^= mState << 13;
+            mState ^= mState >> 7;
+            mState ^= mState << 17;
+            return mState;
+        }
+    };
+    typedef test_group<radix_sort> radix_sort_t;
+    typedef radix_sort_t::object radix_sort_object_t;
+    tut::radix_sort_t tut_radix_sort("LLRadixSort");
+
+    // random keys in every byte sort like std::sort
+    template<> template<>
+    void radix_sort_object_t::test<1>()
+    {
+        std::vector<U64> keys(5000);
+        for (U64& key : keys)
+        {
+            key = next();
+        }
+
+        std::vector<U64> expected = keys;
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<U64> scratch;
+        ll_radix_sort(keys, scratch);
+        ensure("random keys", keys == expected);
+    }
+
+    // keys with few distinct bytes, passes get skipped and the result must
+    // still end up in keys
+    template<> template<>
+    void radix_sort_object_t::test<2>()
+    {
+        for (U32 shift = 0; shift < 64; shift += 8)
+        {
+            std::vector<U64> keys(300);
+            for (U64& key : keys)
+            {
+                key = (next() & 0xFF) << shift;
+            }
+
+            std::vector<U64> expected = keys;
+            std::sort(expected.begin(), expected.end());
+
+            std::vector<U64> scratch;
+            ll_radix_sort(keys, scratch);
+            ensure("single byte keys", keys == expected);
+        }
+
+        std::vector<U64> keys(100, 42);
+        std::vector<U64> scratch;
+        ll_radix_sort(keys, scratch);
+        ensure("equal keys", keys == std::vector<U64>(100, 42));
+    }
+
+    // short arrays
+    template<> template<>
+    void radix_sort_object_t::test<3>()
+    {
+        std::vector<U64> keys;
+        std::vector<U64> scratch;
+        ll_radix_sort(keys, scratch);
+        ensure("empty", keys.empty());
+
+        keys = { 3, 1, 2 };
+        ll_radix_sort(keys, scratch);
+        ensure("three keys", keys == std::vector<U64>({ 1, 2, 3 }));
+    }
+
+    // float keys order like the floats
+    template<> template<>
+    void radix_sort_object_t::test<4>()
+    {
+        const F32 values[] = { -1000.f, -2.5f, -1.f, -0.f, 0.f, 1e-20f, 0.5f, 1.f, 3.f, 1e20f };
+        for (U32 i = 1; i < LL_ARRAY_SIZE(values); ++i)
+        {
+            ensure("float order", ll_float_sort_key(values[i - 1]) < ll_float_sort_key(values[i]));
+        }
+    }
+}
@@ -0,0 +1,573 @@
+/**
+ * @file llsd_bench.cpp
+ * @brief Throughput and allocation benchmarks of LLSD serialization
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmemorystream.h"
+#include "llsd.h"
+#include "llsdarena.h"
+#include "llsdjson.h"
+#include "llsdserialize.h"
+#include "llsdsink.h"
+
+#include <boost/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Parses and formats payloads shaped like what the viewer actually moves
+// through LLSD, with every parser and formatter, and reports the throughput
+// in MB/s of serialized text and the heap allocations per LLSD node. Meant
+// as the baseline for LLSD and serializer changes.
+//
+// Every benchmark is calibrated to run for at least MIN_EPOCH_TIME per
+// epoch, the median of EPOCHS epochs is reported with the spread between
+// the fastest and slowest one. Allocations are counted over one extra run.
+//
+// Usage: llsd_bench [--csv] [filter]
+// Only benchmarks whose name contains filter are run.
+
+// Count heap allocations, unless llcommon replaces operator new for Tracy
+#if !(TRACY_ENABLE && LL_PROFILER_ENABLE_TRACY_MEMORY)
+#define LLSD_BENCH_COUNT_ALLOCATIONS 1
+
+static std::atomic<U64> sAllocations{ 0 };
+
+void* operator new(size_t size)
+{
+    sAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+#endif
+
+namespace
+{
+    constexpr S32 EPOCHS = 11;
+    constexpr auto MIN_EPOCH_TIME = std::chrono::milliseconds(20);
+
+    // ------------------------------------------------------------------------
+    // Payloads
+
+    U32 sSeed = 1;
+
+    U32 next_random()
+    {
+        sSeed = sSeed * 1664525 + 1013904223;
+        return sSeed >> 8;
+    }
+
+    LLUUID make_id()
+    {
+        U32 words[4] = { next_random(), next_random(), next_random(), next_random() };
+        LLUUID id;
+        memcpy(id.mData, words, sizeof(words));
+        return id;
+    }
+
+    std::string make_name(const char* prefix)
+    {
+        return llformat("%s %u", prefix, next_random() % 100000);
+    }
+
+    LLSD make_permissions()
+    {
+        LLSD perms;
+        perms["base_mask"] = (LLSD::Integer)0x7fffffff;
+        perms["everyone_mask"] = 0;
+        perms["group_mask"] = 0;
+        perms["next_owner_mask"] = (LLSD::Integer)0x82000;
+        perms["owner_mask"] = (LLSD::Integer)0x7fffffff;
+        perms["creator_id"] = make_id();
+        perms["owner_id"] = make_id();
+        perms["last_owner_id"] = make_id();
+        perms["group_id"] = LLUUID::null;
+        perms["is_owner_group"] = false;
+        return perms;
+    }
+
+    LLSD make_item(const LLUUID& parent_id)
+    {
+        LLSD item;
+        item["item_id"] = make_id();
+        item["parent_id"] = parent_id;
+        item["asset_id"] = make_id();
+        item["name"] = make_name("Item");
+        item["desc"] = (next_random() % 4) ? std::string("(No Description)") : make_name("A longer description of the item");
+        item["type"] = (LLSD::Integer)(next_random() % 25);
+        item["inv_type"] = (LLSD::Integer)(next_random() % 20);
+        item["flags"] = (LLSD::Integer)(next_random() % 0x10000);
+        item["created_at"] = (LLSD::Integer)(1200000000 + next_random() % 500000000);
+        item["permissions"] = make_permissions();
+        LLSD& sale = item["sale_info"];
+        sale["sale_price"] = 10;
+        sale["sale_type"] = 0;
+        return item;
+    }
+
+    LLSD make_category(const LLUUID& parent_id)
+    {
+        LLSD cat;
+        cat["category_id"] = make_id();
+        cat["parent_id"] = parent_id;
+        cat["agent_id"] = make_id();
+        cat["name"] = make_name("Folder");
+        cat["type_default"] = -1;
+        cat["version"] = (LLSD::Integer)(next_random() % 1000);
+        cat["descendents"] = (LLSD::Integer)(next_random() % 200);
+        return cat;
+    }
+
+    // An AIS3 folder fetch with its children embedded
+    LLSD make_ais_response()
+    {
+        const LLUUID folder_id = make_id();
+        LLSD response = make_category(make_id());
+        response["category_id"] = folder_id;
+
+        LLSD& embedded = response["_embedded"];
+        LLSD& items = embedded["items"];
+        for (S32 i = 0; i < 250; ++i)
+        {
+            LLSD item = make_item(folder_id);
+            item["_links"]["self"]["href"] = "/item/" + item["item_id"].asString();
+            items[item["item_id"].asString()] = item;
+        }
+        LLSD& categories = embedded["categories"];
+        for (S32 i = 0; i < 30; ++i)
+        {
+            LLSD cat = make_category(folder_id);
+            categories[cat["category_id"].asString()] = cat;
+        }
+        response["_links"]["self"]["href"] = "/category/" + folder_id.asString() + "/children";
+        response["_base_uri"] = "https://cap.example.com/cap/00000000-0000-0000-0000-000000000000";
+        return response;
+    }
+
+    // What the inventory cache holds, as one array
+    LLSD make_inventory_cache()
+    {
+        LLSD cache = LLSD::emptyArray();
+        LLUUID parent_id = make_id();
+        for (S32 i = 0; i < 5000; ++i)
+        {
+            if (i % 40 == 0)
+            {
+                LLSD cat = make_category(parent_id);
+                parent_id = cat["category_id"].asUUID();
+                cache.append(cat);
+            }
+            cache.append(make_item(parent_id));
+        }
+        return cache;
+    }
+
+    // GLTF material overrides of a region, as the simulator sends them
+    LLSD make_material_overrides()
+    {
+        LLSD overrides = LLSD::emptyArray();
+        for (S32 i = 0; i < 300; ++i)
+        {
+            LLSD object;
+            object["object_id"] = (LLSD::Integer)(next_random() % 1000000);
+            LLSD& sides = object["sides"];
+            LLSD& gltf_json = object["gltf_json"];
+            for (S32 side = 0; side < 1 + (S32)(next_random() % 6); ++side)
+            {
+                sides.append(side);
+                gltf_json.append(llformat("{\"asset\":{\"version\":\"2.0\"},\"materials\":[{\"pbrMetallicRoughness\":"
+                                          "{\"baseColorFactor\":[%.3f,%.3f,%.3f,1.0],\"metallicFactor\":0.%u,"
+                                          "\"roughnessFactor\":0.%u}}]}",
+                                          (next_random() % 1000) / 1000.f, (next_random() % 1000) / 1000.f,
+                                          (next_random() % 1000) / 1000.f, next_random() % 10, next_random() % 10));
+            }
+            overrides.append(object);
+        }
+        return overrides;
+    }
+
+    // One event queue poll with a mix of the usual messages
+    LLSD make_event_queue_bundle()
+    {
+        LLSD bundle;
+        LLSD& events = bundle["events"];
+        for (S32 i = 0; i < 120; ++i)
+        {
+            LLSD event;
+            LLSD& body = event["body"];
+            switch (i % 3)
+            {
+            case 0:
+                {
+                    event["message"] = "ObjectPhysicsProperties";
+                    LLSD props;
+                    props["LocalID"] = (LLSD::Integer)(next_random() % 1000000);
+                    props["Density"] = 1000.0;
+                    props["Friction"] = 0.6;
+                    props["GravityMultiplier"] = 1.0;
+                    props["Restitution"] = 0.5;
+                    props["PhysicsShapeType"] = 0;
+                    body["ObjectData"].append(props);
+                }
+                break;
+            case 1:
+                {
+                    event["message"] = "AgentGroupDataUpdate";
+                    body["AgentData"].append(LLSD().with("AgentID", make_id()));
+                    for (S32 g = 0; g < 10; ++g)
+                    {
+                        LLSD group;
+                        group["GroupID"] = make_id();
+                        group["GroupName"] = make_name("Group");
+                        group["GroupPowers"] = LLSD::Binary(8, (U8)g);
+                        group["AcceptNotices"] = true;
+                        group["GroupInsigniaID"] = make_id();
+                        group["Contribution"] = 0;
+                        body["GroupData"].append(group);
+                    }
+                }
+                break;
+            default:
+                {
+                    event["message"] = "ChatterBoxSessionAgentListUpdates";
+                    body["session_id"] = make_id();
+                    LLSD& agents = body["agent_updates"];
+                    for (S32 a = 0; a < 5; ++a)
+                    {
+                        LLSD& info = agents[make_id().asString()]["info"];
+                        info["can_voice_chat"] = true;
+                        info["is_moderator"] = false;
+                        info["mutes"]["text"] = false;
+                    }
+                }
+                break;
+            }
+            events.append(event);
+        }
+        bundle["id"] = 1234;
+        return bundle;
+    }
+
+    // A display name lookup of a busy region
+    LLSD make_avatar_names()
+    {
+        LLSD response;
+        LLSD& agents = response["agents"];
+        for (S32 i = 0; i < 500; ++i)
+        {
+            LLSD agent;
+            agent["id"] = make_id();
+            agent["username"] = llformat("resident%u", next_random() % 1000000);
+            agent["display_name"] = make_name("Display Name");
+            agent["legacy_first_name"] = llformat("Resident%u", next_random() % 1000000);
+            agent["legacy_last_name"] = "Resident";
+            agent["is_display_name_default"] = (next_random() % 3) == 0;
+            agent["display_name_next_update"] = LLDate((F64)(1700000000 + next_random() % 100000000));
+            agents.append(agent);
+        }
+        response["bad_ids"] = LLSD::emptyArray();
+        return response;
+    }
+
+    U32 count_nodes(const LLSD& sd)
+    {
+        U32 count = 1;
+        if (sd.isMap())
+        {
+            for (LLSD::map_const_iterator it = sd.beginMap(); it != sd.endMap(); ++it)
+            {
+                count += count_nodes(it->second);
+            }
+        }
+        else if (sd.isArray())
+        {
+            for (LLSD::array_const_iterator it = sd.beginArray(); it != sd.endArray(); ++it)
+            {
+                count += count_nodes(*it);
+            }
+        }
+        return count;
+    }
+
+    // Takes every event and does nothing with it, the cost of the parse alone
+    class NullSink : public LLSDSink
+    {
+    public:
+        void onString(const LLSD::String& value) override   { mCount += (U32)value.size(); }
+        void onMapKey(const LLSD::String& key) override     { mCount += (U32)key.size(); }
+        U32 mCount = 0;
+    };
+
+    // ------------------------------------------------------------------------
+    // Harness
+
+    class Bench
+    {
+    public:
+        Bench(const std::string& filter, bool csv) : mFilter(filter), mCSV(csv) {}
+
+        void header() const
+        {
+            if (mCSV)
+            {
+                printf("name,bytes,nodes,mb_per_s,ns_per_node,allocs_per_node,spread_percent\n");
+            }
+            else
+            {
+                printf("%10s %10s %10s %8s  %s\n", "MB/s", "ns/node", "alloc/node", "spread", "benchmark");
+            }
+        }
+
+        // bytes is the size of the serialized form, nodes the node count
+        void run(const std::string& name, size_t bytes, U32 nodes, const std::function<void()>& func) const
+        {
+            if (!mFilter.empty() && name.find(mFilter) == std::string::npos)
+            {
+                return;
+            }
+
+            typedef std::chrono::steady_clock clock_t;
+
+            func();
+            U64 calls = 1;
+            while (true)
+            {
+                const auto start = clock_t::now();
+                for (U64 i = 0; i < calls; ++i)
+                {
+                    func();
+                }
+                if (clock_t::now() - start >= MIN_EPOCH_TIME)
+                {
+                    break;
+                }
+                calls *= 2;
+            }
+
+            std::vector<F64> seconds;
+            for (S32 epoch = 0; epoch < EPOCHS; ++epoch)
+            {
+                const auto start = clock_t::now();
+                for (U64 i = 0; i < calls; ++i)
+                {
+                    func();
+                }
+                seconds.push_back(std::chrono::duration<F64>(clock_t::now() - start).count() / (F64)calls);
+            }
+            std::sort(seconds.begin(), seconds.end());
+            const F64 median = seconds[EPOCHS / 2];
+            const F64 spread = (seconds.back() - seconds.front()) / median * 100.0;
+
+            F64 allocs_per_node = -1.0;
+#if LLSD_BENCH_COUNT_ALLOCATIONS
+            const U64 before = sAllocations.load();
+            func();
+            allocs_per_node = (F64)(sAllocations.load() - before) / (F64)nodes;
+#endif
+
+            const F64 mb_per_s = (F64)bytes / median / (1024.0 * 1024.0);
+            const F64 ns_per_node = median * 1e9 / (F64)nodes;
+            if (mCSV)
+            {
+                printf("\"%s\",%zu,%u,%.2f,%.2f,%.3f,%.2f\n", name.c_str(), bytes, nodes, mb_per_s, ns_per_node, allocs_per_node, spread);
+            }
+            else if (allocs_per_node >= 0.0)
+            {
+                printf("%10.2f %10.2f %10.3f %7.1f%%  %s\n", mb_per_s, ns_per_node, allocs_per_node, spread, name.c_str());
+            }
+            else
+            {
+                printf("%10.2f %10.2f %10s %7.1f%%  %s\n", mb_per_s, ns_per_node, "n/a", spread, name.c_str());
+            }
+            fflush(stdout);
+        }
+
+    private:
+        std::string mFilter;
+        bool        mCSV;
+    };
+
+    std::string format_with(const LLSDFormatter& formatter, const LLSD& sd)
+    {
+        std::ostringstream ostr;
+        formatter.format(sd, ostr, LLSDFormatter::OPTIONS_NONE);
+        return ostr.str();
+    }
+
+    void parse_with(LLSDParser& parser, const std::string& text, LLSD& sd)
+    {
+        LLMemoryStream istr((const U8*)text.data(), (S32)text.size());
+        if (parser.parse(istr, sd, text.size()) == LLSDParser::PARSE_FAILURE)
+        {
+            fprintf(stderr, "Parse failure\n");
+            exit(1);
+        }
+    }
+
+    void bench_payload(const Bench& bench, const char* payload, const LLSD& sd)
+    {
+        const U32 nodes = count_nodes(sd);
+
+        LLPointer<LLSDFormatter> xml_formatter = new LLSDXMLFormatter();
+        LLPointer<LLSDFormatter> notation_formatter = new LLSDNotationFormatter();
+        LLPointer<LLSDFormatter> binary_formatter = new LLSDBinaryFormatter();
+        const std::string xml = format_with(*xml_formatter, sd);
+        const std::string notation = format_with(*notation_formatter, sd);
+        const std::string binary = format_with(*binary_formatter, sd);
+        const std::string json = boost::json::serialize(LlsdToJson(sd));
+
+        const std::string name(payload);
+
+        // Formatters
+        bench.run(name + " format xml", xml.size(), nodes, [&]() { format_with(*xml_formatter, sd); });
+        bench.run(name + " format notation", notation.size(), nodes, [&]() { format_with(*notation_formatter, sd); });
+        bench.run(name + " format binary", binary.size(), nodes, [&]() { format_with(*binary_formatter, sd); });
+        bench.run(name + " format json", json.size(), nodes, [&]() { boost::json::serialize(LlsdToJson(sd)); });
+
+        // Parsers to a tree
+        bench.run(name + " parse xml", xml.size(), nodes, [&]()
+        {
+            LLSD out;
+            LLPointer<LLSDParser> parser = new LLSDXMLParser();
+            parse_with(*parser, xml, out);
+        });
+        bench.run(name + " parse notation", notation.size(), nodes, [&]()
+        {
+            LLSD out;
+            LLPointer<LLSDParser> parser = new LLSDNotationParser();
+            parse_with(*parser, notation, out);
+        });
+        bench.run(name + " parse binary", binary.size(), nodes, [&]()
+        {
+            LLSD out;
+            LLPointer<LLSDParser> parser = new LLSDBinaryParser();
+            parse_with(*parser, binary, out);
+        });
+        bench.run(name + " parse json", json.size(), nodes, [&]()
+        {
+            LLSD out = LlsdFromJson(boost::json::parse(json));
+        });
+
+        // The same into an arena, tree released with it
+        bench.run(name + " parse binary arena", binary.size(), nodes, [&]()
+        {
+            LLSDArena arena;
+            LLSD out;
+            LLPointer<LLSDParser> parser = new LLSDBinaryParser();
+            parse_with(*parser, binary, out);
+        });
+
+        // Streaming to a sink, no tree
+        bench.run(name + " parse xml sink", xml.size(), nodes, [&]()
+        {
+            NullSink sink;
+            LLPointer<LLSDParser> parser = new LLSDXMLParser();
+            LLMemoryStream istr((const U8*)xml.data(), (S32)xml.size());
+            parser->parse(istr, sink, xml.size());
+        });
+        bench.run(name + " parse binary sink", binary.size(), nodes, [&]()
+        {
+            NullSink sink;
+            LLPointer<LLSDParser> parser = new LLSDBinaryParser();
+            LLMemoryStream istr((const U8*)binary.data(), (S32)binary.size());
+            parser->parse(istr, sink, binary.size());
+        });
+        bench.run(name + " parse json sink", json.size(), nodes, [&]()
+        {
+            NullSink sink;
+            LlsdJsonToSink(json.data(), json.size(), sink);
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string filter;
+    bool csv = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--csv"))
+        {
+            csv = true;
+        }
+        else if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h"))
+        {
+            printf("Usage: %s [--csv] [filter]\n", argv[0]);
+            printf("Runs the LLSD serialization benchmarks whose name contains filter, or all of them.\n");
+            return 0;
+        }
+        else
+        {
+            filter = argv[i];
+        }
+    }
+
+    Bench bench(filter, csv);
+    bench.header();
+    bench_payload(bench, "ais_response", make_ais_response());
+    bench_payload(bench, "inventory_cache", make_inventory_cache());
+    bench_payload(bench, "material_overrides", make_material_overrides());
+    bench_payload(bench, "event_queue", make_event_queue_bundle());
+    bench_payload(bench, "avatar_names", make_avatar_names());
+    return 0;
+}
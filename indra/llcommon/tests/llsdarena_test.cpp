@@ -0,0 +1,175 @@
+/**
+ * @file llsdarena_test.cpp
+ * @brief Tests for the LLSD node arena
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+
+#include "linden_common.h"
+
+#include "../llsdarena.h"
+#include "../llsd.h"
+#include "../llsdserialize.h"
+#include "../llsdutil.h"
+
+#include "../test/lltut.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    std::string make_xml(S32 count)
+    {
+        LLSD tree = LLSD::emptyArray();
+        for (S32 i = 0; i < count; ++i)
+        {
+            LLSD item;
+            item["name"] = llformat("item %d", i);
+            item["id"] = i;
+            item["flags"] = LLSD::emptyArray();
+            item["flags"].append(true);
+            item["flags"].append(1.5);
+            tree.append(item);
+        }
+
+        std::ostringstream out;
+        LLSDSerialize::toXML(tree, out);
+        return out.str();
+    }
+
+    LLSD parse_xml(const std::string& xml)
+    {
+        LLSD result;
+        std::istringstream in(xml);
+        LLSDSerialize::fromXML(result, in);
+        return result;
+    }
+}
+
+namespace tut
+{
+    struct sd_arena
+    {
+    };
+    typedef test_group<sd_arena> sd_arena_t;
+    typedef sd_arena_t::object sd_arena_object_t;
+    tut::sd_arena_t tut_sd_arena("LLSDArena");
+
+    // blocks are aligned and distinct, chunks go when their blocks do
+    template<> template<>
+    void sd_arena_object_t::test<1>()
+    {
+        const size_t before = LLSDArena::getChunkCount();
+        std::vector<void*> blocks;
+        {
+            LLSDArena arena;
+            for (U32 i = 0; i < 10000; ++i)
+            {
+                const size_t size = 8 + (i * 37) % 120;
+                void* block = LLSDArena::allocate(size);
+                ensure("block allocated", block != nullptr);
+                ensure("block aligned", ((uintptr_t)block & 0xF) == 0);
+                memset(block, i & 0xFF, size);
+                blocks.push_back(block);
+            }
+            ensure("several chunks", LLSDArena::getChunkCount() - before > 1);
+        }
+
+        std::vector<void*> sorted(blocks);
+        std::sort(sorted.begin(), sorted.end());
+        ensure("blocks distinct", std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+
+        for (void* block : blocks)
+        {
+            LLSDArena::release(block);
+        }
+        ensure_equals("chunks freed", LLSDArena::getChunkCount(), before);
+    }
+
+    // nothing without an arena or for blocks bigger than a chunk
+    template<> template<>
+    void sd_arena_object_t::test<2>()
+    {
+        ensure("no arena", LLSDArena::allocate(32) == nullptr);
+
+        LLSDArena arena;
+        ensure("too big", LLSDArena::allocate(LLSDArena::CHUNK_SIZE) == nullptr);
+    }
+
+    // arenas nest, the innermost one is used
+    template<> template<>
+    void sd_arena_object_t::test<3>()
+    {
+        const size_t before = LLSDArena::getChunkCount();
+        LLSDArena outer;
+        void* first = LLSDArena::allocate(32);
+        void* inner_block = nullptr;
+        {
+            LLSDArena inner;
+            inner_block = LLSDArena::allocate(32);
+            ensure_equals("own chunk", LLSDArena::getChunkCount(), before + 2);
+        }
+        void* second = LLSDArena::allocate(32);
+        ensure_equals("outer chunk again", (U8*)second - (U8*)first, (ptrdiff_t)32);
+
+        LLSDArena::release(inner_block);
+        ensure_equals("inner chunk freed", LLSDArena::getChunkCount(), before + 1);
+        LLSDArena::release(first);
+        LLSDArena::release(second);
+    }
+
+    // a tree parsed into an arena reads the same and outlives it, a node
+    // kept around keeps its chunk
+    template<> template<>
+    void sd_arena_object_t::test<4>()
+    {
+        const std::string xml = make_xml(5000);
+        const LLSD expected = parse_xml(xml);
+        const size_t before = LLSDArena::getChunkCount();
+
+        LLSD parsed;
+        {
+            LLSDArena arena;
+            parsed = parse_xml(xml);
+        }
+        ensure("chunks in use", LLSDArena::getChunkCount() > before);
+        ensure("same tree", llsd_equals(parsed, expected));
+
+        // modifying it is fine too, new nodes come from the heap
+        parsed[0]["name"] = "changed";
+        parsed.append(LLSD("more"));
+        ensure_equals("changed", parsed[0]["name"].asString(), std::string("changed"));
+
+        LLSD kept = parsed[4999]["flags"];
+        parsed.clear();
+        ensure("its chunks kept", LLSDArena::getChunkCount() > before && LLSDArena::getChunkCount() <= before + 2);
+        ensure_equals("kept readable", kept[1].asReal(), 1.5);
+
+        kept.clear();
+        ensure_equals("chunks freed", LLSDArena::getChunkCount(), before);
+    }
+}
@@ -0,0 +1,215 @@
+/**
+ * @file llsdsink_test.cpp
+ * @brief Tests for the streaming LLSD parses
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+
+#include "linden_common.h"
+
+#include "../llsdsink.h"
+#include "../llsd.h"
+#include "../llsdjson.h"
+#include "../llsdserialize.h"
+#include "../llsdutil.h"
+
+#include "../test/lltut.h"
+
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    // Builds the tree back from the events
+    class TreeSink : public LLSDSink
+    {
+    public:
+        void onUndefined() override                     { value(LLSD()); }
+        void onBoolean(LLSD::Boolean v) override        { value(v); }
+        void onInteger(LLSD::Integer v) override        { value(v); }
+        void onReal(LLSD::Real v) override              { value(v); }
+        void onString(const LLSD::String& v) override   { value(v); }
+        void onUUID(const LLSD::UUID& v) override       { value(v); }
+        void onDate(const LLSD::Date& v) override       { value(v); }
+        void onURI(const LLSD::URI& v) override         { value(v); }
+        void onBinary(const LLSD::Binary& v) override   { value(v); }
+
+        void onBeginMap() override          { mStack.push_back(&value(LLSD::emptyMap())); }
+        void onMapKey(const LLSD::String& key) override { mKey = key; }
+        void onEndMap() override            { mStack.pop_back(); }
+        void onBeginArray() override        { mStack.push_back(&value(LLSD::emptyArray())); }
+        void onEndArray() override          { mStack.pop_back(); }
+
+        LLSD mResult;
+        S32 mEvents = 0;
+
+    private:
+        LLSD& value(const LLSD& v)
+        {
+            ++mEvents;
+            if (mStack.empty())
+            {
+                mResult = v;
+                return mResult;
+            }
+            LLSD& parent = *mStack.back();
+            if (parent.isMap())
+            {
+                return parent[mKey] = v;
+            }
+            parent.append(v);
+            return parent[parent.size() - 1];
+        }
+
+        std::vector<LLSD*> mStack;
+        std::string mKey;
+    };
+
+    LLSD sample()
+    {
+        LLSD tree;
+        tree["undef"] = LLSD();
+        tree["true"] = true;
+        tree["int"] = -42;
+        tree["real"] = 3.25;
+        tree["string"] = "text & <markup>";
+        tree["uuid"] = LLUUID("0fd0e798-a54f-40b1-8024-f7b1fed3e5c3");
+        tree["date"] = LLDate(1700000000.0);
+        tree["uri"] = LLURI("http://example.com/a?b=c");
+        LLSD::Binary binary;
+        for (U8 i = 0; i < 40; ++i)
+        {
+            binary.push_back(i * 7);
+        }
+        tree["binary"] = binary;
+        tree["empty map"] = LLSD::emptyMap();
+        tree["empty array"] = LLSD::emptyArray();
+        for (S32 i = 0; i < 20; ++i)
+        {
+            LLSD item;
+            item["name"] = llformat("item %d", i);
+            item["values"].append(i);
+            item["values"].append(i * 0.5);
+            tree["items"].append(item);
+        }
+        return tree;
+    }
+
+    template <class PARSER>
+    void check_parse(const std::string& what, const std::string& serialized, const LLSD& expected)
+    {
+        LLPointer<LLSDParser> parser = new PARSER();
+        std::istringstream dom_in(serialized);
+        LLSD dom;
+        S32 dom_count = parser->parse(dom_in, dom, serialized.size());
+
+        parser = new PARSER();
+        std::istringstream sink_in(serialized);
+        TreeSink sink;
+        S32 sink_count = parser->parse(sink_in, sink, serialized.size());
+
+        tut::ensure_equals(what + " count", sink_count, dom_count);
+        tut::ensure(what + " same as tree", llsd_equals(sink.mResult, dom));
+        tut::ensure(what + " same as written", llsd_equals(sink.mResult, expected));
+    }
+}
+
+namespace tut
+{
+    struct sd_sink
+    {
+    };
+    typedef test_group<sd_sink> sd_sink_t;
+    typedef sd_sink_t::object sd_sink_object_t;
+    tut::sd_sink_t tut_sd_sink("LLSDSink");
+
+    // replay sends a tree back as it is
+    template<> template<>
+    void sd_sink_object_t::test<1>()
+    {
+        const LLSD tree = sample();
+        TreeSink sink;
+        LLSDSink::replay(tree, sink);
+        ensure("replayed", llsd_equals(sink.mResult, tree));
+    }
+
+    // the streaming XML, binary and notation parses match the tree ones
+    template<> template<>
+    void sd_sink_object_t::test<2>()
+    {
+        const LLSD tree = sample();
+
+        std::ostringstream xml;
+        LLSDSerialize::toXML(tree, xml);
+        check_parse<LLSDXMLParser>("xml", xml.str(), tree);
+
+        std::ostringstream binary;
+        LLSDSerialize::toBinary(tree, binary);
+        check_parse<LLSDBinaryParser>("binary", binary.str(), tree);
+
+        std::ostringstream notation;
+        LLSDSerialize::toNotation(tree, notation);
+        check_parse<LLSDNotationParser>("notation", notation.str(), tree);
+    }
+
+    // a broken document fails the streaming parse too
+    template<> template<>
+    void sd_sink_object_t::test<3>()
+    {
+        std::ostringstream binary;
+        LLSDSerialize::toBinary(sample(), binary);
+        const std::string truncated = binary.str().substr(0, binary.str().size() / 2);
+
+        LLPointer<LLSDParser> parser = new LLSDBinaryParser();
+        std::istringstream in(truncated);
+        TreeSink sink;
+        ensure_equals("binary failure", parser->parse(in, sink, truncated.size()), (S32)LLSDParser::PARSE_FAILURE);
+
+        // values that aren't in a map or array are skipped, as in the tree
+        const std::string xml = "<llsd><map><key>a</key><integer>1</integer><integer>2</integer>"
+            "<key>b</key><array><string>x</string></array></map></llsd>";
+        parser = new LLSDXMLParser();
+        std::istringstream xml_in(xml);
+        TreeSink xml_sink;
+        parser->parse(xml_in, xml_sink, xml.size());
+        ensure_equals("xml a", xml_sink.mResult["a"].asInteger(), 1);
+        ensure_equals("xml b", xml_sink.mResult["b"][0].asString(), std::string("x"));
+        ensure_equals("xml size", xml_sink.mResult.size(), (size_t)2);
+    }
+
+    // JSON goes to the sink the way LlsdFromJson() converts it
+    template<> template<>
+    void sd_sink_object_t::test<4>()
+    {
+        const std::string json = "{\"a\":1,\"b\":[true,null,2.5,\"text \\u00e9\"],"
+            "\"c\":{\"d\":-7,\"e\":{}},\"f\":[]}";
+
+        TreeSink sink;
+        ensure("parsed", LlsdJsonToSink(json.data(), json.size(), sink));
+        ensure("same as LlsdFromJson", llsd_equals(sink.mResult, LlsdFromJson(boost::json::parse(json))));
+
+        TreeSink broken;
+        ensure("broken", !LlsdJsonToSink(json.data(), json.size() - 3, broken));
+    }
+}
@@ -0,0 +1,155 @@
+/**
+ * @file llslabpool_test.cpp
+ * @brief Tests for the size class slab allocator
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "../llslabpool.h"
+
+#include "../test/lltut.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    struct Pooled
+    {
+        static LLSlabPool sPool;
+        LL_SLAB_POOL_NEW(sPool)
+
+        virtual ~Pooled() {}
+        U32 mValue = 0;
+    };
+    LLSlabPool Pooled::sPool(256, true);
+
+    struct PooledBig : public Pooled
+    {
+        U8 mData[100];
+    };
+}
+
+namespace tut
+{
+    struct slab_pool
+    {
+    };
+    typedef test_group<slab_pool> slab_pool_t;
+    typedef slab_pool_t::object slab_pool_object_t;
+    tut::slab_pool_t tut_slab_pool("LLSlabPool");
+
+    // blocks are aligned, distinct and writable
+    template<> template<>
+    void slab_pool_object_t::test<1>()
+    {
+        LLSlabPool pool(512, true);
+        std::vector<void*> blocks;
+        for (U32 i = 0; i < 2000; ++i)
+        {
+            const size_t size = 1 + (i * 37) % 512;
+            void* block = pool.allocate(size);
+            ensure("block aligned", ((uintptr_t)block & 0xF) == 0);
+            memset(block, i & 0xFF, size);
+            blocks.push_back(block);
+        }
+
+        std::vector<void*> sorted(blocks);
+        std::sort(sorted.begin(), sorted.end());
+        ensure("blocks distinct", std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+
+        for (U32 i = 0; i < blocks.size(); ++i)
+        {
+            pool.deallocate(blocks[i], 1 + (i * 37) % 512);
+        }
+    }
+
+    // a freed block is the next one handed out for its size class
+    template<> template<>
+    void slab_pool_object_t::test<2>()
+    {
+        LLSlabPool pool(256, true);
+        void* first = pool.allocate(40);
+        void* second = pool.allocate(40);
+        ensure("same slab", ((uintptr_t)first & ~(uintptr_t)(LLSlabPool::SLAB_SIZE - 1))
+            == ((uintptr_t)second & ~(uintptr_t)(LLSlabPool::SLAB_SIZE - 1)));
+        pool.deallocate(first, 40);
+        ensure_equals("block reused", pool.allocate(48), first);
+        pool.deallocate(first, 48);
+        pool.deallocate(second, 40);
+    }
+
+    // empty slabs go back to the heap, but one per size class stays
+    template<> template<>
+    void slab_pool_object_t::test<3>()
+    {
+        LLSlabPool pool(256, true);
+        const size_t per_slab = LLSlabPool::SLAB_SIZE / 256;
+        std::vector<void*> blocks;
+        for (size_t i = 0; i < per_slab * 4; ++i)
+        {
+            blocks.push_back(pool.allocate(256));
+        }
+        ensure("several slabs", pool.getSlabCount() >= 4);
+
+        for (void* block : blocks)
+        {
+            pool.deallocate(block, 256);
+        }
+        ensure_equals("one slab kept", pool.getSlabCount(), (size_t)1);
+    }
+
+    // big blocks, and all of them when disabled, come from the heap
+    template<> template<>
+    void slab_pool_object_t::test<4>()
+    {
+        LLSlabPool pool(256, true);
+        void* big = pool.allocate(1000);
+        ensure("big block aligned", ((uintptr_t)big & 0xF) == 0);
+        ensure_equals("no slab for big block", pool.getSlabCount(), (size_t)0);
+        pool.deallocate(big, 1000);
+
+        LLSlabPool disabled(256, false);
+        void* small = disabled.allocate(32);
+        ensure_equals("no slab when disabled", disabled.getSlabCount(), (size_t)0);
+        disabled.deallocate(small, 32);
+    }
+
+    // new and delete of a class hierarchy go through the pool with the size
+    // of the most derived class
+    template<> template<>
+    void slab_pool_object_t::test<5>()
+    {
+        Pooled* small = new Pooled;
+        Pooled* big = new PooledBig;
+        ensure_equals("two size classes", Pooled::sPool.getSlabCount(), (size_t)2);
+        delete small;
+        delete big;
+
+        Pooled* again = new PooledBig;
+        ensure_equals("slab kept for reuse", Pooled::sPool.getSlabCount(), (size_t)2);
+        delete again;
+    }
+}
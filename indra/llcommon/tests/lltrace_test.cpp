@@ -32,6 +32,8 @@
 #include "lltracerecording.h"
 #include "../test/lltut.h"
 
+#include <thread>
+
 #ifdef LL_WINDOWS
 #pragma warning(disable : 4244) // possible loss of data on conversions
 #endif
@@ -143,4 +145,44 @@ namespace tut
                 && after_3pm.getMax(sCaffeineLevelStat) == sCaffeinePerOz * ((S32Ounces)S32TallCup(1) + (S32Ounces)S32GrandeCup(3) + (S32Ounces)S32VentiCup(1)).value());
     }
 
+    // child thread buffers are merged when the parent pulls
+    template<> template<>
+    void trace_object_t::test<2>()
+    {
+        Recording recording;
+        recording.start();
+
+        std::thread child_thread([this]()
+        {
+            ThreadRecorder child(mRecorder);
+            add(sCupsOfCoffeeConsumed, 2);
+            child.pushToParent();
+            add(sCupsOfCoffeeConsumed, 3);
+            // the rest is handed over when the recorder goes away
+        });
+        child_thread.join();
+
+        ensure_equals("child stats are not shared before the pull", recording.getSum(sCupsOfCoffeeConsumed), 0);
+        mRecorder.pullFromChildren();
+        ensure_equals("child stats are merged by the pull", recording.getSum(sCupsOfCoffeeConsumed), 5);
+    }
+
+    // threads without a recorder have no buffers to record into
+    template<> template<>
+    void trace_object_t::test<3>()
+    {
+        Recording recording;
+        recording.start();
+
+        std::thread thread([]()
+        {
+            add(sCupsOfCoffeeConsumed, 4);
+        });
+        thread.join();
+        add(sCupsOfCoffeeConsumed, 1);
+
+        mRecorder.pullFromChildren();
+        ensure_equals("stats of threads without a recorder are dropped", recording.getSum(sCupsOfCoffeeConsumed), 1);
+    }
+
 }
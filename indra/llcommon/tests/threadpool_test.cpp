@@ -0,0 +1,160 @@
+/**
+ * @file   threadpool_test.cpp
+ * @date   2024-11-12
+ * @brief  Test for the work stealing mode of threadpool.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Copyright (c) 2024, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "threadpool.h"
+// STL headers
+#include <atomic>
+#include <vector>
+// std headers
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+
+using namespace LL;
+using namespace std::literals::chrono_literals; // ms suffix
+
+namespace
+{
+    // Waits for the workers to get there, false on timeout
+    bool wait_for(const std::atomic<int>& value, int expected)
+    {
+        auto until = std::chrono::steady_clock::now() + 5s;
+        while (value.load() != expected)
+        {
+            if (std::chrono::steady_clock::now() > until)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(1ms);
+        }
+        return true;
+    }
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct threadpool_data
+    {
+        threadpool_data()
+        {
+            pool.setWorkStealing(true);
+            pool.start();
+        }
+
+        ThreadPool pool{ "threadpool_test", 4 };
+    };
+    typedef test_group<threadpool_data> threadpool_group;
+    typedef threadpool_group::object object;
+    threadpool_group threadpoolgrp("threadpool");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("postWork");
+        ensure("work stealing not enabled", pool.isWorkStealing());
+        ensure_equals("main thread is a worker", pool.getCurrentWorker(), -1);
+
+        std::atomic<int> count{ 0 };
+        for (int i = 0; i < 1000; ++i)
+        {
+            ensure("post failed", pool.postWork([&count](){ ++count; }));
+        }
+        // work posted to the WorkQueue still runs next to the deques
+        pool.getQueue().post([&count](){ ++count; });
+        ensure("not all work ran", wait_for(count, 1001));
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("follow-up work");
+        std::atomic<int> done{ 0 };
+        std::atomic<int> worker_ran{ 0 };
+        for (int i = 0; i < 8; ++i)
+        {
+            pool.postWork([this, &done, &worker_ran]()
+            {
+                // posted from a worker, lands on its own deque
+                pool.postWork([this, &done, &worker_ran]()
+                {
+                    if (pool.getCurrentWorker() >= 0)
+                    {
+                        ++worker_ran;
+                    }
+                    ++done;
+                });
+            });
+        }
+        ensure("follow-up work didn't run", wait_for(done, 8));
+        ensure_equals("follow-up work ran outside the pool", worker_ran.load(), 8);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("parallelFor");
+        std::vector<std::atomic<int>> hits(10007);
+        pool.parallelFor(0, hits.size(), 0, [&hits](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                ++hits[i];
+            }
+        });
+        for (size_t i = 0; i < hits.size(); ++i)
+        {
+            ensure_equals("item not visited exactly once", hits[i].load(), 1);
+        }
+
+        std::atomic<int> chunks{ 0 };
+        pool.parallelFor(5, 5, 1, [&chunks](size_t, size_t){ ++chunks; });
+        ensure_equals("empty range ran", chunks.load(), 0);
+        pool.parallelFor(0, 100, 10, [&chunks](size_t begin, size_t end)
+        {
+            ensure_equals("wrong chunk size", end - begin, size_t(10));
+            ++chunks;
+        });
+        ensure_equals("wrong chunk count", chunks.load(), 10);
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("parallelFor exception");
+        std::atomic<int> chunks{ 0 };
+        std::string what;
+        try
+        {
+            pool.parallelFor(0, 64, 1, [&chunks](size_t begin, size_t)
+            {
+                ++chunks;
+                if (begin == 13)
+                {
+                    throw std::runtime_error("chunk 13");
+                }
+            });
+        }
+        catch (const std::runtime_error& e)
+        {
+            what = e.what();
+        }
+        ensure_equals("exception not rethrown", what, "chunk 13");
+        ensure_equals("other chunks didn't run", chunks.load(), 64);
+    }
+} // namespace tut
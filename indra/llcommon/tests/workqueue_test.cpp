@@ -17,6 +17,8 @@
 // std headers
 #include <chrono>
 #include <deque>
+#include <string>
+#include <vector>
 // external library headers
 // other Linden headers
 #include "../test/lltut.h"
@@ -236,4 +238,69 @@ namespace tut
         ensure_equals("didn't run coroutine", stored, "ran");
         ensure("void waitForResult() didn't return", done);
     }
+
+    template<> template<>
+    void object::test<7>()
+    {
+        set_test_name("postBatch");
+        WorkQueue fifo("fifo");
+        std::string observe;
+        std::vector<WorkQueue::Work> works;
+        for (char c : "abcde"s)
+        {
+            works.push_back([&observe, c](){ observe.push_back(c); });
+        }
+        ensure_equals("not all posted", fifo.postBatch(works), 5);
+        ensure("batch not consumed", works.empty());
+        ensure_equals("queue size", fifo.size(), 5);
+        fifo.runPending();
+        ensure_equals("batch out of order", observe, "abcde");
+
+        // WorkSchedule posts them one by one
+        works.push_back([&observe](){ observe.push_back('f'); });
+        works.push_back([&observe](){ observe.push_back('g'); });
+        ensure_equals("schedule didn't post", queue.postBatch(works), 2);
+        queue.runPending();
+        ensure_equals("schedule batch", observe, "abcdefg");
+
+        fifo.close();
+        works.push_back([&observe](){ observe.push_back('h'); });
+        ensure_equals("posted to closed queue", fifo.postBatch(works), 0);
+    }
+
+    template<> template<>
+    void object::test<8>()
+    {
+        set_test_name("ReplyBatch");
+        WorkQueue main("main");
+        WorkQueue worker("worker");
+        std::vector<int> results;
+        for (int i = 0; i < 3; ++i)
+        {
+            main.postTo(worker.getWeak(), [i](){ return i; }, [&results](int r){ results.push_back(r); });
+        }
+
+        {
+            WorkQueueBase::ReplyBatch replies;
+            worker.runPending();
+            ensure_equals("replies not held", main.size(), 0);
+        }
+        ensure_equals("replies not sent", main.size(), 3);
+        main.runPending();
+        ensure_equals("reply count", results.size(), 3);
+        ensure("replies out of order", results[0] == 0 && results[1] == 1 && results[2] == 2);
+
+        // Posting anything else sends the held replies first
+        results.clear();
+        std::string observe;
+        main.postTo(worker.getWeak(), [](){ return 4; }, [&results](int r){ results.push_back(r); });
+        {
+            WorkQueueBase::ReplyBatch replies;
+            worker.runOne();
+            main.post([&observe, &results](){ observe = STRINGIZE(results.size()); });
+            ensure_equals("held replies not sent first", main.size(), 2);
+        }
+        main.runPending();
+        ensure_equals("reply overtaken", observe, "1");
+    }
 } // namespace tut
@@ -20,7 +20,9 @@
 #include "commoncontrol.h"
 #include "llerror.h"
 #include "llevents.h"
+#include "llexception.h" // <FS/> Work stealing
 #include "llsd.h"
+#include "lltracethreadrecorder.h" // <FS/> Record stats of pool threads
 #include "stringize.h"
 
 #include <boost/fiber/algo/round_robin.hpp>
@@ -57,6 +59,23 @@ struct sleepy_robin: public boost::fibers::algo::round_robin
     }
 };
 
+// <FS> Work stealing
+namespace
+{
+    // The pool and index of the worker running on this thread
+    thread_local const LL::ThreadPoolBase* tCurrentPool = nullptr;
+    thread_local size_t tCurrentWorker = 0;
+
+    // A worker busy with its deque still serves the WorkQueue every this
+    // many items
+    constexpr U32 SHARED_QUEUE_INTERVAL = 16;
+
+    // parallelFor() chunks per thread when no grain is given, a few so the
+    // threads even out
+    constexpr size_t CHUNKS_PER_THREAD = 4;
+}
+// </FS>
+
 /*****************************************************************************
 *   ThreadPoolBase
 *****************************************************************************/
@@ -73,11 +92,28 @@ LL::ThreadPoolBase::ThreadPoolBase(const std::string& name,
 
 void LL::ThreadPoolBase::start()
 {
+    // <FS> Work stealing
+    if (mWorkStealing)
+    {
+        for (size_t i = 0; i < mThreadCount; ++i)
+        {
+            mDeques.push_back(std::make_unique<WorkerDeque>());
+        }
+    }
+    // </FS>
+
     for (size_t i = 0; i < mThreadCount; ++i)
     {
         std::string tname{ stringize(mName, ':', (i+1), '/', mThreadCount) };
-        mThreads.emplace_back(tname, [this, tname]()
+        // <FS> Work stealing
+        //mThreads.emplace_back(tname, [this, tname]()
+        mThreads.emplace_back(tname, [this, tname, i]()
+        // </FS>
             {
+                // <FS> Work stealing
+                tCurrentPool = this;
+                tCurrentWorker = i;
+                // </FS>
                 LL_PROFILER_SET_THREAD_NAME(tname.c_str());
                 LL_INFOS("THREAD") << "Started thread " << tname << LL_ENDL;
                 run(tname);
@@ -143,14 +179,265 @@ void LL::ThreadPoolBase::run(const std::string& name)
 #endif // LL_WINDOWS
 
     LL_DEBUGS("ThreadPool") << name << " starting" << LL_ENDL;
+    // <FS> Pool threads record into buffers of their own like LLThreads do,
+    // without a recorder their stats went into the shared default buffer
+    //run();
+    std::unique_ptr<LLTrace::ThreadRecorder> recorder;
+    if (LLTrace::ThreadRecorder* master = LLTrace::get_master_thread_recorder())
+    {
+        recorder = std::make_unique<LLTrace::ThreadRecorder>(*master);
+    }
     run();
+    recorder.reset();
+    // </FS>
     LL_DEBUGS("ThreadPool") << name << " stopping" << LL_ENDL;
 }
 
 void LL::ThreadPoolBase::run()
 {
+    // <FS> Work stealing
+    //mQueue->runUntilClose();
+    S32 worker = getCurrentWorker();
+    if (mWorkStealing && worker >= 0)
+    {
+        runWorkStealing(worker);
+        return;
+    }
     mQueue->runUntilClose();
+    // </FS>
+}
+
+// <FS> Work stealing
+void LL::ThreadPoolBase::setWorkStealing(bool enable)
+{
+    if (!mThreads.empty())
+    {
+        LL_WARNS("ThreadPool") << mName << " already started, work stealing can't change" << LL_ENDL;
+        return;
+    }
+    mWorkStealing = enable;
+}
+
+S32 LL::ThreadPoolBase::getCurrentWorker() const
+{
+    return (tCurrentPool == this) ? (S32)tCurrentWorker : -1;
+}
+
+bool LL::ThreadPoolBase::postWork(const WorkQueueBase::Work& work)
+{
+    if (mDeques.empty())
+    {
+        return mQueue->post(work);
+    }
+
+    // Work posted by a worker is most likely a follow-up on what it just
+    // did, keep it there
+    S32 current = getCurrentWorker();
+    size_t worker = (current >= 0) ? (size_t)current : mNextDeque.fetch_add(1, std::memory_order_relaxed);
+    return postWorkTo(worker, work);
+}
+
+bool LL::ThreadPoolBase::postWorkTo(size_t worker, const WorkQueueBase::Work& work)
+{
+    if (mDeques.empty())
+    {
+        return mQueue->post(work);
+    }
+    if (mQueue->isClosed())
+    {
+        return false;
+    }
+
+    WorkerDeque& deque = *mDeques[worker % mDeques.size()];
+    {
+        std::lock_guard<std::mutex> lock(deque.mMutex);
+        deque.mWork.push_back(work);
+    }
+    // Pairs with the check of runWorkStealing() before it waits: either
+    // the worker sees the work or we see the worker waiting
+    mLocalWork.fetch_add(1);
+    if (mSleeping.load() > 0)
+    {
+        // Wakes a waiting worker, which looks at the deques again
+        mQueue->post([](){});
+    }
+    return true;
+}
+
+bool LL::ThreadPoolBase::popLocalWork(size_t worker, WorkQueueBase::Work& work)
+{
+    if (!mLocalWork.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    // Newest of our own first, its data is the most likely to be in cache
+    {
+        WorkerDeque& deque = *mDeques[worker];
+        std::lock_guard<std::mutex> lock(deque.mMutex);
+        if (!deque.mWork.empty())
+        {
+            work = std::move(deque.mWork.back());
+            deque.mWork.pop_back();
+            mLocalWork.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // Then the oldest of the others
+    for (size_t i = 1; i < mDeques.size(); ++i)
+    {
+        WorkerDeque& deque = *mDeques[(worker + i) % mDeques.size()];
+        std::lock_guard<std::mutex> lock(deque.mMutex);
+        if (!deque.mWork.empty())
+        {
+            work = std::move(deque.mWork.front());
+            deque.mWork.pop_front();
+            mLocalWork.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void LL::ThreadPoolBase::callLocalWork(const WorkQueueBase::Work& work)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    try
+    {
+        work();
+    }
+    catch (...)
+    {
+        // Same as WorkQueueBase::callWork(), the worker must go on
+        LOG_UNHANDLED_EXCEPTION(mName);
+    }
+}
+
+void LL::ThreadPoolBase::runWorkStealing(size_t worker)
+{
+    WorkQueueBase::ReplyBatch replies;
+    WorkQueueBase::Work work;
+    U32 local_count = 0;
+    for (;;)
+    {
+        LLTrace::ThreadRecorder::pushCurrentToParentIfDue();
+
+        if (popLocalWork(worker, work))
+        {
+            WorkQueueBase::ReplyBatch::flushCurrentIfDue();
+            callLocalWork(work);
+            if (++local_count % SHARED_QUEUE_INTERVAL == 0)
+            {
+                mQueue->runOne();
+            }
+            continue;
+        }
+
+        mSleeping.fetch_add(1);
+        if (mLocalWork.load() > 0)
+        {
+            mSleeping.fetch_sub(1);
+            continue;
+        }
+        bool open = mQueue->runOneWait();
+        mSleeping.fetch_sub(1);
+        if (!open)
+        {
+            break;
+        }
+    }
+
+    // Closed, nothing new gets posted to the deques anymore
+    while (popLocalWork(worker, work))
+    {
+        callLocalWork(work);
+    }
+}
+
+void LL::ThreadPoolBase::parallelFor(size_t begin, size_t end, size_t grain,
+                                     const std::function<void(size_t, size_t)>& body)
+{
+    if (end <= begin)
+    {
+        return;
+    }
+
+    const size_t count = end - begin;
+    if (!grain)
+    {
+        grain = std::max<size_t>(count / ((mThreads.size() + 1) * CHUNKS_PER_THREAD), 1);
+    }
+    const size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || mThreads.empty() || mQueue->isClosed())
+    {
+        body(begin, end);
+        return;
+    }
+
+    struct Job
+    {
+        std::atomic<size_t> mNext{ 0 };
+        std::atomic<size_t> mDone{ 0 };
+        size_t mChunks;
+        size_t mBegin;
+        size_t mEnd;
+        size_t mGrain;
+        const std::function<void(size_t, size_t)>* mBody;
+        std::mutex mErrorMutex;
+        std::exception_ptr mError;
+
+        void runChunks()
+        {
+            for (size_t chunk = mNext.fetch_add(1); chunk < mChunks; chunk = mNext.fetch_add(1))
+            {
+                const size_t chunk_begin = mBegin + chunk * mGrain;
+                try
+                {
+                    (*mBody)(chunk_begin, std::min(chunk_begin + mGrain, mEnd));
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mErrorMutex);
+                    if (!mError)
+                    {
+                        mError = std::current_exception();
+                    }
+                }
+                mDone.fetch_add(1, std::memory_order_release);
+            }
+        }
+    };
+
+    // Helpers that come late find no chunk left and never touch body, which
+    // only has to outlive the chunks
+    auto job = std::make_shared<Job>();
+    job->mChunks = chunks;
+    job->mBegin = begin;
+    job->mEnd = end;
+    job->mGrain = grain;
+    job->mBody = &body;
+
+    const size_t helpers = std::min(mThreads.size(), chunks - 1);
+    const S32 current = getCurrentWorker();
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        // One per worker, starting after the calling one
+        postWorkTo((current >= 0) ? (size_t)current + 1 + i : i, [job]() { job->runChunks(); });
+    }
+
+    job->runChunks();
+    while (job->mDone.load(std::memory_order_acquire) < chunks)
+    {
+        std::this_thread::yield();
+    }
+
+    if (job->mError)
+    {
+        std::rethrow_exception(job->mError);
+    }
 }
+// </FS>
 
 //static
 size_t LL::ThreadPoolBase::getConfiguredWidth(const std::string& name, size_t dft)
@@ -15,7 +15,11 @@
 
 #include "threadpool_fwd.h"
 #include "workqueue.h"
+#include <atomic>                   // <FS/> Work stealing
+#include <deque>                    // <FS/> Work stealing
+#include <functional>               // <FS/> Work stealing
 #include <memory>                   // std::unique_ptr
+#include <mutex>                    // <FS/> Work stealing
 #include <string>
 #include <thread>
 #include <utility>                  // std::pair
@@ -85,6 +89,56 @@ namespace LL
         static
         size_t getWidth(const std::string& name, size_t dft);
 
+        // <FS> Work stealing
+        /**
+         * Call setWorkStealing(true) before start() to give each worker a
+         * deque of its own next to the shared WorkQueue. Work posted with
+         * postWork() goes to a deque: a worker takes from the back of its
+         * own and, when that is empty, steals from the front of the others
+         * before it waits on the WorkQueue. Submitters and workers don't
+         * all meet on the one WorkQueue lock, and follow-up work stays
+         * with the thread that produced its data unless another worker
+         * runs out. Work posted to the WorkQueue runs as before. Workers
+         * only run the default run(), a subclass overriding run() doesn't
+         * get the deques served.
+         */
+        void setWorkStealing(bool enable);
+        bool isWorkStealing() const { return mWorkStealing; }
+
+        /**
+         * postWork() posts work to the deque of the calling worker when
+         * called from a thread of this pool, otherwise to the workers in
+         * turn. Without work stealing it posts to the WorkQueue. Returns
+         * false if the pool has been closed.
+         */
+        bool postWork(const WorkQueueBase::Work& work);
+
+        /**
+         * postWorkTo() posts work to the deque of a given worker, e.g. the
+         * one whose caches already hold the data, modulo the pool width.
+         * Idle workers may still steal it.
+         */
+        bool postWorkTo(size_t worker, const WorkQueueBase::Work& work);
+
+        /**
+         * parallelFor() calls body(chunk_begin, chunk_end) for consecutive
+         * chunks of grain items covering [begin, end), on the workers and
+         * on the calling thread, and returns once all chunks are done. A
+         * grain of 0 splits the range into a few chunks per thread. If body
+         * throws, the first exception is rethrown to the caller once the
+         * other chunks are done. Dispatch costs one post per worker, the
+         * chunks are claimed through a shared counter.
+         */
+        void parallelFor(size_t begin, size_t end, size_t grain,
+                         const std::function<void(size_t, size_t)>& body);
+
+        /**
+         * Index of the calling thread among the workers of this pool, -1 if
+         * it isn't one of them.
+         */
+        S32 getCurrentWorker() const;
+        // </FS>
+
     protected:
         std::unique_ptr<WorkQueueBase> mQueue;
         std::vector<std::pair<std::string, std::thread>> mThreads;
@@ -95,6 +149,24 @@ namespace LL
 
         std::string mName;
         size_t mThreadCount;
+
+        // <FS> Work stealing
+        struct WorkerDeque
+        {
+            std::mutex mMutex;
+            std::deque<WorkQueueBase::Work> mWork;
+        };
+
+        void runWorkStealing(size_t worker);
+        bool popLocalWork(size_t worker, WorkQueueBase::Work& work);
+        void callLocalWork(const WorkQueueBase::Work& work);
+
+        std::vector<std::unique_ptr<WorkerDeque>> mDeques;
+        std::atomic<size_t> mNextDeque{ 0 };
+        std::atomic<size_t> mLocalWork{ 0 };    // items in all deques
+        std::atomic<S32> mSleeping{ 0 };        // workers waiting on mQueue
+        bool mWorkStealing{ false };
+        // </FS>
     };
 
     /**
@@ -15,17 +15,29 @@
 #include "workqueue.h"
 // STL headers
 // std headers
+#include <algorithm>                // <FS/> Batched dispatch
 // external library headers
 // other Linden headers
 #include "llcoros.h"
 #include LLCOROS_MUTEX_HEADER
 #include "llerror.h"
 #include "llexception.h"
+#include "lltracethreadrecorder.h" // <FS/> Push thread stats to the parent
 #include "stringize.h"
 
 using Mutex = LLCoros::Mutex;
 using Lock  = LLCoros::LockType;
 
+// <FS> Batched dispatch
+namespace
+{
+    // Most items runUntil() and runPending() take from the queue at once
+    constexpr size_t MAX_DRAIN_BATCH = 64;
+
+    thread_local LL::WorkQueueBase::ReplyBatch* tReplyBatch = nullptr;
+}
+// </FS>
+
 /*****************************************************************************
 *   WorkQueueBase
 *****************************************************************************/
@@ -38,12 +50,26 @@ LL::WorkQueueBase::WorkQueueBase(const std::string& name):
 
 void LL::WorkQueueBase::runUntilClose()
 {
+    ReplyBatch replies; // <FS/> Batched dispatch
     try
     {
         for (;;)
         {
             LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
-            callWork(pop_());
+            // <FS> Batched dispatch
+            //callWork(pop_());
+            Work work;
+            if (!tryPop_(work))
+            {
+                // Nothing more right now, don't keep anybody waiting while
+                // we wait
+                ReplyBatch::flushCurrent();
+                work = pop_();
+            }
+            ReplyBatch::flushCurrentIfDue();
+            callWork(work);
+            // </FS>
+            LLTrace::ThreadRecorder::pushCurrentToParentIfDue(); // <FS/> Push thread stats to the parent
         }
     }
     catch (const Closed&)
@@ -54,10 +80,21 @@ void LL::WorkQueueBase::runUntilClose()
 bool LL::WorkQueueBase::runPending()
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
-    for (Work work; tryPop_(work); )
+    // <FS> Batched dispatch
+    //for (Work work; tryPop_(work); )
+    //{
+    //    callWork(work);
+    //}
+    std::vector<Work> works;
+    while (tryPopMany_(works, MAX_DRAIN_BATCH))
     {
-        callWork(work);
+        for (const Work& work : works)
+        {
+            callWork(work);
+        }
+        works.clear();
     }
+    // </FS>
     return ! done();
 }
 
@@ -71,16 +108,72 @@ bool LL::WorkQueueBase::runOne()
     return ! done();
 }
 
+// <FS> Work stealing
+bool LL::WorkQueueBase::runOneWait()
+{
+    try
+    {
+        // <FS> Batched dispatch
+        //callWork(pop_());
+        Work work;
+        if (!tryPop_(work))
+        {
+            ReplyBatch::flushCurrent();
+            work = pop_();
+        }
+        ReplyBatch::flushCurrentIfDue();
+        callWork(work);
+        // </FS>
+        return true;
+    }
+    catch (const Closed&)
+    {
+        return false;
+    }
+}
+// </FS>
+
 bool LL::WorkQueueBase::runUntil(const TimePoint& until)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
     // Should we subtract some slop to allow for typical Work execution time?
     // How much slop?
     // runUntil() is simply a time-bounded runPending().
-    for (Work work; TimePoint::clock::now() < until && tryPop_(work); )
+    // <FS> Batched dispatch
+    //for (Work work; TimePoint::clock::now() < until && tryPop_(work); )
+    //{
+    //    callWork(work);
+    //}
+    // Take as many items at once as should fit in what is left of the
+    // timeslice, going by what items have cost lately. Whatever was taken
+    // runs, so guessing low beats guessing high.
+    std::vector<Work> works;
+    for (TimePoint now = TimePoint::clock::now(); now < until; )
     {
-        callWork(work);
+        const F32 avg_micros = mAvgWorkMicros.load(std::memory_order_relaxed);
+        const F32 left_micros = (F32)std::chrono::duration_cast<std::chrono::microseconds>(until - now).count();
+        size_t batch = MAX_DRAIN_BATCH;
+        if (avg_micros > 0.f)
+        {
+            batch = std::clamp((size_t)(left_micros / avg_micros), (size_t)1, MAX_DRAIN_BATCH);
+        }
+        if (!tryPopMany_(works, batch))
+        {
+            break;
+        }
+
+        for (const Work& work : works)
+        {
+            callWork(work);
+        }
+
+        const TimePoint start = now;
+        now = TimePoint::clock::now();
+        const F32 micros = (F32)std::chrono::duration_cast<std::chrono::microseconds>(now - start).count() / (F32)works.size();
+        mAvgWorkMicros.store((avg_micros > 0.f) ? avg_micros * 0.9f + micros * 0.1f : micros, std::memory_order_relaxed);
+        works.clear();
     }
+    // </FS>
     return ! done();
 }
 
@@ -117,6 +210,150 @@ void LL::WorkQueueBase::callWork(const Work& work)
     }
 }
 
+// <FS> Batched dispatch
+size_t LL::WorkQueueBase::postBatch(std::vector<Work>& works)
+{
+    size_t posted = 0;
+    for (const Work& work : works)
+    {
+        if (!post(work))
+        {
+            break;
+        }
+        ++posted;
+    }
+    works.clear();
+    return posted;
+}
+
+// static
+size_t LL::WorkQueueBase::postBatchMaybe(weak_t target, std::vector<Work>& works)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    auto tptr = target.lock();
+    if (!tptr)
+    {
+        works.clear();
+        return 0;
+    }
+    return tptr->postBatch(works);
+}
+
+// static
+bool LL::WorkQueueBase::postReply(weak_t target, Work&& work)
+{
+    if (ReplyBatch::add(target, std::move(work)))
+    {
+        return true;
+    }
+    return postMaybe(target, std::move(work));
+}
+
+size_t LL::WorkQueueBase::tryPopMany_(std::vector<Work>& works, size_t max)
+{
+    size_t popped = 0;
+    for (Work work; popped < max && tryPop_(work); ++popped)
+    {
+        works.push_back(std::move(work));
+    }
+    return popped;
+}
+
+/*****************************************************************************
+*   WorkQueueBase::ReplyBatch
+*****************************************************************************/
+LL::WorkQueueBase::ReplyBatch::ReplyBatch():
+    mPrevious(tReplyBatch),
+    mAvgWorkMicros(0.f)
+{
+    tReplyBatch = this;
+}
+
+LL::WorkQueueBase::ReplyBatch::~ReplyBatch()
+{
+    // Become inactive first: the flush posts, and posting flushes
+    tReplyBatch = mPrevious;
+    flush();
+}
+
+// static
+bool LL::WorkQueueBase::ReplyBatch::add(const weak_t& target, Work&& work)
+{
+    ReplyBatch* self = tReplyBatch;
+    if (!self)
+    {
+        return false;
+    }
+
+    // Replies go back to one queue at a time, almost always the main loop.
+    // A reply for another one sends what is held first to keep the order.
+    if (!self->mWork.empty() && (self->mTarget.owner_before(target) || target.owner_before(self->mTarget)))
+    {
+        self->flush();
+    }
+    if (self->mWork.empty())
+    {
+        self->mTarget = target;
+        self->mOldest = TimePoint::clock::now();
+    }
+    self->mWork.push_back(std::move(work));
+    return true;
+}
+
+// static
+void LL::WorkQueueBase::ReplyBatch::flushCurrent()
+{
+    if (ReplyBatch* self = tReplyBatch)
+    {
+        // What comes next is a wait, not work
+        self->mLastCheck = TimePoint();
+        self->flush();
+    }
+}
+
+// static
+void LL::WorkQueueBase::ReplyBatch::flushCurrentIfDue()
+{
+    ReplyBatch* self = tReplyBatch;
+    if (!self)
+    {
+        return;
+    }
+
+    // Called once per item, the time since the last call is about what an
+    // item takes on this thread
+    const TimePoint now = TimePoint::clock::now();
+    if (self->mLastCheck != TimePoint())
+    {
+        const F32 micros = (F32)std::chrono::duration_cast<std::chrono::microseconds>(now - self->mLastCheck).count();
+        self->mAvgWorkMicros = self->mAvgWorkMicros * 0.9f + micros * 0.1f;
+    }
+    self->mLastCheck = now;
+
+    // Where items take long, holding replies across the next one delays
+    // them for nothing
+    if (!self->mWork.empty() &&
+        (self->mWork.size() >= MAX_REPLIES || now - self->mOldest >= MAX_DELAY ||
+         self->mAvgWorkMicros >= (F32)MAX_DELAY.count()))
+    {
+        self->flush();
+    }
+}
+
+void LL::WorkQueueBase::ReplyBatch::flush()
+{
+    if (mWork.empty())
+    {
+        return;
+    }
+    // postBatch() must not find these again through flushCurrent()
+    std::vector<Work> works;
+    works.swap(mWork);
+    postBatchMaybe(mTarget, works);
+    mTarget.reset();
+}
+// </FS>
+
 void LL::WorkQueueBase::error(const std::string& msg)
 {
     LL_ERRS("WorkQueue") << msg << LL_ENDL;
@@ -163,14 +400,26 @@ bool LL::WorkQueue::done()
 
 bool LL::WorkQueue::post(const Work& callable)
 {
+    ReplyBatch::flushCurrent(); // <FS/> Batched dispatch
     return mQueue.pushIfOpen(callable);
 }
 
 bool LL::WorkQueue::tryPost(const Work& callable)
 {
+    ReplyBatch::flushCurrent(); // <FS/> Batched dispatch
     return mQueue.tryPush(callable);
 }
 
+// <FS> Batched dispatch
+size_t LL::WorkQueue::postBatch(std::vector<Work>& works)
+{
+    ReplyBatch::flushCurrent();
+    size_t posted = mQueue.pushManyIfOpen(works.begin(), works.end());
+    works.clear();
+    return posted;
+}
+// </FS>
+
 LL::WorkQueue::Work LL::WorkQueue::pop_()
 {
     return mQueue.pop();
@@ -181,6 +430,13 @@ bool LL::WorkQueue::tryPop_(Work& work)
     return mQueue.tryPop(work);
 }
 
+// <FS> Batched dispatch
+size_t LL::WorkQueue::tryPopMany_(std::vector<Work>& works, size_t max)
+{
+    return mQueue.tryPopMany(works, max);
+}
+// </FS>
+
 /*****************************************************************************
 *   WorkSchedule
 *****************************************************************************/
@@ -221,6 +477,7 @@ bool LL::WorkSchedule::post(const Work& callable)
 
 bool LL::WorkSchedule::post(const Work& callable, const TimePoint& time)
 {
+    ReplyBatch::flushCurrent(); // <FS/> Batched dispatch
     return mQueue.pushIfOpen(TimedWork(time, callable));
 }
 
@@ -231,6 +488,7 @@ bool LL::WorkSchedule::tryPost(const Work& callable)
 
 bool LL::WorkSchedule::tryPost(const Work& callable, const TimePoint& time)
 {
+    ReplyBatch::flushCurrent(); // <FS/> Batched dispatch
     return mQueue.tryPush(TimedWork(time, callable));
 }
 
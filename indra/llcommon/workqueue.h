@@ -17,10 +17,12 @@
 #include "llinstancetracker.h"
 #include "llinstancetrackersubclass.h"
 #include "threadsafeschedule.h"
+#include <atomic>                   // <FS/> Batched dispatch
 #include <chrono>
 #include <exception>                // std::current_exception
 #include <functional>               // std::function
 #include <string>
+#include <vector>                   // <FS/> Batched dispatch
 
 namespace LL
 {
@@ -101,6 +103,65 @@ namespace LL
         template <typename... ARGS>
         static bool postMaybe(weak_t target, ARGS&&... args);
 
+        // <FS> Batched dispatch
+        /**
+         * post several work items at once, unless the queue is closed first.
+         * The items are moved out of works, which is left empty. Returns how
+         * many were posted. The default posts them one by one; WorkQueue
+         * posts them all under one lock with one wakeup.
+         */
+        virtual size_t postBatch(std::vector<Work>& works);
+
+        /**
+         * postBatch() to another WorkQueue, which may or may not still exist
+         * and be open.
+         */
+        static size_t postBatchMaybe(weak_t target, std::vector<Work>& works);
+
+        /**
+         * While a ReplyBatch exists on a thread, the replies postTo() sends
+         * from that thread are held back and posted to their originating
+         * WorkQueue together: once MAX_REPLIES have piled up, once the oldest
+         * has waited MAX_DELAY, before the thread waits for more work, before
+         * it posts anything else and when the ReplyBatch goes away.
+         * runUntilClose() keeps one, thread pools do too. A worker finishing
+         * many small requests then wakes the requesting thread once instead
+         * of once per request.
+         */
+        class ReplyBatch
+        {
+        public:
+            static constexpr size_t MAX_REPLIES = 32;
+            static constexpr std::chrono::microseconds MAX_DELAY{ 500 };
+
+            ReplyBatch();
+            ~ReplyBatch();
+
+            ReplyBatch(const ReplyBatch&) = delete;
+            ReplyBatch& operator=(const ReplyBatch&) = delete;
+
+            // Hold work for target if this thread has a ReplyBatch, returns
+            // false if it hasn't
+            static bool add(const weak_t& target, Work&& work);
+            // Post whatever this thread holds, before it waits for work
+            static void flushCurrent();
+            // Before each item: post what this thread holds once it is
+            // MAX_REPLIES or MAX_DELAY old, or right away where items take
+            // longer than MAX_DELAY
+            static void flushCurrentIfDue();
+
+        private:
+            void flush();
+
+            ReplyBatch* mPrevious;
+            weak_t mTarget;
+            std::vector<Work> mWork;
+            TimePoint mOldest;
+            TimePoint mLastCheck;
+            F32 mAvgWorkMicros;
+        };
+        // </FS>
+
         /*------------------------- handshake API --------------------------*/
 
         /**
@@ -151,6 +212,15 @@ namespace LL
          */
         bool runOne();
 
+        // <FS> Work stealing
+        /**
+         * runOneWait() runs one TimedWork item, waiting for one to become
+         * ready if none is. It returns true if it ran an item, false once
+         * the queue has been closed and drained.
+         */
+        bool runOneWait();
+        // </FS>
+
         /**
          * runFor() runs a subset of ready TimedWork items, until the
          * timeslice has been exceeded. It returns true if the queue remains
@@ -194,9 +264,23 @@ namespace LL
         static std::string makeName(const std::string& name);
         void callWork(const Work& work);
 
+        // <FS> Batched dispatch
+        // Routes a postTo() reply through this thread's ReplyBatch, if any
+        static bool postReply(weak_t target, Work&& work);
+        // </FS>
+
     private:
         virtual Work pop_() = 0;
         virtual bool tryPop_(Work&) = 0;
+        // <FS> Batched dispatch
+        // Pop up to max ready items at once, without blocking. The default
+        // pops them one by one.
+        virtual size_t tryPopMany_(std::vector<Work>& works, size_t max);
+
+        // Moving average of the time one item takes in runUntil(), in
+        // microseconds, to size the batches it pops to its timeslice
+        std::atomic<F32> mAvgWorkMicros{ 0.f };
+        // </FS>
     };
 
 /*****************************************************************************
@@ -254,12 +338,21 @@ namespace LL
          */
         bool tryPost(const Work&) override;
 
+        // <FS> Batched dispatch
+        /**
+         * post several work items under one lock, unless the queue is closed
+         * first
+         */
+        size_t postBatch(std::vector<Work>& works) override;
+        // </FS>
+
     private:
         using Queue = LLThreadSafeQueue<Work>;
         Queue mQueue;
 
         Work pop_() override;
         bool tryPop_(Work&) override;
+        size_t tryPopMany_(std::vector<Work>& works, size_t max) override; // <FS/> Batched dispatch
     };
 
 /*****************************************************************************
@@ -514,7 +607,10 @@ namespace LL
                     // Make a reply lambda to repost to THIS WorkQueue.
                     // Delegate to makeReplyLambda() so we can partially
                     // specialize on void return.
-                    postMaybe(reply, makeReplyLambda(std::move(callable), std::move(callback)));
+                    // <FS> Batched dispatch
+                    //postMaybe(reply, makeReplyLambda(std::move(callable), std::move(callback)));
+                    postReply(reply, makeReplyLambda(std::move(callable), std::move(callback)));
+                    // </FS>
                 }
                 catch (...)
                 {
@@ -0,0 +1,167 @@
+/**
+ * @file _httpconcurrency.cpp
+ * @brief Adaptive concurrency limit of a policy class
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "_httpconcurrency.h"
+
+#include "_httpinternal.h"
+
+#include <limits>
+
+
+namespace
+{
+
+// Latency base may rise by this much a window, lets it follow a
+// change of route or of server
+const F32 LATENCY_BASE_DRIFT = 1.02f;
+
+// Average latency over the base that is taken for queuing
+const F32 LATENCY_QUEUING_FACTOR = 3.0f;
+
+// Throughput gain below which a longer latency isn't paying off
+const F32 THROUGHPUT_GAIN = 1.05f;
+
+} // end anonymous namespace
+
+
+namespace LLCore
+{
+
+
+HttpConcurrencyController::HttpConcurrencyController()
+    : mStart(0),
+      mCeiling(0),
+      mLimit(HTTP_ADAPTIVE_LIMIT_MIN),
+      mWindowEnd(0),
+      mSaturated(false),
+      mCompleted(0U),
+      mSucceeded(0U),
+      mCongested(0U),
+      mBytes(0U),
+      mLatencySum(0),
+      mLatencyMin(std::numeric_limits<HttpTime>::max()),
+      mThroughput(0.f),
+      mLatency(0.f),
+      mLatencyBase(0.f),
+      mCongestionRate(0.f),
+      mIncreases(0U),
+      mDecreases(0U)
+{}
+
+
+void HttpConcurrencyController::configure(int start, int ceiling)
+{
+    ceiling = llmax(ceiling, HTTP_ADAPTIVE_LIMIT_MIN);
+    start = llclamp(start, HTTP_ADAPTIVE_LIMIT_MIN, ceiling);
+    if (start == mStart && ceiling == mCeiling)
+    {
+        return;
+    }
+
+    *this = HttpConcurrencyController();
+    mStart = start;
+    mCeiling = ceiling;
+    mLimit = start;
+}
+
+
+void HttpConcurrencyController::noteCompletion(ECompletion kind, HttpTime latency, size_t bytes)
+{
+    ++mCompleted;
+    mBytes += bytes;
+    if (COMPLETION_CONGESTED == kind)
+    {
+        ++mCongested;
+    }
+    else if (COMPLETION_SUCCESS == kind)
+    {
+        ++mSucceeded;
+        mLatencySum += latency;
+        mLatencyMin = llmin(mLatencyMin, latency);
+    }
+}
+
+
+bool HttpConcurrencyController::update(HttpTime now)
+{
+    if (! mWindowEnd)
+    {
+        mWindowEnd = now + HTTP_ADAPTIVE_WINDOW;
+        return false;
+    }
+    if (now < mWindowEnd)
+    {
+        return false;
+    }
+
+    const F32 seconds(F32(now + HTTP_ADAPTIVE_WINDOW - mWindowEnd) / 1000000.f);
+    const F32 last_throughput(mThroughput);
+    mThroughput = F32(mBytes) / seconds;
+    mCongestionRate = mCompleted ? F32(mCongested) / F32(mCompleted) : 0.f;
+    if (mSucceeded)
+    {
+        mLatency = F32(mLatencySum) / F32(mSucceeded) / 1000.f;
+        const F32 latency_min(F32(mLatencyMin) / 1000.f);
+        mLatencyBase = mLatencyBase > 0.f ? llmin(mLatencyBase * LATENCY_BASE_DRIFT, latency_min) : latency_min;
+    }
+
+    if (mCongested)
+    {
+        // Throttled, back off hard
+        mLimit = llmax(HTTP_ADAPTIVE_LIMIT_MIN, mLimit / 2);
+        ++mDecreases;
+    }
+    else if (mSaturated && mSucceeded
+             && mLatency > mLatencyBase * LATENCY_QUEUING_FACTOR
+             && mThroughput <= last_throughput * THROUGHPUT_GAIN)
+    {
+        // More requests only wait longer at the server
+        if (mLimit > HTTP_ADAPTIVE_LIMIT_MIN)
+        {
+            --mLimit;
+            ++mDecreases;
+        }
+    }
+    else if (mSaturated && mLimit < mCeiling)
+    {
+        ++mLimit;
+        ++mIncreases;
+    }
+
+    mWindowEnd = now + HTTP_ADAPTIVE_WINDOW;
+    mSaturated = false;
+    mCompleted = 0U;
+    mSucceeded = 0U;
+    mCongested = 0U;
+    mBytes = 0U;
+    mLatencySum = 0;
+    mLatencyMin = std::numeric_limits<HttpTime>::max();
+    return true;
+}
+
+
+}  // end namespace LLCore
@@ -0,0 +1,118 @@
+/**
+ * @file _httpconcurrency.h
+ * @brief Adaptive concurrency limit of a policy class
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef _LLCORE_HTTP_CONCURRENCY_H_
+#define _LLCORE_HTTP_CONCURRENCY_H_
+
+
+#include "httpcommon.h"
+
+
+namespace LLCore
+{
+
+/// Additive-increase, multiplicative-decrease controller for the
+/// number of requests a policy class keeps active.
+///
+/// Completions are gathered over windows of HTTP_ADAPTIVE_WINDOW.
+/// At the end of a window the limit is:
+///
+/// - halved when any request was throttled (429, 5xx) or failed
+///   in a retryable way (timeouts, resets),
+/// - lowered by one when latency grew well past the lowest seen
+///   without any gain in throughput, requests are only queuing
+///   at the server,
+/// - raised by one when requests were kept waiting at the limit.
+///
+/// The limit stays between HTTP_ADAPTIVE_LIMIT_MIN and the ceiling
+/// given with PO_ADAPTIVE_CONCURRENCY.
+///
+/// Threading:  Single-threaded, owned by the worker thread.
+class HttpConcurrencyController
+{
+public:
+    enum ECompletion
+    {
+        COMPLETION_SUCCESS,
+        COMPLETION_CONGESTED,       // throttled or timed out
+        COMPLETION_FAILED           // other failures, no signal
+    };
+
+    HttpConcurrencyController();
+
+    /// (Re)starts the controller at the static limit of the class
+    /// when it or the ceiling changed, keeps its state otherwise.
+    void configure(int start, int ceiling);
+
+    /// Requests were waiting for a slot during this window.
+    void noteSaturated()
+        {
+            mSaturated = true;
+        }
+
+    void noteCompletion(ECompletion kind, HttpTime latency, size_t bytes);
+
+    /// Closes the window when it is over.
+    ///
+    /// @return         true if a window was closed.
+    bool update(HttpTime now);
+
+    int getLimit() const            { return mLimit; }
+    int getCeiling() const          { return mCeiling; }
+    F32 getThroughput() const       { return mThroughput; }         // bytes/s over the last window
+    F32 getLatency() const          { return mLatency; }            // mS, average over the last window
+    F32 getLatencyBase() const      { return mLatencyBase; }        // mS
+    F32 getCongestionRate() const   { return mCongestionRate; }     // over the last window
+    U32 getIncreases() const        { return mIncreases; }
+    U32 getDecreases() const        { return mDecreases; }
+
+protected:
+    int                 mStart;
+    int                 mCeiling;
+    int                 mLimit;
+    HttpTime            mWindowEnd;
+
+    // This window
+    bool                mSaturated;
+    U32                 mCompleted;
+    U32                 mSucceeded;
+    U32                 mCongested;
+    U64                 mBytes;
+    HttpTime            mLatencySum;
+    HttpTime            mLatencyMin;
+
+    // Last window
+    F32                 mThroughput;
+    F32                 mLatency;
+    F32                 mLatencyBase;
+    F32                 mCongestionRate;
+    U32                 mIncreases;
+    U32                 mDecreases;
+};  // end class HttpConcurrencyController
+
+}  // end namespace LLCore
+
+#endif // _LLCORE_HTTP_CONCURRENCY_H_
@@ -153,10 +153,27 @@ constexpr int HTTP_CONNECTION_LIMIT_MAX = 256;
 constexpr long HTTP_PIPELINING_DEFAULT = 0L;
 constexpr long HTTP_PIPELINING_MAX = 20L;
 
+// HTTP/2 stream weight limits, see RFC 7540 5.3.2
+constexpr int HTTP_STREAM_WEIGHT_DEFAULT = 16;
+constexpr int HTTP_STREAM_WEIGHT_MIN = 1;
+constexpr int HTTP_STREAM_WEIGHT_MAX = 256;
+
 // Miscellaneous defaults
 constexpr bool HTTP_USE_RETRY_AFTER_DEFAULT = true;
 constexpr long HTTP_THROTTLE_RATE_DEFAULT = 0L;
 
+// <FS> Adaptive concurrency
+// Adaptive concurrency, see HttpConcurrencyController
+constexpr HttpTime HTTP_ADAPTIVE_WINDOW = 1000000UL; // 1 sec
+constexpr int HTTP_ADAPTIVE_LIMIT_MIN = 1;
+// </FS>
+
+// <FS> Zero-copy body handoff
+// Largest response body received into one contiguous region when
+// its length is known up front
+constexpr size_t HTTP_BODY_RESERVE_MAX = 32 * 1024 * 1024;
+// </FS>
+
 // Tuning parameters
 
 // Time worker thread sleeps after a pass through the
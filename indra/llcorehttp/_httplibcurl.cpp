@@ -541,7 +541,21 @@ void HttpLibcurl::policyUpdated(unsigned int policy_class)
         policy.stallPolicy(policy_class, false);
         mDirtyPolicy[policy_class] = false;
 
-        if (options.mPipelining > 1)
+        if (options.mMultiplexing)
+        {
+            // HTTP/2 streams share the per-host connections; libcurl
+            // falls back to one request per connection on HTTP/1.1
+            check_curl_multi_setopt(multi_handle,
+                                     CURLMOPT_PIPELINING,
+                                     long(CURLPIPE_MULTIPLEX));
+            check_curl_multi_setopt(multi_handle,
+                                     CURLMOPT_MAX_HOST_CONNECTIONS,
+                                     long(options.mPerHostConnectionLimit));
+            check_curl_multi_setopt(multi_handle,
+                                     CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                                     long(options.mConnectionLimit));
+        }
+        else if (options.mPipelining > 1)
         {
             // We'll try to do pipelining on this multihandle
             check_curl_multi_setopt(multi_handle,
@@ -565,9 +579,15 @@ void HttpLibcurl::policyUpdated(unsigned int policy_class)
             check_curl_multi_setopt(multi_handle,
                                      CURLMOPT_MAX_HOST_CONNECTIONS,
                                      0L);
+            // <FS> Adaptive concurrency
+            // One connection per active request, leave room for the adaptive limit
+            //check_curl_multi_setopt(multi_handle,
+            //                         CURLMOPT_MAX_TOTAL_CONNECTIONS,
+            //                         long(options.mConnectionLimit));
             check_curl_multi_setopt(multi_handle,
                                      CURLMOPT_MAX_TOTAL_CONNECTIONS,
-                                     long(options.mConnectionLimit));
+                                     llmax(long(options.mConnectionLimit), options.mAdaptiveConcurrency));
+            // </FS>
         }
     }
     else if (! mDirtyPolicy[policy_class])
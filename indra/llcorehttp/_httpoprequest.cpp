@@ -155,6 +155,7 @@ HttpOpRequest::HttpOpRequest()
       mPolicyRetryLimit(HTTP_RETRY_COUNT_DEFAULT),
       mPolicyMinRetryBackoff(HttpTime(HTTP_RETRY_BACKOFF_MIN_DEFAULT)),
       mPolicyMaxRetryBackoff(HttpTime(HTTP_RETRY_BACKOFF_MAX_DEFAULT)),
+      mPolicyActiveAt(HttpTime(0)), // <FS/> Adaptive concurrency
       mCallbackSSLVerify(NULL)
 {
     // *NOTE:  As members are added, retry initialization/cleanup
@@ -770,6 +771,15 @@ HttpStatus HttpOpRequest::prepareRequest(HttpService * service)
     //    xfer_timeout = 1L;
     //    timeout = 1L;
     //}
+    if (cpolicy.mMultiplexing)
+    {
+        // Wait for a stream on an existing connection rather than
+        // opening a new one for every request
+        check_curl_easy_setopt(mCurlHandle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        check_curl_easy_setopt(mCurlHandle, CURLOPT_PIPEWAIT, 1L);
+        check_curl_easy_setopt(mCurlHandle, CURLOPT_STREAM_WEIGHT,
+                               long(mReqOptions ? mReqOptions->getStreamWeight() : HTTP_STREAM_WEIGHT_DEFAULT));
+    }
     check_curl_easy_setopt(mCurlHandle, CURLOPT_TIMEOUT, xfer_timeout);
     check_curl_easy_setopt(mCurlHandle, CURLOPT_CONNECTTIMEOUT, timeout);
 
@@ -803,6 +813,17 @@ size_t HttpOpRequest::writeCallback(void * data, size_t size, size_t nmemb, void
     if (! op->mReplyBody)
     {
         op->mReplyBody = new BufferArray();
+
+        // <FS> Zero-copy body handoff
+        // With a known length, receive the body in one piece that
+        // consumers can take over without copying it
+        curl_off_t length(-1);
+        if (CURLE_OK == curl_easy_getinfo(op->mCurlHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length)
+            && length > 0 && length <= curl_off_t(HTTP_BODY_RESERVE_MAX))
+        {
+            op->mReplyBody->reserve(size_t(length));
+        }
+        // </FS>
     }
     const size_t req_size(size * nmemb);
     const size_t write_size(op->mReplyBody->append(static_cast<char *>(data), req_size));
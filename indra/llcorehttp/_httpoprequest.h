@@ -226,6 +226,7 @@ public:
     int                 mPolicyRetryLimit;
     HttpTime            mPolicyMinRetryBackoff; // initial delay between retries (mcs)
     HttpTime            mPolicyMaxRetryBackoff;
+    HttpTime            mPolicyActiveAt;        // <FS/> Adaptive concurrency, when last handed to transport
 };  // end class HttpOpRequest
 
 
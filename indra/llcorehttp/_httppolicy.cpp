@@ -32,6 +32,7 @@
 #include "_httpservice.h"
 #include "_httplibcurl.h"
 #include "_httppolicyclass.h"
+#include "bufferarray.h" // <FS/> Adaptive concurrency
 
 #include "lltimer.h"
 #include "httpstats.h"
@@ -71,6 +72,7 @@ public:
     long                mThrottleLeft;
     long                mRequestCount;
     bool                mStallStaging;
+    HttpConcurrencyController mConcurrency; // <FS/> Adaptive concurrency
 };
 
 
@@ -233,6 +235,24 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
             result = HttpService::NORMAL;
             continue;
         }
+
+        // <FS> Adaptive concurrency
+        int static_limit(state.mOptions.mPipelining > 1L
+                         ? (state.mOptions.mPerHostConnectionLimit
+                            * state.mOptions.mPipelining)
+                         : state.mOptions.mConnectionLimit);
+        const bool adaptive(state.mOptions.mAdaptiveConcurrency > 0L);
+        if (adaptive)
+        {
+            // Starts over when the class options change
+            state.mConcurrency.configure(static_limit, int(state.mOptions.mAdaptiveConcurrency));
+            if (state.mConcurrency.update(now))
+            {
+                recordConcurrency(policy_class, state.mConcurrency);
+            }
+        }
+        // </FS>
+
         if (retryq.empty() && readyq.empty())
         {
             continue;
@@ -249,10 +269,13 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
         }
 
         int active(transport.getActiveCountInClass(policy_class));
-        int active_limit(state.mOptions.mPipelining > 1L
-                         ? (state.mOptions.mPerHostConnectionLimit
-                            * state.mOptions.mPipelining)
-                         : state.mOptions.mConnectionLimit);
+        // <FS> Adaptive concurrency
+        //int active_limit(state.mOptions.mPipelining > 1L
+        //                 ? (state.mOptions.mPerHostConnectionLimit
+        //                    * state.mOptions.mPipelining)
+        //                 : state.mOptions.mConnectionLimit);
+        int active_limit(adaptive ? state.mConcurrency.getLimit() : static_limit);
+        // </FS>
         int needed(active_limit - active);      // Expect negatives here
 
         if (needed > 0)
@@ -266,6 +289,7 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
 
                 retryq.pop();
 
+                op->mPolicyActiveAt = now; // <FS/> Adaptive concurrency
                 op->stageFromReady(mService);
                 op.reset();
 
@@ -295,6 +319,7 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
                 HttpOpRequest::ptr_t op(readyq.top());
                 readyq.pop();
 
+                op->mPolicyActiveAt = now; // <FS/> Adaptive concurrency
                 op->stageFromReady(mService);
                 op.reset();
 
@@ -321,6 +346,14 @@ HttpService::ELoopSpeed HttpPolicy::processReadyQueue()
 
     throttle_on:
 
+        // <FS> Adaptive concurrency
+        if (adaptive && needed <= 0 && ! readyq.empty())
+        {
+            // New requests are waiting on the limit
+            state.mConcurrency.noteSaturated();
+        }
+        // </FS>
+
         if (! readyq.empty() || ! retryq.empty())
         {
             // If anything is ready, continue looping...
@@ -374,6 +407,25 @@ bool HttpPolicy::cancel(HttpHandle handle)
 
 bool HttpPolicy::stageAfterCompletion(const HttpOpRequest::ptr_t &op)
 {
+    // <FS> Adaptive concurrency
+    ClassState & state(*mClasses[op->mReqPolicy]);
+    if (state.mOptions.mAdaptiveConcurrency > 0L)
+    {
+        static const HttpStatus error_429(429);
+
+        HttpConcurrencyController::ECompletion kind(HttpConcurrencyController::COMPLETION_SUCCESS);
+        if (! op->mStatus)
+        {
+            kind = (op->mStatus.isRetryable() || error_429 == op->mStatus)
+                ? HttpConcurrencyController::COMPLETION_CONGESTED
+                : HttpConcurrencyController::COMPLETION_FAILED;
+        }
+        state.mConcurrency.noteCompletion(kind,
+                                          totalTime() - op->mPolicyActiveAt,
+                                          op->mReplyBody ? op->mReplyBody->size() : 0);
+    }
+    // </FS>
+
     // Retry or finalize
     if (! op->mStatus)
     {
@@ -429,6 +481,23 @@ HttpPolicyClass & HttpPolicy::getClassOptions(HttpRequest::policy_t pclass)
 }
 
 
+// <FS> Adaptive concurrency
+void HttpPolicy::recordConcurrency(HttpRequest::policy_t policy_class, const HttpConcurrencyController & concurrency)
+{
+    HTTPStats::ConcurrencyStats stats;
+    stats.mLimit = concurrency.getLimit();
+    stats.mCeiling = concurrency.getCeiling();
+    stats.mThroughput = concurrency.getThroughput();
+    stats.mLatency = concurrency.getLatency();
+    stats.mLatencyBase = concurrency.getLatencyBase();
+    stats.mCongestionRate = concurrency.getCongestionRate();
+    stats.mIncreases = concurrency.getIncreases();
+    stats.mDecreases = concurrency.getDecreases();
+    HTTPStats::instance().recordConcurrency(policy_class, stats);
+}
+// </FS>
+
+
 int HttpPolicy::getReadyCount(HttpRequest::policy_t policy_class) const
 {
     if (policy_class < mClasses.size())
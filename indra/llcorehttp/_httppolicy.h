@@ -34,6 +34,7 @@
 #include "_httpretryqueue.h"
 #include "_httppolicyglobal.h"
 #include "_httppolicyclass.h"
+#include "_httpconcurrency.h" // <FS/> Adaptive concurrency
 #include "_httpinternal.h"
 
 
@@ -163,6 +164,13 @@ public:
     bool stallPolicy(HttpRequest::policy_t policy_class, bool stall);
 
 protected:
+    // <FS> Adaptive concurrency
+    /// Publish the state of an adaptive class to HTTPStats.
+    ///
+    /// Threading:  called by worker thread
+    void recordConcurrency(HttpRequest::policy_t policy_class, const HttpConcurrencyController & concurrency);
+    // </FS>
+
     struct ClassState;
     typedef std::vector<ClassState *>   class_list_t;
 
@@ -37,7 +37,11 @@ HttpPolicyClass::HttpPolicyClass()
     : mConnectionLimit(HTTP_CONNECTION_LIMIT_DEFAULT),
       mPerHostConnectionLimit(HTTP_CONNECTION_LIMIT_DEFAULT),
       mPipelining(HTTP_PIPELINING_DEFAULT),
-      mThrottleRate(HTTP_THROTTLE_RATE_DEFAULT)
+      mThrottleRate(HTTP_THROTTLE_RATE_DEFAULT),
+      // <FS> Adaptive concurrency
+      mMultiplexing(0L),
+      mAdaptiveConcurrency(0L)
+      // </FS>
 {}
 
 
@@ -53,6 +57,8 @@ HttpPolicyClass & HttpPolicyClass::operator=(const HttpPolicyClass & other)
         mPerHostConnectionLimit = other.mPerHostConnectionLimit;
         mPipelining = other.mPipelining;
         mThrottleRate = other.mThrottleRate;
+        mMultiplexing = other.mMultiplexing;
+        mAdaptiveConcurrency = other.mAdaptiveConcurrency; // <FS/> Adaptive concurrency
     }
     return *this;
 }
@@ -62,7 +68,11 @@ HttpPolicyClass::HttpPolicyClass(const HttpPolicyClass & other)
     : mConnectionLimit(other.mConnectionLimit),
       mPerHostConnectionLimit(other.mPerHostConnectionLimit),
       mPipelining(other.mPipelining),
-      mThrottleRate(other.mThrottleRate)
+      mThrottleRate(other.mThrottleRate),
+      // <FS> Adaptive concurrency
+      mMultiplexing(other.mMultiplexing),
+      mAdaptiveConcurrency(other.mAdaptiveConcurrency)
+      // </FS>
 {}
 
 
@@ -86,6 +96,16 @@ HttpStatus HttpPolicyClass::set(HttpRequest::EPolicyOption opt, long value)
         mThrottleRate = llclamp(value, 0L, 1000000L);
         break;
 
+    case HttpRequest::PO_MULTIPLEXING:
+        mMultiplexing = value ? 1L : 0L;
+        break;
+
+    // <FS> Adaptive concurrency
+    case HttpRequest::PO_ADAPTIVE_CONCURRENCY:
+        mAdaptiveConcurrency = llclamp(value, 0L, long(HTTP_CONNECTION_LIMIT_MAX * HTTP_PIPELINING_MAX));
+        break;
+    // </FS>
+
     default:
         return HttpStatus(HttpStatus::LLCORE, HE_INVALID_ARG);
     }
@@ -114,6 +134,16 @@ HttpStatus HttpPolicyClass::get(HttpRequest::EPolicyOption opt, long * value) co
         *value = mThrottleRate;
         break;
 
+    case HttpRequest::PO_MULTIPLEXING:
+        *value = mMultiplexing;
+        break;
+
+    // <FS> Adaptive concurrency
+    case HttpRequest::PO_ADAPTIVE_CONCURRENCY:
+        *value = mAdaptiveConcurrency;
+        break;
+    // </FS>
+
     default:
         return HttpStatus(HttpStatus::LLCORE, HE_INVALID_ARG);
     }
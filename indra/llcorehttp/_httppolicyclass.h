@@ -64,6 +64,8 @@ public:
     long                        mPerHostConnectionLimit;
     long                        mPipelining;
     long                        mThrottleRate;
+    long                        mMultiplexing;
+    long                        mAdaptiveConcurrency;       // <FS/> Adaptive concurrency
 };  // end class HttpPolicyClass
 
 }  // end namespace LLCore
@@ -59,6 +59,7 @@ public:
 
 protected:
     Block(size_t len);
+    Block(size_t len, char * data);             // <FS/> Zero-copy body handoff
 
     Block(const Block &);                       // Not defined
     void operator=(const Block &);              // Not defined
@@ -71,14 +72,26 @@ public:
     // Only public entry to get a block.
     static Block * alloc(size_t len);
 
+    // <FS> Zero-copy body handoff
+    // Block with its data in a separate buffer from ll_aligned_malloc_16(),
+    // NULL if it can't be allocated.
+    static Block * allocAligned(size_t len);
+    // </FS>
+
 public:
     size_t mUsed;
     size_t mAlloced;
 
+    // <FS> Zero-copy body handoff
+    char * mData;                               // mStorage or an aligned buffer
+    bool mAligned;
+    // </FS>
+
     // *NOTE:  Must be last member of the object.  We'll
     // overallocate as requested via operator new and index
     // into the array at will.
-    char mData[1];
+    //char mData[1];
+    char mStorage[1];                           // <FS/> Zero-copy body handoff
 };
 
 
@@ -184,6 +197,84 @@ void * BufferArray::appendBufferAlloc(size_t len)
 }
 
 
+// <FS> Zero-copy body handoff
+bool BufferArray::reserve(size_t len)
+{
+    if (mLen || ! mBlocks.empty() || ! len)
+    {
+        return false;
+    }
+
+    Block * block;
+    try
+    {
+        block = Block::allocAligned(len);
+    }
+    catch (std::bad_alloc&)
+    {
+        block = NULL;
+    }
+    if (! block)
+    {
+        LL_WARNS() << "Unable to reserve " << len << " bytes, continuing with small blocks." << LL_ENDL;
+        return false;
+    }
+    mBlocks.push_back(block);
+    return true;
+}
+
+
+void * BufferArray::detachAlignedData(size_t * len)
+{
+    *len = 0;
+    if (! mLen)
+    {
+        return NULL;
+    }
+
+    // Content sits in the reserved region, skipping empty blocks
+    // appendBufferAlloc() may have added after it
+    Block * only(NULL);
+    for (Block * block : mBlocks)
+    {
+        if (block->mUsed)
+        {
+            if (only)
+            {
+                only = NULL;
+                break;
+            }
+            only = block;
+        }
+    }
+
+    if (only && only->mAligned && isLastRef())
+    {
+        void * data(only->mData);
+        only->mAligned = false;                 // Ownership leaves with the data
+        only->mData = NULL;
+        *len = mLen;
+
+        for (Block * block : mBlocks)
+        {
+            delete block;
+        }
+        mBlocks.clear();
+        mLen = 0;
+        return data;
+    }
+
+    void * data(ll_aligned_malloc_16(mLen));
+    if (! data)
+    {
+        return NULL;
+    }
+    *len = read(0, data, mLen);
+    return data;
+}
+// </FS>
+
+
 size_t BufferArray::read(size_t pos, void * dst, size_t len)
 {
     char * c_dst(static_cast<char *>(dst));
@@ -325,14 +416,38 @@ bool BufferArray::getBlockStartEnd(int block, const char ** start, const char **
 
 BufferArray::Block::Block(size_t len)
     : mUsed(0),
-      mAlloced(len)
+      // <FS> Zero-copy body handoff
+      //mAlloced(len)
+      mAlloced(len),
+      mData(mStorage),
+      mAligned(false)
+      // </FS>
 {
     memset(mData, 0, len);
 }
 
 
+// <FS> Zero-copy body handoff
+BufferArray::Block::Block(size_t len, char * data)
+    : mUsed(0),
+      mAlloced(len),
+      mData(data),
+      mAligned(true)
+{
+    // Filled by the caller, no need to clear
+}
+// </FS>
+
+
 BufferArray::Block::~Block()
 {
+    // <FS> Zero-copy body handoff
+    if (mAligned)
+    {
+        ll_aligned_free_16(mData);
+    }
+    mData = NULL;
+    // </FS>
     mUsed = 0;
     mAlloced = 0;
 }
@@ -365,4 +480,18 @@ BufferArray::Block * BufferArray::Block::alloc(size_t len)
 }
 
 
+// <FS> Zero-copy body handoff
+BufferArray::Block * BufferArray::Block::allocAligned(size_t len)
+{
+    char * data = static_cast<char *>(ll_aligned_malloc_16(len));
+    if (! data)
+    {
+        return NULL;
+    }
+    Block * block = new (0) Block(len, data);
+    return block;
+}
+// </FS>
+
+
 }  // end namespace LLCore
@@ -103,6 +103,31 @@ public:
     ///                 of BufferArray of 'len' size.
     void * appendBufferAlloc(size_t len);
 
+    // <FS> Zero-copy body handoff
+    /// Sizes an empty BufferArray for a body of known length.
+    /// Up to 'len' bytes of following append() and write()
+    /// calls land in one contiguous, 16-byte aligned region
+    /// that detachAlignedData() can hand over without a copy.
+    ///
+    /// @return         true if the region was allocated, false
+    ///                 if the instance isn't empty or memory
+    ///                 ran out.
+    bool reserve(size_t len);
+
+    /// Hands the whole content over in one buffer allocated with
+    /// ll_aligned_malloc_16(), which the caller frees with
+    /// ll_aligned_free_16() or gives to an owner that does, like
+    /// LLImageBase::setData().  When the content fills a single
+    /// reserve()d region and the caller holds the only reference,
+    /// the region itself is handed over and the instance is left
+    /// empty.  Otherwise the content is copied into a new buffer
+    /// and left in place.
+    ///
+    /// @param len      Returns the size of the buffer
+    /// @return         The buffer, NULL if empty or out of memory.
+    void * detachAlignedData(size_t * len);
+    // </FS>
+
     /// Current count of bytes in BufferArray instance.
     size_t size() const
         {
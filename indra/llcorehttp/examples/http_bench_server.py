@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""\
+@file   http_bench_server.py
+@brief  Local HTTP/1.1 server for http_load_bench.
+
+GET /bench/<size> answers 200 with a body of <size> bytes.  A 'delay'
+query parameter adds that many milliseconds before the answer, e.g.
+/bench/16384?delay=20, to simulate a distant server.
+
+$LicenseInfo:firstyear=2024&license=viewerlgpl$
+Second Life Viewer Source Code
+Copyright (C) 2024, Linden Research, Inc.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation;
+version 2.1 of the License only.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+$/LicenseInfo$
+"""
+
+import getopt
+import sys
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlparse
+
+
+class BenchRequestHandler(BaseHTTPRequestHandler):
+    # Keep-alive, so connection reuse and pipelining can be measured
+    protocol_version = "HTTP/1.1"
+    bodies = {}
+
+    def do_GET(self):
+        url = urlparse(self.path)
+        parts = url.path.strip("/").split("/")
+        if len(parts) != 2 or parts[0] != "bench" or not parts[1].isdigit():
+            self.send_error(404)
+            return
+
+        delay = parse_qs(url.query).get("delay")
+        if delay:
+            time.sleep(int(delay[0]) / 1000.0)
+
+        size = int(parts[1])
+        body = self.bodies.get(size)
+        if body is None:
+            body = self.bodies[size] = bytes(i % 251 for i in range(size))
+        self.send_response(200)
+        self.send_header("Content-Type", "application/octet-stream")
+        self.send_header("Content-Length", str(size))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, format, *args):
+        pass
+
+
+if __name__ == "__main__":
+    port = 8080
+    options, args = getopt.getopt(sys.argv[1:], "p:")
+    for option, value in options:
+        if option == "-p":
+            port = int(value)
+
+    server = ThreadingHTTPServer(("127.0.0.1", port), BenchRequestHandler)
+    server.daemon_threads = True
+    print("Serving http://127.0.0.1:%d/bench/<size>" % port)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
@@ -0,0 +1,477 @@
+/**
+ * @file http_load_bench.cpp
+ * @brief Load generation and latency benchmark for core-http library
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <map>
+#include <vector>
+#if LL_WINDOWS
+#include "windows.h"
+#else
+#include <sys/resource.h>
+#endif
+
+#include "httpcommon.h"
+#include "httprequest.h"
+#include "httphandler.h"
+#include "httpresponse.h"
+#include "httpoptions.h"
+#include "httpheaders.h"
+#include "bufferarray.h"
+
+#include <curl/curl.h>
+
+#include "lltimer.h"
+
+
+// Drives HttpRequest with a fixed number of outstanding GETs against a
+// local server (see http_bench_server.py) and reports throughput,
+// latency percentiles and CPU per request.  Meant for comparing builds
+// before and after changes to the policy and transport layers, so it
+// keeps to the public API.
+
+void usage(std::ostream & out);
+U64 cpu_time();
+
+// Default command line settings
+static int request_count(5000);
+static int warmup_count(200);
+static int body_size(16384);
+static int concurrency_limit(8);
+static int outstanding(32);
+static int pipeline_depth(0);
+static int class_count(1);
+static bool multiplexing(false);
+static bool adaptive(false);
+static std::string url_base("http://127.0.0.1:8080/bench/");
+
+#if LL_WINDOWS
+
+int getopt(int argc, char * const argv[], const char *optstring);
+char *optarg(NULL);
+int optind(1);
+
+#endif
+
+
+class LoadGenerator : public LLCore::HttpHandler
+{
+public:
+    LoadGenerator(LLCore::HttpRequest * request, const std::vector<LLCore::HttpRequest::policy_t> & classes);
+
+    // Keeps the pipeline full.  Returns true once everything completed.
+    bool fill();
+
+    virtual void onCompleted(LLCore::HttpHandle handle, LLCore::HttpResponse * response);
+
+    void report(std::ostream & out, U64 wall_usecs, U64 cpu_usecs) const;
+
+public:
+    std::string                 mUrl;
+    int                         mToIssue;
+    int                         mWarmup;
+
+protected:
+    typedef std::map<LLCore::HttpHandle, U64> issued_map_t;
+
+    LLCore::HttpRequest *       mRequest;
+    std::vector<LLCore::HttpRequest::policy_t> mClasses;
+    LLCore::HttpOptions::ptr_t  mOptions;
+    LLCore::HttpHeaders::ptr_t  mHeaders;
+    LLCore::HttpHandler::ptr_t  mSelf;
+    issued_map_t                mIssued;
+    std::vector<U64>            mLatencies;
+    int                         mIssuedCount;
+    int                         mErrors;
+    U64                         mBytes;
+
+public:
+    U64                         mMeasureStart;
+    U64                         mMeasureCpuStart;
+};
+
+
+namespace
+{
+    void NoOpDeletor(LLCore::HttpHandler *)
+    { /*NoOp*/ }
+
+    bool parse_int(const char * arg, int low, int high, int & value)
+    {
+        char * end;
+        long parsed(strtol(arg, &end, 10));
+        if (parsed < low || parsed > high || *end != '\0')
+        {
+            return false;
+        }
+        value = int(parsed);
+        return true;
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    int option(-1);
+    while (-1 != (option = getopt(argc, argv, "u:n:W:s:c:H:p:P:mah?")))
+    {
+        bool ok(true);
+        switch (option)
+        {
+        case 'u':
+            url_base = optarg;
+            break;
+
+        case 'n':
+            ok = parse_int(optarg, 1, 10000000, request_count);
+            break;
+
+        case 'W':
+            ok = parse_int(optarg, 0, 1000000, warmup_count);
+            break;
+
+        case 's':
+            ok = parse_int(optarg, 0, 64 * 1024 * 1024, body_size);
+            break;
+
+        case 'c':
+            ok = parse_int(optarg, 1, 100, concurrency_limit);
+            break;
+
+        case 'H':
+            ok = parse_int(optarg, 1, 1000, outstanding);
+            break;
+
+        case 'p':
+            ok = parse_int(optarg, 0, 100, pipeline_depth);
+            break;
+
+        case 'P':
+            ok = parse_int(optarg, 1, 8, class_count);
+            break;
+
+        case 'm':
+            multiplexing = true;
+            break;
+
+        case 'a':
+            adaptive = true;
+            break;
+
+        case 'h':
+        case '?':
+            usage(std::cout);
+            return 0;
+        }
+        if (! ok)
+        {
+            usage(std::cerr);
+            return 1;
+        }
+    }
+
+    if (optind != argc)
+    {
+        usage(std::cerr);
+        return 1;
+    }
+
+    // Initialization
+    curl_global_init(CURL_GLOBAL_ALL);
+    LLCore::HttpRequest::createService();
+
+    std::vector<LLCore::HttpRequest::policy_t> classes;
+    classes.push_back(LLCore::HttpRequest::policy_t(LLCore::HttpRequest::DEFAULT_POLICY_ID));
+    while (classes.size() < size_t(class_count))
+    {
+        classes.push_back(LLCore::HttpRequest::createPolicyClass());
+    }
+    for (LLCore::HttpRequest::policy_t policy : classes)
+    {
+        LLCore::HttpRequest::setStaticPolicyOption(LLCore::HttpRequest::PO_CONNECTION_LIMIT,
+                                                   policy, concurrency_limit, NULL);
+        LLCore::HttpRequest::setStaticPolicyOption(LLCore::HttpRequest::PO_PER_HOST_CONNECTION_LIMIT,
+                                                   policy, concurrency_limit, NULL);
+        if (pipeline_depth)
+        {
+            LLCore::HttpRequest::setStaticPolicyOption(LLCore::HttpRequest::PO_PIPELINING_DEPTH,
+                                                       policy, pipeline_depth, NULL);
+        }
+        if (multiplexing)
+        {
+            LLCore::HttpRequest::setStaticPolicyOption(LLCore::HttpRequest::PO_MULTIPLEXING,
+                                                       policy, 1L, NULL);
+        }
+        if (adaptive)
+        {
+            LLCore::HttpRequest::setStaticPolicyOption(LLCore::HttpRequest::PO_ADAPTIVE_CONCURRENCY,
+                                                       policy, 1L, NULL);
+        }
+    }
+    LLCore::HttpRequest::startThread();
+
+    LLCore::HttpRequest * hr = new LLCore::HttpRequest();
+
+    LoadGenerator generator(hr, classes);
+    generator.mUrl = url_base + std::to_string(body_size);
+    generator.mWarmup = warmup_count;
+    generator.mToIssue = warmup_count + request_count;
+
+    while (! generator.fill())
+    {
+        hr->update(0);
+        ms_sleep(1);
+    }
+    U64 wall(totalTime() - generator.mMeasureStart);
+    U64 cpu(cpu_time() - generator.mMeasureCpuStart);
+
+    std::cout << "Requests: " << request_count << "  Body: " << body_size
+              << " bytes  Connections: " << concurrency_limit << "  Outstanding: " << outstanding
+              << "  Pipelining: " << pipeline_depth << "  Classes: " << class_count
+              << (multiplexing ? "  Multiplexed" : "") << (adaptive ? "  Adaptive" : "")
+              << std::endl;
+    generator.report(std::cout, wall, cpu);
+
+    // Clean up
+    hr->requestStopThread(LLCore::HttpHandler::ptr_t());
+    ms_sleep(1000);
+    delete hr;
+    LLCore::HttpRequest::destroyService();
+    curl_global_cleanup();
+
+    return 0;
+}
+
+
+void usage(std::ostream & out)
+{
+    out << "\n"
+        "usage:\thttp_load_bench [options]\n"
+        "\n"
+        "Keeps a fixed number of GETs outstanding against a local server until\n"
+        "the requested count completed, then prints requests per second,\n"
+        "latency percentiles and CPU time per request.  Start the server\n"
+        "with examples/http_bench_server.py; it answers <url>/<size> with a\n"
+        "body of that many bytes.\n"
+        "\n"
+        "Options:\n"
+        "\n"
+        " -u <url>              URL the body size is appended to\n"
+        "                       Default:  " << url_base << "\n"
+        " -n <count>            Requests measured.  Default:  " << request_count << "\n"
+        " -W <count>            Requests issued before measuring.  Default:  " << warmup_count << "\n"
+        " -s <bytes>            Response body size.  Default:  " << body_size << "\n"
+        " -c <limit>            Connection limit per policy class.  Range:  [1..100]\n"
+        "                       Default:  " << concurrency_limit << "\n"
+        " -H <count>            Requests kept outstanding.  Range:  [1..1000]\n"
+        "                       Default:  " << outstanding << "\n"
+        " -p <depth>            If <depth> is positive, enables and sets pipelining\n"
+        "                       depth.  Default:  " << pipeline_depth << "\n"
+        " -P <count>            Spread requests over this many policy classes.\n"
+        "                       Range:  [1..8]  Default:  " << class_count << "\n"
+        " -m                    Enable HTTP/2 multiplexing on the classes\n"
+        " -a                    Enable adaptive concurrency on the classes\n"
+        " -h                    print this help\n"
+        "\n"
+        << std::endl;
+}
+
+
+LoadGenerator::LoadGenerator(LLCore::HttpRequest * request, const std::vector<LLCore::HttpRequest::policy_t> & classes)
+    : LLCore::HttpHandler(),
+      mToIssue(0),
+      mWarmup(0),
+      mRequest(request),
+      mClasses(classes),
+      mOptions(new LLCore::HttpOptions),
+      mHeaders(new LLCore::HttpHeaders),
+      mSelf(this, NoOpDeletor),
+      mIssuedCount(0),
+      mErrors(0),
+      mBytes(0),
+      mMeasureStart(0),
+      mMeasureCpuStart(0)
+{
+    mOptions->setRetries(0);
+    mHeaders->append("Accept", "application/octet-stream");
+}
+
+
+bool LoadGenerator::fill()
+{
+    while (mIssuedCount < mToIssue && int(mIssued.size()) < outstanding)
+    {
+        LLCore::HttpRequest::policy_t policy(mClasses[mIssuedCount % mClasses.size()]);
+        LLCore::HttpHandle handle(mRequest->requestGet(policy, mUrl, mOptions, mHeaders, mSelf));
+        if (! handle)
+        {
+            // Fatal.  Couldn't queue up something.
+            std::cerr << "Failed to queue work to HTTP Service.  Reason:  "
+                      << mRequest->getStatus().toString() << std::endl;
+            exit(1);
+        }
+        if (mIssuedCount == mWarmup)
+        {
+            mMeasureStart = totalTime();
+            mMeasureCpuStart = cpu_time();
+        }
+        mIssued[handle] = (mIssuedCount >= mWarmup) ? U64(totalTime()) : U64(0);
+        ++mIssuedCount;
+    }
+
+    return mIssuedCount >= mToIssue && mIssued.empty();
+}
+
+
+void LoadGenerator::onCompleted(LLCore::HttpHandle handle, LLCore::HttpResponse * response)
+{
+    issued_map_t::iterator it(mIssued.find(handle));
+    if (mIssued.end() == it)
+    {
+        std::cerr << "Failed to find handle in request list.  Fatal." << std::endl;
+        exit(1);
+    }
+
+    if (it->second)
+    {
+        // Measured request
+        if (response->getStatus())
+        {
+            LLCore::BufferArray * body(response->getBody());
+            mBytes += body ? body->size() : 0;
+            mLatencies.push_back(totalTime() - it->second);
+        }
+        else
+        {
+            ++mErrors;
+        }
+    }
+    mIssued.erase(it);
+}
+
+
+void LoadGenerator::report(std::ostream & out, U64 wall_usecs, U64 cpu_usecs) const
+{
+    std::vector<U64> sorted(mLatencies);
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double p) -> double
+    {
+        if (sorted.empty())
+        {
+            return 0.0;
+        }
+        size_t index((std::min)(sorted.size() - 1, size_t(p * sorted.size())));
+        return sorted[index] / 1000.0;
+    };
+
+    const double seconds(wall_usecs / 1000000.0);
+    const size_t completed(sorted.size());
+    out << std::fixed << std::setprecision(2)
+        << "Completed: " << completed << "  Errors: " << mErrors
+        << "  Bytes: " << mBytes << "  Wall: " << seconds << " s" << std::endl
+        << "Requests/s: " << (seconds > 0.0 ? completed / seconds : 0.0)
+        << "  MB/s: " << (seconds > 0.0 ? mBytes / seconds / (1024.0 * 1024.0) : 0.0) << std::endl
+        << "Latency ms  p50: " << percentile(0.50) << "  p90: " << percentile(0.90)
+        << "  p99: " << percentile(0.99) << "  max: " << percentile(1.0) << std::endl
+        << "CPU per request: " << (completed ? double(cpu_usecs) / completed : 0.0) << " uS"
+        << std::endl;
+}
+
+
+// User plus system time of the whole process, both HTTP and
+// application threads, in microseconds.
+U64 cpu_time()
+{
+#if LL_WINDOWS
+    FILETIME ft_dummy, ft_system, ft_user;
+    GetProcessTimes(GetCurrentProcess(), &ft_dummy, &ft_dummy, &ft_system, &ft_user);
+    ULARGE_INTEGER system, user;
+    system.u.LowPart = ft_system.dwLowDateTime;
+    system.u.HighPart = ft_system.dwHighDateTime;
+    user.u.LowPart = ft_user.dwLowDateTime;
+    user.u.HighPart = ft_user.dwHighDateTime;
+    return (system.QuadPart + user.QuadPart) / U64L(10);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage))
+    {
+        return 0;
+    }
+    return U64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * U64L(1000000)
+        + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#endif
+}
+
+
+#if LL_WINDOWS
+
+// Very much a subset of posix functionality.  Don't push
+// it too hard...
+int getopt(int argc, char * const argv[], const char *optstring)
+{
+    static int pos(0);
+    while (optind < argc)
+    {
+        if (pos == 0)
+        {
+            if (argv[optind][0] != '-')
+                return -1;
+            pos = 1;
+        }
+        if (! argv[optind][pos])
+        {
+            ++optind;
+            pos = 0;
+            continue;
+        }
+        const char * thing(strchr(optstring, argv[optind][pos]));
+        if (! thing)
+        {
+            ++optind;
+            return -1;
+        }
+        if (thing[1] == ':')
+        {
+            optarg = argv[++optind];
+            ++optind;
+            pos = 0;
+        }
+        else
+        {
+            optarg = NULL;
+            ++pos;
+        }
+        return *thing;
+    }
+    return -1;
+}
+
+#endif
@@ -48,6 +48,7 @@ HttpOptions::HttpOptions() :
     mVerifyHost(false),
     mDNSCacheTimeout(-1L),
     mNoBody(false),
+    mStreamWeight(HTTP_STREAM_WEIGHT_DEFAULT),
     mLastModified(0) // <FS:Ansariel> GetIfModified request
 {}
 
@@ -120,6 +121,11 @@ void HttpOptions::setDNSCacheTimeout(int timeout)
     mDNSCacheTimeout = timeout;
 }
 
+void HttpOptions::setStreamWeight(int weight)
+{
+    mStreamWeight = llclamp(weight, HTTP_STREAM_WEIGHT_MIN, HTTP_STREAM_WEIGHT_MAX);
+}
+
 void HttpOptions::setHeadersOnly(bool nobody)
 {
     mNoBody = nobody;
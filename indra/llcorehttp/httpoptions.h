@@ -185,6 +185,15 @@ public:
     /// NoVerifySSLCert
     static void         setDefaultSSLVerifyPeer(bool verify);
 
+    /// Relative HTTP/2 stream weight, 1 to 256, for requests made
+    /// on a policy class with PO_MULTIPLEXING enabled.
+    /// Default: 16 (libcurl and HTTP/2 default)
+    void                setStreamWeight(int weight);
+    int                 getStreamWeight() const
+    {
+        return mStreamWeight;
+    }
+
     // <FS:Ansariel> GetIfModified request
     void                setLastModified(long last_modified);
     long                getLastModified() const
@@ -207,6 +216,7 @@ protected:
     bool                mVerifyHost;
     int                 mDNSCacheTimeout;
     bool                mNoBody;
+    int                 mStreamWeight;
 
     static bool         sDefaultVerifyPeer;
 
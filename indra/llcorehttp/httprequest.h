@@ -232,6 +232,31 @@ public:
         /// Global only
         PO_SSL_VERIFY_CALLBACK,
 
+        /// Long value that if non-zero asks for HTTP/2 on the
+        /// connections of this class and lets libcurl multiplex
+        /// requests over them.  New requests wait for a stream on
+        /// an existing connection rather than opening a new one,
+        /// up to PO_PER_HOST_CONNECTION_LIMIT connections per host.
+        /// Requests are given a stream weight from their
+        /// HttpOptions::setStreamWeight() value.  Servers that
+        /// only speak HTTP/1.1 are unaffected.
+        ///
+        /// Per-class only
+        PO_MULTIPLEXING,
+
+        // <FS> Adaptive concurrency
+        /// Long value that if non-zero lets the class adjust the
+        /// number of requests it keeps active from the throughput,
+        /// latency and throttling it sees, between one and this
+        /// value.  It starts from the limit the connection and
+        /// pipelining options give and backs off when servers
+        /// answer with 429 or 5xx statuses or time out.
+        /// Zero keeps the static limit.
+        ///
+        /// Per-class only
+        PO_ADAPTIVE_CONCURRENCY,
+        // </FS>
+
         PO_LAST  // Always at end
     };
 
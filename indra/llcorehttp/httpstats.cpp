@@ -45,6 +45,11 @@ void HTTPStats::resetStats()
     mDataDown.reset();
     mDataUp.reset();
     mRequests = 0;
+
+    // <FS> Adaptive concurrency
+    std::lock_guard<std::mutex> lock(mConcurrencyMutex);
+    mConcurrency.clear();
+    // </FS>
 }
 
 
@@ -61,6 +66,20 @@ void HTTPStats::recordResultCode(S32 code)
 
 }
 
+// <FS> Adaptive concurrency
+void HTTPStats::recordConcurrency(S32 policy_class, const ConcurrencyStats& stats)
+{
+    std::lock_guard<std::mutex> lock(mConcurrencyMutex);
+    mConcurrency[policy_class] = stats;
+}
+
+HTTPStats::concurrency_map_t HTTPStats::getConcurrencyStats() const
+{
+    std::lock_guard<std::mutex> lock(mConcurrencyMutex);
+    return mConcurrency;
+}
+// </FS>
+
 namespace
 {
     std::string byte_count_converter(F32 bytes)
@@ -101,6 +120,23 @@ void HTTPStats::dumpStats()
         out << (*it).first << " " << (*it).second << std::endl;
     }
 
+    // <FS> Adaptive concurrency
+    const concurrency_map_t concurrency(getConcurrencyStats());
+    if (!concurrency.empty())
+    {
+        out << std::endl;
+        out << "Adaptive Concurrency:" << std::endl << "Class Limit/Max Throughput Latency/Base Congested Up/Down" << std::endl;
+        for (const auto& [policy_class, stats] : concurrency)
+        {
+            out << policy_class << " " << stats.mLimit << "/" << stats.mCeiling
+                << " " << byte_count_converter(stats.mThroughput) << "/s"
+                << " " << stats.mLatency << "/" << stats.mLatencyBase << "ms"
+                << " " << (stats.mCongestionRate * 100.f) << "%"
+                << " " << stats.mIncreases << "/" << stats.mDecreases << std::endl;
+        }
+    }
+    // </FS>
+
     LL_WARNS("HTTPCore") << out.str() << LL_ENDL;
 }
 
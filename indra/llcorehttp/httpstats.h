@@ -33,6 +33,8 @@
 #include "llsingleton.h"
 #include "llsd.h"
 
+#include <mutex> // <FS/> Adaptive concurrency
+
 namespace LLCore
 {
     class HTTPStats final : public LLSimpleton<HTTPStats>
@@ -59,6 +61,28 @@ namespace LLCore
 
         void    recordResultCode(S32 code);
 
+        // <FS> Adaptive concurrency
+        // Adaptive concurrency state of a policy class at the end of its last window
+        struct ConcurrencyStats
+        {
+            S32     mLimit;
+            S32     mCeiling;
+            F32     mThroughput;        // bytes/s
+            F32     mLatency;           // mS
+            F32     mLatencyBase;       // mS
+            F32     mCongestionRate;    // throttled or timed out share of completions
+            U32     mIncreases;
+            U32     mDecreases;
+        };
+        typedef std::map<S32, ConcurrencyStats> concurrency_map_t;
+
+        // Threads:  Tcore
+        void    recordConcurrency(S32 policy_class, const ConcurrencyStats& stats);
+
+        // Threads:  T*
+        concurrency_map_t getConcurrencyStats() const;
+        // </FS>
+
         void    dumpStats();
     private:
         StatsAccumulator mDataDown;
@@ -67,6 +91,11 @@ namespace LLCore
         S32              mRequests;
 
         std::map<S32, S32> mResutCodes;
+
+        // <FS> Adaptive concurrency
+        mutable std::mutex  mConcurrencyMutex;
+        concurrency_map_t   mConcurrency;
+        // </FS>
     };
 
 
@@ -101,6 +101,10 @@ const std::string HTTP_IN_HEADER_RETRY_AFTER("retry-after");
 const std::string HTTP_IN_HEADER_SET_COOKIE("set-cookie");
 const std::string HTTP_IN_HEADER_USER_AGENT("user-agent");
 const std::string HTTP_IN_HEADER_X_FORWARDED_FOR("x-forwarded-for");
+// <FS> Conditional GET cache
+const std::string HTTP_IN_HEADER_ETAG("etag");
+const std::string HTTP_IN_HEADER_LAST_MODIFIED("last-modified");
+// </FS>
 
 const std::string HTTP_CONTENT_LLSD_XML("application/llsd+xml");
 const std::string HTTP_CONTENT_OCTET_STREAM("application/octet-stream");
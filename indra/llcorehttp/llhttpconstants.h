@@ -191,6 +191,10 @@ extern const std::string HTTP_IN_HEADER_RETRY_AFTER;
 extern const std::string HTTP_IN_HEADER_SET_COOKIE;
 extern const std::string HTTP_IN_HEADER_USER_AGENT;
 extern const std::string HTTP_IN_HEADER_X_FORWARDED_FOR;
+// <FS> Conditional GET cache
+extern const std::string HTTP_IN_HEADER_ETAG;
+extern const std::string HTTP_IN_HEADER_LAST_MODIFIED;
+// </FS>
 
 //// HTTP Content Types ////
 
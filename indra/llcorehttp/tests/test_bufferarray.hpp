@@ -374,6 +374,61 @@ void BufferArrayTestObjectType::test<8>()
     ba->release();
 }
 
+template <> template <>
+void BufferArrayTestObjectType::test<9>()
+{
+    set_test_name("BufferArray reserve and detachAlignedData");
+
+    char str1[] = "abcdefghij";
+    size_t str1_len(strlen(str1));
+    size_t len(0);
+
+    // Reserved and filled:  region handed over, array emptied
+    BufferArray * ba = new BufferArray();
+    ensure("Reserve on empty", ba->reserve(2 * str1_len));
+    ensure("Reserve only once", ! ba->reserve(str1_len));
+    ensure("Reserved isn't content", 0 == ba->size());
+    ba->append(str1, str1_len);
+    ba->write(str1_len, str1, str1_len);
+    char * data = static_cast<char *>(ba->detachAlignedData(&len));
+    ensure("Detached", NULL != data);
+    ensure("Detached length", 2 * str1_len == len);
+    ensure("Detached aligned", 0 == (reinterpret_cast<uintptr_t>(data) & 15));
+    ensure("Detached content", 0 == strncmp(data, str1, str1_len) && 0 == strncmp(data + str1_len, str1, str1_len));
+    ensure("Emptied", 0 == ba->size());
+    ll_aligned_free_16(data);
+    ba->release();
+
+    // Overflowing the reservation:  copied, content kept
+    ba = new BufferArray();
+    ba->reserve(str1_len);
+    ba->append(str1, str1_len);
+    ba->append(str1, str1_len);
+    data = static_cast<char *>(ba->detachAlignedData(&len));
+    ensure("Copied", NULL != data && 2 * str1_len == len);
+    ensure("Copied content", 0 == strncmp(data + str1_len, str1, str1_len));
+    ensure("Kept", 2 * str1_len == ba->size());
+    ll_aligned_free_16(data);
+
+    // Shared:  copied, content kept
+    ba->release();
+    ba = new BufferArray();
+    ba->reserve(str1_len);
+    ba->append(str1, str1_len);
+    ba->addRef();
+    data = static_cast<char *>(ba->detachAlignedData(&len));
+    ensure("Shared copied", NULL != data && str1_len == len);
+    ensure("Shared kept", str1_len == ba->size());
+    ll_aligned_free_16(data);
+    ba->release();
+    ba->release();
+
+    // Nothing to hand over
+    ba = new BufferArray();
+    ensure("Empty", NULL == ba->detachAlignedData(&len) && 0 == len);
+    ba->release();
+}
+
 }  // end namespace tut
 
 
@@ -0,0 +1,144 @@
+/**
+ * @file test_httpconcurrency.hpp
+ * @brief unit tests for the LLCore::HttpConcurrencyController class
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#ifndef TEST_LLCORE_HTTP_CONCURRENCY_H_
+#define TEST_LLCORE_HTTP_CONCURRENCY_H_
+
+#include "_httpconcurrency.h"
+#include "_httpinternal.h"
+
+
+using namespace LLCore;
+
+
+namespace tut
+{
+
+struct HttpConcurrencyTestData
+{
+    // Runs one window of completions of the given latency through the controller
+    static void window(HttpConcurrencyController & controller, HttpTime & now, int completions,
+                       HttpConcurrencyController::ECompletion kind, HttpTime latency, bool saturated)
+        {
+            for (int i(0); i < completions; ++i)
+            {
+                controller.noteCompletion(kind, latency, 1000);
+            }
+            if (saturated)
+            {
+                controller.noteSaturated();
+            }
+            now += HTTP_ADAPTIVE_WINDOW;
+            controller.update(now);
+        }
+};
+
+typedef test_group<HttpConcurrencyTestData> HttpConcurrencyTestGroupType;
+typedef HttpConcurrencyTestGroupType::object HttpConcurrencyTestObjectType;
+HttpConcurrencyTestGroupType HttpConcurrencyTestGroup("HttpConcurrencyController Tests");
+
+template <> template <>
+void HttpConcurrencyTestObjectType::test<1>()
+{
+    set_test_name("HttpConcurrencyController additive increase");
+
+    HttpConcurrencyController controller;
+    controller.configure(4, 8);
+    ensure_equals("Starts at the static limit", controller.getLimit(), 4);
+
+    HttpTime now(1000000);
+    controller.update(now);             // opens the first window
+
+    window(controller, now, 10, HttpConcurrencyController::COMPLETION_SUCCESS, 50000, false);
+    ensure_equals("Not raised when nothing waits", controller.getLimit(), 4);
+
+    for (int i(0); i < 10; ++i)
+    {
+        window(controller, now, 10, HttpConcurrencyController::COMPLETION_SUCCESS, 50000, true);
+    }
+    ensure_equals("Raised by one a window up to the ceiling", controller.getLimit(), 8);
+    ensure_equals("Increases counted", controller.getIncreases(), 4U);
+    ensure("Throughput measured", controller.getThroughput() > 9000.f && controller.getThroughput() < 11000.f);
+    ensure("Latency measured", controller.getLatency() > 49.f && controller.getLatency() < 51.f);
+}
+
+template <> template <>
+void HttpConcurrencyTestObjectType::test<2>()
+{
+    set_test_name("HttpConcurrencyController multiplicative decrease");
+
+    HttpConcurrencyController controller;
+    controller.configure(16, 32);
+
+    HttpTime now(1000000);
+    controller.update(now);
+
+    window(controller, now, 9, HttpConcurrencyController::COMPLETION_SUCCESS, 50000, true);
+    controller.noteCompletion(HttpConcurrencyController::COMPLETION_CONGESTED, 0, 0);
+    now += HTTP_ADAPTIVE_WINDOW;
+    controller.update(now);
+    ensure_equals("Halved on a throttle", controller.getLimit(), 8);
+    ensure("Congestion rate", controller.getCongestionRate() > 0.f);
+
+    for (int i(0); i < 10; ++i)
+    {
+        window(controller, now, 1, HttpConcurrencyController::COMPLETION_CONGESTED, 0, true);
+    }
+    ensure_equals("Never below one", controller.getLimit(), HTTP_ADAPTIVE_LIMIT_MIN);
+
+    window(controller, now, 1, HttpConcurrencyController::COMPLETION_FAILED, 0, true);
+    ensure_equals("Other failures aren't congestion", controller.getLimit(), HTTP_ADAPTIVE_LIMIT_MIN + 1);
+}
+
+template <> template <>
+void HttpConcurrencyTestObjectType::test<3>()
+{
+    set_test_name("HttpConcurrencyController latency and reconfiguration");
+
+    HttpConcurrencyController controller;
+    controller.configure(6, 12);
+
+    HttpTime now(1000000);
+    controller.update(now);
+
+    window(controller, now, 10, HttpConcurrencyController::COMPLETION_SUCCESS, 20000, true);
+    ensure_equals("Raised", controller.getLimit(), 7);
+
+    // Same throughput, five times the latency:  queuing at the server
+    window(controller, now, 10, HttpConcurrencyController::COMPLETION_SUCCESS, 100000, true);
+    ensure_equals("Lowered on latency", controller.getLimit(), 6);
+
+    controller.configure(6, 12);
+    ensure_equals("Same options keep the state", controller.getLimit(), 6);
+    ensure_equals("Decreases kept", controller.getDecreases(), 1U);
+
+    controller.configure(20, 12);
+    ensure_equals("Restarted, clamped to the ceiling", controller.getLimit(), 12);
+    ensure_equals("Counters restarted", controller.getDecreases(), 0U);
+}
+
+}  // end namespace tut
+
+#endif  // TEST_LLCORE_HTTP_CONCURRENCY_H_
@@ -49,6 +49,41 @@
   */
 static const std::string CACHE_FILENAME_PREFIX("sl_cache");
 
+/**
+ * The index of cache entries that is persisted between sessions. The name
+ * deliberately does not contain CACHE_FILENAME_PREFIX so a directory scan
+ * never mistakes it for a cached asset.
+ */
+static const std::string CACHE_INDEX_FILENAME("cache_index.dat");
+static const U32 CACHE_INDEX_MAGIC = 0x58444346; // "FCDX"
+static const U32 CACHE_INDEX_VERSION = 1;
+
+/**
+ * Even with a valid index we walk the directory once in a while to pick
+ * up files written by another viewer instance sharing the same cache.
+ */
+static const std::time_t CACHE_FULL_SCAN_INTERVAL = 7 * 24 * 60 * 60;
+
+/**
+ * Extract the asset id from a cache file path of the form
+ * <cache_dir>/sl_cache_<uuid>_0.asset
+ */
+static bool cache_filename_to_id(const std::string& file_path, LLUUID& id)
+{
+    std::string base_name = gDirUtilp->getBaseFileName(file_path, true);
+    if (base_name.size() < CACHE_FILENAME_PREFIX.size() + 1 + UUID_STR_LENGTH - 1)
+    {
+        return false;
+    }
+    std::string uuid_as_string = base_name.substr(CACHE_FILENAME_PREFIX.size() + 1, UUID_STR_LENGTH - 1);
+    if (!LLUUID::validate(uuid_as_string))
+    {
+        return false;
+    }
+    id.set(uuid_as_string);
+    return true;
+}
+
 std::string LLDiskCache::sCacheDir;
 
 // <FS:Ansariel> Optimize asset simple disk cache
@@ -67,6 +102,13 @@ LLDiskCache::LLDiskCache(const std::string& cache_dir,
 {
     sCacheDir = cache_dir;
     LLFile::mkdir(cache_dir);
+    mIndexFilename = cache_dir + gDirUtilp->getDirDelimiter() + CACHE_INDEX_FILENAME;
+    mPack.init(cache_dir);
+
+    if (!loadIndex() || std::time(nullptr) - mLastFullScanTime > CACHE_FULL_SCAN_INTERVAL)
+    {
+        rebuildIndex();
+    }
 
     // <FS:Ansariel> Optimize asset simple disk cache
     for (S32 i = 0; i < 16; i++)
@@ -82,6 +124,11 @@ LLDiskCache::LLDiskCache(const std::string& cache_dir,
     // </FS:Beq>
 }
 
+LLDiskCache::~LLDiskCache()
+{
+    saveIndex();
+}
+
 // WARNING: purge() is called by LLPurgeDiskCacheThread. As such it must
 // NOT touch any LLDiskCache data without introducing and locking a mutex!
 
@@ -123,43 +170,15 @@ void LLDiskCache::purge()
     typedef std::pair<std::time_t, std::pair<uintmax_t, std::string>> file_info_t;
     std::vector<file_info_t> file_info;
 
-#if LL_WINDOWS
-    std::wstring cache_path(utf8str_to_utf16str(sCacheDir));
-#else
-    std::string cache_path(sCacheDir);
-#endif
+    // Take a snapshot of the index so we don't hold the lock while deleting files
     uintmax_t file_size_total = 0; // <FS:Beq/> try to make simple cache less naive.
-    
-    if (boost::filesystem::is_directory(cache_path, ec) && !ec.failed())
     {
-        // <FS:Ansariel> Optimize asset simple disk cache
-        //boost::filesystem::directory_iterator iter(cache_path, ec);
-        //while (iter != boost::filesystem::directory_iterator() && !ec.failed())
-        boost::filesystem::recursive_directory_iterator iter(cache_path, ec);
-        while (iter != boost::filesystem::recursive_directory_iterator() && !ec.failed())
-        // </FS:Ansariel>
+        LLMutexLock lock(&mIndexMutex);
+        file_info.reserve(mIndex.size());
+        for (const auto& [id, entry] : mIndex)
         {
-            if (boost::filesystem::is_regular_file(*iter, ec) && !ec.failed())
-            {
-                if ((*iter).path().string().find(CACHE_FILENAME_PREFIX) != std::string::npos)
-                {
-                    uintmax_t file_size = boost::filesystem::file_size(*iter, ec);
-                    if (ec.failed())
-                    {
-                        continue;
-                    }
-                    const std::string file_path = (*iter).path().string();
-                    const std::time_t file_time = boost::filesystem::last_write_time(*iter, ec);
-                    if (ec.failed())
-                    {
-                        continue;
-                    }
-                    file_size_total += file_size; // <FS:Beq/> try to make simple cache less naive.
-
-                    file_info.push_back(file_info_t(file_time, { file_size, file_path }));
-                }
-            }
-            iter.increment(ec);
+            file_size_total += entry.mSize;
+            file_info.push_back(file_info_t(entry.mLastAccess, { entry.mSize, metaDataToFilepath(id, entry.mType) }));
         }
     }
 
@@ -245,11 +264,41 @@ void LLDiskCache::purge()
     // </FS>
         if (should_remove)
         {
-            boost::filesystem::remove(entry.second.second, ec);
+            // Hold the index while deleting so that the file and its entry
+            // go together, or not at all
+            const LLUUID id(uuid_as_string);
+            LLMutexLock lock(&mIndexMutex);
+            auto it = mIndex.find(id);
+            if (it != mIndex.end() && it->second.mLastAccess != entry.first)
+            {
+                // Somebody used the file since we took the snapshot, it is
+                // no longer among the oldest
+                deleted_size_total -= this_file_size;
+                del--;
+                keep++;
+                if (mEnableCacheDebugInfo)
+                {
+                    file_removed[entry.second.second] = purge_action::keep_file;
+                }
+                continue;
+            }
+
+            // ec may still hold the result of an earlier call, e.g. the
+            // skip list touch of an asset that lives in the pack
+            ec.clear();
+            if (!mPack.remove(id))
+            {
+                boost::filesystem::remove(entry.second.second, ec);
+            }
             if (ec.failed())
             {
                 LL_WARNS() << "Failed to delete cache file " << entry.second.second << ": " << ec.message() << LL_ENDL;
             }
+            else if (it != mIndex.end())
+            {
+                mStoredCacheSize -= llmin(mStoredCacheSize, it->second.mSize);
+                mIndex.erase(it);
+            }
         }
     }
 // <FS:Beq> update the debug logging to be more useful
@@ -317,7 +366,7 @@ void LLDiskCache::purge()
         // LL_INFOS() << "Total dir size after purge is " << dirFileSize(sCacheDir) << LL_ENDL;
         // LL_INFOS() << "Cache purge took " << execute_time << " ms to execute for " << file_info.size() << " files" << LL_ENDL;
 
-    auto newCacheSize = updateCacheSize(file_size_total - deleted_size_total); 
+    auto newCacheSize = dirFileSize(sCacheDir);
     LL_INFOS("LLDiskCache") << "Total dir size after purge is " << newCacheSize << LL_ENDL; 
     LL_INFOS("LLDiskCache") << "Cache purge took " << execute_time << " ms to execute for " << file_info.size() << " files" << LL_ENDL;
 // </FS:Beq>
@@ -380,6 +429,14 @@ void LLDiskCache::prepopulateCacheWithStatic()
                     {
                         LL_WARNS("LLDiskCache") << "Failed to copy " << from_asset_file << " to " << to_asset_file << LL_ENDL;
                     }
+                    else
+                    {
+                        llstat file_stat;
+                        if (LLFile::stat(to_asset_file, &file_stat) == 0)
+                        {
+                            recordWrite(uuid, LLAssetType::AT_UNKNOWN, file_stat.st_size);
+                        }
+                    }
                 }
                 if (std::find(mSkipList.begin(), mSkipList.end(), uuid_as_string) == mSkipList.end())
                 {
@@ -432,6 +489,16 @@ void LLDiskCache::clearCache()
             }
             iter.increment(ec);
         }
+
+        mPack.clear();
+
+        {
+            LLMutexLock lock(&mIndexMutex);
+            mIndex.clear();
+            mStoredCacheSize = 0;
+            mLastFullScanTime = std::time(nullptr);
+        }
+
         // <FS:Beq> add static assets into the new cache after clear
     LL_INFOS() << "prepopulating new cache " << LL_ENDL;
         prepopulateCacheWithStatic();
@@ -473,48 +540,39 @@ void LLDiskCache::removeOldVFSFiles()
     }
 }
 
-// <FS:Beq> Lets not scan every single time if we can avoid it eh?
-// uintmax_t LLDiskCache::dirFileSize(const std::string& dir)
-// {
-uintmax_t LLDiskCache::updateCacheSize(const uintmax_t newsize)
+uintmax_t LLDiskCache::dirFileSize(const std::string& dir, bool force)
 {
-    mStoredCacheSize = newsize;
-    mLastScanTime = system_clock::now();
+    // The index is kept up to date by LLFileSystem so there is no need to
+    // walk the directory unless explicitly asked to.
+    if (force)
+    {
+        rebuildIndex();
+    }
+
+    LLMutexLock lock(&mIndexMutex);
     return mStoredCacheSize;
 }
 
-uintmax_t LLDiskCache::dirFileSize(const std::string& dir, bool force)
+void LLDiskCache::rebuildIndex()
 {
-    using namespace std::chrono;
-    const seconds cache_duration{ 120 };// A rather arbitrary number. it takes 5 seconds+ on a fast drive to scan 80K+ items. purge runs every minute and will update. so 120 should mean we never need a superfluous cache scan.
-
-    const auto current_time = system_clock::now();
-
-    const auto time_difference = duration_cast<seconds>(current_time - mLastScanTime);
+    LL_PROFILE_ZONE_SCOPED;
+    auto start_time = std::chrono::high_resolution_clock::now();
 
-    // Check if the cached result can be used
-    if( !force && time_difference < cache_duration )
-    {
-        LL_DEBUGS("LLDiskCache") << "Using cached result: " << mStoredCacheSize << LL_ENDL;
-        return mStoredCacheSize;
-    }
-// </FS:Beq>
+    index_map_t index;
     uintmax_t total_file_size = 0;
 
     /**
      * There may be a better way that works directly on the folder (similar to
      * right clicking on a folder in the OS and asking for size vs right clicking
      * on all files and adding up manually) but this is very fast - less than 100ms
-     * for 10,000 files in my testing so, so long as it's not called frequently,
-     * it should be okay. Note that's it's only currently used for logging/debugging
-     * so if performance is ever an issue, optimizing this or removing it altogether,
-     * is an easy win.
+     * for 10,000 files in my testing. Since the index is persisted, this only
+     * runs after a crash, a cache clear or once in a while to catch stragglers.
      */
     boost::system::error_code ec;
 #if LL_WINDOWS
-    std::wstring dir_path(utf8str_to_utf16str(dir));
+    std::wstring dir_path(utf8str_to_utf16str(sCacheDir));
 #else
-    std::string dir_path(dir);
+    std::string dir_path(sCacheDir);
 #endif
     if (boost::filesystem::is_directory(dir_path, ec) && !ec.failed())
     {
@@ -527,12 +585,20 @@ uintmax_t LLDiskCache::dirFileSize(const std::string& dir, bool force)
         {
             if (boost::filesystem::is_regular_file(*iter, ec) && !ec.failed())
             {
-                if ((*iter).path().string().find(CACHE_FILENAME_PREFIX) != std::string::npos)
+                const std::string file_path = (*iter).path().string();
+                LLUUID id;
+                if (file_path.find(CACHE_FILENAME_PREFIX) != std::string::npos && cache_filename_to_id(file_path, id))
                 {
                     uintmax_t file_size = boost::filesystem::file_size(*iter, ec);
                     if (!ec.failed())
                     {
-                        total_file_size += file_size;
+                        const std::time_t file_time = boost::filesystem::last_write_time(*iter, ec);
+                        if (!ec.failed())
+                        {
+                            // The file name does not encode the asset type; it gets filled in on next access
+                            index[id] = { file_size, file_time, LLAssetType::AT_UNKNOWN };
+                            total_file_size += file_size;
+                        }
                     }
                 }
             }
@@ -540,10 +606,191 @@ uintmax_t LLDiskCache::dirFileSize(const std::string& dir, bool force)
         }
     }
 
-// <FS:Beq> Lets not scan every single time if we can avoid it eh?
-    // return total_file_size;
-    return updateCacheSize(total_file_size);
-// </FS:Beq>
+    std::vector<LLDiskCachePack::EntryInfo> packed_entries;
+    mPack.getEntries(packed_entries);
+    for (const LLDiskCachePack::EntryInfo& packed : packed_entries)
+    {
+        // The packed copy shadows any loose file left behind for the same asset
+        IndexEntry& entry = index[packed.mID];
+        total_file_size -= llmin(total_file_size, entry.mSize);
+        entry = { (uintmax_t)packed.mSize, packed.mLastWrite, packed.mType };
+        total_file_size += packed.mSize;
+    }
+
+    size_t num_entries = index.size();
+    {
+        LLMutexLock lock(&mIndexMutex);
+        mIndex.swap(index);
+        mStoredCacheSize = total_file_size;
+        mLastFullScanTime = std::time(nullptr);
+    }
+
+    auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+    LL_INFOS("LLDiskCache") << "Rebuilt cache index with " << num_entries << " entries (" << total_file_size << " bytes) in " << execute_time << " ms" << LL_ENDL;
+}
+
+bool LLDiskCache::loadIndex()
+{
+    LLFILE* file = LLFile::fopen(mIndexFilename, "rb");
+    if (!file)
+    {
+        LL_INFOS("LLDiskCache") << "No cache index found, a full scan is required" << LL_ENDL;
+        return false;
+    }
+
+    bool success = false;
+    U32 magic = 0;
+    U32 version = 0;
+    U64 count = 0;
+    S64 last_scan = 0;
+    if (fread(&magic, sizeof(magic), 1, file) == 1 && magic == CACHE_INDEX_MAGIC &&
+        fread(&version, sizeof(version), 1, file) == 1 && version == CACHE_INDEX_VERSION &&
+        fread(&last_scan, sizeof(last_scan), 1, file) == 1 &&
+        fread(&count, sizeof(count), 1, file) == 1)
+    {
+        index_map_t index;
+        index.reserve((size_t)count);
+        uintmax_t total_file_size = 0;
+        U64 i = 0;
+        for (; i < count; ++i)
+        {
+            LLUUID id;
+            S32 type;
+            U64 size;
+            S64 last_access;
+            if (fread(id.mData, UUID_BYTES, 1, file) != 1 ||
+                fread(&type, sizeof(type), 1, file) != 1 ||
+                fread(&size, sizeof(size), 1, file) != 1 ||
+                fread(&last_access, sizeof(last_access), 1, file) != 1)
+            {
+                break;
+            }
+            index[id] = { (uintmax_t)size, (std::time_t)last_access, (LLAssetType::EType)type };
+            total_file_size += size;
+        }
+
+        if (i == count)
+        {
+            LLMutexLock lock(&mIndexMutex);
+            mIndex.swap(index);
+            mStoredCacheSize = total_file_size;
+            mLastFullScanTime = (std::time_t)last_scan;
+            success = true;
+        }
+    }
+    fclose(file);
+
+    // Remove the index now; it is written again on a clean shutdown. If the
+    // viewer crashes there is no index and the next session rescans.
+    LLFile::remove(mIndexFilename);
+
+    if (success)
+    {
+        LL_INFOS("LLDiskCache") << "Loaded cache index with " << count << " entries" << LL_ENDL;
+    }
+    else
+    {
+        LL_WARNS("LLDiskCache") << "Cache index " << mIndexFilename << " is invalid, a full scan is required" << LL_ENDL;
+    }
+    return success;
+}
+
+void LLDiskCache::saveIndex()
+{
+    LLMutexLock lock(&mIndexMutex);
+
+    LLFILE* file = LLFile::fopen(mIndexFilename, "wb");
+    if (!file)
+    {
+        LL_WARNS("LLDiskCache") << "Unable to write cache index " << mIndexFilename << LL_ENDL;
+        return;
+    }
+
+    bool success = true;
+    const U32 magic = CACHE_INDEX_MAGIC;
+    const U32 version = CACHE_INDEX_VERSION;
+    const S64 last_scan = (S64)mLastFullScanTime;
+    const U64 count = (U64)mIndex.size();
+    success &= fwrite(&magic, sizeof(magic), 1, file) == 1;
+    success &= fwrite(&version, sizeof(version), 1, file) == 1;
+    success &= fwrite(&last_scan, sizeof(last_scan), 1, file) == 1;
+    success &= fwrite(&count, sizeof(count), 1, file) == 1;
+    for (const auto& [id, entry] : mIndex)
+    {
+        if (!success)
+        {
+            break;
+        }
+        const S32 type = (S32)entry.mType;
+        const U64 size = (U64)entry.mSize;
+        const S64 last_access = (S64)entry.mLastAccess;
+        success &= fwrite(id.mData, UUID_BYTES, 1, file) == 1;
+        success &= fwrite(&type, sizeof(type), 1, file) == 1;
+        success &= fwrite(&size, sizeof(size), 1, file) == 1;
+        success &= fwrite(&last_access, sizeof(last_access), 1, file) == 1;
+    }
+    fclose(file);
+
+    if (!success)
+    {
+        LL_WARNS("LLDiskCache") << "Failed to write cache index " << mIndexFilename << LL_ENDL;
+        LLFile::remove(mIndexFilename);
+    }
+}
+
+bool LLDiskCache::recordAccess(const LLUUID& id)
+{
+    LLMutexLock lock(&mIndexMutex);
+    auto it = mIndex.find(id);
+    if (it == mIndex.end())
+    {
+        return false;
+    }
+    it->second.mLastAccess = std::time(nullptr);
+    return true;
+}
+
+void LLDiskCache::recordWrite(const LLUUID& id, LLAssetType::EType at, uintmax_t size)
+{
+    LLMutexLock lock(&mIndexMutex);
+    IndexEntry& entry = mIndex[id];
+    mStoredCacheSize -= llmin(mStoredCacheSize, entry.mSize);
+    entry.mSize = size;
+    entry.mLastAccess = std::time(nullptr);
+    entry.mType = at;
+    mStoredCacheSize += size;
+}
+
+void LLDiskCache::recordRename(const LLUUID& old_id, const LLUUID& new_id, LLAssetType::EType new_type)
+{
+    LLMutexLock lock(&mIndexMutex);
+    auto it = mIndex.find(old_id);
+    if (it == mIndex.end())
+    {
+        return;
+    }
+    IndexEntry entry = it->second;
+    mIndex.erase(it);
+
+    entry.mType = new_type;
+    auto [new_it, inserted] = mIndex.emplace(new_id, entry);
+    if (!inserted)
+    {
+        // The rename replaced an existing file
+        mStoredCacheSize -= llmin(mStoredCacheSize, new_it->second.mSize);
+        new_it->second = entry;
+    }
+}
+
+void LLDiskCache::recordRemove(const LLUUID& id)
+{
+    LLMutexLock lock(&mIndexMutex);
+    auto it = mIndex.find(id);
+    if (it != mIndex.end())
+    {
+        mStoredCacheSize -= llmin(mStoredCacheSize, it->second.mSize);
+        mIndex.erase(it);
+    }
 }
 
 LLPurgeDiskCacheThread::LLPurgeDiskCacheThread() :
@@ -558,5 +805,8 @@ void LLPurgeDiskCacheThread::run()
     while (LLApp::instance()->sleep(CHECK_INTERVAL))
     {
         LLDiskCache::instance().purge();
+
+        // Reclaim the space used by removed or replaced small assets
+        LLDiskCache::instance().getPack().compact();
     }
 }
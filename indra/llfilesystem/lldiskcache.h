@@ -25,9 +25,17 @@
  * 2/ The time of last access for a file can be updated instantly
  *    for file reads and automatically as part of the file writes.
  * 3/ The purge algorithm collects a list of all files in the
- *    directory, sorts them by date of last access (write) and then
+ *    cache, sorts them by date of last access (write) and then
  *    deletes any files based on age until the total size of all
  *    the files is less than the maximum size specified.
+ *    The list of files comes from an in-memory index that LLFileSystem
+ *    keeps up to date on every read, write, rename and remove. The
+ *    index is saved next to the cache files on a clean shutdown so the
+ *    next session does not need to walk the whole directory tree; after
+ *    a crash (no index file) or once a week a full scan rebuilds it.
+ * 6/ Assets smaller than the pack threshold are not stored as individual
+ *    files but appended to a few large segment files (see LLDiskCachePack)
+ *    to save the cost of a file create/open/close and an inode each.
  * 4/ An LLSingleton idiom is used since there will only ever be
  *    a single cache and we want to access it from numerous places.
  * 5/ Performance on my modest system seems very acceptable. For
@@ -63,7 +71,13 @@
 #define _LLDISKCACHE
 
 #include "llsingleton.h"
+#include "lldiskcachepack.h"
+#include "llassettype.h"
+#include "llmutex.h"
+#include "lluuid.h"
+#include <atomic>
 #include <chrono>
+#include <unordered_map>
 using namespace std::chrono;
 
 
@@ -108,7 +122,7 @@ class LLDiskCache :
                     // </FS:Beq>
                     );
 
-        virtual ~LLDiskCache() = default;
+        virtual ~LLDiskCache();
 
     public:
         /**
@@ -152,6 +166,36 @@ class LLDiskCache :
 
         void removeOldVFSFiles();
 
+        /**
+         * Keep the index of cache entries up to date. These are called by
+         * LLFileSystem whenever a cache file is read, written, renamed or
+         * removed so that purge() and dirFileSize() never have to walk the
+         * cache directory. They are safe to call from any thread.
+         * recordAccess() returns false if the entry is not in the index.
+         */
+        bool recordAccess(const LLUUID& id);
+        void recordWrite(const LLUUID& id, LLAssetType::EType at, uintmax_t size);
+        void recordRename(const LLUUID& old_id, const LLUUID& new_id, LLAssetType::EType new_type);
+        void recordRemove(const LLUUID& id);
+
+        /**
+         * The segment store used for small assets. Assets of at most
+         * getPackThreshold() bytes written in one go are put in there.
+         * A threshold of 0 disables the store for new writes.
+         */
+        LLDiskCachePack& getPack() { return mPack; }
+        U32 getPackThreshold() const { return mPackThreshold; }
+        void setPackThreshold(U32 threshold) { mPackThreshold = threshold; }
+
+        /**
+         * When enabled, new writes of mesh and animation assets are stored
+         * as zlib compressed chunks (see LLDiskCacheCompressed). Compressed
+         * files are read back transparently whether or not this is enabled.
+         */
+        bool getCompressAssets() const { return mCompressAssets; }
+        void setCompressAssets(bool compress) { mCompressAssets = compress; }
+        static bool isCompressibleType(LLAssetType::EType at) { return at == LLAssetType::AT_MESH || at == LLAssetType::AT_ANIMATION; }
+
         // <FS:Ansariel> Better asset cache size control
         void setMaxSizeBytes(uintmax_t size) { mMaxSizeBytes = size; }
         // <FS:Beq> High/Low water control
@@ -165,15 +209,42 @@ class LLDiskCache :
          * directory. Primarily used here to determine the directory size
          * before and after the cache purge
          */
-        uintmax_t updateCacheSize(const uintmax_t newsize); // <FS:Beq/> enable time based caching of dirfilesize except when force is true.
-        uintmax_t dirFileSize(const std::string& dir, bool force = false); // <FS:Beq/> enable time based caching of dirfilesize except when force is true.
+        uintmax_t dirFileSize(const std::string& dir, bool force = false); // Returns the indexed size; force rescans the directory
 
         /**
-         * cache the directory size cos it takes forever to calculate it
-         * 
+         * Walk the cache directory and rebuild the index from scratch.
+         * Only needed when there is no usable index file.
          */
+        void rebuildIndex();
+
+        /**
+         * Read/write the index file. loadIndex() deletes the file once it has
+         * been read so that a crash leaves no stale index behind.
+         */
+        bool loadIndex();
+        void saveIndex();
+
+        struct IndexEntry
+        {
+            uintmax_t           mSize;
+            std::time_t         mLastAccess;
+            LLAssetType::EType  mType;
+        };
+        typedef std::unordered_map<LLUUID, IndexEntry> index_map_t;
+
+        /**
+         * All the cache entries we know about and the sum of their sizes.
+         * Both are protected by mIndexMutex.
+         */
+        index_map_t mIndex;
         uintmax_t mStoredCacheSize{ 0 };
-        time_point<system_clock> mLastScanTime{ };
+        std::time_t mLastFullScanTime{ 0 };
+        LLMutex mIndexMutex;
+        std::string mIndexFilename;
+
+        LLDiskCachePack mPack;
+        std::atomic<U32> mPackThreshold{ 16 * 1024 };
+        std::atomic<bool> mCompressAssets{ false };
 
     private:
         /**
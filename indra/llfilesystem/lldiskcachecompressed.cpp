@@ -0,0 +1,247 @@
+/**
+ * @file lldiskcachecompressed.cpp
+ * @brief Chunked zlib storage for compressed disk cache assets.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lldiskcachecompressed.h"
+
+#include "llfile.h"
+
+#ifdef LL_USESYSTEMLIBS
+# include <zlib.h>
+#else
+# include "zlib-ng/zlib.h"
+#endif
+
+// Compressed assets start with this magic. Only mesh and animation assets
+// are compressed and neither of those formats can start with these bytes,
+// so it tells them apart from regular asset files.
+static const U32 COMPRESSED_MAGIC = 0x3243434c; // "LCC2"
+static const S32 CHUNK_MAX_SIZE = 64 * 1024;
+
+struct chunk_header_t
+{
+    S32 mOffset;            // Position of the chunk data in the asset
+    S32 mSize;              // Uncompressed size
+    U32 mCompressedSize;
+};
+
+namespace
+{
+    struct Chunk
+    {
+        chunk_header_t  mHeader;
+        long            mFilePos;   // Start of the zlib stream in the file
+    };
+
+    // Open a compressed asset file and list its chunks. Returns nullptr if
+    // the file is missing or not compressed. A truncated last chunk (e.g.
+    // the viewer crashed in the middle of a write) is ignored.
+    LLFILE* open_chunks(const std::string& filename, const char* mode, std::vector<Chunk>& chunks, S32& size)
+    {
+        LLFILE* file = LLFile::fopen(filename, mode);
+        if (!file)
+        {
+            return nullptr;
+        }
+
+        U32 magic = 0;
+        if (fread(&magic, sizeof(magic), 1, file) != 1 || magic != COMPRESSED_MAGIC)
+        {
+            fclose(file);
+            return nullptr;
+        }
+
+        size = 0;
+        long end = 0;
+        if (fseek(file, 0, SEEK_END) == 0)
+        {
+            end = ftell(file);
+        }
+        long pos = sizeof(magic);
+        Chunk chunk;
+        while (fseek(file, pos, SEEK_SET) == 0 &&
+               fread(&chunk.mHeader, sizeof(chunk_header_t), 1, file) == 1)
+        {
+            chunk.mFilePos = pos + sizeof(chunk_header_t);
+            pos = chunk.mFilePos + chunk.mHeader.mCompressedSize;
+            if (pos > end || chunk.mHeader.mOffset < 0 || chunk.mHeader.mSize < 0)
+            {
+                break;
+            }
+            chunks.push_back(chunk);
+            size = llmax(size, chunk.mHeader.mOffset + chunk.mHeader.mSize);
+        }
+        return file;
+    }
+}
+
+// static
+bool LLDiskCacheCompressed::isCompressed(const std::string& filename)
+{
+    LLFILE* file = LLFile::fopen(filename, "rb");
+    if (!file)
+    {
+        return false;
+    }
+
+    U32 magic = 0;
+    bool compressed = fread(&magic, sizeof(magic), 1, file) == 1 && magic == COMPRESSED_MAGIC;
+    fclose(file);
+    return compressed;
+}
+
+// static
+S32 LLDiskCacheCompressed::getSize(const std::string& filename)
+{
+    std::vector<Chunk> chunks;
+    S32 size = 0;
+    LLFILE* file = open_chunks(filename, "rb", chunks, size);
+    if (!file)
+    {
+        return -1;
+    }
+    fclose(file);
+    return size;
+}
+
+// static
+S32 LLDiskCacheCompressed::read(const std::string& filename, S32 offset, U8* buffer, S32 bytes)
+{
+    std::vector<Chunk> chunks;
+    S32 size = 0;
+    LLFILE* file = open_chunks(filename, "rb", chunks, size);
+    if (!file)
+    {
+        return -1;
+    }
+
+    const S32 to_read = offset >= 0 ? llclamp(size - offset, 0, bytes) : 0;
+    const S32 end = offset + to_read;
+    if (to_read > 0)
+    {
+        memset(buffer, 0, to_read);
+    }
+
+    // Apply the chunks oldest first so that newer data overwrites older
+    std::vector<U8> compressed;
+    std::vector<U8> data;
+    for (const Chunk& chunk : chunks)
+    {
+        const chunk_header_t& header = chunk.mHeader;
+        const S32 first = llmax(offset, header.mOffset);
+        const S32 last = llmin(end, header.mOffset + header.mSize);
+        if (first >= last)
+        {
+            continue;
+        }
+
+        compressed.resize(header.mCompressedSize);
+        data.resize(header.mSize);
+        uLongf data_size = header.mSize;
+        if (fseek(file, chunk.mFilePos, SEEK_SET) != 0 ||
+            fread(compressed.data(), 1, compressed.size(), file) != compressed.size() ||
+            uncompress(data.data(), &data_size, compressed.data(), (uLong)compressed.size()) != Z_OK ||
+            data_size != (uLongf)header.mSize)
+        {
+            LL_WARNS() << "Corrupt compressed cache file " << filename << LL_ENDL;
+            fclose(file);
+            return 0;
+        }
+        memcpy(buffer + (first - offset), data.data() + (first - header.mOffset), last - first);
+    }
+    fclose(file);
+    return to_read;
+}
+
+// static
+bool LLDiskCacheCompressed::write(const std::string& filename, S32 offset, const U8* buffer, S32 bytes, bool truncate, uintmax_t& disk_size)
+{
+    if (offset < 0 || bytes < 0 || (bytes > 0 && !buffer))
+    {
+        return false;
+    }
+
+    LLFILE* file = nullptr;
+    if (!truncate)
+    {
+        std::vector<Chunk> chunks;
+        S32 size = 0;
+        file = open_chunks(filename, "r+b", chunks, size);
+        if (file)
+        {
+            // Drop a damaged tail instead of appending after it
+            long pos = sizeof(U32);
+            if (!chunks.empty())
+            {
+                pos = chunks.back().mFilePos + chunks.back().mHeader.mCompressedSize;
+            }
+            if (fseek(file, pos, SEEK_SET) != 0)
+            {
+                fclose(file);
+                return false;
+            }
+        }
+    }
+    if (!file)
+    {
+        file = LLFile::fopen(filename, "wb");
+        if (!file)
+        {
+            return false;
+        }
+        if (fwrite(&COMPRESSED_MAGIC, sizeof(COMPRESSED_MAGIC), 1, file) != 1)
+        {
+            fclose(file);
+            return false;
+        }
+    }
+
+    std::vector<U8> out;
+    bool success = true;
+    S32 written = 0;
+    do
+    {
+        const S32 chunk_size = llmin(bytes - written, CHUNK_MAX_SIZE);
+        uLongf compressed_size = compressBound(chunk_size);
+        out.resize(sizeof(chunk_header_t) + compressed_size);
+        success = compress2(out.data() + sizeof(chunk_header_t), &compressed_size, bytes > 0 ? buffer + written : nullptr, chunk_size, Z_DEFAULT_COMPRESSION) == Z_OK;
+        if (success)
+        {
+            chunk_header_t header = { offset + written, chunk_size, (U32)compressed_size };
+            memcpy(out.data(), &header, sizeof(header));
+            out.resize(sizeof(chunk_header_t) + compressed_size);
+            success = fwrite(out.data(), 1, out.size(), file) == out.size();
+        }
+        written += chunk_size;
+    }
+    while (success && written < bytes);
+
+    const long file_end = ftell(file);
+    fclose(file);
+    disk_size = file_end > 0 ? (uintmax_t)file_end : 0;
+    return success;
+}
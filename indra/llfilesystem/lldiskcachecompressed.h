@@ -0,0 +1,77 @@
+/**
+ * @file lldiskcachecompressed.h
+ * @brief Chunked zlib storage for compressed disk cache assets.
+ *
+ * @Description:
+ * Mesh and animation assets can be stored compressed in the disk cache.
+ * The mesh repository writes its assets block by block (header first,
+ * then each LOD as it arrives) and reads them back the same way, so a
+ * single zlib stream would have to be inflated whole for every block.
+ *
+ * A compressed file is instead a small file header followed by a list of
+ * independently compressed chunks:
+ * 1/ Each chunk is a header (offset and size of the data in the asset,
+ *    compressed size) followed by the zlib stream. No chunk holds more
+ *    than CHUNK_MAX_SIZE bytes of asset data.
+ * 2/ A write only appends new chunks to the end of the file; chunks
+ *    written later win where they overlap older ones.
+ * 3/ A read scans the chunk headers and only inflates the chunks that
+ *    overlap the requested range. Bytes no chunk covers read as zeros,
+ *    like the hole left by seeking past the end of a regular file.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLDISKCACHECOMPRESSED_H
+#define LL_LLDISKCACHECOMPRESSED_H
+
+class LLDiskCacheCompressed
+{
+    public:
+        /**
+         * True if filename exists and is a compressed asset file.
+         */
+        static bool isCompressed(const std::string& filename);
+
+        /**
+         * Uncompressed size of the asset, or -1 if filename is not a
+         * compressed asset file.
+         */
+        static S32 getSize(const std::string& filename);
+
+        /**
+         * Read up to bytes bytes of the asset starting at offset. Returns
+         * the number of bytes read or -1 if filename is not a compressed
+         * asset file.
+         */
+        static S32 read(const std::string& filename, S32 offset, U8* buffer, S32 bytes);
+
+        /**
+         * Store bytes bytes of asset data at offset. With truncate (or when
+         * the file doesn't exist yet) the file is started over, otherwise
+         * the data is added to the existing compressed file. disk_size is
+         * set to the size of the file afterwards.
+         */
+        static bool write(const std::string& filename, S32 offset, const U8* buffer, S32 bytes, bool truncate, uintmax_t& disk_size);
+};
+
+#endif // LL_LLDISKCACHECOMPRESSED_H
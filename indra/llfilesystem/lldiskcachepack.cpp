@@ -0,0 +1,559 @@
+/**
+ * @file lldiskcachepack.cpp
+ * @brief Append-only segment store for small disk cache assets.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lldiskcachepack.h"
+
+#include "lldir.h"
+#include <boost/filesystem.hpp>
+
+/**
+ * Segment files are named pack_<id>.seg. They deliberately don't use the
+ * "sl_cache" prefix of loose cache files so that the directory scans in
+ * LLDiskCache never treat them as assets.
+ */
+static const std::string SEGMENT_PREFIX("pack_");
+static const std::string SEGMENT_EXTENSION(".seg");
+
+static const U32 RECORD_MAGIC = 0x4b435253; // "SRCK"
+static const U32 SEGMENT_DEFAULT_MAX_SIZE = 64 * 1024 * 1024;
+
+/**
+ * A segment whose live records use less than this fraction of the file
+ * gets compacted.
+ */
+static const F32 COMPACT_LIVE_RATIO = 0.5f;
+
+struct record_header_t
+{
+    U32 mMagic;
+    U8  mID[UUID_BYTES];
+    S32 mType;
+    S32 mSize;  // < 0 for a tombstone
+};
+static const U32 RECORD_HEADER_SIZE = sizeof(record_header_t);
+
+LLDiskCachePack::LLDiskCachePack()
+:   mSegmentMaxSize(SEGMENT_DEFAULT_MAX_SIZE)
+{
+}
+
+LLDiskCachePack::~LLDiskCachePack()
+{
+    close();
+}
+
+std::string LLDiskCachePack::getSegmentFilename(U32 segment_id) const
+{
+    return llformat("%s%s%s%04u%s", mDir.c_str(), gDirUtilp->getDirDelimiter().c_str(),
+                    SEGMENT_PREFIX.c_str(), segment_id, SEGMENT_EXTENSION.c_str());
+}
+
+void LLDiskCachePack::init(const std::string& dir)
+{
+    close();
+
+    LLMutexLock lock(&mMutex);
+    mDir = dir;
+
+    // Find the existing segments; the map keeps them ordered oldest first
+    boost::system::error_code ec;
+#if LL_WINDOWS
+    std::wstring dir_path(utf8str_to_utf16str(dir));
+#else
+    std::string dir_path(dir);
+#endif
+    if (boost::filesystem::is_directory(dir_path, ec) && !ec.failed())
+    {
+        boost::filesystem::directory_iterator iter(dir_path, ec);
+        while (iter != boost::filesystem::directory_iterator() && !ec.failed())
+        {
+            const std::string file_name = (*iter).path().filename().string();
+            if (file_name.compare(0, SEGMENT_PREFIX.size(), SEGMENT_PREFIX) == 0 &&
+                file_name.size() > SEGMENT_PREFIX.size() + SEGMENT_EXTENSION.size() &&
+                file_name.compare(file_name.size() - SEGMENT_EXTENSION.size(), SEGMENT_EXTENSION.size(), SEGMENT_EXTENSION) == 0)
+            {
+                U32 segment_id = 0;
+                if (sscanf(file_name.c_str() + SEGMENT_PREFIX.size(), "%u", &segment_id) == 1)
+                {
+                    mSegments[segment_id] = Segment();
+                }
+            }
+            iter.increment(ec);
+        }
+    }
+
+    // Replay all the records in order so that newer ones replace older ones
+    bool tail_is_valid = true;
+    for (auto& [segment_id, segment] : mSegments)
+    {
+        tail_is_valid = scanSegment(segment_id, segment);
+    }
+
+    // Never append after a damaged tail (e.g. the viewer crashed in the
+    // middle of a write), start a new segment instead
+    if (!mSegments.empty())
+    {
+        mActiveSegment = mSegments.rbegin()->first;
+        if (!tail_is_valid || mSegments.rbegin()->second.mSize >= mSegmentMaxSize)
+        {
+            mActiveSegment++;
+        }
+    }
+    mHasActiveSegment = false;
+
+    LL_INFOS("LLDiskCache") << "Loaded " << mRecords.size() << " packed assets from " << mSegments.size() << " segments" << LL_ENDL;
+}
+
+bool LLDiskCachePack::scanSegment(U32 segment_id, Segment& segment)
+{
+    const std::string filename = getSegmentFilename(segment_id);
+    segment.mFile = LLFile::fopen(filename, "r+b");
+    if (!segment.mFile)
+    {
+        LL_WARNS("LLDiskCache") << "Unable to open cache segment " << filename << LL_ENDL;
+        return false;
+    }
+
+    S64 file_size = -1;
+    llstat file_stat;
+    if (LLFile::stat(filename, &file_stat) == 0)
+    {
+        segment.mLastWrite = file_stat.st_mtime;
+        file_size = file_stat.st_size;
+    }
+
+    U32 offset = 0;
+    record_header_t header;
+    while (fread(&header, RECORD_HEADER_SIZE, 1, segment.mFile) == 1)
+    {
+        if (header.mMagic != RECORD_MAGIC)
+        {
+            LL_WARNS("LLDiskCache") << "Bad record in cache segment " << filename << " at offset " << offset << LL_ENDL;
+            segment.mSize = offset;
+            return false;
+        }
+
+        LLUUID id;
+        memcpy(id.mData, header.mID, UUID_BYTES);
+        killRecord(id);
+
+        U32 data_size = header.mSize > 0 ? header.mSize : 0;
+        if (header.mSize >= 0)
+        {
+            if (fseek(segment.mFile, data_size, SEEK_CUR) != 0)
+            {
+                segment.mSize = offset;
+                return false;
+            }
+            mRecords[id] = { segment_id, offset + RECORD_HEADER_SIZE, header.mSize, (LLAssetType::EType)header.mType };
+            segment.mLiveBytes += RECORD_HEADER_SIZE + data_size;
+        }
+        offset += RECORD_HEADER_SIZE + data_size;
+    }
+
+    // fseek() happily moves past the end of the file, so check that the
+    // last record really is complete
+    segment.mSize = offset;
+    return file_size == (S64)offset;
+}
+
+void LLDiskCachePack::close()
+{
+    LLMutexLock lock(&mMutex);
+    for (auto& [segment_id, segment] : mSegments)
+    {
+        if (segment.mFile)
+        {
+            fclose(segment.mFile);
+            segment.mFile = nullptr;
+        }
+    }
+    mSegments.clear();
+    mRecords.clear();
+    mHasActiveSegment = false;
+}
+
+// Must be called with mMutex held
+bool LLDiskCachePack::openActiveSegment()
+{
+    if (mHasActiveSegment)
+    {
+        Segment& segment = mSegments[mActiveSegment];
+        if (segment.mFile && segment.mSize < mSegmentMaxSize)
+        {
+            return true;
+        }
+        mActiveSegment++;
+    }
+
+    while (mSegments.find(mActiveSegment) != mSegments.end() && mSegments[mActiveSegment].mSize >= mSegmentMaxSize)
+    {
+        mActiveSegment++;
+    }
+
+    Segment& segment = mSegments[mActiveSegment];
+    if (!segment.mFile)
+    {
+        segment.mFile = LLFile::fopen(getSegmentFilename(mActiveSegment), "w+b");
+        segment.mSize = 0;
+        segment.mLiveBytes = 0;
+    }
+    mHasActiveSegment = (segment.mFile != nullptr);
+    if (!mHasActiveSegment)
+    {
+        LL_WARNS("LLDiskCache") << "Unable to create cache segment " << getSegmentFilename(mActiveSegment) << LL_ENDL;
+        mSegments.erase(mActiveSegment);
+    }
+    return mHasActiveSegment;
+}
+
+// Must be called with mMutex held
+void LLDiskCachePack::scanRecordIDs(Segment& segment, std::vector<LLUUID>* data_ids, std::vector<LLUUID>* tombstone_ids)
+{
+    if (!segment.mFile)
+    {
+        return;
+    }
+
+    record_header_t header;
+    U32 offset = 0;
+    while (offset < segment.mSize &&
+           fseek(segment.mFile, offset, SEEK_SET) == 0 &&
+           fread(&header, RECORD_HEADER_SIZE, 1, segment.mFile) == 1 &&
+           header.mMagic == RECORD_MAGIC)
+    {
+        std::vector<LLUUID>* ids = header.mSize < 0 ? tombstone_ids : data_ids;
+        if (ids)
+        {
+            LLUUID id;
+            memcpy(id.mData, header.mID, UUID_BYTES);
+            ids->push_back(id);
+        }
+        offset += RECORD_HEADER_SIZE + (header.mSize > 0 ? header.mSize : 0);
+    }
+}
+
+// Must be called with mMutex held
+void LLDiskCachePack::killRecord(const LLUUID& id)
+{
+    auto it = mRecords.find(id);
+    if (it != mRecords.end())
+    {
+        auto seg_it = mSegments.find(it->second.mSegment);
+        if (seg_it != mSegments.end())
+        {
+            seg_it->second.mLiveBytes -= llmin(seg_it->second.mLiveBytes, RECORD_HEADER_SIZE + (U32)it->second.mSize);
+        }
+        mRecords.erase(it);
+    }
+}
+
+// Must be called with mMutex held
+bool LLDiskCachePack::appendRecord(const LLUUID& id, LLAssetType::EType at, const U8* buffer, S32 bytes)
+{
+    if (!openActiveSegment())
+    {
+        return false;
+    }
+
+    Segment& segment = mSegments[mActiveSegment];
+
+    record_header_t header;
+    header.mMagic = RECORD_MAGIC;
+    memcpy(header.mID, id.mData, UUID_BYTES);
+    header.mType = (S32)at;
+    header.mSize = buffer ? bytes : -1;
+
+    bool success = fseek(segment.mFile, segment.mSize, SEEK_SET) == 0 &&
+                   fwrite(&header, RECORD_HEADER_SIZE, 1, segment.mFile) == 1;
+    if (success && buffer && bytes > 0)
+    {
+        success = fwrite(buffer, 1, bytes, segment.mFile) == (size_t)bytes;
+    }
+    fflush(segment.mFile);
+
+    if (!success)
+    {
+        // Don't leave a partial record in the middle of the segment
+        LL_WARNS("LLDiskCache") << "Failed to write to cache segment " << mActiveSegment << LL_ENDL;
+        fclose(segment.mFile);
+        segment.mFile = LLFile::fopen(getSegmentFilename(mActiveSegment), "rb");
+        segment.mSize = mSegmentMaxSize;
+        return false;
+    }
+
+    killRecord(id);
+    const U32 data_offset = segment.mSize + RECORD_HEADER_SIZE;
+    const U32 data_size = buffer ? bytes : 0;
+    segment.mSize += RECORD_HEADER_SIZE + data_size;
+    segment.mLastWrite = std::time(nullptr);
+    if (buffer)
+    {
+        mRecords[id] = { mActiveSegment, data_offset, bytes, at };
+        segment.mLiveBytes += RECORD_HEADER_SIZE + data_size;
+    }
+    return true;
+}
+
+S32 LLDiskCachePack::getSize(const LLUUID& id) const
+{
+    LLMutexLock lock(&mMutex);
+    auto it = mRecords.find(id);
+    return it != mRecords.end() ? it->second.mSize : -1;
+}
+
+S32 LLDiskCachePack::read(const LLUUID& id, S32 offset, U8* buffer, S32 bytes)
+{
+    LLMutexLock lock(&mMutex);
+    auto it = mRecords.find(id);
+    if (it == mRecords.end())
+    {
+        return -1;
+    }
+
+    const Record& record = it->second;
+    Segment& segment = mSegments[record.mSegment];
+    if (!segment.mFile || offset < 0)
+    {
+        return 0;
+    }
+
+    S32 to_read = llclamp(record.mSize - offset, 0, bytes);
+    if (to_read == 0 || fseek(segment.mFile, record.mOffset + offset, SEEK_SET) != 0)
+    {
+        return 0;
+    }
+    return (S32)fread(buffer, 1, to_read, segment.mFile);
+}
+
+bool LLDiskCachePack::readAll(const LLUUID& id, std::vector<U8>& data)
+{
+    S32 size = getSize(id);
+    if (size < 0)
+    {
+        return false;
+    }
+    data.resize(size);
+    return size == 0 || read(id, 0, data.data(), size) == size;
+}
+
+bool LLDiskCachePack::write(const LLUUID& id, LLAssetType::EType at, const U8* buffer, S32 bytes)
+{
+    LLMutexLock lock(&mMutex);
+    return appendRecord(id, at, buffer, bytes);
+}
+
+bool LLDiskCachePack::remove(const LLUUID& id)
+{
+    LLMutexLock lock(&mMutex);
+    if (mRecords.find(id) == mRecords.end())
+    {
+        return false;
+    }
+    // Make the removal persistent with a tombstone; if that fails at least
+    // forget about the record for this session
+    if (!appendRecord(id, LLAssetType::AT_NONE, nullptr, 0))
+    {
+        killRecord(id);
+    }
+    return true;
+}
+
+bool LLDiskCachePack::rename(const LLUUID& old_id, const LLUUID& new_id, LLAssetType::EType new_type)
+{
+    std::vector<U8> data;
+    if (!readAll(old_id, data))
+    {
+        return false;
+    }
+
+    LLMutexLock lock(&mMutex);
+    if (!appendRecord(new_id, new_type, data.data(), (S32)data.size()))
+    {
+        return false;
+    }
+    appendRecord(old_id, LLAssetType::AT_NONE, nullptr, 0);
+    return true;
+}
+
+void LLDiskCachePack::clear()
+{
+    std::vector<std::string> filenames;
+    {
+        LLMutexLock lock(&mMutex);
+        for (const auto& [segment_id, segment] : mSegments)
+        {
+            filenames.push_back(getSegmentFilename(segment_id));
+        }
+    }
+    const std::string dir = mDir;
+    close();
+    for (const std::string& filename : filenames)
+    {
+        LLFile::remove(filename, ENOENT);
+    }
+
+    LLMutexLock lock(&mMutex);
+    mDir = dir;
+    mActiveSegment = 0;
+}
+
+void LLDiskCachePack::compact()
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    std::vector<U32> candidates;
+    {
+        LLMutexLock lock(&mMutex);
+        for (const auto& [segment_id, segment] : mSegments)
+        {
+            if (segment_id != mActiveSegment &&
+                segment.mLiveBytes < (U32)(segment.mSize * COMPACT_LIVE_RATIO))
+            {
+                candidates.push_back(segment_id);
+            }
+        }
+    }
+
+    for (U32 segment_id : candidates)
+    {
+        std::vector<LLUUID> ids;
+        {
+            LLMutexLock lock(&mMutex);
+            for (const auto& [id, record] : mRecords)
+            {
+                if (record.mSegment == segment_id)
+                {
+                    ids.push_back(id);
+                }
+            }
+        }
+
+        // Move one record at a time so readers are not blocked for long
+        std::vector<U8> data;
+        bool moved_all = true;
+        for (const LLUUID& id : ids)
+        {
+            LLMutexLock lock(&mMutex);
+            auto it = mRecords.find(id);
+            if (it == mRecords.end() || it->second.mSegment != segment_id)
+            {
+                continue;
+            }
+            const Record record = it->second;
+            Segment& segment = mSegments[segment_id];
+            data.resize(record.mSize);
+            if (!segment.mFile ||
+                fseek(segment.mFile, record.mOffset, SEEK_SET) != 0 ||
+                (record.mSize > 0 && fread(data.data(), record.mSize, 1, segment.mFile) != 1) ||
+                !appendRecord(id, record.mType, data.data(), record.mSize))
+            {
+                moved_all = false;
+                break;
+            }
+        }
+
+        if (!moved_all)
+        {
+            continue;
+        }
+
+        LLMutexLock lock(&mMutex);
+        auto seg_it = mSegments.find(segment_id);
+        if (seg_it != mSegments.end())
+        {
+            // A tombstone in this segment is only still needed while an
+            // older segment has a stale record of that asset that would
+            // come back on next start. Older candidates were compacted (and
+            // deleted) first, so most tombstones can simply be dropped.
+            if (seg_it != mSegments.begin())
+            {
+                std::vector<LLUUID> tombstones;
+                scanRecordIDs(seg_it->second, nullptr, &tombstones);
+
+                std::unordered_set<LLUUID> removed;
+                for (const LLUUID& id : tombstones)
+                {
+                    if (mRecords.find(id) == mRecords.end())
+                    {
+                        removed.insert(id);
+                    }
+                }
+
+                std::vector<LLUUID> stale;
+                for (auto older_it = mSegments.begin(); older_it != seg_it && !removed.empty(); ++older_it)
+                {
+                    stale.clear();
+                    scanRecordIDs(older_it->second, &stale, nullptr);
+                    for (const LLUUID& id : stale)
+                    {
+                        if (removed.erase(id))
+                        {
+                            appendRecord(id, LLAssetType::AT_NONE, nullptr, 0);
+                        }
+                    }
+                }
+            }
+
+            if (seg_it->second.mFile)
+            {
+                fclose(seg_it->second.mFile);
+            }
+            mSegments.erase(seg_it);
+            LLFile::remove(getSegmentFilename(segment_id), ENOENT);
+            LL_DEBUGS("LLDiskCache") << "Compacted cache segment " << segment_id << ", moved " << ids.size() << " records" << LL_ENDL;
+        }
+    }
+}
+
+U64 LLDiskCachePack::getSegmentBytes() const
+{
+    LLMutexLock lock(&mMutex);
+    U64 bytes = 0;
+    for (const auto& [segment_id, segment] : mSegments)
+    {
+        bytes += segment.mSize;
+    }
+    return bytes;
+}
+
+void LLDiskCachePack::getEntries(std::vector<EntryInfo>& entries) const
+{
+    LLMutexLock lock(&mMutex);
+    entries.reserve(entries.size() + mRecords.size());
+    for (const auto& [id, record] : mRecords)
+    {
+        std::time_t last_write = 0;
+        auto seg_it = mSegments.find(record.mSegment);
+        if (seg_it != mSegments.end())
+        {
+            last_write = seg_it->second.mLastWrite;
+        }
+        entries.push_back({ id, record.mType, record.mSize, last_write });
+    }
+}
@@ -0,0 +1,171 @@
+/**
+ * @file lldiskcachepack.h
+ * @brief Append-only segment store for small disk cache assets.
+ *
+ * @Description:
+ * Most entries in the asset disk cache are tiny (LSL bytecode, notecards,
+ * gestures, sound and mesh headers...). Storing each of them as its own
+ * file costs a create/open/close and an inode per asset, which is slow on
+ * some file systems and with on-access virus scanners.
+ *
+ * Small assets are instead appended to a handful of large segment files:
+ * 1/ Each record is a small header (id, asset type, size) followed by
+ *    the asset data. A removal is recorded as a header with a negative
+ *    size (a tombstone). The newest record for an id wins.
+ * 2/ Only the newest segment is ever written to. It is rolled over once
+ *    it reaches SEGMENT_MAX_SIZE bytes.
+ * 3/ The location of every live record is kept in memory and rebuilt at
+ *    startup by reading the record headers of each segment.
+ * 4/ compact() copies the live records of mostly dead segments into the
+ *    active segment and deletes the old segment. It is run from
+ *    LLPurgeDiskCacheThread after each purge.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLDISKCACHEPACK_H
+#define LL_LLDISKCACHEPACK_H
+
+#include "llassettype.h"
+#include "llfile.h"
+#include "llmutex.h"
+#include "lluuid.h"
+
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class LLDiskCachePack
+{
+    public:
+        LLDiskCachePack();
+        ~LLDiskCachePack();
+
+        /**
+         * Open all the segment files found in dir and rebuild the map of
+         * live records from their headers.
+         */
+        void init(const std::string& dir);
+
+        /**
+         * Close all segment files. Called on shutdown.
+         */
+        void close();
+
+        /**
+         * Size of the packed asset, or -1 if id is not in the pack.
+         */
+        S32 getSize(const LLUUID& id) const;
+        bool contains(const LLUUID& id) const { return getSize(id) >= 0; }
+
+        /**
+         * Read up to bytes bytes of the asset starting at offset. Returns the
+         * number of bytes read or -1 if the asset is not in the pack.
+         */
+        S32 read(const LLUUID& id, S32 offset, U8* buffer, S32 bytes);
+
+        /**
+         * Read the complete asset data. Returns false if the asset is not in
+         * the pack.
+         */
+        bool readAll(const LLUUID& id, std::vector<U8>& data);
+
+        /**
+         * Replace the content of an asset with the given buffer.
+         */
+        bool write(const LLUUID& id, LLAssetType::EType at, const U8* buffer, S32 bytes);
+
+        bool remove(const LLUUID& id);
+        bool rename(const LLUUID& old_id, const LLUUID& new_id, LLAssetType::EType new_type);
+
+        /**
+         * Remove all the segment files.
+         */
+        void clear();
+
+        /**
+         * Move the live records out of segments that are mostly dead and
+         * delete those segments. Safe to call from any thread.
+         */
+        void compact();
+
+        /**
+         * Total size of the segment files, tombstones and dead records
+         * included.
+         */
+        U64 getSegmentBytes() const;
+
+        /**
+         * Size at which the active segment is closed and a new one started.
+         * Only meant to be changed by the tests.
+         */
+        void setSegmentMaxSize(U32 bytes) { mSegmentMaxSize = bytes; }
+
+        struct EntryInfo
+        {
+            LLUUID              mID;
+            LLAssetType::EType  mType;
+            S32                 mSize;
+            std::time_t         mLastWrite; // Time the containing segment was last written
+        };
+
+        /**
+         * List the live records, used to rebuild the disk cache index.
+         */
+        void getEntries(std::vector<EntryInfo>& entries) const;
+
+    private:
+        struct Record
+        {
+            U32                 mSegment;
+            U32                 mOffset;    // Start of the asset data in the segment
+            S32                 mSize;
+            LLAssetType::EType  mType;
+        };
+
+        struct Segment
+        {
+            LLFILE*     mFile{ nullptr };
+            U32         mSize{ 0 };         // Bytes used in the segment file
+            U32         mLiveBytes{ 0 };    // Bytes used by live records (headers included)
+            std::time_t mLastWrite{ 0 };
+        };
+
+        bool scanSegment(U32 segment_id, Segment& segment);
+        bool openActiveSegment();
+        bool appendRecord(const LLUUID& id, LLAssetType::EType at, const U8* buffer, S32 bytes);
+        void killRecord(const LLUUID& id);
+        void scanRecordIDs(Segment& segment, std::vector<LLUUID>* data_ids, std::vector<LLUUID>* tombstone_ids);
+        std::string getSegmentFilename(U32 segment_id) const;
+
+    private:
+        std::string mDir;
+        std::unordered_map<LLUUID, Record> mRecords;
+        std::map<U32, Segment> mSegments;
+        U32 mActiveSegment{ 0 };
+        bool mHasActiveSegment{ false };
+        U32 mSegmentMaxSize;
+        mutable LLMutex mMutex;
+};
+
+#endif // LL_LLDISKCACHEPACK_H
@@ -32,10 +32,15 @@
 #include "lldir.h"
 #include "llfilesystem.h"
 #include "llfasttimer.h"
+#include "lltimer.h"
+#include "lltrace.h"
 #include "lldiskcache.h"
+#include "lldiskcachecompressed.h"
+#include "workqueue.h"
 
 #include "boost/filesystem.hpp"
 
+
 constexpr S32 LLFileSystem::READ        = 0x00000001;
 constexpr S32 LLFileSystem::WRITE       = 0x00000002;
 constexpr S32 LLFileSystem::READ_WRITE  = 0x00000003;  // LLFileSystem::READ & LLFileSystem::WRITE
@@ -43,6 +48,124 @@ constexpr S32 LLFileSystem::APPEND      = 0x00000006;  // 0x00000004 & LLFileSys
 
 static LLTrace::BlockTimerStatHandle FTM_VFILE_WAIT("VFile Wait");
 
+LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > LLFileSystem::sCacheHitRate("disk_cache_hits");
+LLTrace::SampleStatHandle<F32Milliseconds> LLFileSystem::sCacheReadLatency("disk_cache_read_latency");
+LLTrace::CountStatHandle<F64Kilobytes> LLFileSystem::sCacheBytesRead("disk_cache_bytes_read");
+LLTrace::CountStatHandle<F64Kilobytes> LLFileSystem::sCacheBytesWritten("disk_cache_bytes_written");
+
+// Disk cache statistics, shown in the Disk Cache section of the statistics
+// floater. Lookups are counted when a file is opened for reading and in
+// getExists(); the per-type stats group the asset types the cache actually
+// sees so that each of them can be told apart in the floater.
+namespace
+{
+    typedef LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > hit_rate_stat_t;
+    typedef LLTrace::SampleStatHandle<F32Milliseconds> latency_stat_t;
+
+    struct TypeStats
+    {
+        hit_rate_stat_t mHitRate;
+        latency_stat_t  mReadLatency;
+    };
+
+    enum ETypeGroup
+    {
+        GROUP_SOUND,
+        GROUP_ANIMATION,
+        GROUP_MESH,
+        GROUP_WEARABLE,
+        GROUP_SCRIPT,
+        GROUP_NOTECARD,
+        GROUP_GESTURE,
+        GROUP_MATERIAL,
+        GROUP_OTHER,
+        GROUP_COUNT
+    };
+
+    TypeStats sTypeStats[GROUP_COUNT] =
+    {
+        { hit_rate_stat_t("disk_cache_hits_sound"), latency_stat_t("disk_cache_read_latency_sound") },
+        { hit_rate_stat_t("disk_cache_hits_animation"), latency_stat_t("disk_cache_read_latency_animation") },
+        { hit_rate_stat_t("disk_cache_hits_mesh"), latency_stat_t("disk_cache_read_latency_mesh") },
+        { hit_rate_stat_t("disk_cache_hits_wearable"), latency_stat_t("disk_cache_read_latency_wearable") },
+        { hit_rate_stat_t("disk_cache_hits_script"), latency_stat_t("disk_cache_read_latency_script") },
+        { hit_rate_stat_t("disk_cache_hits_notecard"), latency_stat_t("disk_cache_read_latency_notecard") },
+        { hit_rate_stat_t("disk_cache_hits_gesture"), latency_stat_t("disk_cache_read_latency_gesture") },
+        { hit_rate_stat_t("disk_cache_hits_material"), latency_stat_t("disk_cache_read_latency_material") },
+        { hit_rate_stat_t("disk_cache_hits_other"), latency_stat_t("disk_cache_read_latency_other") },
+    };
+
+    TypeStats& get_type_stats(LLAssetType::EType type)
+    {
+        switch (type)
+        {
+            case LLAssetType::AT_SOUND:
+            case LLAssetType::AT_SOUND_WAV:
+                return sTypeStats[GROUP_SOUND];
+            case LLAssetType::AT_ANIMATION:
+                return sTypeStats[GROUP_ANIMATION];
+            case LLAssetType::AT_MESH:
+                return sTypeStats[GROUP_MESH];
+            case LLAssetType::AT_BODYPART:
+            case LLAssetType::AT_CLOTHING:
+                return sTypeStats[GROUP_WEARABLE];
+            case LLAssetType::AT_LSL_TEXT:
+            case LLAssetType::AT_LSL_BYTECODE:
+                return sTypeStats[GROUP_SCRIPT];
+            case LLAssetType::AT_NOTECARD:
+                return sTypeStats[GROUP_NOTECARD];
+            case LLAssetType::AT_GESTURE:
+                return sTypeStats[GROUP_GESTURE];
+            case LLAssetType::AT_SETTINGS:
+            case LLAssetType::AT_MATERIAL:
+                return sTypeStats[GROUP_MATERIAL];
+            default:
+                return sTypeStats[GROUP_OTHER];
+        }
+    }
+
+    void record_lookup(LLAssetType::EType type, bool hit)
+    {
+        LLUnit<F32, LLUnits::Ratio> ratio = LLUnits::Ratio::fromValue(hit ? 1 : 0);
+        record(LLFileSystem::sCacheHitRate, ratio);
+        record(get_type_stats(type).mHitRate, ratio);
+    }
+
+    void record_read(LLAssetType::EType type, S32 bytes, F32Milliseconds latency)
+    {
+        add(LLFileSystem::sCacheBytesRead, F64Bytes(bytes));
+        sample(LLFileSystem::sCacheReadLatency, latency);
+        sample(get_type_stats(type).mReadLatency, latency);
+    }
+}
+
+// The segment store for small assets, if the disk cache is up
+static LLDiskCachePack* get_pack()
+{
+    return LLDiskCache::instanceExists() ? &LLDiskCache::getInstance()->getPack() : nullptr;
+}
+
+// Move a packed asset out to its own file, for writes that need one
+static void unpack_to_file(LLDiskCachePack* pack, const LLUUID& file_id, const std::string& filename)
+{
+    std::vector<U8> data;
+    if (!pack || !pack->readAll(file_id, data))
+    {
+        return;
+    }
+
+    LLFILE* ofs = LLFile::fopen(filename, "wb");
+    if (ofs)
+    {
+        bool success = data.empty() || fwrite(data.data(), 1, data.size(), ofs) == data.size();
+        fclose(ofs);
+        if (success)
+        {
+            pack->remove(file_id);
+        }
+    }
+}
+
 LLFileSystem::LLFileSystem(const LLUUID& file_id, const LLAssetType::EType file_type, S32 mode)
 {
     mFileType = file_type;
@@ -54,7 +177,17 @@ LLFileSystem::LLFileSystem(const LLUUID& file_id, const LLAssetType::EType file_
     // This block of code was originally called in the read() method but after comments here:
     // https://bitbucket.org/lindenlab/viewer/commits/e28c1b46e9944f0215a13cab8ee7dded88d7fc90#comment-10537114
     // we decided to follow Henri's suggestion and move the code to update the last access time here.
-    if (mode == LLFileSystem::READ)
+    if (mode == LLFileSystem::READ && get_pack() && get_pack()->contains(mFileID))
+    {
+        record_lookup(mFileType, true);
+
+        // Packed assets keep their access time in the disk cache index only
+        if (!LLDiskCache::getInstance()->recordAccess(mFileID))
+        {
+            LLDiskCache::getInstance()->recordWrite(mFileID, mFileType, get_pack()->getSize(mFileID));
+        }
+    }
+    else if (mode == LLFileSystem::READ)
     {
         // build the filename (TODO: we do this in a few places - perhaps we should factor into a single function)
         const std::string filename = LLDiskCache::metaDataToFilepath(mFileID, mFileType);
@@ -64,9 +197,20 @@ LLFileSystem::LLFileSystem(const LLUUID& file_id, const LLAssetType::EType file_
         // way the cache works - it relies on a valid "last accessed time" for
         // each file so it knows how to remove the oldest, unused files
         bool exists = gDirUtilp->fileExists(filename);
+        record_lookup(mFileType, exists);
         if (exists)
         {
             updateFileAccessTime(filename);
+
+            // Keep the disk cache index in step; pick up files it does not know about yet
+            if (LLDiskCache::instanceExists() && !LLDiskCache::getInstance()->recordAccess(mFileID))
+            {
+                llstat file_stat;
+                if (LLFile::stat(filename, &file_stat) == 0)
+                {
+                    LLDiskCache::getInstance()->recordWrite(mFileID, mFileType, file_stat.st_size);
+                }
+            }
         }
     }
 }
@@ -75,6 +219,13 @@ LLFileSystem::LLFileSystem(const LLUUID& file_id, const LLAssetType::EType file_
 bool LLFileSystem::getExists(const LLUUID& file_id, const LLAssetType::EType file_type)
 {
     LL_PROFILE_ZONE_SCOPED;
+    if (LLDiskCachePack* pack = get_pack(); pack && pack->contains(file_id))
+    {
+        bool exists = pack->getSize(file_id) > 0;
+        record_lookup(file_type, exists);
+        return exists;
+    }
+
     const std::string filename = LLDiskCache::metaDataToFilepath(file_id, file_type);
 
     // <FS:Ansariel> IO-streams replacement
@@ -85,13 +236,11 @@ bool LLFileSystem::getExists(const LLUUID& file_id, const LLAssetType::EType fil
     //    return file.tellg() > 0;
     //}
     llstat file_stat;
-    if (LLFile::stat(filename, &file_stat) == 0)
-    {
-        return S_ISREG(file_stat.st_mode) && file_stat.st_size > 0;
-    }
+    bool exists = LLFile::stat(filename, &file_stat) == 0 && S_ISREG(file_stat.st_mode) && file_stat.st_size > 0;
     // </FS:Ansariel>
 
-    return false;
+    record_lookup(file_type, exists);
+    return exists;
 }
 
 // static
@@ -100,7 +249,16 @@ bool LLFileSystem::removeFile(const LLUUID& file_id, const LLAssetType::EType fi
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
     const std::string filename = LLDiskCache::metaDataToFilepath(file_id, file_type);
 
-    LLFile::remove(filename.c_str(), suppress_error);
+    LLDiskCachePack* pack = get_pack();
+    if (!pack || !pack->remove(file_id))
+    {
+        LLFile::remove(filename.c_str(), suppress_error);
+    }
+
+    if (LLDiskCache::instanceExists())
+    {
+        LLDiskCache::getInstance()->recordRemove(file_id);
+    }
 
     return true;
 }
@@ -116,7 +274,11 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
     // Rename needs the new file to not exist.
     LLFileSystem::removeFile(new_file_id, new_file_type, ENOENT);
 
-    if (LLFile::rename(old_filename, new_filename) != 0)
+    if (LLDiskCachePack* pack = get_pack(); pack && pack->rename(old_file_id, new_file_id, new_file_type))
+    {
+        LLDiskCache::getInstance()->recordRename(old_file_id, new_file_id, new_file_type);
+    }
+    else if (LLFile::rename(old_filename, new_filename) != 0)
     {
         // We would like to return false here indicating the operation
         // failed but the original code does not and doing so seems to
@@ -124,6 +286,10 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
         //return false;
         LL_WARNS() << "Failed to rename " << old_file_id << " to " << new_file_id << " reason: " << strerror(errno) << LL_ENDL;
     }
+    else if (LLDiskCache::instanceExists())
+    {
+        LLDiskCache::getInstance()->recordRename(old_file_id, new_file_id, new_file_type);
+    }
 
     return true;
 }
@@ -132,6 +298,15 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
 S32 LLFileSystem::getFileSize(const LLUUID& file_id, const LLAssetType::EType file_type)
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    if (LLDiskCachePack* pack = get_pack())
+    {
+        S32 packed_size = pack->getSize(file_id);
+        if (packed_size >= 0)
+        {
+            return packed_size;
+        }
+    }
+
     const std::string filename = LLDiskCache::metaDataToFilepath(file_id, file_type);
 
     S32 file_size = 0;
@@ -149,16 +324,155 @@ S32 LLFileSystem::getFileSize(const LLUUID& file_id, const LLAssetType::EType fi
     }
     // </FS:Ansariel>
 
+    if (LLDiskCache::isCompressibleType(file_type) && file_size > 0)
+    {
+        S32 uncompressed_size = LLDiskCacheCompressed::getSize(filename);
+        if (uncompressed_size >= 0)
+        {
+            file_size = uncompressed_size;
+        }
+    }
+
     return file_size;
 }
 
+namespace
+{
+    struct AsyncReadResult
+    {
+        bool mSuccess{ false };
+        std::vector<U8> mData;
+    };
+
+    AsyncReadResult do_read(const LLUUID& file_id, const LLAssetType::EType file_type, S32 offset, S32 bytes)
+    {
+        AsyncReadResult result;
+        LLFileSystem file(file_id, file_type, LLFileSystem::READ);
+        if (bytes < 0)
+        {
+            bytes = llmax(file.getSize() - offset, 0);
+        }
+        if (bytes > 0 && file.seek(offset, 0))
+        {
+            result.mData.resize(bytes);
+            result.mSuccess = file.read(result.mData.data(), bytes);
+            result.mData.resize(file.getLastBytesRead());
+        }
+        return result;
+    }
+
+    bool do_write(const LLUUID& file_id, const LLAssetType::EType file_type, const std::vector<U8>& data, S32 mode)
+    {
+        LLFileSystem file(file_id, file_type, mode);
+        return file.write(data.data(), (S32)data.size());
+    }
+}
+
+// static
+void LLFileSystem::readAsync(const LLUUID& file_id, const LLAssetType::EType file_type,
+                             S32 offset, S32 bytes, read_callback_t callback,
+                             const std::string& reply_queue)
+{
+    LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    LL::WorkQueue::ptr_t origin_queue = LL::WorkQueue::getInstance(reply_queue);
+    if (general_queue && origin_queue &&
+        origin_queue->postTo(
+            general_queue,
+            [file_id, file_type, offset, bytes]() // Work done on general queue
+            {
+                return do_read(file_id, file_type, offset, bytes);
+            },
+            [callback](AsyncReadResult result) mutable // Callback to reply queue
+            {
+                if (callback)
+                {
+                    callback(result.mSuccess, result.mData);
+                }
+            }))
+    {
+        return;
+    }
+
+    // No thread pool (e.g. during startup or shutdown): do it right away
+    AsyncReadResult result = do_read(file_id, file_type, offset, bytes);
+    if (callback)
+    {
+        callback(result.mSuccess, result.mData);
+    }
+}
+
+// static
+void LLFileSystem::writeAsync(const LLUUID& file_id, const LLAssetType::EType file_type,
+                              std::vector<U8> data, S32 mode, write_callback_t callback,
+                              const std::string& reply_queue)
+{
+    LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    LL::WorkQueue::ptr_t origin_queue = LL::WorkQueue::getInstance(reply_queue);
+    if (general_queue && origin_queue)
+    {
+        // The data must outlive a failed post, so share it between the lambdas
+        auto shared_data = std::make_shared<std::vector<U8>>(std::move(data));
+        if (origin_queue->postTo(
+                general_queue,
+                [file_id, file_type, shared_data, mode]() // Work done on general queue
+                {
+                    return do_write(file_id, file_type, *shared_data, mode);
+                },
+                [callback](bool success) // Callback to reply queue
+                {
+                    if (callback)
+                    {
+                        callback(success);
+                    }
+                }))
+        {
+            return;
+        }
+        data = std::move(*shared_data);
+    }
+
+    bool success = do_write(file_id, file_type, data, mode);
+    if (callback)
+    {
+        callback(success);
+    }
+}
+
 bool LLFileSystem::read(U8* buffer, S32 bytes)
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
     bool success = false;
+    LLTimer read_timer;
+
+    if (LLDiskCachePack* pack = get_pack())
+    {
+        S32 bytes_read = pack->read(mFileID, mPosition, buffer, bytes);
+        if (bytes_read >= 0)
+        {
+            mBytesRead = bytes_read;
+            mPosition += mBytesRead;
+            record_read(mFileType, mBytesRead, read_timer.getElapsedTimeF32());
+            return mBytesRead > 0;
+        }
+    }
 
     const std::string filename = LLDiskCache::metaDataToFilepath(mFileID, mFileType);
 
+    if (LLDiskCache::isCompressibleType(mFileType))
+    {
+        // Only the chunks overlapping the requested range get inflated
+        S32 bytes_read = LLDiskCacheCompressed::read(filename, mPosition, buffer, bytes);
+        if (bytes_read >= 0)
+        {
+            mBytesRead = bytes_read;
+            mPosition += mBytesRead;
+            record_read(mFileType, mBytesRead, read_timer.getElapsedTimeF32());
+            return mBytesRead > 0;
+        }
+    }
+
     // <FS:Ansariel> IO-streams replacement
     //llifstream file(filename, std::ios::binary);
     //if (file.is_open())
@@ -199,6 +513,7 @@ bool LLFileSystem::read(U8* buffer, S32 bytes)
             {
                 success = true;
             }
+            record_read(mFileType, mBytesRead, read_timer.getElapsedTimeF32());
         }
     }
     // </FS:Ansariel>
@@ -225,6 +540,40 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
 
     bool success = false;
 
+    if (LLDiskCachePack* pack = get_pack())
+    {
+        const U32 pack_threshold = LLDiskCache::getInstance()->getPackThreshold();
+        if (mMode == WRITE && bytes >= 0 && (U32)bytes <= pack_threshold)
+        {
+            // A complete small asset; keep it out of the file system
+            if (pack->write(mFileID, mFileType, buffer, bytes))
+            {
+                LLFile::remove(filename, ENOENT);
+                mPosition = bytes;
+                add(sCacheBytesWritten, F64Bytes(bytes));
+                LLDiskCache::getInstance()->recordWrite(mFileID, mFileType, bytes);
+                return true;
+            }
+        }
+        else if (pack->contains(mFileID))
+        {
+            // Partial writes and large assets live in their own file
+            unpack_to_file(pack, mFileID, filename);
+        }
+    }
+
+    if (LLDiskCache::isCompressibleType(mFileType) && LLDiskCache::instanceExists())
+    {
+        // Whole writes follow the setting. Partial writes keep the format of
+        // the existing file, new files follow the setting.
+        const bool compress_assets = LLDiskCache::getInstance()->getCompressAssets();
+        const bool compressed_file = LLDiskCacheCompressed::isCompressed(filename);
+        if (mMode == WRITE ? compress_assets : (compressed_file || (compress_assets && !LLFile::isfile(filename))))
+        {
+            return writeCompressed(filename, buffer, bytes, compressed_file);
+        }
+    }
+
     // <FS:Ansariel> IO-streams replacement
     //if (mMode == APPEND)
     //{
@@ -322,9 +671,53 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
     }
     // </FS:Ansariel>
 
+    if (success)
+    {
+        add(sCacheBytesWritten, F64Bytes(bytes));
+    }
+
+    if (success && LLDiskCache::instanceExists())
+    {
+        // mPosition is the end of the file for WRITE and APPEND; a READ_WRITE
+        // may have overwritten data in the middle without growing the file
+        uintmax_t file_size = mPosition;
+        if (mMode == READ_WRITE)
+        {
+            file_size = getFileSize(mFileID, mFileType);
+        }
+        LLDiskCache::getInstance()->recordWrite(mFileID, mFileType, file_size);
+    }
+
     return success;
 }
 
+bool LLFileSystem::writeCompressed(const std::string& filename, const U8* buffer, S32 bytes, bool compressed_file)
+{
+    // Writes only ever add chunks, so block-wise writers don't rewrite
+    // (or even inflate) the data that is already there
+    S32 offset = 0;
+    if (mMode == APPEND)
+    {
+        offset = compressed_file ? LLDiskCacheCompressed::getSize(filename) : 0;
+    }
+    else if (mMode == READ_WRITE)
+    {
+        offset = mPosition;
+    }
+
+    uintmax_t disk_size = 0;
+    if (!LLDiskCacheCompressed::write(filename, offset, buffer, bytes, mMode == WRITE || !compressed_file, disk_size))
+    {
+        return false;
+    }
+
+    mPosition = offset + bytes;
+    add(LLFileSystem::sCacheBytesWritten, F64Bytes(bytes));
+    // The cache size limit applies to what is actually on disk
+    LLDiskCache::getInstance()->recordWrite(mFileID, mFileType, disk_size);
+    return true;
+}
+
 bool LLFileSystem::seek(S32 offset, S32 origin)
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
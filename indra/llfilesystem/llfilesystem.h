@@ -33,6 +33,10 @@
 #include "lluuid.h"
 #include "llassettype.h"
 #include "lldiskcache.h"
+#include "lltrace.h"
+
+#include <functional>
+#include <vector>
 
 class LLFileSystem
 {
@@ -66,12 +70,42 @@ class LLFileSystem
                                const LLUUID& new_file_id, const LLAssetType::EType new_file_type);
         static S32 getFileSize(const LLUUID& file_id, const LLAssetType::EType file_type);
 
+        /**
+         * Non-blocking versions of read() and write(). The file operation runs on
+         * the "General" thread pool and the callback is then invoked on the thread
+         * servicing reply_queue (the main loop by default), so a cold disk never
+         * stalls the caller. If either queue is not available the operation is
+         * performed synchronously and the callback is invoked before returning.
+         *
+         * readAsync() reads up to bytes bytes from offset; bytes < 0 reads the
+         * rest of the file. writeAsync() takes one of the mode flags above.
+         */
+        typedef std::function<void(bool success, std::vector<U8>& data)> read_callback_t;
+        typedef std::function<void(bool success)> write_callback_t;
+        static void readAsync(const LLUUID& file_id, const LLAssetType::EType file_type,
+                              S32 offset, S32 bytes, read_callback_t callback,
+                              const std::string& reply_queue = "mainloop");
+        static void writeAsync(const LLUUID& file_id, const LLAssetType::EType file_type,
+                               std::vector<U8> data, S32 mode, write_callback_t callback,
+                               const std::string& reply_queue = "mainloop");
+
     public:
         static const S32 READ;
         static const S32 WRITE;
         static const S32 READ_WRITE;
         static const S32 APPEND;
 
+        // Disk cache lookups, reads and writes across all asset types; the
+        // per-type stats are only looked up by name by the statistics floater
+        static LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > sCacheHitRate;
+        static LLTrace::SampleStatHandle<F32Milliseconds> sCacheReadLatency;
+        static LLTrace::CountStatHandle<F64Kilobytes> sCacheBytesRead;
+        static LLTrace::CountStatHandle<F64Kilobytes> sCacheBytesWritten;
+
+    protected:
+        // Write path for compressed mesh and animation assets
+        bool writeCompressed(const std::string& filename, const U8* buffer, S32 bytes, bool compressed_file);
+
     protected:
         LLAssetType::EType mFileType;
         LLUUID  mFileID;
@@ -0,0 +1,152 @@
+/**
+ * @file lldiskcachecompressed_test.cpp
+ * @brief LLDiskCacheCompressed test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lldiskcachecompressed.h"
+#include "llfile.h"
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+    struct LLDiskCacheCompressedData
+    {
+        std::string mFilename;
+
+        LLDiskCacheCompressedData()
+        {
+            mFilename = std::string(LLFile::tmpdir()) + "lldiskcachecompressed_test.asset";
+        }
+
+        ~LLDiskCacheCompressedData()
+        {
+            LLFile::remove(mFilename, ENOENT);
+        }
+
+        // Compressible, but not the same byte over and over
+        static std::vector<U8> makeBlock(S32 index, S32 size)
+        {
+            std::vector<U8> block(size);
+            for (S32 i = 0; i < size; ++i)
+            {
+                block[i] = (U8)((index * 7 + i / 16) & 0xff);
+            }
+            return block;
+        }
+
+        std::vector<U8> readAll()
+        {
+            S32 size = LLDiskCacheCompressed::getSize(mFilename);
+            std::vector<U8> data(llmax(size, 0));
+            S32 bytes_read = LLDiskCacheCompressed::read(mFilename, 0, data.data(), size);
+            ensure_equals("read all", bytes_read, size);
+            return data;
+        }
+    };
+    typedef test_group<LLDiskCacheCompressedData> LLDiskCacheCompressedTest_t;
+    typedef LLDiskCacheCompressedTest_t::object LLDiskCacheCompressedTest_object_t;
+    tut::LLDiskCacheCompressedTest_t tut_LLDiskCacheCompressedTest("LLDiskCacheCompressed");
+
+    template<> template<>
+    void LLDiskCacheCompressedTest_object_t::test<1>()
+        // Block-wise appends only add to the file and read back whole
+    {
+        const S32 BLOCK_SIZE = 1000;
+        const S32 BLOCK_COUNT = 200;
+
+        std::vector<U8> expected;
+        uintmax_t disk_size = 0;
+        for (S32 i = 0; i < BLOCK_COUNT; ++i)
+        {
+            const std::vector<U8> block = makeBlock(i, BLOCK_SIZE);
+            const S32 offset = i ? LLDiskCacheCompressed::getSize(mFilename) : 0;
+            ensure_equals("append offset", offset, (S32)expected.size());
+
+            const uintmax_t previous_size = disk_size;
+            ensure("append", LLDiskCacheCompressed::write(mFilename, offset, block.data(), BLOCK_SIZE, i == 0, disk_size));
+            // An append must not rewrite what is already there
+            ensure("file grew", disk_size > previous_size);
+            ensure("append only adds one chunk", disk_size - previous_size < (uintmax_t)BLOCK_SIZE);
+
+            expected.insert(expected.end(), block.begin(), block.end());
+        }
+
+        ensure("is compressed", LLDiskCacheCompressed::isCompressed(mFilename));
+        ensure_equals("size", LLDiskCacheCompressed::getSize(mFilename), BLOCK_COUNT * BLOCK_SIZE);
+        ensure("content", readAll() == expected);
+
+        // A read in the middle spanning two blocks
+        std::vector<U8> middle(BLOCK_SIZE);
+        const S32 offset = 57 * BLOCK_SIZE + BLOCK_SIZE / 2;
+        ensure_equals("middle read", LLDiskCacheCompressed::read(mFilename, offset, middle.data(), BLOCK_SIZE), BLOCK_SIZE);
+        ensure("middle content", std::equal(middle.begin(), middle.end(), expected.begin() + offset));
+
+        // Reads past the end are clamped
+        ensure_equals("read past the end", LLDiskCacheCompressed::read(mFilename, BLOCK_COUNT * BLOCK_SIZE - 10, middle.data(), BLOCK_SIZE), 10);
+    }
+
+    template<> template<>
+    void LLDiskCacheCompressedTest_object_t::test<2>()
+        // Newer chunks win over the data they overlap, holes read as zeros
+    {
+        const S32 SIZE = 200 * 1024;
+        std::vector<U8> expected = makeBlock(1, SIZE);
+        uintmax_t disk_size = 0;
+        ensure("write", LLDiskCacheCompressed::write(mFilename, 0, expected.data(), SIZE, true, disk_size));
+
+        const std::vector<U8> patch = makeBlock(2, 5000);
+        ensure("patch", LLDiskCacheCompressed::write(mFilename, 70000, patch.data(), (S32)patch.size(), false, disk_size));
+        std::copy(patch.begin(), patch.end(), expected.begin() + 70000);
+
+        const std::vector<U8> tail = makeBlock(3, 100);
+        ensure("write past the end", LLDiskCacheCompressed::write(mFilename, SIZE + 50, tail.data(), (S32)tail.size(), false, disk_size));
+        expected.resize(SIZE + 50, 0);
+        expected.insert(expected.end(), tail.begin(), tail.end());
+
+        ensure_equals("size", LLDiskCacheCompressed::getSize(mFilename), (S32)expected.size());
+        ensure("content", readAll() == expected);
+
+        // Starting over drops the old chunks
+        ensure("truncate", LLDiskCacheCompressed::write(mFilename, 0, tail.data(), (S32)tail.size(), true, disk_size));
+        ensure("truncated content", readAll() == tail);
+    }
+
+    template<> template<>
+    void LLDiskCacheCompressedTest_object_t::test<3>()
+        // Regular files are left to the caller
+    {
+        LLFILE* file = LLFile::fopen(mFilename, "wb");
+        ensure("create", file != nullptr);
+        fwrite("plain asset data", 1, 16, file);
+        fclose(file);
+
+        U8 buffer[16];
+        ensure("not compressed", !LLDiskCacheCompressed::isCompressed(mFilename));
+        ensure_equals("size", LLDiskCacheCompressed::getSize(mFilename), -1);
+        ensure_equals("read", LLDiskCacheCompressed::read(mFilename, 0, buffer, 16), -1);
+    }
+}
@@ -0,0 +1,145 @@
+/**
+ * @file lldiskcachepack_test.cpp
+ * @brief LLDiskCachePack test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lldiskcachepack.h"
+#include "../lldir.h"
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+    // Size of a record header in the segment files
+    static const U64 HEADER_SIZE = 28;
+    static const S32 ASSET_SIZE = 40;
+
+    struct LLDiskCachePackData
+    {
+        std::string mDir;
+        LLDiskCachePack mPack;
+
+        LLDiskCachePackData()
+        {
+            mDir = std::string(LLFile::tmpdir()) + "lldiskcachepack_test";
+            LLFile::mkdir(mDir);
+            mPack.init(mDir);
+            mPack.clear();
+        }
+
+        ~LLDiskCachePackData()
+        {
+            mPack.clear();
+            LLFile::rmdir(mDir);
+        }
+
+        void write(const LLUUID& id, U8 fill)
+        {
+            std::vector<U8> data(ASSET_SIZE, fill);
+            ensure("write " + id.asString(), mPack.write(id, LLAssetType::AT_TEXTURE, data.data(), ASSET_SIZE));
+        }
+
+        void ensureContent(const LLUUID& id, U8 fill)
+        {
+            std::vector<U8> data;
+            ensure("read " + id.asString(), mPack.readAll(id, data));
+            ensure_equals("content of " + id.asString(), data, std::vector<U8>(ASSET_SIZE, fill));
+        }
+
+        void reopen()
+        {
+            mPack.close();
+            mPack.init(mDir);
+        }
+    };
+    typedef test_group<LLDiskCachePackData> LLDiskCachePackTest_t;
+    typedef LLDiskCachePackTest_t::object LLDiskCachePackTest_object_t;
+    tut::LLDiskCachePackTest_t tut_LLDiskCachePackTest("LLDiskCachePack");
+
+    template<> template<>
+    void LLDiskCachePackTest_object_t::test<1>()
+        // compact() drops tombstones once nothing older is left for them to hide
+    {
+        const LLUUID a("00000000-0000-0000-0000-00000000000a");
+        const LLUUID b("00000000-0000-0000-0000-00000000000b");
+        const LLUUID c("00000000-0000-0000-0000-00000000000c");
+
+        // One record per segment
+        mPack.setSegmentMaxSize(1);
+        write(a, 1);
+        write(b, 2);
+        ensure("remove", mPack.remove(a));
+        write(c, 3);
+
+        const U64 before = mPack.getSegmentBytes();
+        ensure_equals("segment bytes before compact", before, 3 * (HEADER_SIZE + ASSET_SIZE) + HEADER_SIZE);
+
+        mPack.compact();
+        ensure_equals("segment bytes after compact", mPack.getSegmentBytes(), 2 * (HEADER_SIZE + ASSET_SIZE));
+
+        reopen();
+        ensure_equals("segment bytes after reopen", mPack.getSegmentBytes(), 2 * (HEADER_SIZE + ASSET_SIZE));
+        ensure("removed asset came back", !mPack.contains(a));
+        ensureContent(b, 2);
+        ensureContent(c, 3);
+    }
+
+    template<> template<>
+    void LLDiskCachePackTest_object_t::test<2>()
+        // compact() keeps a tombstone while an older segment still has the record
+    {
+        const LLUUID a("00000000-0000-0000-0000-00000000000a");
+        const LLUUID b("00000000-0000-0000-0000-00000000000b");
+        const LLUUID c("00000000-0000-0000-0000-00000000000c");
+        const LLUUID e("00000000-0000-0000-0000-00000000000e");
+        const LLUUID f("00000000-0000-0000-0000-00000000000f");
+
+        // Segment 0: a, b. Segment 1: tombstone a, c, tombstone c, e.
+        // Segment 2: f
+        mPack.setSegmentMaxSize(130);
+        write(a, 1);
+        write(b, 2);
+        ensure("remove a", mPack.remove(a));
+        write(c, 3);
+        ensure("remove c", mPack.remove(c));
+        write(e, 4);
+        write(f, 5);
+
+        // Segment 0 is still half live and stays. Segment 1 goes, e moves
+        // on and only the tombstone of a, which still hides the record in
+        // segment 0, goes with it.
+        mPack.compact();
+        ensure_equals("segment bytes after compact", mPack.getSegmentBytes(),
+                      4 * (HEADER_SIZE + ASSET_SIZE) + HEADER_SIZE);
+
+        reopen();
+        ensure("removed asset came back", !mPack.contains(a));
+        ensure("removed asset came back", !mPack.contains(c));
+        ensureContent(b, 2);
+        ensureContent(e, 4);
+        ensureContent(f, 5);
+    }
+}
@@ -39,6 +39,7 @@
 #include "llimagejpeg.h"
 #include "llimagepng.h"
 #include "llimagedxt.h"
+#include "llimagesimd.h"
 #include "llmemory.h"
 
 #include <boost/preprocessor.hpp>
@@ -671,6 +672,12 @@ void LLImageBase::sanityCheck()
 // virtual
 void LLImageBase::deleteData()
 {
+    // <FS> Memory accounting
+    if (mData)
+    {
+        LLMemAccounting::disclaim(LLMemTag::TEXTURES, mData, mDataSize);
+    }
+    // </FS>
     ll_aligned_free_16(mData);
     mDataSize = 0;
     mData = NULL;
@@ -716,6 +723,12 @@ U8* LLImageBase::allocateData(S32 size)
             LL_WARNS() << "Failed to allocate image data size [" << size << "]" << LL_ENDL;
             mBadBufferAllocation = true;
         }
+        // <FS> Memory accounting
+        else
+        {
+            LLMemAccounting::claim(LLMemTag::TEXTURES, mData, size);
+        }
+        // </FS>
     }
 
     if (mBadBufferAllocation)
@@ -747,8 +760,10 @@ U8* LLImageBase::reallocateData(S32 size)
     {
         S32 bytes = llmin(mDataSize, size);
         memcpy(new_datap, mData, bytes);    /* Flawfinder: ignore */
+        LLMemAccounting::disclaim(LLMemTag::TEXTURES, mData, mDataSize); // <FS/> Memory accounting
         ll_aligned_free_16(mData) ;
     }
+    LLMemAccounting::claim(LLMemTag::TEXTURES, new_datap, size); // <FS/> Memory accounting
     mData = new_datap;
     mDataSize = size;
     mBadBufferAllocation = false;
@@ -1185,14 +1200,6 @@ void LLImageRaw::biasedScaleToPowerOfTwo(S32 max_dim)
     scale( new_width, new_height );
 }
 
-// static
-// Calculates (U8)(255*(a/255.f)*(b/255.f) + 0.5f).  Thanks, Jim Blinn!
-inline U8 LLImageRaw::fastFractionalMult( U8 a, U8 b )
-{
-    U32 i = a * b + 128;
-    return U8((i + (i>>8)) >> 8);
-}
-
 
 void LLImageRaw::composite( const LLImageRaw* src )
 {
@@ -1303,30 +1310,7 @@ void LLImageRaw::compositeUnscaled4onto3( const LLImageRaw* src )
         return;
     }
     // </FS:Beq>
-    while( pixels-- )
-    {
-        U8 alpha = src_data[3];
-        if( alpha )
-        {
-            if( 255 == alpha )
-            {
-                dst_data[0] = src_data[0];
-                dst_data[1] = src_data[1];
-                dst_data[2] = src_data[2];
-            }
-            else
-            {
-
-                U8 transparency = 255 - alpha;
-                dst_data[0] = fastFractionalMult( dst_data[0], transparency ) + fastFractionalMult( src_data[0], alpha );
-                dst_data[1] = fastFractionalMult( dst_data[1], transparency ) + fastFractionalMult( src_data[1], alpha );
-                dst_data[2] = fastFractionalMult( dst_data[2], transparency ) + fastFractionalMult( src_data[2], alpha );
-            }
-        }
-
-        src_data += 4;
-        dst_data += 3;
-    }
+    LLImageSIMD::compositeRGBAOntoRGB(src_data, dst_data, pixels);
 }
 
 
@@ -1764,6 +1748,12 @@ void LLImageRaw::copyLineScaled( const U8* in, U8* out, S32 in_pixel_len, S32 ou
     const S32 components = getComponents();
     llassert( components >= 1 && components <= 4 );
 
+    if (components == 4)
+    {
+        LLImageSIMD::scaleLineRGBA(in, out, in_pixel_len, out_pixel_len, in_pixel_step, out_pixel_step);
+        return;
+    }
+
     const F32 ratio = F32(in_pixel_len) / out_pixel_len; // ratio of old to new
     const F32 norm_factor = 1.f / ratio;
 
@@ -1878,96 +1868,11 @@ void LLImageRaw::compositeRowScaled4onto3( const U8* in, U8* out, S32 in_pixel_l
 {
     llassert( getComponents() == 3 );
 
-    const S32 IN_COMPONENTS = 4;
-    const S32 OUT_COMPONENTS = 3;
-
-    const F32 ratio = F32(in_pixel_len) / out_pixel_len; // ratio of old to new
-    const F32 norm_factor = 1.f / ratio;
-
-    for( S32 x = 0; x < out_pixel_len; x++ )
-    {
-        // Sample input pixels in range from sample0 to sample1.
-        // Avoid floating point accumulation error... don't just add ratio each time.  JC
-        const F32 sample0 = x * ratio;
-        const F32 sample1 = (x+1) * ratio;
-        const S32 index0 = S32(sample0);            // left integer (floor)
-        const S32 index1 = S32(sample1);            // right integer (floor)
-        const F32 fract0 = 1.f - (sample0 - F32(index0));   // spill over on left
-        const F32 fract1 = sample1 - F32(index1);           // spill-over on right
-
-        U8 in_scaled_r;
-        U8 in_scaled_g;
-        U8 in_scaled_b;
-        U8 in_scaled_a;
-
-        if( index0 == index1 )
-        {
-            // Interval is embedded in one input pixel
-            S32 t1 = index0 * IN_COMPONENTS;
-            in_scaled_r = in[t1 + 0];
-            in_scaled_g = in[t1 + 0];
-            in_scaled_b = in[t1 + 0];
-            in_scaled_a = in[t1 + 0];
-        }
-        else
-        {
-            // Left straddle
-            S32 t1 = index0 * IN_COMPONENTS;
-            F32 r = in[t1 + 0] * fract0;
-            F32 g = in[t1 + 1] * fract0;
-            F32 b = in[t1 + 2] * fract0;
-            F32 a = in[t1 + 3] * fract0;
-
-            // Central interval
-            for( S32 u = index0 + 1; u < index1; u++ )
-            {
-                S32 t2 = u * IN_COMPONENTS;
-                r += in[t2 + 0];
-                g += in[t2 + 1];
-                b += in[t2 + 2];
-                a += in[t2 + 3];
-            }
-
-            // right straddle
-            // Watch out for reading off of end of input array.
-            if( fract1 && index1 < in_pixel_len )
-            {
-                S32 t3 = index1 * IN_COMPONENTS;
-                r += in[t3 + 0] * fract1;
-                g += in[t3 + 1] * fract1;
-                b += in[t3 + 2] * fract1;
-                a += in[t3 + 3] * fract1;
-            }
-
-            r *= norm_factor;
-            g *= norm_factor;
-            b *= norm_factor;
-            a *= norm_factor;
-
-            in_scaled_r = U8(ll_round(r));
-            in_scaled_g = U8(ll_round(g));
-            in_scaled_b = U8(ll_round(b));
-            in_scaled_a = U8(ll_round(a));
-        }
-
-        if( in_scaled_a )
-        {
-            if( 255 == in_scaled_a )
-            {
-                out[0] = in_scaled_r;
-                out[1] = in_scaled_g;
-                out[2] = in_scaled_b;
-            }
-            else
-            {
-                U8 transparency = 255 - in_scaled_a;
-                out[0] = fastFractionalMult( out[0], transparency ) + fastFractionalMult( in_scaled_r, in_scaled_a );
-                out[1] = fastFractionalMult( out[1], transparency ) + fastFractionalMult( in_scaled_g, in_scaled_a );
-                out[2] = fastFractionalMult( out[2], transparency ) + fastFractionalMult( in_scaled_b, in_scaled_a );
-            }
-        }
-        out += OUT_COMPONENTS;
-    }
+    // Scale the row first, then blend it.  This used to do both per pixel
+    // and replicated the red channel when a pixel was not filtered.
+    std::vector<U8> scaled_row(out_pixel_len * 4);
+    LLImageSIMD::scaleLineRGBA( in, scaled_row.data(), in_pixel_len, out_pixel_len, 1, 1 );
+    LLImageSIMD::compositeRGBAOntoRGB( scaled_row.data(), out, out_pixel_len );
 }
 
 void LLImageRaw::addEmissive(LLImageRaw* src)
@@ -2617,6 +2522,17 @@ static void avg4_colors2(const U8* a, const U8* b, const U8* c, const U8* d, U8*
 void LLImageBase::setDataAndSize(U8 *data, S32 size)
 {
     ll_assert_aligned(data, 16);
+    // <FS> Memory accounting
+    // Takes over data, or hands the current data over to the caller
+    if (mData)
+    {
+        LLMemAccounting::disclaim(LLMemTag::TEXTURES, mData, mDataSize);
+    }
+    if (data)
+    {
+        LLMemAccounting::claim(LLMemTag::TEXTURES, data, size);
+    }
+    // </FS>
     mData = data;
     mDataSize = size;
 }
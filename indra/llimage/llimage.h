@@ -312,8 +312,6 @@ protected:
     void copyLineScaled( const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len, S32 in_pixel_step, S32 out_pixel_step );
     void compositeRowScaled4onto3( const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len );
 
-    static U8 fastFractionalMult(U8 a, U8 b);
-
     void setDataAndSize(U8 *data, S32 width, S32 height, S8 components) ;
 
 public:
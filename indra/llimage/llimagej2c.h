@@ -73,6 +73,10 @@ public:
     void setMaxBytes(S32 max_bytes);
     S32 getMaxBytes() const { return mMaxBytes; }
 
+    // Number of threads the decoder may use for this image
+    void setDecodeThreads(S32 threads) { mDecodeThreads = threads; }
+    S32 getDecodeThreads() const { return mDecodeThreads; }
+
     static S32 calcHeaderSizeJ2C();
     static S32 calcDataSizeJ2C(S32 w, S32 h, S32 comp, S32 discard_level, F32 rate = DEFAULT_COMPRESSION_RATE);
 
@@ -87,6 +91,7 @@ protected:
     void updateRawDiscardLevel();
 
     S32 mMaxBytes; // Maximum number of bytes of data to use...
+    S32 mDecodeThreads;
 
     S32 mDataSizes[MAX_DISCARD_LEVEL+1];        // Size of data required to reach a given level
     U32 mAreaUsedForDataSizeCalcs;              // Height * width used to calculate mDataSizes
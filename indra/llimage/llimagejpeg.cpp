@@ -31,7 +31,10 @@
 #include "llerror.h"
 #include "llexception.h"
 
-jmp_buf LLImageJPEG::sSetjmpBuffer ;
+// <FS> Snapshots are encoded on worker threads
+//jmp_buf LLImageJPEG::sSetjmpBuffer ;
+thread_local jmp_buf LLImageJPEG::sSetjmpBuffer ;
+// </FS>
 LLImageJPEG::LLImageJPEG(S32 quality)
 :   LLImageFormatted(IMG_CODEC_JPEG),
     mOutputBuffer( NULL ),
@@ -78,7 +78,10 @@ protected:
 
     S32             mEncodeQuality;     // on a scale from 1 to 100
 private:
-    static jmp_buf  sSetjmpBuffer;      // To allow the library to abort.
+    // <FS> Snapshots are encoded on worker threads
+    //static jmp_buf  sSetjmpBuffer;      // To allow the library to abort.
+    static thread_local jmp_buf sSetjmpBuffer;  // To allow the library to abort.
+    // </FS>
 };
 
 #endif  // LL_LLIMAGEJPEG_H
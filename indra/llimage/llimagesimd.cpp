@@ -0,0 +1,198 @@
+/**
+ * @file llimagesimd.cpp
+ * @brief SSE2 pixel kernels used by LLImageRaw.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llimagesimd.h"
+
+#include "llmath.h"
+
+#include <emmintrin.h>
+
+namespace
+{
+    // Calculates (U8)(255*(a/255.f)*(b/255.f) + 0.5f).  Thanks, Jim Blinn!
+    inline U8 fast_fractional_mult(U8 a, U8 b)
+    {
+        U32 i = a * b + 128;
+        return U8((i + (i >> 8)) >> 8);
+    }
+
+    // fast_fractional_mult() on eight 16 bit lanes holding 0-255 values.
+    // a * b + 128 + (i >> 8) peaks at 65407 so it never overflows a lane.
+    inline __m128i fast_fractional_mult(__m128i a, __m128i b)
+    {
+        __m128i i = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(i, _mm_srli_epi16(i, 8)), 8);
+    }
+
+    // Blend the two pixels in each 16 bit lane register
+    inline __m128i blend_pixels(__m128i src, __m128i dst)
+    {
+        const __m128i full = _mm_set1_epi16(255);
+        __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        return _mm_add_epi16(fast_fractional_mult(dst, _mm_sub_epi16(full, alpha)), fast_fractional_mult(src, alpha));
+    }
+
+    inline __m128 load_pixel(const U8* in)
+    {
+        S32 bits;
+        memcpy(&bits, in, 4);
+        const __m128i zero = _mm_setzero_si128();
+        __m128i pixel = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), zero);
+        return _mm_cvtepi32_ps(_mm_unpacklo_epi16(pixel, zero));
+    }
+
+    // ll_round() on the four channels, which are never negative here
+    inline void store_pixel(U8* out, __m128 pixel)
+    {
+        __m128i rounded = _mm_cvttps_epi32(_mm_add_ps(pixel, _mm_set1_ps(0.5f)));
+        rounded = _mm_packs_epi32(rounded, rounded);
+        S32 bits = _mm_cvtsi128_si32(_mm_packus_epi16(rounded, rounded));
+        memcpy(out, &bits, 4);
+    }
+}
+
+void LLImageSIMD::compositeRGBAOntoRGB(const U8* src, U8* dst, S32 pixels)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha_bits = _mm_set1_epi32((S32)0xff000000);
+    const __m128i rgb_mask = _mm_cvtsi32_si128(0x00ffffff);
+
+    // Four pixels at a time. dst is read 16 bytes at a time, so stop while
+    // there are at least two more pixels after the block.
+    for (; pixels >= 6; pixels -= 4, src += 16, dst += 12)
+    {
+        __m128i in = _mm_loadu_si128((const __m128i*)src);
+        __m128i alpha = _mm_and_si128(in, alpha_bits);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xffff)
+        {
+            // Fully transparent, leave dst alone
+            continue;
+        }
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alpha_bits)) == 0xffff)
+        {
+            // Fully opaque, just copy
+            for (S32 i = 0; i < 4; ++i)
+            {
+                memcpy(dst + i * 3, src + i * 4, 3);
+            }
+            continue;
+        }
+
+        // Spread the RGB pixels out to RGBx so they line up with src
+        __m128i packed = _mm_loadu_si128((const __m128i*)dst);
+        __m128i rgb = _mm_or_si128(_mm_or_si128(_mm_and_si128(packed, rgb_mask),
+                                                _mm_and_si128(_mm_slli_si128(packed, 1), _mm_slli_si128(rgb_mask, 4))),
+                                   _mm_or_si128(_mm_and_si128(_mm_slli_si128(packed, 2), _mm_slli_si128(rgb_mask, 8)),
+                                                _mm_and_si128(_mm_slli_si128(packed, 3), _mm_slli_si128(rgb_mask, 12))));
+
+        __m128i lo = blend_pixels(_mm_unpacklo_epi8(in, zero), _mm_unpacklo_epi8(rgb, zero));
+        __m128i hi = blend_pixels(_mm_unpackhi_epi8(in, zero), _mm_unpackhi_epi8(rgb, zero));
+        __m128i out = _mm_packus_epi16(lo, hi);
+
+        // And pack them back into 12 bytes
+        out = _mm_or_si128(_mm_or_si128(_mm_and_si128(out, rgb_mask),
+                                        _mm_srli_si128(_mm_and_si128(out, _mm_slli_si128(rgb_mask, 4)), 1)),
+                           _mm_or_si128(_mm_srli_si128(_mm_and_si128(out, _mm_slli_si128(rgb_mask, 8)), 2),
+                                        _mm_srli_si128(_mm_and_si128(out, _mm_slli_si128(rgb_mask, 12)), 3)));
+        _mm_storel_epi64((__m128i*)dst, out);
+        S32 last = _mm_cvtsi128_si32(_mm_srli_si128(out, 8));
+        memcpy(dst + 8, &last, 4);
+    }
+
+    // Left over pixels
+    for (; pixels > 0; --pixels, src += 4, dst += 3)
+    {
+        U8 alpha = src[3];
+        if (alpha)
+        {
+            if (255 == alpha)
+            {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+            }
+            else
+            {
+                U8 transparency = 255 - alpha;
+                dst[0] = fast_fractional_mult(dst[0], transparency) + fast_fractional_mult(src[0], alpha);
+                dst[1] = fast_fractional_mult(dst[1], transparency) + fast_fractional_mult(src[1], alpha);
+                dst[2] = fast_fractional_mult(dst[2], transparency) + fast_fractional_mult(src[2], alpha);
+            }
+        }
+    }
+}
+
+void LLImageSIMD::scaleLineRGBA(const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len, S32 in_pixel_step, S32 out_pixel_step)
+{
+    const S32 COMPONENTS = 4;
+
+    const F32 ratio = F32(in_pixel_len) / out_pixel_len; // ratio of old to new
+    const __m128 norm_factor = _mm_set1_ps(1.f / ratio);
+
+    const S32 in_stride = in_pixel_step * COMPONENTS;
+    const S32 out_stride = out_pixel_step * COMPONENTS;
+
+    for (S32 x = 0; x < out_pixel_len; x++)
+    {
+        // Same sampling as LLImageRaw::copyLineScaled(), with the four
+        // channels accumulated in one register in the same order.
+        const F32 sample0 = x * ratio;
+        const F32 sample1 = (x + 1) * ratio;
+        const S32 index0 = llfloor(sample0);
+        const S32 index1 = llfloor(sample1);
+        const F32 fract0 = 1.f - (sample0 - F32(index0));
+        const F32 fract1 = sample1 - F32(index1);
+
+        U8* outp = out + x * out_stride;
+        if (index0 == index1)
+        {
+            // Interval is embedded in one input pixel
+            memcpy(outp, in + index0 * in_stride, COMPONENTS);
+            continue;
+        }
+
+        // Left straddle
+        __m128 sum = _mm_mul_ps(load_pixel(in + index0 * in_stride), _mm_set1_ps(fract0));
+
+        // Central interval
+        const U8* inp = in + (index0 + 1) * in_stride;
+        for (S32 u = index0 + 1; u < index1; u++, inp += in_stride)
+        {
+            sum = _mm_add_ps(sum, load_pixel(inp));
+        }
+
+        // Right straddle, watch out for reading off of end of input array.
+        if (fract1 && index1 < in_pixel_len)
+        {
+            sum = _mm_add_ps(sum, _mm_mul_ps(load_pixel(in + index1 * in_stride), _mm_set1_ps(fract1)));
+        }
+
+        store_pixel(outp, _mm_mul_ps(sum, norm_factor));
+    }
+}
@@ -0,0 +1,46 @@
+/**
+ * @file llimagesimd.h
+ * @brief SSE2 pixel kernels used by LLImageRaw.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLIMAGESIMD_H
+#define LL_LLIMAGESIMD_H
+
+#include "stdtypes.h"
+
+// The viewer requires SSE2 (see llsimdmath.h), so these kernels need no
+// runtime dispatch. AVX builds get the VEX encoded forms from the compiler.
+// Results are bit for bit the same as the scalar code they replace.
+namespace LLImageSIMD
+{
+    // Blend the RGBA pixels of src over the RGB pixels of dst, as
+    // LLImageRaw::compositeUnscaled4onto3() does.
+    void compositeRGBAOntoRGB(const U8* src, U8* dst, S32 pixels);
+
+    // Box filter a line of RGBA pixels, see LLImageRaw::copyLineScaled().
+    // Steps are in pixels, so lines can be rows or columns.
+    void scaleLineRGBA(const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len, S32 in_pixel_step, S32 out_pixel_step);
+}
+
+#endif // LL_LLIMAGESIMD_H
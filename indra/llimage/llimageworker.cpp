@@ -28,8 +28,31 @@
 
 #include "llimageworker.h"
 #include "llimagedxt.h"
+#include "llimagej2c.h"
 #include "threadpool.h"
 
+#include <thread>
+
+// Images decoding to at least this many pixels may use the idle decode
+// threads too, once the decode queue has drained
+static const S32 MULTI_THREAD_DECODE_MIN_PIXELS = 1024 * 1024;
+static const S32 MAX_DECODE_THREADS_PER_IMAGE = 4;
+
+// Cores left once the main thread, the other thread pools ("General",
+// "Mesh"...) and the busy threads of the decode pool have theirs
+static S32 unclaimed_cores(const LL::ThreadPoolBase* decode_pool, S32 active_decodes)
+{
+    S32 claimed = 1 + active_decodes;
+    for (auto& pool : LL::ThreadPoolBase::instance_snapshot())
+    {
+        if (&pool != decode_pool)
+        {
+            claimed += (S32)pool.getWidth();
+        }
+    }
+    return (S32)std::thread::hardware_concurrency() - claimed;
+}
+
 /*--------------------------------------------------------------------------*/
 class ImageRequest
 {
@@ -38,10 +61,11 @@ public:
                  S32 discard,
                  bool needs_aux,
                  const LLPointer<LLImageDecodeThread::Responder>& responder,
+                 const LLImageDecodeThread::lookup_t& lookup,
                  U32 request_id);
     virtual ~ImageRequest();
 
-    /*virtual*/ bool processRequest();
+    /*virtual*/ bool processRequest(S32 spare_threads = 0);
     /*virtual*/ void finishRequest(bool completed);
 
 private:
@@ -58,6 +82,7 @@ private:
     bool mDecodedRaw;
     bool mDecodedAux;
     LLPointer<LLImageDecodeThread::Responder> mResponder;
+    LLImageDecodeThread::lookup_t mLookup;
     std::string mErrorString;};
 
 
@@ -65,7 +90,8 @@ private:
 
 // MAIN THREAD
 LLImageDecodeThread::LLImageDecodeThread(bool /*threaded*/)
-    : mDecodeCount(0)
+    : mDecodeCount(0),
+      mActiveDecodes(0)
 {
     mThreadPool.reset(new LL::ThreadPool("ImageDecode", 8));
     mThreadPool->start();
@@ -85,14 +111,67 @@ size_t LLImageDecodeThread::update(F32 max_time_ms)
 
 size_t LLImageDecodeThread::getPending()
 {
-    return mThreadPool->getQueue().size();
+    std::lock_guard<std::mutex> lock(mPendingMutex);
+    return mPending.size();
+}
+
+bool LLImageDecodeThread::setPriority(handle_t handle, F32 priority)
+{
+    std::lock_guard<std::mutex> lock(mPendingMutex);
+    auto it = mPending.find(handle);
+    if (it == mPending.end())
+    {
+        return false;
+    }
+    if (it->second.mPriority != priority)
+    {
+        mPendingOrder.erase(std::make_pair(-it->second.mPriority, handle));
+        mPendingOrder.emplace(-priority, handle);
+        it->second.mPriority = priority;
+    }
+    return true;
+}
+
+bool LLImageDecodeThread::cancel(handle_t handle)
+{
+    std::unique_ptr<ImageRequest> req;
+    {
+        std::lock_guard<std::mutex> lock(mPendingMutex);
+        auto it = mPending.find(handle);
+        if (it == mPending.end())
+        {
+            return false;
+        }
+        mPendingOrder.erase(std::make_pair(-it->second.mPriority, handle));
+        req = std::move(it->second.mRequest);
+        mPending.erase(it);
+    }
+    // The responder is not called, the request goes away here
+    return true;
+}
+
+std::unique_ptr<ImageRequest> LLImageDecodeThread::popRequest()
+{
+    std::lock_guard<std::mutex> lock(mPendingMutex);
+    if (mPendingOrder.empty())
+    {
+        return nullptr;
+    }
+    const handle_t handle = mPendingOrder.begin()->second;
+    mPendingOrder.erase(mPendingOrder.begin());
+    auto it = mPending.find(handle);
+    std::unique_ptr<ImageRequest> req = std::move(it->second.mRequest);
+    mPending.erase(it);
+    return req;
 }
 
 LLImageDecodeThread::handle_t LLImageDecodeThread::decodeImage(
     const LLPointer<LLImageFormatted>& image,
     S32 discard,
     bool needs_aux,
-    const LLPointer<LLImageDecodeThread::Responder>& responder)
+    const LLPointer<LLImageDecodeThread::Responder>& responder,
+    const lookup_t& lookup,
+    F32 priority)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
 
@@ -100,16 +179,36 @@ LLImageDecodeThread::handle_t LLImageDecodeThread::decodeImage(
     if (decode_id == 0)
         decode_id = ++mDecodeCount;
 
-    // Instantiate the ImageRequest right in the lambda, why not?
+    {
+        std::lock_guard<std::mutex> lock(mPendingMutex);
+        mPending[decode_id] = { priority, std::make_unique<ImageRequest>(image, discard, needs_aux, responder, lookup, decode_id) };
+        mPendingOrder.emplace(-priority, decode_id);
+    }
+
+    // The pool queue stays first in first out, each work item it runs
+    // decodes whatever pending request has the highest priority by then
     bool posted = mThreadPool->getQueue().post(
-        [req = ImageRequest(image, discard, needs_aux, responder, decode_id)]
-        () mutable
+        [this]()
         {
-            auto done = req.processRequest();
-            req.finishRequest(done);
+            std::unique_ptr<ImageRequest> req = popRequest();
+            if (!req)
+            {
+                return; // cancelled
+            }
+            // Pool threads that have nothing else to do can help with this image
+            S32 active = (S32)++mActiveDecodes;
+            S32 spare_threads = (S32)mThreadPool->getWidth() - active - (S32)getPending();
+            if (spare_threads > 0)
+            { // but not more than there are cores nobody else counts on
+                spare_threads = llmin(spare_threads, unclaimed_cores(mThreadPool.get(), active));
+            }
+            auto done = req->processRequest(spare_threads);
+            req->finishRequest(done);
+            --mActiveDecodes;
         });
     if (! posted)
     {
+        cancel(decode_id);
         LL_DEBUGS() << "Tried to start decoding on shutdown" << LL_ENDL;
         return 0;
     }
@@ -132,6 +231,7 @@ ImageRequest::ImageRequest(const LLPointer<LLImageFormatted>& image,
                            S32 discard,
                            bool needs_aux,
                            const LLPointer<LLImageDecodeThread::Responder>& responder,
+                           const LLImageDecodeThread::lookup_t& lookup,
                            U32 request_id)
     : mFormattedImage(image),
       mDiscardLevel(discard),
@@ -139,6 +239,7 @@ ImageRequest::ImageRequest(const LLPointer<LLImageFormatted>& image,
       mDecodedRaw(false),
       mDecodedAux(false),
       mResponder(responder),
+      mLookup(lookup),
       mRequestId(request_id)
 {
 }
@@ -154,7 +255,7 @@ ImageRequest::~ImageRequest()
 
 
 // Returns true when done, whether or not decode was successful.
-bool ImageRequest::processRequest()
+bool ImageRequest::processRequest(S32 spare_threads)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
 
@@ -186,6 +287,28 @@ bool ImageRequest::processRequest()
             {
                 mFormattedImage->setDiscardLevel(mDiscardLevel);
             }
+            if (mFormattedImage->getCodec() == IMG_CODEC_J2C)
+            {
+                S32 threads = 1;
+                S32 discard = llmax(mFormattedImage->getDiscardLevel(), 0);
+                if (spare_threads > 0 &&
+                    (mFormattedImage->getWidth() >> discard) * (mFormattedImage->getHeight() >> discard) >= MULTI_THREAD_DECODE_MIN_PIXELS)
+                {
+                    threads = llmin(spare_threads + 1, MAX_DECODE_THREADS_PER_IMAGE);
+                }
+                ((LLImageJ2C*)mFormattedImage.get())->setDecodeThreads(threads);
+            }
+            if (mLookup && !mNeedsAux)
+            {
+                LLPointer<LLImageRaw> raw = mLookup(mFormattedImage);
+                if (raw.notNull())
+                {
+                    // Already decoded elsewhere
+                    mDecodedImageRaw = raw;
+                    mDecodedRaw = true;
+                    return true;
+                }
+            }
             mDecodedImageRaw = new LLImageRaw(mFormattedImage->getWidth(),
                                               mFormattedImage->getHeight(),
                                               mFormattedImage->getComponents());
@@ -30,6 +30,13 @@
 #include "llimage.h"
 #include "llpointer.h"
 #include "threadpool_fwd.h"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+class ImageRequest;
 
 class LLImageDecodeThread
 {
@@ -46,22 +53,50 @@ public:
     LLImageDecodeThread(bool threaded = true);
     virtual ~LLImageDecodeThread();
 
+    // Called on the decode thread once the image header was parsed and the
+    // discard level set. May return an already decoded image for that
+    // discard level, in which case the image is not decoded again.
+    typedef std::function<LLPointer<LLImageRaw>(const LLImageFormatted* image)> lookup_t;
+
     // meant to resemble LLQueuedThread::handle_t
     typedef U32 handle_t;
     handle_t decodeImage(const LLPointer<LLImageFormatted>& image,
                          S32 discard, bool needs_aux,
-                         const LLPointer<Responder>& responder);
+                         const LLPointer<Responder>& responder,
+                         const lookup_t& lookup = lookup_t(),
+                         F32 priority = 0.f);
+    // Decodes that have not started yet run highest priority first, oldest
+    // first for equal priorities. These return false once the decode started.
+    bool setPriority(handle_t handle, F32 priority);
+    bool cancel(handle_t handle);
     size_t getPending();
     size_t update(F32 max_time_ms);
     S32 getTotalDecodeCount() { return mDecodeCount; }
     void shutdown();
 
 private:
+    // Takes the highest priority request off the pending ones, null when
+    // everything was cancelled
+    std::unique_ptr<ImageRequest> popRequest();
+
+    struct PendingRequest
+    {
+        F32 mPriority;
+        std::unique_ptr<ImageRequest> mRequest;
+    };
+    // (-priority, handle), so begin() is the next one to decode
+    typedef std::set<std::pair<F32, handle_t> > priority_set_t;
+
+    std::mutex mPendingMutex;
+    std::unordered_map<handle_t, PendingRequest> mPending;
+    priority_set_t mPendingOrder;
+
     // As of SL-17483, LLImageDecodeThread is no longer itself an
     // LLQueuedThread - instead this is the API by which we submit work to the
     // "ImageDecode" ThreadPool.
     std::unique_ptr<LL::ThreadPool> mThreadPool;
     LLAtomicU32 mDecodeCount;
+    LLAtomicU32 mActiveDecodes;
 };
 
 #endif
@@ -0,0 +1,201 @@
+/**
+ * @file llimagesimd_test.cpp
+ * @brief Test the SSE2 pixel kernels against the scalar code they replace
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+// Class to test
+#include "../llimagesimd.h"
+#include "llmath.h"
+// Tut header
+#include "../test/lltut.h"
+
+#include <string>
+#include <vector>
+
+// -------------------------------------------------------------------------------------------
+// Reference implementations: the scalar loops from LLImageRaw the kernels replaced
+// -------------------------------------------------------------------------------------------
+
+namespace
+{
+    U8 ref_fractional_mult(U8 a, U8 b)
+    {
+        U32 i = a * b + 128;
+        return U8((i + (i >> 8)) >> 8);
+    }
+
+    void ref_composite(const U8* src, U8* dst, S32 pixels)
+    {
+        while (pixels--)
+        {
+            U8 alpha = src[3];
+            if (alpha)
+            {
+                if (255 == alpha)
+                {
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                    dst[2] = src[2];
+                }
+                else
+                {
+                    U8 transparency = 255 - alpha;
+                    dst[0] = ref_fractional_mult(dst[0], transparency) + ref_fractional_mult(src[0], alpha);
+                    dst[1] = ref_fractional_mult(dst[1], transparency) + ref_fractional_mult(src[1], alpha);
+                    dst[2] = ref_fractional_mult(dst[2], transparency) + ref_fractional_mult(src[2], alpha);
+                }
+            }
+            src += 4;
+            dst += 3;
+        }
+    }
+
+    void ref_scale_line(const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len, S32 in_pixel_step, S32 out_pixel_step)
+    {
+        const S32 components = 4;
+        const F32 ratio = F32(in_pixel_len) / out_pixel_len;
+        const F32 norm_factor = 1.f / ratio;
+
+        for (S32 x = 0; x < out_pixel_len; x++)
+        {
+            const F32 sample0 = x * ratio;
+            const F32 sample1 = (x + 1) * ratio;
+            const S32 index0 = llfloor(sample0);
+            const S32 index1 = llfloor(sample1);
+            const F32 fract0 = 1.f - (sample0 - F32(index0));
+            const F32 fract1 = sample1 - F32(index1);
+
+            S32 t0 = x * out_pixel_step * components;
+            if (index0 == index1)
+            {
+                S32 t1 = index0 * in_pixel_step * components;
+                for (S32 i = 0; i < components; ++i)
+                {
+                    out[t0 + i] = in[t1 + i];
+                }
+                continue;
+            }
+
+            F32 sum[components];
+            S32 t1 = index0 * in_pixel_step * components;
+            for (S32 i = 0; i < components; ++i)
+            {
+                sum[i] = in[t1 + i] * fract0;
+            }
+            for (S32 u = index0 + 1; u < index1; u++)
+            {
+                S32 t2 = u * in_pixel_step * components;
+                for (S32 i = 0; i < components; ++i)
+                {
+                    sum[i] += in[t2 + i];
+                }
+            }
+            if (fract1 && index1 < in_pixel_len)
+            {
+                S32 t3 = index1 * in_pixel_step * components;
+                for (S32 i = 0; i < components; ++i)
+                {
+                    sum[i] += in[t3 + i] * fract1;
+                }
+            }
+            for (S32 i = 0; i < components; ++i)
+            {
+                out[t0 + i] = U8(ll_round(sum[i] * norm_factor));
+            }
+        }
+    }
+
+    // Random pixels with runs of fully opaque and fully transparent ones,
+    // like the bakes and UI images that get composited.
+    void fill_pixels(std::vector<U8>& data, U32 seed)
+    {
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            seed = seed * 1664525 + 1013904223;
+            data[i] = U8(seed >> 24);
+        }
+        for (size_t i = 3; i + 4 * 64 < data.size(); i += 4 * 256)
+        {
+            for (size_t j = 0; j < 64; ++j)
+            {
+                data[i + j * 4] = (i / (4 * 256)) % 2 ? 255 : 0;
+            }
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------
+// TUT
+// -------------------------------------------------------------------------------------------
+
+namespace tut
+{
+    struct imagesimd_test
+    {
+    };
+
+    typedef test_group<imagesimd_test> imagesimd_t;
+    typedef imagesimd_t::object imagesimd_object_t;
+    tut::imagesimd_t tut_imagesimd("LLImageSIMD");
+
+    template<> template<>
+    void imagesimd_object_t::test<1>()
+    {
+        // Composite matches the scalar blend, including the odd pixels at the end
+        const S32 pixels = 4099;
+        std::vector<U8> src(pixels * 4);
+        std::vector<U8> dst(pixels * 3);
+        fill_pixels(src, 1);
+        fill_pixels(dst, 2);
+        std::vector<U8> expected(dst);
+
+        ref_composite(src.data(), expected.data(), pixels);
+        LLImageSIMD::compositeRGBAOntoRGB(src.data(), dst.data(), pixels);
+        ensure("composite matches scalar", dst == expected);
+    }
+
+    template<> template<>
+    void imagesimd_object_t::test<2>()
+    {
+        // Scaling rows and columns, down and up, matches the scalar box filter
+        const S32 sizes[][2] = { { 1024, 333 }, { 512, 256 }, { 7, 3 }, { 100, 100 }, { 64, 200 }, { 5, 1 } };
+        for (const auto& size : sizes)
+        {
+            const S32 in_len = size[0];
+            const S32 out_len = size[1];
+            for (S32 step = 1; step <= 3; step += 2)
+            {
+                std::vector<U8> in(in_len * step * 4);
+                fill_pixels(in, in_len);
+                std::vector<U8> out(out_len * step * 4, 0);
+                std::vector<U8> expected(out);
+
+                ref_scale_line(in.data(), expected.data(), in_len, out_len, step, step);
+                LLImageSIMD::scaleLineRGBA(in.data(), out.data(), in_len, out_len, step, step);
+                ensure("scaled line matches scalar " + std::to_string(in_len) + "->" + std::to_string(out_len) + " step " + std::to_string(step), out == expected);
+            }
+        }
+    }
+}
@@ -166,4 +166,31 @@ namespace tut
         // Verifies that the responder has now been called
         ensure("LLImageDecodeThread: threaded work unit not processed", done == true);
     }
+
+    template<> template<>
+    void imagedecodethread_object_t::test<2>()
+    {
+        // Cancel and reprioritize requests
+        mThread = new LLImageDecodeThread(true);
+        ensure("LLImageDecodeThread: cancel() of an unknown handle", !mThread->cancel(12345));
+        ensure("LLImageDecodeThread: setPriority() of an unknown handle", !mThread->setPriority(12345, 1.f));
+
+        bool done = false;
+        LLImageDecodeThread::handle_t decodeHandle = mThread->decodeImage(NULL, 0, false, new responder_test(&done), LLImageDecodeThread::lookup_t(), 1.f);
+        ensure("LLImageDecodeThread: decodeImage() with priority, returned handle is null", decodeHandle != 0);
+        mThread->setPriority(decodeHandle, 2.f);
+        // The pool may have started it already, then it completes as usual
+        bool cancelled = mThread->cancel(decodeHandle);
+        const U32 INCREMENT_TIME = 500;
+        const U32 MAX_TIME = 20 * INCREMENT_TIME;
+        U32 total_time = 0;
+        while (!cancelled && !done && (total_time < MAX_TIME))
+        {
+            ms_sleep(INCREMENT_TIME);
+            total_time += INCREMENT_TIME;
+        }
+        ensure("LLImageDecodeThread: cancelled request completed, or started request not completed", done != cancelled);
+        ensure("LLImageDecodeThread: request cancelled twice", !mThread->cancel(decodeHandle));
+        ensure_equals("LLImageDecodeThread: requests left pending", mThread->getPending(), (size_t)0);
+    }
 }
@@ -336,13 +336,19 @@ public:
         return true;
     }
 
-    bool decode(U8* data, U32 dataSize, U32* channels, U8 discard_level)
+    bool decode(U8* data, U32 dataSize, U32* channels, U8 discard_level, S32 threads = 1)
     {
         parameters.flags &= ~OPJ_DPARAMETERS_DUMP_FLAG;
 
         decoder = opj_create_decompress(OPJ_CODEC_J2K);
         opj_setup_decoder(decoder, &parameters);
 
+        if (threads > 1)
+        {
+            // decode code blocks in parallel, fails harmlessly if OpenJPEG was built without threads
+            opj_codec_set_threads(decoder, threads);
+        }
+
         opj_set_info_handler(decoder, opj_info, this);
         opj_set_warning_handler(decoder, opj_warn, this);
         opj_set_error_handler(decoder, opj_error, this);
@@ -828,7 +834,7 @@ bool LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
     U32 image_channels = 0;
     S32 data_size = base.getDataSize();
     S32 max_bytes = (base.getMaxBytes() ? base.getMaxBytes() : data_size);
-    bool decoded = decoder.decode(base.getData(), max_bytes, &image_channels, base.mDiscardLevel);
+    bool decoded = decoder.decode(base.getData(), max_bytes, &image_channels, base.mDiscardLevel, base.getDecodeThreads());
 
     // set correct channel count early so failed decodes don't miss it...
     S32 channels = (S32)image_channels - first_channel;
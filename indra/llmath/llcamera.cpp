@@ -28,6 +28,21 @@
 
 #include "llmath.h"
 #include "llcamera.h"
+#include "llvolumesimd.h" // <FS/> Batched culling
+
+// <FS> Batched culling
+#if LL_X86
+#include <immintrin.h>
+
+// Only AVX is needed, and leaving FMA out keeps gcc from fusing the plane
+// distances so the batch stays bit for bit with AABBInFrustum().
+#if LL_MSVC
+#define LL_TARGET_AVX2
+#else
+#define LL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif // LL_X86
+// </FS>
 
 // ---------------- Constructors and destructors ----------------
 
@@ -296,6 +311,205 @@ S32 LLCamera::AABBInRegionFrustumNoFarClip(const LLVector4a& center, const LLVec
     return AABBInFrustumNoFarClip(center, radius, mRegionPlanes);
 }
 
+// <FS> Batched culling
+namespace
+{
+    // A plane in the form the batch kernels splat from: the normal, the
+    // sFrustumScaler signs picking the box corner and -d
+    struct CullPlane
+    {
+        F32 mNormal[3];
+        F32 mSign[3];
+        F32 mDist;
+    };
+
+    // Up to width floats of one axis, the rest of a short tail zeroed
+    inline void load_tail(F32* dst, const F32* src, S32 n, S32 width)
+    {
+        for (S32 i = 0; i < width; ++i)
+        {
+            dst[i] = i < n ? src[i] : 0.f;
+        }
+    }
+
+    // 0 where any box is all outside, else 1 where any box is partly in, else 2
+    inline void store_results(S32* results, S32 n, S32 outside, S32 partial)
+    {
+        for (S32 i = 0; i < n; ++i)
+        {
+            results[i] = (outside >> i) & 1 ? 0 : ((partial >> i) & 1 ? 1 : 2);
+        }
+    }
+
+    // Same operations in the same order as AABBInFrustum(): the corner is
+    // center -/+ radius * sign and the dot product sums x and y before z
+    void cull_boxes_sse2(const CullPlane* planes, U32 num_planes,
+                         const F32* const center[3], const F32* const radius[3], S32 count, S32* results)
+    {
+        for (S32 i = 0; i < count; i += 4)
+        {
+            const S32 n = llmin(count - i, 4);
+            LLQuad c[3], r[3];
+            for (S32 axis = 0; axis < 3; ++axis)
+            {
+                if (n == 4)
+                {
+                    c[axis] = _mm_loadu_ps(center[axis] + i);
+                    r[axis] = _mm_loadu_ps(radius[axis] + i);
+                }
+                else
+                {
+                    LL_ALIGN_16(F32 tmp[4]);
+                    load_tail(tmp, center[axis] + i, n, 4);
+                    c[axis] = _mm_load_ps(tmp);
+                    load_tail(tmp, radius[axis] + i, n, 4);
+                    r[axis] = _mm_load_ps(tmp);
+                }
+            }
+
+            LLQuad outside = _mm_setzero_ps();
+            LLQuad partial = _mm_setzero_ps();
+            for (U32 p = 0; p < num_planes; ++p)
+            {
+                const CullPlane& plane = planes[p];
+                LLQuad dmin = _mm_setzero_ps();
+                LLQuad dmax = _mm_setzero_ps();
+                for (S32 axis = 0; axis < 3; ++axis)
+                {
+                    const LLQuad normal = _mm_set1_ps(plane.mNormal[axis]);
+                    const LLQuad rscale = _mm_mul_ps(r[axis], _mm_set1_ps(plane.mSign[axis]));
+                    const LLQuad lo = _mm_mul_ps(normal, _mm_sub_ps(c[axis], rscale));
+                    const LLQuad hi = _mm_mul_ps(normal, _mm_add_ps(c[axis], rscale));
+                    dmin = axis ? _mm_add_ps(dmin, lo) : lo;
+                    dmax = axis ? _mm_add_ps(dmax, hi) : hi;
+                }
+                const LLQuad dist = _mm_set1_ps(plane.mDist);
+                outside = _mm_or_ps(outside, _mm_cmpgt_ps(dmin, dist));
+                partial = _mm_or_ps(partial, _mm_cmpgt_ps(dmax, dist));
+                if (_mm_movemask_ps(outside) == 0xf)
+                {
+                    break;
+                }
+            }
+
+            store_results(results + i, n, _mm_movemask_ps(outside), _mm_movemask_ps(partial));
+        }
+    }
+
+#if LL_X86
+    LL_TARGET_AVX2 void cull_boxes_avx2(const CullPlane* planes, U32 num_planes,
+                                        const F32* const center[3], const F32* const radius[3], S32 count, S32* results)
+    {
+        for (S32 i = 0; i < count; i += 8)
+        {
+            const S32 n = llmin(count - i, 8);
+            __m256 c[3], r[3];
+            for (S32 axis = 0; axis < 3; ++axis)
+            {
+                if (n == 8)
+                {
+                    c[axis] = _mm256_loadu_ps(center[axis] + i);
+                    r[axis] = _mm256_loadu_ps(radius[axis] + i);
+                }
+                else
+                {
+                    F32 tmp[8];
+                    load_tail(tmp, center[axis] + i, n, 8);
+                    c[axis] = _mm256_loadu_ps(tmp);
+                    load_tail(tmp, radius[axis] + i, n, 8);
+                    r[axis] = _mm256_loadu_ps(tmp);
+                }
+            }
+
+            __m256 outside = _mm256_setzero_ps();
+            __m256 partial = _mm256_setzero_ps();
+            for (U32 p = 0; p < num_planes; ++p)
+            {
+                const CullPlane& plane = planes[p];
+                __m256 dmin = _mm256_setzero_ps();
+                __m256 dmax = _mm256_setzero_ps();
+                for (S32 axis = 0; axis < 3; ++axis)
+                {
+                    const __m256 normal = _mm256_set1_ps(plane.mNormal[axis]);
+                    const __m256 rscale = _mm256_mul_ps(r[axis], _mm256_set1_ps(plane.mSign[axis]));
+                    const __m256 lo = _mm256_mul_ps(normal, _mm256_sub_ps(c[axis], rscale));
+                    const __m256 hi = _mm256_mul_ps(normal, _mm256_add_ps(c[axis], rscale));
+                    dmin = axis ? _mm256_add_ps(dmin, lo) : lo;
+                    dmax = axis ? _mm256_add_ps(dmax, hi) : hi;
+                }
+                const __m256 dist = _mm256_set1_ps(plane.mDist);
+                outside = _mm256_or_ps(outside, _mm256_cmp_ps(dmin, dist, _CMP_GT_OQ));
+                partial = _mm256_or_ps(partial, _mm256_cmp_ps(dmax, dist, _CMP_GT_OQ));
+                if (_mm256_movemask_ps(outside) == 0xff)
+                {
+                    break;
+                }
+            }
+
+            store_results(results + i, n, _mm256_movemask_ps(outside), _mm256_movemask_ps(partial));
+        }
+    }
+#endif // LL_X86
+}
+
+void LLCamera::batchAABBInFrustum(const F32* const center[3], const F32* const radius[3], S32 count, S32* results,
+                                  const LLPlane* planes, bool far_clip)
+{
+    if (!planes)
+    {
+        //use agent space
+        planes = mAgentPlanes;
+    }
+
+    CullPlane cull_planes[AGENT_PLANE_USER_CLIP_NUM];
+    U32 num_planes = 0;
+    U32 max_planes = llmin(mPlaneCount, (U32) AGENT_PLANE_USER_CLIP_NUM);
+    for (U32 i = 0; i < max_planes; i++)
+    {
+        U8 mask = mPlaneMask[i];
+        if ((far_clip || i != 5) && (mask < PLANE_MASK_NUM))
+        {
+            CullPlane& plane = cull_planes[num_planes++];
+            for (S32 axis = 0; axis < 3; ++axis)
+            {
+                plane.mNormal[axis] = planes[i][axis];
+                plane.mSign[axis] = sFrustumScaler[mask][axis];
+            }
+            plane.mDist = -planes[i][3];
+        }
+    }
+
+#if LL_X86
+    if (LLVolumeSIMD::useAVX2())
+    {
+        cull_boxes_avx2(cull_planes, num_planes, center, radius, count, results);
+        return;
+    }
+#endif
+    cull_boxes_sse2(cull_planes, num_planes, center, radius, count, results);
+}
+
+void LLCamera::AABBInFrustumBatch(const F32* const center[3], const F32* const radius[3], S32 count, S32* results, const LLPlane* planes)
+{
+    batchAABBInFrustum(center, radius, count, results, planes, true);
+}
+
+void LLCamera::AABBInRegionFrustumBatch(const F32* const center[3], const F32* const radius[3], S32 count, S32* results)
+{
+    batchAABBInFrustum(center, radius, count, results, mRegionPlanes, true);
+}
+
+void LLCamera::AABBInFrustumNoFarClipBatch(const F32* const center[3], const F32* const radius[3], S32 count, S32* results, const LLPlane* planes)
+{
+    batchAABBInFrustum(center, radius, count, results, planes, false);
+}
+
+void LLCamera::AABBInRegionFrustumNoFarClipBatch(const F32* const center[3], const F32* const radius[3], S32 count, S32* results)
+{
+    batchAABBInFrustum(center, radius, count, results, mRegionPlanes, false);
+}
+// </FS>
+
 int LLCamera::sphereInFrustumQuick(const LLVector3 &sphere_center, const F32 radius)
 {
     LLVector3 dist = sphere_center-mFrustCenter;
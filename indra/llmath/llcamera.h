@@ -202,6 +202,16 @@ public:
     S32 AABBInFrustumNoFarClip(const LLVector4a& center, const LLVector4a& radius, const LLPlane* planes = NULL);
     S32 AABBInRegionFrustumNoFarClip(const LLVector4a& center, const LLVector4a& radius);
 
+    // <FS> Batched AABBInFrustum*() for count boxes laid out as structure of
+    // arrays, center[axis][i] and radius[axis][i]. results[i] is what the
+    // single box call returns for box i. Boxes are tested four at a time
+    // against each plane, eight at a time on CPUs with AVX2.
+    void AABBInFrustumBatch(const F32* const center[3], const F32* const radius[3], S32 count, S32* results, const LLPlane* planes = NULL);
+    void AABBInRegionFrustumBatch(const F32* const center[3], const F32* const radius[3], S32 count, S32* results);
+    void AABBInFrustumNoFarClipBatch(const F32* const center[3], const F32* const radius[3], S32 count, S32* results, const LLPlane* planes = NULL);
+    void AABBInRegionFrustumNoFarClipBatch(const F32* const center[3], const F32* const radius[3], S32 count, S32* results);
+    // </FS>
+
     //does a quick 'n dirty sphere-sphere check
     S32 sphereInFrustumQuick(const LLVector3 &sphere_center, const F32 radius);
 
@@ -218,6 +228,7 @@ protected:
     void calculateFrustumPlanes();
     void calculateFrustumPlanes(F32 left, F32 right, F32 top, F32 bottom);
     void calculateFrustumPlanesFromWindow(F32 x1, F32 y1, F32 x2, F32 y2);
+    void batchAABBInFrustum(const F32* const center[3], const F32* const radius[3], S32 count, S32* results, const LLPlane* planes, bool far_clip); // <FS/> Batched culling
 } LL_ALIGN_POSTFIX(16);
 
 
@@ -52,6 +52,8 @@
 #include "llmeshoptimizer.h"
 #include "lltimer.h"
 #include "llvolumeoctree.h"
+#include "llvolumesimd.h" // <FS/> Vertex stream kernels
+#include "llvolumebvh.h" // <FS/> Flat picking hierarchy
 
 #include "mikktspace/mikktspace.hh"
 
@@ -1987,6 +1989,16 @@ LLVolume::LLVolume(const LLVolumeParams &params, const F32 detail, const bool ge
     mNumHullPoints = 0;
     mNumHullIndices = 0;
 
+    // <FS> Shared prim tessellation
+    // Flexible paths are animated and sculpts regenerate both in sculpt(), the
+    // rest take their profile and path from LLVolumeMgr in generate()
+    U8 sculpt_type = mParams.getSculptType() & LL_SCULPT_TYPE_MASK;
+    mSharedShape = LLVolumeMgr::sShareTessellation
+        && mParams.getPathParams().getCurveType() != LL_PCODE_PATH_FLEXIBLE
+        && (sculpt_type == LL_SCULPT_TYPE_NONE || sculpt_type == LL_SCULPT_TYPE_MESH);
+    if (!mSharedShape)
+    {
+    // </FS>
     // set defaults
     if (mParams.getPathParams().getCurveType() == LL_PCODE_PATH_FLEXIBLE)
     {
@@ -1997,6 +2009,7 @@ LLVolume::LLVolume(const LLVolumeParams &params, const F32 detail, const bool ge
         mPathp = new LLPath();
     }
     mProfilep = new LLProfile();
+    } // <FS/> Shared prim tessellation
 
     mGenerateSingleFace = generate_single_face;
 
@@ -2010,11 +2023,32 @@ LLVolume::LLVolume(const LLVolumeParams &params, const F32 detail, const bool ge
 
 void LLVolume::resizePath(S32 length)
 {
+    unshareShape(); // <FS/> Shared prim tessellation
     mPathp->resizePath(length);
     mVolumeFaces.clear();
     setDirty();
 }
 
+// <FS> Shared prim tessellation
+void LLVolume::setDirty()
+{
+    unshareShape();
+    mPathp->setDirty();
+    mProfilep->setDirty();
+}
+
+// Swap the shared profile and path for private ones, which start out dirty
+void LLVolume::unshareShape()
+{
+    if (mSharedShape)
+    {
+        mSharedShape = false;
+        mPathp = new LLPath();
+        mProfilep = new LLProfile();
+    }
+}
+// </FS>
+
 void LLVolume::regen()
 {
     generate();
@@ -2031,9 +2065,11 @@ void LLVolume::genTangents(S32 face)
 LLVolume::~LLVolume()
 {
     sNumMeshPoints -= mMesh.size();
-    delete mPathp;
-
-    delete mProfilep;
+    // <FS> Shared prim tessellation
+    //delete mPathp;
+    //
+    //delete mProfilep;
+    // </FS>
 
     mPathp = NULL;
     mProfilep = NULL;
@@ -2052,7 +2088,7 @@ bool LLVolume::generate()
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
 
     LL_CHECK_MEMORY
-    llassert_always(mProfilep);
+    llassert_always(mProfilep || mSharedShape); // <FS/> Shared prim tessellation
 
     //Added 10.03.05 Dave Parks
     // Split is a parameter to LLProfile::generate that tesselates edges on the profile
@@ -2091,8 +2127,24 @@ bool LLVolume::generate()
         }
     }
 
-    bool regenPath = mPathp->generate(mParams.getPathParams(), path_detail, split);
-    bool regenProf = mProfilep->generate(mParams.getProfileParams(), mPathp->isOpen(),profile_detail, split);
+    // <FS> Shared prim tessellation
+    //bool regenPath = mPathp->generate(mParams.getPathParams(), path_detail, split);
+    //bool regenProf = mProfilep->generate(mParams.getProfileParams(), mPathp->isOpen(),profile_detail, split);
+    bool regenPath = false;
+    bool regenProf = false;
+    if (!mSharedShape)
+    {
+        regenPath = mPathp->generate(mParams.getPathParams(), path_detail, split);
+        regenProf = mProfilep->generate(mParams.getProfileParams(), mPathp->isOpen(),profile_detail, split);
+    }
+    else if (mPathp.isNull())
+    {
+        // First generate(), the shared shapes never change afterwards
+        mPathp = LLVolumeMgr::getSharedPath(mParams.getPathParams(), path_detail, split);
+        mProfilep = LLVolumeMgr::getSharedProfile(mParams.getProfileParams(), mPathp->isOpen(), profile_detail, split);
+        regenPath = true;
+    }
+    // </FS>
 
     if (regenPath || regenProf )
     {
@@ -2127,7 +2179,7 @@ bool LLVolume::generate()
             rot_mat.loadu(scale_mat);
 
             LLVector4a* profile = mProfilep->mProfile.mArray;
-            LLVector4a* end_profile = profile+sizeT;
+            //LLVector4a* end_profile = profile+sizeT; // <FS/> Vertex stream kernels
             LLVector4a offset = mPathp->mPath[s].mPos;
 
             // hack to work around MAINT-5660 for debug until we can suss out
@@ -2137,15 +2189,21 @@ bool LLVolume::generate()
                 offset.clear();
             }
 
-            LLVector4a tmp;
-
-            // Run along the profile.
-            while (profile < end_profile)
-            {
-                rot_mat.rotate(*profile++, tmp);
-                dst->setAdd(tmp,offset);
-                ++dst;
-            }
+            // <FS> Vertex stream kernels
+            //LLVector4a tmp;
+            //
+            //// Run along the profile.
+            //while (profile < end_profile)
+            //{
+            //    rot_mat.rotate(*profile++, tmp);
+            //    dst->setAdd(tmp,offset);
+            //    ++dst;
+            //}
+            // Run along the profile, the offset rides in the translation row
+            rot_mat.mMatrix[3] = offset;
+            LLVolumeSIMD::transformPositions(rot_mat, profile, dst, sizeT);
+            dst += sizeT;
+            // </FS>
         }
 
         for (std::vector<LLProfile::Face>::iterator iter = mProfilep->mFaces.begin();
@@ -2323,7 +2381,7 @@ bool LLVolume::unpackVolumeFaces(std::istream& is, S32 size)
     return unpackVolumeFacesInternal(mdl);
 }
 
-bool LLVolume::unpackVolumeFaces(U8* in_data, S32 size)
+bool LLVolume::unpackVolumeFaces(U8* in_data, S32 size, bool optimize)
 {
     //input data is now pointing at a zlib compressed block of LLSD
     //decompress block
@@ -2334,10 +2392,10 @@ bool LLVolume::unpackVolumeFaces(U8* in_data, S32 size)
         LL_DEBUGS("MeshStreaming") << "Failed to unzip LLSD blob for LoD with code " << uzip_result << " , will probably fetch from sim again." << LL_ENDL;
         return false;
     }
-    return unpackVolumeFacesInternal(mdl);
+    return unpackVolumeFacesInternal(mdl, optimize);
 }
 
-bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
+bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl, bool optimize)
 {
     {
         auto face_count = mdl.size();
@@ -2686,13 +2744,16 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
             }
             else
             {
-                min = max = face.mPositions[0];
-
-                for (S32 i = 1; i < face.mNumVertices; ++i)
-                {
-                    min.setMin(min, face.mPositions[i]);
-                    max.setMax(max, face.mPositions[i]);
-                }
+                // <FS> Vertex stream kernels
+                //min = max = face.mPositions[0];
+                //
+                //for (S32 i = 1; i < face.mNumVertices; ++i)
+                //{
+                //    min.setMin(min, face.mPositions[i]);
+                //    max.setMax(max, face.mPositions[i]);
+                //}
+                LLVolumeSIMD::getMinMax(face.mPositions, face.mNumVertices, min, max);
+                // </FS>
 
                 if (face.mTexCoords)
                 {
@@ -2716,7 +2777,7 @@ bool LLVolume::unpackVolumeFacesInternal(const LLSD& mdl)
         }
     }
 
-    if (!cacheOptimize(true))
+    if (optimize && !cacheOptimize(true))
     {
         // Out of memory?
         LL_WARNS() << "Failed to optimize!" << LL_ENDL;
@@ -2775,6 +2836,12 @@ void LLVolume::copyVolumeFaces(const LLVolume* volume)
     mSculptLevel = 0;
 }
 
+void LLVolume::swapVolumeFaces(LLVolume* volume)
+{
+    mVolumeFaces.swap(volume->mVolumeFaces);
+    mSculptLevel = 0;
+}
+
 bool LLVolume::cacheOptimize(bool gen_tangents)
 {
     for (S32 i = 0; i < mVolumeFaces.size(); ++i)
@@ -3218,6 +3285,7 @@ void LLVolume::sculpt(U16 sculpt_width, U16 sculpt_height, S8 sculpt_components,
 
     sculpt_calc_mesh_resolution(sculpt_width, sculpt_height, sculpt_type, mDetail, requested_sizeS, requested_sizeT);
 
+    unshareShape(); // <FS/> Shared prim tessellation
     mPathp->generate(mParams.getPathParams(), mDetail, 0, true, requested_sizeS);
     mProfilep->generate(mParams.getProfileParams(), mPathp->isOpen(), mDetail, 0, true, requested_sizeT);
 
@@ -4397,17 +4465,75 @@ S32 LLVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a& en
             }
             else
             {
-                if (!face.getOctree())
-                {
-                    face.createOctree();
-                }
-
-                LLOctreeTriangleRayIntersect intersect(start, dir, &face, &closest_t, intersection, tex_coord, normal, tangent_out);
-                intersect.traverse(face.getOctree());
-                if (intersect.mHitFace)
+                // <FS> Flat picking hierarchy
+                //if (!face.getOctree())
+                //{
+                //    face.createOctree();
+                //}
+                //
+                //LLOctreeTriangleRayIntersect intersect(start, dir, &face, &closest_t, intersection, tex_coord, normal, tangent_out);
+                //intersect.traverse(face.getOctree());
+                //if (intersect.mHitFace)
+                //{
+                //    hit_face = i;
+                //}
+                face.createBVH();
+
+                F32 a, b;
+                S32 tri = face.getBVH()->intersect(face.mPositions, face.mIndices, start, dir, closest_t, a, b);
+                if (tri >= 0)
                 {
                     hit_face = i;
+
+                    U16 idx0 = face.mIndices[tri * 3 + 0];
+                    U16 idx1 = face.mIndices[tri * 3 + 1];
+                    U16 idx2 = face.mIndices[tri * 3 + 2];
+
+                    if (intersection != NULL)
+                    {
+                        LLVector4a intersect = dir;
+                        intersect.mul(closest_t);
+                        intersect.add(start);
+                        *intersection = intersect;
+                    }
+
+                    if (tex_coord != NULL && face.mTexCoords)
+                    {
+                        LLVector2* tc = (LLVector2*) face.mTexCoords;
+                        *tex_coord = ((1.f - a - b) * tc[idx0] +
+                                      a             * tc[idx1] +
+                                      b             * tc[idx2]);
+                    }
+
+                    if (normal != NULL && face.mNormals)
+                    {
+                        LLVector4a n1, n2, n3;
+                        n1 = face.mNormals[idx0];
+                        n1.mul(1.f - a - b);
+                        n2 = face.mNormals[idx1];
+                        n2.mul(a);
+                        n3 = face.mNormals[idx2];
+                        n3.mul(b);
+                        n1.add(n2);
+                        n1.add(n3);
+                        *normal = n1;
+                    }
+
+                    if (tangent_out != NULL && face.mTangents)
+                    {
+                        LLVector4a t1, t2, t3;
+                        t1 = face.mTangents[idx0];
+                        t1.mul(1.f - a - b);
+                        t2 = face.mTangents[idx1];
+                        t2.mul(a);
+                        t3 = face.mTangents[idx2];
+                        t3.mul(b);
+                        t1.add(t2);
+                        t1.add(t3);
+                        *tangent_out = t1;
+                    }
                 }
+                // </FS>
             }
         }
     }
@@ -4959,6 +5085,7 @@ LLVolumeFace::LLVolumeFace() :
     mWeightsScrubbed(false),
     mOctree(NULL),
     mOctreeTriangles(NULL),
+    mBVH(NULL), // <FS/> Flat picking hierarchy
     mOptimized(false)
 {
     mExtents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*3);
@@ -4989,7 +5116,8 @@ LLVolumeFace::LLVolumeFace(const LLVolumeFace& src)
 #endif
     mWeightsScrubbed(false),
     mOctree(NULL),
-    mOctreeTriangles(NULL)
+    mOctreeTriangles(NULL),
+    mBVH(NULL) // <FS/> Flat picking hierarchy
 {
     mExtents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*3);
     mCenter = mExtents+2;
@@ -5132,14 +5260,52 @@ void LLVolumeFace::freeData()
 #endif
 
     destroyOctree();
+    destroyBVH(); // <FS/> Flat picking hierarchy
+    updateMemAccounting(); // <FS/> Memory accounting
 }
 
+// <FS> Memory accounting
+// Recomputes the size of the vertex, index, tangent and weight buffers
+// after any of them changed and accounts the difference to LLMemTag::MESH
+void LLVolumeFace::updateMemAccounting()
+{
+    S64 bytes = 0;
+    if (mPositions)
+    {
+        bytes += (S64)mNumAllocatedVertices * sizeof(LLVector4a) * 2 + (((S64)mNumAllocatedVertices * sizeof(LLVector2) + 0xF) & ~0xF);
+    }
+    if (mIndices)
+    {
+        bytes += ((S64)mNumIndices * sizeof(U16) + 0xF) & ~0xF;
+    }
+    if (mTangents)
+    {
+        bytes += (S64)mNumVertices * sizeof(LLVector4a);
+    }
+    if (mWeights)
+    {
+        bytes += (S64)mNumVertices * sizeof(LLVector4a);
+    }
+
+    if (bytes > mAccountedBytes)
+    {
+        LLMemAccounting::claim(LLMemTag::MESH, bytes - mAccountedBytes);
+    }
+    else if (bytes < mAccountedBytes)
+    {
+        LLMemAccounting::disclaim(LLMemTag::MESH, mAccountedBytes - bytes);
+    }
+    mAccountedBytes = bytes;
+}
+// </FS>
+
 bool LLVolumeFace::create(LLVolume* volume, bool partial_build)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
 
     //tree for this face is no longer valid
     destroyOctree();
+    destroyBVH(); // <FS/> Flat picking hierarchy
 
     LL_CHECK_MEMORY
     bool ret = false ;
@@ -5250,6 +5416,7 @@ void LLVolumeFace::remap()
     mTexCoords = remap_tex_coords;
     mNumVertices = remap_vertices_count;
     mNumAllocatedVertices = remap_vertices_count;
+    updateMemAccounting(); // <FS/> Memory accounting
 }
 
 void LLVolumeFace::optimize(F32 angle_cutoff)
@@ -5914,6 +6081,31 @@ const LLVolumeOctree* LLVolumeFace::getOctree() const
     return mOctree;
 }
 
+// <FS> Flat picking hierarchy
+void LLVolumeFace::createBVH()
+{
+    if (!mBVH)
+    {
+        mBVH = new LLVolumeBVH();
+    }
+    if (mBVH->isEmpty())
+    {
+        mBVH->build(mPositions, mIndices, mNumIndices);
+    }
+}
+
+void LLVolumeFace::destroyBVH()
+{
+    delete mBVH;
+    mBVH = nullptr;
+}
+
+const LLVolumeBVH* LLVolumeFace::getBVH() const
+{
+    return mBVH;
+}
+// </FS>
+
 
 void LLVolumeFace::swapData(LLVolumeFace& rhs)
 {
@@ -5924,6 +6116,10 @@ void LLVolumeFace::swapData(LLVolumeFace& rhs)
     llswap(rhs.mIndices,mIndices);
     llswap(rhs.mNumVertices, mNumVertices);
     llswap(rhs.mNumIndices, mNumIndices);
+    // <FS> Memory accounting
+    updateMemAccounting();
+    rhs.updateMemAccounting();
+    // </FS>
 }
 
 void    LerpPlanarVertex(LLVolumeFace::VertexData& v0,
@@ -6599,6 +6795,8 @@ void LLVolumeFace::resizeVertices(S32 num_verts)
 
     // Force update
     mJointRiggingInfoTab.clear();
+
+    updateMemAccounting(); // <FS/> Memory accounting
 }
 
 void LLVolumeFace::pushVertex(const LLVolumeFace::VertexData& cv)
@@ -6646,7 +6844,7 @@ void LLVolumeFace::pushVertex(const LLVector4a& pos, const LLVector4a& norm, con
         ll_aligned_free<64>(old_buf);
 
         mNumAllocatedVertices = new_verts;
-
+        updateMemAccounting(); // <FS/> Memory accounting
     }
 
     mPositions[mNumVertices] = pos;
@@ -6660,13 +6858,14 @@ void LLVolumeFace::allocateTangents(S32 num_verts)
 {
     ll_aligned_free_16(mTangents);
     mTangents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*num_verts);
+    updateMemAccounting(); // <FS/> Memory accounting
 }
 
 void LLVolumeFace::allocateWeights(S32 num_verts)
 {
     ll_aligned_free_16(mWeights);
     mWeights = (LLVector4a*)ll_aligned_malloc_16(sizeof(LLVector4a)*num_verts);
-
+    updateMemAccounting(); // <FS/> Memory accounting
 }
 
 void LLVolumeFace::allocateJointIndices(S32 num_verts)
@@ -6708,6 +6907,8 @@ void LLVolumeFace::resizeIndices(S32 num_indices)
         // Either num_indices is zero or allocation failure
         mNumIndices = 0;
     }
+
+    updateMemAccounting(); // <FS/> Memory accounting
 }
 
 void LLVolumeFace::pushIndex(const U16& idx)
@@ -6723,6 +6924,12 @@ void LLVolumeFace::pushIndex(const U16& idx)
     }
 
     mIndices[mNumIndices++] = idx;
+    // <FS> Memory accounting
+    if (new_size != old_size)
+    {
+        updateMemAccounting();
+    }
+    // </FS>
 }
 
 void LLVolumeFace::fillFromLegacyData(std::vector<LLVolumeFace::VertexData>& v, std::vector<U16>& idx)
@@ -6880,19 +7087,24 @@ bool LLVolumeFace::createSide(LLVolume* volume, bool partial_build)
 
     mCenter->clear();
 
-    LLVector4a* cur_pos = pos;
-    LLVector4a* end_pos = pos + mNumVertices;
+    // <FS> Vertex stream kernels
+    //LLVector4a* cur_pos = pos;
+    //LLVector4a* end_pos = pos + mNumVertices;
+    // </FS>
 
     //get bounding box for this side
     LLVector4a face_min;
     LLVector4a face_max;
 
-    face_min = face_max = *cur_pos++;
-
-    while (cur_pos < end_pos)
-    {
-        update_min_max(face_min, face_max, *cur_pos++);
-    }
+    // <FS> Vertex stream kernels
+    //face_min = face_max = *cur_pos++;
+    //
+    //while (cur_pos < end_pos)
+    //{
+    //    update_min_max(face_min, face_max, *cur_pos++);
+    //}
+    LLVolumeSIMD::getMinMax(pos, mNumVertices, face_min, face_max);
+    // </FS>
     // VFExtents change
     mExtents[0] = face_min;
     mExtents[1] = face_max;
@@ -42,6 +42,7 @@ class LLVolumeFace;
 class LLVolume;
 class LLVolumeTriangle;
 class LLVolumeOctree;
+class LLVolumeBVH; // <FS/> Flat picking hierarchy
 
 #include "lluuid.h"
 #include "v4color.h"
@@ -687,7 +688,10 @@ protected:
 };
 
 
-class LLProfile
+// <FS> Shared prim tessellation
+//class LLProfile
+class LLProfile : public LLThreadSafeRefCount
+// </FS>
 {
     friend class LLVolume;
 
@@ -755,7 +759,10 @@ protected:
 // SWEEP/EXTRUDE PATHS
 //-------------------------------------------------------------------
 
-class LLPath
+// <FS> Shared prim tessellation
+//class LLPath
+class LLPath : public LLThreadSafeRefCount
+// </FS>
 {
 public:
     class PathPt
@@ -874,6 +881,7 @@ public:
     ~LLVolumeFace();
 private:
     void freeData();
+    void updateMemAccounting(); // <FS/> Memory accounting
 public:
 
     bool create(LLVolume* volume, bool partial_build = false);
@@ -921,6 +929,14 @@ public:
     // Get a reference to the octree, which may be null
     const LLVolumeOctree* getOctree() const;
 
+    // <FS> Flat picking hierarchy
+    // Ray picking goes through an LLVolumeBVH, built on the first pick after
+    // the positions or indices change. The octree is only kept for debug display.
+    void createBVH();
+    void destroyBVH();
+    const LLVolumeBVH* getBVH() const;
+    // </FS>
+
     // Part of silhouette generation (used by selection outlines)
     // Populates the provided edge array with numbers corresponding to
     // *partial* logic of whether a particular index should be rendered
@@ -994,6 +1010,11 @@ public:
     //whether or not face has been cache optimized
     bool mOptimized;
 
+    // <FS> Memory accounting
+    // Bytes of the buffers above accounted to LLMemTag::MESH
+    S64 mAccountedBytes = 0;
+    // </FS>
+
     // if this is a mesh asset, scale and translation that were applied
     // when encoding the source mesh into a unit cube
     // used for regenerating tangents
@@ -1002,6 +1023,7 @@ public:
 private:
     LLVolumeOctree* mOctree;
     LLVolumeTriangle* mOctreeTriangles;
+    LLVolumeBVH* mBVH; // <FS/> Flat picking hierarchy
 
     bool createUnCutCubeCap(LLVolume* volume, bool partial_build = false);
     bool createCap(LLVolume* volume, bool partial_build = false);
@@ -1038,13 +1060,19 @@ public:
     const LLVolumeParams& getParams() const                 { return mParams; }
     LLVolumeParams getCopyOfParams() const                  { return mParams; }
     const LLProfile& getProfile() const                     { return *mProfilep; }
-    LLPath& getPath() const                                 { return *mPathp; }
+    // <FS> Shared prim tessellation
+    //LLPath& getPath() const                                 { return *mPathp; }
+    LLPath& getPath() const                                 { return *mPathp.get(); }
+    // </FS>
     void resizePath(S32 length);
     const LLAlignedArray<LLVector4a,64>&    getMesh() const             { return mMesh; }
     const LLVector4a& getMeshPt(const U32 i) const          { return mMesh[i]; }
 
 
-    void setDirty() { mPathp->setDirty(); mProfilep->setDirty(); }
+    // <FS> Shared prim tessellation
+    //void setDirty() { mPathp->setDirty(); mProfilep->setDirty(); }
+    void setDirty();
+    // </FS>
 
     void regen();
     void genTangents(S32 face);
@@ -1108,6 +1136,7 @@ public:
     // NaCl End
 
     void copyVolumeFaces(const LLVolume* volume);
+    void swapVolumeFaces(LLVolume* volume); // takes volume's faces, volume is left with ours
     void copyFacesTo(std::vector<LLVolumeFace> &faces) const;
     void copyFacesFrom(const std::vector<LLVolumeFace> &faces);
 
@@ -1126,9 +1155,10 @@ protected:
     void createVolumeFaces();
 public:
     bool unpackVolumeFaces(std::istream& is, S32 size);
-    bool unpackVolumeFaces(U8* in_data, S32 size);
+    // optimize=false skips cacheOptimize(), the caller must run it before use
+    bool unpackVolumeFaces(U8* in_data, S32 size, bool optimize = true);
 private:
-    bool unpackVolumeFacesInternal(const LLSD& mdl);
+    bool unpackVolumeFacesInternal(const LLSD& mdl, bool optimize = true);
 
 public:
     virtual void setMeshAssetLoaded(bool loaded);
@@ -1145,8 +1175,14 @@ public:
     bool mIsMeshAssetUnavaliable;
 
     const LLVolumeParams mParams;
-    LLPath *mPathp;
-    LLProfile *mProfilep;
+    // <FS> Shared prim tessellation
+    //LLPath *mPathp;
+    //LLProfile *mProfilep;
+    LLPointer<LLPath> mPathp;
+    LLPointer<LLProfile> mProfilep;
+    bool mSharedShape; // mPathp and mProfilep come from LLVolumeMgr and must not be modified
+    void unshareShape();
+    // </FS>
     LLAlignedArray<LLVector4a,64> mMesh;
 
 
@@ -0,0 +1,555 @@
+/**
+ * @file llvolumebvh.cpp
+ * @brief Flat bounding volume hierarchy for ray picking volume faces
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llvolumebvh.h"
+
+#include "llmath.h"
+#include "llvector4a.h"
+#include "llvolume.h"
+#include "llmutex.h"
+#include "lltimer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_set>
+
+namespace
+{
+    // Binned SAH parameters. Costs are relative to one triangle test.
+    const S32 NUM_BINS = 16;
+    const F32 TRAVERSAL_COST = 1.f;
+    const U32 MIN_LEAF_TRIS = 2;
+    const U32 MAX_LEAF_TRIS = 8;
+
+    // Deep enough for any sensible face, keeps the query stack bounded
+    const S32 MAX_BUILD_DEPTH = 64;
+    const S32 MAX_STACK = 3 * MAX_BUILD_DEPTH + 4;
+
+    struct BVHRegistry
+    {
+        LLMutex                             mMutex;
+        std::unordered_set<LLVolumeBVH*>    mHierarchies;   // mMutex
+        std::atomic<size_t>                 mMemoryUsage{ 0 };
+    };
+
+    BVHRegistry& get_registry()
+    {
+        static BVHRegistry registry;
+        return registry;
+    }
+
+    F32 half_area(const F32* min, const F32* max)
+    {
+        F32 dx = max[0] - min[0];
+        F32 dy = max[1] - min[1];
+        F32 dz = max[2] - min[2];
+        return dx * dy + dy * dz + dz * dx;
+    }
+
+    void grow(F32* min, F32* max, const F32* other_min, const F32* other_max)
+    {
+        for (S32 i = 0; i < 3; ++i)
+        {
+            min[i] = llmin(min[i], other_min[i]);
+            max[i] = llmax(max[i], other_max[i]);
+        }
+    }
+
+    void reset_bounds(F32* min, F32* max)
+    {
+        for (S32 i = 0; i < 3; ++i)
+        {
+            min[i] = F32_MAX;
+            max[i] = -F32_MAX;
+        }
+    }
+}
+
+struct LLVolumeBVH::BuildTri
+{
+    F32 mMin[3];
+    F32 mMax[3];
+    F32 mCentroid[3];
+    U32 mTriangle;
+};
+
+struct LLVolumeBVH::BuildNode
+{
+    F32 mMin[3];
+    F32 mMax[3];
+    S32 mLeft;
+    S32 mRight;
+    U32 mFirst;
+    U32 mCount; // > 0 for leaves
+};
+
+LLVolumeBVH::LLVolumeBVH()
+:   mMemoryUsage(0),
+    mLastUsed(0)
+{
+    BVHRegistry& registry = get_registry();
+    LLMutexLock lock(&registry.mMutex);
+    registry.mHierarchies.insert(this);
+}
+
+LLVolumeBVH::~LLVolumeBVH()
+{
+    BVHRegistry& registry = get_registry();
+    LLMutexLock lock(&registry.mMutex);
+    registry.mHierarchies.erase(this);
+    registry.mMemoryUsage -= mMemoryUsage;
+}
+
+void LLVolumeBVH::clear()
+{
+    mNodes.clear();
+    mNodes.shrink_to_fit();
+    mTriangles.clear();
+    mTriangles.shrink_to_fit();
+    updateMemoryUsage();
+}
+
+void LLVolumeBVH::updateMemoryUsage()
+{
+    size_t usage = mNodes.capacity() * sizeof(Node) + mTriangles.capacity() * sizeof(U32);
+    BVHRegistry& registry = get_registry();
+    registry.mMemoryUsage += usage;
+    registry.mMemoryUsage -= mMemoryUsage;
+    mMemoryUsage = usage;
+}
+
+size_t LLVolumeBVH::getMemoryUsage() const
+{
+    return mMemoryUsage;
+}
+
+void LLVolumeBVH::build(const LLVector4a* positions, const U16* indices, S32 num_indices)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+
+    mNodes.clear();
+    mTriangles.clear();
+    mLastUsed = totalTime();
+
+    const U32 num_triangles = num_indices / 3;
+    if (!num_triangles)
+    {
+        updateMemoryUsage();
+        return;
+    }
+
+    std::vector<BuildTri> tris(num_triangles);
+    for (U32 i = 0; i < num_triangles; ++i)
+    {
+        BuildTri& tri = tris[i];
+        reset_bounds(tri.mMin, tri.mMax);
+        for (U32 j = 0; j < 3; ++j)
+        {
+            const F32* v = positions[indices[i * 3 + j]].getF32ptr();
+            grow(tri.mMin, tri.mMax, v, v);
+        }
+        for (S32 k = 0; k < 3; ++k)
+        {
+            tri.mCentroid[k] = (tri.mMin[k] + tri.mMax[k]) * 0.5f;
+        }
+        tri.mTriangle = i;
+    }
+
+    std::vector<BuildNode> nodes;
+    nodes.reserve(num_triangles * 2 / MIN_LEAF_TRIS + 1);
+    buildRecursive(nodes, tris, 0, num_triangles, 0);
+
+    mTriangles.resize(num_triangles);
+    for (U32 i = 0; i < num_triangles; ++i)
+    {
+        mTriangles[i] = tris[i].mTriangle;
+    }
+
+    mNodes.reserve(nodes.size() / 2 + 1);
+    collapse(nodes, 0);
+    mNodes.shrink_to_fit();
+
+    updateMemoryUsage();
+}
+
+S32 LLVolumeBVH::buildRecursive(std::vector<BuildNode>& nodes, std::vector<BuildTri>& tris, U32 first, U32 count, S32 depth)
+{
+    S32 index = (S32)nodes.size();
+    nodes.emplace_back();
+
+    F32 min[3], max[3], centroid_min[3], centroid_max[3];
+    reset_bounds(min, max);
+    reset_bounds(centroid_min, centroid_max);
+    for (U32 i = first; i < first + count; ++i)
+    {
+        grow(min, max, tris[i].mMin, tris[i].mMax);
+        grow(centroid_min, centroid_max, tris[i].mCentroid, tris[i].mCentroid);
+    }
+
+    BuildNode& node = nodes[index];
+    memcpy(node.mMin, min, sizeof(min));
+    memcpy(node.mMax, max, sizeof(max));
+    node.mLeft = node.mRight = -1;
+    node.mFirst = first;
+    node.mCount = count;
+
+    if (count <= MIN_LEAF_TRIS || depth >= MAX_BUILD_DEPTH)
+    {
+        return index;
+    }
+
+    // Find the cheapest bin boundary on any axis
+    F32 best_cost = F32_MAX;
+    S32 best_axis = -1;
+    S32 best_split = 0;
+    for (S32 axis = 0; axis < 3; ++axis)
+    {
+        F32 extent = centroid_max[axis] - centroid_min[axis];
+        if (extent <= 0.f)
+        {
+            continue;
+        }
+        F32 scale = NUM_BINS / extent;
+
+        U32 bin_count[NUM_BINS] = {};
+        F32 bin_min[NUM_BINS][3], bin_max[NUM_BINS][3];
+        for (S32 b = 0; b < NUM_BINS; ++b)
+        {
+            reset_bounds(bin_min[b], bin_max[b]);
+        }
+        for (U32 i = first; i < first + count; ++i)
+        {
+            S32 b = llmin(NUM_BINS - 1, (S32)((tris[i].mCentroid[axis] - centroid_min[axis]) * scale));
+            ++bin_count[b];
+            grow(bin_min[b], bin_max[b], tris[i].mMin, tris[i].mMax);
+        }
+
+        // Sweep from the right to get the cost of every right hand side
+        F32 right_cost[NUM_BINS];
+        F32 acc_min[3], acc_max[3];
+        reset_bounds(acc_min, acc_max);
+        U32 acc_count = 0;
+        for (S32 b = NUM_BINS - 1; b > 0; --b)
+        {
+            grow(acc_min, acc_max, bin_min[b], bin_max[b]);
+            acc_count += bin_count[b];
+            right_cost[b] = acc_count ? acc_count * half_area(acc_min, acc_max) : 0.f;
+        }
+
+        reset_bounds(acc_min, acc_max);
+        acc_count = 0;
+        for (S32 b = 0; b < NUM_BINS - 1; ++b)
+        {
+            grow(acc_min, acc_max, bin_min[b], bin_max[b]);
+            acc_count += bin_count[b];
+            if (!acc_count || acc_count == count)
+            {
+                continue;
+            }
+            F32 cost = acc_count * half_area(acc_min, acc_max) + right_cost[b + 1];
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_axis = axis;
+                best_split = b;
+            }
+        }
+    }
+
+    U32 mid = first + count / 2;
+    if (best_axis >= 0)
+    {
+        F32 area = half_area(min, max);
+        F32 leaf_cost = count * area;
+        F32 split_cost = TRAVERSAL_COST * area + best_cost;
+        if (split_cost >= leaf_cost && count <= MAX_LEAF_TRIS)
+        {
+            return index;
+        }
+
+        F32 scale = NUM_BINS / (centroid_max[best_axis] - centroid_min[best_axis]);
+        F32 axis_min = centroid_min[best_axis];
+        auto split = std::partition(tris.begin() + first, tris.begin() + first + count,
+            [=](const BuildTri& tri)
+            {
+                return llmin(NUM_BINS - 1, (S32)((tri.mCentroid[best_axis] - axis_min) * scale)) <= best_split;
+            });
+        mid = (U32)(split - tris.begin());
+    }
+    else if (count <= MAX_LEAF_TRIS)
+    {
+        // Every centroid in the same place, splitting cannot help
+        return index;
+    }
+
+    if (mid == first || mid == first + count)
+    {
+        mid = first + count / 2;
+    }
+
+    S32 left = buildRecursive(nodes, tris, first, mid - first, depth + 1);
+    S32 right = buildRecursive(nodes, tris, mid, first + count - mid, depth + 1);
+
+    BuildNode& inner = nodes[index];
+    inner.mLeft = left;
+    inner.mRight = right;
+    inner.mCount = 0;
+    return index;
+}
+
+S32 LLVolumeBVH::collapse(const std::vector<BuildNode>& nodes, S32 index)
+{
+    // Pull grandchildren up until there are four children, opening the
+    // largest inner child first
+    S32 children[4];
+    S32 num_children = 0;
+    const BuildNode& root = nodes[index];
+    if (root.mCount)
+    {
+        children[num_children++] = index;
+    }
+    else
+    {
+        children[num_children++] = root.mLeft;
+        children[num_children++] = root.mRight;
+    }
+
+    while (num_children < 4)
+    {
+        S32 best = -1;
+        F32 best_area = -1.f;
+        for (S32 i = 0; i < num_children; ++i)
+        {
+            const BuildNode& child = nodes[children[i]];
+            if (!child.mCount)
+            {
+                F32 area = half_area(child.mMin, child.mMax);
+                if (area > best_area)
+                {
+                    best_area = area;
+                    best = i;
+                }
+            }
+        }
+        if (best < 0)
+        {
+            break;
+        }
+        const BuildNode& opened = nodes[children[best]];
+        children[best] = opened.mLeft;
+        children[num_children++] = opened.mRight;
+    }
+
+    S32 node_index = (S32)mNodes.size();
+    mNodes.emplace_back();
+    {
+        Node& node = mNodes[node_index];
+        for (S32 i = 0; i < 4; ++i)
+        {
+            for (S32 axis = 0; axis < 3; ++axis)
+            {
+                node.mMin[axis][i] = F32_MAX;
+                node.mMax[axis][i] = -F32_MAX;
+            }
+            node.mChild[i] = -1;
+            node.mCount[i] = 0;
+        }
+    }
+
+    for (S32 i = 0; i < num_children; ++i)
+    {
+        const BuildNode& child = nodes[children[i]];
+        S32 child_index = child.mCount ? (S32)child.mFirst : collapse(nodes, children[i]);
+
+        // collapse() may have moved mNodes
+        Node& node = mNodes[node_index];
+        for (S32 axis = 0; axis < 3; ++axis)
+        {
+            node.mMin[axis][i] = child.mMin[axis];
+            node.mMax[axis][i] = child.mMax[axis];
+        }
+        node.mChild[i] = child_index;
+        node.mCount[i] = child.mCount;
+    }
+
+    return node_index;
+}
+
+S32 LLVolumeBVH::intersect(const LLVector4a* positions, const U16* indices,
+                           const LLVector4a& start, const LLVector4a& dir,
+                           F32& closest_t, F32& a, F32& b) const
+{
+    if (mNodes.empty())
+    {
+        return -1;
+    }
+    mLastUsed = totalTime();
+
+    // Slab test setup. Near and far planes are picked per axis from the ray
+    // direction so an inverted (empty) box can never pass.
+    __m128 origin[3];
+    __m128 inv_dir[3];
+    bool negative[3];
+    for (S32 axis = 0; axis < 3; ++axis)
+    {
+        F32 d = dir[axis];
+        negative[axis] = d < 0.f;
+        if (fabsf(d) < 1e-30f)
+        {
+            d = negative[axis] ? -1e-30f : 1e-30f;
+        }
+        origin[axis] = _mm_set1_ps(start[axis]);
+        inv_dir[axis] = _mm_set1_ps(1.f / d);
+    }
+
+    S32 hit = -1;
+    F32 max_t = llmin(closest_t, 1.f);
+
+    struct StackEntry
+    {
+        S32 mNode;
+        F32 mNear;
+    };
+    StackEntry stack[MAX_STACK];
+    S32 stack_size = 0;
+    stack[stack_size++] = { 0, 0.f };
+
+    while (stack_size > 0)
+    {
+        const StackEntry entry = stack[--stack_size];
+        if (entry.mNear > max_t)
+        {
+            continue;
+        }
+        const Node& node = mNodes[entry.mNode];
+
+        __m128 t_near = _mm_setzero_ps();
+        __m128 t_far = _mm_set1_ps(max_t);
+        for (S32 axis = 0; axis < 3; ++axis)
+        {
+            const F32* near_plane = negative[axis] ? node.mMax[axis] : node.mMin[axis];
+            const F32* far_plane = negative[axis] ? node.mMin[axis] : node.mMax[axis];
+            __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(near_plane), origin[axis]), inv_dir[axis]);
+            __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(far_plane), origin[axis]), inv_dir[axis]);
+            t_near = _mm_max_ps(t_near, t0);
+            t_far = _mm_min_ps(t_far, t1);
+        }
+        S32 mask = _mm_movemask_ps(_mm_cmple_ps(t_near, t_far));
+        if (!mask)
+        {
+            continue;
+        }
+
+        LL_ALIGN_16(F32 near_t[4]);
+        _mm_store_ps(near_t, t_near);
+
+        // Test leaves right away, queue inner children far to near so the
+        // nearest is popped first
+        StackEntry inner[4];
+        S32 num_inner = 0;
+        for (S32 i = 0; i < 4; ++i)
+        {
+            if (!(mask & (1 << i)))
+            {
+                continue;
+            }
+            if (node.mCount[i])
+            {
+                const U32 end = node.mChild[i] + node.mCount[i];
+                for (U32 j = node.mChild[i]; j < end; ++j)
+                {
+                    const U32 tri = mTriangles[j];
+                    const U16* idx = indices + tri * 3;
+                    F32 tri_a, tri_b, t;
+                    if (LLTriangleRayIntersect(positions[idx[0]], positions[idx[1]], positions[idx[2]],
+                                               start, dir, tri_a, tri_b, t) &&
+                        t >= 0.f && t <= max_t && t < closest_t)
+                    {
+                        closest_t = t;
+                        max_t = t;
+                        a = tri_a;
+                        b = tri_b;
+                        hit = (S32)tri;
+                    }
+                }
+            }
+            else
+            {
+                StackEntry child = { node.mChild[i], near_t[i] };
+                S32 k = num_inner++;
+                while (k > 0 && inner[k - 1].mNear < child.mNear)
+                {
+                    inner[k] = inner[k - 1];
+                    --k;
+                }
+                inner[k] = child;
+            }
+        }
+
+        llassert(stack_size + num_inner <= MAX_STACK);
+        for (S32 i = 0; i < num_inner; ++i)
+        {
+            stack[stack_size++] = inner[i];
+        }
+    }
+
+    return hit;
+}
+
+//static
+void LLVolumeBVH::purgeUnused(F32 max_idle)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+
+    const U64 now = totalTime();
+    const U64 max_idle_usec = (U64)(max_idle * 1000000.f);
+
+    BVHRegistry& registry = get_registry();
+    LLMutexLock lock(&registry.mMutex);
+    size_t freed = 0;
+    for (LLVolumeBVH* bvh : registry.mHierarchies)
+    {
+        if (!bvh->isEmpty() && now - bvh->mLastUsed > max_idle_usec)
+        {
+            freed += bvh->mMemoryUsage;
+            bvh->clear();
+        }
+    }
+
+    if (freed)
+    {
+        LL_INFOS("VolumeBVH") << "Freed " << freed / 1024 << " KB of picking hierarchies, "
+                              << registry.mMemoryUsage / 1024 << " KB still in use" << LL_ENDL;
+    }
+}
+
+//static
+size_t LLVolumeBVH::getTotalMemoryUsage()
+{
+    return get_registry().mMemoryUsage;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file llvolumebvh.h
+ * @brief Flat bounding volume hierarchy for ray picking volume faces
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVOLUMEBVH_H
+#define LL_LLVOLUMEBVH_H
+
+#include "stdtypes.h"
+
+#include <vector>
+
+class LLVector4a;
+
+// Bounding volume hierarchy over the triangles of one LLVolumeFace, used for
+// ray picking in place of LLVolumeOctree. It is built with a binned surface
+// area heuristic and collapsed to nodes of four children stored in one flat
+// array. The child bounds of a node are laid out per axis so a ray is tested
+// against all four with one set of SSE instructions.
+//
+// The hierarchy only holds triangle numbers, positions and indices are
+// passed back in on every query and must not have changed since build().
+//
+// Every hierarchy is registered so purgeUnused() can drop the ones that have
+// not been picked for a while when memory runs low. A purged hierarchy is
+// empty and gets rebuilt on its next pick.
+class LLVolumeBVH
+{
+public:
+    LLVolumeBVH();
+    ~LLVolumeBVH();
+
+    void build(const LLVector4a* positions, const U16* indices, S32 num_indices);
+    void clear();
+    bool isEmpty() const                            { return mNodes.empty(); }
+
+    // Closest triangle hit by the segment start + t * dir, 0 <= t <= 1, with
+    // t < closest_t. Returns the triangle number (first index / 3) and
+    // updates closest_t and the barycentric a and b of the hit, or returns -1.
+    S32 intersect(const LLVector4a* positions, const U16* indices,
+                  const LLVector4a& start, const LLVector4a& dir,
+                  F32& closest_t, F32& a, F32& b) const;
+
+    size_t getMemoryUsage() const;
+
+    // Threads:  Tmain
+    // Clear every hierarchy not picked in the last max_idle seconds
+    static void purgeUnused(F32 max_idle);
+
+    // Threads:  T*
+    static size_t getTotalMemoryUsage();
+
+private:
+    // Four children; an inner child indexes mNodes, a leaf child is
+    // mCount[i] entries of mTriangles starting at mChild[i]. Unused slots
+    // have an inverted box and never pass the slab test.
+    struct alignas(16) Node
+    {
+        F32 mMin[3][4];
+        F32 mMax[3][4];
+        S32 mChild[4];
+        U32 mCount[4];
+    };
+
+    struct BuildTri;
+    struct BuildNode;
+
+    S32 buildRecursive(std::vector<BuildNode>& nodes, std::vector<BuildTri>& tris, U32 first, U32 count, S32 depth);
+    S32 collapse(const std::vector<BuildNode>& nodes, S32 index);
+    void updateMemoryUsage();
+
+    std::vector<Node>   mNodes;
+    std::vector<U32>    mTriangles;
+    size_t              mMemoryUsage;
+    mutable U64         mLastUsed;
+};
+
+#endif // LL_LLVOLUMEBVH_H
@@ -82,6 +82,7 @@ bool LLVolumeMgr::cleanup()
     {
         mDataMutex->unlock();
     }
+    clearSharedShapes(); // <FS/> Shared prim tessellation
     return no_refs;
 }
 
@@ -218,6 +219,130 @@ void LLVolumeMgr::useMutex()
     }
 }
 
+// <FS> Shared prim tessellation
+namespace
+{
+    // Caches grow to at least this many entries before unused ones are pruned
+    const size_t MIN_SHARED_SHAPE_PRUNE_SIZE = 1024;
+
+    struct SharedProfileKey
+    {
+        LLProfileParams mParams;
+        bool            mPathOpen;
+        F32             mDetail;
+        S32             mSplit;
+
+        bool operator<(const SharedProfileKey& rhs) const
+        {
+            if (mDetail != rhs.mDetail) return mDetail < rhs.mDetail;
+            if (mSplit != rhs.mSplit) return mSplit < rhs.mSplit;
+            if (mPathOpen != rhs.mPathOpen) return rhs.mPathOpen;
+            return mParams < rhs.mParams;
+        }
+    };
+
+    struct SharedPathKey
+    {
+        LLPathParams    mParams;
+        F32             mDetail;
+        S32             mSplit;
+
+        bool operator<(const SharedPathKey& rhs) const
+        {
+            if (mDetail != rhs.mDetail) return mDetail < rhs.mDetail;
+            if (mSplit != rhs.mSplit) return mSplit < rhs.mSplit;
+            return mParams < rhs.mParams;
+        }
+    };
+
+    LLMutex sSharedShapeMutex;
+    std::map<SharedProfileKey, LLPointer<LLProfile> > sSharedProfiles;    // sSharedShapeMutex
+    std::map<SharedPathKey, LLPointer<LLPath> > sSharedPaths;             // sSharedShapeMutex
+    size_t sSharedProfilePruneSize = MIN_SHARED_SHAPE_PRUNE_SIZE;         // sSharedShapeMutex
+    size_t sSharedPathPruneSize = MIN_SHARED_SHAPE_PRUNE_SIZE;            // sSharedShapeMutex
+
+    // Drop the entries no volume holds any more, once the cache has doubled
+    // since the last pass. Called with sSharedShapeMutex held.
+    template<typename MAP>
+    void prune_shared_shapes(MAP& cache, size_t& prune_size)
+    {
+        if (cache.size() < prune_size)
+        {
+            return;
+        }
+        for (auto it = cache.begin(); it != cache.end(); )
+        {
+            if (it->second->getNumRefs() == 1)
+            {
+                it = cache.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        prune_size = llmax(MIN_SHARED_SHAPE_PRUNE_SIZE, cache.size() * 2);
+    }
+}
+
+//static
+bool LLVolumeMgr::sShareTessellation = true;
+
+//static
+LLPointer<LLProfile> LLVolumeMgr::getSharedProfile(const LLProfileParams& params, bool path_open, F32 detail, S32 split)
+{
+    SharedProfileKey key{ params, path_open, detail, split };
+    {
+        LLMutexLock lock(&sSharedShapeMutex);
+        auto it = sSharedProfiles.find(key);
+        if (it != sSharedProfiles.end())
+        {
+            return it->second;
+        }
+    }
+
+    // Generate outside the lock, if another thread got there first its copy wins
+    LLPointer<LLProfile> profile = new LLProfile();
+    profile->generate(params, path_open, detail, split);
+
+    LLMutexLock lock(&sSharedShapeMutex);
+    prune_shared_shapes(sSharedProfiles, sSharedProfilePruneSize);
+    return sSharedProfiles.emplace(key, profile).first->second;
+}
+
+//static
+LLPointer<LLPath> LLVolumeMgr::getSharedPath(const LLPathParams& params, F32 detail, S32 split)
+{
+    SharedPathKey key{ params, detail, split };
+    {
+        LLMutexLock lock(&sSharedShapeMutex);
+        auto it = sSharedPaths.find(key);
+        if (it != sSharedPaths.end())
+        {
+            return it->second;
+        }
+    }
+
+    LLPointer<LLPath> path = new LLPath();
+    path->generate(params, detail, split);
+
+    LLMutexLock lock(&sSharedShapeMutex);
+    prune_shared_shapes(sSharedPaths, sSharedPathPruneSize);
+    return sSharedPaths.emplace(key, path).first->second;
+}
+
+//static
+void LLVolumeMgr::clearSharedShapes()
+{
+    // Volumes still holding a shared shape keep it alive
+    LLMutexLock lock(&sSharedShapeMutex);
+    sSharedProfiles.clear();
+    sSharedPaths.clear();
+    sSharedProfilePruneSize = MIN_SHARED_SHAPE_PRUNE_SIZE;
+    sSharedPathPruneSize = MIN_SHARED_SHAPE_PRUNE_SIZE;
+}
+// </FS>
+
 std::ostream& operator<<(std::ostream& s, const LLVolumeMgr& volume_mgr)
 {
     s << "{ numLODgroups=" << volume_mgr.mVolumeLODGroups.size() << ", ";
@@ -95,6 +95,16 @@ public:
     // manually call this for mutex magic
     void useMutex();
 
+    // <FS> Shared prim tessellation
+    // Generated profiles and paths of non-sculpted, non-flexible volumes,
+    // shared between all volumes with the same parameters and detail.
+    // Returned instances are immutable. Threads:  T*
+    static LLPointer<LLProfile> getSharedProfile(const LLProfileParams& params, bool path_open, F32 detail, S32 split);
+    static LLPointer<LLPath> getSharedPath(const LLPathParams& params, F32 detail, S32 split);
+    static void clearSharedShapes();
+    static bool sShareTessellation;
+    // </FS>
+
     friend std::ostream& operator<<(std::ostream& s, const LLVolumeMgr& volume_mgr);
 
 protected:
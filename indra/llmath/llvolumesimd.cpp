@@ -0,0 +1,515 @@
+/**
+ * @file llvolumesimd.cpp
+ * @brief Batch transform kernels for LLVolumeFace vertex streams
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llvolumesimd.h"
+
+#include "llmath.h"
+#include "llmatrix4a.h"
+#include "llprocessor.h"
+#include "llvector4a.h"
+#include "llvector4logical.h"
+
+#include <atomic>
+
+#if LL_X86
+#include <immintrin.h>
+
+// MSVC lets any function use the AVX2 intrinsics, gcc and clang have to be
+// told per function so the rest of the file stays SSE2.
+#if LL_MSVC
+#define LL_TARGET_AVX2
+#else
+#define LL_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif // LL_X86
+
+namespace
+{
+    // -------------------------------------------------------------------------------------------
+    // SSE2: the LLMatrix4a calls the kernels replace
+    // -------------------------------------------------------------------------------------------
+
+    void transform_positions_sse2(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count)
+    {
+        for (S32 i = 0; i < count; ++i)
+        {
+            LLVector4a res;
+            mat.affineTransform(src[i], res);
+            dst[i] = res;
+        }
+    }
+
+    void transform_positions_w_sse2(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count, F32 w)
+    {
+        LLVector4Logical mask;
+        mask.clear();
+        mask.setElement<3>();
+
+        LLVector4a w_vec;
+        w_vec.splat(w);
+
+        for (S32 i = 0; i < count; ++i)
+        {
+            LLVector4a res;
+            mat.affineTransform(src[i], res);
+            dst[i].setSelectWithMask(mask, w_vec, res);
+        }
+    }
+
+    void rotate_vectors_sse2(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count)
+    {
+        for (S32 i = 0; i < count; ++i)
+        {
+            LLVector4a res;
+            mat.rotate(src[i], res);
+            dst[i] = res;
+        }
+    }
+
+    void rotate_tangents_sse2(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count)
+    {
+        LLVector4Logical mask;
+        mask.clear();
+        mask.setElement<3>();
+
+        for (S32 i = 0; i < count; ++i)
+        {
+            LLVector4a res;
+            mat.rotate(src[i], res);
+            dst[i].setSelectWithMask(mask, src[i], res);
+        }
+    }
+
+    // Same weight decoding as FSSkinningUtil::getPerVertexSkinMatrixSSE()
+    void skin_positions_sse2(const LLMatrix4a* palette, U32 max_joints, const LLVector4a* weights,
+                             const LLVector4a* src, LLVector4a* dst, S32 count)
+    {
+        LL_ALIGN_16(S32 idx[4]);
+        LL_ALIGN_16(F32 wght[4]);
+
+        const __m128i max_idx = _mm_set1_epi16((S16)(max_joints - 1));
+
+        for (S32 i = 0; i < count; ++i)
+        {
+            __m128i w_idx = _mm_cvttps_epi32(weights[i]);
+            __m128 w = _mm_sub_ps(weights[i], _mm_cvtepi32_ps(w_idx));
+
+            w_idx = _mm_min_epi16(w_idx, max_idx);
+            _mm_store_si128((__m128i*)idx, w_idx);
+
+            __m128 scale = _mm_add_ps(w, _mm_movehl_ps(w, w));
+            scale = _mm_add_ss(scale, _mm_shuffle_ps(scale, scale, 1));
+            scale = _mm_shuffle_ps(scale, scale, 0);
+
+            w = _mm_div_ps(w, scale);
+            _mm_store_ps(wght, w);
+
+            LLMatrix4a final_mat;
+            final_mat.clear();
+            for (U32 k = 0; k < 4; ++k)
+            {
+                LLMatrix4a joint_mat;
+                joint_mat.setMul(palette[idx[k]], wght[k]);
+                final_mat.add(joint_mat);
+            }
+
+            LLVector4a res;
+            final_mat.affineTransform(src[i], res);
+            dst[i] = res;
+        }
+    }
+
+    void multiply_matrices_sse2(const LLMatrix4a* a, const LLMatrix4a* b, LLMatrix4a* dst, S32 count)
+    {
+        for (S32 i = 0; i < count; ++i)
+        {
+            matMulUnsafe(a[i], b[i], dst[i]);
+        }
+    }
+
+    void get_min_max_sse2(const LLVector4a* src, S32 count, LLVector4a& min, LLVector4a& max)
+    {
+        min = max = src[0];
+        for (S32 i = 1; i < count; ++i)
+        {
+            min.setMin(min, src[i]);
+            max.setMax(max, src[i]);
+        }
+    }
+
+#if LL_X86
+    // -------------------------------------------------------------------------------------------
+    // AVX2 + FMA: two vertices per register, the matrix rows broadcast to both lanes
+    // -------------------------------------------------------------------------------------------
+
+    struct avx2_matrix
+    {
+        __m256 mRow[4];
+    };
+
+    LL_TARGET_AVX2 inline void load_matrix(const LLMatrix4a& mat, avx2_matrix& rows)
+    {
+        for (S32 i = 0; i < 4; ++i)
+        {
+            rows.mRow[i] = _mm256_broadcast_ps((const __m128*)mat.mMatrix[i].getF32ptr());
+        }
+    }
+
+    LL_TARGET_AVX2 inline __m256 affine_transform(const avx2_matrix& m, __m256 v)
+    {
+        __m256 res = _mm256_fmadd_ps(_mm256_permute_ps(v, 0xAA), m.mRow[2], m.mRow[3]);
+        res = _mm256_fmadd_ps(_mm256_permute_ps(v, 0x55), m.mRow[1], res);
+        return _mm256_fmadd_ps(_mm256_permute_ps(v, 0x00), m.mRow[0], res);
+    }
+
+    LL_TARGET_AVX2 inline __m256 rotate(const avx2_matrix& m, __m256 v)
+    {
+        __m256 res = _mm256_mul_ps(_mm256_permute_ps(v, 0xAA), m.mRow[2]);
+        res = _mm256_fmadd_ps(_mm256_permute_ps(v, 0x55), m.mRow[1], res);
+        return _mm256_fmadd_ps(_mm256_permute_ps(v, 0x00), m.mRow[0], res);
+    }
+
+    // A lone vertex at the end of a stream goes through the same lane math
+    // as the pairs, so every vertex of a stream is rounded the same way.
+    LL_TARGET_AVX2 inline __m256 load_tail(const LLVector4a& v)
+    {
+        return _mm256_castps128_ps256(_mm_load_ps(v.getF32ptr()));
+    }
+
+    LL_TARGET_AVX2 inline void store_tail(LLVector4a& v, __m256 res)
+    {
+        _mm_store_ps(v.getF32ptr(), _mm256_castps256_ps128(res));
+    }
+
+    LL_TARGET_AVX2 void transform_positions_avx2(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count)
+    {
+        avx2_matrix m;
+        load_matrix(mat, m);
+
+        S32 i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256 v0 = _mm256_loadu_ps(src[i].getF32ptr());
+            __m256 v1 = _mm256_loadu_ps(src[i + 2].getF32ptr());
+            _mm256_storeu_ps(dst[i].getF32ptr(), affine_transform(m, v0));
+            _mm256_storeu_ps(dst[i + 2].getF32ptr(), affine_transform(m, v1));
+        }
+        for (; i + 2 <= count; i += 2)
+        {
+            _mm256_storeu_ps(dst[i].getF32ptr(), affine_transform(m, _mm256_loadu_ps(src[i].getF32ptr())));
+        }
+        if (i < count)
+        {
+            store_tail(dst[i], affine_transform(m, load_tail(src[i])));
+        }
+    }
+
+    LL_TARGET_AVX2 void transform_positions_w_avx2(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count, F32 w)
+    {
+        avx2_matrix m;
+        load_matrix(mat, m);
+        const __m256 w_vec = _mm256_set1_ps(w);
+
+        S32 i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256 v0 = _mm256_loadu_ps(src[i].getF32ptr());
+            __m256 v1 = _mm256_loadu_ps(src[i + 2].getF32ptr());
+            _mm256_storeu_ps(dst[i].getF32ptr(), _mm256_blend_ps(affine_transform(m, v0), w_vec, 0x88));
+            _mm256_storeu_ps(dst[i + 2].getF32ptr(), _mm256_blend_ps(affine_transform(m, v1), w_vec, 0x88));
+        }
+        for (; i + 2 <= count; i += 2)
+        {
+            __m256 v = _mm256_loadu_ps(src[i].getF32ptr());
+            _mm256_storeu_ps(dst[i].getF32ptr(), _mm256_blend_ps(affine_transform(m, v), w_vec, 0x88));
+        }
+        if (i < count)
+        {
+            store_tail(dst[i], _mm256_blend_ps(affine_transform(m, load_tail(src[i])), w_vec, 0x88));
+        }
+    }
+
+    LL_TARGET_AVX2 void rotate_vectors_avx2(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count)
+    {
+        avx2_matrix m;
+        load_matrix(mat, m);
+
+        S32 i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256 v0 = _mm256_loadu_ps(src[i].getF32ptr());
+            __m256 v1 = _mm256_loadu_ps(src[i + 2].getF32ptr());
+            _mm256_storeu_ps(dst[i].getF32ptr(), rotate(m, v0));
+            _mm256_storeu_ps(dst[i + 2].getF32ptr(), rotate(m, v1));
+        }
+        for (; i + 2 <= count; i += 2)
+        {
+            _mm256_storeu_ps(dst[i].getF32ptr(), rotate(m, _mm256_loadu_ps(src[i].getF32ptr())));
+        }
+        if (i < count)
+        {
+            store_tail(dst[i], rotate(m, load_tail(src[i])));
+        }
+    }
+
+    LL_TARGET_AVX2 void rotate_tangents_avx2(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count)
+    {
+        avx2_matrix m;
+        load_matrix(mat, m);
+
+        S32 i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256 v0 = _mm256_loadu_ps(src[i].getF32ptr());
+            __m256 v1 = _mm256_loadu_ps(src[i + 2].getF32ptr());
+            _mm256_storeu_ps(dst[i].getF32ptr(), _mm256_blend_ps(rotate(m, v0), v0, 0x88));
+            _mm256_storeu_ps(dst[i + 2].getF32ptr(), _mm256_blend_ps(rotate(m, v1), v1, 0x88));
+        }
+        for (; i + 2 <= count; i += 2)
+        {
+            __m256 v = _mm256_loadu_ps(src[i].getF32ptr());
+            _mm256_storeu_ps(dst[i].getF32ptr(), _mm256_blend_ps(rotate(m, v), v, 0x88));
+        }
+        if (i < count)
+        {
+            __m256 v = load_tail(src[i]);
+            store_tail(dst[i], _mm256_blend_ps(rotate(m, v), v, 0x88));
+        }
+    }
+
+    // The blended matrix is kept as rows 0|1 and 2|3 in two registers, which
+    // halves the work of summing the four weighted joint matrices.
+    LL_TARGET_AVX2 void skin_positions_avx2(const LLMatrix4a* palette, U32 max_joints, const LLVector4a* weights,
+                                            const LLVector4a* src, LLVector4a* dst, S32 count)
+    {
+        LL_ALIGN_16(S32 idx[4]);
+        LL_ALIGN_16(F32 wght[4]);
+
+        const __m128i max_idx = _mm_set1_epi32((S32)max_joints - 1);
+        const __m128 one = _mm_set1_ps(1.f);
+
+        for (S32 i = 0; i < count; ++i)
+        {
+            __m128i w_idx = _mm_cvttps_epi32(weights[i]);
+            __m128 w = _mm_sub_ps(weights[i], _mm_cvtepi32_ps(w_idx));
+            _mm_store_si128((__m128i*)idx, _mm_min_epi32(w_idx, max_idx));
+
+            __m128 scale = _mm_add_ps(w, _mm_movehl_ps(w, w));
+            scale = _mm_add_ss(scale, _mm_shuffle_ps(scale, scale, 1));
+            _mm_store_ps(wght, _mm_div_ps(w, _mm_shuffle_ps(scale, scale, 0)));
+
+            const F32* joint = palette[idx[0]].mMatrix[0].getF32ptr();
+            __m256 weight = _mm256_set1_ps(wght[0]);
+            __m256 rows01 = _mm256_mul_ps(_mm256_loadu_ps(joint), weight);
+            __m256 rows23 = _mm256_mul_ps(_mm256_loadu_ps(joint + 8), weight);
+            for (S32 k = 1; k < 4; ++k)
+            {
+                joint = palette[idx[k]].mMatrix[0].getF32ptr();
+                weight = _mm256_set1_ps(wght[k]);
+                rows01 = _mm256_fmadd_ps(_mm256_loadu_ps(joint), weight, rows01);
+                rows23 = _mm256_fmadd_ps(_mm256_loadu_ps(joint + 8), weight, rows23);
+            }
+
+            // x * row0 + z * row2 in the low lane, y * row1 + 1 * row3 in the high one
+            __m128 v = _mm_load_ps(src[i].getF32ptr());
+            __m256 xy = _mm256_set_m128(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+            __m256 z1 = _mm256_set_m128(one, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)));
+            __m256 sum = _mm256_fmadd_ps(z1, rows23, _mm256_mul_ps(xy, rows01));
+            _mm_store_ps(dst[i].getF32ptr(), _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1)));
+        }
+    }
+
+    // Two rows of a per register, each lane blends the rows of b by its own
+    // row of a
+    LL_TARGET_AVX2 void multiply_matrices_avx2(const LLMatrix4a* a, const LLMatrix4a* b, LLMatrix4a* dst, S32 count)
+    {
+        for (S32 i = 0; i < count; ++i)
+        {
+            avx2_matrix rows;
+            load_matrix(b[i], rows);
+
+            const F32* src = a[i].mMatrix[0].getF32ptr();
+            F32* out = dst[i].mMatrix[0].getF32ptr();
+            for (S32 half = 0; half < 2; ++half)
+            {
+                __m256 v = _mm256_loadu_ps(src + half * 8);
+                __m256 res = _mm256_mul_ps(_mm256_permute_ps(v, 0xFF), rows.mRow[3]);
+                res = _mm256_fmadd_ps(_mm256_permute_ps(v, 0xAA), rows.mRow[2], res);
+                res = _mm256_fmadd_ps(_mm256_permute_ps(v, 0x55), rows.mRow[1], res);
+                res = _mm256_fmadd_ps(_mm256_permute_ps(v, 0x00), rows.mRow[0], res);
+                _mm256_storeu_ps(out + half * 8, res);
+            }
+        }
+    }
+
+    LL_TARGET_AVX2 void get_min_max_avx2(const LLVector4a* src, S32 count, LLVector4a& min, LLVector4a& max)
+    {
+        __m256 min0 = _mm256_broadcast_ps((const __m128*)src[0].getF32ptr());
+        __m256 max0 = min0;
+        __m256 min1 = min0;
+        __m256 max1 = min0;
+
+        S32 i = 1;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256 v0 = _mm256_loadu_ps(src[i].getF32ptr());
+            __m256 v1 = _mm256_loadu_ps(src[i + 2].getF32ptr());
+            min0 = _mm256_min_ps(min0, v0);
+            max0 = _mm256_max_ps(max0, v0);
+            min1 = _mm256_min_ps(min1, v1);
+            max1 = _mm256_max_ps(max1, v1);
+        }
+        for (; i < count; ++i)
+        {
+            __m256 v = _mm256_broadcast_ps((const __m128*)src[i].getF32ptr());
+            min0 = _mm256_min_ps(min0, v);
+            max0 = _mm256_max_ps(max0, v);
+        }
+
+        min0 = _mm256_min_ps(min0, min1);
+        max0 = _mm256_max_ps(max0, max1);
+        min = _mm_min_ps(_mm256_castps256_ps128(min0), _mm256_extractf128_ps(min0, 1));
+        max = _mm_max_ps(_mm256_castps256_ps128(max0), _mm256_extractf128_ps(max0, 1));
+    }
+#endif // LL_X86
+
+    bool cpu_has_avx2()
+    {
+#if LL_X86
+        LLProcessorInfo info;
+        return info.hasAVX2() && info.hasFMA();
+#else
+        return false;
+#endif
+    }
+
+    std::atomic<bool>& use_avx2()
+    {
+        static std::atomic<bool> sUseAVX2(cpu_has_avx2());
+        return sUseAVX2;
+    }
+}
+
+namespace LLVolumeSIMD
+{
+    bool useAVX2()
+    {
+        return use_avx2();
+    }
+
+    void setUseAVX2(bool enable)
+    {
+        use_avx2() = enable && cpu_has_avx2();
+    }
+
+    void transformPositions(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count)
+    {
+#if LL_X86
+        if (use_avx2())
+        {
+            transform_positions_avx2(mat, src, dst, count);
+            return;
+        }
+#endif
+        transform_positions_sse2(mat, src, dst, count);
+    }
+
+    void transformPositions(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count, F32 w)
+    {
+#if LL_X86
+        if (use_avx2())
+        {
+            transform_positions_w_avx2(mat, src, dst, count, w);
+            return;
+        }
+#endif
+        transform_positions_w_sse2(mat, src, dst, count, w);
+    }
+
+    void rotateVectors(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count)
+    {
+#if LL_X86
+        if (use_avx2())
+        {
+            rotate_vectors_avx2(mat, src, dst, count);
+            return;
+        }
+#endif
+        rotate_vectors_sse2(mat, src, dst, count);
+    }
+
+    void rotateTangents(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count)
+    {
+#if LL_X86
+        if (use_avx2())
+        {
+            rotate_tangents_avx2(mat, src, dst, count);
+            return;
+        }
+#endif
+        rotate_tangents_sse2(mat, src, dst, count);
+    }
+
+    void skinPositions(const LLMatrix4a* palette, U32 max_joints, const LLVector4a* weights,
+                       const LLVector4a* src, LLVector4a* dst, S32 count)
+    {
+#if LL_X86
+        if (use_avx2())
+        {
+            skin_positions_avx2(palette, max_joints, weights, src, dst, count);
+            return;
+        }
+#endif
+        skin_positions_sse2(palette, max_joints, weights, src, dst, count);
+    }
+
+    void multiplyMatrices(const LLMatrix4a* a, const LLMatrix4a* b, LLMatrix4a* dst, S32 count)
+    {
+#if LL_X86
+        if (use_avx2())
+        {
+            multiply_matrices_avx2(a, b, dst, count);
+            return;
+        }
+#endif
+        multiply_matrices_sse2(a, b, dst, count);
+    }
+
+    void getMinMax(const LLVector4a* src, S32 count, LLVector4a& min, LLVector4a& max)
+    {
+        llassert(count > 0);
+#if LL_X86
+        if (use_avx2())
+        {
+            get_min_max_avx2(src, count, min, max);
+            return;
+        }
+#endif
+        get_min_max_sse2(src, count, min, max);
+    }
+}
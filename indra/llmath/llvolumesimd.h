@@ -0,0 +1,78 @@
+/**
+ * @file llvolumesimd.h
+ * @brief Batch transform kernels for LLVolumeFace vertex streams
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVOLUMESIMD_H
+#define LL_LLVOLUMESIMD_H
+
+#include "stdtypes.h"
+
+class LLMatrix4a;
+class LLVector4a;
+
+// Kernels that run a whole position, normal or tangent stream through one
+// transform. The SSE2 versions are the per vertex LLMatrix4a calls they
+// replace. On x86 CPUs with AVX2 and FMA, picked at runtime from
+// LLProcessorInfo, two vertices are handled per register and the multiply
+// adds are fused, so results can differ from the SSE2 path in the last bit.
+//
+// Streams are arrays of 16 byte aligned LLVector4a, dst may be src.
+namespace LLVolumeSIMD
+{
+    // Whether the AVX2 kernels are in use
+    bool useAVX2();
+
+    // Turn the AVX2 kernels off (or back on, when the CPU has them)
+    void setUseAVX2(bool enable);
+
+    // dst = mat.affineTransform(src)
+    void transformPositions(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count);
+
+    // As above with the w component of every result replaced by w, used to
+    // carry the texture index in LLFace::getGeometryVolume()
+    void transformPositions(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count, F32 w);
+
+    // dst = mat.rotate(src), for normals
+    void rotateVectors(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count);
+
+    // As rotateVectors(), keeping the w (bitangent sign) of each source tangent
+    void rotateTangents(const LLMatrix4a& mat, const LLVector4a* src, LLVector4a* dst, S32 count);
+
+    // Skin a position stream. weights is in LLVolumeFace::mWeights form: the
+    // integer part of each component is a joint index into palette (clamped
+    // to max_joints - 1) and the fraction its weight. Weights are normalized
+    // per vertex like LLSkinningUtil does.
+    void skinPositions(const LLMatrix4a* palette, U32 max_joints, const LLVector4a* weights,
+                       const LLVector4a* src, LLVector4a* dst, S32 count);
+
+    // dst[i] = matMulUnsafe(a[i], b[i]), for building skinning palettes. dst
+    // must not overlap a or b.
+    void multiplyMatrices(const LLMatrix4a* a, const LLMatrix4a* b, LLMatrix4a* dst, S32 count);
+
+    // Component wise bounds of a stream, count must be at least 1
+    void getMinMax(const LLVector4a* src, S32 count, LLVector4a& min, LLVector4a& max);
+}
+
+#endif // LL_LLVOLUMESIMD_H
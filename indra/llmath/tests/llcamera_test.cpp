@@ -0,0 +1,162 @@
+/**
+ * @file llcamera_test.cpp
+ * @brief Test the batched frustum culls against the single box calls
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llmath.h"
+#include "../llcamera.h"
+#include "../llvector4a.h"
+#include "../llvolumesimd.h"
+
+#include <vector>
+
+namespace
+{
+    F32 random_f32(U32& seed)
+    {
+        seed = seed * 1664525 + 1013904223;
+        return F32(seed >> 8) / F32(1 << 24) * 2.f - 1.f;
+    }
+
+    // A frustum looking down +x from the origin, near at 1 and far at 64
+    void setup_camera(LLCamera& camera, LLPlane* user_clip = NULL)
+    {
+        LLVector3 frust[8];
+        const F32 dist[2] = { 1.f, 64.f };
+        for (S32 i = 0; i < 2; ++i)
+        {
+            const F32 d = dist[i];
+            frust[i * 4 + 0].set(d, d * 0.75f, -d * 0.5f);
+            frust[i * 4 + 1].set(d, -d * 0.75f, -d * 0.5f);
+            frust[i * 4 + 2].set(d, -d * 0.75f, d * 0.5f);
+            frust[i * 4 + 3].set(d, d * 0.75f, d * 0.5f);
+        }
+        camera.calcAgentFrustumPlanes(frust);
+        if (user_clip)
+        {
+            camera.setUserClipPlane(*user_clip);
+        }
+        camera.calcRegionFrustumPlanes(LLVector3(16.f, -8.f, 2.f), 64.f);
+    }
+
+    // Boxes of all sizes in and around the frustum
+    void fill_boxes(std::vector<F32> center[3], std::vector<F32> radius[3], S32 count, U32 seed)
+    {
+        const F32 scale[3] = { 48.f, 40.f, 32.f };
+        for (S32 axis = 0; axis < 3; ++axis)
+        {
+            center[axis].resize(count);
+            radius[axis].resize(count);
+            for (S32 i = 0; i < count; ++i)
+            {
+                center[axis][i] = random_f32(seed) * scale[axis] + (axis == 0 ? 32.f : 0.f);
+                radius[axis][i] = fabsf(random_f32(seed)) * (i % 3 ? 2.f : 16.f);
+            }
+        }
+    }
+
+    void check_batch(LLCamera& camera, S32 count, U32 seed)
+    {
+        std::vector<F32> center[3], radius[3];
+        fill_boxes(center, radius, count, seed);
+        const F32* const center_ptrs[3] = { center[0].data(), center[1].data(), center[2].data() };
+        const F32* const radius_ptrs[3] = { radius[0].data(), radius[1].data(), radius[2].data() };
+
+        std::vector<S32> results[4];
+        for (std::vector<S32>& res : results)
+        {
+            res.assign(count, -1);
+        }
+        camera.AABBInFrustumBatch(center_ptrs, radius_ptrs, count, results[0].data());
+        camera.AABBInFrustumNoFarClipBatch(center_ptrs, radius_ptrs, count, results[1].data());
+        camera.AABBInRegionFrustumBatch(center_ptrs, radius_ptrs, count, results[2].data());
+        camera.AABBInRegionFrustumNoFarClipBatch(center_ptrs, radius_ptrs, count, results[3].data());
+
+        for (S32 i = 0; i < count; ++i)
+        {
+            LLVector4a c(center[0][i], center[1][i], center[2][i]);
+            LLVector4a r(radius[0][i], radius[1][i], radius[2][i]);
+            tut::ensure_equals("in frustum", results[0][i], camera.AABBInFrustum(c, r));
+            tut::ensure_equals("no far clip", results[1][i], camera.AABBInFrustumNoFarClip(c, r));
+            tut::ensure_equals("in region frustum", results[2][i], camera.AABBInRegionFrustum(c, r));
+            tut::ensure_equals("region no far clip", results[3][i], camera.AABBInRegionFrustumNoFarClip(c, r));
+        }
+    }
+}
+
+namespace tut
+{
+    struct camera_data
+    {
+        ~camera_data()
+        {
+            LLVolumeSIMD::setUseAVX2(true);
+        }
+    };
+    typedef test_group<camera_data> camera_test;
+    typedef camera_test::object camera_object;
+    tut::camera_test camera_testcase("LLCamera");
+
+    // Short tails on both the four and eight wide loops
+    const S32 BATCH_SIZES[] = { 1, 3, 4, 5, 7, 8, 9, 64, 1001 };
+
+    template<> template<>
+    void camera_object::test<1>()
+    {
+        // Every box gets the single box result on both paths
+        for (S32 avx2 = 0; avx2 < 2; ++avx2)
+        {
+            LLVolumeSIMD::setUseAVX2(avx2 != 0);
+            for (S32 count : BATCH_SIZES)
+            {
+                LLCamera camera;
+                setup_camera(camera);
+                check_batch(camera, count, count);
+            }
+        }
+    }
+
+    template<> template<>
+    void camera_object::test<2>()
+    {
+        // User clip planes are tested and ignored planes skipped, as in the single box calls
+        for (S32 avx2 = 0; avx2 < 2; ++avx2)
+        {
+            LLVolumeSIMD::setUseAVX2(avx2 != 0);
+
+            LLPlane user_clip(LLVector3(32.f, 0.f, 0.f), LLVector3(0.f, 1.f, 0.f));
+            LLCamera clipped;
+            setup_camera(clipped, &user_clip);
+            check_batch(clipped, 1001, 11);
+
+            LLCamera camera;
+            setup_camera(camera);
+            camera.ignoreAgentFrustumPlane(LLCamera::AGENT_PLANE_LEFT);
+            check_batch(camera, 1001, 12);
+        }
+    }
+}
@@ -0,0 +1,546 @@
+/**
+ * @file llmath_bench.cpp
+ * @brief Microbenchmarks of the llmath kernels
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llmath.h"
+#include "../llmatrix4a.h"
+#include "../llquaternion.h"
+#include "../llvector4a.h"
+#include "../llvolume.h"
+#include "../llvolumebvh.h"
+#include "../llvolumemgr.h"
+#include "../llvolumeoctree.h"
+#include "../llvolumesimd.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Times the llmath kernels the renderer leans on, so SIMD and tessellation
+// changes can be compared with numbers. Every benchmark is calibrated to run
+// for at least MIN_EPOCH_TIME per epoch, and the median of EPOCHS epochs is
+// reported with the spread between the fastest and slowest epoch. A spread
+// over a few percent means the machine was busy and the numbers should not
+// be trusted.
+//
+// Usage: llmath_bench [--csv] [filter]
+// Only benchmarks whose name contains filter are run.
+
+namespace
+{
+    constexpr S32 EPOCHS = 11;
+    constexpr auto MIN_EPOCH_TIME = std::chrono::milliseconds(10);
+    constexpr S32 STREAM_LENGTH = 1024;
+    constexpr S32 RAY_COUNT = 256;
+
+    // Stops the compiler from dropping work whose result is never used
+#if LL_WINDOWS
+    const void* volatile sSink = nullptr;
+    template <typename T> inline void keep(const T& value)
+    {
+        sSink = &value;
+    }
+#else
+    template <typename T> inline void keep(const T& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+#endif
+
+    F32 random_f32(U32& seed)
+    {
+        seed = seed * 1664525 + 1013904223;
+        return F32(seed >> 8) / F32(1 << 24) * 2.f - 1.f;
+    }
+
+    void fill_stream(std::vector<LLVector4a>& stream, U32 seed)
+    {
+        for (LLVector4a& v : stream)
+        {
+            v.set(random_f32(seed), random_f32(seed), random_f32(seed), 1.f);
+        }
+    }
+
+    void fill_matrix(LLMatrix4a& mat, U32 seed)
+    {
+        for (S32 i = 0; i < 4; ++i)
+        {
+            mat.mMatrix[i].set(random_f32(seed), random_f32(seed), random_f32(seed), i == 3 ? 1.f : 0.f);
+        }
+    }
+
+    class Bench
+    {
+    public:
+        Bench(const std::string& filter, bool csv) : mFilter(filter), mCSV(csv) {}
+
+        void header() const
+        {
+            if (mCSV)
+            {
+                printf("name,ns_per_op,ops_per_s,spread_percent\n");
+            }
+            else
+            {
+                printf("%12s %14s %8s  %s\n", "ns/op", "op/s", "spread", "benchmark");
+            }
+        }
+
+        // ops is how many operations one call of func does
+        void run(const std::string& name, S32 ops, const std::function<void()>& func) const
+        {
+            if (!mFilter.empty() && name.find(mFilter) == std::string::npos)
+            {
+                return;
+            }
+
+            typedef std::chrono::steady_clock clock_t;
+
+            // Warm up, then double the calls per epoch until an epoch is long
+            // enough for the clock
+            func();
+            U64 calls = 1;
+            while (true)
+            {
+                const auto start = clock_t::now();
+                for (U64 i = 0; i < calls; ++i)
+                {
+                    func();
+                }
+                if (clock_t::now() - start >= MIN_EPOCH_TIME)
+                {
+                    break;
+                }
+                calls *= 2;
+            }
+
+            std::vector<F64> ns_per_op;
+            for (S32 epoch = 0; epoch < EPOCHS; ++epoch)
+            {
+                const auto start = clock_t::now();
+                for (U64 i = 0; i < calls; ++i)
+                {
+                    func();
+                }
+                const F64 ns = std::chrono::duration<F64, std::nano>(clock_t::now() - start).count();
+                ns_per_op.push_back(ns / ((F64)calls * ops));
+            }
+            std::sort(ns_per_op.begin(), ns_per_op.end());
+
+            const F64 median = ns_per_op[EPOCHS / 2];
+            const F64 spread = (ns_per_op.back() - ns_per_op.front()) / median * 100.0;
+            if (mCSV)
+            {
+                printf("\"%s\",%.4f,%.1f,%.2f\n", name.c_str(), median, 1e9 / median, spread);
+            }
+            else
+            {
+                printf("%12.3f %14.1f %7.1f%%  %s\n", median, 1e9 / median, spread, name.c_str());
+            }
+            fflush(stdout);
+        }
+
+    private:
+        std::string mFilter;
+        bool        mCSV;
+    };
+
+    // ------------------------------------------------------------------------
+    // LLVector4a
+
+    void bench_vector4a(const Bench& bench)
+    {
+        std::vector<LLVector4a> a(STREAM_LENGTH), b(STREAM_LENGTH), out(STREAM_LENGTH);
+        fill_stream(a, 1);
+        fill_stream(b, 2);
+
+        bench.run("LLVector4a setAdd", STREAM_LENGTH, [&]()
+        {
+            for (S32 i = 0; i < STREAM_LENGTH; ++i)
+            {
+                out[i].setAdd(a[i], b[i]);
+            }
+            keep(out[STREAM_LENGTH - 1]);
+        });
+
+        bench.run("LLVector4a setMul", STREAM_LENGTH, [&]()
+        {
+            for (S32 i = 0; i < STREAM_LENGTH; ++i)
+            {
+                out[i].setMul(a[i], b[i]);
+            }
+            keep(out[STREAM_LENGTH - 1]);
+        });
+
+        bench.run("LLVector4a dot3", STREAM_LENGTH, [&]()
+        {
+            LLVector4a sum(0.f);
+            for (S32 i = 0; i < STREAM_LENGTH; ++i)
+            {
+                sum.add(LLVector4a(a[i].dot3(b[i]).getF32()));
+            }
+            keep(sum);
+        });
+
+        bench.run("LLVector4a setCross3", STREAM_LENGTH, [&]()
+        {
+            for (S32 i = 0; i < STREAM_LENGTH; ++i)
+            {
+                out[i].setCross3(a[i], b[i]);
+            }
+            keep(out[STREAM_LENGTH - 1]);
+        });
+
+        bench.run("LLVector4a normalize3fast", STREAM_LENGTH, [&]()
+        {
+            for (S32 i = 0; i < STREAM_LENGTH; ++i)
+            {
+                out[i] = a[i];
+                out[i].normalize3fast();
+            }
+            keep(out[STREAM_LENGTH - 1]);
+        });
+
+        bench.run("LLVector4a setMin/setMax bounds", STREAM_LENGTH, [&]()
+        {
+            LLVector4a min = a[0];
+            LLVector4a max = a[0];
+            for (S32 i = 1; i < STREAM_LENGTH; ++i)
+            {
+                min.setMin(min, a[i]);
+                max.setMax(max, a[i]);
+            }
+            keep(min);
+            keep(max);
+        });
+
+        bench.run("LLVolumeSIMD getMinMax", STREAM_LENGTH, [&]()
+        {
+            LLVector4a min, max;
+            LLVolumeSIMD::getMinMax(a.data(), STREAM_LENGTH, min, max);
+            keep(min);
+            keep(max);
+        });
+    }
+
+    // ------------------------------------------------------------------------
+    // LLMatrix4a
+
+    void bench_matrix4a(const Bench& bench)
+    {
+        std::vector<LLVector4a> src(STREAM_LENGTH), out(STREAM_LENGTH);
+        fill_stream(src, 3);
+        LLMatrix4a mat;
+        fill_matrix(mat, 4);
+
+        std::vector<LLMatrix4a> mats_a(STREAM_LENGTH), mats_b(STREAM_LENGTH), mats_out(STREAM_LENGTH);
+        for (S32 i = 0; i < STREAM_LENGTH; ++i)
+        {
+            fill_matrix(mats_a[i], i + 10);
+            fill_matrix(mats_b[i], i + 20);
+        }
+
+        bench.run("LLMatrix4a affineTransform", STREAM_LENGTH, [&]()
+        {
+            for (S32 i = 0; i < STREAM_LENGTH; ++i)
+            {
+                mat.affineTransform(src[i], out[i]);
+            }
+            keep(out[STREAM_LENGTH - 1]);
+        });
+
+        bench.run("LLMatrix4a rotate", STREAM_LENGTH, [&]()
+        {
+            for (S32 i = 0; i < STREAM_LENGTH; ++i)
+            {
+                mat.rotate(src[i], out[i]);
+            }
+            keep(out[STREAM_LENGTH - 1]);
+        });
+
+        bench.run("LLMatrix4a matMul", STREAM_LENGTH, [&]()
+        {
+            for (S32 i = 0; i < STREAM_LENGTH; ++i)
+            {
+                matMul(mats_a[i], mats_b[i], mats_out[i]);
+            }
+            keep(mats_out[STREAM_LENGTH - 1]);
+        });
+
+        // The batch kernels, on the SSE2 path and on AVX2 when the CPU has it
+        const bool has_avx2 = LLVolumeSIMD::useAVX2();
+        for (S32 avx2 = 0; avx2 < (has_avx2 ? 2 : 1); ++avx2)
+        {
+            LLVolumeSIMD::setUseAVX2(avx2 != 0);
+            const std::string path = avx2 ? " (AVX2)" : " (SSE2)";
+
+            bench.run("LLVolumeSIMD transformPositions" + path, STREAM_LENGTH, [&]()
+            {
+                LLVolumeSIMD::transformPositions(mat, src.data(), out.data(), STREAM_LENGTH);
+                keep(out[STREAM_LENGTH - 1]);
+            });
+
+            bench.run("LLVolumeSIMD rotateVectors" + path, STREAM_LENGTH, [&]()
+            {
+                LLVolumeSIMD::rotateVectors(mat, src.data(), out.data(), STREAM_LENGTH);
+                keep(out[STREAM_LENGTH - 1]);
+            });
+
+            bench.run("LLVolumeSIMD rotateTangents" + path, STREAM_LENGTH, [&]()
+            {
+                LLVolumeSIMD::rotateTangents(mat, src.data(), out.data(), STREAM_LENGTH);
+                keep(out[STREAM_LENGTH - 1]);
+            });
+
+            bench.run("LLVolumeSIMD multiplyMatrices" + path, STREAM_LENGTH, [&]()
+            {
+                LLVolumeSIMD::multiplyMatrices(mats_a.data(), mats_b.data(), mats_out.data(), STREAM_LENGTH);
+                keep(mats_out[STREAM_LENGTH - 1]);
+            });
+        }
+        LLVolumeSIMD::setUseAVX2(true);
+    }
+
+    // ------------------------------------------------------------------------
+    // LLQuaternion
+
+    void bench_quaternion(const Bench& bench)
+    {
+        std::vector<LLQuaternion> from(STREAM_LENGTH), to(STREAM_LENGTH), out(STREAM_LENGTH);
+        U32 seed = 5;
+        for (S32 i = 0; i < STREAM_LENGTH; ++i)
+        {
+            from[i].setAngleAxis(random_f32(seed) * F_PI, LLVector3(random_f32(seed), random_f32(seed), random_f32(seed) + 2.f));
+            to[i].setAngleAxis(random_f32(seed) * F_PI, LLVector3(random_f32(seed) + 2.f, random_f32(seed), random_f32(seed)));
+        }
+
+        bench.run("LLQuaternion slerp", STREAM_LENGTH, [&]()
+        {
+            for (S32 i = 0; i < STREAM_LENGTH; ++i)
+            {
+                out[i] = slerp((F32)i / STREAM_LENGTH, from[i], to[i]);
+            }
+            keep(out[STREAM_LENGTH - 1]);
+        });
+
+        bench.run("LLQuaternion nlerp", STREAM_LENGTH, [&]()
+        {
+            for (S32 i = 0; i < STREAM_LENGTH; ++i)
+            {
+                out[i] = nlerp((F32)i / STREAM_LENGTH, from[i], to[i]);
+            }
+            keep(out[STREAM_LENGTH - 1]);
+        });
+
+        bench.run("LLQuaternion operator*", STREAM_LENGTH, [&]()
+        {
+            for (S32 i = 0; i < STREAM_LENGTH; ++i)
+            {
+                out[i] = from[i] * to[i];
+            }
+            keep(out[STREAM_LENGTH - 1]);
+        });
+    }
+
+    // ------------------------------------------------------------------------
+    // LLVolume
+
+    struct Prim
+    {
+        const char* mName;
+        U8          mProfile;
+        U8          mPath;
+        F32         mRatioY;
+    };
+
+    const Prim PRIMS[] = {
+        { "box",        LL_PCODE_PROFILE_SQUARE,        LL_PCODE_PATH_LINE,     1.f },
+        { "cylinder",   LL_PCODE_PROFILE_CIRCLE,        LL_PCODE_PATH_LINE,     1.f },
+        { "sphere",     LL_PCODE_PROFILE_CIRCLE_HALF,   LL_PCODE_PATH_CIRCLE,   1.f },
+        { "torus",      LL_PCODE_PROFILE_CIRCLE,        LL_PCODE_PATH_CIRCLE,   0.25f },
+    };
+
+    // The detail of each LOD, as LLVolumeLODGroup uses them
+    const F32 DETAILS[] = { 1.f, 1.5f, 2.5f, 4.f };
+
+    LLVolumeParams prim_params(const Prim& prim)
+    {
+        LLVolumeParams params;
+        params.setType(prim.mProfile, prim.mPath);
+        params.setRatio(1.f, prim.mRatioY);
+        return params;
+    }
+
+    void bench_volume(const Bench& bench)
+    {
+        const bool shared = LLVolumeMgr::sShareTessellation;
+        for (const Prim& prim : PRIMS)
+        {
+            const LLVolumeParams params = prim_params(prim);
+            for (S32 lod = 0; lod < (S32)LL_ARRAY_SIZE(DETAILS); ++lod)
+            {
+                for (S32 share = 0; share < 2; ++share)
+                {
+                    LLVolumeMgr::sShareTessellation = share != 0;
+                    bench.run(llformat("LLVolume generate %s lod %d%s", prim.mName, lod, share ? " shared" : ""), 1, [&]()
+                    {
+                        LLPointer<LLVolume> volume = new LLVolume(params, DETAILS[lod]);
+                        keep(volume->getNumVolumeFaces());
+                    });
+                }
+            }
+        }
+        LLVolumeMgr::sShareTessellation = shared;
+
+        // Optimizing a face works on a copy made for each run, the copy alone
+        // is timed as well so it can be taken out
+        for (const Prim& prim : PRIMS)
+        {
+            LLPointer<LLVolume> volume = new LLVolume(prim_params(prim), DETAILS[3]);
+            const LLVolumeFace& face = volume->getVolumeFace(0);
+            const S32 triangles = face.mNumIndices / 3;
+
+            bench.run(llformat("LLVolumeFace copy %s (per triangle)", prim.mName), triangles, [&]()
+            {
+                LLVolumeFace copy(face);
+                keep(copy.mNumVertices);
+            });
+
+            bench.run(llformat("LLVolumeFace copy+cacheOptimize %s (per triangle)", prim.mName), triangles, [&]()
+            {
+                LLVolumeFace copy(face);
+                copy.cacheOptimize(true);
+                keep(copy.mNumVertices);
+            });
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // LLOctree, through the triangle octree of LLVolumeFace, against the BVH
+    // that replaced it for picking
+
+    void bench_octree(const Bench& bench)
+    {
+        for (const Prim& prim : PRIMS)
+        {
+            LLPointer<LLVolume> volume = new LLVolume(prim_params(prim), DETAILS[3]);
+            LLVolumeFace& face = volume->getVolumeFace(0);
+            const S32 triangles = face.mNumIndices / 3;
+
+            bench.run(llformat("LLOctree insert %s (per triangle)", prim.mName), triangles, [&]()
+            {
+                face.createOctree();
+                keep(face.getOctree());
+                face.destroyOctree();
+            });
+
+            bench.run(llformat("LLVolumeBVH build %s (per triangle)", prim.mName), triangles, [&]()
+            {
+                LLVolumeBVH bvh;
+                bvh.build(face.mPositions, face.mIndices, face.mNumIndices);
+                keep(bvh.isEmpty());
+            });
+
+            // Rays through the unit cube the prim sits in, most of them hit
+            std::vector<LLVector4a> starts(RAY_COUNT), dirs(RAY_COUNT);
+            U32 seed = 6;
+            for (S32 i = 0; i < RAY_COUNT; ++i)
+            {
+                LLVector4a end(random_f32(seed) * 0.25f, random_f32(seed) * 0.25f, random_f32(seed) * 0.25f);
+                starts[i].set(random_f32(seed) * 2.f, random_f32(seed) * 2.f, random_f32(seed) * 2.f);
+                dirs[i].setSub(end, starts[i]);
+                dirs[i].mul(2.f);
+            }
+
+            face.createOctree();
+            bench.run(llformat("LLOctree intersect %s (per ray)", prim.mName), RAY_COUNT, [&]()
+            {
+                S32 hits = 0;
+                for (S32 i = 0; i < RAY_COUNT; ++i)
+                {
+                    F32 closest_t = 1.f;
+                    LLVector4a intersection;
+                    LLOctreeTriangleRayIntersect intersect(starts[i], dirs[i], &face, &closest_t, &intersection, nullptr, nullptr, nullptr);
+                    intersect.traverse(face.getOctree());
+                    hits += intersect.mHitFace ? 1 : 0;
+                }
+                keep(hits);
+            });
+            face.destroyOctree();
+
+            LLVolumeBVH bvh;
+            bvh.build(face.mPositions, face.mIndices, face.mNumIndices);
+            bench.run(llformat("LLVolumeBVH intersect %s (per ray)", prim.mName), RAY_COUNT, [&]()
+            {
+                S32 hits = 0;
+                for (S32 i = 0; i < RAY_COUNT; ++i)
+                {
+                    F32 closest_t = 1.f;
+                    F32 a, b;
+                    hits += bvh.intersect(face.mPositions, face.mIndices, starts[i], dirs[i], closest_t, a, b) >= 0 ? 1 : 0;
+                }
+                keep(hits);
+            });
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string filter;
+    bool csv = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--csv"))
+        {
+            csv = true;
+        }
+        else if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h"))
+        {
+            printf("Usage: %s [--csv] [filter]\n", argv[0]);
+            printf("Runs the llmath microbenchmarks whose name contains filter, or all of them.\n");
+            return 0;
+        }
+        else
+        {
+            filter = argv[i];
+        }
+    }
+
+    Bench bench(filter, csv);
+    bench.header();
+    bench_vector4a(bench);
+    bench_matrix4a(bench);
+    bench_quaternion(bench);
+    bench_volume(bench);
+    bench_octree(bench);
+    return 0;
+}
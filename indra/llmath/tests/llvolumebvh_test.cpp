@@ -0,0 +1,191 @@
+/**
+ * @file llvolumebvh_test.cpp
+ * @brief Test the picking hierarchy against testing every triangle
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llmath.h"
+#include "../llvector4a.h"
+#include "../llvolume.h"
+#include "../llvolumebvh.h"
+#include "lltimer.h"
+
+#include <vector>
+
+namespace
+{
+    F32 random_f32(U32& seed)
+    {
+        seed = seed * 1664525 + 1013904223;
+        return F32(seed >> 8) / F32(1 << 24) * 2.f - 1.f;
+    }
+
+    // Small triangles scattered through the unit cube
+    void fill_soup(std::vector<LLVector4a>& positions, std::vector<U16>& indices, S32 num_triangles, U32 seed)
+    {
+        positions.resize(num_triangles * 3);
+        indices.resize(num_triangles * 3);
+        for (S32 i = 0; i < num_triangles; ++i)
+        {
+            F32 center[3] = { random_f32(seed), random_f32(seed), random_f32(seed) };
+            for (S32 j = 0; j < 3; ++j)
+            {
+                positions[i * 3 + j].set(center[0] + random_f32(seed) * 0.1f,
+                                         center[1] + random_f32(seed) * 0.1f,
+                                         center[2] + random_f32(seed) * 0.1f);
+                indices[i * 3 + j] = (U16)(i * 3 + j);
+            }
+        }
+    }
+
+    S32 brute_force(const std::vector<LLVector4a>& positions, const std::vector<U16>& indices,
+                    const LLVector4a& start, const LLVector4a& dir, F32& closest_t)
+    {
+        S32 hit = -1;
+        for (size_t i = 0; i < indices.size() / 3; ++i)
+        {
+            F32 a, b, t;
+            if (LLTriangleRayIntersect(positions[indices[i * 3]], positions[indices[i * 3 + 1]], positions[indices[i * 3 + 2]],
+                                       start, dir, a, b, t) &&
+                t >= 0.f && t <= 1.f && t < closest_t)
+            {
+                closest_t = t;
+                hit = (S32)i;
+            }
+        }
+        return hit;
+    }
+}
+
+namespace tut
+{
+    struct volumebvh_data
+    {
+    };
+    typedef test_group<volumebvh_data> volumebvh_test;
+    typedef volumebvh_test::object volumebvh_object;
+    tut::volumebvh_test volumebvh_testcase("LLVolumeBVH");
+
+    template<> template<>
+    void volumebvh_object::test<1>()
+    {
+        // Same closest triangle as testing them all, for sizes that make a
+        // lone leaf, a partly filled root and deep trees
+        const S32 SOUP_SIZES[] = { 1, 2, 3, 5, 17, 300, 5000 };
+        U32 seed = 7;
+        for (S32 num_triangles : SOUP_SIZES)
+        {
+            std::vector<LLVector4a> positions;
+            std::vector<U16> indices;
+            fill_soup(positions, indices, num_triangles, num_triangles);
+
+            LLVolumeBVH bvh;
+            bvh.build(positions.data(), indices.data(), (S32)indices.size());
+            ensure("built", !bvh.isEmpty());
+
+            for (S32 ray = 0; ray < 500; ++ray)
+            {
+                LLVector4a start(random_f32(seed) * 2.f, random_f32(seed) * 2.f, random_f32(seed) * 2.f);
+                LLVector4a end(random_f32(seed) * 2.f, random_f32(seed) * 2.f, random_f32(seed) * 2.f);
+                if (ray % 5 == 0)
+                {
+                    // Axis aligned, zero direction components
+                    end = start;
+                    end.getF32ptr()[ray % 3] += 4.f;
+                }
+                LLVector4a dir;
+                dir.setSub(end, start);
+
+                F32 expected_t = 2.f;
+                S32 expected = brute_force(positions, indices, start, dir, expected_t);
+
+                F32 closest_t = 2.f;
+                F32 a = 0.f, b = 0.f;
+                S32 hit = bvh.intersect(positions.data(), indices.data(), start, dir, closest_t, a, b);
+                ensure_equals("same triangle", hit, expected);
+                if (hit >= 0)
+                {
+                    ensure_equals("same distance", closest_t, expected_t);
+                    ensure("barycentrics in range", a >= 0.f && b >= 0.f && a + b <= 1.0001f);
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void volumebvh_object::test<2>()
+    {
+        // Hits beyond closest_t are ignored, so faces can be tested in turn
+        std::vector<LLVector4a> positions(3);
+        positions[0].set(-1.f, -1.f, 0.f);
+        positions[1].set(1.f, -1.f, 0.f);
+        positions[2].set(0.f, 1.f, 0.f);
+        U16 indices[3] = { 0, 1, 2 };
+
+        LLVolumeBVH bvh;
+        bvh.build(positions.data(), indices, 3);
+
+        LLVector4a start(0.f, 0.f, 1.f);
+        LLVector4a dir(0.f, 0.f, -2.f);
+        F32 a, b;
+        F32 closest_t = 2.f;
+        ensure_equals("hit", bvh.intersect(positions.data(), indices, start, dir, closest_t, a, b), 0);
+        ensure_equals("halfway", closest_t, 0.5f);
+
+        closest_t = 0.25f;
+        ensure_equals("closer hit wins", bvh.intersect(positions.data(), indices, start, dir, closest_t, a, b), -1);
+        ensure_equals("closest_t untouched", closest_t, 0.25f);
+    }
+
+    template<> template<>
+    void volumebvh_object::test<3>()
+    {
+        // Idle hierarchies are purged and accounted for
+        std::vector<LLVector4a> positions;
+        std::vector<U16> indices;
+        fill_soup(positions, indices, 100, 3);
+
+        size_t before = LLVolumeBVH::getTotalMemoryUsage();
+        LLVolumeBVH bvh;
+        bvh.build(positions.data(), indices.data(), (S32)indices.size());
+        ensure("memory counted", bvh.getMemoryUsage() > 0);
+        ensure_equals("total includes it", LLVolumeBVH::getTotalMemoryUsage(), before + bvh.getMemoryUsage());
+
+        LLVolumeBVH::purgeUnused(3600.f);
+        ensure("recently used is kept", !bvh.isEmpty());
+
+        ms_sleep(2);
+        LLVolumeBVH::purgeUnused(0.f);
+        ensure("idle is purged", bvh.isEmpty());
+        ensure_equals("memory released", LLVolumeBVH::getTotalMemoryUsage(), before);
+
+        F32 closest_t = 2.f;
+        F32 a, b;
+        LLVector4a start(0.f, 0.f, 2.f);
+        LLVector4a dir(0.f, 0.f, -4.f);
+        ensure_equals("purged misses", bvh.intersect(positions.data(), indices.data(), start, dir, closest_t, a, b), -1);
+    }
+}
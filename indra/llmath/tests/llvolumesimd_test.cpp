@@ -0,0 +1,241 @@
+/**
+ * @file llvolumesimd_test.cpp
+ * @brief Test the vertex stream kernels against the LLMatrix4a calls they replace
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llmath.h"
+#include "../llmatrix4a.h"
+#include "../llvector4a.h"
+#include "../llvolumesimd.h"
+
+#include <vector>
+
+namespace
+{
+    typedef std::vector<LLVector4a> stream_t;
+
+    F32 random_f32(U32& seed)
+    {
+        seed = seed * 1664525 + 1013904223;
+        return F32(seed >> 8) / F32(1 << 24) * 4.f - 2.f;
+    }
+
+    void fill_stream(stream_t& stream, U32 seed)
+    {
+        for (LLVector4a& v : stream)
+        {
+            v.set(random_f32(seed), random_f32(seed), random_f32(seed), random_f32(seed));
+        }
+    }
+
+    void fill_matrix(LLMatrix4a& mat, U32 seed)
+    {
+        for (S32 i = 0; i < 4; ++i)
+        {
+            mat.mMatrix[i].set(random_f32(seed), random_f32(seed), random_f32(seed), i == 3 ? 1.f : 0.f);
+        }
+    }
+
+    // Only the fused multiply adds of the AVX2 path may change the result
+    bool streams_match(const stream_t& a, const stream_t& b)
+    {
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            for (S32 j = 0; j < 4; ++j)
+            {
+                if (fabsf(a[i][j] - b[i][j]) > 1e-5f)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+namespace tut
+{
+    struct volumesimd_data
+    {
+        ~volumesimd_data()
+        {
+            LLVolumeSIMD::setUseAVX2(true);
+        }
+    };
+    typedef test_group<volumesimd_data> volumesimd_test;
+    typedef volumesimd_test::object volumesimd_object;
+    tut::volumesimd_test volumesimd_testcase("LLVolumeSIMD");
+
+    // Odd lengths cover the pair, single vertex and unrolled loops
+    const S32 STREAM_LENGTHS[] = { 1, 2, 3, 4, 5, 7, 64, 1001 };
+
+    template<> template<>
+    void volumesimd_object::test<1>()
+    {
+        // Positions, normals and tangents match the per vertex LLMatrix4a calls on both paths
+        LLMatrix4a mat;
+        fill_matrix(mat, 1);
+
+        for (S32 avx2 = 0; avx2 < 2; ++avx2)
+        {
+            LLVolumeSIMD::setUseAVX2(avx2 != 0);
+            for (S32 count : STREAM_LENGTHS)
+            {
+                stream_t src(count), out(count), expected(count);
+                fill_stream(src, count);
+
+                for (S32 i = 0; i < count; ++i)
+                {
+                    mat.affineTransform(src[i], expected[i]);
+                }
+                LLVolumeSIMD::transformPositions(mat, src.data(), out.data(), count);
+                ensure("positions match", streams_match(out, expected));
+
+                for (S32 i = 0; i < count; ++i)
+                {
+                    expected[i].getF32ptr()[3] = 3.f;
+                }
+                LLVolumeSIMD::transformPositions(mat, src.data(), out.data(), count, 3.f);
+                ensure("positions with w match", streams_match(out, expected));
+
+                for (S32 i = 0; i < count; ++i)
+                {
+                    mat.rotate(src[i], expected[i]);
+                }
+                LLVolumeSIMD::rotateVectors(mat, src.data(), out.data(), count);
+                ensure("normals match", streams_match(out, expected));
+
+                for (S32 i = 0; i < count; ++i)
+                {
+                    expected[i].getF32ptr()[3] = src[i][3];
+                }
+                // In place, as the skinning path uses it
+                out = src;
+                LLVolumeSIMD::rotateTangents(mat, out.data(), out.data(), count);
+                ensure("tangents match", streams_match(out, expected));
+            }
+        }
+    }
+
+    template<> template<>
+    void volumesimd_object::test<2>()
+    {
+        // Skinning matches blending the palette per vertex, out of range joints are clamped
+        const U32 max_joints = 8;
+        LLMatrix4a palette[max_joints];
+        for (U32 i = 0; i < max_joints; ++i)
+        {
+            fill_matrix(palette[i], i + 10);
+        }
+
+        for (S32 avx2 = 0; avx2 < 2; ++avx2)
+        {
+            LLVolumeSIMD::setUseAVX2(avx2 != 0);
+            for (S32 count : STREAM_LENGTHS)
+            {
+                stream_t src(count), weights(count), out(count), expected(count);
+                fill_stream(src, count);
+                for (S32 i = 0; i < count; ++i)
+                {
+                    weights[i].set((F32)(i % 8) + 0.5f, 3.25f, (F32)((i * 3) % 8) + 0.125f, 11.125f);
+
+                    const S32 idx[4] = { i % 8, 3, (i * 3) % 8, 7 };
+                    const F32 wght[4] = { 0.5f, 0.25f, 0.125f, 0.125f };
+                    LLMatrix4a final_mat;
+                    final_mat.clear();
+                    for (S32 k = 0; k < 4; ++k)
+                    {
+                        LLMatrix4a joint_mat;
+                        joint_mat.setMul(palette[idx[k]], wght[k]);
+                        final_mat.add(joint_mat);
+                    }
+                    final_mat.affineTransform(src[i], expected[i]);
+                }
+
+                LLVolumeSIMD::skinPositions(palette, max_joints, weights.data(), src.data(), out.data(), count);
+                ensure("skinned positions match", streams_match(out, expected));
+            }
+        }
+    }
+
+    template<> template<>
+    void volumesimd_object::test<3>()
+    {
+        // Bounds are exact on both paths
+        for (S32 avx2 = 0; avx2 < 2; ++avx2)
+        {
+            LLVolumeSIMD::setUseAVX2(avx2 != 0);
+            for (S32 count : STREAM_LENGTHS)
+            {
+                stream_t src(count);
+                fill_stream(src, count + 100);
+
+                LLVector4a expected_min = src[0];
+                LLVector4a expected_max = src[0];
+                for (S32 i = 1; i < count; ++i)
+                {
+                    expected_min.setMin(expected_min, src[i]);
+                    expected_max.setMax(expected_max, src[i]);
+                }
+
+                LLVector4a min, max;
+                LLVolumeSIMD::getMinMax(src.data(), count, min, max);
+                ensure("min matches", min.equals4(expected_min));
+                ensure("max matches", max.equals4(expected_max));
+            }
+        }
+    }
+
+    template<> template<>
+    void volumesimd_object::test<4>()
+    {
+        // Palette products match matMulUnsafe on both paths
+        for (S32 avx2 = 0; avx2 < 2; ++avx2)
+        {
+            LLVolumeSIMD::setUseAVX2(avx2 != 0);
+            for (S32 count : STREAM_LENGTHS)
+            {
+                std::vector<LLMatrix4a> a(count), b(count), out(count);
+                for (S32 i = 0; i < count; ++i)
+                {
+                    fill_matrix(a[i], i + 20);
+                    fill_matrix(b[i], i + 5000);
+                }
+                LLVolumeSIMD::multiplyMatrices(a.data(), b.data(), out.data(), count);
+
+                for (S32 i = 0; i < count; ++i)
+                {
+                    LLMatrix4a expected;
+                    matMulUnsafe(a[i], b[i], expected);
+                    stream_t expected_rows(expected.mMatrix, expected.mMatrix + 4);
+                    stream_t out_rows(out[i].mMatrix, out[i].mMatrix + 4);
+                    ensure("products match", streams_match(out_rows, expected_rows));
+                }
+            }
+        }
+    }
+}
@@ -339,3 +339,40 @@ U64 LLMeshOptimizer::simplify(U16 *destination,
     }
 }
 
+// <FS> GLTF meshopt compression
+//static
+bool LLMeshOptimizer::decodeVertexBuffer(void* destination, U64 vertex_count, U64 vertex_size, const U8* buffer, U64 buffer_size)
+{
+    return meshopt_decodeVertexBuffer(destination, vertex_count, vertex_size, buffer, buffer_size) == 0;
+}
+
+//static
+bool LLMeshOptimizer::decodeIndexBuffer(void* destination, U64 index_count, U64 index_size, const U8* buffer, U64 buffer_size)
+{
+    return meshopt_decodeIndexBuffer(destination, index_count, index_size, buffer, buffer_size) == 0;
+}
+
+//static
+bool LLMeshOptimizer::decodeIndexSequence(void* destination, U64 index_count, U64 index_size, const U8* buffer, U64 buffer_size)
+{
+    return meshopt_decodeIndexSequence(destination, index_count, index_size, buffer, buffer_size) == 0;
+}
+
+//static
+void LLMeshOptimizer::decodeFilterOct(void* buffer, U64 count, U64 stride)
+{
+    meshopt_decodeFilterOct(buffer, count, stride);
+}
+
+//static
+void LLMeshOptimizer::decodeFilterQuat(void* buffer, U64 count, U64 stride)
+{
+    meshopt_decodeFilterQuat(buffer, count, stride);
+}
+
+//static
+void LLMeshOptimizer::decodeFilterExp(void* buffer, U64 count, U64 stride)
+{
+    meshopt_decodeFilterExp(buffer, count, stride);
+}
+// </FS>
@@ -150,6 +150,20 @@ public:
         F32 target_error,
         bool sloppy,
         F32* result_error);
+
+    // <FS> GLTF meshopt compression
+    // Decoders for EXT_meshopt_compression buffer views, false if the
+    // encoded data is malformed or doesn't match the given sizes.
+    // vertex_size must be a multiple of 4, index_size 2 or 4.
+    static bool decodeVertexBuffer(void* destination, U64 vertex_count, U64 vertex_size, const U8* buffer, U64 buffer_size);
+    static bool decodeIndexBuffer(void* destination, U64 index_count, U64 index_size, const U8* buffer, U64 buffer_size);
+    static bool decodeIndexSequence(void* destination, U64 index_count, U64 index_size, const U8* buffer, U64 buffer_size);
+
+    // Filters run in place over decoded vertex data
+    static void decodeFilterOct(void* buffer, U64 count, U64 stride);
+    static void decodeFilterQuat(void* buffer, U64 count, U64 stride);
+    static void decodeFilterExp(void* buffer, U64 count, U64 stride);
+    // </FS>
 private:
 };
 
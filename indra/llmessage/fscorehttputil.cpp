@@ -72,7 +72,8 @@ namespace FSCoreHttpUtil
         postDataBuffer->append( postData.c_str(), postData.size() );
 
         LLCoros::instance().launch("HttpCoroutineAdapter::genericPostCoroRaw",
-                                   boost::bind(trivialPostCoroRaw, url, LLCore::HttpRequest::DEFAULT_POLICY_ID, postDataBuffer, aHeader, options, success, failure));
+                                   boost::bind(trivialPostCoroRaw, url, LLCore::HttpRequest::DEFAULT_POLICY_ID, postDataBuffer, aHeader, options, success, failure),
+                                   LLCoros::STACK_SMALL);
     }
 
     void trivialGetCoroRaw(std::string url, LLCore::HttpRequest::policy_t policyId, LLCore::HttpHeaders::ptr_t aHeader, LLCore::HttpOptions::ptr_t options, completionCallback_t success, completionCallback_t failure)
@@ -113,7 +114,8 @@ namespace FSCoreHttpUtil
     void callbackHttpGetRaw(const std::string &url, completionCallback_t success, completionCallback_t failure, LLCore::HttpHeaders::ptr_t aHeader, LLCore::HttpOptions::ptr_t options)
     {
         LLCoros::instance().launch("HttpCoroutineAdapter::genericGetCoroRaw",
-                                   boost::bind(trivialGetCoroRaw, url, LLCore::HttpRequest::DEFAULT_POLICY_ID, aHeader, options, success, failure));
+                                   boost::bind(trivialGetCoroRaw, url, LLCore::HttpRequest::DEFAULT_POLICY_ID, aHeader, options, success, failure),
+                                   LLCoros::STACK_SMALL);
     }
 
     void trivialGetCoro(std::string url, time_t last_modified, completionCallback_t success, completionCallback_t failure)
@@ -148,6 +150,6 @@ namespace FSCoreHttpUtil
 
     void callbackHttpGet(const std::string &url, const time_t& last_modified, completionCallback_t success, completionCallback_t failure)
     {
-        LLCoros::instance().launch("HttpCoroutineAdapter::genericGetCoro", boost::bind(&trivialGetCoro, url, last_modified, success, failure));
+        LLCoros::instance().launch("HttpCoroutineAdapter::genericGetCoro", boost::bind(&trivialGetCoro, url, last_modified, success, failure), LLCoros::STACK_SMALL);
     }
 }
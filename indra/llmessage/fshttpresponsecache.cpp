@@ -0,0 +1,402 @@
+/**
+ * @file fshttpresponsecache.cpp
+ * @brief Conditional GET cache for capability responses
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (c) 2024 The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "fshttpresponsecache.h"
+
+#include "bufferarray.h"
+#include "hbxxh.h"
+#include "llcoros.h"
+#include "lldir.h"
+#include "llfile.h"
+#include "llhttpconstants.h"
+#include "llsdserialize.h"
+#include "workqueue.h"
+
+#include <boost/filesystem.hpp>
+
+namespace
+{
+    // Larger bodies are passed through untouched
+    constexpr size_t MAX_ENTRY_SIZE = 1024 * 1024;
+    constexpr size_t MAX_MEMORY_SIZE = 4 * 1024 * 1024;
+
+    const std::string FILE_EXTENSION(".llsd");
+
+    // Runs fn on the General queue when called from a coroutine, so the
+    // caller only suspends; elsewhere it runs in place.
+    template <typename FN>
+    auto run_off_main(FN&& fn) -> decltype(fn())
+    {
+        LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+        if (general_queue && !LLCoros::getName().empty())
+        {
+            try
+            {
+                return general_queue->waitForResult(std::forward<FN>(fn));
+            }
+            catch (const LL::WorkQueue::Closed&)
+            {
+            }
+        }
+        return fn();
+    }
+
+    void post_or_run(std::function<void()> fn)
+    {
+        LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+        if (!general_queue || !general_queue->post(fn))
+        {
+            fn();
+        }
+    }
+
+    // Removes the oldest files until the directory fits in limit bytes
+    void purge_directory(const std::string& dir, U64 limit)
+    {
+        boost::system::error_code ec;
+#if LL_WINDOWS
+        std::wstring path(utf8str_to_utf16str(dir));
+#else
+        std::string path(dir);
+#endif
+        typedef std::pair<std::time_t, std::pair<uintmax_t, boost::filesystem::path>> file_info_t;
+        std::vector<file_info_t> files;
+        U64 total = 0;
+
+        boost::filesystem::directory_iterator iter(path, ec);
+        while (!ec.failed() && iter != boost::filesystem::directory_iterator())
+        {
+            if (boost::filesystem::is_regular_file(*iter, ec) && !ec.failed())
+            {
+                uintmax_t size = boost::filesystem::file_size(*iter, ec);
+                std::time_t modified = boost::filesystem::last_write_time(*iter, ec);
+                if (!ec.failed())
+                {
+                    files.push_back(file_info_t(modified, { size, iter->path() }));
+                    total += size;
+                }
+            }
+            iter.increment(ec);
+        }
+
+        if (total <= limit)
+        {
+            return;
+        }
+
+        std::sort(files.begin(), files.end(), [](const file_info_t& x, const file_info_t& y)
+        {
+            return x.first < y.first;
+        });
+        for (const file_info_t& file : files)
+        {
+            if (total <= limit)
+            {
+                break;
+            }
+            boost::filesystem::remove(file.second.second, ec);
+            total -= file.second.first;
+        }
+    }
+}
+
+FSHttpResponseCache::FSHttpResponseCache() :
+    mMemorySize(0),
+    mEnabled(true),
+    mHits(0),
+    mStores(0)
+{
+}
+
+FSHttpResponseCache::~FSHttpResponseCache()
+{
+    if (mHits || mStores)
+    {
+        LL_INFOS("CoreHTTP") << "Response cache: " << mHits << " responses revalidated, " << mStores << " stored" << LL_ENDL;
+    }
+}
+
+void FSHttpResponseCache::setDirectory(const std::string& dir, U64 disk_limit)
+{
+    clear();
+    mDirectory = dir;
+    if (mDirectory.empty())
+    {
+        return;
+    }
+
+    LLFile::mkdir(mDirectory);
+    std::string purge_dir(mDirectory);
+    post_or_run([purge_dir, disk_limit]() { purge_directory(purge_dir, disk_limit); });
+}
+
+// static
+std::string FSHttpResponseCache::makeKey(const std::string& name, const std::string& url, const LLCore::HttpHeaders::ptr_t& headers)
+{
+    static const std::string cap_marker("/cap/");
+
+    // Drop the scheme, and for capabilities host and capability id too
+    std::string::size_type start = url.find("://");
+    start = (start == std::string::npos) ? 0 : start + 3;
+    std::string::size_type cap = url.find(cap_marker, start);
+    if (cap != std::string::npos)
+    {
+        start = url.find_first_of("/?", cap + cap_marker.size());
+        if (start == std::string::npos)
+        {
+            start = url.size();
+        }
+    }
+
+    std::string key(name);
+    key += '|';
+    key.append(url, start, std::string::npos);
+    const std::string* accept = headers ? headers->find(HTTP_OUT_HEADER_ACCEPT) : nullptr;
+    if (accept)
+    {
+        key += '|';
+        key += *accept;
+    }
+    return key;
+}
+
+bool FSHttpResponseCache::addValidators(const std::string& key, const LLCore::HttpHeaders::ptr_t& headers)
+{
+    if (!headers || headers->find(HTTP_OUT_HEADER_IF_NONE_MATCH) || headers->find(HTTP_OUT_HEADER_IF_MODIFIED_SINCE))
+    {
+        return false;
+    }
+
+    Entry* entry = find(key);
+    if (!entry)
+    {
+        entry = load(key);
+    }
+    if (entry)
+    {
+        if (!entry->mETag.empty())
+        {
+            headers->append(HTTP_OUT_HEADER_IF_NONE_MATCH, entry->mETag);
+        }
+        if (!entry->mLastModified.empty())
+        {
+            headers->append(HTTP_OUT_HEADER_IF_MODIFIED_SINCE, entry->mLastModified);
+        }
+    }
+    return true;
+}
+
+void FSHttpResponseCache::onResponse(const std::string& key, LLCore::HttpResponse* response)
+{
+    static const LLCore::HttpStatus not_modified(HTTP_NOT_MODIFIED);
+
+    const LLCore::HttpStatus status(response->getStatus());
+    if (status == not_modified)
+    {
+        Entry* entry = find(key);
+        if (!entry)
+        {
+            entry = load(key);
+        }
+        if (!entry)
+        {   // Evicted since the request went out; the caller sees the 304
+            return;
+        }
+
+        LLCore::BufferArray* body = new LLCore::BufferArray();
+        body->append(entry->mBody.data(), entry->mBody.size());
+        response->setBody(body);
+        body->release();
+        response->setStatus(LLCore::HttpStatus(HTTP_OK));
+        response->setContentType(entry->mContentType);
+        LLCore::HttpHeaders::ptr_t headers(response->getHeaders());
+        if (headers && !entry->mContentType.empty() && !headers->find(HTTP_IN_HEADER_CONTENT_TYPE))
+        {
+            headers->append(HTTP_IN_HEADER_CONTENT_TYPE, entry->mContentType);
+        }
+        ++mHits;
+        return;
+    }
+
+    if (!status)
+    {
+        return;
+    }
+
+    LLCore::HttpHeaders::ptr_t headers(response->getHeaders());
+    const std::string* etag = headers ? headers->find(HTTP_IN_HEADER_ETAG) : nullptr;
+    const std::string* last_modified = headers ? headers->find(HTTP_IN_HEADER_LAST_MODIFIED) : nullptr;
+    const std::string* cache_control = headers ? headers->find(HTTP_IN_HEADER_CACHE_CONTROL) : nullptr;
+    LLCore::BufferArray* body = response->getBody();
+    const size_t size = body ? body->size() : 0;
+    if ((!etag && !last_modified) || (cache_control && cache_control->find("no-store") != std::string::npos) ||
+        size > MAX_ENTRY_SIZE)
+    {
+        erase(key);
+        if (!mDirectory.empty())
+        {
+            std::string path(filename(key));
+            post_or_run([path]() { LLFile::remove(path, ENOENT); });
+        }
+        return;
+    }
+
+    Entry entry;
+    entry.mKey = key;
+    entry.mETag = etag ? *etag : std::string();
+    entry.mLastModified = last_modified ? *last_modified : std::string();
+    entry.mContentType = response->getContentType();
+    entry.mBody.resize(size);
+    if (size)
+    {
+        body->read(0, entry.mBody.data(), size);
+    }
+    store(std::move(entry), true);
+    ++mStores;
+}
+
+void FSHttpResponseCache::clear()
+{
+    mEntries.clear();
+    mIndex.clear();
+    mMemorySize = 0;
+}
+
+FSHttpResponseCache::Entry* FSHttpResponseCache::find(const std::string& key)
+{
+    auto it = mIndex.find(key);
+    if (it == mIndex.end())
+    {
+        return nullptr;
+    }
+    mEntries.splice(mEntries.begin(), mEntries, it->second);
+    return &mEntries.front();
+}
+
+FSHttpResponseCache::Entry* FSHttpResponseCache::load(const std::string& key)
+{
+    if (mDirectory.empty())
+    {
+        return nullptr;
+    }
+
+    const std::string path(filename(key));
+    std::unique_ptr<Entry> loaded = run_off_main([path, key]()
+    {
+        std::unique_ptr<Entry> result;
+        llifstream file(path.c_str(), std::ios::in | std::ios::binary);
+        LLSD data;
+        if (!file.is_open() || LLSDSerialize::fromBinary(data, file, MAX_ENTRY_SIZE * 2) <= 0 ||
+            data["key"].asString() != key)
+        {
+            return result;
+        }
+        result = std::make_unique<Entry>();
+        result->mKey = key;
+        result->mETag = data["etag"].asString();
+        result->mLastModified = data["last_modified"].asString();
+        result->mContentType = data["content_type"].asString();
+        const LLSD::Binary& body = data["body"].asBinary();
+        result->mBody.assign(body.begin(), body.end());
+        return result;
+    });
+
+    if (!loaded)
+    {
+        return nullptr;
+    }
+    store(std::move(*loaded), false);
+    return &mEntries.front();
+}
+
+void FSHttpResponseCache::store(Entry&& entry, bool write)
+{
+    erase(entry.mKey);
+
+    if (write && !mDirectory.empty())
+    {
+        LLSD data;
+        data["key"] = entry.mKey;
+        data["etag"] = entry.mETag;
+        data["last_modified"] = entry.mLastModified;
+        data["content_type"] = entry.mContentType;
+        data["body"] = LLSD::Binary(entry.mBody.begin(), entry.mBody.end());
+        std::ostringstream out;
+        LLSDSerialize::toBinary(data, out);
+
+        std::string path(filename(entry.mKey));
+        std::string contents(out.str());
+        post_or_run([path, contents]()
+        {
+            const std::string temp(path + ".tmp");
+            {
+                llofstream file(temp.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+                if (!file.is_open())
+                {
+                    return;
+                }
+                file.write(contents.data(), contents.size());
+            }
+            LLFile::rename(temp, path);
+        });
+    }
+
+    mMemorySize += entry.mBody.size();
+    mEntries.push_front(std::move(entry));
+    mIndex[mEntries.front().mKey] = mEntries.begin();
+    trimMemory();
+}
+
+void FSHttpResponseCache::erase(const std::string& key)
+{
+    auto it = mIndex.find(key);
+    if (it != mIndex.end())
+    {
+        mMemorySize -= it->second->mBody.size();
+        mEntries.erase(it->second);
+        mIndex.erase(it);
+    }
+}
+
+void FSHttpResponseCache::trimMemory()
+{
+    // Keep the newest entry even when it is over the limit on its own
+    while (mMemorySize > MAX_MEMORY_SIZE && mEntries.size() > 1)
+    {
+        const Entry& oldest = mEntries.back();
+        mMemorySize -= oldest.mBody.size();
+        mIndex.erase(oldest.mKey);
+        mEntries.pop_back();
+    }
+}
+
+std::string FSHttpResponseCache::filename(const std::string& key) const
+{
+    return gDirUtilp->add(mDirectory, HBXXH128::digest(key).asString() + FILE_EXTENSION);
+}
@@ -0,0 +1,107 @@
+/**
+ * @file fshttpresponsecache.h
+ * @brief Conditional GET cache for capability responses
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (c) 2024 The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_HTTPRESPONSECACHE_H
+#define FS_HTTPRESPONSECACHE_H
+
+#include "llsingleton.h"
+#include "httpheaders.h"
+#include "httpresponse.h"
+
+#include <list>
+#include <unordered_map>
+
+// Keeps the body of capability GET responses that came with an ETag or
+// Last-Modified header, sends the matching validators with the next GET
+// of the same resource and turns a 304 Not Modified back into the stored
+// 200 response before the handler sees it.
+//
+// Capability URLs change with every session and region, so entries are
+// keyed by a name the caller picks plus the part of the URL after the
+// capability id (see makeKey()). Entries live in memory and, once
+// setDirectory() was called, in one file each below that directory.
+//
+// All methods are meant to be called from the main thread (coroutines
+// included); file reads and writes go to the "General" work queue.
+class FSHttpResponseCache : public LLSingleton<FSHttpResponseCache>
+{
+    LLSINGLETON(FSHttpResponseCache);
+    ~FSHttpResponseCache();
+
+public:
+    // Empty directory keeps the cache in memory only. Files beyond
+    // disk_limit bytes are purged, oldest first.
+    void setDirectory(const std::string& dir, U64 disk_limit);
+    void setEnabled(bool enabled)   { mEnabled = enabled; }
+    bool isEnabled() const          { return mEnabled; }
+
+    // Key for a GET of url made under the given name. The accept header
+    // is part of the key since it picks the body format.
+    static std::string makeKey(const std::string& name, const std::string& url, const LLCore::HttpHeaders::ptr_t& headers);
+
+    // Adds If-None-Match and If-Modified-Since for a stored entry.
+    // Returns false, leaving headers alone, when the caller already set
+    // validators of its own; such requests are not cached.
+    bool addValidators(const std::string& key, const LLCore::HttpHeaders::ptr_t& headers);
+
+    // Stores a fresh response or turns a 304 into the stored one.
+    void onResponse(const std::string& key, LLCore::HttpResponse* response);
+
+    void clear();
+
+    U32 getHits() const             { return mHits; }
+    U32 getStores() const           { return mStores; }
+
+private:
+    struct Entry
+    {
+        std::string mKey;
+        std::string mETag;
+        std::string mLastModified;
+        std::string mContentType;
+        std::string mBody;
+    };
+    typedef std::list<Entry> entry_list_t;
+
+    Entry* find(const std::string& key);
+    Entry* load(const std::string& key);
+    void store(Entry&& entry, bool write);
+    void erase(const std::string& key);
+    void trimMemory();
+    std::string filename(const std::string& key) const;
+
+    entry_list_t    mEntries;   // most recently used first
+    std::unordered_map<std::string, entry_list_t::iterator> mIndex;
+    size_t          mMemorySize;
+
+    std::string     mDirectory;
+    bool            mEnabled;
+    U32             mHits;
+    U32             mStores;
+};
+
+#endif // FS_HTTPRESPONSECACHE_H
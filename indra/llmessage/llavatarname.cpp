@@ -128,6 +128,66 @@ void LLAvatarName::fromLLSD(const LLSD& sd)
     }
 }
 
+// <FS> Binary name cache
+namespace
+{
+    void pack_string(std::string& out, const std::string& str)
+    {
+        const U16 length = (U16)llmin(str.size(), (size_t)U16_MAX);
+        out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.append(str, 0, length);
+    }
+
+    bool unpack_string(const U8* data, U32 size, U32& offset, std::string& str)
+    {
+        U16 length;
+        if (size - offset < sizeof(length))
+        {
+            return false;
+        }
+        memcpy(&length, data + offset, sizeof(length));
+        offset += sizeof(length);
+        if (size - offset < length)
+        {
+            return false;
+        }
+        str.assign(reinterpret_cast<const char*>(data + offset), length);
+        offset += length;
+        return true;
+    }
+}
+
+void LLAvatarName::packBinary(std::string& out) const
+{
+    out.append(reinterpret_cast<const char*>(&mExpires), sizeof(mExpires));
+    out.append(reinterpret_cast<const char*>(&mNextUpdate), sizeof(mNextUpdate));
+    out.push_back(mIsDisplayNameDefault ? 1 : 0);
+    pack_string(out, mUsername);
+    pack_string(out, mDisplayName);
+    pack_string(out, mLegacyFirstName);
+    pack_string(out, mLegacyLastName);
+}
+
+bool LLAvatarName::unpackBinary(const U8* data, U32 size)
+{
+    if (size < sizeof(mExpires) + sizeof(mNextUpdate) + 1)
+    {
+        return false;
+    }
+    U32 offset = 0;
+    memcpy(&mExpires, data + offset, sizeof(mExpires));
+    offset += sizeof(mExpires);
+    memcpy(&mNextUpdate, data + offset, sizeof(mNextUpdate));
+    offset += sizeof(mNextUpdate);
+    mIsDisplayNameDefault = data[offset++] != 0;
+    mIsTemporaryName = false;
+    return unpack_string(data, size, offset, mUsername)
+        && unpack_string(data, size, offset, mDisplayName)
+        && unpack_string(data, size, offset, mLegacyFirstName)
+        && unpack_string(data, size, offset, mLegacyLastName);
+}
+// </FS>
+
 // Transform a string (typically provided by the legacy service) into a decent
 // avatar name instance.
 void LLAvatarName::fromString(const std::string& full_name)
@@ -43,6 +43,14 @@ public:
     LLSD asLLSD() const;
     void fromLLSD(const LLSD& sd);
 
+    // <FS> Binary name cache
+    // Conversion to and from the binary name cache file. The data starts
+    // with mExpires, so the cache can skip expired names without reading
+    // them. unpackBinary() returns false if the data is truncated.
+    void packBinary(std::string& out) const;
+    bool unpackBinary(const U8* data, U32 size);
+    // </FS>
+
     // Used only in legacy mode when the display name capability is not provided server side
     // or to otherwise create a temporary valid item.
     void fromString(const std::string& full_name);
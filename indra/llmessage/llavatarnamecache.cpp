@@ -57,6 +57,20 @@ const F64 TEMP_CACHE_ENTRY_LIFETIME = 60.0;
 // Maximum time an unrefreshed cache entry is allowed.
 const F64 MAX_UNREFRESHED_TIME = 20.0 * 60.0;
 
+// <FS> Binary name cache
+// File header: magic, version and name count. Each name follows as agent
+// id, size and LLAvatarName::packBinary() data.
+static const char BINARY_CACHE_MAGIC[4] = { 'F', 'S', 'A', 'N' };
+static const U32 BINARY_CACHE_VERSION = 1;
+static const U32 BINARY_CACHE_HEADER_SIZE = sizeof(BINARY_CACHE_MAGIC) + sizeof(U32) * 2;
+static const U32 BINARY_NAME_HEADER_SIZE = UUID_BYTES + sizeof(U32);
+// </FS>
+
+// <FS> Bulk name lookup
+// Requests sent by one idle() while a bulk lookup is queued
+static const S32 MAX_BULK_REQUESTS_PER_IDLE = 8;
+// </FS>
+
 // Send bulk lookup requests a few times a second at most.
 // Only need per-frame timing resolution.
 static LLFrameTimer sRequestTimer;
@@ -151,6 +165,7 @@ void LLAvatarNameCache::requestAvatarNameCache_(std::string url, std::vector<LLU
     {
 
         LLCoreHttpUtil::HttpCoroutineAdapter httpAdapter("NameCache", sHttpPolicy);
+        httpAdapter.setResponseCache("GetDisplayNames"); // <FS/> Conditional GET cache
         LLSD results = httpAdapter.getAndSuspend(sHttpRequest, url);
 
         LL_DEBUGS() << results << LL_ENDL;
@@ -291,7 +306,10 @@ void LLAvatarNameCache::handleAvNameCacheSuccess(const LLSD &data, const LLSD &h
 // Provide some fallback for agents that return errors
 void LLAvatarNameCache::handleAgentError(const LLUUID& agent_id)
 {
-    std::map<LLUUID,LLAvatarName>::iterator existing = mCache.find(agent_id);
+    // <FS> Flat UUID maps
+    //std::map<LLUUID,LLAvatarName>::iterator existing = mCache.find(agent_id);
+    cache_t::iterator existing = mCache.find(agent_id);
+    // </FS>
     if (existing == mCache.end())
     {
         // <FS:Ansariel> Don't re-request names for agents with null uuid.
@@ -335,7 +353,11 @@ void LLAvatarNameCache::processName(const LLUUID& agent_id, const LLAvatarName&
 
     bool updated_account = true; // assume obsolete value for new arrivals by default
 
-    std::map<LLUUID, LLAvatarName>::iterator it = mCache.find(agent_id);
+    // <FS> Flat UUID maps
+    //std::map<LLUUID, LLAvatarName>::iterator it = mCache.find(agent_id);
+    //cache_t::iterator it = mCache.find(agent_id);
+    cache_t::iterator it = findName(agent_id); // <FS/> Binary name cache
+    // </FS>
     if (it != mCache.end()
         && (*it).second.getAccountName() == av_name.getAccountName())
     {
@@ -442,7 +464,10 @@ void LLAvatarNameCache::legacyNameCallback(const LLUUID& agent_id,
     // Retrieve the name and set it to never (or almost never...) expire: when we are using the legacy
     // protocol, we do not get an expiration date for each name and there's no reason to ask the
     // data again and again so we set the expiration time to the largest value admissible.
-    std::map<LLUUID,LLAvatarName>::iterator av_record = LLAvatarNameCache::getInstance()->mCache.find(agent_id);
+    // <FS> Flat UUID maps
+    //std::map<LLUUID,LLAvatarName>::iterator av_record = LLAvatarNameCache::getInstance()->mCache.find(agent_id);
+    cache_t::iterator av_record = LLAvatarNameCache::getInstance()->mCache.find(agent_id);
+    // </FS>
     LLAvatarName& av_name = av_record->second;
     av_name.setExpires(MAX_UNREFRESHED_TIME);
 }
@@ -491,6 +516,10 @@ void LLAvatarNameCache::requestNamesViaLegacy()
 void LLAvatarNameCache::clearCache()
 {
     mCache.clear();
+    // <FS> Binary name cache
+    mStoredOffsets.clear();
+    mStoredNames.clear();
+    // </FS>
 }
 // </FS:Ansariel>
 
@@ -526,6 +555,7 @@ bool LLAvatarNameCache::importFile(std::istream& istr)
 
 void LLAvatarNameCache::exportFile(std::ostream& ostr)
 {
+    decodeStoredNames(); // <FS/> Binary name cache
     LLSD agents;
     F64 max_unrefreshed = LLFrameTimer::getTotalSeconds() - MAX_UNREFRESHED_TIME;
     LL_INFOS("AvNameCache") << "LLAvatarNameCache at exit cache has " << mCache.size() << LL_ENDL;
@@ -547,6 +577,150 @@ void LLAvatarNameCache::exportFile(std::ostream& ostr)
     LLSDSerialize::toPrettyXML(data, ostr);
 }
 
+// <FS> Binary name cache
+bool LLAvatarNameCache::importBinaryFile(std::istream& istr)
+{
+    std::string data((std::istreambuf_iterator<char>(istr)), std::istreambuf_iterator<char>());
+    if (data.size() < BINARY_CACHE_HEADER_SIZE || memcmp(data.data(), BINARY_CACHE_MAGIC, sizeof(BINARY_CACHE_MAGIC)) != 0)
+    {
+        LL_WARNS("AvNameCache") << "avatar name cache file is not a binary name cache" << LL_ENDL;
+        return false;
+    }
+
+    const U8* bytes = reinterpret_cast<const U8*>(data.data());
+    const U32 size = (U32)data.size();
+    U32 version;
+    U32 count;
+    memcpy(&version, bytes + sizeof(BINARY_CACHE_MAGIC), sizeof(U32));
+    memcpy(&count, bytes + sizeof(BINARY_CACHE_MAGIC) + sizeof(U32), sizeof(U32));
+    if (version != BINARY_CACHE_VERSION)
+    {
+        LL_WARNS("AvNameCache") << "avatar name cache version " << version << " not supported" << LL_ENDL;
+        return false;
+    }
+
+    // Expired names are left in the data but not indexed
+    F64 max_unrefreshed = LLFrameTimer::getTotalSeconds() - MAX_UNREFRESHED_TIME;
+    mStoredOffsets.clear();
+    mStoredOffsets.reserve(count);
+    U32 offset = BINARY_CACHE_HEADER_SIZE;
+    LLUUID agent_id;
+    for (U32 i = 0; i < count; ++i)
+    {
+        if (size - offset < BINARY_NAME_HEADER_SIZE)
+        {
+            LL_WARNS("AvNameCache") << "avatar name cache truncated at name " << i << LL_ENDL;
+            mStoredOffsets.clear();
+            return false;
+        }
+        U32 name_size;
+        memcpy(agent_id.mData, bytes + offset, UUID_BYTES);
+        memcpy(&name_size, bytes + offset + UUID_BYTES, sizeof(U32));
+        offset += BINARY_NAME_HEADER_SIZE;
+        if (name_size < sizeof(F64) || size - offset < name_size)
+        {
+            LL_WARNS("AvNameCache") << "avatar name cache truncated at name " << i << LL_ENDL;
+            mStoredOffsets.clear();
+            return false;
+        }
+
+        F64 expires;
+        memcpy(&expires, bytes + offset, sizeof(F64));
+        if (expires >= max_unrefreshed && agent_id.notNull() && !mCache.contains(agent_id))
+        {
+            mStoredOffsets[agent_id] = { offset, name_size };
+        }
+        offset += name_size;
+    }
+
+    mStoredNames.swap(data);
+    LL_INFOS("AvNameCache") << "LLAvatarNameCache indexed " << mStoredOffsets.size() << " of " << count << LL_ENDL;
+    return true;
+}
+
+void LLAvatarNameCache::exportBinaryFile(std::ostream& ostr)
+{
+    F64 max_unrefreshed = LLFrameTimer::getTotalSeconds() - MAX_UNREFRESHED_TIME;
+    std::string data;
+    data.reserve(BINARY_CACHE_HEADER_SIZE + (mCache.size() + mStoredOffsets.size()) * 96);
+    data.append(BINARY_CACHE_MAGIC, sizeof(BINARY_CACHE_MAGIC));
+    data.append(reinterpret_cast<const char*>(&BINARY_CACHE_VERSION), sizeof(U32));
+    data.append(sizeof(U32), '\0'); // name count, filled in below
+
+    U32 count = 0;
+    for (const auto& [agent_id, av_name] : mCache)
+    {
+        // Do not write temporary or expired entries to the stored cache
+        if (av_name.isValidName(max_unrefreshed))
+        {
+            data.append(reinterpret_cast<const char*>(agent_id.mData), UUID_BYTES);
+            const size_t size_pos = data.size();
+            data.append(sizeof(U32), '\0');
+            av_name.packBinary(data);
+            const U32 name_size = (U32)(data.size() - size_pos - sizeof(U32));
+            memcpy(&data[size_pos], &name_size, sizeof(U32));
+            ++count;
+        }
+    }
+
+    // Names that were never looked up are copied over as they are
+    for (const auto& [agent_id, stored] : mStoredOffsets)
+    {
+        F64 expires;
+        memcpy(&expires, mStoredNames.data() + stored.mOffset, sizeof(F64));
+        if (expires >= max_unrefreshed)
+        {
+            data.append(reinterpret_cast<const char*>(agent_id.mData), UUID_BYTES);
+            data.append(reinterpret_cast<const char*>(&stored.mSize), sizeof(U32));
+            data.append(mStoredNames, stored.mOffset, stored.mSize);
+            ++count;
+        }
+    }
+
+    memcpy(&data[sizeof(BINARY_CACHE_MAGIC) + sizeof(U32)], &count, sizeof(U32));
+    ostr.write(data.data(), data.size());
+    LL_INFOS("AvNameCache") << "LLAvatarNameCache wrote " << count << LL_ENDL;
+}
+
+LLAvatarNameCache::cache_t::iterator LLAvatarNameCache::findName(const LLUUID& agent_id)
+{
+    cache_t::iterator it = mCache.find(agent_id);
+    if (it != mCache.end() || mStoredOffsets.empty())
+    {
+        return it;
+    }
+
+    auto stored = mStoredOffsets.find(agent_id);
+    if (stored == mStoredOffsets.end())
+    {
+        return it;
+    }
+
+    LLAvatarName av_name;
+    const bool valid = av_name.unpackBinary(reinterpret_cast<const U8*>(mStoredNames.data()) + stored->second.mOffset, stored->second.mSize);
+    mStoredOffsets.erase(stored);
+    if (mStoredOffsets.empty())
+    {
+        // All looked up, drop the file contents
+        std::string().swap(mStoredNames);
+    }
+    if (!valid)
+    {
+        LL_WARNS("AvNameCache") << "broken avatar name cache entry for " << agent_id << LL_ENDL;
+        return mCache.end();
+    }
+    return mCache.emplace(agent_id, av_name).first;
+}
+
+void LLAvatarNameCache::decodeStoredNames()
+{
+    while (!mStoredOffsets.empty())
+    {
+        findName(mStoredOffsets.begin()->first);
+    }
+}
+// </FS>
+
 void LLAvatarNameCache::setNameLookupURL(const std::string& name_lookup_url)
 {
     mNameLookupURL = name_lookup_url;
@@ -576,7 +750,10 @@ void LLAvatarNameCache::idle()
     // 100 ms is the threshold for "user speed" operations, so we can
     // stall for about that long to batch up requests.
     const F32 SECS_BETWEEN_REQUESTS = 0.1f;
-    if (!sRequestTimer.hasExpired())
+    // <FS> Bulk name lookup
+    //if (!sRequestTimer.hasExpired())
+    if (!sRequestTimer.hasExpired() && !mBulkRequest)
+    // </FS>
     {
         return;
     }
@@ -585,7 +762,13 @@ void LLAvatarNameCache::idle()
     {
         if (usePeopleAPI())
         {
-            requestNamesViaCapability();
+            // <FS> Bulk name lookup
+            //requestNamesViaCapability();
+            for (S32 requests = mBulkRequest ? MAX_BULK_REQUESTS_PER_IDLE : 1; requests > 0 && !mAskQueue.empty(); --requests)
+            {
+                requestNamesViaCapability();
+            }
+            // </FS>
         }
         else
         {
@@ -598,6 +781,7 @@ void LLAvatarNameCache::idle()
     {
         // cleared the list, reset the request timer.
         sRequestTimer.resetWithExpiry(SECS_BETWEEN_REQUESTS);
+        mBulkRequest = false; // <FS/> Bulk name lookup
     }
 
     // erase anything that has not been refreshed for more than MAX_UNREFRESHED_TIME
@@ -669,7 +853,11 @@ bool LLAvatarNameCache::getName(const LLUUID& agent_id, LLAvatarName *av_name)
     if (mRunning)
     {
         // ...only do immediate lookups when cache is running
-        std::map<LLUUID,LLAvatarName>::iterator it = mCache.find(agent_id);
+        // <FS> Flat UUID maps
+        //std::map<LLUUID,LLAvatarName>::iterator it = mCache.find(agent_id);
+        //cache_t::iterator it = mCache.find(agent_id);
+        cache_t::iterator it = findName(agent_id); // <FS/> Binary name cache
+        // </FS>
         if (it != mCache.end())
         {
             *av_name = it->second;
@@ -733,11 +921,15 @@ LLAvatarNameCache::callback_connection_t LLAvatarNameCache::getNameCallback(cons
     if (mRunning)
     {
         // ...only do immediate lookups when cache is running
-        std::map<LLUUID,LLAvatarName>::iterator it = mCache.find(agent_id);
+        // <FS> Flat UUID maps
+        //std::map<LLUUID,LLAvatarName>::iterator it = mCache.find(agent_id);
+        //cache_t::iterator it = mCache.find(agent_id);
+        cache_t::iterator it = findName(agent_id); // <FS/> Binary name cache
+        // </FS>
         if (it != mCache.end())
         {
             LLAvatarName& av_name = it->second;
-            LLSD test = av_name.asLLSD();
+            //LLSD test = av_name.asLLSD(); // <FS/> Unused, and built for every cache hit
 
             // <FS> Contact sets alias
             bool dn_removed;
@@ -787,6 +979,32 @@ LLAvatarNameCache::callback_connection_t LLAvatarNameCache::getNameCallback(cons
     return connection;
 }
 
+// <FS> Bulk name lookup
+S32 LLAvatarNameCache::getNames(const uuid_vec_t& agent_ids, name_list_t* av_names)
+{
+    S32 found = 0;
+    const size_t queued = mAskQueue.size();
+    LLAvatarName av_name;
+    for (const LLUUID& agent_id : agent_ids)
+    {
+        if (getName(agent_id, &av_name))
+        {
+            if (av_names)
+            {
+                av_names->emplace_back(agent_id, av_name);
+            }
+            ++found;
+        }
+    }
+
+    if (mAskQueue.size() > queued)
+    {
+        mBulkRequest = true;
+    }
+    return found;
+}
+// </FS>
+
 // [RLVa:KB] - Checked: 2010-12-08 (RLVa-1.4.0a) | Added: RLVa-1.2.2c
 bool LLAvatarNameCache::getForceDisplayNames()
 {
@@ -829,6 +1047,7 @@ void LLAvatarNameCache::setUseUsernames(bool use)
 void LLAvatarNameCache::erase(const LLUUID& agent_id)
 {
     mCache.erase(agent_id);
+    mStoredOffsets.erase(agent_id); // <FS/> Binary name cache
 }
 
 void LLAvatarNameCache::fetch(const LLUUID& agent_id) // FS:TM used in LGGContactSets
@@ -841,12 +1060,18 @@ void LLAvatarNameCache::insert(const LLUUID& agent_id, const LLAvatarName& av_na
 {
     // *TODO: update timestamp if zero?
     mCache[agent_id] = av_name;
+    mStoredOffsets.erase(agent_id); // <FS/> Binary name cache
 }
 
 LLUUID LLAvatarNameCache::findIdByName(const std::string& name)
 {
-    std::map<LLUUID, LLAvatarName>::iterator it;
-    std::map<LLUUID, LLAvatarName>::iterator end = mCache.end();
+    // <FS> Flat UUID maps
+    //std::map<LLUUID, LLAvatarName>::iterator it;
+    //std::map<LLUUID, LLAvatarName>::iterator end = mCache.end();
+    decodeStoredNames(); // <FS/> Binary name cache
+    cache_t::iterator it;
+    cache_t::iterator end = mCache.end();
+    // </FS>
     for (it = mCache.begin(); it != end; ++it)
     {
         if (it->second.getUserName() == name)
@@ -30,6 +30,7 @@
 
 #include "llavatarname.h"   // for convenience
 #include "llsingleton.h"
+#include "lluuidflatmap.h" // <FS/> Flat UUID maps
 #include <boost/signals2.hpp>
 #include <set>
 
@@ -56,6 +57,13 @@ public:
     bool importFile(std::istream& istr);
     void exportFile(std::ostream& ostr);
 
+    // <FS> Binary name cache
+    // Same as above in a compact binary format. Imported names are only
+    // indexed, each one is decoded when it is first looked up.
+    bool importBinaryFile(std::istream& istr);
+    void exportBinaryFile(std::ostream& ostr);
+    // </FS>
+
     // On the viewer, usually a simulator capabilities.
     // If empty, name cache will fall back to using legacy name lookup system.
     void setNameLookupURL(const std::string& name_lookup_url);
@@ -87,6 +95,15 @@ public:
     static callback_connection_t get(const LLUUID& agent_id, callback_slot_t slot);
     callback_connection_t getNameCallback(const LLUUID& agent_id, callback_slot_t slot);
 
+    // <FS> Bulk name lookup
+    // Looks up many names at once, like getName() for each of them. The
+    // names not in cache go out with the next idle() in as many full
+    // requests as it takes, rather than one request per request window.
+    // Returns how many names were filled in.
+    typedef std::vector<std::pair<LLUUID, LLAvatarName> > name_list_t;
+    S32 getNames(const uuid_vec_t& agent_ids, name_list_t* av_names = NULL);
+    // </FS>
+
     // Set display name: flips the switch and triggers the callbacks.
     void setUseDisplayNames(bool use);
 
@@ -203,9 +220,33 @@ private:
     signal_map_t mSignalMap;
 
     // The cache at last, i.e. avatar names we know about.
-    typedef std::map<LLUUID, LLAvatarName> cache_t;
+    // <FS> Flat UUID maps: looked up for every name shown
+    //typedef std::map<LLUUID, LLAvatarName> cache_t;
+    typedef LLUUIDFlatMap<LLAvatarName> cache_t;
+    // </FS>
     cache_t mCache;
 
+    // <FS> Binary name cache
+    // Looks agent_id up in mCache, decoding its imported name first if it
+    // wasn't yet
+    cache_t::iterator findName(const LLUUID& agent_id);
+    void decodeStoredNames();
+
+    struct StoredName
+    {
+        U32 mOffset;
+        U32 mSize;
+    };
+    // Contents of the imported binary file and where the names that were
+    // not looked up yet are in it
+    std::string mStoredNames;
+    LLUUIDFlatMap<StoredName> mStoredOffsets;
+    // </FS>
+
+    // <FS> Bulk name lookup
+    bool mBulkRequest = false;
+    // </FS>
+
     // Time when unrefreshed cached names were checked last.
     F64 mLastExpireCheck;
 
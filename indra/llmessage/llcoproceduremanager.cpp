@@ -32,10 +32,12 @@
 #include "llcoproceduremanager.h"
 
 #include <chrono>
+#include <queue> // <FS/> Coprocedure priorities
 
 #include <boost/fiber/buffered_channel.hpp>
 
 #include "llexception.h"
+#include "lltimer.h" // <FS/> Coprocedure queue metrics
 #include "stringize.h"
 
 //=========================================================================
@@ -57,6 +59,7 @@ class LLCoprocedurePool: private boost::noncopyable
 {
 public:
     typedef LLCoprocedureManager::CoProcedure_t CoProcedure_t;
+    typedef LLCoprocedureManager::EPriority EPriority; // <FS/> Coprocedure priorities
 
     LLCoprocedurePool(const std::string &name, size_t size);
     ~LLCoprocedurePool();
@@ -67,7 +70,10 @@ public:
     /// @param proc Is a bound function to be executed
     ///
     /// @return This method returns a UUID that can be used later to cancel execution.
-    LLUUID enqueueCoprocedure(const std::string &name, CoProcedure_t proc);
+    // <FS> Coprocedure priorities
+    //LLUUID enqueueCoprocedure(const std::string &name, CoProcedure_t proc);
+    LLUUID enqueueCoprocedure(const std::string &name, CoProcedure_t proc, EPriority priority);
+    // </FS>
 
     /// Returns the number of coprocedures in the queue awaiting processing.
     ///
@@ -90,6 +96,8 @@ public:
         return static_cast<S32>(countPending() + countActive());
     }
 
+    LLSD getStats() const; // <FS/> Coprocedure queue metrics
+
     void close();
 
 private:
@@ -97,16 +105,46 @@ private:
     {
         typedef std::shared_ptr<QueuedCoproc> ptr_t;
 
-        QueuedCoproc(const std::string &name, const LLUUID &id, CoProcedure_t proc) :
+        // <FS> Coprocedure priorities
+        //QueuedCoproc(const std::string &name, const LLUUID &id, CoProcedure_t proc) :
+        //    mName(name),
+        //    mId(id),
+        //    mProc(proc)
+        //{}
+        QueuedCoproc(const std::string &name, const LLUUID &id, CoProcedure_t proc, EPriority priority, U64 sequence) :
             mName(name),
             mId(id),
-            mProc(proc)
+            mProc(proc),
+            mPriority(priority),
+            mSequence(sequence),
+            mEnqueued(LLTimer::getTotalSeconds())
         {}
+        // </FS>
 
         std::string mName;
         LLUUID mId;
         CoProcedure_t mProc;
+        // <FS> Coprocedure priorities
+        EPriority mPriority;
+        U64 mSequence;
+        F64 mEnqueued;
+        // </FS>
+    };
+
+    // <FS> Coprocedure priorities
+    // Top of the queue is the highest priority, oldest first
+    struct QueuedCoprocOrder
+    {
+        bool operator()(const QueuedCoproc::ptr_t &a, const QueuedCoproc::ptr_t &b) const
+        {
+            if (a->mPriority != b->mPriority)
+            {
+                return a->mPriority < b->mPriority;
+            }
+            return a->mSequence > b->mSequence;
+        }
     };
+    // </FS>
 
     // we use a buffered_channel here rather than unbuffered_channel since we want to be able to
     // push values without blocking,even if there's currently no one calling a pop operation (due to
@@ -117,9 +155,26 @@ private:
     // instance.
     typedef std::shared_ptr<CoprocQueue_t> CoprocQueuePtr;
 
+    // <FS> Coprocedure priorities
+    // The channel only hands work over to the pool coroutines, which move
+    // all of it into this queue and run its top. Shared for the same
+    // reason as the channel.
+    typedef std::priority_queue<QueuedCoproc::ptr_t, std::vector<QueuedCoproc::ptr_t>, QueuedCoprocOrder> ReadyQueue_t;
+    typedef std::shared_ptr<ReadyQueue_t> ReadyQueuePtr;
+    // </FS>
+
     std::string     mPoolName;
     size_t          mPoolSize, mActiveCoprocsCount, mPending;
     CoprocQueuePtr  mPendingCoprocs;
+    // <FS> Coprocedure priorities
+    ReadyQueuePtr   mReadyCoprocs;
+    U64             mSequence;
+    // </FS>
+    // <FS> Coprocedure queue metrics
+    size_t          mMaxPending;
+    U64             mCompleted;
+    F64             mWaitTotal, mWaitMax, mRunTotal;
+    // </FS>
     LLTempBoundListener mStatusListener;
 
     typedef std::map<std::string, LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t> CoroAdapterMap_t;
@@ -127,8 +182,12 @@ private:
 
     CoroAdapterMap_t mCoroMapping;
 
-    void coprocedureInvokerCoro(CoprocQueuePtr pendingCoprocs,
+    // <FS> Coprocedure priorities
+    //void coprocedureInvokerCoro(CoprocQueuePtr pendingCoprocs,
+    //                            LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t httpAdapter);
+    void coprocedureInvokerCoro(CoprocQueuePtr pendingCoprocs, ReadyQueuePtr readyCoprocs,
                                 LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t httpAdapter);
+    // </FS>
 };
 
 //=========================================================================
@@ -188,7 +247,10 @@ void LLCoprocedureManager::initializePool(const std::string &poolName)
 }
 
 //-------------------------------------------------------------------------
-LLUUID LLCoprocedureManager::enqueueCoprocedure(const std::string &pool, const std::string &name, CoProcedure_t proc)
+// <FS> Coprocedure priorities
+//LLUUID LLCoprocedureManager::enqueueCoprocedure(const std::string &pool, const std::string &name, CoProcedure_t proc)
+LLUUID LLCoprocedureManager::enqueueCoprocedure(const std::string &pool, const std::string &name, CoProcedure_t proc, EPriority priority)
+// </FS>
 {
     // Attempt to find the pool and enqueue the procedure.  If the pool does
     // not exist, create it.
@@ -202,7 +264,10 @@ LLUUID LLCoprocedureManager::enqueueCoprocedure(const std::string &pool, const s
     }
 
     poolPtr_t targetPool = it->second;
-    return targetPool->enqueueCoprocedure(name, proc);
+    // <FS> Coprocedure priorities
+    //return targetPool->enqueueCoprocedure(name, proc);
+    return targetPool->enqueueCoprocedure(name, proc, priority);
+    // </FS>
 }
 
 void LLCoprocedureManager::setPropertyMethods(SettingQuery_t queryfn, SettingUpdate_t updatefn)
@@ -278,6 +343,18 @@ size_t LLCoprocedureManager::count(const std::string &pool) const
     return it->second->count();
 }
 
+// <FS> Coprocedure queue metrics
+LLSD LLCoprocedureManager::getStats() const
+{
+    LLSD stats = LLSD::emptyMap();
+    for (const auto& pair : mPoolMap)
+    {
+        stats[pair.first] = pair.second->getStats();
+    }
+    return stats;
+}
+// </FS>
+
 void LLCoprocedureManager::close()
 {
     for(auto & poolEntry : mPoolMap)
@@ -302,6 +379,17 @@ LLCoprocedurePool::LLCoprocedurePool(const std::string &poolName, size_t size):
     mActiveCoprocsCount(0),
     mPending(0),
     mPendingCoprocs(std::make_shared<CoprocQueue_t>(LLCoprocedureManager::DEFAULT_QUEUE_SIZE)),
+    // <FS> Coprocedure priorities
+    mReadyCoprocs(std::make_shared<ReadyQueue_t>()),
+    mSequence(0),
+    // </FS>
+    // <FS> Coprocedure queue metrics
+    mMaxPending(0),
+    mCompleted(0),
+    mWaitTotal(0.0),
+    mWaitMax(0.0),
+    mRunTotal(0.0),
+    // </FS>
     mHTTPPolicy(LLCore::HttpRequest::DEFAULT_POLICY_ID),
     mCoroMapping()
 {
@@ -346,8 +434,12 @@ LLCoprocedurePool::LLCoprocedurePool(const std::string &poolName, size_t size):
 
         std::string pooledCoro = LLCoros::instance().launch(
             "LLCoprocedurePool("+mPoolName+")::coprocedureInvokerCoro",
+            // <FS> Coprocedure priorities
+            //boost::bind(&LLCoprocedurePool::coprocedureInvokerCoro, this,
+            //            mPendingCoprocs, httpAdapter));
             boost::bind(&LLCoprocedurePool::coprocedureInvokerCoro, this,
-                        mPendingCoprocs, httpAdapter));
+                        mPendingCoprocs, mReadyCoprocs, httpAdapter));
+            // </FS>
 
         mCoroMapping.insert(CoroAdapterMap_t::value_type(pooledCoro, httpAdapter));
     }
@@ -360,7 +452,10 @@ LLCoprocedurePool::~LLCoprocedurePool()
 }
 
 //-------------------------------------------------------------------------
-LLUUID LLCoprocedurePool::enqueueCoprocedure(const std::string &name, LLCoprocedurePool::CoProcedure_t proc)
+// <FS> Coprocedure priorities
+//LLUUID LLCoprocedurePool::enqueueCoprocedure(const std::string &name, LLCoprocedurePool::CoProcedure_t proc)
+LLUUID LLCoprocedurePool::enqueueCoprocedure(const std::string &name, LLCoprocedurePool::CoProcedure_t proc, EPriority priority)
+// </FS>
 {
     LLUUID id(LLUUID::generateNewID());
 
@@ -384,10 +479,14 @@ LLUUID LLCoprocedurePool::enqueueCoprocedure(const std::string &name, LLCoproced
         LL_DEBUGS("CoProcMgr") << "Coprocedure(" << name << ") enqueuing with id=" << id.asString() << " in pool \"" << mPoolName << "\" at "
                               << mPending << LL_ENDL;
     }
-    auto pushed = mPendingCoprocs->try_push(std::make_shared<QueuedCoproc>(name, id, proc));
+    // <FS> Coprocedure priorities
+    //auto pushed = mPendingCoprocs->try_push(std::make_shared<QueuedCoproc>(name, id, proc));
+    auto pushed = mPendingCoprocs->try_push(std::make_shared<QueuedCoproc>(name, id, proc, priority, mSequence++));
+    // </FS>
     if (pushed == boost::fibers::channel_op_status::success)
     {
         ++mPending;
+        mMaxPending = llmax(mMaxPending, mPending); // <FS/> Coprocedure queue metrics
         return id;
     }
 
@@ -406,6 +505,7 @@ LLUUID LLCoprocedurePool::enqueueCoprocedure(const std::string &name, LLCoproced
 //-------------------------------------------------------------------------
 void LLCoprocedurePool::coprocedureInvokerCoro(
     CoprocQueuePtr pendingCoprocs,
+    ReadyQueuePtr readyCoprocs, // <FS/> Coprocedure priorities
     LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t httpAdapter)
 {
     for (;;)
@@ -429,24 +529,70 @@ void LLCoprocedurePool::coprocedureInvokerCoro(
         // destroyed during pop_wait_for().
         QueuedCoproc::ptr_t coproc;
         boost::fibers::channel_op_status status;
+        // <FS> Coprocedure priorities
+        //{
+        //    LLCoros::TempStatus st("waiting for work for 10s");
+        //    status = pendingCoprocs->pop_wait_for(coproc, std::chrono::seconds(10));
+        //}
+        //if (status == boost::fibers::channel_op_status::closed)
+        //{
+        //    break;
+        //}
+        //
+        //if(status == boost::fibers::channel_op_status::timeout)
+        //{
+        //    LL_DEBUGS_ONCE("CoProcMgr") << "pool '" << mPoolName << "' waiting." << LL_ENDL;
+        //    continue;
+        //}
+        if (readyCoprocs->empty())
         {
-            LLCoros::TempStatus st("waiting for work for 10s");
-            status = pendingCoprocs->pop_wait_for(coproc, std::chrono::seconds(10));
+            {
+                LLCoros::TempStatus st("waiting for work for 10s");
+                status = pendingCoprocs->pop_wait_for(coproc, std::chrono::seconds(10));
+            }
+            if (status == boost::fibers::channel_op_status::closed)
+            {
+                break;
+            }
+
+            if(status == boost::fibers::channel_op_status::timeout)
+            {
+                LL_DEBUGS_ONCE("CoProcMgr") << "pool '" << mPoolName << "' waiting." << LL_ENDL;
+                continue;
+            }
+            readyCoprocs->push(coproc);
         }
-        if (status == boost::fibers::channel_op_status::closed)
+        else if (pendingCoprocs->is_closed())
         {
             break;
         }
 
-        if(status == boost::fibers::channel_op_status::timeout)
+        // Take over everything else that is queued so it runs in priority
+        // order. Fresh pointers for the same reason as above.
+        for (;;)
         {
-            LL_DEBUGS_ONCE("CoProcMgr") << "pool '" << mPoolName << "' waiting." << LL_ENDL;
-            continue;
+            QueuedCoproc::ptr_t queued;
+            if (pendingCoprocs->try_pop(queued) != boost::fibers::channel_op_status::success)
+            {
+                break;
+            }
+            readyCoprocs->push(queued);
         }
+        QueuedCoproc::ptr_t next(readyCoprocs->top());
+        readyCoprocs->pop();
+        coproc.swap(next);
+        // </FS>
         // we actually popped an item
         --mPending;
         mActiveCoprocsCount++;
 
+        // <FS> Coprocedure queue metrics
+        const F64 started = LLTimer::getTotalSeconds();
+        const F64 waited = started - coproc->mEnqueued;
+        mWaitTotal += waited;
+        mWaitMax = llmax(mWaitMax, waited);
+        // </FS>
+
         LL_DEBUGS("CoProcMgr") << "Dequeued and invoking coprocedure(" << coproc->mName << ") with id=" << coproc->mId.asString() << " in pool \"" << mPoolName << "\" (" << mPending << " left)" << LL_ENDL;
 
         try
@@ -464,6 +610,10 @@ void LLCoprocedurePool::coprocedureInvokerCoro(
             LOG_UNHANDLED_EXCEPTION(STRINGIZE("Coprocedure('" << coproc->mName
                                               << "', id=" << coproc->mId.asString()
                                               << ") in pool '" << mPoolName << "'"));
+            // <FS> Coprocedure queue metrics
+            ++mCompleted;
+            mRunTotal += LLTimer::getTotalSeconds() - started;
+            // </FS>
             // must NOT omit this or we deplete the pool
             mActiveCoprocsCount--;
             continue;
@@ -472,11 +622,38 @@ void LLCoprocedurePool::coprocedureInvokerCoro(
         // Nicky: This is super spammy. Consider using LL_DEBUGS here?
         LL_DEBUGS("CoProcMgr") << "Finished coprocedure(" << coproc->mName << ")" << " in pool \"" << mPoolName << "\"" << LL_ENDL;
 
+        // <FS> Coprocedure queue metrics
+        ++mCompleted;
+        mRunTotal += LLTimer::getTotalSeconds() - started;
+        // </FS>
         mActiveCoprocsCount--;
     }
 }
 
+// <FS> Coprocedure queue metrics
+LLSD LLCoprocedurePool::getStats() const
+{
+    LLSD stats;
+    stats["pending"] = LLSD::Integer(mPending);
+    stats["active"] = LLSD::Integer(mActiveCoprocsCount);
+    stats["max_pending"] = LLSD::Integer(mMaxPending);
+    stats["completed"] = LLSD::Integer(mCompleted);
+    stats["wait_avg"] = mCompleted ? mWaitTotal / mCompleted : 0.0;
+    stats["wait_max"] = mWaitMax;
+    stats["run_avg"] = mCompleted ? mRunTotal / mCompleted : 0.0;
+    return stats;
+}
+// </FS>
+
 void LLCoprocedurePool::close()
 {
+    // <FS> Coprocedure queue metrics
+    if (mCompleted)
+    {
+        LL_INFOS("CoProcMgr") << "Pool " << mPoolName << ": " << mCompleted << " completed, max pending " << mMaxPending
+                              << ", wait avg " << (mWaitTotal / mCompleted) << "s max " << mWaitMax
+                              << "s, run avg " << (mRunTotal / mCompleted) << "s" << LL_ENDL;
+    }
+    // </FS>
     mPendingCoprocs->close();
 }
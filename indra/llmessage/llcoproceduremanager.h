@@ -46,13 +46,29 @@ public:
 
     typedef boost::function<void(LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t &, const LLUUID &id)> CoProcedure_t;
 
+    // <FS> Coprocedure priorities
+    /// Waiting coprocedures of a pool run highest priority first, and in
+    /// enqueue order within the same priority. Running ones are never
+    /// interrupted.
+    enum EPriority
+    {
+        PRIORITY_LOW = 0,   // bulk work, e.g. inventory fetches
+        PRIORITY_NORMAL,
+        PRIORITY_HIGH       // the user is waiting on it
+    };
+    // </FS>
+
     /// Places the coprocedure on the queue for processing.
     ///
     /// @param name Is used for debugging and should identify this coroutine.
     /// @param proc Is a bound function to be executed
+    /// @param priority Decides which waiting coprocedure runs next <FS/>
     ///
     /// @return This method returns a UUID that can be used later to cancel execution.
-    LLUUID enqueueCoprocedure(const std::string &pool, const std::string &name, CoProcedure_t proc);
+    // <FS> Coprocedure priorities
+    //LLUUID enqueueCoprocedure(const std::string &pool, const std::string &name, CoProcedure_t proc);
+    LLUUID enqueueCoprocedure(const std::string &pool, const std::string &name, CoProcedure_t proc, EPriority priority = PRIORITY_NORMAL);
+    // </FS>
 
     /// Cancel a coprocedure. If the coprocedure is already being actively executed
     /// this method calls cancelYieldingOperation() on the associated HttpAdapter
@@ -76,6 +92,13 @@ public:
     size_t count() const;
     size_t count(const std::string &pool) const;
 
+    // <FS> Coprocedure queue metrics
+    /// Map of pool name to its queue statistics: "pending", "active",
+    /// "max_pending", "completed", "wait_avg", "wait_max" and "run_avg"
+    /// (times in seconds).
+    LLSD getStats() const;
+    // </FS>
+
     void close();
     void close(const std::string &pool);
 
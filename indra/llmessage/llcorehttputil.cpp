@@ -30,6 +30,10 @@
 #include <sstream>
 #include <algorithm>
 #include <iterator>
+// <FS> LLSD arena
+#include <atomic>
+#include <optional>
+// </FS>
 #include "llcorehttputil.h"
 #include "llhttpconstants.h"
 #include "llsd.h"
@@ -39,6 +43,10 @@
 #include "llfilesystem.h"
 
 #include "message.h" // for getting the port
+#include "workqueue.h" // <FS/> Off-thread LLSD parsing
+#include "llsdarena.h" // <FS/> LLSD arena
+#include "fshttpresponsecache.h" // <FS/> Conditional GET cache
+#include "llframepump.h" // <FS/> Frame pump
 
 
 using namespace LLCore;
@@ -55,6 +63,17 @@ namespace
     BoolSettingQuery_t  mBoolSettingGet;
     BoolSettingUpdate_t mBoolSettingPut;
 
+    // <FS> LLSD arena
+    std::atomic<size_t> sLLSDArenaThreshold(0);
+
+    // Whether to parse a body this big into an arena
+    inline bool use_arena(size_t body_size)
+    {
+        const size_t threshold = sLLSDArenaThreshold;
+        return threshold && body_size >= threshold;
+    }
+    // </FS>
+
     inline bool getBoolSetting(const std::string &keyname)
     {
         if (!mBoolSettingGet || mBoolSettingGet.empty())
@@ -76,6 +95,13 @@ void setPropertyMethods(BoolSettingQuery_t queryfn, BoolSettingUpdate_t updatefn
 }
 
 
+// <FS> LLSD arena
+void setLLSDArenaThreshold(size_t bytes)
+{
+    sLLSDArenaThreshold = bytes;
+}
+// </FS>
+
 void logMessageSuccess(std::string logAuth, std::string url, std::string message)
 {
     LL_INFOS() << logAuth << " Success '" << message << "' for " << url << LL_ENDL;
@@ -97,9 +123,14 @@ public:
     ~HttpRequestPumper();
 
 private:
-    bool                       pollRequest(const LLSD&);
+    // <FS> Frame pump, there is one of these for every request in flight
+    //bool                       pollRequest(const LLSD&);
+    //
+    //LLTempBoundListener        mBoundListener;
+    void                       pollRequest(const LLFrameTick&);
 
-    LLTempBoundListener        mBoundListener;
+    LLFrameTickPump::TempConnection mBoundListener;
+    // </FS>
     LLCore::HttpRequest::ptr_t mHttpRequest;
 };
 
@@ -266,6 +297,14 @@ void HttpCoroHandler::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRespons
         return;
     }
 
+    // <FS> Conditional GET cache
+    if (!mResponseCacheKey.empty())
+    {   // Turns a 304 back into the stored response
+        FSHttpResponseCache::instance().onResponse(mResponseCacheKey, response);
+        status = response->getStatus();
+    }
+    // </FS>
+
     if (!status)
     {
         bool parseSuccess(false);
@@ -465,6 +504,13 @@ LLSD HttpCoroLLSDHandler::parseBody(LLCore::HttpResponse *response, bool &succes
 
     LLSD result;
 
+    // <FS> LLSD arena
+    std::optional<LLSDArena> arena;
+    if (use_arena(response->getBodySize()))
+    {
+        arena.emplace();
+    }
+    // </FS>
     if (!LLCoreHttpUtil::responseToLLSD(response, true, result))
     {
         success = false;
@@ -550,6 +596,63 @@ LLSD HttpCoroRawHandler::parseBody(LLCore::HttpResponse *response, bool &success
     return LLSD();
 }
 
+// <FS> Off-thread LLSD parsing
+//========================================================================
+/// The HttpCoroDeferredLLSDHandler is a HttpCoroLLSDHandler that holds on to
+/// the body of a successful response instead of parsing it, so that
+/// HttpCoroutineAdapter::postAndSuspendParseAsync() can parse it off the
+/// main thread. Error bodies are still parsed in place.
+///
+class HttpCoroDeferredLLSDHandler : public HttpCoroLLSDHandler
+{
+public:
+    typedef std::shared_ptr<HttpCoroDeferredLLSDHandler> ptr_t;
+
+    HttpCoroDeferredLLSDHandler(LLEventStream &reply);
+
+    LLCore::BufferArray::ptr_t takeBody();
+    bool isLLSDContent() const { return mLLSDContent; }
+
+protected:
+    virtual LLSD handleSuccess(LLCore::HttpResponse * response, LLCore::HttpStatus &status);
+
+private:
+    LLCore::BufferArray::ptr_t  mBody;
+    bool                        mLLSDContent;
+};
+
+//-------------------------------------------------------------------------
+HttpCoroDeferredLLSDHandler::HttpCoroDeferredLLSDHandler(LLEventStream &reply):
+    HttpCoroLLSDHandler(reply),
+    mLLSDContent(false)
+{
+}
+
+LLCore::BufferArray::ptr_t HttpCoroDeferredLLSDHandler::takeBody()
+{
+    LLCore::BufferArray::ptr_t body;
+    body.swap(mBody);
+    return body;
+}
+
+LLSD HttpCoroDeferredLLSDHandler::handleSuccess(LLCore::HttpResponse * response, LLCore::HttpStatus &status)
+{
+    BufferArray * body(response->getBody());
+    if (body && body->size())
+    {
+        // Hold on to the body past the response
+        body->addRef();
+        mBody = body;
+
+        LLCore::HttpHeaders::ptr_t headers(response->getHeaders());
+        const std::string *contentType = (headers) ? headers->find(HTTP_IN_HEADER_CONTENT_TYPE) : NULL;
+        mLLSDContent = contentType && (HTTP_CONTENT_LLSD_XML == *contentType);
+    }
+
+    return LLSD::emptyMap();
+}
+// </FS>
+
 //========================================================================
 /// The HttpCoroJSONHandler is a specialization of the LLCore::HttpHandler for
 /// interacting with coroutines.
@@ -626,8 +729,11 @@ LLSD HttpCoroJSONHandler::parseBody(LLCore::HttpResponse *response, bool &succes
 HttpRequestPumper::HttpRequestPumper(const LLCore::HttpRequest::ptr_t &request) :
     mHttpRequest(request)
 {
-    mBoundListener = LLEventPumps::instance().obtain("mainloop").
-        listen(LLEventPump::ANONYMOUS, boost::bind(&HttpRequestPumper::pollRequest, this, _1));
+    // <FS> Frame pump
+    //mBoundListener = LLEventPumps::instance().obtain("mainloop").
+    //    listen(LLEventPump::ANONYMOUS, boost::bind(&HttpRequestPumper::pollRequest, this, _1));
+    mBoundListener = LLFrameTickPump::instance().listen("HttpRequestPumper", [this](const LLFrameTick& tick) { pollRequest(tick); });
+    // </FS>
 }
 
 HttpRequestPumper::~HttpRequestPumper()
@@ -638,13 +744,16 @@ HttpRequestPumper::~HttpRequestPumper()
     }
 }
 
-bool HttpRequestPumper::pollRequest(const LLSD&)
+// <FS> Frame pump
+//bool HttpRequestPumper::pollRequest(const LLSD&)
+void HttpRequestPumper::pollRequest(const LLFrameTick&)
+// </FS>
 {
     if (mHttpRequest->getStatus() != HttpStatus(HttpStatus::LLCORE, HE_OP_CANCELED))
     {
         mHttpRequest->update(0L);
     }
-    return false;
+    //return false; // <FS/> Frame pump
 }
 
 //========================================================================
@@ -683,6 +792,86 @@ LLSD HttpCoroutineAdapter::postAndSuspend(LLCore::HttpRequest::ptr_t request,
     return postAndSuspend_(request, url, body, options, headers, httpHandler);
 }
 
+// <FS> Off-thread LLSD parsing
+// Threads:  any
+// The parsed LLSD is only handed back once the parsing thread is done with
+// it, the unique_ptr keeps that thread from holding a reference to it after.
+static std::unique_ptr<LLSD> parse_llsd_body(const LLCore::BufferArray::ptr_t &rawbody)
+{
+    std::unique_ptr<LLSD> content(new LLSD());
+    std::optional<LLSDArena> arena;
+    if (use_arena(rawbody->size()))
+    {
+        arena.emplace();
+    }
+    LLCore::BufferArrayStream bas(rawbody.get());
+    if (LLSDParser::PARSE_FAILURE == LLSDSerialize::fromXML(*content, bas, true))
+    {
+        content.reset();
+    }
+    return content;
+}
+
+LLSD HttpCoroutineAdapter::postAndSuspendParseAsync(LLCore::HttpRequest::ptr_t request,
+    const std::string & url, const LLSD & body,
+    LLCore::HttpOptions::ptr_t options, LLCore::HttpHeaders::ptr_t headers)
+{
+    LLEventStream  replyPump(mAdapterName, true);
+    HttpCoroDeferredLLSDHandler::ptr_t deferredHandler(new HttpCoroDeferredLLSDHandler(replyPump));
+    HttpCoroHandler::ptr_t httpHandler(deferredHandler);
+
+    LLSD results = postAndSuspend_(request, url, body, options, headers, httpHandler);
+
+    LLCore::BufferArray::ptr_t rawbody = deferredHandler->takeBody();
+    if (!rawbody)
+    {   // failed, canceled or nothing in the body
+        return results;
+    }
+
+    std::unique_ptr<LLSD> content;
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    if (general_queue && !LLCoros::getName().empty())
+    {
+        try
+        {
+            content = general_queue->waitForResult([rawbody]() { return parse_llsd_body(rawbody); });
+        }
+        catch (const LL::WorkQueue::Closed&)
+        {   // shutting down, parse it here
+            content = parse_llsd_body(rawbody);
+        }
+    }
+    else
+    {
+        content = parse_llsd_body(rawbody);
+    }
+
+    LLSD httpResults = results[HttpCoroutineAdapter::HTTP_RESULTS];
+    if (!content || content->isUndefined())
+    {
+        // Only a failure when the body claimed to be LLSD, as in HttpCoroLLSDHandler
+        if (!content && deferredHandler->isLLSDContent())
+        {
+            LL_WARNS("CoreHTTP") << "Failed to deserialize . " << url << LL_ENDL;
+            HttpCoroHandler::writeStatusCodes(LLCore::HttpStatus(499, "Failed to deserialize LLSD."), url, httpResults);
+        }
+        results = LLSD::emptyMap();
+    }
+    else if (!content->isMap())
+    {
+        results = LLSD::emptyMap();
+        results[HttpCoroutineAdapter::HTTP_RESULTS_CONTENT] = *content;
+    }
+    else
+    {
+        results = *content;
+    }
+    results[HttpCoroutineAdapter::HTTP_RESULTS] = httpResults;
+
+    return results;
+}
+// </FS>
+
 LLSD HttpCoroutineAdapter::postAndSuspend_(LLCore::HttpRequest::ptr_t &request,
     const std::string & url, const LLSD & body,
     LLCore::HttpOptions::ptr_t &options, LLCore::HttpHeaders::ptr_t &headers,
@@ -956,6 +1145,27 @@ LLSD HttpCoroutineAdapter::getAndSuspend_(LLCore::HttpRequest::ptr_t &request,
     HttpRequestPumper pumper(request);
     checkDefaultHeaders(headers);
 
+    // <FS> Conditional GET cache
+    if (!mResponseCacheName.empty() && FSHttpResponseCache::instance().isEnabled())
+    {
+        // Callers may reuse their headers, so the validators go on a copy
+        LLCore::HttpHeaders::ptr_t cache_headers(new LLCore::HttpHeaders);
+        for (const LLCore::HttpHeaders::header_t& header : *headers)
+        {
+            cache_headers->append(header.first, header.second);
+        }
+        const std::string key(FSHttpResponseCache::makeKey(mResponseCacheName, url, cache_headers));
+        if (FSHttpResponseCache::instance().addValidators(key, cache_headers))
+        {
+            LLCore::HttpOptions::ptr_t cache_options(options ? options : LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions));
+            cache_options->setWantHeaders(true);
+            options = cache_options;
+            headers = cache_headers;
+            handler->setResponseCacheKey(key);
+        }
+    }
+    // </FS>
+
     // The HTTPCoroHandler does not self delete, so retrieval of a the contained
     // pointer from the smart pointer is safe in this case.
     LLCore::HttpHandle hhandle = request->requestGet(mPolicyId,
@@ -1221,8 +1431,12 @@ LLCore::HttpStatus HttpCoroutineAdapter::getStatusFromLLSD(const LLSD &httpResul
 /*static*/
 void HttpCoroutineAdapter::callbackHttpGet(const std::string &url, LLCore::HttpRequest::policy_t policyId, completionCallback_t success, completionCallback_t failure)
 {
+    // <FS> Pooled coroutine stacks
+    //LLCoros::instance().launch("HttpCoroutineAdapter::genericGetCoro",
+    //    boost::bind(&HttpCoroutineAdapter::trivialGetCoro, url, policyId, success, failure));
     LLCoros::instance().launch("HttpCoroutineAdapter::genericGetCoro",
-        boost::bind(&HttpCoroutineAdapter::trivialGetCoro, url, policyId, success, failure));
+        boost::bind(&HttpCoroutineAdapter::trivialGetCoro, url, policyId, success, failure), LLCoros::STACK_SMALL);
+    // </FS>
 }
 
 /*static*/
@@ -1271,8 +1485,12 @@ void HttpCoroutineAdapter::trivialGetCoro(std::string url, LLCore::HttpRequest::
 /*static*/
 void HttpCoroutineAdapter::callbackHttpPost(const std::string &url, LLCore::HttpRequest::policy_t policyId, const LLSD &postData, completionCallback_t success, completionCallback_t failure)
 {
+    // <FS> Pooled coroutine stacks
+    //LLCoros::instance().launch("HttpCoroutineAdapter::genericPostCoro",
+    //    boost::bind(&HttpCoroutineAdapter::trivialPostCoro, url, policyId, postData, success, failure));
     LLCoros::instance().launch("HttpCoroutineAdapter::genericPostCoro",
-        boost::bind(&HttpCoroutineAdapter::trivialPostCoro, url, policyId, postData, success, failure));
+        boost::bind(&HttpCoroutineAdapter::trivialPostCoro, url, policyId, postData, success, failure), LLCoros::STACK_SMALL);
+    // </FS>
 }
 
 /*static*/
@@ -1326,8 +1544,12 @@ void HttpCoroutineAdapter::trivialPostCoro(std::string url, LLCore::HttpRequest:
 void HttpCoroutineAdapter::callbackHttpDel(const std::string &url, LLCore::HttpRequest::policy_t policyId, completionCallback_t success,
                                            completionCallback_t failure)
 {
+    // <FS> Pooled coroutine stacks
+    //LLCoros::instance().launch("HttpCoroutineAdapter::genericDelCoro",
+    //                           boost::bind(&HttpCoroutineAdapter::trivialDelCoro, url, policyId, success, failure));
     LLCoros::instance().launch("HttpCoroutineAdapter::genericDelCoro",
-                               boost::bind(&HttpCoroutineAdapter::trivialDelCoro, url, policyId, success, failure));
+                               boost::bind(&HttpCoroutineAdapter::trivialDelCoro, url, policyId, success, failure), LLCoros::STACK_SMALL);
+    // </FS>
 }
 
 /*static*/
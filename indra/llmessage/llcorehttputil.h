@@ -63,6 +63,12 @@ typedef boost::function<void(const std::string &, bool, const std::string &)> Bo
 
 void setPropertyMethods(BoolSettingQuery_t queryfn, BoolSettingUpdate_t updatefn);
 
+// <FS> LLSD arena
+/// LLSD response bodies of at least this many bytes are parsed into an
+/// LLSDArena, 0 turns it off.
+void setLLSDArenaThreshold(size_t bytes);
+// </FS>
+
 
 extern const F32 HTTP_REQUEST_EXPIRY_SECS;
 
@@ -277,6 +283,13 @@ public:
         return mReplyPump;
     }
 
+    // <FS> Conditional GET cache
+    void setResponseCacheKey(const std::string &key)
+    {
+        mResponseCacheKey = key;
+    }
+    // </FS>
+
 protected:
     /// this method may modify the status value
     virtual LLSD handleSuccess(LLCore::HttpResponse * response, LLCore::HttpStatus &status) = 0;
@@ -286,6 +299,7 @@ private:
     void buildStatusEntry(LLCore::HttpResponse *response, LLCore::HttpStatus status, LLSD &result);
 
     LLEventStream &mReplyPump;
+    std::string mResponseCacheKey; // <FS/> Conditional GET cache
 };
 
 //=========================================================================
@@ -366,6 +380,17 @@ public:
             LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions()), headers);
     }
 
+    // <FS> Off-thread LLSD parsing
+    /// Like postAndSuspend(), but the LLSD body of a successful response is
+    /// parsed on the "General" work queue while the coroutine waits, rather
+    /// than on the main thread as soon as the response arrives. Parses in
+    /// place when that queue isn't running.
+    LLSD postAndSuspendParseAsync(LLCore::HttpRequest::ptr_t request,
+        const std::string & url, const LLSD & body,
+        LLCore::HttpOptions::ptr_t options = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions()),
+        LLCore::HttpHeaders::ptr_t headers = LLCore::HttpHeaders::ptr_t(new LLCore::HttpHeaders()));
+    // </FS>
+
     LLSD postFileAndSuspend(LLCore::HttpRequest::ptr_t request,
         const std::string & url, std::string fileName,
         LLCore::HttpOptions::ptr_t options = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions()),
@@ -578,6 +603,16 @@ public:
     ///
     void cancelSuspendedOperation();
 
+    // <FS> Conditional GET cache
+    /// Revalidates the responses of the following GETs against the
+    /// FSHttpResponseCache. Capability URLs change between sessions, so
+    /// name has to stay the same for the same kind of request.
+    void setResponseCache(const std::string &name)
+    {
+        mResponseCacheName = name;
+    }
+    // </FS>
+
     static LLCore::HttpStatus getStatusFromLLSD(const LLSD &httpResults);
 
     /// The convenience routines below can be provided with callback functors
@@ -672,6 +707,7 @@ private:
     LLCore::HttpHandle              mYieldingHandle;
     LLCore::HttpRequest::wptr_t     mWeakRequest;
     HttpCoroHandler::wptr_t         mWeakHandler;
+    std::string                     mResponseCacheName; // <FS/> Conditional GET cache
 };
 
 
@@ -29,6 +29,8 @@
 
 #include "nd/ndexceptions.h" // <FS:ND/> For ndxran
 
+#include <algorithm> // <FS/> Fast binary unpacking
+
 class LLColor4;
 class LLColor4U;
 class LLVector2;
@@ -185,6 +187,27 @@ public:
                 void        reset()             { mCurBufferp = mBufferp; mWriteEnabled = (mCurBufferp != NULL); }
                 void        shift(S32 offset)   { reset(); mCurBufferp += offset;}
                 void        freeBuffer()        { delete [] mBufferp; mBufferp = mCurBufferp = NULL; mBufferSize = 0; mWriteEnabled = false; }
+                // <FS> Shared object cache file
+                // Forget a buffer that belongs to somebody else, without deleting it
+                void        releaseBuffer()     { mBufferp = mCurBufferp = NULL; mBufferSize = 0; mWriteEnabled = false; }
+                // </FS>
+                // <FS> Fast binary unpacking
+                // Non-virtual readers for fixed layout sections. They don't check
+                // anything, call canRead() once for the whole section first.
+                bool        canRead(S32 size) const { return mCurBufferp && size <= mBufferSize - getCurrentSize(); }
+                U8          readU8()            { return *mCurBufferp++; }
+                U16         readU16()           { return readRaw<U16>(); }
+                U32         readU32()           { return readRaw<U32>(); }
+                F32         readF32()           { return readRaw<F32>(); }
+                void        readF32s(F32* values, S32 count)
+                {
+                    for (S32 i = 0; i < count; ++i)
+                    {
+                        values[i] = readRaw<F32>();
+                    }
+                }
+                void        readBytes(U8* value, S32 size) { memcpy(value, mCurBufferp, size); mCurBufferp += size; }
+                // </FS>
                 void        assignBuffer(U8 *bufferp, S32 size)
                 {
                     if(mBufferp && mBufferp != bufferp)
@@ -204,6 +227,20 @@ public:
 protected:
     inline bool verifyLength(const S32 data_size, const char *name);
 
+    // <FS> Fast binary unpacking
+    template <typename T>
+    T readRaw()
+    {
+        T value;
+        memcpy(&value, mCurBufferp, sizeof(T));
+#ifdef LL_BIG_ENDIAN
+        std::reverse((U8*)&value, (U8*)&value + sizeof(T));
+#endif
+        mCurBufferp += sizeof(T);
+        return value;
+    }
+    // </FS>
+
     U8 *mBufferp;
     U8 *mCurBufferp;
     S32 mBufferSize;
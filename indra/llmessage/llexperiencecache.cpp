@@ -256,6 +256,7 @@ void LLExperienceCache::requestExperiencesCoro(LLCoreHttpUtil::HttpCoroutineAdap
 
     //LL_INFOS("requestExperiencesCoro") << "url: " << url << LL_ENDL;
 
+    httpAdapter->setResponseCache("GetExperienceInfo"); // <FS/> Conditional GET cache
     LLSD result = httpAdapter->getAndSuspend(httpRequest, url);
 
     LLSD httpResults = result[LLCoreHttpUtil::HttpCoroutineAdapter::HTTP_RESULTS];
@@ -376,8 +377,13 @@ void LLExperienceCache::requestExperiences()
 
         if (mRequestQueue.empty() || (ostr.tellp() > EXP_URL_SEND_THRESHOLD))
         {   // request is placed in the coprocedure pool for the ExpCache cache.  Throttling is done by the pool itself.
+            // <FS> Coprocedure priorities, batched lookups go after user actions
+            //LLCoprocedureManager::instance().enqueueCoprocedure("ExpCache", "RequestExperiences",
+            //    boost::bind(&LLExperienceCache::requestExperiencesCoro, this, _1, ostr.str(), requests) );
             LLCoprocedureManager::instance().enqueueCoprocedure("ExpCache", "RequestExperiences",
-                boost::bind(&LLExperienceCache::requestExperiencesCoro, this, _1, ostr.str(), requests) );
+                boost::bind(&LLExperienceCache::requestExperiencesCoro, this, _1, ostr.str(), requests),
+                LLCoprocedureManager::PRIORITY_LOW);
+            // </FS>
 
             ostr.str(std::string());
             ostr << urlBase << "?page_size=" << PAGE_SIZE1;
@@ -30,6 +30,7 @@
 #include "message.h" // TODO: babbage: Remove...
 #include "llstl.h"
 #include "llindexedvector.h"
+#include "llprehashindex.h" // <FS/> Prehash index
 
 #include "nd/ndexceptions.h" // <FS:ND/> For ndxran
 
@@ -169,6 +170,14 @@ protected:
 };
 
 
+// <FS> Prehash index
+// Index the interned names in the table of gMessageStringTable
+inline void build_prehash_index(LLPrehashIndex& index, const std::vector<const char*>& names)
+{
+    index.build(names, LLMessageStringTable::getInstance()->mString[0], MESSAGE_MAX_STRINGS_LENGTH, MESSAGE_NUMBER_OF_HASH_BUCKETS);
+}
+// </FS>
+
 typedef enum e_message_block_type
 {
     MBT_NULL,
@@ -208,6 +217,15 @@ public:
         {
             mTotalSize = -1;
         }
+
+        // <FS> Prehash index
+        std::vector<const char*> names;
+        for (const LLMessageVariable* variable : mMemberVariables)
+        {
+            names.push_back(variable->getName());
+        }
+        build_prehash_index(mVariableIndex, names);
+        // </FS>
     }
 
     EMsgVariableType getVariableType(char *name)
@@ -222,10 +240,22 @@ public:
 
     const LLMessageVariable* getVariable(char* name) const
     {
-        message_variable_map_t::const_iterator iter = mMemberVariables.find(name);
-        return iter != mMemberVariables.end()? *iter : NULL;
+        // <FS> Prehash index
+        //message_variable_map_t::const_iterator iter = mMemberVariables.find(name);
+        //return iter != mMemberVariables.end()? *iter : NULL;
+        S32 index = getVariableIndex(name);
+        return index >= 0 ? *(mMemberVariables.begin() + index) : NULL;
+        // </FS>
     }
 
+    // <FS> Prehash index
+    // Position of the variable in mMemberVariables, -1 if there is none
+    S32 getVariableIndex(const char* name) const
+    {
+        return mVariableIndex.find(name);
+    }
+    // </FS>
+
     friend std::ostream&     operator<<(std::ostream& s, LLMessageBlock &msg);
 
     typedef LLIndexedVector<LLMessageVariable*, const char *, 8> message_variable_map_t;
@@ -234,6 +264,9 @@ public:
     EMsgBlockType                           mType;
     S32                                     mNumber;
     S32                                     mTotalSize;
+
+private:
+    LLPrehashIndex                          mVariableIndex; // <FS/> Prehash index
 };
 
 
@@ -319,6 +352,15 @@ public:
         {
             mTotalSize = -1;
         }
+
+        // <FS> Prehash index
+        std::vector<const char*> names;
+        for (const LLMessageBlock* block : mMemberBlocks)
+        {
+            names.push_back(block->mName);
+        }
+        build_prehash_index(mBlockIndex, names);
+        // </FS>
     }
 
     LLMessageBlock *getBlock(char *name)
@@ -405,10 +447,22 @@ public:
 
     const LLMessageBlock* getBlock(char* name) const
     {
-        message_block_map_t::const_iterator iter = mMemberBlocks.find(name);
-        return iter != mMemberBlocks.end()? *iter : NULL;
+        // <FS> Prehash index
+        //message_block_map_t::const_iterator iter = mMemberBlocks.find(name);
+        //return iter != mMemberBlocks.end()? *iter : NULL;
+        S32 index = getBlockIndex(name);
+        return index >= 0 ? *(mMemberBlocks.begin() + index) : NULL;
+        // </FS>
     }
 
+    // <FS> Prehash index
+    // Position of the block in mMemberBlocks, -1 if there is none
+    S32 getBlockIndex(const char* name) const
+    {
+        return mBlockIndex.find(name);
+    }
+    // </FS>
+
 public:
     typedef LLIndexedVector<LLMessageBlock*, char*, 8> message_block_map_t;
     message_block_map_t                     mMemberBlocks;
@@ -434,6 +488,8 @@ private:
     // message handler function (this is set by each application)
     void                                    (*mHandlerFunc)(LLMessageSystem *msgsystem, void **user_data);
     void                                    **mUserData;
+
+    LLPrehashIndex                          mBlockIndex; // <FS/> Prehash index
 };
 
 #endif // LL_LLMESSAGETEMPLATE_H
@@ -43,6 +43,96 @@
 #include "message.h"
 #include "u64.h"
 
+// <FS> Network thread
+#include "llthread.h"
+
+#include <atomic>
+
+bool LLPacketRing::sUseReceiveThread = false;
+
+// Single producer, single consumer ring of datagrams. The thread waits on
+// the socket and reads whatever is waiting straight into the free slots in
+// one call, the main thread hands them out one by one in receivePacket().
+// When the main thread falls behind and the ring fills up, datagrams wait in
+// the socket's own buffer like they did without the thread.
+class LLPacketRing::ReceiveThread : public LLThread
+{
+public:
+    ReceiveThread(S32 socket)
+    :   LLThread("Packet receive"),
+        mSocket(socket),
+        mStorage(SLOT_COUNT * NET_BUFFER_SIZE),
+        mHead(0),
+        mTail(0)
+    {
+        for (U32 i = 0; i < SLOT_COUNT; ++i)
+        {
+            mSlots[i].mData = &mStorage[i * NET_BUFFER_SIZE];
+            mSlots[i].mSize = 0;
+        }
+    }
+
+    // Threads:  Tmain
+    // The oldest datagram not handed out yet, NULL if the ring is empty
+    const net_packet_t* front() const
+    {
+        const U32 tail = mTail.load(std::memory_order_relaxed);
+        if (tail == mHead.load(std::memory_order_acquire))
+        {
+            return NULL;
+        }
+        return &mSlots[tail & SLOT_MASK];
+    }
+
+    // Threads:  Tmain
+    void pop()
+    {
+        mTail.store(mTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+protected:
+    void run() override
+    {
+        while (!isQuitting())
+        {
+            const U32 head = mHead.load(std::memory_order_relaxed);
+            const U32 used = head - mTail.load(std::memory_order_acquire);
+            if (used == SLOT_COUNT)
+            {
+                ms_sleep(1);
+                continue;
+            }
+
+            // short enough a wait to notice shutdown() in time
+            if (!wait_for_packet(mSocket, 50))
+            {
+                continue;
+            }
+
+            // free slots up to the end of the storage, the rest on the next pass
+            const U32 first = head & SLOT_MASK;
+            const S32 count = (S32)llmin(SLOT_COUNT - used, SLOT_COUNT - first, BATCH_SIZE);
+            const S32 received = receive_packets(mSocket, &mSlots[first], count);
+            if (received > 0)
+            {
+                mHead.store(head + received, std::memory_order_release);
+            }
+        }
+    }
+
+private:
+    static constexpr U32 SLOT_COUNT = 256;  // power of two, 2 MB of buffers
+    static constexpr U32 SLOT_MASK = SLOT_COUNT - 1;
+    static constexpr U32 BATCH_SIZE = 32;
+
+    const S32           mSocket;
+    std::vector<char>   mStorage;
+    net_packet_t        mSlots[SLOT_COUNT];
+    std::atomic<U32>    mHead;  // written by the thread
+    std::atomic<U32>    mTail;  // written by the main thread
+};
+// </FS>
+
 ///////////////////////////////////////////////////////////
 LLPacketRing::LLPacketRing () :
     mUseInThrottle(false),
@@ -68,6 +158,8 @@ LLPacketRing::~LLPacketRing ()
 ///////////////////////////////////////////////////////////
 void LLPacketRing::cleanup ()
 {
+    stopReceiveThread(); // <FS/> Network thread
+
     LLPacketBuffer *packetp;
 
     while (!mReceiveQueue.empty())
@@ -85,6 +177,63 @@ void LLPacketRing::cleanup ()
     }
 }
 
+// <FS> Network thread
+///////////////////////////////////////////////////////////
+void LLPacketRing::stopReceiveThread()
+{
+    if (mReceiveThread)
+    {
+        mReceiveThread->shutdown();
+        mReceiveThread.reset();
+    }
+}
+
+///////////////////////////////////////////////////////////
+S32 LLPacketRing::receiveFromThread(S32 socket, char *datap)
+{
+    if (!mReceiveThread)
+    {
+        mReceiveThread = std::make_unique<ReceiveThread>(socket);
+        mReceiveThread->start();
+    }
+
+    const net_packet_t* packetp = mReceiveThread->front();
+    if (!packetp)
+    {
+        return 0;
+    }
+
+    S32 packet_size = packetp->mSize;
+    if (LLProxy::isSOCKSProxyEnabled())
+    {
+        if (packet_size > SOCKS_HEADER_SIZE)
+        {
+            // *FIX We are assuming ATYP is 0x01 (IPv4), not 0x03 (hostname) or 0x04 (IPv6)
+            memcpy(datap, packetp->mData + SOCKS_HEADER_SIZE, packet_size - SOCKS_HEADER_SIZE);
+            const proxywrap_t * header = static_cast<const proxywrap_t*>(static_cast<const void*>(packetp->mData));
+            mLastSender.setAddress(header->addr);
+            mLastSender.setPort(ntohs(header->port));
+
+            packet_size -= SOCKS_HEADER_SIZE; // The unwrapped packet size
+        }
+        else
+        {
+            packet_size = 0;
+        }
+    }
+    else
+    {
+        memcpy(datap, packetp->mData, packet_size);
+        mLastSender = LLHost(packetp->mSenderIP, packetp->mSenderPort);
+    }
+
+    mLastReceivingIF = LLHost(packetp->mReceivingIF, INVALID_PORT);
+
+    mReceiveThread->pop();
+    return packet_size;
+}
+// </FS>
+
 ///////////////////////////////////////////////////////////
 void LLPacketRing::dropPackets (U32 num_to_drop)
 {
@@ -161,6 +310,11 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
     // If using the throttle, simulate a limited size input buffer.
     if (mUseInThrottle)
     {
+        // <FS> Network thread
+        // LLPacketBuffer reads the socket itself
+        stopReceiveThread();
+        // </FS>
+
         bool done = false;
 
         // push any current net packet (if any) onto delay ring
@@ -223,6 +377,14 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
     }
     else
     {
+        // <FS> Network thread
+        if (sUseReceiveThread)
+        {
+            packet_size = receiveFromThread(socket, datap);
+        }
+        else
+        {
+        // </FS>
         // no delay, pull straight from net
         if (LLProxy::isSOCKSProxyEnabled())
         {
@@ -251,6 +413,9 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
         }
 
         mLastReceivingIF = ::get_receiving_interface();
+        // <FS> Network thread
+        }
+        // </FS>
 
         if (packet_size)  // did we actually get a packet?
         {
@@ -28,6 +28,7 @@
 #ifndef LL_LLPACKETRING_H
 #define LL_LLPACKETRING_H
 
+#include <memory>    // <FS/> Network thread
 #include <queue>
 
 #include "llhost.h"
@@ -60,6 +61,16 @@ public:
 
     S32 getAndResetActualInBits()               { S32 bits = mActualBitsIn; mActualBitsIn = 0; return bits;}
     S32 getAndResetActualOutBits()              { S32 bits = mActualBitsOut; mActualBitsOut = 0; return bits;}
+
+    // <FS> Network thread
+    // Read the socket on a thread of its own, in batches, into a ring of
+    // packet buffers receivePacket() takes from. Started by the first
+    // receivePacket() without the in throttle.
+    static void setUseReceiveThread(bool use_thread) { sUseReceiveThread = use_thread; }
+
+    // Must be called before the socket is closed
+    void stopReceiveThread();
+    // </FS>
 protected:
     bool mUseInThrottle;
     bool mUseOutThrottle;
@@ -85,6 +96,16 @@ protected:
 
 private:
     bool sendPacketImpl(int h_socket, const char * send_buffer, S32 buf_size, LLHost host);
+
+    // <FS> Network thread
+    class ReceiveThread;
+
+    S32 receiveFromThread(S32 socket, char *datap);
+
+    std::unique_ptr<ReceiveThread> mReceiveThread;
+
+    static bool sUseReceiveThread;
+    // </FS>
 };
 
 
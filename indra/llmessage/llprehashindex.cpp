@@ -0,0 +1,120 @@
+/**
+ * @file llprehashindex.cpp
+ * @brief Perfect hash of message system names.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llprehashindex.h"
+
+namespace
+{
+    // Multipliers tried for each table size before doubling it
+    constexpr U32 ATTEMPTS = 64;
+}
+
+LLPrehashIndex::LLPrehashIndex()
+:   mSlots(1, -1),
+    mTable(NULL),
+    mTableBytes(0),
+    mStringLength(1),
+    mMultiplier(0),
+    mShift(31)
+{
+}
+
+bool LLPrehashIndex::tryMultiplier(const std::vector<U32>& numbers, U32 multiplier, U32 bits)
+{
+    const U32 shift = 32 - bits;
+    mSlots.assign((size_t)1 << bits, -1);
+    for (size_t i = 0; i < numbers.size(); ++i)
+    {
+        if (numbers[i] == U32_MAX)
+        {
+            continue;
+        }
+        S16& slot = mSlots[(numbers[i] * multiplier) >> shift];
+        if (slot >= 0)
+        {
+            return false;
+        }
+        slot = (S16)i;
+    }
+    mMultiplier = multiplier;
+    mShift = shift;
+    return true;
+}
+
+void LLPrehashIndex::build(const std::vector<const char*>& names, const char* table, U32 string_length, U32 string_count)
+{
+    llassert(string_count > 1 && string_count <= 0x10000 && names.size() <= 0x8000);
+
+    mNames = names;
+    mTable = table;
+    mTableBytes = (uintptr_t)string_length * string_count;
+    mStringLength = string_length;
+
+    std::vector<U32> numbers;
+    numbers.reserve(names.size());
+    for (const char* name : names)
+    {
+        const uintptr_t offset = (uintptr_t)name - (uintptr_t)table;
+        if (offset >= mTableBytes)
+        {
+            // not interned, find() won't know it
+            numbers.push_back(U32_MAX);
+            continue;
+        }
+        numbers.push_back((U32)(offset / string_length));
+    }
+
+    U32 table_bits = 0;
+    while ((1U << table_bits) < string_count)
+    {
+        ++table_bits;
+    }
+
+    // start at twice the names, grow until a multiplier spreads them out
+    U32 bits = 1;
+    while ((1U << bits) < 2 * names.size())
+    {
+        ++bits;
+    }
+
+    U32 seed = 0x9e3779b9;
+    for (; bits < table_bits; ++bits)
+    {
+        for (U32 attempt = 0; attempt < ATTEMPTS; ++attempt)
+        {
+            seed = seed * 1664525 + 1013904223;
+            if (tryMultiplier(numbers, seed | 1, bits))
+            {
+                return;
+            }
+        }
+    }
+
+    // a slot for every string of the table always works
+    tryMultiplier(numbers, 1U << (32 - table_bits), table_bits);
+}
@@ -0,0 +1,82 @@
+/**
+ * @file llprehashindex.h
+ * @brief Perfect hash of message system names.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPREHASHINDEX_H
+#define LL_LLPREHASHINDEX_H
+
+#include "stdtypes.h"
+
+#include <cstdint>
+#include <vector>
+
+// Looks up the names LLMessageStringTable hands out (the _PREHASH_ names)
+// in O(1), for the block and variable maps of the message templates, which
+// stop changing once the template file has been read.
+//
+// An interned name is one of the fixed size strings of the table, so where
+// it sits in the table is already a unique number below
+// MESSAGE_NUMBER_OF_HASH_BUCKETS. build() looks for a multiplier that sends
+// the numbers of its names to distinct slots of a small table, which is
+// a perfect hash: a lookup is one multiply, one table read and a pointer
+// compare to turn away anything that isn't one of the names. Big sets that
+// don't hash apart use the number itself as the slot.
+class LLPrehashIndex
+{
+public:
+    LLPrehashIndex();
+
+    // Index names[i] as i. The names must be distinct and interned in the
+    // table of string_count strings of string_length bytes at table.
+    void build(const std::vector<const char*>& names, const char* table, U32 string_length, U32 string_count);
+
+    // i for names[i] of the last build(), -1 for anything else
+    S32 find(const char* name) const
+    {
+        const uintptr_t offset = (uintptr_t)name - (uintptr_t)mTable;
+        if (offset >= mTableBytes)
+        {
+            return -1;
+        }
+        const U32 slot = ((U32)(offset / mStringLength) * mMultiplier) >> mShift;
+        const S32 index = mSlots[slot];
+        return index >= 0 && mNames[index] == name ? index : -1;
+    }
+
+    U32 size() const { return (U32)mNames.size(); }
+
+private:
+    bool tryMultiplier(const std::vector<U32>& numbers, U32 multiplier, U32 bits);
+
+    std::vector<const char*>    mNames;
+    std::vector<S16>            mSlots;     // index in mNames, -1 for none
+    const char*                 mTable;
+    uintptr_t                   mTableBytes;
+    U32                         mStringLength;
+    U32                         mMultiplier;
+    U32                         mShift;
+};
+
+#endif // LL_LLPREHASHINDEX_H
@@ -40,12 +40,51 @@
 
 #include "nd/ndexceptions.h" // <FS:ND/> For ndxran
 
+bool LLTemplateMessageReader::sZeroCopy = false; // <FS/> Zero-copy message reader
+
+// <FS:Beq> storage for Tracy tag
+#ifdef TRACY_ENABLE
+static char msgstr[36];
+#endif
+// </FS:Beq>
+
+// <FS> Prehash index
+namespace
+{
+    // Message numbers packed next to each other: high frequency 1-254 from
+    // 0, medium 0xFF01-0xFFFE from 256, fixed 0xFFFFFFF0 and up from 512
+    // and low 0xFFFF0001 and up from 528. -1 for anything else.
+    S32 dense_number(U32 num)
+    {
+        if (num < 0x100)
+        {
+            return (S32)num;
+        }
+        if ((num & 0xFFFFFF00) == 0xFF00)
+        {
+            return 0x100 + (num & 0xFF);
+        }
+        if (num >= 0xFFFFFFF0)
+        {
+            return 0x200 + (num - 0xFFFFFFF0);
+        }
+        if ((num & 0xFFFF0000) == 0xFFFF0000)
+        {
+            return 0x210 + (num & 0xFFFF);
+        }
+        return -1;
+    }
+}
+// </FS>
+
 LLTemplateMessageReader::LLTemplateMessageReader(message_template_number_map_t&
                                                  number_template_map) :
     mReceiveSize(0),
     mCurrentRMessageTemplate(NULL),
     mCurrentRMessageData(NULL),
-    mMessageNumbers(number_template_map)
+    mMessageNumbers(number_template_map),
+    mBuffer(NULL), // <FS/> Zero-copy message reader
+    mNumberTableCount(0) // <FS/> Prehash index
 {
 }
 
@@ -63,8 +102,113 @@ void LLTemplateMessageReader::clearMessage()
     mCurrentRMessageTemplate = NULL;
     delete mCurrentRMessageData;
     mCurrentRMessageData = NULL;
+    // <FS> Zero-copy message reader
+    mBuffer = NULL;
+    mBlockSlots.clear();
+    mVarSlots.clear();
+    // </FS>
+}
+
+// <FS> Zero-copy message reader
+//static
+void LLTemplateMessageReader::setZeroCopy(bool zero_copy)
+{
+    sZeroCopy = zero_copy;
 }
 
+// Returns 0 and the slot of the variable, or why there isn't one
+S32 LLTemplateMessageReader::findSlot(const char* blockname, S32 blocknum, const char* varname,
+                                      const VarSlot** slot, const LLMessageVariable** variable) const
+{
+    const S32 block_index = mCurrentRMessageTemplate->getBlockIndex(blockname);
+    if (block_index < 0)
+    {
+        return LL_BLOCK_NOT_IN_MESSAGE;
+    }
+
+    const BlockSlot& block_slot = mBlockSlots[block_index];
+    if (blocknum < 0 || blocknum >= block_slot.mCount)
+    {
+        return LL_BLOCK_NOT_IN_MESSAGE;
+    }
+
+    const LLMessageBlock* block = *(mCurrentRMessageTemplate->mMemberBlocks.begin() + block_index);
+    const S32 var_index = block->getVariableIndex(varname);
+    if (var_index < 0)
+    {
+        return LL_VARIABLE_NOT_IN_BLOCK;
+    }
+
+    const LLMessageBlock::message_variable_map_t& variables = block->mMemberVariables;
+    *slot = &mVarSlots[block_slot.mFirstVar + blocknum * variables.size() + var_index];
+    if (variable)
+    {
+        *variable = *(variables.begin() + var_index);
+    }
+    return 0;
+}
+
+void LLTemplateMessageReader::getSlotData(const char* blockname, const char* varname, void* datap,
+                                          S32 size, S32 blocknum, S32 max_size)
+{
+    if (!mBuffer)
+    {
+        LL_ERRS() << "Invalid mBuffer in getData!" << LL_ENDL;
+        return;
+    }
+
+    const VarSlot* slot = NULL;
+    const LLMessageVariable* variable = NULL;
+    S32 found = findSlot(blockname, blocknum, varname, &slot, &variable);
+    if (found == LL_BLOCK_NOT_IN_MESSAGE)
+    {
+        LL_ERRS() << "Block " << blockname << " #" << blocknum
+            << " not in message " << mCurrentRMessageTemplate->mName << LL_ENDL;
+        return;
+    }
+    if (found == LL_VARIABLE_NOT_IN_BLOCK)
+    {
+        LL_ERRS() << "Variable "<< varname << " not in message "
+            << mCurrentRMessageTemplate->mName << " block " << blockname << LL_ENDL;
+        return;
+    }
+
+    if (size && size != slot->mSize)
+    {
+        LL_ERRS() << "Msg " << mCurrentRMessageTemplate->mName
+            << " variable " << varname
+            << " is size " << slot->mSize
+            << " but copying into buffer of size " << size
+            << LL_ENDL;
+        return;
+    }
+
+    S32 copy_size = slot->mSize;
+    if (max_size < copy_size)
+    {
+        LL_WARNS() << "Msg " << mCurrentRMessageTemplate->mName
+            << " variable " << varname
+            << " is size " << slot->mSize
+            << " but truncated to max size of " << max_size
+            << LL_ENDL;
+        copy_size = max_size;
+    }
+
+    if (slot->mOffset < 0)
+    { // the packet ended before it
+        memset(datap, 0, copy_size);
+    }
+    else if (copy_size == slot->mSize)
+    {
+        htolememcpy(datap, mBuffer + slot->mOffset, variable->getType(), copy_size);
+    }
+    else
+    {
+        memcpy(datap, mBuffer + slot->mOffset, copy_size);
+    }
+}
+// </FS>
+
 void LLTemplateMessageReader::getData(const char *blockname, const char *varname, void *datap, S32 size, S32 blocknum, S32 max_size)
 {
     // is there a message ready to go?
@@ -74,6 +218,14 @@ void LLTemplateMessageReader::getData(const char *blockname, const char *varname
         return;
     }
 
+    // <FS> Zero-copy message reader
+    if (sZeroCopy)
+    {
+        getSlotData(blockname, varname, datap, size, blocknum, max_size);
+        return;
+    }
+    // </FS>
+
     if (!mCurrentRMessageData)
     {
         LL_ERRS() << "Invalid mCurrentMessageData in getData!" << LL_ENDL;
@@ -159,6 +311,20 @@ S32 LLTemplateMessageReader::getNumberOfBlocks(const char *blockname)
         return -1;
     }
 
+    // <FS> Zero-copy message reader
+    if (sZeroCopy)
+    {
+        if (!mBuffer)
+        {
+            LL_ERRS() << "Invalid mBuffer in getNumberOfBlocks!" << LL_ENDL;
+            return -1;
+        }
+
+        const S32 block_index = mCurrentRMessageTemplate->getBlockIndex(blockname);
+        return block_index < 0 ? 0 : mBlockSlots[block_index].mCount;
+    }
+    // </FS>
+
     if (!mCurrentRMessageData)
     {
         LL_ERRS() << "Invalid mCurrentRMessageData in getData!" << LL_ENDL;
@@ -186,6 +352,39 @@ S32 LLTemplateMessageReader::getSize(const char *blockname, const char *varname)
         return LL_MESSAGE_ERROR;
     }
 
+    // <FS> Zero-copy message reader
+    if (sZeroCopy)
+    {
+        if (!mBuffer)
+        {   // This is a serious error - crash
+            LL_ERRS() << "Invalid mBuffer in getSize!" << LL_ENDL;
+            return LL_MESSAGE_ERROR;
+        }
+
+        const VarSlot* slot = NULL;
+        S32 found = findSlot(blockname, 0, varname, &slot);
+        if (found == LL_BLOCK_NOT_IN_MESSAGE)
+        {   // don't crash
+            LL_INFOS() << "Block " << blockname << " not in message "
+                << mCurrentRMessageTemplate->mName << LL_ENDL;
+            return found;
+        }
+        if (found == LL_VARIABLE_NOT_IN_BLOCK)
+        {   // don't crash
+            LL_INFOS() << "Variable " << varname << " not in message "
+                << mCurrentRMessageTemplate->mName << " block " << blockname << LL_ENDL;
+            return found;
+        }
+        if (mCurrentRMessageTemplate->mMemberBlocks[(char*)blockname]->mType != MBT_SINGLE)
+        {   // This is a serious error - crash
+            LL_ERRS() << "Block " << blockname << " isn't type MBT_SINGLE,"
+                " use getSize with blocknum argument!" << LL_ENDL;
+            return LL_MESSAGE_ERROR;
+        }
+        return slot->mSize;
+    }
+    // </FS>
+
     if (!mCurrentRMessageData)
     {   // This is a serious error - crash
         LL_ERRS() << "Invalid mCurrentRMessageData in getData!" << LL_ENDL;
@@ -234,6 +433,33 @@ S32 LLTemplateMessageReader::getSize(const char *blockname, S32 blocknum, const
         return LL_MESSAGE_ERROR;
     }
 
+    // <FS> Zero-copy message reader
+    if (sZeroCopy)
+    {
+        if (!mBuffer)
+        {   // This is a serious error - crash
+            LL_ERRS() << "Invalid mBuffer in getSize!" << LL_ENDL;
+            return LL_MESSAGE_ERROR;
+        }
+
+        const VarSlot* slot = NULL;
+        S32 found = findSlot(blockname, blocknum, varname, &slot);
+        if (found == LL_BLOCK_NOT_IN_MESSAGE)
+        {   // don't crash
+            LL_INFOS() << "Block " << blockname << " not in message "
+                << mCurrentRMessageTemplate->mName << LL_ENDL;
+            return found;
+        }
+        if (found == LL_VARIABLE_NOT_IN_BLOCK)
+        {   // don't crash
+            LL_INFOS() << "Variable " << varname << " not in message "
+                << mCurrentRMessageTemplate->mName << " block " << blockname << LL_ENDL;
+            return found;
+        }
+        return slot->mSize;
+    }
+    // </FS>
+
     if (!mCurrentRMessageData)
     {   // This is a serious error - crash
         LL_ERRS() << "Invalid mCurrentRMessageData in getData!" << LL_ENDL;
@@ -494,7 +720,8 @@ bool LLTemplateMessageReader::decodeTemplate(
         return(false);
     }
 
-    LLMessageTemplate* temp = get_ptr_in_map(mMessageNumbers,num);
+    //LLMessageTemplate* temp = get_ptr_in_map(mMessageNumbers,num); // <FS/> Prehash index
+    LLMessageTemplate* temp = findTemplate(num);
     if (temp)
     {
         *msg_template = temp;
@@ -511,6 +738,37 @@ bool LLTemplateMessageReader::decodeTemplate(
     return(true);
 }
 
+// <FS> Prehash index
+LLMessageTemplate* LLTemplateMessageReader::findTemplate(U32 num)
+{
+    if (mNumberTableCount != mMessageNumbers.size())
+    {
+        // templates are only added while the template file is read
+        mNumberTable.clear();
+        for (const auto& entry : mMessageNumbers)
+        {
+            const S32 index = dense_number(entry.first);
+            if (index >= 0)
+            {
+                if ((size_t)index >= mNumberTable.size())
+                {
+                    mNumberTable.resize(index + 1, NULL);
+                }
+                mNumberTable[index] = entry.second;
+            }
+        }
+        mNumberTableCount = mMessageNumbers.size();
+    }
+
+    const S32 index = dense_number(num);
+    if (index < 0)
+    {
+        return get_ptr_in_map(mMessageNumbers, num);
+    }
+    return (size_t)index < mNumberTable.size() ? mNumberTable[index] : NULL;
+}
+// </FS>
+
 void LLTemplateMessageReader::logRanOffEndOfPacket( const LLHost& host, const S32 where, const S32 wanted )
 {
     // we've run off the end of the packet!
@@ -532,26 +790,10 @@ void LLTemplateMessageReader::logRanOffEndOfPacket( const LLHost& host, const S3
 
 static LLTrace::BlockTimerStatHandle FTM_PROCESS_MESSAGES("Process Messages");
 
-// decode a given message
-bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender )
+// <FS> Zero-copy message reader
+// Copy every variable of the message into mCurrentRMessageData
+bool LLTemplateMessageReader::copyData(const U8* buffer, S32 decode_pos, const LLHost& sender)
 {
-    LL_RECORD_BLOCK_TIME(FTM_PROCESS_MESSAGES);
-
-    llassert( mReceiveSize >= 0 );
-    llassert( mCurrentRMessageTemplate);
-    llassert( !mCurrentRMessageData );
-    delete mCurrentRMessageData; // just to make sure
-	// <FS:Beq> storage for Tracy tag
-	#ifdef TRACY_ENABLE
-	static char msgstr[36];
-	#endif
-    // </FS:Beq>    
-
-    // The offset tells us how may bytes to skip after the end of the
-    // message name.
-    U8 offset = buffer[PHL_OFFSET];
-    S32 decode_pos = LL_PACKET_ID_SIZE + (S32)(mCurrentRMessageTemplate->mFrequency) + offset;
-
     // create base working data set
     mCurrentRMessageData = new LLMsgData(mCurrentRMessageTemplate->mName);
 
@@ -716,6 +958,206 @@ bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender
         LL_DEBUGS() << "Empty message '" << mCurrentRMessageTemplate->mName << "' (no blocks)" << LL_ENDL;
         return false;
     }
+    return true;
+}
+
+// Find where every variable of the message starts in buffer, reading the
+// sizes of the variable blocks and variables the same way copyData() does
+bool LLTemplateMessageReader::buildSlots(const U8* buffer, S32 decode_pos, const LLHost& sender)
+{
+    mBuffer = buffer;
+    mBlockSlots.clear();
+    mVarSlots.clear();
+    // <FS:Beq> Tracy Message processing
+    #ifdef TRACY_ENABLE
+    strncpy(msgstr, mCurrentRMessageTemplate->mName, 35);
+    #endif
+    // </FS:Beq>
+
+    bool any_block = false;
+    LLMessageTemplate::message_block_map_t::const_iterator iter;
+    for(iter = mCurrentRMessageTemplate->mMemberBlocks.begin();
+        iter != mCurrentRMessageTemplate->mMemberBlocks.end();
+        ++iter)
+    {
+        const LLMessageBlock* mbci = *iter;
+        S32 repeat_number;
+
+        if (mbci->mType == MBT_SINGLE)
+        {
+            repeat_number = 1;
+        }
+        else if (mbci->mType == MBT_MULTIPLE)
+        {
+            repeat_number = mbci->mNumber;
+        }
+        else if (mbci->mType == MBT_VARIABLE)
+        {
+            // missing variable blocks at the end of the message are legal
+            if (decode_pos >= mReceiveSize)
+            {
+                repeat_number = 0;
+            }
+            else
+            {
+                repeat_number = buffer[decode_pos];
+                decode_pos++;
+            }
+        }
+        else
+        {
+            LL_ERRS() << "Unknown block type" << LL_ENDL;
+            return false;
+        }
+
+        BlockSlot block_slot;
+        block_slot.mCount = repeat_number;
+        block_slot.mFirstVar = (S32)mVarSlots.size();
+        mBlockSlots.push_back(block_slot);
+        any_block |= repeat_number > 0;
+
+        for (S32 i = 0; i < repeat_number; i++)
+        {
+            for (LLMessageBlock::message_variable_map_t::const_iterator var_iter = mbci->mMemberVariables.begin();
+                 var_iter != mbci->mMemberVariables.end(); var_iter++)
+            {
+                const LLMessageVariable& mvci = **var_iter;
+                VarSlot var_slot;
+
+                if (mvci.getType() == MVT_VARIABLE)
+                {
+                    S32 data_size = mvci.getSize();
+                    U8 tsizeb = 0;
+                    U16 tsizeh = 0;
+                    U32 tsize = 0;
+
+                    if ((decode_pos + data_size) > mReceiveSize)
+                    {
+                        logRanOffEndOfPacket(sender, decode_pos, data_size);
+
+                        // default to 0 length variable blocks
+                        tsize = 0;
+                    }
+                    else
+                    {
+                        switch(data_size)
+                        {
+                        case 1:
+                            htolememcpy(&tsizeb, &buffer[decode_pos], MVT_U8, 1);
+                            tsize = tsizeb;
+                            break;
+                        case 2:
+                            htolememcpy(&tsizeh, &buffer[decode_pos], MVT_U16, 2);
+                            tsize = tsizeh;
+                            break;
+                        case 4:
+                            htolememcpy(&tsize, &buffer[decode_pos], MVT_U32, 4);
+                            break;
+                        default:
+                            LL_ERRS() << "Attempting to read variable field with unknown size of " << data_size << LL_ENDL;
+                            break;
+                        }
+                    }
+                    decode_pos += data_size;
+
+                    var_slot.mOffset = decode_pos;
+                    var_slot.mSize = (S32)tsize;
+                    decode_pos += tsize;
+                }
+                else
+                {
+                    if ((decode_pos + mvci.getSize()) > mReceiveSize)
+                    {
+                        logRanOffEndOfPacket(sender, decode_pos, mvci.getSize());
+
+                        // default to 0s.
+                        var_slot.mOffset = -1;
+                    }
+                    else
+                    {
+                        var_slot.mOffset = decode_pos;
+                    }
+                    var_slot.mSize = mvci.getSize();
+                    decode_pos += mvci.getSize();
+                }
+
+                mVarSlots.push_back(var_slot);
+            }
+        }
+    }
+
+    if (!any_block && !mCurrentRMessageTemplate->mMemberBlocks.empty())
+    {
+        LL_DEBUGS() << "Empty message '" << mCurrentRMessageTemplate->mName << "' (no blocks)" << LL_ENDL;
+        return false;
+    }
+    return true;
+}
+
+// What copyData() would have made of the message
+void LLTemplateMessageReader::buildMsgData(LLMsgData& msg_data) const
+{
+    LLMessageTemplate::message_block_map_t::const_iterator iter;
+    S32 block_index = 0;
+    for(iter = mCurrentRMessageTemplate->mMemberBlocks.begin();
+        iter != mCurrentRMessageTemplate->mMemberBlocks.end();
+        ++iter, ++block_index)
+    {
+        const LLMessageBlock* mbci = *iter;
+        const BlockSlot& block_slot = mBlockSlots[block_index];
+        const S32 var_count = (S32)mbci->mMemberVariables.size();
+
+        for (S32 i = 0; i < block_slot.mCount; i++)
+        {
+            LLMsgBlkData* cur_data_block = new LLMsgBlkData(mbci->mName, block_slot.mCount);
+            cur_data_block->mName = mbci->mName + i;
+            msg_data.addBlock(cur_data_block);
+
+            S32 var_index = block_slot.mFirstVar + i * var_count;
+            for (LLMessageBlock::message_variable_map_t::const_iterator var_iter = mbci->mMemberVariables.begin();
+                 var_iter != mbci->mMemberVariables.end(); var_iter++, var_index++)
+            {
+                const LLMessageVariable& mvci = **var_iter;
+                const VarSlot& var_slot = mVarSlots[var_index];
+
+                cur_data_block->addVariable(mvci.getName(), mvci.getType());
+                if (var_slot.mOffset < 0)
+                {
+                    std::vector<U8> data(var_slot.mSize, 0);
+                    cur_data_block->addData(mvci.getName(), &(data[0]), var_slot.mSize, mvci.getType());
+                }
+                else
+                {
+                    cur_data_block->addData(mvci.getName(), mBuffer + var_slot.mOffset, var_slot.mSize, mvci.getType());
+                }
+            }
+        }
+    }
+}
+// </FS>
+
+// decode a given message
+bool LLTemplateMessageReader::decodeData(const U8* buffer, const LLHost& sender )
+{
+    LL_RECORD_BLOCK_TIME(FTM_PROCESS_MESSAGES);
+
+    llassert( mReceiveSize >= 0 );
+    llassert( mCurrentRMessageTemplate);
+    llassert( !mCurrentRMessageData );
+    delete mCurrentRMessageData; // just to make sure
+
+    // The offset tells us how may bytes to skip after the end of the
+    // message name.
+    U8 offset = buffer[PHL_OFFSET];
+    S32 decode_pos = LL_PACKET_ID_SIZE + (S32)(mCurrentRMessageTemplate->mFrequency) + offset;
+
+    // <FS> Zero-copy message reader
+    bool decoded = sZeroCopy ? buildSlots(buffer, decode_pos, sender) : copyData(buffer, decode_pos, sender);
+    if (!decoded)
+    {
+        return false;
+    }
+    // </FS>
 
     {
         // <FS:Beq> Tracy Message processing
@@ -848,5 +1290,14 @@ void LLTemplateMessageReader::copyToBuilder(LLMessageBuilder& builder) const
     {
         return;
     }
+    // <FS> Zero-copy message reader
+    if (sZeroCopy)
+    {
+        LLMsgData msg_data(mCurrentRMessageTemplate->mName);
+        buildMsgData(msg_data);
+        builder.copyFromMessageData(msg_data);
+        return;
+    }
+    // </FS>
     builder.copyFromMessageData(*mCurrentRMessageData);
 }
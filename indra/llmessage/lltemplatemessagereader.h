@@ -30,8 +30,10 @@
 #include "llmessagereader.h"
 
 #include <map>
+#include <vector>
 
 class LLMessageTemplate;
+class LLMessageVariable;
 class LLMsgData;
 
 class LLTemplateMessageReader : public LLMessageReader
@@ -106,6 +108,15 @@ public:
     bool isBanned(bool trusted_source) const;
     bool isUdpBanned() const;
 
+    // <FS> Zero-copy message reader
+    // Read the variables straight out of the received packet through a table
+    // of their offsets, instead of copying each of them into an LLMsgData
+    // before the handler runs. The packet buffer has to stay untouched until
+    // clearMessage(), which LLMessageSystem does by receiving into its own
+    // buffers.
+    static void setZeroCopy(bool zero_copy);
+    // </FS>
+
 private:
 
     void getData(const char *blockname, const char *varname, void *datap,
@@ -118,10 +129,47 @@ private:
 
     bool decodeData(const U8* buffer, const LLHost& sender );
 
+    // <FS> Zero-copy message reader
+    struct BlockSlot
+    {
+        S32 mCount;     // repetitions in this message
+        S32 mFirstVar;  // in mVarSlots, first variable of the first repetition
+    };
+    struct VarSlot
+    {
+        S32 mOffset;    // in mBuffer, -1 when the packet ended before it
+        S32 mSize;
+    };
+
+    bool copyData(const U8* buffer, S32 decode_pos, const LLHost& sender);
+    bool buildSlots(const U8* buffer, S32 decode_pos, const LLHost& sender);
+    S32 findSlot(const char* blockname, S32 blocknum, const char* varname,
+                 const VarSlot** slot, const LLMessageVariable** variable = NULL) const;
+    void getSlotData(const char* blockname, const char* varname, void* datap,
+                     S32 size, S32 blocknum, S32 max_size);
+    void buildMsgData(LLMsgData& msg_data) const;
+    // </FS>
+
+    // <FS> Prehash index
+    LLMessageTemplate* findTemplate(U32 num);
+    // </FS>
+
     S32 mReceiveSize;
     LLMessageTemplate* mCurrentRMessageTemplate;
     LLMsgData* mCurrentRMessageData;
     message_template_number_map_t& mMessageNumbers;
+
+    // <FS> Zero-copy message reader
+    static bool sZeroCopy;
+    const U8* mBuffer;                      // of the message being read
+    std::vector<BlockSlot> mBlockSlots;     // in template block order
+    std::vector<VarSlot> mVarSlots;
+    // </FS>
+
+    // <FS> Prehash index
+    std::vector<LLMessageTemplate*> mNumberTable;   // mMessageNumbers by dense_number()
+    size_t mNumberTableCount;                       // templates in mNumberTable
+    // </FS>
 };
 
 #endif // LL_LLTEMPLATEMESSAGEREADER_H
@@ -0,0 +1,177 @@
+/**
+ * @file llzerocode.cpp
+ * @brief SSE2 zero coding of template message packets.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llzerocode.h"
+
+#include <emmintrin.h>
+#if LL_WINDOWS
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // Largest run one zero and a count byte stand for
+    constexpr S32 MAX_RUN = 255;
+
+    inline S32 first_set_bit(U32 mask)
+    {
+#if LL_WINDOWS
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (S32)index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    // Index of the first zero byte from i on, size if there is none
+    inline S32 find_zero(const U8* in, S32 i, S32 size)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= size; i += 16)
+        {
+            U32 mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(in + i)), zero));
+            if (mask)
+            {
+                return i + first_set_bit(mask);
+            }
+        }
+        while (i < size && in[i])
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    // Index of the first non zero byte from i on, size if there is none
+    inline S32 find_nonzero(const U8* in, S32 i, S32 size)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= size; i += 16)
+        {
+            U32 mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(in + i)), zero)) ^ 0xffff;
+            if (mask)
+            {
+                return i + first_set_bit(mask);
+            }
+        }
+        while (i < size && !in[i])
+        {
+            ++i;
+        }
+        return i;
+    }
+}
+
+S32 LLZeroCode::encode(const U8* in, S32 size, U8* out)
+{
+    U8* outptr = out;
+    S32 i = 0;
+    while (i < size)
+    {
+        const S32 zero = find_zero(in, i, size);
+        memcpy(outptr, in + i, zero - i);
+        outptr += zero - i;
+        if (zero == size)
+        {
+            break;
+        }
+
+        i = find_nonzero(in, zero, size);
+        S32 run = i - zero;
+        for (; run >= MAX_RUN; run -= MAX_RUN)
+        {
+            *outptr++ = 0;
+            *outptr++ = MAX_RUN;
+        }
+        if (run)
+        {
+            *outptr++ = 0;
+            *outptr++ = (U8)run;
+        }
+    }
+    return (S32)(outptr - out);
+}
+
+S32 LLZeroCode::encodedSize(const U8* in, S32 size)
+{
+    S32 encoded = size;
+    S32 i = find_zero(in, 0, size);
+    while (i < size)
+    {
+        const S32 zero = i;
+        i = find_nonzero(in, zero, size);
+        const S32 run = i - zero;
+        encoded += 2 * ((run + MAX_RUN - 1) / MAX_RUN) - run;
+        i = find_zero(in, i, size);
+    }
+    return encoded;
+}
+
+S32 LLZeroCode::expand(const U8* in, S32 size, U8* out, S32 capacity)
+{
+    S32 written = 0;
+    S32 i = 0;
+    while (i < size)
+    {
+        const S32 zero = find_zero(in, i, size);
+        const S32 literal = zero - i;
+        if (written + literal > capacity)
+        {
+            return -1;
+        }
+        memcpy(out + written, in + i, literal);
+        written += literal;
+        if (zero == size)
+        {
+            break;
+        }
+
+        // the zero stands for itself, each zero after it for 256 more and
+        // the count byte that ends the run for count - 1 more
+        i = zero + 1;
+        S32 run = 1;
+        while (i < size && !in[i])
+        {
+            run += 256;
+            ++i;
+        }
+        if (i < size)
+        {
+            run += in[i++] - 1;
+        }
+
+        if (written + run > capacity)
+        {
+            return -1;
+        }
+        memset(out + written, 0, run);
+        written += run;
+    }
+    return written;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file llzerocode.h
+ * @brief SSE2 zero coding of template message packets.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLZEROCODE_H
+#define LL_LLZEROCODE_H
+
+#include "stdtypes.h"
+
+// Zero coding squeezes the runs of zero bytes out of a packet body: a run
+// becomes a zero followed by its length, with runs longer than 255 split in
+// pieces of 255. Expanding also takes the 0 0 [count] wrap form, 256 more
+// zeroes per extra zero, though nothing sends it.
+//
+// The viewer requires SSE2 (see llsimdmath.h), so these need no runtime
+// dispatch. Literal bytes between zeroes are found sixteen at a time and
+// copied as a block, the output is byte for byte what the scalar loops in
+// LLMessageSystem and LLTemplateMessageBuilder made.
+namespace LLZeroCode
+{
+    // Encode size bytes of in into out, which must hold 2 * size bytes.
+    // Returns the encoded size.
+    S32 encode(const U8* in, S32 size, U8* out);
+
+    // What encode() would return, without writing anything
+    S32 encodedSize(const U8* in, S32 size);
+
+    // Expand size bytes of in into out. Returns the expanded size, or -1 if
+    // it would take more than capacity bytes.
+    S32 expand(const U8* in, S32 size, U8* out, S32 capacity);
+}
+
+#endif // LL_LLZEROCODE_H
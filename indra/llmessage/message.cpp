@@ -70,6 +70,7 @@
 #include "lltransfermanager.h"
 #include "lluuid.h"
 #include "llxfermanager.h"
+#include "llzerocode.h"
 #include "llquaternion.h"
 #include "u64.h"
 #include "v3dmath.h"
@@ -328,6 +329,8 @@ LLMessageSystem::~LLMessageSystem()
     for_each(mMessageNumbers.begin(), mMessageNumbers.end(), DeletePairedPointer());
     mMessageNumbers.clear();
 
+    mPacketRing.stopReceiveThread(); // <FS/> Network thread, before its socket goes
+
     if (!mbError)
     {
         end_net(mSocket);
@@ -2770,54 +2773,11 @@ S32 LLMessageSystem::zeroCodeAdjustCurrentSendTotal()
     // TODO: babbage: remove this horror
     mMessageBuilder->setBuilt(false);
 
-    S32 count = mSendSize;
-
-    S32 net_gain = 0;
-    U8 num_zeroes = 0;
-
-    U8 *inptr = (U8 *)mSendBuffer;
-
-// skip the packet id field
-
-    for (U32 ii = 0; ii < LL_PACKET_ID_SIZE; ++ii)
-    {
-        count--;
-        inptr++;
-    }
-
-// don't actually build, just test
+// skip the packet id field, don't actually build, just test
 
-// sequential zero bytes are encoded as 0 [U8 count]
-// with 0 0 [count] representing wrap (>256 zeroes)
+    S32 body_size = mSendSize - LL_PACKET_ID_SIZE;
+    S32 net_gain = LLZeroCode::encodedSize((U8 *)mSendBuffer + LL_PACKET_ID_SIZE, body_size) - body_size;
 
-    while (count--)
-    {
-        if (!(*inptr))   // in a zero count
-        {
-            if (num_zeroes)
-            {
-                if (++num_zeroes > 254)
-                {
-                    num_zeroes = 0;
-                }
-                net_gain--;   // subseqent zeroes save one
-            }
-            else
-            {
-                net_gain++;  // starting a zero count adds one
-                num_zeroes = 1;
-            }
-            inptr++;
-        }
-        else
-        {
-            if (num_zeroes)
-            {
-                num_zeroes = 0;
-            }
-            inptr++;
-        }
-    }
     if (net_gain < 0)
     {
         return net_gain;
@@ -2852,72 +2812,24 @@ S32 LLMessageSystem::zeroCodeExpand(U8** data, S32* data_size)
 
     *data[0] &= (~LL_ZERO_CODE_FLAG);
 
-    S32 count = (*data_size);
-
     U8 *inptr = (U8 *)*data;
-    U8 *outptr = (U8 *)mEncodedRecvBuffer;
 
 // skip the packet id field
 
-    for (U32 ii = 0; ii < LL_PACKET_ID_SIZE; ++ii)
-    {
-        count--;
-        *outptr++ = *inptr++;
-    }
-
-// reconstruct encoded packet, keeping track of net size gain
+    memcpy(mEncodedRecvBuffer, inptr, LL_PACKET_ID_SIZE);
 
-// sequential zero bytes are encoded as 0 [U8 count]
-// with 0 0 [count] representing wrap (>256 zeroes)
+// reconstruct encoded packet
 
-    while (count--)
+    S32 expanded = LLZeroCode::expand(inptr + LL_PACKET_ID_SIZE, in_size - LL_PACKET_ID_SIZE,
+        mEncodedRecvBuffer + LL_PACKET_ID_SIZE, MAX_BUFFER_SIZE - LL_PACKET_ID_SIZE);
+    if (expanded < 0)
     {
-        if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-1]))
-        {
-            LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 1" << LL_ENDL;
-            callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-            outptr = mEncodedRecvBuffer;
-            break;
-        }
-        if (!((*outptr++ = *inptr++)))
-        {
-            while (((count--)) && (!(*inptr)))
-            {
-                *outptr++ = *inptr++;
-                if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-256]))
-                {
-                    LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 2" << LL_ENDL;
-                    callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-                    outptr = mEncodedRecvBuffer;
-                    count = -1;
-                    break;
-                }
-                memset(outptr,0,255);
-                outptr += 255;
-            }
-
-            if (count < 0)
-            {
-                break;
-            }
-
-            else
-            {
-                if (outptr > (&mEncodedRecvBuffer[MAX_BUFFER_SIZE-(*inptr)]))
-                {
-                    LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size 3" << LL_ENDL;
-                    callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
-                    outptr = mEncodedRecvBuffer;
-                }
-                memset(outptr,0,(*inptr) - 1);
-                outptr += ((*inptr) - 1);
-                inptr++;
-            }
-        }
+        LL_WARNS("Messaging") << "attempt to write past reasonable encoded buffer size" << LL_ENDL;
+        callExceptionFunc(MX_WROTE_PAST_BUFFER_SIZE);
     }
 
     *data = mEncodedRecvBuffer;
-    *data_size = (S32)(outptr - mEncodedRecvBuffer);
+    *data_size = expanded < 0 ? 0 : LL_PACKET_ID_SIZE + expanded;
     mUncompressedBytesIn += *data_size;
 
     return(in_size);
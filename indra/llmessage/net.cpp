@@ -40,6 +40,7 @@
     #include <arpa/inet.h>
     #include <fcntl.h>
     #include <errno.h>
+    #include <poll.h>   // <FS/> Network thread
 #endif
 
 // linden library includes
@@ -376,6 +377,40 @@ bool send_packet(int hSocket, const char *sendBuffer, int size, U32 recipient, i
     return (nRet != SOCKET_ERROR);
 }
 
+// <FS> Network thread
+S32 receive_packets(int hSocket, net_packet_t* packets, S32 count)
+{
+    // Winsock has no batched receive short of registered I/O, read one at a time
+    S32 received = 0;
+    while (received < count)
+    {
+        net_packet_t& packet = packets[received];
+        SOCKADDR_IN from;
+        int addr_size = sizeof(from);
+        int nRet = recvfrom(hSocket, packet.mData, NET_BUFFER_SIZE, 0, (struct sockaddr*)&from, &addr_size);
+        if (nRet == SOCKET_ERROR || nRet == 0)
+        {
+            break;
+        }
+        packet.mSize = nRet;
+        packet.mSenderIP = from.sin_addr.s_addr;
+        packet.mSenderPort = ntohs(from.sin_port);
+        packet.mReceivingIF = INVALID_HOST_IP_ADDRESS;
+        ++received;
+    }
+    return received;
+}
+
+bool wait_for_packet(int hSocket, S32 timeout_ms)
+{
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET((SOCKET)hSocket, &readable);
+    timeval timeout = { timeout_ms / 1000, (timeout_ms % 1000) * 1000 };
+    return select(0, &readable, NULL, NULL, &timeout) > 0;
+}
+// </FS>
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // Linux Versions
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -658,6 +693,87 @@ bool send_packet(int hSocket, const char * sendBuffer, int size, U32 recipient,
     return success;
 }
 
+// <FS> Network thread
+S32 receive_packets(int hSocket, net_packet_t* packets, S32 count)
+{
+#if LL_LINUX
+    constexpr S32 MAX_BATCH = 64;
+    struct mmsghdr msgs[MAX_BATCH];
+    struct iovec iovs[MAX_BATCH];
+    struct sockaddr_in from[MAX_BATCH];
+    char cmsgs[MAX_BATCH][CMSG_SPACE(sizeof(struct in_pktinfo))];
+
+    count = llmin(count, MAX_BATCH);
+    memset(msgs, 0, sizeof(msgs[0]) * count);
+    for (S32 i = 0; i < count; ++i)
+    {
+        iovs[i].iov_base = packets[i].mData;
+        iovs[i].iov_len = NET_BUFFER_SIZE;
+        msgs[i].msg_hdr.msg_name = &from[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = cmsgs[i];
+        msgs[i].msg_hdr.msg_controllen = sizeof(cmsgs[i]);
+    }
+
+    int received = recvmmsg(hSocket, msgs, count, MSG_DONTWAIT, NULL);
+    if (received <= 0)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < received; ++i)
+    {
+        net_packet_t& packet = packets[i];
+        packet.mSize = msgs[i].msg_len;
+        packet.mSenderIP = from[i].sin_addr.s_addr;
+        packet.mSenderPort = ntohs(from[i].sin_port);
+        packet.mReceivingIF = INVALID_HOST_IP_ADDRESS;
+
+        // same as recvfrom_destip()
+        for (struct cmsghdr* cmsgptr = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsgptr != NULL; cmsgptr = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsgptr))
+        {
+            if (cmsgptr->cmsg_level == SOL_IP && cmsgptr->cmsg_type == IP_PKTINFO)
+            {
+                in_pktinfo* pktinfo = (in_pktinfo*)CMSG_DATA(cmsgptr);
+                packet.mReceivingIF = pktinfo->ipi_spec_dst.s_addr;
+            }
+        }
+    }
+    return received;
+#else
+    S32 received = 0;
+    while (received < count)
+    {
+        net_packet_t& packet = packets[received];
+        struct sockaddr_in from;
+        socklen_t addr_size = sizeof(from);
+        int nRet = recvfrom(hSocket, packet.mData, NET_BUFFER_SIZE, 0, (struct sockaddr*)&from, &addr_size);
+        if (nRet <= 0)
+        {
+            break;
+        }
+        packet.mSize = nRet;
+        packet.mSenderIP = from.sin_addr.s_addr;
+        packet.mSenderPort = ntohs(from.sin_port);
+        packet.mReceivingIF = INVALID_HOST_IP_ADDRESS;
+        ++received;
+    }
+    return received;
+#endif
+}
+
+bool wait_for_packet(int hSocket, S32 timeout_ms)
+{
+    struct pollfd readable;
+    readable.fd = hSocket;
+    readable.events = POLLIN;
+    readable.revents = 0;
+    return poll(&readable, 1, timeout_ms) > 0 && (readable.revents & POLLIN);
+}
+// </FS>
+
 #endif
 
 //EOF
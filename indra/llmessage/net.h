@@ -45,6 +45,26 @@ S32     receive_packet(int hSocket, char * receiveBuffer);
 
 bool    send_packet(int hSocket, const char *sendBuffer, int size, U32 recipient, int nPort);   // Returns true on success.
 
+// <FS> Network thread
+// One datagram read by receive_packets(), mData must hold NET_BUFFER_SIZE bytes
+struct net_packet_t
+{
+    char*   mData;
+    S32     mSize;
+    U32     mSenderIP;
+    U32     mSenderPort;
+    U32     mReceivingIF;
+};
+
+// Reads up to count waiting datagrams, with a single recvmmsg() on Linux.
+// Returns how many were read, 0 if none were waiting.
+// Doesn't touch the state behind get_sender() and get_receiving_interface().
+S32     receive_packets(int hSocket, net_packet_t* packets, S32 count);
+
+// Waits up to timeout_ms for a datagram to arrive, true if one is waiting.
+bool    wait_for_packet(int hSocket, S32 timeout_ms);
+// </FS>
+
 //void  get_sender(char * tmp);
 LLHost  get_sender();
 U32     get_sender_port();
@@ -176,4 +176,37 @@ namespace tut
         LL_INFOS("CoMain") << "checking count" << LL_ENDL;
         ensure_equals("coprocedure failed to update counter", counter, 5);
     }
+
+    // waiting coprocedures run by priority, in enqueue order within one
+    template<> template<>
+    void coproceduremanager_object_t::test<5>()
+    {
+        Sync sync;
+        std::string order;
+        auto proc = [&order, &sync](char tag)
+        {
+            return [&order, &sync, tag](LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t &, const LLUUID &)
+            {
+                order += tag;
+                sync.bump();
+            };
+        };
+
+        // single coroutine, so nothing runs before all are queued
+        LLCoprocedureManager::instance().initializePool("Upload");
+        LLCoprocedureManager::instance().enqueueCoprocedure("Upload", "low1", proc('a'), LLCoprocedureManager::PRIORITY_LOW);
+        LLCoprocedureManager::instance().enqueueCoprocedure("Upload", "normal", proc('b'));
+        LLCoprocedureManager::instance().enqueueCoprocedure("Upload", "low2", proc('c'), LLCoprocedureManager::PRIORITY_LOW);
+        LLCoprocedureManager::instance().enqueueCoprocedure("Upload", "high", proc('d'), LLCoprocedureManager::PRIORITY_HIGH);
+
+        sync.yield(4);
+        ensure_equals("run order", order, std::string("dbac"));
+
+        LLSD stats = LLCoprocedureManager::instance().getStats()["Upload"];
+        ensure_equals("completed", stats["completed"].asInteger(), 4);
+        ensure_equals("max pending", stats["max_pending"].asInteger(), 4);
+        ensure_equals("pending", stats["pending"].asInteger(), 0);
+
+        LLCoprocedureManager::instance().close("Upload");
+    }
 }  // namespace tut
@@ -0,0 +1,192 @@
+/**
+ * @file llprehashindex_test.cpp
+ * @brief LLPrehashIndex test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llprehashindex.h"
+
+#include "llindexedvector.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+// -------------------------------------------------------------------------------------------
+// A string table laid out like LLMessageStringTable's
+// -------------------------------------------------------------------------------------------
+
+namespace
+{
+    constexpr U32 STRING_LENGTH = 64;
+    constexpr U32 STRING_COUNT = 8192;
+
+    char sTable[STRING_COUNT][STRING_LENGTH];
+
+    U32 next_random(U32& seed)
+    {
+        seed = seed * 1664525 + 1013904223;
+        return seed >> 8;
+    }
+
+    // count distinct strings of the table, spread like hashed names
+    std::vector<const char*> pick_names(U32 count, U32 seed)
+    {
+        std::vector<bool> used(STRING_COUNT, false);
+        std::vector<const char*> names;
+        while (names.size() < count)
+        {
+            const U32 bucket = next_random(seed) % STRING_COUNT;
+            if (!used[bucket])
+            {
+                used[bucket] = true;
+                names.push_back(sTable[bucket]);
+            }
+        }
+        return names;
+    }
+
+    void build(LLPrehashIndex& index, const std::vector<const char*>& names)
+    {
+        index.build(names, sTable[0], STRING_LENGTH, STRING_COUNT);
+    }
+}
+
+// -------------------------------------------------------------------------------------------
+// TUT
+// -------------------------------------------------------------------------------------------
+
+namespace tut
+{
+    struct prehashindex_test
+    {
+    };
+
+    typedef test_group<prehashindex_test> prehashindex_t;
+    typedef prehashindex_t::object prehashindex_object_t;
+    tut::prehashindex_t tut_prehashindex("LLPrehashIndex");
+
+    template<> template<>
+    void prehashindex_object_t::test<1>()
+    {
+        // Every name is found at its index, from blocks of one variable up
+        // to all the message names of the template file
+        const U32 counts[] = { 0, 1, 2, 3, 7, 8, 20, 64, 200, 700, 4000 };
+        for (U32 count : counts)
+        {
+            for (U32 seed = 1; seed <= 10; ++seed)
+            {
+                const std::vector<const char*> names = pick_names(count, seed * 7919 + count);
+                LLPrehashIndex index;
+                build(index, names);
+                ensure_equals("size", index.size(), count);
+                for (U32 i = 0; i < count; ++i)
+                {
+                    ensure_equals("index of name " + std::to_string(i) + " of " + std::to_string(count), index.find(names[i]), (S32)i);
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void prehashindex_object_t::test<2>()
+    {
+        // Anything else isn't
+        const std::vector<const char*> names = pick_names(12, 3);
+        LLPrehashIndex index;
+        build(index, names);
+
+        std::map<const char*, S32> known;
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            known[names[i]] = (S32)i;
+        }
+        for (U32 bucket = 0; bucket < STRING_COUNT; ++bucket)
+        {
+            const char* name = sTable[bucket];
+            const S32 expected = known.count(name) ? known[name] : -1;
+            ensure_equals("string " + std::to_string(bucket), index.find(name), expected);
+            // the block number offset LLMsgData keys by
+            ensure_equals("inside string " + std::to_string(bucket), index.find(name + 1), -1);
+        }
+
+        const char outside[] = "Block";
+        ensure_equals("not in the table", index.find(outside), -1);
+        ensure_equals("null", index.find(NULL), -1);
+        ensure_equals("past the table", index.find((const char*)sTable + sizeof(sTable)), -1);
+
+        LLPrehashIndex empty;
+        ensure_equals("never built", empty.find(names[0]), -1);
+    }
+
+    template<> template<>
+    void prehashindex_object_t::test<3>()
+    {
+        // Microbenchmark against the maps the templates look names up in,
+        // reported only: timings are not reliable enough to assert on
+        const U32 counts[] = { 4, 16, 600 };
+        for (U32 count : counts)
+        {
+            const std::vector<const char*> names = pick_names(count, count);
+            LLPrehashIndex index;
+            build(index, names);
+            LLIndexedVector<S32, const char*, 8> indexed;
+            for (size_t i = 0; i < names.size(); ++i)
+            {
+                indexed[names[i]] = (S32)i;
+            }
+
+            std::vector<const char*> lookups;
+            U32 seed = 17;
+            for (U32 i = 0; i < 1000000; ++i)
+            {
+                lookups.push_back(names[next_random(seed) % count]);
+            }
+
+            LLTimer timer;
+            S64 map_sum = 0;
+            for (const char* name : lookups)
+            {
+                map_sum += *indexed.find(name);
+            }
+            F64 map_time = timer.getElapsedTimeF64();
+
+            timer.reset();
+            S64 index_sum = 0;
+            for (const char* name : lookups)
+            {
+                index_sum += index.find(name);
+            }
+            F64 index_time = timer.getElapsedTimeF64();
+
+            ensure_equals("same indices", index_sum, map_sum);
+            LL_INFOS() << "1M lookups in " << count << " names: LLIndexedVector " << map_time * 1000.0
+                << " ms, LLPrehashIndex " << index_time * 1000.0 << " ms" << LL_ENDL;
+        }
+    }
+}
@@ -0,0 +1,226 @@
+/**
+ * @file llzerocode_test.cpp
+ * @brief LLZeroCode test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llzerocode.h"
+
+#include "../test/lltut.h"
+
+#include <string>
+#include <vector>
+
+// -------------------------------------------------------------------------------------------
+// Reference implementations: the scalar loops from LLTemplateMessageBuilder and
+// LLMessageSystem the kernels replaced, without the packet id field
+// -------------------------------------------------------------------------------------------
+
+namespace
+{
+    S32 ref_encode(const U8* in, S32 size, U8* out)
+    {
+        S32 count = size;
+        U8 num_zeroes = 0;
+        const U8* inptr = in;
+        U8* outptr = out;
+
+        while (count--)
+        {
+            if (!(*inptr))
+            {
+                if (num_zeroes)
+                {
+                    if (++num_zeroes > 254)
+                    {
+                        *outptr++ = num_zeroes;
+                        num_zeroes = 0;
+                    }
+                }
+                else
+                {
+                    *outptr++ = 0;
+                    num_zeroes = 1;
+                }
+                inptr++;
+            }
+            else
+            {
+                if (num_zeroes)
+                {
+                    *outptr++ = num_zeroes;
+                    num_zeroes = 0;
+                }
+                *outptr++ = *inptr++;
+            }
+        }
+
+        if (num_zeroes)
+        {
+            *outptr++ = num_zeroes;
+        }
+        return (S32)(outptr - out);
+    }
+
+    // out must be big enough, the buffer checks are left out
+    S32 ref_expand(const U8* in, S32 size, U8* out)
+    {
+        S32 count = size;
+        const U8* inptr = in;
+        U8* outptr = out;
+
+        while (count--)
+        {
+            if (!((*outptr++ = *inptr++)))
+            {
+                while (((count--)) && (!(*inptr)))
+                {
+                    *outptr++ = *inptr++;
+                    memset(outptr, 0, 255);
+                    outptr += 255;
+                }
+
+                if (count < 0)
+                {
+                    break;
+                }
+                else
+                {
+                    memset(outptr, 0, (*inptr) - 1);
+                    outptr += ((*inptr) - 1);
+                    inptr++;
+                }
+            }
+        }
+        return (S32)(outptr - out);
+    }
+
+    U32 next_random(U32& seed)
+    {
+        seed = seed * 1664525 + 1013904223;
+        return seed >> 8;
+    }
+
+    // Random bytes with runs of zeroes of every length, like the padding
+    // and empty fields of ObjectUpdate
+    void fill_packet(std::vector<U8>& data, U32 seed)
+    {
+        size_t i = 0;
+        while (i < data.size())
+        {
+            size_t run = next_random(seed) % 24;
+            if (next_random(seed) % 16 == 0)
+            {
+                run = next_random(seed) % 800;
+            }
+            const bool zeroes = next_random(seed) % 2;
+            for (; run && i < data.size(); --run, ++i)
+            {
+                data[i] = zeroes ? 0 : U8(next_random(seed) % 255 + 1);
+            }
+        }
+    }
+}
+
+// -------------------------------------------------------------------------------------------
+// TUT
+// -------------------------------------------------------------------------------------------
+
+namespace tut
+{
+    struct zerocode_test
+    {
+    };
+
+    typedef test_group<zerocode_test> zerocode_t;
+    typedef zerocode_t::object zerocode_object_t;
+    tut::zerocode_t tut_zerocode("LLZeroCode");
+
+    template<> template<>
+    void zerocode_object_t::test<1>()
+    {
+        // Encoding matches the scalar loop, and expands back to the packet
+        for (U32 seed = 1; seed <= 2000; ++seed)
+        {
+            std::vector<U8> packet(seed % 1600);
+            fill_packet(packet, seed);
+            const S32 size = (S32)packet.size();
+
+            std::vector<U8> encoded(2 * size + 1);
+            std::vector<U8> expected(2 * size + 1);
+            const S32 encoded_size = LLZeroCode::encode(packet.data(), size, encoded.data());
+            const S32 expected_size = ref_encode(packet.data(), size, expected.data());
+            const std::string what = " seed " + std::to_string(seed);
+            ensure_equals("encoded size" + what, encoded_size, expected_size);
+            ensure("encoded bytes" + what, std::equal(encoded.begin(), encoded.begin() + encoded_size, expected.begin()));
+            ensure_equals("encodedSize()" + what, LLZeroCode::encodedSize(packet.data(), size), expected_size);
+
+            std::vector<U8> expanded(size + 1);
+            const S32 expanded_size = LLZeroCode::expand(encoded.data(), encoded_size, expanded.data(), size);
+            ensure_equals("round trip size" + what, expanded_size, size);
+            ensure("round trip bytes" + what, std::equal(packet.begin(), packet.end(), expanded.begin()));
+        }
+    }
+
+    template<> template<>
+    void zerocode_object_t::test<2>()
+    {
+        // Expanding anything, including the 0 0 [count] wrap form and a
+        // dangling zero at the end, matches the scalar loop
+        for (U32 seed = 1; seed <= 2000; ++seed)
+        {
+            std::vector<U8> encoded(seed % 400);
+            fill_packet(encoded, seed);
+            const S32 size = (S32)encoded.size();
+
+            const S32 capacity = 256 * size + 256;
+            std::vector<U8> expanded(capacity);
+            std::vector<U8> expected(capacity);
+            const S32 expanded_size = LLZeroCode::expand(encoded.data(), size, expanded.data(), capacity);
+            const S32 expected_size = ref_expand(encoded.data(), size, expected.data());
+            const std::string what = " seed " + std::to_string(seed);
+            ensure_equals("expanded size" + what, expanded_size, expected_size);
+            ensure("expanded bytes" + what, std::equal(expanded.begin(), expanded.begin() + expanded_size, expected.begin()));
+        }
+    }
+
+    template<> template<>
+    void zerocode_object_t::test<3>()
+    {
+        // Expanding never writes past the capacity
+        const U8 encoded[] = { 1, 2, 0, 200, 3, 0, 0, 10, 4 };
+        const S32 full = 2 + 200 + 1 + 266 + 1;
+        for (S32 capacity = 0; capacity <= full; ++capacity)
+        {
+            std::vector<U8> expanded(full + 16, 0xaa);
+            const S32 expanded_size = LLZeroCode::expand(encoded, sizeof(encoded), expanded.data(), capacity);
+            ensure_equals("expanded size with capacity " + std::to_string(capacity), expanded_size, capacity == full ? full : -1);
+            for (S32 i = capacity; i < full + 16; ++i)
+            {
+                ensure_equals("untouched past capacity " + std::to_string(capacity), expanded[i], 0xaa);
+            }
+        }
+    }
+}
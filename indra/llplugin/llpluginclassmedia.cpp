@@ -133,6 +133,7 @@ void LLPluginClassMedia::reset()
     mStatus = LLPluginClassMediaOwner::MEDIA_NONE;
     mSleepTime = 1.0f / 100.0f;
     mCanCut = false;
+    mFrameRateHint = 0.f; // <FS/> Media frame rate hint
     mCanCopy = false;
     mCanPaste = false;
     mMediaName.clear();
@@ -856,6 +857,20 @@ void LLPluginClassMedia::setPriority(EPriority priority)
     }
 }
 
+// <FS> Media frame rate hint
+void LLPluginClassMedia::setFrameRateHint(F32 fps)
+{
+    if (mFrameRateHint != fps)
+    {
+        mFrameRateHint = fps;
+
+        LLPluginMessage message(LLPLUGIN_MESSAGE_CLASS_MEDIA, "frame_rate_hint");
+        message.setValueReal("fps", fps);
+        sendMessage(message);
+    }
+}
+// </FS>
+
 void LLPluginClassMedia::setLowPrioritySizeLimit(int size)
 {
     int power = nextPowerOf2(size);
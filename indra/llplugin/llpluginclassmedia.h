@@ -189,6 +189,11 @@ public:
     static const char* priorityToString(EPriority priority);
     void setPriority(EPriority priority);
     void setLowPrioritySizeLimit(int size);
+    // <FS> Media frame rate hint
+    // How many frames per second the viewer will actually show, plugins
+    // that understand it can stop producing more. 0 is unlimited.
+    void setFrameRateHint(F32 fps);
+    // </FS>
 
     F64 getCPUUsage();
 
@@ -418,6 +423,7 @@ protected:
     LLPluginClassMediaOwner::EMediaStatus mStatus;
 
     F64             mSleepTime;
+    F32             mFrameRateHint; // <FS/> Media frame rate hint
 
     bool            mCanCut;
     bool            mCanCopy;
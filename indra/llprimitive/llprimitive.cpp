@@ -1385,9 +1385,11 @@ bool LLPrimitive::packTEMessage(LLDataPacker &dp) const
 S32 LLPrimitive::parseTEMessage(LLMessageSystem* mesgsys, char const* block_name, const S32 block_num, LLTEContents& tec)
 {
     S32 retval = 0;
+    // <FS> Parallel object update decoding
     // temp buffer for material ID processing
     // data will end up in tec.material_id[]
-    material_id_type material_data[LLTEContents::MAX_TES];
+    //material_id_type material_data[LLTEContents::MAX_TES];
+    // </FS>
 
     if (block_num < 0)
     {
@@ -1419,6 +1421,19 @@ S32 LLPrimitive::parseTEMessage(LLMessageSystem* mesgsys, char const* block_name
 
     tec.face_count = llmin((U32)getNumTEs(),(U32)LLTEContents::MAX_TES);
 
+    // <FS> Parallel object update decoding
+    return parseTEContents(tec);
+}
+
+// static
+S32 LLPrimitive::parseTEContents(LLTEContents& tec)
+{
+    S32 retval = 0;
+    // temp buffer for material ID processing
+    // data will end up in tec.material_id[]
+    material_id_type material_data[LLTEContents::MAX_TES];
+    // </FS>
+
     U8 *cur_ptr = tec.packed_buffer;
     LL_DEBUGS("TEXTUREENTRY") << "Texture Entry with buffere sized: " << tec.size << LL_ENDL;
     U8 *buffer_end = tec.packed_buffer + tec.size;
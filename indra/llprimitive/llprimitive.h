@@ -511,6 +511,11 @@ public:
     S32 unpackTEMessage(LLDataPacker &dp);
     S32 parseTEMessage(LLMessageSystem* mesgsys, char const* block_name, const S32 block_num, LLTEContents& tec);
     S32 applyParsedTEMessage(LLTEContents& tec);
+    // <FS> Parallel object update decoding
+    // Parses tec.packed_buffer, tec.size bytes including the terminating 0,
+    // for tec.face_count faces. Doesn't touch any primitive, safe on any thread.
+    static S32 parseTEContents(LLTEContents& tec);
+    // </FS>
 
 #ifdef CHECK_FOR_FINITE
     inline void setPosition(const LLVector3& pos);
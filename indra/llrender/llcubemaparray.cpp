@@ -37,6 +37,7 @@
 
 #include "llrender.h"
 #include "llglslshader.h"
+#include "llvramaccounting.h" // <FS/> VRAM accounting
 
 #include "llglheaders.h"
 
@@ -126,6 +127,7 @@ void LLCubeMapArray::allocate(U32 resolution, U32 components, U32 count, bool us
 
     bind(0);
     free_cur_tex_image();
+    LLVRAMAccounting::Scope vram_scope({ LLVRAMCategory::REFLECTION_PROBE }, true); // <FS/> VRAM accounting
 
     U32 format = components == 4 ? GL_RGBA16F : GL_RGB16F;
     U32 mip = 0;
@@ -66,6 +66,7 @@ LLFontRegistry* LLFontGL::sFontRegistry = NULL;
 
 LLCoordGL LLFontGL::sCurOrigin;
 F32 LLFontGL::sCurDepth;
+bool LLFontGL::sDepthInVertices = false; // <FS/> Batched name tags
 std::vector<std::pair<LLCoordGL, F32> > LLFontGL::sOriginStack;
 
 const F32 PAD_UVY = 0.5f; // half of vertical padding between glyphs in the glyph texture
@@ -185,7 +186,13 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
 
     // Depth translation, so that floating text appears 'in-world'
     // and is correctly occluded.
-    gGL.translatef(0.f,0.f,sCurDepth);
+    // <FS> Batched glyph pages, a translation flushes, consecutive UI strings share a batch without one
+    //gGL.translatef(0.f,0.f,sCurDepth);
+    if (sCurDepth != 0.f && !sDepthInVertices) // <FS/> Batched name tags
+    {
+        gGL.translatef(0.f, 0.f, sCurDepth);
+    }
+    // </FS>
 
     S32 chars_drawn = 0;
     S32 i;
@@ -271,9 +278,24 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
     const LLFontGlyphInfo* next_glyph = NULL;
 
     static constexpr S32 GLYPH_BATCH_SIZE = 30;
-    static thread_local LLVector4a vertices[GLYPH_BATCH_SIZE * 6];
-    static thread_local LLVector2 uvs[GLYPH_BATCH_SIZE * 6];
-    static thread_local LLColor4U colors[GLYPH_BATCH_SIZE * 6];
+    // <FS> Batched glyph pages
+    // The quads are gathered per bitmap page over the whole string and each
+    // page is drawn once at the end, instead of drawing whatever is queued
+    // every time the string moves on to a glyph of another page (emojis).
+    //static thread_local LLVector4a vertices[GLYPH_BATCH_SIZE * 6];
+    //static thread_local LLVector2 uvs[GLYPH_BATCH_SIZE * 6];
+    //static thread_local LLColor4U colors[GLYPH_BATCH_SIZE * 6];
+    struct GlyphPage
+    {
+        std::pair<EFontGlyphType, S32>  mEntry;
+        S32                             mCount; // quads
+        std::vector<LLVector4a>         mVertices;
+        std::vector<LLVector2>          mUVs;
+        std::vector<LLColor4U>          mColors;
+    };
+    static thread_local std::vector<GlyphPage> glyph_pages;
+    size_t page_count = 0;
+    // </FS>
 
     LLColor4U text_color(color);
     // Preserve the transparency to render fading emojis in fading text (e.g.
@@ -281,7 +303,10 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
     LLColor4U emoji_color(255, 255, 255, text_color.mV[VALPHA]);
 
     std::pair<EFontGlyphType, S32> bitmap_entry = std::make_pair(EFontGlyphType::Grayscale, -1);
-    S32 glyph_count = 0;
+    // <FS> Batched glyph pages
+    //S32 glyph_count = 0;
+    GlyphPage* page = nullptr;
+    // </FS>
     for (i = begin_offset; i < begin_offset + length; i++)
     {
         llwchar wch = wstr[i];
@@ -301,22 +326,45 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
         std::pair<EFontGlyphType, S32> next_bitmap_entry = fgi->mBitmapEntry;
         if (next_bitmap_entry != bitmap_entry)
         {
-            // Actually draw the queued glyphs before switching their texture;
-            // otherwise the queued glyphs will be taken from wrong textures.
-            if (glyph_count > 0)
+            // <FS> Batched glyph pages
+            //// Actually draw the queued glyphs before switching their texture;
+            //// otherwise the queued glyphs will be taken from wrong textures.
+            //if (glyph_count > 0)
+            //{
+            //    gGL.begin(LLRender::TRIANGLES);
+            //    {
+            //        gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 6);
+            //    }
+            //    gGL.end();
+            //    // </FS:Ansariel>
+            //    glyph_count = 0;
+            //}
+            //
+            //bitmap_entry = next_bitmap_entry;
+            //LLImageGL* font_image = font_bitmap_cache->getImageGL(bitmap_entry.first, bitmap_entry.second);
+            //gGL.getTexUnit(0)->bind(font_image);
+            bitmap_entry = next_bitmap_entry;
+            page = nullptr;
+            for (size_t p = 0; p < page_count; ++p)
             {
-                gGL.begin(LLRender::TRIANGLES);
+                if (glyph_pages[p].mEntry == bitmap_entry)
                 {
-                    gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 6);
+                    page = &glyph_pages[p];
+                    break;
                 }
-                gGL.end();
-                // </FS:Ansariel>
-                glyph_count = 0;
             }
 
-            bitmap_entry = next_bitmap_entry;
-            LLImageGL* font_image = font_bitmap_cache->getImageGL(bitmap_entry.first, bitmap_entry.second);
-            gGL.getTexUnit(0)->bind(font_image);
+            if (!page)
+            {
+                if (glyph_pages.size() <= page_count)
+                {
+                    glyph_pages.resize(page_count + 1);
+                }
+                page = &glyph_pages[page_count++];
+                page->mEntry = bitmap_entry;
+                page->mCount = 0;
+            }
+            // </FS>
         }
 
         if ((start_x + scaled_max_pixels) < (cur_x + fgi->mXBearing + fgi->mWidth))
@@ -337,22 +385,36 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
                     (F32)ll_round(cur_render_x + (F32)fgi->mXBearing) + (F32)fgi->mWidth,
                     (F32)ll_round(cur_render_y + (F32)fgi->mYBearing) - (F32)fgi->mHeight);
 
-        if (glyph_count >= GLYPH_BATCH_SIZE)
+        // <FS> Batched glyph pages
+        //if (glyph_count >= GLYPH_BATCH_SIZE)
+        //{
+        //    gGL.begin(LLRender::TRIANGLES);
+        //    {
+        //        gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 6);
+        //    }
+        //    gGL.end();
+        //
+        //    glyph_count = 0;
+        //}
+        // room for the most quads a glyph makes, see drawGlyph()
+        const size_t needed = (size_t)(page->mCount + 6) * 6;
+        if (page->mVertices.size() < needed)
         {
-            gGL.begin(LLRender::TRIANGLES);
-            {
-                gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 6);
-            }
-            gGL.end();
-
-            glyph_count = 0;
+            page->mVertices.resize(needed * 2);
+            page->mUVs.resize(needed * 2);
+            page->mColors.resize(needed * 2);
         }
+        // </FS>
 
         const LLColor4U& col =
             bitmap_entry.first == EFontGlyphType::Grayscale ? text_color
                                                             : emoji_color;
-        drawGlyph(glyph_count, vertices, uvs, colors, screen_rect, uv_rect,
+        // <FS> Batched glyph pages
+        //drawGlyph(glyph_count, vertices, uvs, colors, screen_rect, uv_rect,
+        //          col, style_to_add, shadow, drop_shadow_strength);
+        drawGlyph(page->mCount, page->mVertices.data(), page->mUVs.data(), page->mColors.data(), screen_rect, uv_rect,
                   col, style_to_add, shadow, drop_shadow_strength);
+        // </FS>
 
         chars_drawn++;
         cur_x += fgi->mXAdvance;
@@ -377,11 +439,47 @@ S32 LLFontGL::render(const LLWString &wstr, S32 begin_offset, F32 x, F32 y, cons
         cur_render_y = cur_y;
     }
 
-    gGL.begin(LLRender::TRIANGLES);
+    // <FS> Batched glyph pages
+    //gGL.begin(LLRender::TRIANGLES);
+    //{
+    //    gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 6);
+    //}
+    //gGL.end();
+    for (size_t p = 0; p < page_count; ++p)
     {
-        gGL.vertexBatchPreTransformed(vertices, uvs, colors, glyph_count * 6);
+        GlyphPage& glyph_page = glyph_pages[p];
+        if (glyph_page.mCount == 0)
+        {
+            continue;
+        }
+
+        // <FS> Batched name tags
+        if (sDepthInVertices && sCurDepth != 0.f)
+        {
+            for (S32 v = 0; v < glyph_page.mCount * 6; ++v)
+            {
+                glyph_page.mVertices[v].getF32ptr()[VZ] = sCurDepth;
+            }
+        }
+        // </FS>
+
+        LLImageGL* font_image = font_bitmap_cache->getImageGL(glyph_page.mEntry.first, glyph_page.mEntry.second);
+        gGL.getTexUnit(0)->bind(font_image);
+
+        // in pieces the immediate mode buffer always has room for
+        for (S32 first = 0; first < glyph_page.mCount; first += GLYPH_BATCH_SIZE)
+        {
+            const S32 count = llmin(glyph_page.mCount - first, GLYPH_BATCH_SIZE);
+            gGL.begin(LLRender::TRIANGLES);
+            {
+                gGL.vertexBatchPreTransformed(&glyph_page.mVertices[first * 6], &glyph_page.mUVs[first * 6],
+                                              &glyph_page.mColors[first * 6], count * 6);
+            }
+            gGL.end();
+        }
+        glyph_page.mCount = 0;
     }
-    gGL.end();
+    // </FS>
 
 
     if (right_x)
@@ -227,6 +227,12 @@ public:
 
     static LLCoordGL sCurOrigin;
     static F32          sCurDepth;
+    // <FS> Batched name tags
+    // Put sCurDepth into the glyph vertices instead of translating the
+    // modelview, so strings at different depths share a batch. Only for
+    // callers whose modelview is the identity.
+    static bool         sDepthInVertices;
+    // </FS>
     static std::vector<std::pair<LLCoordGL, F32> > sOriginStack;
 
     static LLColor4 sShadowColor;
@@ -218,7 +218,13 @@ void LLFontVertexBuffer::renderBuffers()
 
     // Depth translation, so that floating text appears 'in-world'
     // and is correctly occluded.
-    gGL.translatef(0.f, 0.f, LLFontGL::sCurDepth);
+    // <FS> Batched glyph pages
+    //gGL.translatef(0.f, 0.f, LLFontGL::sCurDepth);
+    if (LLFontGL::sCurDepth != 0.f)
+    {
+        gGL.translatef(0.f, 0.f, LLFontGL::sCurDepth);
+    }
+    // </FS>
     gGL.setSceneBlendType(LLRender::BT_ALPHA);
 
     // Note: ellipses should technically be covered by push/load/translate of their own
@@ -1501,6 +1501,13 @@ void LLGLManager::initExtensions()
     mHasCubeMapArray = mGLVersion >= 3.99f;
     mHasTransformFeedback = mGLVersion >= 3.99f;
     mHasDebugOutput = mGLVersion >= 4.29f;
+    // <FS> GPU texture downscaling
+#if LL_DARWIN
+    mHasCopyImage = false;
+#else
+    mHasCopyImage = mGLVersion >= 4.29f;
+#endif
+    // </FS>
 
     // Misc
     glGetIntegerv(GL_MAX_ELEMENTS_VERTICES, (GLint*) &mGLMaxVertexRange);
@@ -1512,6 +1519,29 @@ void LLGLManager::initExtensions()
 // <FS:Zi> Linux support
 //#if (LL_WINDOWS || LL_LINUX) && !LL_MESA_HEADLESS
     mHasATIMemInfo = ExtensionExists("GL_ATI_meminfo", gGLHExts.mSysExts); //Basic AMD method, also see mHasAMDAssociations
+    mHasTextureCompressionS3TC = ExtensionExists("GL_EXT_texture_compression_s3tc", gGLHExts.mSysExts);
+    // The sRGB BC1/BC3 formats come from EXT_texture_sRGB, or from the newer s3tc_srgb extension
+    mHasTextureCompressionS3TCSRGB = mHasTextureCompressionS3TC
+        && (ExtensionExists("GL_EXT_texture_sRGB", gGLHExts.mSysExts) || ExtensionExists("GL_EXT_texture_compression_s3tc_srgb", gGLHExts.mSysExts));
+
+    // <FS> Parallel shader compile, let the driver compile and link on as many threads as it likes
+#if !LL_DARWIN
+    bool has_khr_parallel_compile = ExtensionExists("GL_KHR_parallel_shader_compile", gGLHExts.mSysExts);
+    bool has_arb_parallel_compile = ExtensionExists("GL_ARB_parallel_shader_compile", gGLHExts.mSysExts);
+    if (has_khr_parallel_compile || has_arb_parallel_compile)
+    {
+        typedef void (APIENTRY* max_compiler_threads_proc_t)(GLuint count);
+        max_compiler_threads_proc_t max_compiler_threads = (max_compiler_threads_proc_t)GLH_EXT_GET_PROC_ADDRESS(
+            has_khr_parallel_compile ? "glMaxShaderCompilerThreadsKHR" : "glMaxShaderCompilerThreadsARB");
+        if (max_compiler_threads)
+        {
+            // 0xFFFFFFFF asks for the implementation's own maximum
+            max_compiler_threads(0xFFFFFFFF);
+            mHasParallelShaderCompile = true;
+        }
+    }
+#endif
+    // </FS>
 
     LL_DEBUGS("RenderInit") << "GL Probe: Getting symbols" << LL_ENDL;
 
@@ -95,8 +95,12 @@ public:
     // GL 4.x capabilities
     bool mHasCubeMapArray = false;
     bool mHasDebugOutput = false;
+    bool mHasCopyImage = false; // <FS/> GPU texture downscaling
     bool mHasTransformFeedback = false;
     bool mHasAnisotropic = false;
+    bool mHasTextureCompressionS3TC = false;
+    bool mHasTextureCompressionS3TCSRGB = false;
+    bool mHasParallelShaderCompile = false; // <FS/> KHR or ARB_parallel_shader_compile
 
     // Vendor-specific extensions
     bool mHasAMDAssociations = false;
@@ -64,6 +64,15 @@ U32 LLGLSLShader::sTotalTrianglesDrawn = 0;
 U64 LLGLSLShader::sTotalSamplesDrawn = 0;
 U32 LLGLSLShader::sTotalBinds = 0;
 boost::json::value LLGLSLShader::sDefaultStats;
+// <FS> Parallel shader compile
+bool LLGLSLShader::sDeferLink = false;
+bool LLGLSLShader::sDeferredLinkFailed = false;
+std::vector<LLGLSLShader*> LLGLSLShader::sPendingLink;
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+// </FS>
 
 //UI shader -- declared here so llui_libtest will link properly
 LLGLSLShader    gUIProgram;
@@ -356,6 +365,14 @@ void LLGLSLShader::unloadInternal()
 {
     sInstances.erase(this);
 
+    // <FS> Parallel shader compile
+    if (mLinkPending)
+    {
+        sPendingLink.erase(std::remove(sPendingLink.begin(), sPendingLink.end(), this), sPendingLink.end());
+        mLinkPending = false;
+    }
+    // </FS>
+
     stop_glerror();
     mAttribute.clear();
     mTexture.clear();
@@ -470,6 +487,28 @@ bool LLGLSLShader::createShader()
         unloadInternal();
         return false;
     }
+
+    // <FS> Parallel shader compile, submit the link and check it in finishDeferredLink()
+    if (success && sDeferLink && !mUsingBinaryProgram)
+    {
+        bindReservedAttribs();
+        {
+            LL_PROFILE_ZONE_NAMED_CATEGORY_SHADER("glLinkProgram");
+            glLinkProgram(mProgramObject);
+        }
+        mLinkPending = true;
+        sPendingLink.push_back(this);
+        return true;
+    }
+
+    return finishCreate(success);
+}
+
+bool LLGLSLShader::finishCreate(bool success)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_SHADER;
+    // </FS>
+
     // Map attributes and uniforms
     if (success)
     {
@@ -488,7 +527,14 @@ bool LLGLSLShader::createShader()
         {
             LL_SHADER_LOADING_WARNS() << "Failed to link using shader level " << mShaderLevel << " trying again using shader level " << (mShaderLevel - 1) << LL_ENDL;
             mShaderLevel--;
-            return createShader();
+            // <FS> Parallel shader compile, retry without deferring so the caller gets the final result
+            //return createShader();
+            bool defer_link = sDeferLink;
+            sDeferLink = false;
+            success = createShader();
+            sDeferLink = defer_link;
+            return success;
+            // </FS>
         }
         else
         {
@@ -651,12 +697,12 @@ bool LLGLSLShader::mapAttributes()
     bool res = true;
     if (!mUsingBinaryProgram)
     {
-        //before linking, make sure reserved attributes always have consistent locations
-        for (U32 i = 0; i < LLShaderMgr::instance()->mReservedAttribs.size(); i++)
+        // <FS> Parallel shader compile, a deferred link already has them bound
+        if (!mLinkPending)
         {
-            const char* name = LLShaderMgr::instance()->mReservedAttribs[i].c_str();
-            glBindAttribLocation(mProgramObject, i, (const GLchar*)name);
+            bindReservedAttribs();
         }
+        // </FS>
 
         //link the program
         res = link();
@@ -697,6 +743,30 @@ bool LLGLSLShader::mapAttributes()
     return false;
 }
 
+// <FS> Parallel shader compile
+void LLGLSLShader::bindReservedAttribs()
+{
+    //before linking, make sure reserved attributes always have consistent locations
+    for (U32 i = 0; i < LLShaderMgr::instance()->mReservedAttribs.size(); i++)
+    {
+        const char* name = LLShaderMgr::instance()->mReservedAttribs[i].c_str();
+        glBindAttribLocation(mProgramObject, i, (const GLchar*)name);
+    }
+
+    // <FS> Pre-skinned shadows
+    if (!mFeedbackVaryings.empty())
+    {
+        std::vector<const GLchar*> names;
+        for (const std::string& varying : mFeedbackVaryings)
+        {
+            names.push_back(varying.c_str());
+        }
+        glTransformFeedbackVaryings(mProgramObject, (GLsizei)names.size(), names.data(), GL_INTERLEAVED_ATTRIBS);
+    }
+    // </FS>
+}
+// </FS>
+
 void LLGLSLShader::mapUniform(GLint index)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_SHADER;
@@ -855,6 +925,7 @@ bool LLGLSLShader::mapUniforms()
     mUniformMap.clear();
     mTexture.clear();
     mValue.clear();
+    mUniformsDirty = true; // <FS/> Cached environment uniforms, a new program has none of them yet
     //initialize arrays
     mUniform.resize(LLShaderMgr::instance()->mReservedUniforms.size(), -1);
     mTexture.resize(LLShaderMgr::instance()->mReservedUniforms.size(), -1);
@@ -1003,6 +1074,7 @@ bool LLGLSLShader::mapUniforms()
         "GLTFJoints",       // UB_GLTF_JOINTS
         "GLTFNodes",        // UB_GLTF_NODES
         "GLTFMaterials",    // UB_GLTF_MATERIALS
+        "MeshInstances",    // UB_MESH_INSTANCES <FS/> Mesh instancing
     };
 
     llassert(LL_ARRAY_SIZE(ubo_names) == NUM_UNIFORM_BLOCKS);
@@ -1027,7 +1099,19 @@ bool LLGLSLShader::link(bool suppress_errors)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_SHADER;
 
-    bool success = LLShaderMgr::instance()->linkProgramObject(mProgramObject, suppress_errors);
+    // <FS> Parallel shader compile, a deferred link was submitted by createShader()
+    //bool success = LLShaderMgr::instance()->linkProgramObject(mProgramObject, suppress_errors);
+    bool success;
+    if (mLinkPending)
+    {
+        mLinkPending = false;
+        success = LLShaderMgr::instance()->checkLinkStatus(mProgramObject, suppress_errors);
+    }
+    else
+    {
+        success = LLShaderMgr::instance()->linkProgramObject(mProgramObject, suppress_errors);
+    }
+    // </FS>
 
     if (!success && !suppress_errors)
     {
@@ -1046,6 +1130,13 @@ void LLGLSLShader::bind()
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_SHADER;
 
+    // <FS> Parallel shader compile
+    if (mLinkPending && !finishDeferred())
+    {
+        return;
+    }
+    // </FS>
+
     llassert_always(mProgramObject != 0);
 
     gGL.flush();
@@ -1074,6 +1165,59 @@ void LLGLSLShader::bind()
     llassert_always(sCurBoundShader == mProgramObject);
 }
 
+// <FS> Parallel shader compile
+// static
+void LLGLSLShader::beginDeferredLink()
+{
+    sDeferLink = true;
+    sDeferredLinkFailed = false;
+}
+
+// static
+bool LLGLSLShader::finishDeferredLink()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_SHADER;
+
+    sDeferLink = false;
+
+    while (!sPendingLink.empty())
+    {
+        // Take any program the driver is done with, else wait on the oldest
+        LLGLSLShader* shader = sPendingLink.front();
+        if (gGLManager.mHasParallelShaderCompile)
+        {
+            for (LLGLSLShader* pending : sPendingLink)
+            {
+                GLint complete = GL_FALSE;
+                glGetProgramiv(pending->mProgramObject, GL_COMPLETION_STATUS_KHR, &complete);
+                if (complete == GL_TRUE)
+                {
+                    shader = pending;
+                    break;
+                }
+            }
+        }
+        shader->finishDeferred();
+    }
+
+    bool success = !sDeferredLinkFailed;
+    sDeferredLinkFailed = false;
+    return success;
+}
+
+bool LLGLSLShader::finishDeferred()
+{
+    sPendingLink.erase(std::find(sPendingLink.begin(), sPendingLink.end(), this));
+
+    if (!finishCreate(true))
+    {
+        sDeferredLinkFailed = true;
+        return false;
+    }
+    return true;
+}
+// </FS>
+
 void LLGLSLShader::bind(U8 variant)
 {
     llassert(mGLTFVariants.size() == LLGLSLShader::NUM_GLTF_VARIANTS);
@@ -2058,6 +2202,7 @@ LLUUID LLGLSLShader::hash()
     hash_obj.update(gGLManager.mGLVendor);
     hash_obj.update(gGLManager.mGLRenderer);
     hash_obj.update(gGLManager.mGLVersionString);
+    hash_obj.update(LLShaderMgr::instance()->mShaderSourceHash.mData, UUID_BYTES); // <FS/> Shader cache source hash
     return hash_obj.digest();
 }
 
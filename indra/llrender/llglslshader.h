@@ -73,6 +73,9 @@ public:
     {
         S32 mUniform{ 0 };
         T mValue{};
+
+        // <FS/> Cached environment uniforms
+        bool operator==(const UniformSetting& rhs) const { return mUniform == rhs.mUniform && mValue == rhs.mValue; }
     };
 
     typedef UniformSetting<S32> IntSetting;
@@ -120,6 +123,13 @@ public:
 
     void apply(LLGLSLShader* shader);
 
+    // <FS> Cached environment uniforms
+    bool operator==(const LLShaderUniforms& rhs) const
+    {
+        return mIntegers == rhs.mIntegers && mFloats == rhs.mFloats && mVectors == rhs.mVectors && mVector3s == rhs.mVector3s;
+    }
+    bool operator!=(const LLShaderUniforms& rhs) const { return !(*this == rhs); }
+    // </FS>
 
     std::vector<IntSetting> mIntegers;
     std::vector<FloatSetting> mFloats;
@@ -153,6 +163,7 @@ public:
         UB_GLTF_JOINTS,         // "GLTFJoints"
         UB_GLTF_NODES,          // "GLTFNodes"
         UB_GLTF_MATERIALS,      // "GLTFMaterials"
+        UB_MESH_INSTANCES,      // "MeshInstances" <FS/> Mesh instancing
         NUM_UNIFORM_BLOCKS
     };
 
@@ -176,6 +187,17 @@ public:
     static void startProfile();
     static void stopProfile();
 
+    // <FS> Parallel shader compile
+    // While deferring, createShader() only submits the compiles and the link
+    // and returns true, leaving the driver to work on every program of a load
+    // group at once. finishDeferredLink() then checks the programs in the
+    // order they complete and returns false if any of them failed. A pending
+    // program that gets bound is finished first.
+    static void beginDeferredLink();
+    static bool finishDeferredLink();
+    static bool sDeferLink;
+    // </FS>
+
     void unload();
     void clearStats();
     void dumpStats(boost::json::object& stats);
@@ -318,6 +340,8 @@ public:
     static defines_map_t sGlobalDefines;
     LLUUID mShaderHash;
     bool mUsingBinaryProgram = false;
+    bool mLinkPending = false; // <FS/> Parallel shader compile
+    std::vector<std::string> mFeedbackVaryings; // <FS/> Pre-skinned shadows, captured with transform feedback
 
     //statistics for profiling shader performance
     bool mProfilePending = false;
@@ -366,6 +390,13 @@ public:
 
 private:
     void unloadInternal();
+    // <FS> Parallel shader compile
+    void bindReservedAttribs();
+    bool finishCreate(bool success);
+    bool finishDeferred();
+    static std::vector<LLGLSLShader*> sPendingLink;
+    static bool sDeferredLinkFailed;
+    // </FS>
     // This must be static because finishProfile() is called at least once
     // within a __try block. If we default its stats parameter to a temporary
     // json::value, that temporary must be destroyed when the stack is
@@ -41,6 +41,7 @@
 #include "llrender.h"
 #include "llwindow.h"
 #include "llframetimer.h"
+#include "llvramaccounting.h" // <FS/> VRAM accounting
 #include <unordered_set>
 
 extern LL_COMMON_API bool on_main_thread();
@@ -63,7 +64,15 @@ U32 LLImageGL::sFrameCount = 0;
 
 // texture memory accounting (for macOS)
 static LLMutex sTexMemMutex;
-static std::unordered_map<U32, U64> sTextureAllocs;
+// <FS> VRAM accounting: remember the tag each texture was claimed under
+//static std::unordered_map<U32, U64> sTextureAllocs;
+struct TextureAlloc
+{
+    U64         mSize;
+    LLVRAMTag   mTag;
+};
+static std::unordered_map<U32, TextureAlloc> sTextureAllocs;
+// </FS>
 static U64 sTextureBytes = 0;
 
 // track a texture alloc on the currently bound texture.
@@ -83,7 +92,12 @@ void LLImageGLMemory::alloc_tex_image(U32 width, U32 height, U32 intformat, U32
     // it is a precondition that no existing allocation exists for this texture
     llassert(sTextureAllocs.find(texName) == sTextureAllocs.end());
 
-    sTextureAllocs[texName] = size;
+    // <FS> VRAM accounting
+    //sTextureAllocs[texName] = size;
+    const LLVRAMTag& tag = LLVRAMAccounting::getCurrentTag();
+    sTextureAllocs[texName] = { size, tag };
+    LLVRAMAccounting::claim(tag, (S64)size);
+    // </FS>
     sTextureBytes += size;
 
     sTexMemMutex.unlock();
@@ -96,9 +110,15 @@ void LLImageGLMemory::free_tex_image(U32 texName)
     auto iter = sTextureAllocs.find(texName);
     if (iter != sTextureAllocs.end()) // sometimes a texName will be "freed" before allocated (e.g. first call to setManualImage for a given texName)
     {
-        llassert(iter->second <= sTextureBytes); // sTextureBytes MUST NOT go below zero
+        // <FS> VRAM accounting
+        //llassert(iter->second <= sTextureBytes); // sTextureBytes MUST NOT go below zero
+        //
+        //sTextureBytes -= iter->second;
+        llassert(iter->second.mSize <= sTextureBytes); // sTextureBytes MUST NOT go below zero
 
-        sTextureBytes -= iter->second;
+        sTextureBytes -= iter->second.mSize;
+        LLVRAMAccounting::disclaim(iter->second.mTag, (S64)iter->second.mSize);
+        // </FS>
 
         sTextureAllocs.erase(iter);
     }
@@ -106,6 +126,21 @@ void LLImageGLMemory::free_tex_image(U32 texName)
     sTexMemMutex.unlock();
 }
 
+// <FS> VRAM accounting
+// move the allocation of texName to another tag
+void LLImageGLMemory::tag_tex_image(U32 texName, const LLVRAMTag& tag)
+{
+    LLMutexLock lock(&sTexMemMutex);
+    auto iter = sTextureAllocs.find(texName);
+    if (iter != sTextureAllocs.end())
+    {
+        LLVRAMAccounting::disclaim(iter->second.mTag, (S64)iter->second.mSize);
+        iter->second.mTag = tag;
+        LLVRAMAccounting::claim(tag, (S64)iter->second.mSize);
+    }
+}
+// </FS>
+
 // track texture free on given texNames
 void LLImageGLMemory::free_tex_images(U32 count, const U32* texNames)
 {
@@ -161,6 +196,7 @@ S32 LLImageGL::sMaxCategories = 1 ;
 bool LLImageGL::sSkipAnalyzeAlpha;
 U32  LLImageGL::sScratchPBO = 0;
 U32  LLImageGL::sScratchPBOSize = 0;
+bool LLImageGL::sUseUploadRing = true; // <FS/> Media upload ring
 U32* LLImageGL::sManualScratch = nullptr;
 
 
@@ -292,6 +328,8 @@ void LLImageGL::cleanupClass()
         sScratchPBOSize = 0;
     }
 
+    cleanupUploadRing(); // <FS/> Media upload ring
+
     delete[] sManualScratch;
 }
 
@@ -310,6 +348,8 @@ S32 LLImageGL::dataFormatBits(S32 dataformat)
     case GL_COMPRESSED_LUMINANCE:                   return 8;
     case GL_COMPRESSED_LUMINANCE_ALPHA:             return 16;
     case GL_COMPRESSED_ALPHA:                       return 8;
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:           return 4;
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:          return 4;
     case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:          return 4;
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:    return 4;
     case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:          return 8;
@@ -351,11 +391,66 @@ S32 LLImageGL::dataFormatBits(S32 dataformat)
     }
 }
 
+//static
+S32 LLImageGL::getCompressedFormat(S32 intformat)
+{
+    // Ask for BC1/BC3 explicitly when we can: the generic formats leave the
+    // choice to the driver, which may not compress at all, and their actual
+    // size can't be accounted for.
+    const bool s3tc = gGLManager.mHasTextureCompressionS3TC;
+    const bool s3tc_srgb = gGLManager.mHasTextureCompressionS3TCSRGB;
+    switch (intformat)
+    {
+    case GL_RED:
+    case GL_R8:
+        intformat = GL_COMPRESSED_RED;
+        break;
+    case GL_RG:
+    case GL_RG8:
+        intformat = GL_COMPRESSED_RG;
+        break;
+    case GL_RGB:
+    case GL_RGB8:
+        intformat = s3tc ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB;
+        break;
+    case GL_SRGB:
+    case GL_SRGB8:
+        intformat = s3tc_srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_SRGB;
+        break;
+    case GL_RGBA:
+    case GL_RGBA8:
+        intformat = s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA;
+        break;
+    case GL_SRGB_ALPHA:
+    case GL_SRGB8_ALPHA8:
+        intformat = s3tc_srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_SRGB_ALPHA;
+        break;
+    case GL_LUMINANCE:
+    case GL_LUMINANCE8:
+        intformat = GL_COMPRESSED_LUMINANCE;
+        break;
+    case GL_LUMINANCE_ALPHA:
+    case GL_LUMINANCE8_ALPHA8:
+        intformat = GL_COMPRESSED_LUMINANCE_ALPHA;
+        break;
+    case GL_ALPHA:
+    case GL_ALPHA8:
+        intformat = GL_COMPRESSED_ALPHA;
+        break;
+    default:
+        LL_WARNS() << "Could not compress format: " << std::hex << intformat << std::dec << LL_ENDL;
+        break;
+    }
+    return intformat;
+}
+
 //static
 S64 LLImageGL::dataFormatBytes(S32 dataformat, S32 width, S32 height)
 {
     switch (dataformat)
     {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
     case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
     case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
@@ -378,6 +473,8 @@ S32 LLImageGL::dataFormatComponents(S32 dataformat)
 {
     switch (dataformat)
     {
+      case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:     return 3;
+      case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:    return 3;
       case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:    return 3;
       case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT: return 3;
       case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:    return 4;
@@ -726,6 +823,20 @@ void LLImageGL::setExplicitFormat( LLGLint internal_format, LLGLenum primary_for
     calcAlphaChannelOffsetAndStride() ;
 }
 
+// <FS> VRAM accounting
+void LLImageGL::setCategory(S32 category)
+{
+    if (mCategory != category)
+    {
+        mCategory = category;
+        if (mTexName)
+        {
+            tag_tex_image(mTexName, LLVRAMAccounting::textureTag(category));
+        }
+    }
+}
+// </FS>
+
 //----------------------------------------------------------------------------
 
 void LLImageGL::setImage(const LLImageRaw* imageraw)
@@ -741,6 +852,7 @@ void LLImageGL::setImage(const LLImageRaw* imageraw)
 bool LLImageGL::setImage(const U8* data_in, bool data_hasmips /* = false */, S32 usename /* = 0 */)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    LLVRAMAccounting::Scope vram_scope(LLVRAMAccounting::textureTag(mCategory)); // <FS/> VRAM accounting
 
     const bool is_compressed = isCompressed();
 
@@ -1225,6 +1337,150 @@ bool LLImageGL::setSubImage(const LLImageRaw* imageraw, S32 x_pos, S32 y_pos, S3
     return setSubImage(imageraw->getData(), imageraw->getWidth(), imageraw->getHeight(), x_pos, y_pos, width, height, force_fast_update, use_name);
 }
 
+// <FS> Media upload ring
+// A pixel unpack buffer created with glBufferStorage and mapped
+// persistently and coherently, like the vertex streaming ring. Dirty rects
+// are written into it and uploaded from there, so glTexSubImage2D doesn't
+// have to take its own copy of client memory before returning. Each thread
+// that uploads has its own ring, the fences that guard the segments only
+// cover the commands of the context they were placed in.
+class LLUploadRing
+{
+public:
+    static constexpr U32 SEGMENT_COUNT = 3;
+    static constexpr U32 SEGMENT_SIZE = 8 * 1024 * 1024;  // A whole 1920x1080 RGBA frame
+
+    LLUploadRing()
+    {
+        glGenBuffers(1, &mGLBuffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mGLBuffer);
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, SEGMENT_COUNT * SEGMENT_SIZE, nullptr, flags);
+        mData = (U8*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, SEGMENT_COUNT * SEGMENT_SIZE, flags);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        stop_glerror();
+    }
+
+    ~LLUploadRing()
+    {
+        if (mGLBuffer)
+        {
+            if (mData)
+            {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mGLBuffer);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            }
+            glDeleteBuffers(1, &mGLBuffer);
+        }
+    }
+
+    bool isValid() const    { return mData != nullptr; }
+    U32 getGLBuffer() const { return mGLBuffer; }
+
+    U8* allocate(U32 size, U32& offset)
+    {
+        if (size > SEGMENT_SIZE)
+        {
+            return nullptr;
+        }
+
+        if (mHead + size > (mSegment + 1) * SEGMENT_SIZE)
+        {
+            mFences[mSegment].placeFence();
+            mSegment = (mSegment + 1) % SEGMENT_COUNT;
+            mFences[mSegment].wait();
+            mHead = mSegment * SEGMENT_SIZE;
+        }
+
+        offset = mHead;
+        mHead += (size + 255) & ~255;
+        return mData + offset;
+    }
+
+private:
+    U32             mGLBuffer = 0;
+    U8*             mData = nullptr;
+    U32             mSegment = 0;
+    U32             mHead = 0;
+    LLGLSyncFence   mFences[SEGMENT_COUNT];
+};
+
+static thread_local LLUploadRing* tUploadRing = nullptr;
+static thread_local bool tUploadRingFailed = false;
+
+bool LLImageGL::setSubImageStreamed(const U8* datap, S32 data_width, S32 data_height, S32 x_pos, S32 y_pos, S32 width, S32 height, LLGLuint use_name)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+
+    LLGLuint tex_name = use_name != 0 ? use_name : mTexName;
+    if (!sUseUploadRing || tUploadRingFailed || gGLManager.mIsApple || gGLManager.mGLVersion < 4.39f || !glBufferStorage ||
+        !tex_name || !datap || mUseMipMaps || isCompressed() || mFormatSwapBytes || mCurrentDiscardLevel != 0 ||
+        width <= 0 || height <= 0 || x_pos < 0 || y_pos < 0 ||
+        x_pos + width > getWidth() || y_pos + height > getHeight() ||
+        x_pos + width > data_width || y_pos + height > data_height)
+    {
+        return false;
+    }
+
+    if (!tUploadRing)
+    {
+        tUploadRing = new LLUploadRing();
+        if (!tUploadRing->isValid())
+        {
+            LL_WARNS() << "Persistent mapping failed, media upload ring disabled on this thread" << LL_ENDL;
+            delete tUploadRing;
+            tUploadRing = nullptr;
+            tUploadRingFailed = true;
+            return false;
+        }
+    }
+
+    const U32 components = getComponents();
+    const U32 row_bytes = width * components;
+    U32 offset = 0;
+    U8* dst = tUploadRing->allocate(row_bytes * height, offset);
+    if (!dst)
+    {
+        return false;
+    }
+
+    const U8* src = datap + (y_pos * data_width + x_pos) * components;
+    if (x_pos == 0 && width == data_width)
+    {
+        memcpy(dst, src, (size_t)row_bytes * height);
+    }
+    else
+    {
+        for (S32 row = 0; row < height; ++row)
+        {
+            memcpy(dst + (size_t)row * row_bytes, src + (size_t)row * data_width * components, row_bytes);
+        }
+    }
+
+    bool res = gGL.getTexUnit(0)->bindManual(mBindTarget, tex_name);
+    if (!res) LL_ERRS() << "LLImageGL::setSubImageStreamed(): bindTexture failed" << LL_ENDL;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, tUploadRing->getGLBuffer());
+    glTexSubImage2D(mTarget, 0, x_pos, y_pos, width, height, mFormatPrimary, mFormatType, (const void*)(uintptr_t)offset);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    gGL.getTexUnit(0)->disable();
+    stop_glerror();
+
+    mGLTextureCreated = true;
+    return true;
+}
+
+//static
+void LLImageGL::cleanupUploadRing()
+{
+    delete tUploadRing;
+    tUploadRing = nullptr;
+    tUploadRingFailed = false;
+}
+// </FS>
+
 // Copy sub image from frame buffer
 bool LLImageGL::setSubImageFromFrameBuffer(S32 fb_x, S32 fb_y, S32 x_pos, S32 y_pos, S32 width, S32 height)
 {
@@ -1405,48 +1661,7 @@ void LLImageGL::setManualImage(U32 target, S32 miplevel, S32 intformat, S32 widt
     const bool compress = LLImageGL::sCompressTextures && allow_compression;
     if (compress)
     {
-        switch (intformat)
-        {
-        case GL_RED:
-        case GL_R8:
-            intformat = GL_COMPRESSED_RED;
-            break;
-        case GL_RG:
-        case GL_RG8:
-            intformat = GL_COMPRESSED_RG;
-            break;
-        case GL_RGB:
-        case GL_RGB8:
-            intformat = GL_COMPRESSED_RGB;
-            break;
-        case GL_SRGB:
-        case GL_SRGB8:
-            intformat = GL_COMPRESSED_SRGB;
-            break;
-        case GL_RGBA:
-        case GL_RGBA8:
-            intformat = GL_COMPRESSED_RGBA;
-            break;
-        case GL_SRGB_ALPHA:
-        case GL_SRGB8_ALPHA8:
-            intformat = GL_COMPRESSED_SRGB_ALPHA;
-            break;
-        case GL_LUMINANCE:
-        case GL_LUMINANCE8:
-            intformat = GL_COMPRESSED_LUMINANCE;
-            break;
-        case GL_LUMINANCE_ALPHA:
-        case GL_LUMINANCE8_ALPHA8:
-            intformat = GL_COMPRESSED_LUMINANCE_ALPHA;
-            break;
-        case GL_ALPHA:
-        case GL_ALPHA8:
-            intformat = GL_COMPRESSED_ALPHA;
-            break;
-        default:
-            LL_WARNS() << "Could not compress format: " << std::hex << intformat << std::dec << LL_ENDL;
-            break;
-        }
+        intformat = getCompressedFormat(intformat);
     }
 
     stop_glerror();
@@ -1734,6 +1949,12 @@ void LLImageGL::syncToMainThread(LLGLuint new_tex_name)
     LL_PROFILE_ZONE_SCOPED;
     llassert(!on_main_thread());
 
+    // <FS> Batched dispatch: the sync wait and the name swap reach the main
+    // thread together
+    std::vector<LL::WorkQueue::Work> main_work;
+    main_work.reserve(2);
+    // </FS>
+
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("cglt - sync");
         if (gGLManager.mIsNVIDIA)
@@ -1753,8 +1974,11 @@ void LLImageGL::syncToMainThread(LLGLuint new_tex_name)
             glFlush();
             auto sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
             glFlush();
-            LL::WorkQueue::postMaybe(
-                mMainQueue,
+            // <FS> Batched dispatch
+            //LL::WorkQueue::postMaybe(
+            //    mMainQueue,
+            main_work.emplace_back(
+            // </FS>
                 [=]()
                 {
                     LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("cglt - wait sync");
@@ -1771,14 +1995,18 @@ void LLImageGL::syncToMainThread(LLGLuint new_tex_name)
     }
 
     ref();
-    LL::WorkQueue::postMaybe(
-        mMainQueue,
+    // <FS> Batched dispatch
+    //LL::WorkQueue::postMaybe(
+    //    mMainQueue,
+    main_work.emplace_back(
+    // </FS>
         [=]()
         {
             LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("cglt - delete callback");
             syncTexName(new_tex_name);
             unref();
         });
+    LL::WorkQueue::postBatchMaybe(mMainQueue, main_work); // <FS/> Batched dispatch
 
     LL_PROFILER_GPU_COLLECT;
 }
@@ -2299,6 +2527,8 @@ bool LLImageGL::isCompressed()
     bool is_compressed = false;
     switch (mFormatPrimary)
     {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
     case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
     case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
@@ -2436,6 +2666,7 @@ void LLImageGL::resetCurTexSizebar()
 bool LLImageGL::scaleDown(S32 desired_discard)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    LLVRAMAccounting::Scope vram_scope(LLVRAMAccounting::textureTag(mCategory)); // <FS/> VRAM accounting
 
     if (mTarget != GL_TEXTURE_2D
         || mFormatInternal == -1 // not initialized
@@ -2456,7 +2687,15 @@ bool LLImageGL::scaleDown(S32 desired_discard)
     S32 desired_width = getWidth(desired_discard);
     S32 desired_height = getHeight(desired_discard);
 
-    if (gGLManager.mDownScaleMethod == 0)
+    // <FS> GPU texture downscaling
+    //if (gGLManager.mDownScaleMethod == 0)
+    if (gGLManager.mDownScaleMethod == 2 && scaleDownFromMips(desired_discard))
+    {
+        return true;
+    }
+
+    if (gGLManager.mDownScaleMethod != 1)
+    // </FS>
     { // use an FBO to downscale the texture
         glViewport(0, 0, desired_width, desired_height);
 
@@ -2532,6 +2771,120 @@ bool LLImageGL::scaleDown(S32 desired_discard)
     return true;
 }
 
+// <FS> GPU texture downscaling
+// The mip chain already holds the smaller version. Copy its levels into a
+// new texture and let the old one go, without drawing, reading back or
+// generating mipmaps again.
+bool LLImageGL::scaleDownFromMips(S32 desired_discard)
+{
+#if LL_DARWIN
+    return false;
+#else
+    if (!gGLManager.mHasCopyImage || !mHasMipMaps || mTexName == 0)
+    {
+        return false;
+    }
+
+    const S32 mip = desired_discard - mCurrentDiscardLevel;
+    const S32 levels = mMaxDiscardLevel - desired_discard + 1;
+
+    // setManualImage() may have picked another format, or swizzled a
+    // deprecated one, take both from the texture itself
+    GLint internal_format = 0;
+    GLint compressed = 0;
+    GLint swizzle[4] = { GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA };
+    if (!gGL.getTexUnit(0)->bind(this, false, true))
+    {
+        return false;
+    }
+    glGetTexLevelParameteriv(mTarget, mip, GL_TEXTURE_INTERNAL_FORMAT, &internal_format);
+    glGetTexLevelParameteriv(mTarget, mip, GL_TEXTURE_COMPRESSED, &compressed);
+    glGetTexParameteriv(mTarget, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+
+    // Every level that gets copied has to be there, with the size the new
+    // texture expects; compressed levels also need their byte size
+    std::vector<GLint> image_sizes(levels, 0);
+    bool levels_ok = internal_format != 0;
+    for (S32 level = 0; levels_ok && level < levels; ++level)
+    {
+        GLint width = 0;
+        GLint height = 0;
+        GLint level_format = 0;
+        glGetTexLevelParameteriv(mTarget, mip + level, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(mTarget, mip + level, GL_TEXTURE_HEIGHT, &height);
+        glGetTexLevelParameteriv(mTarget, mip + level, GL_TEXTURE_INTERNAL_FORMAT, &level_format);
+        if (compressed)
+        {
+            glGetTexLevelParameteriv(mTarget, mip + level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &image_sizes[level]);
+        }
+        levels_ok = width == getWidth(desired_discard + level) && height == getHeight(desired_discard + level) &&
+                    level_format == internal_format && (!compressed || image_sizes[level] > 0);
+    }
+    if (!levels_ok)
+    {
+        gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+        return false;
+    }
+
+    GLenum error;
+    while ((error = glGetError()) != GL_NO_ERROR)
+    {
+        LL_WARNS() << "GL Error happens before downscaling texture. Error code: " << error << LL_ENDL;
+    }
+
+    LLGLuint new_texname = 0;
+    LLImageGL::generateTextures(1, &new_texname);
+    gGL.getTexUnit(0)->bind(this, false, true, new_texname);
+    glTexParameteri(mTarget, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(mTarget, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glTexParameteriv(mTarget, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    for (S32 level = 0; level < levels; ++level)
+    {
+        if (compressed)
+        {
+            // no client format for compressed storage, only its size
+            glCompressedTexImage2D(mTarget, level, internal_format, getWidth(desired_discard + level), getHeight(desired_discard + level), 0,
+                                   image_sizes[level], nullptr);
+        }
+        else
+        {
+            glTexImage2D(mTarget, level, internal_format, getWidth(desired_discard + level), getHeight(desired_discard + level), 0,
+                         mFormatPrimary, mFormatType, nullptr);
+        }
+    }
+    alloc_tex_image(getWidth(desired_discard), getHeight(desired_discard), mFormatInternal, 1);
+
+    for (S32 level = 0; level < levels; ++level)
+    {
+        glCopyImageSubData(mTexName, mTarget, mip + level, 0, 0, 0,
+                           new_texname, mTarget, level, 0, 0, 0,
+                           getWidth(desired_discard + level), getHeight(desired_discard + level), 1);
+    }
+    gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+
+    // Keep the old texture if any of the levels failed to allocate or copy
+    if ((error = glGetError()) != GL_NO_ERROR)
+    {
+        LL_WARNS() << "GL Error happens while downscaling texture. Error code: " << error << LL_ENDL;
+        while ((error = glGetError()) != GL_NO_ERROR)
+        {
+            LL_WARNS() << "GL Error happens while downscaling texture. Error code: " << error << LL_ENDL;
+        }
+        LLImageGL::deleteTextures(1, &new_texname);
+        return false;
+    }
+
+    // The old allocation is released with the name, a few frames from now
+    LLImageGL::deleteTextures(1, &mTexName);
+    mTexName = new_texname;
+    mTexOptionsDirty = true;
+    mTextureMemory = (S64Bytes)getMipBytes(desired_discard);
+    mCurrentDiscardLevel = desired_discard;
+    return true;
+#endif
+}
+// </FS>
+
 
 //----------------------------------------------------------------------------
 #if LL_IMAGEGL_THREAD_CHECK
@@ -2625,6 +2978,7 @@ void LLImageGLThread::run()
     gGL.init(false);
     LL_PROFILER_GPU_CONTEXT_NS("LLImageGL Context", 17);
     LL::ThreadPool::run();
+    LLImageGL::cleanupUploadRing(); // <FS/> Media upload ring
     gGL.shutdown();
     mWindow->destroySharedContext(mContext);
 }
@@ -44,6 +44,7 @@
 #define LL_IMAGEGL_THREAD_CHECK 0 //set to 1 to enable thread debugging for ImageGL
 
 class LLWindow;
+struct LLVRAMTag; // <FS/> VRAM accounting
 
 #define BYTES_TO_MEGA_BYTES(x) ((x) >> 20)
 #define MEGA_BYTES_TO_BYTES(x) ((x) << 20)
@@ -54,6 +55,7 @@ namespace LLImageGLMemory
     void free_tex_image(U32 texName);
     void free_tex_images(U32 count, const U32* texNames);
     void free_cur_tex_image();
+    void tag_tex_image(U32 texName, const LLVRAMTag& tag); // <FS/> VRAM accounting
 }
 
 //============================================================================
@@ -78,6 +80,8 @@ public:
     // Size calculation
     static S32 dataFormatBits(S32 dataformat);
     static S64 dataFormatBytes(S32 dataformat, S32 width, S32 height);
+    // Internal format used for intformat when texture compression is on
+    static S32 getCompressedFormat(S32 intformat);
     static S32 dataFormatComponents(S32 dataformat);
 
     bool updateBindStats() const ;
@@ -135,6 +139,13 @@ public:
     bool setSubImage(const LLImageRaw* imageraw, S32 x_pos, S32 y_pos, S32 width, S32 height, bool force_fast_update = false, LLGLuint use_name = 0);
     bool setSubImage(const U8* datap, S32 data_width, S32 data_height, S32 x_pos, S32 y_pos, S32 width, S32 height, bool force_fast_update = false, LLGLuint use_name = 0);
     bool setSubImageFromFrameBuffer(S32 fb_x, S32 fb_y, S32 x_pos, S32 y_pos, S32 width, S32 height);
+    // <FS> Media upload ring
+    // Uploads the rect through the calling thread's persistently mapped
+    // pixel unpack ring. Returns false when the ring can't take it, the
+    // caller then falls back to setSubImage().
+    bool setSubImageStreamed(const U8* datap, S32 data_width, S32 data_height, S32 x_pos, S32 y_pos, S32 width, S32 height, LLGLuint use_name = 0);
+    static void cleanupUploadRing();
+    // </FS>
 
     // wait for gl commands to finish on current thread and push
     // a lambda to main thread to swap mNewTexName and mTexName
@@ -167,6 +178,8 @@ public:
     bool getHasExplicitFormat() const { return mHasExplicitFormat; }
     LLGLenum getPrimaryFormat() const { return mFormatPrimary; }
     LLGLenum getFormatType() const { return mFormatType; }
+    LLGLint getInternalFormat() const { return mFormatInternal; }
+    bool getAllowCompression() const { return mAllowCompression; }
 
     bool getHasGLTexture() const { return mTexName != 0; }
     LLGLuint getTexName() const { return mTexName; }
@@ -224,6 +237,12 @@ public:
     // only works for GL_TEXTURE_2D target
     bool scaleDown(S32 desired_discard);
 
+    // <FS> GPU texture downscaling
+    // scaleDown() by copying the smaller levels out of the mip chain into a
+    // new texture, returns false if the texture or the GL can't do that
+    bool scaleDownFromMips(S32 desired_discard);
+    // </FS>
+
 public:
     // Various GL/Rendering options
     S64Bytes mTextureMemory;
@@ -309,6 +328,7 @@ private:
     static bool sSkipAnalyzeAlpha;
     static U32 sScratchPBO;
     static U32 sScratchPBOSize;
+    static bool sUseUploadRing; // <FS/> Media upload ring
     static U32* sManualScratch;
 
     //the flag to allow to call readBackRaw(...).
@@ -321,7 +341,10 @@ private:
 private:
     S32 mCategory ;
 public:
-    void setCategory(S32 category) {mCategory = category;}
+    // <FS> VRAM accounting: move the texture memory along with the category
+    //void setCategory(S32 category) {mCategory = category;}
+    void setCategory(S32 category);
+    // </FS>
     S32  getCategory()const {return mCategory;}
 
     void setTexName(GLuint texName) { mTexName = texName; }
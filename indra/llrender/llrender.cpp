@@ -71,6 +71,32 @@ bool LLRender::sGLCoreProfile = false;
 bool LLRender::sNsightDebugSupport = false;
 LLVector2 LLRender::sUIGLScaleFactor = LLVector2(1.f, 1.f);
 bool LLRender::sClassicMode = false;
+bool LLRender::sBatchPrimitives = true; // <FS/> Batched immediate mode
+
+// <FS> Batched immediate mode
+namespace
+{
+    // Room left at least to a strip, fan or loop joining the pending lists,
+    // out of the 4094 vertices of the buffer
+    constexpr U32 BATCH_JOIN_RESERVE = 1024;
+
+    // The list type a strip, fan or loop is drawn as, NUM_MODES for the others
+    U32 list_mode(U32 mode)
+    {
+        switch (mode)
+        {
+            case LLRender::TRIANGLE_STRIP:
+            case LLRender::TRIANGLE_FAN:
+                return LLRender::TRIANGLES;
+            case LLRender::LINE_STRIP:
+            case LLRender::LINE_LOOP:
+                return LLRender::LINES;
+            default:
+                return LLRender::NUM_MODES;
+        }
+    }
+}
+// </FS>
 
 struct LLVBCache
 {
@@ -215,7 +241,9 @@ bool LLTexUnit::bind(LLTexture* texture, bool for_rendering, bool forceBind)
     stop_glerror();
     if (mIndex >= 0)
     {
-        gGL.flush();
+        // <FS> Batched immediate mode, only flush when the binding changes
+        //gGL.flush();
+        // </FS>
 
         LLImageGL* gl_tex = NULL ;
 
@@ -226,6 +254,7 @@ bool LLTexUnit::bind(LLTexture* texture, bool for_rendering, bool forceBind)
                 //in audit, replace the selected texture by the default one.
                 if ((mCurrTexture != gl_tex->getTexName()) || forceBind)
                 {
+                    gGL.flush(); // <FS/> Batched immediate mode
                     activate();
                     enable(gl_tex->getTarget());
                     mCurrTexture = gl_tex->getTexName();
@@ -329,7 +358,9 @@ bool LLTexUnit::bind(LLCubeMap* cubeMap)
 {
     if (mIndex < 0) return false;
 
-    gGL.flush();
+    // <FS> Batched immediate mode, only flush when the binding changes
+    //gGL.flush();
+    // </FS>
 
     if (cubeMap == NULL)
     {
@@ -341,6 +372,7 @@ bool LLTexUnit::bind(LLCubeMap* cubeMap)
     {
         if (LLCubeMap::sUseCubeMaps)
         {
+            gGL.flush(); // <FS/> Batched immediate mode
             activate();
             enable(LLTexUnit::TT_CUBE_MAP);
             mCurrTexture = cubeMap->mImages[0]->getTexName();
@@ -369,7 +401,9 @@ bool LLTexUnit::bind(LLRenderTarget* renderTarget, bool bindDepth)
 {
     if (mIndex < 0) return false;
 
-    gGL.flush();
+    // <FS> Batched immediate mode, bindManual() flushes when the binding changes
+    //gGL.flush();
+    // </FS>
 
     if (bindDepth)
     {
@@ -805,6 +839,7 @@ LLRender::LLRender()
   : mDirty(false),
     mCount(0),
     mMode(LLRender::TRIANGLES),
+    mBatchStart(0), // <FS/> Batched immediate mode
     mCurrTextureUnitIndex(0),
     mLineWidth(1.f), // <FS> Line width OGL core profile fix by Rye Mutt
     // <FS:Ansariel> Don't ignore OpenGL max line width
@@ -831,6 +866,7 @@ LLRender::LLRender()
     mCurrBlendAlphaSFactor = BF_UNDEF;
     mCurrBlendColorDFactor = BF_UNDEF;
     mCurrBlendAlphaDFactor = BF_UNDEF;
+    mPremultipliedAlphaTarget = false; // <FS/> UI buffer
 
     mMatrixMode = LLRender::MM_MODELVIEW;
 
@@ -927,6 +963,7 @@ void LLRender::initVertexBuffer()
 void LLRender::resetVertexBuffer()
 {
     mBuffer = NULL;
+    LLVertexBuffer::cleanupStreaming(); // <FS/> Streaming ring buffer
 }
 
 void LLRender::shutdown()
@@ -1197,7 +1234,9 @@ void LLRender::rotatef(const GLfloat& a, const GLfloat& x, const GLfloat& y, con
 
 void LLRender::pushMatrix()
 {
-    flush();
+    // <FS> Batched immediate mode, the current matrix stays the same
+    //flush();
+    // </FS>
 
     {
         if (mMatIdx[mMatrixMode] < LL_MATRIX_STACK_DEPTH-1)
@@ -1388,13 +1427,16 @@ void LLRender::setColorMask(bool writeColor, bool writeAlpha)
 
 void LLRender::setColorMask(bool writeColorR, bool writeColorG, bool writeColorB, bool writeAlpha)
 {
-    flush();
+    // <FS> Batched immediate mode, only flush when the mask changes
+    //flush();
+    // </FS>
 
     if (mCurrColorMask[0] != writeColorR ||
         mCurrColorMask[1] != writeColorG ||
         mCurrColorMask[2] != writeColorB ||
         mCurrColorMask[3] != writeAlpha)
     {
+        flush(); // <FS/> Batched immediate mode
         mCurrColorMask[0] = writeColorR;
         mCurrColorMask[1] = writeColorG;
         mCurrColorMask[2] = writeColorB;
@@ -1442,6 +1484,13 @@ void LLRender::blendFunc(eBlendFactor sfactor, eBlendFactor dfactor)
 {
     llassert(sfactor < BF_UNDEF);
     llassert(dfactor < BF_UNDEF);
+    // <FS> UI buffer
+    if (mPremultipliedAlphaTarget && sfactor == BF_SOURCE_ALPHA && dfactor == BF_ONE_MINUS_SOURCE_ALPHA)
+    {
+        blendFunc(sfactor, dfactor, BF_ONE, BF_ONE_MINUS_SOURCE_ALPHA);
+        return;
+    }
+    // </FS>
     if (mCurrBlendColorSFactor != sfactor || mCurrBlendColorDFactor != dfactor ||
         mCurrBlendAlphaSFactor != sfactor || mCurrBlendAlphaDFactor != dfactor)
     {
@@ -1476,6 +1525,21 @@ void LLRender::blendFunc(eBlendFactor color_sfactor, eBlendFactor color_dfactor,
     }
 }
 
+// <FS> UI buffer
+void LLRender::setPremultipliedAlphaTarget(bool premultiplied)
+{
+    if (mPremultipliedAlphaTarget != premultiplied)
+    {
+        mPremultipliedAlphaTarget = premultiplied;
+        if (mCurrBlendColorSFactor == BF_SOURCE_ALPHA && mCurrBlendColorDFactor == BF_ONE_MINUS_SOURCE_ALPHA)
+        {
+            // Switch the alpha factors of the current state
+            blendFunc(BF_SOURCE_ALPHA, BF_ONE_MINUS_SOURCE_ALPHA);
+        }
+    }
+}
+// </FS>
+
 LLTexUnit* LLRender::getTexUnit(U32 index)
 {
     if (index < mTexUnits.size())
@@ -1577,6 +1641,19 @@ void LLRender::begin(const GLuint& mode)
 {
     if (mode != mMode)
     {
+        // <FS> Batched immediate mode
+        // A strip, fan or loop is built after the list of its type still
+        // pending, end() turns it into that list type. A pending list that
+        // would leave it too little room is drawn first.
+        if (sBatchPrimitives && mCount > 0 && mCount + BATCH_JOIN_RESERVE <= 4094 && mMode == list_mode(mode))
+        {
+            mBatchStart = mCount;
+            mMode = mode;
+            return;
+        }
+        mBatchStart = 0;
+        // </FS>
+
         if (mMode == LLRender::LINES ||
             mMode == LLRender::TRIANGLES ||
             mMode == LLRender::POINTS)
@@ -1600,6 +1677,13 @@ void LLRender::end()
         //IMM_ERRS << "GL begin and end called with no vertices specified." << LL_ENDL;
     }
 
+    // <FS> Batched immediate mode
+    if (sBatchPrimitives && list_mode(mMode) != LLRender::NUM_MODES)
+    {
+        expandPrimitive();
+    }
+    // </FS>
+
     if ((mMode != LLRender::LINES &&
         mMode != LLRender::TRIANGLES &&
         mMode != LLRender::POINTS) ||
@@ -1612,6 +1696,14 @@ void LLRender::end()
 void LLRender::flush()
 {
     STOP_GLERROR;
+
+    // <FS> Batched immediate mode, the lists before an unfinished strip go first
+    if (mBatchStart > 0)
+    {
+        flushBatchedPrefix();
+    }
+    // </FS>
+
     if (mCount > 0)
     {
         LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
@@ -1671,7 +1763,13 @@ void LLRender::flush()
                 vb = bufferfromCache(attribute_mask, count);
             }
 
-            drawBuffer(vb, mMode, count);
+            // <FS> Streaming ring buffer, null when bufferfromCache() streamed it
+            //drawBuffer(vb, mMode, count);
+            if (vb)
+            {
+                drawBuffer(vb, mMode, count);
+            }
+            // </FS>
         }
         else
         {
@@ -1721,6 +1819,12 @@ LLVertexBuffer* LLRender::bufferfromCache(U32 attribute_mask, U32 count)
     if (cache != sVBCache.end())
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_VERTEX("vb cache hit");
+        // <FS> Streaming ring buffer, streamed last time, seen again so it gets a buffer
+        if (cache->second.vb.isNull())
+        {
+            cache->second.vb = genBuffer(attribute_mask, count);
+        }
+        // </FS>
         // cache hit, just use the cached buffer
         vb = cache->second.vb;
         cache->second.touched = std::chrono::steady_clock::now();
@@ -1728,9 +1832,24 @@ LLVertexBuffer* LLRender::bufferfromCache(U32 attribute_mask, U32 count)
     else
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_VERTEX("vb cache miss");
-        vb = genBuffer(attribute_mask, count);
+        // <FS> Streaming ring buffer
+        // Geometry seen for the first time, like text that changes every
+        // frame, is drawn straight from the streaming ring instead of getting
+        // a buffer of its own. Only geometry that comes back is cached.
+        //vb = genBuffer(attribute_mask, count);
+        //
+        //sVBCache[vhash] = { vb , std::chrono::steady_clock::now() };
+        if (LLVertexBuffer::drawStreamed(mMode, count, mVerticesp.get(), mTexcoordsp.get(), mColorsp.get()))
+        {
+            vb = nullptr;
+        }
+        else
+        {
+            vb = genBuffer(attribute_mask, count);
+        }
 
         sVBCache[vhash] = { vb , std::chrono::steady_clock::now() };
+        // </FS>
 
         static U32 miss_count = 0;
         miss_count++;
@@ -1800,6 +1919,131 @@ void LLRender::resetStriders(S32 count)
     mCount = 0;
 }
 
+// <FS> Batched immediate mode
+// Rewrite the strip, fan or loop begun at mBatchStart in place as a list of
+// the matching type, so it goes out in one draw with the lists around it
+// instead of a draw of its own. Left as it is when the list would not fit.
+void LLRender::expandPrimitive()
+{
+    U32 first = mBatchStart;
+    mBatchStart = 0;
+
+    U32 count = mCount - first;
+    U32 expanded = 0;
+    switch (mMode)
+    {
+        case LLRender::TRIANGLE_STRIP:
+        case LLRender::TRIANGLE_FAN:
+            expanded = count >= 3 ? (count - 2) * 3 : 0;
+            break;
+        case LLRender::LINE_STRIP:
+            expanded = count >= 2 ? (count - 1) * 2 : 0;
+            break;
+        case LLRender::LINE_LOOP:
+            expanded = count >= 2 ? count * 2 : 0;
+            break;
+        default:
+            return;
+    }
+
+    if (first + expanded > 4094)
+    {
+        if (first > 0)
+        {
+            mBatchStart = first;
+            flushBatchedPrefix();
+            first = 0;
+        }
+
+        if (expanded > 4094)
+        {
+            return;
+        }
+    }
+
+    // with the attribute state set after the last vertex
+    mBatchVertices.assign(mVerticesp.get() + first, mVerticesp.get() + mCount + 1);
+    mBatchTexcoords.assign(mTexcoordsp.get() + first, mTexcoordsp.get() + mCount + 1);
+    mBatchColors.assign(mColorsp.get() + first, mColorsp.get() + mCount + 1);
+
+    U32 out = first;
+    auto emit = [&](U32 i)
+    {
+        mVerticesp[out] = mBatchVertices[i];
+        mTexcoordsp[out] = mBatchTexcoords[i];
+        mColorsp[out] = mBatchColors[i];
+        ++out;
+    };
+
+    switch (mMode)
+    {
+        case LLRender::TRIANGLE_STRIP:
+            for (U32 i = 0; i + 2 < count; ++i)
+            { // every other triangle of a strip is wound the other way
+                emit(i & 1 ? i + 1 : i);
+                emit(i & 1 ? i : i + 1);
+                emit(i + 2);
+            }
+            break;
+        case LLRender::TRIANGLE_FAN:
+            for (U32 i = 1; i + 1 < count; ++i)
+            {
+                emit(0);
+                emit(i);
+                emit(i + 1);
+            }
+            break;
+        default:
+            for (U32 i = 0; i + 1 < count; ++i)
+            {
+                emit(i);
+                emit(i + 1);
+            }
+            if (mMode == LLRender::LINE_LOOP && count >= 2)
+            {
+                emit(count - 1);
+                emit(0);
+            }
+            break;
+    }
+
+    mVerticesp[out] = mBatchVertices[count];
+    mTexcoordsp[out] = mBatchTexcoords[count];
+    mColorsp[out] = mBatchColors[count];
+
+    mCount = out;
+    mMode = list_mode(mMode);
+}
+
+// Draw the lists pending before the strip, fan or loop begun at mBatchStart
+// and move what there is of it to the start of the buffer
+void LLRender::flushBatchedPrefix()
+{
+    const U32 first = mBatchStart;
+    const U32 mode = mMode;
+    const U32 count = mCount - first;
+    mBatchStart = 0;
+
+    mBatchVertices.assign(mVerticesp.get() + first, mVerticesp.get() + mCount + 1);
+    mBatchTexcoords.assign(mTexcoordsp.get() + first, mTexcoordsp.get() + mCount + 1);
+    mBatchColors.assign(mColorsp.get() + first, mColorsp.get() + mCount + 1);
+
+    mCount = first;
+    mMode = list_mode(mode);
+    flush();
+
+    for (U32 i = 0; i <= count; ++i)
+    {
+        mVerticesp[i] = mBatchVertices[i];
+        mTexcoordsp[i] = mBatchTexcoords[i];
+        mColorsp[i] = mBatchColors[i];
+    }
+
+    mCount = count;
+    mMode = mode;
+}
+// </FS>
+
 void LLRender::vertex3f(const GLfloat& x, const GLfloat& y, const GLfloat& z)
 {
     //the range of mVerticesp, mColorsp and mTexcoordsp is [0, 4095]
@@ -1813,6 +2057,14 @@ void LLRender::vertex3f(const GLfloat& x, const GLfloat& y, const GLfloat& z)
         }
     }
 
+    // <FS> Batched immediate mode, a strip longer than the reserve makes
+    // room by drawing the lists pending before it
+    if (mCount > 4094 && mBatchStart > 0)
+    {
+        flushBatchedPrefix();
+    }
+    // </FS>
+
     if (mCount > 4094)
     {
     //  LL_WARNS() << "GL immediate mode overflow.  Some geometry not drawn." << LL_ENDL;
@@ -463,6 +463,14 @@ public:
     void blendFunc(eBlendFactor color_sfactor, eBlendFactor color_dfactor,
                eBlendFactor alpha_sfactor, eBlendFactor alpha_dfactor);
 
+    // <FS> UI buffer
+    // While set, alpha blending accumulates coverage in the alpha channel
+    // (ONE, ONE_MINUS_SOURCE_ALPHA), so a target cleared to transparent ends
+    // up premultiplied and can be composited with the same result as drawing
+    // directly.
+    void setPremultipliedAlphaTarget(bool premultiplied);
+    // </FS>
+
     LLLightState* getLight(U32 index);
     void setAmbientLightColor(const LLColor4& color);
 
@@ -492,14 +500,20 @@ public:
     static bool sNsightDebugSupport;
     static LLVector2 sUIGLScaleFactor;
     static bool sClassicMode; // classic sky mode active
+    static bool sBatchPrimitives; // <FS/> Batched immediate mode
 
 private:
     friend class LLLightState;
 
+    // <FS/> null when the vertices were new and already drawn from the streaming ring
     LLVertexBuffer* bufferfromCache(U32 attribute_mask, U32 count);
     LLVertexBuffer* genBuffer(U32 attribute_mask, S32 count);
     void drawBuffer(LLVertexBuffer* vb, U32 mode, S32 count);
     void resetStriders(S32 count);
+    // <FS> Batched immediate mode
+    void expandPrimitive();
+    void flushBatchedPrefix();
+    // </FS>
 
     eMatrixMode mMatrixMode;
     U32 mMatIdx[NUM_MATRIX_MODES];
@@ -512,6 +526,7 @@ private:
     bool            mDirty;
     U32             mCount;
     U32             mMode;
+    U32             mBatchStart; // <FS/> Batched immediate mode, first vertex of the strip, fan or loop being built
     U32             mCurrTextureUnitIndex;
     bool                mCurrColorMask[4];
     F32             mLineWidth; // <FS> Line width OGL core profile fix by Rye Mutt
@@ -532,9 +547,16 @@ private:
     eBlendFactor mCurrBlendColorDFactor;
     eBlendFactor mCurrBlendAlphaSFactor;
     eBlendFactor mCurrBlendAlphaDFactor;
+    bool mPremultipliedAlphaTarget; // <FS/> UI buffer
 
     std::vector<LLVector3> mUIOffset;
     std::vector<LLVector3> mUIScale;
+
+    // <FS> Batched immediate mode, scratch space of expandPrimitive()
+    std::vector<LLVector4a> mBatchVertices;
+    std::vector<LLVector2>  mBatchTexcoords;
+    std::vector<LLColor4U>  mBatchColors;
+    // </FS>
 };
 
 extern F32 gGLModelView[16];
@@ -29,6 +29,7 @@
 #include "llrendertarget.h"
 #include "llrender.h"
 #include "llgl.h"
+#include "llvramaccounting.h" // <FS/> VRAM accounting
 
 LLRenderTarget* LLRenderTarget::sBoundTarget = NULL;
 U32 LLRenderTarget::sBytesAllocated = 0;
@@ -78,6 +79,7 @@ void LLRenderTarget::resize(U32 resx, U32 resy)
 {
     //for accounting, get the number of pixels added/subtracted
     S32 pix_diff = (resx*resy)-(mResX*mResY);
+    LLVRAMAccounting::Scope vram_scope({ LLVRAMCategory::RENDER_TARGET }, true); // <FS/> VRAM accounting
 
     mResX = resx;
     mResY = resy;
@@ -229,6 +231,7 @@ bool LLRenderTarget::addColorAttachment(U32 color_fmt)
     U32 tex;
     LLImageGL::generateTextures(1, &tex);
     gGL.getTexUnit(0)->bindManual(mUsage, tex);
+    LLVRAMAccounting::Scope vram_scope({ LLVRAMCategory::RENDER_TARGET }, true); // <FS/> VRAM accounting
 
     stop_glerror();
 
@@ -298,6 +301,7 @@ bool LLRenderTarget::addColorAttachment(U32 color_fmt)
 bool LLRenderTarget::allocateDepth()
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_DISPLAY;
+    LLVRAMAccounting::Scope vram_scope({ LLVRAMCategory::RENDER_TARGET }, true); // <FS/> VRAM accounting
     LLImageGL::generateTextures(1, &mDepth);
     gGL.getTexUnit(0)->bindManual(mUsage, mDepth);
 
@@ -444,9 +448,16 @@ void LLRenderTarget::bindTarget()
     }
     check_framebuffer_status();
 
-    glViewport(0, 0, mResX, mResY);
-    sCurResX = mResX;
-    sCurResY = mResY;
+    // <FS> Impostor atlas
+    //glViewport(0, 0, mResX, mResY);
+    //sCurResX = mResX;
+    //sCurResY = mResY;
+    S32 viewport[4];
+    getViewport(viewport);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    sCurResX = viewport[2];
+    sCurResY = viewport[3];
+    // </FS>
 
     mPreviousRT = sBoundTarget;
     sBoundTarget = this;
@@ -462,7 +473,19 @@ void LLRenderTarget::clear(U32 mask_in)
         mask |= GL_DEPTH_BUFFER_BIT;
 
     }
-    if (mFBO)
+    // <FS> Impostor atlas
+    //if (mFBO)
+    if (mFBO && mViewportWidth && mViewportHeight)
+    { // clear the region only, the rest of the target belongs to someone else
+        check_framebuffer_status();
+        LLGLEnable scissor(GL_SCISSOR_TEST);
+        glScissor(mViewportX, mViewportY, mViewportWidth, mViewportHeight);
+        stop_glerror();
+        glClear(mask & mask_in);
+        stop_glerror();
+    }
+    else if (mFBO)
+    // </FS>
     {
         check_framebuffer_status();
         stop_glerror();
@@ -558,12 +581,32 @@ bool LLRenderTarget::isComplete() const
 
 void LLRenderTarget::getViewport(S32* viewport)
 {
+    // <FS> Impostor atlas
+    if (mViewportWidth && mViewportHeight)
+    {
+        viewport[0] = mViewportX;
+        viewport[1] = mViewportY;
+        viewport[2] = mViewportWidth;
+        viewport[3] = mViewportHeight;
+        return;
+    }
+    // </FS>
     viewport[0] = 0;
     viewport[1] = 0;
     viewport[2] = mResX;
     viewport[3] = mResY;
 }
 
+// <FS> Impostor atlas
+void LLRenderTarget::setViewport(U32 x, U32 y, U32 width, U32 height)
+{
+    mViewportX = x;
+    mViewportY = y;
+    mViewportWidth = width;
+    mViewportHeight = height;
+}
+// </FS>
+
 bool LLRenderTarget::isBoundInStack() const
 {
     LLRenderTarget* cur = sBoundTarget;
@@ -136,6 +136,12 @@ public:
     //get applied viewport
     void getViewport(S32* viewport);
 
+    // <FS> Impostor atlas
+    // Restrict the viewport applied by bindTarget and the area cleared by
+    // clear to a region of the target, all of it when width or height is 0
+    void setViewport(U32 x, U32 y, U32 width, U32 height);
+    // </FS>
+
     //get X resolution
     U32 getWidth() const { return mResX; }
 
@@ -188,6 +194,13 @@ protected:
     U32 mMipLevels;
 
     LLTexUnit::eTextureType mUsage;
+
+    // <FS> Impostor atlas
+    U32 mViewportX = 0;
+    U32 mViewportY = 0;
+    U32 mViewportWidth = 0;
+    U32 mViewportHeight = 0;
+    // </FS>
 };
 
 #endif
@@ -33,6 +33,11 @@
 #include "llsdserialize.h"
 #include "hbxxh.h"
 
+// <FS> Shader cache source hash
+#include <boost/filesystem.hpp>
+#include <fstream>
+// </FS>
+
 #if LL_DARWIN
 #include "OpenGL/OpenGL.h"
 #endif
@@ -879,7 +884,10 @@ GLuint LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shader_lev
         }
     }
 
-    if (error == GL_NO_ERROR)
+    // <FS> Parallel shader compile, asking for the status would wait on the compile, the link reports it instead
+    //if (error == GL_NO_ERROR)
+    if (error == GL_NO_ERROR && !LLGLSLShader::sDeferLink)
+    // </FS>
     {
         //check for errors
         GLint success = GL_TRUE;
@@ -896,7 +904,10 @@ GLuint LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shader_lev
             ret = 0;
         }
     }
-    else
+    // <FS> Parallel shader compile
+    //else
+    else if (error != GL_NO_ERROR)
+    // </FS>
     {
         ret = 0;
     }
@@ -940,6 +951,13 @@ bool LLShaderMgr::linkProgramObject(GLuint obj, bool suppress_errors)
         glLinkProgram(obj);
     }
 
+    // <FS> Parallel shader compile
+    return checkLinkStatus(obj, suppress_errors);
+}
+
+bool LLShaderMgr::checkLinkStatus(GLuint obj, bool suppress_errors)
+{
+    // </FS>
     GLint success = GL_TRUE;
 
     {
@@ -990,9 +1008,19 @@ void LLShaderMgr::initShaderCache(bool enabled, const LLUUID& old_cache_version,
 
     mShaderCacheEnabled = gGLManager.mGLVersion >= 4.09 && enabled;
 
-    if(!mShaderCacheEnabled || mShaderCacheInitialized)
+    // <FS> Shader cache source hash, redone on every call as shaders can be
+    // edited and reloaded without a restart
+    //if(!mShaderCacheEnabled || mShaderCacheInitialized)
+    //    return;
+    if (!mShaderCacheEnabled)
         return;
 
+    updateShaderSourceHash();
+
+    if (mShaderCacheInitialized)
+        return;
+    // </FS>
+
     mShaderCacheInitialized = true;
 
     mShaderCacheDir = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "shader_cache");
@@ -1029,6 +1057,52 @@ void LLShaderMgr::initShaderCache(bool enabled, const LLUUID& old_cache_version,
     }
 }
 
+// <FS> Shader cache source hash
+// Program binaries are keyed by shader names, defines and driver, but not by
+// what the sources say. Hashing every file under the shader directory,
+// including the feature files shaders pull in, makes an edited source miss
+// the cache instead of loading the binary built from the old text. Stale
+// binaries are then never loaded again and age out of the cache.
+void LLShaderMgr::updateShaderSourceHash()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_SHADER;
+
+    const std::string shader_dir = gDirUtilp->getDirName(getShaderDirPrefix());
+#if LL_WINDOWS
+    const boost::filesystem::path root(utf8str_to_utf16str(shader_dir));
+#else
+    const boost::filesystem::path root(shader_dir);
+#endif
+
+    std::vector<boost::filesystem::path> files;
+    boost::system::error_code ec;
+    boost::filesystem::recursive_directory_iterator iter(root, ec);
+    while (iter != boost::filesystem::recursive_directory_iterator() && !ec.failed())
+    {
+        if (boost::filesystem::is_regular_file(*iter, ec) && !ec.failed())
+        {
+            files.push_back(iter->path());
+        }
+        iter.increment(ec);
+    }
+
+    // directory order differs between file systems
+    std::sort(files.begin(), files.end());
+
+    HBXXH128 hash_obj;
+    for (const boost::filesystem::path& file : files)
+    {
+        hash_obj.update(file.lexically_relative(root).generic_string());
+
+        std::ifstream instream(file.c_str(), std::ios::binary);
+        hash_obj.update(instream);
+    }
+    mShaderSourceHash = hash_obj.digest();
+
+    LL_INFOS() << "Hashed " << files.size() << " shader sources: " << mShaderSourceHash << LL_ENDL;
+}
+// </FS>
+
 void LLShaderMgr::clearShaderCache()
 {
     std::string shader_cache = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "shader_cache");
@@ -372,6 +372,7 @@ public:
     void dumpObjectLog(GLuint ret, bool warns = true, const std::string& filename = "");
     void dumpShaderSource(U32 shader_code_count, GLchar** shader_code_text);
     bool    linkProgramObject(GLuint obj, bool suppress_errors = false);
+    bool    checkLinkStatus(GLuint obj, bool suppress_errors = false); // <FS/> Parallel shader compile
     bool    validateProgramObject(GLuint obj);
     GLuint loadShaderFile(const std::string& filename, S32 & shader_level, GLenum type, std::map<std::string, std::string>* defines = NULL, S32 texture_index_channels = -1);
 
@@ -384,6 +385,7 @@ public:
     void initShaderCache(bool enabled, const LLUUID& old_cache_version, const LLUUID& current_cache_version);
     void clearShaderCache();
     void persistShaderCacheMetadata();
+    void updateShaderSourceHash(); // <FS/> Shader cache source hash
 
     bool loadCachedProgramBinary(LLGLSLShader* shader);
     bool saveCachedProgramBinary(LLGLSLShader* shader);
@@ -408,6 +410,7 @@ public:
     bool mShaderCacheInitialized = false;
     bool mShaderCacheEnabled = false;
     std::string mShaderCacheDir;
+    LLUUID mShaderSourceHash; // <FS/> Shader cache source hash, part of every program's key
 
 protected:
 
@@ -36,6 +36,8 @@
 #include "llshadermgr.h"
 #include "llglslshader.h"
 #include "llmemory.h"
+#include <map> // <FS/> Geometry heap
+#include "llwindow.h" // <FS/> Render submit thread
 #include <glm/gtc/type_ptr.hpp>
 
 //Next Highest Power Of Two
@@ -607,6 +609,209 @@ public:
 
 static LLVBOPool* sVBOPool = nullptr;
 
+// <FS> Geometry heap
+// Carves vertex and index buffers out of a few large GL buffers, so the
+// draws of different spatial groups and rigged faces share buffer bindings
+// and the driver tracks far fewer buffer objects. Each block keeps its own
+// CPU copy, like the pool's. Free ranges are coalesced with their
+// neighbours on free, and a page that empties is given back to GL unless it
+// is the last one of its kind. Not available on Apple, where _unmapBuffer()
+// recreates whole buffers.
+class LLVBOHeap
+{
+public:
+    static constexpr U32 PAGE_SIZE = 8 * 1024 * 1024;
+    static constexpr U32 MAX_BLOCK_SIZE = 512 * 1024;  // larger buffers go to the pool
+    static constexpr U32 ALIGNMENT = 64;
+
+    ~LLVBOHeap()
+    {
+        for (auto& pages : mPages)
+        {
+            for (Page& page : pages)
+            {
+                delete_buffers(1, &page.mGLName);
+            }
+        }
+    }
+
+    U64 getVramBytesUsed() const
+    {
+        return (U64)(mPages[0].size() + mPages[1].size()) * PAGE_SIZE;
+    }
+
+    // false when size must come from the pool instead
+    bool allocate(GLenum type, U32 size, GLuint& name, U32& offset, U8*& data)
+    {
+        LL_PROFILE_ZONE_SCOPED_CATEGORY_VERTEX;
+        llassert(type == GL_ARRAY_BUFFER || type == GL_ELEMENT_ARRAY_BUFFER);
+        if (size > MAX_BLOCK_SIZE)
+        {
+            return false;
+        }
+
+        const U32 block_size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        std::vector<Page>& pages = mPages[type == GL_ELEMENT_ARRAY_BUFFER];
+
+        Page* page = nullptr;
+        std::multimap<U32, U32>::iterator fit;
+        for (Page& candidate : pages)
+        {
+            // best fit within the page
+            fit = candidate.mBySize.lower_bound(block_size);
+            if (fit != candidate.mBySize.end())
+            {
+                page = &candidate;
+                break;
+            }
+        }
+
+        if (!page)
+        {
+            LL_PROFILE_GPU_ZONE("vbo heap page");
+            pages.emplace_back();
+            page = &pages.back();
+            page->mGLName = gen_buffer();
+            glBindBuffer(type, page->mGLName);
+            glBufferData(type, PAGE_SIZE, nullptr, GL_DYNAMIC_DRAW);
+            if (type == GL_ELEMENT_ARRAY_BUFFER)
+            {
+                LLVertexBuffer::sGLRenderIndices = page->mGLName;
+            }
+            else
+            {
+                LLVertexBuffer::sGLRenderBuffer = page->mGLName;
+            }
+            page->insertFree(0, PAGE_SIZE);
+            fit = page->mBySize.lower_bound(block_size);
+        }
+
+        const U32 free_offset = fit->second;
+        const U32 free_size = fit->first;
+        page->eraseFree(free_offset, free_size);
+        if (free_size > block_size)
+        {
+            page->insertFree(free_offset + block_size, free_size - block_size);
+        }
+        page->mUsed += block_size;
+
+        name = page->mGLName;
+        offset = free_offset;
+        data = (U8*)ll_aligned_malloc_16(size);
+        return true;
+    }
+
+    void free(GLenum type, U32 size, GLuint name, U32 offset, U8* data)
+    {
+        LL_PROFILE_ZONE_SCOPED_CATEGORY_VERTEX;
+        ll_aligned_free_16(data);
+
+        U32 block_size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        std::vector<Page>& pages = mPages[type == GL_ELEMENT_ARRAY_BUFFER];
+        for (size_t i = 0; i < pages.size(); ++i)
+        {
+            Page& page = pages[i];
+            if (page.mGLName != name)
+            {
+                continue;
+            }
+
+            llassert(page.mUsed >= block_size);
+            page.mUsed -= block_size;
+
+            // merge with the free ranges on either side
+            auto next = page.mFree.lower_bound(offset);
+            if (next != page.mFree.end() && next->first == offset + block_size)
+            {
+                block_size += next->second;
+                page.eraseFree(next->first, next->second);
+            }
+            auto prev = page.mFree.lower_bound(offset);
+            if (prev != page.mFree.begin())
+            {
+                --prev;
+                if (prev->first + prev->second == offset)
+                {
+                    offset = prev->first;
+                    block_size += prev->second;
+                    page.eraseFree(prev->first, prev->second);
+                }
+            }
+            page.insertFree(offset, block_size);
+
+            if (page.mUsed == 0 && pages.size() > 1)
+            {
+                delete_buffers(1, &page.mGLName);
+                pages.erase(pages.begin() + i);
+            }
+            return;
+        }
+
+        llassert(false); // block from no page of this heap
+    }
+
+private:
+    struct Page
+    {
+        GLuint                  mGLName = 0;
+        U32                     mUsed = 0;
+        std::map<U32, U32>      mFree;      // offset -> size
+        std::multimap<U32, U32> mBySize;    // size -> offset
+
+        void insertFree(U32 offset, U32 size)
+        {
+            mFree[offset] = size;
+            mBySize.emplace(size, offset);
+        }
+
+        void eraseFree(U32 offset, U32 size)
+        {
+            mFree.erase(offset);
+            auto range = mBySize.equal_range(size);
+            for (auto iter = range.first; iter != range.second; ++iter)
+            {
+                if (iter->second == offset)
+                {
+                    mBySize.erase(iter);
+                    break;
+                }
+            }
+        }
+    };
+
+    std::vector<Page> mPages[2]; // vertex, index
+};
+
+static LLVBOHeap* sVBOHeap = nullptr;
+
+// From the heap when it takes size, else from the pool
+static void allocate_gl(GLenum type, U32 size, GLuint& name, U32& offset, U8*& data, bool& heap)
+{
+    heap = sVBOHeap && sVBOHeap->allocate(type, size, name, offset, data);
+    if (!heap)
+    {
+        offset = 0;
+        sVBOPool->allocate(type, size, name, data);
+    }
+}
+
+static void free_gl(GLenum type, U32 size, GLuint name, U32 offset, U8* data, bool heap)
+{
+    if (!heap)
+    {
+        sVBOPool->free(type, size, name, data);
+    }
+    else if (sVBOHeap)
+    {
+        sVBOHeap->free(type, size, name, offset, data);
+    }
+    else
+    {
+        ll_aligned_free_16(data);
+    }
+}
+// </FS>
+
 void LLVertexBufferData::drawWithMatrix()
 {
     if (!mVB)
@@ -672,7 +877,10 @@ void LLVertexBufferData::draw()
 //static
 U64 LLVertexBuffer::getBytesAllocated()
 {
-    return sVBOPool ? sVBOPool->getVramBytesUsed() : 0;
+    // <FS> Geometry heap
+    //return sVBOPool ? sVBOPool->getVramBytesUsed() : 0;
+    return (sVBOPool ? sVBOPool->getVramBytesUsed() : 0) + (sVBOHeap ? sVBOHeap->getVramBytesUsed() : 0);
+    // </FS>
 }
 
 //============================================================================
@@ -682,6 +890,14 @@ U32 LLVertexBuffer::sGLRenderBuffer = 0;
 U32 LLVertexBuffer::sGLRenderIndices = 0;
 U32 LLVertexBuffer::sLastMask = 0;
 U32 LLVertexBuffer::sVertexCount = 0;
+bool LLVertexBuffer::sUsePackedAttributes = false; // <FS/> Packed vertex attributes
+bool LLVertexBuffer::sUseStreamingRing = true; // <FS/> Streaming ring buffer
+bool LLVertexBuffer::sUseGeometryHeap = true; // <FS/> Geometry heap
+bool LLVertexBuffer::sUseSubmitThread = false; // <FS/> Render submit thread
+// <FS> Geometry heap: heap buffers share a GL name, so whose attribute
+// pointers are set up can't be told from sGLRenderBuffer alone
+static const LLVertexBuffer* sSetupBuffer = nullptr;
+// </FS>
 
 
 //NOTE: each component must be AT LEAST 4 bytes in size to avoid a performance penalty on AMD hardware
@@ -703,6 +919,42 @@ const U32 LLVertexBuffer::sTypeSize[LLVertexBuffer::TYPE_MAX] =
     sizeof(LLVector4), // TYPE_TEXTURE_INDEX (actually exists as position.w), no extra data, but stride is 16 bytes
 };
 
+// <FS> Packed vertex attributes: size of each attribute in the GL buffer of a packed vertex buffer
+const U32 LLVertexBuffer::sPackedTypeSize[LLVertexBuffer::TYPE_MAX] =
+{
+    sizeof(LLVector4), // TYPE_VERTEX,
+    sizeof(U32),       // TYPE_NORMAL, GL_INT_2_10_10_10_REV
+    sizeof(LLVector2), // TYPE_TEXCOORD0,
+    sizeof(LLVector2), // TYPE_TEXCOORD1,
+    sizeof(LLVector2), // TYPE_TEXCOORD2,
+    sizeof(LLVector2), // TYPE_TEXCOORD3,
+    sizeof(LLColor4U), // TYPE_COLOR,
+    sizeof(LLColor4U), // TYPE_EMISSIVE, only alpha is used currently
+    sizeof(U32),       // TYPE_TANGENT, GL_INT_2_10_10_10_REV
+    sizeof(F32),       // TYPE_WEIGHT,
+    sizeof(LLVector4), // TYPE_WEIGHT4,
+    sizeof(LLVector4), // TYPE_CLOTHWEIGHT,
+    sizeof(U64),       // TYPE_JOINT,
+    sizeof(LLVector4), // TYPE_TEXTURE_INDEX (actually exists as position.w), no extra data, but stride is 16 bytes
+};
+
+// Packs the xyz of each vector into signed normalized 10 bit fields and the
+// sign of w into the 2 bit field, the GPU unpacks them back to floats
+static void pack_snorm_2_10_10_10(const U8* src, U8* dst, U32 count)
+{
+    const F32* v = (const F32*)src;
+    U32* packed = (U32*)dst;
+    for (U32 i = 0; i < count; ++i, v += 4)
+    {
+        U32 x = (U32)ll_round(llclamp(v[0], -1.f, 1.f) * 511.f) & 0x3FF;
+        U32 y = (U32)ll_round(llclamp(v[1], -1.f, 1.f) * 511.f) & 0x3FF;
+        U32 z = (U32)ll_round(llclamp(v[2], -1.f, 1.f) * 511.f) & 0x3FF;
+        U32 w = v[3] < 0.f ? 0x3 : 0x1;
+        packed[i] = x | (y << 10) | (z << 20) | (w << 30);
+    }
+}
+// </FS>
+
 static const std::string vb_type_name[] =
 {
     "TYPE_VERTEX",
@@ -927,17 +1179,116 @@ void LLVertexBuffer::drawRange(U32 mode, U32 start, U32 end, U32 count, U32 indi
     llassert(mGLIndices == sGLRenderIndices);
     gGL.syncMatrices();
     STOP_GLERROR;
+    // <FS> Geometry heap
+    //glDrawRangeElements(sGLMode[mode], start, end, count, mIndicesType,
+    //    (GLvoid*) (indices_offset * (size_t) mIndicesStride));
     glDrawRangeElements(sGLMode[mode], start, end, count, mIndicesType,
-        (GLvoid*) (indices_offset * (size_t) mIndicesStride));
+        (GLvoid*) (mGLIndicesOffset + indices_offset * (size_t) mIndicesStride));
+    // </FS>
     STOP_GLERROR;
 }
 
 void LLVertexBuffer::drawRangeFast(U32 mode, U32 start, U32 end, U32 count, U32 indices_offset) const
 {
+    // <FS> Geometry heap
+    //glDrawRangeElements(sGLMode[mode], start, end, count, mIndicesType,
+    //    (GLvoid*)(indices_offset * (size_t)mIndicesStride));
     glDrawRangeElements(sGLMode[mode], start, end, count, mIndicesType,
-        (GLvoid*)(indices_offset * (size_t)mIndicesStride));
+        (GLvoid*)(mGLIndicesOffset + indices_offset * (size_t)mIndicesStride));
+    // </FS>
 }
 
+// <FS> Multi-draw batching
+void LLVertexBuffer::drawRanges(U32 mode, const U32* counts, const U32* indices_offsets, U32 draw_count) const
+{
+    llassert(mGLBuffer == sGLRenderBuffer);
+    llassert(mGLIndices == sGLRenderIndices);
+
+    // main thread only, like every other draw
+    static std::vector<GLsizei> gl_counts;
+    static std::vector<const GLvoid*> gl_offsets;
+    gl_counts.resize(draw_count);
+    gl_offsets.resize(draw_count);
+    for (U32 i = 0; i < draw_count; ++i)
+    {
+        llassert(indices_offsets[i] + counts[i] <= mNumIndices);
+        gl_counts[i] = (GLsizei)counts[i];
+        gl_offsets[i] = (const GLvoid*)(mGLIndicesOffset + indices_offsets[i] * (size_t)mIndicesStride);
+    }
+
+    gGL.syncMatrices();
+    STOP_GLERROR;
+    glMultiDrawElements(sGLMode[mode], gl_counts.data(), mIndicesType, gl_offsets.data(), (GLsizei)draw_count);
+    STOP_GLERROR;
+}
+// </FS>
+
+// <FS> Mesh instancing
+void LLVertexBuffer::drawInstanced(U32 mode, U32 count, U32 indices_offset, U32 instance_count) const
+{
+    llassert(indices_offset + count <= mNumIndices);
+    llassert(mGLBuffer == sGLRenderBuffer);
+    llassert(mGLIndices == sGLRenderIndices);
+    gGL.syncMatrices();
+    STOP_GLERROR;
+    glDrawElementsInstanced(sGLMode[mode], count, mIndicesType,
+        (GLvoid*)(mGLIndicesOffset + indices_offset * (size_t)mIndicesStride), instance_count);
+    STOP_GLERROR;
+}
+// </FS>
+
+// <FS> GPU terrain
+void LLVertexBuffer::drawRangesBaseVertex(U32 mode, const U32* counts, const U32* indices_offsets, const S32* base_vertices, U32 draw_count) const
+{
+    llassert(mGLBuffer == sGLRenderBuffer);
+    llassert(mGLIndices == sGLRenderIndices);
+
+    // main thread only, like every other draw
+    static std::vector<GLsizei> gl_counts;
+    static std::vector<const GLvoid*> gl_offsets;
+    static std::vector<GLint> gl_base_vertices;
+    gl_counts.resize(draw_count);
+    gl_offsets.resize(draw_count);
+    gl_base_vertices.resize(draw_count);
+    for (U32 i = 0; i < draw_count; ++i)
+    {
+        llassert(indices_offsets[i] + counts[i] <= mNumIndices);
+        llassert(base_vertices[i] >= 0 && (U32)base_vertices[i] < mNumVerts);
+        gl_counts[i] = (GLsizei)counts[i];
+        gl_offsets[i] = (const GLvoid*)(mGLIndicesOffset + indices_offsets[i] * (size_t)mIndicesStride);
+        gl_base_vertices[i] = (GLint)base_vertices[i];
+    }
+
+    gGL.syncMatrices();
+    STOP_GLERROR;
+    glMultiDrawElementsBaseVertex(sGLMode[mode], gl_counts.data(), mIndicesType, gl_offsets.data(),
+        (GLsizei)draw_count, gl_base_vertices.data());
+    STOP_GLERROR;
+}
+// </FS>
+
+// <FS> Pre-skinned shadows
+void LLVertexBuffer::drawRangeWithPositions(U32 mode, U32 start, U32 end, U32 count, U32 indices_offset, U32 positions, U32 positions_offset) const
+{
+    llassert(validateRange(start, end, count, indices_offset));
+    llassert(mGLIndices == sGLRenderIndices);
+    llassert(LLGLSLShader::sCurBoundShaderPtr->mAttributeMask == MAP_VERTEX);
+
+    glBindBuffer(GL_ARRAY_BUFFER, positions);
+    glVertexAttribPointer(TYPE_VERTEX, 3, GL_FLOAT, GL_FALSE, sTypeSize[TYPE_VERTEX], (GLvoid*)(size_t)positions_offset);
+
+    // the positions of the range start at positions_offset, index start is its first
+    gGL.syncMatrices();
+    STOP_GLERROR;
+    glDrawRangeElementsBaseVertex(sGLMode[mode], start, end, count, mIndicesType,
+        (GLvoid*)(mGLIndicesOffset + indices_offset * (size_t)mIndicesStride), -(GLint)start);
+    STOP_GLERROR;
+
+    // whichever buffer is set next has to set up its pointers again
+    sGLRenderBuffer = positions;
+    sSetupBuffer = nullptr;
+}
+// </FS>
 
 void LLVertexBuffer::draw(U32 mode, U32 count, U32 indices_offset) const
 {
@@ -957,6 +1308,170 @@ void LLVertexBuffer::drawArrays(U32 mode, U32 first, U32 count) const
     STOP_GLERROR;
 }
 
+// <FS> Streaming ring buffer
+// One GL buffer created with glBufferStorage and mapped persistently and
+// coherently, so immediate mode vertices are written straight into memory
+// the GPU reads, without glBufferData or glBufferSubData copies. It is cut
+// into segments. Leaving a segment fences it, entering one waits for the
+// fence placed when it was last left, which only stalls when the GPU is a
+// whole ring behind.
+class LLStreamRing
+{
+public:
+    static constexpr U32 SEGMENT_COUNT = 4;
+    static constexpr U32 SEGMENT_SIZE = 1024 * 1024;
+
+    LLStreamRing()
+    {
+        STOP_GLERROR;
+        glGenBuffers(1, &mGLBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, mGLBuffer);
+        LLVertexBuffer::sGLRenderBuffer = mGLBuffer;
+
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, SEGMENT_COUNT * SEGMENT_SIZE, nullptr, flags);
+        mData = (U8*)glMapBufferRange(GL_ARRAY_BUFFER, 0, SEGMENT_COUNT * SEGMENT_SIZE, flags);
+        STOP_GLERROR;
+    }
+
+    ~LLStreamRing()
+    {
+        if (mGLBuffer)
+        {
+            if (LLVertexBuffer::sGLRenderBuffer != mGLBuffer)
+            {
+                glBindBuffer(GL_ARRAY_BUFFER, mGLBuffer);
+            }
+            if (mData)
+            {
+                glUnmapBuffer(GL_ARRAY_BUFFER);
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            LLVertexBuffer::sGLRenderBuffer = 0;
+            glDeleteBuffers(1, &mGLBuffer);
+        }
+    }
+
+    bool isValid() const    { return mData != nullptr; }
+    U32 getGLBuffer() const { return mGLBuffer; }
+
+    // size bytes to write at the returned pointer, offset is where they are
+    // in the GL buffer
+    U8* allocate(U32 size, U32& offset)
+    {
+        if (size > SEGMENT_SIZE)
+        {
+            return nullptr;
+        }
+
+        if (mHead + size > (mSegment + 1) * SEGMENT_SIZE)
+        {
+            mFences[mSegment].placeFence();
+            mSegment = (mSegment + 1) % SEGMENT_COUNT;
+            mFences[mSegment].wait();
+            mHead = mSegment * SEGMENT_SIZE;
+        }
+
+        offset = mHead;
+        mHead += (size + 15) & ~15;
+        return mData + offset;
+    }
+
+private:
+    U32             mGLBuffer = 0;
+    U8*             mData = nullptr;
+    U32             mSegment = 0;
+    U32             mHead = 0;
+    LLGLSyncFence   mFences[SEGMENT_COUNT];
+};
+
+static LLStreamRing* sStreamRing = nullptr;
+static bool sStreamRingFailed = false;
+
+//static
+bool LLVertexBuffer::drawStreamed(U32 mode, U32 count, const LLVector4a* pos, const LLVector2* tc, const LLColor4U* colors)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VERTEX;
+    llassert(LLGLSLShader::sCurBoundShaderPtr);
+
+    const U32 data_mask = LLGLSLShader::sCurBoundShaderPtr->mAttributeMask;
+    if (!sUseStreamingRing || sStreamRingFailed || gGLManager.mIsApple || gGLManager.mGLVersion < 4.39f || !glBufferStorage ||
+        (data_mask & ~(MAP_VERTEX | MAP_TEXCOORD0 | MAP_COLOR)))
+    {
+        return false;
+    }
+
+    if (!sStreamRing)
+    {
+        sStreamRing = new LLStreamRing();
+        if (!sStreamRing->isValid())
+        {
+            LL_WARNS() << "Persistent mapping failed, streaming ring disabled" << LL_ENDL;
+            delete sStreamRing;
+            sStreamRing = nullptr;
+            sStreamRingFailed = true;
+            return false;
+        }
+    }
+
+    // non interleaved like LLVertexBuffer, each array 16 byte aligned
+    const U32 pos_size = count * sTypeSize[TYPE_VERTEX];
+    const U32 tc_size = (data_mask & MAP_TEXCOORD0) ? ((count * sTypeSize[TYPE_TEXCOORD0] + 15) & ~15) : 0;
+    const U32 color_size = (data_mask & MAP_COLOR) ? count * sTypeSize[TYPE_COLOR] : 0;
+
+    U32 offset = 0;
+    U8* dst = sStreamRing->allocate(pos_size + tc_size + color_size, offset);
+    if (!dst)
+    {
+        return false;
+    }
+
+    memcpy(dst, pos, pos_size);
+    if (tc_size)
+    {
+        memcpy(dst + pos_size, tc, count * sTypeSize[TYPE_TEXCOORD0]);
+    }
+    if (color_size)
+    {
+        memcpy(dst + pos_size + tc_size, colors, color_size);
+    }
+
+    STOP_GLERROR;
+    if (sGLRenderBuffer != sStreamRing->getGLBuffer())
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, sStreamRing->getGLBuffer());
+        sGLRenderBuffer = sStreamRing->getGLBuffer();
+    }
+
+    // the next LLVertexBuffer::setBuffer() sees another buffer bound and
+    // sets its own pointers up again
+    U8* base = nullptr;
+    glVertexAttribPointer(TYPE_VERTEX, 3, GL_FLOAT, GL_FALSE, sTypeSize[TYPE_VERTEX], (void*)(base + offset));
+    if (tc_size)
+    {
+        glVertexAttribPointer(TYPE_TEXCOORD0, 2, GL_FLOAT, GL_FALSE, sTypeSize[TYPE_TEXCOORD0], (void*)(base + offset + pos_size));
+    }
+    if (color_size)
+    {
+        glVertexAttribPointer(TYPE_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sTypeSize[TYPE_COLOR], (void*)(base + offset + pos_size + tc_size));
+    }
+
+    gGL.syncMatrices();
+    glDrawArrays(sGLMode[mode], 0, count);
+    STOP_GLERROR;
+
+    return true;
+}
+
+//static
+void LLVertexBuffer::cleanupStreaming()
+{
+    delete sStreamRing;
+    sStreamRing = nullptr;
+    sStreamRingFailed = false;
+}
+// </FS>
+
 //static
 void LLVertexBuffer::initClass(LLWindow* window)
 {
@@ -971,6 +1486,26 @@ void LLVertexBuffer::initClass(LLWindow* window)
     {
         LL_INFOS() << "VBO Pooling Enabled" << LL_ENDL;
         sVBOPool = new LLDefaultVBOPool();
+
+        // <FS> Geometry heap
+        if (sUseGeometryHeap)
+        {
+            LL_INFOS() << "VBO Heap Enabled" << LL_ENDL;
+            sVBOHeap = new LLVBOHeap();
+        }
+        // </FS>
+
+        // <FS> Render submit thread
+        // not on Intel, see RenderGLMultiThreadedTextures, nor on macOS where
+        // uploads go through glBufferData in _unmapBuffer
+#if !LL_DARWIN
+        if (sUseSubmitThread && gGLManager.mGLVersion > 3.95f && !gGLManager.mIsIntel)
+        {
+            LLGLSubmitThread::createInstance(window);
+            LL_INFOS() << "VBO Submit Thread " << (LLGLSubmitThread::getInstance()->isEnabled() ? "Enabled" : "Unavailable") << LL_ENDL;
+        }
+#endif
+        // </FS>
     }
 
 #if ENABLE_GL_WORK_QUEUE
@@ -998,11 +1533,26 @@ void LLVertexBuffer::unbind()
 //static
 void LLVertexBuffer::cleanupClass()
 {
+    cleanupStreaming(); // <FS/> Streaming ring buffer
+
+    // <FS> Render submit thread
+    if (LLGLSubmitThread::instanceExists())
+    {
+        LLGLSubmitThread::getInstance()->sync();
+        LLGLSubmitThread::deleteSingleton();
+    }
+    // </FS>
+
     unbind();
 
     delete sVBOPool;
     sVBOPool = nullptr;
 
+    // <FS> Geometry heap
+    delete sVBOHeap;
+    sVBOHeap = nullptr;
+    // </FS>
+
 #if ENABLE_GL_WORK_QUEUE
     sQueue->close();
     for (int i = 0; i < THREAD_COUNT; ++i)
@@ -1027,12 +1577,30 @@ LLVertexBuffer::LLVertexBuffer(U32 typemask)
     for (U32 i = 0; i < TYPE_MAX; i++)
     {
         mOffsets[i] = 0;
+        mGLOffsets[i] = 0; // <FS/> Packed vertex attributes
     }
+
+    // <FS> Packed vertex attributes, not on Apple where the whole buffer is
+    // sent in _unmapBuffer()
+    mPacked = sUsePackedAttributes && !gGLManager.mIsApple && (typemask & (MAP_NORMAL | MAP_TANGENT));
+    // </FS>
+
+    // <FS> VRAM accounting: the partition comes with a vertex buffer scope,
+    // other scopes only tell the owner
+    const LLVRAMTag& tag = LLVRAMAccounting::getCurrentTag();
+    mVRAMTag.mCategory = LLVRAMCategory::VERTEX_BUFFER;
+    mVRAMTag.mDetail = (tag.mCategory == LLVRAMCategory::VERTEX_BUFFER) ? tag.mDetail : 0;
+    mVRAMTag.mOwner = tag.mOwner;
+    // </FS>
 }
 
 // list of mapped buffers
 // NOTE: must not be LLPointer<LLVertexBuffer> to avoid breaking non-ref-counted LLVertexBuffer instances
 static std::vector<LLVertexBuffer*> sMappedBuffers;
+// <FS> Buffers may be mapped by geometry fill jobs, each job owns its buffers
+// but the list is shared
+static std::mutex sMappedBuffersMutex;
+// </FS>
 
 //static
 void LLVertexBuffer::flushBuffers()
@@ -1049,7 +1617,7 @@ void LLVertexBuffer::flushBuffers()
 }
 
 //static
-U32 LLVertexBuffer::calcOffsets(const U32& typemask, U32* offsets, U32 num_vertices)
+U32 LLVertexBuffer::calcOffsets(const U32& typemask, U32* offsets, U32 num_vertices, const U32* type_size)
 {
     U32 offset = 0;
     for (U32 i=0; i<TYPE_TEXTURE_INDEX; i++)
@@ -1057,10 +1625,10 @@ U32 LLVertexBuffer::calcOffsets(const U32& typemask, U32* offsets, U32 num_verti
         U32 mask = 1<<i;
         if (typemask & mask)
         {
-            if (offsets && LLVertexBuffer::sTypeSize[i])
+            if (offsets && type_size[i])
             {
                 offsets[i] = offset;
-                offset += LLVertexBuffer::sTypeSize[i]*num_vertices;
+                offset += type_size[i]*num_vertices;
                 offset = (offset + 0xF) & ~0xF;
             }
         }
@@ -1100,6 +1668,13 @@ LLVertexBuffer::~LLVertexBuffer()
     destroyGLBuffer();
     destroyGLIndices();
 
+    // <FS> Geometry heap
+    if (sSetupBuffer == this)
+    {
+        sSetupBuffer = nullptr;
+    }
+    // </FS>
+
     if (mMappedData)
     {
         LL_ERRS() << "Failed to clear vertex buffer's vertices" << LL_ENDL;
@@ -1112,7 +1687,7 @@ LLVertexBuffer::~LLVertexBuffer()
 
 //----------------------------------------------------------------------------
 
-void LLVertexBuffer::genBuffer(U32 size)
+void LLVertexBuffer::genBuffer(U32 size, U32 gl_size)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VERTEX;
     llassert(sVBOPool);
@@ -1124,7 +1699,29 @@ void LLVertexBuffer::genBuffer(U32 size)
         llassert(mMappedData == nullptr);
 
         mSize = size;
-        sVBOPool->allocate(GL_ARRAY_BUFFER, mSize, mGLBuffer, mMappedData);
+        // <FS> Packed vertex attributes: the pool provides the packed GL
+        // buffer and its staging copy, the full float copy is our own
+        //sVBOPool->allocate(GL_ARRAY_BUFFER, mSize, mGLBuffer, mMappedData);
+        if (mPacked)
+        {
+            mGLSize = gl_size;
+            //sVBOPool->allocate(GL_ARRAY_BUFFER, mGLSize, mGLBuffer, mPackedData);
+            allocate_gl(GL_ARRAY_BUFFER, mGLSize, mGLBuffer, mGLOffset, mPackedData, mHeapVertex);
+            mMappedData = (U8*)ll_aligned_malloc_16(mSize);
+        }
+        else
+        {
+            //sVBOPool->allocate(GL_ARRAY_BUFFER, mSize, mGLBuffer, mMappedData);
+            allocate_gl(GL_ARRAY_BUFFER, mSize, mGLBuffer, mGLOffset, mMappedData, mHeapVertex);
+        }
+        // </FS>
+
+        // <FS> VRAM accounting, released by destroyGLBuffer() on the same condition
+        if (mGLBuffer || mMappedData)
+        {
+            LLVRAMAccounting::claim(mVRAMTag, mPacked ? mGLSize : mSize);
+        }
+        // </FS>
     }
 }
 
@@ -1139,11 +1736,21 @@ void LLVertexBuffer::genIndices(U32 size)
         llassert(mGLIndices == 0);
         llassert(mMappedIndexData == nullptr);
         mIndicesSize = size;
-        sVBOPool->allocate(GL_ELEMENT_ARRAY_BUFFER, mIndicesSize, mGLIndices, mMappedIndexData);
+        // <FS> Geometry heap
+        //sVBOPool->allocate(GL_ELEMENT_ARRAY_BUFFER, mIndicesSize, mGLIndices, mMappedIndexData);
+        allocate_gl(GL_ELEMENT_ARRAY_BUFFER, mIndicesSize, mGLIndices, mGLIndicesOffset, mMappedIndexData, mHeapIndices);
+        // </FS>
+
+        // <FS> VRAM accounting, released by destroyGLIndices() on the same condition
+        if (mGLIndices || mMappedIndexData)
+        {
+            LLVRAMAccounting::claim(mVRAMTag, mIndicesSize);
+        }
+        // </FS>
     }
 }
 
-bool LLVertexBuffer::createGLBuffer(U32 size)
+bool LLVertexBuffer::createGLBuffer(U32 size, U32 gl_size)
 {
     if (mGLBuffer || mMappedData)
     {
@@ -1157,7 +1764,7 @@ bool LLVertexBuffer::createGLBuffer(U32 size)
 
     bool success = true;
 
-    genBuffer(size);
+    genBuffer(size, gl_size);
 
     if (!mMappedData)
     {
@@ -1194,12 +1801,49 @@ void LLVertexBuffer::destroyGLBuffer()
     if (mGLBuffer || mMappedData)
     {
         LL_PROFILE_ZONE_SCOPED_CATEGORY_VERTEX;
+        // <FS> Render submit thread, a late upload must not land in the
+        // range once it is handed out again
+        if (LLGLSubmitThread* thread = get_submit_thread())
+        {
+            thread->waitFor(mSubmitSequence);
+        }
+        // </FS>
+        LLVRAMAccounting::disclaim(mVRAMTag, mPacked ? mGLSize : mSize); // <FS/> VRAM accounting
         //llassert(sVBOPool);
-        if (sVBOPool)
+        // <FS> Packed vertex attributes
+        //if (sVBOPool)
+        //{
+        //    sVBOPool->free(GL_ARRAY_BUFFER, mSize, mGLBuffer, mMappedData);
+        //}
+        if (mPacked)
+        {
+            if (sVBOPool && mPackedData)
+            {
+                //sVBOPool->free(GL_ARRAY_BUFFER, mGLSize, mGLBuffer, mPackedData);
+                free_gl(GL_ARRAY_BUFFER, mGLSize, mGLBuffer, mGLOffset, mPackedData, mHeapVertex); // <FS/> Geometry heap
+            }
+            if (mMappedData)
+            {
+                ll_aligned_free_16(mMappedData);
+            }
+            mGLSize = 0;
+            mPackedData = nullptr;
+        }
+        else if (sVBOPool)
         {
-            sVBOPool->free(GL_ARRAY_BUFFER, mSize, mGLBuffer, mMappedData);
+            //sVBOPool->free(GL_ARRAY_BUFFER, mSize, mGLBuffer, mMappedData);
+            free_gl(GL_ARRAY_BUFFER, mSize, mGLBuffer, mGLOffset, mMappedData, mHeapVertex); // <FS/> Geometry heap
         }
 
+        // Geometry heap, a new block may land at other offsets of the same buffer
+        mGLOffset = 0;
+        mHeapVertex = false;
+        if (sSetupBuffer == this)
+        {
+            sSetupBuffer = nullptr;
+        }
+        // </FS>
+
         mSize = 0;
         mGLBuffer = 0;
         mMappedData = nullptr;
@@ -1211,11 +1855,23 @@ void LLVertexBuffer::destroyGLIndices()
     if (mGLIndices || mMappedIndexData)
     {
         LL_PROFILE_ZONE_SCOPED_CATEGORY_VERTEX;
+        // <FS> Render submit thread
+        if (LLGLSubmitThread* thread = get_submit_thread())
+        {
+            thread->waitFor(mSubmitSequence);
+        }
+        // </FS>
+        LLVRAMAccounting::disclaim(mVRAMTag, mIndicesSize); // <FS/> VRAM accounting
         //llassert(sVBOPool);
         if (sVBOPool)
         {
-            sVBOPool->free(GL_ELEMENT_ARRAY_BUFFER, mIndicesSize, mGLIndices, mMappedIndexData);
+            // <FS> Geometry heap
+            //sVBOPool->free(GL_ELEMENT_ARRAY_BUFFER, mIndicesSize, mGLIndices, mMappedIndexData);
+            free_gl(GL_ELEMENT_ARRAY_BUFFER, mIndicesSize, mGLIndices, mGLIndicesOffset, mMappedIndexData, mHeapIndices);
+            // </FS>
         }
+        mGLIndicesOffset = 0; // <FS/> Geometry heap
+        mHeapIndices = false; // <FS/> Geometry heap
 
         mIndicesSize = 0;
         mGLIndices = 0;
@@ -1231,10 +1887,18 @@ bool LLVertexBuffer::updateNumVerts(U32 nverts)
 
     U32 needed_size = calcOffsets(mTypeMask, mOffsets, nverts);
 
+    // <FS> Packed vertex attributes
+    //if (needed_size != mSize)
+    //{
+    //    success &= createGLBuffer(needed_size);
+    //}
+    U32 gl_size = mPacked ? calcOffsets(mTypeMask, mGLOffsets, nverts, sPackedTypeSize) : 0;
+
     if (needed_size != mSize)
     {
-        success &= createGLBuffer(needed_size);
+        success &= createGLBuffer(needed_size, gl_size);
     }
+    // </FS>
 
     llassert(mSize == needed_size);
     mNumVerts = nverts;
@@ -1369,6 +2033,16 @@ U8* LLVertexBuffer::mapIndexBuffer(U32 index, S32 count)
     return mMappedIndexData + sizeof(U16)*index;
 }
 
+// <FS> Render submit thread
+// The submit thread when called from the main thread, uploads and binds from
+// other threads never go through it
+static LLGLSubmitThread* get_submit_thread()
+{
+    LLGLSubmitThread* thread = LLGLSubmitThread::getInstance();
+    return thread && thread->isEnabled() && on_main_thread() ? thread : nullptr;
+}
+// </FS>
+
 // flush the given byte range
 //  target -- "target" parameter for glBufferSubData
 //  start -- first byte to copy
@@ -1391,6 +2065,17 @@ void LLVertexBuffer::flush_vbo(GLenum target, U32 start, U32 end, void* data, U8
     {
         llassert(target == GL_ARRAY_BUFFER ? sGLRenderBuffer == mGLBuffer : sGLRenderIndices == mGLIndices);
 
+        // <FS> Packed vertex attributes
+        if (mPacked && target == GL_ARRAY_BUFFER)
+        {
+            if (end != 0)
+            {
+                flush_packed(start, end, (const U8*)data);
+            }
+            return;
+        }
+        // </FS>
+
         // skip mapped data and stream to GPU via glBufferSubData
         if (end != 0)
         {
@@ -1399,6 +2084,19 @@ void LLVertexBuffer::flush_vbo(GLenum target, U32 start, U32 end, void* data, U8
             LL_PROFILE_ZONE_NUM(end);
             LL_PROFILE_ZONE_NUM(end-start);
 
+            // <FS> Render submit thread
+            if (LLGLSubmitThread* thread = get_submit_thread())
+            {
+                if (thread->isRecording())
+                {
+                    const U32 gl_offset = target == GL_ARRAY_BUFFER ? mGLOffset : mGLIndicesOffset;
+                    mSubmitSequence = thread->upload(target == GL_ARRAY_BUFFER ? mGLBuffer : mGLIndices, gl_offset + start, end - start + 1, data);
+                    return;
+                }
+                thread->waitFor(mSubmitSequence);
+            }
+            // </FS>
+
             constexpr U32 block_size = 65536;
 
             for (U32 i = start; i <= end; i += block_size)
@@ -1407,12 +2105,76 @@ void LLVertexBuffer::flush_vbo(GLenum target, U32 start, U32 end, void* data, U8
                 //LL_PROFILE_GPU_ZONE("glBufferSubData");
                 U32 tend = llmin(i + block_size, end);
                 U32 size = tend - i + 1;
-                glBufferSubData(target, i, size, (U8*) data + (i-start));
+                // <FS> Geometry heap
+                //glBufferSubData(target, i, size, (U8*) data + (i-start));
+                const U32 gl_offset = target == GL_ARRAY_BUFFER ? mGLOffset : mGLIndicesOffset;
+                glBufferSubData(target, gl_offset + i, size, (U8*) data + (i-start));
+                // </FS>
             }
         }
     }
 }
 
+// <FS> Packed vertex attributes
+// Converts the given byte range of the full float layout into the packed
+// layout and streams it to the GL buffer, one attribute at a time
+//  start -- first byte to copy, in mMappedData layout
+//  end -- last byte to copy (NOT last byte + 1)
+//  data -- data to be flushed
+void LLVertexBuffer::flush_packed(U32 start, U32 end, const U8* data)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VERTEX;
+    for (U32 type = 0; type < TYPE_TEXTURE_INDEX; ++type)
+    {
+        const U32 size = sTypeSize[type];
+        if (!(mTypeMask & (1 << type)) || !size || !mNumVerts)
+        {
+            continue;
+        }
+
+        const U32 attrib_start = mOffsets[type];
+        const U32 attrib_end = attrib_start + size * mNumVerts - 1;
+        if (end < attrib_start || start > attrib_end)
+        {
+            continue;
+        }
+
+        // mapped ranges cover whole vertices of an attribute
+        const U32 first = (llmax(start, attrib_start) - attrib_start + size - 1) / size;
+        const U32 last = (llmin(end, attrib_end) - attrib_start + 1) / size;
+        if (last <= first)
+        {
+            continue;
+        }
+
+        const U32 count = last - first;
+        const U32 packed_size = sPackedTypeSize[type];
+        const U8* src = data + (attrib_start + first * size - start);
+        U8* dst = mPackedData + mGLOffsets[type] + first * packed_size;
+        if (packed_size == size)
+        {
+            memcpy(dst, src, count * size);
+        }
+        else
+        {
+            pack_snorm_2_10_10_10(src, dst, count);
+        }
+
+        LLGLSubmitThread* thread = get_submit_thread();
+        if (thread && thread->isRecording())
+        {
+            mSubmitSequence = thread->upload(mGLBuffer, mGLOffset + mGLOffsets[type] + first * packed_size, count * packed_size, dst);
+            continue;
+        }
+        if (thread)
+        {
+            thread->waitFor(mSubmitSequence);
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, mGLOffset + mGLOffsets[type] + first * packed_size, count * packed_size, dst);
+    }
+}
+// </FS>
+
 void LLVertexBuffer::unmapBuffer()
 {
     flushBuffers();
@@ -1423,7 +2185,11 @@ void LLVertexBuffer::_mapBuffer()
     if (!mMapped)
     {
         mMapped = true;
+        // <FS> Geometry fill jobs map buffers off the main thread
+        //sMappedBuffers.push_back(this);
+        std::lock_guard<std::mutex> lock(sMappedBuffersMutex);
         sMappedBuffers.push_back(this);
+        // </FS>
     }
 }
 
@@ -1692,6 +2458,13 @@ void LLVertexBuffer::setBuffer()
         _unmapBuffer();
     }
 
+    // <FS> Render submit thread, uploads to this buffer may still be in flight
+    if (LLGLSubmitThread* thread = get_submit_thread())
+    {
+        thread->waitFor(mSubmitSequence);
+    }
+    // </FS>
+
     // no data may be pending
     llassert(mMappedVertexRegions.empty());
     llassert(mMappedIndexRegions.empty());
@@ -1713,7 +2486,10 @@ void LLVertexBuffer::setBuffer()
 
         setupVertexBuffer();
     }
-    else if (sLastMask != data_mask)
+    // <FS> Geometry heap, another block of the same GL buffer was set up
+    //else if (sLastMask != data_mask)
+    else if (sLastMask != data_mask || (mHeapVertex && sSetupBuffer != this))
+    // </FS>
     {
         setupVertexBuffer();
         sLastMask = data_mask;
@@ -1733,100 +2509,122 @@ void LLVertexBuffer::setBuffer()
 void LLVertexBuffer::setupVertexBuffer()
 {
     STOP_GLERROR;
-    U8* base = nullptr;
+    // <FS> Geometry heap
+    //U8* base = nullptr;
+    U8* base = reinterpret_cast<U8*>((size_t)mGLOffset);
+    sSetupBuffer = this;
+    // </FS>
 
     U32 data_mask = LLGLSLShader::sCurBoundShaderPtr->mAttributeMask;
 
+    // <FS> Packed vertex attributes
+    const U32* offsets = mPacked ? mGLOffsets : mOffsets;
+    const U32* type_size = mPacked ? sPackedTypeSize : sTypeSize;
+    // </FS>
+
     if (data_mask & MAP_NORMAL)
     {
         AttributeType loc = TYPE_NORMAL;
-        void* ptr = (void*)(base + mOffsets[TYPE_NORMAL]);
-        glVertexAttribPointer(loc, 3, GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_NORMAL], ptr);
+        void* ptr = (void*)(base + offsets[TYPE_NORMAL]);
+        // <FS> Packed vertex attributes
+        //glVertexAttribPointer(loc, 3, GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_NORMAL], ptr);
+        if (mPacked)
+        {
+            glVertexAttribPointer(loc, 4, GL_INT_2_10_10_10_REV, GL_TRUE, type_size[TYPE_NORMAL], ptr);
+        }
+        else
+        {
+            glVertexAttribPointer(loc, 3, GL_FLOAT, GL_FALSE, type_size[TYPE_NORMAL], ptr);
+        }
+        // </FS>
     }
     if (data_mask & MAP_TEXCOORD3)
     {
         AttributeType loc = TYPE_TEXCOORD3;
-        void* ptr = (void*)(base + mOffsets[TYPE_TEXCOORD3]);
-        glVertexAttribPointer(loc, 2, GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD3], ptr);
+        void* ptr = (void*)(base + offsets[TYPE_TEXCOORD3]);
+        glVertexAttribPointer(loc, 2, GL_FLOAT, GL_FALSE, type_size[TYPE_TEXCOORD3], ptr);
     }
     if (data_mask & MAP_TEXCOORD2)
     {
         AttributeType loc = TYPE_TEXCOORD2;
-        void* ptr = (void*)(base + mOffsets[TYPE_TEXCOORD2]);
-        glVertexAttribPointer(loc, 2, GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD2], ptr);
+        void* ptr = (void*)(base + offsets[TYPE_TEXCOORD2]);
+        glVertexAttribPointer(loc, 2, GL_FLOAT, GL_FALSE, type_size[TYPE_TEXCOORD2], ptr);
     }
     if (data_mask & MAP_TEXCOORD1)
     {
         AttributeType loc = TYPE_TEXCOORD1;
-        void* ptr = (void*)(base + mOffsets[TYPE_TEXCOORD1]);
-        glVertexAttribPointer(loc, 2, GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD1], ptr);
+        void* ptr = (void*)(base + offsets[TYPE_TEXCOORD1]);
+        glVertexAttribPointer(loc, 2, GL_FLOAT, GL_FALSE, type_size[TYPE_TEXCOORD1], ptr);
     }
     if (data_mask & MAP_TANGENT)
     {
         AttributeType loc = TYPE_TANGENT;
-        void* ptr = (void*)(base + mOffsets[TYPE_TANGENT]);
-        glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_TANGENT], ptr);
+        void* ptr = (void*)(base + offsets[TYPE_TANGENT]);
+        // <FS> Packed vertex attributes
+        //glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_TANGENT], ptr);
+        glVertexAttribPointer(loc, 4, mPacked ? GL_INT_2_10_10_10_REV : GL_FLOAT, mPacked ? GL_TRUE : GL_FALSE, type_size[TYPE_TANGENT], ptr);
+        // </FS>
     }
     if (data_mask & MAP_TEXCOORD0)
     {
         AttributeType loc = TYPE_TEXCOORD0;
-        void* ptr = (void*)(base + mOffsets[TYPE_TEXCOORD0]);
-        glVertexAttribPointer(loc, 2, GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_TEXCOORD0], ptr);
+        void* ptr = (void*)(base + offsets[TYPE_TEXCOORD0]);
+        glVertexAttribPointer(loc, 2, GL_FLOAT, GL_FALSE, type_size[TYPE_TEXCOORD0], ptr);
     }
     if (data_mask & MAP_COLOR)
     {
         AttributeType loc = TYPE_COLOR;
         //bind emissive instead of color pointer if emissive is present
-        void* ptr = (data_mask & MAP_EMISSIVE) ? (void*)(base + mOffsets[TYPE_EMISSIVE]) : (void*)(base + mOffsets[TYPE_COLOR]);
-        glVertexAttribPointer(loc, 4, GL_UNSIGNED_BYTE, GL_TRUE, LLVertexBuffer::sTypeSize[TYPE_COLOR], ptr);
+        void* ptr = (data_mask & MAP_EMISSIVE) ? (void*)(base + offsets[TYPE_EMISSIVE]) : (void*)(base + offsets[TYPE_COLOR]);
+        glVertexAttribPointer(loc, 4, GL_UNSIGNED_BYTE, GL_TRUE, type_size[TYPE_COLOR], ptr);
     }
     if (data_mask & MAP_EMISSIVE)
     {
         AttributeType loc = TYPE_EMISSIVE;
-        void* ptr = (void*)(base + mOffsets[TYPE_EMISSIVE]);
-        glVertexAttribPointer(loc, 4, GL_UNSIGNED_BYTE, GL_TRUE, LLVertexBuffer::sTypeSize[TYPE_EMISSIVE], ptr);
+        void* ptr = (void*)(base + offsets[TYPE_EMISSIVE]);
+        glVertexAttribPointer(loc, 4, GL_UNSIGNED_BYTE, GL_TRUE, type_size[TYPE_EMISSIVE], ptr);
 
         if (!(data_mask & MAP_COLOR))
         { //map emissive to color channel when color is not also being bound to avoid unnecessary shader swaps
             loc = TYPE_COLOR;
-            glVertexAttribPointer(loc, 4, GL_UNSIGNED_BYTE, GL_TRUE, LLVertexBuffer::sTypeSize[TYPE_EMISSIVE], ptr);
+            glVertexAttribPointer(loc, 4, GL_UNSIGNED_BYTE, GL_TRUE, type_size[TYPE_EMISSIVE], ptr);
         }
     }
     if (data_mask & MAP_WEIGHT)
     {
         AttributeType loc = TYPE_WEIGHT;
-        void* ptr = (void*)(base + mOffsets[TYPE_WEIGHT]);
-        glVertexAttribPointer(loc, 1, GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_WEIGHT], ptr);
+        void* ptr = (void*)(base + offsets[TYPE_WEIGHT]);
+        glVertexAttribPointer(loc, 1, GL_FLOAT, GL_FALSE, type_size[TYPE_WEIGHT], ptr);
     }
     if (data_mask & MAP_WEIGHT4)
     {
         AttributeType loc = TYPE_WEIGHT4;
-        void* ptr = (void*)(base + mOffsets[TYPE_WEIGHT4]);
-        glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_WEIGHT4], ptr);
+        void* ptr = (void*)(base + offsets[TYPE_WEIGHT4]);
+        glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, type_size[TYPE_WEIGHT4], ptr);
     }
     if (data_mask & MAP_JOINT)
     {
         AttributeType loc = TYPE_JOINT;
-        void* ptr = (void*)(base + mOffsets[TYPE_JOINT]);
-        glVertexAttribIPointer(loc, 4, GL_UNSIGNED_SHORT, LLVertexBuffer::sTypeSize[TYPE_JOINT], ptr);
+        void* ptr = (void*)(base + offsets[TYPE_JOINT]);
+        glVertexAttribIPointer(loc, 4, GL_UNSIGNED_SHORT, type_size[TYPE_JOINT], ptr);
     }
     if (data_mask & MAP_CLOTHWEIGHT)
     {
         AttributeType loc = TYPE_CLOTHWEIGHT;
-        void* ptr = (void*)(base + mOffsets[TYPE_CLOTHWEIGHT]);
-        glVertexAttribPointer(loc, 4, GL_FLOAT, GL_TRUE, LLVertexBuffer::sTypeSize[TYPE_CLOTHWEIGHT], ptr);
+        void* ptr = (void*)(base + offsets[TYPE_CLOTHWEIGHT]);
+        glVertexAttribPointer(loc, 4, GL_FLOAT, GL_TRUE, type_size[TYPE_CLOTHWEIGHT], ptr);
     }
     if (data_mask & MAP_TEXTURE_INDEX)
     {
         AttributeType loc = TYPE_TEXTURE_INDEX;
-        void* ptr = (void*)(base + mOffsets[TYPE_VERTEX] + 12);
-        glVertexAttribIPointer(loc, 1, GL_UNSIGNED_INT, LLVertexBuffer::sTypeSize[TYPE_VERTEX], ptr);
+        void* ptr = (void*)(base + offsets[TYPE_VERTEX] + 12);
+        glVertexAttribIPointer(loc, 1, GL_UNSIGNED_INT, type_size[TYPE_VERTEX], ptr);
     }
     if (data_mask & MAP_VERTEX)
     {
         AttributeType loc = TYPE_VERTEX;
-        void* ptr = (void*)(base + mOffsets[TYPE_VERTEX]);
-        glVertexAttribPointer(loc, 3, GL_FLOAT, GL_FALSE, LLVertexBuffer::sTypeSize[TYPE_VERTEX], ptr);
+        void* ptr = (void*)(base + offsets[TYPE_VERTEX]);
+        glVertexAttribPointer(loc, 3, GL_FLOAT, GL_FALSE, type_size[TYPE_VERTEX], ptr);
     }
     STOP_GLERROR;
 }
@@ -1946,3 +2744,168 @@ void LLVertexBuffer::setIndexData(const U32* data, U32 offset, U32 count)
 
 
 
+
+// <FS> Render submit thread
+LLGLSubmitThread::LLGLSubmitThread(LLWindow* window)
+    // We want exactly one thread, uploads must land in the order recorded
+    : LL::ThreadPool("LLGLSubmit", 1)
+    , mWindow(window)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VERTEX;
+
+    // Without a shared context (SDL1) every upload stays on the main thread
+    mContext = mWindow->createSharedContext();
+    if (mContext)
+    {
+        LL::ThreadPool::start();
+    }
+}
+
+LLGLSubmitThread::~LLGLSubmitThread()
+{
+    // the thread publishes until the queue is drained
+    close();
+    if (mIssuedFence)
+    {
+        glDeleteSync(mIssuedFence);
+    }
+}
+
+void LLGLSubmitThread::run()
+{
+    mWindow->makeContextCurrent(mContext);
+    LL_PROFILER_GPU_CONTEXT_NS("LLGLSubmit Context", 19);
+    LL::ThreadPool::run();
+    mWindow->destroySharedContext(mContext);
+}
+
+void LLGLSubmitThread::beginRecording()
+{
+    mRecording = isEnabled();
+}
+
+U64 LLGLSubmitThread::upload(GLuint buffer, U32 offset, U32 size, const void* data)
+{
+    if (!mRecorded)
+    {
+        mRecorded = std::make_shared<CommandList>();
+        mRecorded->mFirstSequence = mNextSequence;
+    }
+
+    Upload upload;
+    upload.mBuffer = buffer;
+    upload.mOffset = offset;
+    upload.mSize = size;
+    upload.mData = mRecorded->mData.size();
+    mRecorded->mUploads.push_back(upload);
+
+    const U8* src = (const U8*)data;
+    mRecorded->mData.insert(mRecorded->mData.end(), src, src + size);
+    return mNextSequence++;
+}
+
+void LLGLSubmitThread::submit()
+{
+    mRecording = false;
+    flushRecorded();
+}
+
+void LLGLSubmitThread::flushRecorded()
+{
+    if (!mRecorded || mRecorded->mUploads.empty())
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VERTEX;
+
+    std::shared_ptr<CommandList> list = std::move(mRecorded);
+    mRecorded.reset();
+
+    // the buffers were allocated, and may still be drawn from, by commands of the main context
+    list->mReady = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    if (!getQueue().post([this, list]() { execute(*list); }))
+    { // shutting down, upload from here
+        execute(*list);
+    }
+}
+
+void LLGLSubmitThread::waitFor(U64 sequence)
+{
+    if (sequence <= mWaitedSequence)
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VERTEX;
+
+    if (mRecorded && sequence >= mRecorded->mFirstSequence)
+    { // still only recorded
+        flushRecorded();
+    }
+
+    // Only blocks until the thread has issued the upload; the queue drains
+    // even when it is closed, so this always comes back
+    std::unique_lock<std::mutex> lock(mIssuedMutex);
+    mIssuedCondition.wait(lock, [this, sequence]() { return mIssuedSequence >= sequence; });
+
+    // a GPU side wait, the main thread goes on
+    glWaitSync(mIssuedFence, 0, GL_TIMEOUT_IGNORED);
+    mWaitedSequence = mIssuedSequence;
+}
+
+void LLGLSubmitThread::execute(CommandList& list)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VERTEX;
+
+    // Publish a fence every so many uploads so that the main thread can go
+    // on with the buffers at the start of the list while the rest uploads
+    constexpr size_t PUBLISH_INTERVAL = 32;
+
+    glWaitSync(list.mReady, 0, GL_TIMEOUT_IGNORED);
+    glDeleteSync(list.mReady);
+
+    // not GL_ARRAY_BUFFER, an element array binding would need a vertex array object here
+    GLuint bound = 0;
+    for (size_t i = 0, count = list.mUploads.size(); i < count; ++i)
+    {
+        const Upload& upload = list.mUploads[i];
+        if (upload.mBuffer != bound)
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, upload.mBuffer);
+            bound = upload.mBuffer;
+        }
+        glBufferSubData(GL_COPY_WRITE_BUFFER, upload.mOffset, upload.mSize, list.mData.data() + upload.mData);
+
+        if ((i + 1) % PUBLISH_INTERVAL == 0 || i + 1 == count)
+        {
+            publish(list.mFirstSequence + i);
+        }
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void LLGLSubmitThread::publish(U64 sequence)
+{
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // the main context can only wait on a fence that was flushed
+    glFlush();
+
+    GLsync previous = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mIssuedMutex);
+        previous = mIssuedFence;
+        mIssuedFence = fence;
+        mIssuedSequence = sequence;
+    }
+    mIssuedCondition.notify_all();
+
+    // waits already placed on it keep it alive until they are done
+    if (previous)
+    {
+        glDeleteSync(previous);
+    }
+}
+// </FS>
@@ -39,6 +39,12 @@
 #include <vector>
 #include <list>
 #include <glm/gtc/matrix_transform.hpp>
+// <FS> Render submit thread
+#include "llsingleton.h"
+#include "threadpool.h"
+#include <condition_variable>
+// </FS>
+#include "llvramaccounting.h" // <FS/> VRAM accounting
 
 #define LL_MAX_VERTEX_ATTRIB_LOCATION 64
 
@@ -115,6 +121,15 @@ public:
     static void drawArrays(U32 mode, const std::vector<LLVector3>& pos);
     static void drawElements(U32 mode, const LLVector4a* pos, const LLVector2* tc, U32 num_indices, const U16* indicesp);
 
+    // <FS> Streaming ring buffer
+    // Copy count vertices into the persistently mapped streaming ring and
+    // draw them with the bound shader. Returns false, having drawn nothing,
+    // when the ring is disabled, unsupported or the shader wants attributes
+    // other than position, texcoord0 and color.
+    static bool drawStreamed(U32 mode, U32 count, const LLVector4a* pos, const LLVector2* tc, const LLColor4U* colors);
+    static void cleanupStreaming();
+    // </FS>
+
     static void unbind(); //unbind any bound vertex buffer
 
     //get the size of a vertex with the given typemask
@@ -123,7 +138,7 @@ public:
     //get the size of a buffer with the given typemask and vertex count
     //fill offsets with the offset of each vertex component array into the buffer
     // indexed by the following enum
-    static U32 calcOffsets(const U32& typemask, U32* offsets, U32 num_vertices);
+    static U32 calcOffsets(const U32& typemask, U32* offsets, U32 num_vertices, const U32* type_size = sTypeSize);
 
     // flush any pending mapped buffers
     static void flushBuffers();
@@ -180,9 +195,9 @@ protected:
 
     void setupVertexBuffer();
 
-    void    genBuffer(U32 size);
+    void    genBuffer(U32 size, U32 gl_size = 0);
     void    genIndices(U32 size);
-    bool    createGLBuffer(U32 size);
+    bool    createGLBuffer(U32 size, U32 gl_size = 0);
     bool    createGLIndices(U32 size);
     void    destroyGLBuffer();
     void    destroyGLIndices();
@@ -269,6 +284,7 @@ public:
     U8* getMappedData() const               { return mMappedData; }
     U8* getMappedIndices() const            { return mMappedIndexData; }
     U32 getOffset(AttributeType type) const { return mOffsets[type]; }
+    bool isPacked() const                   { return mPacked; } // <FS/> Packed vertex attributes
 
     // these functions assume (and assert on) the current VBO being bound
     // Detailed error checking can be enabled by setting gDebugGL to true
@@ -280,6 +296,28 @@ public:
     // since the last call to syncMatrices, this is much faster than drawRange
     void drawRangeFast(U32 mode, U32 start, U32 end, U32 count, U32 indices_offset) const;
 
+    // <FS> Multi-draw batching
+    // draw several index ranges of this buffer in one glMultiDrawElements call
+    void drawRanges(U32 mode, const U32* counts, const U32* indices_offsets, U32 draw_count) const;
+    // </FS>
+
+    // <FS> Mesh instancing
+    // draw count indices instance_count times, gl_InstanceID counting up from 0
+    void drawInstanced(U32 mode, U32 count, U32 indices_offset, U32 instance_count) const;
+    // </FS>
+
+    // <FS> GPU terrain
+    // drawRanges() with base_vertices[i] added to every index of range i
+    void drawRangesBaseVertex(U32 mode, const U32* counts, const U32* indices_offsets, const S32* base_vertices, U32 draw_count) const;
+    // </FS>
+
+    // <FS> Pre-skinned shadows
+    // drawRange() with the positions of vertices [start, end] read from the GL buffer
+    // positions at byte offset positions_offset, 16 bytes apart, in place of this buffer's.
+    // The bound shader may read nothing but positions. Leaves no vertex buffer set up.
+    void drawRangeWithPositions(U32 mode, U32 start, U32 end, U32 count, U32 indices_offset, U32 positions, U32 positions_offset) const;
+    // </FS>
+
     //for debugging, validate data in given range is valid
     bool validateRange(U32 start, U32 end, U32 count, U32 offset) const;
 
@@ -309,6 +347,25 @@ protected:
     std::vector<MappedRegion> mMappedVertexRegions;  // list of mMappedData byte ranges that must be sent to GL
     std::vector<MappedRegion> mMappedIndexRegions;   // list of mMappedIndexData byte ranges that must be sent to GL
 
+    // <FS> Packed vertex attributes: the GL buffer stores normals and tangents
+    // as GL_INT_2_10_10_10_REV. mMappedData keeps the full float layout the
+    // striders write to and is converted into mPackedData on upload.
+    bool    mPacked = false;
+    U32     mGLOffsets[TYPE_MAX];   // byte offsets into the GL buffer of each attribute
+    U32     mGLSize = 0;            // size in bytes of the GL buffer
+    U8*     mPackedData = nullptr;  // staging copy of the GL buffer
+    // </FS>
+
+    // <FS> Geometry heap: blocks of a shared GL buffer start at these byte offsets
+    U32     mGLOffset = 0;
+    U32     mGLIndicesOffset = 0;
+    bool    mHeapVertex = false;
+    bool    mHeapIndices = false;
+    // </FS>
+
+    LLVRAMTag mVRAMTag; // <FS/> VRAM accounting, taken from the scope the buffer was created in
+    U64 mSubmitSequence = 0; // <FS/> Render submit thread, last upload of this buffer sent through the thread
+
 private:
     // DEPRECATED
     // These function signatures are deprecated, but for some reason
@@ -319,6 +376,7 @@ private:
     friend class LLNavMeshVBOManager;
 
     void flush_vbo(GLenum target, U32 start, U32 end, void* data, U8* dst);
+    void flush_packed(U32 start, U32 end, const U8* data); // <FS/> Packed vertex attributes
 
     LLVertexBuffer(U32 typemask, U32 usage)
         : LLVertexBuffer(typemask)
@@ -337,6 +395,11 @@ public:
 
     static U64 getBytesAllocated();
     static const U32 sTypeSize[TYPE_MAX];
+    static const U32 sPackedTypeSize[TYPE_MAX]; // <FS/> Packed vertex attributes
+    static bool sUsePackedAttributes;           // <FS/> Packed vertex attributes for buffers created from now on
+    static bool sUseStreamingRing;              // <FS/> Streaming ring buffer for immediate mode geometry
+    static bool sUseGeometryHeap;               // <FS/> Geometry heap, read by initClass()
+    static bool sUseSubmitThread;               // <FS/> Render submit thread, read by initClass()
     static const U32 sGLMode[LLRender::NUM_MODES];
     static U32 sGLRenderBuffer;
     static U32 sGLRenderIndices;
@@ -344,6 +407,90 @@ public:
     static U32 sVertexCount;
 };
 
+// <FS> Render submit thread
+// Sends the GL buffer uploads of geometry rebuilds from a thread of its own,
+// on a context shared with the main one. While the main thread records (see
+// beginRecording()) LLVertexBuffer queues its uploads, with a copy of their
+// data, in a command list instead of calling glBufferSubData. submit() hands
+// the list to the thread, which runs it behind a fence of the main context
+// while the main thread goes on with the frame.
+// Every upload gets a sequence number. The thread places a fence of its own
+// after every few uploads and publishes it with the last sequence number it
+// covers. Before a vertex buffer is bound, uploaded to or freed on the main
+// thread, the main context waits (GPU side) on the first fence that covers
+// the last upload of that buffer. The main thread itself only blocks when
+// the thread hasn't even issued that upload yet.
+class LLGLSubmitThread : public LLSimpleton<LLGLSubmitThread>, LL::ThreadPool
+{
+public:
+    LLGLSubmitThread(LLWindow* window);
+    ~LLGLSubmitThread();
+
+    // false when no shared context could be made, nothing is recorded then
+    bool isEnabled() const { return mContext != nullptr; }
+
+    // Threads:  Tmain
+    void beginRecording();
+    bool isRecording() const { return mRecording; }
+
+    // Threads:  Tmain
+    // Queue an upload of size bytes of data into buffer at offset, returns
+    // the sequence number to pass to waitFor() before the buffer is used
+    U64 upload(GLuint buffer, U32 offset, U32 size, const void* data);
+
+    // Threads:  Tmain
+    // Stop recording and hand the recorded uploads to the thread
+    void submit();
+
+    // Threads:  Tmain
+    // Order the main context after the upload with the given sequence
+    // number and the ones before it, recording goes on
+    void waitFor(U64 sequence);
+
+    // Threads:  Tmain
+    // waitFor() everything recorded or submitted so far
+    void sync() { waitFor(mNextSequence - 1); }
+
+    void run() override;
+
+private:
+    struct Upload
+    {
+        GLuint  mBuffer;
+        U32     mOffset;
+        U32     mSize;
+        size_t  mData;      // into CommandList::mData
+    };
+
+    struct CommandList
+    {
+        std::vector<Upload>     mUploads;
+        std::vector<U8>         mData;
+        U64                     mFirstSequence = 0; // of mUploads[0]
+        GLsync                  mReady = nullptr;   // of the main context, placed at submit()
+    };
+
+    // hand the recorded list, if any, to the thread
+    void flushRecorded();
+    void execute(CommandList& list);
+    // Threads:  Tsubmit
+    void publish(U64 sequence);
+
+    LLWindow*                           mWindow;
+    void*                               mContext = nullptr;
+    std::shared_ptr<CommandList>        mRecorded;
+    bool                                mRecording = false;
+    U64                                 mNextSequence = 1;
+    U64                                 mWaitedSequence = 0;    // main context is ordered after this one
+
+    // Published by the thread
+    std::mutex                          mIssuedMutex;
+    std::condition_variable             mIssuedCondition;
+    U64                                 mIssuedSequence = 0;
+    GLsync                              mIssuedFence = nullptr; // placed after mIssuedSequence
+};
+// </FS>
+
 #ifdef LL_PROFILER_ENABLE_RENDER_DOC
 #define LL_LABEL_VERTEX_BUFFER(buf, name) buf->setLabel(name)
 #else
@@ -0,0 +1,184 @@
+/**
+ * @file llvramaccounting.cpp
+ * @brief GPU memory accounted by category and owner
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llvramaccounting.h"
+
+#include "llgltexture.h"
+
+namespace
+{
+    const char* CATEGORY_NAMES[] =
+    {
+        "Textures",
+        "Vertex Buffers",
+        "Render Targets",
+        "Reflection Probes",
+        "Impostors",
+        "Other"
+    };
+    static_assert(LL_ARRAY_SIZE(CATEGORY_NAMES) == (size_t)LLVRAMCategory::COUNT, "CATEGORY_NAMES out of sync with LLVRAMCategory");
+
+    const char* OWNER_NAMES[] =
+    {
+        "None",
+        "Region",
+        "Avatar",
+        "HUD",
+        "UI"
+    };
+    static_assert(LL_ARRAY_SIZE(OWNER_NAMES) == (size_t)LLVRAMOwner::COUNT, "OWNER_NAMES out of sync with LLVRAMOwner");
+
+    const char* PLOT_NAMES[] =
+    {
+        "VRAM Textures",
+        "VRAM Vertex Buffers",
+        "VRAM Render Targets",
+        "VRAM Reflection Probes",
+        "VRAM Impostors",
+        "VRAM Other"
+    };
+    static_assert(LL_ARRAY_SIZE(PLOT_NAMES) == (size_t)LLVRAMCategory::COUNT, "PLOT_NAMES out of sync with LLVRAMCategory");
+
+    static_assert(LLGLTexture::MAX_GL_IMAGE_CATEGORY <= LLVRAMAccounting::MAX_DETAIL, "Texture categories don't fit the detail counters");
+}
+
+std::atomic<S64> LLVRAMAccounting::sCounters[(size_t)LLVRAMCategory::COUNT][MAX_DETAIL][(size_t)LLVRAMOwner::COUNT];
+thread_local LLVRAMTag LLVRAMAccounting::sCurrentTag;
+
+// static
+S64 LLVRAMAccounting::getBytes(LLVRAMCategory category)
+{
+    S64 bytes = 0;
+    for (U32 detail = 0; detail < MAX_DETAIL; ++detail)
+    {
+        for (size_t owner = 0; owner < (size_t)LLVRAMOwner::COUNT; ++owner)
+        {
+            bytes += sCounters[(size_t)category][detail][owner].load(std::memory_order_relaxed);
+        }
+    }
+    return bytes;
+}
+
+// static
+S64 LLVRAMAccounting::getBytes(LLVRAMOwner owner)
+{
+    S64 bytes = 0;
+    for (size_t category = 0; category < (size_t)LLVRAMCategory::COUNT; ++category)
+    {
+        bytes += getBytes((LLVRAMCategory)category, owner);
+    }
+    return bytes;
+}
+
+// static
+S64 LLVRAMAccounting::getBytes(LLVRAMCategory category, LLVRAMOwner owner)
+{
+    S64 bytes = 0;
+    for (U32 detail = 0; detail < MAX_DETAIL; ++detail)
+    {
+        bytes += sCounters[(size_t)category][detail][(size_t)owner].load(std::memory_order_relaxed);
+    }
+    return bytes;
+}
+
+// static
+S64 LLVRAMAccounting::getTotalBytes()
+{
+    S64 bytes = 0;
+    for (size_t category = 0; category < (size_t)LLVRAMCategory::COUNT; ++category)
+    {
+        bytes += getBytes((LLVRAMCategory)category);
+    }
+    return bytes;
+}
+
+// static
+const char* LLVRAMAccounting::getName(LLVRAMCategory category)
+{
+    return (category < LLVRAMCategory::COUNT) ? CATEGORY_NAMES[(size_t)category] : "Unknown";
+}
+
+// static
+const char* LLVRAMAccounting::getName(LLVRAMOwner owner)
+{
+    return (owner < LLVRAMOwner::COUNT) ? OWNER_NAMES[(size_t)owner] : "Unknown";
+}
+
+// static
+LLVRAMTag LLVRAMAccounting::textureTag(S32 category)
+{
+    LLVRAMTag tag;
+    tag.mCategory = LLVRAMCategory::TEXTURE;
+    if (category < 0 || category >= LLGLTexture::MAX_GL_IMAGE_CATEGORY)
+    {
+        // Never given a boost level, like fonts and the default images
+        tag.mDetail = LLGLTexture::OTHER;
+        return tag;
+    }
+
+    tag.mDetail = (U8)category;
+    switch (category)
+    {
+    case LLGLTexture::BOOST_AVATAR:
+    case LLGLTexture::BOOST_AVATAR_BAKED:
+    case LLGLTexture::BOOST_AVATAR_BAKED_SELF:
+    case LLGLTexture::BOOST_AVATAR_SELF:
+    case LLGLTexture::AVATAR_SCRATCH_TEX:
+        tag.mOwner = LLVRAMOwner::AVATAR;
+        break;
+    case LLGLTexture::BOOST_HUD:
+        tag.mOwner = LLVRAMOwner::HUD;
+        break;
+    case LLGLTexture::BOOST_ICON:
+    case LLGLTexture::BOOST_THUMBNAIL:
+    case LLGLTexture::BOOST_UI:
+    case LLGLTexture::BOOST_PREVIEW:
+    case LLGLTexture::BOOST_MAP:
+    case LLGLTexture::BOOST_MAP_VISIBLE:
+        tag.mOwner = LLVRAMOwner::UI;
+        break;
+    case LLGLTexture::OTHER:
+        tag.mOwner = LLVRAMOwner::NONE;
+        break;
+    default:
+        // Attachments at BOOST_NONE land here as well, a texture shared
+        // between owners is only accounted once
+        tag.mOwner = LLVRAMOwner::REGION;
+        break;
+    }
+    return tag;
+}
+
+// static
+void LLVRAMAccounting::plot()
+{
+    for (size_t category = 0; category < (size_t)LLVRAMCategory::COUNT; ++category)
+    {
+        LL_PROFILE_PLOT(PLOT_NAMES[category], (int64_t)getBytes((LLVRAMCategory)category));
+    }
+}
@@ -0,0 +1,145 @@
+/**
+ * @file llvramaccounting.h
+ * @brief GPU memory accounted by category and owner
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVRAMACCOUNTING_H
+#define LL_LLVRAMACCOUNTING_H
+
+#include <atomic>
+
+// What GPU memory is used for
+enum class LLVRAMCategory : U8
+{
+    TEXTURE,            // Detail is the boost level or texture category
+    VERTEX_BUFFER,      // Detail is the spatial partition
+    RENDER_TARGET,
+    REFLECTION_PROBE,
+    IMPOSTOR,
+    OTHER,
+    COUNT
+};
+
+// Who GPU memory is used for
+enum class LLVRAMOwner : U8
+{
+    NONE,
+    REGION,
+    AVATAR,
+    HUD,
+    UI,
+    COUNT
+};
+
+struct LLVRAMTag
+{
+    LLVRAMCategory  mCategory = LLVRAMCategory::OTHER;
+    U8              mDetail = 0;
+    LLVRAMOwner     mOwner = LLVRAMOwner::NONE;
+};
+
+// GPU memory by category, detail and owner. Allocation sites claim the
+// bytes they hand to GL under a tag and disclaim them with the same tag
+// when the object is deleted.
+//
+// Texture allocations happen deep inside LLImageGL and the render targets,
+// which don't know who they allocate for. Callers that do open a Scope,
+// and allocations on that thread are tagged with it until it closes.
+// Counters are relaxed atomics, sums read from another thread may be off
+// by an allocation in flight.
+class LLVRAMAccounting
+{
+public:
+    static constexpr U32 MAX_DETAIL = 32;
+
+    static void claim(const LLVRAMTag& tag, S64 bytes)
+    {
+        counter(tag).fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    static void disclaim(const LLVRAMTag& tag, S64 bytes)
+    {
+        counter(tag).fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    static S64 getBytes(LLVRAMCategory category);
+    static S64 getBytes(LLVRAMOwner owner);
+    static S64 getBytes(LLVRAMCategory category, LLVRAMOwner owner);
+    static S64 getBytes(LLVRAMCategory category, U8 detail, LLVRAMOwner owner)
+    {
+        return sCounters[(size_t)category][detail % MAX_DETAIL][(size_t)owner].load(std::memory_order_relaxed);
+    }
+    static S64 getTotalBytes();
+
+    static const char* getName(LLVRAMCategory category);
+    static const char* getName(LLVRAMOwner owner);
+
+    // Tag of texture memory of the given LLGLTexture boost level or
+    // category, the owner follows from the level
+    static LLVRAMTag textureTag(S32 category);
+
+    // Tag allocations on this thread are made under
+    static const LLVRAMTag& getCurrentTag() { return sCurrentTag; }
+
+    // Allocations on this thread are tagged with the given tag while the
+    // scope is open. With only_if_unset an outer scope wins, render
+    // targets use it so the probe or impostor allocating them keeps its tag.
+    class Scope
+    {
+    public:
+        Scope(const LLVRAMTag& tag, bool only_if_unset = false) :
+            mPrevious(sCurrentTag)
+        {
+            if (!only_if_unset || sCurrentTag.mCategory == LLVRAMCategory::OTHER)
+            {
+                sCurrentTag = tag;
+            }
+        }
+
+        ~Scope()
+        {
+            sCurrentTag = mPrevious;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        LLVRAMTag mPrevious;
+    };
+
+    // Once per frame
+    static void plot();
+
+private:
+    static std::atomic<S64>& counter(const LLVRAMTag& tag)
+    {
+        return sCounters[(size_t)tag.mCategory][tag.mDetail % MAX_DETAIL][(size_t)tag.mOwner];
+    }
+
+    static std::atomic<S64> sCounters[(size_t)LLVRAMCategory::COUNT][MAX_DETAIL][(size_t)LLVRAMOwner::COUNT];
+    static thread_local LLVRAMTag sCurrentTag;
+};
+
+#endif // LL_LLVRAMACCOUNTING_H
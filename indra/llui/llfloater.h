@@ -279,6 +279,7 @@ public:
     void            fitWithDependentsOnScreen(const LLRect& left, const LLRect& bottom, const LLRect& right, const LLRect& chatbar, const LLRect& utilitybar, const LLRect& constraint, S32 min_overlap_pixels);
     // </FS:Ansariel>
     bool            isMinimized() const             { return mMinimized; }
+    /*virtual*/ bool isFloater() const override     { return true; } // <FS/> UI buffer
     /// isShown() differs from getVisible() in that isShown() also considers
     /// isMinimized(). isShown() is true only if visible and not minimized.
     bool            isShown() const;
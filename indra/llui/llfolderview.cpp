@@ -179,6 +179,10 @@ LLFolderView::LLFolderView(const Params& p)
     mShowSelectionContext(false),
     mShowSingleSelection(false),
     mArrangeGeneration(0),
+    // <FS> Virtualized folder rows
+    mArrangeWindowTop(S32_MIN),
+    mArrangeWindowBottom(S32_MAX),
+    // </FS>
     mSignalSelectCallback(0),
     mMinWidth(0),
     mDragAndDropThisFrame(false),
@@ -325,6 +329,22 @@ S32 LLFolderView::arrange( S32* unused_width, S32* unused_height )
     mMinWidth = 0;
     S32 target_height;
 
+    // <FS> Virtualized folder rows
+    static LLCachedControl<bool> virtualize_rows(*LLUI::getInstance()->mSettingGroups["config"], "FSVirtualizeFolderRows", true);
+    if (virtualize_rows && mScrollContainer)
+    {
+        const LLRect visible_rect = getVisibleRect();
+        const S32 margin = visible_rect.getHeight();
+        mArrangeWindowTop = getRect().getHeight() - visible_rect.mTop - margin;
+        mArrangeWindowBottom = getRect().getHeight() - visible_rect.mBottom + margin;
+    }
+    else
+    {
+        mArrangeWindowTop = S32_MIN;
+        mArrangeWindowBottom = S32_MAX;
+    }
+    // </FS>
+
     LLFolderViewFolder::arrange(&mMinWidth, &target_height);
 
     LLRect scroll_rect = (mScrollContainer ? mScrollContainer->getContentWindowRect() : LLRect());
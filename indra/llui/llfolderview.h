@@ -144,6 +144,16 @@ public:
     void arrangeAll() { mArrangeGeneration++; }
     S32 getArrangeGeneration() { return mArrangeGeneration; }
 
+    // <FS> Virtualized folder rows
+    // True if a row top pixels below the top of this view lies within the
+    // visible part of the scroll container, plus a page on either side,
+    // as of the current arrange(). Rows outside skip measuring their labels.
+    bool isInArrangeWindow(S32 top, S32 height) const
+    {
+        return top + height >= mArrangeWindowTop && top <= mArrangeWindowBottom;
+    }
+    // </FS>
+
     // applies filters to control visibility of items
     virtual void filter( LLFolderViewFilter& filter);
 
@@ -325,6 +335,10 @@ protected:
     std::string                     mSearchString;
     LLFrameTimer                    mMultiSelectionFadeTimer;
     S32                             mArrangeGeneration;
+    // <FS> Virtualized folder rows
+    S32                             mArrangeWindowTop;
+    S32                             mArrangeWindowBottom;
+    // </FS>
 
     signal_t                        mSelectSignal;
     signal_t                        mReshapeSignal;
@@ -171,6 +171,7 @@ LLFolderViewItem::LLFolderViewItem(const LLFolderViewItem::Params& p)
 :   LLView(p),
     mLabelWidth(0),
     mLabelWidthDirty(false),
+    mArrangeTop(0), // <FS/> Virtualized folder rows
     mSuffixNeedsRefresh(false),
     mLabelPaddingRight(DEFAULT_LABEL_PADDING_RIGHT),
     mParentFolder( NULL ),
@@ -455,17 +456,23 @@ S32 LLFolderViewItem::arrange( S32* width, S32* height )
     }
     // </FS:Ansariel>
 
-    if (mLabelWidthDirty)
+    // <FS> Virtualized folder rows
+    //if (mLabelWidthDirty)
+    //{
+    //    if (mSuffixNeedsRefresh)
+    //    {
+    //        // Expensive. But despite refreshing label,
+    //        // it is purely visual, so it is fine to do at our laisure
+    //        refreshSuffix();
+    //    }
+    //    mLabelWidth = getLabelXPos() + getLabelFontForStyle(mLabelStyle)->getWidth(mLabel.c_str()) + getLabelFontForStyle(LLFontGL::NORMAL)->getWidth(mLabelSuffix.c_str()) + mLabelPaddingRight;
+    //    mLabelWidthDirty = false;
+    //}
+    if (mLabelWidthDirty && getRoot()->isInArrangeWindow(mArrangeTop, getItemHeight()))
     {
-        if (mSuffixNeedsRefresh)
-        {
-            // Expensive. But despite refreshing label,
-            // it is purely visual, so it is fine to do at our laisure
-            refreshSuffix();
-        }
-        mLabelWidth = getLabelXPos() + getLabelFontForStyle(mLabelStyle)->getWidth(mLabel.c_str()) + getLabelFontForStyle(LLFontGL::NORMAL)->getWidth(mLabelSuffix.c_str()) + mLabelPaddingRight;
-        mLabelWidthDirty = false;
+        updateLabelWidth();
     }
+    // </FS>
 
     *width = llmax(*width, mLabelWidth);
 
@@ -485,6 +492,20 @@ S32 LLFolderViewItem::getItemHeight() const
     return mItemHeight;
 }
 
+// <FS> Virtualized folder rows
+void LLFolderViewItem::updateLabelWidth()
+{
+    if (mSuffixNeedsRefresh)
+    {
+        // Expensive. But despite refreshing label,
+        // it is purely visual, so it is fine to do at our laisure
+        refreshSuffix();
+    }
+    mLabelWidth = getLabelXPos() + getLabelFontForStyle(mLabelStyle)->getWidth(mLabel.c_str()) + getLabelFontForStyle(LLFontGL::NORMAL)->getWidth(mLabelSuffix.c_str()) + mLabelPaddingRight;
+    mLabelWidthDirty = false;
+}
+// </FS>
+
 S32 LLFolderViewItem::getLabelXPos()
 {
     return getIndentation() + mArrowSize + mTextPad + mIconWidth + mIconPad;
@@ -987,6 +1008,20 @@ void LLFolderViewItem::draw()
     const bool show_context = (getRoot() ? getRoot()->getShowSelectionContext() : false);
     const bool filled = show_context || (getRoot() ? getRoot()->getParentPanel()->hasFocus() : false); // If we have keyboard focus, draw selection filled
 
+    // <FS> Virtualized folder rows
+    // Skipped by arrange() while it was scrolled out of view
+    if (mLabelWidthDirty)
+    {
+        S32 old_width = mLabelWidth;
+        updateLabelWidth();
+        if (mLabelWidth > old_width && getParentFolder())
+        {
+            // May widen the folder view
+            getParentFolder()->requestArrange();
+        }
+    }
+    // </FS>
+
     const LLFontGL* font = getLabelFont();
     S32 line_height = font->getLineHeight();
 
@@ -1336,6 +1371,7 @@ S32 LLFolderViewFolder::arrange( S32* width, S32* height )
                     S32 child_height = 0;
                     S32 child_top = parent_item_height - ll_round(running_height);
 
+                    folderp->setArrangeTop(mArrangeTop + ll_round(running_height)); // <FS/> Virtualized folder rows
                     target_height += folderp->arrange( &child_width, &child_height );
 
                     running_height += (F32)child_height;
@@ -1355,6 +1391,7 @@ S32 LLFolderViewFolder::arrange( S32* width, S32* height )
                     S32 child_height = 0;
                     S32 child_top = parent_item_height - ll_round(running_height);
 
+                    itemp->setArrangeTop(mArrangeTop + ll_round(running_height)); // <FS/> Virtualized folder rows
                     target_height += itemp->arrange( &child_width, &child_height );
                     // don't change width, as this item is as wide as its parent folder by construction
                     itemp->reshape( itemp->getRect().getWidth(), child_height);
@@ -97,6 +97,7 @@ protected:
     LLWString                   mLabel;
     S32                         mLabelWidth;
     bool                        mLabelWidthDirty;
+    S32                         mArrangeTop; // <FS/> Virtualized folder rows, pixels below the top of the root
     S32                         mLabelPaddingRight;
     LLFolderViewFolder*         mParentFolder;
     LLPointer<LLFolderViewModelItem> mViewModelItem;
@@ -193,6 +194,10 @@ public:
     virtual S32 getLabelXPos();
     S32 getIconPad();
     S32 getTextPad();
+    // <FS> Virtualized folder rows
+    // Set by the parent folder right before arrange()
+    void setArrangeTop(S32 top) { mArrangeTop = top; }
+    // </FS>
 
     // If 'selection' is 'this' then note that otherwise ignore.
     // Returns true if this item ends up being selected.
@@ -291,6 +296,11 @@ public:
     // refreshes suffixes and sets icons. Expensive!
     // Does not need filter update
     virtual void refreshSuffix();
+    // <FS> Virtualized folder rows
+    // Refreshes the suffix if needed and measures the label. Rows outside
+    // the root's arrange window leave this to the first draw.
+    void updateLabelWidth();
+    // </FS>
 
     bool isSingleFolderMode() { return mSingleFolderMode; }
 
@@ -68,7 +68,8 @@ inline bool LLKeywordToken::isTail(const llwchar* s) const
 }
 
 LLKeywords::LLKeywords()
-:   mLoaded(false)
+:   mLoaded(false),
+    mLexValid(false) // <FS/> Incremental syntax highlighting
 {
 }
 
@@ -89,6 +90,8 @@ void LLKeywords::addToken(LLKeywordToken::ETokenType type,
                           const std::string& tool_tip_in,
                           const std::string& delimiter_in)
 {
+    mLexValid = false; // <FS/> Incremental syntax highlighting
+
     std::string tip_text = tool_tip_in;
     LLStringUtil::replaceString(tip_text, "\\n", "\n" );
     LLStringUtil::replaceString(tip_text, "\t", " " );
@@ -507,25 +510,128 @@ void LLKeywords::findSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLW
     LL_RECORD_BLOCK_TIME(FTM_SYNTAX_COLORING);
     seg_list->clear();
 
+    // <FS> Incremental syntax highlighting
+    mLexedText = wtext;
+    mLineStates.assign(1, { 0, 0 });
+    mLexValid = true;
+    // </FS>
+
     if( wtext.empty() )
     {
         return;
     }
 
+    // <FS> Incremental syntax highlighting
+    lexSegments(seg_list, wtext, 0, true, nullptr, mLineStates, editor, style);
+}
+
+bool LLKeywords::findChangedSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLWString& wtext, LLTextEditor& editor, LLStyleConstSP style,
+                                     S32 changed_start, S32 changed_end, S32& start, S32& end)
+{
+    LL_RECORD_BLOCK_TIME(FTM_SYNTAX_COLORING);
+    seg_list->clear();
+
+    if (!mLexValid || mLineStates.empty() || wtext.empty())
+    {
+        return false;
+    }
+
+    const S32 old_len = static_cast<S32>(mLexedText.size());
+    const S32 new_len = static_cast<S32>(wtext.size());
+    const S32 common_len = llmin(old_len, new_len);
+    S32 prefix = 0;
+    while (prefix < common_len && wtext[prefix] == mLexedText[prefix])
+    {
+        prefix++;
+    }
+    prefix = llclamp(changed_start, 0, prefix);
+    S32 suffix = 0;
+    while (suffix < common_len - prefix && wtext[new_len - 1 - suffix] == mLexedText[old_len - 1 - suffix])
+    {
+        suffix++;
+    }
+    const S32 delta = new_len - old_len;
+    changed_end = llmax(changed_end, new_len - suffix);
+
+    auto by_start = [](const LineState& line, S32 pos) { return line.mStart < pos; };
+
+    // The line of the first change only depends on the unchanged text before it
+    line_state_list_t::iterator line_it = std::upper_bound(mLineStates.begin(), mLineStates.end(), prefix,
+        [](S32 pos, const LineState& line) { return pos < line.mStart; });
+    --line_it;
+    const S32 resume = line_it->mResume;
+
+    // Done once a line behind the changes starts outside of any token, as
+    // the same line did before
+    auto converged = [&](S32 line_start)
+    {
+        if (line_start <= changed_end)
+        {
+            return false;
+        }
+        line_state_list_t::const_iterator old_it = std::lower_bound(mLineStates.begin(), mLineStates.end(), line_start - delta, by_start);
+        return old_it != mLineStates.end() && old_it->mStart == line_start - delta && old_it->mResume == old_it->mStart;
+    };
+
+    line_state_list_t lines;
+    const S32 stop = lexSegments(seg_list, wtext, resume, resume == line_it->mStart, converged, lines, editor, style);
+
+    while (!seg_list->empty() && seg_list->back()->getStart() >= stop)
+    {
+        seg_list->pop_back();
+    }
+    if (!seg_list->empty() && seg_list->back()->getEnd() > stop)
+    {
+        seg_list->back()->setEnd(stop);
+    }
+
+    // Replace the states of the lexed lines, shift those behind them
+    const S32 old_stop = stop - delta;
+    line_state_list_t::iterator first_it = std::upper_bound(mLineStates.begin(), mLineStates.end(), resume,
+        [](S32 pos, const LineState& line) { return pos < line.mStart; });
+    line_state_list_t::iterator last_it = std::lower_bound(first_it, mLineStates.end(), old_stop, by_start);
+    for (line_state_list_t::iterator it = last_it; it != mLineStates.end(); ++it)
+    {
+        it->mStart += delta;
+        it->mResume += delta;
+    }
+    first_it = mLineStates.erase(first_it, last_it);
+    mLineStates.insert(first_it, lines.begin(), lines.end());
+
+    mLexedText = wtext;
+    start = resume;
+    end = stop;
+    return true;
+}
+
+S32 LLKeywords::lexSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLWString& wtext, S32 lex_start, bool at_line_start,
+                            const std::function<bool(S32)>& stop_at, line_state_list_t& lines, LLTextEditor& editor, LLStyleConstSP style)
+{
+    // </FS>
     S32 text_len = static_cast<S32>(wtext.size()) + 1;
 
     // <FS:Ansariel> Script editor ignoring font selection
     //seg_list->push_back( new LLNormalTextSegment( style, 0, text_len, editor ) );
     LLStyleSP actual_style = getDefaultStyle(editor);
     actual_style->setColor(style->getColor());
-    seg_list->push_back( new LLNormalTextSegment( actual_style, 0, text_len, editor ) );
+    // <FS> Incremental syntax highlighting
+    //seg_list->push_back( new LLNormalTextSegment( actual_style, 0, text_len, editor ) );
+    seg_list->push_back( new LLNormalTextSegment( actual_style, lex_start, text_len, editor ) );
+    // </FS>
     // </FS:Ansariel>
 
     const llwchar* base = wtext.c_str();
-    const llwchar* cur = base;
+    // <FS> Incremental syntax highlighting
+    //const llwchar* cur = base;
+    const llwchar* cur = base + lex_start;
+    const llwchar* line_start_ptr = at_line_start ? cur : nullptr;
+    // </FS>
     while( *cur )
     {
-        if( *cur == '\n' || cur == base )
+        // <FS> Incremental syntax highlighting
+        //if( *cur == '\n' || cur == base )
+        if( *cur == '\n' || cur == line_start_ptr )
+        // </FS>
         {
             if( *cur == '\n' )
             {
@@ -536,6 +642,16 @@ void LLKeywords::findSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLW
                 text_segment->setToken( 0 );
                 insertSegment( *seg_list, text_segment, text_len, style, editor);
                 cur++;
+
+                // <FS> Incremental syntax highlighting
+                const S32 line_start = (S32)(cur - base);
+                if (stop_at && stop_at(line_start))
+                {
+                    return line_start;
+                }
+                lines.push_back({ line_start, line_start });
+                // </FS>
+
                 if( !*cur || *cur == '\n' )
                 {
                     continue;
@@ -651,6 +767,12 @@ void LLKeywords::findSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLW
                             }
                             else
                             {
+                                // <FS> Incremental syntax highlighting
+                                if (*cur == '\n')
+                                {
+                                    lines.push_back({ (S32)(cur - base) + 1, seg_start });
+                                }
+                                // </FS>
                                 between_delimiters++;
                                 cur++;
                             }
@@ -736,6 +858,8 @@ void LLKeywords::findSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLW
             }
         }
     }
+
+    return text_len; // <FS/> Incremental syntax highlighting
 }
 
 void LLKeywords::insertSegments(const LLWString& wtext, std::vector<LLTextSegmentPtr>& seg_list, LLKeywordToken* cur_token, S32 text_len, S32 seg_start, S32 seg_end, LLStyleConstSP style, LLTextEditor& editor )
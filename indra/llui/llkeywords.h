@@ -36,6 +36,7 @@
 #include <map>
 #include <list>
 #include <deque>
+#include <functional> // <FS/> Incremental syntax highlighting
 #include "llpointer.h"
 
 // <FS:Ansariel> Script editor ignoring font selection
@@ -124,6 +125,25 @@ public:
                              const LLWString& text,
                              class LLTextEditor& editor,
                              LLStyleConstSP style);
+    // <FS> Incremental syntax highlighting
+    // Lexes only what the changes since the previous findSegments() or
+    // findChangedSegments() call affect: from the line of the first change
+    // until a line starts outside of any token again, like it did before.
+    // [changed_start, changed_end) has to hold all positions the edits
+    // touched, comparing the texts can't tell those apart from equal
+    // characters around them. seg_list then covers [start, end) of the
+    // text. False if there is no previous lexing to go on, findSegments()
+    // has to do it all then.
+    bool        findChangedSegments(std::vector<LLTextSegmentPtr> *seg_list,
+                                    const LLWString& text,
+                                    class LLTextEditor& editor,
+                                    LLStyleConstSP style,
+                                    S32 changed_start,
+                                    S32 changed_end,
+                                    S32& start,
+                                    S32& end);
+    void        resetChangedSegments() { mLexValid = false; }
+    // </FS>
     void        initialize(LLSD SyntaxXML);
     void        processTokens();
 
@@ -176,6 +196,29 @@ public:
 #endif
 
 protected:
+    // <FS> Incremental syntax highlighting
+    // Where lexing has to start over to get a line right: the line start
+    // itself, or the head of a delimited token spanning it
+    struct LineState
+    {
+        S32 mStart;
+        S32 mResume;
+    };
+    typedef std::vector<LineState> line_state_list_t;
+
+    // Lexes wtext from lex_start, which is a line start if at_line_start
+    // and the head of a delimiter otherwise. Each line start passed goes
+    // into lines. Stops at the first line start outside of a token that
+    // stop_at accepts and returns it, or the end of the text.
+    S32         lexSegments(std::vector<LLTextSegmentPtr> *seg_list,
+                            const LLWString& wtext,
+                            S32 lex_start,
+                            bool at_line_start,
+                            const std::function<bool(S32)>& stop_at,
+                            line_state_list_t& lines,
+                            LLTextEditor& editor,
+                            LLStyleConstSP style);
+    // </FS>
     void        processTokensGroup(const LLSD& Tokens, std::string_view Group);
     void        insertSegment(std::vector<LLTextSegmentPtr>& seg_list,
                               LLTextSegmentPtr new_segment,
@@ -209,6 +252,12 @@ protected:
 
     // <FS:Ansariel> Script editor ignoring font selection
     LLStyleSP getDefaultStyle(const LLTextEditor& editor);
+
+    // <FS> Incremental syntax highlighting
+    LLWString           mLexedText;
+    line_state_list_t   mLineStates;
+    bool                mLexValid;
+    // </FS>
 };
 
 #endif  // LL_LLKEYWORDS_H
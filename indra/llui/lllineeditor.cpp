@@ -149,6 +149,7 @@ LLLineEditor::LLLineEditor(const LLLineEditor::Params& p)
     mSpellCheck( p.spellcheck ),
     mSpellCheckStart(-1),
     mSpellCheckEnd(-1),
+    mSpellCheckResults(0), // <FS/> Asynchronous spell checking
     mSelectAllonFocusReceived( p.select_on_focus ),
     mSelectAllonCommit( true ),
     mPassDelete(false),
@@ -2085,7 +2086,11 @@ void LLLineEditor::draw()
         // Calculate start and end indices for the first and last visible word
         U32 start = prevWordPos(mScrollHPos), end = nextWordPos(mScrollHPos + rendered_text);
 
-        if ( (mSpellCheckStart != start) || (mSpellCheckEnd != end) )
+        // <FS> Asynchronous spell checking
+        //if ( (mSpellCheckStart != start) || (mSpellCheckEnd != end) )
+        const U32 spell_check_results = LLSpellChecker::instance().updateCachedChecks();
+        if ( (mSpellCheckStart != start) || (mSpellCheckEnd != end) || (mSpellCheckResults != spell_check_results) )
+        // </FS>
         {
             const LLWString& text = mText.getWString().substr(start, end);
 
@@ -2116,7 +2121,10 @@ void LLLineEditor::draw()
 
                 // Don't process words shorter than 3 characters
                 std::string word = wstring_to_utf8str(text.substr(word_start, word_end - word_start));
-                if ( (word.length() >= 3) && (!LLSpellChecker::instance().checkSpelling(word)) )
+                // <FS> Asynchronous spell checking, words still being looked up are underlined once known
+                //if ( (word.length() >= 3) && (!LLSpellChecker::instance().checkSpelling(word)) )
+                if ( (word.length() >= 3) && (LLSpellChecker::SPELL_MISSPELLED == LLSpellChecker::instance().checkSpellingCached(word)) )
+                // </FS>
                 {
                     mMisspellRanges.push_back(std::pair<U32, U32>(start + word_start, start + word_end));
                 }
@@ -2131,6 +2139,7 @@ void LLLineEditor::draw()
 
             mSpellCheckStart = start;
             mSpellCheckEnd = end;
+            mSpellCheckResults = spell_check_results; // <FS/> Asynchronous spell checking
         }
 
         // Draw squiggly lines under any (visible) misspelled words
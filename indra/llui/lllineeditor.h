@@ -393,6 +393,7 @@ protected:
     bool        mSpellCheck;
     S32         mSpellCheckStart;
     S32         mSpellCheckEnd;
+    U32         mSpellCheckResults; // <FS/> Asynchronous spell checking
     LLTimer     mSpellCheckTimer;
     std::list<std::pair<U32, U32> > mMisspellRanges;
     std::vector<std::string>        mSuggestionList;
@@ -30,6 +30,10 @@
 #include "llui.h"
 
 /*static*/ std::stack<LLRect> LLScreenClipRect::sClipRectStack;
+// <FS> Batched glyph pages
+/*static*/ S32 LLScreenClipRect::sScissor[4] = { 0, 0, 0, 0 };
+/*static*/ bool LLScreenClipRect::sScissorValid = false;
+// </FS>
 
 
 LLScreenClipRect::LLScreenClipRect(const LLRect& rect, bool enabled)
@@ -80,10 +84,18 @@ void LLScreenClipRect::popClipRect()
 //static
 void LLScreenClipRect::updateScissorRegion()
 {
-    if (sClipRectStack.empty()) return;
-
-    // finish any deferred calls in the old clipping region
-    gGL.flush();
+    // <FS> Batched glyph pages
+    //if (sClipRectStack.empty()) return;
+    //
+    //// finish any deferred calls in the old clipping region
+    //gGL.flush();
+    if (sClipRectStack.empty())
+    {
+        // the next outermost clip rect sets its region whatever was set in between
+        sScissorValid = false;
+        return;
+    }
+    // </FS>
 
     LLRect rect = sClipRectStack.top();
     stop_glerror();
@@ -92,6 +104,24 @@ void LLScreenClipRect::updateScissorRegion()
     y = llfloor(rect.mBottom * LLUI::getScaleFactor().mV[VY]);
     w = llmax(0, llceil(rect.getWidth() * LLUI::getScaleFactor().mV[VX])) + 1;
     h = llmax(0, llceil(rect.getHeight() * LLUI::getScaleFactor().mV[VY])) + 1;
+
+    // <FS> Batched glyph pages
+    // Nested clip rects of the same region, like the rows of a list or a
+    // tree, keep the pending vertices batched across them
+    if (sScissorValid && sScissor[0] == x && sScissor[1] == y && sScissor[2] == w && sScissor[3] == h)
+    {
+        return;
+    }
+    sScissor[0] = x;
+    sScissor[1] = y;
+    sScissor[2] = w;
+    sScissor[3] = h;
+    sScissorValid = true;
+
+    // finish any deferred calls in the old clipping region
+    gGL.flush();
+    // </FS>
+
     glScissor( x,y,w,h );
     stop_glerror();
 }
@@ -51,6 +51,10 @@ private:
     bool            mEnabled;
 
     static std::stack<LLRect> sClipRectStack;
+    // <FS> Batched glyph pages, the scissor box last set while the stack was not empty
+    static S32 sScissor[4];
+    static bool sScissorValid;
+    // </FS>
 };
 
 class LLLocalClipRect : public LLScreenClipRect
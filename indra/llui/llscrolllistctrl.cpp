@@ -232,6 +232,11 @@ LLScrollListCtrl::LLScrollListCtrl(const LLScrollListCtrl::Params& p)
     // <FS:Ansariel> Fix for FS-specific people list (radar)
     mFilterColumn(-1),
     mIsFiltered(false),
+    // <FS> Filtered scroll list count
+    mFilteredCount(0),
+    mFilteredCountFrame(0),
+    mFilteredCountListSize(0),
+    // </FS>
     mPersistSortOrder(p.persist_sort_order),
     mPersistedSortOrderLoaded(false),
     mPersistedSortOrderControl(""),
@@ -440,6 +445,14 @@ S32 LLScrollListCtrl::getItemCount() const
     // <FS:Ansariel> Fix for FS-specific people list (radar)
     if (mIsFiltered)
     {
+        // <FS> Filtered scroll list count
+        // Asked for several times per frame, count once per frame and size
+        const U32 frame = LLFrameTimer::getFrameCount();
+        if (mFilteredCountFrame == frame && mFilteredCountListSize == mItemList.size())
+        {
+            return mFilteredCount;
+        }
+        // </FS>
         S32 count(0);
         item_list::const_iterator iter;
         for(iter = mItemList.begin(); iter != mItemList.end(); iter++)
@@ -453,6 +466,11 @@ S32 LLScrollListCtrl::getItemCount() const
             }
             count++;
         }
+        // <FS> Filtered scroll list count
+        mFilteredCount = count;
+        mFilteredCountFrame = frame;
+        mFilteredCountListSize = mItemList.size();
+        // </FS>
         return count;
     }
     // </FS:Ansariel> Fix for FS-specific people list (radar)
@@ -663,7 +681,21 @@ LLRect LLScrollListCtrl::getRequiredRect()
 bool LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, bool requires_column )
 {
     bool not_too_big = getItemCount() < mMaxItemCount;
-    if (not_too_big)
+    // <FS> Sorted insertion into scroll lists
+    // A list that is sorted stays sorted: the new row goes where a stable
+    // sort would put it, instead of re-sorting all rows on the next draw.
+    // Lazily sorted lists keep their deferred sort.
+    static LLUICachedControl<bool> sorted_insert("FSScrollListSortedInsert", true);
+    if (not_too_big && sorted_insert && !mSortLazily && hasSortOrder() && isSorted()
+        && (pos == ADD_TOP || pos == ADD_BOTTOM || pos == ADD_DEFAULT))
+    {
+        SortScrollListItem compare(mSortColumns, mSortCallback, mAlternateSort);
+        item_list::iterator where = (pos == ADD_TOP) ? std::lower_bound(mItemList.begin(), mItemList.end(), item, compare)
+                                                     : std::upper_bound(mItemList.begin(), mItemList.end(), item, compare);
+        mItemList.insert(where, item);
+    }
+    else if (not_too_big)
+    // </FS>
     {
         switch( pos )
         {
@@ -684,7 +716,11 @@ bool LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, bool r
             setNeedsSort();
             break;
         }
+    }
 
+    // <FS> Sorted insertion into scroll lists
+    if (not_too_big)
+    {
         // create new column on demand
         if (mColumns.empty() && requires_column)
         {
@@ -3896,6 +3932,7 @@ void LLScrollListCtrl::setFilterString(const std::string& str)
     mFilterString = str;
     std::transform(mFilterString.begin(), mFilterString.end(), mFilterString.begin(), ::tolower);
     mIsFiltered = (mFilterColumn > -1 && !mFilterString.empty());
+    mFilteredCountFrame = 0; // <FS/> Filtered scroll list count
     updateLayout();
 
     if (mIsFiltered && getNumSelected() > 0 && isFiltered(getFirstSelected()))
@@ -577,6 +577,11 @@ private:
     std::string     mFilterString;
     S32             mFilterColumn;
     bool            mIsFiltered;
+    // <FS> Filtered scroll list count
+    mutable S32     mFilteredCount;
+    mutable U32     mFilteredCountFrame;
+    mutable size_t  mFilteredCountListSize;
+    // </FS>
 
     S32             mSearchColumn;
     S32             mNumDynamicWidthColumns;
@@ -30,6 +30,7 @@
 #include "llsdserialize.h"
 
 #include "llspellcheck.h"
+#include "workqueue.h" // <FS/> Asynchronous spell checking
 #include <hunspell/hunspell.hxx>
 
 static const std::string DICT_DIR = "dictionaries";
@@ -39,9 +40,19 @@ static const std::string DICT_FILE_IGNORE = "user_ignore.dic";
 static const std::string DICT_FILE_MAIN = "dictionaries.xml";
 static const std::string DICT_FILE_USER = "user_dictionaries.xml";
 
+// <FS> Asynchronous spell checking
+// A notecard worth of distinct words, the cache starts over beyond that
+static const size_t MAX_CACHED_WORDS = 50000;
+// </FS>
+
 LLSpellChecker::settings_change_signal_t LLSpellChecker::sSettingsChangeSignal;
 
 LLSpellChecker::LLSpellChecker()
+    // <FS> Asynchronous spell checking
+    : mAsyncState(std::make_shared<AsyncState>()),
+      mCacheGeneration(0),
+      mResultCounter(0)
+    // </FS>
 {
     // Load initial dictionary information
     refreshDictionaryMap();
@@ -53,10 +64,23 @@ LLSpellChecker::~LLSpellChecker()
 
 bool LLSpellChecker::checkSpelling(const std::string& word) const
 {
-    if ( (!mHunspell) || (word.length() < 3) || (0 != mHunspell->spell(word)) )
+    // <FS> Asynchronous spell checking
+    //if ( (!mHunspell) || (word.length() < 3) || (0 != mHunspell->spell(word)) )
+    //{
+    //    return true;
+    //}
+    if ( (!mHunspell) || (word.length() < 3) )
     {
         return true;
     }
+    {
+        std::lock_guard<std::mutex> lock(mAsyncState->mHunspellMutex);
+        if (0 != mHunspell->spell(word))
+        {
+            return true;
+        }
+    }
+    // </FS>
     if (!mIgnoreList.empty())
     {
         std::string word_lower(word);
@@ -74,11 +98,126 @@ S32 LLSpellChecker::getSuggestions(const std::string& word, std::vector<std::str
         return 0;
     }
 
-    suggestions = mHunspell->suggest(word);
+    // <FS> Asynchronous spell checking
+    //suggestions = mHunspell->suggest(word);
+    {
+        std::lock_guard<std::mutex> lock(mAsyncState->mHunspellMutex);
+        suggestions = mHunspell->suggest(word);
+    }
+    // </FS>
 
     return static_cast<S32>(suggestions.size());
 }
 
+// <FS> Asynchronous spell checking
+LLSpellChecker::ECheckResult LLSpellChecker::checkSpellingCached(const std::string& word)
+{
+    static LLUICachedControl<bool> async_spell_check("FSAsyncSpellCheck", true);
+    if ( (!async_spell_check) || (!mHunspell) || (word.length() < 3) )
+    {
+        return (checkSpelling(word)) ? SPELL_CORRECT : SPELL_MISSPELLED;
+    }
+
+    auto it = mWordCache.find(word);
+    if (mWordCache.end() == it)
+    {
+        if (mPendingWords.insert(word).second)
+        {
+            mQueuedWords.push_back(word);
+        }
+        return SPELL_PENDING;
+    }
+    if (it->second)
+    {
+        return SPELL_CORRECT;
+    }
+
+    if (!mIgnoreList.empty())
+    {
+        std::string word_lower(word);
+        LLStringUtil::toLower(word_lower);
+        if (mIgnoreList.end() != std::find(mIgnoreList.begin(), mIgnoreList.end(), word_lower))
+        {
+            return SPELL_CORRECT;
+        }
+    }
+    return SPELL_MISSPELLED;
+}
+
+U32 LLSpellChecker::updateCachedChecks()
+{
+    if ( (!mQueuedWords.empty()) && (mHunspell) )
+    {
+        std::vector<std::string> words;
+        words.swap(mQueuedWords);
+
+        // The lookup keeps its own reference to the Hunspell instance, a
+        // dictionary change in the meantime only makes its results stale
+        auto lookup = [state = mAsyncState, hunspell = mHunspell, words, generation = mCacheGeneration]()
+        {
+            std::vector<AsyncState::WordResult> results;
+            results.reserve(words.size());
+            for (const std::string& word : words)
+            {
+                std::lock_guard<std::mutex> lock(state->mHunspellMutex);
+                results.push_back({ word, generation, 0 != hunspell->spell(word) });
+            }
+
+            std::lock_guard<std::mutex> lock(state->mResultMutex);
+            state->mResults.insert(state->mResults.end(), results.begin(), results.end());
+            state->mHasResults = true;
+        };
+
+        LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+        if ( (!general_queue) || (!general_queue->post(lookup)) )
+        {
+            lookup();
+        }
+    }
+
+    if (mAsyncState->mHasResults.exchange(false))
+    {
+        std::vector<AsyncState::WordResult> results;
+        {
+            std::lock_guard<std::mutex> lock(mAsyncState->mResultMutex);
+            results.swap(mAsyncState->mResults);
+        }
+
+        bool updated = false;
+        for (const AsyncState::WordResult& result : results)
+        {
+            if (result.mGeneration != mCacheGeneration)
+            {
+                continue;
+            }
+            if (mWordCache.size() >= MAX_CACHED_WORDS)
+            {
+                // Words still pending stay valid, only the answers go
+                mWordCache.clear();
+            }
+            mWordCache[result.mWord] = result.mCorrect;
+            mPendingWords.erase(result.mWord);
+            updated = true;
+        }
+        if (updated)
+        {
+            ++mResultCounter;
+        }
+    }
+
+    return mResultCounter;
+}
+
+void LLSpellChecker::clearWordCache()
+{
+    mWordCache.clear();
+    mPendingWords.clear();
+    mQueuedWords.clear();
+    ++mCacheGeneration;
+    ++mResultCounter;
+}
+// </FS>
+
 const LLSD LLSpellChecker::getDictionaryData(const std::string& dict_language)
 {
     for (LLSD::array_const_iterator it = mDictMap.beginArray(); it != mDictMap.endArray(); ++it)
@@ -176,8 +315,13 @@ void LLSpellChecker::addToCustomDictionary(const std::string& word)
 {
     if (mHunspell)
     {
+        // <FS> Asynchronous spell checking
+        //mHunspell->add(word);
+        std::lock_guard<std::mutex> lock(mAsyncState->mHunspellMutex);
         mHunspell->add(word);
+        // </FS>
     }
+    clearWordCache(); // <FS/> Asynchronous spell checking
     addToDictFile(getDictionaryUserPath() + DICT_FILE_CUSTOM, word);
     sSettingsChangeSignal();
 }
@@ -267,6 +411,10 @@ void LLSpellChecker::setSecondaryDictionaries(dict_list_t dict_list)
     {
         const std::string app_path = getDictionaryAppPath();
         const std::string user_path = getDictionaryUserPath();
+        // <FS> Asynchronous spell checking
+        std::lock_guard<std::mutex> lock(mAsyncState->mHunspellMutex);
+        clearWordCache();
+        // </FS>
         for (dict_list_t::const_iterator it_added = dict_add.begin(); it_added != end_added; ++it_added)
         {
             const LLSD dict_entry = getDictionaryData(*it_added);
@@ -292,6 +440,7 @@ void LLSpellChecker::setSecondaryDictionaries(dict_list_t dict_list)
 
 void LLSpellChecker::initHunspell(const std::string& dict_language)
 {
+    clearWordCache(); // <FS/> Asynchronous spell checking
     if (mHunspell)
     {
         mHunspell.reset();
@@ -315,11 +464,17 @@ void LLSpellChecker::initHunspell(const std::string& dict_language)
         const std::string filename_dic = dict_entry["name"].asString() + ".dic";
         if ( (gDirUtilp->fileExists(user_path + filename_aff)) && (gDirUtilp->fileExists(user_path + filename_dic)) )
         {
-            mHunspell = std::make_unique<Hunspell>((user_path + filename_aff).c_str(), (user_path + filename_dic).c_str());
+            // <FS> Asynchronous spell checking
+            //mHunspell = std::make_unique<Hunspell>((user_path + filename_aff).c_str(), (user_path + filename_dic).c_str());
+            mHunspell = std::make_shared<Hunspell>((user_path + filename_aff).c_str(), (user_path + filename_dic).c_str());
+            // </FS>
         }
         else if ( (gDirUtilp->fileExists(app_path + filename_aff)) && (gDirUtilp->fileExists(app_path + filename_dic)) )
         {
-            mHunspell = std::make_unique<Hunspell>((app_path + filename_aff).c_str(), (app_path + filename_dic).c_str());
+            // <FS> Asynchronous spell checking
+            //mHunspell = std::make_unique<Hunspell>((app_path + filename_aff).c_str(), (app_path + filename_dic).c_str());
+            mHunspell = std::make_shared<Hunspell>((app_path + filename_aff).c_str(), (app_path + filename_dic).c_str());
+            // </FS>
         }
         if (!mHunspell)
         {
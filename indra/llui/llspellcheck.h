@@ -31,6 +31,12 @@
 #include "llui.h"
 #include "llinitdestroyclass.h"
 #include <boost/signals2.hpp>
+// <FS> Asynchronous spell checking
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+// </FS>
 
 class Hunspell;
 
@@ -44,9 +50,26 @@ public:
     void addToIgnoreList(const std::string& word);
     bool checkSpelling(const std::string& word) const;
     S32  getSuggestions(const std::string& word, std::vector<std::string>& suggestions) const;
+
+    // <FS> Asynchronous spell checking
+    enum ECheckResult
+    {
+        SPELL_CORRECT,
+        SPELL_MISSPELLED,
+        SPELL_PENDING       // looked up in the background, ask again later
+    };
+    // Like checkSpelling(), but answers from a per-word cache and leaves
+    // the Hunspell lookup of words it hasn't seen yet to a worker thread
+    ECheckResult checkSpellingCached(const std::string& word);
+    // Takes in finished lookups and hands words queued since the last call
+    // to the worker. The returned counter changes whenever a result came
+    // in, so callers know to check pending words again.
+    U32          updateCachedChecks();
+    // </FS>
 protected:
     void addToDictFile(const std::string& dict_path, const std::string& word);
     void initHunspell(const std::string& dict_language);
+    void clearWordCache(); // <FS/> Asynchronous spell checking
 
 public:
     typedef std::list<std::string> dict_list_t;
@@ -76,7 +99,35 @@ public:
     static boost::signals2::connection setSettingsChangeCallback(const settings_change_signal_t::slot_type& cb);
 
 protected:
-    std::unique_ptr<Hunspell>   mHunspell;
+    // <FS> Asynchronous spell checking
+    //std::unique_ptr<Hunspell>   mHunspell;
+    // Shared with lookups still running on the worker
+    std::shared_ptr<Hunspell>   mHunspell;
+
+    // Everything the worker touches, outlives the spell checker if needed
+    struct AsyncState
+    {
+        // Hunspell isn't thread safe, any use of it holds this
+        std::mutex                                  mHunspellMutex;
+        std::mutex                                  mResultMutex;
+        struct WordResult
+        {
+            std::string mWord;
+            U32         mGeneration;
+            bool        mCorrect;
+        };
+        std::vector<WordResult>                     mResults;
+        std::atomic<bool>                           mHasResults { false };
+    };
+    std::shared_ptr<AsyncState>                 mAsyncState;
+    // Hunspell's answer per word, without the ignore list applied
+    std::unordered_map<std::string, bool>       mWordCache;
+    std::unordered_set<std::string>             mPendingWords;
+    std::vector<std::string>                    mQueuedWords;
+    // Changes whenever the cache is cleared; older lookups are dropped
+    U32                                         mCacheGeneration;
+    U32                                         mResultCounter;
+    // </FS>
     std::string mDictLanguage;
     std::string mDictFile;
     dict_list_t mDictSecondary;
@@ -208,6 +208,7 @@ LLTextBase::LLTextBase(const LLTextBase::Params &p)
     mIsFriendSignal(NULL),
     mIsObjectBlockedSignal(NULL),
     mMaxTextByteLength( p.max_text_length ),
+    mMaxScrollbackLength(0), // <FS/> Scrollback limit
     mFont(p.font),
     mFontShadow(p.font_shadow),
     mPopupMenuHandle(),
@@ -217,6 +218,7 @@ LLTextBase::LLTextBase(const LLTextBase::Params &p)
     mSpellCheck(p.spellcheck),
     mSpellCheckStart(-1),
     mSpellCheckEnd(-1),
+    mSpellCheckResults(0), // <FS/> Asynchronous spell checking
     mCursorColor(p.cursor_color),
     mFgColor(p.text_color),
     mBorderVisible( p.border_visible ),
@@ -796,7 +798,11 @@ void LLTextBase::drawText()
         S32 start = line_start;
         S32 end   = getLineEnd(last_line);
 
-        if ( (mSpellCheckStart != start) || (mSpellCheckEnd != end) )
+        // <FS> Asynchronous spell checking
+        //if ( (mSpellCheckStart != start) || (mSpellCheckEnd != end) )
+        const U32 spell_check_results = LLSpellChecker::instance().updateCachedChecks();
+        if ( (mSpellCheckStart != start) || (mSpellCheckEnd != end) || (mSpellCheckResults != spell_check_results) )
+        // </FS>
         {
             const LLWString& wstrText = getWText();
             mMisspellRanges.clear();
@@ -858,7 +864,10 @@ void LLTextBase::drawText()
                         std::string word = wstring_to_utf8str(wstrText.substr(word_start, word_end - word_start));
 
                         // Don't process words shorter than 3 characters
-                        if ( (word.length() >= 3) && (!LLSpellChecker::instance().checkSpelling(word)) )
+                        // <FS> Asynchronous spell checking, words still being looked up are underlined once known
+                        //if ( (word.length() >= 3) && (!LLSpellChecker::instance().checkSpelling(word)) )
+                        if ( (word.length() >= 3) && (LLSpellChecker::SPELL_MISSPELLED == LLSpellChecker::instance().checkSpellingCached(word)) )
+                        // </FS>
                         {
                             mMisspellRanges.push_back(std::pair<U32, U32>(word_start, word_end));
                         }
@@ -875,6 +884,7 @@ void LLTextBase::drawText()
 
             mSpellCheckStart = start;
             mSpellCheckEnd = end;
+            mSpellCheckResults = spell_check_results; // <FS/> Asynchronous spell checking
         }
     }
     else
@@ -1829,6 +1839,7 @@ void LLTextBase::reflow()
 
         S32 start_index = mReflowIndex;
         mReflowIndex = S32_MAX;
+        S32 layout_start_index = 0; // <FS/> Incremental text layout
 
         // shrink document to minimum size (visible portion of text widget)
         // to force inlined widgets with follows set to shrink
@@ -1858,6 +1869,7 @@ void LLTextBase::reflow()
                 cur_top = iter->mRect.mTop;
                 getSegmentAndOffset(iter->mDocIndexStart, &seg_iter, &seg_offset);
                 mLineInfoList.erase(iter, mLineInfoList.end());
+                layout_start_index = line_start_index; // <FS/> Incremental text layout
             }
         }
 
@@ -1958,6 +1970,14 @@ void LLTextBase::reflow()
             ++segment_it)
         {
             LLTextSegmentPtr segmentp = *segment_it;
+            // <FS> Incremental text layout
+            // Lines before the reflowed ones kept their layout, only views
+            // placed in document coordinates have to follow the document
+            if (segmentp->getEnd() <= layout_start_index && !segmentp->positionsView())
+            {
+                continue;
+            }
+            // </FS>
             segmentp->updateLayout(*this);
 
         }
@@ -2638,6 +2658,13 @@ void LLTextBase::needsReflow(S32 index)
     LL_DEBUGS() << "reflow on object " << (void*)this << " index = " << mReflowIndex << ", new index = " << index << LL_ENDL;
     mReflowIndex = llmin(mReflowIndex, index);
 
+    // <FS> UI buffer
+    if (sDirtyRectTracking)
+    {
+        LLView::dirtyRect();
+    }
+    // </FS>
+
 // [SL:KB] - Patch: Control-TextHighlight | Checked: 2013-12-30 (Catznip-3.6)
     mHighlightsDirty = true;
 // [/SL:KB]
@@ -2655,6 +2682,40 @@ S32 LLTextBase::removeFirstLine()
     return 0;
 }
 
+// <FS> Scrollback limit
+S32 LLTextBase::trimScrollback()
+{
+    if (mMaxScrollbackLength <= 0 || getLength() <= mMaxScrollbackLength)
+    {
+        return 0;
+    }
+
+    // Trim a quarter more than needed, so the full reflow this causes
+    // happens once per many appends instead of with every one of them
+    const LLWString& text = getWText();
+    size_t line_end = text.find(L'\n', getLength() - (mMaxScrollbackLength / 4) * 3);
+    if (line_end == LLWString::npos)
+    {
+        return 0;
+    }
+    S32 length = (S32)line_end + 1;
+
+    if (mSelectionStart < length || mSelectionEnd < length)
+    {
+        deselect();
+    }
+    else
+    {
+        mSelectionStart -= length;
+        mSelectionEnd -= length;
+    }
+    removeStringNoUndo(0, length);
+    mCursorPos = llmax(0, mCursorPos - length);
+    mScrollIndex = llmax(0, mScrollIndex - length);
+    return length;
+}
+// </FS>
+
 // virtual
 void LLTextBase::copyContents(const LLTextBase* source)
 {
@@ -84,6 +84,11 @@ public:
     */
     virtual S32                 getNumChars(S32 num_pixels, S32 segment_offset, S32 line_offset, S32 max_chars, S32 line_ind) const;
     virtual void                updateLayout(const class LLTextBase& editor);
+    // <FS> Incremental text layout
+    // True if updateLayout() places something in document coordinates,
+    // which move whenever the document grows
+    virtual bool                positionsView() const { return false; }
+    // </FS>
     virtual F32                 draw(S32 start, S32 end, S32 selection_start, S32 selection_end, const LLRectf& draw_rect);
     virtual bool                canEdit() const;
     virtual void                unlinkFromDocument(class LLTextBase* editor);
@@ -249,6 +254,7 @@ public:
     /*virtual*/ bool        getDimensionsF32(S32 first_char, S32 num_chars, F32& width, S32& height) const;
     /*virtual*/ S32         getNumChars(S32 num_pixels, S32 segment_offset, S32 line_offset, S32 max_chars, S32 line_ind) const;
     /*virtual*/ void        updateLayout(const class LLTextBase& editor);
+    /*virtual*/ bool        positionsView() const { return true; } // <FS/> Incremental text layout
     /*virtual*/ F32         draw(S32 start, S32 end, S32 selection_start, S32 selection_end, const LLRectf& draw_rect);
     /*virtual*/ bool        canEdit() const { return false; }
     /*virtual*/ void        unlinkFromDocument(class LLTextBase* editor);
@@ -508,6 +514,12 @@ public:
     S32                     getLength() const { return static_cast<S32>(getWText().length()); }
     S32                     getLineCount() const { return static_cast<S32>(mLineInfoList.size()); }
     S32                     removeFirstLine(); // returns removed length
+    // <FS> Scrollback limit
+    // Once the text is longer than length characters, whole lines are removed
+    // from the top until it is down to three quarters of it. 0 disables it.
+    void                    setMaxScrollbackLength(S32 length) { mMaxScrollbackLength = length; }
+    S32                     trimScrollback(); // returns removed length
+    // </FS>
 
     void                    addDocumentChild(LLView* view);
     void                    removeDocumentChild(LLView* view);
@@ -779,6 +791,7 @@ protected:
     bool                        mSpellCheck;
     S32                         mSpellCheckStart;
     S32                         mSpellCheckEnd;
+    U32                         mSpellCheckResults; // <FS/> Asynchronous spell checking
     LLTimer                     mSpellCheckTimer;
     std::list<std::pair<U32, U32> > mMisspellRanges;
     std::vector<std::string>        mSuggestionList;
@@ -816,6 +829,7 @@ protected:
     bool                        mPlainText;         // didn't use Image or Icon segments
     bool                        mAutoIndent;
     S32                         mMaxTextByteLength; // Maximum length mText is allowed to be in bytes
+    S32                         mMaxScrollbackLength; // <FS/> Scrollback limit, in characters
     bool                        mSkipTripleClick;
     bool                        mAlwaysShowIcons;
 
@@ -36,6 +36,7 @@
 #include "lltabcontainer.h"
 #include "llaccordionctrltab.h"
 #include "lluiusage.h"
+#include "llsdutil.h" // <FS/> UI buffer
 
 static LLDefaultChildRegistry::Register<LLUICtrl> r("ui_ctrl");
 
@@ -455,6 +456,12 @@ bool LLUICtrl::isCtrl() const
 //virtual
 void LLUICtrl::setValue(const LLSD& value)
 {
+    // <FS> UI buffer
+    if (sDirtyRectTracking && !llsd_equals(mViewModel->getValue(), value))
+    {
+        LLView::dirtyRect();
+    }
+    // </FS>
     mViewModel->setValue(value);
 }
 
@@ -43,6 +43,8 @@
 
 // this library includes
 #include "llpanel.h"
+#include "llfile.h" // <FS/> XUI cache
+#include "llui.h" // <FS/> XUI cache
 
 //-----------------------------------------------------------------------------
 
@@ -183,9 +185,75 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
         paths.push_back(xui_filename);
     }
 
-    return LLXMLNode::getLayeredXMLNode(root, paths);
+    // <FS> XUI cache
+    //return LLXMLNode::getLayeredXMLNode(root, paths);
+    return instance().getCachedLayeredXMLNode(paths, root);
+    // </FS>
 }
 
+// <FS> XUI cache
+// Floaters and panels that are built over and over, like IM floaters,
+// toasts and chat headers, copy the merged tree instead of reading and
+// parsing every layer of it again.
+bool LLUICtrlFactory::getCachedLayeredXMLNode(const std::vector<std::string>& paths, LLXMLNodePtr& root)
+{
+    static LLUICachedControl<bool> use_cache("FSCacheLayeredXUI", true);
+    if (!use_cache)
+    {
+        mXMLNodeCache.clear();
+        return LLXMLNode::getLayeredXMLNode(root, paths);
+    }
+
+    std::string key;
+    std::vector<std::pair<S64, S64> > stamps;
+    stamps.reserve(paths.size());
+    for (const std::string& path : paths)
+    {
+        key += path;
+        key += '\n';
+        if (path.empty())
+        {
+            stamps.emplace_back(-1, -1);
+            continue;
+        }
+        llstat stat_data;
+        if (LLFile::stat(path, &stat_data) != 0)
+        {
+            // Let the parser report it
+            return LLXMLNode::getLayeredXMLNode(root, paths);
+        }
+        stamps.emplace_back((S64)stat_data.st_size, (S64)stat_data.st_mtime);
+    }
+
+    auto it = mXMLNodeCache.find(key);
+    if (it != mXMLNodeCache.end())
+    {
+        if (it->second.mFileStamps == stamps)
+        {
+            root = it->second.mRoot->cloneTree();
+            return true;
+        }
+        mXMLNodeCache.erase(it);
+    }
+
+    if (!LLXMLNode::getLayeredXMLNode(root, paths))
+    {
+        return false;
+    }
+
+    // Callers are free to modify what they get, the cache keeps its own copy
+    CachedXMLNode& entry = mXMLNodeCache[key];
+    entry.mFileStamps.swap(stamps);
+    entry.mRoot = root->cloneTree();
+    for (const auto& stamp : entry.mFileStamps)
+    {
+        entry.mBytes += llmax(stamp.first, (S64)0);
+    }
+    LLMemAccounting::claim(LLMemTag::UI, entry.mBytes);
+    return true;
+}
+// </FS>
+
 
 //-----------------------------------------------------------------------------
 // saveToXML()
@@ -35,6 +35,9 @@
 #include "lldir.h"
 #include "llsingleton.h"
 #include "llheteromap.h"
+#include "llmemory.h" // <FS/> Memory accounting
+
+#include <unordered_map> // <FS/> XUI cache
 
 class LLView;
 void deleteView(LLView*); // Inside LLView.cpp, avoid having to potentially delete an incomplete type here.
@@ -206,6 +209,10 @@ private:
 
     static void loadWidgetTemplate(const std::string& widget_tag, LLInitParam::BaseBlock& block);
 
+    // <FS> XUI cache
+    bool getCachedLayeredXMLNode(const std::vector<std::string>& paths, LLXMLNodePtr& root);
+    // </FS>
+
     template<typename T>
     static T* createWidgetImpl(const typename T::Params& params, LLView* parent = NULL)
     {
@@ -284,6 +291,25 @@ private:
     // This is simply a cache looked up by type. Its lifespan is tied to
     // LLUICtrlFactory. Use LLHeteroMap for this cache.
     LLHeteroMap mParamDefaultsMap;
+
+    // <FS> XUI cache
+    // Merged trees of layered XUI files, by the list of files they were
+    // built from. Each keeps size and modification time of those files and
+    // is dropped once they change.
+    struct CachedXMLNode
+    {
+        // Accounted to LLMemTag::UI with the size of the files as an
+        // estimate, the tree itself isn't measured
+        CachedXMLNode() = default;
+        CachedXMLNode(const CachedXMLNode&) = delete;
+        CachedXMLNode& operator=(const CachedXMLNode&) = delete;
+        ~CachedXMLNode() { LLMemAccounting::disclaim(LLMemTag::UI, mBytes); }
+        S64                                 mBytes = 0;
+        std::vector<std::pair<S64, S64> >   mFileStamps;
+        LLXMLNodePtr                        mRoot;
+    };
+    std::unordered_map<std::string, CachedXMLNode> mXMLNodeCache;
+    // </FS>
 };
 
 template <typename PARAM_BLOCK, int DUMMY>
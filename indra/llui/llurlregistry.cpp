@@ -38,6 +38,7 @@ void LLUrlRegistryNullCallback(const std::string &url, const std::string &label,
 }
 
 LLUrlRegistry::LLUrlRegistry()
+    : mCombinedMatching(true) // <FS> Combined URL matching
 {
 //  mUrlEntry.reserve(20);
 // [RLVa:KB] - Checked: 2010-11-01 (RLVa-1.2.2a) | Added: RLVa-1.2.2a
@@ -122,25 +123,19 @@ void LLUrlRegistry::registerUrl(LLUrlEntryBase *url, bool force_front)
             mUrlEntry.insert(mUrlEntry.begin(), url);
         else
         mUrlEntry.push_back(url);
+
+        // <FS> Combined URL matching
+        for (CombinedPattern& combined : mCombinedPatterns)
+        {
+            combined.mBuilt = false;
+        }
+        // </FS>
     }
 }
 
-static bool matchRegex(const char *text, boost::regex regex, U32 &start, U32 &end)
+// <FS> Combined URL matching
+static void trimMatchEnd(const char *text, U32 start, U32 &end)
 {
-    boost::cmatch result;
-    bool found;
-
-    found = ll_regex_search(text, result, regex);
-
-    if (! found)
-    {
-        return false;
-    }
-
-    // return the first/last character offset for the matched substring
-    start = static_cast<U32>(result[0].first - text);
-    end = static_cast<U32>(result[0].second - text) - 1;
-
     // we allow certain punctuation to terminate a Url but not match it,
     // e.g., "http://foo.com/." should just match "http://foo.com/"
     if (text[end] == '.' || text[end] == ',')
@@ -158,9 +153,29 @@ static bool matchRegex(const char *text, boost::regex regex, U32 &start, U32 &en
     {
             end--;
     }
+}
+
+static bool matchRegex(const char *text, boost::regex regex, U32 &start, U32 &end)
+{
+    boost::cmatch result;
+    bool found;
+
+    found = ll_regex_search(text, result, regex);
+
+    if (! found)
+    {
+        return false;
+    }
+
+    // return the first/last character offset for the matched substring
+    start = static_cast<U32>(result[0].first - text);
+    end = static_cast<U32>(result[0].second - text) - 1;
+
+    trimMatchEnd(text, start, end);
 
     return true;
 }
+// </FS>
 
 static bool stringHasUrl(const std::string &text)
 {
@@ -219,6 +234,130 @@ static bool stringHasJira(const std::string &text)
             text.find("WEB") != std::string::npos);
 }
 
+// <FS> Combined URL matching
+void LLUrlRegistry::buildCombinedPattern(CombinedPattern& combined, bool skip_icon)
+{
+    combined.mBuilt = true;
+    combined.mValid = false;
+    combined.mEntries.clear();
+    combined.mGroups.clear();
+
+    // Each pattern becomes a capture group of its own, in registration
+    // order. At the leftmost position where any of them matches, perl
+    // semantics take the first alternative that matches there, which is
+    // the entry the per-entry loop would pick as well.
+    std::string expression;
+    size_t group = 1;
+    for (LLUrlEntryBase* url_entry : mUrlEntry)
+    {
+        if (skip_icon && url_entry == mUrlEntryIcon)
+        {
+            continue;
+        }
+
+        const boost::regex pattern = url_entry->getPattern();
+        if (pattern.empty() || (pattern.flags() & ~(boost::regex::perl | boost::regex::icase)))
+        {
+            // Nothing in the tree does this, but it wouldn't survive
+            // being inlined into the alternation
+            return;
+        }
+
+        if (!expression.empty())
+        {
+            expression += '|';
+        }
+        expression += (pattern.flags() & boost::regex::icase) ? "((?i:" : "((?-i:";
+        expression += pattern.str();
+        expression += "))";
+
+        combined.mEntries.push_back(url_entry);
+        combined.mGroups.push_back(group);
+        group += 1 + pattern.mark_count();
+    }
+
+    try
+    {
+        combined.mPattern.assign(expression, boost::regex::perl);
+    }
+    catch (const std::runtime_error& e)
+    {
+        LL_WARNS() << "Could not combine URL patterns: " << e.what() << LL_ENDL;
+        return;
+    }
+
+    // Group numbers only line up if no entry relies on its own numbering
+    combined.mValid = (combined.mPattern.mark_count() + 1 == group);
+    if (!combined.mValid)
+    {
+        LL_WARNS() << "Combined URL pattern has " << combined.mPattern.mark_count()
+                   << " groups instead of " << group - 1 << LL_ENDL;
+    }
+}
+
+bool LLUrlRegistry::findCombinedMatch(const std::string& text, bool skip_icon,
+                                      U32& match_start, U32& match_end, LLUrlEntryBase*& match_entry)
+{
+    CombinedPattern& combined = mCombinedPatterns[skip_icon ? 1 : 0];
+    if (!combined.mBuilt)
+    {
+        buildCombinedPattern(combined, skip_icon);
+    }
+    if (!combined.mValid)
+    {
+        return false;
+    }
+
+    boost::cmatch result;
+    try
+    {
+        if (!boost::regex_search(text.c_str(), result, combined.mPattern))
+        {
+            match_entry = NULL;
+            return true;
+        }
+    }
+    catch (const std::runtime_error& e)
+    {
+        // Too complex as a whole, the single patterns may still cope
+        LL_WARNS() << "error searching with the combined URL pattern: " << e.what() << LL_ENDL;
+        return false;
+    }
+
+    for (size_t i = 0; i < combined.mEntries.size(); ++i)
+    {
+        if (!result[combined.mGroups[i]].matched)
+        {
+            continue;
+        }
+
+        LLUrlEntryBase* url_entry = combined.mEntries[i];
+        U32 start = static_cast<U32>(result[0].first - text.c_str());
+        U32 end = static_cast<U32>(result[0].second - text.c_str()) - 1;
+        trimMatchEnd(text.c_str(), start, end);
+
+        // Rejected matches let a later entry win at the same position,
+        // which one alternation can't express
+        if (url_entry == mLLUrlEntryInvalidSLURL && url_entry->isSLURLvalid(text.substr(start, end - start + 1)))
+        {
+            return false;
+        }
+        if ((url_entry == mUrlEntryHTTPLabel || url_entry == mUrlEntrySLLabel) &&
+            !url_entry->isWikiLinkCorrect(text.substr(start, end - start + 1)))
+        {
+            return false;
+        }
+
+        match_start = start;
+        match_end = end;
+        match_entry = url_entry;
+        return true;
+    }
+
+    return false;
+}
+// </FS>
+
 bool LLUrlRegistry::findUrl(const std::string &text, LLUrlMatch &match, const LLUrlLabelCallback &cb, bool is_content_trusted)
 {
     // avoid costly regexes if there is clearly no URL in the text
@@ -231,8 +370,22 @@ bool LLUrlRegistry::findUrl(const std::string &text, LLUrlMatch &match, const LL
     U32 match_start = 0, match_end = 0;
     LLUrlEntryBase *match_entry = NULL;
 
+    // <FS> Combined URL matching
+    // The wear folder entry ends the search wherever it matches, not only
+    // at the leftmost position, so texts with one take the long way
+    bool matched_combined = false;
+    if (mCombinedMatching && !boost::ifind_first(text, "wear_folder"))
+    {
+        const bool skip_icon = (text.find("Hand") != std::string::npos) || !is_content_trusted;
+        matched_combined = findCombinedMatch(text, skip_icon, match_start, match_end, match_entry);
+    }
+    // </FS>
+
     std::vector<LLUrlEntryBase *>::iterator it;
-    for (it = mUrlEntry.begin(); it != mUrlEntry.end(); ++it)
+    // <FS> Combined URL matching
+    //for (it = mUrlEntry.begin(); it != mUrlEntry.end(); ++it)
+    for (it = mUrlEntry.begin(); !matched_combined && it != mUrlEntry.end(); ++it)
+    // </FS>
     {
         //Skip for url entry icon if content is not trusted
         if((mUrlEntryIcon == *it) && ((text.find("Hand") != std::string::npos) || !is_content_trusted))
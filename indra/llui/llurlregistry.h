@@ -93,7 +93,32 @@ public:
     // Set handler for url registry to be capable of parsing and populating keybindings
     void setKeybindingHandler(LLKeyBindingToStringHandler* handler);
 
+    // <FS> Combined URL matching
+    // Match all entries with one alternation of their patterns instead of
+    // running every pattern over the text separately
+    void setCombinedMatching(bool enabled) { mCombinedMatching = enabled; }
+    // </FS>
+
 private:
+    // <FS> Combined URL matching
+    struct CombinedPattern
+    {
+        bool                            mBuilt = false;
+        bool                            mValid = false;
+        boost::regex                    mPattern;
+        std::vector<LLUrlEntryBase*>    mEntries;
+        // Index of the capture group that wraps each entry's pattern
+        std::vector<size_t>             mGroups;
+    };
+
+    void buildCombinedPattern(CombinedPattern& combined, bool skip_icon);
+    // False if the combined pattern can't decide and the entries have to
+    // be matched one by one; true otherwise, with match_entry NULL when
+    // there is no Url in the text.
+    bool findCombinedMatch(const std::string& text, bool skip_icon,
+                           U32& match_start, U32& match_end, LLUrlEntryBase*& match_entry);
+    // </FS>
+
     std::vector<LLUrlEntryBase *> mUrlEntry;
     LLUrlEntryBase* mUrlEntryTrusted;
     LLUrlEntryBase* mUrlEntryIcon;
@@ -106,6 +131,11 @@ private:
     LLUrlEntryBase* mUrlEntryTrustedUrl;
     // <FS:Ansariel> Wear folder SLUrl
     LLUrlEntryBase* mUrlEntryWear;
+
+    // <FS> Combined URL matching, second pattern leaves out the icon entry
+    CombinedPattern mCombinedPatterns[2];
+    bool mCombinedMatching;
+    // </FS>
 };
 
 #endif
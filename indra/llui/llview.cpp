@@ -63,6 +63,7 @@ bool    LLView::sDebugUnicode = false;
 bool    LLView::sDebugCamera = false;
 bool    LLView::sIsRectDirty = false;
 LLRect  LLView::sDirtyRect;
+bool    LLView::sDirtyRectTracking = false; // <FS/> UI buffer
 bool    LLView::sDebugRectsShowNames = true;
 bool    LLView::sDebugKeys = false;
 bool    LLView::sDebugMouseHandling = false;
@@ -221,6 +222,13 @@ bool LLView::isPanel() const
     return false;
 }
 
+// <FS> UI buffer
+bool LLView::isFloater() const
+{
+    return false;
+}
+// </FS>
+
 void LLView::setToolTip(const LLStringExplicit& msg)
 {
     // <FS:ND> LLUIString comes with a tax of 92 byte (Numbers apply to Win32).
@@ -1345,7 +1353,12 @@ void LLView::dirtyRect()
     LLView* child = getParent();
     LLView* parent = child ? child->getParent() : NULL;
     LLView* cur = this;
-    while (child && parent && parent->getParent())
+    // <FS> UI buffer
+    // Floaters sit several levels below the screen sized views, so the
+    // third to top-most view would dirty the whole screen for them
+    //while (child && parent && parent->getParent())
+    while (child && parent && parent->getParent() && !cur->isFloater())
+    // </FS>
     { //find third to top-most view
         cur = child;
         child = parent;
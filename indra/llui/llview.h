@@ -216,6 +216,8 @@ public:
 
     virtual bool isPanel() const;
 
+    virtual bool isFloater() const; // <FS/> UI buffer
+
     //
     // MANIPULATORS
     //
@@ -677,6 +679,11 @@ public:
 
     static bool sIsRectDirty;
     static LLRect sDirtyRect;
+    // <FS> UI buffer
+    // Set while the UI is drawn into a buffer that is only redrawn where
+    // dirty, so changes that don't dirty the rect otherwise report it
+    static bool sDirtyRectTracking;
+    // </FS>
 
     // Draw widget names and sizes when drawing debug rectangles, turning this
     // off is useful to make the rectangles themselves easier to see.
@@ -44,6 +44,7 @@
 #include "llrect.h"
 #include "llxmltree.h"
 #include "llsdserialize.h"
+#include "llsdutil.h" // <FS/> Settings snapshot
 #include "llfile.h"
 #include "lltimer.h"
 #include "lldir.h"
@@ -423,6 +424,27 @@ LLPointer<LLControlVariable> LLControlGroup::getControl(std::string_view name)
     return iter == mNameTable.end() ? LLPointer<LLControlVariable>() : iter->second;
 }
 
+// <FS> Keyed settings access
+std::string LLControlGroup::sSnapshotDir;
+
+LLControlVariable* LLControlGroup::bindKey(U32 index, std::string_view name)
+{
+    ctrl_name_table_t::iterator iter = mNameTable.find(name);
+    if (iter == mNameTable.end())
+    {
+        // Not declared (yet), look again next time
+        return nullptr;
+    }
+
+    if (index >= mKeyedControls.size())
+    {
+        mKeyedControls.resize(index + 1, nullptr);
+    }
+    mKeyedControls[index] = iter->second.get();
+    return mKeyedControls[index];
+}
+// </FS>
+
 
 ////////////////////////////////////////////////////////////////////////////
 
@@ -529,6 +551,7 @@ void LLControlGroup::cleanup()
     }
 
     mNameTable.clear();
+    mKeyedControls.clear(); // <FS/> Keyed settings access
 }
 
 eControlType LLControlGroup::typeStringToEnum(const std::string& typestr)
@@ -1093,20 +1116,45 @@ U32 LLControlGroup::saveToFile(const std::string& filename, bool nondefault_only
 U32 LLControlGroup::loadFromFile(const std::string& filename, bool set_default_values, bool save_values)
 {
     LLSD settings;
-    llifstream infile;
-    infile.open(filename.c_str());
-    if(!infile.is_open())
+    // <FS> Settings snapshot
+    //llifstream infile;
+    //infile.open(filename.c_str());
+    //if(!infile.is_open())
+    //{
+    //    LL_WARNS("Settings") << "Cannot find file " << filename << " to load." << LL_ENDL;
+    //    return 0;
+    //}
+    //
+    //if (LLSDParser::PARSE_FAILURE == LLSDSerialize::fromXML(settings, infile))
+    //{
+    //    infile.close();
+    //    LL_WARNS("Settings") << "Unable to parse LLSD control file " << filename << ". Trying Legacy Method." << LL_ENDL;
+    //    return loadFromFileLegacy(filename, true, TYPE_STRING);
+    //}
+    const bool use_snapshot = set_default_values && !sSnapshotDir.empty();
+    if (!use_snapshot || !loadSnapshot(filename, settings))
     {
-        LL_WARNS("Settings") << "Cannot find file " << filename << " to load." << LL_ENDL;
-        return 0;
-    }
+        llifstream infile;
+        infile.open(filename.c_str());
+        if(!infile.is_open())
+        {
+            LL_WARNS("Settings") << "Cannot find file " << filename << " to load." << LL_ENDL;
+            return 0;
+        }
 
-    if (LLSDParser::PARSE_FAILURE == LLSDSerialize::fromXML(settings, infile))
-    {
-        infile.close();
-        LL_WARNS("Settings") << "Unable to parse LLSD control file " << filename << ". Trying Legacy Method." << LL_ENDL;
-        return loadFromFileLegacy(filename, true, TYPE_STRING);
+        if (LLSDParser::PARSE_FAILURE == LLSDSerialize::fromXML(settings, infile))
+        {
+            infile.close();
+            LL_WARNS("Settings") << "Unable to parse LLSD control file " << filename << ". Trying Legacy Method." << LL_ENDL;
+            return loadFromFileLegacy(filename, true, TYPE_STRING);
+        }
+
+        if (use_snapshot)
+        {
+            saveSnapshot(filename, settings);
+        }
     }
+    // </FS>
 
     U32 validitems = 0;
     bool hidefromsettingseditor = false;
@@ -1234,6 +1282,95 @@ U32 LLControlGroup::loadFromFile(const std::string& filename, bool set_default_v
     return validitems;
 }
 
+// <FS> Settings snapshot
+namespace
+{
+    // Bump when the layout of the snapshot changes
+    constexpr S32 SNAPSHOT_VERSION = 1;
+
+    bool get_source_stamp(const std::string& filename, LLSD& stamp)
+    {
+        llstat status;
+        if (LLFile::stat(filename, &status) != 0)
+        {
+            return false;
+        }
+        stamp["version"] = SNAPSHOT_VERSION;
+        stamp["source"] = filename;
+        stamp["size"] = (LLSD::Real)status.st_size;
+        stamp["mtime"] = (LLSD::Real)status.st_mtime;
+        return true;
+    }
+}
+
+std::string LLControlGroup::getSnapshotFilename(const std::string& filename) const
+{
+    return sSnapshotDir + gDirUtilp->getDirDelimiter() + "snapshot_" + getKey() + "_" + gDirUtilp->getBaseFileName(filename, true) + ".llsd";
+}
+
+bool LLControlGroup::loadSnapshot(const std::string& filename, LLSD& settings)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    LLSD stamp;
+    if (!get_source_stamp(filename, stamp))
+    {
+        return false;
+    }
+
+    const std::string snapshot_name = getSnapshotFilename(filename);
+    llifstream infile(snapshot_name.c_str(), std::ios::in | std::ios::binary);
+    if (!infile.is_open())
+    {
+        return false;
+    }
+
+    LLSD snapshot;
+    if (LLSDParser::PARSE_FAILURE == LLSDSerialize::fromBinary(snapshot, infile, LLSDSerialize::SIZE_UNLIMITED)
+        || !llsd_equals(snapshot["stamp"], stamp))
+    {
+        LL_INFOS("Settings") << "Settings snapshot " << snapshot_name << " is out of date" << LL_ENDL;
+        return false;
+    }
+
+    settings = snapshot["settings"];
+    LL_DEBUGS("Settings") << "Read " << filename << " from snapshot " << snapshot_name << LL_ENDL;
+    return settings.isMap();
+}
+
+void LLControlGroup::saveSnapshot(const std::string& filename, const LLSD& settings)
+{
+    LLSD snapshot;
+    if (!get_source_stamp(filename, snapshot["stamp"]))
+    {
+        return;
+    }
+    snapshot["settings"] = settings;
+
+    // Written next to the final name and renamed, so another viewer never
+    // reads half a snapshot
+    const std::string snapshot_name = getSnapshotFilename(filename);
+    const std::string temp_name = snapshot_name + ".tmp";
+    {
+        llofstream outfile(temp_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!outfile.is_open())
+        {
+            LL_WARNS("Settings") << "Unable to write settings snapshot " << temp_name << LL_ENDL;
+            return;
+        }
+        LLSDSerialize::toBinary(snapshot, outfile);
+        if (outfile.fail())
+        {
+            outfile.close();
+            LLFile::remove(temp_name);
+            return;
+        }
+    }
+    LLFile::remove(snapshot_name, ENOENT);
+    LLFile::rename(temp_name, snapshot_name);
+}
+// </FS>
+
 void LLControlGroup::resetToDefaults()
 {
     ctrl_name_table_t::iterator control_iter;
@@ -196,6 +196,19 @@ T convert_from_llsd(const LLSD& sd, eControlType type, std::string_view control_
     return T(sd);
 }
 
+// <FS> Keyed settings access
+// Names a control of a known type by a slot number. fs_settings_keys.py
+// generates one for every setting in settings.xml at build time; after the
+// first use a lookup through a key is an index into a table instead of a
+// search of the name table.
+template <typename T>
+struct LLControlKey
+{
+    U32         mIndex;
+    const char* mName;
+};
+// </FS>
+
 //const U32 STRING_CACHE_SIZE = 10000;
 class LLControlGroup : public LLInstanceTracker<LLControlGroup, std::string>
 {
@@ -317,6 +330,58 @@ public:
 
     bool    controlExists(std::string_view name);
 
+    // <FS> Keyed settings access
+    // Same as the accessors by name, on the main thread only. The control
+    // is looked up by name once and remembered in the slot of the key.
+    template<typename T> LLControlVariable* getControl(const LLControlKey<T>& key)
+    {
+        if (mSettingsProfile)
+        {
+            incrCount(key.mName);
+        }
+        if (key.mIndex < mKeyedControls.size() && mKeyedControls[key.mIndex])
+        {
+            return mKeyedControls[key.mIndex];
+        }
+        return bindKey(key.mIndex, key.mName);
+    }
+
+    template<typename T> T get(const LLControlKey<T>& key)
+    {
+        LLControlVariable* control = getControl(key);
+        if (!control)
+        {
+            LL_WARNS() << "Control " << key.mName << " not found." << LL_ENDL;
+            return T();
+        }
+        return convert_from_llsd<T>(control->get(), control->type(), key.mName);
+    }
+
+    template<typename T> void set(const LLControlKey<T>& key, const T& val)
+    {
+        LLControlVariable* control = getControl(key);
+        if (control && control->isType(get_control_type<T>()))
+        {
+            control->set(convert_to_llsd(val));
+        }
+        else
+        {
+            LL_WARNS() << "Invalid control " << key.mName << LL_ENDL;
+        }
+    }
+
+    template<typename T> LLControlVariable::commit_signal_t* getSignal(const LLControlKey<T>& key)
+    {
+        LLControlVariable* control = getControl(key);
+        return control ? control->getSignal() : nullptr;
+    }
+
+    // Parsed default settings files are kept in this directory as binary
+    // LLSD and read from there while the file is unchanged. Empty, the
+    // default, always parses the XML.
+    static void setSnapshotDir(const std::string& dir) { sSnapshotDir = dir; }
+    // </FS>
+
     // Returns number of controls loaded, 0 if failed
     // If require_declaration is false, will auto-declare controls it finds
     // as the given type.
@@ -327,6 +392,20 @@ public:
     void    incrCount(std::string_view name);
 
     bool    mSettingsProfile;
+
+    // <FS> Keyed settings access
+private:
+    LLControlVariable* bindKey(U32 index, std::string_view name);
+    bool loadSnapshot(const std::string& filename, LLSD& settings);
+    void saveSnapshot(const std::string& filename, const LLSD& settings);
+    std::string getSnapshotFilename(const std::string& filename) const;
+
+    // Controls by key slot. The name table keeps them alive and only drops
+    // them in cleanup(), which clears this as well.
+    std::vector<LLControlVariable*> mKeyedControls;
+
+    static std::string sSnapshotDir;
+    // </FS>
 };
 
 
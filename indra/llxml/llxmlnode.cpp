@@ -161,6 +161,27 @@ LLXMLNodePtr LLXMLNode::deepCopy()
     return newnode;
 }
 
+// <FS> XUI cache
+LLXMLNodePtr LLXMLNode::cloneTree() const
+{
+    LLXMLNodePtr newnode = LLXMLNodePtr(new LLXMLNode(*this));
+    newnode->mLineNumber = mLineNumber;
+    for (LLXMLAttribList::const_iterator iter = mAttributes.begin();
+         iter != mAttributes.end(); ++iter)
+    {
+        LLXMLNodePtr attribute(iter->second->cloneTree());
+        newnode->addChild(attribute);
+    }
+    for (LLXMLNodePtr child = getFirstChild(); child.notNull(); child = child->getNextSibling())
+    {
+        LLXMLNodePtr child_copy(child->cloneTree());
+        newnode->addChild(child_copy);
+    }
+
+    return newnode;
+}
+// </FS>
+
 // virtual
 LLXMLNode::~LLXMLNode()
 {
@@ -123,6 +123,10 @@ public:
     LLXMLNode(LLStringTableEntry* name, bool is_attribute);
     LLXMLNode(const LLXMLNode& rhs);
     LLXMLNodePtr deepCopy();
+    // <FS> XUI cache
+    // Like deepCopy(), but keeps children in document order and line numbers
+    LLXMLNodePtr cloneTree() const;
+    // </FS>
 
     bool isNull();
 
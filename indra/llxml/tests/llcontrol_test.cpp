@@ -151,4 +151,63 @@ namespace tut
         ensure("listener fired on changed setting", mListenerFired);
     }
 
+    // keyed access
+    template<> template<>
+    void control_group_t::test<5>()
+    {
+        constexpr LLControlKey<U32> TestSetting{ 3, "TestSetting" };
+        constexpr LLControlKey<bool> MissingSetting{ 7, "MissingSetting" };
+
+        ensure_equals("undeclared control reads default", mCG->get(TestSetting), 0U);
+        mCG->loadFromFile(mTestConfigFile.c_str(), true);
+        ensure_equals("value by key", mCG->get(TestSetting), 12U);
+        ensure("same control as by name", mCG->getControl(TestSetting) == mCG->getControl("TestSetting").get());
+
+        mListenerFired = false;
+        mCG->getSignal(TestSetting)->connect(boost::bind(&this->handleListenerTest));
+        mCG->set(TestSetting, 14U);
+        ensure_equals("value by name", mCG->getU32("TestSetting"), 14U);
+        ensure("listener fired on keyed set", mListenerFired);
+
+        ensure("missing control", !mCG->getControl(MissingSetting));
+        mCG->declareBOOL("MissingSetting", true, "Declared after the first lookup");
+        ensure("declared later", mCG->get(MissingSetting));
+    }
+
+    // settings snapshot
+    template<> template<>
+    void control_group_t::test<6>()
+    {
+        LLControlGroup::setSnapshotDir(mTestConfigDir);
+        const std::string snapshot = mTestConfigDir + "snapshot_snapshot_settings.llsd";
+        mCleanups.push_back(snapshot);
+
+        {
+            LLControlGroup first("snapshot");
+            ensure_equals("parsed from XML", first.loadFromFile(mTestConfigFile, true), 1U);
+        }
+        ensure("snapshot written", LLFile::isfile(snapshot));
+
+        {
+            LLControlGroup from_snapshot("snapshot");
+            ensure_equals("read from snapshot", from_snapshot.loadFromFile(mTestConfigFile, true), 1U);
+            ensure_equals("snapshot value", from_snapshot.getU32("TestSetting"), 12U);
+        }
+
+        // Changing the settings file makes the snapshot stale
+        LLSD config;
+        config["TestSetting"]["Comment"] = "Dummy setting used for testing";
+        config["TestSetting"]["Persist"] = 1;
+        config["TestSetting"]["Type"] = "U32";
+        config["TestSetting"]["Value"] = 42;
+        config["OtherSetting"] = config["TestSetting"];
+        writeSettingsFile(config);
+
+        {
+            LLControlGroup stale("snapshot");
+            ensure_equals("stale snapshot ignored", stale.loadFromFile(mTestConfigFile, true), 2U);
+            ensure_equals("value from XML", stale.getU32("TestSetting"), 42U);
+        }
+        LLControlGroup::setSnapshotDir(std::string());
+    }
 }
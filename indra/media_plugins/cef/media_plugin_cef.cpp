@@ -43,6 +43,8 @@
 #include "dullahan.h"
 #include "dullahan_version.h"
 
+#include <chrono> // <FS/> Media frame rate hint
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 class MediaPluginCEF :
@@ -116,6 +118,15 @@ private:
 #endif
     F32 mCurVolume;
     dullahan* mCEFLib;
+
+    // <FS> Media frame rate hint
+    // Frames still land in shared memory as they come, but the viewer is
+    // only told about them at the rate it asked for. 0 is unlimited.
+    void flushPendingDirty(bool force);
+    F64 mFrameRateHint;
+    bool mDirtyPending;
+    std::chrono::steady_clock::time_point mLastDirtySent;
+    // </FS>
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -140,6 +151,10 @@ MediaPluginBase(host_send_func, host_user_data)
     mUseMockKeyChain = true;
     mDisableWebSecurity = false;
     mFileAccessFromFileUrls = false;
+    // <FS> Media frame rate hint
+    mFrameRateHint = 0.0;
+    mDirtyPending = false;
+    // </FS>
     mUserAgentSubtring = "";
     mAuthUsername = "";
     mAuthPassword = "";
@@ -195,10 +210,34 @@ void MediaPluginCEF::onPageChangedCallback(const unsigned char* pixels, int x, i
         {
             mCEFLib->setSize(mWidth, mHeight);
         }
-        setDirty(0, 0, mWidth, mHeight);
+        // <FS> Media frame rate hint
+        //setDirty(0, 0, mWidth, mHeight);
+        mDirtyPending = true;
+        flushPendingDirty(false);
+        // </FS>
     }
 }
 
+// <FS> Media frame rate hint
+void MediaPluginCEF::flushPendingDirty(bool force)
+{
+    if (!mDirtyPending)
+    {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (!force && mFrameRateHint > 0.0 && std::chrono::duration<F64>(now - mLastDirtySent).count() < 1.0 / mFrameRateHint)
+    {
+        return;
+    }
+
+    mDirtyPending = false;
+    mLastDirtySent = now;
+    setDirty(0, 0, mWidth, mHeight);
+}
+// </FS>
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 void MediaPluginCEF::onConsoleMessageCallback(std::string message, std::string source, int line)
@@ -547,6 +586,7 @@ void MediaPluginCEF::receiveMessage(const char* message_string)
             else if (message_name == "idle")
             {
                 mCEFLib->update();
+                flushPendingDirty(false); // <FS/> Media frame rate hint
 
 #if LL_VOLUME_CATCHER
                 mVolumeCatcher.pump();
@@ -920,6 +960,15 @@ void MediaPluginCEF::receiveMessage(const char* message_string)
             {
                 mEnableMediaPluginDebugging = message_in.getValueBoolean("enable");
             }
+            // <FS> Media frame rate hint
+            else if (message_name == "frame_rate_hint")
+            {
+                F64 fps = message_in.getValueReal("fps");
+                bool faster = (fps <= 0.0) || (mFrameRateHint > 0.0 && fps > mFrameRateHint);
+                mFrameRateHint = std::max(fps, 0.0);
+                flushPendingDirty(faster);
+            }
+            // </FS>
             if (message_name == "pick_file_response")
             {
                 LLSD file_list_llsd = message_in.getValueLLSD("file_list");
@@ -15,50 +15,104 @@
 
 const static boost::regex NEWLINES("\\n{1}");
 
-// NACLAntiSpamQueueEntry
+// NACLAntiSpamRateSketch
 
-NACLAntiSpamQueueEntry::NACLAntiSpamQueueEntry() :
-    mEntryTime(0),
-    mEntryAmount(0),
-    mBlocked(false)
+NACLAntiSpamRateSketch::NACLAntiSpamRateSketch() :
+    mCurrent(0),
+    mWindow(0),
+    mPeriod(0)
 {
+    // Per session seed so sources can't be picked to collide on purpose
+    LLUUID seed;
+    seed.generate();
+    mSeed = seed.getDigest64();
+    clear();
 }
 
-void NACLAntiSpamQueueEntry::clearEntry()
+void NACLAntiSpamRateSketch::clear()
 {
-    mEntryTime = 0;
-    mEntryAmount = 0;
-    mBlocked = false;
+    memset(mCounts, 0, sizeof(mCounts));
 }
 
-U32 NACLAntiSpamQueueEntry::getEntryAmount()
+void NACLAntiSpamRateSketch::getSlots(const LLUUID& source, U32 slots[DEPTH]) const
 {
-    return mEntryAmount;
+    // Two independent hashes combined into one per row (Kirsch-Mitzenmacher)
+    U64 h1 = 0, h2 = 0;
+    memcpy(&h1, source.mData, sizeof(U64));
+    memcpy(&h2, source.mData + sizeof(U64), sizeof(U64));
+    h1 ^= mSeed;
+    h1 *= 0xff51afd7ed558ccdULL;
+    h1 ^= h1 >> 33;
+    h2 ^= mSeed >> 17;
+    h2 *= 0xc4ceb9fe1a85ec53ULL;
+    h2 ^= h2 >> 33;
+    h2 |= 1;
+    for (U32 row = 0; row < DEPTH; ++row)
+    {
+        slots[row] = (U32)((h1 + row * h2) >> 32) % WIDTH;
+    }
 }
 
-U32 NACLAntiSpamQueueEntry::getEntryTime()
+void NACLAntiSpamRateSketch::advance(U32 window)
 {
-    return mEntryTime;
-}
+    if (window == mWindow)
+    {
+        return;
+    }
 
-void NACLAntiSpamQueueEntry::updateEntryAmount()
-{
-    mEntryAmount++;
+    if (window == mWindow + 1)
+    {
+        // The current window becomes the previous one
+        mCurrent ^= 1;
+        memset(mCounts[mCurrent], 0, sizeof(mCounts[mCurrent]));
+    }
+    else
+    {
+        clear();
+    }
+    mWindow = window;
 }
 
-void NACLAntiSpamQueueEntry::updateEntryTime()
+U32 NACLAntiSpamRateSketch::addEvent(const LLUUID& source, U32 now, U32 period)
 {
-    mEntryTime = (U32)time(NULL);
-}
+    period = llmax(period, 1U);
+    if (period != mPeriod)
+    {
+        // Windows of a different length can't be compared
+        clear();
+        mPeriod = period;
+        mWindow = now / period;
+    }
+    advance(now / period);
 
-void NACLAntiSpamQueueEntry::setBlocked()
-{
-    mBlocked = true;
-}
+    U32 slots[DEPTH];
+    getSlots(source, slots);
 
-bool NACLAntiSpamQueueEntry::getBlocked()
-{
-    return mBlocked;
+    U16 (&current)[DEPTH][WIDTH] = mCounts[mCurrent];
+    const U16 (&previous)[DEPTH][WIDTH] = mCounts[mCurrent ^ 1];
+    U16 current_min = U16_MAX;
+    U16 previous_min = U16_MAX;
+    for (U32 row = 0; row < DEPTH; ++row)
+    {
+        current_min = llmin(current_min, current[row][slots[row]]);
+        previous_min = llmin(previous_min, previous[row][slots[row]]);
+    }
+
+    if (current_min < U16_MAX)
+    {
+        for (U32 row = 0; row < DEPTH; ++row)
+        {
+            if (current[row][slots[row]] == current_min)
+            {
+                current[row][slots[row]]++;
+            }
+        }
+        current_min++;
+    }
+
+    // Share of the previous window that still lies within the last period
+    const U32 remaining = period - (now % period);
+    return (U32)current_min + (U32)(((U64)previous_min * remaining) / period);
 }
 
 // NACLAntiSpamQueue
@@ -94,93 +148,41 @@ U32 NACLAntiSpamQueue::getAmount()
     return mQueueAmount;
 }
 
-NACLAntiSpamQueueEntry* NACLAntiSpamQueue::getEntry(const LLUUID& source)
+bool NACLAntiSpamQueue::isBlocked(const LLUUID& source) const
 {
-    spam_queue_entry_map_t::iterator found = mEntries.find(source);
-    if (found != mEntries.end())
-    {
-        return found->second;
-    }
-    else
-    {
-        return nullptr;
-    }
+    return mBlocked.find(source) != mBlocked.end();
 }
 
 void NACLAntiSpamQueue::clearEntries()
 {
-    for (auto& [id, entry] : mEntries)
-    {
-        //AO: Only clear entries that are not blocked.
-        if (!entry->getBlocked())
-        {
-            entry->clearEntry();
-        }
-    }
+    //AO: Only clear entries that are not blocked.
+    mRates.clear();
 }
 
 void NACLAntiSpamQueue::purgeEntries()
 {
-    for (spam_queue_entry_map_t::iterator it = mEntries.begin(); it != mEntries.end(); ++it)
-    {
-        delete it->second;
-    }
-    mEntries.clear();
+    mRates.clear();
+    mBlocked.clear();
 }
 
 void NACLAntiSpamQueue::blockEntry(const LLUUID& source)
 {
-    spam_queue_entry_map_t::iterator it = mEntries.find(source);
-    if (it == mEntries.end())
-    {
-        mEntries[source] = new NACLAntiSpamQueueEntry();
-    }
-
-    mEntries[source]->setBlocked();
+    mBlocked.insert(source);
 }
 
 EAntispamCheckResult NACLAntiSpamQueue::checkEntry(const LLUUID& name, U32 multiplier)
 {
-    spam_queue_entry_map_t::iterator it = mEntries.find(name);
-    if (it != mEntries.end())
+    if (isBlocked(name))
     {
-        if (it->second->getBlocked())
-        {
-            return EAntispamCheckResult::ExistingBlock;
-        }
-        U32 eTime = it->second->getEntryTime();
-        U32 currentTime = (U32)time(0);
-        if ((currentTime - eTime) <= mQueueTime)
-        {
-            it->second->updateEntryAmount();
-            U32 eAmount = it->second->getEntryAmount();
-            if (eAmount > (mQueueAmount * multiplier))
-            {
-                it->second->setBlocked();
-                return EAntispamCheckResult::NewBlock;
-            }
-            else
-            {
-                return EAntispamCheckResult::Unblocked;
-            }
-        }
-        else
-        {
-            it->second->clearEntry();
-            it->second->updateEntryAmount();
-            it->second->updateEntryTime();
-            return EAntispamCheckResult::Unblocked;
-        }
+        return EAntispamCheckResult::ExistingBlock;
     }
-    else
+
+    if (mRates.addEvent(name, (U32)time(NULL), mQueueTime) > (mQueueAmount * multiplier))
     {
-        LL_DEBUGS("AntiSpam") << "New queue entry:" << name.asString() << LL_ENDL;
-        NACLAntiSpamQueueEntry* entry = new NACLAntiSpamQueueEntry();
-        entry->updateEntryAmount();
-        entry->updateEntryTime();
-        mEntries[name] = entry;
-        return EAntispamCheckResult::Unblocked;
+        mBlocked.insert(name);
+        return EAntispamCheckResult::NewBlock;
     }
+    return EAntispamCheckResult::Unblocked;
 }
 
 // NACLAntiSpamRegistry
@@ -327,13 +329,7 @@ void NACLAntiSpamRegistry::blockOnQueue(EAntispamQueue queue, const LLUUID& sour
 
 void NACLAntiSpamRegistry::blockGlobalEntry(const LLUUID& source)
 {
-    spam_queue_entry_map_t::iterator it = mGlobalEntries.find(source);
-    if (it == mGlobalEntries.end())
-    {
-        mGlobalEntries[source] = new NACLAntiSpamQueueEntry();
-    }
-
-    mGlobalEntries[source]->setBlocked();
+    mGlobalBlocked.insert(source);
 }
 
 bool NACLAntiSpamRegistry::checkQueue(EAntispamQueue queue, const LLUUID& source, EAntispamSource sourcetype, U32 multiplier)
@@ -484,15 +480,7 @@ bool NACLAntiSpamRegistry::isBlockedOnQueue(EAntispamQueue queue, const LLUUID&
 
     if (mGlobalQueue)
     {
-        spam_queue_entry_map_t::iterator found = mGlobalEntries.find(source);
-        if (found != mGlobalEntries.end())
-        {
-            return (found->second->getBlocked());
-        }
-        else
-        {
-            return false;
-        }
+        return mGlobalBlocked.find(source) != mGlobalBlocked.end();
     }
     else
     {
@@ -502,8 +490,7 @@ bool NACLAntiSpamRegistry::isBlockedOnQueue(EAntispamQueue queue, const LLUUID&
             return false;
         }
 
-        NACLAntiSpamQueueEntry* entry = mQueues[queue]->getEntry(source);
-        return (entry && entry->getBlocked());
+        return mQueues[queue]->isBlocked(source);
     }
 }
 
@@ -572,62 +559,29 @@ void NACLAntiSpamRegistry::purgeAllQueues()
 
 EAntispamCheckResult NACLAntiSpamRegistry::checkGlobalEntry(const LLUUID& source, U32 multiplier)
 {
-    spam_queue_entry_map_t::iterator it = mGlobalEntries.find(source);
-    if (it != mGlobalEntries.end())
+    if (mGlobalBlocked.find(source) != mGlobalBlocked.end())
     {
-        if (it->second->getBlocked())
-        {
-            return EAntispamCheckResult::ExistingBlock;
-        }
-
-        U32 eTime = it->second->getEntryTime();
-        U32 currentTime = (U32)time(NULL);
-        if ((currentTime - eTime) <= mGlobalTime)
-        {
-            it->second->updateEntryAmount();
-            U32 eAmount = it->second->getEntryAmount();
-            if (eAmount > (mGlobalAmount * multiplier))
-            {
-                return EAntispamCheckResult::NewBlock;
-            }
-            else
-            {
-                return EAntispamCheckResult::Unblocked;
-            }
-        }
-        else
-        {
-            it->second->clearEntry();
-            it->second->updateEntryAmount();
-            it->second->updateEntryTime();
-            return EAntispamCheckResult::Unblocked;
-        }
+        return EAntispamCheckResult::ExistingBlock;
     }
-    else
+
+    if (mGlobalRates.addEvent(source, (U32)time(NULL), mGlobalTime) > (mGlobalAmount * multiplier))
     {
-        NACLAntiSpamQueueEntry* entry = new NACLAntiSpamQueueEntry();
-        entry->updateEntryAmount();
-        entry->updateEntryTime();
-        mGlobalEntries[source] = entry;
-        return EAntispamCheckResult::Unblocked;
+        return EAntispamCheckResult::NewBlock;
     }
+    return EAntispamCheckResult::Unblocked;
 }
 
 void NACLAntiSpamRegistry::clearGlobalEntries()
 {
-    for (auto& [id, entry] : mGlobalEntries)
-    {
-        entry->clearEntry();
-    }
+    // Unlike the per type queues this has always cleared blocks too
+    mGlobalRates.clear();
+    mGlobalBlocked.clear();
 }
 
 void NACLAntiSpamRegistry::purgeGlobalEntries()
 {
-    for (spam_queue_entry_map_t::iterator it = mGlobalEntries.begin(); it != mGlobalEntries.end(); ++it)
-    {
-        delete it->second;
-    }
-    mGlobalEntries.clear();
+    mGlobalRates.clear();
+    mGlobalBlocked.clear();
 }
 
 void NACLAntiSpamRegistry::processObjectPropertiesFamily(LLMessageSystem* msg)
@@ -1,7 +1,6 @@
 #ifndef NACL_ANTISPAM_H
 #define NACL_ANTISPAM_H
 
-#include <unordered_map>
 #include <unordered_set>
 #include "llsingleton.h"
 #include "llavatarnamecache.h"
@@ -42,31 +41,41 @@ struct AntispamObjectData
     std::string     mNotificationId;
 };
 
-class NACLAntiSpamQueueEntry
+// Event rates per source in a fixed amount of memory, no matter how many
+// sources there are. Counts go into a count-min sketch: every source maps
+// to one counter per row and its count is the smallest of them, which can
+// only be too high when other sources collide with it in every row. Only
+// the counters at the minimum are incremented (conservative update) to keep
+// that overestimate small.
+//
+// Time is cut into windows of one period. The previous window is kept and
+// weighted by how much of it still lies within the last period, so the rate
+// decays smoothly instead of dropping to zero at the window boundary.
+class NACLAntiSpamRateSketch
 {
-    friend class NACLAntiSpamQueue;
-    friend class NACLAntiSpamRegistry;
-
 public:
-    U32 getEntryAmount();
-    U32 getEntryTime();
-
-protected:
-    NACLAntiSpamQueueEntry();
+    NACLAntiSpamRateSketch();
 
-    void clearEntry();
-    void updateEntryAmount();
-    void updateEntryTime();
-    bool getBlocked();
-    void setBlocked();
+    // Counts one event of source at now (seconds) and returns the estimated
+    // number of its events within the last period seconds
+    U32 addEvent(const LLUUID& source, U32 now, U32 period);
+    void clear();
 
 private:
-    U32     mEntryAmount;
-    U32     mEntryTime;
-    bool    mBlocked;
+    static constexpr U32 DEPTH = 4;
+    static constexpr U32 WIDTH = 2048;
+
+    void getSlots(const LLUUID& source, U32 slots[DEPTH]) const;
+    void advance(U32 window);
+
+    U16 mCounts[2][DEPTH][WIDTH];   // Current and previous window
+    U32 mCurrent;                   // Index of the current window in mCounts
+    U32 mWindow;                    // Number of the current window (now / period)
+    U32 mPeriod;
+    U64 mSeed;
 };
 
-typedef std::unordered_map<LLUUID, NACLAntiSpamQueueEntry*, FSUUIDHash> spam_queue_entry_map_t;
+typedef std::unordered_set<LLUUID, FSUUIDHash> spam_blocked_set_t;
 typedef std::unordered_set<LLUUID, FSUUIDHash> collision_sound_set_t;
 
 class NACLAntiSpamQueue
@@ -86,13 +95,14 @@ protected:
 
     void blockEntry(const LLUUID& source);
     EAntispamCheckResult checkEntry(const LLUUID& source, U32 multiplier);
-    NACLAntiSpamQueueEntry* getEntry(const LLUUID& source);
+    bool isBlocked(const LLUUID& source) const;
 
     void clearEntries();
     void purgeEntries();
 
 private:
-    spam_queue_entry_map_t  mEntries;
+    NACLAntiSpamRateSketch  mRates;
+    spam_blocked_set_t      mBlocked;
     U32                     mQueueAmount;
     U32                     mQueueTime;
 };
@@ -137,7 +147,8 @@ private:
     void notify(AntispamObjectData data);
 
     NACLAntiSpamQueue*      mQueues[ANTISPAM_QUEUE_MAX];
-    spam_queue_entry_map_t  mGlobalEntries;
+    NACLAntiSpamRateSketch  mGlobalRates;
+    spam_blocked_set_t      mGlobalBlocked;
     U32                     mGlobalTime;
     U32                     mGlobalAmount;
     bool                    mGlobalQueue;
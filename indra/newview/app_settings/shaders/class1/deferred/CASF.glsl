@@ -2065,9 +2065,20 @@ A_STATIC void CasSetup(
 //==============================================================================================================================
 #ifdef A_GPU
  AF3 CasLoad(ASU2 p) { return texelFetch(diffuseRect, p, 0).rgb; }
+// <FS> Fused post processing, diffuseRect holds the HDR scene, tonemapped tap by tap
+#ifdef FUSED_TONEMAP
+ vec3 toneMap(vec3 color);
  void CasInput(inout AF1 r,inout AF1 g,inout AF1 b)
  {
+  AF3 c=toneMap(max(AF3(r,g,b),AF3_(0.0)));
+  r=c.r;g=c.g;b=c.b;
  }
+#else
+ void CasInput(inout AF1 r,inout AF1 g,inout AF1 b)
+ {
+ }
+#endif
+// </FS>
 
 //------------------------------------------------------------------------------------------------------------------------------
  void CasFilter(
@@ -2549,8 +2560,20 @@ void main()
 {
     vec4 diff = vec4(0.f);
     uvec2 point = uvec2(vary_fragcoord * out_screen_res.xy);
+// <FS> Dynamic resolution, diffuseRect is smaller than the target
+#ifdef CAS_UPSCALE
+    CasFilter(diff.r, diff.g, diff.b, point, cas_param_0, cas_param_1, false);
+#else
     CasFilter(diff.r, diff.g, diff.b, point, cas_param_0, cas_param_1, true);
+#endif
+// </FS>
     diff.a = texture(diffuseRect, vary_fragcoord).a;
+// <FS> Fused post processing, gamma correction of postDeferredGammaCorrect.glsl in the same pass
+#ifdef FUSED_TONEMAP
+    diff.rgb = linear_to_srgb(diff.rgb);
+    diff = max(diff, vec4(0));
+#endif
+// </FS>
     frag_color = diff;
 }
 #endif
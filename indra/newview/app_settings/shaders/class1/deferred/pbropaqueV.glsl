@@ -37,6 +37,32 @@ mat4 getObjectSkinnedTransform();
 uniform mat3 normal_matrix;
 uniform mat4 modelview_projection_matrix;
 #endif
+
+#ifdef INSTANCED
+// <FS> Mesh instancing
+// 7 vec4s per instance, see FSMeshInstancer: the model matrix and the normal
+// matrix packed like GLTFNodes, then the vertex color
+layout (std140) uniform MeshInstances
+{
+    vec4 mesh_instances[MAX_UBO_VEC4S];
+};
+
+mat4 getInstanceTransform(int idx)
+{
+    vec4 src0 = mesh_instances[idx+0];
+    vec4 src1 = mesh_instances[idx+1];
+    vec4 src2 = mesh_instances[idx+2];
+
+    mat4 ret;
+    ret[0] = vec4(src0.xyz, 0);
+    ret[1] = vec4(src1.xyz, 0);
+    ret[2] = vec4(src2.xyz, 0);
+    ret[3] = vec4(src0.w, src1.w, src2.w, 1);
+
+    return ret;
+}
+// </FS>
+#endif
 uniform mat4 texture_matrix0;
 
 uniform vec4[2] texture_base_color_transform;
@@ -45,7 +71,9 @@ uniform vec4[2] texture_metallic_roughness_transform;
 uniform vec4[2] texture_emissive_transform;
 
 in vec3 position;
+#ifndef INSTANCED
 in vec4 diffuse_color;
+#endif
 in vec3 normal;
 in vec4 tangent;
 in vec2 texcoord0;
@@ -76,6 +104,13 @@ void main()
     vary_position = pos;
     gl_Position = projection_matrix*vec4(pos,1.0);
 
+#elif defined(INSTANCED)
+    int idx = gl_InstanceID*7;
+    vec4 pos = getInstanceTransform(idx) * vec4(position.xyz, 1.0);
+    mat3 instance_normal = mat3(getInstanceTransform(idx+3));
+
+    vary_position = (modelview_matrix*pos).xyz;
+    gl_Position = modelview_projection_matrix * pos;
 #else
     vary_position = (modelview_matrix*vec4(position.xyz, 1.0)).xyz;
     //transform vertex
@@ -90,6 +125,9 @@ void main()
 #ifdef HAS_SKIN
     vec3 n = (mat*vec4(normal.xyz+position.xyz,1.0)).xyz-pos.xyz;
     vec3 t = (mat*vec4(tangent.xyz+position.xyz,1.0)).xyz-pos.xyz;
+#elif defined(INSTANCED)
+    vec3 n = normal_matrix * (instance_normal * normal);
+    vec3 t = normal_matrix * (instance_normal * tangent.xyz);
 #else //HAS_SKIN
     vec3 n = normal_matrix * normal;
     vec3 t = normal_matrix * tangent.xyz;
@@ -102,7 +140,11 @@ void main()
     vary_sign = transformed_tangent.w;
     vary_normal = n;
 
+#ifdef INSTANCED
+    vertex_color = mesh_instances[idx+6];
+#else
     vertex_color = diffuse_color;
+#endif
 }
 
 #else
@@ -25,7 +25,11 @@
 
 /*[EXTRA_CODE_HERE]*/
 
+// <FS> Fused post processing, FUSED_TONEMAP links toneMap() into CASF.glsl
+#ifndef FUSED_TONEMAP
 out vec4 frag_color;
+#endif
+// </FS>
 
 uniform sampler2D diffuseRect;
 uniform sampler2D exposureMap;
@@ -151,6 +155,7 @@ vec3 toneMap(vec3 color)
 
 //===============================================================
 
+#ifndef FUSED_TONEMAP // <FS/> Fused post processing
 void debugExposure(inout vec3 color)
 {
     float exp_scale = texture(exposureMap, vec2(0.5,0.5)).r;
@@ -173,6 +178,14 @@ void main()
 #endif
 
     //debugExposure(diff.rgb);
+
+// <FS> Fused post processing, gamma correction of postDeferredGammaCorrect.glsl in the same pass
+#ifdef FUSED_GAMMA
+    diff.rgb = linear_to_srgb(diff.rgb);
+#endif
+// </FS>
+
     frag_color = max(diff, vec4(0));
 }
+#endif // <FS/> Fused post processing
 
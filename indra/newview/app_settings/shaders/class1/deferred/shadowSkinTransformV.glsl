@@ -0,0 +1,42 @@
+/**
+ * @file shadowSkinTransformV.glsl
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// One point per vertex of a rigged face, drawn with the rasterizer off.
+// The skinned position is captured with transform feedback, in the same
+// space shadowSkinnedV.glsl skins into, so shadowV.glsl can draw it with
+// the modelview of every shadow map.
+
+in vec3 position;
+
+out vec4 skinned_position;
+
+mat4 getObjectSkinnedTransform();
+
+void main()
+{
+    mat4 mat = getObjectSkinnedTransform();
+    skinned_position = mat*vec4(position.xyz, 1.0);
+    gl_Position = skinned_position;
+}
@@ -27,8 +27,32 @@ uniform mat4 modelview_projection_matrix;
 
 in vec3 position;
 
+#ifdef INSTANCED
+// <FS> Mesh instancing, same layout as pbropaqueV.glsl
+layout (std140) uniform MeshInstances
+{
+    vec4 mesh_instances[MAX_UBO_VEC4S];
+};
+// </FS>
+#endif
+
 void main()
 {
+#ifdef INSTANCED
+    int idx = gl_InstanceID*7;
+    vec4 src0 = mesh_instances[idx+0];
+    vec4 src1 = mesh_instances[idx+1];
+    vec4 src2 = mesh_instances[idx+2];
+
+    mat4 mat;
+    mat[0] = vec4(src0.xyz, 0);
+    mat[1] = vec4(src1.xyz, 0);
+    mat[2] = vec4(src2.xyz, 0);
+    mat[3] = vec4(src0.w, src1.w, src2.w, 1);
+
+    gl_Position = modelview_projection_matrix*(mat*vec4(position.xyz, 1.0));
+#else
     //transform vertex
     gl_Position = modelview_projection_matrix*vec4(position.xyz, 1.0);
+#endif
 }
@@ -31,10 +31,34 @@ in vec2 texcoord0;
 
 out vec2 vary_texcoord0;
 
+#ifdef INSTANCED
+// <FS> Tree instancing, same layout as treeV.glsl
+layout (std140) uniform MeshInstances
+{
+    vec4 mesh_instances[MAX_UBO_VEC4S];
+};
+// </FS>
+#endif
+
 void main()
 {
+#ifdef INSTANCED
+    int idx = gl_InstanceID*3;
+    vec4 src0 = mesh_instances[idx+0];
+    vec4 src1 = mesh_instances[idx+1];
+    vec4 src2 = mesh_instances[idx+2];
+
+    mat4 mat;
+    mat[0] = vec4(src0.xyz, 0);
+    mat[1] = vec4(src1.xyz, 0);
+    mat[2] = vec4(src2.xyz, 0);
+    mat[3] = vec4(src0.w, src1.w, src2.w, 1);
+
+    gl_Position = modelview_projection_matrix*(mat*vec4(position.xyz, 1.0));
+#else
     //transform vertex
     gl_Position = modelview_projection_matrix*vec4(position.xyz, 1.0);
+#endif
 
     vary_texcoord0 = (texture_matrix0 * vec4(texcoord0,0,1)).xy;
 }
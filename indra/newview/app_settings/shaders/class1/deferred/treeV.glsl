@@ -37,8 +37,45 @@ out vec4 vertex_color;
 out vec2 vary_texcoord0;
 out vec3 vary_position;
 
+#ifdef INSTANCED
+// <FS> Tree instancing
+// 3 vec4s per instance, see FSTreeInstancer: the model matrix packed like
+// GLTFNodes. Trees are scaled uniformly so it transforms the normals as well.
+layout (std140) uniform MeshInstances
+{
+    vec4 mesh_instances[MAX_UBO_VEC4S];
+};
+
+mat4 getInstanceTransform(int idx)
+{
+    vec4 src0 = mesh_instances[idx+0];
+    vec4 src1 = mesh_instances[idx+1];
+    vec4 src2 = mesh_instances[idx+2];
+
+    mat4 ret;
+    ret[0] = vec4(src0.xyz, 0);
+    ret[1] = vec4(src1.xyz, 0);
+    ret[2] = vec4(src2.xyz, 0);
+    ret[3] = vec4(src0.w, src1.w, src2.w, 1);
+
+    return ret;
+}
+// </FS>
+#endif
+
 void main()
 {
+#ifdef INSTANCED
+    mat4 mat = getInstanceTransform(gl_InstanceID*3);
+    vec4 pos = mat * vec4(position.xyz, 1.0);
+
+    gl_Position = modelview_projection_matrix * pos;
+    vary_position = (modelview_matrix*pos).xyz;
+
+    vary_texcoord0 = (texture_matrix0 * vec4(texcoord0,0,1)).xy;
+
+    vary_normal = normalize(normal_matrix * (mat3(mat) * normal));
+#else
     //transform vertex
     gl_Position = modelview_projection_matrix * vec4(position.xyz, 1.0);
     vary_position = (modelview_matrix*vec4(position.xyz, 1.0)).xyz;
@@ -46,6 +83,7 @@ void main()
     vary_texcoord0 = (texture_matrix0 * vec4(texcoord0,0,1)).xy;
 
     vary_normal = normalize(normal_matrix * normal);
+#endif
 
     vertex_color = vec4(1,1,1,1);
 }
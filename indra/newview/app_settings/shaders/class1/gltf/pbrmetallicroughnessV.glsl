@@ -242,7 +242,10 @@ uniform int gltf_node_id = 0;
 mat4 getGLTFTransform()
 {
     mat4 ret;
-    int idx = gltf_node_id*3;
+    // <FS> GLTF instancing, gltf_node_id is the first slot of an instance run
+    //int idx = gltf_node_id*3;
+    int idx = (gltf_node_id + gl_InstanceID)*3;
+    // </FS>
 
     vec4 src0 = gltf_nodes[idx+0];
     vec4 src1 = gltf_nodes[idx+1];
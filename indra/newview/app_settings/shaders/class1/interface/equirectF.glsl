@@ -0,0 +1,64 @@
+/**
+ * @file equirectF.glsl
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Draws one cube face of a 360 snapshot into a strip of an equirectangular
+// image. Every face is drawn over the whole strip and only keeps the pixels
+// whose direction points through it.
+
+in vec2 tc;
+
+uniform sampler2D diffuseMap;
+
+uniform vec3 face_dir;
+uniform vec3 face_right;
+uniform vec3 face_up;
+
+// x: first row of the strip from the top, y: rows in the strip,
+// z: rows in the image, w: heading at the center of the image in radians
+uniform vec4 strip;
+
+out vec4 frag_color;
+
+#define PI 3.14159265358979
+
+void main()
+{
+    float row = strip.x + (1.0 - tc.y) * strip.y;
+    float latitude = PI * 0.5 - PI * row / strip.z;
+    float heading = strip.w + (tc.x - 0.5) * 2.0 * PI;
+
+    // compass heading, +Y is north and +X is east
+    vec3 dir = vec3(sin(heading) * cos(latitude), cos(heading) * cos(latitude), sin(latitude));
+
+    float facing = dot(dir, face_dir);
+    vec3 a = abs(dir);
+    if (facing <= 0.0 || facing < max(a.x, max(a.y, a.z)) - 1e-5)
+    {
+        discard;
+    }
+
+    vec2 uv = vec2(dot(dir, face_right), dot(dir, face_up)) / facing * 0.5 + 0.5;
+    frag_color = vec4(texture(diffuseMap, uv).rgb, 1.0);
+}
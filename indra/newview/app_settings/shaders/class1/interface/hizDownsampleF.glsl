@@ -0,0 +1,50 @@
+/**
+ * @file hizDownsampleF.glsl
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Farthest depth of the level above, one step down the Hi-Z pyramid.
+// Target sizes round up, so each texel takes the 3x3 source texels its
+// area can overlap instead of just 2x2.
+
+uniform sampler2D depthMap;
+
+out vec4 frag_color;
+
+void main()
+{
+    ivec2 src_size = textureSize(depthMap, 0);
+    ivec2 tc = ivec2(gl_FragCoord.xy) * 2;
+
+    float far_depth = 0.0;
+    for (int y = -1; y < 2; ++y)
+    {
+        for (int x = -1; x < 2; ++x)
+        {
+            ivec2 src = clamp(tc + ivec2(x, y), ivec2(0), src_size - 1);
+            far_depth = max(far_depth, texelFetch(depthMap, src, 0).r);
+        }
+    }
+
+    frag_color = vec4(far_depth);
+}
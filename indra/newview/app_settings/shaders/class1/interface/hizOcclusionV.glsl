@@ -0,0 +1,98 @@
+/**
+ * @file hizOcclusionV.glsl
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// One point per spatial group, written to its own texel of the results
+// target: 1 when the group's box may be visible, 0 when the Hi-Z pyramid
+// proves it is behind what was already drawn.
+
+uniform mat4 modelview_projection_matrix;
+
+uniform sampler2D diffuseMap;   // box center then half size of every group
+uniform sampler2D depthMap;     // Hi-Z pyramid, farthest depth per texel
+uniform vec2 result_size;
+uniform int result_width;
+uniform int hiz_levels;
+
+flat out float visible;
+
+void main()
+{
+    int id = gl_VertexID;
+    ivec2 result = ivec2(id % result_width, id / result_width);
+    ivec2 box_tc = ivec2(result.x * 2, result.y);
+
+    vec3 center = texelFetch(diffuseMap, box_tc, 0).xyz;
+    vec3 size = texelFetch(diffuseMap, box_tc + ivec2(1, 0), 0).xyz;
+
+    vec3 ndc_min = vec3(1.0);
+    vec3 ndc_max = vec3(-1.0);
+    bool clipped = false;
+    for (int i = 0; i < 8; ++i)
+    {
+        vec3 corner = vec3((i & 1) != 0 ? 1.0 : -1.0,
+                           (i & 2) != 0 ? 1.0 : -1.0,
+                           (i & 4) != 0 ? 1.0 : -1.0);
+        vec4 p = modelview_projection_matrix * vec4(center + size * corner, 1.0);
+        if (p.w <= 0.0)
+        {
+            clipped = true;
+        }
+        else
+        {
+            vec3 ndc = p.xyz / p.w;
+            ndc_min = min(ndc_min, ndc);
+            ndc_max = max(ndc_max, ndc);
+        }
+    }
+
+    visible = 1.0;
+
+    // boxes reaching behind the camera are left to the near clip
+    if (!clipped)
+    {
+        vec2 uv_min = clamp(ndc_min.xy * 0.5 + 0.5, 0.0, 1.0);
+        vec2 uv_max = clamp(ndc_max.xy * 0.5 + 0.5, 0.0, 1.0);
+        float depth = ndc_min.z * 0.5 + 0.5;
+
+        // the level where the box spans at most one texel, so 2x2 texels cover it
+        vec2 texels = (uv_max - uv_min) * vec2(textureSize(depthMap, 0));
+        int level = int(ceil(log2(max(max(texels.x, texels.y), 1.0))));
+        level = clamp(level, 0, hiz_levels - 1);
+
+        ivec2 level_size = textureSize(depthMap, level);
+        ivec2 t0 = clamp(ivec2(uv_min * vec2(level_size)), ivec2(0), level_size - 1);
+        ivec2 t1 = clamp(ivec2(uv_max * vec2(level_size)), ivec2(0), level_size - 1);
+
+        float far_depth = max(max(texelFetch(depthMap, t0, level).r, texelFetch(depthMap, ivec2(t1.x, t0.y), level).r),
+                              max(texelFetch(depthMap, ivec2(t0.x, t1.y), level).r, texelFetch(depthMap, t1, level).r));
+
+        if (depth > far_depth)
+        {
+            visible = 0.0;
+        }
+    }
+
+    gl_Position = vec4((vec2(result) + 0.5) / result_size * 2.0 - 1.0, 0.0, 1.0);
+}
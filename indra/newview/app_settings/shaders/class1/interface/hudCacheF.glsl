@@ -0,0 +1,50 @@
+/**
+ * @file hudCacheF.glsl
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Composite the cached HUD, drawn once over black (diffuseMap) and once
+// over white (specularMap). Over black every pixel holds the color the
+// HUD adds, the difference between the two is how much of the background
+// still shows through, per channel. TRANSMITTANCE draws that with a
+// multiplying blend, then the color is added.
+
+uniform sampler2D diffuseMap;
+#ifdef TRANSMITTANCE
+uniform sampler2D specularMap;
+#endif
+
+in vec2 tc;
+
+out vec4 frag_color;
+
+void main()
+{
+    vec3 black = texture(diffuseMap, tc).rgb;
+#ifdef TRANSMITTANCE
+    vec3 white = texture(specularMap, tc).rgb;
+    frag_color = vec4(clamp(white - black, vec3(0.0), vec3(1.0)), 1.0);
+#else
+    frag_color = vec4(black, 0.0);
+#endif
+}
@@ -0,0 +1,551 @@
+/**
+ * @file fs360equirect.cpp
+ * @brief Converts 360 snapshot cube faces to an equirectangular JPEG
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fs360equirect.h"
+
+#include "llcoros.h"
+#include "lleventcoro.h"
+#include "llfile.h"
+#include "llglslshader.h"
+#include "llimagegl.h"
+#include "llimagejpeg.h"
+#include "llrender.h"
+#include "llrendertarget.h"
+#include "llstring.h"
+#include "llvertexbuffer.h"
+#include "llviewershadermgr.h"
+#include "pipeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csetjmp>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    // Rows rendered and read back at a time
+    constexpr U32 STRIP_ROWS = 128;
+    // Strips waiting for the encoder before the conversion holds off
+    constexpr size_t MAX_QUEUED_STRIPS = 4;
+    constexpr size_t OUTPUT_BUFFER_SIZE = 64 * 1024;
+
+    // libjpeg reports errors by calling error_exit, which must not return
+    struct ErrorManager
+    {
+        jpeg_error_mgr  mPub;
+        jmp_buf         mJump;
+    };
+
+    void error_exit(j_common_ptr cinfo)
+    {
+        char buffer[JMSG_LENGTH_MAX];
+        (*cinfo->err->format_message)(cinfo, buffer);
+        LL_WARNS("360Capture") << "JPEG encode failed: " << buffer << LL_ENDL;
+        longjmp(reinterpret_cast<ErrorManager*>(cinfo->err)->mJump, 1);
+    }
+
+    // Writes the compressed data straight to the file
+    struct Destination
+    {
+        jpeg_destination_mgr    mPub;
+        LLFILE*                 mFile;
+        JOCTET                  mBuffer[OUTPUT_BUFFER_SIZE];
+    };
+
+    void init_destination(j_compress_ptr cinfo)
+    {
+        Destination* dest = reinterpret_cast<Destination*>(cinfo->dest);
+        dest->mPub.next_output_byte = dest->mBuffer;
+        dest->mPub.free_in_buffer = OUTPUT_BUFFER_SIZE;
+    }
+
+    boolean empty_output_buffer(j_compress_ptr cinfo)
+    {
+        Destination* dest = reinterpret_cast<Destination*>(cinfo->dest);
+        if (fwrite(dest->mBuffer, 1, OUTPUT_BUFFER_SIZE, dest->mFile) != OUTPUT_BUFFER_SIZE)
+        {
+            ERREXIT(cinfo, JERR_FILE_WRITE);
+        }
+        init_destination(cinfo);
+        return TRUE;
+    }
+
+    void term_destination(j_compress_ptr cinfo)
+    {
+        Destination* dest = reinterpret_cast<Destination*>(cinfo->dest);
+        const size_t count = OUTPUT_BUFFER_SIZE - dest->mPub.free_in_buffer;
+        if (count && fwrite(dest->mBuffer, 1, count, dest->mFile) != count)
+        {
+            ERREXIT(cinfo, JERR_FILE_WRITE);
+        }
+    }
+
+    std::string build_xmp(const FS360Equirect::Metadata& metadata, U32 width, U32 height)
+    {
+        return STRINGIZE(
+            "<?xpacket begin=\"\xEF\xBB\xBF\" id=\"W5M0MpCehiHzreSzNTczkc9d\"?>"
+            "<x:xmpmeta xmlns:x=\"adobe:ns:meta/\">"
+            "<rdf:RDF xmlns:rdf=\"http://www.w3.org/1999/02/22-rdf-syntax-ns#\">"
+            "<rdf:Description rdf:about=\"\" xmlns:GPano=\"http://ns.google.com/photos/1.0/panorama/\""
+            " GPano:ProjectionType=\"equirectangular\""
+            " GPano:UsePanoramaViewer=\"True\""
+            " GPano:CroppedAreaImageWidthPixels=\"" << width << "\""
+            " GPano:CroppedAreaImageHeightPixels=\"" << height << "\""
+            " GPano:FullPanoWidthPixels=\"" << width << "\""
+            " GPano:FullPanoHeightPixels=\"" << height << "\""
+            " GPano:CroppedAreaLeftPixels=\"0\""
+            " GPano:CroppedAreaTopPixels=\"0\""
+            " GPano:PoseHeadingDegrees=\"" << llformat("%.1f", metadata.mHeadingDeg) << "\""
+            " GPano:CaptureSoftware=\"" << LLStringFn::xml_encode(metadata.mCaptureSoftware, true) << "\""
+            " GPano:StitchingSoftware=\"" << LLStringFn::xml_encode(metadata.mCaptureSoftware, true) << "\""
+            " GPano:FirstPhotoDate=\"" << metadata.mDate << "\""
+            " GPano:LastPhotoDate=\"" << metadata.mDate << "\""
+            " GPano:SourcePhotosCount=\"6\""
+            " xmlns:xmp=\"http://ns.adobe.com/xap/1.0/\""
+            " xmp:CreatorTool=\"" << LLStringFn::xml_encode(metadata.mSoftware, true) << "\""
+            " xmlns:dc=\"http://purl.org/dc/elements/1.1/\">"
+            "<dc:title><rdf:Alt><rdf:li xml:lang=\"x-default\">" << LLStringFn::xml_encode(metadata.mRegionName) << "</rdf:li></rdf:Alt></dc:title>"
+            "<dc:source>" << LLStringFn::xml_encode(metadata.mRegionURL) << "</dc:source>"
+            "</rdf:Description>"
+            "</rdf:RDF>"
+            "</x:xmpmeta>"
+            "<?xpacket end=\"w\"?>");
+    }
+
+    // Compresses rows on a thread of its own. Rows arrive top to bottom, in
+    // strips, and are written to the file as they come.
+    class Encoder
+    {
+    public:
+        Encoder(U32 width, U32 height) :
+            mWidth(width),
+            mHeight(height),
+            mFinished(false),
+            mFailed(false),
+            mRowsWritten(0)
+        {
+            memset(&mCInfo, 0, sizeof(mCInfo));
+            memset(&mDest, 0, sizeof(mDest));
+        }
+
+        ~Encoder()
+        {
+            finish();
+        }
+
+        bool start(const std::string& filename, S32 quality, const std::string& xmp)
+        {
+            mDest.mFile = LLFile::fopen(filename, "wb");
+            if (!mDest.mFile)
+            {
+                LL_WARNS("360Capture") << "Unable to open " << filename << LL_ENDL;
+                return false;
+            }
+
+            if (!startCompress(quality, xmp))
+            {
+                fclose(mDest.mFile);
+                mDest.mFile = nullptr;
+                return false;
+            }
+
+            mThread = std::thread([this]() { run(); });
+            return true;
+        }
+
+        // Takes tightly packed RGB rows, top row first
+        void push(std::vector<U8>&& rows)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStrips.push_back(std::move(rows));
+            mCondition.notify_one();
+        }
+
+        size_t queued()
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mStrips.size();
+        }
+
+        bool failed() const { return mFailed; }
+
+        // Waits for the queued rows, true when the whole image was written
+        bool finish()
+        {
+            if (mThread.joinable())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mFinished = true;
+                    mCondition.notify_one();
+                }
+                mThread.join();
+            }
+
+            if (mDest.mFile)
+            {
+                if (mFailed || mRowsWritten != mHeight || !finishCompress())
+                {
+                    mFailed = true;
+                    jpeg_abort_compress(&mCInfo);
+                }
+                jpeg_destroy_compress(&mCInfo);
+                mFailed = (fclose(mDest.mFile) != 0) || mFailed;
+                mDest.mFile = nullptr;
+            }
+            return !mFailed && mRowsWritten == mHeight;
+        }
+
+    private:
+        void run()
+        {
+            LL_PROFILER_SET_THREAD_NAME("360 JPEG encoder");
+
+            std::vector<U8> strip;
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    mCondition.wait(lock, [this]() { return mFinished || !mStrips.empty(); });
+                    if (mStrips.empty())
+                    {
+                        return;
+                    }
+                    strip.swap(mStrips.front());
+                    mStrips.pop_front();
+                }
+
+                if (!mFailed && !writeRows(strip.data(), (U32)(strip.size() / (mWidth * 3))))
+                {
+                    mFailed = true;
+                }
+            }
+        }
+
+        // The libjpeg calls are kept in small functions of their own, free of
+        // anything the longjmp out of error_exit would skip over
+
+        bool startCompress(S32 quality, const std::string& xmp)
+        {
+            mCInfo.err = jpeg_std_error(&mErr.mPub);
+            mErr.mPub.error_exit = &error_exit;
+            if (setjmp(mErr.mJump))
+            {
+                jpeg_destroy_compress(&mCInfo);
+                return false;
+            }
+
+            jpeg_create_compress(&mCInfo);
+            mDest.mPub.init_destination = &init_destination;
+            mDest.mPub.empty_output_buffer = &empty_output_buffer;
+            mDest.mPub.term_destination = &term_destination;
+            mCInfo.dest = &mDest.mPub;
+
+            mCInfo.image_width = mWidth;
+            mCInfo.image_height = mHeight;
+            mCInfo.input_components = 3;
+            mCInfo.in_color_space = JCS_RGB;
+            jpeg_set_defaults(&mCInfo);
+            jpeg_set_quality(&mCInfo, llclamp(quality, 1, 100), TRUE);
+            jpeg_start_compress(&mCInfo, TRUE);
+
+            // The XMP packet goes into an APP1 segment after the namespace
+            static const char XMP_NAMESPACE[] = "http://ns.adobe.com/xap/1.0/";
+            std::string segment(XMP_NAMESPACE, sizeof(XMP_NAMESPACE));
+            segment += xmp;
+            if (segment.size() <= 65533)
+            {
+                jpeg_write_marker(&mCInfo, JPEG_APP0 + 1, reinterpret_cast<const JOCTET*>(segment.data()), (unsigned int)segment.size());
+            }
+            return true;
+        }
+
+        bool writeRows(U8* data, U32 rows)
+        {
+            if (setjmp(mErr.mJump))
+            {
+                return false;
+            }
+
+            const U32 stride = mWidth * 3;
+            for (U32 row = 0; row < rows && mCInfo.next_scanline < mCInfo.image_height; ++row)
+            {
+                JSAMPROW row_pointer = data + row * stride;
+                jpeg_write_scanlines(&mCInfo, &row_pointer, 1);
+                ++mRowsWritten;
+            }
+            return true;
+        }
+
+        bool finishCompress()
+        {
+            if (setjmp(mErr.mJump))
+            {
+                return false;
+            }
+            jpeg_finish_compress(&mCInfo);
+            return true;
+        }
+
+        const U32                   mWidth;
+        const U32                   mHeight;
+        jpeg_compress_struct        mCInfo;
+        ErrorManager                mErr;
+        Destination                 mDest;
+
+        std::thread                 mThread;
+        std::mutex                  mMutex;
+        std::condition_variable     mCondition;
+        std::deque<std::vector<U8>> mStrips;
+        bool                        mFinished;
+        std::atomic<bool>           mFailed;
+        U32                         mRowsWritten;   // Encoder thread only until joined
+    };
+
+    // GL resources of one conversion
+    struct Renderer
+    {
+        Renderer() : mBuffers{ 0, 0 } {}
+
+        ~Renderer()
+        {
+            if (mBuffers[0])
+            {
+                glDeleteBuffers(2, mBuffers);
+            }
+            mTarget.release();
+        }
+
+        bool init(const FS360Equirect::faces_t& faces, U32 width)
+        {
+            for (size_t i = 0; i < faces.size(); ++i)
+            {
+                LLImageDataSharedLock lock(faces[i].mImage);
+                mTextures[i] = new LLImageGL(faces[i].mImage, false, false);
+                if (!mTextures[i]->getTexName())
+                {
+                    return false;
+                }
+            }
+
+            if (!mTarget.allocate(width, STRIP_ROWS, GL_RGBA))
+            {
+                return false;
+            }
+
+            glGenBuffers(2, mBuffers);
+            for (U32 buffer : mBuffers)
+            {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+                glBufferData(GL_PIXEL_PACK_BUFFER, width * STRIP_ROWS * 4, nullptr, GL_STREAM_READ);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            return true;
+        }
+
+        // Renders rows [first_row, first_row + rows) of the image and starts
+        // reading them back into the given buffer
+        void render(const FS360Equirect::faces_t& faces, U32 first_row, U32 rows, U32 height, F32 heading, U32 buffer)
+        {
+            LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+            static LLStaticHashedString face_dir("face_dir");
+            static LLStaticHashedString face_right("face_right");
+            static LLStaticHashedString face_up("face_up");
+            static LLStaticHashedString strip("strip");
+
+            LLGLDepthTest depth(GL_FALSE, GL_FALSE);
+            LLGLDisable blend(GL_BLEND);
+            LLGLDisable cull(GL_CULL_FACE);
+
+            mTarget.bindTarget();
+            glViewport(0, 0, mTarget.getWidth(), rows);
+            mTarget.clear();
+
+            gEquirectProgram.bind();
+            gEquirectProgram.uniform4f(strip, (F32)first_row, (F32)rows, (F32)height, heading);
+            const S32 channel = gEquirectProgram.enableTexture(LLShaderMgr::DIFFUSE_MAP);
+            gPipeline.mScreenTriangleVB->setBuffer();
+            for (size_t i = 0; i < faces.size(); ++i)
+            {
+                // The right of a snapshot is its look direction crossed with its up
+                const LLVector3& dir = faces[i].mLookDir;
+                const LLVector3& up = faces[i].mUpVec;
+                const LLVector3 right = dir % up;
+                gEquirectProgram.uniform3fv(face_dir, 1, dir.mV);
+                gEquirectProgram.uniform3fv(face_right, 1, right.mV);
+                gEquirectProgram.uniform3fv(face_up, 1, up.mV);
+
+                gGL.getTexUnit(channel)->bind(mTextures[i]);
+                gGL.getTexUnit(channel)->setTextureAddressMode(LLTexUnit::TAM_CLAMP);
+                gGL.getTexUnit(channel)->setTextureFilteringOption(LLTexUnit::TFO_BILINEAR);
+                gPipeline.mScreenTriangleVB->drawArrays(LLRender::TRIANGLES, 0, 3);
+            }
+            gGL.getTexUnit(channel)->unbind(LLTexUnit::TT_TEXTURE);
+            gEquirectProgram.unbind();
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+            glReadPixels(0, 0, mTarget.getWidth(), rows, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            mTarget.flush();
+        }
+
+        std::array<LLPointer<LLImageGL>, 6> mTextures;
+        LLRenderTarget                      mTarget;
+        U32                                 mBuffers[2];
+        LLGLSyncFence                       mFences[2];
+    };
+
+    // Copies a strip out of its pixel buffer as packed RGB, top row first.
+    // GL rows come bottom up.
+    bool map_strip(U32 buffer, U32 width, U32 rows, std::vector<U8>& out)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        const U8* pixels = (const U8*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, width * rows * 4, GL_MAP_READ_BIT);
+        if (!pixels)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            return false;
+        }
+
+        out.resize((size_t)width * rows * 3);
+        U8* dst = out.data();
+        for (U32 row = 0; row < rows; ++row)
+        {
+            const U8* src = pixels + (size_t)(rows - 1 - row) * width * 4;
+            for (U32 x = 0; x < width; ++x, src += 4, dst += 3)
+            {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+            }
+        }
+
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return true;
+    }
+
+    bool convert_coro(const FS360Equirect::faces_t& faces, U32 width, const FS360Equirect::Metadata& metadata, S32 quality,
+                      const std::string& filename)
+    {
+        const U32 height = width / 2;
+        const F32 heading = metadata.mHeadingDeg * DEG_TO_RAD;
+
+        Renderer renderer;
+        if (!renderer.init(faces, width))
+        {
+            LL_WARNS("360Capture") << "Unable to set up the equirectangular conversion" << LL_ENDL;
+            return false;
+        }
+
+        Encoder encoder(width, height);
+        if (!encoder.start(filename, quality, build_xmp(metadata, width, height)))
+        {
+            return false;
+        }
+
+        auto collect = [&](U32 strip_index) -> bool
+        {
+            const U32 slot = strip_index % 2;
+            const U32 first_row = strip_index * STRIP_ROWS;
+            const U32 rows = llmin(STRIP_ROWS, height - first_row);
+
+            // Let the viewer run on while the GPU and the encoder catch up
+            while (!renderer.mFences[slot].isCompleted() || encoder.queued() >= MAX_QUEUED_STRIPS)
+            {
+                llcoro::suspend();
+            }
+
+            std::vector<U8> strip;
+            if (!map_strip(renderer.mBuffers[slot], width, rows, strip))
+            {
+                return false;
+            }
+            encoder.push(std::move(strip));
+            return !encoder.failed();
+        };
+
+        const U32 strips = (height + STRIP_ROWS - 1) / STRIP_ROWS;
+        for (U32 strip_index = 0; strip_index < strips; ++strip_index)
+        {
+            const U32 slot = strip_index % 2;
+            const U32 first_row = strip_index * STRIP_ROWS;
+            renderer.render(faces, first_row, llmin(STRIP_ROWS, height - first_row), height, heading, renderer.mBuffers[slot]);
+            renderer.mFences[slot].placeFence();
+
+            // The previous strip was read back while this one rendered
+            if (strip_index > 0 && !collect(strip_index - 1))
+            {
+                return false;
+            }
+        }
+
+        if (!collect(strips - 1))
+        {
+            return false;
+        }
+        return encoder.finish();
+    }
+}
+
+// static
+bool FS360Equirect::canConvert(U32 width)
+{
+    return gEquirectProgram.isComplete() && width > 0 && width <= (U32)gGLManager.mGLMaxTextureSize;
+}
+
+// static
+void FS360Equirect::convert(const faces_t& faces, U32 width, const Metadata& metadata, S32 quality,
+                            const std::string& filename, callback_t callback)
+{
+    LLCoros::instance().launch("FS360Equirect::convert",
+        [faces, width, metadata, quality, filename, callback]()
+        {
+            const auto start = std::chrono::steady_clock::now();
+            const bool success = convert_coro(faces, width, metadata, quality, filename);
+            if (success)
+            {
+                LL_INFOS("360Capture") << "Wrote " << width << "x" << width / 2 << " equirectangular image to " << filename << " in "
+                                       << std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count() << " seconds" << LL_ENDL;
+            }
+            else
+            {
+                LLFile::remove(filename);
+            }
+
+            if (callback)
+            {
+                callback(success);
+            }
+        });
+}
@@ -0,0 +1,78 @@
+/**
+ * @file fs360equirect.h
+ * @brief Converts 360 snapshot cube faces to an equirectangular JPEG
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FS360EQUIRECT_H
+#define FS_FS360EQUIRECT_H
+
+#include "llimage.h"
+#include "llpointer.h"
+#include "v3math.h"
+
+#include <array>
+#include <functional>
+
+// Turns the six cube faces of a 360 snapshot into an equirectangular image
+// on the GPU and writes it as a JPEG with the GPano metadata panorama viewers
+// look for.
+//
+// The image is rendered in strips of rows. Each strip is read back through a
+// pixel buffer while the viewer keeps running, and its rows go to a thread
+// that feeds them to the JPEG encoder as they come in, so the full image is
+// never held in memory.
+class FS360Equirect
+{
+public:
+    struct Face
+    {
+        LLPointer<LLImageRaw>   mImage;
+        LLVector3               mLookDir;
+        LLVector3               mUpVec;
+    };
+    typedef std::array<Face, 6> faces_t;
+
+    struct Metadata
+    {
+        std::string mSoftware;
+        std::string mCaptureSoftware;
+        std::string mDate;              // ISO 8601
+        std::string mRegionName;
+        std::string mRegionURL;
+        F32         mHeadingDeg = 0.f;  // Compass heading at the center of the image
+    };
+
+    typedef std::function<void(bool success)> callback_t;
+
+    // Whether the GPU path can produce an image this wide
+    static bool canConvert(U32 width);
+
+    // Starts the conversion in a coroutine on the main thread, the callback
+    // runs there once the file is written or the conversion failed
+    static void convert(const faces_t& faces, U32 width, const Metadata& metadata, S32 quality,
+                        const std::string& filename, callback_t callback);
+};
+
+#endif // FS_FS360EQUIRECT_H
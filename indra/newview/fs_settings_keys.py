@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+# @file fs_settings_keys.py
+# @brief Generate typed LLControlKey constants for the settings in settings.xml
+#
+# $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+# Phoenix Firestorm Viewer Source Code
+# Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation;
+# version 2.1 of the License only.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+#
+# The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+# http://www.firestormviewer.org
+# $/LicenseInfo$
+
+# Usage: fs_settings_keys.py <settings.xml> <output header>
+#
+# Every setting becomes a constexpr LLControlKey in namespace FSSetting,
+# named like the setting. Names that don't start with a letter get a
+# leading underscore.
+
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+CONTROL_TYPES = {
+    "U32": "U32",
+    "S32": "S32",
+    "F32": "F32",
+    "Boolean": "bool",
+    "String": "std::string",
+    "Vector3": "LLVector3",
+    "Vector3D": "LLVector3d",
+    "Quaternion": "LLQuaternion",
+    "Rect": "LLRect",
+    "Color4": "LLColor4",
+    "Color3": "LLColor3",
+    "LLSD": "LLSD",
+}
+
+def read_settings(filename):
+    # A stray < or & in a comment breaks loading the defaults at startup,
+    # so a file that isn't well formed has to fail the build here
+    try:
+        root = ET.parse(filename).getroot()
+    except ET.ParseError as e:
+        raise ValueError("%s is not valid XML: %s" % (filename, e))
+    top = root.find("map")
+    if top is None:
+        raise ValueError("%s has no top level map" % filename)
+
+    settings = []
+    children = list(top)
+    for key, control in zip(children[0::2], children[1::2]):
+        if key.tag != "key" or control.tag != "map":
+            raise ValueError("Unexpected <%s> in %s" % (control.tag, filename))
+        fields = list(control)
+        control_type = None
+        for field, value in zip(fields[0::2], fields[1::2]):
+            if field.text == "Type":
+                control_type = value.text
+        if control_type not in CONTROL_TYPES:
+            raise ValueError("Setting %s in %s has unknown type %s" % (key.text, filename, control_type))
+        settings.append((key.text, CONTROL_TYPES[control_type]))
+    return settings
+
+def identifier(name):
+    ident = re.sub(r"\W", "_", name)
+    if not re.match(r"[A-Za-z]", ident):
+        ident = "_" + ident
+    return ident
+
+def write_header(settings, source, filename):
+    lines = [
+        "// Generated by fs_settings_keys.py from %s, do not edit" % os.path.basename(source),
+        "",
+        "#ifndef FS_FSSETTINGKEYS_H",
+        "#define FS_FSSETTINGKEYS_H",
+        "",
+        '#include "llcontrol.h"',
+        "",
+        "namespace FSSetting",
+        "{",
+    ]
+    for index, (name, cpp_type) in enumerate(settings):
+        lines.append('    constexpr LLControlKey<%s> %s{ %d, "%s" };' % (cpp_type, identifier(name), index, name))
+    lines += [
+        "",
+        "    constexpr U32 KEY_COUNT = %d;" % len(settings),
+        "}",
+        "",
+        "#endif // FS_FSSETTINGKEYS_H",
+        "",
+    ]
+    text = "\n".join(lines)
+
+    # Leave the header alone when nothing changed, it would rebuild
+    # everything that includes it
+    try:
+        with open(filename, "r") as existing:
+            if existing.read() == text:
+                return
+    except IOError:
+        pass
+    with open(filename, "w") as out:
+        out.write(text)
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write("Usage: %s <settings.xml> <output header>\n" % argv[0])
+        return 1
+    try:
+        settings = read_settings(argv[1])
+    except ValueError as e:
+        sys.stderr.write("%s\n" % e)
+        return 1
+    names = [name for name, _ in settings]
+    if len(set(names)) != len(names):
+        sys.stderr.write("Duplicate settings in %s\n" % argv[1])
+        return 1
+    write_header(settings, argv[1], argv[2])
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,188 @@
+/**
+ * @file fsanimationscheduler.cpp
+ * @brief Frame budget for the animation of avatars and animesh
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsanimationscheduler.h"
+
+#include "llframetimer.h"
+#include "llviewercontrol.h"
+#include "llvoavatar.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Weight of the last update in the smoothed cost of an avatar
+    constexpr F32 COST_SMOOTHING = 0.1f;
+
+    bool is_scheduled(const LLVOAvatar* avatar)
+    {
+        return !avatar->isDead()
+            && !avatar->isSelf()
+            && !avatar->isUIAvatar()
+            && avatar->isVisible()
+            && avatar->mSpecialRenderMode == 0
+            && avatar->mUpdatePeriod <= 1;  // impostors have their own rate
+    }
+}
+
+FSAnimationScheduler::FSAnimationScheduler()
+:   mSlot(0),
+    mLastSchedule(0),
+    mEnabled(false)
+{
+    std::fill(std::begin(mLoad), std::end(mLoad), 0.f);
+}
+
+FSAnimationScheduler::~FSAnimationScheduler()
+{
+}
+
+void FSAnimationScheduler::schedule()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+
+    static LLCachedControl<bool> enabled(gSavedSettings, "FSAnimationBudget", true);
+    static LLCachedControl<F32> budget_ms(gSavedSettings, "FSAnimationBudgetMs", 4.f);
+
+    const U32 frame = LLFrameTimer::getFrameCount();
+    mSlot = frame % MAX_PERIOD;
+
+    if (!enabled)
+    {
+        if (mEnabled)
+        { // everybody back to every frame
+            for (LLCharacter* character : LLCharacter::sInstances)
+            {
+                LLVOAvatar* avatar = (LLVOAvatar*)character;
+                avatar->mAnimationPeriod = 1;
+                avatar->mAnimationPhase = 0;
+            }
+            mEnabled = false;
+        }
+        return;
+    }
+    mEnabled = true;
+
+    // Periods only change at the start of a cycle, and not more often than
+    // once a cycle, so an avatar is never left out longer than its period
+    if (mSlot != 0 && frame - mLastSchedule < MAX_PERIOD)
+    {
+        return;
+    }
+    mLastSchedule = frame;
+
+    mEntries.clear();
+    F32 floor_cost = 0.f;
+    for (LLCharacter* character : LLCharacter::sInstances)
+    {
+        LLVOAvatar* avatar = (LLVOAvatar*)character;
+        if (!is_scheduled(avatar))
+        {
+            avatar->mAnimationPeriod = 1;
+            avatar->mAnimationPhase = 0;
+            continue;
+        }
+
+        mEntries.push_back({ avatar, avatar->getPixelArea(), avatar->mAnimationCost });
+        floor_cost += avatar->mAnimationCost / MAX_PERIOD;
+    }
+
+    std::sort(mEntries.begin(), mEntries.end(),
+        [](const Entry& a, const Entry& b)
+        {
+            return a.mImportance > b.mImportance;
+        });
+
+    // What the budget allows on top of everybody at the slowest rate
+    F32 remaining = llmax(budget_ms / 1000.f - floor_cost, 0.f);
+
+    std::fill(std::begin(mLoad), std::end(mLoad), 0.f);
+    for (const Entry& entry : mEntries)
+    {
+        LLVOAvatar* avatar = entry.mAvatar;
+        const F32 slowest = entry.mCost / MAX_PERIOD;
+
+        U32 period = 1;
+        while (period < MAX_PERIOD && entry.mCost / period - slowest > remaining)
+        {
+            period *= 2;
+        }
+        remaining -= entry.mCost / period - slowest;
+
+        U32 phase = avatar->mAnimationPhase;
+        if (period != avatar->mAnimationPeriod || phase >= period)
+        { // the phase whose frames are the least loaded so far
+            F32 best_load = 0.f;
+            for (U32 candidate = 0; candidate < period; ++candidate)
+            {
+                F32 load = 0.f;
+                for (U32 slot = candidate; slot < MAX_PERIOD; slot += period)
+                {
+                    load = llmax(load, mLoad[slot]);
+                }
+                if (candidate == 0 || load < best_load)
+                {
+                    best_load = load;
+                    phase = candidate;
+                }
+            }
+        }
+
+        for (U32 slot = phase; slot < MAX_PERIOD; slot += period)
+        {
+            mLoad[slot] += entry.mCost;
+        }
+
+        avatar->mAnimationPeriod = period;
+        avatar->mAnimationPhase = phase;
+    }
+
+    // Don't hold on to avatars past the frame
+    mEntries.clear();
+}
+
+bool FSAnimationScheduler::shouldAnimate(const LLVOAvatar* avatar) const
+{
+    return !mEnabled
+        || avatar->mAnimationPeriod <= 1
+        || avatar->mUpdatePeriod > 1    // turned into an impostor since it was scheduled
+        || mSlot % avatar->mAnimationPeriod == avatar->mAnimationPhase;
+}
+
+void FSAnimationScheduler::recordCost(LLVOAvatar* avatar, F64 seconds)
+{
+    if (avatar->mAnimationCost <= 0.f)
+    {
+        avatar->mAnimationCost = (F32)seconds;
+    }
+    else
+    {
+        avatar->mAnimationCost = lerp(avatar->mAnimationCost, (F32)seconds, COST_SMOOTHING);
+    }
+}
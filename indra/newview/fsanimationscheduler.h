@@ -0,0 +1,88 @@
+/**
+ * @file fsanimationscheduler.h
+ * @brief Frame budget for the animation of avatars and animesh
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSANIMATIONSCHEDULER_H
+#define FS_FSANIMATIONSCHEDULER_H
+
+#include "llsingleton.h"
+
+#include <vector>
+
+class LLVOAvatar;
+
+// Spreads a per frame budget for evaluating animations across all visible
+// avatars and animesh (LLControlAvatar) that are drawn at full detail.
+// Impostors keep the update period LLVOAvatar::computeUpdatePeriod() gives
+// them and the agent's own avatar is always animated.
+//
+// Every avatar measures what its motions cost per update. Each avatar first
+// gets the slowest rate, 1 in MAX_PERIOD frames, then what is left of the
+// budget goes to the avatars in order of their pixel area, each taking the
+// fastest power of two rate that still fits. The phases of the slower
+// avatars are picked to even out the cost of the frames, rather than all
+// of them landing on the same frame.
+//
+// On the frames it isn't animated an avatar keeps last frame's pose, its
+// root and joint matrices still follow it around. The motions get the time
+// that passed in between on the next update.
+// Enabled with FSAnimationBudget.
+class FSAnimationScheduler : public LLSingleton<FSAnimationScheduler>
+{
+    LLSINGLETON(FSAnimationScheduler);
+    ~FSAnimationScheduler();
+
+public:
+    static constexpr U32 MAX_PERIOD = 16;
+
+    // Threads:  Tmain
+    // Once a frame, before the idle updates of the avatars
+    void schedule();
+
+    // Threads:  Tmain
+    // Whether avatar evaluates its motions this frame
+    bool shouldAnimate(const LLVOAvatar* avatar) const;
+
+    // Threads:  Tmain
+    // Seconds avatar spent on its motions in an update
+    void recordCost(LLVOAvatar* avatar, F64 seconds);
+
+private:
+    struct Entry
+    {
+        LLVOAvatar* mAvatar;
+        F32         mImportance;
+        F32         mCost;      // seconds per update
+    };
+
+    std::vector<Entry>  mEntries;   // scratch of schedule()
+    F32                 mLoad[MAX_PERIOD];  // expected seconds of each frame slot
+    U32                 mSlot;      // of this frame, in [0, MAX_PERIOD)
+    U32                 mLastSchedule;  // frame
+    bool                mEnabled;
+};
+
+#endif // FS_FSANIMATIONSCHEDULER_H
@@ -171,6 +171,10 @@ FSAreaSearch::FSAreaSearch(const LLSD& key) :
     mExcludeNeighborRegions(true),
     mRequestQueuePause(false),
     mRequestNeedsSent(false),
+    // <FS> Area search index
+    mRequestBudget(0.f),
+    mRematchPending(false),
+    // </FS>
     mRlvBehaviorCallbackConnection()
 {
     gAgent.setFSAreaSearchActive(true);
@@ -224,6 +228,8 @@ FSAreaSearch::~FSAreaSearch()
         LLViewerParcelMgr::getInstance()->removeObserver(mParcelChangedObserver.get());
         mParcelChangedObserver = nullptr;
     }
+
+    gObjectList.setAreaSearchIndexEnabled(false); // <FS/> Area search index
 }
 
 bool FSAreaSearch::postBuild()
@@ -351,6 +357,7 @@ void FSAreaSearch::checkRegion()
             mRequested = 0;
             mObjectDetails.clear();
             mRegionRequests.clear();
+            mRequestQueue.clear(); // <FS/> Area search index
             mLastPropertiesReceivedTimer.start();
             mPanelList->getResultList()->deleteAllItems();
             mPanelList->setCounterText();
@@ -369,16 +376,30 @@ void FSAreaSearch::refreshList(bool cache_clear)
         mRequested = 0;
         mObjectDetails.clear();
         mRegionRequests.clear();
+        mRequestQueue.clear(); // <FS/> Area search index
         mLastPropertiesReceivedTimer.start();
+        // <FS> Incremental area search results
+        mPanelList->getResultList()->deleteAllItems();
+        // </FS>
     }
     else
     {
+        // <FS> Incremental area search results
+        // Listed rows are matched again and updated or removed in place
+        //for (auto& object_it : mObjectDetails)
+        //{
+        //     object_it.second.listed = false;
+        //}
         for (auto& object_it : mObjectDetails)
         {
-             object_it.second.listed = false;
+             object_it.second.rematch = object_it.second.listed;
         }
+        mRematchPending = true;
+        // </FS>
     }
-    mPanelList->getResultList()->deleteAllItems();
+    // <FS> Incremental area search results
+    //mPanelList->getResultList()->deleteAllItems();
+    // </FS>
     mPanelList->setCounterText();
     mPanelList->setAgentLastPosition(gAgent.getPositionGlobal());
     mNamesRequested.clear();
@@ -409,54 +430,101 @@ void FSAreaSearch::findObjects()
     checkRegion();
     mRefresh = false;
     mSearchableObjects = 0;
-    S32 object_count = gObjectList.getNumObjects();
-
-    for (S32 i = 0; i < object_count; i++)
-    {
-        LLViewerObject* objectp = gObjectList.getObject(i);
-        if (!objectp || !isSearchableObject(objectp, our_region))
-        {
-            continue;
-        }
-
-        const LLUUID& object_id = objectp->getID();
-
-        if (object_id.isNull())
-        {
-            LL_WARNS("FSAreaSearch") << "WTF?! Selectable object with id of NULL!!" << LL_ENDL;
-            continue;
-        }
-
-        mSearchableObjects++;
-
-        if (mObjectDetails.count(object_id) == 0)
-        {
-            FSObjectProperties& details = mObjectDetails[object_id];
-            details.id = object_id;
-            details.local_id = objectp->getLocalID();
-            details.region_handle = objectp->getRegion()->getHandle();
-            mRequestNeedsSent = true;
-            mRequested++;
-        }
-        else
-        {
-            FSObjectProperties& details = mObjectDetails[object_id];
-            if (details.request == FSObjectProperties::FINISHED)
+    // <FS> Area search index
+    //S32 object_count = gObjectList.getNumObjects();
+    //
+    //for (S32 i = 0; i < object_count; i++)
+    //{
+    //    LLViewerObject* objectp = gObjectList.getObject(i);
+    //    if (!objectp || !isSearchableObject(objectp, our_region))
+    //    {
+    //        continue;
+    //    }
+    //
+    //    const LLUUID& object_id = objectp->getID();
+    //
+    //    if (object_id.isNull())
+    //    {
+    //        LL_WARNS("FSAreaSearch") << "WTF?! Selectable object with id of NULL!!" << LL_ENDL;
+    //        continue;
+    //    }
+    //
+    //    mSearchableObjects++;
+    //
+    //    if (mObjectDetails.count(object_id) == 0)
+    //    {
+    //        FSObjectProperties& details = mObjectDetails[object_id];
+    //        details.id = object_id;
+    //        details.local_id = objectp->getLocalID();
+    //        details.region_handle = objectp->getRegion()->getHandle();
+    //        mRequestNeedsSent = true;
+    //        mRequested++;
+    //    }
+    //    else
+    //    {
+    //        FSObjectProperties& details = mObjectDetails[object_id];
+    //        if (details.request == FSObjectProperties::FINISHED)
+    //        {
+    //            matchObject(details, objectp);
+    //        }
+    //
+    //        if (details.request == FSObjectProperties::FAILED)
+    //        {
+    //            // object came back into view
+    //            details.request = FSObjectProperties::NEED;
+    //            details.local_id = objectp->getLocalID();
+    //            details.region_handle = objectp->getRegion()->getHandle();
+    //            mRequestNeedsSent = true;
+    //            mRequested++;
+    //        }
+    //    }
+    //}
+    if (mRematchPending)
+    {
+        for (LLScrollListItem* item : mPanelList->getResultList()->getAllData())
+        {
+            mRematchRows[item->getUUID()] = item;
+        }
+        mRematchPending = false;
+    }
+
+    static LLCachedControl<bool> use_index(gSavedSettings, "FSAreaSearchIndex");
+    if (use_index != gObjectList.getAreaSearchIndex().isEnabled())
+    {
+        gObjectList.setAreaSearchIndexEnabled(use_index);
+    }
+
+    const FSAreaSearchIndex& index = gObjectList.getAreaSearchIndex();
+    if (index.isEnabled() && mExcludeNeighborRegions)
+    {
+        if (const FSAreaSearchIndex::object_set_t* objects = index.getRegionObjects(our_region->getHandle()))
+        {
+            for (LLViewerObject* objectp : *objects)
             {
-                matchObject(details, objectp);
+                processObject(objectp, our_region);
             }
-
-            if (details.request == FSObjectProperties::FAILED)
+        }
+    }
+    else if (index.isEnabled())
+    {
+        for (const auto& region_it : index.getRegions())
+        {
+            for (LLViewerObject* objectp : region_it.second)
             {
-                // object came back into view
-                details.request = FSObjectProperties::NEED;
-                details.local_id = objectp->getLocalID();
-                details.region_handle = objectp->getRegion()->getHandle();
-                mRequestNeedsSent = true;
-                mRequested++;
+                processObject(objectp, our_region);
             }
         }
     }
+    else
+    {
+        S32 object_count = gObjectList.getNumObjects();
+        for (S32 i = 0; i < object_count; i++)
+        {
+            processObject(gObjectList.getObject(i), our_region);
+        }
+    }
+    mRematchRows.clear();
+    // </FS>
 
     mPanelList->updateScrollList();
 
@@ -490,6 +558,60 @@ void FSAreaSearch::findObjects()
     mRequestQueuePause = false;
 }
 
+// <FS> Area search index
+void FSAreaSearch::processObject(LLViewerObject* objectp, LLViewerRegion* our_region)
+{
+    if (!objectp || !isSearchableObject(objectp, our_region))
+    {
+        return;
+    }
+
+    const LLUUID& object_id = objectp->getID();
+
+    if (object_id.isNull())
+    {
+        LL_WARNS("FSAreaSearch") << "WTF?! Selectable object with id of NULL!!" << LL_ENDL;
+        return;
+    }
+
+    mSearchableObjects++;
+
+    if (mObjectDetails.count(object_id) == 0)
+    {
+        FSObjectProperties& details = mObjectDetails[object_id];
+        details.id = object_id;
+        details.local_id = objectp->getLocalID();
+        details.region_handle = objectp->getRegion()->getHandle();
+        queueRequest(details);
+        mRequested++;
+    }
+    else
+    {
+        FSObjectProperties& details = mObjectDetails[object_id];
+        if (details.request == FSObjectProperties::FINISHED)
+        {
+            matchObject(details, objectp);
+        }
+
+        if (details.request == FSObjectProperties::FAILED)
+        {
+            // object came back into view
+            details.request = FSObjectProperties::NEED;
+            details.local_id = objectp->getLocalID();
+            details.region_handle = objectp->getRegion()->getHandle();
+            queueRequest(details);
+            mRequested++;
+        }
+    }
+}
+
+void FSAreaSearch::queueRequest(FSObjectProperties& details)
+{
+    mRequestQueue[details.region_handle].push_back(details.id);
+    mRequestNeedsSent = true;
+}
+// </FS>
+
 bool FSAreaSearch::isSearchableObject(LLViewerObject* objectp, LLViewerRegion* our_region)
 {
     // need to be connected to region object is in.
@@ -565,7 +687,10 @@ void FSAreaSearch::processRequestQueue()
             if (object_it.second.request == FSObjectProperties::SENT)
             {
                 object_it.second.request = FSObjectProperties::NEED;
-                mRequestNeedsSent = true;
+                // <FS> Area search index
+                //mRequestNeedsSent = true;
+                queueRequest(object_it.second);
+                // </FS>
                 request_count++;
             }
 
@@ -596,39 +721,100 @@ void FSAreaSearch::processRequestQueue()
     }
     mRequestNeedsSent = false;
 
+    // <FS> Area search index
+    // Requests go out in batches of the queued objects, at no more than
+    // FSAreaSearchRequestRate objects per second.
+    //for (const auto regionp : LLWorld::getInstance()->getRegionList())
+    //{
+    //    U64 region_handle = regionp->getHandle();
+    //    if (mRegionRequests[region_handle] > (MAX_OBJECTS_PER_PACKET + 128))
+    //    {
+    //        mRequestNeedsSent = true;
+    //        return;
+    //    }
+    //
+    //    std::vector<U32> request_list;
+    //    bool need_continue = false;
+    //
+    //    for (auto& object_it : mObjectDetails)
+    //    {
+    //        if (object_it.second.request == FSObjectProperties::NEED && object_it.second.region_handle == region_handle)
+    //        {
+    //            request_list.push_back(object_it.second.local_id);
+    //            object_it.second.request = FSObjectProperties::SENT;
+    //            mRegionRequests[region_handle]++;
+    //            if (mRegionRequests[region_handle] >= ((MAX_OBJECTS_PER_PACKET * 3) - 3))
+    //            {
+    //                requestObjectProperties(request_list, true, regionp);
+    //                requestObjectProperties(request_list, false, regionp);
+    //                mRequestNeedsSent = true;
+    //                need_continue = true;
+    //                break;
+    //            }
+    //        }
+    //    }
+    //
+    //    if (need_continue)
+    //    {
+    //        continue;
+    //    }
+    //
+    //    if (!request_list.empty())
+    //    {
+    //        requestObjectProperties(request_list, true, regionp);
+    //        requestObjectProperties(request_list, false, regionp);
+    //    }
+    //}
+    static LLCachedControl<U32> request_rate(gSavedSettings, "FSAreaSearchRequestRate");
+    const F32 rate = (F32)request_rate();
+    if (rate > 0.f)
+    {
+        mRequestBudget = llmin(mRequestBudget + mRequestBudgetTimer.getElapsedTimeF32() * rate, rate);
+    }
+    mRequestBudgetTimer.reset();
+
     for (const auto regionp : LLWorld::getInstance()->getRegionList())
     {
         U64 region_handle = regionp->getHandle();
+        auto queue_it = mRequestQueue.find(region_handle);
+        if (queue_it == mRequestQueue.end() || queue_it->second.empty())
+        {
+            continue;
+        }
+
         if (mRegionRequests[region_handle] > (MAX_OBJECTS_PER_PACKET + 128))
         {
             mRequestNeedsSent = true;
-            return;
+            continue;
         }
 
+        std::deque<LLUUID>& queue = queue_it->second;
         std::vector<U32> request_list;
-        bool need_continue = false;
-
-        for (auto& object_it : mObjectDetails)
+        while (!queue.empty() && mRegionRequests[region_handle] < ((MAX_OBJECTS_PER_PACKET * 3) - 3) &&
+               (rate <= 0.f || mRequestBudget >= 1.f))
         {
-            if (object_it.second.request == FSObjectProperties::NEED && object_it.second.region_handle == region_handle)
+            const LLUUID id = queue.front();
+            queue.pop_front();
+
+            auto details_it = mObjectDetails.find(id);
+            if (details_it == mObjectDetails.end() || details_it->second.request != FSObjectProperties::NEED)
             {
-                request_list.push_back(object_it.second.local_id);
-                object_it.second.request = FSObjectProperties::SENT;
-                mRegionRequests[region_handle]++;
-                if (mRegionRequests[region_handle] >= ((MAX_OBJECTS_PER_PACKET * 3) - 3))
-                {
-                    requestObjectProperties(request_list, true, regionp);
-                    requestObjectProperties(request_list, false, regionp);
-                    mRequestNeedsSent = true;
-                    need_continue = true;
-                    break;
-                }
+                // Answered, failed or queued twice
+                continue;
             }
-        }
 
-        if (need_continue)
-        {
-            continue;
+            FSObjectProperties& details = details_it->second;
+            if (details.region_handle != region_handle)
+            {
+                // Crossed into another region since it was queued
+                mRequestQueue[details.region_handle].push_back(id);
+                continue;
+            }
+
+            request_list.push_back(details.local_id);
+            details.request = FSObjectProperties::SENT;
+            mRegionRequests[region_handle]++;
+            mRequestBudget -= 1.f;
         }
 
         if (!request_list.empty())
@@ -636,7 +822,13 @@ void FSAreaSearch::processRequestQueue()
             requestObjectProperties(request_list, true, regionp);
             requestObjectProperties(request_list, false, regionp);
         }
+
+        if (!queue.empty())
+        {
+            mRequestNeedsSent = true;
+        }
     }
+    // </FS>
 }
 
 void FSAreaSearch::requestObjectProperties(const std::vector<U32>& request_list, bool select, LLViewerRegion* regionp)
@@ -793,12 +985,41 @@ void FSAreaSearch::processObjectProperties(LLMessageSystem* msg)
 
 void FSAreaSearch::matchObject(FSObjectProperties& details, LLViewerObject* objectp)
 {
-    if (details.listed)
+    // <FS> Incremental area search results
+    //if (details.listed)
+    //{
+    //    // object allready listed on the scroll list.
+    //    return;
+    //}
+    if (details.listed && !details.rematch)
     {
         // object allready listed on the scroll list.
         return;
     }
 
+    LLScrollListItem* list_row = nullptr;
+    if (details.listed)
+    {
+        auto row_it = mRematchRows.find(details.id);
+        list_row = (row_it != mRematchRows.end()) ? row_it->second : mPanelList->getResultList()->getItem(LLSD(details.id));
+    }
+    details.listed = false;
+    details.rematch = false;
+    listObject(details, objectp, list_row);
+
+    if (list_row && !details.listed)
+    {
+        // No longer matches, the row goes
+        FSScrollListCtrl* result_list = mPanelList->getResultList();
+        result_list->deleteSingleItem(result_list->getItemIndex(list_row));
+        mRematchRows.erase(details.id);
+    }
+}
+
+void FSAreaSearch::listObject(FSObjectProperties& details, LLViewerObject* objectp, LLScrollListItem* list_row)
+{
+    // </FS>
+
     //-----------------------------------------------------------------------
     // Filters
     //-----------------------------------------------------------------------
@@ -1072,9 +1293,34 @@ void FSAreaSearch::matchObject(FSObjectProperties& details, LLViewerObject* obje
     cell_params.value = last_owner_name;
     row_params.columns.add(cell_params);
 
-    LLScrollListItem* list_row = mPanelList->getResultList()->addRow(row_params);
+    // <FS> Incremental area search results
+    //LLScrollListItem* list_row = mPanelList->getResultList()->addRow(row_params);
+    FSScrollListCtrl* result_list = mPanelList->getResultList();
+    const bool row_updated = (list_row != nullptr);
+    if (row_updated)
+    {
+        // Still listed from before the refresh, update it in place
+        for (LLInitParam::ParamIterator<LLScrollListCell::Params>::const_iterator itor = row_params.columns.begin();
+             itor != row_params.columns.end(); ++itor)
+        {
+            LLScrollListColumn* column = result_list->getColumn(itor->column());
+            LLScrollListCell* cell = column ? list_row->getColumn(column->mIndex) : nullptr;
+            if (cell)
+            {
+                cell->setValue(itor->value());
+            }
+        }
+    }
+    else
+    {
+        list_row = result_list->addRow(row_params);
+    }
+    // </FS>
 
-    if (objectp->flagTemporaryOnRez() || objectp->flagUsePhysics())
+    // <FS> Incremental area search results
+    //if (objectp->flagTemporaryOnRez() || objectp->flagUsePhysics())
+    if (objectp->flagTemporaryOnRez() || objectp->flagUsePhysics() || row_updated)
+    // </FS>
     {
         U8 font_style = LLFontGL::NORMAL;
         if (objectp->flagTemporaryOnRez())
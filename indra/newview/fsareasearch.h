@@ -37,6 +37,7 @@
 #include "llviewerobject.h"
 #include "rlvdefines.h"
 #include <boost/regex.hpp>
+#include <deque> // <FS/> Area search index
 
 class LLAvatarName;
 class LLTextBox;
@@ -47,6 +48,7 @@ class LLTabContainer;
 class LLContextMenu;
 class LLSpinCtrl;
 class LLComboBox;
+class LLScrollListItem; // <FS/> Area search index
 
 class FSPanelAreaSearchList;
 class FSPanelAreaSearchFind;
@@ -81,6 +83,7 @@ struct FSObjectProperties
     bool name_requested;
     U32 local_id;
     U64 region_handle;
+    bool rematch; // <FS/> Incremental area search results
 
     typedef enum e_object_properties_request
     {
@@ -94,7 +97,8 @@ struct FSObjectProperties
     FSObjectProperties() :
         request(NEED),
         listed(false),
-        name_requested(false)
+        name_requested(false),
+        rematch(false) // <FS/> Incremental area search results
     {
     }
 };
@@ -172,6 +176,11 @@ public:
 private:
     void requestObjectProperties(const std::vector< U32 >& request_list, bool select, LLViewerRegion* regionp);
     void matchObject(FSObjectProperties& details, LLViewerObject* objectp);
+    // <FS> Area search index
+    void listObject(FSObjectProperties& details, LLViewerObject* objectp, LLScrollListItem* list_row);
+    void processObject(LLViewerObject* objectp, LLViewerRegion* our_region);
+    void queueRequest(FSObjectProperties& details);
+    // </FS>
     void getNameFromUUID(const LLUUID& id, std::string& name, bool group, bool& name_requested);
 
     void updateCounterText();
@@ -189,6 +198,15 @@ private:
     bool mRequestQueuePause;
     bool mRequestNeedsSent;
     std::map<U64,S32> mRegionRequests;
+    // <FS> Area search index
+    // Objects waiting for a properties request, per region handle
+    std::map<U64, std::deque<LLUUID>> mRequestQueue;
+    F32 mRequestBudget;
+    LLFrameTimer mRequestBudgetTimer;
+    // Rows of the result list by object id, while a refresh rematches them
+    std::unordered_map<LLUUID, LLScrollListItem*> mRematchRows;
+    bool mRematchPending;
+    // </FS>
 
     std::string mSearchName;
     std::string mSearchDescription;
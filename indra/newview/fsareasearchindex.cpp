@@ -0,0 +1,138 @@
+/**
+ * @file fsareasearchindex.cpp
+ * @brief Region buckets of the objects area search can list
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsareasearchindex.h"
+
+#include "llviewerobject.h"
+#include "llviewerregion.h"
+
+FSAreaSearchIndex::FSAreaSearchIndex() :
+    mEnabled(false)
+{
+}
+
+void FSAreaSearchIndex::setEnabled(bool enabled, const std::vector<LLPointer<LLViewerObject>>& objects)
+{
+    if (enabled == mEnabled)
+    {
+        return;
+    }
+
+    mEnabled = enabled;
+    mRegions.clear();
+    mRegionOf.clear();
+    if (mEnabled)
+    {
+        mRegionOf.reserve(objects.size());
+        for (const LLPointer<LLViewerObject>& objectp : objects)
+        {
+            if (objectp.notNull() && !objectp->isDead())
+            {
+                addObject(objectp);
+            }
+        }
+    }
+}
+
+void FSAreaSearchIndex::addObject(LLViewerObject* objectp)
+{
+    if (mEnabled && isIndexed(objectp))
+    {
+        insert(objectp, objectp->getRegion()->getHandle());
+    }
+}
+
+void FSAreaSearchIndex::removeObject(LLViewerObject* objectp)
+{
+    if (!mEnabled)
+    {
+        return;
+    }
+
+    auto it = mRegionOf.find(objectp);
+    if (it == mRegionOf.end())
+    {
+        return;
+    }
+
+    auto region_it = mRegions.find(it->second);
+    if (region_it != mRegions.end())
+    {
+        region_it->second.erase(objectp);
+        if (region_it->second.empty())
+        {
+            mRegions.erase(region_it);
+        }
+    }
+    mRegionOf.erase(it);
+}
+
+void FSAreaSearchIndex::onRegionChanged(LLViewerObject* objectp)
+{
+    if (!mEnabled)
+    {
+        return;
+    }
+
+    // Only moves objects of the list, others never get removed again
+    auto it = mRegionOf.find(objectp);
+    if (it == mRegionOf.end())
+    {
+        return;
+    }
+
+    if (objectp->isDead() || !objectp->getRegion() || objectp->getRegion()->getHandle() != it->second)
+    {
+        removeObject(objectp);
+        if (!objectp->isDead())
+        {
+            addObject(objectp);
+        }
+    }
+}
+
+const FSAreaSearchIndex::object_set_t* FSAreaSearchIndex::getRegionObjects(U64 region_handle) const
+{
+    auto it = mRegions.find(region_handle);
+    return it != mRegions.end() ? &it->second : nullptr;
+}
+
+// static
+bool FSAreaSearchIndex::isIndexed(LLViewerObject* objectp)
+{
+    // Fixed for the life of an object, everything else is checked per search
+    return objectp && objectp->getRegion() && !objectp->isAvatar() &&
+           objectp->getPCode() != LLViewerObject::LL_VO_SURFACE_PATCH;
+}
+
+void FSAreaSearchIndex::insert(LLViewerObject* objectp, U64 region_handle)
+{
+    mRegionOf[objectp] = region_handle;
+    mRegions[region_handle].insert(objectp);
+}
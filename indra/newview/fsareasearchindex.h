@@ -0,0 +1,74 @@
+/**
+ * @file fsareasearchindex.h
+ * @brief Region buckets of the objects area search can list
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSAREASEARCHINDEX_H
+#define FS_FSAREASEARCHINDEX_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class LLViewerObject;
+class LLViewerRegion;
+
+// Objects that can have object properties, i.e. everything except avatars
+// and land, bucketed by the region they are in. LLViewerObjectList keeps it
+// up to date while it is enabled, so area search only walks the candidates
+// of the regions it searches instead of the whole object list.
+//
+// Objects are held by raw pointer; they are removed in cleanupReferences()
+// before the list drops its reference.
+class FSAreaSearchIndex
+{
+public:
+    typedef std::unordered_set<LLViewerObject*> object_set_t;
+
+    FSAreaSearchIndex();
+
+    // Enabling fills the index from objects, disabling empties it
+    void setEnabled(bool enabled, const std::vector<LLPointer<LLViewerObject>>& objects);
+    bool isEnabled() const { return mEnabled; }
+
+    void addObject(LLViewerObject* objectp);
+    void removeObject(LLViewerObject* objectp);
+    void onRegionChanged(LLViewerObject* objectp);
+
+    // Objects of a region, NULL if there are none
+    const object_set_t* getRegionObjects(U64 region_handle) const;
+    const std::unordered_map<U64, object_set_t>& getRegions() const { return mRegions; }
+    size_t size() const { return mRegionOf.size(); }
+
+private:
+    static bool isIndexed(LLViewerObject* objectp);
+    void insert(LLViewerObject* objectp, U64 region_handle);
+
+    std::unordered_map<U64, object_set_t>           mRegions;
+    std::unordered_map<LLViewerObject*, U64>        mRegionOf;
+    bool                                            mEnabled;
+};
+
+#endif // FS_FSAREASEARCHINDEX_H
@@ -40,6 +40,17 @@
 
 const LLUUID MAGIC_ID("3c115e51-04f4-523c-9fa6-98aff1034730");
 
+// 16 filter bits and 4 probes per id keep false positives around 0.25%
+constexpr U32 FILTER_BITS_PER_ID = 16;
+constexpr U32 FILTER_MIN_BITS = 1024;
+
+// Asset and object ids are random enough to use their words as hashes, the
+// multiply spreads the ones that are not
+static inline U32 filter_bit(U32 word, U32 mask)
+{
+    return (word * 0x9E3779B1u) & mask;
+}
+
 LLAssetType::EType S32toAssetType(S32 assetindex)
 {
     LLAssetType::EType type;
@@ -74,20 +85,78 @@ void FSAssetBlacklist::init()
 
 bool FSAssetBlacklist::isBlacklisted(const LLUUID& id, LLAssetType::EType type)
 {
-    if (mBlacklistData.empty())
+    if (mBlacklistData.empty() || !mayBeBlacklisted(id))
     {
         return false;
     }
 
-    blacklist_type_map_t::iterator it = mBlacklistTypeContainer.find(type);
+    blacklist_type_map_t::const_iterator it = mBlacklistTypeContainer.find(type);
 
     if (it == mBlacklistTypeContainer.end())
     {
         return false;
     }
 
-    blacklisted_uuid_container_t uuids = it->second;
-    return (uuids.find(id) != uuids.end());
+    return (it->second.find(id) != it->second.end());
+}
+
+bool FSAssetBlacklist::mayBeBlacklisted(const LLUUID& id) const
+{
+    if (mFilterBits.empty())
+    {
+        return false;
+    }
+
+    U32 words[4];
+    memcpy(words, id.mData, sizeof(words));
+    for (U32 word : words)
+    {
+        const U32 bit = filter_bit(word, mFilterMask);
+        if (!(mFilterBits[bit >> 6] & (1ull << (bit & 63))))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FSAssetBlacklist::addToFilter(const LLUUID& id)
+{
+    if (mBlacklistData.size() >= mFilterCapacity)
+    {
+        // Grow with the blacklist, the id is already in the type map
+        rebuildFilter();
+        return;
+    }
+
+    U32 words[4];
+    memcpy(words, id.mData, sizeof(words));
+    for (U32 word : words)
+    {
+        const U32 bit = filter_bit(word, mFilterMask);
+        mFilterBits[bit >> 6] |= (1ull << (bit & 63));
+    }
+}
+
+void FSAssetBlacklist::rebuildFilter()
+{
+    U32 bits = FILTER_MIN_BITS;
+    while (bits / FILTER_BITS_PER_ID < (mBlacklistData.size() + 1) * 2)
+    {
+        bits <<= 1;
+    }
+
+    mFilterBits.assign(bits / 64, 0);
+    mFilterMask = bits - 1;
+    mFilterCapacity = bits / FILTER_BITS_PER_ID;
+
+    for (const auto& [type, uuids] : mBlacklistTypeContainer)
+    {
+        for (const LLUUID& id : uuids)
+        {
+            addToFilter(id);
+        }
+    }
 }
 
 void FSAssetBlacklist::addNewItemToBlacklist(const LLUUID& id, const std::string& name, const std::string& region, LLAssetType::EType type, bool permanent /*= true*/, bool save /*= true*/)
@@ -152,6 +221,7 @@ void FSAssetBlacklist::removeItemsFromBlacklist(const uuid_vec_t& ids)
             }
             data.append(id.asString());
         }
+        rebuildFilter();
 
         if (need_save)
         {
@@ -212,6 +282,7 @@ bool FSAssetBlacklist::addEntryToBlacklistMap(const LLUUID& id, LLAssetType::ETy
     {
         mBlacklistTypeContainer[type] = blacklisted_uuid_container_t{ id };
     }
+    addToFilter(id);
     return true;
 }
 
@@ -71,10 +71,22 @@ private:
     bool removeItem(const LLUUID& id);
     bool addEntryToBlacklistMap(const LLUUID& id, LLAssetType::EType type);
 
+    // Bloom filter over all blacklisted ids, whatever their type. Most ids
+    // looked up are not blacklisted, and the filter rules them out with a few
+    // bit tests on the raw id words. It can't forget ids, it is rebuilt when
+    // entries are removed.
+    bool mayBeBlacklisted(const LLUUID& id) const;
+    void addToFilter(const LLUUID& id);
+    void rebuildFilter();
+
     std::string             mBlacklistFileName;
     blacklist_type_map_t    mBlacklistTypeContainer;
     blacklist_data_t        mBlacklistData;
 
+    std::vector<U64>        mFilterBits;
+    U32                     mFilterMask{ 0 };      // Bit count - 1, bit count is a power of two
+    size_t                  mFilterCapacity{ 0 };  // Ids the filter is sized for
+
     blacklist_changed_callback_t mBlacklistChangedCallback;
 };
 
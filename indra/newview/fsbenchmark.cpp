@@ -0,0 +1,400 @@
+/**
+ * @file fsbenchmark.cpp
+ * @brief Scripted benchmark run with a machine readable report
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsbenchmark.h"
+
+#include "fsframepacer.h"
+#include "llagent.h"
+#include "llagentpilot.h"
+#include "llappviewer.h"
+#include "llgl.h"
+#include "llmeshrepository.h"
+#include "llsdjson.h"
+#include "llsdutil_math.h"
+#include "llstartup.h"
+#include "llsys.h"
+#include "lltexturefetch.h"
+#include "llversioninfo.h"
+#include "llviewercontrol.h"
+#include "llviewerregion.h"
+#include "llviewerwindow.h"
+#include "llwindow.h"
+
+#include <algorithm>
+
+namespace
+{
+    // The scene counts as loaded once nothing was fetched for this long
+    constexpr F64 QUIET_SECONDS = 2.0;
+    constexpr F32 MEMORY_SAMPLE_INTERVAL = 1.f;
+
+    // Seconds since the viewer was launched
+    F64 now()
+    {
+        return (F64)(totalTime() - gStartTime) / 1000000.0;
+    }
+
+    bool is_scene_loading()
+    {
+        return LLAppViewer::getTextureFetch()->getNumRequests() > 0
+            || LLMeshRepoThread::sActiveHeaderRequests > 0
+            || LLMeshRepoThread::sActiveLODRequests > 0
+            || LLMeshRepository::sLODPending > 0;
+    }
+
+    // Seconds, null when the milestone was never reached
+    LLSD seconds_or_null(F64 seconds)
+    {
+        return (seconds > 0.0) ? LLSD(seconds) : LLSD();
+    }
+
+    // Percentiles in milliseconds of the samples in seconds, sorts them
+    LLSD percentiles_ms(std::vector<F32>& samples)
+    {
+        LLSD stats = LLSD::emptyMap();
+        stats["count"] = (LLSD::Integer)samples.size();
+        if (samples.empty())
+        {
+            return stats;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        F64 total = 0.0;
+        for (F32 sample : samples)
+        {
+            total += sample;
+        }
+        auto percentile = [&samples](F32 fraction)
+        {
+            const size_t index = llmin((size_t)(fraction * (F32)samples.size()), samples.size() - 1);
+            return (F64)samples[index] * 1000.0;
+        };
+
+        stats["mean_ms"] = total / (F64)samples.size() * 1000.0;
+        stats["p50_ms"] = percentile(0.5f);
+        stats["p90_ms"] = percentile(0.9f);
+        stats["p95_ms"] = percentile(0.95f);
+        stats["p99_ms"] = percentile(0.99f);
+        stats["max_ms"] = (F64)samples.back() * 1000.0;
+        return stats;
+    }
+}
+
+bool FSBenchmark::sEnabled = false;
+
+FSBenchmark::FSBenchmark() :
+    mOffline(false),
+    mPhase(EPhase::Startup),
+    mLoginScreenTime(0.0),
+    mLoginStartTime(0.0),
+    mInWorldTime(0.0),
+    mSceneLoadedTime(0.0),
+    mRunStart(0.0),
+    mRunEnd(0.0),
+    mLastBusy(0.0),
+    mUsePilot(false),
+    mPeakRSS(0)
+{
+}
+
+void FSBenchmark::init()
+{
+    sEnabled = gSavedSettings.getBOOL("FSBenchmarkMode") || gSavedSettings.getBOOL("FSBenchmarkOffline");
+    if (!sEnabled)
+    {
+        return;
+    }
+
+    mOffline = gSavedSettings.getBOOL("FSBenchmarkOffline");
+    if (!mOffline)
+    {
+        // Neither is persisted, both only last for this session
+        gSavedSettings.setBOOL("AutoLogin", true);
+        const std::string location = gSavedSettings.getString("FSBenchmarkLocation");
+        if (!location.empty() && gSavedSettings.getString("CmdLineLoginLocation").empty())
+        {
+            gSavedSettings.setString("CmdLineLoginLocation", location);
+        }
+    }
+
+    LL_INFOS("Benchmark") << "Benchmark mode, " << (mOffline ? "offline" : "online") << LL_ENDL;
+}
+
+void FSBenchmark::update()
+{
+    if (mPhase == EPhase::Done)
+    {
+        return;
+    }
+
+    const F64 now_seconds = now();
+    if (mMemoryTimer.getElapsedTimeF32() >= MEMORY_SAMPLE_INTERVAL)
+    {
+        sampleMemory();
+    }
+
+    // Counts from launch until the run starts, and then from the start of
+    // the run
+    static LLCachedControl<F32> timeout(gSavedSettings, "FSBenchmarkTimeout");
+    const F64 since = (mPhase == EPhase::Run) ? mRunStart : 0.0;
+    if (timeout > 0.f && now_seconds - since > (F64)timeout)
+    {
+        LL_WARNS("Benchmark") << "Benchmark " << (mPhase == EPhase::Run ? "run" : "start") << " took longer than " << (F32)timeout << " seconds" << LL_ENDL;
+        finish(now_seconds, "timeout");
+        return;
+    }
+
+    switch (mPhase)
+    {
+    case EPhase::Startup:
+        updateStartup(now_seconds);
+        break;
+    case EPhase::Settle:
+        updateSettle(now_seconds);
+        break;
+    case EPhase::Run:
+        {
+            mFrameTimes.push_back(gFrameIntervalSeconds.value());
+            mLatencies.push_back(FSFramePacer::instance().getLatency());
+
+            static LLCachedControl<F32> duration(gSavedSettings, "FSBenchmarkDuration");
+            const bool done = mUsePilot ? !gAgentPilot.isPlaying() : (now_seconds - mRunStart >= (F64)duration);
+            if (done)
+            {
+                finish(now_seconds, "complete");
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void FSBenchmark::updateStartup(F64 now)
+{
+    const EStartupState state = LLStartUp::getStartupState();
+    if (state == STATE_LOGIN_WAIT && mLoginScreenTime == 0.0)
+    {
+        mLoginScreenTime = now;
+    }
+    if (state >= STATE_LOGIN_CLEANUP && mLoginStartTime == 0.0)
+    {
+        mLoginStartTime = now;
+    }
+
+    if (mOffline ? state == STATE_LOGIN_WAIT : state == STATE_STARTED)
+    {
+        if (!mOffline)
+        {
+            mInWorldTime = now;
+        }
+        mLastBusy = now;
+        mPhase = EPhase::Settle;
+    }
+}
+
+void FSBenchmark::updateSettle(F64 now)
+{
+    if (!mOffline && mSceneLoadedTime == 0.0)
+    {
+        if (is_scene_loading())
+        {
+            mLastBusy = now;
+        }
+        else if (now - mLastBusy >= QUIET_SECONDS)
+        {
+            mSceneLoadedTime = mLastBusy;
+            LL_INFOS("Benchmark") << "Scene loaded " << mSceneLoadedTime - mInWorldTime << " seconds after arrival" << LL_ENDL;
+        }
+    }
+
+    static LLCachedControl<F32> settle(gSavedSettings, "FSBenchmarkSettleSeconds");
+    const F64 arrived = mOffline ? mLoginScreenTime : mInWorldTime;
+    if ((mOffline || mSceneLoadedTime > 0.0) && now - arrived >= (F64)settle)
+    {
+        startRun(now);
+    }
+}
+
+void FSBenchmark::startRun(F64 now)
+{
+    mUsePilot = false;
+    if (!mOffline)
+    {
+        // One pass over the recorded path, the benchmark decides what
+        // happens after
+        gAgentPilot.setLoop(false);
+        gAgentPilot.startPlayback();
+        mUsePilot = gAgentPilot.isPlaying();
+    }
+
+    mRunStart = now;
+    mFrameTimes.clear();
+    mLatencies.clear();
+    mFrameTimes.reserve(16384);
+    mLatencies.reserve(16384);
+    mPhase = EPhase::Run;
+    LL_INFOS("Benchmark") << "Benchmark run started, " << (mUsePilot ? "playing the recorded path" : "holding still") << LL_ENDL;
+}
+
+void FSBenchmark::finish(F64 now, const std::string& status)
+{
+    if (mPhase == EPhase::Run)
+    {
+        mRunEnd = now;
+    }
+    mPhase = EPhase::Done;
+    if (mUsePilot && gAgentPilot.isPlaying())
+    {
+        gAgentPilot.stopPlayback();
+    }
+
+    sampleMemory();
+    writeReport(buildReport(status));
+
+    if (gSavedSettings.getBOOL("FSBenchmarkQuit"))
+    {
+        LLAppViewer::instance()->requestQuit();
+    }
+}
+
+LLSD FSBenchmark::buildReport(const std::string& status) const
+{
+    LLSD report;
+    report["status"] = status;
+    report["mode"] = mOffline ? "offline" : "online";
+
+    LLSD& viewer = report["viewer"];
+    viewer["version"] = LLVersionInfo::instance().getChannelAndVersion();
+    viewer["build_config"] = LLVersionInfo::instance().getBuildConfig();
+
+    LLSD& system = report["system"];
+    system["os"] = LLOSInfo::instance().getOSStringSimple();
+    system["cpu"] = gSysCPU.getCPUString();
+    system["gpu"] = gGLManager.getRawGLString();
+    system["physical_memory_mb"] = (LLSD::Integer)(gSysMemory.getPhysicalMemoryKB().value() / 1024);
+
+    LLSD& settings = report["settings"];
+    settings["draw_distance"] = gSavedSettings.getF32("RenderFarClip");
+    settings["graphics_quality"] = (LLSD::Integer)gSavedSettings.getU32("RenderQualityPerformance");
+    settings["fps_limit"] = gSavedSettings.getBOOL("FSLimitFramerate") ? (LLSD::Integer)gSavedSettings.getU32("FramePerSecondLimit") : 0;
+    settings["vsync"] = gSavedSettings.getBOOL("RenderVSyncEnable");
+    settings["headless"] = gHeadlessClient;
+    if (gViewerWindow)
+    {
+        settings["window_width"] = gViewerWindow->getWindowWidthRaw();
+        settings["window_height"] = gViewerWindow->getWindowHeightRaw();
+    }
+
+    if (!mOffline)
+    {
+        LLSD& location = report["location"];
+        location["requested"] = gSavedSettings.getString("FSBenchmarkLocation");
+        if (LLViewerRegion* region = gAgent.getRegion())
+        {
+            location["region"] = region->getName();
+            location["position"] = ll_sd_from_vector3(gAgent.getPositionAgent());
+        }
+        location["recorded_path"] = mUsePilot;
+    }
+
+    LLSD& timings = report["timings"];
+    timings["login_screen_s"] = seconds_or_null(mLoginScreenTime);
+    timings["in_world_s"] = seconds_or_null(mInWorldTime);
+    timings["login_s"] = (mInWorldTime > 0.0 && mLoginStartTime > 0.0) ? LLSD(mInWorldTime - mLoginStartTime) : LLSD();
+    timings["scene_load_s"] = (mSceneLoadedTime > 0.0) ? LLSD(mSceneLoadedTime - mInWorldTime) : LLSD();
+    timings["run_s"] = (mRunEnd > 0.0) ? LLSD(mRunEnd - mRunStart) : LLSD();
+
+    std::vector<F32> frame_times(mFrameTimes);
+    LLSD frames = percentiles_ms(frame_times);
+    if (mRunEnd > mRunStart && !mFrameTimes.empty())
+    {
+        frames["fps"] = (F64)mFrameTimes.size() / (mRunEnd - mRunStart);
+        // Frames that took more than twice the median
+        const F32 stutter = frame_times[frame_times.size() / 2] * 2.f;
+        frames["stutters"] = (LLSD::Integer)std::count_if(mFrameTimes.begin(), mFrameTimes.end(), [stutter](F32 t) { return t > stutter; });
+    }
+    report["frames"] = frames;
+
+    std::vector<F32> latencies;
+    std::copy_if(mLatencies.begin(), mLatencies.end(), std::back_inserter(latencies), [](F32 t) { return t > 0.f; });
+    report["input_latency"] = percentiles_ms(latencies);
+
+    LLSD& memory = report["memory"];
+    memory["rss_peak_mb"] = (F64)mPeakRSS / (1024.0 * 1024.0);
+    memory["rss_end_mb"] = (F64)LLMemory::getCurrentRSS() / (1024.0 * 1024.0);
+    LLSD& subsystems = memory["subsystems"];
+    for (size_t i = 0; i < (size_t)LLMemTag::COUNT; ++i)
+    {
+        const LLMemTag tag = (LLMemTag)i;
+        LLSD& entry = subsystems[LLMemAccounting::getName(tag)];
+        entry["mb"] = (F64)LLMemAccounting::getBytes(tag) / (1024.0 * 1024.0);
+        entry["peak_mb"] = (F64)LLMemAccounting::getPeakBytes(tag) / (1024.0 * 1024.0);
+    }
+    return report;
+}
+
+void FSBenchmark::writeReport(const LLSD& report) const
+{
+    std::string filename = gSavedSettings.getString("FSBenchmarkReport");
+    if (filename.empty())
+    {
+        filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "benchmark_" + LLDate::now().toHTTPDateString("%Y%m%d_%H%M%S") + ".json");
+    }
+
+    llofstream json(filename.c_str(), std::ios::out | std::ios::trunc);
+    if (!json.is_open())
+    {
+        LL_WARNS("Benchmark") << "Unable to write benchmark report " << filename << LL_ENDL;
+        return;
+    }
+    json << boost::json::serialize(LlsdToJson(report)) << '\n';
+    json.close();
+
+    // Frame by frame, next to the report
+    const std::string csv_filename = gDirUtilp->getDirName(filename) + gDirUtilp->getDirDelimiter() + gDirUtilp->getBaseFileName(filename, true) + ".csv";
+    llofstream csv(csv_filename.c_str(), std::ios::out | std::ios::trunc);
+    if (csv.is_open())
+    {
+        csv << "frame,frame_ms,input_latency_ms\n";
+        for (size_t i = 0; i < mFrameTimes.size(); ++i)
+        {
+            csv << llformat("%u,%.3f,%.3f\n", (U32)i, mFrameTimes[i] * 1000.f, mLatencies[i] * 1000.f);
+        }
+        csv.close();
+    }
+
+    LL_INFOS("Benchmark") << "Benchmark " << report["status"].asString() << ", report written to " << filename << LL_ENDL;
+}
+
+void FSBenchmark::sampleMemory()
+{
+    mPeakRSS = llmax(mPeakRSS, LLMemory::getCurrentRSS());
+    mMemoryTimer.reset();
+}
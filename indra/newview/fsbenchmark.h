@@ -0,0 +1,112 @@
+/**
+ * @file fsbenchmark.h
+ * @brief Scripted benchmark run with a machine readable report
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSBENCHMARK_H
+#define FS_FSBENCHMARK_H
+
+#include "llframetimer.h"
+#include "llsd.h"
+#include "llsingleton.h"
+
+#include <vector>
+
+// Benchmark mode, for comparing viewer builds on the same scene and the
+// same machine.
+//
+// Online (--benchmark) the viewer logs in with the saved credentials at
+// FSBenchmarkLocation, waits until the textures and meshes around it have
+// loaded and for at least FSBenchmarkSettleSeconds, then plays the camera
+// path recorded with the agent pilot (StatsPilotXMLFile). Without a
+// recorded path it holds still for FSBenchmarkDuration seconds instead.
+// Offline (--benchmarkoffline) nothing connects to a grid: the run measures
+// the login screen for FSBenchmarkDuration seconds, which covers startup,
+// the UI and the rendering of the login screen.
+//
+// Either way the viewer then writes a JSON report with the startup and load
+// timings, the frame time percentiles, the input latency and the memory
+// use, and a CSV with one line per frame of the run, and quits. The report
+// goes to FSBenchmarkReport, or to the logs directory. A run that doesn't
+// get to the end within FSBenchmarkTimeout seconds writes a report with
+// what it has and the status "timeout".
+//
+// Runs with HeadlessClient as well, the frame times then don't include
+// rendering.
+class FSBenchmark : public LLSingleton<FSBenchmark>
+{
+    LLSINGLETON(FSBenchmark);
+
+public:
+    static bool isEnabled() { return sEnabled; }
+
+    // Threads:  Tmain
+    // From LLAppViewer::initConfiguration(), before the start location is
+    // worked out
+    void init();
+    // Every frame from LLAppViewer::idle(), including the frames before
+    // login
+    void update();
+
+private:
+    enum class EPhase
+    {
+        Startup,    // Until the login screen, or the world when online
+        Settle,     // Waiting for the scene to load
+        Run,        // Measuring
+        Done
+    };
+
+    void updateStartup(F64 now);
+    void updateSettle(F64 now);
+    void startRun(F64 now);
+    void finish(F64 now, const std::string& status);
+
+    LLSD buildReport(const std::string& status) const;
+    void writeReport(const LLSD& report) const;
+    void sampleMemory();
+
+    static bool sEnabled;
+
+    bool                mOffline;
+    EPhase              mPhase;
+
+    // Seconds since launch, 0 until reached
+    F64                 mLoginScreenTime;
+    F64                 mLoginStartTime;
+    F64                 mInWorldTime;
+    F64                 mSceneLoadedTime;
+    F64                 mRunStart;
+    F64                 mRunEnd;
+    F64                 mLastBusy;      // last time textures or meshes were loading
+
+    bool                mUsePilot;
+    std::vector<F32>    mFrameTimes;    // seconds
+    std::vector<F32>    mLatencies;     // seconds, 0 for frames that didn't present
+    U64                 mPeakRSS;
+    LLFrameTimer        mMemoryTimer;
+};
+
+#endif // FS_FSBENCHMARK_H
@@ -1899,6 +1899,12 @@ void FSChatHistory::appendMessage(const LLChat& chat, const LLSD &args, const LL
         //prependNewLineState = false;
     }
 
+    // <FS> Chat history scrollback limit
+    static LLCachedControl<S32> max_history_length(gSavedSettings, "FSChatHistoryMaxLength");
+    setMaxScrollbackLength(max_history_length);
+    trimScrollback();
+    // </FS>
+
     blockUndo();    // <FS:Zi> FIRE-8600: TAB out of chat history
 
     // automatically scroll to end when receiving chat from myself
@@ -0,0 +1,164 @@
+/**
+ * @file fschatlogwriter.cpp
+ * @brief Writes chat and IM transcripts from a background thread
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fschatlogwriter.h"
+
+#include "llfile.h"
+
+#include <chrono>
+
+namespace
+{
+    constexpr auto WRITE_INTERVAL = std::chrono::milliseconds(500);
+
+    // Write early once this much text is waiting
+    constexpr size_t MAX_PENDING_BYTES = 64 * 1024;
+}
+
+FSChatLogWriter::FSChatLogWriter() :
+    mPendingBytes(0),
+    mRunning(true)
+{
+    mWriter = std::thread([this]() { writerLoop(); });
+}
+
+FSChatLogWriter::~FSChatLogWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mPendingMutex);
+        mRunning = false;
+    }
+    mPendingCondition.notify_one();
+    if (mWriter.joinable())
+    {
+        mWriter.join();
+    }
+
+    // Whatever was logged while the thread stopped
+    writeAll();
+}
+
+void FSChatLogWriter::append(const std::string& filename, const std::string& text)
+{
+    bool wake_writer = false;
+    {
+        std::lock_guard<std::mutex> lock(mPendingMutex);
+        mPending[filename] += text;
+        mPendingBytes += text.size();
+        wake_writer = (mPendingBytes >= MAX_PENDING_BYTES);
+    }
+    if (wake_writer)
+    {
+        mPendingCondition.notify_one();
+    }
+}
+
+// static
+void FSChatLogWriter::flush(const std::string& filename)
+{
+    if (instanceExists())
+    {
+        getInstance()->write(filename);
+    }
+}
+
+// static
+void FSChatLogWriter::flushAll()
+{
+    if (instanceExists())
+    {
+        getInstance()->writeAll();
+    }
+}
+
+void FSChatLogWriter::writerLoop()
+{
+    LL_PROFILER_SET_THREAD_NAME("Chat log writer");
+
+    std::unique_lock<std::mutex> lock(mPendingMutex);
+    while (mRunning)
+    {
+        mPendingCondition.wait_for(lock, WRITE_INTERVAL, [this]() { return !mRunning || mPendingBytes >= MAX_PENDING_BYTES; });
+        if (mPending.empty())
+        {
+            continue;
+        }
+
+        lock.unlock();
+        writeAll();
+        lock.lock();
+    }
+}
+
+void FSChatLogWriter::write(const std::string& filename)
+{
+    std::lock_guard<std::mutex> write_lock(mWriteMutex);
+
+    std::string text;
+    {
+        std::lock_guard<std::mutex> lock(mPendingMutex);
+        auto it = mPending.find(filename);
+        if (it == mPending.end())
+        {
+            return;
+        }
+        text.swap(it->second);
+        mPendingBytes -= text.size();
+        mPending.erase(it);
+    }
+    writeFile(filename, text);
+}
+
+void FSChatLogWriter::writeAll()
+{
+    std::lock_guard<std::mutex> write_lock(mWriteMutex);
+
+    pending_map_t pending;
+    {
+        std::lock_guard<std::mutex> lock(mPendingMutex);
+        pending.swap(mPending);
+        mPendingBytes = 0;
+    }
+    for (const auto& [filename, text] : pending)
+    {
+        writeFile(filename, text);
+    }
+}
+
+// static
+void FSChatLogWriter::writeFile(const std::string& filename, const std::string& text)
+{
+    llofstream file(filename.c_str(), std::ios_base::app);
+    if (!file.is_open())
+    {
+        LL_WARNS() << "Couldn't open chat history log! - " << filename << LL_ENDL;
+        return;
+    }
+    file << text;
+}
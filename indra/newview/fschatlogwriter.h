@@ -0,0 +1,81 @@
+/**
+ * @file fschatlogwriter.h
+ * @brief Writes chat and IM transcripts from a background thread
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSCHATLOGWRITER_H
+#define FS_FSCHATLOGWRITER_H
+
+#include "llsingleton.h"
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// Appends transcript lines to their log files from a writer thread, so a busy
+// group chat doesn't open, write and close a file on the main thread for
+// every message. Lines are collected per file and written a few times a
+// second, or sooner when a lot of text is waiting.
+//
+// Anything that reads, lists, moves or deletes transcripts flushes first so it
+// sees every line that was logged.
+class FSChatLogWriter : public LLSingleton<FSChatLogWriter>
+{
+    LLSINGLETON(FSChatLogWriter);
+    ~FSChatLogWriter();
+
+public:
+    // Queues text for the end of the file at the given full path
+    void append(const std::string& filename, const std::string& text);
+
+    // Both write what was queued before returning, safe to call from any
+    // thread and do nothing when nothing was ever logged
+    static void flush(const std::string& filename);
+    static void flushAll();
+
+private:
+    typedef std::map<std::string, std::string> pending_map_t;
+
+    void writerLoop();
+    void write(const std::string& filename);
+    void writeAll();
+    static void writeFile(const std::string& filename, const std::string& text);
+
+    // Queued text per file
+    std::mutex              mPendingMutex;
+    std::condition_variable mPendingCondition;
+    pending_map_t           mPending;
+    size_t                  mPendingBytes;
+    bool                    mRunning;
+
+    // Held while writing so text queued for a file reaches it in order,
+    // whichever thread writes it
+    std::mutex              mWriteMutex;
+
+    std::thread             mWriter;
+};
+
+#endif // FS_FSCHATLOGWRITER_H
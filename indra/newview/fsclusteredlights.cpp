@@ -0,0 +1,302 @@
+/**
+ * @file fsclusteredlights.cpp
+ * @brief Clustered deferred lighting of local point lights
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsclusteredlights.h"
+
+#include "llglslshader.h"
+#include "llimagegl.h"
+#include "llrender.h"
+#include "llviewercontrol.h"
+#include "llviewershadermgr.h"
+
+#include <cmath>
+
+namespace
+{
+    // the offset and count of every cluster come first in the cluster texture
+    constexpr U32 CLUSTER_HEADER = FSClusteredLights::CLUSTER_COUNT * 2;
+    constexpr U32 MAX_INDICES = FSClusteredLights::CLUSTER_TEXTURE_WIDTH * FSClusteredLights::CLUSTER_TEXTURE_ROWS - CLUSTER_HEADER;
+
+    static_assert(FSClusteredLights::MAX_LIGHTS <= 65536, "light indices are kept in U16");
+    static_assert(FSClusteredLights::TILES_X <= 256 && FSClusteredLights::TILES_Y <= 256 && FSClusteredLights::SLICES <= 256,
+        "cluster coordinates are kept in U8");
+}
+
+FSClusteredLights::FSClusteredLights()
+:   mLightTexture(0),
+    mClusterTexture(0),
+    mNear(0.f),
+    mSliceScale(0.f)
+{
+}
+
+FSClusteredLights::~FSClusteredLights()
+{
+    // The light and cluster textures are deleted in release(), called
+    // from LLPipeline::releaseGLBuffers() and LLPipeline::cleanup() before
+    // the GL context goes away.
+}
+
+// static
+bool FSClusteredLights::isEnabled()
+{
+    static LLCachedControl<bool> clustered(gSavedSettings, "FSClusteredLighting", false);
+    return clustered && gDeferredClusteredLightProgram.isComplete();
+}
+
+void FSClusteredLights::clear()
+{
+    mLights.clear();
+}
+
+bool FSClusteredLights::add(const LLVector3& center, F32 size, const LLColor3& color, F32 falloff)
+{
+    if (mLights.size() >= MAX_LIGHTS)
+    {
+        return false;
+    }
+
+    mLights.push_back({ center, size, color, falloff });
+    return true;
+}
+
+bool FSClusteredLights::prepare(const glm::mat4& proj, F32 near_clip)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+
+    if (mLights.empty() || !allocate())
+    {
+        return false;
+    }
+
+    // Slices run from the near clip to the back of the farthest light
+    F32 far_depth = near_clip * 2.f;
+    for (const Light& light : mLights)
+    {
+        far_depth = llmax(far_depth, -light.mCenter.mV[VZ] + light.mSize);
+    }
+
+    mNear = llmax(near_clip, 0.01f);
+    mSliceScale = (F32)SLICES / logf(far_depth / mNear);
+    const F32 slice_depth_step = logf(far_depth / mNear) / (F32)SLICES;
+
+    // Screen position of x / depth, see the projection in get_current_projection()
+    const F32 scale_x = proj[0][0];
+    const F32 offset_x = -proj[2][0];
+    const F32 scale_y = proj[1][1];
+    const F32 offset_y = -proj[2][1];
+
+    auto tile = [](F32 ndc, U32 tiles) -> S32
+    {
+        return llclamp((S32)floorf((ndc * 0.5f + 0.5f) * (F32)tiles), 0, (S32)tiles - 1);
+    };
+
+    // The clusters of every light, the bounds of the light clamped to each
+    // slice it crosses and projected at both ends of the clamped depths
+    mRanges.clear();
+    for (U32 i = 0; i < (U32)mLights.size(); ++i)
+    {
+        const Light& light = mLights[i];
+        const F32 depth = -light.mCenter.mV[VZ];
+        const F32 r = light.mSize;
+
+        if (depth + r < mNear)
+        { // behind the near clip
+            continue;
+        }
+
+        const S32 first_slice = llclamp((S32)floorf(logf(llmax(depth - r, mNear) / mNear) * mSliceScale), 0, (S32)SLICES - 1);
+        const S32 last_slice = llclamp((S32)floorf(logf((depth + r) / mNear) * mSliceScale), 0, (S32)SLICES - 1);
+
+        for (S32 slice = first_slice; slice <= last_slice; ++slice)
+        {
+            const F32 slice_near = mNear * expf(slice_depth_step * (F32)slice);
+            const F32 slice_far = mNear * expf(slice_depth_step * (F32)(slice + 1));
+            const F32 d0 = llmax(slice_near, depth - r, mNear);
+            const F32 d1 = llmax(llmin(slice_far, depth + r), d0);
+
+            const F32 x0 = light.mCenter.mV[VX] - r;
+            const F32 x1 = light.mCenter.mV[VX] + r;
+            const F32 y0 = light.mCenter.mV[VY] - r;
+            const F32 y1 = light.mCenter.mV[VY] + r;
+
+            Range range;
+            range.mLight = (U16)i;
+            range.mSlice = (U8)slice;
+            range.mX0 = (U8)tile(llmin(x0 / d0, x0 / d1) * scale_x + offset_x, TILES_X);
+            range.mX1 = (U8)tile(llmax(x1 / d0, x1 / d1) * scale_x + offset_x, TILES_X);
+            range.mY0 = (U8)tile(llmin(y0 / d0, y0 / d1) * scale_y + offset_y, TILES_Y);
+            range.mY1 = (U8)tile(llmax(y1 / d0, y1 / d1) * scale_y + offset_y, TILES_Y);
+            mRanges.push_back(range);
+        }
+    }
+
+    // Count, lay the lists out one after the other, then fill them
+    mCounts.assign(CLUSTER_COUNT, 0);
+    for (const Range& range : mRanges)
+    {
+        for (U32 y = range.mY0; y <= range.mY1; ++y)
+        {
+            for (U32 x = range.mX0; x <= range.mX1; ++x)
+            {
+                ++mCounts[(range.mSlice * TILES_Y + y) * TILES_X + x];
+            }
+        }
+    }
+
+    mClusterData.assign(CLUSTER_TEXTURE_WIDTH * CLUSTER_TEXTURE_ROWS, 0.f);
+    U32 offset = 0;
+    for (U32 cluster = 0; cluster < CLUSTER_COUNT; ++cluster)
+    {
+        // a cluster that doesn't fit anymore loses lights rather than the frame
+        U32 count = llmin(mCounts[cluster], MAX_INDICES - offset);
+        mClusterData[cluster * 2] = (F32)(CLUSTER_HEADER + offset);
+        mClusterData[cluster * 2 + 1] = (F32)count;
+        mCounts[cluster] = offset;
+        offset += count;
+    }
+    const U32 used_texels = CLUSTER_HEADER + offset;
+
+    for (const Range& range : mRanges)
+    {
+        for (U32 y = range.mY0; y <= range.mY1; ++y)
+        {
+            for (U32 x = range.mX0; x <= range.mX1; ++x)
+            {
+                U32 cluster = (range.mSlice * TILES_Y + y) * TILES_X + x;
+                U32 end = (U32)mClusterData[cluster * 2] - CLUSTER_HEADER + (U32)mClusterData[cluster * 2 + 1];
+                if (mCounts[cluster] < end)
+                {
+                    mClusterData[CLUSTER_HEADER + mCounts[cluster]++] = (F32)range.mLight;
+                }
+            }
+        }
+    }
+
+    mLightData.assign(MAX_LIGHTS * 2 * 4, 0.f);
+    for (U32 i = 0; i < (U32)mLights.size(); ++i)
+    {
+        const Light& light = mLights[i];
+        F32* dst = &mLightData[i * 4];
+        dst[0] = light.mCenter.mV[VX];
+        dst[1] = light.mCenter.mV[VY];
+        dst[2] = light.mCenter.mV[VZ];
+        dst[3] = light.mSize;
+
+        dst = &mLightData[(MAX_LIGHTS + i) * 4];
+        dst[0] = light.mColor.mV[VRED];
+        dst[1] = light.mColor.mV[VGREEN];
+        dst[2] = light.mColor.mV[VBLUE];
+        dst[3] = light.mFalloff;
+    }
+
+    // only the rows that were written
+    gGL.getTexUnit(0)->bindManual(LLTexUnit::TT_TEXTURE, mClusterTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, CLUSTER_TEXTURE_WIDTH, (used_texels + CLUSTER_TEXTURE_WIDTH - 1) / CLUSTER_TEXTURE_WIDTH,
+        GL_RED, GL_FLOAT, mClusterData.data());
+
+    gGL.getTexUnit(0)->bindManual(LLTexUnit::TT_TEXTURE, mLightTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, MAX_LIGHTS, 2, GL_RGBA, GL_FLOAT, mLightData.data());
+    gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+
+    return true;
+}
+
+void FSClusteredLights::bind(LLGLSLShader& shader)
+{
+    static LLStaticHashedString cluster_near("cluster_near");
+    static LLStaticHashedString cluster_scale("cluster_scale");
+
+    S32 light_channel = shader.enableTexture(LLShaderMgr::DIFFUSE_MAP);
+    S32 cluster_channel = shader.enableTexture(LLShaderMgr::BUMP_MAP);
+    if (light_channel > -1)
+    {
+        gGL.getTexUnit(light_channel)->bindManual(LLTexUnit::TT_TEXTURE, mLightTexture);
+    }
+    if (cluster_channel > -1)
+    {
+        gGL.getTexUnit(cluster_channel)->bindManual(LLTexUnit::TT_TEXTURE, mClusterTexture);
+    }
+
+    shader.uniform1f(cluster_near, mNear);
+    shader.uniform1f(cluster_scale, mSliceScale);
+}
+
+void FSClusteredLights::unbind(LLGLSLShader& shader)
+{
+    shader.disableTexture(LLShaderMgr::DIFFUSE_MAP);
+    shader.disableTexture(LLShaderMgr::BUMP_MAP);
+}
+
+bool FSClusteredLights::allocate()
+{
+    if (mLightTexture && mClusterTexture)
+    {
+        return true;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+    release();
+
+    LLImageGL::generateTextures(1, &mLightTexture);
+    gGL.getTexUnit(0)->bindManual(LLTexUnit::TT_TEXTURE, mLightTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, MAX_LIGHTS, 2, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    LLImageGL::generateTextures(1, &mClusterTexture);
+    gGL.getTexUnit(0)->bindManual(LLTexUnit::TT_TEXTURE, mClusterTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, CLUSTER_TEXTURE_WIDTH, CLUSTER_TEXTURE_ROWS, 0, GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+
+    return mLightTexture && mClusterTexture;
+}
+
+void FSClusteredLights::release()
+{
+    if (mLightTexture)
+    {
+        LLImageGL::deleteTextures(1, &mLightTexture);
+        mLightTexture = 0;
+    }
+    if (mClusterTexture)
+    {
+        LLImageGL::deleteTextures(1, &mClusterTexture);
+        mClusterTexture = 0;
+    }
+
+    mLights.clear();
+    mRanges.clear();
+    mCounts.clear();
+    mLightData.clear();
+    mClusterData.clear();
+}
@@ -0,0 +1,129 @@
+/**
+ * @file fsclusteredlights.h
+ * @brief Clustered deferred lighting of local point lights
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+
+#ifndef FS_FSCLUSTEREDLIGHTS_H
+#define FS_FSCLUSTEREDLIGHTS_H
+
+#include "llgl.h"
+#include "v3color.h"
+#include "v3math.h"
+
+#include "glm/mat4x4.hpp"
+
+#include <vector>
+
+class LLGLSLShader;
+
+// Local point lights applied in one full screen pass instead of a box or a
+// batch of LL_DEFERRED_MULTI_LIGHT_COUNT lights per draw. The view frustum
+// is split in TILES_X x TILES_Y screen tiles and SLICES depth slices,
+// exponentially spaced from the near clip to the farthest light. Every light
+// is binned on the CPU into the clusters its bounds overlap and the pass
+// looks up the cluster of each pixel, evaluating only the lights listed in
+// it, see clusteredLightF.glsl.
+//
+// The lights are uploaded as two rows of an RGBA32F texture, the view space
+// center and size in the first, the color and falloff in the second. The
+// cluster lists are uploaded in an R32F texture, an offset and count per
+// cluster followed by the light indices of all clusters.
+//
+// Projectors keep their own passes.
+// Enabled with FSClusteredLighting.
+class FSClusteredLights
+{
+public:
+    static constexpr U32 TILES_X = 16;
+    static constexpr U32 TILES_Y = 9;
+    static constexpr U32 SLICES = 24;
+    static constexpr U32 CLUSTER_COUNT = TILES_X * TILES_Y * SLICES;
+    static constexpr U32 MAX_LIGHTS = 1024;
+
+    // Texels per row of the cluster texture, and rows
+    static constexpr U32 CLUSTER_TEXTURE_WIDTH = 2048;
+    static constexpr U32 CLUSTER_TEXTURE_ROWS = 128;
+
+    FSClusteredLights();
+    ~FSClusteredLights();
+
+    static bool isEnabled();
+
+    // Threads:  Tmain
+    // Start collecting the lights of a lighting pass
+    void clear();
+
+    // Threads:  Tmain
+    // Add a light at view space center of radius size. Returns false when
+    // there is no room left, the light must then be drawn the usual way.
+    bool add(const LLVector3& center, F32 size, const LLColor3& color, F32 falloff);
+
+    bool empty() const { return mLights.empty(); }
+
+    // Threads:  Tmain
+    // Bin the lights for the view with projection proj and near clip plane
+    // near_clip and upload them. Returns false when there is nothing to draw.
+    bool prepare(const glm::mat4& proj, F32 near_clip);
+
+    // Threads:  Tmain
+    // Bind the textures and uniforms of the prepared lights to shader, which
+    // must be bound
+    void bind(LLGLSLShader& shader);
+    void unbind(LLGLSLShader& shader);
+
+    void release();
+
+private:
+    struct Light
+    {
+        LLVector3   mCenter;    // view space
+        F32         mSize;
+        LLColor3    mColor;
+        F32         mFalloff;
+    };
+
+    struct Range
+    {
+        U16 mLight;
+        U8  mSlice;
+        U8  mX0, mX1;
+        U8  mY0, mY1;
+    };
+
+    bool allocate();
+
+    std::vector<Light>  mLights;
+    std::vector<Range>  mRanges;
+    std::vector<U32>    mCounts;        // per cluster
+    std::vector<F32>    mLightData;     // light texture contents
+    std::vector<F32>    mClusterData;   // cluster texture contents
+    GLuint              mLightTexture;
+    GLuint              mClusterTexture;
+    F32                 mNear;
+    F32                 mSliceScale;    // slices per log of depth over near
+};
+
+#endif // FS_FSCLUSTEREDLIGHTS_H
@@ -260,7 +260,7 @@ FSDiscordConnect::FSDiscordConnect()
     mConnectTime(0)
 {
     mMarkerFilename = gDirUtilp->getExpandedFilename(LL_PATH_USER_SETTINGS, "discord_in_use_marker");
-    LLEventPumps::instance().obtain("mainloop").listen("FSDiscordConnect", std::bind(&FSDiscordConnect::Tick, this, std::placeholders::_1));
+    mTickConnection = LLFrameTickPump::instance().listen("FSDiscordConnect", [this](const LLFrameTick& tick) { Tick(tick); });
 }
 
 FSDiscordConnect::~FSDiscordConnect()
@@ -288,12 +288,10 @@ void FSDiscordConnect::checkConnectionToDiscord(bool auto_connect)
         std::bind(&FSDiscordConnect::discordConnectedCoro, this, auto_connect));
 }
 
-bool FSDiscordConnect::Tick(const LLSD&)
+void FSDiscordConnect::Tick(const LLFrameTick&)
 {
     Discord_RunCallbacks();
     updateRichPresence();
-
-    return false;
 }
 
 void FSDiscordConnect::storeInfo(const LLSD& info)
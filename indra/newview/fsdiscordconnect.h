@@ -31,6 +31,7 @@
 #include "llsingleton.h"
 #include "llcoros.h"
 #include "lleventcoro.h"
+#include "llframepump.h"
 
 class LLEventPump;
 
@@ -65,7 +66,7 @@ public:
 
     void updateRichPresence() const;
 
-    bool Tick(const LLSD&);
+    void Tick(const LLFrameTick&);
 
 private:
 
@@ -87,6 +88,8 @@ private:
 
     std::string mMarkerFilename;
     time_t mConnectTime;
+
+    LLFrameTickPump::TempConnection mTickConnection;
 };
 
 #endif // FS_FSDISCORDCONNECT_H
@@ -0,0 +1,151 @@
+/**
+ * @file fsdynamicresolution.cpp
+ * @brief Render resolution scaled to hold a GPU frame time
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsdynamicresolution.h"
+
+#include "fsgpupasstimer.h"
+#include "llviewercontrol.h"
+
+namespace
+{
+    // Share of the frame budget the GPU time is held at
+    constexpr F32 BUDGET_USE = 0.9f;
+
+    // Weight of a new frame in the smoothed times
+    constexpr F32 SMOOTHING = 0.1f;
+}
+
+FSDynamicResolution::FSDynamicResolution()
+:   mLastFrameRead(0),
+    mFixedTime(0.f),
+    mScaledTime(0.f),
+    mScale(1.f),
+    mEnabled(false),
+    mHaveSample(false)
+{
+}
+
+bool FSDynamicResolution::update(FSGPUPassTimer& timer)
+{
+    static LLCachedControl<bool> enabled(gSavedSettings, "FSDynamicResolution", false);
+    static LLCachedControl<F32> target_fps(gSavedSettings, "FSDynamicResolutionTargetFPS", 60.f);
+    static LLCachedControl<F32> min_scale(gSavedSettings, "FSDynamicResolutionMin", 0.5f);
+
+    timer.setRequired(FSGPUPassTimer::USER_DYNAMIC_RESOLUTION, enabled);
+
+    if (!enabled)
+    {
+        mEnabled = false;
+        if (mScale < 1.f)
+        {
+            setScale(1.f);
+            return true;
+        }
+        return false;
+    }
+
+    if (!mEnabled)
+    {
+        mEnabled = true;
+        mHaveSample = false;
+        mSinceChange.reset();
+    }
+
+    if (timer.getFramesRead() == mLastFrameRead)
+    {
+        return false;
+    }
+    mLastFrameRead = timer.getFramesRead();
+
+    // Frames rendered at the last scale are still being read back
+    if (mSinceChange.getElapsedTimeF32() < DOWN_DELAY)
+    {
+        return false;
+    }
+
+    const F32 fixed = timer.getTime(FSGPUPassTimer::PASS_SHADOW)
+        + timer.getTime(FSGPUPassTimer::PASS_REFLECTION_PROBES)
+        + timer.getTime(FSGPUPassTimer::PASS_HERO_PROBES);
+    const F32 scaled = timer.getTime(FSGPUPassTimer::PASS_DEFERRED)
+        + timer.getTime(FSGPUPassTimer::PASS_LIGHTING)
+        + timer.getTime(FSGPUPassTimer::PASS_ALPHA)
+        + timer.getTime(FSGPUPassTimer::PASS_POST);
+
+    if (!mHaveSample)
+    {
+        mFixedTime = fixed;
+        mScaledTime = scaled;
+        mHaveSample = true;
+    }
+    else
+    {
+        mFixedTime = lerp(mFixedTime, fixed, SMOOTHING);
+        mScaledTime = lerp(mScaledTime, scaled, SMOOTHING);
+    }
+
+    const F32 lowest = llclamp((F32)min_scale, 0.25f, 1.f);
+    const F32 budget = 1000.f / llmax((F32)target_fps, 1.f);
+    const F32 available = budget * BUDGET_USE - mFixedTime;
+
+    // The scaled passes go with the pixel count, the square of the scale
+    F32 ideal = mScale;
+    if (mScaledTime > 0.f)
+    {
+        ideal = available > 0.f ? mScale * sqrtf(available / mScaledTime) : lowest;
+    }
+    ideal = llclamp(ideal, lowest, 1.f);
+
+    F32 scale = mScale;
+    if (ideal < mScale)
+    { // over budget, straight to the step that fits
+        scale = floorf(ideal / STEP) * STEP;
+    }
+    else if (ideal >= mScale + STEP && mSinceChange.getElapsedTimeF32() >= UP_DELAY)
+    { // one step at a time going up
+        scale = mScale + STEP;
+    }
+    scale = llclamp(scale, lowest, 1.f);
+
+    if (scale == mScale)
+    {
+        return false;
+    }
+
+    setScale(scale);
+    return true;
+}
+
+void FSDynamicResolution::setScale(F32 scale)
+{
+    mScale = scale;
+    mSinceChange.reset();
+
+    // The times of the new scale are another story
+    mHaveSample = false;
+}
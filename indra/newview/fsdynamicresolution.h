@@ -0,0 +1,79 @@
+/**
+ * @file fsdynamicresolution.h
+ * @brief Render resolution scaled to hold a GPU frame time
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSDYNAMICRESOLUTION_H
+#define FS_FSDYNAMICRESOLUTION_H
+
+#include "llframetimer.h"
+
+class FSGPUPassTimer;
+
+// Scales the resolution the world is rendered at so the GPU time of a frame
+// holds FSDynamicResolutionTargetFPS, within FSDynamicResolutionMin and 1.
+// The controller reads the pass times of FSGPUPassTimer, taking the shadow
+// and probe passes as fixed and the deferred, lighting, alpha and post
+// passes as growing with the pixel count, and picks the scale that puts the
+// frame at 90% of its budget. Scales go in steps of STEP, down as soon as
+// the frame is over budget, up only once the next step fits and no sooner
+// than UP_DELAY after the last change, so targets aren't reallocated over
+// and over around the budget.
+//
+// LLPipeline renders at the scale (see resizeScreenTexture()) and upscales
+// the result with CAS in renderFinalize(). Shadow maps keep their size.
+// Enabled with FSDynamicResolution.
+class FSDynamicResolution
+{
+public:
+    static constexpr F32 STEP = 0.0625f;
+    static constexpr F32 DOWN_DELAY = 0.5f;    // seconds
+    static constexpr F32 UP_DELAY = 2.f;
+
+    FSDynamicResolution();
+
+    // Threads:  Tmain
+    // Take the GPU times of the last frame read back by timer, once a frame.
+    // Returns true when the scale changed.
+    bool update(FSGPUPassTimer& timer);
+
+    bool isEnabled() const { return mEnabled; }
+
+    // Scale of the render resolution in both dimensions, 1 while disabled
+    F32 getScale() const { return mScale; }
+
+private:
+    void setScale(F32 scale);
+
+    LLFrameTimer    mSinceChange;
+    U32             mLastFrameRead;
+    F32             mFixedTime;     // milliseconds, smoothed
+    F32             mScaledTime;
+    F32             mScale;
+    bool            mEnabled;
+    bool            mHaveSample;
+};
+
+#endif // FS_FSDYNAMICRESOLUTION_H
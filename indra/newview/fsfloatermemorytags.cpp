@@ -0,0 +1,118 @@
+/**
+ * @file fsfloatermemorytags.cpp
+ * @brief Live view of the memory accounted to each subsystem
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsfloatermemorytags.h"
+
+#include "llmemory.h"
+#include "llscrolllistctrl.h"
+#include "lltextbox.h"
+
+namespace
+{
+    constexpr F32 REFRESH_INTERVAL = 1.f;
+
+    // Floater strings with the label of each tag
+    const char* TAG_LABELS[] =
+    {
+        "tag_textures",
+        "tag_mesh",
+        "tag_llsd",
+        "tag_ui",
+        "tag_inventory",
+        "tag_objects",
+        "tag_audio",
+        "tag_frame"
+    };
+    static_assert(LL_ARRAY_SIZE(TAG_LABELS) == (size_t)LLMemTag::COUNT, "TAG_LABELS out of sync with LLMemTag");
+
+    std::string format_mb(S64 bytes)
+    {
+        return llformat("%.1f", (F64)bytes / (1024.0 * 1024.0));
+    }
+}
+
+FSFloaterMemoryTags::FSFloaterMemoryTags(const LLSD& seed) :
+    LLFloater(seed),
+    mTagList(nullptr),
+    mSummaryText(nullptr)
+{
+}
+
+bool FSFloaterMemoryTags::postBuild()
+{
+    mTagList = getChild<LLScrollListCtrl>("tag_list");
+    mSummaryText = getChild<LLTextBox>("summary_text");
+    return true;
+}
+
+void FSFloaterMemoryTags::onOpen(const LLSD& key)
+{
+    refresh();
+}
+
+void FSFloaterMemoryTags::draw()
+{
+    if (mRefreshTimer.checkExpirationAndReset(REFRESH_INTERVAL))
+    {
+        refresh();
+    }
+    LLFloater::draw();
+}
+
+void FSFloaterMemoryTags::refresh()
+{
+    const S32 scroll_pos = mTagList->getScrollPos();
+    mTagList->clearRows();
+
+    S64 total = 0;
+    for (size_t i = 0; i < (size_t)LLMemTag::COUNT; ++i)
+    {
+        const LLMemTag tag = (LLMemTag)i;
+        const S64 bytes = LLMemAccounting::getBytes(tag);
+        total += bytes;
+
+        LLSD row;
+        row["columns"][0]["column"] = "tag";
+        row["columns"][0]["value"] = getString(TAG_LABELS[i]);
+        row["columns"][1]["column"] = "current";
+        row["columns"][1]["value"] = format_mb(bytes);
+        row["columns"][2]["column"] = "peak";
+        row["columns"][2]["value"] = format_mb(LLMemAccounting::getPeakBytes(tag));
+        row["columns"][3]["column"] = "allocations";
+        row["columns"][3]["value"] = llformat("%llu", (unsigned long long)LLMemAccounting::getAllocations(tag));
+        mTagList->addElement(row);
+    }
+    mTagList->setScrollPos(scroll_pos);
+
+    LLStringUtil::format_map_t args;
+    args["[TOTAL]"] = format_mb(total);
+    args["[RESIDENT]"] = format_mb((S64)LLMemory::getCurrentRSS());
+    args["[FRAME_PEAK]"] = llformat("%u", (U32)(LLFrameArena::getHighWater() / 1024));
+    mSummaryText->setText(getString("summary", args));
+}
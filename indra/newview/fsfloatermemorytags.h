@@ -0,0 +1,57 @@
+/**
+ * @file fsfloatermemorytags.h
+ * @brief Live view of the memory accounted to each subsystem
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FLOATERMEMORYTAGS_H
+#define FS_FLOATERMEMORYTAGS_H
+
+#include "llfloater.h"
+#include "llframetimer.h"
+
+class LLScrollListCtrl;
+class LLTextBox;
+
+// Lists the bytes LLMemAccounting has for each subsystem, with peak and
+// number of allocations, and how much of the resident set they explain.
+// Refreshes once a second while open.
+class FSFloaterMemoryTags : public LLFloater
+{
+public:
+    FSFloaterMemoryTags(const LLSD& seed);
+
+    bool postBuild() override;
+    void onOpen(const LLSD& key) override;
+    void draw() override;
+
+private:
+    void refresh() override;
+
+    LLScrollListCtrl*   mTagList;
+    LLTextBox*          mSummaryText;
+    LLFrameTimer        mRefreshTimer;
+};
+
+#endif // FS_FLOATERMEMORYTAGS_H
@@ -35,10 +35,38 @@
 #include "llcallbacklist.h"
 #include "llvoavatarself.h"
 #include "llagentcamera.h"
+#include "llviewerregion.h"
+#include "llvramaccounting.h"
 
 const F32 PROPERTIES_REQUEST_TIMEOUT = 10.0f;
 const F32 PROPERY_REQUEST_INTERVAL = 2.0f;
 const U32 PROPERTIES_MAX_REQUEST_COUNT = 250;
+const F32 CATEGORY_REFRESH_INTERVAL = 1.0f;
+
+static std::string getVRAMDetailName( LLVRAMCategory aCategory, U8 aDetail )
+{
+    static const char* textureNames[] = {
+        "None", "Avatar", "Avatar baked", "Terrain", "", "", "", "", "", "",
+        "High", "Sculpted", "Bump", "", "Selected", "Avatar baked self", "Avatar self", "Super high",
+        "HUD", "Icon", "Thumbnail", "UI", "Preview", "Map", "Map visible",
+        "Local", "Avatar scratch", "Dynamic", "Media", "Other"
+    };
+    static_assert( LL_ARRAY_SIZE( textureNames ) == LLViewerTexture::MAX_GL_IMAGE_CATEGORY, "textureNames out of sync with the boost levels" );
+
+    static const char* partitionNames[] = {
+        "HUD", "Terrain", "Void water", "Water", "Tree", "Particle", "Grass", "Volume",
+        "Bridge", "Avatar", "Animesh", "HUD particle", "Object cache"
+    };
+    static_assert( LL_ARRAY_SIZE( partitionNames ) == LLViewerRegion::NUM_PARTITIONS, "partitionNames out of sync with the partitions" );
+
+    if( aCategory == LLVRAMCategory::TEXTURE && aDetail < LL_ARRAY_SIZE( textureNames ) )
+        return textureNames[ aDetail ];
+    if( aCategory == LLVRAMCategory::VERTEX_BUFFER && aDetail < LL_ARRAY_SIZE( partitionNames ) )
+        return partitionNames[ aDetail ];
+    if( aDetail )
+        return llformat( "%u", (U32)aDetail );
+    return std::string();
+}
 
 static void onIdle( void *aData )
 {
@@ -55,6 +83,8 @@ struct ObjectStat
 struct FSFloaterVRAMUsage::ImplData
 {
     LLScrollListCtrl *mList;
+    LLScrollListCtrl *mCategoryList;
+    LLFrameTimer mCategoryTimer;
     LLObjectSelectionHandle mSelection;
     U32 mPending;
     LLFrameTimer mPropTimer;
@@ -72,6 +102,7 @@ FSFloaterVRAMUsage::FSFloaterVRAMUsage(const LLSD& seed)
 {
     mData = new ImplData();
     mData->mList = 0;
+    mData->mCategoryList = 0;
     mData->mPending = 0;
 
     gIdleCallbacks.addFunction( &::onIdle, this) ;
@@ -95,6 +126,8 @@ bool FSFloaterVRAMUsage::postBuild()
     pRefresh->setClickedCallback( boost::bind( &FSFloaterVRAMUsage::doRefresh, this ) );
 
     mData->mList = getChild< LLScrollListCtrl >( "result_list" );
+    mData->mCategoryList = getChild< LLScrollListCtrl >( "category_list" );
+    refreshCategories();
 
     LLSelectMgr::instance().registerPropertyListener( this );
     LLSelectMgr::instance().enableSilhouette( false );
@@ -104,6 +137,9 @@ bool FSFloaterVRAMUsage::postBuild()
 
 void FSFloaterVRAMUsage::onIdle()
 {
+    if( mData->mCategoryList && mData->mCategoryTimer.getElapsedTimeF32() >= CATEGORY_REFRESH_INTERVAL )
+        refreshCategories();
+
     if( !mData->mPending && mData->mObjects.empty() )
     {
         LLSelectMgr::instance().deselectAll();
@@ -183,7 +219,16 @@ U32 FSFloaterVRAMUsage::calcTexturSize( LLViewerObject *aObject, std::ostream *a
 
         stTextures[ pTex->getID() ] = textureId;
 
-        S32 texSize = pTex->getFullWidth() * pTex->getFullHeight() * pTex->getComponents();
+        S64 texSize = pTex->getFullWidth() * pTex->getFullHeight() * pTex->getComponents();
+        LLImageGL *pGLImage = pTex->getGLTexture();
+        if( pGLImage && pGLImage->getInternalFormat() )
+        {
+            // Account for the format actually uploaded, textures may be compressed
+            S32 format = pGLImage->getInternalFormat();
+            if( LLImageGL::sCompressTextures && pGLImage->getAllowCompression() )
+                format = LLImageGL::getCompressedFormat( format );
+            texSize = LLImageGL::dataFormatBytes( format, pTex->getFullWidth(), pTex->getFullHeight() );
+        }
         if( pTex->getUseMipMaps() )
             texSize += (texSize*33)/100;
 
@@ -194,8 +239,41 @@ U32 FSFloaterVRAMUsage::calcTexturSize( LLViewerObject *aObject, std::ostream *a
     return static_cast< U32 >( totalTexSize );
 }
 
+void FSFloaterVRAMUsage::refreshCategories()
+{
+    mData->mCategoryTimer.reset();
+
+    // Keep the scroll position, the list is rebuilt every second
+    S32 scrollPos = mData->mCategoryList->getScrollPos();
+    mData->mCategoryList->deleteAllItems();
+
+    for( size_t category = 0; category < (size_t)LLVRAMCategory::COUNT; ++category )
+    {
+        for( U8 detail = 0; detail < LLVRAMAccounting::MAX_DETAIL; ++detail )
+        {
+            for( size_t owner = 0; owner < (size_t)LLVRAMOwner::COUNT; ++owner )
+            {
+                S64 bytes = LLVRAMAccounting::getBytes( (LLVRAMCategory)category, detail, (LLVRAMOwner)owner );
+                if( bytes <= 0 )
+                    continue;
+
+                LLScrollListItem::Params item;
+                item.columns.add().column("category").value( LLVRAMAccounting::getName( (LLVRAMCategory)category ) );
+                item.columns.add().column("detail").value( getVRAMDetailName( (LLVRAMCategory)category, detail ) );
+                item.columns.add().column("owner").value( LLVRAMAccounting::getName( (LLVRAMOwner)owner ) );
+                item.columns.add().column("size").value( (S32)( bytes / 1024 ) );
+                mData->mCategoryList->addRow( item );
+            }
+        }
+    }
+
+    mData->mCategoryList->sortByColumn( "size", false );
+    mData->mCategoryList->setScrollPos( scrollPos );
+}
+
 void FSFloaterVRAMUsage::doRefresh()
 {
+    refreshCategories();
     mData->mList->deleteAllItems();
     S32 numObjects = gObjectList.getNumObjects();
 
@@ -48,6 +48,7 @@ public:
 
 private:
     void doRefresh();
+    void refreshCategories();
 
     void addObjectToList( LLViewerObject*, std::string const& );
     void calcFaceSize( LLFace *aFace, S32 &aW, S32 &aH );
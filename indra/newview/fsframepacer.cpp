@@ -0,0 +1,217 @@
+/**
+ * @file fsframepacer.cpp
+ * @brief Paces frames against the frame rate limit and the display refresh
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsframepacer.h"
+
+#include "llviewercontrol.h"
+#include "llviewerwindow.h"
+#include "llwindow.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace
+{
+    // Prediction is the cost this share of recent frames stayed below
+    constexpr F32 COST_PERCENTILE = 0.9f;
+    // ms_sleep() may oversleep by up to a scheduler tick, the end of a wait
+    // yields instead
+    constexpr F64 SPIN_SECONDS = 0.002;
+    constexpr F32 STATS_INTERVAL = 10.f;
+
+    void sleep_until(F64 until)
+    {
+        F64 now = LLTimer::getTotalSeconds();
+        while (now < until)
+        {
+            const U32 ms = (U32)((until - now - SPIN_SECONDS) * 1000.0);
+            if (until - now > SPIN_SECONDS && ms > 0)
+            {
+                ms_sleep(ms);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+            now = LLTimer::getTotalSeconds();
+        }
+    }
+}
+
+FSFramePacer::FSFramePacer() :
+    mCostCount(0),
+    mCostPos(0),
+    mPredictedCost(0.f),
+    mFrameStart(0.0),
+    mInputTime(0.0),
+    mSwapBeginTime(0.0),
+    mDeadline(0.0),
+    mLatency(0.f),
+    mMissed(0)
+{
+    std::fill(std::begin(mCosts), std::end(mCosts), 0.f);
+    mStatsTimer.reset();
+}
+
+void FSFramePacer::markInput()
+{
+    mInputTime = LLTimer::getTotalSeconds();
+}
+
+void FSFramePacer::markSwapBegin()
+{
+    mSwapBeginTime = LLTimer::getTotalSeconds();
+}
+
+void FSFramePacer::markPresent()
+{
+    const F64 now = LLTimer::getTotalSeconds();
+    if (mFrameStart > 0.0 && mSwapBeginTime > mFrameStart)
+    {
+        mCosts[mCostPos] = (F32)(mSwapBeginTime - mFrameStart);
+        mCostPos = (mCostPos + 1) % COST_HISTORY;
+        mCostCount = llmin(mCostCount + 1, COST_HISTORY);
+    }
+
+    if (mInputTime > 0.0)
+    {
+        mLatency = (F32)(now - mInputTime);
+        mLatencies.push_back(mLatency);
+        LL_PROFILE_PLOT("Input latency ms", (F64)mLatency * 1000.0);
+    }
+
+    if (mDeadline > 0.0 && now > mDeadline)
+    {
+        // Late, or vsync held the swap to the next vblank. Either way the
+        // cadence continues from here instead of catching up.
+        if (now - mDeadline > 0.001)
+        {
+            ++mMissed;
+        }
+        mDeadline = now;
+    }
+
+    if (mStatsTimer.getElapsedTimeF32() >= STATS_INTERVAL)
+    {
+        logStats();
+    }
+}
+
+F32 FSFramePacer::wait(F32 frame_interval)
+{
+    const F64 interval = getInterval(frame_interval);
+    F64 now = LLTimer::getTotalSeconds();
+    if (interval <= 0.0)
+    {
+        mDeadline = 0.0;
+        mFrameStart = now;
+        return 0.f;
+    }
+
+    static LLCachedControl<F32> margin_ms(gSavedSettings, "FSFramePacingMargin");
+    const F64 lead = (F64)predictCost() + llclamp((F64)margin_ms, 0.0, 20.0) * 0.001;
+
+    F64 deadline = (mDeadline > 0.0) ? mDeadline + interval : now + interval;
+    if (deadline - lead < now)
+    {
+        // Can't make it, present as soon as the frame is done
+        deadline = now + lead;
+    }
+    mDeadline = deadline;
+
+    const F64 start = deadline - lead;
+    F32 slept = 0.f;
+    if (start > now)
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_APP("FramePacer wait");
+        sleep_until(start);
+        slept = (F32)(start - now);
+        now = LLTimer::getTotalSeconds();
+    }
+    mFrameStart = now;
+    return slept;
+}
+
+F64 FSFramePacer::getInterval(F32 frame_interval) const
+{
+    F64 interval = llmax((F64)frame_interval, 0.0);
+
+    static LLCachedControl<bool> vsync(gSavedSettings, "RenderVSyncEnable");
+    if (vsync && gViewerWindow && gViewerWindow->getWindow())
+    {
+        const S32 refresh_rate = gViewerWindow->getWindow()->getRefreshRate();
+        if (refresh_rate > 0)
+        {
+            interval = llmax(interval, 1.0 / (F64)refresh_rate);
+        }
+    }
+    return interval;
+}
+
+F32 FSFramePacer::predictCost()
+{
+    if (mCostCount == 0)
+    {
+        mPredictedCost = 0.f;
+        return mPredictedCost;
+    }
+
+    F32 costs[COST_HISTORY];
+    std::copy(mCosts, mCosts + mCostCount, costs);
+    const U32 nth = llmin((U32)(mCostCount * COST_PERCENTILE), mCostCount - 1);
+    std::nth_element(costs, costs + nth, costs + mCostCount);
+    mPredictedCost = costs[nth];
+    LL_PROFILE_PLOT("Predicted frame cost ms", (F64)mPredictedCost * 1000.0);
+    return mPredictedCost;
+}
+
+void FSFramePacer::logStats()
+{
+    if (!mLatencies.empty())
+    {
+        F32 total = 0.f;
+        for (F32 latency : mLatencies)
+        {
+            total += latency;
+        }
+        const size_t p95 = llmin((size_t)(mLatencies.size() * 0.95f), mLatencies.size() - 1);
+        std::nth_element(mLatencies.begin(), mLatencies.begin() + p95, mLatencies.end());
+        const F32 latency_p95 = mLatencies[p95];
+        const F32 latency_max = *std::max_element(mLatencies.begin() + p95, mLatencies.end());
+
+        LL_INFOS("FramePacer") << "Input to present latency over " << mLatencies.size() << " frames: mean "
+                               << total / (F32)mLatencies.size() * 1000.f << " ms, 95th percentile " << latency_p95 * 1000.f
+                               << " ms, max " << latency_max * 1000.f << " ms. Predicted frame cost "
+                               << mPredictedCost * 1000.f << " ms, " << mMissed << " missed deadlines" << LL_ENDL;
+    }
+
+    mLatencies.clear();
+    mMissed = 0;
+    mStatsTimer.reset();
+}
@@ -0,0 +1,103 @@
+/**
+ * @file fsframepacer.h
+ * @brief Paces frames against the frame rate limit and the display refresh
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSFRAMEPACER_H
+#define FS_FSFRAMEPACER_H
+
+#include "llframetimer.h"
+#include "llsingleton.h"
+
+#include <vector>
+
+// Decides when the main loop starts the next frame.
+//
+// The old limiter slept whatever was left of 1 / FramePerSecondLimit after
+// a frame, rounded down to whole milliseconds. Frames started whenever the
+// sleep happened to end, so the time between input sampling and the frame
+// being shown wandered from frame to frame and the camera, which moves by
+// the measured frame time, stuttered at capped frame rates.
+//
+// The pacer keeps a present deadline that advances by one frame interval
+// each frame: the FPS limit, or with vsync the display refresh if that is
+// longer. It predicts how long a frame takes from input sampling to the
+// swap, from a high percentile of recent frames, and sleeps until just that
+// long plus a safety margin before the deadline. Input is gathered right
+// after, so it is as fresh as it can be when the frame is shown, and frames
+// start on an even cadence. A frame that presents late moves the deadline
+// with it; with vsync that locks the deadlines to the actual vblanks.
+//
+// Latency from input sampling to the swap returning is measured every
+// frame and reported under the FramePacer log tag and as profiler plots.
+// The swap returning is the closest the viewer gets to the photons, there
+// is no portable way to learn when the display scanned the image out.
+class FSFramePacer : public LLSingleton<FSFramePacer>
+{
+    LLSINGLETON(FSFramePacer);
+
+public:
+    // Threads:  Tmain
+    // After the frame gathered its input
+    void markInput();
+    // Before and after swapping buffers
+    void markSwapBegin();
+    void markPresent();
+
+    // Threads:  Tmain
+    // Sleeps until the next frame should start. frame_interval is the
+    // seconds per frame of the frame rate limit, 0 for none. Returns the
+    // seconds slept.
+    F32 wait(F32 frame_interval);
+
+    // Seconds, of the last presented frame
+    F32 getLatency() const { return mLatency; }
+    F32 getPredictedCost() const { return mPredictedCost; }
+
+private:
+    F64 getInterval(F32 frame_interval) const;
+    F32 predictCost();
+    void logStats();
+
+    static constexpr U32 COST_HISTORY = 64;
+
+    F32                 mCosts[COST_HISTORY];   // seconds from frame start to the swap
+    U32                 mCostCount;
+    U32                 mCostPos;
+    F32                 mPredictedCost;
+
+    F64                 mFrameStart;
+    F64                 mInputTime;
+    F64                 mSwapBeginTime;
+    F64                 mDeadline;              // 0 while not pacing
+    F32                 mLatency;
+
+    // Reporting period
+    std::vector<F32>    mLatencies;
+    U32                 mMissed;
+    LLFrameTimer        mStatsTimer;
+};
+
+#endif // FS_FSFRAMEPACER_H
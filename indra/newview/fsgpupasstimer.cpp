@@ -0,0 +1,223 @@
+/**
+ * @file fsgpupasstimer.cpp
+ * @brief GPU time of the major render passes
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsgpupasstimer.h"
+
+#include "lltrace.h"
+#include "llviewercontrol.h"
+
+extern bool gCubeSnapshot;
+
+namespace
+{
+    // Shown in the GPU Passes section of the Statistics floater
+    LLTrace::SampleStatHandle<F64Milliseconds> sPassStats[FSGPUPassTimer::PASS_COUNT] =
+    {
+        { "gpushadowpass", "GPU time of the sun shadow maps" },
+        { "gpudeferredpass", "GPU time of the deferred geometry" },
+        { "gpulightingpass", "GPU time of the deferred lighting" },
+        { "gpualphapass", "GPU time of the alpha and post deferred geometry" },
+        { "gpupostpass", "GPU time of post processing" },
+        { "gpureflectionprobepass", "GPU time of the reflection probe updates" },
+        { "gpuheroprobepass", "GPU time of the hero probe updates" }
+    };
+
+    const char* sPassNames[FSGPUPassTimer::PASS_COUNT] =
+    {
+        "Shadow",
+        "Deferred",
+        "Lighting",
+        "Alpha",
+        "Post",
+        "Probes",
+        "Hero probes"
+    };
+}
+
+FSGPUPassTimer::FSGPUPassTimer()
+:   mCurrentFrame(0),
+    mFramesRead(0),
+    mEnabled(false),
+    mRequired(0)
+{
+    for (U32 i = 0; i < PASS_COUNT; ++i)
+    {
+        mOpen[i] = -1;
+        mTime[i] = 0.f;
+    }
+}
+
+FSGPUPassTimer::~FSGPUPassTimer()
+{
+    // The timer queries of every frame are deleted in release(), called
+    // from LLPipeline::releaseScreenBuffers() and LLPipeline::cleanup();
+    // gPipeline is only destroyed after the GL context is gone.
+}
+
+// static
+const char* FSGPUPassTimer::getPassName(EPass pass)
+{
+    return sPassNames[pass];
+}
+
+void FSGPUPassTimer::newFrame()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_DISPLAY;
+
+    static LLCachedControl<bool> timers(gSavedSettings, "FSGPUPassTimers", false);
+    const bool enabled = timers || mRequired != 0;
+
+    if (mEnabled)
+    {
+        Frame& frame = mFrames[mCurrentFrame];
+        for (U32 i = 0; i < PASS_COUNT; ++i)
+        {
+            if (mOpen[i] >= 0)
+            { // never ended, drop everything from it on rather than read a query that was never placed
+                frame.mPasses.resize(llmin(frame.mPasses.size(), (size_t)mOpen[i]));
+                mOpen[i] = -1;
+            }
+        }
+        frame.mPending = !frame.mPasses.empty();
+    }
+
+    // Oldest first, so the stats get the frames in order
+    for (U32 i = 1; i <= FRAME_COUNT; ++i)
+    {
+        read(mFrames[(mCurrentFrame + i) % FRAME_COUNT]);
+    }
+
+    mCurrentFrame = (mCurrentFrame + 1) % FRAME_COUNT;
+    Frame& frame = mFrames[mCurrentFrame];
+
+    // When the GPU is that far behind the frame is skipped, nothing ever waits on a query
+    mEnabled = enabled && !frame.mPending;
+    frame.mPasses.clear();
+
+    if (!enabled)
+    {
+        for (U32 i = 0; i < PASS_COUNT; ++i)
+        {
+            mTime[i] = 0.f;
+        }
+    }
+}
+
+void FSGPUPassTimer::begin(EPass pass)
+{
+    if (!mEnabled || mOpen[pass] >= 0 || (gCubeSnapshot && pass < PASS_REFLECTION_PROBES))
+    {
+        return;
+    }
+
+    Frame& frame = mFrames[mCurrentFrame];
+    U32 interval = (U32)frame.mPasses.size();
+    if (frame.mQueries.size() < (interval + 1) * 2)
+    {
+        frame.mQueries.resize((interval + 1) * 2);
+        glGenQueries(2, &frame.mQueries[interval * 2]);
+    }
+
+    glQueryCounter(frame.mQueries[interval * 2], GL_TIMESTAMP);
+    frame.mLast = frame.mQueries[interval * 2];
+    frame.mPasses.push_back(pass);
+    mOpen[pass] = (S32)interval;
+}
+
+void FSGPUPassTimer::end(EPass pass)
+{
+    if (!mEnabled || mOpen[pass] < 0 || (gCubeSnapshot && pass < PASS_REFLECTION_PROBES))
+    {
+        return;
+    }
+
+    Frame& frame = mFrames[mCurrentFrame];
+    glQueryCounter(frame.mQueries[mOpen[pass] * 2 + 1], GL_TIMESTAMP);
+    frame.mLast = frame.mQueries[mOpen[pass] * 2 + 1];
+    mOpen[pass] = -1;
+}
+
+void FSGPUPassTimer::read(Frame& frame)
+{
+    if (!frame.mPending)
+    {
+        return;
+    }
+
+    // Timestamps are written in order, the last one placed being there means all of them are
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(frame.mLast, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available != GL_TRUE)
+    {
+        return;
+    }
+
+    F64 time[PASS_COUNT] = { 0.0 };
+    for (U32 i = 0; i < (U32)frame.mPasses.size(); ++i)
+    {
+        GLuint64 begin = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(frame.mQueries[i * 2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.mQueries[i * 2 + 1], GL_QUERY_RESULT, &end);
+        if (end > begin)
+        {
+            time[frame.mPasses[i]] += (end - begin) / 1000000.0;
+        }
+    }
+
+    // Passes that didn't run this frame took no time
+    for (U32 i = 0; i < PASS_COUNT; ++i)
+    {
+        mTime[i] = (F32)time[i];
+        sample(sPassStats[i], F64Milliseconds(time[i]));
+    }
+
+    frame.mPending = false;
+    ++mFramesRead;
+}
+
+void FSGPUPassTimer::release()
+{
+    for (Frame& frame : mFrames)
+    {
+        if (!frame.mQueries.empty())
+        {
+            glDeleteQueries((GLsizei)frame.mQueries.size(), frame.mQueries.data());
+        }
+        frame = Frame();
+    }
+
+    for (U32 i = 0; i < PASS_COUNT; ++i)
+    {
+        mOpen[i] = -1;
+        mTime[i] = 0.f;
+    }
+    mCurrentFrame = 0;
+    mEnabled = false;
+}
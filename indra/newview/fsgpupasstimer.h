@@ -0,0 +1,131 @@
+/**
+ * @file fsgpupasstimer.h
+ * @brief GPU time of the major render passes
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSGPUPASSTIMER_H
+#define FS_FSGPUPASSTIMER_H
+
+#include "llgl.h"
+#include "llprofiler.h"
+
+#include <vector>
+
+// GPU time of the major passes of the world camera, for GPU bound users
+// who get nothing out of the fast timers. Every pass drops a GL timestamp
+// query at its start and end, the queries of a frame are read back once the
+// last of them is available, some frames later, so nothing ever waits on
+// the GPU. Results go to the LLTrace stats shown in the Statistics floater
+// and the fast timer view.
+//
+// Passes run for the cube snapshots of the reflection and hero probes only
+// count toward the probe passes. Different passes may nest, each is timed
+// from its own start to its own end, a pass doesn't nest in itself.
+// Enabled with FSGPUPassTimers, or by whoever needs the times.
+class FSGPUPassTimer
+{
+public:
+    enum EPass : U32
+    {
+        PASS_SHADOW = 0,
+        PASS_DEFERRED,
+        PASS_LIGHTING,
+        PASS_ALPHA,
+        PASS_POST,
+        PASS_REFLECTION_PROBES,
+        PASS_HERO_PROBES,
+        PASS_COUNT
+    };
+
+    // Whoever needs the times with FSGPUPassTimers off
+    enum EUser : U32
+    {
+        USER_DYNAMIC_RESOLUTION = 1 << 0,
+        USER_MIRROR_BUDGET      = 1 << 1
+    };
+
+    FSGPUPassTimer();
+    ~FSGPUPassTimer();
+
+    // Threads:  Tmain
+    // Close the frame being timed and read back every finished one
+    void newFrame();
+
+    // Threads:  Tmain
+    void begin(EPass pass);
+    void end(EPass pass);
+
+    // Last GPU time of the pass in milliseconds, 0 while disabled
+    F32 getTime(EPass pass) const { return mTime[pass]; }
+
+    // Frames read back so far, tells whether getTime() has news
+    U32 getFramesRead() const { return mFramesRead; }
+
+    // Time the passes even with FSGPUPassTimers off, for as long as any user requires it
+    void setRequired(EUser user, bool required) { mRequired = required ? (mRequired | user) : (mRequired & ~user); }
+
+    static const char* getPassName(EPass pass);
+
+    void release();
+
+    class Scope
+    {
+    public:
+        Scope(FSGPUPassTimer& timer, EPass pass) : mTimer(timer), mPass(pass) { mTimer.begin(mPass); }
+        ~Scope() { mTimer.end(mPass); }
+
+    private:
+        FSGPUPassTimer& mTimer;
+        EPass           mPass;
+    };
+
+private:
+    struct Frame
+    {
+        std::vector<GLuint> mQueries;   // begin and end of every interval, grown on demand
+        std::vector<U32>    mPasses;    // pass of every interval
+        GLuint              mLast = 0;  // query placed last
+        bool                mPending = false;
+    };
+
+    static constexpr U32 FRAME_COUNT = 4;
+
+    void read(Frame& frame);
+
+    Frame   mFrames[FRAME_COUNT];
+    U32     mCurrentFrame;
+    S32     mOpen[PASS_COUNT];      // interval of the pass open in the current frame, -1 for none
+    F32     mTime[PASS_COUNT];
+    U32     mFramesRead;
+    bool    mEnabled;               // the current frame is being timed
+    U32     mRequired;              // EUser bits
+};
+
+// Tracy GPU zone and pass timer for the rest of the enclosing scope
+#define FS_GPU_PASS_TIMER(timer, pass, name) \
+    LL_PROFILE_GPU_ZONE(name) \
+    FSGPUPassTimer::Scope fs_gpu_pass_scope(timer, pass)
+
+#endif // FS_FSGPUPASSTIMER_H
@@ -0,0 +1,587 @@
+/**
+ * @file fsgputerrain.cpp
+ * @brief Terrain drawn from full resolution region meshes
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsgputerrain.h"
+
+#include "lldrawpool.h"
+#include "lldrawpoolterrain.h"
+#include "llface.h"
+#include "llsurface.h"
+#include "llsurfacepatch.h"
+#include "llviewerregion.h"
+#include "llvolume.h"
+#include "llvosurfacepatch.h"
+
+#include <algorithm>
+
+bool FSGPUTerrain::sEnabled = false;
+
+namespace
+{
+    enum
+    {
+        EDGE_SOUTH = 0,
+        EDGE_EAST,
+        EDGE_NORTH,
+        EDGE_WEST,
+        EDGE_COUNT
+    };
+
+    // Neighbor patch across each edge
+    const U32 EDGE_DIRECTION[EDGE_COUNT] = { SOUTH, EAST, NORTH, WEST };
+
+    // Grid x, y of the point t along edge and depth into the patch
+    void edge_point(U32 edge, U32 width, U32 t, U32 depth, U32& x, U32& y)
+    {
+        switch (edge)
+        {
+            case EDGE_SOUTH: x = t;             y = depth;          break;
+            case EDGE_EAST:  x = width - depth; y = t;              break;
+            case EDGE_NORTH: x = t;             y = width - depth;  break;
+            default:         x = depth;         y = t;              break;
+        }
+    }
+
+    // Height at grid x, y of patch, up to one grid into its neighbors
+    F32 get_height(const LLSurfacePatch* patch, S32 x, S32 y)
+    {
+        const S32 width = (S32)patch->getSurface()->getGridsPerPatchEdge();
+
+        if (x < 0 || x > width)
+        {
+            const LLSurfacePatch* neighbor = patch->getNeighborPatch(x < 0 ? WEST : EAST);
+            if (neighbor && neighbor->getDataZ())
+            {
+                patch = neighbor;
+                x += x < 0 ? width : -width;
+            }
+            else
+            {
+                x = llclamp(x, 0, width);
+            }
+        }
+
+        if (y < 0 || y > width)
+        {
+            const LLSurfacePatch* neighbor = patch->getNeighborPatch(y < 0 ? SOUTH : NORTH);
+            if (neighbor && neighbor->getDataZ())
+            {
+                patch = neighbor;
+                y += y < 0 ? width : -width;
+            }
+            else
+            {
+                y = llclamp(y, 0, width);
+            }
+        }
+
+        return *(patch->getDataZ() + x + y * patch->getSurface()->getGridsPerEdge());
+    }
+
+    U32 stride_level(U32 stride, U32 levels)
+    {
+        U32 level = 0;
+        while (level + 1 < levels && (1U << (level + 1)) <= stride)
+        {
+            ++level;
+        }
+        return level;
+    }
+}
+
+FSGPUTerrain::FSGPUTerrain()
+{
+}
+
+FSGPUTerrain::~FSGPUTerrain()
+{
+    // The region vertex buffers are dropped in release(), called from
+    // LLPipeline::releaseGLBuffers() and LLPipeline::cleanup(); the
+    // LLPointers are already empty by the time this runs.
+}
+
+// static
+bool FSGPUTerrain::isEnabled()
+{
+    // glMultiDrawElementsBaseVertex
+    return sEnabled && gGLManager.mGLVersion >= 3.19f;
+}
+
+void FSGPUTerrain::render(const std::vector<LLFace*>& faces)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_DRAWPOOL;
+
+    mPatches.clear();
+    for (LLFace* facep : faces)
+    {
+        LLVOSurfacePatch* vobj = (LLVOSurfacePatch*)facep->getViewerObject();
+        LLSurfacePatch* patch = vobj ? vobj->getPatch() : nullptr;
+        if (patch && patch->getSurface() && patch->getSurface()->getRegion() && patch->getDataZ())
+        {
+            mPatches.emplace_back(patch->getSurface(), patch);
+        }
+    }
+
+    // a region at a time
+    std::stable_sort(mPatches.begin(), mPatches.end(),
+        [](const std::pair<const LLSurface*, const LLSurfacePatch*>& a, const std::pair<const LLSurface*, const LLSurfacePatch*>& b)
+        {
+            return a.first < b.first;
+        });
+
+    size_t start = 0;
+    while (start < mPatches.size())
+    {
+        const LLSurface* surface = mPatches[start].first;
+        size_t end = start;
+        while (end < mPatches.size() && mPatches[end].first == surface)
+        {
+            ++end;
+        }
+
+        std::unique_ptr<Surface>& entry = mSurfaces[surface];
+        if (!entry)
+        {
+            entry.reset(new Surface());
+            if (!initSurface(*entry, surface))
+            {
+                entry->mChunks.clear();
+            }
+        }
+
+        Surface& mesh = *entry;
+        if (!mesh.mChunks.empty())
+        {
+            for (size_t i = start; i < end; ++i)
+            {
+                const LLSurfacePatch* patch = mPatches[i].second;
+                U32 x, y, block;
+                Chunk* chunk = getPatchCoords(patch, surface, x, y) ? getChunk(mesh, x, y, block) : nullptr;
+                if (!chunk)
+                {
+                    continue;
+                }
+
+                if (chunk->mDirty[block])
+                {
+                    fillBlock(mesh, *chunk, patch, block);
+                }
+
+                drawPatch(mesh, *chunk, patch, block);
+            }
+
+            LLRenderPass::applyModelMatrix(&surface->getRegion()->mRenderMatrix);
+
+            for (Chunk& chunk : mesh.mChunks)
+            {
+                if (chunk.mCounts.empty())
+                {
+                    continue;
+                }
+
+                if (chunk.mMapped)
+                {
+                    chunk.mBuffer->unmapBuffer();
+                    chunk.mMapped = false;
+                }
+
+                chunk.mBuffer->setBuffer();
+                chunk.mBuffer->drawRangesBaseVertex(LLRender::TRIANGLES, chunk.mCounts.data(), chunk.mOffsets.data(),
+                    chunk.mBaseVertices.data(), (U32)chunk.mCounts.size());
+
+                chunk.mCounts.clear();
+                chunk.mOffsets.clear();
+                chunk.mBaseVertices.clear();
+            }
+        }
+
+        start = end;
+    }
+
+    mPatches.clear();
+}
+
+void FSGPUTerrain::dirtyPatch(const LLSurfacePatch* patch)
+{
+    if (!patch || mSurfaces.empty())
+    {
+        return;
+    }
+
+    // the normals along the edges of the neighbors depend on the heights of patch
+    markDirty(patch);
+    for (U32 edge = 0; edge < EDGE_COUNT; ++edge)
+    {
+        markDirty(patch->getNeighborPatch(EDGE_DIRECTION[edge]));
+    }
+}
+
+void FSGPUTerrain::removeSurface(const LLSurface* surface)
+{
+    mSurfaces.erase(surface);
+}
+
+void FSGPUTerrain::release()
+{
+    mSurfaces.clear();
+    mPatches.clear();
+}
+
+bool FSGPUTerrain::initSurface(Surface& mesh, const LLSurface* surface)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_DRAWPOOL;
+
+    const U32 width = (U32)surface->getGridsPerPatchEdge();
+    const U32 patches = (U32)surface->getPatchesPerEdge();
+
+    // power of two patches, and the vertices of a block within U16 indices
+    if (width < 2 || (width & (width - 1)) != 0 || (width + 1) * (width + 1) > 65536 || patches == 0)
+    {
+        LL_WARNS("Terrain") << "No GPU terrain for " << width << " grids per patch edge" << LL_ENDL;
+        return false;
+    }
+
+    mesh.mPatchWidth = width;
+    mesh.mLevels = 0;
+    while ((1U << mesh.mLevels) <= width)
+    {
+        ++mesh.mLevels;
+    }
+
+    mesh.mChunksPerEdge = (patches + CHUNK_PATCHES - 1) / CHUNK_PATCHES;
+    mesh.mChunks.resize(mesh.mChunksPerEdge * mesh.mChunksPerEdge);
+
+    const U32 row = width + 1;
+    auto quad = [&](std::vector<U16>& indices, U32 x, U32 y, U32 stride)
+    {
+        indices.push_back((U16)(x + y * row));
+        indices.push_back((U16)(x + stride + (y + stride) * row));
+        indices.push_back((U16)(x + (y + stride) * row));
+        indices.push_back((U16)(x + y * row));
+        indices.push_back((U16)(x + stride + y * row));
+        indices.push_back((U16)(x + stride + (y + stride) * row));
+    };
+
+    mesh.mIndices.clear();
+    mesh.mInside.assign(mesh.mLevels, Range());
+    mesh.mEdges.assign(mesh.mLevels * EDGE_COUNT * mesh.mLevels, Range());
+
+    for (U32 level = 0; level < mesh.mLevels; ++level)
+    {
+        const U32 stride = 1U << level;
+
+        Range& inside = mesh.mInside[level];
+        inside.mOffset = (U32)mesh.mIndices.size();
+        if (stride == width)
+        { // the corners only, nothing is coarser
+            quad(mesh.mIndices, 0, 0, width);
+            inside.mCount = (U32)mesh.mIndices.size() - inside.mOffset;
+            continue;
+        }
+
+        // all but the ring of grids along the edges
+        for (U32 y = stride; y + 2 * stride <= width; y += stride)
+        {
+            for (U32 x = stride; x + 2 * stride <= width; x += stride)
+            {
+                quad(mesh.mIndices, x, y, stride);
+            }
+        }
+        inside.mCount = (U32)mesh.mIndices.size() - inside.mOffset;
+
+        for (U32 edge = 0; edge < EDGE_COUNT; ++edge)
+        {
+            for (U32 edge_level = level; edge_level < mesh.mLevels; ++edge_level)
+            {
+                buildEdge(mesh, level, edge_level, edge);
+            }
+        }
+    }
+
+    mesh.mTangentIndices.clear();
+    for (U32 y = 0; y < width; ++y)
+    {
+        for (U32 x = 0; x < width; ++x)
+        {
+            quad(mesh.mTangentIndices, x, y, 1);
+        }
+    }
+
+    return true;
+}
+
+// The strip between the edge of the patch, at the stride of edge_level, and
+// the inside of it, at the stride of level. The two rows are zipped together
+// so the strip takes in every vertex of both. The four strips of a level are
+// the trapezoids of the ring around the inside.
+void FSGPUTerrain::buildEdge(Surface& mesh, U32 level, U32 edge_level, U32 edge)
+{
+    const U32 width = mesh.mPatchWidth;
+    const U32 row = width + 1;
+    const U32 stride = 1U << level;
+    const U32 edge_stride = 1U << edge_level;
+
+    Range& range = mesh.mEdges[(level * EDGE_COUNT + edge) * mesh.mLevels + edge_level];
+    range.mOffset = (U32)mesh.mIndices.size();
+
+    auto add = [&](U32 t0, U32 d0, U32 t1, U32 d1, U32 t2, U32 d2)
+    {
+        U32 x[3], y[3];
+        edge_point(edge, width, t0, d0, x[0], y[0]);
+        edge_point(edge, width, t1, d1, x[1], y[1]);
+        edge_point(edge, width, t2, d2, x[2], y[2]);
+
+        // counter clockwise seen from above
+        const S32 area = ((S32)x[1] - (S32)x[0]) * ((S32)y[2] - (S32)y[0]) - ((S32)x[2] - (S32)x[0]) * ((S32)y[1] - (S32)y[0]);
+        if (area < 0)
+        {
+            std::swap(x[1], x[2]);
+            std::swap(y[1], y[2]);
+        }
+
+        for (U32 i = 0; i < 3; ++i)
+        {
+            mesh.mIndices.push_back((U16)(x[i] + y[i] * row));
+        }
+    };
+
+    const U32 outer = width / edge_stride;              // last point along the edge
+    const U32 inner = (width - 2 * stride) / stride;    // last point along the inside
+    U32 o = 0;
+    U32 i = 0;
+    while (o < outer || i < inner)
+    {
+        if (i < inner && (o == outer || stride + (i + 1) * stride <= (o + 1) * edge_stride))
+        {
+            add(o * edge_stride, 0, stride + i * stride, stride, stride + (i + 1) * stride, stride);
+            ++i;
+        }
+        else
+        {
+            add(o * edge_stride, 0, stride + i * stride, stride, (o + 1) * edge_stride, 0);
+            ++o;
+        }
+    }
+
+    range.mCount = (U32)mesh.mIndices.size() - range.mOffset;
+}
+
+bool FSGPUTerrain::getPatchCoords(const LLSurfacePatch* patch, const LLSurface* surface, U32& x, U32& y) const
+{
+    const F32 patch_meters = surface->getMetersPerGrid() * surface->getGridsPerPatchEdge();
+    const LLVector3d origin = patch->getOriginGlobal() - surface->getOriginGlobal();
+    const S32 px = ll_round((F32)origin.mdV[VX] / patch_meters);
+    const S32 py = ll_round((F32)origin.mdV[VY] / patch_meters);
+    if (px < 0 || py < 0 || px >= surface->getPatchesPerEdge() || py >= surface->getPatchesPerEdge())
+    {
+        return false;
+    }
+
+    x = (U32)px;
+    y = (U32)py;
+    return true;
+}
+
+FSGPUTerrain::Chunk* FSGPUTerrain::getChunk(Surface& mesh, U32 x, U32 y, U32& block)
+{
+    const U32 index = x / CHUNK_PATCHES + (y / CHUNK_PATCHES) * mesh.mChunksPerEdge;
+    if (index >= mesh.mChunks.size())
+    {
+        return nullptr;
+    }
+
+    block = x % CHUNK_PATCHES + (y % CHUNK_PATCHES) * CHUNK_PATCHES;
+
+    Chunk& chunk = mesh.mChunks[index];
+    if (chunk.mBuffer.isNull())
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_DRAWPOOL("gpu terrain - make buffer");
+
+        const U32 block_vertices = (mesh.mPatchWidth + 1) * (mesh.mPatchWidth + 1);
+        LLPointer<LLVertexBuffer> buffer = new LLVertexBuffer(LLDrawPoolTerrain::VERTEX_DATA_MASK);
+        if (!buffer->allocateBuffer(CHUNK_PATCHES * CHUNK_PATCHES * block_vertices, (U32)mesh.mIndices.size()))
+        {
+            return nullptr;
+        }
+
+        LLStrider<U16> indices;
+        if (!buffer->getIndexStrider(indices))
+        {
+            return nullptr;
+        }
+        for (U16 index : mesh.mIndices)
+        {
+            *(indices++) = index;
+        }
+
+        chunk.mBuffer = buffer;
+        chunk.mMapped = true;
+        chunk.mDirty.assign(CHUNK_PATCHES * CHUNK_PATCHES, true);
+    }
+
+    return &chunk;
+}
+
+void FSGPUTerrain::fillBlock(Surface& mesh, Chunk& chunk, const LLSurfacePatch* patch, U32 block)
+{
+    LL_PROFILE_ZONE_NAMED_CATEGORY_DRAWPOOL("gpu terrain - fill block");
+
+    const U32 width = mesh.mPatchWidth;
+    const U32 row = width + 1;
+    const U32 count = row * row;
+
+    LLStrider<LLVector3> vertices;
+    LLStrider<LLVector3> normals;
+    LLStrider<LLVector2> texcoords1;
+    LLStrider<LLVector4a> tangents;
+    if (!chunk.mBuffer->getVertexStrider(vertices, block * count, count)
+        || !chunk.mBuffer->getNormalStrider(normals, block * count, count)
+        || !chunk.mBuffer->getTexCoord1Strider(texcoords1, block * count, count)
+        || !chunk.mBuffer->getTangentStrider(tangents, block * count, count))
+    {
+        return;
+    }
+
+    chunk.mMapped = true;
+
+    const F32 region_width = patch->getSurface()->getRegion()->getWidth();
+    const F32 meters_per_grid = patch->getSurface()->getMetersPerGrid();
+
+    mPositions.resize(count);
+    mNormals.resize(count);
+    mTangents.resize(count);
+    mTexCoords.resize(count);
+
+    for (U32 y = 0; y <= width; ++y)
+    {
+        for (U32 x = 0; x <= width; ++x)
+        {
+            const U32 v = x + y * row;
+
+            LLVector3 position;
+            LLVector3 unused;
+            patch->eval(x, y, 1, &position, &unused, texcoords1.get());
+
+            // the patch keeps normals at its render stride only
+            const S32 sx = (S32)x;
+            const S32 sy = (S32)y;
+            LLVector3 normal(get_height(patch, sx - 1, sy) - get_height(patch, sx + 1, sy),
+                             get_height(patch, sx, sy - 1) - get_height(patch, sx, sy + 1),
+                             2.f * meters_per_grid);
+            normal.normalize();
+
+            *(vertices++) = position;
+            *(normals++) = normal;
+            texcoords1++;
+
+            mPositions[v].set(position.mV[VX], position.mV[VY], position.mV[VZ], 1.f);
+            mNormals[v].set(normal.mV[VX], normal.mV[VY], normal.mV[VZ], 0.f);
+            mTangents[v].clear();
+            // as gen_terrain_tangents()
+            mTexCoords[v].set(position.mV[VX] / region_width, position.mV[VY] / region_width);
+        }
+    }
+
+    LLCalculateTangentArray(count, mPositions.data(), mNormals.data(), mTexCoords.data(),
+        (U32)mesh.mTangentIndices.size() / 3, mesh.mTangentIndices.data(), mTangents.data());
+
+    for (U32 v = 0; v < count; ++v)
+    {
+        *(tangents++) = mTangents[v];
+    }
+
+    chunk.mDirty[block] = false;
+}
+
+void FSGPUTerrain::drawPatch(Surface& mesh, Chunk& chunk, const LLSurfacePatch* patch, U32 block)
+{
+    const U32 width = mesh.mPatchWidth;
+    const S32 base_vertex = (S32)(block * (width + 1) * (width + 1));
+
+    const U32 level = stride_level(llclamp(patch->getRenderStride(), 1U, width), mesh.mLevels);
+
+    const Range& inside = mesh.mInside[level];
+    if (inside.mCount)
+    {
+        chunk.mCounts.push_back(inside.mCount);
+        chunk.mOffsets.push_back(inside.mOffset);
+        chunk.mBaseVertices.push_back(base_vertex);
+    }
+
+    if ((1U << level) == width)
+    {
+        return;
+    }
+
+    for (U32 edge = 0; edge < EDGE_COUNT; ++edge)
+    {
+        // both sides of an edge go by the coarser of them and meet without cracks
+        U32 edge_level = level;
+        const LLSurfacePatch* neighbor = patch->getNeighborPatch(EDGE_DIRECTION[edge]);
+        if (neighbor)
+        {
+            edge_level = llmax(level, stride_level(llclamp(neighbor->getRenderStride(), 1U, width), mesh.mLevels));
+        }
+
+        const Range& range = mesh.mEdges[(level * EDGE_COUNT + edge) * mesh.mLevels + edge_level];
+        if (range.mCount)
+        {
+            chunk.mCounts.push_back(range.mCount);
+            chunk.mOffsets.push_back(range.mOffset);
+            chunk.mBaseVertices.push_back(base_vertex);
+        }
+    }
+}
+
+void FSGPUTerrain::markDirty(const LLSurfacePatch* patch)
+{
+    if (!patch || !patch->getSurface())
+    {
+        return;
+    }
+
+    auto iter = mSurfaces.find(patch->getSurface());
+    if (iter == mSurfaces.end() || iter->second->mChunks.empty())
+    {
+        return;
+    }
+
+    Surface& mesh = *iter->second;
+    U32 x, y;
+    if (getPatchCoords(patch, patch->getSurface(), x, y))
+    {
+        const U32 index = x / CHUNK_PATCHES + (y / CHUNK_PATCHES) * mesh.mChunksPerEdge;
+        Chunk& chunk = mesh.mChunks[index];
+        if (chunk.mBuffer.notNull())
+        {
+            chunk.mDirty[x % CHUNK_PATCHES + (y % CHUNK_PATCHES) * CHUNK_PATCHES] = true;
+        }
+    }
+}
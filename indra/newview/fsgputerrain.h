@@ -0,0 +1,130 @@
+/**
+ * @file fsgputerrain.h
+ * @brief Terrain drawn from full resolution region meshes
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+
+#ifndef FS_FSGPUTERRAIN_H
+#define FS_FSGPUTERRAIN_H
+
+#include "llvertexbuffer.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+class LLFace;
+class LLSurface;
+class LLSurfacePatch;
+
+// Terrain drawn from a mesh of every region at full resolution, uploaded
+// once, instead of the patch strips LLVOSurfacePatch rebuilds each time the
+// camera moves a patch to another render stride. The render stride of each
+// patch only picks which indices of its block of the mesh are drawn.
+//
+// A block holds the (P + 1) x (P + 1) vertices of one patch, P being the
+// grids per patch edge. Blocks share one index pattern: the inside of the
+// patch at each stride, and the strips along its four edges at each stride
+// of the coarser side, so a patch meets a neighbor of another stride
+// without cracks. All visible patches of a chunk of 8 x 8 blocks, one
+// vertex buffer, go out in one glMultiDrawElementsBaseVertex call.
+//
+// Blocks are refilled when the terrain geometry of their patch is rebuilt
+// for new heights or composition, see LLTerrainPartition::getGeometry().
+// Enabled with FSGPUTerrain.
+class FSGPUTerrain
+{
+public:
+    static bool sEnabled;
+
+    FSGPUTerrain();
+    ~FSGPUTerrain();
+
+    static bool isEnabled();
+
+    // Threads:  Tmain
+    // Draw the patches of faces, terrain faces of any region, with the
+    // bound shader
+    void render(const std::vector<LLFace*>& faces);
+
+    // Threads:  Tmain
+    // The heights, normals or composition of patch changed
+    void dirtyPatch(const LLSurfacePatch* patch);
+
+    // Threads:  Tmain
+    void removeSurface(const LLSurface* surface);
+
+    void release();
+
+private:
+    static constexpr U32 CHUNK_PATCHES = 8;     // patches per chunk edge
+
+    struct Range
+    {
+        U32 mOffset = 0;
+        U32 mCount = 0;
+    };
+
+    struct Chunk
+    {
+        LLPointer<LLVertexBuffer>   mBuffer;
+        std::vector<bool>           mDirty;     // per block
+        bool                        mMapped = false;
+        std::vector<U32>            mCounts;    // draws of the current call
+        std::vector<U32>            mOffsets;
+        std::vector<S32>            mBaseVertices;
+    };
+
+    struct Surface
+    {
+        U32                     mPatchWidth = 0;    // grids per patch edge
+        U32                     mLevels = 0;        // strides 1, 2, 4 up to mPatchWidth
+        U32                     mChunksPerEdge = 0;
+        std::vector<U16>        mIndices;
+        std::vector<Range>      mInside;            // per level
+        std::vector<Range>      mEdges;             // per level, edge and level of the edge
+        std::vector<U16>        mTangentIndices;    // every grid of a block
+        std::vector<Chunk>      mChunks;
+    };
+
+    bool initSurface(Surface& mesh, const LLSurface* surface);
+    void buildEdge(Surface& mesh, U32 level, U32 edge_level, U32 edge);
+    bool getPatchCoords(const LLSurfacePatch* patch, const LLSurface* surface, U32& x, U32& y) const;
+    Chunk* getChunk(Surface& mesh, U32 x, U32 y, U32& block);
+    void fillBlock(Surface& mesh, Chunk& chunk, const LLSurfacePatch* patch, U32 block);
+    void drawPatch(Surface& mesh, Chunk& chunk, const LLSurfacePatch* patch, U32 block);
+    void markDirty(const LLSurfacePatch* patch);
+
+    std::map<const LLSurface*, std::unique_ptr<Surface>>   mSurfaces;
+    std::vector<std::pair<const LLSurface*, const LLSurfacePatch*>> mPatches;  // of the current call
+
+    // scratch space of fillBlock()
+    std::vector<LLVector4a> mPositions;
+    std::vector<LLVector4a> mNormals;
+    std::vector<LLVector4a> mTangents;
+    std::vector<LLVector2>  mTexCoords;
+};
+
+#endif // FS_FSGPUTERRAIN_H
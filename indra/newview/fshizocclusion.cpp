@@ -0,0 +1,405 @@
+/**
+ * @file fshizocclusion.cpp
+ * @brief Hierarchical depth occlusion test for spatial groups
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fshizocclusion.h"
+
+#include "llimagegl.h"
+#include "llrender.h"
+#include "llvertexbuffer.h"
+#include "llviewercamera.h"
+#include "llviewercontrol.h"
+#include "llvieweroctree.h"
+#include "llviewershadermgr.h"
+#include "pipeline.h"
+
+extern bool gCubeSnapshot;
+
+FSHiZOcclusion::FSHiZOcclusion()
+:   mPyramid(0),
+    mBoxTexture(0),
+    mWidth(0),
+    mHeight(0),
+    mNextReadback(0),
+    mActive(false)
+{
+}
+
+FSHiZOcclusion::~FSHiZOcclusion()
+{
+    // The pyramid and box textures, the result target and the readback
+    // buffers go in release(), which LLPipeline::releaseScreenBuffers() and
+    // LLPipeline::cleanup() call while the GL context is still current.
+    // Pending groups need apply() then, which can't run from here.
+}
+
+void FSHiZOcclusion::release()
+{
+    mChain.clear();
+    mResults.release();
+
+    if (mPyramid)
+    {
+        LLImageGL::deleteTextures(1, &mPyramid);
+        mPyramid = 0;
+    }
+
+    if (mBoxTexture)
+    {
+        LLImageGL::deleteTextures(1, &mBoxTexture);
+        mBoxTexture = 0;
+    }
+
+    // Groups still waiting would never be tested again, apply() counts
+    // them as visible once their buffer is gone
+    LLViewerCamera::eCameraID saved_camera_id = LLViewerCamera::sCurCameraID;
+    LLViewerCamera::sCurCameraID = LLViewerCamera::CAMERA_WORLD;
+    for (Readback& readback : mReadbacks)
+    {
+        if (readback.mBuffer)
+        {
+            glDeleteBuffers(1, &readback.mBuffer);
+            readback.mBuffer = 0;
+        }
+        if (readback.mPending)
+        {
+            apply(readback);
+        }
+    }
+    LLViewerCamera::sCurCameraID = saved_camera_id;
+
+    mBoxes.clear();
+    mGroups.clear();
+    mWidth = 0;
+    mHeight = 0;
+    mActive = false;
+}
+
+bool FSHiZOcclusion::allocate(U32 width, U32 height)
+{
+    if (width == mWidth && height == mHeight && mPyramid)
+    {
+        return true;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+    release();
+
+    // Level 0 is half the depth buffer, sizes round up so every level
+    // covers the whole screen
+    std::vector<std::pair<U32, U32>> sizes;
+    U32 w = width, h = height;
+    do
+    {
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+        sizes.emplace_back(w, h);
+    } while (w > 1 || h > 1);
+
+    mChain.resize(sizes.size());
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        if (!mChain[i].allocate(sizes[i].first, sizes[i].second, GL_R32F))
+        {
+            release();
+            return false;
+        }
+    }
+
+    LLImageGL::generateTextures(1, &mPyramid);
+    gGL.getTexUnit(0)->bindManual(LLTexUnit::TT_TEXTURE, mPyramid, true);
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_R32F, sizes[i].first, sizes[i].second, 0, GL_RED, GL_FLOAT, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)sizes.size() - 1);
+
+    LLImageGL::generateTextures(1, &mBoxTexture);
+    gGL.getTexUnit(0)->bindManual(LLTexUnit::TT_TEXTURE, mBoxTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, RESULT_WIDTH * 2, RESULT_ROWS, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+
+    if (!mResults.allocate(RESULT_WIDTH, RESULT_ROWS, GL_RGBA8))
+    {
+        release();
+        return false;
+    }
+
+    for (Readback& readback : mReadbacks)
+    {
+        glGenBuffers(1, &readback.mBuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.mBuffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, RESULT_WIDTH * RESULT_ROWS, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    mWidth = width;
+    mHeight = height;
+    return true;
+}
+
+bool FSHiZOcclusion::beginTest(LLRenderTarget& depth_src)
+{
+    static LLCachedControl<bool> use_hiz(gSavedSettings, "FSHiZOcclusion", true);
+
+    mActive = false;
+    if (!use_hiz ||
+        LLViewerCamera::sCurCameraID != LLViewerCamera::CAMERA_WORLD ||
+        LLPipeline::sShadowRender ||
+        gCubeSnapshot ||
+        !gHiZDownsampleProgram.mProgramObject ||
+        !gHiZOcclusionProgram.mProgramObject)
+    {
+        return false;
+    }
+
+    if (!allocate(depth_src.getWidth(), depth_src.getHeight()))
+    {
+        return false;
+    }
+
+    // the GPU is more than READBACK_COUNT tests behind, wait for the oldest
+    Readback& readback = mReadbacks[mNextReadback];
+    if (readback.mPending)
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_PIPELINE("hiz - stall");
+        apply(readback);
+    }
+
+    buildPyramid(depth_src);
+
+    mBoxes.clear();
+    mGroups.clear();
+    mActive = true;
+    return true;
+}
+
+void FSHiZOcclusion::buildPyramid(LLRenderTarget& depth_src)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+    LL_PROFILE_GPU_ZONE("hiz pyramid");
+
+    LLGLDepthTest depth(GL_FALSE);
+    LLGLDisable blend(GL_BLEND);
+    gGL.setColorMask(true, false);
+
+    gHiZDownsampleProgram.bind();
+    S32 channel = gHiZDownsampleProgram.enableTexture(LLShaderMgr::DEFERRED_DEPTH);
+
+    gPipeline.mScreenTriangleVB->setBuffer();
+
+    for (size_t i = 0; i < mChain.size(); ++i)
+    {
+        mChain[i].bindTarget();
+        if (i == 0)
+        {
+            gGL.getTexUnit(channel)->bind(&depth_src, true);
+        }
+        else
+        {
+            gGL.getTexUnit(channel)->bind(&mChain[i - 1]);
+        }
+
+        gPipeline.mScreenTriangleVB->drawArrays(LLRender::TRIANGLES, 0, 3);
+
+        gGL.getTexUnit(channel)->bindManual(LLTexUnit::TT_TEXTURE, mPyramid, true);
+        glCopyTexSubImage2D(GL_TEXTURE_2D, (GLint)i, 0, 0, 0, 0, mChain[i].getWidth(), mChain[i].getHeight());
+
+        mChain[i].flush();
+    }
+
+    gGL.getTexUnit(channel)->unbind(LLTexUnit::TT_TEXTURE);
+    gHiZDownsampleProgram.unbind();
+
+    gGL.setColorMask(false, false);
+}
+
+bool FSHiZOcclusion::push(LLOcclusionCullingGroup* group, const LLVector4a& center, const LLVector4a& size)
+{
+    if (!mActive || mGroups.size() >= MAX_GROUPS)
+    {
+        return false;
+    }
+
+    mGroups.emplace_back(group);
+    mBoxes.push_back(center);
+    mBoxes.push_back(size);
+    return true;
+}
+
+void FSHiZOcclusion::endTest()
+{
+    if (!mActive)
+    {
+        return;
+    }
+    mActive = false;
+
+    if (mGroups.empty())
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+    LL_PROFILE_GPU_ZONE("hiz test");
+
+    static LLStaticHashedString result_size("result_size");
+    static LLStaticHashedString result_width("result_width");
+    static LLStaticHashedString hiz_levels("hiz_levels");
+
+    const U32 count = (U32)mGroups.size();
+    const U32 rows = (count + RESULT_WIDTH - 1) / RESULT_WIDTH;
+
+    // whole rows, the padding is never read back
+    mBoxes.resize(rows * RESULT_WIDTH * 2);
+    gGL.getTexUnit(0)->bindManual(LLTexUnit::TT_TEXTURE, mBoxTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, RESULT_WIDTH * 2, rows, GL_RGBA, GL_FLOAT, mBoxes.data());
+
+    LLGLDepthTest depth(GL_FALSE);
+    LLGLDisable blend(GL_BLEND);
+    gGL.setColorMask(true, false);
+
+    mResults.bindTarget();
+
+    gHiZOcclusionProgram.bind();
+    S32 box_channel = gHiZOcclusionProgram.enableTexture(LLShaderMgr::DIFFUSE_MAP);
+    S32 pyramid_channel = gHiZOcclusionProgram.enableTexture(LLShaderMgr::DEFERRED_DEPTH);
+    gGL.getTexUnit(box_channel)->bindManual(LLTexUnit::TT_TEXTURE, mBoxTexture);
+    gGL.getTexUnit(pyramid_channel)->bindManual(LLTexUnit::TT_TEXTURE, mPyramid, true);
+
+    gHiZOcclusionProgram.uniform2f(result_size, (F32)RESULT_WIDTH, (F32)RESULT_ROWS);
+    gHiZOcclusionProgram.uniform1i(result_width, RESULT_WIDTH);
+    gHiZOcclusionProgram.uniform1i(hiz_levels, (GLint)mChain.size());
+
+    gGL.syncMatrices();
+
+    // positions come from gl_VertexID and the box texture, no vertex buffer
+    LLVertexBuffer::unbind();
+    glDrawArrays(GL_POINTS, 0, count);
+
+    Readback& readback = mReadbacks[mNextReadback];
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.mBuffer);
+    glReadPixels(0, 0, RESULT_WIDTH, rows, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.mFence.placeFence();
+    readback.mGroups.swap(mGroups);
+    readback.mFrame = gFrameCount;
+    readback.mPending = true;
+    mNextReadback = (mNextReadback + 1) % READBACK_COUNT;
+
+    mResults.flush();
+
+    gGL.getTexUnit(pyramid_channel)->unbind(LLTexUnit::TT_TEXTURE);
+    gGL.getTexUnit(box_channel)->unbind(LLTexUnit::TT_TEXTURE);
+    gHiZOcclusionProgram.unbind();
+
+    gGL.setColorMask(false, false);
+
+    mGroups.clear();
+}
+
+void FSHiZOcclusion::resolve()
+{
+    // occlusion states are per camera, results are for the world camera
+    if (LLViewerCamera::sCurCameraID != LLViewerCamera::CAMERA_WORLD)
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+    static LLCachedControl<U32> occlusion_timeout(gSavedSettings, "RenderOcclusionTimeout", 4);
+
+    // oldest first, a newer test never finishes before an older one
+    for (U32 i = 0; i < READBACK_COUNT; ++i)
+    {
+        Readback& readback = mReadbacks[(mNextReadback + i) % READBACK_COUNT];
+        if (!readback.mPending)
+        {
+            continue;
+        }
+
+        if (!readback.mFence.isCompleted() && gFrameCount - readback.mFrame <= occlusion_timeout)
+        {
+            break;
+        }
+
+        apply(readback);
+    }
+}
+
+void FSHiZOcclusion::apply(Readback& readback)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+
+    const U32 count = (U32)readback.mGroups.size();
+    const U8* results = nullptr;
+    if (readback.mBuffer)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.mBuffer);
+        results = (const U8*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, count, GL_MAP_READ_BIT);
+    }
+
+    for (U32 i = 0; i < count; ++i)
+    {
+        LLOcclusionCullingGroup* group = readback.mGroups[i];
+        // dead, resolved through an occluded parent or tested again since
+        if (group->isDead() ||
+            !group->isOcclusionState(LLOcclusionCullingGroup::QUERY_PENDING) ||
+            group->getLastOcclusionIssuedTime() != readback.mFrame)
+        {
+            continue;
+        }
+
+        // no results count as visible, like a query that was discarded
+        if (group->isOcclusionState(LLOcclusionCullingGroup::DISCARD_QUERY) || !results || results[i])
+        {
+            group->clearOcclusionState(LLOcclusionCullingGroup::OCCLUDED, LLOcclusionCullingGroup::STATE_MODE_DIFF);
+        }
+        else
+        {
+            group->setOcclusionState(LLOcclusionCullingGroup::OCCLUDED, LLOcclusionCullingGroup::STATE_MODE_DIFF);
+        }
+        group->clearOcclusionState(LLOcclusionCullingGroup::QUERY_PENDING | LLOcclusionCullingGroup::DISCARD_QUERY);
+    }
+
+    if (results)
+    {
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    if (readback.mBuffer)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    readback.mGroups.clear();
+    readback.mPending = false;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file fshizocclusion.h
+ * @brief Hierarchical depth occlusion test for spatial groups
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSHIZOCCLUSION_H
+#define FS_FSHIZOCCLUSION_H
+
+#include "llgl.h"
+#include "llpointer.h"
+#include "llrendertarget.h"
+#include "llvector4a.h"
+
+#include <vector>
+
+class LLOcclusionCullingGroup;
+
+// Occlusion culling of the world camera's spatial groups without one GL
+// query per group. After the opaque pools are drawn, the depth buffer is
+// reduced to a pyramid where every texel holds the farthest depth under it.
+// The bounds of all groups due for a test are then drawn as one batch of
+// points, each projecting its box, picking the pyramid level where the box
+// covers at most 2x2 texels and writing whether its nearest depth is in
+// front of them. The results are read back through a pixel buffer and
+// applied once its fence has passed, a frame or more later, like queries.
+//
+// Groups of water partitions and of the object cache keep using queries.
+class FSHiZOcclusion
+{
+public:
+    static constexpr U32 RESULT_WIDTH = 256;
+    static constexpr U32 RESULT_ROWS = 64;
+    static constexpr U32 MAX_GROUPS = RESULT_WIDTH * RESULT_ROWS;
+
+    FSHiZOcclusion();
+    ~FSHiZOcclusion();
+
+    // Threads:  Tmain
+    // Build the pyramid from the depth of depth_src and start taking groups.
+    // Called with color writes off, as occlusion queries are. Returns false
+    // when this pass can't use Hi-Z, groups then issue queries as usual.
+    bool beginTest(LLRenderTarget& depth_src);
+
+    // Threads:  Tmain
+    // Queue the box center +/- size for the current test, false when there
+    // is no test running or it is full and the group must issue a query
+    bool push(LLOcclusionCullingGroup* group, const LLVector4a& center, const LLVector4a& size);
+
+    // Threads:  Tmain
+    // Test the queued groups and start reading the results back
+    void endTest();
+
+    // Threads:  Tmain
+    // Apply the results of every finished test to its groups
+    void resolve();
+
+    void release();
+
+private:
+    struct Readback
+    {
+        GLuint                                          mBuffer = 0;
+        LLGLSyncFence                                   mFence;
+        std::vector<LLPointer<LLOcclusionCullingGroup>> mGroups;
+        U32                                             mFrame = 0;
+        bool                                            mPending = false;
+    };
+
+    static constexpr U32 READBACK_COUNT = 3;
+
+    bool allocate(U32 width, U32 height);
+    void buildPyramid(LLRenderTarget& depth_src);
+    void apply(Readback& readback);
+
+    std::vector<LLRenderTarget>     mChain;         // pyramid levels to render into
+    GLuint                          mPyramid;       // the same levels as mips of one texture, for the test
+    GLuint                          mBoxTexture;    // center then size of every queued group
+    LLRenderTarget                  mResults;       // one texel per queued group, non zero when visible
+    U32                             mWidth;
+    U32                             mHeight;
+
+    std::vector<LLVector4a>                         mBoxes;
+    std::vector<LLPointer<LLOcclusionCullingGroup>> mGroups;
+    Readback                                        mReadbacks[READBACK_COUNT];
+    U32                                             mNextReadback;
+    bool                                            mActive;
+};
+
+#endif // FS_FSHIZOCCLUSION_H
@@ -0,0 +1,318 @@
+/**
+ * @file fshudcache.cpp
+ * @brief Cached rendering of the HUD attachments
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fshudcache.h"
+
+#include "llagentcamera.h"
+#include "lldrawable.h"
+#include "llface.h"
+#include "llfetchedgltfmaterial.h"
+#include "llframetimer.h"
+#include "llrender.h"
+#include "llspatialpartition.h"
+#include "lltoolpie.h"
+#include "llviewercamera.h"
+#include "llviewercontrol.h"
+#include "llviewerjointattachment.h"
+#include "llviewershadermgr.h"
+#include "llviewertexture.h"
+#include "llviewerwindow.h"
+#include "llvoavatarself.h"
+#include "llvovolume.h"
+#include "pipeline.h"
+
+extern bool gSnapshot;
+
+namespace
+{
+    // FNV-1a, a value at a time
+    void hash_value(U64& hash, U64 value)
+    {
+        hash = (hash ^ value) * 0x100000001b3ULL;
+    }
+
+    void hash_texture(U64& hash, const LLViewerTexture* texture)
+    {
+        hash_value(hash, (U64)(uintptr_t)texture);
+        if (texture)
+        { // loading a better level shows on the HUD
+            hash_value(hash, (U64)(texture->getDiscardLevel() + 1));
+        }
+    }
+
+    void hash_object(U64& hash, bool& animated, const LLViewerObject* object)
+    {
+        if (!object || object->isDead())
+        {
+            return;
+        }
+
+        hash_value(hash, (U64)(uintptr_t)object);
+
+        if (object->isParticleSource()
+            || (object->getPCode() == LL_PCODE_VOLUME && ((const LLVOVolume*)object)->mTextureAnimp))
+        {
+            animated = true;
+        }
+
+        LLDrawable* drawable = object->mDrawable.get();
+        if (drawable)
+        {
+            for (S32 i = 0; i < drawable->getNumFaces(); ++i)
+            {
+                const LLFace* face = drawable->getFace(i);
+                if (!face)
+                {
+                    continue;
+                }
+
+                if (face->hasMedia())
+                {
+                    animated = true;
+                }
+
+                hash_texture(hash, face->getTexture());
+
+                const LLTextureEntry* te = face->getTextureEntry();
+                const LLFetchedGLTFMaterial* material = te ? (const LLFetchedGLTFMaterial*)te->getGLTFRenderMaterial() : nullptr;
+                if (material)
+                {
+                    hash_texture(hash, material->mBaseColorTexture);
+                    hash_texture(hash, material->mEmissiveTexture);
+                }
+            }
+        }
+
+        for (const auto& child : object->getChildren())
+        {
+            hash_object(hash, animated, child);
+        }
+    }
+}
+
+FSHUDCache::FSHUDCache()
+:   mSignature(0),
+    mButtons(0),
+    mZoom(0.f),
+    mLastUpdate(0),
+    mDirty(true),
+    mValid(false)
+{
+}
+
+FSHUDCache::~FSHUDCache()
+{
+    // Both HUD targets are freed in release(), called from
+    // LLPipeline::releaseGLBuffers() and LLPipeline::cleanup(), so the
+    // LLRenderTarget destructors find nothing left to delete.
+}
+
+void FSHUDCache::markChanged(LLSpatialGroup* group)
+{
+    if (mValid && group && group->isHUDGroup())
+    {
+        mDirty = true;
+    }
+}
+
+bool FSHUDCache::isCurrent()
+{
+    static LLCachedControl<bool> enabled(gSavedSettings, "FSHUDCache", false);
+    static LLCachedControl<U32> max_frames(gSavedSettings, "FSHUDCacheMaxFrames", 60);
+
+    if (!enabled || !mValid || mDirty || gSnapshot || !mTargets[0].isComplete())
+    {
+        return false;
+    }
+
+    if (mTargets[0].getWidth() != (U32)gViewerWindow->getWindowWidthRaw()
+        || mTargets[0].getHeight() != (U32)gViewerWindow->getWindowHeightRaw()
+        || mZoom != gAgentCamera.mHUDCurZoom
+        || LLFrameTimer::getFrameCount() - mLastUpdate >= max_frames)
+    {
+        return false;
+    }
+
+    LLCoordGL mouse;
+    U32 buttons;
+    getMouseState(mouse, buttons);
+    if (mouse.mX != mMouse.mX || mouse.mY != mMouse.mY || buttons != mButtons)
+    {
+        return false;
+    }
+
+    bool animated = false;
+    return getSignature(animated) == mSignature && !animated;
+}
+
+bool FSHUDCache::update(const std::function<void()>& render)
+{
+    static LLCachedControl<bool> enabled(gSavedSettings, "FSHUDCache", false);
+
+    if (!enabled || gSnapshot || !gHUDCacheTransmittanceProgram.isComplete() || !gHUDCacheColorProgram.isComplete())
+    {
+        if (mTargets[0].isComplete())
+        {
+            release();
+        }
+        return false;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+
+    const U32 width = (U32)gViewerWindow->getWindowWidthRaw();
+    const U32 height = (U32)gViewerWindow->getWindowHeightRaw();
+    for (LLRenderTarget& target : mTargets)
+    {
+        if ((target.getWidth() != width || target.getHeight() != height)
+            && !target.allocate(width, height, GL_RGBA16F, true))
+        {
+            release();
+            return false;
+        }
+    }
+
+    // Over black, then over white. The viewport is the one the HUD would be
+    // drawn with, the targets cover the whole window.
+    for (U32 i = 0; i < 2; ++i)
+    {
+        LLRenderTarget& target = mTargets[i];
+        target.bindTarget();
+        glClearColor((F32)i, (F32)i, (F32)i, 0.f);
+        target.clear();
+        glClearColor(0.f, 0.f, 0.f, 0.f);
+        glViewport(gGLViewport[0], gGLViewport[1], gGLViewport[2], gGLViewport[3]);
+
+        render();
+
+        target.flush();
+    }
+
+    bool animated = false;
+    mSignature = getSignature(animated);
+    getMouseState(mMouse, mButtons);
+    mZoom = gAgentCamera.mHUDCurZoom;
+    mLastUpdate = LLFrameTimer::getFrameCount();
+    mDirty = false;
+    mValid = !animated;
+
+    composite();
+    return true;
+}
+
+void FSHUDCache::composite()
+{
+    if (!mTargets[0].isComplete() || !mTargets[1].isComplete())
+    {
+        return;
+    }
+
+    LL_PROFILE_GPU_ZONE("hud cache composite");
+
+    LLGLDepthTest depth(GL_FALSE, GL_FALSE);
+    LLGLDisable cull(GL_CULL_FACE);
+    LLGLEnable blend(GL_BLEND);
+
+    glViewport(0, 0, mTargets[0].getWidth(), mTargets[0].getHeight());
+    gPipeline.mScreenTriangleVB->setBuffer();
+
+    // what remains of the frame below
+    gGL.setSceneBlendType(LLRender::BT_MULT);
+    gHUDCacheTransmittanceProgram.bind();
+    gHUDCacheTransmittanceProgram.bindTexture(LLShaderMgr::DIFFUSE_MAP, &mTargets[0], false, LLTexUnit::TFO_POINT);
+    gHUDCacheTransmittanceProgram.bindTexture(LLShaderMgr::SPECULAR_MAP, &mTargets[1], false, LLTexUnit::TFO_POINT);
+    gPipeline.mScreenTriangleVB->drawArrays(LLRender::TRIANGLES, 0, 3);
+    gHUDCacheTransmittanceProgram.unbind();
+
+    // plus what the HUD adds
+    gGL.setSceneBlendType(LLRender::BT_ADD);
+    gHUDCacheColorProgram.bind();
+    gHUDCacheColorProgram.bindTexture(LLShaderMgr::DIFFUSE_MAP, &mTargets[0], false, LLTexUnit::TFO_POINT);
+    gPipeline.mScreenTriangleVB->drawArrays(LLRender::TRIANGLES, 0, 3);
+    gHUDCacheColorProgram.unbind();
+
+    gGL.setSceneBlendType(LLRender::BT_ALPHA);
+    glViewport(gGLViewport[0], gGLViewport[1], gGLViewport[2], gGLViewport[3]);
+}
+
+void FSHUDCache::release()
+{
+    for (LLRenderTarget& target : mTargets)
+    {
+        target.release();
+    }
+    mValid = false;
+    mDirty = true;
+}
+
+U64 FSHUDCache::getSignature(bool& animated) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+
+    U64 hash = 0xcbf29ce484222325ULL;
+    animated = false;
+
+    if (!isAgentAvatarValid())
+    {
+        return hash;
+    }
+
+    for (const auto& point : gAgentAvatarp->mAttachmentPoints)
+    {
+        const LLViewerJointAttachment* attachment = point.second;
+        if (!attachment || !attachment->getIsHUDAttachment())
+        {
+            continue;
+        }
+
+        for (const LLPointer<LLViewerObject>& object : attachment->mAttachedObjects)
+        {
+            hash_object(hash, animated, object);
+        }
+    }
+
+    return hash;
+}
+
+void FSHUDCache::getMouseState(LLCoordGL& mouse, U32& buttons) const
+{
+    LLPointer<LLViewerObject> hover = LLToolPie::getInstance()->getHoverPick().getObject();
+    if (hover.isNull() || !hover->getRootEdit()->isHUDAttachment())
+    { // elsewhere, the HUD doesn't care where
+        mouse = LLCoordGL(-1, -1);
+        buttons = 0;
+        return;
+    }
+
+    mouse = gViewerWindow->getCurrentMouse();
+    buttons = (gViewerWindow->getLeftMouseDown() ? 1 : 0)
+        | (gViewerWindow->getMiddleMouseDown() ? 2 : 0)
+        | (gViewerWindow->getRightMouseDown() ? 4 : 0);
+}
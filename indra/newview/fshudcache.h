@@ -0,0 +1,97 @@
+/**
+ * @file fshudcache.h
+ * @brief Cached rendering of the HUD attachments
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+
+#ifndef FS_FSHUDCACHE_H
+#define FS_FSHUDCACHE_H
+
+#include "llcoord.h"
+#include "llrendertarget.h"
+
+#include <functional>
+
+class LLSpatialGroup;
+
+// HUD attachments drawn into render targets of their own and composited
+// over the frame, redrawn only when something on the HUD changed: HUD
+// geometry moved or was rebuilt, textures or materials of HUD faces loaded
+// or were swapped, the HUD zoom or the window size changed, or the mouse
+// moved or clicked over a HUD object. HUDs with media, animated textures
+// or particles are redrawn every frame, as is every HUD at least once in
+// FSHUDCacheMaxFrames.
+//
+// Blending makes every drawn pixel a linear function of the pixel below,
+// so the HUD is drawn once over black and once over white into RGBA16F
+// targets. Over black is the color the HUD adds, the difference is what
+// remains of the background, which makes the composite exact for alpha and
+// additive blending alike, see hudCacheF.glsl. HUD text is not cached.
+// Enabled with FSHUDCache.
+class FSHUDCache
+{
+public:
+    FSHUDCache();
+    ~FSHUDCache();
+
+    // Threads:  Tmain
+    // HUD groups and drawables of HUD groups about to move or be rebuilt
+    void markChanged(LLSpatialGroup* group);
+
+    // Threads:  Tmain
+    // The cache holds the HUD as it would be drawn this frame
+    bool isCurrent();
+
+    // Threads:  Tmain
+    // Draw the HUD into the cache, render is called once per background with
+    // the HUD matrices and the viewport set, and composite it. False when the
+    // cache is off or can't be allocated, render was not called then.
+    bool update(const std::function<void()>& render);
+
+    // Threads:  Tmain
+    // Blend the cached HUD over the bound frame buffer
+    void composite();
+
+    void release();
+
+private:
+    // Hash of the HUD objects and the textures of their faces, animated is
+    // set when any of them changes without being rebuilt
+    U64 getSignature(bool& animated) const;
+
+    // Mouse over a HUD object, or where it was last over one
+    void getMouseState(LLCoordGL& mouse, U32& buttons) const;
+
+    LLRenderTarget  mTargets[2];    // the HUD over black and over white
+    U64             mSignature;
+    LLCoordGL       mMouse;
+    U32             mButtons;
+    F32             mZoom;
+    U32             mLastUpdate;    // frame
+    bool            mDirty;
+    bool            mValid;
+};
+
+#endif // FS_FSHUDCACHE_H
@@ -0,0 +1,230 @@
+/**
+ * @file fsidlescheduler.cpp
+ * @brief Time budgeted scheduler for the idle work of the main loop
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsidlescheduler.h"
+
+#include "llappviewer.h"
+#include "llviewercontrol.h"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr F32 STATS_INTERVAL = 60.f;        // seconds between cost logs
+    constexpr F32 BUDGET_SMOOTHING = 0.25f;
+    constexpr F32 COST_SMOOTHING = 0.1f;
+}
+
+F32 FSIdleScheduler::sSleepTime = 0.f;
+
+FSIdleScheduler::FSIdleScheduler() :
+    mNextHandle(1),
+    mFrameBudget(0.f),
+    mLastSpent(0.f),
+    mRunning(false),
+    mHasRemoved(false)
+{
+}
+
+FSIdleScheduler::~FSIdleScheduler()
+{
+}
+
+FSIdleScheduler::handle_t FSIdleScheduler::addTask(const std::string& name, EPriority priority, F32 rate, F32 budget_ms, const task_t& task)
+{
+    Task entry;
+    entry.mHandle = mNextHandle++;
+    entry.mName = name;
+    entry.mPriority = priority;
+    entry.mInterval = (rate > 0.f) ? 1.0 / rate : 0.0;
+    entry.mBudget = llmax(budget_ms, 0.f) * 0.001f;
+    entry.mTask = task;
+    entry.mNextRun = 0.0;
+    entry.mSkipped = 0;
+    entry.mPending = false;
+    entry.mRemoved = false;
+    entry.mCalls = 0;
+    entry.mSkips = 0;
+    entry.mTotalTime = 0.0;
+    entry.mAverage = 0.f;
+    entry.mMax = 0.f;
+
+    // Tasks are referenced while they run, don't move them around then
+    (mRunning ? mAddedTasks : mTasks).push_back(std::move(entry));
+    return mNextHandle - 1;
+}
+
+void FSIdleScheduler::removeTask(handle_t handle)
+{
+    for (std::vector<Task>* tasks : { &mTasks, &mAddedTasks })
+    {
+        for (Task& task : *tasks)
+        {
+            if (task.mHandle == handle)
+            {
+                task.mRemoved = true;
+                mHasRemoved = true;
+            }
+        }
+    }
+
+    if (!mRunning)
+    {
+        mTasks.erase(std::remove_if(mTasks.begin(), mTasks.end(), [](const Task& task) { return task.mRemoved; }), mTasks.end());
+        mHasRemoved = false;
+    }
+}
+
+F32 FSIdleScheduler::computeBudget()
+{
+    static LLCachedControl<U32> max_fps(gSavedSettings, "FramePerSecondLimit");
+    static LLCachedControl<bool> limit_framerate(gSavedSettings, "FSLimitFramerate");
+    static LLCachedControl<U32> target_fps(gSavedSettings, "FSIdleSchedulerTargetFPS");
+    static LLCachedControl<F32> min_budget_ms(gSavedSettings, "FSIdleSchedulerMinBudget");
+    static LLCachedControl<F32> max_budget_ms(gSavedSettings, "FSIdleSchedulerMaxBudget");
+
+    // With the frame rate limited, the limit is the target the frame has to
+    // fit in
+    const U32 fps = llmax((limit_framerate && max_fps > 0) ? (U32)max_fps : (U32)target_fps, 1U);
+
+    // What the rest of last frame took, without the scheduled work and
+    // without sleeping
+    const F32 rest_of_frame = llmax(gFrameIntervalSeconds.value() - mLastSpent - sSleepTime, 0.f);
+    sSleepTime = 0.f;
+
+    const F32 min_budget = llmax((F32)min_budget_ms, 0.f) * 0.001f;
+    const F32 max_budget = llmax((F32)max_budget_ms * 0.001f, min_budget);
+    const F32 budget = llclamp(1.f / (F32)fps - rest_of_frame, min_budget, max_budget);
+    mFrameBudget = (mFrameBudget > 0.f) ? lerp(mFrameBudget, budget, BUDGET_SMOOTHING) : budget;
+    return mFrameBudget;
+}
+
+void FSIdleScheduler::run()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_APP;
+
+    static LLCachedControl<bool> enabled(gSavedSettings, "FSIdleScheduler");
+
+    const F32 frame_budget = computeBudget();
+    const F64 now = LLFrameTimer::getElapsedSeconds();
+
+    mOrder.clear();
+    for (size_t i = 0; i < mTasks.size(); ++i)
+    {
+        const Task& task = mTasks[i];
+        if (!task.mRemoved && (task.mPending || task.mInterval <= 0.0 || now >= task.mNextRun))
+        {
+            mOrder.push_back(i);
+        }
+    }
+
+    // By priority, tasks that had to wait move up a level every
+    // STARVE_FRAMES frames they are skipped
+    std::stable_sort(mOrder.begin(), mOrder.end(), [this](size_t a, size_t b)
+    {
+        auto rank = [](const Task& task)
+        {
+            return (S32)(task.mPriority * STARVE_FRAMES) - (S32)llmin(task.mSkipped, STARVE_FRAMES);
+        };
+        return rank(mTasks[a]) < rank(mTasks[b]);
+    });
+
+    mRunning = true;
+    LLTimer timer;
+    for (size_t index : mOrder)
+    {
+        Task& task = mTasks[index];
+        if (task.mRemoved)
+        {
+            continue;
+        }
+
+        F32 budget = (task.mBudget > 0.f) ? task.mBudget : frame_budget;
+        if (enabled && task.mPriority != PRIORITY_CRITICAL && task.mSkipped < STARVE_FRAMES)
+        {
+            // Skip what doesn't fit in what is left, going by what it
+            // usually takes
+            const F32 remaining = frame_budget - timer.getElapsedTimeF32();
+            if (remaining <= 0.f || task.mAverage > remaining)
+            {
+                ++task.mSkipped;
+                ++task.mSkips;
+                continue;
+            }
+            budget = llmin(budget, remaining);
+        }
+
+        const F32 start = timer.getElapsedTimeF32();
+        task.mPending = task.mTask(budget);
+        const F32 cost = timer.getElapsedTimeF32() - start;
+
+        task.mAverage = task.mCalls ? lerp(task.mAverage, cost, COST_SMOOTHING) : cost;
+        task.mMax = llmax(task.mMax, cost);
+        task.mTotalTime += cost;
+        ++task.mCalls;
+        task.mSkipped = 0;
+        if (task.mInterval > 0.0)
+        {
+            task.mNextRun = now + task.mInterval;
+        }
+    }
+    mRunning = false;
+    mLastSpent = timer.getElapsedTimeF32();
+
+    if (mHasRemoved)
+    {
+        mTasks.erase(std::remove_if(mTasks.begin(), mTasks.end(), [](const Task& task) { return task.mRemoved; }), mTasks.end());
+        mHasRemoved = false;
+    }
+    for (Task& task : mAddedTasks)
+    {
+        if (!task.mRemoved)
+        {
+            mTasks.push_back(std::move(task));
+        }
+    }
+    mAddedTasks.clear();
+
+    if (mStatsTimer.getElapsedTimeF32() > STATS_INTERVAL)
+    {
+        mStatsTimer.reset();
+        logStats();
+    }
+}
+
+void FSIdleScheduler::logStats() const
+{
+    LL_DEBUGS("IdleScheduler") << "Frame budget " << mFrameBudget * 1000.f << " ms, last frame spent " << mLastSpent * 1000.f << " ms" << LL_ENDL;
+    for (const Task& task : mTasks)
+    {
+        LL_DEBUGS("IdleScheduler") << task.mName << ": " << task.mCalls << " calls, " << task.mSkips << " skips, "
+                                   << task.mAverage * 1000.f << " ms average, " << task.mMax * 1000.f << " ms max, "
+                                   << task.mTotalTime << " s total" << LL_ENDL;
+    }
+}
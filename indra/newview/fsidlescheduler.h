@@ -0,0 +1,130 @@
+/**
+ * @file fsidlescheduler.h
+ * @brief Time budgeted scheduler for the idle work of the main loop
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSIDLESCHEDULER_H
+#define FS_FSIDLESCHEDULER_H
+
+#include "llframetimer.h"
+#include "llsingleton.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Runs the periodic main thread work that used to be called one after the
+// other from LLAppViewer::idle(), each with its own idea of how much time it
+// may take.
+//
+// Subsystems register a task with a priority, a rate and a time budget. Once
+// a frame run() works out how much of the frame target is left over from
+// the rest of the frame, then runs the due tasks by priority until that is
+// spent. A task gets what is left of the frame budget, capped by its own
+// budget, and returns whether it has more work; such a task is due again the
+// next frame regardless of its rate. Tasks that are due but don't fit move
+// up in the order each frame they are skipped and run anyway once they have
+// waited STARVE_FRAMES frames. Critical tasks run every time they are due.
+//
+// The cost of each task is measured and logged under the IdleScheduler tag.
+// Disabled with FSIdleScheduler, then every due task runs without a budget.
+class FSIdleScheduler : public LLSingleton<FSIdleScheduler>
+{
+    LLSINGLETON(FSIdleScheduler);
+    ~FSIdleScheduler();
+
+public:
+    enum EPriority
+    {
+        PRIORITY_CRITICAL = 0,  // never skipped
+        PRIORITY_HIGH,
+        PRIORITY_NORMAL,
+        PRIORITY_LOW,
+        PRIORITY_COUNT
+    };
+
+    // Gets the seconds it should take at most, returns true when it has
+    // more work
+    typedef std::function<bool(F32 budget)> task_t;
+    typedef U32 handle_t;
+
+    static constexpr U32 STARVE_FRAMES = 30;
+
+    // Threads:  Tmain
+    // rate is in calls per second, 0 for every frame. A budget of 0 lets
+    // the task have whatever is left of the frame budget.
+    handle_t addTask(const std::string& name, EPriority priority, F32 rate, F32 budget_ms, const task_t& task);
+    void removeTask(handle_t handle);
+
+    // Threads:  Tmain
+    // Once a frame from LLAppViewer::idle()
+    void run();
+
+    // Threads:  Tmain
+    // Time the main loop slept this frame, which is left over frame time
+    static void recordSleep(F32 seconds) { sSleepTime += seconds; }
+
+    // Threads:  Tmain
+    void logStats() const;
+
+private:
+    struct Task
+    {
+        handle_t    mHandle;
+        std::string mName;
+        EPriority   mPriority;
+        F64         mInterval;  // seconds, 0 for every frame
+        F32         mBudget;    // seconds, 0 for no limit of its own
+        task_t      mTask;
+
+        F64         mNextRun;
+        U32         mSkipped;   // frames it was due and didn't run
+        bool        mPending;   // has more work
+        bool        mRemoved;
+
+        // Cost
+        U64         mCalls;
+        U64         mSkips;
+        F64         mTotalTime;
+        F32         mAverage;   // seconds per call, moving average
+        F32         mMax;
+    };
+
+    F32 computeBudget();
+
+    std::vector<Task>   mTasks;
+    std::vector<Task>   mAddedTasks;    // while running, added after
+    std::vector<size_t> mOrder;         // scratch of run()
+    handle_t            mNextHandle;
+    F32                 mFrameBudget;   // seconds, smoothed
+    F32                 mLastSpent;     // seconds run() took last frame
+    LLFrameTimer        mStatsTimer;
+    bool                mRunning;
+    bool                mHasRemoved;
+
+    static F32          sSleepTime;
+};
+
+#endif // FS_FSIDLESCHEDULER_H
@@ -0,0 +1,322 @@
+/**
+ * @file fsimpostoratlas.cpp
+ * @brief Shared atlas pages for avatar impostors
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsimpostoratlas.h"
+
+#include "llrender.h"
+#include "pipeline.h"
+
+#include <algorithm>
+
+// Same attachments as the impostor targets of the avatars themselves
+bool addDeferredAttachments(LLRenderTarget& target, bool for_impostor);
+
+FSImpostorAtlas::FSImpostorAtlas()
+:   mGeneration(0)
+{
+}
+
+FSImpostorAtlas::~FSImpostorAtlas()
+{
+    // The page render targets are freed in release(), which
+    // LLPipeline::releaseGLBuffers() and LLPipeline::cleanup() call, so
+    // the LLRenderTarget destructors find nothing left to delete.
+}
+
+bool FSImpostorAtlas::allocate(Slot& slot, U32 width, U32 height)
+{
+    if (isValid(slot) && slot.mWidth == width && slot.mHeight == height)
+    {
+        return true;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+    free(slot);
+
+    width = llclamp(width, 1U, PAGE_SIZE);
+    height = llclamp(height, 1U, PAGE_SIZE);
+
+    Rect rect;
+    S32 found = -1;
+
+    // A freed slot of the same size first, then room on a shelf of an allocated page
+    for (size_t i = 0; i < mPages.size() && found < 0; ++i)
+    {
+        Page& page = *mPages[i];
+        if (!page.mTarget.isComplete())
+        {
+            continue;
+        }
+
+        for (auto iter = page.mFree.begin(); iter != page.mFree.end(); ++iter)
+        {
+            if (iter->mWidth == width && iter->mHeight == height)
+            {
+                rect = *iter;
+                page.mFree.erase(iter);
+                found = (S32)i;
+                break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < mPages.size() && found < 0; ++i)
+    {
+        Page& page = *mPages[i];
+        if (page.mTarget.isComplete() && place(page, width, height, rect))
+        {
+            found = (S32)i;
+        }
+    }
+
+    if (found < 0)
+    { // a released page, or a new one
+        for (size_t i = 0; i < mPages.size() && found < 0; ++i)
+        {
+            if (!mPages[i]->mTarget.isComplete())
+            {
+                found = (S32)i;
+            }
+        }
+
+        if (found < 0)
+        {
+            mPages.emplace_back(new Page());
+            found = (S32)mPages.size() - 1;
+        }
+
+        Page& page = *mPages[found];
+        if (!allocatePage(page) || !place(page, width, height, rect))
+        {
+            page.mTarget.release();
+            return false;
+        }
+    }
+
+    ++mPages[found]->mSlots;
+
+    slot.mPage = found;
+    slot.mX = rect.mX;
+    slot.mY = rect.mY;
+    slot.mWidth = rect.mWidth;
+    slot.mHeight = rect.mHeight;
+    slot.mGeneration = mGeneration;
+    return true;
+}
+
+void FSImpostorAtlas::free(Slot& slot)
+{
+    if (isValid(slot))
+    {
+        Page& page = *mPages[slot.mPage];
+        page.mFree.push_back({ slot.mX, slot.mY, slot.mWidth, slot.mHeight });
+
+        if (--page.mSlots == 0)
+        { // empty, give the memory back
+            page.mTarget.release();
+            page.mShelves.clear();
+            page.mFree.clear();
+            page.mUsedHeight = 0;
+        }
+    }
+
+    slot = Slot();
+}
+
+bool FSImpostorAtlas::isValid(const Slot& slot) const
+{
+    return slot.mPage >= 0
+        && slot.mGeneration == mGeneration
+        && slot.mPage < (S32)mPages.size()
+        && mPages[slot.mPage]->mTarget.isComplete();
+}
+
+LLRenderTarget* FSImpostorAtlas::getTarget(const Slot& slot)
+{
+    if (!isValid(slot))
+    {
+        return nullptr;
+    }
+
+    LLRenderTarget& target = mPages[slot.mPage]->mTarget;
+    target.setViewport(slot.mX, slot.mY, slot.mWidth, slot.mHeight);
+    return &target;
+}
+
+void FSImpostorAtlas::queue(const Slot& slot, const LLColor4U& color,
+                            const LLVector3& bottom_left, const LLVector3& bottom_right,
+                            const LLVector3& top_right, const LLVector3& top_left)
+{
+    if (!isValid(slot))
+    {
+        return;
+    }
+
+    Quad quad;
+    quad.mPage = slot.mPage;
+    quad.mColor = color;
+    quad.mCorners[0] = bottom_left;
+    quad.mCorners[1] = bottom_right;
+    quad.mCorners[2] = top_right;
+    quad.mCorners[3] = top_left;
+    quad.mTexCoords[0] = (F32)slot.mX / (F32)PAGE_SIZE;
+    quad.mTexCoords[1] = (F32)slot.mY / (F32)PAGE_SIZE;
+    quad.mTexCoords[2] = (F32)(slot.mX + slot.mWidth) / (F32)PAGE_SIZE;
+    quad.mTexCoords[3] = (F32)(slot.mY + slot.mHeight) / (F32)PAGE_SIZE;
+    mQueue.push_back(quad);
+}
+
+void FSImpostorAtlas::drawQueued(S32 diffuse_channel, S32 specular_channel, S32 normal_channel)
+{
+    if (mQueue.empty())
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+
+    std::stable_sort(mQueue.begin(), mQueue.end(), [](const Quad& a, const Quad& b) { return a.mPage < b.mPage; });
+
+    gGL.flush();
+
+    size_t start = 0;
+    while (start < mQueue.size())
+    {
+        size_t end = start;
+        while (end < mQueue.size() && mQueue[end].mPage == mQueue[start].mPage)
+        {
+            ++end;
+        }
+
+        LLRenderTarget& target = mPages[mQueue[start].mPage]->mTarget;
+        if (target.isComplete())
+        {
+            U32 num_tex = target.getNumTextures();
+            if (normal_channel > -1 && num_tex >= 3)
+            {
+                target.bindTexture(2, normal_channel);
+            }
+            if (specular_channel > -1 && num_tex >= 2)
+            {
+                target.bindTexture(1, specular_channel);
+            }
+            gGL.getTexUnit(diffuse_channel)->bind(&target);
+
+            gGL.begin(LLRender::TRIANGLES);
+            for (size_t i = start; i < end; ++i)
+            {
+                const Quad& quad = mQueue[i];
+                const F32* tc = quad.mTexCoords;
+
+                gGL.color4ubv(quad.mColor.mV);
+
+                gGL.texCoord2f(tc[0], tc[1]);
+                gGL.vertex3fv(quad.mCorners[0].mV);
+                gGL.texCoord2f(tc[2], tc[1]);
+                gGL.vertex3fv(quad.mCorners[1].mV);
+                gGL.texCoord2f(tc[2], tc[3]);
+                gGL.vertex3fv(quad.mCorners[2].mV);
+
+                gGL.texCoord2f(tc[0], tc[1]);
+                gGL.vertex3fv(quad.mCorners[0].mV);
+                gGL.texCoord2f(tc[2], tc[3]);
+                gGL.vertex3fv(quad.mCorners[2].mV);
+                gGL.texCoord2f(tc[0], tc[3]);
+                gGL.vertex3fv(quad.mCorners[3].mV);
+            }
+            gGL.end();
+            gGL.flush();
+        }
+
+        start = end;
+    }
+
+    mQueue.clear();
+}
+
+void FSImpostorAtlas::release()
+{
+    for (auto& page : mPages)
+    {
+        page->mTarget.release();
+    }
+    mPages.clear();
+    mQueue.clear();
+
+    // Slots still held by avatars are stale from here on
+    ++mGeneration;
+}
+
+bool FSImpostorAtlas::place(Page& page, U32 width, U32 height, Rect& rect)
+{
+    for (Shelf& shelf : page.mShelves)
+    {
+        if (shelf.mHeight == height && PAGE_SIZE - shelf.mUsedWidth >= width)
+        {
+            rect = { shelf.mUsedWidth, shelf.mY, width, height };
+            shelf.mUsedWidth += width;
+            return true;
+        }
+    }
+
+    if (PAGE_SIZE - page.mUsedHeight >= height)
+    {
+        page.mShelves.push_back({ page.mUsedHeight, height, width });
+        rect = { 0, page.mUsedHeight, width, height };
+        page.mUsedHeight += height;
+        return true;
+    }
+
+    return false;
+}
+
+bool FSImpostorAtlas::allocatePage(Page& page)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+
+    page.mShelves.clear();
+    page.mFree.clear();
+    page.mUsedHeight = 0;
+    page.mSlots = 0;
+
+    if (!page.mTarget.allocate(PAGE_SIZE, PAGE_SIZE, GL_RGBA, true))
+    {
+        return false;
+    }
+
+    if (LLPipeline::sRenderDeferred && !addDeferredAttachments(page.mTarget, true))
+    {
+        return false;
+    }
+
+    gGL.getTexUnit(0)->bind(&page.mTarget);
+    gGL.getTexUnit(0)->setTextureFilteringOption(LLTexUnit::TFO_POINT);
+    gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+    return true;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file fsimpostoratlas.h
+ * @brief Shared atlas pages for avatar impostors
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSIMPOSTORATLAS_H
+#define FS_FSIMPOSTORATLAS_H
+
+#include "llcolor4u.h"
+#include "llrendertarget.h"
+#include "v3math.h"
+
+#include <memory>
+#include <vector>
+
+// Avatar impostors packed into shared render targets instead of one target
+// per avatar. Impostors are power of two sized, up to 512x512, and are
+// placed on shelves of their own height in pages of PAGE_SIZE squared, a
+// new page being allocated when none has room. Freed slots are reused by
+// impostors of the same size and a page is released once it holds none.
+//
+// Drawing is batched the same way: impostors queue their quad while the
+// avatar pool walks its avatars and the queue is drawn at the end of the
+// pass, one draw per page instead of one per avatar.
+class FSImpostorAtlas
+{
+public:
+    static constexpr U32 PAGE_SIZE = 2048;
+
+    struct Slot
+    {
+        S32 mPage = -1;
+        U32 mX = 0;
+        U32 mY = 0;
+        U32 mWidth = 0;
+        U32 mHeight = 0;
+        U32 mGeneration = 0;    // slots of an earlier generation were dropped by release()
+    };
+
+    FSImpostorAtlas();
+    ~FSImpostorAtlas();
+
+    // Threads:  Tmain
+    // Make slot width x height, keeping it when it already is. Returns false
+    // when no page could be allocated, slot is then free.
+    bool allocate(Slot& slot, U32 width, U32 height);
+
+    // Threads:  Tmain
+    // Safe to call on free slots and on slots of an earlier generation
+    void free(Slot& slot);
+
+    bool isValid(const Slot& slot) const;
+
+    // Threads:  Tmain
+    // The page of slot with its viewport set to the slot, for bindTarget,
+    // clear and flush as with a target of its own
+    LLRenderTarget* getTarget(const Slot& slot);
+
+    // Threads:  Tmain
+    // Queue the impostor in slot as the quad bottom_left, bottom_right,
+    // top_right, top_left
+    void queue(const Slot& slot, const LLColor4U& color,
+               const LLVector3& bottom_left, const LLVector3& bottom_right,
+               const LLVector3& top_right, const LLVector3& top_left);
+
+    // Threads:  Tmain
+    // Draw the queued impostors with the bound shader, page by page. Channels
+    // below 0 are not bound.
+    void drawQueued(S32 diffuse_channel, S32 specular_channel, S32 normal_channel);
+
+    void release();
+
+private:
+    struct Shelf
+    {
+        U32 mY;
+        U32 mHeight;
+        U32 mUsedWidth;
+    };
+
+    struct Rect
+    {
+        U32 mX;
+        U32 mY;
+        U32 mWidth;
+        U32 mHeight;
+    };
+
+    struct Page
+    {
+        LLRenderTarget      mTarget;
+        std::vector<Shelf>  mShelves;
+        std::vector<Rect>   mFree;      // freed slots, reused by impostors of the same size
+        U32                 mUsedHeight = 0;
+        U32                 mSlots = 0;
+    };
+
+    struct Quad
+    {
+        S32         mPage;
+        LLColor4U   mColor;
+        LLVector3   mCorners[4];
+        F32         mTexCoords[4];  // left, bottom, right, top
+    };
+
+    bool place(Page& page, U32 width, U32 height, Rect& rect);
+    bool allocatePage(Page& page);
+
+    std::vector<std::unique_ptr<Page>>  mPages;
+    std::vector<Quad>                   mQueue;
+    U32                                 mGeneration;
+};
+
+#endif // FS_FSIMPOSTORATLAS_H
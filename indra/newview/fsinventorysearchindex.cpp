@@ -0,0 +1,275 @@
+/**
+ * @file fsinventorysearchindex.cpp
+ * @brief Trigram index of inventory names
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsinventorysearchindex.h"
+
+#include "llinventorymodel.h"
+#include "llinventoryobserver.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Compact once this many slots are dead and they outnumber the live ones
+    constexpr U32 MIN_DEAD_SLOTS_TO_COMPACT = 1024;
+
+    inline U32 trigram_at(const std::string& text, size_t pos)
+    {
+        return ((U32)(U8)text[pos] << 16) | ((U32)(U8)text[pos + 1] << 8) | (U32)(U8)text[pos + 2];
+    }
+
+    void collect_trigrams(const std::string& text, std::vector<U32>& trigrams)
+    {
+        trigrams.clear();
+        for (size_t pos = 0; pos + 3 <= text.size(); ++pos)
+        {
+            trigrams.push_back(trigram_at(text, pos));
+        }
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    }
+}
+
+FSInventorySearchIndex::FSInventorySearchIndex(LLInventoryModel* model) :
+    mModel(model),
+    mDeadSlots(0),
+    mRevision(0),
+    mBuilt(false)
+{
+}
+
+void FSInventorySearchIndex::clear()
+{
+    mSlots.clear();
+    mSlotOf.clear();
+    mPostings.clear();
+    mDeadSlots = 0;
+    ++mRevision;
+    mBuilt = false;
+}
+
+void FSInventorySearchIndex::onChanged(U32 mask, const std::set<LLUUID>& ids)
+{
+    if (!mBuilt)
+    {
+        return;
+    }
+
+    if (ids.empty() && mask == LLInventoryObserver::ALL)
+    {
+        // Full refresh, rebuild with the next query
+        clear();
+        return;
+    }
+
+    for (const LLUUID& id : ids)
+    {
+        const LLInventoryObject* obj = mModel->getObject(id);
+        if (!obj)
+        {
+            remove(id);
+            continue;
+        }
+
+        std::string name(obj->getName());
+        LLStringUtil::toUpper(name);
+        auto it = mSlotOf.find(id);
+        if (it != mSlotOf.end() && mSlots[it->second].mName == name)
+        {
+            continue;
+        }
+        remove(id);
+        add(id, name);
+    }
+
+    if (mDeadSlots >= MIN_DEAD_SLOTS_TO_COMPACT && mDeadSlots * 2 > mSlots.size())
+    {
+        compact();
+    }
+}
+
+bool FSInventorySearchIndex::query(const std::string& pattern, Candidates& candidates)
+{
+    if (pattern.size() < 3)
+    {
+        return false;
+    }
+    if (!mBuilt)
+    {
+        build();
+        if (!mBuilt)
+        {
+            return false;
+        }
+    }
+
+    candidates.mRevision = mRevision;
+    candidates.mSlots.assign(mSlots.size(), false);
+
+    std::vector<U32> trigrams;
+    collect_trigrams(pattern, trigrams);
+
+    std::vector<const posting_list_t*> lists;
+    lists.reserve(trigrams.size());
+    for (U32 trigram : trigrams)
+    {
+        auto it = mPostings.find(trigram);
+        if (it == mPostings.end())
+        {
+            // Nothing contains this one, so nothing is a candidate
+            return true;
+        }
+        lists.push_back(&it->second);
+    }
+
+    std::sort(lists.begin(), lists.end(), [](const posting_list_t* a, const posting_list_t* b)
+    {
+        return a->size() < b->size();
+    });
+
+    std::vector<U32> matches(lists.front()->begin(), lists.front()->end());
+    std::vector<U32> intersection;
+    for (size_t i = 1; i < lists.size() && !matches.empty(); ++i)
+    {
+        intersection.clear();
+        std::set_intersection(matches.begin(), matches.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(intersection));
+        matches.swap(intersection);
+    }
+
+    for (U32 slot : matches)
+    {
+        candidates.mSlots[slot] = true;
+    }
+    return true;
+}
+
+bool FSInventorySearchIndex::canReject(const LLUUID& id, const std::string& name, const Candidates& candidates) const
+{
+    if (candidates.mRevision != mRevision)
+    {
+        return false;
+    }
+
+    auto it = mSlotOf.find(id);
+    if (it == mSlotOf.end() || it->second >= candidates.mSlots.size() || candidates.mSlots[it->second])
+    {
+        return false;
+    }
+    return mSlots[it->second].mName == name;
+}
+
+void FSInventorySearchIndex::build()
+{
+    if (!mModel->isInventoryUsable())
+    {
+        return;
+    }
+
+    clear();
+
+    LLInventoryModel::cat_array_t cats;
+    LLInventoryModel::item_array_t items;
+    const LLUUID roots[] = { mModel->getRootFolderID(), mModel->getLibraryRootFolderID() };
+    for (const LLUUID& root_id : roots)
+    {
+        if (LLViewerInventoryCategory* root = mModel->getCategory(root_id))
+        {
+            cats.push_back(root);
+            mModel->collectDescendents(root_id, cats, items, LLInventoryModel::INCLUDE_TRASH);
+        }
+    }
+
+    mSlots.reserve(cats.size() + items.size());
+    mSlotOf.reserve(cats.size() + items.size());
+    std::string name;
+    for (const LLViewerInventoryCategory* cat : cats)
+    {
+        name = cat->getName();
+        LLStringUtil::toUpper(name);
+        add(cat->getUUID(), name);
+    }
+    for (const LLViewerInventoryItem* item : items)
+    {
+        name = item->getName();
+        LLStringUtil::toUpper(name);
+        add(item->getUUID(), name);
+    }
+
+    mBuilt = true;
+    LL_DEBUGS("Inventory") << "Indexed " << mSlots.size() << " names with " << mPostings.size() << " trigrams" << LL_ENDL;
+}
+
+void FSInventorySearchIndex::add(const LLUUID& id, const std::string& name)
+{
+    const U32 slot = (U32)mSlots.size();
+    mSlots.push_back({ id, name });
+    mSlotOf[id] = slot;
+
+    std::vector<U32> trigrams;
+    collect_trigrams(name, trigrams);
+    for (U32 trigram : trigrams)
+    {
+        mPostings[trigram].push_back(slot);
+    }
+}
+
+void FSInventorySearchIndex::remove(const LLUUID& id)
+{
+    auto it = mSlotOf.find(id);
+    if (it == mSlotOf.end())
+    {
+        return;
+    }
+
+    // Stays in the posting lists until the next compaction
+    Slot& slot = mSlots[it->second];
+    slot.mID.setNull();
+    slot.mName.clear();
+    mSlotOf.erase(it);
+    ++mDeadSlots;
+}
+
+void FSInventorySearchIndex::compact()
+{
+    slots_t slots;
+    slots.swap(mSlots);
+    mSlotOf.clear();
+    mPostings.clear();
+    mDeadSlots = 0;
+    ++mRevision;
+
+    mSlots.reserve(slots.size() / 2);
+    for (const Slot& slot : slots)
+    {
+        if (slot.mID.notNull())
+        {
+            add(slot.mID, slot.mName);
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/**
+ * @file fsinventorysearchindex.h
+ * @brief Trigram index of inventory names
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSINVENTORYSEARCHINDEX_H
+#define FS_FSINVENTORYSEARCHINDEX_H
+
+#include "llmemory.h"
+#include "lluuid.h"
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class LLInventoryModel;
+
+// Upper case names of the items and categories of an inventory model,
+// indexed by the three byte sequences (trigrams) they contain. A search
+// pattern can only occur in names that contain all of its trigrams, so
+// the index hands out a candidate set per pattern and everything outside
+// of it is known not to match.
+//
+// The index is built with the first query and kept up to date from
+// LLInventoryModel::notifyObservers() before any observer runs. Renamed
+// and removed objects leave a dead slot behind; slots are compacted once
+// more than half of them are dead. Its storage is accounted to
+// LLMemTag::INVENTORY.
+class FSInventorySearchIndex
+{
+public:
+    // Result of query(), one flag per slot at the time of the query
+    struct Candidates
+    {
+        std::vector<bool>   mSlots;
+        U32                 mRevision = 0;
+    };
+
+    FSInventorySearchIndex(LLInventoryModel* model);
+
+    // Changed ids of the model, with the mask of the notification
+    void onChanged(U32 mask, const std::set<LLUUID>& ids);
+    void clear();
+
+    // Fills candidates for an upper case pattern. False if the pattern is
+    // too short to be indexed or the inventory isn't usable yet.
+    bool query(const std::string& pattern, Candidates& candidates);
+
+    // True if id was indexed with exactly this name and isn't a candidate,
+    // i.e. the name doesn't contain the pattern of the query. Names that
+    // differ from the indexed one, like those with a label suffix, and
+    // objects added since the query return false.
+    bool canReject(const LLUUID& id, const std::string& name, const Candidates& candidates) const;
+
+    // Revision changes whenever slots are compacted; candidates of an older
+    // revision are meaningless.
+    U32 getRevision() const { return mRevision; }
+
+private:
+    void build();
+    void add(const LLUUID& id, const std::string& name);
+    void remove(const LLUUID& id);
+    void compact();
+
+    struct Slot
+    {
+        LLUUID      mID;        // null when dead
+        std::string mName;      // upper case
+    };
+
+    template <typename T>
+    using alloc_t = LLTaggedAllocator<T, LLMemTag::INVENTORY>;
+    typedef std::vector<Slot, alloc_t<Slot>> slots_t;
+    typedef std::vector<U32, alloc_t<U32>> posting_list_t;
+
+    LLInventoryModel*                       mModel;
+    slots_t                                 mSlots;
+    std::unordered_map<LLUUID, U32, std::hash<LLUUID>, std::equal_to<LLUUID>,
+                       alloc_t<std::pair<const LLUUID, U32>>> mSlotOf;
+    // Trigram to slots, ascending since slots are only ever appended
+    std::unordered_map<U32, posting_list_t, std::hash<U32>, std::equal_to<U32>,
+                       alloc_t<std::pair<const U32, posting_list_t>>> mPostings;
+    U32                                     mDeadSlots;
+    U32                                     mRevision;
+    bool                                    mBuilt;
+};
+
+#endif // FS_FSINVENTORYSEARCHINDEX_H
@@ -36,6 +36,7 @@
 #include "fslslpreproc.h"
 
 #include "fslslpreprocviewer.h"
+#include "hbxxh.h"
 #include "llagent.h"
 #include "llappviewer.h"
 #include "llcompilequeue.h"
@@ -44,6 +45,9 @@
 #include "llnotificationsutil.h"
 #include "lltrans.h"
 #include "llviewercontrol.h"
+#include "workqueue.h"
+
+#include <mutex>
 
 #ifdef __GNUC__
 // There is a sprintf( ... "%d", size_t_value) buried inside boost::wave. In order to not mess with system header, I rather disable that warning here.
@@ -133,6 +137,204 @@ using namespace boost::regex_constants;
 #define rCMNT_OR_STR rCMNT "|\"(?:[^\"\\\\]|\\\\[^\\n])*+\"" // skip over strings as a block too
 #define rDOT_MATCHES_NEWLINE "(?s)"
 
+// Everything a preprocessing run needs, gathered on the main thread so the run
+// itself can happen on the General queue without touching the viewer.
+struct FSLSLPreprocJob
+{
+    void message(const std::string& msg) { mMessages.emplace_back(false, msg); }
+    void error(const std::string& err) { mMessages.emplace_back(true, err); }
+
+    bool mEnabled = true;
+    std::string mInput;
+    std::string mRawInput;
+    std::string mName;
+    std::vector<std::string> mIncludePaths;
+    std::vector<std::string> mSysIncludePaths;
+    std::vector<std::string> mMacros;
+    std::map<std::string, LLUUID> mAssetIDs;
+    std::set<std::string> mResolvedIncludes;
+    bool mLazyLists = false;
+    bool mSwitch = false;
+    bool mOptimizer = false;
+    bool mCompression = false;
+    bool mDefinitionCaching = false;
+
+    std::string mOutput;
+    std::vector<std::pair<bool, std::string>> mMessages;    // true for errors
+    std::set<std::string> mUnresolvedIncludes;
+    bool mErrored = false;
+    bool mLackDefault = false;
+};
+
+namespace
+{
+    // Wave output of recent runs, keyed by a hash of the script and the
+    // preprocessor setup. Include files are checked against the content hash
+    // they had when the entry was made, so editing one invalidates only the
+    // scripts that use it.
+    struct WaveCacheEntry
+    {
+        std::string mOutput;
+        bool mLazyLists = false;
+        bool mSwitch = false;
+        std::map<std::string, LLUUID> mIncludes;                    // name, asset id
+        std::vector<std::pair<std::string, LLUUID>> mFiles;         // path, content hash
+        U64 mLastUsed = 0;
+    };
+
+    constexpr size_t WAVE_CACHE_SIZE = 32;
+
+    std::mutex sWaveCacheMutex;
+    std::map<LLUUID, WaveCacheEntry> sWaveCache;
+    U64 sWaveCacheClock = 0;
+
+    // Spirit is built without BOOST_SPIRIT_THREADSAFE, the wave grammars must
+    // not be used by two threads at once
+    std::mutex sWaveMutex;
+
+    // Output using these changes from one run to the next
+    const char* TIME_MACROS[] = { "__UNIXTIME__", "__DATE__", "__TIME__" };
+
+    bool uses_time_macros(const std::string& text)
+    {
+        for (const char* macro : TIME_MACROS)
+        {
+            if (text.find(macro) != std::string::npos)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool read_include_file(const std::string& path, std::string& content)
+    {
+        llifstream file(path.c_str(), std::ios::in | std::ios::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    LLUUID wave_cache_key(const FSLSLPreprocJob& job)
+    {
+        HBXXH128 hash;
+        hash.update(job.mInput);
+        hash.update(job.mName);
+        for (const std::string& path : job.mIncludePaths)
+        {
+            hash.update(path);
+        }
+        hash.update("|", 1);
+        for (const std::string& path : job.mSysIncludePaths)
+        {
+            hash.update(path);
+        }
+        for (const std::string& macro : job.mMacros)
+        {
+            if (macro.rfind("__UNIXTIME__=", 0) != 0)
+            {
+                hash.update(macro);
+            }
+        }
+        return hash.digest();
+    }
+
+    // Returns true when the job got its wave output, or the includes it needs
+    // resolved first, from the cache
+    bool find_in_wave_cache(const LLUUID& key, FSLSLPreprocJob& job, bool& lazy_lists, bool& use_switch)
+    {
+        WaveCacheEntry entry;
+        {
+            std::lock_guard<std::mutex> lock(sWaveCacheMutex);
+            auto it = sWaveCache.find(key);
+            if (it == sWaveCache.end())
+            {
+                return false;
+            }
+            it->second.mLastUsed = ++sWaveCacheClock;
+            entry = it->second;
+        }
+
+        for (const auto& [name, asset_id] : entry.mIncludes)
+        {
+            if (job.mResolvedIncludes.find(name) == job.mResolvedIncludes.end())
+            {
+                job.mUnresolvedIncludes.insert(name);
+                continue;
+            }
+            auto it = job.mAssetIDs.find(name);
+            if ((it != job.mAssetIDs.end() ? it->second : LLUUID::null) != asset_id)
+            {
+                return false;
+            }
+        }
+        if (!job.mUnresolvedIncludes.empty())
+        {
+            // The main thread looks them up and fetches what changed, the
+            // next run checks the files again
+            return true;
+        }
+
+        std::string content;
+        for (const auto& [path, hash] : entry.mFiles)
+        {
+            if (!read_include_file(path, content) || HBXXH128::digest(content) != hash)
+            {
+                return false;
+            }
+        }
+
+        LL_DEBUGS("FSLSLPreprocessor") << "Wave output of " << job.mName << " found in cache" << LL_ENDL;
+        job.mOutput = std::move(entry.mOutput);
+        lazy_lists = entry.mLazyLists;
+        use_switch = entry.mSwitch;
+        return true;
+    }
+
+    void add_to_wave_cache(const LLUUID& key, const FSLSLPreprocJob& job, const std::set<std::string>& includes,
+                           const std::set<std::string>& files, bool lazy_lists, bool use_switch)
+    {
+        if (uses_time_macros(job.mInput))
+        {
+            return;
+        }
+
+        WaveCacheEntry entry;
+        std::string content;
+        for (const std::string& path : files)
+        {
+            if (!read_include_file(path, content) || uses_time_macros(content))
+            {
+                return;
+            }
+            entry.mFiles.emplace_back(path, HBXXH128::digest(content));
+        }
+        for (const std::string& name : includes)
+        {
+            auto it = job.mAssetIDs.find(name);
+            entry.mIncludes[name] = (it != job.mAssetIDs.end()) ? it->second : LLUUID::null;
+        }
+        entry.mOutput = job.mOutput;
+        entry.mLazyLists = lazy_lists;
+        entry.mSwitch = use_switch;
+
+        std::lock_guard<std::mutex> lock(sWaveCacheMutex);
+        entry.mLastUsed = ++sWaveCacheClock;
+        sWaveCache[key] = std::move(entry);
+        if (sWaveCache.size() > WAVE_CACHE_SIZE)
+        {
+            auto oldest = std::min_element(sWaveCache.begin(), sWaveCache.end(), [](const auto& a, const auto& b)
+            {
+                return a.second.mLastUsed < b.second.mLastUsed;
+            });
+            sWaveCache.erase(oldest);
+        }
+    }
+}
+
 std::string FSLSLPreprocessor::encode(const std::string& script)
 {
     std::string otext = FSLSLPreprocessor::decode(script);
@@ -310,7 +512,8 @@ static void shredder(std::string& text)
     while (cursor < S32(text.length()));
 }
 
-std::string FSLSLPreprocessor::lslopt(std::string script)
+// static
+std::string FSLSLPreprocessor::lslopt(std::string script, FSLSLPreprocJob& job)
 {
     try
     {
@@ -483,7 +686,7 @@ std::string FSLSLPreprocessor::lslopt(std::string script)
         args["[WHAT]"] = e.what();
         std::string err = LLTrans::getString("fs_preprocessor_optimizer_regex_err", args);
         LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
-        display_error(err);
+        job.error(err);
         throw;
     }
     catch (std::exception& e)
@@ -492,14 +695,15 @@ std::string FSLSLPreprocessor::lslopt(std::string script)
         args["[WHAT]"] = e.what();
         std::string err = LLTrans::getString("fs_preprocessor_optimizer_exception", args);
         LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
-        display_error(err);
+        job.error(err);
         throw;
     }
 
     return script;
 }
 
-std::string FSLSLPreprocessor::lslcomp(std::string script)
+// static
+std::string FSLSLPreprocessor::lslcomp(std::string script, FSLSLPreprocJob& job)
 {
     try
     {
@@ -512,7 +716,7 @@ std::string FSLSLPreprocessor::lslcomp(std::string script)
         args["[WHAT]"] = e.what();
         std::string err = LLTrans::getString("fs_preprocessor_compress_regex_err", args);
         LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
-        display_error(err);
+        job.error(err);
         throw;
     }
     catch (std::exception& e)
@@ -521,7 +725,7 @@ std::string FSLSLPreprocessor::lslcomp(std::string script)
         args["[WHAT]"] = e.what();
         std::string err = LLTrans::getString("fs_preprocessor_compress_exception", args);
         LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
-        display_error(err);
+        job.error(err);
         throw;
     }
     return script;
@@ -542,73 +746,26 @@ static inline std::string shortfile(const std::string& in)
 class trace_include_files : public boost::wave::context_policies::default_preprocessing_hooks
 {
 public:
-    trace_include_files(FSLSLPreprocessor* proc)
-    :   mProc(proc)
+    trace_include_files(FSLSLPreprocJob& job)
+    :   mJob(job)
     {
         mAssetStack.push(LLUUID::null.asString());
-        mFileStack.push(proc->mMainScriptName);
+        mFileStack.push(job.mName);
     }
 
+    // Inventory can only be looked at on the main thread. An include that
+    // was not looked up yet is skipped and the run stops; the main thread
+    // resolves it, fetching the script if needed, and starts over.
     template <typename ContextT>
     bool found_include_directive(ContextT const& ctx, std::string const &filename, bool include_next)
     {
         std::string cfilename = filename.substr(1, filename.length() - 2);
         LL_DEBUGS("FSLSLPreprocessor") << cfilename << ":found_include_directive" << LL_ENDL;
-        std::optional<LLUUID> item_id = FSLSLPreprocessor::findInventoryByName(cfilename);
-        if (item_id.has_value())
+        mIncludes.insert(cfilename);
+        if (mJob.mResolvedIncludes.find(cfilename) == mJob.mResolvedIncludes.end())
         {
-            LLViewerInventoryItem* item = gInventory.getItem(item_id.value());
-            if (item)
-            {
-                std::map<std::string,LLUUID>::iterator it = mProc->cached_assetids.find(cfilename);
-                bool not_cached = (it == mProc->cached_assetids.end());
-                bool changed = true;
-                if (!not_cached)
-                {
-                    changed = (mProc->cached_assetids[cfilename] != item->getAssetUUID());
-                }
-                if (not_cached || changed)
-                {
-                    std::set<std::string>::iterator it = mProc->caching_files.find(cfilename);
-                    if (it == mProc->caching_files.end())
-                    {
-                        if (not_cached)
-                        {
-                            LLStringUtil::format_map_t args;
-                            args["[FILENAME]"] = cfilename;
-                            mProc->display_message(LLTrans::getString("fs_preprocessor_cache_miss", args));
-                        }
-                        else /*if(changed)*/
-                        {
-                            LLStringUtil::format_map_t args;
-                            args["[FILENAME]"] = cfilename;
-                            mProc->display_message(LLTrans::getString("fs_preprocessor_cache_invalidated", args));
-                        }
-                        //one is always true
-                        mProc->caching_files.insert(cfilename);
-                        ProcCacheInfo* info = new ProcCacheInfo;
-                        info->item = item;
-                        info->self = mProc;
-                        LLPermissions perm(((LLInventoryItem*)item)->getPermissions());
-                        gAssetStorage->getInvItemAsset(LLHost(),
-                                                        gAgentID,
-                                                        gAgentSessionID,
-                                                        perm.getOwner(),
-                                                        LLUUID::null,
-                                                        item->getUUID(),
-                                                        LLUUID::null,
-                                                        item->getType(),
-                                                        &FSLSLPreprocessor::FSProcCacheCallback,
-                                                        info,
-                                                        true);
-                        return true;
-                    }
-                }
-            }
-        }
-        else
-        {
-            //todo check on HDD in user defined dir for file in question
+            mJob.mUnresolvedIncludes.insert(cfilename);
+            return true;
         }
         return false;
     }
@@ -621,10 +778,11 @@ public:
         ContextT& usefulctx = const_cast<ContextT&>(ctx);
         std::string id;
         std::string filename = shortfile(relname);
-        std::map<std::string, LLUUID>::iterator it = mProc->cached_assetids.find(filename);
-        if (it != mProc->cached_assetids.end())
+        mFiles.insert(absname);
+        std::map<std::string, LLUUID>::iterator it = mJob.mAssetIDs.find(filename);
+        if (it != mJob.mAssetIDs.end())
         {
-            id = mProc->cached_assetids[filename].asString();
+            id = it->second.asString();
         }
         else
         {
@@ -683,8 +841,13 @@ public:
         }
     }
 
+    const std::set<std::string>& getIncludes() const { return mIncludes; }
+    const std::set<std::string>& getFiles() const { return mFiles; }
+
 private:
-    FSLSLPreprocessor* mProc;
+    FSLSLPreprocJob& mJob;
+    std::set<std::string> mIncludes;
+    std::set<std::string> mFiles;
     std::stack<std::string> mAssetStack;
     std::stack<std::string> mFileStack;
 };
@@ -773,12 +936,60 @@ void FSLSLPreprocessor::FSProcCacheCallback(const LLUUID& iuuid, LLAssetType::ET
     }
 }
 
+void FSLSLPreprocessor::resolve_include(const std::string& name)
+{
+    mResolvedIncludes.insert(name);
+
+    std::optional<LLUUID> item_id = findInventoryByName(name);
+    if (!item_id.has_value())
+    {
+        //todo check on HDD in user defined dir for file in question
+        return;
+    }
+
+    LLViewerInventoryItem* item = gInventory.getItem(item_id.value());
+    if (!item)
+    {
+        return;
+    }
+
+    std::map<std::string, LLUUID>::iterator it = cached_assetids.find(name);
+    bool not_cached = (it == cached_assetids.end());
+    bool changed = not_cached || (it->second != item->getAssetUUID());
+    if (!changed || caching_files.find(name) != caching_files.end())
+    {
+        return;
+    }
+
+    LLStringUtil::format_map_t args;
+    args["[FILENAME]"] = name;
+    display_message(LLTrans::getString(not_cached ? "fs_preprocessor_cache_miss" : "fs_preprocessor_cache_invalidated", args));
+
+    caching_files.insert(name);
+    ProcCacheInfo* info = new ProcCacheInfo;
+    info->item = item;
+    info->self = this;
+    LLPermissions perm(((LLInventoryItem*)item)->getPermissions());
+    gAssetStorage->getInvItemAsset(LLHost(),
+                                    gAgentID,
+                                    gAgentSessionID,
+                                    perm.getOwner(),
+                                    LLUUID::null,
+                                    item->getUUID(),
+                                    LLUUID::null,
+                                    item->getType(),
+                                    &FSLSLPreprocessor::FSProcCacheCallback,
+                                    info,
+                                    true);
+}
+
 void FSLSLPreprocessor::preprocess_script(bool close, bool sync, bool defcache)
 {
     mClose = close;
     mSync = sync;
     mDefinitionCaching = defcache;
     caching_files.clear();
+    mResolvedIncludes.clear();
     LLStringUtil::format_map_t args;
     display_message(LLTrans::getString("fs_preprocessor_starting"));
 
@@ -823,6 +1034,7 @@ void FSLSLPreprocessor::preprocess_script(const LLUUID& asset_id, LLScriptQueueD
 
     mDefinitionCaching = false;
     caching_files.clear();
+    mResolvedIncludes.clear();
     LLStringUtil::format_map_t args;
     display_message(LLTrans::getString("fs_preprocessor_starting"));
 
@@ -1115,6 +1327,297 @@ static std::string reformat_switch_statements(std::string script, bool &lackDefa
     return script;
 }
 
+// Runs wave on the job input, or takes its output from the cache
+static void run_wave(FSLSLPreprocJob& job, bool& lazy_lists, bool& use_switch)
+{
+    const LLUUID key = wave_cache_key(job);
+    bool wave_lazy_lists = false;
+    bool wave_switch = false;
+    if (find_in_wave_cache(key, job, wave_lazy_lists, wave_switch))
+    {
+        lazy_lists = lazy_lists || wave_lazy_lists;
+        use_switch = use_switch || wave_switch;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(sWaveMutex);
+    boost::wave::util::file_position_type current_position;
+    std::string& output = job.mOutput;
+    try
+    {
+        typedef boost::wave::cpplexer::lex_token<> token_type;
+        typedef boost::wave::cpplexer::lex_iterator<token_type> lex_iterator_type;
+        typedef boost::wave::context<std::string::iterator, lex_iterator_type, boost::wave::iteration_context_policies::load_file_to_string, trace_include_files >
+                context_type;
+
+        context_type ctx(job.mInput.begin(), job.mInput.end(), job.mName.c_str(), trace_include_files(job));
+        ctx.set_language(boost::wave::enable_long_long(ctx.get_language()));
+        ctx.set_language(boost::wave::enable_prefer_pp_numbers(ctx.get_language()));
+        ctx.set_language(boost::wave::enable_variadics(ctx.get_language()));
+
+        for (const std::string& path : job.mIncludePaths)
+        {
+            ctx.add_include_path(path.c_str());
+        }
+        for (const std::string& path : job.mSysIncludePaths)
+        {
+            ctx.add_sysinclude_path(path.c_str());
+        }
+        for (const std::string& def : job.mMacros)
+        {
+            ctx.add_macro_definition(def, false);
+        }
+
+        ctx.add_macro_definition("list(...)=((list)(__VA_ARGS__))", false);
+        ctx.add_macro_definition("float(...)=((float)(__VA_ARGS__))", false);
+        ctx.add_macro_definition("integer(...)=((integer)(__VA_ARGS__))", false);
+        ctx.add_macro_definition("key(...)=((key)(__VA_ARGS__))", false);
+        ctx.add_macro_definition("rotation(...)=((rotation)(__VA_ARGS__))", false);
+        ctx.add_macro_definition("quaternion(...)=((quaternion)(__VA_ARGS__))", false);
+        ctx.add_macro_definition("string(...)=((string)(__VA_ARGS__))", false);
+        ctx.add_macro_definition("vector(...)=((vector)(__VA_ARGS__))", false);
+
+        context_type::iterator_type first = ctx.begin();
+        context_type::iterator_type last = ctx.end();
+
+        while (first != last)
+        {
+            if (!job.mUnresolvedIncludes.empty())
+            {
+                output.clear();
+                return;
+            }
+            current_position = (*first).get_position();
+
+            std::string token = std::string((*first).get_value().c_str());//stupid boost bitching even though we know its a std::string
+
+            if (token == "#line")
+            {
+                token = "//#line";
+            }
+
+            output += token;
+
+            if (!wave_lazy_lists)
+            {
+                wave_lazy_lists = ctx.is_defined_macro(std::string("USE_LAZY_LISTS"));
+            }
+
+            if (!wave_switch)
+            {
+                wave_switch = ctx.is_defined_macro(std::string("USE_SWITCHES"));
+            }
+            ++first;
+        }
+
+        if (!job.mUnresolvedIncludes.empty())
+        {
+            // The last thing in the script was an include
+            output.clear();
+            return;
+        }
+
+        add_to_wave_cache(key, job, ctx.get_hooks().getIncludes(), ctx.get_hooks().getFiles(), wave_lazy_lists, wave_switch);
+    }
+    catch(boost::wave::cpp_exception const& e)
+    {
+        job.mErrored = true;
+        // some preprocessing error
+        LLStringUtil::format_map_t args;
+        args["[ERR_NAME]"] = e.file_name();
+        args["[LINENUMBER]"] = llformat("%d", e.line_no() - 1);
+        args["[ERR_DESC]"] = e.description();
+        std::string err = LLTrans::getString("fs_preprocessor_cpp_exception", args);
+        LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
+        job.error(err);
+    }
+    catch(boost::wave::cpplexer::lexing_exception const& e)
+    {
+        // lexing preprocessing error
+        boost::wave::cpplexer::util::severity severity_level = e.severity_level(e.get_errorcode());
+        job.mErrored = (severity_level != boost::wave::cpplexer::util::severity_warning && severity_level != boost::wave::cpplexer::util::severity_remark);
+        LLStringUtil::format_map_t args;
+        std::string severity_text = e.severity_text(e.get_errorcode());
+        LLStringUtil::toUpper(severity_text);
+        args["[SEVERITY]"] = severity_text;
+        args["[ERR_NAME]"] = e.file_name();
+        args["[LINENUMBER]"] = llformat("%d", e.line_no() - 1);
+        args["[ERR_DESC]"] = e.description();
+        std::string err = LLTrans::getString("fs_preprocessor_lexing_exception", args);
+        LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
+        job.error(err);
+    }
+    catch(std::exception const& e)
+    {
+        FAILDEBUG
+        job.mErrored = true;
+        LLStringUtil::format_map_t args;
+        args["[ERR_NAME]"] = std::string(current_position.get_file().c_str());
+        args["[LINENUMBER]"] = llformat("%d", current_position.get_line());
+        args["[ERR_DESC]"] = e.what();
+        job.error(LLTrans::getString("fs_preprocessor_exception", args));
+    }
+    catch (...)
+    {
+        FAILDEBUG
+        job.mErrored = true;
+        LLStringUtil::format_map_t args;
+        args["[ERR_NAME]"] = std::string(current_position.get_file().c_str());
+        args["[LINENUMBER]"] = llformat("%d", current_position.get_line());
+        std::string err = LLTrans::getString("fs_preprocessor_error", args);
+        LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
+        job.error(err);
+    }
+
+    lazy_lists = lazy_lists || wave_lazy_lists;
+    use_switch = use_switch || wave_switch;
+}
+
+// Everything between reading the editor and handing the script back, safe to
+// run on any thread
+static void process_job(FSLSLPreprocJob& job)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    bool lazy_lists = job.mLazyLists;
+    bool use_switch = job.mSwitch;
+    std::string& output = job.mOutput;
+
+    run_wave(job, lazy_lists, use_switch);
+    if (!job.mUnresolvedIncludes.empty())
+    {
+        return;
+    }
+
+    if (!job.mErrored)
+    {
+        FAILDEBUG
+        if (lazy_lists)
+        {
+            try
+            {
+                job.message(LLTrans::getString("fs_preprocessor_lazylist_start"));
+                try
+                {
+                    output = reformat_lazy_lists(output);
+                }
+                catch (boost::regex_error& e)
+                {
+                    LLStringUtil::format_map_t args;
+                    args["[WHAT]"] = e.what();
+                    std::string err = LLTrans::getString("fs_preprocessor_lazylist_regex_err", args);
+                    LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
+                    job.error(err);
+                    throw;
+                }
+                catch (std::exception& e)
+                {
+                    LLStringUtil::format_map_t args;
+                    args["[WHAT]"] = e.what();
+                    std::string err = LLTrans::getString("fs_preprocessor_lazylist_exception", args);
+                    LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
+                    job.error(err);
+                    throw;
+                }
+            }
+            catch(...)
+            {
+                job.mErrored = true;
+                job.error(LLTrans::getString("fs_preprocessor_lazylist_unexpected_exception"));
+            }
+        }
+
+        if (use_switch)
+        {
+            try
+            {
+                job.message(LLTrans::getString("fs_preprocessor_switchstatement_start"));
+                try
+                {
+                    output = reformat_switch_statements(output, job.mLackDefault);
+                }
+                catch (boost::regex_error& e)
+                {
+                    LLStringUtil::format_map_t args;
+                    args["[WHAT]"] = e.what();
+                    std::string err = LLTrans::getString("fs_preprocessor_switchstatement_regex_err", args);
+                    LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
+                    job.error(err);
+                    throw;
+                }
+                catch (std::exception& e)
+                {
+                    LLStringUtil::format_map_t args;
+                    args["[WHAT]"] = e.what();
+                    std::string err = LLTrans::getString("fs_preprocessor_switchstatement_exception", args);
+                    LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
+                    job.error(err);
+                    throw;
+                }
+            }
+            catch(...)
+            {
+                job.mErrored = true;
+                job.error(LLTrans::getString("fs_preprocessor_switchstatement_unexpected_exception"));
+            }
+        }
+    }
+
+    if (job.mDefinitionCaching)
+    {
+        return;
+    }
+
+    if (!job.mErrored)
+    {
+        if (job.mOptimizer)
+        {
+            job.message(LLTrans::getString("fs_preprocessor_optimizer_start"));
+            try
+            {
+                output = FSLSLPreprocessor::lslopt(output, job);
+            }
+            catch(...)
+            {
+                job.mErrored = true;
+                job.error(LLTrans::getString("fs_preprocessor_optimizer_unexpected_exception"));
+            }
+        }
+    }
+    else
+    {
+        // FIRE-31718: Preprocessor crashes viewer on recursive #include
+
+        // Truncate the resulting preprocessed script to something the text field can handle without
+        // freezing for so long the viewer disconnects. The usual script source code limit is 64kB so
+        // let's play it safe and allow twice as much here. The script is most likely already unusable
+        // at this point due to the preprocessor bailing out with an error earlier, so a truncated
+        // version doesn't hurt more than it already did.
+        if (output.size() > 128 * 1024)
+        {
+            output.resize(128 * 1024);
+            job.error(LLTrans::getString("fs_preprocessor_truncated"));
+        }
+    }
+
+    if (!job.mErrored)
+    {
+        if (job.mCompression)
+        {
+            job.message(LLTrans::getString("fs_preprocessor_compress_exception"));
+            try
+            {
+                output = FSLSLPreprocessor::lslcomp(output, job);
+            }
+            catch(...)
+            {
+                job.mErrored = true;
+                job.error(LLTrans::getString("fs_preprocessor_compress_unexpected_exception"));
+            }
+        }
+    }
+}
+
 void FSLSLPreprocessor::start_process()
 {
     if (mWaving)
@@ -1122,10 +1625,14 @@ void FSLSLPreprocessor::start_process()
         LL_WARNS("FSLSLPreprocessor") << "already waving?" << LL_ENDL;
         return;
     }
+    if (!caching_files.empty())
+    {
+        // The last include fetch to finish starts the run again
+        return;
+    }
 
     mWaving = true;
-    bool lackDefault = false;
-    boost::wave::util::file_position_type current_position;
+    std::shared_ptr<FSLSLPreprocJob> job = std::make_shared<FSLSLPreprocJob>();
     std::string input;
     if (mStandalone)
     {
@@ -1136,6 +1643,7 @@ void FSLSLPreprocessor::start_process()
         input = mCore->mEditor->getText();
     }
     std::string rinput = input;
+    job->mRawInput = rinput;
     bool preprocessor_enabled = true;
 
     // Simple check for the "do not preprocess" marker.  This logic will NOT survive a conversion into some form of sectional preprocessing as discussed in FIRE-9335, but will serve the basic use case given therein.
@@ -1251,17 +1759,18 @@ void FSLSLPreprocessor::start_process()
 
     //Make sure wave does not complain about missing newline at end of script.
     input += "\n";
-    std::string output;
-
-    std::string name = mMainScriptName;
-    bool lazy_lists = gSavedSettings.getBOOL("_NACL_PreProcLSLLazyLists");
-    bool use_switch = gSavedSettings.getBOOL("_NACL_PreProcLSLSwitch");
-    bool use_optimizer = gSavedSettings.getBOOL("_NACL_PreProcLSLOptimizer");
-    bool enable_hdd_include = gSavedSettings.getBOOL("_NACL_PreProcEnableHDDInclude");
-    bool use_compression = gSavedSettings.getBOOL("_NACL_PreProcLSLTextCompress");
-    bool errored = false;
+
+    job->mEnabled = preprocessor_enabled;
+    job->mDefinitionCaching = mDefinitionCaching;
     if (preprocessor_enabled)
     {
+        std::string name = mMainScriptName;
+        bool lazy_lists = gSavedSettings.getBOOL("_NACL_PreProcLSLLazyLists");
+        bool use_switch = gSavedSettings.getBOOL("_NACL_PreProcLSLSwitch");
+        bool use_optimizer = gSavedSettings.getBOOL("_NACL_PreProcLSLOptimizer");
+        bool enable_hdd_include = gSavedSettings.getBOOL("_NACL_PreProcEnableHDDInclude");
+        bool use_compression = gSavedSettings.getBOOL("_NACL_PreProcLSLTextCompress");
+
         std::string settings;
         settings = LLTrans::getString("fs_preprocessor_settings_list_prefix") + " preproc";
         if (lazy_lists)
@@ -1288,272 +1797,113 @@ void FSLSLPreprocessor::start_process()
         display_message(settings);
 
         LL_DEBUGS("FSLSLPreprocessor") << settings << LL_ENDL;
-        std::string err;
-        try
+
+        job->mInput = input;
+        job->mName = name;
+        job->mLazyLists = lazy_lists;
+        job->mSwitch = use_switch;
+        job->mOptimizer = use_optimizer;
+        job->mCompression = use_compression;
+        job->mAssetIDs = cached_assetids;
+        job->mResolvedIncludes = mResolvedIncludes;
+
+        std::string path = gDirUtilp->getExpandedFilename(LL_PATH_CACHE,"") + gDirUtilp->getDirDelimiter() + "lslpreproc" + gDirUtilp->getDirDelimiter();
+        job->mIncludePaths.push_back(path);
+        if (enable_hdd_include)
         {
-            trace_include_files tracer(this);
-            typedef boost::wave::cpplexer::lex_token<> token_type;
-            typedef boost::wave::cpplexer::lex_iterator<token_type> lex_iterator_type;
-            typedef boost::wave::context<std::string::iterator, lex_iterator_type, boost::wave::iteration_context_policies::load_file_to_string, trace_include_files >
-                    context_type;
-
-            context_type ctx(input.begin(), input.end(), name.c_str(), tracer);
-            ctx.set_language(boost::wave::enable_long_long(ctx.get_language()));
-            ctx.set_language(boost::wave::enable_prefer_pp_numbers(ctx.get_language()));
-            ctx.set_language(boost::wave::enable_variadics(ctx.get_language()));
-
-            std::string path = gDirUtilp->getExpandedFilename(LL_PATH_CACHE,"") + gDirUtilp->getDirDelimiter() + "lslpreproc" + gDirUtilp->getDirDelimiter();
-            ctx.add_include_path(path.c_str());
-            if (enable_hdd_include)
+            std::string hddpath = gSavedSettings.getString("_NACL_PreProcHDDIncludeLocation");
+            if (!hddpath.empty())
             {
-                std::string hddpath = gSavedSettings.getString("_NACL_PreProcHDDIncludeLocation");
-                if (!hddpath.empty())
-                {
-                    ctx.add_include_path(hddpath.c_str());
-                    ctx.add_sysinclude_path(hddpath.c_str());
-                }
+                job->mIncludePaths.push_back(hddpath);
+                job->mSysIncludePaths.push_back(hddpath);
             }
-            std::string def = llformat("__AGENTKEY__=\"%s\"", gAgentID.asString().c_str());//legacy because I used it earlier
-            ctx.add_macro_definition(def, false);
-            def = llformat("__AGENTID__=\"%s\"", gAgentID.asString().c_str());
-            ctx.add_macro_definition(def, false);
-            def = llformat("__AGENTIDRAW__=%s", gAgentID.asString().c_str());
-            ctx.add_macro_definition(def, false);
-            std::string aname = gAgentAvatarp->getFullname();
-            def = llformat("__AGENTNAME__=\"%s\"", aname.c_str());
-            ctx.add_macro_definition(def, false);
-            def = llformat("__ASSETID__=%s", LLUUID::null.asString().c_str());
-            ctx.add_macro_definition(def, false);
-            def = llformat("__SHORTFILE__=\"%s\"", name.c_str());
-            ctx.add_macro_definition(def, false);
-            def = llformat("__UNIXTIME__=%i", (S32)time_corrected());
-            ctx.add_macro_definition(def, false);
-
-            ctx.add_macro_definition("list(...)=((list)(__VA_ARGS__))", false);
-            ctx.add_macro_definition("float(...)=((float)(__VA_ARGS__))", false);
-            ctx.add_macro_definition("integer(...)=((integer)(__VA_ARGS__))", false);
-            ctx.add_macro_definition("key(...)=((key)(__VA_ARGS__))", false);
-            ctx.add_macro_definition("rotation(...)=((rotation)(__VA_ARGS__))", false);
-            ctx.add_macro_definition("quaternion(...)=((quaternion)(__VA_ARGS__))", false);
-            ctx.add_macro_definition("string(...)=((string)(__VA_ARGS__))", false);
-            ctx.add_macro_definition("vector(...)=((vector)(__VA_ARGS__))", false);
+        }
+        job->mMacros.push_back(llformat("__AGENTKEY__=\"%s\"", gAgentID.asString().c_str()));//legacy because I used it earlier
+        job->mMacros.push_back(llformat("__AGENTID__=\"%s\"", gAgentID.asString().c_str()));
+        job->mMacros.push_back(llformat("__AGENTIDRAW__=%s", gAgentID.asString().c_str()));
+        std::string aname = gAgentAvatarp->getFullname();
+        job->mMacros.push_back(llformat("__AGENTNAME__=\"%s\"", aname.c_str()));
+        job->mMacros.push_back(llformat("__ASSETID__=%s", LLUUID::null.asString().c_str()));
+        job->mMacros.push_back(llformat("__SHORTFILE__=\"%s\"", name.c_str()));
+        job->mMacros.push_back(llformat("__UNIXTIME__=%i", (S32)time_corrected()));
+    }
 
-            context_type::iterator_type first = ctx.begin();
-            context_type::iterator_type last = ctx.end();
+    dispatch_process(job);
+}
 
-            while (first != last)
+void FSLSLPreprocessor::dispatch_process(std::shared_ptr<FSLSLPreprocJob> job)
+{
+    static LLCachedControl<bool> background(gSavedSettings, "FSLSLPreprocBackground");
+    if (job->mEnabled && background)
+    {
+        LL::WorkQueue::ptr_t main_queue = LL::WorkQueue::getInstance("mainloop");
+        LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+        std::weak_ptr<bool> alive = mAlive;
+        bool posted = main_queue && general_queue && main_queue->postTo(
+            general_queue,
+            [job]() // Work done on general queue
             {
-                if (caching_files.size() != 0)
-                {
-                    mWaving = false;
-                    return;
-                }
-                current_position = (*first).get_position();
-
-                std::string token = std::string((*first).get_value().c_str());//stupid boost bitching even though we know its a std::string
-
-                if (token == "#line")
-                {
-                    token = "//#line";
-                }
-
-                output += token;
-
-                if (!lazy_lists)
-                {
-                    lazy_lists = ctx.is_defined_macro(std::string("USE_LAZY_LISTS"));
-                }
-
-                if (!use_switch)
+                process_job(*job);
+                return job;
+            },
+            [this, alive](std::shared_ptr<FSLSLPreprocJob> job) // Callback to main thread
+            {
+                if (alive.lock())
                 {
-                    use_switch = ctx.is_defined_macro(std::string("USE_SWITCHES"));
+                    finish_process(*job);
                 }
-                ++first;
-            }
-        }
-        catch(boost::wave::cpp_exception const& e)
-        {
-            errored = true;
-            // some preprocessing error
-            LLStringUtil::format_map_t args;
-            args["[ERR_NAME]"] = e.file_name();
-            args["[LINENUMBER]"] = llformat("%d", e.line_no() - 1);
-            args["[ERR_DESC]"] = e.description();
-            std::string err = LLTrans::getString("fs_preprocessor_cpp_exception", args);
-            LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
-            display_error(err);
-        }
-        catch(boost::wave::cpplexer::lexing_exception const& e)
-        {
-            // lexing preprocessing error
-            boost::wave::cpplexer::util::severity severity_level = e.severity_level(e.get_errorcode());
-            errored = (severity_level != boost::wave::cpplexer::util::severity_warning && severity_level != boost::wave::cpplexer::util::severity_remark);
-            LLStringUtil::format_map_t args;
-            std::string severity_text = e.severity_text(e.get_errorcode());
-            LLStringUtil::toUpper(severity_text);
-            args["[SEVERITY]"] = severity_text;
-            args["[ERR_NAME]"] = e.file_name();
-            args["[LINENUMBER]"] = llformat("%d", e.line_no() - 1);
-            args["[ERR_DESC]"] = e.description();
-            std::string err = LLTrans::getString("fs_preprocessor_lexing_exception", args);
-            LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
-            display_error(err);
-        }
-        catch(std::exception const& e)
-        {
-            FAILDEBUG
-            errored = true;
-            LLStringUtil::format_map_t args;
-            args["[ERR_NAME]"] = std::string(current_position.get_file().c_str());
-            args["[LINENUMBER]"] = llformat("%d", current_position.get_line());
-            args["[ERR_DESC]"] = e.what();
-            display_error(LLTrans::getString("fs_preprocessor_exception", args));
-        }
-        catch (...)
+            });
+        if (posted)
         {
-            FAILDEBUG
-            errored = true;
-            LLStringUtil::format_map_t args;
-            args["[ERR_NAME]"] = std::string(current_position.get_file().c_str());
-            args["[LINENUMBER]"] = llformat("%d", current_position.get_line());
-            std::string err = LLTrans::getString("fs_preprocessor_error", args);
-            LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
-            display_error(err);
+            return;
         }
     }
 
-    if (preprocessor_enabled && !errored)
+    if (job->mEnabled)
     {
-        FAILDEBUG
-        if (lazy_lists)
-        {
-            try
-            {
-                display_message(LLTrans::getString("fs_preprocessor_lazylist_start"));
-                try
-                {
-                    output = reformat_lazy_lists(output);
-                }
-                catch (boost::regex_error& e)
-                {
-                    LLStringUtil::format_map_t args;
-                    args["[WHAT]"] = e.what();
-                    std::string err = LLTrans::getString("fs_preprocessor_lazylist_regex_err", args);
-                    LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
-                    display_error(err);
-                    throw;
-                }
-                catch (std::exception& e)
-                {
-                    LLStringUtil::format_map_t args;
-                    args["[WHAT]"] = e.what();
-                    std::string err = LLTrans::getString("fs_preprocessor_lazylist_exception", args);
-                    LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
-                    display_error(err);
-                    throw;
-                }
-            }
-            catch(...)
-            {
-                errored = true;
-                display_error(LLTrans::getString("fs_preprocessor_lazylist_unexpected_exception"));
-            }
-        }
-
-        if (use_switch)
-        {
-            try
-            {
-                display_message(LLTrans::getString("fs_preprocessor_switchstatement_start"));
-                try
-                {
-                    output = reformat_switch_statements(output, lackDefault);
-                }
-                catch (boost::regex_error& e)
-                {
-                    LLStringUtil::format_map_t args;
-                    args["[WHAT]"] = e.what();
-                    std::string err = LLTrans::getString("fs_preprocessor_switchstatement_regex_err", args);
-                    LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
-                    display_error(err);
-                    throw;
-                }
-                catch (std::exception& e)
-                {
-                    LLStringUtil::format_map_t args;
-                    args["[WHAT]"] = e.what();
-                    std::string err = LLTrans::getString("fs_preprocessor_switchstatement_exception", args);
-                    LL_WARNS("FSLSLPreprocessor") << err << LL_ENDL;
-                    display_error(err);
-                    throw;
-                }
-            }
-            catch(...)
-            {
-                errored = true;
-                display_error(LLTrans::getString("fs_preprocessor_switchstatement_unexpected_exception"));
-            }
-        }
+        process_job(*job);
     }
+    finish_process(*job);
+}
 
-    if (!mDefinitionCaching)
+void FSLSLPreprocessor::finish_process(FSLSLPreprocJob& job)
+{
+    mWaving = false;
+
+    for (const auto& [is_error, text] : job.mMessages)
     {
-        if (!errored)
+        if (is_error)
         {
-            if (preprocessor_enabled && use_optimizer)
-            {
-                display_message(LLTrans::getString("fs_preprocessor_optimizer_start"));
-                try
-                {
-                    output = lslopt(output);
-                }
-                catch(...)
-                {
-                    errored = true;
-                    display_error(LLTrans::getString("fs_preprocessor_optimizer_unexpected_exception"));
-                }
-            }
+            display_error(text);
         }
         else
         {
-            // FIRE-31718: Preprocessor crashes viewer on recursive #include
-
-            // Truncate the resulting preprocessed script to something the text field can handle without
-            // freezing for so long the viewer disconnects. The usual script source code limit is 64kB so
-            // let's play it safe and allow twice as much here. The script is most likely already unusable
-            // at this point due to the preprocessor bailing out with an error earlier, so a truncated
-            // version doesn't hurt more than it already did.
-            if (output.size() > 128 * 1024)
-            {
-                output.resize(128 * 1024);
-                display_error(LLTrans::getString("fs_preprocessor_truncated"));
-            }
+            display_message(text);
         }
+    }
 
-        if (!errored)
+    if (!job.mUnresolvedIncludes.empty())
+    {
+        // Wave stopped at includes it could not look up, fetch what is
+        // missing or outdated and run again
+        for (const std::string& name : job.mUnresolvedIncludes)
         {
-            if (preprocessor_enabled && use_compression)
-            {
-                display_message(LLTrans::getString("fs_preprocessor_compress_exception"));
-                try
-                {
-                    output = lslcomp(output);
-                }
-                catch(...)
-                {
-                    errored = true;
-                    display_error(LLTrans::getString("fs_preprocessor_compress_unexpected_exception"));
-                }
-            }
+            resolve_include(name);
         }
+        start_process();
+        return;
+    }
 
-        if (preprocessor_enabled)
+    if (!mDefinitionCaching)
+    {
+        std::string output;
+        if (job.mEnabled)
         {
-            output = encode(rinput) + "\n\n" + output;
+            output = encode(job.mRawInput) + "\n\n" + job.mOutput;
         }
         else
         {
-            output = rinput;
+            output = job.mRawInput;
         }
 
         if (mStandalone)
@@ -1572,14 +1922,12 @@ void FSLSLPreprocessor::start_process()
             mCore->doSaveComplete((void*)mCore, mClose, mSync);
         }
     }
-    if (lackDefault)
+    if (job.mLackDefault)
     {
         LLNotificationsUtil::add("DefaultLabelMissing");
     }
-    mWaving = false;
 }
 
-
 void FSLSLPreprocessor::display_message(std::string_view msg)
 {
     if (mStandalone)
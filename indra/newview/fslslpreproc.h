@@ -37,6 +37,9 @@
 #include "llviewerprecompiledheaders.h"
 #include "llpreviewscript.h"
 
+#include <memory>
+
+struct FSLSLPreprocJob;
 struct LLScriptQueueData;
 
 class FSLSLPreprocessor
@@ -45,19 +48,20 @@ class FSLSLPreprocessor
 
 public:
     FSLSLPreprocessor(LLScriptEdCore* corep)
-        : mCore(corep), mWaving(false), mClose(false), mSync(false), mStandalone(false)
+        : mCore(corep), mWaving(false), mClose(false), mSync(false), mStandalone(false), mAlive(std::make_shared<bool>(true))
     {}
 
     FSLSLPreprocessor()
-        : mWaving(false), mClose(false), mSync(false), mStandalone(true)
+        : mWaving(false), mClose(false), mSync(false), mStandalone(true), mAlive(std::make_shared<bool>(true))
     {}
 
     static bool mono_directive(std::string_view text, bool agent_inv = true);
     std::string encode(const std::string& script);
     std::string decode(const std::string& script);
 
-    std::string lslopt(std::string script);
-    std::string lslcomp(std::string script);
+    // Run on the preprocessing thread, messages go to the job
+    static std::string lslopt(std::string script, FSLSLPreprocJob& job);
+    static std::string lslcomp(std::string script, FSLSLPreprocJob& job);
 
     static std::optional<LLUUID> findInventoryByName(std::string_view name);
     static void FSProcCacheCallback(const LLUUID& uuid, LLAssetType::EType type,
@@ -65,6 +69,9 @@ public:
     void preprocess_script(bool close = false, bool sync = false, bool defcache = false);
     void preprocess_script(const LLUUID& asset_id, LLScriptQueueData* data, LLAssetType::EType type, const std::string& script_data);
     void start_process();
+    void dispatch_process(std::shared_ptr<FSLSLPreprocJob> job);
+    void finish_process(FSLSLPreprocJob& job);
+    void resolve_include(const std::string& name);
     void display_message(std::string_view msg);
     void display_error(std::string_view err);
 
@@ -82,6 +89,9 @@ public:
 
     std::set<std::string> caching_files;
     std::set<std::string> defcached_files;
+    // Include names already looked up in inventory during this run. Wave runs
+    // off the main thread and stops at the first include not in here.
+    std::set<std::string> mResolvedIncludes;
     bool mDefinitionCaching;
 
     LLScriptEdCore* mCore;
@@ -96,6 +106,9 @@ public:
     LLUUID mAssetID;
     LLScriptQueueData* mData;
     LLAssetType::EType mType;
+
+    // Preprocessing results only come back while this is alive
+    std::shared_ptr<bool> mAlive;
 };
 
 #endif // FS_LSLPREPROC_H
@@ -0,0 +1,293 @@
+/**
+ * @file fsmeshinstancer.cpp
+ * @brief Instanced drawing of static meshes repeated across the scene
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsmeshinstancer.h"
+
+#include "lldrawpool.h"
+#include "llfetchedgltfmaterial.h"
+#include "llframetimer.h"
+#include "llglslshader.h"
+#include "llrender.h"
+#include "llvolume.h"
+#include "pipeline.h"
+
+#include <algorithm>
+
+namespace
+{
+    // vec4s per instance, see pbropaqueV.glsl
+    constexpr U32 INSTANCE_VEC4S = 7;
+
+    // Frames a mesh face buffer is kept after it was last drawn
+    constexpr U32 BUFFER_LIFETIME = 600;
+
+    constexpr U32 INSTANCE_VERTEX_MASK = LLVertexBuffer::MAP_VERTEX | LLVertexBuffer::MAP_NORMAL |
+        LLVertexBuffer::MAP_TEXCOORD0 | LLVertexBuffer::MAP_TANGENT;
+
+    bool same_batch(const LLSpatialGroup::MeshInstance& a, const LLSpatialGroup::MeshInstance& b)
+    {
+        return a.mVolume == b.mVolume
+            && a.mVolumeFace == b.mVolumeFace
+            && a.mModelMatrix == b.mModelMatrix
+            && a.mMaterial == b.mMaterial;
+    }
+}
+
+FSMeshInstancer::FSMeshInstancer()
+:   mUBO(0),
+    mOffsetAlignment(0),
+    mLastEviction(0)
+{
+}
+
+FSMeshInstancer::~FSMeshInstancer()
+{
+    // mUBO and the shared instance vertex buffers are freed in release(),
+    // called from LLPipeline::releaseGLBuffers() and LLPipeline::cleanup()
+    // while the GL context is still current.
+}
+
+void FSMeshInstancer::render(bool shadow)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_DRAWPOOL;
+
+    mInstances.clear();
+    for (LLCullResult::sg_iterator i = gPipeline.beginInstanceGroups(); i != gPipeline.endInstanceGroups(); ++i)
+    {
+        for (const LLSpatialGroup::MeshInstance& instance : (*i)->mMeshInstances)
+        {
+            mInstances.push_back(&instance);
+        }
+    }
+
+    if (mInstances.empty())
+    {
+        return;
+    }
+
+    if (!LLGLSLShader::sCurBoundShaderPtr)
+    {
+        return;
+    }
+
+    if (mUBO == 0)
+    {
+        glGenBuffers(1, &mUBO);
+
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        mOffsetAlignment = (U32)llmax(alignment, 16);
+    }
+
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_DRAWPOOL("mesh instancer - sort");
+        std::sort(mInstances.begin(), mInstances.end(),
+            [](const LLSpatialGroup::MeshInstance* a, const LLSpatialGroup::MeshInstance* b)
+            {
+                if (a->mVolume != b->mVolume)
+                {
+                    return a->mVolume.get() < b->mVolume.get();
+                }
+                if (a->mVolumeFace != b->mVolumeFace)
+                {
+                    return a->mVolumeFace < b->mVolumeFace;
+                }
+                if (a->mModelMatrix != b->mModelMatrix)
+                {
+                    return a->mModelMatrix < b->mModelMatrix;
+                }
+                return a->mMaterial.get() < b->mMaterial.get();
+            });
+    }
+
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_DRAWPOOL("mesh instancer - pack");
+
+        // as many instances per draw as the shaders' MAX_UBO_VEC4S allow
+        const U32 max_instances = llmax((U32)gGLManager.mMaxUniformBlockSize / (16 * INSTANCE_VEC4S), 1U);
+        const U32 align = mOffsetAlignment / sizeof(F32);
+
+        mBatches.clear();
+        mData.clear();
+
+        U32 i = 0;
+        while (i < (U32)mInstances.size())
+        {
+            Batch batch;
+            batch.mFirst = i;
+            batch.mCount = 0;
+
+            // every range bound must start on the offset alignment
+            mData.resize((mData.size() + align - 1) / align * align);
+            batch.mOffset = (U32)(mData.size() * sizeof(F32));
+
+            const LLSpatialGroup::MeshInstance& first = *mInstances[i];
+            while (i < (U32)mInstances.size() && batch.mCount < max_instances && same_batch(first, *mInstances[i]))
+            {
+                const LLSpatialGroup::MeshInstance& instance = *mInstances[i];
+                mData.insert(mData.end(), instance.mTransform, instance.mTransform + 12);
+                mData.insert(mData.end(), instance.mNormal, instance.mNormal + 12);
+                mData.insert(mData.end(), instance.mColor.mV, instance.mColor.mV + 4);
+                ++batch.mCount;
+                ++i;
+            }
+
+            mBatches.push_back(batch);
+        }
+
+        glBindBuffer(GL_UNIFORM_BUFFER, mUBO);
+        glBufferData(GL_UNIFORM_BUFFER, mData.size() * sizeof(F32), mData.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_DRAWPOOL("mesh instancer - draw");
+
+        const LLFetchedGLTFMaterial* last_mat = nullptr;
+        for (const Batch& batch : mBatches)
+        {
+            const LLSpatialGroup::MeshInstance& first = *mInstances[batch.mFirst];
+
+            LLVertexBuffer* buffer = getBuffer(first.mVolume, first.mVolumeFace);
+            if (!buffer)
+            {
+                continue;
+            }
+
+            LLFetchedGLTFMaterial* mat = first.mMaterial;
+            if (!shadow && mat != last_mat)
+            {
+                mat->bind();
+                last_mat = mat;
+            }
+
+            LLGLDisable cull_face(mat->mDoubleSided ? GL_CULL_FACE : 0);
+
+            LLRenderPass::applyModelMatrix(first.mModelMatrix);
+
+            glBindBufferRange(GL_UNIFORM_BUFFER, LLGLSLShader::UB_MESH_INSTANCES, mUBO,
+                batch.mOffset, batch.mCount * INSTANCE_VEC4S * 16);
+
+            buffer->setBuffer();
+            buffer->drawInstanced(LLRender::TRIANGLES, buffer->getNumIndices(), 0, batch.mCount);
+        }
+    }
+
+    // the instances belong to the groups, don't hold on to them past the pass
+    mInstances.clear();
+
+    evictBuffers();
+}
+
+LLVertexBuffer* FSMeshInstancer::getBuffer(LLVolume* volume, S32 face)
+{
+    if (!volume || face < 0 || face >= volume->getNumVolumeFaces())
+    {
+        return nullptr;
+    }
+
+    const LLVolumeFace& vf = volume->getVolumeFace(face);
+    if (vf.mNumVertices <= 0 || vf.mNumIndices <= 0 || !vf.mPositions || !vf.mNormals || !vf.mTexCoords)
+    {
+        return nullptr;
+    }
+
+    Buffer& entry = mBuffers[buffer_key_t(volume, face)];
+    entry.mLastUsed = LLFrameTimer::getFrameCount();
+
+    // the volume of a LOD may be regenerated in place
+    if (entry.mVertexBuffer.notNull()
+        && entry.mPositions == vf.mPositions
+        && entry.mNumVertices == vf.mNumVertices
+        && entry.mNumIndices == vf.mNumIndices)
+    {
+        return entry.mVertexBuffer;
+    }
+
+    LL_PROFILE_ZONE_NAMED_CATEGORY_DRAWPOOL("mesh instancer - make buffer");
+
+    volume->genTangents(face);
+
+    LLPointer<LLVertexBuffer> buffer = new LLVertexBuffer(INSTANCE_VERTEX_MASK);
+    if (!vf.mTangents || !buffer->allocateBuffer(vf.mNumVertices, vf.mNumIndices))
+    {
+        mBuffers.erase(buffer_key_t(volume, face));
+        return nullptr;
+    }
+
+    buffer->setPositionData(vf.mPositions);
+    buffer->setNormalData(vf.mNormals);
+    buffer->setTangentData(vf.mTangents);
+    buffer->setTexCoord0Data(vf.mTexCoords);
+    buffer->setIndexData(vf.mIndices);
+    buffer->unmapBuffer();
+
+    entry.mVolume = volume;
+    entry.mVertexBuffer = buffer;
+    entry.mPositions = vf.mPositions;
+    entry.mNumVertices = vf.mNumVertices;
+    entry.mNumIndices = vf.mNumIndices;
+    return entry.mVertexBuffer;
+}
+
+void FSMeshInstancer::evictBuffers()
+{
+    const U32 frame = LLFrameTimer::getFrameCount();
+    if (frame - mLastEviction < BUFFER_LIFETIME / 4)
+    {
+        return;
+    }
+    mLastEviction = frame;
+
+    for (auto iter = mBuffers.begin(); iter != mBuffers.end(); )
+    {
+        if (frame - iter->second.mLastUsed > BUFFER_LIFETIME)
+        {
+            iter = mBuffers.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+void FSMeshInstancer::release()
+{
+    mBuffers.clear();
+    mInstances.clear();
+    mBatches.clear();
+    mData.clear();
+
+    if (mUBO)
+    {
+        glDeleteBuffers(1, &mUBO);
+        mUBO = 0;
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ * @file fsmeshinstancer.h
+ * @brief Instanced drawing of static meshes repeated across the scene
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSMESHINSTANCER_H
+#define FS_FSMESHINSTANCER_H
+
+#include "llgl.h"
+#include "llspatialpartition.h"
+
+#include <map>
+#include <vector>
+
+// Draws the opaque PBR faces of static meshes with one instanced draw call
+// per mesh face, LOD and material instead of baking every copy into the
+// vertex buffers of its spatial group. The faces are picked when the group
+// is rebuilt (see add_mesh_instance() in llvovolume.cpp) and recorded with
+// their transforms in LLSpatialGroup::mMeshInstances. Visible groups with
+// instances are collected into the cull result with the render map.
+//
+// The geometry of every mesh face is kept once, in object space, in a vertex
+// buffer of its own, released some time after it was last drawn. The
+// instances of a pass are uploaded in one uniform buffer, 7 vec4s each, read
+// by the INSTANCED variants of pbropaqueV.glsl and shadowV.glsl.
+// Enabled with FSMeshInstancing.
+class FSMeshInstancer
+{
+public:
+    FSMeshInstancer();
+    ~FSMeshInstancer();
+
+    // Threads:  Tmain
+    // Draw the instances of the current cull result with the bound shader,
+    // gDeferredPBROpaqueInstancedProgram or gDeferredShadowInstancedProgram.
+    // Materials are bound unless shadow is set.
+    void render(bool shadow);
+
+    void release();
+
+private:
+    struct Buffer
+    {
+        LLPointer<LLVolume>         mVolume;        // keeps the key alive
+        LLPointer<LLVertexBuffer>   mVertexBuffer;
+        const LLVector4a*           mPositions = nullptr;   // the face data the buffer was made from
+        S32                         mNumVertices = 0;
+        S32                         mNumIndices = 0;
+        U32                         mLastUsed = 0;  // frame
+    };
+
+    struct Batch
+    {
+        U32 mFirst;     // in mInstances
+        U32 mCount;
+        U32 mOffset;    // in bytes, in the uniform buffer
+    };
+
+    typedef std::pair<const LLVolume*, S32> buffer_key_t;
+
+    LLVertexBuffer* getBuffer(LLVolume* volume, S32 face);
+    void evictBuffers();
+
+    std::map<buffer_key_t, Buffer>                      mBuffers;
+    std::vector<const LLSpatialGroup::MeshInstance*>    mInstances; // of the pass, sorted
+    std::vector<Batch>                                  mBatches;
+    std::vector<F32>                                    mData;      // uniform buffer contents
+    GLuint                                              mUBO;
+    U32                                                 mOffsetAlignment;   // in bytes
+    U32                                                 mLastEviction;      // frame
+};
+
+#endif // FS_FSMESHINSTANCER_H
@@ -46,6 +46,10 @@
 #include "rlvactions.h"
 #include "rlvhandler.h"
 
+// <FS> Diff-based radar list updates
+// Range changes below this many meters don't update a listed row
+constexpr F32 RADAR_RANGE_UPDATE_THRESHOLD = 0.5f;
+// </FS>
 
 /**
  * Update buttons on changes in our friend relations (STORM-557).
@@ -328,7 +332,27 @@ void FSPanelRadar::updateList(const std::vector<LLSD>& entries, const LLSD& stat
     bool needs_sort = mRadarList->isSorted();
     mRadarList->setNeedsSort(false);
 
-    mRadarList->clearRows();
+    // <FS> Diff-based radar list updates
+    // Rows of avatars still around are updated in place, only the cells
+    // that changed are touched.
+    //mRadarList->clearRows();
+    static LLCachedControl<bool> incremental_list(gSavedSettings, "FSRadarIncrementalList");
+    std::unordered_map<LLUUID, LLScrollListItem*> rows;
+    if (incremental_list)
+    {
+        for (LLScrollListItem* item : mRadarList->getAllData())
+        {
+            rows[item->getUUID()] = item;
+        }
+    }
+    else
+    {
+        mRadarList->clearRows();
+    }
+    std::unordered_map<LLUUID, LLSD> row_data_shown;
+    row_data_shown.reserve(entries.size());
+    bool list_changed = !incremental_list;
+    // </FS>
     for (const auto& avdata : entries)
     {
         constexpr char font_name[] = "SANSSERIF_SMALL";
@@ -395,7 +419,31 @@ void FSPanelRadar::updateList(const std::vector<LLSD>& entries, const LLSD& stat
         row_data["columns"][10]["column"] = "seen_sort";
         row_data["columns"][10]["value"] = entry["seen"].asString() + "_" + entry["name"].asString();
 
-        LLScrollListItem* row = mRadarList->addElement(row_data);
+        // <FS> Diff-based radar list updates
+        //LLScrollListItem* row = mRadarList->addElement(row_data);
+        const LLUUID avatar_id = entry["id"].asUUID();
+        LLScrollListItem* row = nullptr;
+        if (auto row_it = rows.find(avatar_id); row_it != rows.end())
+        {
+            row = row_it->second;
+            rows.erase(row_it);
+            if (auto last_it = mLastRowData.find(avatar_id); last_it != mLastRowData.end())
+            {
+                list_changed |= updateRow(row, last_it->second, row_data);
+            }
+            else
+            {
+                mRadarList->deleteSingleItem(mRadarList->getItemIndex(row));
+                row = nullptr;
+            }
+        }
+        if (!row)
+        {
+            row = mRadarList->addElement(row_data);
+            list_changed = true;
+        }
+        row_data_shown[avatar_id] = row_data;
+        // </FS>
 
         static S32 rangeColumnIndex = mRadarList->getColumn("range")->mIndex;
         static S32 nameColumnIndex = mRadarList->getColumn("name")->mIndex;
@@ -433,7 +481,20 @@ void FSPanelRadar::updateList(const std::vector<LLSD>& entries, const LLSD& stat
         }
     }
 
-    mRadarList->setNeedsSort(needs_sort);
+    // <FS> Diff-based radar list updates
+    // Rows of avatars that left
+    for (const auto& [avatar_id, row] : rows)
+    {
+        mRadarList->deleteSingleItem(mRadarList->getItemIndex(row));
+        list_changed = true;
+    }
+    mLastRowData.swap(row_data_shown);
+    // </FS>
+
+    // <FS> Diff-based radar list updates
+    //mRadarList->setNeedsSort(needs_sort);
+    mRadarList->setNeedsSort(needs_sort && list_changed);
+    // </FS>
     mRadarList->updateSort();
 
     LLStringUtil::format_map_t name_count_args;
@@ -463,6 +524,53 @@ void FSPanelRadar::updateList(const std::vector<LLSD>& entries, const LLSD& stat
     mChangeSignal();
 }
 
+// <FS> Diff-based radar list updates
+bool FSPanelRadar::updateRow(LLScrollListItem* row, const LLSD& last_row_data, LLSD& row_data)
+{
+    bool changed = false;
+    const LLSD& last_columns = last_row_data["columns"];
+    LLSD& columns = row_data["columns"];
+    for (LLSD::Integer i = 0; i < columns.size(); ++i)
+    {
+        LLSD& column = columns[i];
+        const LLSD& last_column = last_columns[i];
+        if (column["value"].asString() == last_column["value"].asString() &&
+            column["tool_tip"].asString() == last_column["tool_tip"].asString())
+        {
+            continue;
+        }
+
+        const std::string& column_name = column["column"].asStringRef();
+        if (column_name == "range")
+        {
+            // Ranges out of draw distance start with '>' and always update
+            const std::string& range = column["value"].asStringRef();
+            const std::string& last_range = last_column["value"].asStringRef();
+            if (!range.empty() && !last_range.empty() && range[0] != '>' && last_range[0] != '>' &&
+                fabs(atof(range.c_str()) - atof(last_range.c_str())) < RADAR_RANGE_UPDATE_THRESHOLD)
+            {
+                // Keep comparing against what is shown
+                column["value"] = last_column["value"];
+                continue;
+            }
+        }
+
+        LLScrollListColumn* list_column = mRadarList->getColumn(column_name);
+        LLScrollListCell* cell = list_column ? row->getColumn(list_column->mIndex) : nullptr;
+        if (cell)
+        {
+            cell->setValue(column["value"]);
+            if (column.has("tool_tip"))
+            {
+                cell->setToolTip(column["tool_tip"].asString());
+            }
+            changed = true;
+        }
+    }
+    return changed;
+}
+// </FS>
+
 void FSPanelRadar::onColumnDisplayModeChanged()
 {
     U32 column_config = gSavedSettings.getU32("FSRadarColumnConfig");
@@ -71,6 +71,7 @@ public:
 private:
     void                    updateButtons();
     void                    updateList(const std::vector<LLSD>& entries, const LLSD& stats);
+    bool                    updateRow(LLScrollListItem* row, const LLSD& last_row_data, LLSD& row_data); // <FS/> Diff-based radar list updates
 
     // UI callbacks
     void                    onAddFriendButtonClicked();
@@ -100,6 +101,11 @@ private:
     std::map<std::string, U32> mColumnBits;
     S32                     mLastResizeDelta;
 
+    // <FS> Diff-based radar list updates
+    // Row data each listed avatar was last shown with
+    std::unordered_map<LLUUID, LLSD>    mLastRowData;
+    // </FS>
+
     // Slot connection for FSRadar updates
     boost::signals2::connection mUpdateSignalConnection;
 
@@ -0,0 +1,285 @@
+/**
+ * @file fsperfstatstrace.cpp
+ * @brief Streams performance stats records to a trace file
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsperfstatstrace.h"
+
+#include "llperfstats.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+    // Binary traces start with this, the format version, the record size
+    // and the clock frequency as F64, followed by the raw records
+    constexpr char BINARY_MAGIC[4] = { 'F', 'S', 'P', 'T' };
+    constexpr U32 BINARY_VERSION = 1;
+
+    constexpr auto WRITER_INTERVAL = std::chrono::milliseconds(250);
+
+    const char* STAT_NAMES[] = {
+        "geometry",
+        "shadows",
+        "huds",
+        "ui",
+        "combined",
+        "swap",
+        "frame",
+        "display",
+        "sleep",
+        "lfs",
+        "meshrepo",
+        "fpslimit",
+        "fps",
+        "idle",
+        "done"
+    };
+    static_assert(LL_ARRAY_SIZE(STAT_NAMES) == static_cast<size_t>(LLPerfStats::StatType_t::STATS_COUNT), "STAT_NAMES out of sync with StatType_t");
+
+    const char* OBJ_NAMES[] = {
+        "scene",
+        "avatar"
+    };
+    static_assert(LL_ARRAY_SIZE(OBJ_NAMES) == static_cast<size_t>(LLPerfStats::ObjType_t::OT_COUNT), "OBJ_NAMES out of sync with ObjType_t");
+
+    // The ring of the calling thread, tagged with the trace object it
+    // belongs to
+    thread_local const FSPerfStatsTrace* tRingOwner = nullptr;
+    thread_local void* tRing = nullptr;
+}
+
+static_assert(sizeof(FSPerfStatsTrace::Record) == 48, "Trace records are written as is and must keep their layout");
+
+std::atomic<FSPerfStatsTrace*> FSPerfStatsTrace::sActive{ nullptr };
+
+// ----------------------------------------------------------------------------
+// FSPerfStatsTrace::Ring
+
+FSPerfStatsTrace::Ring::Ring() :
+    mRecords(new Record[CAPACITY]),
+    mHead(0),
+    mTail(0)
+{
+}
+
+bool FSPerfStatsTrace::Ring::push(const Record& record)
+{
+    const U32 head = mHead.load(std::memory_order_relaxed);
+    if (head - mTail.load(std::memory_order_acquire) >= CAPACITY)
+    {
+        return false;
+    }
+    mRecords[head & (CAPACITY - 1)] = record;
+    mHead.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+void FSPerfStatsTrace::Ring::drain(std::vector<Record>& out)
+{
+    const U32 tail = mTail.load(std::memory_order_relaxed);
+    const U32 head = mHead.load(std::memory_order_acquire);
+    for (U32 pos = tail; pos != head; ++pos)
+    {
+        out.push_back(mRecords[pos & (CAPACITY - 1)]);
+    }
+    mTail.store(head, std::memory_order_release);
+}
+
+void FSPerfStatsTrace::Ring::discard()
+{
+    mTail.store(mHead.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+// ----------------------------------------------------------------------------
+// FSPerfStatsTrace
+
+FSPerfStatsTrace::FSPerfStatsTrace() :
+    mDropped(0),
+    mRunning(false),
+    mFormat(EFormat::CSV),
+    mCPUHertz(0.0),
+    mWritten(0)
+{
+}
+
+FSPerfStatsTrace::~FSPerfStatsTrace()
+{
+    stop();
+}
+
+// static
+void FSPerfStatsTrace::record(const Record& record)
+{
+    FSPerfStatsTrace* self = sActive.load(std::memory_order_acquire);
+    if (!self)
+    {
+        return;
+    }
+
+    if (Ring* ring = self->getThreadRing(); !ring->push(record))
+    {
+        self->mDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FSPerfStatsTrace::Ring* FSPerfStatsTrace::getThreadRing()
+{
+    if (tRingOwner != this)
+    {
+        std::lock_guard<std::mutex> lock(mRingsMutex);
+        mRings.push_back(std::make_unique<Ring>());
+        tRing = mRings.back().get();
+        tRingOwner = this;
+    }
+    return static_cast<Ring*>(tRing);
+}
+
+bool FSPerfStatsTrace::start(const std::string& filename, EFormat format, F64 cpu_hertz)
+{
+    stop();
+
+    mFile.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!mFile.is_open())
+    {
+        LL_WARNS("PerfStats") << "Unable to open trace file " << filename << LL_ENDL;
+        return false;
+    }
+
+    mFormat = format;
+    mCPUHertz = cpu_hertz;
+    mWritten = 0;
+    mDropped = 0;
+    {
+        // Leftovers of an earlier trace
+        std::lock_guard<std::mutex> lock(mRingsMutex);
+        for (auto& ring : mRings)
+        {
+            ring->discard();
+        }
+    }
+
+    if (mFormat == EFormat::Binary)
+    {
+        const U32 record_size = sizeof(Record);
+        mFile.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        mFile.write(reinterpret_cast<const char*>(&BINARY_VERSION), sizeof(BINARY_VERSION));
+        mFile.write(reinterpret_cast<const char*>(&record_size), sizeof(record_size));
+        mFile.write(reinterpret_cast<const char*>(&mCPUHertz), sizeof(mCPUHertz));
+    }
+    else
+    {
+        mFile << "frame,kind,stat,object,flags,tuned_avatars,tuning_flags,value_us,value2_us,id\n";
+    }
+
+    LL_INFOS("PerfStats") << "Writing performance trace to " << filename << LL_ENDL;
+    mRunning = true;
+    mWriter = std::thread([this]() { writerLoop(); });
+    sActive = this;
+    return true;
+}
+
+void FSPerfStatsTrace::stop()
+{
+    sActive = nullptr;
+    if (!mWriter.joinable())
+    {
+        return;
+    }
+
+    mRunning = false;
+    mWriter.join();
+
+    // Whatever was recorded before recording stopped
+    std::vector<Record> records;
+    flush(records);
+    mFile.close();
+
+    LL_INFOS("PerfStats") << "Performance trace finished, " << mWritten << " records written, " << mDropped << " dropped" << LL_ENDL;
+}
+
+void FSPerfStatsTrace::writerLoop()
+{
+    LL_PROFILER_SET_THREAD_NAME("PerfStats trace");
+
+    std::vector<Record> records;
+    while (mRunning)
+    {
+        std::this_thread::sleep_for(WRITER_INTERVAL);
+        flush(records);
+    }
+}
+
+void FSPerfStatsTrace::flush(std::vector<Record>& records)
+{
+    records.clear();
+    {
+        std::lock_guard<std::mutex> lock(mRingsMutex);
+        for (auto& ring : mRings)
+        {
+            ring->drain(records);
+        }
+    }
+    if (records.empty())
+    {
+        return;
+    }
+
+    // Rings are drained one after the other, keep the file in frame order
+    std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) { return a.mFrame < b.mFrame; });
+    writeRecords(records);
+    mWritten += records.size();
+}
+
+void FSPerfStatsTrace::writeRecords(const std::vector<Record>& records)
+{
+    if (mFormat == EFormat::Binary)
+    {
+        mFile.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+        return;
+    }
+
+    const F64 us_per_tick = (mCPUHertz > 0.0) ? 1000000.0 / mCPUHertz : 0.0;
+    std::string line;
+    for (const Record& record : records)
+    {
+        if (record.mKind == static_cast<U8>(EKind::Frame))
+        {
+            line = llformat("%u,frame,,,%u,%u,%u,%.3f,%.3f,\n", record.mFrame, record.mFlags, record.mCount, record.mTuning,
+                            (F64)record.mValue / 1000.0, (F64)record.mValue2 * us_per_tick);
+        }
+        else
+        {
+            const char* stat = (record.mStatType < LL_ARRAY_SIZE(STAT_NAMES)) ? STAT_NAMES[record.mStatType] : "unknown";
+            const char* obj = (record.mObjType < LL_ARRAY_SIZE(OBJ_NAMES)) ? OBJ_NAMES[record.mObjType] : "unknown";
+            line = llformat("%u,stat,%s,%s,%u,,,%.3f,,%s\n", record.mFrame, stat, obj, record.mFlags,
+                            (F64)record.mValue * us_per_tick, record.mID.notNull() ? record.mID.asString().c_str() : "");
+        }
+        mFile << line;
+    }
+}
@@ -0,0 +1,130 @@
+/**
+ * @file fsperfstatstrace.h
+ * @brief Streams performance stats records to a trace file
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSPERFSTATSTRACE_H
+#define FS_FSPERFSTATSTRACE_H
+
+#include "llfile.h"
+#include "llsingleton.h"
+#include "lluuid.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Writes the records LLPerfStats collects, plus one summary record per
+// frame with the state of the autotune, to a trace file so frame costs and
+// tuning decisions can be analyzed offline.
+//
+// Recording threads put fixed size records into a ring buffer of their own.
+// Each ring has one producer and one consumer and needs no lock on either
+// side. A writer thread drains the rings a few times a second and appends
+// the records to the file, either as CSV or in binary. When a ring is full
+// the record is dropped and counted; recording never waits for the disk.
+class FSPerfStatsTrace : public LLSingleton<FSPerfStatsTrace>
+{
+    LLSINGLETON(FSPerfStatsTrace);
+    ~FSPerfStatsTrace();
+
+public:
+    enum class EKind : U8
+    {
+        Stat = 0,
+        Frame = 1
+    };
+
+    enum class EFormat
+    {
+        CSV,
+        Binary
+    };
+
+    struct Record
+    {
+        U32     mFrame;
+        U8      mKind;
+        U8      mStatType;
+        U8      mObjType;
+        U8      mFlags;     // Stat: 1 rigged, 2 HUD. Frame: 1 below target FPS
+        U32     mCount;     // Frame: number of tuned avatars
+        U32     mTuning;    // Frame: tunables changed by the autotune this frame
+        U64     mValue;     // Stat: time in clock ticks. Frame: avatar render time limit in ns
+        U64     mValue2;    // Frame: mean frame time in clock ticks
+        LLUUID  mID;        // Stat: avatar or object
+    };
+
+    static bool isActive() { return sActive.load(std::memory_order_relaxed) != nullptr; }
+    // Safe to call from any thread, does nothing unless a trace is running
+    static void record(const Record& record);
+
+    // Both on the main thread only
+    bool start(const std::string& filename, EFormat format, F64 cpu_hertz);
+    void stop();
+
+private:
+    class Ring
+    {
+    public:
+        static constexpr U32 CAPACITY = 8192;   // Power of two
+
+        Ring();
+        bool push(const Record& record);        // Producer side
+        void drain(std::vector<Record>& out);   // Consumer side
+        void discard();                         // Consumer side
+
+    private:
+        std::unique_ptr<Record[]>   mRecords;
+        std::atomic<U32>            mHead;      // Next slot to write, only advanced by the producer
+        std::atomic<U32>            mTail;      // Next slot to read, only advanced by the consumer
+    };
+
+    Ring* getThreadRing();
+    void writerLoop();
+    void flush(std::vector<Record>& records);
+    void writeRecords(const std::vector<Record>& records);
+
+    // The running trace, null when none is. Kept apart from the singleton so
+    // recording doesn't go through the singleton lookup.
+    static std::atomic<FSPerfStatsTrace*> sActive;
+
+    // Rings stay registered for the lifetime of the trace object, a thread
+    // keeps its ring across traces
+    std::mutex                          mRingsMutex;
+    std::vector<std::unique_ptr<Ring>>  mRings;
+    std::atomic<U64>                    mDropped;
+
+    std::thread         mWriter;
+    std::atomic<bool>   mRunning;
+    llofstream          mFile;
+    EFormat             mFormat;
+    F64                 mCPUHertz;
+    U64                 mWritten;
+};
+
+#endif // FS_FSPERFSTATSTRACE_H
@@ -0,0 +1,249 @@
+/**
+ * @file fsregioncrosspreload.cpp
+ * @brief Loads the region ahead before the agent crosses into it
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsregioncrosspreload.h"
+
+#include "fsregionprefetch.h"
+
+#include "llagent.h"
+#include "lldrawable.h"
+#include "llface.h"
+#include "llframetimer.h"
+#include "llmeshrepository.h"
+#include "llviewercamera.h"
+#include "llviewercontrol.h"
+#include "llviewerregion.h"
+#include "llviewertexture.h"
+#include "llvoavatarself.h"
+#include "llvocache.h"
+#include "llvolumemgr.h"
+#include "llvovolume.h"
+#include "llworld.h"
+
+namespace
+{
+    // Points along the path checked for a crossing
+    constexpr S32 PATH_STEPS = 8;
+
+    // Halvings of the step a crossing was found in
+    constexpr S32 REFINE_STEPS = 6;
+
+    const U32 TEXTURE_CHANNELS[] = { LLRender::DIFFUSE_MAP, LLRender::NORMAL_MAP, LLRender::SPECULAR_MAP };
+}
+
+FSRegionCrossPreload::FSRegionCrossPreload()
+:   mLastUpdate(0.0),
+    mRegionHandle(0)
+{
+}
+
+FSRegionCrossPreload::~FSRegionCrossPreload()
+{
+}
+
+void FSRegionCrossPreload::update()
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    static LLCachedControl<bool> enabled(gSavedSettings, "FSRegionCrossPreload", true);
+    static LLCachedControl<F32> lookahead(gSavedSettings, "FSRegionCrossPreloadSeconds", 10.f);
+    static LLCachedControl<F32> min_speed(gSavedSettings, "FSRegionCrossPreloadMinSpeed", 4.f);
+    static LLCachedControl<F32> radius(gSavedSettings, "FSRegionCrossPreloadRadius", 64.f);
+
+    if (!enabled || !isAgentAvatarValid() || !gAgent.getRegion())
+    {
+        mVelocity.clear();
+        mLastUpdate = 0.0;
+        clear();
+        return;
+    }
+
+    // the vehicle when sitting on one, the avatar moves with it
+    LLViewerObject* mover = gAgentAvatarp->getRootEdit();
+
+    const F64 now = LLFrameTimer::getElapsedSeconds();
+    const F32 dt = mLastUpdate > 0.0 ? (F32)(now - mLastUpdate) : 0.f;
+    mLastUpdate = now;
+    mVelocity.update(mover->getVelocity(), dt);
+
+    const LLVector3 velocity = mVelocity.get();
+    LLVector3d crossing;
+    LLViewerRegion* target = NULL;
+    if (velocity.length() >= min_speed)
+    {
+        target = predictCrossing(mover->getPositionGlobal(), velocity, lookahead, crossing);
+    }
+
+    if (!target || target->getHandle() != mRegionHandle)
+    {
+        clear();
+    }
+    if (!target)
+    {
+        return;
+    }
+    if (!mRegionHandle)
+    { // the textures in use there the last time, out of view ones too
+        mRegionHandle = target->getHandle();
+        FSRegionPrefetch::instance().prefetchRegion(mRegionHandle);
+    }
+
+    // The sphere sits just past the crossing point, where the agent will be
+    // right after the crossing
+    LLVector3 heading = velocity;
+    heading.normalize();
+    const LLVector3 crossing_agent = gAgent.getPosAgentFromGlobal(crossing);
+    target->setPreloadSphere(crossing_agent + heading * (radius * 0.5f), radius);
+
+    for (const LLPointer<LLVOCacheEntry>& entry : target->getPreloadEntries())
+    {
+        if (!entry->isState(LLVOCacheEntry::ACTIVE) || !entry->getEntry())
+        {
+            continue;
+        }
+
+        LLDrawable* drawable = (LLDrawable*)entry->getEntry()->getDrawable();
+        LLViewerObject* root = drawable ? drawable->getVObj().get() : NULL;
+        if (!root || root->isDead())
+        {
+            continue;
+        }
+
+        boostObject(root, crossing_agent);
+        for (LLViewerObject* child : root->getChildren())
+        {
+            boostObject(child, crossing_agent);
+        }
+    }
+}
+
+LLViewerRegion* FSRegionCrossPreload::predictCrossing(const LLVector3d& position, const LLVector3& velocity, F32 lookahead,
+    LLVector3d& crossing) const
+{
+    LLWorld* world = LLWorld::getInstance();
+    const LLViewerRegion* here = world->getRegionFromPosGlobal(position);
+    if (!here)
+    {
+        return NULL;
+    }
+
+    const LLVector3d velocity_global(velocity);
+    F32 before = 0.f;
+    for (S32 i = 1; i <= PATH_STEPS; ++i)
+    {
+        F32 after = lookahead * i / PATH_STEPS;
+        LLViewerRegion* region = world->getRegionFromPosGlobal(position + velocity_global * after);
+        if (!region)
+        {
+            return NULL;    // off the edge of the known world, nothing to load
+        }
+        if (region == here)
+        {
+            before = after;
+            continue;
+        }
+
+        // close in on the region border
+        for (S32 j = 0; j < REFINE_STEPS; ++j)
+        {
+            const F32 middle = (before + after) * 0.5f;
+            if (world->getRegionFromPosGlobal(position + velocity_global * middle) == here)
+            {
+                before = middle;
+            }
+            else
+            {
+                after = middle;
+            }
+        }
+
+        crossing = position + velocity_global * after;
+        return world->getRegionFromPosGlobal(crossing);
+    }
+
+    return NULL;
+}
+
+void FSRegionCrossPreload::boostObject(LLViewerObject* object, const LLVector3& crossing_agent)
+{
+    LLDrawable* drawable = object->mDrawable;
+    if (!drawable || object->isDead())
+    {
+        return;
+    }
+
+    // what it covers of the screen seen from the crossing point
+    const F32 radius = llmax(drawable->getRadius(), 0.1f);
+    const F32 distance = llmax(dist_vec(object->getPositionAgent(), crossing_agent), radius);
+    const F32 screen_area = (F32)LLViewerCamera::getInstance()->getScreenPixelArea();
+    const F32 virtual_size = screen_area * (radius * radius) / (distance * distance);
+
+    for (S32 i = 0; i < drawable->getNumFaces(); ++i)
+    {
+        LLFace* face = drawable->getFace(i);
+        if (!face)
+        {
+            continue;
+        }
+
+        for (U32 channel : TEXTURE_CHANNELS)
+        {
+            LLViewerTexture* texture = face->getTexture(channel);
+            if (texture)
+            {
+                texture->addTextureStats(virtual_size);
+            }
+        }
+    }
+
+    // once a crossing, the mesh repository notifies the object when it arrives
+    if (object->isMesh() && mMeshRequested.insert(object->getID()).second)
+    {
+        LLVOVolume* volume = (LLVOVolume*)object;
+        const S32 lod = LLVolumeLODGroup::getDetailFromTan(ll_round(LLVOVolume::sLODFactor * radius / distance, 0.01f));
+        if (lod > volume->getLOD() && volume->getVolume())
+        {
+            gMeshRepo.loadMesh(volume, volume->getVolume()->getParams(), lod, volume->getLOD());
+        }
+    }
+}
+
+void FSRegionCrossPreload::clear()
+{
+    if (mRegionHandle)
+    {
+        LLViewerRegion* region = LLWorld::getInstance()->getRegionFromHandle(mRegionHandle);
+        if (region)
+        {
+            region->setPreloadSphere(LLVector3::zero, 0.f);
+        }
+        mRegionHandle = 0;
+    }
+    mMeshRequested.clear();
+}
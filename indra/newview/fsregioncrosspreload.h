@@ -0,0 +1,79 @@
+/**
+ * @file fsregioncrosspreload.h
+ * @brief Loads the region ahead before the agent crosses into it
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSREGIONCROSSPRELOAD_H
+#define FS_FSREGIONCROSSPRELOAD_H
+
+#include "llsingleton.h"
+#include "lluuid.h"
+#include "v3dmath.h"
+#include "v3math.h"
+
+#include "fsregioncross.h"
+
+#include <unordered_set>
+
+class LLViewerObject;
+class LLViewerRegion;
+
+// Predicts where the agent, or the vehicle it sits on, crosses into a
+// neighbouring region from its smoothed velocity, and gets that region ready
+// before the crossing rather than after it.
+//
+// While a crossing is expected within the lookahead, the neighbour is given
+// a preload sphere just past the crossing point. Its cached objects in the
+// sphere are created as if they were in view, the textures of the ones that
+// exist are fetched at the size they have seen from the crossing point and
+// their meshes at the LOD they need from there. The texture trace
+// FSRegionPrefetch recorded the last time the agent was there is replayed
+// too. Objects that aren't in the object cache have to wait for the region
+// to send them once it is entered.
+// Enabled with FSRegionCrossPreload.
+class FSRegionCrossPreload : public LLSingleton<FSRegionCrossPreload>
+{
+    LLSINGLETON(FSRegionCrossPreload);
+    ~FSRegionCrossPreload();
+
+public:
+    // Threads:  Tmain
+    // Once a frame, before the idle updates of the regions
+    void update();
+
+private:
+    // The region the agent enters within lookahead seconds, or NULL
+    LLViewerRegion* predictCrossing(const LLVector3d& position, const LLVector3& velocity, F32 lookahead,
+        LLVector3d& crossing) const;
+    void boostObject(LLViewerObject* object, const LLVector3& crossing_agent);
+    void clear();
+
+    LowPassFilter                   mVelocity;
+    std::unordered_set<LLUUID>      mMeshRequested;     // objects of this crossing
+    F64                             mLastUpdate;        // seconds
+    U64                             mRegionHandle;      // of the preloaded region, 0 for none
+};
+
+#endif // FS_FSREGIONCROSSPRELOAD_H
@@ -0,0 +1,217 @@
+/**
+ * @file fsregionprefetch.cpp
+ * @brief Per-region asset traces replayed as prefetch on teleport
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsregionprefetch.h"
+
+#include "llagent.h"
+#include "llcallbacklist.h"
+#include "llfilesystem.h"
+#include "llviewercontrol.h"
+#include "llviewernetwork.h"
+#include "llviewerregion.h"
+#include "llviewertexturelist.h"
+
+// Trace layout: header, then texture records
+static const U32 TRACE_MAGIC = 0x46525054; // "TPRF"
+static const U32 TRACE_VERSION = 2;
+static const U32 MAX_TRACE_TEXTURES = 1000;
+
+struct trace_header_t
+{
+    U32 mMagic;
+    U32 mVersion;
+    U32 mTextureCount;
+};
+
+struct trace_texture_t
+{
+    U8  mID[UUID_BYTES];
+    S32 mPixelArea;
+    S32 mType;
+};
+
+FSRegionPrefetch::FSRegionPrefetch()
+{
+    mRegionChangedConnection = gAgent.addRegionChangedCallback([this]() { onRegionChanged(); });
+
+    // We may already be in a region by the time we get created
+    onRegionChanged();
+}
+
+FSRegionPrefetch::~FSRegionPrefetch()
+{
+    mRegionChangedConnection.disconnect();
+}
+
+// static
+LLUUID FSRegionPrefetch::getTraceID(U64 region_handle)
+{
+    // Region handles are only unique per grid
+    return LLUUID::generateNewID(llformat("region_prefetch_trace:%s:%llu",
+                                          LLGridManager::getInstance()->getGridId().c_str(),
+                                          (unsigned long long)region_handle));
+}
+
+void FSRegionPrefetch::onRegionChanged()
+{
+    static LLCachedControl<bool> prefetch_enabled(gSavedSettings, "FSRegionPrefetchEnabled");
+    static LLCachedControl<F32> record_delay(gSavedSettings, "FSRegionPrefetchRecordDelay");
+
+    // Invalidate any pending recording for the region we just left
+    U32 generation = ++mGeneration;
+
+    LLViewerRegion* regionp = gAgent.getRegion();
+    if (!prefetch_enabled || !regionp)
+    {
+        return;
+    }
+
+    U64 region_handle = regionp->getHandle();
+    doAfterInterval([region_handle, generation]()
+                    {
+                        if (instanceExists())
+                        {
+                            getInstance()->recordTrace(region_handle, generation);
+                        }
+                    },
+                    llmax((F32)record_delay, 1.f));
+}
+
+void FSRegionPrefetch::recordTrace(U64 region_handle, U32 generation)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    LLViewerRegion* regionp = gAgent.getRegion();
+    if (generation != mGeneration || !regionp || regionp->getHandle() != region_handle)
+    {
+        // We left the region before the trace was due
+        return;
+    }
+
+    // Same selection as the login texture list in LLViewerTextureList::shutdown()
+    typedef std::multimap<S32, LLViewerFetchedTexture*, std::greater<S32> > image_area_map_t;
+    image_area_map_t image_area_map;
+    for (LLViewerFetchedTexture* image : gTextureList)
+    {
+        if (!image->hasGLTexture() ||
+            !image->getUseDiscard() ||
+            image->needsAux() ||
+            !image->getTargetHost().isInvalid() ||
+            !image->getUrl().empty() ||
+            image->isInvisiprim() ||
+            !image->getBoundRecently())
+        {
+            continue; // avoid UI, baked, and other special images
+        }
+        S32 desired = image->getDesiredDiscardLevel();
+        if (desired >= 0 && desired < MAX_DISCARD_LEVEL)
+        {
+            image_area_map.emplace(image->getWidth(desired) * image->getHeight(desired), image);
+        }
+    }
+
+    std::vector<trace_texture_t> textures;
+    textures.reserve(llmin((U32)image_area_map.size(), MAX_TRACE_TEXTURES));
+    for (const auto& [pixel_area, image] : image_area_map)
+    {
+        if (textures.size() >= MAX_TRACE_TEXTURES)
+        {
+            break;
+        }
+        trace_texture_t record;
+        memcpy(record.mID, image->getID().mData, UUID_BYTES);
+        record.mPixelArea = pixel_area;
+        record.mType = (S32)image->getType();
+        textures.push_back(record);
+    }
+
+    if (textures.empty())
+    {
+        return;
+    }
+
+    trace_header_t header = { TRACE_MAGIC, TRACE_VERSION, (U32)textures.size() };
+    std::vector<U8> data(sizeof(header) + textures.size() * sizeof(trace_texture_t));
+    memcpy(data.data(), &header, sizeof(header));
+    memcpy(data.data() + sizeof(header), textures.data(), textures.size() * sizeof(trace_texture_t));
+
+    LL_DEBUGS("RegionPrefetch") << "Recording " << textures.size() << " textures for region " << region_handle << LL_ENDL;
+    LLFileSystem::writeAsync(getTraceID(region_handle), LLAssetType::AT_UNKNOWN, std::move(data), LLFileSystem::WRITE, nullptr);
+}
+
+void FSRegionPrefetch::prefetchRegion(U64 region_handle)
+{
+    static LLCachedControl<bool> prefetch_enabled(gSavedSettings, "FSRegionPrefetchEnabled");
+    if (!prefetch_enabled)
+    {
+        return;
+    }
+
+    LLFileSystem::readAsync(getTraceID(region_handle), LLAssetType::AT_UNKNOWN, 0, -1,
+        [region_handle](bool success, std::vector<U8>& data)
+        {
+            // Back on the main thread
+            trace_header_t header;
+            if (!success || data.size() < sizeof(header))
+            {
+                return;
+            }
+            memcpy(&header, data.data(), sizeof(header));
+            if (header.mMagic != TRACE_MAGIC || header.mVersion != TRACE_VERSION ||
+                header.mTextureCount > MAX_TRACE_TEXTURES ||
+                data.size() != sizeof(header) + header.mTextureCount * sizeof(trace_texture_t))
+            {
+                LL_WARNS("RegionPrefetch") << "Ignoring invalid prefetch trace for region " << region_handle << LL_ENDL;
+                return;
+            }
+
+            const U8* ptr = data.data() + sizeof(header);
+            S32 texture_count = 0;
+            for (U32 i = 0; i < header.mTextureCount; ++i, ptr += sizeof(trace_texture_t))
+            {
+                trace_texture_t record;
+                memcpy(&record, ptr, sizeof(record));
+                LLUUID id;
+                memcpy(id.mData, record.mID, UUID_BYTES);
+
+                // Same as the login prefetch in LLViewerTextureList::doPrefetchImages()
+                if ((LLViewerTexture::FETCHED_TEXTURE == record.mType || LLViewerTexture::LOD_TEXTURE == record.mType) && !LLViewerTexture::isInvisiprim(id))
+                {
+                    LLViewerFetchedTexture* image = LLViewerTextureManager::getFetchedTexture(id, FTT_DEFAULT, MIPMAP_TRUE, LLGLTexture::BOOST_NONE, (S8)record.mType);
+                    if (image)
+                    {
+                        image->addTextureStats((F32)record.mPixelArea);
+                        ++texture_count;
+                    }
+                }
+            }
+
+            LL_DEBUGS("RegionPrefetch") << "Prefetching " << texture_count << " textures for region " << region_handle << LL_ENDL;
+        });
+}
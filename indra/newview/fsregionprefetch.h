@@ -0,0 +1,58 @@
+/**
+ * @file fsregionprefetch.h
+ * @brief Per-region asset traces replayed as prefetch on teleport
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSREGIONPREFETCH_H
+#define FS_FSREGIONPREFETCH_H
+
+#include "llsingleton.h"
+
+// A few seconds after arriving in a region we record which textures are
+// in use there and store that trace in the asset cache, keyed by region
+// handle. The next time we teleport to that region the trace is replayed
+// as soon as the destination is known: the textures are requested the
+// same way the login texture list is.
+class FSRegionPrefetch : public LLSingleton<FSRegionPrefetch>
+{
+    LLSINGLETON(FSRegionPrefetch);
+    ~FSRegionPrefetch();
+
+public:
+    // Called from process_teleport_finish() with the destination handle,
+    // and by FSRegionCrossPreload ahead of a region crossing
+    void prefetchRegion(U64 region_handle);
+
+private:
+    void onRegionChanged();
+    void recordTrace(U64 region_handle, U32 generation);
+
+    static LLUUID getTraceID(U64 region_handle);
+
+    boost::signals2::connection mRegionChangedConnection;
+    U32 mGeneration{ 0 };
+};
+
+#endif // FS_FSREGIONPREFETCH_H
@@ -0,0 +1,515 @@
+/**
+ * @file fsscenebundle.cpp
+ * @brief Captures a region with its assets to a bundle and replays it
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsscenebundle.h"
+
+#include "llagent.h"
+#include "llappviewer.h"
+#include "llcallbacklist.h"
+#include "llfilesystem.h"
+#include "llimage.h"
+#include "llsdserialize.h"
+#include "llsdutil.h"
+#include "llsdutil_math.h"
+#include "llslurl.h"
+#include "llversioninfo.h"
+#include "llviewercamera.h"
+#include "llviewercontrol.h"
+#include "llviewerobjectlist.h"
+#include "llviewerregion.h"
+#include "llvoavatar.h"
+#include "llvocache.h"
+
+namespace
+{
+    constexpr S32 BUNDLE_VERSION = 1;
+    constexpr char MANIFEST_FILENAME[] = "manifest.llsd";
+    constexpr char OBJECTS_FILENAME[] = "objects.slc";
+    constexpr char PATH_FILENAME[] = "path.xml";
+    constexpr char ASSETS_DIRNAME[] = "assets";
+
+    // Texture cache reads in flight while capturing
+    constexpr size_t MAX_TEXTURE_READS = 16;
+    // The texture cache keeps a small decoded copy of each texture, written
+    // along with it. Textures are decoded at the discard level that is at
+    // most this big for that.
+    constexpr S32 FAST_CACHE_DIMENSION = 64;
+    constexpr F32 INSTALL_TIMEOUT = 60.f;
+
+    std::string asset_path(const std::string& dir, const LLUUID& id, const char* extension)
+    {
+        return gDirUtilp->add(dir, ASSETS_DIRNAME, id.asString() + extension);
+    }
+
+    bool write_file(const std::string& filename, const U8* data, S32 size)
+    {
+        LLFILE* fp = LLFile::fopen(filename, "wb");
+        if (!fp)
+        {
+            return false;
+        }
+        const bool success = fwrite(data, 1, size, fp) == (size_t)size;
+        fclose(fp);
+        return success;
+    }
+
+    void add_id(std::set<LLUUID>& ids, const LLUUID& id)
+    {
+        if (id.notNull())
+        {
+            ids.insert(id);
+        }
+    }
+}
+
+FSSceneBundle::FSSceneBundle()
+{
+}
+
+FSSceneBundle::~FSSceneBundle()
+{
+    LLTextureCache* cache = LLAppViewer::getTextureCache();
+    for (TextureRead& read : mTextureReads)
+    {
+        if (cache)
+        {
+            cache->readComplete(read.mHandle, true);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Capture
+
+bool FSSceneBundle::capture(const std::string& dir)
+{
+    LLViewerRegion* region = gAgent.getRegion();
+    if (isCapturing() || !region)
+    {
+        return false;
+    }
+
+    LLFile::mkdir(dir);
+    LLFile::mkdir(gDirUtilp->add(dir, ASSETS_DIRNAME));
+    if (!region->exportObjectCache(gDirUtilp->add(dir, OBJECTS_FILENAME)))
+    {
+        LL_WARNS("SceneBundle") << "Unable to write the object cache of " << region->getName() << " to " << dir << LL_ENDL;
+        return false;
+    }
+
+    mCaptureDir = dir;
+    mManifest = LLSD::emptyMap();
+    mManifest["version"] = BUNDLE_VERSION;
+    mManifest["viewer"] = LLVersionInfo::instance().getChannelAndVersion();
+    mManifest["captured"] = LLDate::now();
+
+    LLSD& region_sd = mManifest["region"];
+    region_sd["name"] = region->getName();
+    region_sd["handle"] = ll_sd_from_U64(region->getHandle());
+    region_sd["location"] = LLSLURL(region->getName(), gAgent.getPositionAgent()).getSLURLString();
+    region_sd["objects"] = OBJECTS_FILENAME;
+
+    const LLViewerCamera& camera = LLViewerCamera::instance();
+    LLSD& camera_sd = mManifest["camera"];
+    camera_sd["origin"] = ll_sd_from_vector3(camera.getOrigin());
+    camera_sd["at"] = ll_sd_from_vector3(camera.getAtAxis());
+    camera_sd["up"] = ll_sd_from_vector3(camera.getUpAxis());
+    camera_sd["view"] = camera.getView();
+
+    const std::string path_filename = gSavedSettings.getString("StatsPilotXMLFile");
+    if (LLFile::isfile(path_filename) && LLFile::copy(path_filename, gDirUtilp->add(dir, PATH_FILENAME)))
+    {
+        mManifest["camera_path"] = PATH_FILENAME;
+    }
+
+    std::set<LLUUID> textures;
+    std::set<LLUUID> meshes;
+    collectAssets(region, textures, meshes);
+    mManifest["avatars"] = captureAvatars(region, textures);
+    const U32 mesh_count = captureMeshes(meshes);
+
+    mManifest["textures"] = LLSD::emptyMap();
+    mTexturesToRead.assign(textures.begin(), textures.end());
+    LL_INFOS("SceneBundle") << "Capturing " << region->getName() << " to " << dir << ": " << mesh_count << " of "
+                            << meshes.size() << " meshes written, reading " << textures.size() << " textures" << LL_ENDL;
+
+    doOnIdleRepeating([]()
+    {
+        return !FSSceneBundle::instanceExists() || FSSceneBundle::instance().updateCapture();
+    });
+    return true;
+}
+
+void FSSceneBundle::collectAssets(LLViewerRegion* region, std::set<LLUUID>& textures, std::set<LLUUID>& meshes)
+{
+    for (S32 i = 0; i < gObjectList.getNumObjects(); ++i)
+    {
+        LLViewerObject* object = gObjectList.getObject(i);
+        if (!object || object->isDead() || object->getRegion() != region)
+        {
+            continue;
+        }
+
+        for (U8 te = 0; te < object->getNumTEs(); ++te)
+        {
+            const LLTextureEntry* entry = object->getTE(te);
+            if (!entry)
+            {
+                continue;
+            }
+            add_id(textures, entry->getID());
+            if (const LLMaterial* material = entry->getMaterialParams().get())
+            {
+                add_id(textures, material->getNormalID());
+                add_id(textures, material->getSpecularID());
+            }
+            if (const LLGLTFMaterial* material = entry->getGLTFRenderMaterial())
+            {
+                for (const LLUUID& id : material->mTextureId)
+                {
+                    add_id(textures, id);
+                }
+            }
+        }
+
+        if (object->isSculpted() && object->getVolume())
+        {
+            const LLUUID& sculpt_id = object->getVolume()->getParams().getSculptID();
+            add_id(object->isMesh() ? meshes : textures, sculpt_id);
+        }
+    }
+}
+
+LLSD FSSceneBundle::captureAvatars(LLViewerRegion* region, std::set<LLUUID>& textures)
+{
+    LLSD avatars = LLSD::emptyArray();
+    for (LLCharacter* character : LLCharacter::sInstances)
+    {
+        LLVOAvatar* avatar = dynamic_cast<LLVOAvatar*>(character);
+        if (!avatar || avatar->isDead() || avatar->getRegion() != region || avatar->isControlAvatar())
+        {
+            continue;
+        }
+
+        LLSD avatar_sd;
+        avatar_sd["id"] = avatar->getID();
+        avatar_sd["position"] = ll_sd_from_vector3(avatar->getPositionRegion());
+
+        LLSD& params = avatar_sd["visual_params"];
+        params = LLSD::emptyMap();
+        for (LLVisualParam* param = avatar->getFirstVisualParam(); param; param = avatar->getNextVisualParam())
+        {
+            if (param->getGroup() == VISUAL_PARAM_GROUP_TWEAKABLE)
+            {
+                params[llformat("%d", param->getID())] = param->getWeight();
+            }
+        }
+
+        LLSD& texture_ids = avatar_sd["textures"];
+        texture_ids = LLSD::emptyArray();
+        for (U8 te = 0; te < avatar->getNumTEs(); ++te)
+        {
+            const LLTextureEntry* entry = avatar->getTE(te);
+            texture_ids.append(entry ? entry->getID() : LLUUID::null);
+            if (entry)
+            {
+                add_id(textures, entry->getID());
+            }
+        }
+        avatars.append(avatar_sd);
+    }
+    return avatars;
+}
+
+U32 FSSceneBundle::captureMeshes(const std::set<LLUUID>& meshes)
+{
+    LLSD& meshes_sd = mManifest["meshes"];
+    meshes_sd = LLSD::emptyMap();
+
+    std::vector<U8> buffer;
+    for (const LLUUID& id : meshes)
+    {
+        LLFileSystem file(id, LLAssetType::AT_MESH);
+        const S32 size = file.getSize();
+        if (size <= 0)
+        {
+            continue;
+        }
+        buffer.resize(size);
+        if (file.read(buffer.data(), size) && write_file(asset_path(mCaptureDir, id, ".mesh"), buffer.data(), size))
+        {
+            meshes_sd[id.asString()]["size"] = size;
+        }
+    }
+    return (U32)meshes_sd.size();
+}
+
+bool FSSceneBundle::updateCapture()
+{
+    LLTextureCache* cache = LLAppViewer::getTextureCache();
+    if (!isCapturing() || !cache)
+    {
+        return true;
+    }
+
+    while (mTextureReads.size() < MAX_TEXTURE_READS && !mTexturesToRead.empty())
+    {
+        TextureRead read;
+        read.mID = mTexturesToRead.back();
+        read.mReader = new TextureReader();
+        read.mHandle = cache->readFromCache(read.mID, 0, MAX_IMAGE_DATA_SIZE, read.mReader);
+        mTexturesToRead.pop_back();
+        mTextureReads.push_back(read);
+    }
+
+    LLSD& textures_sd = mManifest["textures"];
+    for (size_t i = 0; i < mTextureReads.size(); )
+    {
+        TextureRead& read = mTextureReads[i];
+        if (!read.mReader->isDone())
+        {
+            ++i;
+            continue;
+        }
+
+        cache->readComplete(read.mHandle, false);
+        LLImageFormatted* image = read.mReader->getImage();
+        if (read.mReader->succeeded() && image && image->getData() && image->getDataSize() > 0
+            && write_file(asset_path(mCaptureDir, read.mID, ".tex"), image->getData(), image->getDataSize()))
+        {
+            LLSD& texture_sd = textures_sd[read.mID.asString()];
+            texture_sd["size"] = image->getDataSize();
+            texture_sd["image_size"] = read.mReader->getImageSize();
+            texture_sd["codec"] = (S32)image->getCodec();
+        }
+        mTextureReads[i] = mTextureReads.back();
+        mTextureReads.pop_back();
+    }
+
+    if (mTextureReads.empty() && mTexturesToRead.empty())
+    {
+        finishCapture();
+        return true;
+    }
+    return false;
+}
+
+void FSSceneBundle::finishCapture()
+{
+    const std::string filename = gDirUtilp->add(mCaptureDir, MANIFEST_FILENAME);
+    llofstream file(filename.c_str(), std::ios::out | std::ios::trunc);
+    if (file.is_open())
+    {
+        LLSDSerialize::toPrettyXML(mManifest, file);
+        file.close();
+        LL_INFOS("SceneBundle") << "Scene bundle written to " << mCaptureDir << " with " << mManifest["meshes"].size() << " meshes, "
+                                << mManifest["textures"].size() << " textures and " << mManifest["avatars"].size() << " avatars" << LL_ENDL;
+    }
+    else
+    {
+        LL_WARNS("SceneBundle") << "Unable to write " << filename << LL_ENDL;
+    }
+
+    mCaptureDir.clear();
+    mManifest.clear();
+}
+
+void FSSceneBundle::TextureReader::completed(bool success)
+{
+    mSuccess = success;
+    mDone = true;
+}
+
+// ----------------------------------------------------------------------------
+// Replay
+
+// static
+bool FSSceneBundle::isReplaying()
+{
+    return !gSavedSettings.getString("FSSceneReplayBundle").empty();
+}
+
+void FSSceneBundle::prepareReplay()
+{
+    if (!isReplaying())
+    {
+        return;
+    }
+
+    const std::string dir = gSavedSettings.getString("FSSceneReplayBundle");
+    LLSD manifest;
+    llifstream file(gDirUtilp->add(dir, MANIFEST_FILENAME).c_str());
+    if (!file.is_open() || LLSDParser::PARSE_FAILURE == LLSDSerialize::fromXML(manifest, file) || manifest["version"].asInteger() != BUNDLE_VERSION)
+    {
+        LL_WARNS("SceneBundle") << "No usable scene bundle in " << dir << ", not replaying" << LL_ENDL;
+        gSavedSettings.setString("FSSceneReplayBundle", "");
+        return;
+    }
+
+    // The benchmark runs the replay
+    gSavedSettings.setBOOL("FSBenchmarkMode", true);
+    gSavedSettings.setString("FSBenchmarkLocation", manifest["region"]["location"].asString());
+    if (manifest.has("camera_path"))
+    {
+        gSavedSettings.setString("StatsPilotXMLFile", gDirUtilp->add(dir, manifest["camera_path"].asString()));
+    }
+    mManifest = manifest;
+    LL_INFOS("SceneBundle") << "Replaying the scene bundle of " << manifest["region"]["name"].asString() << " in " << dir << LL_ENDL;
+}
+
+void FSSceneBundle::installReplay()
+{
+    if (!isReplaying() || !mManifest.isMap())
+    {
+        return;
+    }
+
+    const std::string dir = gSavedSettings.getString("FSSceneReplayBundle");
+    const U64 handle = ll_U64_from_sd(mManifest["region"]["handle"]);
+    const bool objects = LLVOCache::instance().importRegion(handle, gDirUtilp->add(dir, mManifest["region"]["objects"].asString()));
+    const U32 meshes = installMeshes(dir, mManifest["meshes"]);
+    const U32 textures = installTextures(dir, mManifest["textures"]);
+
+    LL_INFOS("SceneBundle") << "Installed the scene bundle: objects " << (objects ? "imported" : "missing") << ", " << meshes
+                            << " meshes, " << textures << " textures" << LL_ENDL;
+    mManifest.clear();
+}
+
+U32 FSSceneBundle::installMeshes(const std::string& dir, const LLSD& meshes)
+{
+    U32 installed = 0;
+    std::vector<U8> buffer;
+    for (const auto& mesh : llsd::inMap(meshes))
+    {
+        const LLUUID id(mesh.first);
+        const S32 size = mesh.second["size"].asInteger();
+        LLFILE* fp = LLFile::fopen(asset_path(dir, id, ".mesh"), "rb");
+        if (!fp)
+        {
+            continue;
+        }
+        buffer.resize(size);
+        const bool read = fread(buffer.data(), 1, size, fp) == (size_t)size;
+        fclose(fp);
+
+        if (read)
+        {
+            LLFileSystem file(id, LLAssetType::AT_MESH, LLFileSystem::WRITE);
+            installed += file.write(buffer.data(), size) ? 1 : 0;
+        }
+    }
+    return installed;
+}
+
+U32 FSSceneBundle::installTextures(const std::string& dir, const LLSD& textures)
+{
+    LLTextureCache* cache = LLAppViewer::getTextureCache();
+    if (!cache)
+    {
+        return 0;
+    }
+
+    // The cache writes from the images, they stay around until it is done
+    struct Write
+    {
+        LLPointer<LLImageFormatted>  mImage;
+        LLTextureCache::handle_t    mHandle;
+    };
+    std::vector<Write> writes;
+
+    for (const auto& texture : llsd::inMap(textures))
+    {
+        const LLUUID id(texture.first);
+        const S32 size = texture.second["size"].asInteger();
+        LLPointer<LLImageFormatted> image = LLImageFormatted::createFromType((S8)texture.second["codec"].asInteger());
+        LLFILE* fp = image.notNull() ? LLFile::fopen(asset_path(dir, id, ".tex"), "rb") : nullptr;
+        if (!fp)
+        {
+            continue;
+        }
+        U8* data = image->allocateData(size);
+        const bool read = data && fread(data, 1, size, fp) == (size_t)size;
+        fclose(fp);
+        if (!read || !image->updateData())
+        {
+            continue;
+        }
+
+        // The small decoded copy for the fast cache
+        S32 discard = 0;
+        while (discard < MAX_DISCARD_LEVEL
+               && ((image->getWidth() >> discard) > FAST_CACHE_DIMENSION || (image->getHeight() >> discard) > FAST_CACHE_DIMENSION))
+        {
+            ++discard;
+        }
+        image->setDiscardLevel((S8)discard);
+        LLPointer<LLImageRaw> raw = new LLImageRaw();
+        if (!image->decode(raw, 0.f))
+        {
+            continue;
+        }
+
+        const LLTextureCache::handle_t handle = cache->writeToCache(id, image->getData(), image->getDataSize(),
+                                                                    texture.second["image_size"].asInteger(), raw, discard, new TextureWriter());
+        if (handle != LLWorkerThread::nullHandle())
+        {
+            writes.push_back({ image, handle });
+        }
+    }
+
+    // Startup waits for the cache, the login must find the textures there
+    U32 installed = 0;
+    LLTimer timer;
+    while (!writes.empty() && timer.getElapsedTimeF32() < INSTALL_TIMEOUT)
+    {
+        cache->update(1.f);
+        for (size_t i = 0; i < writes.size(); )
+        {
+            if (cache->writeComplete(writes[i].mHandle))
+            {
+                ++installed;
+                writes[i] = writes.back();
+                writes.pop_back();
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        if (!writes.empty())
+        {
+            ms_sleep(1);
+        }
+    }
+    for (const Write& write : writes)
+    {
+        cache->writeComplete(write.mHandle, true);
+    }
+    return installed;
+}
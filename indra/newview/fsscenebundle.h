@@ -0,0 +1,120 @@
+/**
+ * @file fsscenebundle.h
+ * @brief Captures a region with its assets to a bundle and replays it
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSSCENEBUNDLE_H
+#define FS_FSSCENEBUNDLE_H
+
+#include "llsd.h"
+#include "llsingleton.h"
+#include "lltexturecache.h"
+#include "lluuid.h"
+
+#include <atomic>
+#include <set>
+#include <vector>
+
+class LLViewerRegion;
+
+// A scene bundle is a directory with what the viewer needs to draw a region
+// without downloading anything: the object cache entries of the region,
+// the meshes and the textures its objects and the avatars in it use, the
+// appearance of those avatars and the recorded camera path, if there is
+// one. manifest.llsd lists all of it.
+//
+// Capture writes the region the agent is in to a new bundle. The object
+// cache entries and the meshes are written right away, the textures are
+// read from the texture cache over the next frames.
+//
+// Replay (FSSceneReplayBundle, --scenereplay) puts the bundle into the
+// caches before anything is fetched, then runs the benchmark at the
+// captured location with the captured camera path. Objects then come from
+// the object cache, meshes and textures from the disk caches, and only
+// what changed in the region since the capture goes over the network. A
+// simulator is still needed: regions, objects and avatars only come to
+// life through its messages.
+class FSSceneBundle : public LLSingleton<FSSceneBundle>
+{
+    LLSINGLETON(FSSceneBundle);
+    ~FSSceneBundle();
+
+public:
+    // Threads:  Tmain
+    bool capture(const std::string& dir);
+    bool isCapturing() const { return !mCaptureDir.empty(); }
+
+    static bool isReplaying();
+    // Threads:  Tmain
+    // From LLAppViewer::initConfiguration(), before the benchmark reads its
+    // settings: sets the benchmark up for the bundle
+    void prepareReplay();
+    // From LLAppViewer::initCache(), once the caches are up
+    void installReplay();
+
+private:
+    class TextureReader : public LLTextureCache::ReadResponder
+    {
+    public:
+        void completed(bool success) override;
+        bool isDone() const { return mDone; }
+        bool succeeded() const { return mSuccess; }
+        LLImageFormatted* getImage() const { return mFormattedImage; }
+        S32 getImageSize() const { return mImageSize; }
+
+    private:
+        std::atomic<bool>   mDone{ false };
+        bool                mSuccess = false;
+    };
+
+    class TextureWriter : public LLTextureCache::WriteResponder
+    {
+    public:
+        void completed(bool success) override {}
+    };
+
+    struct TextureRead
+    {
+        LLUUID                      mID;
+        LLTextureCache::handle_t    mHandle;
+        LLPointer<TextureReader>    mReader;
+    };
+
+    void collectAssets(LLViewerRegion* region, std::set<LLUUID>& textures, std::set<LLUUID>& meshes);
+    LLSD captureAvatars(LLViewerRegion* region, std::set<LLUUID>& textures);
+    U32 captureMeshes(const std::set<LLUUID>& meshes);
+    bool updateCapture();
+    void finishCapture();
+
+    U32 installMeshes(const std::string& dir, const LLSD& meshes);
+    U32 installTextures(const std::string& dir, const LLSD& textures);
+
+    std::string                 mCaptureDir;
+    LLSD                        mManifest;
+    std::vector<LLUUID>         mTexturesToRead;
+    std::vector<TextureRead>    mTextureReads;
+};
+
+#endif // FS_FSSCENEBUNDLE_H
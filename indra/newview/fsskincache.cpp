@@ -0,0 +1,287 @@
+/**
+ * @file fsskincache.cpp
+ * @brief Rigged mesh skinned once a frame for all shadow maps
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsskincache.h"
+
+#include "lldrawpool.h"
+#include "llfetchedgltfmaterial.h"
+#include "llframetimer.h"
+#include "llglslshader.h"
+#include "llrender.h"
+#include "llviewershadermgr.h"
+#include "pipeline.h"
+
+namespace
+{
+    // xyzw of a skinned position, see shadowSkinTransformV.glsl
+    constexpr U32 POSITION_SIZE = 16;
+
+    // Largest the buffer grows to, 4M vertices
+    constexpr U32 MAX_CAPACITY = 64 * 1024 * 1024;
+
+    U32 vertex_bytes(const LLDrawInfo& params)
+    {
+        return (params.mEnd - params.mStart + 1) * POSITION_SIZE;
+    }
+
+    bool same_face(const LLDrawInfo& params, const LLVertexBuffer* buffer, const LLVOAvatar* avatar,
+        const LLMeshSkinInfo* skin_info, U32 start, U32 end)
+    {
+        return params.mVertexBuffer.get() == buffer
+            && params.mAvatar.get() == avatar
+            && params.mSkinInfo == skin_info
+            && params.mStart == start
+            && params.mEnd == end;
+    }
+}
+
+FSSkinCache::FSSkinCache()
+:   mBuffer(0),
+    mCapacity(0),
+    mUsed(0),
+    mNeeded(0),
+    mFrame(0)
+{
+}
+
+FSSkinCache::~FSSkinCache()
+{
+    // The skinned vertex buffer mBuffer is deleted in release(), called
+    // from LLPipeline::releaseGLBuffers() and LLPipeline::cleanup() while
+    // the GL context is still current.
+}
+
+void FSSkinCache::newFrame()
+{
+    const U32 frame = LLFrameTimer::getFrameCount();
+    if (frame == mFrame && mBuffer)
+    {
+        return;
+    }
+    mFrame = frame;
+
+    if (!mBuffer)
+    {
+        glGenBuffers(1, &mBuffer);
+    }
+
+    // grow to what the last frame wanted, with some room to spare
+    if (mNeeded > mCapacity || mCapacity == 0)
+    {
+        mCapacity = llmin(llmax(mNeeded + mNeeded / 4, 1024U * 1024U), MAX_CAPACITY);
+        glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, mBuffer);
+        glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, mCapacity, nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0);
+    }
+
+    mEntries.clear();
+    mUsed = 0;
+    mNeeded = 0;
+}
+
+void FSSkinCache::collect(U32 type, bool gltf)
+{
+    std::vector<LLDrawInfo*>& draws = gltf ? mDrawsGLTF : mDraws;
+
+    auto* begin = gPipeline.beginRenderMap(type);
+    auto* end = gPipeline.endRenderMap(type);
+    for (LLCullResult::drawinfo_iterator i = begin; i != end; )
+    {
+        LLDrawInfo* params = *i;
+        LLCullResult::increment_iterator(i, end);
+
+        if (!params->mCount || params->mAvatar.isNull() || !params->mSkinInfo || params->mVertexBuffer.isNull())
+        {
+            continue;
+        }
+        draws.push_back(params);
+
+        auto found = mEntries.find(params);
+        if (found != mEntries.end()
+            && same_face(*params, found->second.mVertexBuffer, found->second.mAvatar, found->second.mSkinInfo,
+                found->second.mStart, found->second.mEnd))
+        {
+            continue;
+        }
+
+        Entry& entry = mEntries[params];
+        entry.mVertexBuffer = params->mVertexBuffer.get();
+        entry.mAvatar = params->mAvatar.get();
+        entry.mSkinInfo = params->mSkinInfo;
+        entry.mStart = params->mStart;
+        entry.mEnd = params->mEnd;
+        entry.mOffset = mUsed;
+        entry.mSkinned = false;
+
+        const U32 bytes = vertex_bytes(*params);
+        mNeeded += bytes;
+        if (mUsed + bytes <= mCapacity)
+        {
+            mUsed += bytes;
+            mToSkin.push_back(params);
+        }
+    }
+}
+
+void FSSkinCache::skin()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_DRAWPOOL;
+
+    gDeferredShadowSkinTransformProgram.bind();
+
+    LLGLEnable discard(GL_RASTERIZER_DISCARD);
+
+    const LLVOAvatar* last_avatar = nullptr;
+    U64 last_mesh_id = 0;
+    bool skip_last_skin = false;
+    for (LLDrawInfo* params : mToSkin)
+    {
+        Entry& entry = mEntries[params];
+        if (!LLRenderPass::uploadMatrixPalette(params->mAvatar, params->mSkinInfo, last_avatar, last_mesh_id, skip_last_skin))
+        { // skin info not loaded yet, the fallback won't draw it either
+            continue;
+        }
+
+        glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, mBuffer, entry.mOffset, vertex_bytes(*params));
+
+        params->mVertexBuffer->setBuffer();
+        glBeginTransformFeedback(GL_POINTS);
+        params->mVertexBuffer->drawArrays(LLRender::POINTS, params->mStart, params->mEnd - params->mStart + 1);
+        glEndTransformFeedback();
+
+        entry.mSkinned = true;
+    }
+
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    mToSkin.clear();
+}
+
+void FSSkinCache::renderShadow(const U32* types, U32 type_count)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_DRAWPOOL;
+
+    newFrame();
+
+    mDraws.clear();
+    mDrawsGLTF.clear();
+    for (U32 i = 0; i < type_count; ++i)
+    {
+        collect(types[i] + 1, false);
+    }
+    collect(LLRenderPass::PASS_GLTF_PBR_RIGGED, true);
+
+    if (!mToSkin.empty())
+    {
+        skin();
+    }
+
+    gGL.loadMatrix(gGLModelView);
+    gGLLastMatrix = NULL;
+
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_DRAWPOOL("skin cache - skinned");
+        gDeferredShadowProgram.bind();
+
+        for (U32 pass = 0; pass < 2; ++pass)
+        {
+            const bool gltf = pass == 1;
+            for (LLDrawInfo* params : gltf ? mDrawsGLTF : mDraws)
+            {
+                const Entry& entry = mEntries[params];
+                if (!entry.mSkinned)
+                {
+                    continue;
+                }
+
+                LLGLDisable cull_face(gltf && params->mGLTFMaterial && params->mGLTFMaterial->mDoubleSided ? GL_CULL_FACE : 0);
+
+                LLRenderPass::applyModelMatrix(*params);
+
+                params->mVertexBuffer->setBuffer();
+                params->mVertexBuffer->drawRangeWithPositions(LLRender::TRIANGLES, params->mStart, params->mEnd,
+                    params->mCount, params->mOffset, mBuffer, entry.mOffset);
+            }
+        }
+    }
+
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_DRAWPOOL("skin cache - fallback");
+        gDeferredShadowProgram.bind(true);
+
+        const LLVOAvatar* last_avatar = nullptr;
+        U64 last_mesh_id = 0;
+        bool skip_last_skin = false;
+        for (LLDrawInfo* params : mDraws)
+        {
+            if (mEntries[params].mSkinned)
+            {
+                continue;
+            }
+
+            if (LLRenderPass::uploadMatrixPalette(params->mAvatar, params->mSkinInfo, last_avatar, last_mesh_id, skip_last_skin))
+            {
+                LLRenderPass::applyModelMatrix(*params);
+                params->mVertexBuffer->setBuffer();
+                params->mVertexBuffer->drawRange(LLRender::TRIANGLES, params->mStart, params->mEnd, params->mCount, params->mOffset);
+            }
+        }
+
+        for (LLDrawInfo* params : mDrawsGLTF)
+        {
+            if (!mEntries[params].mSkinned)
+            {
+                LLRenderPass::pushUntexturedRiggedGLTFBatch(*params, last_avatar, last_mesh_id, skip_last_skin);
+            }
+        }
+    }
+
+    gGL.loadMatrix(gGLModelView);
+    gGLLastMatrix = NULL;
+
+    // the draw infos belong to the cull result, don't hold on to them past the pass
+    mDraws.clear();
+    mDrawsGLTF.clear();
+}
+
+void FSSkinCache::release()
+{
+    mEntries.clear();
+    mToSkin.clear();
+    mDraws.clear();
+    mDrawsGLTF.clear();
+    mCapacity = 0;
+    mUsed = 0;
+    mNeeded = 0;
+
+    if (mBuffer)
+    {
+        glDeleteBuffers(1, &mBuffer);
+        mBuffer = 0;
+    }
+}
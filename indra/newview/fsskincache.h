@@ -0,0 +1,95 @@
+/**
+ * @file fsskincache.h
+ * @brief Rigged mesh skinned once a frame for all shadow maps
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSSKINCACHE_H
+#define FS_FSSKINCACHE_H
+
+#include "llgl.h"
+
+#include <unordered_map>
+#include <vector>
+
+class LLDrawInfo;
+class LLMeshSkinInfo;
+class LLVertexBuffer;
+class LLVOAvatar;
+
+// Skins the opaque rigged faces of the shadow passes once a frame instead
+// of once for every sun cascade and projector shadow they land in. The
+// first shadow map a face is drawn into runs its vertices through
+// shadowSkinTransformV.glsl with the rasterizer off and captures the skinned
+// positions with transform feedback, into one GL buffer shared by the whole
+// frame. That shadow map and every later one draw the face with the plain
+// shadow shader, reading the captured positions in place of the face's own.
+//
+// The buffer only grows between frames, faces that don't fit any more are
+// drawn with the skinned shadow shader as before and counted towards the
+// size of the next frame's buffer.
+// Enabled with FSPreSkinnedShadows.
+class FSSkinCache
+{
+public:
+    FSSkinCache();
+    ~FSSkinCache();
+
+    // Threads:  Tmain
+    // Draw the rigged variants of the legacy render types and of
+    // PASS_GLTF_PBR from the current cull result into the bound shadow map.
+    // Leaves gDeferredShadowProgram's rigged variant bound.
+    void renderShadow(const U32* types, U32 type_count);
+
+    void release();
+
+private:
+    struct Entry
+    {
+        // what the face was skinned from, a draw info freed during the frame can be reused
+        const LLVertexBuffer*   mVertexBuffer;
+        const LLVOAvatar*       mAvatar;
+        const LLMeshSkinInfo*   mSkinInfo;
+        U32                     mStart;
+        U32                     mEnd;
+        U32                     mOffset;    // in bytes, in mBuffer
+        bool                    mSkinned;   // false when it didn't fit
+    };
+
+    void newFrame();
+    void collect(U32 type, bool gltf);
+    void skin();
+
+    std::unordered_map<const LLDrawInfo*, Entry>    mEntries;   // of this frame
+    std::vector<LLDrawInfo*>                        mToSkin;    // scratch of renderShadow()
+    std::vector<LLDrawInfo*>                        mDraws;     // scratch of renderShadow()
+    std::vector<LLDrawInfo*>                        mDrawsGLTF; // scratch of renderShadow()
+    GLuint                                          mBuffer;
+    U32                                             mCapacity;  // in bytes
+    U32                                             mUsed;      // this frame
+    U32                                             mNeeded;    // this frame, skinned or not
+    U32                                             mFrame;
+};
+
+#endif // FS_FSSKINCACHE_H
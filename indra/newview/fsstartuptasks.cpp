@@ -0,0 +1,242 @@
+/**
+ * @file fsstartuptasks.cpp
+ * @brief Runs independent startup stages as a dependency graph
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fsstartuptasks.h"
+
+#include "llappviewer.h"
+#include "llviewercontrol.h"
+#include "workqueue.h"
+
+namespace
+{
+    // Seconds since the viewer was launched
+    F64 now()
+    {
+        return (F64)(totalTime() - gStartTime) / 1000000.0;
+    }
+}
+
+FSStartupTasks::FSStartupTasks() :
+    mLoginScreen(0.0),
+    mLoginStart(0.0)
+{
+}
+
+FSStartupTasks::~FSStartupTasks()
+{
+    // Pool stages point at their stage
+    for (const auto& stage : mStages)
+    {
+        if (stage->mThread == EThread::Pool && stage->mState == EState::Running)
+        {
+            while (!stage->mFinished.load(std::memory_order_acquire))
+            {
+                ms_sleep(1);
+            }
+        }
+    }
+}
+
+void FSStartupTasks::add(const std::string& name, EThread thread, work_t work, const std::vector<std::string>& depends_on)
+{
+    if (find(name))
+    {
+        LL_WARNS("AppInit") << "Startup stage " << name << " was already added" << LL_ENDL;
+        return;
+    }
+
+    auto stage = std::make_unique<Stage>();
+    stage->mName = name;
+    stage->mThread = thread;
+    stage->mWork = std::move(work);
+    stage->mDependsOn = depends_on;
+    stage->mAdded = now();
+    mStages.push_back(std::move(stage));
+    update();
+}
+
+void FSStartupTasks::update()
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    // A stage that finishes can make others ready, go on until nothing
+    // changes. Main stages may add stages while this runs.
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t i = 0; i < mStages.size(); ++i)
+        {
+            Stage* stage = mStages[i].get();
+            if (stage->mState == EState::Running && stage->mFinished.load(std::memory_order_acquire))
+            {
+                stage->mState = EState::Done;
+                changed = true;
+            }
+            else if (stage->mState == EState::Waiting && isReady(*stage))
+            {
+                start(*stage);
+                changed = true;
+            }
+        }
+    }
+}
+
+bool FSStartupTasks::isDone(const std::string& name) const
+{
+    const Stage* stage = find(name);
+    return !stage || stage->mState == EState::Done;
+}
+
+void FSStartupTasks::wait(const std::string& name)
+{
+    Stage* stage = find(name);
+    if (!stage)
+    {
+        return;
+    }
+
+    update();
+    if (stage->mState == EState::Done)
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED;
+    const F64 started = now();
+    while (stage->mState != EState::Done)
+    {
+        ms_sleep(1);
+        update();
+    }
+    stage->mBlocked += now() - started;
+}
+
+void FSStartupTasks::waitAll()
+{
+    for (size_t i = 0; i < mStages.size(); ++i)
+    {
+        wait(mStages[i]->mName);
+    }
+}
+
+FSStartupTasks::Stage* FSStartupTasks::find(const std::string& name) const
+{
+    for (const auto& stage : mStages)
+    {
+        if (stage->mName == name)
+        {
+            return stage.get();
+        }
+    }
+    return nullptr;
+}
+
+bool FSStartupTasks::isReady(const Stage& stage) const
+{
+    for (const std::string& dependency : stage.mDependsOn)
+    {
+        if (!isDone(dependency))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FSStartupTasks::start(Stage& stage)
+{
+    stage.mState = EState::Running;
+    stage.mStarted = now();
+
+    static LLCachedControl<bool> parallel(gSavedSettings, "FSParallelStartup");
+    if (stage.mThread == EThread::Pool && parallel)
+    {
+        LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+        Stage* stagep = &stage;
+        bool posted = general_queue && general_queue->post(
+            [stagep]()
+            {
+                LL_PROFILE_ZONE_NAMED("startup stage");
+                stagep->mWork();
+                stagep->mEnded.store(now(), std::memory_order_relaxed);
+                stagep->mFinished.store(true, std::memory_order_release);
+            });
+        if (posted)
+        {
+            return;
+        }
+    }
+
+    // Main stages, and pool stages without a pool
+    stage.mWork();
+    stage.mEnded.store(now(), std::memory_order_relaxed);
+    stage.mFinished.store(true, std::memory_order_release);
+    stage.mState = EState::Done;
+}
+
+void FSStartupTasks::markLoginScreen()
+{
+    if (mLoginScreen == 0.0)
+    {
+        mLoginScreen = now();
+    }
+}
+
+void FSStartupTasks::markLoginStart()
+{
+    mLoginStart = now();
+}
+
+void FSStartupTasks::markInWorld()
+{
+    const F64 in_world = now();
+    update();
+    logReport();
+
+    LL_INFOS("AppInit") << llformat("Startup: login screen after %.2f s, in world %.2f s after login was started, %.2f s after launch",
+                                    mLoginScreen, in_world - mLoginStart, in_world) << LL_ENDL;
+}
+
+void FSStartupTasks::logReport()
+{
+    for (const auto& stage : mStages)
+    {
+        if (stage->mState != EState::Done)
+        {
+            LL_INFOS("AppInit") << "Startup stage " << stage->mName << " still running" << LL_ENDL;
+            continue;
+        }
+        const F64 ended = stage->mEnded.load(std::memory_order_relaxed);
+        LL_INFOS("AppInit") << llformat("Startup stage %s (%s): ready after %.3f s, ran %.3f s, main thread waited %.3f s for it",
+                                        stage->mName.c_str(), stage->mThread == EThread::Pool ? "pool" : "main",
+                                        stage->mStarted - stage->mAdded, ended - stage->mStarted, stage->mBlocked) << LL_ENDL;
+    }
+}
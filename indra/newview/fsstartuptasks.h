@@ -0,0 +1,110 @@
+/**
+ * @file fsstartuptasks.h
+ * @brief Runs independent startup stages as a dependency graph
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+
+#ifndef FS_FSSTARTUPTASKS_H
+#define FS_FSSTARTUPTASKS_H
+
+#include "llsingleton.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Runs the parts of the startup that don't depend on each other as a
+// dependency graph. A stage starts as soon as the stages it depends on are
+// done. Pool stages run on the "General" thread pool and must not touch
+// main thread state, main stages run on the main thread from update().
+//
+// idle_startup() calls update() every frame. The startup states that need
+// the result of a stage join it with isDone() to keep the frame going, or
+// with wait() where the state can't go on without it.
+//
+// It also keeps the startup milestones and logs how long it took to get to
+// the login screen and into the world, with the time of every stage.
+class FSStartupTasks : public LLSingleton<FSStartupTasks>
+{
+    LLSINGLETON(FSStartupTasks);
+    ~FSStartupTasks();
+
+public:
+    enum class EThread
+    {
+        Main,
+        Pool
+    };
+    typedef std::function<void()> work_t;
+
+    // Main thread only, like everything else but the pool stages themselves
+    void add(const std::string& name, EThread thread, work_t work, const std::vector<std::string>& depends_on = {});
+    void update();
+
+    // Stages that were never added count as done
+    bool isDone(const std::string& name) const;
+    void wait(const std::string& name);
+    void waitAll();
+
+    void markLoginScreen();
+    void markLoginStart();
+    void markInWorld();
+
+private:
+    enum class EState
+    {
+        Waiting,
+        Running,
+        Done
+    };
+
+    struct Stage
+    {
+        std::string                 mName;
+        EThread                     mThread;
+        work_t                      mWork;
+        std::vector<std::string>    mDependsOn;
+        EState                      mState = EState::Waiting;
+        std::atomic<bool>           mFinished{ false };    // Set by the pool thread
+        F64                         mAdded = 0.0;
+        F64                         mStarted = 0.0;
+        std::atomic<F64>            mEnded{ 0.0 };
+        F64                         mBlocked = 0.0;         // Main thread time spent in wait()
+    };
+
+    Stage* find(const std::string& name) const;
+    bool isReady(const Stage& stage) const;
+    void start(Stage& stage);
+    void logReport();
+
+    // Stages are never removed, pool work keeps a pointer to its stage
+    std::vector<std::unique_ptr<Stage>> mStages;
+
+    F64 mLoginScreen;
+    F64 mLoginStart;
+};
+
+#endif // FS_FSSTARTUPTASKS_H
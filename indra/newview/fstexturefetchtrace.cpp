@@ -0,0 +1,323 @@
+/**
+ * @file fstexturefetchtrace.cpp
+ * @brief Texture fetch trace capture and replay
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fstexturefetchtrace.h"
+
+#include "llappviewer.h"
+#include "llcallbacklist.h"
+#include "llsdserialize.h"
+#include "lltexturefetch.h"
+#include "llviewercontrol.h"
+
+// How long to wait for outstanding requests once every event has been issued
+static const F32 REPLAY_DRAIN_TIMEOUT = 120.f;
+
+std::atomic<bool> FSTextureFetchTrace::sRecording{ false };
+LLMutex FSTextureFetchTrace::sMutex;
+llofstream FSTextureFetchTrace::sFile;
+LLTimer FSTextureFetchTrace::sTimer;
+
+// static
+bool FSTextureFetchTrace::start(const std::string& filename)
+{
+    LLMutexLock lock(&sMutex);
+    if (sFile.is_open())
+    {
+        sFile.close();
+    }
+    sFile.open(filename.c_str(), std::ios::out | std::ios::trunc);
+    if (!sFile.is_open())
+    {
+        LL_WARNS("TextureFetchTrace") << "Unable to open texture fetch trace " << filename << LL_ENDL;
+        sRecording = false;
+        return false;
+    }
+
+    LL_INFOS("TextureFetchTrace") << "Recording texture fetch trace to " << filename << LL_ENDL;
+    sTimer.reset();
+    sRecording = true;
+    return true;
+}
+
+// static
+void FSTextureFetchTrace::stop()
+{
+    LLMutexLock lock(&sMutex);
+    sRecording = false;
+    if (sFile.is_open())
+    {
+        sFile.close();
+    }
+}
+
+// static
+void FSTextureFetchTrace::writeLine(const std::string& line)
+{
+    LLMutexLock lock(&sMutex);
+    if (sFile.is_open())
+    {
+        sFile << llformat("%.4f ", sTimer.getElapsedTimeF32()) << line << '\n';
+    }
+}
+
+// static
+void FSTextureFetchTrace::recordCreate(FTType f_type, const std::string& url, const LLUUID& id, F32 priority,
+                                       S32 w, S32 h, S32 c, S32 discard, bool needs_aux, bool can_use_http)
+{
+    std::string line = llformat("C %s %d %f %d %d %d %d %d %d",
+                                id.asString().c_str(), (S32)f_type, priority, w, h, c, discard,
+                                needs_aux ? 1 : 0, can_use_http ? 1 : 0);
+    if (!url.empty())
+    {
+        line += " " + url;
+    }
+    writeLine(line);
+}
+
+// static
+void FSTextureFetchTrace::recordPriority(const LLUUID& id, F32 priority)
+{
+    writeLine(llformat("P %s %f", id.asString().c_str(), priority));
+}
+
+// static
+void FSTextureFetchTrace::recordFinished(const LLUUID& id, S32 discard, S32 worker_state, F32 fetch_time)
+{
+    writeLine(llformat("F %s %d %d %f", id.asString().c_str(), discard, worker_state, fetch_time));
+}
+
+bool FSTextureFetchReplay::start(const std::string& filename, const std::string& asset_url)
+{
+    LLTextureFetch* fetcher = LLAppViewer::getTextureFetch();
+    if (!fetcher || !fetcher->isQAMode())
+    {
+        LL_WARNS("TextureFetchTrace") << "Texture fetch replay needs QAModeMetrics enabled" << LL_ENDL;
+        return false;
+    }
+    if (asset_url.empty())
+    {
+        LL_WARNS("TextureFetchTrace") << "Texture fetch replay needs FSTextureFetchReplayURL" << LL_ENDL;
+        return false;
+    }
+    if (!loadTrace(filename))
+    {
+        return false;
+    }
+
+    LL_INFOS("TextureFetchTrace") << "Replaying " << mEvents.size() << " texture fetch events from " << filename
+                                  << " against " << asset_url << LL_ENDL;
+
+    mFilename = filename;
+    fetcher->setReplayAssetUrl(asset_url);
+    mTimer.reset();
+    doOnIdleRepeating([this]() { return idle(); });
+    return true;
+}
+
+bool FSTextureFetchReplay::loadTrace(const std::string& filename)
+{
+    llifstream file(filename.c_str());
+    if (!file.is_open())
+    {
+        LL_WARNS("TextureFetchTrace") << "Unable to open texture fetch trace " << filename << LL_ENDL;
+        return false;
+    }
+
+    mEvents.clear();
+    mNextEvent = 0;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream stream(line);
+        event_t event{};
+        std::string id;
+        if (!(stream >> event.mTime >> event.mType >> id))
+        {
+            continue;
+        }
+        event.mID.set(id);
+
+        if (event.mType == 'C')
+        {
+            S32 f_type, needs_aux, can_use_http;
+            if (!(stream >> f_type >> event.mPriority >> event.mWidth >> event.mHeight >> event.mComponents
+                         >> event.mDiscard >> needs_aux >> can_use_http))
+            {
+                continue;
+            }
+            event.mFTType = (FTType)f_type;
+            event.mNeedsAux = needs_aux != 0;
+            event.mCanUseHTTP = can_use_http != 0;
+            stream >> event.mUrl;
+        }
+        else if (event.mType == 'P')
+        {
+            if (!(stream >> event.mPriority))
+            {
+                continue;
+            }
+        }
+        else
+        {
+            // Completions are only informational, the replay times its own
+            continue;
+        }
+        mEvents.push_back(event);
+    }
+
+    if (mEvents.empty())
+    {
+        LL_WARNS("TextureFetchTrace") << "No replayable events in " << filename << LL_ENDL;
+        return false;
+    }
+    return true;
+}
+
+bool FSTextureFetchReplay::idle()
+{
+    LLTextureFetch* fetcher = LLAppViewer::getTextureFetch();
+    if (!fetcher || LLApp::isExiting())
+    {
+        return true;
+    }
+
+    F32 now = mTimer.getElapsedTimeF32();
+    for (; mNextEvent < mEvents.size() && mEvents[mNextEvent].mTime <= now; ++mNextEvent)
+    {
+        const event_t& event = mEvents[mNextEvent];
+        if (event.mType == 'C')
+        {
+            // Only textures fetched by id go through the replay server; other
+            // types carry absolute urls of the original session
+            if (event.mFTType != FTT_DEFAULT)
+            {
+                continue;
+            }
+            S32 discard = fetcher->createRequest(event.mFTType, LLStringUtil::null, event.mID, LLHost(), event.mPriority,
+                                                 event.mWidth, event.mHeight, event.mComponents, event.mDiscard,
+                                                 event.mNeedsAux, event.mCanUseHTTP);
+            if (discard >= 0 && !mPending.count(event.mID))
+            {
+                mPending[event.mID] = { now, discard };
+            }
+        }
+        else
+        {
+            fetcher->updateRequestPriority(event.mID, event.mPriority);
+        }
+    }
+
+    for (auto it = mPending.begin(); it != mPending.end(); )
+    {
+        S32 discard = -1;
+        S32 worker_state = 0;
+        LLPointer<LLImageRaw> raw;
+        LLPointer<LLImageRaw> aux;
+        LLCore::HttpStatus status;
+        if (fetcher->getRequestFinished(it->first, discard, worker_state, raw, aux, status))
+        {
+            if (raw.notNull() && discard >= 0)
+            {
+                mLatencies.push_back(now - it->second.mIssueTime);
+            }
+            else
+            {
+                ++mFailed;
+            }
+            fetcher->deleteRequest(it->first, false);
+            it = mPending.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (mNextEvent < mEvents.size())
+    {
+        return false;
+    }
+    if (!mPending.empty() && now < mEvents.back().mTime + REPLAY_DRAIN_TIMEOUT)
+    {
+        return false;
+    }
+
+    finish();
+    return true;
+}
+
+void FSTextureFetchReplay::finish()
+{
+    F32 elapsed = mTimer.getElapsedTimeF32();
+    U32 timed_out = (U32)mPending.size();
+    for (const auto& [id, pending] : mPending)
+    {
+        LLAppViewer::getTextureFetch()->deleteRequest(id, true);
+    }
+    mPending.clear();
+
+    std::sort(mLatencies.begin(), mLatencies.end());
+    F32 mean = 0.f;
+    for (F32 latency : mLatencies)
+    {
+        mean += latency;
+    }
+    size_t count = mLatencies.size();
+    if (count)
+    {
+        mean /= (F32)count;
+    }
+
+    LLSD results;
+    results["trace"] = mFilename;
+    results["events"] = (LLSD::Integer)mEvents.size();
+    results["completed"] = (LLSD::Integer)count;
+    results["failed"] = (LLSD::Integer)mFailed;
+    results["timed_out"] = (LLSD::Integer)timed_out;
+    results["elapsed"] = elapsed;
+    results["latency_mean"] = mean;
+    results["latency_median"] = count ? mLatencies[count / 2] : 0.f;
+    results["latency_p95"] = count ? mLatencies[llmin(count - 1, count * 95 / 100)] : 0.f;
+    results["latency_max"] = count ? mLatencies.back() : 0.f;
+
+    LL_INFOS("TextureFetchTrace") << "Texture fetch replay done: " << results << LL_ENDL;
+
+    llofstream out((mFilename + ".results.xml").c_str());
+    if (out.is_open())
+    {
+        LLSDSerialize::toPrettyXML(results, out);
+    }
+
+    LLAppViewer::getTextureFetch()->setReplayAssetUrl(LLStringUtil::null);
+
+    if (gSavedSettings.getBOOL("FSTextureFetchReplayQuit"))
+    {
+        LLAppViewer::instance()->forceQuit();
+    }
+}
@@ -0,0 +1,124 @@
+/**
+ * @file fstexturefetchtrace.h
+ * @brief Texture fetch trace capture and replay
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+#ifndef FS_FSTEXTUREFETCHTRACE_H
+#define FS_FSTEXTUREFETCHTRACE_H
+
+#include "llfile.h"
+#include "llmutex.h"
+#include "llsingleton.h"
+#include "lltimer.h"
+#include "lluuid.h"
+#include "llviewertexture.h"
+
+// Records the calls made into LLTextureFetch during a session to a text
+// file, one event per line, with the time since recording started:
+//
+//   <seconds> C <id> <f_type> <priority> <w> <h> <c> <discard> <needs_aux> <can_use_http> [<url>]
+//   <seconds> P <id> <priority>
+//   <seconds> F <id> <discard> <worker_state> <fetch_time>
+//
+// Enabled by setting FSTextureFetchTraceFile before startup.
+class FSTextureFetchTrace
+{
+public:
+    // Threads:  Tmain
+    static bool start(const std::string& filename);
+    static void stop();
+
+    // Threads:  T*
+    static bool isRecording() { return sRecording; }
+
+    // Threads:  T*
+    static void recordCreate(FTType f_type, const std::string& url, const LLUUID& id, F32 priority,
+                             S32 w, S32 h, S32 c, S32 discard, bool needs_aux, bool can_use_http);
+    static void recordPriority(const LLUUID& id, F32 priority);
+    static void recordFinished(const LLUUID& id, S32 discard, S32 worker_state, F32 fetch_time);
+
+private:
+    static void writeLine(const std::string& line);
+
+    static std::atomic<bool> sRecording;
+    static LLMutex           sMutex;
+    static llofstream        sFile;     // sMutex
+    static LLTimer           sTimer;
+};
+
+// Replays a recorded trace against LLTextureFetch, LLTextureCache and the
+// image decode threads, with every texture served from a local HTTP server
+// (FSTextureFetchReplayURL, used in place of the region asset capability).
+// Requests are issued at their recorded time offsets, completions are timed,
+// and a summary is written to the log and next to the trace file.
+//
+// Needs the fetcher to run in QA mode (QAModeMetrics) and works from the
+// login screen, so no grid connection is required. With
+// FSTextureFetchReplayQuit the viewer quits once the replay is done.
+class FSTextureFetchReplay : public LLSingleton<FSTextureFetchReplay>
+{
+    LLSINGLETON_EMPTY_CTOR(FSTextureFetchReplay);
+
+public:
+    // Threads:  Tmain
+    bool start(const std::string& filename, const std::string& asset_url);
+
+private:
+    struct event_t
+    {
+        F32         mTime;
+        char        mType;
+        LLUUID      mID;
+        FTType      mFTType;
+        std::string mUrl;
+        F32         mPriority;
+        S32         mWidth;
+        S32         mHeight;
+        S32         mComponents;
+        S32         mDiscard;
+        bool        mNeedsAux;
+        bool        mCanUseHTTP;
+    };
+
+    struct pending_t
+    {
+        F32 mIssueTime;
+        S32 mDiscard;
+    };
+
+    bool loadTrace(const std::string& filename);
+    bool idle();
+    void finish();
+
+    std::vector<event_t>            mEvents;
+    size_t                          mNextEvent{ 0 };
+    std::map<LLUUID, pending_t>     mPending;
+    std::vector<F32>                mLatencies;
+    U32                             mFailed{ 0 };
+    std::string                     mFilename;
+    LLTimer                         mTimer;
+};
+
+#endif // FS_FSTEXTUREFETCHTRACE_H
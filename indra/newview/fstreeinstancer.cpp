@@ -0,0 +1,189 @@
+/**
+ * @file fstreeinstancer.cpp
+ * @brief Instanced drawing of legacy trees
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+
+#include "llviewerprecompiledheaders.h"
+
+#include "fstreeinstancer.h"
+
+#include "lldrawpool.h"
+#include "llglslshader.h"
+#include "llrender.h"
+#include "llviewercontrol.h"
+#include "llviewershadermgr.h"
+
+#include <algorithm>
+
+namespace
+{
+    // vec4s per instance, see treeV.glsl
+    constexpr U32 INSTANCE_VEC4S = 3;
+}
+
+FSTreeInstancer::FSTreeInstancer()
+:   mUBO(0),
+    mOffsetAlignment(0)
+{
+}
+
+FSTreeInstancer::~FSTreeInstancer()
+{
+    // mUBO and the per species meshes are freed in release(), called from
+    // LLPipeline::releaseGLBuffers() and LLPipeline::cleanup() while the
+    // GL context is still current.
+}
+
+// static
+bool FSTreeInstancer::isEnabled()
+{
+    static LLCachedControl<bool> instancing(gSavedSettings, "FSTreeInstancing", false);
+    return instancing && gDeferredTreeInstancedProgram.isComplete() && gDeferredTreeShadowInstancedProgram.isComplete();
+}
+
+LLVertexBuffer* FSTreeInstancer::getMesh(U8 species, S32 lod) const
+{
+    auto iter = mMeshes.find(mesh_key_t(species, lod));
+    return iter != mMeshes.end() ? iter->second.get() : nullptr;
+}
+
+void FSTreeInstancer::setMesh(U8 species, S32 lod, LLVertexBuffer* buffer)
+{
+    mMeshes[mesh_key_t(species, lod)] = buffer;
+}
+
+void FSTreeInstancer::queue(LLVertexBuffer* mesh, const LLMatrix4* model_matrix, const F32* transform)
+{
+    Instance instance;
+    instance.mMesh = mesh;
+    instance.mModelMatrix = model_matrix;
+    std::copy(transform, transform + 12, instance.mTransform);
+    mQueue.push_back(instance);
+}
+
+void FSTreeInstancer::render()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_DRAWPOOL;
+
+    if (mQueue.empty())
+    {
+        return;
+    }
+
+    if (!LLGLSLShader::sCurBoundShaderPtr)
+    {
+        mQueue.clear();
+        return;
+    }
+
+    if (mUBO == 0)
+    {
+        glGenBuffers(1, &mUBO);
+
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        mOffsetAlignment = (U32)llmax(alignment, 16);
+    }
+
+    std::sort(mQueue.begin(), mQueue.end(),
+        [](const Instance& a, const Instance& b)
+        {
+            if (a.mMesh != b.mMesh)
+            {
+                return a.mMesh < b.mMesh;
+            }
+            return a.mModelMatrix < b.mModelMatrix;
+        });
+
+    struct Batch
+    {
+        U32 mFirst;     // in mQueue
+        U32 mCount;
+        U32 mOffset;    // in bytes, in the uniform buffer
+    };
+    std::vector<Batch> batches;
+
+    // as many instances per draw as the shaders' MAX_UBO_VEC4S allow
+    const U32 max_instances = llmax((U32)gGLManager.mMaxUniformBlockSize / (16 * INSTANCE_VEC4S), 1U);
+    const U32 align = mOffsetAlignment / sizeof(F32);
+
+    mData.clear();
+
+    U32 i = 0;
+    while (i < (U32)mQueue.size())
+    {
+        Batch batch;
+        batch.mFirst = i;
+        batch.mCount = 0;
+
+        // every range bound must start on the offset alignment
+        mData.resize((mData.size() + align - 1) / align * align);
+        batch.mOffset = (U32)(mData.size() * sizeof(F32));
+
+        const Instance& first = mQueue[i];
+        while (i < (U32)mQueue.size() && batch.mCount < max_instances
+            && mQueue[i].mMesh == first.mMesh && mQueue[i].mModelMatrix == first.mModelMatrix)
+        {
+            mData.insert(mData.end(), mQueue[i].mTransform, mQueue[i].mTransform + 12);
+            ++batch.mCount;
+            ++i;
+        }
+
+        batches.push_back(batch);
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, mUBO);
+    glBufferData(GL_UNIFORM_BUFFER, mData.size() * sizeof(F32), mData.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    for (const Batch& batch : batches)
+    {
+        const Instance& first = mQueue[batch.mFirst];
+
+        LLRenderPass::applyModelMatrix(first.mModelMatrix);
+
+        glBindBufferRange(GL_UNIFORM_BUFFER, LLGLSLShader::UB_MESH_INSTANCES, mUBO,
+            batch.mOffset, batch.mCount * INSTANCE_VEC4S * 16);
+
+        first.mMesh->setBuffer();
+        first.mMesh->drawInstanced(LLRender::TRIANGLES, first.mMesh->getNumIndices(), 0, batch.mCount);
+    }
+
+    mQueue.clear();
+}
+
+void FSTreeInstancer::release()
+{
+    mMeshes.clear();
+    mQueue.clear();
+    mData.clear();
+
+    if (mUBO)
+    {
+        glDeleteBuffers(1, &mUBO);
+        mUBO = 0;
+    }
+}
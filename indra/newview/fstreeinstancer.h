@@ -0,0 +1,95 @@
+/**
+ * @file fstreeinstancer.h
+ * @brief Instanced drawing of legacy trees
+ *
+ * $LicenseInfo:firstyear=2024&license=fsviewerlgpl$
+ * Phoenix Firestorm Viewer Source Code
+ * Copyright (C) 2024, The Phoenix Firestorm Project, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The Phoenix Firestorm Project, Inc., 1831 Oakwood Drive, Fairmont, Minnesota 56031-3225 USA
+ * http://www.firestormviewer.org
+ * $/LicenseInfo$
+ */
+
+
+#ifndef FS_FSTREEINSTANCER_H
+#define FS_FSTREEINSTANCER_H
+
+#include "llgl.h"
+#include "llvertexbuffer.h"
+
+#include <map>
+#include <vector>
+
+class LLMatrix4;
+
+// Legacy trees drawn as instances of one mesh per species and trunk LOD
+// instead of a mesh of their own with the position, rotation and scale baked
+// in. LLVOTree::updateMesh() generates the mesh of a species in tree space
+// the first time it is needed at a LOD, trees that move or change LOD then
+// only pick another mesh or update their transform.
+//
+// The tree pools queue their instanced faces while drawing and render() them
+// at the end of the pool, one draw per mesh and region. The instances are
+// uploaded in one uniform buffer, 3 vec4s each, read by the INSTANCED
+// variants of treeV.glsl and treeShadowV.glsl.
+// Enabled with FSTreeInstancing.
+class FSTreeInstancer
+{
+public:
+    FSTreeInstancer();
+    ~FSTreeInstancer();
+
+    static bool isEnabled();
+
+    // Threads:  Tmain
+    // The shared mesh of species at trunk LOD lod, NULL until set
+    LLVertexBuffer* getMesh(U8 species, S32 lod) const;
+    void setMesh(U8 species, S32 lod, LLVertexBuffer* buffer);
+
+    // Threads:  Tmain
+    // Queue an instance of mesh drawn with model_matrix, transform is the tree
+    // to region transform, 3 columns with the translation in w
+    void queue(LLVertexBuffer* mesh, const LLMatrix4* model_matrix, const F32* transform);
+
+    bool hasQueued() const { return !mQueue.empty(); }
+
+    // Threads:  Tmain
+    // Draw the queued instances with the bound shader,
+    // gDeferredTreeInstancedProgram or gDeferredTreeShadowInstancedProgram
+    void render();
+
+    void release();
+
+private:
+    struct Instance
+    {
+        LLVertexBuffer*     mMesh;
+        const LLMatrix4*    mModelMatrix;
+        F32                 mTransform[12];
+    };
+
+    typedef std::pair<U8, S32> mesh_key_t;
+
+    std::map<mesh_key_t, LLPointer<LLVertexBuffer>> mMeshes;
+    std::vector<Instance>                           mQueue;
+    std::vector<F32>                                mData;  // uniform buffer contents
+    GLuint                                          mUBO;
+    U32                                             mOffsetAlignment;   // in bytes
+};
+
+#endif // FS_FSTREEINSTANCER_H
@@ -29,6 +29,7 @@
 #include "asset.h"
 #include "buffer_util.h"
 #include "llfilesystem.h"
+#include "llmeshoptimizer.h" // <FS/> GLTF meshopt compression
 
 using namespace LL::GLTF;
 using namespace boost::json;
@@ -120,6 +121,16 @@ void Buffer::erase(Asset& asset, S32 offset, S32 length)
                 view.mByteOffset -= length;
             }
         }
+
+        // <FS> GLTF meshopt compression
+        if (view.mMeshopt.mPresent && view.mMeshopt.mBuffer == idx)
+        {
+            if (view.mMeshopt.mByteOffset >= offset)
+            {
+                view.mMeshopt.mByteOffset -= length;
+            }
+        }
+        // </FS>
     }
 }
 
@@ -130,6 +141,13 @@ bool Buffer::prep(Asset& asset)
         return false;
     }
 
+    // <FS> GLTF meshopt compression
+    if (mMeshopt.mFallback && mUri.empty() && mData.empty())
+    { // fallback for meshopt compressed views, nothing to load, the views decode from other buffers
+        return true;
+    }
+    // </FS>
+
     LLUUID id;
     if (mUri.size() == UUID_STR_SIZE && LLUUID::parseUUID(mUri, &id) && id.notNull())
     { // loaded from an asset, fetch the buffer data from the asset store
@@ -225,6 +243,7 @@ void Buffer::serialize(object& dst) const
     write(mName, "name", dst);
     write(mUri, "uri", dst);
     write_always(mByteLength, "byteLength", dst);
+    write_extensions(dst, &mMeshopt, "EXT_meshopt_compression"); // <FS/> GLTF meshopt compression
 };
 
 const Buffer& Buffer::operator=(const Value& src)
@@ -234,6 +253,12 @@ const Buffer& Buffer::operator=(const Value& src)
         copy(src, "name", mName);
         copy(src, "uri", mUri);
         copy(src, "byteLength", mByteLength);
+        // <FS> GLTF meshopt compression
+        if (!copy_extensions(src, "EXT_meshopt_compression", &mMeshopt))
+        {
+            copy_extensions(src, "KHR_meshopt_compression", &mMeshopt);
+        }
+        // </FS>
 
         // NOTE: DO NOT attempt to handle the uri here.
         // The uri is a reference to a file that is not loaded until
@@ -250,6 +275,7 @@ void BufferView::serialize(object& dst) const
     write(mByteStride, "byteStride", dst, 0);
     write(mTarget, "target", dst, -1);
     write(mName, "name", dst);
+    write_extensions(dst, &mMeshopt, mMeshopt.mKHR ? "KHR_meshopt_compression" : "EXT_meshopt_compression"); // <FS/> GLTF meshopt compression
 }
 
 const BufferView& BufferView::operator=(const Value& src)
@@ -262,10 +288,141 @@ const BufferView& BufferView::operator=(const Value& src)
         copy(src, "byteStride", mByteStride);
         copy(src, "target", mTarget);
         copy(src, "name", mName);
+        // <FS> GLTF meshopt compression
+        if (!copy_extensions(src, "EXT_meshopt_compression", &mMeshopt) &&
+            copy_extensions(src, "KHR_meshopt_compression", &mMeshopt))
+        {
+            mMeshopt.mKHR = true;
+        }
+        // </FS>
     }
     return *this;
 }
 
+// <FS> GLTF meshopt compression
+bool BufferView::prep(Asset& asset)
+{
+    if (!mMeshopt.mPresent)
+    {
+        return true;
+    }
+
+    const MeshoptCompression& meshopt = mMeshopt;
+    if (meshopt.mBuffer < 0 || meshopt.mBuffer >= (S32)asset.mBuffers.size())
+    {
+        LL_WARNS("GLTF") << "Invalid meshopt buffer index: " << meshopt.mBuffer << LL_ENDL;
+        return false;
+    }
+
+    const Buffer& buffer = asset.mBuffers[meshopt.mBuffer];
+    if (meshopt.mByteOffset < 0 || meshopt.mByteLength < 0 || meshopt.mCount < 0 || meshopt.mByteStride <= 0 ||
+        (size_t)meshopt.mByteOffset + (size_t)meshopt.mByteLength > buffer.mData.size())
+    {
+        LL_WARNS("GLTF") << "Invalid meshopt compressed range in buffer " << meshopt.mBuffer << LL_ENDL;
+        return false;
+    }
+
+    const U8* src = buffer.mData.data() + meshopt.mByteOffset;
+    mDecodedData.resize((size_t)meshopt.mCount * meshopt.mByteStride);
+
+    bool decoded = false;
+    if (meshopt.mMode == "ATTRIBUTES")
+    {
+        decoded = LLMeshOptimizer::decodeVertexBuffer(mDecodedData.data(), meshopt.mCount, meshopt.mByteStride, src, meshopt.mByteLength);
+        if (decoded)
+        {
+            if (meshopt.mFilter == "OCTAHEDRAL")
+            {
+                LLMeshOptimizer::decodeFilterOct(mDecodedData.data(), meshopt.mCount, meshopt.mByteStride);
+            }
+            else if (meshopt.mFilter == "QUATERNION")
+            {
+                LLMeshOptimizer::decodeFilterQuat(mDecodedData.data(), meshopt.mCount, meshopt.mByteStride);
+            }
+            else if (meshopt.mFilter == "EXPONENTIAL")
+            {
+                LLMeshOptimizer::decodeFilterExp(mDecodedData.data(), meshopt.mCount, meshopt.mByteStride);
+            }
+        }
+    }
+    else if (meshopt.mMode == "TRIANGLES" && (meshopt.mByteStride == 2 || meshopt.mByteStride == 4))
+    {
+        decoded = LLMeshOptimizer::decodeIndexBuffer(mDecodedData.data(), meshopt.mCount, meshopt.mByteStride, src, meshopt.mByteLength);
+    }
+    else if (meshopt.mMode == "INDICES" && (meshopt.mByteStride == 2 || meshopt.mByteStride == 4))
+    {
+        decoded = LLMeshOptimizer::decodeIndexSequence(mDecodedData.data(), meshopt.mCount, meshopt.mByteStride, src, meshopt.mByteLength);
+    }
+
+    if (!decoded)
+    {
+        LL_WARNS("GLTF") << "Failed to decode meshopt compressed buffer view, mode " << meshopt.mMode << " filter " << meshopt.mFilter << LL_ENDL;
+        mDecodedData.clear();
+        return false;
+    }
+
+    if (mDecodedData.size() < (size_t)mByteLength)
+    { // accessors index into the view as if it were uncompressed
+        LL_WARNS("GLTF") << "Decoded buffer view is " << mDecodedData.size() << " bytes, expected " << mByteLength << LL_ENDL;
+        mDecodedData.clear();
+        return false;
+    }
+
+    return true;
+}
+
+const U8* BufferView::getData(const Asset& asset) const
+{
+    if (!mDecodedData.empty())
+    {
+        return mDecodedData.data();
+    }
+    return asset.mBuffers[mBuffer].mData.data() + mByteOffset;
+}
+
+const MeshoptBuffer& MeshoptBuffer::operator=(const Value& src)
+{
+    mPresent = true;
+    if (src.is_object())
+    {
+        copy(src, "fallback", mFallback);
+    }
+    return *this;
+}
+
+void MeshoptBuffer::serialize(object& dst) const
+{
+    write(mFallback, "fallback", dst, false);
+}
+
+const MeshoptCompression& MeshoptCompression::operator=(const Value& src)
+{
+    mPresent = true;
+    if (src.is_object())
+    {
+        copy(src, "buffer", mBuffer);
+        copy(src, "byteOffset", mByteOffset);
+        copy(src, "byteLength", mByteLength);
+        copy(src, "byteStride", mByteStride);
+        copy(src, "count", mCount);
+        copy(src, "mode", mMode);
+        copy(src, "filter", mFilter);
+    }
+    return *this;
+}
+
+void MeshoptCompression::serialize(object& dst) const
+{
+    write_always(mBuffer, "buffer", dst);
+    write(mByteOffset, "byteOffset", dst, 0);
+    write_always(mByteLength, "byteLength", dst);
+    write_always(mByteStride, "byteStride", dst);
+    write_always(mCount, "count", dst);
+    write_always(mMode, "mode", dst);
+    write(mFilter, "filter", dst, std::string("NONE"));
+}
+// </FS>
+
 void Accessor::serialize(object& dst) const
 {
     write(mName, "name", dst);
@@ -36,6 +36,40 @@ namespace LL
 {
     namespace GLTF
     {
+        // <FS> GLTF meshopt compression
+        // EXT_meshopt_compression on a buffer, marks buffers that only hold
+        // the uncompressed fallback and may come without any data
+        class MeshoptBuffer
+        {
+        public:
+            bool mPresent = false;
+            bool mFallback = false;
+
+            const MeshoptBuffer& operator=(const Value& src);
+            void serialize(boost::json::object& dst) const;
+        };
+
+        // EXT_meshopt_compression (or KHR_meshopt_compression) on a buffer view,
+        // the view's data is decoded from mByteLength bytes at mByteOffset in mBuffer
+        class MeshoptCompression
+        {
+        public:
+            bool mPresent = false;
+            bool mKHR = false;
+
+            S32 mBuffer = INVALID_INDEX;
+            S32 mByteOffset = 0;
+            S32 mByteLength = 0;
+            S32 mByteStride = 0;
+            S32 mCount = 0;
+            std::string mMode;
+            std::string mFilter = "NONE";
+
+            const MeshoptCompression& operator=(const Value& src);
+            void serialize(boost::json::object& dst) const;
+        };
+        // </FS>
+
         class Buffer
         {
         public:
@@ -43,6 +77,7 @@ namespace LL
             std::string mName;
             std::string mUri;
             S32 mByteLength = 0;
+            MeshoptBuffer mMeshopt; // <FS/> GLTF meshopt compression
 
             // erase the given range from this buffer.
             // also updates all buffer views in given asset that reference this buffer
@@ -67,6 +102,19 @@ namespace LL
 
             std::string mName;
 
+            // <FS> GLTF meshopt compression
+            MeshoptCompression mMeshopt;
+
+            // decoded contents of a compressed view, empty otherwise
+            std::vector<U8> mDecodedData;
+
+            // decode compressed data, safe to call for different views at the same time
+            bool prep(Asset& asset);
+
+            // start of this view's data, decoded or straight from the buffer
+            const U8* getData(const Asset& asset) const;
+            // </FS>
+
             void serialize(boost::json::object& obj) const;
             const BufferView& operator=(const Value& value);
         };
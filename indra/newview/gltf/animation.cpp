@@ -29,10 +29,204 @@
 #include "asset.h"
 #include "buffer_util.h"
 #include "../llskinningutil.h"
+#include "llvector4a.h" // <FS/> GLTF animation SoA
 
 using namespace LL::GLTF;
 using namespace boost::json;
 
+// <FS> GLTF animation SoA
+namespace
+{
+    // Channels are interpolated four at a time, one channel per SIMD lane
+    constexpr U32 LANES = 4;
+
+    // out[i] = a[i] + (b[i] - a[i]) * t[i]
+    void lerp_lanes(const vec3* a[LANES], const vec3* b[LANES], const F32 t[LANES], vec3 out[LANES])
+    {
+        LL_ALIGN_16(F32 src[7][LANES]);
+        for (U32 i = 0; i < LANES; ++i)
+        {
+            src[0][i] = a[i]->x;
+            src[1][i] = a[i]->y;
+            src[2][i] = a[i]->z;
+            src[3][i] = b[i]->x;
+            src[4][i] = b[i]->y;
+            src[5][i] = b[i]->z;
+            src[6][i] = t[i];
+        }
+
+        LLVector4a tt;
+        tt.load4a(src[6]);
+
+        LL_ALIGN_16(F32 dst[3][LANES]);
+        for (U32 c = 0; c < 3; ++c)
+        {
+            LLVector4a va, vb;
+            va.load4a(src[c]);
+            vb.load4a(src[c + 3]);
+            vb.sub(va);
+            vb.mul(tt);
+            va.add(vb);
+            va.store4a(dst[c]);
+        }
+
+        for (U32 i = 0; i < LANES; ++i)
+        {
+            out[i] = vec3(dst[0][i], dst[1][i], dst[2][i]);
+        }
+    }
+
+    // out[i] ~= slerp(a[i], b[i], t[i]), normalized
+    //
+    // A normalized lerp with t corrected for the angle between the two
+    // rotations, which stays within 4e-4 of a true slerp without any of
+    // its acos/sin calls.
+    void slerp_lanes(const quat* a[LANES], const quat* b[LANES], const F32 t[LANES], quat out[LANES])
+    {
+        LL_ALIGN_16(F32 src[9][LANES]);
+        for (U32 i = 0; i < LANES; ++i)
+        {
+            src[0][i] = a[i]->x;
+            src[1][i] = a[i]->y;
+            src[2][i] = a[i]->z;
+            src[3][i] = a[i]->w;
+            src[4][i] = b[i]->x;
+            src[5][i] = b[i]->y;
+            src[6][i] = b[i]->z;
+            src[7][i] = b[i]->w;
+            src[8][i] = t[i];
+        }
+
+        LLVector4a qa[4], qb[4], tt;
+        for (U32 c = 0; c < 4; ++c)
+        {
+            qa[c].load4a(src[c]);
+            qb[c].load4a(src[c + 4]);
+        }
+        tt.load4a(src[8]);
+
+        LLVector4a d;
+        d.setMul(qa[0], qb[0]);
+        for (U32 c = 1; c < 4; ++c)
+        {
+            LLVector4a p;
+            p.setMul(qa[c], qb[c]);
+            d.add(p);
+        }
+
+        // take the short way around
+        const LLVector4Logical flip = d.lessThan(LLVector4a::getZero());
+        const LLVector4a minus_one(-1.f);
+        for (U32 c = 0; c < 4; ++c)
+        {
+            LLVector4a neg;
+            neg.setMul(qb[c], minus_one);
+            qb[c].setSelectWithMask(flip, neg, qb[c]);
+        }
+        d.setAbs(d);
+
+        // k = A(d) * (t - 0.5)^2 + B(d), ot = t + t * (t - 0.5) * (t - 1) * k
+        LLVector4a ka(-1.43519f);
+        ka.mul(d);
+        ka.add(LLVector4a(3.55645f));
+        ka.mul(d);
+        ka.add(LLVector4a(-3.2452f));
+        ka.mul(d);
+        ka.add(LLVector4a(1.0904f));
+
+        LLVector4a kb(0.215638f);
+        kb.mul(d);
+        kb.add(LLVector4a(-1.06021f));
+        kb.mul(d);
+        kb.add(LLVector4a(0.848013f));
+
+        LLVector4a th, t1;
+        th.setSub(tt, LLVector4a(0.5f));
+        t1.setSub(tt, LLVector4a(1.f));
+
+        LLVector4a k;
+        k.setMul(th, th);
+        k.mul(ka);
+        k.add(kb);
+
+        LLVector4a ot;
+        ot.setMul(tt, th);
+        ot.mul(t1);
+        ot.mul(k);
+        ot.add(tt);
+
+        LLVector4a len = LLVector4a::getZero();
+        for (U32 c = 0; c < 4; ++c)
+        {
+            qb[c].sub(qa[c]);
+            qb[c].mul(ot);
+            qa[c].add(qb[c]);
+
+            LLVector4a sq;
+            sq.setMul(qa[c], qa[c]);
+            len.add(sq);
+        }
+        len = _mm_sqrt_ps(len);
+
+        LL_ALIGN_16(F32 dst[4][LANES]);
+        for (U32 c = 0; c < 4; ++c)
+        {
+            qa[c].div(len);
+            qa[c].store4a(dst[c]);
+        }
+
+        for (U32 i = 0; i < LANES; ++i)
+        {
+            out[i].x = dst[0][i];
+            out[i].y = dst[1][i];
+            out[i].z = dst[2][i];
+            out[i].w = dst[3][i];
+        }
+    }
+
+    // the keys a channel interpolates between, a sampler with a single
+    // key holds it
+    inline void get_keys(const Animation::Sampler& sampler, U32& k0, U32& k1, F32& t)
+    {
+        k0 = sampler.mFrameIndex;
+        k1 = sampler.mFrameTimes.size() < 2 ? k0 : k0 + 1;
+        t = sampler.mFrameT;
+    }
+
+    // Interpolate vec3 channels in blocks of LANES. Lanes past the end of
+    // the last block repeat its first channel and are not applied.
+    template <typename CHANNEL, typename SET>
+    void apply_vec3_channels(Asset& asset, std::vector<Animation::Sampler>& samplers, std::vector<CHANNEL>& channels,
+                             const std::vector<vec3> CHANNEL::* keys, SET set)
+    {
+        const vec3* a[LANES];
+        const vec3* b[LANES];
+        F32 t[LANES];
+        vec3 out[LANES];
+
+        for (size_t first = 0; first < channels.size(); first += LANES)
+        {
+            const U32 count = (U32)llmin<size_t>(LANES, channels.size() - first);
+            for (U32 i = 0; i < LANES; ++i)
+            {
+                const CHANNEL& channel = channels[first + (i < count ? i : 0)];
+                U32 k0, k1;
+                get_keys(samplers[channel.mSampler], k0, k1, t[i]);
+                a[i] = &(channel.*keys)[k0];
+                b[i] = &(channel.*keys)[k1];
+            }
+
+            lerp_lanes(a, b, t, out);
+
+            for (U32 i = 0; i < count; ++i)
+            {
+                set(asset.mNodes[channels[first + i].mTarget.mNode], out[i]);
+            }
+        }
+    }
+}
+// </FS>
+
 bool Animation::prep(Asset& asset)
 {
     if (!mSamplers.empty())
@@ -95,35 +289,95 @@ void Animation::apply(Asset& asset, float time)
     // convert time to animation loop time
     time = fmod(time, mMaxTime - mMinTime) + mMinTime;
 
+    // <FS> GLTF animation SoA, find the frame once per sampler and
+    // interpolate the channels four at a time
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_GLTF("gltfanim - samplers");
+
+        for (auto& sampler : mSamplers)
+        {
+            sampler.evaluate(asset, time);
+        }
+    }
+    // </FS>
+
     // apply each channel
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_GLTF("gltfanim - rotation");
 
-        for (auto& channel : mRotationChannels)
+        // <FS> GLTF animation SoA
+        //for (auto& channel : mRotationChannels)
+        //{
+        //    channel.apply(asset, mSamplers[channel.mSampler], time);
+        //}
+        const quat* a[LANES];
+        const quat* b[LANES];
+        F32 t[LANES];
+        quat out[LANES];
+
+        for (size_t first = 0; first < mRotationChannels.size(); first += LANES)
         {
-            channel.apply(asset, mSamplers[channel.mSampler], time);
+            const U32 count = (U32)llmin<size_t>(LANES, mRotationChannels.size() - first);
+            for (U32 i = 0; i < LANES; ++i)
+            {
+                const RotationChannel& channel = mRotationChannels[first + (i < count ? i : 0)];
+                U32 k0, k1;
+                get_keys(mSamplers[channel.mSampler], k0, k1, t[i]);
+                a[i] = &channel.mRotations[k0];
+                b[i] = &channel.mRotations[k1];
+            }
+
+            slerp_lanes(a, b, t, out);
+
+            for (U32 i = 0; i < count; ++i)
+            {
+                asset.mNodes[mRotationChannels[first + i].mTarget.mNode].setRotation(out[i]);
+            }
         }
+        // </FS>
     }
 
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_GLTF("gltfanim - translation");
 
-        for (auto& channel : mTranslationChannels)
-        {
-            channel.apply(asset, mSamplers[channel.mSampler], time);
-        }
+        // <FS> GLTF animation SoA
+        //for (auto& channel : mTranslationChannels)
+        //{
+        //    channel.apply(asset, mSamplers[channel.mSampler], time);
+        //}
+        apply_vec3_channels(asset, mSamplers, mTranslationChannels, &TranslationChannel::mTranslations,
+                            [](Node& node, const vec3& v) { node.setTranslation(v); });
+        // </FS>
     }
 
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_GLTF("gltfanim - scale");
 
-        for (auto& channel : mScaleChannels)
-        {
-            channel.apply(asset, mSamplers[channel.mSampler], time);
-        }
+        // <FS> GLTF animation SoA
+        //for (auto& channel : mScaleChannels)
+        //{
+        //    channel.apply(asset, mSamplers[channel.mSampler], time);
+        //}
+        apply_vec3_channels(asset, mSamplers, mScaleChannels, &ScaleChannel::mScales,
+                            [](Node& node, const vec3& v) { node.setScale(v); });
+        // </FS>
     }
 };
 
+// <FS> GLTF animation SoA
+void Animation::Sampler::evaluate(Asset& asset, F32 time)
+{
+    if (mFrameTimes.size() < 2)
+    {
+        mFrameIndex = 0;
+        mFrameT = 0.f;
+        return;
+    }
+
+    getFrameInfo(asset, time, mFrameIndex, mFrameT);
+}
+// </FS>
+
 bool Animation::Sampler::prep(Asset& asset)
 {
     Accessor& accessor = asset.mAccessors[mInput];
@@ -223,25 +477,53 @@ void Animation::Sampler::getFrameInfo(Asset& asset, F32 time, U32& frameIndex, F
         return;
     }
 
-    if (time < mLastFrameTime)
-    {
-        mLastFrameIndex = 0;
-    }
-
+    // <FS> GLTF animation SoA, playback is nearly always monotonic, so try
+    // the cached frame and the one after it before searching
+    //if (time < mLastFrameTime)
+    //{
+    //    mLastFrameIndex = 0;
+    //}
+    //
+    //mLastFrameTime = time;
+    //
+    //U32 idx = mLastFrameIndex;
+    //
+    //for (U32 i = idx; i < (U32)mFrameTimes.size() - 1; i++)
+    //{
+    //    if (time >= mFrameTimes[i] && time < mFrameTimes[i + 1])
+    //    {
+    //        frameIndex = i;
+    //        t = (time - mFrameTimes[i]) / (mFrameTimes[i + 1] - mFrameTimes[i]);
+    //        mLastFrameIndex = frameIndex;
+    //        return;
+    //    }
+    //}
     mLastFrameTime = time;
 
-    U32 idx = mLastFrameIndex;
+    const U32 last = U32(mFrameTimes.size()) - 1;
+    U32 i = mLastFrameIndex;
 
-    for (U32 i = idx; i < (U32)mFrameTimes.size() - 1; i++)
+    if (i >= last || time < mFrameTimes[i] || time >= mFrameTimes[i + 1])
     {
-        if (time >= mFrameTimes[i] && time < mFrameTimes[i + 1])
+        if (i + 2 <= last && time >= mFrameTimes[i + 1] && time < mFrameTimes[i + 2])
         {
-            frameIndex = i;
-            t = (time - mFrameTimes[i]) / (mFrameTimes[i + 1] - mFrameTimes[i]);
-            mLastFrameIndex = frameIndex;
-            return;
+            ++i;
+        }
+        else
+        {
+            auto it = std::upper_bound(mFrameTimes.begin(), mFrameTimes.end(), time);
+            if (it == mFrameTimes.begin() || it == mFrameTimes.end())
+            {
+                return;
+            }
+            i = U32(it - mFrameTimes.begin()) - 1;
         }
     }
+
+    frameIndex = i;
+    t = (time - mFrameTimes[i]) / (mFrameTimes[i + 1] - mFrameTimes[i]);
+    mLastFrameIndex = i;
+    // </FS>
 }
 
 bool Animation::RotationChannel::prep(Asset& asset, Animation::Sampler& sampler)
@@ -52,6 +52,16 @@ namespace LL
                 F32 mLastFrameTime = 0.f;
                 U32 mLastFrameIndex = 0;
 
+                // <FS> GLTF animation SoA
+                // frame index and interpolant at the time of the last evaluate(),
+                // shared by every channel driven by this sampler
+                U32 mFrameIndex = 0;
+                F32 mFrameT = 0.f;
+
+                // update mFrameIndex and mFrameT for the specified time
+                void evaluate(Asset& asset, F32 time);
+                // </FS>
+
                 bool prep(Asset& asset);
 
                 void serialize(boost::json::object& dst) const;
@@ -36,6 +36,11 @@
 #include <boost/url.hpp>
 #include "llimagejpeg.h"
 #include "../llskinningutil.h"
+#include "threadpool.h" // <FS/> GLTF parallel decode
+// <FS> GLTF joint palette
+#include "llmatrix4a.h"
+#include "llvolumesimd.h"
+// </FS>
 
 using namespace LL::GLTF;
 using namespace boost::json;
@@ -47,7 +52,13 @@ namespace LL
     {
         static std::unordered_set<std::string> ExtensionsSupported = {
             "KHR_materials_unlit",
-            "KHR_texture_transform"
+            // <FS> GLTF meshopt compression
+            //"KHR_texture_transform"
+            "KHR_texture_transform",
+            "EXT_meshopt_compression",
+            "KHR_meshopt_compression",
+            "EXT_mesh_gpu_instancing"
+            // </FS>
         };
 
         Material::AlphaMode gltf_alpha_mode_to_enum(const std::string& alpha_mode)
@@ -84,6 +95,21 @@ namespace LL
                 return "OPAQUE";
             }
         }
+
+        // <FS> GLTF instancing
+        // round size up to the alignment glBindBufferRange() wants for uniform buffer offsets
+        static U32 align_ubo_offset(size_t size)
+        {
+            static U32 alignment = 0;
+            if (alignment == 0)
+            {
+                GLint gl_alignment = 256;
+                glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &gl_alignment);
+                alignment = (U32)llmax(gl_alignment, 16);
+            }
+            return (U32)((size + alignment - 1) / alignment * alignment);
+        }
+        // </FS>
     }
 }
 
@@ -129,33 +155,69 @@ void Asset::updateTransforms()
 void Asset::uploadTransforms()
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_GLTF;
-    // prepare matrix palette
-    U32 max_nodes = LLSkinningUtil::getMaxGLTFJointCount();
-
-    size_t node_count = llmin<size_t>(max_nodes, mNodes.size());
-
-    std::vector<mat4> t_mp;
+    // <FS> GLTF instancing
+    //// prepare matrix palette
+    //U32 max_nodes = LLSkinningUtil::getMaxGLTFJointCount();
+    //
+    //size_t node_count = llmin<size_t>(max_nodes, mNodes.size());
+    //
+    //std::vector<mat4> t_mp;
+    //
+    //t_mp.resize(node_count);
+    //
+    //for (U32 i = 0; i < node_count; ++i)
+    //{
+    //    Node& node = mNodes[i];
+    //    // build matrix palette in asset space
+    //    t_mp[i] = node.mAssetMatrix;
+    //}
+    //
+    //std::vector<F32> glmp;
+    //
+    //glmp.resize(node_count * 12);
+    //
+    //F32* mp = glmp.data();
+    //
+    //for (U32 i = 0; i < node_count; ++i)
+    //{
+    //    F32* m = glm::value_ptr(t_mp[i]);
+    //
+    //    U32 idx = i * 12;
+    mInstancePageStride = align_ubo_offset((size_t)mInstancePageSize * 48);
 
-    t_mp.resize(node_count);
-
-    for (U32 i = 0; i < node_count; ++i)
+    if (mNodesUBO == 0)
     {
-        Node& node = mNodes[i];
-        // build matrix palette in asset space
-        t_mp[i] = node.mAssetMatrix;
+        glGenBuffers(1, &mNodesUBO);
     }
 
-    std::vector<F32> glmp;
+    // build the instance palette in asset space, page by page
+    size_t slot_count = mInstanceSlots.size();
+    U32 page_count = mInstancePageSize ? (U32)((slot_count + mInstancePageSize - 1) / mInstancePageSize) : 0;
 
-    glmp.resize(node_count * 12);
+    std::vector<F32> glmp;
 
-    F32* mp = glmp.data();
+    glmp.resize(page_count * mInstancePageStride / sizeof(F32));
 
-    for (U32 i = 0; i < node_count; ++i)
+    for (size_t i = 0; i < slot_count; ++i)
     {
-        F32* m = glm::value_ptr(t_mp[i]);
+        const InstanceSlot& slot = mInstanceSlots[i];
+        if (slot.mNode == INVALID_INDEX)
+        { // padding at the end of a page
+            continue;
+        }
 
-        U32 idx = i * 12;
+        const Node& node = mNodes[slot.mNode];
+        mat4 t_mp = node.mAssetMatrix;
+        if (slot.mInstance != INVALID_INDEX)
+        {
+            t_mp = t_mp * node.mInstanceMatrices[slot.mInstance];
+        }
+
+        F32* m = glm::value_ptr(t_mp);
+        F32* mp = glmp.data() + (i / mInstancePageSize) * mInstancePageStride / sizeof(F32);
+
+        size_t idx = (i % mInstancePageSize) * 12;
+    // </FS>
 
         mp[idx + 0] = m[0];
         mp[idx + 1] = m[1];
@@ -173,15 +235,102 @@ void Asset::uploadTransforms()
         mp[idx + 11] = m[14];
     }
 
-    if (mNodesUBO == 0)
+    // <FS> GLTF instancing
+    //if (mNodesUBO == 0)
+    //{
+    //    glGenBuffers(1, &mNodesUBO);
+    //}
+    // </FS>
+
+    glBindBuffer(GL_UNIFORM_BUFFER, mNodesUBO);
+    glBufferData(GL_UNIFORM_BUFFER, glmp.size() * sizeof(F32), glmp.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+// <FS> GLTF joint palette
+void Asset::uploadJointPalettes()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_GLTF;
+    if (mSkins.empty())
     {
-        glGenBuffers(1, &mNodesUBO);
+        return;
     }
 
-    glBindBuffer(GL_UNIFORM_BUFFER, mNodesUBO);
+    // one buffer for all skins, each palette starting at a bindable offset
+    U32 max_joints = LLSkinningUtil::getMaxGLTFJointCount();
+    size_t total = 0;
+    for (auto& skin : mSkins)
+    {
+        size_t joint_count = llmin<size_t>(max_joints, skin.mJoints.size());
+        skin.mPaletteOffset = (U32)total;
+        skin.mPaletteSize = (U32)(joint_count * 48);
+        total += align_ubo_offset(skin.mPaletteSize);
+    }
+
+    std::vector<F32> glmp;
+    glmp.resize(total / sizeof(F32));
+
+    std::vector<LLMatrix4a> inverse_bind;
+    std::vector<LLMatrix4a> joints;
+    std::vector<LLMatrix4a> palette;
+
+    for (auto& skin : mSkins)
+    {
+        U32 joint_count = skin.mPaletteSize / 48;
+        inverse_bind.resize(joint_count);
+        joints.resize(joint_count);
+        palette.resize(joint_count);
+
+        for (U32 i = 0; i < joint_count; ++i)
+        {
+            if (i < skin.mInverseBindMatricesData.size())
+            {
+                inverse_bind[i].loadu(glm::value_ptr(skin.mInverseBindMatricesData[i]));
+            }
+            else
+            { // no inverseBindMatrices accessor means identity
+                inverse_bind[i].setIdentity();
+            }
+            joints[i].loadu(glm::value_ptr(mNodes[skin.mJoints[i]].mAssetMatrix));
+        }
+
+        // joint asset matrix * inverse bind matrix, in asset space
+        LLVolumeSIMD::multiplyMatrices(inverse_bind.data(), joints.data(), palette.data(), joint_count);
+
+        F32* mp = glmp.data() + skin.mPaletteOffset / sizeof(F32);
+        for (U32 i = 0; i < joint_count; ++i)
+        {
+            const F32* m = palette[i].getF32ptr();
+
+            U32 idx = i * 12;
+
+            mp[idx + 0] = m[0];
+            mp[idx + 1] = m[1];
+            mp[idx + 2] = m[2];
+            mp[idx + 3] = m[12];
+
+            mp[idx + 4] = m[4];
+            mp[idx + 5] = m[5];
+            mp[idx + 6] = m[6];
+            mp[idx + 7] = m[13];
+
+            mp[idx + 8] = m[8];
+            mp[idx + 9] = m[9];
+            mp[idx + 10] = m[10];
+            mp[idx + 11] = m[14];
+        }
+    }
+
+    if (mJointsUBO == 0)
+    {
+        glGenBuffers(1, &mJointsUBO);
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, mJointsUBO);
     glBufferData(GL_UNIFORM_BUFFER, glmp.size() * sizeof(F32), glmp.data(), GL_STREAM_DRAW);
     glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
+// </FS>
 
 void Asset::uploadMaterials()
 {
@@ -392,6 +541,7 @@ void Node::serialize(object& dst) const
     write(mChildren, "children", dst);
     write(mMesh, "mesh", dst, INVALID_INDEX);
     write(mSkin, "skin", dst, INVALID_INDEX);
+    write_extensions(dst, &mInstancing, "EXT_mesh_gpu_instancing"); // <FS/> GLTF instancing
 }
 
 const Node& Node::operator=(const Value& src)
@@ -404,6 +554,7 @@ const Node& Node::operator=(const Value& src)
     copy(src, "children", mChildren);
     copy(src, "mesh", mMesh);
     copy(src, "skin", mSkin);
+    copy_extensions(src, "EXT_mesh_gpu_instancing", &mInstancing); // <FS/> GLTF instancing
 
     if (!mMatrixValid)
     {
@@ -460,10 +611,13 @@ void Asset::update()
 
         updateTransforms();
 
-        for (auto& skin : mSkins)
-        {
-            skin.uploadMatrixPalette(*this);
-        }
+        // <FS> GLTF joint palette, once per frame for every pass that draws this asset
+        //for (auto& skin : mSkins)
+        //{
+        //    skin.uploadMatrixPalette(*this);
+        //}
+        uploadJointPalettes();
+        // </FS>
 
         uploadMaterials();
 
@@ -502,15 +656,73 @@ bool Asset::prep()
         return false;
     }
 
-    // do buffers first as other resources depend on them
-    for (auto& buffer : mBuffers)
+    // <FS> GLTF parallel decode
+    // Buffers, compressed buffer views, embedded images and primitives are
+    // decoded on the General pool, each stage waits for the one before.
+    // Textures and vertex buffers are still created here on the main thread.
+    //// do buffers first as other resources depend on them
+    //for (auto& buffer : mBuffers)
+    //{
+    //    if (!buffer.prep(*this))
+    //    {
+    //        return false;
+    //    }
+    //}
+    //
+    //for (auto& image : mImages)
+    //{
+    //    if (!image.prep(*this))
+    //    {
+    //        return false;
+    //    }
+    //}
+    //
+    //for (auto& mesh : mMeshes)
+    //{
+    //    if (!mesh.prep(*this))
+    //    {
+    //        return false;
+    //    }
+    //}
+    LL::ThreadPoolBase::ptr_t general_pool = LL::ThreadPoolBase::getInstance("General");
+    auto for_each = [&general_pool](size_t count, const std::function<bool(size_t)>& body)
     {
-        if (!buffer.prep(*this))
+        std::atomic<bool> ok{ true };
+        auto chunk = [&](size_t begin, size_t end)
         {
-            return false;
+            for (size_t i = begin; i < end && ok; ++i)
+            {
+                if (!body(i))
+                {
+                    ok = false;
+                }
+            }
+        };
+
+        if (general_pool)
+        {
+            general_pool->parallelFor(0, count, 1, chunk);
+        }
+        else
+        {
+            chunk(0, count);
         }
+        return (bool)ok;
+    };
+
+    // do buffers first as other resources depend on them
+    if (!for_each(mBuffers.size(), [this](size_t i) { return mBuffers[i].prep(*this); }))
+    {
+        return false;
     }
 
+    if (!for_each(mBufferViews.size(), [this](size_t i) { return mBufferViews[i].prep(*this); }))
+    {
+        return false;
+    }
+
+    for_each(mImages.size(), [this](size_t i) { mImages[i].decode(*this); return true; });
+
     for (auto& image : mImages)
     {
         if (!image.prep(*this))
@@ -519,14 +731,21 @@ bool Asset::prep()
         }
     }
 
+    std::vector<Primitive*> primitives;
     for (auto& mesh : mMeshes)
     {
-        if (!mesh.prep(*this))
+        for (auto& primitive : mesh.mPrimitives)
         {
-            return false;
+            primitives.push_back(&primitive);
         }
     }
 
+    if (!for_each(primitives.size(), [this, &primitives](size_t i) { return primitives[i]->prep(*this); }))
+    {
+        return false;
+    }
+    // </FS>
+
     for (auto& animation : mAnimations)
     {
         if (!animation.prep(*this))
@@ -543,6 +762,25 @@ bool Asset::prep()
         }
     }
 
+    // <FS> GLTF instancing
+    for (auto& node : mNodes)
+    {
+        if (!node.prep(*this))
+        {
+            return false;
+        }
+    }
+    // </FS>
+
+    // <FS> GLTF parallel decode
+    // the compressed data is kept for saving, the decoded copies aren't needed anymore
+    for (auto& bufferView : mBufferViews)
+    {
+        bufferView.mDecodedData.clear();
+        bufferView.mDecodedData.shrink_to_fit();
+    }
+    // </FS>
+
     // prepare vertex buffers
 
     // material count is number of materials + 1 for default material
@@ -664,9 +902,199 @@ bool Asset::prep()
             }
         }
     }
+
+    buildInstanceRuns(); // <FS/> GLTF instancing
     return true;
 }
 
+// <FS> GLTF instancing
+void Asset::buildInstanceRuns()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_GLTF;
+    // pbrmetallicroughnessV.glsl declares MAX_NODES_PER_GLTF_OBJECT vec4s, 3 per transform
+    mInstancePageSize = llmax(LLSkinningUtil::getMaxGLTFJointCount() / 3, 1);
+    mInstanceSlots.clear();
+
+    U32 page = 0;
+    U32 used = 0;
+
+    for (RenderData& rd : mRenderData)
+    {
+        for (U32 variant = 0; variant < LLGLSLShader::NUM_GLTF_VARIANTS; ++variant)
+        {
+            for (RenderBatch& batch : rd.mBatches[variant])
+            {
+                batch.mRuns.clear();
+                if (variant & LLGLSLShader::GLTFVariant::RIGGED)
+                { // rigged primitives bind the skin of their node and are drawn one by one
+                    // <FS> GLTF joint palette, keep primitives of the same skin together so its palette is bound once
+                    std::stable_sort(batch.mPrimitives.begin(), batch.mPrimitives.end(),
+                        [this](const RenderBatch::PrimitiveData& a, const RenderBatch::PrimitiveData& b)
+                        {
+                            return mNodes[a.mNodeIndex].mSkin < mNodes[b.mNodeIndex].mSkin;
+                        });
+                    // </FS>
+                    continue;
+                }
+
+                // repeated nodes of the same mesh end up next to each other
+                std::vector<RenderBatch::PrimitiveData> prims = batch.mPrimitives;
+                std::stable_sort(prims.begin(), prims.end(), [this](const RenderBatch::PrimitiveData& a, const RenderBatch::PrimitiveData& b)
+                {
+                    S32 mesh_a = mNodes[a.mNodeIndex].mMesh;
+                    S32 mesh_b = mNodes[b.mNodeIndex].mMesh;
+                    return mesh_a != mesh_b ? mesh_a < mesh_b : a.mPrimitiveIndex < b.mPrimitiveIndex;
+                });
+
+                std::vector<InstanceSlot> slots;
+                for (size_t i = 0; i < prims.size();)
+                {
+                    S32 mesh = mNodes[prims[i].mNodeIndex].mMesh;
+                    S32 primitive = prims[i].mPrimitiveIndex;
+
+                    slots.clear();
+                    for (; i < prims.size() && mNodes[prims[i].mNodeIndex].mMesh == mesh && prims[i].mPrimitiveIndex == primitive; ++i)
+                    {
+                        const Node& node = mNodes[prims[i].mNodeIndex];
+                        if (node.mInstanceMatrices.empty())
+                        {
+                            slots.push_back({ prims[i].mNodeIndex, INVALID_INDEX });
+                        }
+                        else
+                        {
+                            for (S32 j = 0; j < (S32)node.mInstanceMatrices.size(); ++j)
+                            {
+                                slots.push_back({ prims[i].mNodeIndex, j });
+                            }
+                        }
+                    }
+
+                    // a run that fits in a page doesn't straddle two of them
+                    if (slots.size() <= mInstancePageSize && used + slots.size() > mInstancePageSize)
+                    {
+                        ++page;
+                        used = 0;
+                    }
+
+                    for (size_t first = 0; first < slots.size();)
+                    {
+                        if (used == mInstancePageSize)
+                        {
+                            ++page;
+                            used = 0;
+                        }
+
+                        U32 count = (U32)llmin<size_t>(slots.size() - first, mInstancePageSize - used);
+
+                        RenderBatch::InstanceRun run;
+                        run.mMeshIndex = mesh;
+                        run.mPrimitiveIndex = primitive;
+                        run.mPage = page;
+                        run.mFirst = used;
+                        run.mCount = count;
+                        batch.mRuns.push_back(run);
+
+                        mInstanceSlots.resize((size_t)page * mInstancePageSize + used);
+                        mInstanceSlots.insert(mInstanceSlots.end(), slots.begin() + first, slots.begin() + first + count);
+
+                        first += count;
+                        used += count;
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool Node::prep(Asset& asset)
+{
+    mInstanceMatrices.clear();
+    if (!mInstancing.mPresent || mMesh == INVALID_INDEX)
+    {
+        return true;
+    }
+
+    std::vector<vec3> translations;
+    std::vector<quat> rotations;
+    std::vector<vec3> scales;
+    S32 count = -1;
+
+    for (const auto& [name, index] : mInstancing.mAttributes)
+    {
+        if (name != "TRANSLATION" && name != "ROTATION" && name != "SCALE")
+        { // custom attributes (_ID etc) aren't used
+            continue;
+        }
+
+        if (index < 0 || index >= (S32)asset.mAccessors.size())
+        {
+            LL_WARNS("GLTF") << "Invalid EXT_mesh_gpu_instancing accessor on node " << mName << LL_ENDL;
+            return false;
+        }
+
+        Accessor& accessor = asset.mAccessors[index];
+
+        Accessor::Type type = name == "ROTATION" ? Accessor::Type::VEC4 : Accessor::Type::VEC3;
+        if (accessor.mType != type || accessor.mComponentType != Accessor::ComponentType::FLOAT)
+        { // quantized instance transforms aren't supported, draw the mesh once
+            LL_WARNS("GLTF") << "Unsupported " << name << " instance attribute on node " << mName << LL_ENDL;
+            return true;
+        }
+
+        if (count != -1 && count != accessor.mCount)
+        {
+            LL_WARNS("GLTF") << "Mismatched EXT_mesh_gpu_instancing attribute counts on node " << mName << LL_ENDL;
+            return false;
+        }
+        count = accessor.mCount;
+
+        if (name == "TRANSLATION")
+        {
+            copy(asset, accessor, translations);
+        }
+        else if (name == "ROTATION")
+        {
+            copy(asset, accessor, rotations);
+        }
+        else
+        {
+            copy(asset, accessor, scales);
+        }
+    }
+
+    if (count <= 0)
+    {
+        return true;
+    }
+
+    mInstanceMatrices.resize(count);
+    for (S32 i = 0; i < count; ++i)
+    {
+        vec3 translation = translations.empty() ? vec3(0, 0, 0) : translations[i];
+        quat rotation = rotations.empty() ? glm::identity<quat>() : rotations[i];
+        vec3 scale = scales.empty() ? vec3(1, 1, 1) : scales[i];
+        mInstanceMatrices[i] = glm::recompose(scale, rotation, translation, vec3(0, 0, 0), vec4(0, 0, 0, 1));
+    }
+
+    return true;
+}
+
+const MeshGpuInstancing& MeshGpuInstancing::operator=(const Value& src)
+{
+    mPresent = true;
+    if (src.is_object())
+    {
+        copy(src, "attributes", mAttributes);
+    }
+    return *this;
+}
+
+void MeshGpuInstancing::serialize(object& dst) const
+{
+    write(mAttributes, "attributes", dst);
+}
+// </FS>
+
 Asset::Asset(const Value& src)
 {
     *this = src;
@@ -935,6 +1363,33 @@ void Asset::eraseBufferView(S32 bufferView)
 
 LLViewerFetchedTexture* fetch_texture(const LLUUID& id);
 
+// <FS> GLTF parallel decode
+void Image::decode(Asset& asset)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_GLTF;
+    if (mBufferView == INVALID_INDEX || mBufferView >= (S32)asset.mBufferViews.size() || mDecodedImage.notNull())
+    {
+        return;
+    }
+
+    LLUUID id;
+    if ((mUri.size() == UUID_STR_SIZE && LLUUID::parseUUID(mUri, &id) && id.notNull()) || mUri.find("data:") == 0)
+    { // prep() takes asset and data URIs first
+        return;
+    }
+
+    const BufferView& bufferView = asset.mBufferViews[mBufferView];
+    if (bufferView.mBuffer < 0 || bufferView.mBuffer >= (S32)asset.mBuffers.size() ||
+        (size_t)bufferView.mByteOffset + (size_t)bufferView.mByteLength > asset.mBuffers[bufferView.mBuffer].mData.size())
+    {
+        return;
+    }
+
+    // the caller owns what getRawImageFromMemory() returns
+    mDecodedImage = LLViewerTextureManager::getRawImageFromMemory(bufferView.getData(asset), bufferView.mByteLength, mMimeType);
+}
+// </FS>
+
 bool Image::prep(Asset& asset)
 {
     LLUUID id;
@@ -949,12 +1404,20 @@ bool Image::prep(Asset& asset)
     }
     else if (mBufferView != INVALID_INDEX)
     { // embedded in a buffer, load the texture from the buffer
-        BufferView& bufferView = asset.mBufferViews[mBufferView];
-        Buffer& buffer = asset.mBuffers[bufferView.mBuffer];
-
-        U8* data = buffer.mData.data() + bufferView.mByteOffset;
-
-        mTexture = LLViewerTextureManager::getFetchedTextureFromMemory(data, bufferView.mByteLength, mMimeType);
+        // <FS> GLTF parallel decode
+        //BufferView& bufferView = asset.mBufferViews[mBufferView];
+        //Buffer& buffer = asset.mBuffers[bufferView.mBuffer];
+        //
+        //U8* data = buffer.mData.data() + bufferView.mByteOffset;
+        //
+        //mTexture = LLViewerTextureManager::getFetchedTextureFromMemory(data, bufferView.mByteLength, mMimeType);
+        if (mDecodedImage.isNull())
+        {
+            decode(asset);
+        }
+        mTexture = LLViewerTextureManager::getFetchedTextureFromRaw(mDecodedImage);
+        mDecodedImage = nullptr;
+        // </FS>
 
         if (mTexture.isNull())
         {
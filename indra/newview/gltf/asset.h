@@ -177,6 +177,18 @@ namespace LL
             bool prep(Asset& asset);
         };
 
+        // <FS> GLTF instancing
+        class MeshGpuInstancing : public Extension // EXT_mesh_gpu_instancing implementation
+        {
+        public:
+            // accessor index by attribute, TRANSLATION, ROTATION and SCALE are used
+            std::unordered_map<std::string, S32> mAttributes;
+
+            const MeshGpuInstancing& operator=(const Value& src);
+            void serialize(boost::json::object& dst) const;
+        };
+        // </FS>
+
         class Node
         {
         public:
@@ -204,6 +216,17 @@ namespace LL
 
             std::string mName;
 
+            // <FS> GLTF instancing
+            MeshGpuInstancing mInstancing;
+
+            // node space transforms of the EXT_mesh_gpu_instancing instances,
+            // empty if this node's mesh is drawn once
+            std::vector<mat4> mInstanceMatrices;
+
+            // fill mInstanceMatrices from the instancing accessors
+            bool prep(Asset& asset);
+            // </FS>
+
             const Node& operator=(const Value& src);
             void serialize(boost::json::object& dst) const;
 
@@ -238,6 +261,10 @@ namespace LL
             S32 mSkeleton = INVALID_INDEX;
 
             U32 mUBO = 0;
+            // <FS> GLTF joint palette, where this skin's palette lives in Asset::mJointsUBO
+            U32 mPaletteOffset = 0;
+            U32 mPaletteSize = 0;
+            // </FS>
             std::vector<S32> mJoints;
             std::string mName;
             std::vector<mat4> mInverseBindMatricesData;
@@ -316,6 +343,15 @@ namespace LL
             // preserve only uri and name
             void clearData(Asset& asset);
 
+            // <FS> GLTF parallel decode
+            // decoded image embedded in a buffer view, picked up by prep()
+            LLPointer<LLImageRaw> mDecodedImage;
+
+            // decode an image embedded in a buffer view, safe to call for
+            // different images at the same time
+            void decode(Asset& asset);
+            // </FS>
+
             bool prep(Asset& asset);
         };
 
@@ -332,6 +368,23 @@ namespace LL
 
             LLPointer<LLVertexBuffer> mVertexBuffer;
             std::vector<PrimitiveData> mPrimitives;
+
+            // <FS> GLTF instancing
+            // one primitive drawn mCount times with a single instanced draw,
+            // the transforms are mCount consecutive slots of the instance
+            // palette starting at mFirst in page mPage
+            struct InstanceRun
+            {
+                S32 mMeshIndex = INVALID_INDEX;
+                S32 mPrimitiveIndex = INVALID_INDEX;
+                U32 mPage = 0;
+                U32 mFirst = 0;
+                U32 mCount = 0;
+            };
+
+            // mPrimitives grouped by primitive, empty for rigged batches
+            std::vector<InstanceRun> mRuns;
+            // </FS>
         };
 
         class RenderData
@@ -387,8 +440,32 @@ namespace LL
             RenderData mRenderData[2];
 
             // UBO for storing node transforms
+            // <FS/> GLTF instancing, holds the instance palette in pages of mInstancePageSize transforms
             U32 mNodesUBO = 0;
 
+            // <FS> GLTF instancing
+            // what a slot of the instance palette holds, the asset transform
+            // of mNode times its instance mInstance (if any)
+            struct InstanceSlot
+            {
+                S32 mNode = INVALID_INDEX;
+                S32 mInstance = INVALID_INDEX;
+            };
+
+            // slot i lives in page i / mInstancePageSize
+            std::vector<InstanceSlot> mInstanceSlots;
+            U32 mInstancePageSize = 0;
+            U32 mInstancePageStride = 0; // bytes between pages in mNodesUBO
+
+            // group the render batches into InstanceRuns and lay out the palette
+            void buildInstanceRuns();
+            // </FS>
+
+            // <FS> GLTF joint palette
+            // UBO holding the joint palettes of every skin, see Skin::mPaletteOffset
+            U32 mJointsUBO = 0;
+            // </FS>
+
             // UBO for storing material data
             U32 mMaterialsUBO = 0;
 
@@ -408,6 +485,9 @@ namespace LL
             // upload matrices to UBO
             void uploadTransforms();
 
+            // <FS/> GLTF joint palette, upload the joint palettes of all skins to mJointsUBO
+            void uploadJointPalettes();
+
             // upload materils to UBO
             void uploadMaterials();
 
@@ -370,8 +370,11 @@ namespace LL
         inline void copy(Asset& asset, Accessor& accessor, LLStrider<T>& dst)
         {
             const BufferView& bufferView = asset.mBufferViews[accessor.mBufferView];
-            const Buffer& buffer = asset.mBuffers[bufferView.mBuffer];
-            const U8* src = buffer.mData.data() + bufferView.mByteOffset + accessor.mByteOffset;
+            // <FS> GLTF meshopt compression
+            //const Buffer& buffer = asset.mBuffers[bufferView.mBuffer];
+            //const U8* src = buffer.mData.data() + bufferView.mByteOffset + accessor.mByteOffset;
+            const U8* src = bufferView.getData(asset) + accessor.mByteOffset;
+            // </FS>
 
             switch (accessor.mComponentType)
             {
@@ -645,6 +645,8 @@ void GLTFSceneManager::render(Asset& asset, U8 variant)
         bool rigged = variant & LLGLSLShader::GLTFVariant::RIGGED;
 
         bool shader_bound = false;
+        S32 bound_page = -1; // <FS/> GLTF instancing
+        S32 bound_skin = INVALID_INDEX; // <FS/> GLTF joint palette
 
         for (U32 i = 0; i < batches.size(); ++i)
         {
@@ -664,10 +666,12 @@ void GLTFSceneManager::render(Asset& asset, U8 variant)
                     gPipeline.bindDeferredShader(gGLTFPBRMetallicRoughnessProgram.mGLTFVariants[variant]);
                 }
 
-                if (!rigged)
-                {
-                    glBindBufferBase(GL_UNIFORM_BUFFER, LLGLSLShader::UB_GLTF_NODES, asset.mNodesUBO);
-                }
+                // <FS> GLTF instancing, pages of the instance palette are bound per run
+                //if (!rigged)
+                //{
+                //    glBindBufferBase(GL_UNIFORM_BUFFER, LLGLSLShader::UB_GLTF_NODES, asset.mNodesUBO);
+                //}
+                // </FS>
 
                 glBindBufferBase(GL_UNIFORM_BUFFER, LLGLSLShader::UB_GLTF_MATERIALS, asset.mMaterialsUBO);
 
@@ -697,6 +701,36 @@ void GLTFSceneManager::render(Asset& asset, U8 variant)
                 LLGLSLShader::sCurBoundShaderPtr->uniform1i(LLShaderMgr::GLTF_MATERIAL_ID, -1);
             }
 
+            // <FS> GLTF instancing
+            if (!rigged)
+            {
+                for (auto& run : batches[i].mRuns)
+                {
+                    LL_PROFILE_ZONE_NAMED_CATEGORY_GLTF("GLTF draw call");
+                    Primitive& primitive = asset.mMeshes[run.mMeshIndex].mPrimitives[run.mPrimitiveIndex];
+
+                    if ((S32)run.mPage != bound_page)
+                    {
+                        glBindBufferRange(GL_UNIFORM_BUFFER, LLGLSLShader::UB_GLTF_NODES, asset.mNodesUBO,
+                            (GLintptr)run.mPage * asset.mInstancePageStride, (GLsizeiptr)asset.mInstancePageSize * 48);
+                        bound_page = run.mPage;
+                    }
+
+                    LLGLSLShader::sCurBoundShaderPtr->uniform1i(LLShaderMgr::GLTF_NODE_ID, run.mFirst);
+
+                    if (run.mCount == 1)
+                    {
+                        primitive.mVertexBuffer->drawRangeFast(primitive.mGLMode, primitive.mVertexOffset, primitive.mVertexOffset + primitive.getVertexCount() - 1, primitive.getIndexCount(), primitive.mIndexOffset);
+                    }
+                    else
+                    {
+                        primitive.mVertexBuffer->drawInstanced(primitive.mGLMode, primitive.getIndexCount(), primitive.mIndexOffset, run.mCount);
+                    }
+                }
+                continue;
+            }
+            // </FS>
+
             for (auto& pdata : batches[i].mPrimitives)
             {
                 LL_PROFILE_ZONE_NAMED_CATEGORY_GLTF("GLTF draw call");
@@ -709,7 +743,15 @@ void GLTFSceneManager::render(Asset& asset, U8 variant)
                     LL_PROFILE_ZONE_NAMED_CATEGORY_GLTF("gltfdc - bind skin");
                     llassert(node.mSkin != INVALID_INDEX);
                     Skin& skin = asset.mSkins[node.mSkin];
-                    glBindBufferBase(GL_UNIFORM_BUFFER, LLGLSLShader::UB_GLTF_JOINTS, skin.mUBO);
+                    // <FS> GLTF joint palette
+                    //glBindBufferBase(GL_UNIFORM_BUFFER, LLGLSLShader::UB_GLTF_JOINTS, skin.mUBO);
+                    if (node.mSkin != bound_skin)
+                    {
+                        glBindBufferRange(GL_UNIFORM_BUFFER, LLGLSLShader::UB_GLTF_JOINTS, asset.mJointsUBO,
+                            skin.mPaletteOffset, llmax(skin.mPaletteSize, 48U));
+                        bound_skin = node.mSkin;
+                    }
+                    // </FS>
                 }
                 else
                 {
@@ -56,6 +56,7 @@
 #include "rlvhandler.h"
 // [/RLVa:KB]
 #include "fscommon.h"
+#include "fssettingkeys.h" // <FS/> Keyed settings access
 #include "lltrans.h"
 
 using namespace LLAvatarAppearanceDefines;
@@ -1259,8 +1260,12 @@ void LLAgentCamera::updateLookAt(const S32 mouse_x, const S32 mouse_y)
             F32 y_from_center =
                 ((F32) mouse_y / (F32) gViewerWindow->getWorldViewHeightScaled() ) - 0.5f;
 
-            frameCamera.yaw( - x_from_center * gSavedSettings.getF32("YawFromMousePosition") * DEG_TO_RAD);
-            frameCamera.pitch( - y_from_center * gSavedSettings.getF32("PitchFromMousePosition") * DEG_TO_RAD);
+            // <FS> Keyed settings access
+            //frameCamera.yaw( - x_from_center * gSavedSettings.getF32("YawFromMousePosition") * DEG_TO_RAD);
+            //frameCamera.pitch( - y_from_center * gSavedSettings.getF32("PitchFromMousePosition") * DEG_TO_RAD);
+            frameCamera.yaw( - x_from_center * gSavedSettings.get(FSSetting::YawFromMousePosition) * DEG_TO_RAD);
+            frameCamera.pitch( - y_from_center * gSavedSettings.get(FSSetting::PitchFromMousePosition) * DEG_TO_RAD);
+            // </FS>
             lookAtType = LOOKAT_TARGET_FREELOOK;
         }
 
@@ -1557,7 +1562,10 @@ void LLAgentCamera::updateCamera()
         {
             const F32 SMOOTHING_HALF_LIFE = 0.02f;
 
-            F32 smoothing = LLSmoothInterpolation::getInterpolant(gSavedSettings.getF32("CameraPositionSmoothing") * SMOOTHING_HALF_LIFE, false);
+            // <FS> Keyed settings access
+            //F32 smoothing = LLSmoothInterpolation::getInterpolant(gSavedSettings.getF32("CameraPositionSmoothing") * SMOOTHING_HALF_LIFE, false);
+            F32 smoothing = LLSmoothInterpolation::getInterpolant(gSavedSettings.get(FSSetting::CameraPositionSmoothing) * SMOOTHING_HALF_LIFE, false);
+            // </FS>
 
             if (mFocusOnAvatar && !mFocusObject) // we differentiate on avatar mode
             {
@@ -41,6 +41,7 @@
 #include "llviewercontrol.h"
 
 #include "llviewernetwork.h"
+#include "workqueue.h" // <FS/> Background AIS parsing
 
 ///----------------------------------------------------------------------------
 /// Classes for AISv3 support.
@@ -52,6 +53,7 @@ const std::string AISAPI::LIBRARY_CAP_NAME("LibraryAPIv3");
 const S32 AISAPI::HTTP_TIMEOUT = 180;
 
 std::list<AISAPI::ais_query_item_t> AISAPI::sPostponedQuery;
+S32 AISAPI::sPostponedUrgent = 0; // <FS/> Coprocedure priorities
 
 const S32 MAX_SIMULTANEOUS_COROUTINES = 2048;
 
@@ -414,7 +416,10 @@ void AISAPI::UpdateItem(const LLUUID &itemId, const LLSD &updates, completion_t
 }
 
 /*static*/
-void AISAPI::FetchItem(const LLUUID &itemId, ITEM_TYPE type, completion_t callback)
+// <FS> Adaptive AIS fetch
+//void AISAPI::FetchItem(const LLUUID &itemId, ITEM_TYPE type, completion_t callback)
+void AISAPI::FetchItem(const LLUUID &itemId, ITEM_TYPE type, completion_t callback, LLCoprocedureManager::EPriority priority)
+// </FS>
 {
     std::string cap;
 
@@ -445,11 +450,18 @@ void AISAPI::FetchItem(const LLUUID &itemId, ITEM_TYPE type, completion_t callba
     LLCoprocedureManager::CoProcedure_t proc(boost::bind(&AISAPI::InvokeAISCommandCoro,
         _1, getFn, url, itemId, LLSD(), callback, FETCHITEM));
 
-    EnqueueAISCommand("FetchItem", proc);
+    // <FS> Coprocedure priorities, bulk fetches go after edits
+    //EnqueueAISCommand("FetchItem", proc);
+    EnqueueAISCommand("FetchItem", proc, priority);
+    // </FS>
 }
 
 /*static*/
-void AISAPI::FetchCategoryChildren(const LLUUID &catId, ITEM_TYPE type, bool recursive, completion_t callback, S32 depth)
+// <FS> Adaptive AIS fetch
+//void AISAPI::FetchCategoryChildren(const LLUUID &catId, ITEM_TYPE type, bool recursive, completion_t callback, S32 depth)
+void AISAPI::FetchCategoryChildren(const LLUUID &catId, ITEM_TYPE type, bool recursive, completion_t callback, S32 depth,
+                                   LLCoprocedureManager::EPriority priority)
+// </FS>
 {
     std::string cap;
 
@@ -496,7 +508,10 @@ void AISAPI::FetchCategoryChildren(const LLUUID &catId, ITEM_TYPE type, bool rec
     LLCoprocedureManager::CoProcedure_t proc(boost::bind(&AISAPI::InvokeAISCommandCoro,
         _1, getFn, url, catId, body, callback, FETCHCATEGORYCHILDREN));
 
-    EnqueueAISCommand("FetchCategoryChildren", proc);
+    // <FS> Coprocedure priorities, bulk fetches go after edits
+    //EnqueueAISCommand("FetchCategoryChildren", proc);
+    EnqueueAISCommand("FetchCategoryChildren", proc, priority);
+    // </FS>
 }
 
 // some folders can be requested by name, like
@@ -549,7 +564,10 @@ void AISAPI::FetchCategoryChildren(const std::string &identifier, bool recursive
     LLCoprocedureManager::CoProcedure_t proc(boost::bind(&AISAPI::InvokeAISCommandCoro,
         _1, getFn, url, LLUUID::null, body, callback, FETCHCATEGORYCHILDREN));
 
-    EnqueueAISCommand("FetchCategoryChildren", proc);
+    // <FS> Coprocedure priorities, bulk fetches go after edits
+    //EnqueueAISCommand("FetchCategoryChildren", proc);
+    EnqueueAISCommand("FetchCategoryChildren", proc, LLCoprocedureManager::PRIORITY_LOW);
+    // </FS>
 }
 
 /*static*/
@@ -600,7 +618,10 @@ void AISAPI::FetchCategoryCategories(const LLUUID &catId, ITEM_TYPE type, bool r
     LLCoprocedureManager::CoProcedure_t proc(boost::bind(&AISAPI::InvokeAISCommandCoro,
         _1, getFn, url, catId, body, callback, FETCHCATEGORYCATEGORIES));
 
-    EnqueueAISCommand("FetchCategoryCategories", proc);
+    // <FS> Coprocedure priorities, bulk fetches go after edits
+    //EnqueueAISCommand("FetchCategoryCategories", proc);
+    EnqueueAISCommand("FetchCategoryCategories", proc, LLCoprocedureManager::PRIORITY_LOW);
+    // </FS>
 }
 
 void AISAPI::FetchCategorySubset(const LLUUID& catId,
@@ -677,7 +698,10 @@ void AISAPI::FetchCategorySubset(const LLUUID& catId,
     LLCoprocedureManager::CoProcedure_t proc(boost::bind(&AISAPI::InvokeAISCommandCoro,
                                                          _1, getFn, url, catId, body, callback, FETCHCATEGORYSUBSET));
 
-    EnqueueAISCommand("FetchCategorySubset", proc);
+    // <FS> Coprocedure priorities, bulk fetches go after edits
+    //EnqueueAISCommand("FetchCategorySubset", proc);
+    EnqueueAISCommand("FetchCategorySubset", proc, LLCoprocedureManager::PRIORITY_LOW);
+    // </FS>
 }
 
 /*static*/
@@ -751,7 +775,10 @@ void AISAPI::FetchCategoryLinks(const LLUUID &catId, completion_t callback)
     LLCoprocedureManager::CoProcedure_t proc(
         boost::bind(&AISAPI::InvokeAISCommandCoro, _1, getFn, url, LLUUID::null, body, callback, FETCHCATEGORYLINKS));
 
-    EnqueueAISCommand("FetchCategoryLinks", proc);
+    // <FS> Coprocedure priorities, bulk fetches go after edits
+    //EnqueueAISCommand("FetchCategoryLinks", proc);
+    EnqueueAISCommand("FetchCategoryLinks", proc, LLCoprocedureManager::PRIORITY_LOW);
+    // </FS>
 }
 
 /*static*/
@@ -784,33 +811,59 @@ void AISAPI::FetchOrphans(completion_t callback)
     LLCoprocedureManager::CoProcedure_t proc(boost::bind(&AISAPI::InvokeAISCommandCoro ,
                                                          _1 , getFn , url , LLUUID::null , LLSD() , callback , FETCHORPHANS));
 
-    EnqueueAISCommand("FetchOrphans" , proc);
+    // <FS> Coprocedure priorities, bulk fetches go after edits
+    //EnqueueAISCommand("FetchOrphans" , proc);
+    EnqueueAISCommand("FetchOrphans" , proc, LLCoprocedureManager::PRIORITY_LOW);
+    // </FS>
 }
 
 /*static*/
-void AISAPI::EnqueueAISCommand(const std::string &procName, LLCoprocedureManager::CoProcedure_t proc)
+// <FS> Coprocedure priorities
+//void AISAPI::EnqueueAISCommand(const std::string &procName, LLCoprocedureManager::CoProcedure_t proc)
+void AISAPI::EnqueueAISCommand(const std::string &procName, LLCoprocedureManager::CoProcedure_t proc, LLCoprocedureManager::EPriority priority)
+// </FS>
 {
     LLCoprocedureManager &inst = LLCoprocedureManager::instance();
     auto pending_in_pool = inst.countPending("AIS");
     std::string procFullName = "AIS(" + procName + ")";
-    if (pending_in_pool < MAX_SIMULTANEOUS_COROUTINES)
-    {
-        inst.enqueueCoprocedure("AIS", procFullName, proc);
+    // <FS> Coprocedure priorities
+    // Edits don't wait behind postponed fetches, but stay in order among
+    // themselves.
+    bool urgent = priority > LLCoprocedureManager::PRIORITY_LOW;
+    //if (pending_in_pool < MAX_SIMULTANEOUS_COROUTINES)
+    if (pending_in_pool < MAX_SIMULTANEOUS_COROUTINES || (urgent && sPostponedUrgent == 0))
+    // </FS>
+    {
+        // <FS> Coprocedure priorities
+        //inst.enqueueCoprocedure("AIS", procFullName, proc);
+        inst.enqueueCoprocedure("AIS", procFullName, proc, priority);
+        // </FS>
     }
     else
     {
         // As I understand it, coroutines have built-in 'pending' pool
         // but unfortunately it has limited size which inventory often goes over
         // so this is a workaround to not overfill it.
+        // <FS> Coprocedure priorities
+        //if (sPostponedQuery.empty())
+        //{
+        //    sPostponedQuery.push_back(ais_query_item_t(procFullName, proc));
+        //    gIdleCallbacks.addFunction(onIdle, NULL);
+        //}
+        //else
+        //{
+        //    sPostponedQuery.push_back(ais_query_item_t(procFullName, proc));
+        //}
         if (sPostponedQuery.empty())
         {
-            sPostponedQuery.push_back(ais_query_item_t(procFullName, proc));
             gIdleCallbacks.addFunction(onIdle, NULL);
         }
-        else
+        sPostponedQuery.push_back({ procFullName, proc, priority });
+        if (urgent)
         {
-            sPostponedQuery.push_back(ais_query_item_t(procFullName, proc));
+            ++sPostponedUrgent;
         }
+        // </FS>
     }
 }
 
@@ -824,7 +877,14 @@ void AISAPI::onIdle(void *userdata)
         while (pending_in_pool < MAX_SIMULTANEOUS_COROUTINES && !sPostponedQuery.empty())
         {
             ais_query_item_t &item = sPostponedQuery.front();
-            inst.enqueueCoprocedure("AIS", item.first, item.second);
+            // <FS> Coprocedure priorities
+            //inst.enqueueCoprocedure("AIS", item.first, item.second);
+            inst.enqueueCoprocedure("AIS", item.mName, item.mProc, item.mPriority);
+            if (item.mPriority > LLCoprocedureManager::PRIORITY_LOW)
+            {
+                --sPostponedUrgent;
+            }
+            // </FS>
             sPostponedQuery.pop_front();
             pending_in_pool++;
         }
@@ -1063,9 +1123,160 @@ AISUpdate::AISUpdate(const LLSD& update, AISAPI::COMMAND_TYPE type, const LLSD&
 
     mTimer.setTimerExpirySec(AIS_EXPIRY_SECONDS);
     mTimer.start();
+    // <FS> Background AIS parsing
+    if (mFetch)
+    {
+        stageContent(update);
+    }
+    // </FS>
     parseUpdate(update);
 }
 
+// <FS> Background AIS parsing
+namespace
+{
+    // Below this many objects the round trip to a worker costs more
+    // than unpacking in place
+    constexpr size_t AIS_STAGING_MIN_OBJECTS = 64;
+
+    const char* const EMBEDDED_MAPS[] = { "links", "items", "categories" };
+    const char* const EMBEDDED_SINGLES[] = { "item", "category" };
+
+    size_t count_embedded(const LLSD& object, size_t limit)
+    {
+        size_t count = 0;
+        const LLSD& embedded = object["_embedded"];
+        for (const char* key : EMBEDDED_MAPS)
+        {
+            const LLSD& objects = embedded[key];
+            count += objects.size();
+            for (LLSD::map_const_iterator it = objects.beginMap(), end = objects.endMap();
+                 it != end && count < limit; ++it)
+            {
+                count += count_embedded(it->second, limit - count);
+            }
+            if (count >= limit)
+            {
+                break;
+            }
+        }
+        return count;
+    }
+
+    struct AISStagedContent
+    {
+        std::unordered_map<LLUUID, LLPointer<LLViewerInventoryItem> > mItems;
+        std::unordered_map<LLUUID, LLPointer<LLViewerInventoryCategory> > mCategories;
+    };
+
+    // Runs on a worker: only the LLSD and the new objects are touched.
+    // Links unpack like items; name localization is left to the main thread.
+    void stage_object(const LLSD& object, AISStagedContent& staged)
+    {
+        if (object.has("item_id") && object.has("parent_id"))
+        {
+            LLPointer<LLViewerInventoryItem> item(new LLViewerInventoryItem);
+            if (item->LLInventoryItem::fromLLSD(object))
+            {
+                staged.mItems.emplace(item->getUUID(), item);
+            }
+        }
+        else if (object.has("category_id") && object.has("parent_id"))
+        {
+            LLPointer<LLViewerInventoryCategory> category(
+                new LLViewerInventoryCategory(object.has("agent_id") ? object["agent_id"].asUUID() : LLUUID::null));
+            if (category->LLInventoryCategory::fromLLSD(object))
+            {
+                staged.mCategories.emplace(category->getUUID(), category);
+            }
+        }
+
+        const LLSD& embedded = object["_embedded"];
+        for (const char* key : EMBEDDED_MAPS)
+        {
+            const LLSD& objects = embedded[key];
+            for (LLSD::map_const_iterator it = objects.beginMap(), end = objects.endMap(); it != end; ++it)
+            {
+                stage_object(it->second, staged);
+            }
+        }
+        for (const char* key : EMBEDDED_SINGLES)
+        {
+            if (embedded.has(key))
+            {
+                stage_object(embedded[key], staged);
+            }
+        }
+    }
+}
+
+void AISUpdate::stageContent(const LLSD& update)
+{
+    static LLCachedControl<bool> background_parsing(gSavedSettings, "FSBackgroundAISParsing");
+    if (!background_parsing || LLCoros::getName().empty() ||
+        count_embedded(update, AIS_STAGING_MIN_OBJECTS) < AIS_STAGING_MIN_OBJECTS)
+    {
+        return;
+    }
+
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    if (!general_queue)
+    {
+        return;
+    }
+
+    LLTimer timer;
+    try
+    {
+        // The coroutine owns update and stays suspended until the worker
+        // is done with it, so nothing else touches the LLSD meanwhile
+        AISStagedContent staged = general_queue->waitForResult([&update]()
+        {
+            AISStagedContent result;
+            stage_object(update, result);
+            return result;
+        });
+        mStagedItems.swap(staged.mItems);
+        mStagedCategories.swap(staged.mCategories);
+    }
+    catch (const LL::WorkQueue::Closed&)
+    {
+        return;
+    }
+    LL_DEBUGS("Inventory", "AIS3") << "Staged " << mStagedItems.size() << " items and " << mStagedCategories.size()
+                                   << " categories in " << timer.getElapsedTimeF32() << "s" << LL_ENDL;
+
+    // Unpacking took a while; give the main thread a full slice first
+    mTimer.setTimerExpirySec(AIS_EXPIRY_SECONDS);
+}
+
+LLPointer<LLViewerInventoryItem> AISUpdate::takeStagedItem(const LLUUID& item_id)
+{
+    LLPointer<LLViewerInventoryItem> item;
+    staged_item_map_t::iterator it = mStagedItems.find(item_id);
+    if (it != mStagedItems.end())
+    {
+        item = it->second;
+        mStagedItems.erase(it);
+        item->localizeName();
+    }
+    return item;
+}
+
+LLPointer<LLViewerInventoryCategory> AISUpdate::takeStagedCategory(const LLUUID& category_id)
+{
+    LLPointer<LLViewerInventoryCategory> category;
+    staged_category_map_t::iterator it = mStagedCategories.find(category_id);
+    if (it != mStagedCategories.end())
+    {
+        category = it->second;
+        mStagedCategories.erase(it);
+        category->localizeName();
+    }
+    return category;
+}
+// </FS>
+
 void AISUpdate::clearParseResults()
 {
     mCatDescendentDeltas.clear();
@@ -1216,14 +1427,29 @@ void AISUpdate::parseContent(const LLSD& update)
 void AISUpdate::parseItem(const LLSD& item_map)
 {
     LLUUID item_id = item_map["item_id"].asUUID();
-    LLPointer<LLViewerInventoryItem> new_item(new LLViewerInventoryItem);
+    // <FS> Background AIS parsing
+    //LLPointer<LLViewerInventoryItem> new_item(new LLViewerInventoryItem);
+    //LLViewerInventoryItem *curr_item = gInventory.getItem(item_id);
+    //if (curr_item)
+    //{
+    //    // Default to current values where not provided.
+    //    new_item->copyViewerItem(curr_item);
+    //}
+    //bool rv = new_item->unpackMessage(item_map);
     LLViewerInventoryItem *curr_item = gInventory.getItem(item_id);
-    if (curr_item)
+    LLPointer<LLViewerInventoryItem> new_item(curr_item ? LLPointer<LLViewerInventoryItem>() : takeStagedItem(item_id));
+    bool rv = new_item.notNull();
+    if (!rv)
     {
-        // Default to current values where not provided.
-        new_item->copyViewerItem(curr_item);
+        new_item = new LLViewerInventoryItem;
+        if (curr_item)
+        {
+            // Default to current values where not provided.
+            new_item->copyViewerItem(curr_item);
+        }
+        rv = new_item->unpackMessage(item_map);
     }
-    bool rv = new_item->unpackMessage(item_map);
+    // </FS>
     if (rv)
     {
         if (mFetch)
@@ -1261,14 +1487,29 @@ void AISUpdate::parseItem(const LLSD& item_map)
 void AISUpdate::parseLink(const LLSD& link_map, S32 depth)
 {
     LLUUID item_id = link_map["item_id"].asUUID();
-    LLPointer<LLViewerInventoryItem> new_link(new LLViewerInventoryItem);
+    // <FS> Background AIS parsing
+    //LLPointer<LLViewerInventoryItem> new_link(new LLViewerInventoryItem);
+    //LLViewerInventoryItem *curr_link = gInventory.getItem(item_id);
+    //if (curr_link)
+    //{
+    //    // Default to current values where not provided.
+    //    new_link->copyViewerItem(curr_link);
+    //}
+    //bool rv = new_link->unpackMessage(link_map);
     LLViewerInventoryItem *curr_link = gInventory.getItem(item_id);
-    if (curr_link)
+    LLPointer<LLViewerInventoryItem> new_link(curr_link ? LLPointer<LLViewerInventoryItem>() : takeStagedItem(item_id));
+    bool rv = new_link.notNull();
+    if (!rv)
     {
-        // Default to current values where not provided.
-        new_link->copyViewerItem(curr_link);
+        new_link = new LLViewerInventoryItem;
+        if (curr_link)
+        {
+            // Default to current values where not provided.
+            new_link->copyViewerItem(curr_link);
+        }
+        rv = new_link->unpackMessage(link_map);
     }
-    bool rv = new_link->unpackMessage(link_map);
+    // </FS>
     if (rv)
     {
         const LLUUID& parent_id = new_link->getParentUUID();
@@ -1357,7 +1598,15 @@ void AISUpdate::parseCategory(const LLSD& category_map, S32 depth)
     }
 
     LLPointer<LLViewerInventoryCategory> new_cat;
-    if (curr_cat)
+    // <FS> Background AIS parsing
+    //if (curr_cat)
+    bool rv = false;
+    if (!curr_cat && (new_cat = takeStagedCategory(category_id)).notNull())
+    {
+        rv = true;
+    }
+    else if (curr_cat)
+    // </FS>
     {
         // Default to current values where not provided.
         new_cat = new LLViewerInventoryCategory(curr_cat);
@@ -1374,7 +1623,13 @@ void AISUpdate::parseCategory(const LLSD& category_map, S32 depth)
             new_cat = new LLViewerInventoryCategory(LLUUID::null);
         }
     }
-    bool rv = new_cat->unpackMessage(category_map);
+    // <FS> Background AIS parsing
+    //bool rv = new_cat->unpackMessage(category_map);
+    if (!rv)
+    {
+        rv = new_cat->unpackMessage(category_map);
+    }
+    // </FS>
     // *NOTE: unpackMessage does not unpack version or descendent count.
     if (rv)
     {
@@ -31,6 +31,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <unordered_map> // <FS/> Background AIS parsing
 #include "llviewerinventory.h"
 #include "llcorehttputil.h"
 #include "llcoproceduremanager.h"
@@ -56,8 +57,14 @@ public:
     static void PurgeDescendents(const LLUUID &categoryId, completion_t callback = completion_t());
     static void UpdateCategory(const LLUUID &categoryId, const LLSD &updates, completion_t callback = completion_t());
     static void UpdateItem(const LLUUID &itemId, const LLSD &updates, completion_t callback = completion_t());
-    static void FetchItem(const LLUUID &itemId, ITEM_TYPE type, completion_t callback = completion_t());
-    static void FetchCategoryChildren(const LLUUID &catId, ITEM_TYPE type = AISAPI::ITEM_TYPE::INVENTORY, bool recursive = false, completion_t callback = completion_t(), S32 depth = 0);
+    // <FS> Adaptive AIS fetch, explicitly requested objects go before the background crawl
+    //static void FetchItem(const LLUUID &itemId, ITEM_TYPE type, completion_t callback = completion_t());
+    //static void FetchCategoryChildren(const LLUUID &catId, ITEM_TYPE type = AISAPI::ITEM_TYPE::INVENTORY, bool recursive = false, completion_t callback = completion_t(), S32 depth = 0);
+    static void FetchItem(const LLUUID &itemId, ITEM_TYPE type, completion_t callback = completion_t(),
+                          LLCoprocedureManager::EPriority priority = LLCoprocedureManager::PRIORITY_LOW);
+    static void FetchCategoryChildren(const LLUUID &catId, ITEM_TYPE type = AISAPI::ITEM_TYPE::INVENTORY, bool recursive = false, completion_t callback = completion_t(), S32 depth = 0,
+                                      LLCoprocedureManager::EPriority priority = LLCoprocedureManager::PRIORITY_LOW);
+    // </FS>
     static void FetchCategoryChildren(const std::string &identifier, bool recursive = false, completion_t callback = completion_t(), S32 depth = 0);
     static void FetchCategoryCategories(const LLUUID &catId, ITEM_TYPE type = AISAPI::ITEM_TYPE::INVENTORY, bool recursive = false, completion_t callback = completion_t(), S32 depth = 0);
     static void FetchCategorySubset(const LLUUID& catId, const uuid_vec_t specificChildren, ITEM_TYPE type = AISAPI::ITEM_TYPE::INVENTORY, bool recursive = false, completion_t callback = completion_t(), S32 depth = 0);
@@ -92,7 +99,11 @@ private:
     typedef boost::function < LLSD (LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t, LLCore::HttpRequest::ptr_t,
         const std::string, LLSD, LLCore::HttpOptions::ptr_t, LLCore::HttpHeaders::ptr_t) > invokationFn_t;
 
-    static void EnqueueAISCommand(const std::string &procName, LLCoprocedureManager::CoProcedure_t proc);
+    // <FS> Coprocedure priorities
+    //static void EnqueueAISCommand(const std::string &procName, LLCoprocedureManager::CoProcedure_t proc);
+    static void EnqueueAISCommand(const std::string &procName, LLCoprocedureManager::CoProcedure_t proc,
+        LLCoprocedureManager::EPriority priority = LLCoprocedureManager::PRIORITY_NORMAL);
+    // </FS>
     static void onIdle(void *userdata); // launches postponed AIS commands
     static void onUpdateReceived(const LLSD& update, COMMAND_TYPE type, const LLSD& request_body);
 
@@ -103,7 +114,16 @@ private:
         invokationFn_t invoke, std::string url, LLUUID targetId, LLSD body,
         completion_t callback, COMMAND_TYPE type);
 
-    typedef std::pair<std::string, LLCoprocedureManager::CoProcedure_t> ais_query_item_t;
+    // <FS> Coprocedure priorities
+    //typedef std::pair<std::string, LLCoprocedureManager::CoProcedure_t> ais_query_item_t;
+    struct ais_query_item_t
+    {
+        std::string mName;
+        LLCoprocedureManager::CoProcedure_t mProc;
+        LLCoprocedureManager::EPriority mPriority;
+    };
+    static S32 sPostponedUrgent; // postponed commands above PRIORITY_LOW
+    // </FS>
     static std::list<ais_query_item_t> sPostponedQuery;
 };
 
@@ -130,6 +150,14 @@ private:
     void clearParseResults();
     void checkTimeout();
 
+    // <FS> Background AIS parsing
+    // Unpacks the objects of a large fetch on the General work queue while
+    // the calling coroutine waits; parse* then only pick up the results.
+    void stageContent(const LLSD& update);
+    LLPointer<LLViewerInventoryItem> takeStagedItem(const LLUUID& item_id);
+    LLPointer<LLViewerInventoryCategory> takeStagedCategory(const LLUUID& category_id);
+    // </FS>
+
     // Fetch can return large packets of data, throttle it to not cause lags
     // Todo: make throttle work over all fetch requests isntead of per-request
     const F32 AIS_EXPIRY_SECONDS = 0.008f;
@@ -156,6 +184,13 @@ private:
     S32 mFetchDepth;
     LLTimer mTimer;
     AISAPI::COMMAND_TYPE mType;
+
+    // <FS> Background AIS parsing
+    typedef std::unordered_map<LLUUID, LLPointer<LLViewerInventoryItem> > staged_item_map_t;
+    typedef std::unordered_map<LLUUID, LLPointer<LLViewerInventoryCategory> > staged_category_map_t;
+    staged_item_map_t mStagedItems;
+    staged_category_map_t mStagedCategories;
+    // </FS>
 };
 
 #endif
@@ -129,11 +129,33 @@ static const struct
 static void setting_changed();
 static void ssl_verification_changed();
 
+// <FS> Adaptive concurrency
+static bool is_fetch_class(LLAppCoreHttp::EAppPolicy policy)
+{
+    switch (policy)
+    {
+    case LLAppCoreHttp::AP_ASSET:
+    case LLAppCoreHttp::AP_TEXTURE:
+    case LLAppCoreHttp::AP_MESH1:
+    case LLAppCoreHttp::AP_MESH2:
+        return true;
+
+    default:
+        return false;
+    }
+}
+// </FS>
+
 
 LLAppCoreHttp::HttpClass::HttpClass()
     : mPolicy(LLCore::HttpRequest::DEFAULT_POLICY_ID),
       mConnLimit(0U),
-      mPipelined(false)
+      mPipelined(false),
+      // <FS> Adaptive concurrency
+      //mMultiplexed(false)
+      mMultiplexed(false),
+      mAdaptive(false)
+      // </FS>
 {}
 
 
@@ -142,7 +164,12 @@ LLAppCoreHttp::LLAppCoreHttp()
       mStopHandle(LLCORE_HTTP_HANDLE_INVALID),
       mStopRequested(0.0),
       mStopped(false),
-      mPipelined(true)
+      mPipelined(true),
+      // <FS> Adaptive concurrency
+      //mMultiplexed(false)
+      mMultiplexed(false),
+      mAdaptive(false)
+      // </FS>
 {}
 
 
@@ -158,6 +185,7 @@ void LLAppCoreHttp::init()
     LLCoreHttpUtil::setPropertyMethods(
         boost::bind(&LLControlGroup::getBOOL, boost::ref(gSavedSettings), _1),
         boost::bind(&LLControlGroup::declareBOOL, boost::ref(gSavedSettings), _1, _2, _3, LLControlVariable::PERSIST_NONDFT));
+    LLCoreHttpUtil::setLLSDArenaThreshold(gSavedSettings.getU32("FSLLSDArenaThreshold")); // <FS/> LLSD arena
 
     LLCore::LLHttp::initialize();
 
@@ -292,6 +320,26 @@ void LLAppCoreHttp::init()
         LL_INFOS("Init") << "HTTP Pipelining " << (mPipelined ? "enabled" : "disabled") << "!" << LL_ENDL;
     }
 
+    // Global HTTP/2 multiplexing setting, applies to the pipelined classes.
+    // Read once, changes need a restart.
+    static const std::string http_multiplexing("FSHttpMultiplexing");
+    if (gSavedSettings.controlExists(http_multiplexing))
+    {
+        mMultiplexed = gSavedSettings.getBOOL(http_multiplexing);
+        LL_INFOS("Init") << "HTTP/2 multiplexing " << (mMultiplexed ? "enabled" : "disabled") << "!" << LL_ENDL;
+    }
+
+    // <FS> Adaptive concurrency
+    // Global adaptive concurrency setting, applies to the fetch classes.
+    // Read once, changes need a restart.
+    static const std::string http_adaptive("FSHttpAdaptiveConcurrency");
+    if (gSavedSettings.controlExists(http_adaptive))
+    {
+        mAdaptive = gSavedSettings.getBOOL(http_adaptive);
+        LL_INFOS("Init") << "HTTP adaptive concurrency " << (mAdaptive ? "enabled" : "disabled") << "!" << LL_ENDL;
+    }
+    // </FS>
+
     // Register signals for settings and state changes
     for (int i(0); i < LL_ARRAY_SIZE(init_data); ++i)
     {
@@ -460,6 +508,49 @@ void LLAppCoreHttp::refreshSettings(bool initial)
                     mHttpClasses[app_policy].mPipelined = to_pipeline;
                 }
             }
+
+            const bool to_multiplex(mMultiplexed && init_data[i].mPipelined);
+            if (to_multiplex != mHttpClasses[app_policy].mMultiplexed)
+            {
+                LLCore::HttpHandle handle;
+                handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_MULTIPLEXING,
+                                                   mHttpClasses[app_policy].mPolicy,
+                                                   to_multiplex ? 1L : 0L,
+                                                   LLCore::HttpHandler::ptr_t());
+                if (LLCORE_HTTP_HANDLE_INVALID == handle)
+                {
+                    status = mRequest->getStatus();
+                    LL_WARNS("Init") << "Unable to set " << init_data[i].mUsage
+                                     << " multiplexing.  Reason:  " << status.toString()
+                                     << LL_ENDL;
+                }
+                else
+                {
+                    mHttpClasses[app_policy].mMultiplexed = to_multiplex;
+                }
+            }
+
+            // <FS> Adaptive concurrency
+            // The classes fetching from the CDNs move between one request
+            // and the most their concurrency setting allows
+            if (mAdaptive && is_fetch_class(app_policy))
+            {
+                const long ceiling(init_data[i].mMax * (mHttpClasses[app_policy].mPipelined ? PIPELINING_DEPTH : 1L));
+
+                LLCore::HttpHandle handle;
+                handle = mRequest->setPolicyOption(LLCore::HttpRequest::PO_ADAPTIVE_CONCURRENCY,
+                                                   mHttpClasses[app_policy].mPolicy,
+                                                   ceiling,
+                                                   LLCore::HttpHandler::ptr_t());
+                if (LLCORE_HTTP_HANDLE_INVALID == handle)
+                {
+                    status = mRequest->getStatus();
+                    LL_WARNS("Init") << "Unable to set " << init_data[i].mUsage
+                                     << " adaptive concurrency.  Reason:  " << status.toString()
+                                     << LL_ENDL;
+                }
+            }
+            // </FS>
         }
 
         // Get target connection concurrency value
@@ -244,6 +244,12 @@ public:
             return mHttpClasses[policy].mPipelined;
         }
 
+    // Return whether a policy multiplexes requests over HTTP/2.
+    bool isMultiplexed(EAppPolicy policy) const
+        {
+            return mHttpClasses[policy].mMultiplexed;
+        }
+
     // Apply initial or new settings from the environment.
     void refreshSettings(bool initial);
 
@@ -262,6 +268,7 @@ private:
         policy_t                    mPolicy;            // Policy class id for the class
         U32                         mConnLimit;
         bool                        mPipelined;
+        bool                        mMultiplexed;
         boost::signals2::connection mSettingsSignal;    // Signal to global setting that affect this class (if any)
     };
 
@@ -271,6 +278,8 @@ private:
     bool                        mStopped;
     HttpClass                   mHttpClasses[AP_COUNT];
     bool                        mPipelined;             // Global setting
+    bool                        mMultiplexed;           // Global setting, 'FSHttpMultiplexing'
+    bool                        mAdaptive;              // <FS/> Global setting, 'FSHttpAdaptiveConcurrency'
     boost::signals2::connection mPipelinedSignal;       // Signal for 'HttpPipelining' setting
     boost::signals2::connection mSSLNoVerifySignal;     // Signal for 'NoVerifySSLCert' setting
 
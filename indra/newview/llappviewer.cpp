@@ -55,6 +55,7 @@
 #include "llmarketplacenotifications.h"
 #include "llmd5.h"
 #include "llmeshrepository.h"
+#include "llmaterialmgr.h" // <FS/> Persistent material cache
 #include "llpumpio.h"
 #include "llmimetypes.h"
 #include "llslurl.h"
@@ -137,6 +138,11 @@
 #include "llurlaction.h"
 #include "llurlentry.h"
 #include "llvolumemgr.h"
+#include "llvolumesimd.h" // <FS/> Vertex stream kernels
+#include "llpose.h" // <FS/> Vector pose blending
+#include "lltexlayer.h" // <FS/> Async morph mask readback
+#include "llpolymorph.h" // <FS/> Deferred morph normals
+#include "llvolumebvh.h" // <FS/> Flat picking hierarchy
 #include "llxfermanager.h"
 #include "llphysicsextensions.h"
 
@@ -292,6 +298,14 @@ using namespace LL;
 
 #include "fsradar.h"
 #include "fsassetblacklist.h"
+#include "fstexturefetchtrace.h"
+#include "fsidlescheduler.h"
+#include "fsstartuptasks.h" // <FS/> Startup pipeline
+#include "fsframepacer.h" // <FS/> Frame pacing
+#include "fsbenchmark.h" // <FS/> Benchmark mode
+#include "fsscenebundle.h" // <FS/> Scene replay
+#include "llvramaccounting.h" // <FS/> VRAM accounting
+#include "llframepump.h" // <FS/> Frame pump
 #include "bugsplatattributes.h"
 // #include "fstelemetry.h" // <FS:Beq> Tracy profiler support
 
@@ -605,6 +619,21 @@ static void settings_to_globals()
     LLRender::sNsightDebugSupport = gSavedSettings.getBOOL("RenderNsightDebugSupport");
     LLImageGL::sGlobalUseAnisotropic    = gSavedSettings.getBOOL("RenderAnisotropic");
     LLImageGL::sCompressTextures        = gSavedSettings.getBOOL("RenderCompressTextures");
+    LLVertexBuffer::sUsePackedAttributes = gSavedSettings.getBOOL("FSRenderPackedVertexAttributes"); // <FS/> Packed vertex attributes
+    LLVertexBuffer::sUseStreamingRing = gSavedSettings.getBOOL("FSRenderStreamingRing"); // <FS/> Streaming ring buffer
+    LLImageGL::sUseUploadRing = gSavedSettings.getBOOL("FSMediaUploadRing"); // <FS/> Media upload ring
+    LLVertexBuffer::sUseGeometryHeap = gSavedSettings.getBOOL("FSGeometryHeap"); // <FS/> Geometry heap
+    LLVertexBuffer::sUseSubmitThread = gSavedSettings.getBOOL("FSRenderSubmitThread"); // <FS/> Render submit thread
+    LLRender::sBatchPrimitives = gSavedSettings.getBOOL("FSBatchImmediateMode"); // <FS/> Batched immediate mode
+    FSGPUTerrain::sEnabled = gSavedSettings.getBOOL("FSGPUTerrain"); // <FS/> GPU terrain
+    LLVolumeSIMD::setUseAVX2(gSavedSettings.getBOOL("FSVolumeAVX2Kernels")); // <FS/> Vertex stream kernels
+    LLPoseBlender::sVectorBlend = gSavedSettings.getBOOL("FSVectorPoseBlending"); // <FS/> Vector pose blending
+    LLTexLayer::sAsyncMorphReadback = gSavedSettings.getBOOL("FSAsyncMorphMaskReadback"); // <FS/> Async morph mask readback
+    LLPolyMorphTarget::sDeferNormals = gSavedSettings.getBOOL("FSDeferredMorphNormals"); // <FS/> Deferred morph normals
+    LLVolumeMgr::sShareTessellation = gSavedSettings.getBOOL("FSVolumeShareTessellation"); // <FS/> Shared prim tessellation
+    LLViewerOctreeCull::sUseBatchCulling = gSavedSettings.getBOOL("FSBatchFrustumCulling"); // <FS/> Batched culling
+    LLRenderPass::sUseMultiDraw = gSavedSettings.getBOOL("FSMultiDrawBatching"); // <FS/> Multi-draw batching
+    LLSlabPool::sEnabled = gSavedSettings.getBOOL("FSSlabPools"); // <FS/> Slab pools, before the first object is created
     LLVOVolume::sLODFactor              = llclamp(gSavedSettings.getF32("RenderVolumeLODFactor"), 0.01f, MAX_LOD_FACTOR);
     LLVOVolume::sDistanceFactor         = 1.f-LLVOVolume::sLODFactor * 0.1f;
     LLVolumeImplFlexible::sUpdateFactor = gSavedSettings.getF32("RenderFlexTimeFactor");
@@ -1134,6 +1163,13 @@ bool LLAppViewer::init()
     }
     LL_INFOS("InitInfo") << "Cache initialization is done." << LL_ENDL ;
 
+    // <FS> Texture fetch replay
+    if (std::string replay_file = gSavedSettings.getString("FSTextureFetchReplayFile"); !replay_file.empty())
+    {
+        FSTextureFetchReplay::getInstance()->start(replay_file, gSavedSettings.getString("FSTextureFetchReplayURL"));
+    }
+    // </FS>
+
     // Initialize event recorder
     LLViewerEventRecorder::createInstance();
 
@@ -1647,6 +1683,7 @@ bool LLAppViewer::doFrame()
                 }
 
                 gViewerWindow->getWindow()->gatherInput();
+                FSFramePacer::instance().markInput(); // <FS/> Frame pacing
             }
 
             //memory leaking simulation
@@ -1662,6 +1699,11 @@ bool LLAppViewer::doFrame()
 
             {
                 LL_PROFILE_ZONE_NAMED_CATEGORY_APP("df mainloop");
+                // <FS> Frame pump: per-frame listeners that don't need LLSD
+                LLFrameTick tick;
+                tick.mFrame = gFrameCount;
+                LLFrameTickPump::instance().post(tick);
+                // </FS>
                 // canonical per-frame event
                 mainloop.post(newFrame);
             }
@@ -1813,6 +1855,7 @@ bool LLAppViewer::doFrame()
                 {
                     LLPerfStats::RecordSceneTime T ( LLPerfStats::StatType_t::RENDER_SLEEP );
                     ms_sleep(milliseconds_to_sleep);
+                    FSIdleScheduler::recordSleep((F32)milliseconds_to_sleep * 0.001f); // <FS/> Idle scheduler
                     // also pause worker threads during this wait period
                     LLAppViewer::getTextureCache()->pause();
                 }
@@ -1877,7 +1920,22 @@ bool LLAppViewer::doFrame()
             // <FS:Ansariel> FIRE-22297: FPS limiter not working properly on Mac/Linux
             static LLCachedControl<U32> max_fps(gSavedSettings, "FramePerSecondLimit");
             static LLCachedControl<bool> fsLimitFramerate(gSavedSettings, "FSLimitFramerate");
-            if (fsLimitFramerate && LLStartUp::getStartupState() == STATE_STARTED && !gTeleportDisplay && !logoutRequestSent() && max_fps > F_APPROXIMATELY_ZERO)
+            // <FS> Frame pacing
+            //if (fsLimitFramerate && LLStartUp::getStartupState() == STATE_STARTED && !gTeleportDisplay && !logoutRequestSent() && max_fps > F_APPROXIMATELY_ZERO)
+            const bool limit_framerate = fsLimitFramerate && LLStartUp::getStartupState() == STATE_STARTED && !gTeleportDisplay && !logoutRequestSent() && max_fps > F_APPROXIMATELY_ZERO;
+            static LLCachedControl<bool> fsFramePacing(gSavedSettings, "FSFramePacing");
+            if (fsFramePacing && !gHeadlessClient && !LLApp::isExiting())
+            {
+                // Sleeps until the next frame should start, on an even cadence
+                LLPerfStats::RecordSceneTime T ( LLPerfStats::StatType_t::RENDER_FPSLIMIT );
+                F32 slept = FSFramePacer::instance().wait(limit_framerate ? 1.f / (F32)max_fps : 0.f);
+                if (slept > 0.f)
+                {
+                    FSIdleScheduler::recordSleep(slept);
+                }
+            }
+            else if (limit_framerate)
+            // </FS>
             {
                 // Sleep a while to limit frame rate.
                 LLPerfStats::RecordSceneTime T ( LLPerfStats::StatType_t::RENDER_FPSLIMIT );
@@ -1887,6 +1945,7 @@ bool LLAppViewer::doFrame()
                 {
                     LL_PROFILE_ZONE_NAMED_CATEGORY_APP("sleep2");
                     ms_sleep(milliseconds_to_sleep);
+                    FSIdleScheduler::recordSleep((F32)milliseconds_to_sleep * 0.001f); // <FS/> Idle scheduler
                 }
             }
             frameTimer.reset();
@@ -1920,6 +1979,11 @@ bool LLAppViewer::doFrame()
         LL_INFOS() << "Exiting main_loop" << LL_ENDL;
     }
     }LLPerfStats::StatsRecorder::endFrame();
+    // <FS> Memory accounting
+    LLFrameArena::reset();
+    LLMemAccounting::plot();
+    LLVRAMAccounting::plot();
+    // </FS>
     LL_PROFILER_FRAME_END;
 
     return ! LLApp::isRunning();
@@ -2124,6 +2188,15 @@ bool LLAppViewer::cleanup()
 
     LL_INFOS() << "Global stuff deleted" << LL_ENDL;
 
+    // <FS> Startup pipeline
+    // Quitting from the login screen may leave the audio engine starting up;
+    // let it finish so it is shut down below
+    if (FSStartupTasks::instanceExists())
+    {
+        FSStartupTasks::instance().waitAll();
+    }
+    // </FS>
+
     if (gAudiop)
     {
         LL_INFOS() << "Shutting down audio" << LL_ENDL;
@@ -2429,6 +2502,7 @@ bool LLAppViewer::cleanup()
     //MUST happen AFTER SUBSYSTEM_CLEANUP(LLCurl)
     delete sTextureCache;
     sTextureCache = NULL;
+    FSTextureFetchTrace::stop(); // <FS/> Texture fetch trace
     if (sTextureFetch)
     {
         sTextureFetch->shutdown();
@@ -2543,6 +2617,7 @@ void LLAppViewer::initGeneralThread()
     }
 
     mGeneralThreadPool = new LL::ThreadPool("General", 3);
+    mGeneralThreadPool->setWorkStealing(true); // <FS/> Work stealing, for postWork() and parallelFor()
     mGeneralThreadPool->start();
 }
 
@@ -2592,6 +2667,13 @@ bool LLAppViewer::initThreads()
                                                     enable_threads && true,
                                                     app_metrics_qa_mode);
 
+    // <FS> Texture fetch trace
+    if (std::string trace_file = gSavedSettings.getString("FSTextureFetchTraceFile"); !trace_file.empty())
+    {
+        FSTextureFetchTrace::start(trace_file);
+    }
+    // </FS>
+
     // general task background thread (LLPerfStats, etc)
     LLAppViewer::instance()->initGeneralThread();
 
@@ -2967,6 +3049,11 @@ bool LLAppViewer::initConfiguration()
 
     // - load defaults
     bool set_defaults = true;
+    // <FS> Settings snapshot
+    // Parsed default settings are cached as binary LLSD, parsing the XML of
+    // settings.xml is a noticeable part of the startup time
+    LLControlGroup::setSnapshotDir(gDirUtilp->getExpandedFilename(LL_PATH_USER_SETTINGS, ""));
+    // </FS>
     if (!loadSettingsFromDirectory("Default", set_defaults))
     {
         OSMessageBox(
@@ -3334,6 +3421,9 @@ bool LLAppViewer::initConfiguration()
     // other browsers) and do the rough equivalent of command
     // injection and steal passwords. Phoenix. SL-55321
 
+    FSSceneBundle::instance().prepareReplay(); // <FS/> Scene replay, sets up the benchmark
+    FSBenchmark::instance().init(); // <FS/> Benchmark mode, may set the login location
+
     std::string starting_location;
 
     std::string cmd_line_login_location(gSavedSettings.getString("CmdLineLoginLocation"));
@@ -5071,6 +5161,8 @@ bool LLAppViewer::initCache()
     // LLDiskCache::initParamSingleton(cache_dir, disk_cache_size, enable_cache_debug_info);
     LLDiskCache::initParamSingleton(cache_dir, disk_cache_size, enable_cache_debug_info, gSavedSettings.getF32("FSDiskCacheHighWaterPercent"), gSavedSettings.getF32("FSDiskCacheLowWaterPercent"));
     // </FS:Beq>
+    LLDiskCache::getInstance()->setPackThreshold(gSavedSettings.getU32("FSDiskCachePackThreshold"));
+    LLDiskCache::getInstance()->setCompressAssets(gSavedSettings.getBOOL("FSDiskCacheCompressAssets"));
 
     if (!read_only)
     {
@@ -5141,6 +5233,13 @@ bool LLAppViewer::initCache()
     const U32 CACHE_NUMBER_OF_REGIONS_FOR_OBJECTS = 128;
     LLVOCache::getInstance()->initCache(LL_PATH_CACHE, CACHE_NUMBER_OF_REGIONS_FOR_OBJECTS, getObjectCacheVersion());
 
+    // <FS> Scene replay
+    if (FSSceneBundle::isReplaying() && !read_only)
+    {
+        FSSceneBundle::instance().installReplay();
+    }
+    // </FS>
+
     return true;
 }
 
@@ -5163,6 +5262,7 @@ void LLAppViewer::loadKeyBindings()
         }
     }
     LLUrlRegistry::instance().setKeybindingHandler(&gViewerInput);
+    LLUrlRegistry::instance().setCombinedMatching(gSavedSettings.getBOOL("FSCombinedUrlMatching")); // <FS/> Combined URL matching
 }
 
 void LLAppViewer::purgeCache()
@@ -5348,8 +5448,34 @@ void LLAppViewer::loadNameCache()
     // display names cache
     std::string filename =
         gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
+    // <FS> Binary name cache
+    // The XML file is only read when there is no binary one, it is then
+    // converted on the next save
+    std::string binary_filename =
+        gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.bin");
+    LL_INFOS("AvNameCache") << binary_filename << LL_ENDL;
+    bool loaded_binary = false;
+    llifstream binary_stream(binary_filename.c_str(), std::ios::in | std::ios::binary);
+    if (binary_stream.is_open())
+    {
+        loaded_binary = LLAvatarNameCache::getInstance()->importBinaryFile(binary_stream);
+        if (!loaded_binary)
+        {
+            LL_WARNS("AppInit") << "removing invalid '" << binary_filename << "'" << LL_ENDL;
+            binary_stream.close();
+            LLFile::remove(binary_filename);
+        }
+    }
+    // </FS>
     LL_INFOS("AvNameCache") << filename << LL_ENDL;
-    llifstream name_cache_stream(filename.c_str());
+    // <FS> Binary name cache
+    //llifstream name_cache_stream(filename.c_str());
+    llifstream name_cache_stream;
+    if (!loaded_binary)
+    {
+        name_cache_stream.open(filename.c_str());
+    }
+    // </FS>
     if(name_cache_stream.is_open())
     {
         if ( ! LLAvatarNameCache::getInstance()->importFile(name_cache_stream))
@@ -5376,11 +5502,22 @@ void LLAppViewer::saveNameCache()
     // display names cache
     std::string filename =
         gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
-    llofstream name_cache_stream(filename.c_str());
+    // <FS> Binary name cache
+    //llofstream name_cache_stream(filename.c_str());
+    //if(name_cache_stream.is_open())
+    //{
+    //    LLAvatarNameCache::getInstance()->exportFile(name_cache_stream);
+    //}
+    std::string binary_filename =
+        gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.bin");
+    llofstream name_cache_stream(binary_filename.c_str(), std::ios::out | std::ios::binary);
     if(name_cache_stream.is_open())
     {
-        LLAvatarNameCache::getInstance()->exportFile(name_cache_stream);
+        LLAvatarNameCache::getInstance()->exportBinaryFile(name_cache_stream);
+        // Converted, don't leave the stale XML file around
+        LLFile::remove(filename, ENOENT);
     }
+    // </FS>
 
     // real names cache
     if (gCacheName)
@@ -5455,6 +5592,13 @@ void LLAppViewer::idle()
     LLDirPickerThread::clearDead();
     F32 dt_raw = idle_timer.getElapsedTimeAndResetF32();
 
+    // <FS> Benchmark mode
+    if (FSBenchmark::isEnabled())
+    {
+        FSBenchmark::instance().update();
+    }
+    // </FS>
+
     LLGLTFMaterialList::flushUpdates();
 
     static LLCachedControl<U32> downscale_method(gSavedSettings, "RenderDownScaleMethod");
@@ -5589,25 +5733,26 @@ void LLAppViewer::idle()
             viewer_stats_timer.reset();
         }
 
-        // Print the object debugging stats
-        // ...well, reset the stats, anyway. What good are the spammy
-        //  messages if we can't do anything about them? Bah. -- TS
-        static LLFrameTimer object_debug_timer;
-        if (object_debug_timer.getElapsedTimeF32() > 5.f)
-        {
-            object_debug_timer.reset();
-            if (gObjectList.mNumDeadObjectUpdates)
-            {
-                //LL_INFOS() << "Dead object updates: " << gObjectList.mNumDeadObjectUpdates << LL_ENDL;
-                gObjectList.mNumDeadObjectUpdates = 0;
-            }
-            if (gObjectList.mNumUnknownUpdates)
-            {
-                //LL_INFOS() << "Unknown object updates: " << gObjectList.mNumUnknownUpdates << LL_ENDL;
-                gObjectList.mNumUnknownUpdates = 0;
-            }
-
-        }
+        // <FS> Idle scheduler, runs as the "Object stats" task
+        //// Print the object debugging stats
+        //// ...well, reset the stats, anyway. What good are the spammy
+        ////  messages if we can't do anything about them? Bah. -- TS
+        //static LLFrameTimer object_debug_timer;
+        //if (object_debug_timer.getElapsedTimeF32() > 5.f)
+        //{
+        //    object_debug_timer.reset();
+        //    if (gObjectList.mNumDeadObjectUpdates)
+        //    {
+        //        //LL_INFOS() << "Dead object updates: " << gObjectList.mNumDeadObjectUpdates << LL_ENDL;
+        //        gObjectList.mNumDeadObjectUpdates = 0;
+        //    }
+        //    if (gObjectList.mNumUnknownUpdates)
+        //    {
+        //        //LL_INFOS() << "Unknown object updates: " << gObjectList.mNumUnknownUpdates << LL_ENDL;
+        //        gObjectList.mNumUnknownUpdates = 0;
+        //    }
+        //}
+        // </FS>
     }
 
     if (!gDisconnected)
@@ -5648,24 +5793,35 @@ void LLAppViewer::idle()
         // Do event notifications if necessary.  Yes, we may want to move this elsewhere.
         gEventNotifier.update();
 
-        gIdleCallbacks.callFunctions();
-        gInventory.idleNotifyObservers();
-        LLAvatarTracker::instance().idleNotifyObservers();
-    }
-
-    // Metrics logging (LLViewerAssetStats, etc.)
-    {
-        static LLTimer report_interval;
-
-        // *TODO:  Add configuration controls for this
-        F32 seconds = report_interval.getElapsedTimeF32();
-        if (seconds >= app_metrics_interval)
+        // <FS> Idle scheduler
+        //gIdleCallbacks.callFunctions();
+        //gInventory.idleNotifyObservers();
+        //LLAvatarTracker::instance().idleNotifyObservers();
+        static bool idle_tasks_registered = false;
+        if (!idle_tasks_registered)
         {
-            metricsSend(! gDisconnected);
-            report_interval.reset();
+            registerIdleTasks();
+            idle_tasks_registered = true;
         }
+        FSIdleScheduler::instance().run();
+        // </FS>
     }
 
+    // <FS> Idle scheduler, runs as the "Metrics" task
+    //// Metrics logging (LLViewerAssetStats, etc.)
+    //{
+    //    static LLTimer report_interval;
+
+    //    // *TODO:  Add configuration controls for this
+    //    F32 seconds = report_interval.getElapsedTimeF32();
+    //    if (seconds >= app_metrics_interval)
+    //    {
+    //        metricsSend(! gDisconnected);
+    //        report_interval.reset();
+    //    }
+    //}
+    // </FS>
+
     // <FS:SimonLsAlt> Handle deferred notice deletions
     if (auto* notificationsTabbed = LLFloaterReg::findTypedInstance<LLFloaterNotificationsTabbed>("notification_well_window"))
     {
@@ -5846,9 +6002,11 @@ void LLAppViewer::idle()
     // update media focus
     LLViewerMediaFocus::getInstance()->update();
 
-    // Update marketplace
-    LLMarketplaceInventoryImporter::update();
-    LLMarketplaceInventoryNotifications::update();
+    // <FS> Idle scheduler, runs as the "Marketplace" task
+    //// Update marketplace
+    //LLMarketplaceInventoryImporter::update();
+    //LLMarketplaceInventoryNotifications::update();
+    // </FS>
 
     // objects and camera should be in sync, do LOD calculations now
     {
@@ -5856,8 +6014,10 @@ void LLAppViewer::idle()
         gObjectList.updateApparentAngles(gAgent);
     }
 
-    // Update AV render info
-    LLAvatarRenderInfoAccountant::getInstance()->idle();
+    // <FS> Idle scheduler, runs as the "Avatar render info" task
+    //// Update AV render info
+    //LLAvatarRenderInfoAccountant::getInstance()->idle();
+    // </FS>
 
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_APP("audio update"); //LL_RECORD_BLOCK_TIME(FTM_AUDIO_UPDATE);
@@ -5883,6 +6043,85 @@ void LLAppViewer::idle()
     }
 }
 
+// <FS> Idle scheduler
+// The periodic work of idle() that doesn't have to happen at a fixed point of
+// the frame
+void LLAppViewer::registerIdleTasks()
+{
+    FSIdleScheduler& scheduler = FSIdleScheduler::instance();
+
+    // Callers depend on being called every frame and in order
+    scheduler.addTask("Idle callbacks", FSIdleScheduler::PRIORITY_CRITICAL, 0.f, 0.f, [](F32)
+    {
+        gIdleCallbacks.callFunctions();
+        return false;
+    });
+
+    scheduler.addTask("Inventory observers", FSIdleScheduler::PRIORITY_HIGH, 0.f, 0.f, [](F32)
+    {
+        gInventory.idleNotifyObservers();
+        return false;
+    });
+
+    scheduler.addTask("Avatar tracker observers", FSIdleScheduler::PRIORITY_HIGH, 0.f, 0.f, [](F32)
+    {
+        LLAvatarTracker::instance().idleNotifyObservers();
+        return false;
+    });
+
+    // Metrics logging (LLViewerAssetStats, etc.)
+    scheduler.addTask("Metrics", FSIdleScheduler::PRIORITY_LOW, 1.f, 0.f, [](F32)
+    {
+        static LLTimer report_interval;
+
+        // *TODO:  Add configuration controls for this
+        F32 seconds = report_interval.getElapsedTimeF32();
+        if (seconds >= app_metrics_interval)
+        {
+            metricsSend(! gDisconnected);
+            report_interval.reset();
+        }
+        return false;
+    });
+
+    scheduler.addTask("Object stats", FSIdleScheduler::PRIORITY_LOW, 0.2f, 0.f, [](F32)
+    {
+        // Print the object debugging stats
+        // ...well, reset the stats, anyway. What good are the spammy
+        //  messages if we can't do anything about them? Bah. -- TS
+        gObjectList.mNumDeadObjectUpdates = 0;
+        gObjectList.mNumUnknownUpdates = 0;
+
+        // Free the picking hierarchies of faces nobody hovered in a while,
+        // sooner when the system is short on memory
+        static LLCachedControl<F32> picking_max_idle(gSavedSettings, "FSPickingHierarchyMaxIdle");
+        LLVolumeBVH::purgeUnused(LLViewerTexture::isSystemMemoryLow() ? 5.f : (F32)picking_max_idle);
+        return false;
+    });
+
+    // These used to run after the world updates, which idle() skips while
+    // disconnected or teleporting
+    scheduler.addTask("Marketplace", FSIdleScheduler::PRIORITY_LOW, 0.f, 0.f, [](F32)
+    {
+        if (!gDisconnected && !gTeleportDisplay)
+        {
+            LLMarketplaceInventoryImporter::update();
+            LLMarketplaceInventoryNotifications::update();
+        }
+        return false;
+    });
+
+    scheduler.addTask("Avatar render info", FSIdleScheduler::PRIORITY_LOW, 0.f, 0.f, [](F32)
+    {
+        if (!gDisconnected && !gTeleportDisplay)
+        {
+            LLAvatarRenderInfoAccountant::getInstance()->idle();
+        }
+        return false;
+    });
+}
+// </FS>
+
 void LLAppViewer::idleShutdown()
 {
     // Wait for all modal alerts to get resolved
@@ -6297,6 +6536,12 @@ void LLAppViewer::disconnectViewer()
 
     LLAvatarNameCache::instance().setCustomNameCheckCallback(LLAvatarNameCache::custom_name_check_callback_t()); // <FS:Ansariel> Contact sets
     saveNameCache();
+    // <FS> Persistent material cache
+    if (LLMaterialMgr::instanceExists() && !mSecondInstance)
+    {
+        LLMaterialMgr::instance().saveCache();
+    }
+    // </FS>
     if (LLExperienceCache::instanceExists())
     {
         // TODO: LLExperienceCache::cleanup() logic should be moved to
@@ -292,6 +292,7 @@ private:
     // update avatar SLID and display name caches
     void idleNameCache();
     void idleNetwork();
+    void registerIdleTasks(); // <FS/> Idle scheduler
 
     void sendLogoutRequest();
     void disconnectViewer();
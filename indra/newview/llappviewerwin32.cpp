@@ -134,6 +134,7 @@ namespace
             sBugSplatSender->getMinidumpPath(aBuffer, _countof(aBuffer));
             std::wstring strPath{ (wchar_t*)aBuffer };
             ::CopyFileW(strPath.c_str(), FS::DumpFile.c_str(), FALSE);
+            LLError::flushLogs(); // <FS/> Async logging
             ::CopyFileW(FS::LogfileIn.c_str(), FS::LogfileOut.c_str(), FALSE);
             // </FS:ND>
 
@@ -41,6 +41,14 @@ const F32 LLControlAvatar::MAX_LEGAL_SIZE = 64.0f;
 //static
 boost::signals2::connection LLControlAvatar::sRegionChangedSlot;
 
+// <FS> Shared animesh poses
+//static
+LLControlAvatar::shared_pose_map_t LLControlAvatar::sSharedPoses;
+
+// Motions started by the same broadcast land in the same frame
+static const F32 SHARED_POSE_TIME_TOLERANCE = 0.05f;
+// </FS>
+
 LLControlAvatar::LLControlAvatar(const LLUUID& id, const LLPCode pcode, LLViewerRegion* regionp) :
     LLVOAvatar(id, pcode, regionp),
     mPlaying(false),
@@ -405,6 +413,112 @@ bool LLControlAvatar::updateCharacter(LLAgent &agent)
     return LLVOAvatar::updateCharacter(agent);
 }
 
+// <FS> Shared animesh poses
+// Animesh crowds often play the same animations in lockstep. The first of
+// them updated in a frame offers its pose, the ones after it with the same
+// skeleton playing the same motions at the same time copy that pose
+// instead of running their own motions.
+//virtual
+bool LLControlAvatar::findSharedPose()
+{
+    static LLCachedControl<bool> share_poses(gSavedSettings, "FSShareAnimeshPoses", true);
+    if (!share_poses || !canSharePose())
+    {
+        return false;
+    }
+
+    auto range = sSharedPoses.equal_range(getSharedPoseKey());
+    if (range.first == range.second)
+    {
+        return false;
+    }
+
+    shared_pose_motions_t motions;
+    getSharedPoseMotions(motions);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        const SharedPose& pose = it->second;
+        if (pose.mSource->isDead() || pose.mMotions.size() != motions.size() || !hasSameSkeleton(pose.mSource))
+        {
+            continue;
+        }
+
+        bool same = true;
+        for (size_t i = 0; same && i < motions.size(); ++i)
+        {
+            same = motions[i].mID == pose.mMotions[i].mID
+                && motions[i].mStopped == pose.mMotions[i].mStopped
+                && fabsf(motions[i].mTime - pose.mMotions[i].mTime) <= SHARED_POSE_TIME_TOLERANCE;
+        }
+        if (same)
+        {
+            // Keep our own clock, should the motions drift apart later
+            mMotionController.advanceTime();
+            mSharedPoseSource = pose.mSource;
+            return true;
+        }
+    }
+    return false;
+}
+
+//virtual
+void LLControlAvatar::shareEvaluatedPose()
+{
+    static LLCachedControl<bool> share_poses(gSavedSettings, "FSShareAnimeshPoses", true);
+    if (!share_poses || !canSharePose())
+    {
+        return;
+    }
+
+    SharedPose pose;
+    pose.mSource = this;
+    getSharedPoseMotions(pose.mMotions);
+    sSharedPoses.emplace(getSharedPoseKey(), std::move(pose));
+}
+
+bool LLControlAvatar::canSharePose() const
+{
+    // Attached animesh keeps the update cadence of its avatar
+    return mRootVolp && !mRootVolp->isAttachment() && !mMotionController.isPaused();
+}
+
+bool LLControlAvatar::hasSameSkeleton(const LLControlAvatar* other) const
+{
+    return mSkeleton.size() == other->mSkeleton.size()
+        && mGlobalScale == other->mGlobalScale
+        && mScaleConstraintFixup == other->mScaleConstraintFixup
+        && mMotionController.getTimeFactor() == other->mMotionController.getTimeFactor()
+        && mActiveOverrideMeshes == other->mActiveOverrideMeshes;
+}
+
+size_t LLControlAvatar::getSharedPoseKey() const
+{
+    size_t key = mSkeleton.size();
+    for (const LLUUID& mesh_id : mActiveOverrideMeshes)
+    {
+        boost::hash_combine(key, mesh_id);
+    }
+    boost::hash_combine(key, mGlobalScale);
+    boost::hash_combine(key, mScaleConstraintFixup);
+    return key;
+}
+
+void LLControlAvatar::getSharedPoseMotions(shared_pose_motions_t& motions)
+{
+    // Control avatars run no default motions, these are the signaled ones
+    LLMotionController::motion_list_t& active_motions = mMotionController.getActiveMotions();
+    motions.reserve(active_motions.size());
+    for (LLMotion* motionp : active_motions)
+    {
+        motions.push_back({ motionp->getID(), mMotionController.getMotionTime(motionp), motionp->isStopped() });
+    }
+    std::sort(motions.begin(), motions.end(), [](const SharedPoseMotion& a, const SharedPoseMotion& b)
+    {
+        return a.mID < b.mID;
+    });
+}
+// </FS>
+
 //virtual
 void LLControlAvatar::updateDebugText()
 {
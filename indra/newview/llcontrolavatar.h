@@ -30,6 +30,8 @@
 #include "llvoavatar.h"
 #include "llvovolume.h"
 
+#include <unordered_map> // <FS/> Shared animesh poses
+
 class LLControlAvatar:
     public LLVOAvatar
 {
@@ -89,6 +91,14 @@ public:
 
     bool isTooComplex() const; // <FS:Ansariel> FIRE-29012: Standalone animesh avatars get affected by complexity limit
 
+    // <FS> Shared animesh poses
+    virtual bool findSharedPose();
+    virtual void shareEvaluatedPose();
+
+    // Forget the poses offered during the avatar idle updates
+    static void clearSharedPoses() { sSharedPoses.clear(); }
+    // </FS>
+
 
     bool mPlaying;
 
@@ -108,6 +118,32 @@ public:
     static void onRegionChanged();
     bool mRegionChanged;
     static boost::signals2::connection sRegionChangedSlot;
+
+    // <FS> Shared animesh poses
+private:
+    struct SharedPoseMotion
+    {
+        LLUUID  mID;
+        F32     mTime;
+        bool    mStopped;
+    };
+    typedef std::vector<SharedPoseMotion> shared_pose_motions_t;
+
+    struct SharedPose
+    {
+        LLPointer<LLControlAvatar>  mSource;
+        shared_pose_motions_t       mMotions;
+    };
+    typedef std::unordered_multimap<size_t, SharedPose> shared_pose_map_t;
+
+    bool canSharePose() const;
+    bool hasSameSkeleton(const LLControlAvatar* other) const;
+    size_t getSharedPoseKey() const;
+    void getSharedPoseMotions(shared_pose_motions_t& motions);
+
+    // Poses evaluated during this frame's avatar idle updates
+    static shared_pose_map_t sSharedPoses;
+    // </FS>
 };
 
 typedef std::map<LLUUID, S32> signaled_animation_map_t;
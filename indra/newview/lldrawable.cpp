@@ -96,6 +96,16 @@ void LLDrawable::incrementVisible()
     sCurPixelAngle = (F32) gViewerWindow->getWindowHeightRaw()/LLViewerCamera::getInstance()->getView();
 }
 
+// <FS> Slab pools
+// static
+LLSlabPool& LLDrawable::getSlabPool()
+{
+    // never destroyed, drawables can still be released during static destruction
+    static LLSlabPool* pool = new LLSlabPool(4096);
+    return *pool;
+}
+// </FS>
+
 LLDrawable::LLDrawable(LLViewerObject *vobj, bool new_entry)
 :   LLViewerOctreeEntryData(LLViewerOctreeEntry::LLDRAWABLE),
     mVObjp(vobj)
@@ -604,60 +614,144 @@ void LLDrawable::makeStatic(bool warning_enabled)
     llassert(isAvatar() || isRoot() || mParent->isStatic());
 }
 
-// Returns "distance" between target destination and resulting xfrom
-F32 LLDrawable::updateXform(bool undamped)
+// <FS> Parallel move updates
+// static
+F32 LLDrawable::getDampingInterpolant()
 {
-    LL_PROFILE_ZONE_SCOPED_CATEGORY_DRAWABLE;
-
-    bool damped = !undamped;
+    return llclamp(LLSmoothInterpolation::getInterpolant(OBJECT_DAMPING_TIME_CONSTANT), 0.f, 1.f);
+}
 
+void LLDrawable::computeXformTarget(bool undamped, F32 lerp_amt, XformTarget& target) const
+{
     // Position
     const LLVector3 old_pos(mXform.getPosition());
-    LLVector3 target_pos;
     if (mXform.isRoot())
     {
         // get root position in your agent's region
-        target_pos = mVObjp->getPositionAgent();
+        target.mPosition = mVObjp->getPositionAgent();
     }
     else
     {
         // parent-relative position
-        target_pos = mVObjp->getPosition();
+        target.mPosition = mVObjp->getPosition();
     }
 
     // Rotation
     const LLQuaternion old_rot(mXform.getRotation());
-    LLQuaternion target_rot = mVObjp->getRotation();
+    target.mRotation = mVObjp->getRotation();
     //scaling
-    LLVector3 target_scale = mVObjp->getScale();
-    LLVector3 old_scale = mCurrentScale;
+    target.mScale = mVObjp->getScale();
+    const LLVector3 old_scale = mCurrentScale;
 
-    // Damping
-    F32 dist_squared = 0.f;
-    F32 camdist2 = (mDistanceWRTCamera * mDistanceWRTCamera);
+    target.mDistSquared = 0.f;
+    target.mUndamped = undamped;
+    target.mDamped = !undamped && isVisible();
+    target.mInterpolated = false;
 
-    if (damped && isVisible())
+    // Damping
+    if (target.mDamped)
     {
-        F32 lerp_amt = llclamp(LLSmoothInterpolation::getInterpolant(OBJECT_DAMPING_TIME_CONSTANT), 0.f, 1.f);
-        LLVector3 new_pos = lerp(old_pos, target_pos, lerp_amt);
-        dist_squared = dist_vec_squared(new_pos, target_pos);
+        F32 camdist2 = (mDistanceWRTCamera * mDistanceWRTCamera);
+        LLVector3 new_pos = lerp(old_pos, target.mPosition, lerp_amt);
+        F32 dist_squared = dist_vec_squared(new_pos, target.mPosition);
 
-        LLQuaternion new_rot = nlerp(lerp_amt, old_rot, target_rot);
+        LLQuaternion new_rot = nlerp(lerp_amt, old_rot, target.mRotation);
         // FIXME: This can be negative! It is be possible for some rots to 'cancel out' pos or size changes.
-        dist_squared += (1.f - dot(new_rot, target_rot)) * 10.f;
+        dist_squared += (1.f - dot(new_rot, target.mRotation)) * 10.f;
 
-        LLVector3 new_scale = lerp(old_scale, target_scale, lerp_amt);
-        dist_squared += dist_vec_squared(new_scale, target_scale);
+        LLVector3 new_scale = lerp(old_scale, target.mScale, lerp_amt);
+        dist_squared += dist_vec_squared(new_scale, target.mScale);
 
+        target.mDistSquared = dist_squared;
         if ((dist_squared >= MIN_INTERPOLATE_DISTANCE_SQUARED * camdist2) &&
             (dist_squared <= MAX_INTERPOLATE_DISTANCE_SQUARED))
         {
             // interpolate
-            target_pos = new_pos;
-            target_rot = new_rot;
-            target_scale = new_scale;
+            target.mPosition = new_pos;
+            target.mRotation = new_rot;
+            target.mScale = new_scale;
+            target.mInterpolated = true;
         }
-        else if (mVObjp->getAngularVelocity().isExactlyZero())
+    }
+}
+// </FS>
+
+// Returns "distance" between target destination and resulting xfrom
+// <FS> Parallel move updates
+//F32 LLDrawable::updateXform(bool undamped)
+F32 LLDrawable::updateXform(bool undamped, const XformTarget* precomputed)
+// </FS>
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_DRAWABLE;
+
+    // <FS> Parallel move updates
+    //bool damped = !undamped;
+    //
+    //// Position
+    //const LLVector3 old_pos(mXform.getPosition());
+    //LLVector3 target_pos;
+    //if (mXform.isRoot())
+    //{
+    //    // get root position in your agent's region
+    //    target_pos = mVObjp->getPositionAgent();
+    //}
+    //else
+    //{
+    //    // parent-relative position
+    //    target_pos = mVObjp->getPosition();
+    //}
+    //
+    //// Rotation
+    //const LLQuaternion old_rot(mXform.getRotation());
+    //LLQuaternion target_rot = mVObjp->getRotation();
+    ////scaling
+    //LLVector3 target_scale = mVObjp->getScale();
+    //LLVector3 old_scale = mCurrentScale;
+    //
+    //// Damping
+    //F32 dist_squared = 0.f;
+    //F32 camdist2 = (mDistanceWRTCamera * mDistanceWRTCamera);
+    //
+    //if (damped && isVisible())
+    //{
+    //    F32 lerp_amt = llclamp(LLSmoothInterpolation::getInterpolant(OBJECT_DAMPING_TIME_CONSTANT), 0.f, 1.f);
+    //    LLVector3 new_pos = lerp(old_pos, target_pos, lerp_amt);
+    //    dist_squared = dist_vec_squared(new_pos, target_pos);
+    //
+    //    LLQuaternion new_rot = nlerp(lerp_amt, old_rot, target_rot);
+    //    // FIXME: This can be negative! It is be possible for some rots to 'cancel out' pos or size changes.
+    //    dist_squared += (1.f - dot(new_rot, target_rot)) * 10.f;
+    //
+    //    LLVector3 new_scale = lerp(old_scale, target_scale, lerp_amt);
+    //    dist_squared += dist_vec_squared(new_scale, target_scale);
+    //
+    //    if ((dist_squared >= MIN_INTERPOLATE_DISTANCE_SQUARED * camdist2) &&
+    //        (dist_squared <= MAX_INTERPOLATE_DISTANCE_SQUARED))
+    //    {
+    //        // interpolate
+    //        target_pos = new_pos;
+    //        target_rot = new_rot;
+    //        target_scale = new_scale;
+    //    }
+    //    else if (mVObjp->getAngularVelocity().isExactlyZero())
+    XformTarget computed;
+    if (!precomputed)
+    {
+        computeXformTarget(undamped, undamped ? 0.f : getDampingInterpolant(), computed);
+        precomputed = &computed;
+    }
+
+    const LLVector3 old_pos(mXform.getPosition());
+    const LLQuaternion old_rot(mXform.getRotation());
+    LLVector3 target_pos = precomputed->mPosition;
+    LLQuaternion target_rot = precomputed->mRotation;
+    LLVector3 target_scale = precomputed->mScale;
+    F32 dist_squared = precomputed->mDistSquared;
+
+    if (precomputed->mDamped)
+    {
+        if (!precomputed->mInterpolated && mVObjp->getAngularVelocity().isExactlyZero())
+    // </FS>
         {
             // snap to final position (only if no target omega is applied)
             dist_squared = 0.0f;
@@ -788,9 +882,27 @@ bool LLDrawable::updateMove()
     return isState(MOVE_UNDAMPED) ? updateMoveUndamped() : updateMoveDamped();
 }
 
-bool LLDrawable::updateMoveUndamped()
+// <FS> Parallel move updates
+bool LLDrawable::updateMoveTo(const XformTarget& target)
+{
+    if (isDead() || mVObjp.isNull() || isState(MOVE_UNDAMPED) != target.mUndamped)
+    { // changed since, work it out again
+        return updateMove();
+    }
+
+    makeActive();
+
+    return target.mUndamped ? updateMoveUndamped(&target) : updateMoveDamped(&target);
+}
+// </FS>
+
+// <FS> Parallel move updates
+//bool LLDrawable::updateMoveUndamped()
+bool LLDrawable::updateMoveUndamped(const XformTarget* target)
+// </FS>
 {
-    F32 dist_squared = updateXform(true);
+    //F32 dist_squared = updateXform(true);
+    F32 dist_squared = updateXform(true, target); // <FS/> Parallel move updates
 
     mGeneration++;
 
@@ -824,11 +936,15 @@ void LLDrawable::updatePartition()
     }
 }
 
-bool LLDrawable::updateMoveDamped()
+// <FS> Parallel move updates
+//bool LLDrawable::updateMoveDamped()
+bool LLDrawable::updateMoveDamped(const XformTarget* target)
+// </FS>
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_DRAWABLE;
 
-    F32 dist_squared = updateXform(false);
+    //F32 dist_squared = updateXform(false);
+    F32 dist_squared = updateXform(false, target); // <FS/> Parallel move updates
 
     mGeneration++;
 
@@ -43,6 +43,7 @@
 #include "llappviewer.h" // for gFrameTimeSeconds
 #include "llvieweroctree.h"
 #include <unordered_set>
+#include "llslabpool.h" // <FS/> Slab pools
 
 class LLCamera;
 class LLDrawPool;
@@ -63,7 +64,11 @@ LL_ALIGN_PREFIX(16)
 class LLDrawable
     : public LLViewerOctreeEntryData
 {
-    LL_ALIGN_NEW;
+    // <FS> Slab pools
+    //LL_ALIGN_NEW;
+    LL_SLAB_POOL_NEW(getSlabPool())
+    static LLSlabPool& getSlabPool();
+    // </FS>
 public:
     typedef std::vector<LLFace*> face_list_t;
 
@@ -151,7 +156,32 @@ public:
     void destroy();
 
     void update();
-    F32 updateXform(bool undamped);
+    // <FS> Parallel move updates
+    // Where updateXform() moves the drawable to, worked out apart from moving
+    // it so it can be done for many drawables side by side
+    struct XformTarget
+    {
+        LLVector3       mPosition;
+        LLQuaternion    mRotation;
+        LLVector3       mScale;
+        F32             mDistSquared;
+        bool            mUndamped;
+        bool            mDamped;        // damping applied, the drawable was visible
+        bool            mInterpolated;  // still on its way, else it snaps unless spinning
+    };
+
+    // Threads:  any, reads only this drawable and its object. lerp_amt is
+    // what getDampingInterpolant() returns this frame.
+    void computeXformTarget(bool undamped, F32 lerp_amt, XformTarget& target) const;
+    // Threads:  Tmain
+    static F32 getDampingInterpolant();
+    // Threads:  Tmain
+    // updateMove() to a target computed since the last move
+    bool updateMoveTo(const XformTarget& target);
+
+    //F32 updateXform(bool undamped);
+    F32 updateXform(bool undamped, const XformTarget* target = nullptr);
+    // </FS>
 
     virtual void makeActive();
     /*virtual*/ void makeStatic(bool warning_enabled = true);
@@ -216,8 +246,12 @@ protected:
     ~LLDrawable() { destroy(); }
     void moveUpdatePipeline(bool moved);
     void updatePartition();
-    bool updateMoveDamped();
-    bool updateMoveUndamped();
+    // <FS> Parallel move updates
+    //bool updateMoveDamped();
+    //bool updateMoveUndamped();
+    bool updateMoveDamped(const XformTarget* target = nullptr);
+    bool updateMoveUndamped(const XformTarget* target = nullptr);
+    // </FS>
 
 public:
     friend class LLPipeline;
@@ -377,6 +377,8 @@ void LLFacePool::LLOverrideFaceColor::setColor(F32 r, F32 g, F32 b, F32 a)
 //=============================
 // Render Pass Implementation
 //=============================
+bool LLRenderPass::sUseMultiDraw = true; // <FS/> Multi-draw batching
+
 LLRenderPass::LLRenderPass(const U32 type)
 : LLDrawPool(type)
 {
@@ -751,6 +753,54 @@ bool LLRenderPass::uploadMatrixPalette(LLVOAvatar* avatar, LLMeshSkinInfo* skinI
     return !skipLastSkin;
 }
 
+// <FS> Multi-draw batching
+//static
+void LLRenderPass::drawMerged(LLDrawInfo& params, LLDrawInfo**& i, LLDrawInfo** end, same_state_t same_state)
+{
+    LLVertexBuffer* buffer = params.mVertexBuffer;
+    buffer->setBuffer();
+
+    if (!sUseMultiDraw || i == end || !same_state(params, **i))
+    {
+        buffer->drawRange(LLRender::TRIANGLES, params.mStart, params.mEnd, params.mCount, params.mOffset);
+        return;
+    }
+
+    static std::vector<U32> counts;
+    static std::vector<U32> offsets;
+    counts.assign(1, params.mCount);
+    offsets.assign(1, params.mOffset);
+
+    while (i != end && same_state(params, **i))
+    {
+        LLDrawInfo& next = **i;
+        LLCullResult::increment_iterator(i, end);
+        if (next.mCount)
+        {
+            counts.push_back(next.mCount);
+            offsets.push_back(next.mOffset);
+        }
+    }
+
+    buffer->drawRanges(LLRender::TRIANGLES, counts.data(), offsets.data(), (U32)counts.size());
+    gPipeline.mMergedDrawCount += (U32)counts.size() - 1;
+}
+
+namespace
+{
+    // pushGLTFBatch() binds the material, media texture, texture matrix and
+    // model matrix of the draw info
+    bool same_gltf_state(const LLDrawInfo& lhs, const LLDrawInfo& rhs)
+    {
+        return lhs.mVertexBuffer == rhs.mVertexBuffer &&
+            lhs.mGLTFMaterial == rhs.mGLTFMaterial &&
+            lhs.mTexture == rhs.mTexture &&
+            lhs.mTextureMatrix == rhs.mTextureMatrix &&
+            lhs.mModelMatrix == rhs.mModelMatrix;
+    }
+}
+// </FS>
+
 void setup_texture_matrix(LLDrawInfo& params)
 {
     if (params.mTextureMatrix)
@@ -795,7 +845,10 @@ void LLRenderPass::pushGLTFBatches(U32 type)
         LLDrawInfo& params = **i;
         LLCullResult::increment_iterator(i, end);
 
-        pushGLTFBatch(params);
+        // <FS> Multi-draw batching
+        //pushGLTFBatch(params);
+        pushGLTFBatch(params, i, end);
+        // </FS>
     }
 }
 
@@ -810,13 +863,25 @@ void LLRenderPass::pushUntexturedGLTFBatches(U32 type)
         LLDrawInfo& params = **i;
         LLCullResult::increment_iterator(i, end);
 
-        pushUntexturedGLTFBatch(params);
+        // <FS> Multi-draw batching
+        //pushUntexturedGLTFBatch(params);
+        pushUntexturedGLTFBatch(params, i, end);
+        // </FS>
     }
 }
 
 // static
 void LLRenderPass::pushGLTFBatch(LLDrawInfo& params)
 {
+    // <FS> Multi-draw batching
+    LLDrawInfo** none = nullptr;
+    pushGLTFBatch(params, none, none);
+}
+
+// static
+void LLRenderPass::pushGLTFBatch(LLDrawInfo& params, LLDrawInfo**& i, LLDrawInfo** end)
+{
+    // </FS>
     auto& mat = params.mGLTFMaterial;
 
     if (mat.notNull())
@@ -830,8 +895,11 @@ void LLRenderPass::pushGLTFBatch(LLDrawInfo& params)
 
     applyModelMatrix(params);
 
-    params.mVertexBuffer->setBuffer();
-    params.mVertexBuffer->drawRange(LLRender::TRIANGLES, params.mStart, params.mEnd, params.mCount, params.mOffset);
+    // <FS> Multi-draw batching
+    //params.mVertexBuffer->setBuffer();
+    //params.mVertexBuffer->drawRange(LLRender::TRIANGLES, params.mStart, params.mEnd, params.mCount, params.mOffset);
+    drawMerged(params, i, end, same_gltf_state);
+    // </FS>
 
     teardown_texture_matrix(params);
 }
@@ -839,14 +907,26 @@ void LLRenderPass::pushGLTFBatch(LLDrawInfo& params)
 // static
 void LLRenderPass::pushUntexturedGLTFBatch(LLDrawInfo& params)
 {
+    // <FS> Multi-draw batching
+    LLDrawInfo** none = nullptr;
+    pushUntexturedGLTFBatch(params, none, none);
+}
+
+// static
+void LLRenderPass::pushUntexturedGLTFBatch(LLDrawInfo& params, LLDrawInfo**& i, LLDrawInfo** end)
+{
+    // </FS>
     auto& mat = params.mGLTFMaterial;
 
     LLGLDisable cull_face(mat->mDoubleSided ? GL_CULL_FACE : 0);
 
     applyModelMatrix(params);
 
-    params.mVertexBuffer->setBuffer();
-    params.mVertexBuffer->drawRange(LLRender::TRIANGLES, params.mStart, params.mEnd, params.mCount, params.mOffset);
+    // <FS> Multi-draw batching
+    //params.mVertexBuffer->setBuffer();
+    //params.mVertexBuffer->drawRange(LLRender::TRIANGLES, params.mStart, params.mEnd, params.mCount, params.mOffset);
+    drawMerged(params, i, end, same_gltf_state);
+    // </FS>
 }
 
 void LLRenderPass::pushRiggedGLTFBatches(U32 type, bool textured)
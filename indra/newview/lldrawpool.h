@@ -349,6 +349,18 @@ public:
     bool isDead() { return false; }
     void resetDrawOrders() { }
 
+    // <FS> Multi-draw batching
+    static bool sUseMultiDraw;
+
+    // true when nothing needs to be rebound or uploaded between drawing lhs and rhs
+    typedef bool (*same_state_t)(const LLDrawInfo& lhs, const LLDrawInfo& rhs);
+
+    // Draw params, with the state already set up, together with the draw
+    // infos from i on that same_state() matches to it in one multi-draw call.
+    // Advances i past the ones drawn.
+    static void drawMerged(LLDrawInfo& params, LLDrawInfo**& i, LLDrawInfo** end, same_state_t same_state);
+    // </FS>
+
     static void applyModelMatrix(const LLDrawInfo& params);
     // For rendering that doesn't use LLDrawInfo for some reason
     static void applyModelMatrix(const LLMatrix4* model_matrix);
@@ -376,6 +388,11 @@ public:
 
     // push a single GLTF draw call
     static void pushGLTFBatch(LLDrawInfo& params);
+    // <FS> Multi-draw batching
+    // also draws the draw infos from i on that share params' state, advancing i past them
+    static void pushGLTFBatch(LLDrawInfo& params, LLDrawInfo**& i, LLDrawInfo** end);
+    static void pushUntexturedGLTFBatch(LLDrawInfo& params, LLDrawInfo**& i, LLDrawInfo** end);
+    // </FS>
     static void pushRiggedGLTFBatch(LLDrawInfo& params, const LLVOAvatar*& lastAvatar, U64& lastMeshId, bool& skipLastSkin);
     static void pushUntexturedGLTFBatch(LLDrawInfo& params);
     static void pushUntexturedRiggedGLTFBatch(LLDrawInfo& params, const LLVOAvatar*& lastAvatar, U64& lastMeshId, bool& skipLastSkin);
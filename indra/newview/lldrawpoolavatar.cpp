@@ -514,6 +514,8 @@ void LLDrawPoolAvatar::endImpostor()
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
 
+    gPipeline.mImpostorAtlas.drawQueued(sDiffuseChannel, -1, -1); // <FS/> Impostor atlas
+
         gImpostorProgram.unbind();
     gPipeline.enableLightsDynamic();
 }
@@ -571,6 +573,11 @@ void LLDrawPoolAvatar::endDeferredImpostor()
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
 
+    // <FS> Impostor atlas
+    bool bind_material = LLPipeline::sRenderDeferred && !LLPipeline::sReflectionRender;
+    gPipeline.mImpostorAtlas.drawQueued(sDiffuseChannel, bind_material ? specular_channel : -1, bind_material ? normal_channel : -1);
+    // </FS>
+
     sShaderLevel = mShaderLevel;
     sVertexProgram->disableTexture(LLViewerShaderMgr::NORMAL_MAP);
     sVertexProgram->disableTexture(LLViewerShaderMgr::SPECULAR_MAP);
@@ -874,7 +881,8 @@ void LLDrawPoolAvatar::renderAvatars(LLVOAvatar* single_avatar, S32 pass)
         if (impostor || (LLVOAvatar::AOA_NORMAL != avatarp->getOverallAppearance() && !avatarp->needsImpostorUpdate()))
         {
             LL_PROFILE_ZONE_NAMED_CATEGORY_AVATAR("render impostor"); // <FS:Beq/> Tracy markup
-            if (LLPipeline::sRenderDeferred && !LLPipeline::sReflectionRender && avatarp->mImpostor.isComplete())
+            if (LLPipeline::sRenderDeferred && !LLPipeline::sReflectionRender && avatarp->mImpostor.isComplete()
+                && !gPipeline.mImpostorAtlas.isValid(avatarp->mImpostorSlot)) // <FS/> Impostor atlas, bound for the whole page
             {
                 // <FS:Ansariel> FIRE-9179: Crash fix
                 //if (normal_channel > -1)
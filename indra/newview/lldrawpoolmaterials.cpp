@@ -33,6 +33,28 @@
 #include "llglcommonfunc.h"
 #include "llvoavatar.h"
 
+// <FS> Multi-draw batching
+namespace
+{
+    // Everything renderDeferred() binds or uploads per draw info
+    bool same_material_state(const LLDrawInfo& lhs, const LLDrawInfo& rhs)
+    {
+        return lhs.mVertexBuffer == rhs.mVertexBuffer &&
+            lhs.mTexture == rhs.mTexture &&
+            lhs.mNormalMap == rhs.mNormalMap &&
+            lhs.mSpecularMap == rhs.mSpecularMap &&
+            lhs.mSpecColor == rhs.mSpecColor &&
+            lhs.mEnvIntensity == rhs.mEnvIntensity &&
+            lhs.mAlphaMaskCutoff == rhs.mAlphaMaskCutoff &&
+            lhs.mFullbright == rhs.mFullbright &&
+            lhs.mTextureMatrix == rhs.mTextureMatrix &&
+            lhs.mModelMatrix == rhs.mModelMatrix &&
+            lhs.mAvatar == rhs.mAvatar &&
+            lhs.mSkinInfo == rhs.mSkinInfo;
+    }
+}
+// </FS>
+
 LLDrawPoolMaterials::LLDrawPoolMaterials()
 :  LLRenderPass(LLDrawPool::POOL_MATERIALS)
 {
@@ -276,8 +298,11 @@ void LLDrawPoolMaterials::renderDeferred(S32 pass)
             params.mGroup->rebuildMesh();
         }*/
 
-        params.mVertexBuffer->setBuffer();
-        params.mVertexBuffer->drawRange(LLRender::TRIANGLES, params.mStart, params.mEnd, params.mCount, params.mOffset);
+        // <FS> Multi-draw batching
+        //params.mVertexBuffer->setBuffer();
+        //params.mVertexBuffer->drawRange(LLRender::TRIANGLES, params.mStart, params.mEnd, params.mCount, params.mOffset);
+        drawMerged(params, i, end, same_material_state);
+        // </FS>
 
         if (tex_setup)
         {
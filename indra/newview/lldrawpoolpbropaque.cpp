@@ -64,6 +64,14 @@ void LLDrawPoolGLTFPBR::renderDeferred(S32 pass)
 
     LL::GLTFSceneManager::instance().render(true, true);
 
+    // <FS> Mesh instancing
+    if (mRenderType == LLPipeline::RENDER_TYPE_PASS_GLTF_PBR)
+    {
+        gDeferredPBROpaqueInstancedProgram.bind();
+        gPipeline.mMeshInstancer.render(false);
+    }
+    // </FS>
+
     gDeferredPBROpaqueProgram.bind(true);
     pushRiggedGLTFBatches(mRenderType + 1);
 }
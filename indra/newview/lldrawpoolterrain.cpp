@@ -200,6 +200,15 @@ void LLDrawPoolTerrain::renderShadow(S32 pass)
 
 void LLDrawPoolTerrain::drawLoop()
 {
+    // <FS> GPU terrain
+    if (FSGPUTerrain::isEnabled())
+    {
+        llassert(gGL.getMatrixMode() == LLRender::MM_MODELVIEW);
+        gPipeline.mGPUTerrain.render(mDrawFace);
+        return;
+    }
+    // </FS>
+
     if (!mDrawFace.empty())
     {
         for (std::vector<LLFace*>::iterator iter = mDrawFace.begin();
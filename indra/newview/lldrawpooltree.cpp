@@ -91,6 +91,15 @@ void LLDrawPoolTree::renderDeferred(S32 pass)
         {
             LLMatrix4* model_matrix = &(face->getDrawable()->getRegion()->mRenderMatrix);
 
+            // <FS> Tree instancing
+            LLVOTree* tree = (LLVOTree*)face->getViewerObject();
+            if (tree && tree->isInstanced())
+            {
+                gPipeline.mTreeInstancer.queue(buff, model_matrix, tree->getInstanceTransform());
+                continue;
+            }
+            // </FS>
+
             llassert(gGL.getMatrixMode() == LLRender::MM_MODELVIEW);
             LLRenderPass::applyModelMatrix(model_matrix);
 
@@ -98,6 +107,28 @@ void LLDrawPoolTree::renderDeferred(S32 pass)
             buff->drawRange(LLRender::TRIANGLES, 0, buff->getNumVerts() - 1, buff->getNumIndices(), 0);
         }
     }
+
+    // <FS> Tree instancing
+    if (gPipeline.mTreeInstancer.hasQueued())
+    {
+        LLGLSLShader* cur_shader = LLGLSLShader::sCurBoundShaderPtr;
+        LLGLSLShader* instanced_shader = LLPipeline::sShadowRender ? &gDeferredTreeShadowInstancedProgram : &gDeferredTreeInstancedProgram;
+
+        instanced_shader->bind();
+        instanced_shader->setMinimumAlpha(0.5f);
+        if (LLPipeline::sShadowRender)
+        {
+            instanced_shader->uniform1i(LLShaderMgr::SUN_UP_FACTOR, LLEnvironment::instance().getIsSunUp() ? 1 : 0);
+        }
+
+        gPipeline.mTreeInstancer.render();
+
+        if (cur_shader)
+        {
+            cur_shader->bind();
+        }
+    }
+    // </FS>
 }
 
 void LLDrawPoolTree::endDeferredPass(S32 pass)
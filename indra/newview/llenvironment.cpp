@@ -1830,6 +1830,29 @@ void LLEnvironment::update(const LLViewerCamera * cam)
 
     updateSettingsUniforms();
 
+    // <FS> Cached environment uniforms, shaders keep the values they were
+    // given until the uniforms change. A static sky seen from a still camera
+    // doesn't make every shader reapply them each frame.
+    if (!mShaderUniformsDirty)
+    {
+        bool changed = false;
+        for (U32 i = 0; i < LLGLSLShader::SG_COUNT && !changed; ++i)
+        {
+            changed = mSkyUniforms[i] != mAppliedSkyUniforms[i] || mWaterUniforms[i] != mAppliedWaterUniforms[i];
+        }
+        if (!changed)
+        {
+            return;
+        }
+    }
+    mShaderUniformsDirty = false;
+    for (U32 i = 0; i < LLGLSLShader::SG_COUNT; ++i)
+    {
+        mAppliedSkyUniforms[i] = mSkyUniforms[i];
+        mAppliedWaterUniforms[i] = mWaterUniforms[i];
+    }
+    // </FS>
+
     LLViewerShaderMgr::shader_iter shaders_iter, end_shaders;
     end_shaders = LLViewerShaderMgr::instance()->endShaders();
     for (shaders_iter = LLViewerShaderMgr::instance()->beginShaders(); shaders_iter != end_shaders; ++shaders_iter)
@@ -143,6 +143,12 @@ public:
     // prepare settings to be applied to shaders (call whenever settings are updated)
     void                        updateSettingsUniforms();
 
+    // <FS> Cached environment uniforms
+    // Have every shader take the environment uniforms again with the next
+    // update(), for code that overwrites them on a shader for one draw
+    void                        dirtyShaderUniforms() { mShaderUniformsDirty = true; }
+    // </FS>
+
     void                        setSelectedEnvironment(EnvSelection_t env, LLSettingsBase::Seconds transition = TRANSITION_DEFAULT, bool forced = false);
     EnvSelection_t              getSelectedEnvironment() const                  { return mSelectedEnvironment; }
 
@@ -249,6 +255,14 @@ public:
     //cached uniform values from LLSD values
     LLShaderUniforms mWaterUniforms[LLGLSLShader::SG_COUNT];
     LLShaderUniforms mSkyUniforms[LLGLSLShader::SG_COUNT];
+
+    // <FS> Cached environment uniforms
+    // what the shaders were last told to pick up, update() only dirties
+    // them again when the uniforms differ from these
+    LLShaderUniforms mAppliedWaterUniforms[LLGLSLShader::SG_COUNT];
+    LLShaderUniforms mAppliedSkyUniforms[LLGLSLShader::SG_COUNT];
+    bool mShaderUniformsDirty = true;
+    // </FS>
     // =======================================================================================
 
     class DayInstance: public std::enable_shared_from_this<DayInstance>
@@ -42,6 +42,7 @@
 
 #include "llsdutil.h" // <FS:ND/> for ll_pretty_print_sd
 #include "llviewernetwork.h"
+#include "llviewercontrol.h" // <FS/> Off-thread LLSD parsing
 
 namespace LLEventPolling
 {
@@ -192,8 +193,14 @@ namespace Details
             LL_DEBUGS("LLEventPollImpl") << " <" << counter << "> posting and yielding." << LL_ENDL;
             // <FS:Ansariel> Restore pre-coro behavior (60s timeout, no retries)
             //LLSD result = httpAdapter->postAndSuspend(mHttpRequest, url, request);
-            LLSD result = httpAdapter->postAndSuspend(mHttpRequest, url, request, mHttpOptions);
+            //LLSD result = httpAdapter->postAndSuspend(mHttpRequest, url, request, mHttpOptions);
             // </FS:Ansariel>
+            // <FS> Off-thread LLSD parsing
+            static LLCachedControl<bool> parse_off_thread(gSavedSettings, "FSEventPollParseOffThread", true);
+            LLSD result = parse_off_thread ?
+                httpAdapter->postAndSuspendParseAsync(mHttpRequest, url, request, mHttpOptions) :
+                httpAdapter->postAndSuspend(mHttpRequest, url, request, mHttpOptions);
+            // </FS>
 
 //          LL_DEBUGS("LLEventPollImpl::eventPollCoro") << "<" << counter << "> result = "
 //              << LLSDXMLStreamer(result) << LL_ENDL;
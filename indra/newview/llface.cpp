@@ -34,6 +34,7 @@
 #include "llvolume.h"
 #include "m3math.h"
 #include "llmatrix4a.h"
+#include "llvolumesimd.h" // <FS/> Vertex stream kernels
 #include "v3color.h"
 
 #include "lldefs.h"
@@ -130,6 +131,16 @@ void planarProjection(LLVector2 &tc, const LLVector4a& normal,
 // LLFace implementation
 //
 
+// <FS> Slab pools
+// static
+LLSlabPool& LLFace::getSlabPool()
+{
+    // never destroyed, faces can still be released during static destruction
+    static LLSlabPool* pool = new LLSlabPool(4096);
+    return *pool;
+}
+// </FS>
+
 void LLFace::init(LLDrawable* drawablep, LLViewerObject* objp)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_FACE;
@@ -243,6 +254,27 @@ void LLFace::setPool(LLFacePool* pool)
     mDrawPoolp = pool;
 }
 
+// <FS> Incremental complexity
+// Alpha faces and media faces cost more, see LLVOVolume::getRenderCost()
+void LLFace::setPoolType(U32 type)
+{
+    if (mPoolType != type && mVObjp.notNull())
+    {
+        mVObjp->dirtyRenderCost();
+    }
+    mPoolType = type;
+}
+
+void LLFace::setHasMedia(bool has_media)
+{
+    if (mHasMedia != has_media && mVObjp.notNull())
+    {
+        mVObjp->dirtyRenderCost();
+    }
+    mHasMedia = has_media;
+}
+// </FS>
+
 void LLFace::setPool(LLFacePool* new_pool, LLViewerTexture *texturep)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_FACE;
@@ -306,6 +338,13 @@ void LLFace::setTexture(U32 ch, LLViewerTexture* tex)
     }
 
     mTexture[ch] = tex ;
+
+    // <FS> Incremental complexity
+    if (LLRender::DIFFUSE_MAP == ch && mVObjp.notNull())
+    {
+        mVObjp->dirtyRenderCost();
+    }
+    // </FS>
 }
 
 void LLFace::setTexture(LLViewerTexture* tex)
@@ -339,6 +378,14 @@ void LLFace::dirtyTexture()
 
     LLDrawable* drawablep = getDrawable();
 
+    // <FS> Incremental complexity
+    // Loading can turn out a diffuse texture to be an alpha mask
+    if (mVObjp.notNull())
+    {
+        mVObjp->dirtyRenderCost();
+    }
+    // </FS>
+
     if (mVObjp.notNull() && mVObjp->getVolume())
     {
         for (U32 ch = 0; ch < LLRender::NUM_TEXTURE_CHANNELS; ++ch)
@@ -2005,7 +2052,7 @@ bool LLFace::getGeometryVolume(const LLVolume& volume,
 
             //_mm_prefetch((char*)src, _MM_HINT_T0);
 
-            LLVector4a* end = src+num_vertices;
+            //LLVector4a* end = src+num_vertices; // <FS/> Vertex stream kernels
             //LLVector4a* end_64 = end-4;
 
             llassert(num_vertices > 0);
@@ -2024,7 +2071,7 @@ bool LLFace::getGeometryVolume(const LLVolume& volume,
 
             LLVector4a res0; //,res1,res2,res3;
 
-            LLVector4a texIdx;
+            //LLVector4a texIdx; // <FS/> Vertex stream kernels
 
             S32 index = mTextureIndex < FACE_DO_NOT_BATCH_TEXTURES ? mTextureIndex : 0;
 
@@ -2034,22 +2081,27 @@ bool LLFace::getGeometryVolume(const LLVolume& volume,
 
             llassert(index < LLGLSLShader::sIndexedTextureChannels);
 
-            LLVector4Logical mask;
-            mask.clear();
-            mask.setElement<3>();
-
-            texIdx.set(0,0,0,val);
-
-            LLVector4a tmp;
-
-
-            while (src < end)
-            {
-                mat_vert.affineTransform(*src++, res0);
-                tmp.setSelectWithMask(mask, texIdx, res0);
-                tmp.store4a((F32*) dst);
-                dst += 4;
-            }
+            // <FS> Vertex stream kernels
+            //LLVector4Logical mask;
+            //mask.clear();
+            //mask.setElement<3>();
+            //
+            //texIdx.set(0,0,0,val);
+            //
+            //LLVector4a tmp;
+            //
+            //
+            //while (src < end)
+            //{
+            //    mat_vert.affineTransform(*src++, res0);
+            //    tmp.setSelectWithMask(mask, texIdx, res0);
+            //    tmp.store4a((F32*) dst);
+            //    dst += 4;
+            //}
+            LLVolumeSIMD::transformPositions(mat_vert, src, (LLVector4a*) dst, num_vertices, val);
+            dst += num_vertices * 4;
+            res0 = *((LLVector4a*) dst - 1);
+            // </FS>
 
             while (dst < end_f32)
             {
@@ -2075,27 +2127,19 @@ bool LLFace::getGeometryVolume(const LLVolume& volume,
 
             mVertexBuffer->getNormalStrider(norm, mGeomIndex, mGeomCount);
             F32* normals = (F32*) norm.get();
-            LLVector4a* src = vf.mNormals;
-            LLVector4a* end = src+num_vertices;
-
-            while (src < end)
-            {
-                LLVector4a normal;
-// <FS:Zi> GCC12 warning: maybe-uninitialized - probably bogus
-#if defined(__GNUC__) && (__GNUC__ >= 12)
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
-#endif
-// </FS:Zi>
-                mat_normal.rotate(*src++, normal);
-// <FS:Zi> GCC12 warning: maybe-uninitialized - probably bogus
-#if defined(__GNUC__) && (__GNUC__ >= 12)
-#pragma GCC diagnostic pop
-#endif
-// </FS:Zi>
-                normal.store4a(normals);
-                normals += 4;
-            }
+            // <FS> Vertex stream kernels
+            //LLVector4a* src = vf.mNormals;
+            //LLVector4a* end = src+num_vertices;
+            //
+            //while (src < end)
+            //{
+            //    LLVector4a normal;
+            //    mat_normal.rotate(*src++, normal);
+            //    normal.store4a(normals);
+            //    normals += 4;
+            //}
+            LLVolumeSIMD::rotateVectors(mat_normal, vf.mNormals, (LLVector4a*) normals, num_vertices);
+            // </FS>
         }
 
         if (rebuild_tangent)
@@ -2106,34 +2150,26 @@ bool LLFace::getGeometryVolume(const LLVolume& volume,
 
             mVObjp->getVolume()->genTangents(face_index);
 
-            LLVector4Logical mask;
-            mask.clear();
-            mask.setElement<3>();
-
-            LLVector4a* src = vf.mTangents;
-            LLVector4a* end = vf.mTangents +num_vertices;
-
-            while (src < end)
-            {
-                LLVector4a tangent_out;
-// <FS:Zi> GCC12 warning: maybe-uninitialized - probably bogus
-#if defined(__GNUC__) && (__GNUC__ >= 12)
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
-#endif
-// </FS:Zi>
-                mat_normal.rotate(*src, tangent_out);
-// <FS:Zi> GCC12 warning: maybe-uninitialized - probably bogus
-#if defined(__GNUC__) && (__GNUC__ >= 12)
-#pragma GCC diagnostic pop
-#endif
-// </FS:Zi>
-                tangent_out.setSelectWithMask(mask, *src, tangent_out);
-                tangent_out.store4a(tangents);
-
-                src++;
-                tangents += 4;
-            }
+            // <FS> Vertex stream kernels
+            //LLVector4Logical mask;
+            //mask.clear();
+            //mask.setElement<3>();
+            //
+            //LLVector4a* src = vf.mTangents;
+            //LLVector4a* end = vf.mTangents +num_vertices;
+            //
+            //while (src < end)
+            //{
+            //    LLVector4a tangent_out;
+            //    mat_normal.rotate(*src, tangent_out);
+            //    tangent_out.setSelectWithMask(mask, *src, tangent_out);
+            //    tangent_out.store4a(tangents);
+            //
+            //    src++;
+            //    tangents += 4;
+            //}
+            LLVolumeSIMD::rotateTangents(mat_normal, vf.mTangents, (LLVector4a*) tangents, num_vertices);
+            // </FS>
         }
 
         if (rebuild_weights && vf.mWeights)
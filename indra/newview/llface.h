@@ -34,6 +34,7 @@
 #include "v4math.h"
 #include "m4math.h"
 #include "v4coloru.h"
+#include "llslabpool.h" // <FS/> Slab pools
 #include "llquaternion.h"
 #include "xform.h"
 #include "llvertexbuffer.h"
@@ -57,7 +58,11 @@ const U8 FACE_DO_NOT_BATCH_TEXTURES = 255;
 
 class alignas(16) LLFace
 {
-    LL_ALIGN_NEW
+    // <FS> Slab pools
+    //LL_ALIGN_NEW
+    LL_SLAB_POOL_NEW(getSlabPool())
+    static LLSlabPool& getSlabPool();
+    // </FS>
 public:
     LLFace(const LLFace& rhs)
     {
@@ -80,6 +85,7 @@ public:
         TEXTURE_ANIM    = 0x0020,
         RIGGED          = 0x0040,
         PARTICLE        = 0x0080,
+        MESH_INSTANCE   = 0x0100,   // <FS/> Mesh instancing: drawn from the instance list of its group
     };
 
 public:
@@ -135,7 +141,10 @@ public:
     LLDrawable*     getDrawable()       const   { return mDrawablep; }
     LLViewerObject* getViewerObject()   const   { return mVObjp; }
     S32             getLOD()            const   { return mVObjp.notNull() ? mVObjp->getLOD() : 0; }
-    void            setPoolType(U32 type)       { mPoolType = type; }
+    // <FS> Incremental complexity
+    //void            setPoolType(U32 type)       { mPoolType = type; }
+    void            setPoolType(U32 type);
+    // </FS>
     S32             getTEOffset()       const   { return mTEOffset; }
     LLViewerTexture*    getTexture(U32 ch = LLRender::DIFFUSE_MAP) const;
 
@@ -214,7 +223,10 @@ public:
     F32         getTextureVirtualSize() ;
     void        resetVirtualSize();
 
-    void        setHasMedia(bool has_media)  { mHasMedia = has_media ;}
+    // <FS> Incremental complexity
+    //void        setHasMedia(bool has_media)  { mHasMedia = has_media ;}
+    void        setHasMedia(bool has_media);
+    // </FS>
     bool        hasMedia() const ;
 
     void        setMediaAllowed(bool is_media_allowed)  { mIsMediaAllowed = is_media_allowed; }
@@ -231,6 +243,7 @@ public:
     void setVertexBuffer(LLVertexBuffer* buffer);
     void clearVertexBuffer(); //sets mVertexBuffer to NULL
     LLVertexBuffer* getVertexBuffer()   const   { return mVertexBuffer; }
+    bool hasGLTFSelectionBuffer()       const   { return mVertexBufferGLTF.notNull(); } // <FS/> Threaded geometry fill
     S32 getRiggedIndex(U32 type) const;
 
     // used to preserve draw order of faces that are batched together.
@@ -54,6 +54,7 @@
 #include "lltreeiterators.h"
 #include "llmetricperformancetester.h"
 #include "llviewerstats.h"
+#include "pipeline.h" // <FS/> GPU pass timers
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -1394,6 +1395,21 @@ void LLFastTimerView::drawHelp( S32 y )
 
     LLFontGL::getFontMonospace()->renderUTF8(std::string("[Right-Click log selected]"),
         0, MARGIN, y, LLColor4::white, LLFontGL::LEFT, LLFontGL::TOP);
+
+    // <FS> GPU pass timers
+    static LLCachedControl<bool> gpu_pass_timers(gSavedSettings, "FSGPUPassTimers", false);
+    if (gpu_pass_timers)
+    {
+        std::string gpu_times("GPU ms:");
+        for (U32 i = 0; i < FSGPUPassTimer::PASS_COUNT; ++i)
+        {
+            FSGPUPassTimer::EPass pass = (FSGPUPassTimer::EPass)i;
+            gpu_times += llformat(" %s %.2f", FSGPUPassTimer::getPassName(pass), gPipeline.mGPUPassTimer.getTime(pass));
+        }
+        LLFontGL::getFontMonospace()->renderUTF8(gpu_times,
+            0, getRect().getWidth() - MARGIN, y, LLColor4::white, LLFontGL::RIGHT, LLFontGL::TOP);
+    }
+    // </FS>
 }
 
 void LLFastTimerView::drawTicks()
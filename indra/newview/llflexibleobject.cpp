@@ -42,10 +42,17 @@
 #include "llviewerregion.h"
 #include "llworld.h"
 #include "llvoavatar.h"
+#include "threadpool.h" // <FS/> Parallel flexi updates
 
 static const F32 SEC_PER_FLEXI_FRAME = 1.f / 60.f; // 60 flexi updates per second
 /*static*/ F32 LLVolumeImplFlexible::sUpdateFactor = 1.0f;
 std::vector<LLVolumeImplFlexible*> LLVolumeImplFlexible::sInstanceList;
+// <FS> Parallel flexi updates
+std::vector<LLVolumeImplFlexible*> LLVolumeImplFlexible::sPendingList;
+
+// Fewer than this are simulated on the main thread
+static const size_t MIN_PARALLEL_FLEXIS = 4;
+// </FS>
 
 // LLFlexibleObjectData::pack/unpack now in llprimitive.cpp
 
@@ -66,6 +73,10 @@ LLVolumeImplFlexible::LLVolumeImplFlexible(LLViewerObject* vo, LLFlexibleObjectD
     mSimulateRes = 0;
     mCollisionSphereRadius = 0.f;
     mRenderRes = -1;
+    // <FS> Parallel flexi updates
+    mPending = false;
+    mSimulated = false;
+    // </FS>
 
     if(mVO->mDrawable.notNull())
     {
@@ -78,6 +89,13 @@ LLVolumeImplFlexible::LLVolumeImplFlexible(LLViewerObject* vo, LLFlexibleObjectD
 
 LLVolumeImplFlexible::~LLVolumeImplFlexible()
 {
+    // <FS> Parallel flexi updates
+    if (mPending)
+    {
+        sPendingList.erase(std::find(sPendingList.begin(), sPendingList.end(), this));
+    }
+    // </FS>
+
     S32 end_idx = static_cast<S32>(sInstanceList.size()) - 1;
 
     if (end_idx != mInstanceIndex)
@@ -109,6 +127,75 @@ void LLVolumeImplFlexible::updateClass()
     }
 }
 
+// <FS> Parallel flexi updates
+//static
+void LLVolumeImplFlexible::simulatePending()
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    static std::vector<LLVolumeImplFlexible*> batch;
+    batch.clear();
+    for (LLVolumeImplFlexible* flexi : sPendingList)
+    {
+        flexi->mPending = false;
+        if (flexi->canSimulate())
+        {
+            batch.push_back(flexi);
+        }
+    }
+    sPendingList.clear();
+
+    if (batch.empty() || !gAgent.getRegion())
+    {
+        return;
+    }
+
+    LL::ThreadPoolBase::ptr_t general_pool = LL::ThreadPoolBase::getInstance("General");
+    auto chunk = [](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            batch[i]->simulate();
+            batch[i]->mSimulated = true;
+        }
+    };
+
+    if (general_pool && batch.size() >= MIN_PARALLEL_FLEXIS)
+    {
+        general_pool->parallelFor(0, batch.size(), 0, chunk);
+    }
+    else
+    {
+        chunk(0, batch.size());
+    }
+}
+
+bool LLVolumeImplFlexible::canSimulate() const
+{
+    // Same conditions under which doFlexibleUpdate() would simulate
+    LLDrawable* drawablep = mVO->mDrawable;
+    return drawablep && !drawablep->isDead() && mInitialized && mAttributes
+        && mSimulateRes != 0 && mRenderRes >= 0 && !skipImpostorUpdate();
+}
+
+bool LLVolumeImplFlexible::skipImpostorUpdate() const
+{
+    if (!mVO->isAttachment())
+    {
+        return false;
+    }
+
+    LLViewerObject* parent = (LLViewerObject*) mVO->getParent();
+    while (parent && !parent->isAvatar())
+    {
+        parent = (LLViewerObject*) parent->getParent();
+    }
+
+    LLVOAvatar* avatar = (LLVOAvatar*) parent;
+    return avatar && avatar->isImpostor() && !avatar->needsImpostorUpdate();
+}
+// </FS>
+
 LLVector3 LLVolumeImplFlexible::getFramePosition() const
 {
     return mVO->getRenderPosition();
@@ -130,12 +217,21 @@ void LLVolumeImplFlexible::onParameterChanged(U16 param_type, LLNetworkData *dat
 
 void LLVolumeImplFlexible::onShift(const LLVector4a &shift_vector)
 {
+    // <FS> Parallel flexi updates
     //VECTORIZE THIS
-    LLVector3 shift(shift_vector.getF32ptr());
+    //LLVector3 shift(shift_vector.getF32ptr());
+    //for (int section = 0; section < (1<<FLEXIBLE_OBJECT_MAX_SECTIONS)+1; ++section)
+    //{
+    //    mSection[section].mPosition += shift;
+    //}
+    LLVector4a position;
     for (int section = 0; section < (1<<FLEXIBLE_OBJECT_MAX_SECTIONS)+1; ++section)
     {
-        mSection[section].mPosition += shift;
+        position.load3(mSection[section].mPosition.mV);
+        position.add(shift_vector);
+        mSection[section].mPosition.set(position.getF32ptr());
     }
+    // </FS>
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -364,10 +460,17 @@ void LLVolumeImplFlexible::doIdleUpdate()
                 // We control how fast flexies update, buy splitting updates among frames
                 U64 virtual_frame_num = (U64)(LLTimer::getElapsedSeconds() / SEC_PER_FLEXI_FRAME);
 
+                // <FS> Parallel flexi updates
+                static LLCachedControl<F32> min_pixel_area(gSavedSettings, "FSFlexiMinPixelArea", 256.f);
+                // </FS>
                 if  (visible)
                 {
+                    // <FS> Parallel flexi updates
+                    //if (!drawablep->isState(LLDrawable::IN_REBUILD_Q) &&
+                    //    pixel_area > 256.f)
                     if (!drawablep->isState(LLDrawable::IN_REBUILD_Q) &&
-                        pixel_area > 256.f)
+                        pixel_area > min_pixel_area)
+                    // </FS>
                     {
                         U32 id;
                         if (mVO->isRootEdit())
@@ -401,6 +504,15 @@ void LLVolumeImplFlexible::doIdleUpdate()
 
                             mVO->shrinkWrap();
                             gPipeline.markRebuild(drawablep, LLDrawable::REBUILD_POSITION);
+
+                            // <FS> Parallel flexi updates
+                            static LLCachedControl<bool> parallel_flexis(gSavedSettings, "FSParallelFlexiUpdates", true);
+                            if (parallel_flexis && !mPending)
+                            {
+                                mPending = true;
+                                sPendingList.push_back(this);
+                            }
+                            // </FS>
                         }
                     }
                 }
@@ -457,6 +569,82 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
         return;
     }
 
+    // <FS> Parallel flexi updates
+    // Already simulated on the thread pool for this rebuild
+    if (mSimulated)
+    {
+        mSimulated = false;
+    }
+    else
+    {
+        simulate();
+    }
+    S32 i;
+    // </FS>
+
+    // Create points
+    llassert(mRenderRes > -1);
+    S32 num_render_sections = 1<<mRenderRes;
+    if (path->getPathLength() != num_render_sections+1)
+    {
+        ((LLVOVolume*) mVO)->mVolumeChanged = true;
+        volume->resizePath(num_render_sections+1);
+    }
+
+    LLPath::PathPt *new_point;
+
+    LLFlexibleObjectSection newSection[ (1<<FLEXIBLE_OBJECT_MAX_SECTIONS)+1 ];
+    remapSections(mSection, mSimulateRes, newSection, mRenderRes);
+
+    //generate transform from global to prim space
+    LLVector3 delta_scale = LLVector3(1,1,1);
+    LLVector3 delta_pos;
+    LLQuaternion delta_rot;
+
+    delta_rot = ~getFrameRotation();
+    delta_pos = -getFramePosition()*delta_rot;
+
+    // Vertex transform (4x4)
+    LLVector3 x_axis = LLVector3(delta_scale.mV[VX], 0.f, 0.f) * delta_rot;
+    LLVector3 y_axis = LLVector3(0.f, delta_scale.mV[VY], 0.f) * delta_rot;
+    LLVector3 z_axis = LLVector3(0.f, 0.f, delta_scale.mV[VZ]) * delta_rot;
+
+    LLMatrix4 rel_xform;
+    rel_xform.initRows(LLVector4(x_axis, 0.f),
+                                LLVector4(y_axis, 0.f),
+                                LLVector4(z_axis, 0.f),
+                                LLVector4(delta_pos, 1.f));
+
+    LL_CHECK_MEMORY
+    for (i=0; i<=num_render_sections; ++i)
+    {
+        new_point = &path->mPath[i];
+        LLVector3 pos = newSection[i].mPosition * rel_xform;
+        LLQuaternion rot = mSection[i].mAxisRotation * newSection[i].mRotation * delta_rot;
+
+        LLVector3 np(new_point->mPos.getF32ptr());
+
+        if (!mUpdated || (np-pos).magVec()/mVO->mDrawable->mDistanceWRTCamera > 0.001f)
+        {
+            new_point->mPos.load3((newSection[i].mPosition * rel_xform).mV);
+            mUpdated = false;
+        }
+
+        new_point->mRot.loadu(LLMatrix3(rot));
+        new_point->mScale.set(newSection[i].mScale.mV[0], newSection[i].mScale.mV[1], 0,1);
+        new_point->mTexT = ((F32)i)/(num_render_sections);
+    }
+    LL_CHECK_MEMORY
+    //mLastSegmentRotation = parentSegmentRotation; // <FS/> Parallel flexi updates, set by simulate()
+}
+
+
+// <FS> Parallel flexi updates
+// Advances the sections by the time since the last step. Only touches this
+// instance, so instances can be simulated on the thread pool.
+void LLVolumeImplFlexible::simulate()
+{
+    LL_PROFILE_ZONE_SCOPED;
     S32 num_sections = 1 << mSimulateRes;
 
     F32 secondsThisFrame = mTimer.getElapsedTimeAndResetF32();
@@ -505,6 +693,14 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 
     F32 force_factor = section_length * secondsThisFrame;
 
+    // Gravity and the user force are the same for every section
+    LLVector3 external_force = mAttributes->getUserForce();
+    external_force.mV[VZ] -= mAttributes->getGravity();
+    external_force *= force_factor;
+
+    // Read only, the main thread waits for the pool while we run
+    LLWind* wind = (mAttributes->getWindSensitivity() > 0.001f) ? &gAgent.getRegion()->mWind : nullptr;
+
     // Update simulated sections
     for (i=1; i<=num_sections; ++i)
     {
@@ -517,23 +713,18 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
         //---------------------------------------------------
         lastPosition = mSection[i].mPosition;
 
-        //------------------------------------------------------------------------------------------
-        // gravity
-        //------------------------------------------------------------------------------------------
-        mSection[i].mPosition.mV[2] -= mAttributes->getGravity() * force_factor;
-
         //------------------------------------------------------------------------------------------
         // wind force
         //------------------------------------------------------------------------------------------
-        if (mAttributes->getWindSensitivity() > 0.001f)
+        if (wind)
         {
-            mSection[i].mPosition += gAgent.getRegion()->mWind.getVelocity( mSection[i].mPosition ) * wind_factor;
+            mSection[i].mPosition += wind->getVelocity( mSection[i].mPosition ) * wind_factor;
         }
 
         //------------------------------------------------------------------------------------------
-        // user-defined force
+        // gravity and user-defined force
         //------------------------------------------------------------------------------------------
-        mSection[i].mPosition += mAttributes->getUserForce() * force_factor;
+        mSection[i].mPosition += external_force;
 
         //---------------------------------------------------
         // tension (rigidity, stiffness)
@@ -637,88 +828,28 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
     // Calculate derivatives (not necessary until normals are automagically generated)
     mSection[0].mdPosition = (mSection[1].mPosition - mSection[0].mPosition) * inv_section_length;
     // i = 1..NumSections-1
+    // The quadratic derivative through three evenly spaced sections reduces
+    // to the central difference (f3 - f1) / 2L
+    LLVector4a positions[(1<<FLEXIBLE_OBJECT_MAX_SECTIONS)+1];
+    for (i=0; i<=num_sections; ++i)
+    {
+        positions[i].load3(mSection[i].mPosition.mV);
+    }
+    LLVector4a derivative;
+    const F32 half_inv_length = 0.5f * inv_section_length;
     for (i=1; i<num_sections; ++i)
     {
-        // Quadratic numerical derivative of position
-
-        // f(-L1) = aL1^2 - bL1 + c = f1
-        // f(0)   =               c = f2
-        // f(L2)  = aL2^2 + bL2 + c = f3
-        // f = ax^2 + bx + c
-        // d/dx f = 2ax + b
-        // d/dx f(0) = b
-
-        // c = f2
-        // a = [(f1-c)/L1 + (f3-c)/L2] / (L1+L2)
-        // b = (f3-c-aL2^2)/L2
-
-        LLVector3 a = (mSection[i-1].mPosition-mSection[i].mPosition +
-                    mSection[i+1].mPosition-mSection[i].mPosition) * 0.5f * inv_section_length * inv_section_length;
-        LLVector3 b = (mSection[i+1].mPosition-mSection[i].mPosition - a*(section_length*section_length));
-        b *= inv_section_length;
-
-        mSection[i].mdPosition = b;
+        derivative.setSub(positions[i+1], positions[i-1]);
+        derivative.mul(half_inv_length);
+        mSection[i].mdPosition.set(derivative.getF32ptr());
     }
 
     // i = NumSections
     mSection[i].mdPosition = (mSection[i].mPosition - mSection[i-1].mPosition) * inv_section_length;
 
-    // Create points
-    llassert(mRenderRes > -1);
-    S32 num_render_sections = 1<<mRenderRes;
-    if (path->getPathLength() != num_render_sections+1)
-    {
-        ((LLVOVolume*) mVO)->mVolumeChanged = true;
-        volume->resizePath(num_render_sections+1);
-    }
-
-    LLPath::PathPt *new_point;
-
-    LLFlexibleObjectSection newSection[ (1<<FLEXIBLE_OBJECT_MAX_SECTIONS)+1 ];
-    remapSections(mSection, mSimulateRes, newSection, mRenderRes);
-
-    //generate transform from global to prim space
-    LLVector3 delta_scale = LLVector3(1,1,1);
-    LLVector3 delta_pos;
-    LLQuaternion delta_rot;
-
-    delta_rot = ~getFrameRotation();
-    delta_pos = -getFramePosition()*delta_rot;
-
-    // Vertex transform (4x4)
-    LLVector3 x_axis = LLVector3(delta_scale.mV[VX], 0.f, 0.f) * delta_rot;
-    LLVector3 y_axis = LLVector3(0.f, delta_scale.mV[VY], 0.f) * delta_rot;
-    LLVector3 z_axis = LLVector3(0.f, 0.f, delta_scale.mV[VZ]) * delta_rot;
-
-    LLMatrix4 rel_xform;
-    rel_xform.initRows(LLVector4(x_axis, 0.f),
-                                LLVector4(y_axis, 0.f),
-                                LLVector4(z_axis, 0.f),
-                                LLVector4(delta_pos, 1.f));
-
-    LL_CHECK_MEMORY
-    for (i=0; i<=num_render_sections; ++i)
-    {
-        new_point = &path->mPath[i];
-        LLVector3 pos = newSection[i].mPosition * rel_xform;
-        LLQuaternion rot = mSection[i].mAxisRotation * newSection[i].mRotation * delta_rot;
-
-        LLVector3 np(new_point->mPos.getF32ptr());
-
-        if (!mUpdated || (np-pos).magVec()/mVO->mDrawable->mDistanceWRTCamera > 0.001f)
-        {
-            new_point->mPos.load3((newSection[i].mPosition * rel_xform).mV);
-            mUpdated = false;
-        }
-
-        new_point->mRot.loadu(LLMatrix3(rot));
-        new_point->mScale.set(newSection[i].mScale.mV[0], newSection[i].mScale.mV[1], 0,1);
-        new_point->mTexT = ((F32)i)/(num_render_sections);
-    }
-    LL_CHECK_MEMORY
     mLastSegmentRotation = parentSegmentRotation;
 }
-
+// </FS>
 
 void LLVolumeImplFlexible::preRebuild()
 {
@@ -756,24 +887,32 @@ bool LLVolumeImplFlexible::doUpdateGeometry(LLDrawable *drawable)
     LL_PROFILE_ZONE_SCOPED;
     LLVOVolume *volume = (LLVOVolume*)mVO;
 
-    if (mVO->isAttachment())
-    {   //don't update flexible attachments for impostored avatars unless the
-        //impostor is being updated this frame (w00!)
-        LLViewerObject* parent = (LLViewerObject*) mVO->getParent();
-        while (parent && !parent->isAvatar())
-        {
-            parent = (LLViewerObject*) parent->getParent();
-        }
-
-        if (parent)
-        {
-            LLVOAvatar* avatar = (LLVOAvatar*) parent;
-            if (avatar->isImpostor() && !avatar->needsImpostorUpdate())
-            {
-                return true;
-            }
-        }
+    // <FS> Parallel flexi updates
+    //if (mVO->isAttachment())
+    //{   //don't update flexible attachments for impostored avatars unless the
+    //    //impostor is being updated this frame (w00!)
+    //    LLViewerObject* parent = (LLViewerObject*) mVO->getParent();
+    //    while (parent && !parent->isAvatar())
+    //    {
+    //        parent = (LLViewerObject*) parent->getParent();
+    //    }
+    //
+    //    if (parent)
+    //    {
+    //        LLVOAvatar* avatar = (LLVOAvatar*) parent;
+    //        if (avatar->isImpostor() && !avatar->needsImpostorUpdate())
+    //        {
+    //            return true;
+    //        }
+    //    }
+    //}
+    //don't update flexible attachments for impostored avatars unless the
+    //impostor is being updated this frame (w00!)
+    if (skipImpostorUpdate())
+    {
+        return true;
     }
+    // </FS>
 
     if (volume->mDrawable.isNull() || volume->mDrawable->isDead())
     {
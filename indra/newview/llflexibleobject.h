@@ -74,8 +74,17 @@ private:
     static std::vector<LLVolumeImplFlexible*> sInstanceList;
     S32 mInstanceIndex;
 
+    // <FS> Parallel flexi updates
+    static std::vector<LLVolumeImplFlexible*> sPendingList;
+    // </FS>
+
     public:
         static void updateClass();
+        // <FS> Parallel flexi updates
+        // Simulates the instances queued for a rebuild by this frame's
+        // idle update on the General thread pool
+        static void simulatePending();
+        // </FS>
 
         LLVolumeImplFlexible(LLViewerObject* volume, LLFlexibleObjectData* attributes);
         ~LLVolumeImplFlexible();
@@ -99,6 +108,11 @@ private:
         const LLMatrix4& getWorldMatrix(LLXformMatrix* xform) const;
         void updateRelativeXform(bool force_identity);
         void doFlexibleUpdate(); // Called to update the simulation
+        // <FS> Parallel flexi updates
+        void simulate(); // Steps the sections, safe to run off the main thread
+        bool canSimulate() const;
+        bool skipImpostorUpdate() const;
+        // </FS>
         void doFlexibleRebuild(bool rebuild_volume); // Called to rebuild the geometry
         void preRebuild();
 
@@ -137,6 +151,10 @@ private:
         LLVector3                   mCollisionSpherePosition;
         F32                         mCollisionSphereRadius;
         U32                         mID;
+        // <FS> Parallel flexi updates
+        bool                        mPending; // in sPendingList
+        bool                        mSimulated; // stepped by simulatePending(), not yet written to the path
+        // </FS>
 
         //--------------------------------------
         // private methods
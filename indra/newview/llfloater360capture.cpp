@@ -29,6 +29,7 @@
 
 #include "llfloater360capture.h"
 
+#include "fs360equirect.h" // <FS/> 360 snapshot conversion
 #include "llagent.h"
 #include "llagentui.h"
 #include "llbase64.h"
@@ -36,6 +37,7 @@
 #include "llenvironment.h"
 #include "llimagejpeg.h"
 #include "llmediactrl.h"
+#include "llnotificationsutil.h" // <FS/> 360 snapshot conversion
 #include "llradiogroup.h"
 #include "llslurl.h"
 #include "lltextbox.h"
@@ -45,12 +47,20 @@
 #include "llviewercamera.h"
 #include "llviewercontrol.h"
 #include "llviewerpartsim.h"
+#include "llviewermenufile.h" // <FS/> 360 snapshot conversion
 #include "llviewerregion.h"
 #include "llviewerwindow.h"
 #include "pipeline.h"
 
 #include <iterator>
 
+// <FS> 360 snapshot conversion
+// these are the 6 directions we will point the camera - essentially,
+// North, South, East, West, Up, Down
+static const LLVector3 look_dirs[6] = { LLVector3(1, 0, 0), LLVector3(0, 1, 0), LLVector3(0, 0, 1), LLVector3(-1, 0, 0), LLVector3(0, -1, 0), LLVector3(0, 0, -1) };
+static const LLVector3 look_upvecs[6] = { LLVector3(0, 0, 1), LLVector3(0, 0, 1), LLVector3(0, -1, 0), LLVector3(0, 0, 1), LLVector3(0, 0, 1), LLVector3(0, 1, 0) };
+// </FS>
+
 LLFloater360Capture::LLFloater360Capture(const LLSD& key)
     :   LLFloater(key)
 {
@@ -476,10 +486,12 @@ void LLFloater360Capture::capture360Images()
         LLPipeline::sRenderAttachedLights = false;
     }
 
-    // these are the 6 directions we will point the camera - essentially,
-    // North, South, East, West, Up, Down
-    LLVector3 look_dirs[6] = { LLVector3(1, 0, 0), LLVector3(0, 1, 0), LLVector3(0, 0, 1), LLVector3(-1, 0, 0), LLVector3(0, -1, 0), LLVector3(0, 0, -1) };
-    LLVector3 look_upvecs[6] = { LLVector3(0, 0, 1), LLVector3(0, 0, 1), LLVector3(0, -1, 0), LLVector3(0, 0, 1), LLVector3(0, 0, 1), LLVector3(0, 1, 0) };
+    // <FS> 360 snapshot conversion - moved to file scope, the conversion needs them too
+    //// these are the 6 directions we will point the camera - essentially,
+    //// North, South, East, West, Up, Down
+    //LLVector3 look_dirs[6] = { LLVector3(1, 0, 0), LLVector3(0, 1, 0), LLVector3(0, 0, 1), LLVector3(-1, 0, 0), LLVector3(0, -1, 0), LLVector3(0, 0, -1) };
+    //LLVector3 look_upvecs[6] = { LLVector3(0, 0, 1), LLVector3(0, 0, 1), LLVector3(0, -1, 0), LLVector3(0, 0, 1), LLVector3(0, 0, 1), LLVector3(0, 1, 0) };
+    // </FS>
 
     // save current view/camera settings so we can restore them afterwards
     S32 old_occlusion = LLPipeline::sUseOcclusion;
@@ -758,6 +770,22 @@ void LLFloater360Capture::onSaveLocalBtn()
     std::string ctime_str = std::ctime(&result);
     std::string time_str = ctime_str.substr(0, ctime_str.length() - 1);
 
+    // <FS> 360 snapshot conversion
+    static LLCachedControl<bool> native_equirect(gSavedSettings, "FS360CaptureNativeEquirect", true);
+    if (native_equirect && mRawImages[0].notNull() && FS360Equirect::canConvert(mOutputImageWidth))
+    {
+        FS360Equirect::Metadata metadata;
+        metadata.mSoftware = LLVersionInfo::instance().getChannel();
+        metadata.mCaptureSoftware = client_version;
+        metadata.mDate = LLDate::now().asString();
+        metadata.mRegionName = region_name;
+        metadata.mRegionURL = region_url;
+        metadata.mHeadingDeg = mInitialHeadingDeg;
+        saveEquirect(suggested_filename, metadata);
+        return;
+    }
+    // </FS>
+
     // build the JavaScript data structure that is used to pass all the
     // variables into the JavaScript function on the web page loaded into
     // the embedded browser component of the floater.
@@ -787,6 +815,52 @@ void LLFloater360Capture::onSaveLocalBtn()
     mWebBrowser->getMediaPlugin()->executeJavaScript(cmd);
 }
 
+// <FS> 360 snapshot conversion
+// Converts the cube map images to the EQR image in the viewer rather than in
+// the embedded browser, which takes minutes and a lot of memory for the
+// larger sizes
+void LLFloater360Capture::saveEquirect(const std::string& suggested_filename, const FS360Equirect::Metadata& metadata)
+{
+    FS360Equirect::faces_t faces;
+    for (size_t i = 0; i < faces.size(); ++i)
+    {
+        faces[i] = { mRawImages[i], look_dirs[i], look_upvecs[i] };
+    }
+
+    const U32 width = mOutputImageWidth;
+    const S32 quality = (S32)gSavedSettings.getU32("360CaptureJPEGEncodeQuality");
+    LLHandle<LLFloater> handle = getHandle();
+    LLFilePickerReplyThread::startPicker(
+        [handle, faces, width, quality, metadata](const std::vector<std::string>& filenames)
+        {
+            LLFloater360Capture* floater = static_cast<LLFloater360Capture*>(handle.get());
+            if (!floater || filenames.empty())
+            {
+                return;
+            }
+
+            // the faces must stay as they are until they are uploaded
+            floater->mCaptureBtn->setEnabled(false);
+            floater->mSaveLocalBtn->setEnabled(false);
+
+            FS360Equirect::convert(faces, width, metadata, quality, filenames[0],
+                [handle](bool success)
+                {
+                    if (LLFloater360Capture* floater = static_cast<LLFloater360Capture*>(handle.get()))
+                    {
+                        floater->mCaptureBtn->setEnabled(true);
+                        floater->mSaveLocalBtn->setEnabled(true);
+                    }
+                    if (!success)
+                    {
+                        LLNotificationsUtil::add("GenericAlert", LLSD().with("MESSAGE", LLTrans::getString("360CaptureSaveFailed")));
+                    }
+                });
+        },
+        LLFilePicker::FFSAVE_JPEG, suggested_filename);
+}
+// </FS>
+
 // We capture all 6 images sequentially and if parts of the world are moving
 // E.G. clouds, water, objects - then we may get seams or discontinuities
 // when the images are combined to form the EQR image.  This code tries to
@@ -31,6 +31,7 @@
 #include "llfloater.h"
 #include "llmediactrl.h"
 #include "llcharacter.h"
+#include "fs360equirect.h" // <FS/> 360 snapshot conversion
 
 class LLImageRaw;
 class LLTextBox;
@@ -78,6 +79,7 @@ class LLFloater360Capture:
         void onCapture360ImagesBtn();
 
         void onSaveLocalBtn();
+        void saveEquirect(const std::string& suggested_filename, const FS360Equirect::Metadata& metadata); // <FS/> 360 snapshot conversion
         LLUICtrl* mSaveLocalBtn;
 
         LLRadioGroup* mQualityRadioGroup;
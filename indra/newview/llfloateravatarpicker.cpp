@@ -582,6 +582,7 @@ void LLFloaterAvatarPicker::findCoro(std::string url, LLUUID queryID, std::strin
 
     httpOpts->setTimeout(AVATAR_PICKER_SEARCH_TIMEOUT);
 
+    httpAdapter->setResponseCache("AvatarPickerSearch"); // <FS/> Conditional GET cache
     LLSD result = httpAdapter->getAndSuspend(httpRequest, url, httpOpts);
 
     LLSD httpResults = result[LLCoreHttpUtil::HttpCoroutineAdapter::HTTP_RESULTS];
@@ -34,6 +34,7 @@
 #include "llviewercontrol.h"
 #include "llappviewer.h"
 
+#include "llfilesystem.h"
 #include "lltexturefetch.h"
 
 #include "llbutton.h"
@@ -86,6 +87,9 @@ bool LLFloaterLagMeter::postBuild()
     config_string = getString("client_frame_rate_warning_fps", mStringArgs);
     mClientFrameTimeWarning = F32Seconds(1.0f / (float)atof( config_string.c_str() ));
 
+    config_string = getString("client_disk_read_latency_warning_ms", mStringArgs);
+    mClientDiskReadLatencyWarning = F32Milliseconds((float)atof( config_string.c_str() ));
+
     config_string = getString("network_packet_loss_critical_pct", mStringArgs);
     mNetworkPacketLossCritical = F32Percent((float)atof( config_string.c_str() ));
     config_string = getString("network_packet_loss_warning_pct", mStringArgs);
@@ -186,6 +190,10 @@ void LLFloaterLagMeter::determineClient()
         {
             mClientCause->setText( getString("client_draw_distance_cause_msg", mStringArgs) );
         }
+        else if (LLTrace::get_frame_recording().getPeriodMean(LLFileSystem::sCacheReadLatency) >= mClientDiskReadLatencyWarning)
+        {
+            mClientCause->setText( getString("client_disk_cache_cause_msg", mStringArgs) );
+        }
         else if(LLAppViewer::instance()->getTextureFetch()->getNumRequests() > 2)
         {
             mClientCause->setText( getString("client_texture_loading_cause_msg", mStringArgs) );
@@ -55,6 +55,7 @@ private:
 
     F32Milliseconds mClientFrameTimeCritical;
     F32Milliseconds mClientFrameTimeWarning;
+    F32Milliseconds mClientDiskReadLatencyWarning;
     LLButton*       mClientButton;
     LLTextBox*      mClientText;
     LLTextBox*      mClientCause;
@@ -4264,6 +4264,7 @@ void LLPanelEstateAccess::requestEstateGetAccessCoro(std::string url)
     LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t httpAdapter(new LLCoreHttpUtil::HttpCoroutineAdapter("requestEstateGetAccessoCoro", httpPolicy));
     LLCore::HttpRequest::ptr_t httpRequest(new LLCore::HttpRequest);
 
+    httpAdapter->setResponseCache("EstateAccess"); // <FS/> Conditional GET cache
     LLSD result = httpAdapter->getAndSuspend(httpRequest, url);
 
     LLSD httpResults = result[LLCoreHttpUtil::HttpCoroutineAdapter::HTTP_RESULTS];
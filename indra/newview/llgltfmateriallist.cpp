@@ -697,7 +697,30 @@ void LLGLTFMaterialList::flushMaterials()
         using namespace LLStatViewer;
         sample(NUM_MATERIALS, mList.size());
     }
+
+    // <FS> GLTF render material interning
+    constexpr F32 RENDER_MATERIAL_SWEEP_INTERVAL = 10.f;
+    if (mRenderMaterialSweepTimer.getElapsedTimeF32() > RENDER_MATERIAL_SWEEP_INTERVAL)
+    {
+        mRenderMaterialSweepTimer.reset();
+        boost::unordered::erase_if(mRenderMaterials, [](const auto& entry)
+        {
+            return entry.second->getNumRefs() == 1; // only referenced from here
+        });
+    }
+    // </FS>
+}
+
+// <FS> GLTF render material interning
+LLFetchedGLTFMaterial* LLGLTFMaterialList::internRenderMaterial(LLFetchedGLTFMaterial* mat)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    llassert(mat);
+
+    auto [iter, inserted] = mRenderMaterials.try_emplace(mat->getHash(), mat);
+    return iter->second;
 }
+// </FS>
 
 // static
 void LLGLTFMaterialList::modifyMaterialCoro(std::string cap_url, LLSD overrides, std::shared_ptr<CallbackHolder> callback_holder)
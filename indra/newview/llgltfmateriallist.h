@@ -31,6 +31,10 @@
 #include "llfetchedgltfmaterial.h"
 #include "llgltfmaterial.h"
 #include "llpointer.h"
+// <FS> GLTF render material interning
+#include "llframetimer.h"
+#include "lluuidflatmap.h"
+// </FS>
 
 #include <unordered_map>
 
@@ -50,6 +54,15 @@ public:
 
     void flushMaterials();
 
+    // <FS> GLTF render material interning
+    // Return the render material with the same contents (LLGLTFMaterial::getHash())
+    // as mat, registering mat if there is none yet. Interned materials are shared
+    // between faces and must not be modified afterwards.
+    LLFetchedGLTFMaterial* internRenderMaterial(LLFetchedGLTFMaterial* mat);
+
+    size_t getInternedRenderMaterialCount() const { return mRenderMaterials.size(); }
+    // </FS>
+
     // Queue an modification of a material that we want to send to the simulator.  Call "flushUpdates" to flush pending updates.
     //  id - ID of object to modify
     //  side - TexureEntry index to modify, or -1 for all sides
@@ -142,6 +155,12 @@ protected:
 
     LLUUID mLastUpdateKey;
 
+    // <FS> GLTF render material interning
+    // render materials by content hash, dropped once no face uses them
+    LLUUIDFlatMap<LLPointer<LLFetchedGLTFMaterial> > mRenderMaterials;
+    LLFrameTimer mRenderMaterialSweepTimer;
+    // </FS>
+
     struct ModifyMaterialData
     {
         LLUUID object_id;
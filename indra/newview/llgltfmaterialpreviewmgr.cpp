@@ -513,6 +513,7 @@ bool LLGLTFPreviewTexture::render()
         }
 
         gPipeline.unbindDeferredShader(shader);
+        LLEnvironment::instance().dirtyShaderUniforms(); // <FS/> Cached environment uniforms, undo fixup_shader_constants()
 
         screen.flush();
     }
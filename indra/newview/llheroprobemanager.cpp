@@ -31,6 +31,7 @@
 #include "llviewercamera.h"
 #include "llspatialpartition.h"
 #include "llviewerregion.h"
+#include "llvramaccounting.h" // <FS/> VRAM accounting
 #include "pipeline.h"
 #include "llviewershadermgr.h"
 #include "llviewercontrol.h"
@@ -62,6 +63,7 @@ static void touch_default_probe(LLReflectionMap* probe)
 
 LLHeroProbeManager::LLHeroProbeManager()
 {
+    mReuseOrigin.clear(); // <FS/> Mirror reuse
 }
 
 LLHeroProbeManager::~LLHeroProbeManager()
@@ -91,12 +93,14 @@ void LLHeroProbeManager::update()
 
     if (!mRenderTarget.isComplete())
     {
+        LLVRAMAccounting::Scope vram_scope({ LLVRAMCategory::REFLECTION_PROBE }); // <FS/> VRAM accounting
         U32 color_fmt = GL_RGBA16F;
         mRenderTarget.allocate(mProbeResolution, mProbeResolution, color_fmt, true);
     }
 
     if (mMipChain.empty())
     {
+        LLVRAMAccounting::Scope vram_scope({ LLVRAMCategory::REFLECTION_PROBE }); // <FS/> VRAM accounting
         U32 res = mProbeResolution;
         U32 count = (U32)(log2((F32)res) + 0.5f);
 
@@ -240,6 +244,7 @@ void LLHeroProbeManager::renderProbes()
         !gTeleportDisplay && !gDisconnected && !LLAppViewer::instance()->logoutRequestSent())
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_DISPLAY("hpmu - realtime");
+        FS_GPU_PASS_TIMER(gPipeline.mGPUPassTimer, FSGPUPassTimer::PASS_HERO_PROBES, "hero probes"); // <FS/> GPU pass timers
 
         bool radiance_pass = gPipeline.mReflectionMapManager.isRadiancePass();
 
@@ -260,21 +265,77 @@ void LLHeroProbeManager::renderProbes()
 
         S32 face = gFrameCount % 6;
 
-        if (!mProbes.empty() && !mProbes[0].isNull() && !mProbes[0]->mOccluded)
+        // <FS> Mirror budget
+        rate = getBudgetRate(rate);
+        // </FS>
+
+        // <FS> Mirror reuse
+        const bool is_dynamic = mNearestHero->getReflectionProbeIsDynamic() && sDetail > 0;
+        static LLCachedControl<bool> reuse(gSavedSettings, "FSMirrorReuse", true);
+        if (!reuse || mProbes.empty() || mProbes[0].isNull())
+        { // every face is due every rate frames
+            mDirtyFaces = 0x3F;
+        }
+        else
+        {
+            static LLCachedControl<F32> reuse_distance(gSavedSettings, "FSMirrorReuseDistance", 0.05f);
+            static LLCachedControl<U32> reuse_frames(gSavedSettings, "FSMirrorReuseMaxFrames", 30);
+
+            LLVector4a delta;
+            delta.setSub(mProbes[0]->mOrigin, mReuseOrigin);
+            if (mProbes[0]->mOccluded)
+            { // nothing is captured, start over once it shows
+                mReuseHero = nullptr;
+            }
+            else if (mReuseHero != mNearestHero.get() || delta.getLength3().getF32() > reuse_distance)
+            { // a new point of view, capture every face
+                mReuseOrigin = mProbes[0]->mOrigin;
+                mReuseHero = mNearestHero.get();
+                mReuseStart = gFrameCount;
+                mDirtyFaces = 0x3F;
+            }
+            else if (gFrameCount - mReuseStart >= reuse_frames)
+            { // same point of view, catch up with what changes without moving anything (sky, lighting)
+                mReuseStart = gFrameCount;
+                mDirtyFaces = 0x3F;
+            }
+            else if (is_dynamic && mDirtyFaces == 0)
+            { // avatars animate without moving, keep up a face per frame
+                mDirtyFaces = 1 << mNextFace;
+            }
+        }
+
+        //if (!mProbes.empty() && !mProbes[0].isNull() && !mProbes[0]->mOccluded)
+        if (mDirtyFaces != 0 && !mProbes.empty() && !mProbes[0].isNull() && !mProbes[0]->mOccluded)
         {
-            LL_PROFILE_ZONE_NUM(gFrameCount % rate);
+            LL_PROFILE_ZONE_NUM(mDirtyFaces);
             LL_PROFILE_ZONE_NUM(rate);
 
-            for (U32 i = 0; i < 6; ++i)
+            //for (U32 i = 0; i < 6; ++i)
+            //{
+            //    if ((gFrameCount % rate) == (i % rate))
+            //    { // update 6/rate faces per frame
+            //        LL_PROFILE_ZONE_NUM(i);
+            //        updateProbeFace(mProbes[0], i, mNearestHero->getReflectionProbeIsDynamic() && sDetail > 0, near_clip);
+            //    }
+            //}
+            // update 6/rate of the due faces per frame, round robin
+            U32 count = 6 / rate;
+            for (U32 j = 0; j < 6 && count > 0; ++j)
             {
-                if ((gFrameCount % rate) == (i % rate))
-                { // update 6/rate faces per frame
+                U32 i = (mNextFace + j) % 6;
+                if (mDirtyFaces & (1 << i))
+                {
                     LL_PROFILE_ZONE_NUM(i);
-                    updateProbeFace(mProbes[0], i, mNearestHero->getReflectionProbeIsDynamic() && sDetail > 0, near_clip);
+                    updateProbeFace(mProbes[0], i, is_dynamic, near_clip);
+                    mDirtyFaces &= ~(1 << i);
+                    mNextFace = (i + 1) % 6;
+                    --count;
                 }
             }
             generateRadiance(mProbes[0]);
         }
+        // </FS>
 
         mRenderingMirror = false;
 
@@ -285,6 +346,108 @@ void LLHeroProbeManager::renderProbes()
     }
 }
 
+// <FS> Mirror reuse
+void LLHeroProbeManager::markChanged(const LLVector4a& center, F32 radius)
+{
+    if (mDirtyFaces == 0x3F || mNearestHero.isNull() || mProbes.empty() || mProbes[0].isNull())
+    {
+        return;
+    }
+
+    LLVector4a delta;
+    delta.setSub(center, mProbes[0]->mOrigin);
+    const F32 distance = delta.getLength3().getF32();
+    if (distance <= radius)
+    {
+        mDirtyFaces = 0x3F;
+        return;
+    }
+
+    // smaller than half a texel of a face from here, it doesn't show
+    if (radius < distance * F_PI_BY_TWO / (F32)(mProbeResolution * 2))
+    {
+        return;
+    }
+
+    // Face +X sees x >= |y| and x >= |z|, the sphere reaches it when it is
+    // within radius of those planes, x - |y| >= -radius * sqrt(2) and so on
+    const F32* v = delta.getF32ptr();
+    const F32 slack = radius * F_SQRT2;
+    for (U32 axis = 0; axis < 3; ++axis)
+    {
+        const F32 side = llmax(fabsf(v[(axis + 1) % 3]), fabsf(v[(axis + 2) % 3])) - slack;
+        if (v[axis] >= side)
+        {
+            mDirtyFaces |= 1 << (axis * 2);
+        }
+        if (-v[axis] >= side)
+        {
+            mDirtyFaces |= 1 << (axis * 2 + 1);
+        }
+    }
+}
+// </FS>
+
+// <FS> Mirror budget
+S32 LLHeroProbeManager::getBudgetRate(S32 rate)
+{
+    static LLCachedControl<bool> adaptive(gSavedSettings, "FSMirrorAdaptiveRate", true);
+    static LLCachedControl<F32> budget(gSavedSettings, "FSMirrorBudgetMs", 2.f);
+
+    if (adaptive)
+    { // share of the screen the bounding sphere of the mirror covers
+        LLViewerCamera* camera = LLViewerCamera::getInstance();
+        const F32 radius = mNearestHero->getScale().magVec() * 0.5f;
+        const F32 distance = llmax(dist_vec(camera->getOrigin(), mNearestHero->getPositionAgent()), radius);
+        const F32 half_height = distance * tanf(camera->getView() * 0.5f);
+        const F32 area = F_PI * radius * radius / (4.f * half_height * half_height * camera->getAspect());
+
+        const S32 area_rate = area > 0.1f ? 1 : area > 0.03f ? 2 : area > 0.01f ? 3 : 6;
+        rate = llmax(rate, area_rate);
+    }
+
+    FSGPUPassTimer& timer = gPipeline.mGPUPassTimer;
+    timer.setRequired(FSGPUPassTimer::USER_MIRROR_BUDGET, budget > 0.f);
+    if (budget <= 0.f)
+    {
+        mBudgetRate = 1;
+        mBudgetTime = 0.f;
+        return rate;
+    }
+
+    if (timer.getFramesRead() != mBudgetFramesRead)
+    {
+        mBudgetFramesRead = timer.getFramesRead();
+        mBudgetTime = lerp(mBudgetTime, timer.getTime(FSGPUPassTimer::PASS_HERO_PROBES), 0.1f);
+
+        // The cost goes with the faces per frame, 6 / rate. The smoothed time
+        // is rescaled on every step so it isn't taken again before the
+        // new rate shows in the samples.
+        S32 next = mBudgetRate;
+        if (mBudgetTime > budget)
+        {
+            next = mBudgetRate == 1 ? 2 : mBudgetRate == 2 ? 3 : 6;
+        }
+        else if (mBudgetRate > 1)
+        {
+            S32 lower = mBudgetRate == 6 ? 3 : mBudgetRate == 3 ? 2 : 1;
+            if (mBudgetTime * (F32)mBudgetRate / (F32)lower < budget * 0.8f)
+            {
+                next = lower;
+            }
+        }
+
+        if (next != mBudgetRate)
+        {
+            mBudgetTime *= (F32)mBudgetRate / (F32)next;
+            mBudgetRate = next;
+        }
+    }
+
+    return llmax(rate, mBudgetRate);
+}
+// </FS>
+
 // Do the reflection map update render passes.
 // For every 12 calls of this function, one complete reflection probe radiance map and irradiance map is generated
 // First six passes render the scene with direct lighting only into a scratch space cube map at the end of the cube map array and generate
@@ -610,6 +773,8 @@ void LLHeroProbeManager::cleanup()
     mProbes.clear();
 
     mDefaultProbe = nullptr;
+
+    mReuseHero = nullptr; // <FS/> Mirror reuse, the capture is gone
 }
 
 void LLHeroProbeManager::doOcclusion()
@@ -87,6 +87,13 @@ public:
 
     bool isMirrorPass() const { return mRenderingMirror; }
 
+    // <FS> Mirror reuse
+    // Threads:  Tmain
+    // Something in the sphere at center is about to move or be rebuilt, the
+    // cube faces of the hero probe that see it need a new capture
+    void markChanged(const LLVector4a& center, F32 radius);
+    // </FS>
+
     LLVector3 mMirrorPosition;
     LLVector3     mMirrorNormal;
     HeroProbeData mHeroData;
@@ -144,6 +151,29 @@ private:
     std::vector<LLPointer<LLVOVolume>>                       mHeroVOList;
     LLPointer<LLVOVolume>                                 mNearestHero;
 
+    // <FS> Mirror reuse
+    // The cube map of the nearest hero is reused while the point it is
+    // captured from stays put and nothing in the scene changed. Turning the
+    // camera needs no new capture, the cube map has every direction.
+    // Changes only invalidate the faces that see them, see markChanged().
+    LLVector4a                                            mReuseOrigin;   // probe origin the capture started from
+    const LLVOVolume*                                     mReuseHero = nullptr;   // compared only
+    U32                                                   mReuseStart = 0;    // frame of the last full capture
+    U32                                                   mDirtyFaces = 0x3F; // faces due for a capture, bit per face
+    U32                                                   mNextFace = 0;      // where the search for due faces starts
+    // </FS>
+
+    // <FS> Mirror budget
+    // Mirrors covering little of the screen are updated at a lower rate and
+    // the rate is lowered further while the hero probe passes take more GPU
+    // time than FSMirrorBudgetMs.
+    S32 getBudgetRate(S32 rate);
+
+    S32                                                   mBudgetRate = 1;    // rate the GPU budget allows
+    F32                                                   mBudgetTime = 0.f;  // smoothed GPU time of the hero probes, ms
+    U32                                                   mBudgetFramesRead = 0;  // FSGPUPassTimer::getFramesRead() at the last sample
+    // </FS>
+
 
 };
 
@@ -63,6 +63,28 @@ const F32 LOD_0_SCREEN_COVERAGE = 0.15f;
 const F32 LOD_1_SCREEN_COVERAGE = 0.30f;
 const F32 LOD_2_SCREEN_COVERAGE = 0.40f;
 
+// <FS> Batched name tags
+namespace
+{
+    // Background of a tag, drawn with the others once all tags are in
+    struct TagBackground
+    {
+        LLUIImage*  mImage;
+        LLVector3   mPosition;
+        LLVector3   mXPixelVec;
+        LLVector3   mYPixelVec;
+        LLRect      mRect;
+        LLColor4    mColor;
+    };
+
+    bool sBatching = false;
+    std::vector<LLHUDNameTag*> sRenderBatch;
+    std::vector<TagBackground> sBackgrounds;
+    std::vector<TagBackground> sLabelTops;
+    LLHUDTextBatch sTextBatch;
+}
+// </FS>
+
 std::set<LLPointer<LLHUDNameTag> > LLHUDNameTag::sTextObjects;
 std::vector<LLPointer<LLHUDNameTag> > LLHUDNameTag::sVisibleTextObjects;
 bool LLHUDNameTag::sDisplayText = true ;
@@ -102,7 +124,8 @@ LLHUDNameTag::LLHUDNameTag(const U8 type)
     mTextAlignment(ALIGN_TEXT_CENTER),
     mVertAlignment(ALIGN_VERT_CENTER),
     mLOD(0),
-    mHidden(false)
+    mHidden(false),
+    mSizeDirty(true) // <FS/> Batched name tags
 {
     LLPointer<LLHUDNameTag> ptr(this);
     sTextObjects.insert(ptr);
@@ -228,11 +251,65 @@ void LLHUDNameTag::render()
     LL_PROFILE_ZONE_SCOPED_CATEGORY_UI;
     if (sDisplayText)
     {
+        // <FS> Batched name tags
+        static LLCachedControl<bool> batch_tags(gSavedSettings, "FSBatchNameTags", true);
+        if (batch_tags)
+        {
+            // Drawn by renderBatch() with the other tags
+            sRenderBatch.push_back(this);
+            return;
+        }
+        // </FS>
         LLGLDepthTest gls_depth(GL_TRUE, GL_FALSE);
         renderText();
     }
 }
 
+// <FS> Batched name tags
+//static
+void LLHUDNameTag::renderBatch()
+{
+    if (sRenderBatch.empty())
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_UI;
+    LLGLDepthTest gls_depth(GL_TRUE, GL_FALSE);
+
+    // Back to front, so that nearer tags blend over the ones behind them
+    // within each layer
+    std::sort(sRenderBatch.begin(), sRenderBatch.end(), [](const LLHUDNameTag* lhs, const LLHUDNameTag* rhs)
+    {
+        return lhs->getDistance() > rhs->getDistance();
+    });
+
+    sBatching = true;
+    for (LLHUDNameTag* tag : sRenderBatch)
+    {
+        tag->renderText();
+    }
+    sBatching = false;
+    sRenderBatch.clear();
+
+    // All backgrounds, then the label tops over them, then all the text
+    gGL.getTexUnit(0)->enable(LLTexUnit::TT_TEXTURE);
+    for (const std::vector<TagBackground>* layer : { &sBackgrounds, &sLabelTops })
+    {
+        for (const TagBackground& bg : *layer)
+        {
+            bg.mImage->draw3D(bg.mPosition, bg.mXPixelVec, bg.mYPixelVec, bg.mRect, bg.mColor);
+        }
+    }
+    sBackgrounds.clear();
+    sLabelTops.clear();
+
+    sTextBatch.render();
+
+    gGL.color4f(1.0f, 1.0f, 1.0f, 1.0f);
+}
+// </FS>
+
 void LLHUDNameTag::renderText()
 {
     if (!mVisible || mHidden)
@@ -295,7 +372,17 @@ void LLHUDNameTag::renderText()
     LLGLDepthTest gls_depth(GL_TRUE, GL_FALSE);
     LLRect screen_rect;
     screen_rect.setCenterAndSize(0, static_cast<S32>(lltrunc(-mHeight / 2 + mOffsetY)), static_cast<S32>(lltrunc(mWidth)), static_cast<S32>(lltrunc(mHeight)));
-    mRoundedRectImgp->draw3D(render_position, x_pixel_vec, y_pixel_vec, screen_rect, bg_color);
+    // <FS> Batched name tags
+    //mRoundedRectImgp->draw3D(render_position, x_pixel_vec, y_pixel_vec, screen_rect, bg_color);
+    if (sBatching)
+    {
+        sBackgrounds.push_back({ mRoundedRectImgp, render_position, x_pixel_vec, y_pixel_vec, screen_rect, bg_color });
+    }
+    else
+    {
+        mRoundedRectImgp->draw3D(render_position, x_pixel_vec, y_pixel_vec, screen_rect, bg_color);
+    }
+    // </FS>
     if (mLabelSegments.size())
     {
         LLRect label_top_rect = screen_rect;
@@ -307,7 +394,17 @@ void LLHUDNameTag::renderText()
         label_top_color.mV[VALPHA] = color_alpha;
         // </FS:Ansariel>
 
-        mRoundedRectTopImgp->draw3D(render_position, x_pixel_vec, y_pixel_vec, label_top_rect, label_top_color);
+        // <FS> Batched name tags
+        //mRoundedRectTopImgp->draw3D(render_position, x_pixel_vec, y_pixel_vec, label_top_rect, label_top_color);
+        if (sBatching)
+        {
+            sLabelTops.push_back({ mRoundedRectTopImgp, render_position, x_pixel_vec, y_pixel_vec, label_top_rect, label_top_color });
+        }
+        else
+        {
+            mRoundedRectTopImgp->draw3D(render_position, x_pixel_vec, y_pixel_vec, label_top_rect, label_top_color);
+        }
+        // </FS>
     }
 
     F32 y_offset = (F32)mOffsetY;
@@ -332,7 +429,17 @@ void LLHUDNameTag::renderText()
             }
 
             LLColor4 label_color(0.f, 0.f, 0.f, alpha_factor);
-            hud_render_text(segment_iter->getText(), render_position, *fontp, segment_iter->mStyle, LLFontGL::NO_SHADOW, x_offset, y_offset, label_color, false);
+            // <FS> Batched name tags
+            //hud_render_text(segment_iter->getText(), render_position, *fontp, segment_iter->mStyle, LLFontGL::NO_SHADOW, x_offset, y_offset, label_color, false);
+            if (sBatching)
+            {
+                sTextBatch.add(segment_iter->getText(), render_position, *fontp, segment_iter->mStyle, LLFontGL::NO_SHADOW, x_offset, y_offset, label_color);
+            }
+            else
+            {
+                hud_render_text(segment_iter->getText(), render_position, *fontp, segment_iter->mStyle, LLFontGL::NO_SHADOW, x_offset, y_offset, label_color, false);
+            }
+            // </FS>
         }
     }
 
@@ -377,7 +484,17 @@ void LLHUDNameTag::renderText()
             text_color = segment_iter->mColor;
             text_color.mV[VALPHA] *= alpha_factor;
 
-            hud_render_text(segment_iter->getText(), render_position, *fontp, style, shadow, x_offset, y_offset, text_color, false);
+            // <FS> Batched name tags
+            //hud_render_text(segment_iter->getText(), render_position, *fontp, style, shadow, x_offset, y_offset, text_color, false);
+            if (sBatching)
+            {
+                sTextBatch.add(segment_iter->getText(), render_position, *fontp, style, shadow, x_offset, y_offset, text_color);
+            }
+            else
+            {
+                hud_render_text(segment_iter->getText(), render_position, *fontp, style, shadow, x_offset, y_offset, text_color, false);
+            }
+            // </FS>
         }
     }
     /// Reset the default color to white.  The renderer expects this to be the default.
@@ -387,12 +504,14 @@ void LLHUDNameTag::renderText()
 void LLHUDNameTag::setString(const std::string &text_utf8)
 {
     mTextSegments.clear();
+    mSizeDirty = true; // <FS/> Batched name tags
     addLine(text_utf8, mColor);
 }
 
 void LLHUDNameTag::clearString()
 {
     mTextSegments.clear();
+    mSizeDirty = true; // <FS/> Batched name tags
 }
 
 
@@ -406,6 +525,8 @@ void LLHUDNameTag::addLine(const std::string &text_utf8,
     LLWString wline = utf8str_to_wstring(text_utf8);
     if (!wline.empty())
     {
+        mSizeDirty = true; // <FS/> Batched name tags
+
         // use default font for segment if custom font not specified
         if (!font)
         {
@@ -472,6 +593,7 @@ void LLHUDNameTag::addLine(const std::string &text_utf8,
 void LLHUDNameTag::setLabel(const std::string &label_utf8)
 {
     mLabelSegments.clear();
+    mSizeDirty = true; // <FS/> Batched name tags
     addLabel(label_utf8);
 }
 
@@ -480,6 +602,8 @@ void LLHUDNameTag::addLabel(const std::string& label_utf8, F32 max_pixels)
     LLWString wstr = utf8string_to_wstring(label_utf8);
     if (!wstr.empty())
     {
+        mSizeDirty = true; // <FS/> Batched name tags
+
         LLWString seps(utf8str_to_wstring("\r\n"));
         LLWString empty;
 
@@ -516,6 +640,7 @@ void LLHUDNameTag::setZCompare(const bool zcompare)
 void LLHUDNameTag::setFont(const LLFontGL* font)
 {
     mFontp = font;
+    mSizeDirty = true; // <FS/> Batched name tags
 }
 
 
@@ -667,6 +792,15 @@ LLVector2 LLHUDNameTag::updateScreenPos(LLVector2 &offset)
 
 void LLHUDNameTag::updateSize()
 {
+    // <FS> Batched name tags
+    // Only lay the tag out again when its content, fonts or LOD changed
+    if (!mSizeDirty)
+    {
+        return;
+    }
+    mSizeDirty = false;
+    // </FS>
+
     F32 height = 0.f;
     F32 width = 0.f;
 
@@ -840,6 +974,12 @@ void LLHUDNameTag::updateAll()
 
 void LLHUDNameTag::setLOD(S32 lod)
 {
+    // <FS> Batched name tags
+    if (mLOD != lod)
+    {
+        mSizeDirty = true;
+    }
+    // </FS>
     mLOD = lod;
     //RN: uncomment this to visualize LOD levels
     //std::string label = llformat("%d", lod);
@@ -912,6 +1052,7 @@ void LLHUDNameTag::reshape()
     for (text_it = sTextObjects.begin(); text_it != sTextObjects.end(); ++text_it)
     {
         LLHUDNameTag* textp = (*text_it);
+        textp->mSizeDirty = true; // <FS/> Batched name tags
         std::vector<LLHUDTextSegment>::iterator segment_iter;
         for (segment_iter = textp->mTextSegments.begin();
              segment_iter != textp->mTextSegments.end(); ++segment_iter )
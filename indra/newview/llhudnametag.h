@@ -117,7 +117,10 @@ public:
     void setVisibleOffScreen(bool visible) { mVisibleOffScreen = visible; }
 
     // mMaxLines of -1 means unlimited lines.
-    void setMaxLines(S32 max_lines) { mMaxLines = max_lines; }
+    // <FS> Batched name tags
+    //void setMaxLines(S32 max_lines) { mMaxLines = max_lines; }
+    void setMaxLines(S32 max_lines) { mSizeDirty |= (mMaxLines != max_lines); mMaxLines = max_lines; }
+    // </FS>
     void setFadeDistance(F32 fade_distance, F32 fade_range) { mFadeDistance = fade_distance; mFadeRange = fade_range; }
     void updateVisibility();
     LLVector2 updateScreenPos(LLVector2 &offset_target);
@@ -147,6 +150,10 @@ protected:
 
     /*virtual*/ void render();
     void renderText();
+    // <FS> Batched name tags
+    // Draws the tags render() queued this frame, called by LLHUDObject::renderAll()
+    static void renderBatch();
+    // </FS>
     static void updateAll();
     void setLOD(S32 lod);
     S32 getMaxLines();
@@ -182,6 +189,7 @@ private:
     EVertAlignment  mVertAlignment;
     S32             mLOD;
     bool            mHidden;
+    bool            mSizeDirty; // <FS/> Batched name tags, updateSize() has work to do
     LLPointer<LLUIImage> mRoundedRectImgp;
     LLPointer<LLUIImage> mRoundedRectTopImgp;
 
@@ -313,6 +313,8 @@ void LLHUDObject::renderAll()
         }
     }
 
+    LLHUDNameTag::renderBatch(); // <FS/> Batched name tags
+
     LLVertexBuffer::unbind();
     gUIProgram.unbind();
 }
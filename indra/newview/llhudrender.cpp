@@ -134,3 +134,96 @@ void hud_render_text(const LLWString &wstr, const LLVector3 &pos_agent,
     gGL.popMatrix();
     gGL.matrixMode(LLRender::MM_MODELVIEW);
 }
+
+// <FS> Batched name tags
+void LLHUDTextBatch::add(const LLWString& wstr,
+                         const LLVector3& pos_agent,
+                         const LLFontGL& font,
+                         const U8 style,
+                         const LLFontGL::ShadowType shadow,
+                         const F32 x_offset,
+                         const F32 y_offset,
+                         const LLColor4& color)
+{
+    if (!wstr.empty())
+    {
+        mStrings.push_back({ &wstr, pos_agent, &font, style, shadow, x_offset, y_offset, color });
+    }
+}
+
+void LLHUDTextBatch::render()
+{
+    if (mStrings.empty())
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_UI;
+
+    std::stable_sort(mStrings.begin(), mStrings.end(), [](const String& a, const String& b) { return a.mFont < b.mFont; });
+
+    LLViewerCamera* camera = LLViewerCamera::getInstance();
+    LLRect world_view_rect = gViewerWindow->getWorldViewRectRaw();
+    glm::ivec4 viewport(world_view_rect.mLeft, world_view_rect.mBottom, world_view_rect.getWidth(), world_view_rect.getHeight());
+    const glm::mat4 modelview = get_current_modelview();
+    const glm::mat4 projection = get_current_projection();
+
+    // Same state as hud_render_text(), set up once for all strings
+    gGL.matrixMode(LLRender::MM_PROJECTION);
+    gGL.pushMatrix();
+    gGL.matrixMode(LLRender::MM_MODELVIEW);
+    gGL.pushMatrix();
+    LLUI::pushMatrix();
+
+    gl_state_for_2d(world_view_rect.getWidth(), world_view_rect.getHeight());
+    gViewerWindow->setup3DViewport();
+    gGL.loadIdentity();
+
+    // The modelview stays the identity, the depth of each string goes into
+    // its vertices so that translating to it doesn't flush
+    LLFontGL::sDepthInVertices = true;
+
+    LLVector3 axes_pos;
+    LLVector3 right_axis;
+    LLVector3 up_axis;
+    bool have_axes = false;
+    for (const String& str : mStrings)
+    {
+        // Do cheap plane culling
+        if ((str.mPosAgent - camera->getOrigin()) * camera->getAtAxis() <= 0.f)
+        {
+            continue;
+        }
+
+        // The lines of a tag share their position
+        if (!have_axes || str.mPosAgent != axes_pos)
+        {
+            camera->getPixelVectors(str.mPosAgent, up_axis, right_axis);
+            axes_pos = str.mPosAgent;
+            have_axes = true;
+        }
+
+        LLVector3 render_pos = str.mPosAgent + (floorf(str.mXOffset) * right_axis) + (floorf(str.mYOffset) * up_axis);
+        glm::vec3 win_coord = glm::project(glm::make_vec3(render_pos.mV), modelview, projection, viewport);
+        win_coord.x -= world_view_rect.mLeft;
+        win_coord.y -= world_view_rect.mBottom;
+
+        LLUI::loadIdentity();
+        LLUI::translate((F32) win_coord.x*1.0f/LLFontGL::sScaleX, (F32) win_coord.y*1.0f/(LLFontGL::sScaleY), -(((F32) win_coord.z*2.f)-1.f));
+        F32 right_x;
+        str.mFont->render(*str.mText, 0, 0, 1, str.mColor, LLFontGL::LEFT, LLFontGL::BASELINE, str.mStyle, str.mShadow,
+                          static_cast<S32>(str.mText->length()), 1000, &right_x, /*use_ellipses*/false, /*use_color*/true);
+    }
+
+    LLFontGL::sDepthInVertices = false;
+
+    LLUI::popMatrix();
+    gGL.popMatrix();
+
+    gGL.matrixMode(LLRender::MM_PROJECTION);
+    gGL.popMatrix();
+    gGL.matrixMode(LLRender::MM_MODELVIEW);
+
+    mStrings.clear();
+}
+// </FS>
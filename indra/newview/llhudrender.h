@@ -29,6 +29,8 @@
 
 #include "llfontgl.h"
 #include "llfontvertexbuffer.h"
+#include "v3math.h" // <FS/> Batched name tags
+#include "v4color.h" // <FS/> Batched name tags
 
 class LLVector3;
 class LLFontGL;
@@ -55,6 +57,43 @@ void hud_render_utf8text(const std::string &str,
                          const LLColor4& color,
                          const bool orthographic);
 
+// <FS> Batched name tags
+// Collects strings like hud_render_text() draws them and draws them all in
+// one 2D pass. They are grouped by font, so the strings on a glyph page
+// share a draw, and keep the order they were added in within a font.
+class LLHUDTextBatch
+{
+public:
+    // The text is referenced, it has to outlive render()
+    void add(const LLWString& wstr,
+             const LLVector3& pos_agent,
+             const LLFontGL& font,
+             const U8 style,
+             const LLFontGL::ShadowType shadow,
+             const F32 x_offset,
+             const F32 y_offset,
+             const LLColor4& color);
+
+    // Draws and forgets the strings added so far
+    void render();
+
+    bool empty() const { return mStrings.empty(); }
+
+private:
+    struct String
+    {
+        const LLWString*        mText;
+        LLVector3               mPosAgent;
+        const LLFontGL*         mFont;
+        U8                      mStyle;
+        LLFontGL::ShadowType    mShadow;
+        F32                     mXOffset;
+        F32                     mYOffset;
+        LLColor4                mColor;
+    };
+    std::vector<String> mStrings;
+};
+// </FS>
 
 #endif //LL_LLHUDRENDER_H
 
@@ -92,6 +92,10 @@ LLInventoryFilter::LLInventoryFilter(const Params& p)
     mFirstRequiredGeneration(0),
     mFirstSuccessGeneration(0),
     mSearchType(SEARCHTYPE_NAME),
+    // <FS> Indexed inventory search
+    mSearchCandidatesValid(false),
+    mHasSearchCandidates(false),
+    // </FS>
     mSingleFolderMode(false)
 {
     // copy mFilterOps into mDefaultFilterOps
@@ -111,7 +115,19 @@ bool LLInventoryFilter::check(const LLFolderViewModelItem* item)
         return true;
     }
 
-    std::string desc = listener->getSearchableCreatorName();
+    // <FS> Indexed inventory search
+    // Names without a label suffix that lack a trigram of the filter
+    // string can't contain it
+    if (mSearchType == SEARCHTYPE_NAME && mExactToken.empty() && mFilterTokens.empty() && updateSearchCandidates()
+        && gInventory.getSearchIndex().canReject(listener->getUUID(), listener->getSearchableName(), mSearchCandidates))
+    {
+        return false;
+    }
+
+    // Every case below sets it, no need for a name cache lookup up front
+    //std::string desc = listener->getSearchableCreatorName();
+    std::string desc;
+    // </FS>
     switch (mSearchType)
     {
         case SEARCHTYPE_CREATOR:
@@ -322,6 +338,25 @@ bool LLInventoryFilter::checkFolder(const LLUUID& folder_id) const
     return true;
 }
 
+// <FS> Indexed inventory search
+bool LLInventoryFilter::updateSearchCandidates()
+{
+    static LLCachedControl<bool> use_index(gSavedSettings, "FSIndexedInventorySearch", true);
+    if (!use_index)
+    {
+        return false;
+    }
+
+    FSInventorySearchIndex& index = gInventory.getSearchIndex();
+    if (!mSearchCandidatesValid || (mHasSearchCandidates && mSearchCandidates.mRevision != index.getRevision()))
+    {
+        mSearchCandidatesValid = true;
+        mHasSearchCandidates = index.query(mFilterSubString, mSearchCandidates);
+    }
+    return mHasSearchCandidates;
+}
+// </FS>
+
 bool LLInventoryFilter::checkAgainstFilterSubString(const std::string& desc) const
 {
     if (mFilterSubString.empty())
@@ -1093,6 +1128,7 @@ void LLInventoryFilter::setFilterSubString(const std::string& string)
             && !filter_sub_string_new.substr(0, mFilterSubString.size()).compare(mFilterSubString);
 
         mFilterSubString = filter_sub_string_new;
+        mSearchCandidatesValid = false; // <FS/> Indexed inventory search
         if (exact_token_changed)
         {
             setModified(FILTER_RESTART);
@@ -30,6 +30,7 @@
 #include "llinventorytype.h"
 #include "llpermissionsflags.h"
 #include "llfolderviewmodel.h"
+#include "fsinventorysearchindex.h" // <FS/> Indexed inventory search
 
 class LLFolderViewItem;
 class LLFolderViewFolder;
@@ -373,6 +374,7 @@ private:
     bool                checkAgainstCreator(const class LLFolderViewModelItemInventory* listener) const;
     bool                checkAgainstSearchVisibility(const class LLFolderViewModelItemInventory* listener) const;
     bool                checkAgainstClipboard(const LLUUID& object_id) const;
+    bool                updateSearchCandidates(); // <FS/> Indexed inventory search
 
     FilterOps               mFilterOps;
     FilterOps               mDefaultFilterOps;
@@ -403,6 +405,13 @@ private:
     std::vector<std::string> mFilterTokens;
     std::string              mExactToken;
 
+    // <FS> Indexed inventory search
+    // Names of gInventory that can contain mFilterSubString
+    FSInventorySearchIndex::Candidates mSearchCandidates;
+    bool                     mSearchCandidatesValid;
+    bool                     mHasSearchCandidates;
+    // </FS>
+
     bool mSingleFolderMode;
 };
 
@@ -363,9 +363,40 @@ void LLInventoryGallery::draw()
         {
             handleModifiedFilter();
         }
+        releaseOffscreenThumbnails(); // <FS/> Release off-screen gallery thumbnails
     }
 }
 
+// <FS> Release off-screen gallery thumbnails
+// Tiles only load their thumbnail when drawn, so on a large folder the
+// textures pile up while scrolling. Drop those that are more than a page
+// out of view; the texture list frees them once nothing else uses them.
+void LLInventoryGallery::releaseOffscreenThumbnails()
+{
+    static LLCachedControl<bool> release_thumbnails(gSavedSettings, "FSReleaseOffscreenGalleryThumbnails", true);
+    if (!release_thumbnails || !mScrollPanel || mThumbnailReleaseTimer.getElapsedTimeF32() < 1.f)
+    {
+        return;
+    }
+    mThumbnailReleaseTimer.reset();
+
+    LLRect keep_rect = mScrollPanel->getVisibleContentRect();
+    keep_rect.stretch(0, keep_rect.getHeight());
+    for (LLInventoryGalleryItem* item : mItems)
+    {
+        LLRect item_rect;
+        if (item->localRectToOtherView(item->getLocalRect(), &item_rect, mScrollPanel) && !item_rect.overlaps(keep_rect))
+        {
+            item->releaseThumbnail();
+        }
+    }
+    for (LLInventoryGalleryItem* item : mHiddenItems)
+    {
+        item->releaseThumbnail();
+    }
+}
+// </FS>
+
 void LLInventoryGallery::onVisibilityChange(bool new_visibility)
 {
     if (new_visibility)
@@ -2873,6 +2904,13 @@ void LLInventoryGalleryItem::setLoadImmediately(bool val)
     mThumbnailCtrl->setInitImmediately(val);
 }
 
+// <FS> Release off-screen gallery thumbnails
+void LLInventoryGalleryItem::releaseThumbnail()
+{
+    mThumbnailCtrl->releaseTexture();
+}
+// </FS>
+
 void LLInventoryGalleryItem::draw()
 {
     if (isFadeItem())
@@ -226,6 +226,7 @@ private:
     void reArrangeRows(S32 row_diff = 0);
     bool updateRowsIfNeeded();
     void updateGalleryWidth();
+    void releaseOffscreenThumbnails(); // <FS/> Release off-screen gallery thumbnails
 
     LLInventoryGalleryItem* buildGalleryItem(std::string name, LLUUID item_id, LLAssetType::EType type, LLUUID thumbnail_id, LLInventoryType::EType inventory_type, U32 flags, time_t creation_date, bool is_link, bool is_worn);
     LLInventoryGalleryItem* getItem(const LLUUID& id) const;
@@ -251,6 +252,7 @@ private:
     bool mGalleryCreated;
     bool mLoadThumbnailsImmediately;
     bool mNeedsArrange;
+    LLFrameTimer mThumbnailReleaseTimer; // <FS/> Release off-screen gallery thumbnails
 
     /* Params */
     int mRowPanelHeight;
@@ -347,6 +349,7 @@ public:
     void setThumbnail(LLUUID id);
     void setGallery(LLInventoryGallery* gallery) { mGallery = gallery; }
     void setLoadImmediately(bool val);
+    void releaseThumbnail(); // <FS/> Release off-screen gallery thumbnails
     bool isFolder() { return mIsFolder; }
     bool isLink() { return mIsLink; }
     EInventorySortGroup getSortGroup() { return mSortGroup; }
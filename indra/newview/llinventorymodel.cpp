@@ -75,6 +75,14 @@
 #include "llviewerobjectlist.h"
 #include "llviewerobject.h"
 #include "llgesturemgr.h"
+// <FS> Binary inventory cache
+#include "llmemorystream.h"
+#ifdef LL_USESYSTEMLIBS
+#include <zlib.h>
+#else
+#include "zlib-ng/zlib.h"
+#endif
+// </FS>
 // </FS:TT>
 
 //#define DIFF_INVENTORY_FILES
@@ -83,10 +91,12 @@
 #endif
 
 #include <algorithm>
+#include <mutex> // <FS/> Startup pipeline
 #include <boost/algorithm/string/join.hpp>
 
 #include "aoengine.h"
 #include "fsfloaterwearablefavorites.h"
+#include "fsinventorysearchindex.h"
 #include "fslslbridge.h"
 #ifdef OPENSIM
 #include "llviewernetwork.h"
@@ -106,6 +116,12 @@ S32 LLInventoryModel::sPendingSystemFolders = 0;
 //bool decompress_file(const char* src_filename, const char* dst_filename);
 static const char PRODUCTION_CACHE_FORMAT_STRING[] = "%s.inv.llsd";
 static const char GRID_CACHE_FORMAT_STRING[] = "%s.%s.inv.llsd";
+static const char BINARY_CACHE_EXTENSION[] = ".bin"; // <FS/> Binary inventory cache
+// <FS> Startup pipeline
+// Binary caches read ahead by the startup pipeline, by file name
+static std::mutex sCachePrefetchMutex;
+static std::map<std::string, std::vector<U8> > sCachePrefetches;
+// </FS>
 static const char * const LOG_INV("Inventory");
 
 struct InventoryIDPtrLess
@@ -458,6 +474,7 @@ LLInventoryModel::LLInventoryModel()
     mParentChildItemTree(),
     mLastItem(NULL),
     mIsNotifyObservers(false),
+    mSearchIndex(std::make_unique<FSInventorySearchIndex>(this)), // <FS/> Indexed inventory search
     mModifyMask(LLInventoryObserver::ALL),
     mChangedItemIDs(),
     mBulkFecthCallbackSlot(),
@@ -1836,7 +1853,10 @@ void LLInventoryModel::moveObject(const LLUUID& object_id, const LLUUID& cat_id)
         return;
     }
 
-    if((object_id == cat_id) || !is_in_map(mCategoryMap, cat_id))
+    // <FS> Flat hash maps for the inventory indices
+    //if((object_id == cat_id) || !is_in_map(mCategoryMap, cat_id))
+    if((object_id == cat_id) || !mCategoryMap.contains(cat_id))
+    // </FS>
     {
         LL_WARNS(LOG_INV) << "Could not move inventory object " << object_id << " to "
                           << cat_id << LL_ENDL;
@@ -2321,6 +2341,7 @@ void LLInventoryModel::notifyObservers(const LLUUID& transaction_id)
 // [SL:KB] - Patch: UI-Notifications | Checked: Catznip-6.5
     mTransactionId = transaction_id;
 // [/SL:KB]
+    mSearchIndex->onChanged(mModifyMask, mChangedItemIDs); // <FS/> Indexed inventory search
     for (observer_list_t::iterator iter = mObservers.begin();
          iter != mObservers.end(); )
     {
@@ -2467,6 +2488,45 @@ bool LLInventoryModel::fetchDescendentsOf(const LLUUID& folder_id) const
 }
 
 //static
+// <FS> Startup pipeline
+// static
+std::function<void()> LLInventoryModel::getCachePrefetch(const LLUUID& owner_id)
+{
+    const std::string delete_cache_marker = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, owner_id.asString() + "_DELETE_INV_GZ");
+    if (owner_id.isNull() || LLFile::isfile(delete_cache_marker))
+    {
+        return []() {};
+    }
+
+    const std::string filename = getInvCacheAddres(owner_id) + BINARY_CACHE_EXTENSION;
+    return [filename]()
+    {
+        LL_PROFILE_ZONE_NAMED("inventory cache prefetch");
+        llifstream file(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            return;
+        }
+        std::vector<U8> buffer(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(buffer.data()), buffer.size()))
+        {
+            // loadFromBinaryFile() reads it again and reports it
+            return;
+        }
+        std::lock_guard<std::mutex> lock(sCachePrefetchMutex);
+        sCachePrefetches[filename].swap(buffer);
+    };
+}
+
+// static
+void LLInventoryModel::clearCachePrefetches()
+{
+    std::lock_guard<std::mutex> lock(sCachePrefetchMutex);
+    sCachePrefetches.clear();
+}
+// </FS>
+
 std::string LLInventoryModel::getInvCacheAddres(const LLUUID& owner_id)
 {
     std::string inventory_addr;
@@ -2515,6 +2575,29 @@ void LLInventoryModel::cache(
         items,
         INCLUDE_TRASH,
         can_cache);
+    // <FS> Binary inventory cache
+    std::string binary_filename = getInvCacheAddres(agent_id) + BINARY_CACHE_EXTENSION;
+    static LLCachedControl<bool> binary_cache(gSavedSettings, "FSBinaryInventoryCache");
+    if (binary_cache)
+    {
+        std::string temp_binary_file = binary_filename + ".tmp";
+        if (saveToBinaryFile(temp_binary_file, categories, items))
+        {
+            LLFile::remove(binary_filename, ENOENT);
+            if (LLFile::rename(temp_binary_file, binary_filename) == 0)
+            {
+                // Drop the text cache so it cannot go stale behind our back
+                LLFile::remove(getInvCacheAddres(agent_id) + ".gz", ENOENT);
+                return;
+            }
+        }
+        LLFile::remove(temp_binary_file, ENOENT);
+        LL_WARNS(LOG_INV) << "Unable to write " << binary_filename << ", falling back to the text cache" << LL_ENDL;
+    }
+    // The binary file takes precedence at load time, so it must go
+    LLFile::remove(binary_filename, ENOENT);
+    // </FS>
+
     // Use temporary file to avoid potential conflicts with other
     // instances (even a 'read only' instance unzips into a file)
     std::string temp_file = gDirUtilp->getTempFilename();
@@ -2703,6 +2786,7 @@ void LLInventoryModel::empty()
     mCategoryMap.clear(); // remove all references (should delete entries)
     mItemMap.clear(); // remove all references (should delete entries)
     mLastItem = NULL;
+    mSearchIndex->clear(); // <FS/> Indexed inventory search
     //mInventory.clear();
 }
 
@@ -2845,6 +2929,15 @@ bool LLInventoryModel::loadSkeleton(
             LLFile::remove(inventory_filename);
         }
 
+        // <FS> Binary inventory cache
+        std::string binary_filename = inventory_filename + BINARY_CACHE_EXTENSION;
+        if (LLFile::isfile(binary_filename))
+        {
+            LL_INFOS("LLInventoryModel") << "Purging inventory cache file: " << binary_filename << LL_ENDL;
+            LLFile::remove(binary_filename);
+        }
+        // </FS>
+
         inventory_filename.append(".gz");
         if (LLFile::isfile(inventory_filename))
         {
@@ -2864,6 +2957,15 @@ bool LLInventoryModel::loadSkeleton(
             LLFile::remove(inventory_filename);
         }
 
+        // <FS> Binary inventory cache
+        binary_filename = inventory_filename + BINARY_CACHE_EXTENSION;
+        if (LLFile::isfile(binary_filename))
+        {
+            LL_INFOS("LLInventoryModel") << "Purging library cache file: " << binary_filename << LL_ENDL;
+            LLFile::remove(binary_filename);
+        }
+        // </FS>
+
         inventory_filename.append(".gz");
         if (LLFile::isfile(inventory_filename))
         {
@@ -2932,7 +3034,12 @@ bool LLInventoryModel::loadSkeleton(
         const S32 NO_VERSION = LLViewerInventoryCategory::VERSION_UNKNOWN;
         std::string gzip_filename(inventory_filename);
         gzip_filename.append(".gz");
-        LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+        // <FS> Binary inventory cache
+        //LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+        const std::string binary_filename(inventory_filename + BINARY_CACHE_EXTENSION);
+        const bool use_binary_cache = LLFile::isfile(binary_filename);
+        LLFILE* fp = use_binary_cache ? NULL : LLFile::fopen(gzip_filename, "rb");
+        // </FS>
         bool remove_inventory_file = false;
         if (LLAppViewer::instance()->isSecondInstance())
         {
@@ -2962,7 +3069,31 @@ bool LLInventoryModel::loadSkeleton(
             }
         }
         bool is_cache_obsolete = false;
-        if (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+        // <FS> Binary inventory cache
+        //if (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+        bool cache_loaded = false;
+        if (use_binary_cache)
+        {
+            // Only decode the items of folders the skeleton did not change;
+            // the loop below throws the others away anyway.
+            std::unordered_map<LLUUID, S32> skeleton_versions;
+            for (const auto& cat : temp_cats)
+            {
+                skeleton_versions[cat->getUUID()] = cat->getVersion();
+            }
+            auto load_items = [&skeleton_versions](const LLUUID& cat_id, S32 version)
+            {
+                auto it = skeleton_versions.find(cat_id);
+                return it != skeleton_versions.end() && it->second == version;
+            };
+            cache_loaded = loadFromBinaryFile(binary_filename, load_items, categories, items, categories_to_update, is_cache_obsolete);
+        }
+        else
+        {
+            cache_loaded = loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete);
+        }
+        if (cache_loaded)
+        // </FS>
         {
             // We were able to find a cache of files. So, use what we
             // found to generate a set of categories we should add. We
@@ -3156,6 +3287,7 @@ bool LLInventoryModel::loadSkeleton(
             // If out of date, remove the gzipped file too.
             LL_WARNS(LOG_INV) << "Inv cache out of date, removing" << LL_ENDL;
             LLFile::remove(gzip_filename);
+            LLFile::remove(binary_filename, ENOENT); // <FS/> Binary inventory cache
         }
         categories.clear(); // will unref and delete entries
     }
@@ -3776,6 +3908,302 @@ bool LLInventoryModel::saveToFile(const std::string& filename,
     return true;
 }
 
+// <FS> Binary inventory cache
+namespace
+{
+    // Layout of the binary cache, integers in host byte order since the
+    // file never leaves the machine that wrote it:
+    //   InvCacheHeader
+    //   InvCacheIndexEntry, one per category
+    //   per category its exportLLSD() record as binary LLSD, followed by
+    //   the zlib compressed binary LLSD array of its items
+    // The index lets the loader skip the items of folders it is going to
+    // throw away without inflating or parsing them.
+    const char INV_CACHE_MAGIC[8] = { 'F', 'S', 'I', 'N', 'V', 'B', 'I', 'N' };
+
+    struct InvCacheHeader
+    {
+        char    mMagic[8];
+        S32     mVersion;
+        U32     mCategoryCount;
+    };
+
+    struct InvCacheIndexEntry
+    {
+        U8      mCategoryID[UUID_BYTES];
+        S32     mVersion;
+        U32     mItemCount;
+        U64     mOffset;        // of the category record
+        U32     mCategorySize;
+        U32     mItemsSize;     // compressed, right after the category record
+        U32     mItemsRawSize;
+        U32     mReserved;
+    };
+    static_assert(sizeof(InvCacheIndexEntry) == 48, "InvCacheIndexEntry must not change size");
+
+    bool parse_binary_llsd(LLSD& data, const U8* buffer, size_t size)
+    {
+        LLMemoryStream stream(buffer, narrow<size_t>(size));
+        return LLSDSerialize::fromBinary(data, stream, size) > 0;
+    }
+}
+
+// static
+bool LLInventoryModel::loadFromBinaryFile(const std::string& filename,
+                                          const std::function<bool(const LLUUID&, S32)>& load_items,
+                                          cat_array_t& categories,
+                                          item_array_t& items,
+                                          changed_items_t& cats_to_update,
+                                          bool& is_cache_obsolete)
+{
+    LL_PROFILE_ZONE_NAMED("inventory load from binary file");
+
+    LL_INFOS(LOG_INV) << "loading inventory from: (" << filename << ")" << LL_ENDL;
+
+    // One read for the whole file; records are decoded in place
+    std::vector<U8> buffer;
+    // <FS> Startup pipeline
+    bool prefetched = false;
+    {
+        std::lock_guard<std::mutex> lock(sCachePrefetchMutex);
+        auto it = sCachePrefetches.find(filename);
+        if (it != sCachePrefetches.end())
+        {
+            buffer.swap(it->second);
+            sCachePrefetches.erase(it);
+            prefetched = true;
+        }
+    }
+    if (!prefetched)
+    // </FS>
+    {
+        llifstream file(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            LL_INFOS(LOG_INV) << "unable to load inventory from: " << filename << LL_ENDL;
+            return false;
+        }
+        buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(buffer.data()), buffer.size()))
+        {
+            LL_WARNS(LOG_INV) << "Reading inventory cache failed" << LL_ENDL;
+            return false;
+        }
+    }
+
+    is_cache_obsolete = true; // Obsolete until proven current
+
+    InvCacheHeader header;
+    if (buffer.size() < sizeof(header))
+    {
+        LL_WARNS(LOG_INV) << "Inventory cache is truncated" << LL_ENDL;
+        return false;
+    }
+    memcpy(&header, buffer.data(), sizeof(header));
+    if (memcmp(header.mMagic, INV_CACHE_MAGIC, sizeof(INV_CACHE_MAGIC)) || header.mVersion != sCurrentInvCacheVersion)
+    {
+        LL_WARNS(LOG_INV) << "Inventory cache is out of date" << LL_ENDL;
+        return false;
+    }
+    is_cache_obsolete = false;
+
+    const size_t index_size = size_t(header.mCategoryCount) * sizeof(InvCacheIndexEntry);
+    if (buffer.size() - sizeof(header) < index_size)
+    {
+        LL_WARNS(LOG_INV) << "Inventory cache is truncated" << LL_ENDL;
+        return false;
+    }
+
+    std::vector<U8> inflated;
+    S32 items_loaded = 0;
+    const U8* index = buffer.data() + sizeof(header);
+    for (U32 i = 0; i < header.mCategoryCount; ++i)
+    {
+        InvCacheIndexEntry entry;
+        memcpy(&entry, index + i * sizeof(entry), sizeof(entry));
+        if (entry.mOffset > buffer.size() ||
+            buffer.size() - entry.mOffset < U64(entry.mCategorySize) + entry.mItemsSize)
+        {
+            LL_WARNS(LOG_INV) << "Inventory cache is corrupt" << LL_ENDL;
+            return false;
+        }
+
+        const U8* record = buffer.data() + entry.mOffset;
+        LLSD s_cat;
+        if (!parse_binary_llsd(s_cat, record, entry.mCategorySize))
+        {
+            LL_WARNS(LOG_INV) << "Parsing inventory cache failed" << LL_ENDL;
+            continue;
+        }
+        LLPointer<LLViewerInventoryCategory> inv_cat = new LLViewerInventoryCategory(LLUUID::null);
+        if (!inv_cat->importLLSD(s_cat))
+        {
+            continue;
+        }
+        categories.push_back(inv_cat);
+
+        LLUUID cat_id;
+        memcpy(cat_id.mData, entry.mCategoryID, UUID_BYTES);
+        if (!entry.mItemCount || !load_items(cat_id, entry.mVersion))
+        {
+            continue;
+        }
+
+        inflated.resize(entry.mItemsRawSize);
+        uLongf inflated_size = entry.mItemsRawSize;
+        LLSD s_items;
+        if (uncompress(inflated.data(), &inflated_size, record + entry.mCategorySize, entry.mItemsSize) != Z_OK ||
+            !parse_binary_llsd(s_items, inflated.data(), inflated_size))
+        {
+            LL_WARNS(LOG_INV) << "Parsing inventory cache failed for folder " << cat_id << LL_ENDL;
+            continue;
+        }
+
+        for (const LLSD& s_item : llsd::inArray(s_items))
+        {
+            LLPointer<LLViewerInventoryItem> inv_item = new LLViewerInventoryItem;
+            if (!inv_item->fromLLSD(s_item))
+            {
+                continue;
+            }
+            if (inv_item->getUUID().isNull())
+            {
+                LL_DEBUGS(LOG_INV) << "Ignoring inventory with null item id: "
+                    << inv_item->getName() << LL_ENDL;
+            }
+            else if (inv_item->getType() == LLAssetType::AT_UNKNOWN)
+            {
+                cats_to_update.insert(inv_item->getParentUUID());
+            }
+            else
+            {
+                items.push_back(inv_item);
+                ++items_loaded;
+            }
+        }
+    }
+
+    LL_INFOS(LOG_INV) << "Decoded " << items_loaded << " items in " << header.mCategoryCount << " categories." << LL_ENDL;
+    return true;
+}
+
+// static
+bool LLInventoryModel::saveToBinaryFile(const std::string& filename,
+                                        const cat_array_t& categories,
+                                        const item_array_t& items)
+{
+    LL_PROFILE_ZONE_NAMED("inventory save to binary file");
+
+    LL_INFOS(LOG_INV) << "saving inventory to: (" << filename << ")" << LL_ENDL;
+
+    std::unordered_map<LLUUID, std::vector<LLViewerInventoryItem*>> items_by_parent;
+    for (const auto& item : items)
+    {
+        items_by_parent[item->getParentUUID()].push_back(item.get());
+    }
+
+    try
+    {
+        // Items of folders that are not written would be dropped at load
+        // time anyway, as their parent comes back without a version
+        std::vector<InvCacheIndexEntry> index;
+        std::vector<std::string> records;
+        index.reserve(categories.size());
+        records.reserve(categories.size());
+        size_t item_count = 0;
+        for (const auto& cat : categories)
+        {
+            if (cat->getVersion() == LLViewerInventoryCategory::VERSION_UNKNOWN)
+            {
+                continue;
+            }
+
+            InvCacheIndexEntry entry = {};
+            memcpy(entry.mCategoryID, cat->getUUID().mData, UUID_BYTES);
+            entry.mVersion = cat->getVersion();
+
+            std::ostringstream record;
+            LLSDSerialize::toBinary(cat->exportLLSD(), record);
+            std::string data(record.str());
+            entry.mCategorySize = narrow<size_t>(data.size());
+
+            auto children = items_by_parent.find(cat->getUUID());
+            if (children != items_by_parent.end())
+            {
+                LLSD s_items = LLSD::emptyArray();
+                for (LLViewerInventoryItem* item : children->second)
+                {
+                    s_items.append(item->asLLSD());
+                }
+                std::ostringstream raw_stream;
+                LLSDSerialize::toBinary(s_items, raw_stream);
+                const std::string raw(raw_stream.str());
+
+                // Favour speed, this runs while the viewer shuts down
+                uLongf compressed_size = compressBound(narrow<size_t>(raw.size()));
+                std::string compressed(compressed_size, '\0');
+                if (compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressed_size,
+                              reinterpret_cast<const Bytef*>(raw.data()), narrow<size_t>(raw.size()), Z_BEST_SPEED) != Z_OK)
+                {
+                    LL_WARNS(LOG_INV) << "Failed to compress folder " << cat->getUUID() << ". Unable to save inventory to: " << filename << LL_ENDL;
+                    return false;
+                }
+                entry.mItemCount = narrow<size_t>(children->second.size());
+                entry.mItemsRawSize = narrow<size_t>(raw.size());
+                entry.mItemsSize = narrow<uLongf>(compressed_size);
+                data.append(compressed, 0, compressed_size);
+                item_count += children->second.size();
+            }
+
+            index.push_back(entry);
+            records.push_back(std::move(data));
+        }
+
+        InvCacheHeader header;
+        memcpy(header.mMagic, INV_CACHE_MAGIC, sizeof(INV_CACHE_MAGIC));
+        header.mVersion = sCurrentInvCacheVersion;
+        header.mCategoryCount = narrow<size_t>(index.size());
+
+        U64 offset = sizeof(header) + index.size() * sizeof(InvCacheIndexEntry);
+        for (size_t i = 0; i < index.size(); ++i)
+        {
+            index[i].mOffset = offset;
+            offset += records[i].size();
+        }
+
+        llofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            LL_WARNS(LOG_INV) << "Failed to open file. Unable to save inventory to: " << filename << LL_ENDL;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(InvCacheIndexEntry));
+        for (const std::string& record : records)
+        {
+            file.write(record.data(), record.size());
+        }
+        file.close();
+        if (file.fail())
+        {
+            LL_WARNS(LOG_INV) << "Failed to write inventory to: " << filename << LL_ENDL;
+            return false;
+        }
+
+        LL_INFOS(LOG_INV) << "Inventory saved: " << index.size() << " categories, " << item_count << " items." << LL_ENDL;
+    }
+    catch (...)
+    {
+        LOG_UNHANDLED_EXCEPTION("");
+        LL_INFOS(LOG_INV) << "Failed to save inventory to: (" << filename << ")" << LL_ENDL;
+        return false;
+    }
+
+    return true;
+}
+// </FS>
+
 // message handling functionality
 // static
 void LLInventoryModel::registerCallbacks(LLMessageSystem* msg)
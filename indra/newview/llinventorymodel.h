@@ -31,6 +31,7 @@
 #include <set>
 #include <string>
 #include <vector>
+#include <boost/unordered/unordered_flat_map.hpp> // <FS/> Flat hash maps for the inventory indices
 
 #include "llassettype.h"
 #include "llfoldertype.h"
@@ -53,6 +54,7 @@
 
 class LLInventoryObserver;
 class LLInventoryObject;
+class FSInventorySearchIndex; // <FS/> Indexed inventory search
 class LLInventoryItem;
 class LLInventoryCategory;
 class LLMessageSystem;
@@ -205,6 +207,16 @@ public:
 
     static std::string getInvCacheAddres(const LLUUID& owner_id);
 
+    // <FS> Startup pipeline
+    // Reads the binary cache of owner_id ahead of loadSkeleton(), which
+    // takes what was read instead of reading the file. The returned work is
+    // safe to run on any thread; it does nothing when there is no binary
+    // cache or the cache is about to be purged.
+    static std::function<void()> getCachePrefetch(const LLUUID& owner_id);
+    // Drops caches that were read ahead and not used
+    static void clearCachePrefetches();
+    // </FS>
+
     // Call on logout to save a terse representation.
     void cache(const LLUUID& parent_folder_id, const LLUUID& agent_id);
 private:
@@ -213,13 +225,23 @@ private:
     // the inventory using several different identifiers.
     // mInventory member data is the 'master' list of inventory, and
     // mCategoryMap and mItemMap store uuid->object mappings.
-    typedef std::map<LLUUID, LLPointer<LLViewerInventoryCategory> > cat_map_t;
-    typedef std::map<LLUUID, LLPointer<LLViewerInventoryItem> > item_map_t;
+    // <FS> Flat hash maps for the inventory indices
+    // Open addressing keeps lookups to one or two cache lines. Iteration
+    // order is unspecified and iterators don't survive an insertion.
+    //typedef std::map<LLUUID, LLPointer<LLViewerInventoryCategory> > cat_map_t;
+    //typedef std::map<LLUUID, LLPointer<LLViewerInventoryItem> > item_map_t;
+    typedef boost::unordered_flat_map<LLUUID, LLPointer<LLViewerInventoryCategory> > cat_map_t;
+    typedef boost::unordered_flat_map<LLUUID, LLPointer<LLViewerInventoryItem> > item_map_t;
+    // </FS>
     cat_map_t mCategoryMap;
     item_map_t mItemMap;
     // This last set of indices is used to map parents to children.
-    typedef std::map<LLUUID, cat_array_t*> parent_cat_map_t;
-    typedef std::map<LLUUID, item_array_t*> parent_item_map_t;
+    // <FS> Flat hash maps for the inventory indices
+    //typedef std::map<LLUUID, cat_array_t*> parent_cat_map_t;
+    //typedef std::map<LLUUID, item_array_t*> parent_item_map_t;
+    typedef boost::unordered_flat_map<LLUUID, cat_array_t*> parent_cat_map_t;
+    typedef boost::unordered_flat_map<LLUUID, item_array_t*> parent_item_map_t;
+    // </FS>
     parent_cat_map_t mParentChildCategoryTree;
     parent_item_map_t mParentChildItemTree;
 
@@ -625,6 +647,10 @@ public:
 
     const changed_items_t& getChangedIDs() const { return mChangedItemIDs; }
     const changed_items_t& getAddedIDs() const { return mAddedItemIDs; }
+    // <FS> Indexed inventory search
+    // Updated ahead of the observers on every notify
+    FSInventorySearchIndex& getSearchIndex() { return *mSearchIndex; }
+    // </FS>
 // [SL:KB] - Patch: UI-Notifications | Checked: Catznip-6.5
     const LLUUID& getTransactionId() const { return mTransactionId; }
 // [/SL:KB]
@@ -635,6 +661,7 @@ private:
     // Flag set when notifyObservers is being called, to look for bugs
     // where it's called recursively.
     bool mIsNotifyObservers;
+    std::unique_ptr<FSInventorySearchIndex> mSearchIndex; // <FS/> Indexed inventory search
     // Variables used to track what has changed since the last notify.
     U32 mModifyMask;
     changed_items_t mChangedItemIDs;
@@ -729,6 +756,20 @@ protected:
     static bool saveToFile(const std::string& filename,
                            const cat_array_t& categories,
                            const item_array_t& items);
+    // <FS> Binary inventory cache
+    // Same contents as the text cache, with a per-folder index; the items
+    // of a folder are only decoded when load_items(folder id, version)
+    // returns true.
+    static bool loadFromBinaryFile(const std::string& filename,
+                                   const std::function<bool(const LLUUID&, S32)>& load_items,
+                                   cat_array_t& categories,
+                                   item_array_t& items,
+                                   changed_items_t& cats_to_update,
+                                   bool& is_cache_obsolete);
+    static bool saveToBinaryFile(const std::string& filename,
+                                 const cat_array_t& categories,
+                                 const item_array_t& items);
+    // </FS>
 
     //--------------------------------------------------------------------
     // Message handling functionality
@@ -181,6 +181,17 @@ private:
 
 const S32 MAX_FETCH_RETRIES = 10; // <FS:ND/> For legacy inventory
 
+// <FS> Adaptive AIS fetch
+// Background requests in flight never drop below this
+const F32 AIS_FETCH_MIN_LIMIT = 2.f;
+// Top limit is 'as many as you can put into url'
+const F32 AIS_BATCH_MAX = 40.f;
+// Subset requests answering faster than this get bigger batches
+const F64 AIS_BATCH_TARGET_SECONDS = 2.0;
+// Responses this much slower than the fastest one mean AIS is queueing
+const F64 AIS_QUEUEING_FACTOR = 3.0;
+// </FS>
+
 const char* const LOG_INV("Inventory");
 
 } // end of namespace anonymous
@@ -200,6 +211,12 @@ LLInventoryModelBackgroundFetch::LLInventoryModelBackgroundFetch():
     mRecursiveInventoryFetchStarted(false),
     mRecursiveLibraryFetchStarted(false),
     mRecursiveMarketplaceFetchStarted(false),
+    // <FS> Adaptive AIS fetch
+    mAISFetchLimit(0.f),
+    mAISBatchSize(0.f),
+    mAISMinLatency(0.0),
+    mAISLatency(0.0),
+    // </FS>
     mMinTimeBetweenFetches(0.3f)
 {}
 
@@ -904,6 +921,22 @@ void LLInventoryModelBackgroundFetch::bulkFetchViaAis()
         return;
     }
 
+    // <FS> Adaptive AIS fetch
+    // The background crawl stays within the adaptive window, folders and
+    // items somebody asked for may use the whole pool
+    static LLCachedControl<bool> adaptive_fetch(gSavedSettings, "FSAdaptiveAISFetch");
+    if (mAISFetchLimit <= 0.f)
+    {
+        mAISFetchLimit = (F32)max_concurrent_fetches;
+    }
+    mAISFetchLimit = llclamp(mAISFetchLimit, llmin(AIS_FETCH_MIN_LIMIT, (F32)max_concurrent_fetches), (F32)max_concurrent_fetches);
+    const U32 background_fetches = adaptive_fetch ? (U32)mAISFetchLimit : max_concurrent_fetches;
+    auto can_start = [&](const FetchQueueInfo& fetch_info)
+    {
+        return (U32)mFetchCount < (isPriorityFetch(fetch_info) ? max_concurrent_fetches : background_fetches);
+    };
+    // </FS>
+
     // Don't loop for too long (in case of large, fully loaded inventory)
     F64 curent_time = LLTimer::getTotalSeconds();
     const F64 max_time = LLStartUp::getStartupState() > STATE_WEARABLES_WAIT
@@ -912,7 +945,10 @@ void LLInventoryModelBackgroundFetch::bulkFetchViaAis()
     const F64 end_time = curent_time + max_time;
     S32 last_fetch_count = mFetchCount;
 
-    while (!mFetchFolderQueue.empty() && (U32)mFetchCount < max_concurrent_fetches && curent_time < end_time)
+    // <FS> Adaptive AIS fetch
+    //while (!mFetchFolderQueue.empty() && (U32)mFetchCount < max_concurrent_fetches && curent_time < end_time)
+    while (!mFetchFolderQueue.empty() && can_start(mFetchFolderQueue.front()) && curent_time < end_time)
+    // </FS>
     {
         const FetchQueueInfo& fetch_info(mFetchFolderQueue.front());
         bulkFetchViaAis(fetch_info);
@@ -923,7 +959,10 @@ void LLInventoryModelBackgroundFetch::bulkFetchViaAis()
     // Ideally we shouldn't fetch items if recursive fetch isn't done,
     // but there is a chance some request will start timeouting and recursive
     // fetch will get stuck on a single folder, don't block item fetch in such case
-    while (!mFetchItemQueue.empty() && (U32)mFetchCount < max_concurrent_fetches && curent_time < end_time)
+    // <FS> Adaptive AIS fetch
+    //while (!mFetchItemQueue.empty() && (U32)mFetchCount < max_concurrent_fetches && curent_time < end_time)
+    while (!mFetchItemQueue.empty() && can_start(mFetchItemQueue.front()) && curent_time < end_time)
+    // </FS>
     {
         const FetchQueueInfo& fetch_info(mFetchItemQueue.front());
         bulkFetchViaAis(fetch_info);
@@ -1032,7 +1071,15 @@ void LLInventoryModelBackgroundFetch::bulkFetchViaAis(const FetchQueueInfo& fetc
 
                     // Top limit is 'as many as you can put into url'
                     static LLCachedControl<S32> ais_batch(gSavedSettings, "BatchSizeAIS3", 20);
-                    S32 batch_limit = llclamp(ais_batch(), 1, 40);
+                    // <FS> Adaptive AIS fetch, BatchSizeAIS3 is the starting point
+                    //S32 batch_limit = llclamp(ais_batch(), 1, 40);
+                    static LLCachedControl<bool> adaptive_fetch(gSavedSettings, "FSAdaptiveAISFetch");
+                    if (mAISBatchSize <= 0.f)
+                    {
+                        mAISBatchSize = (F32)llclamp(ais_batch(), 1, (S32)AIS_BATCH_MAX);
+                    }
+                    S32 batch_limit = adaptive_fetch ? (S32)mAISBatchSize : llclamp(ais_batch(), 1, 40);
+                    // </FS>
 
                     for (LLInventoryModel::cat_array_t::iterator it = categories->begin();
                          it != categories->end();
@@ -1069,10 +1116,18 @@ void LLInventoryModelBackgroundFetch::bulkFetchViaAis(const FetchQueueInfo& fetc
 
                         EFetchType type = fetch_info.mFetchType;
                         LLUUID cat_id = cat->getUUID(); // need a copy for lambda
-                        AISAPI::completion_t cb = [cat_id, children, type](const LLUUID& response_id)
+                        // <FS> Adaptive AIS fetch
+                        //AISAPI::completion_t cb = [cat_id, children, type](const LLUUID& response_id)
+                        //{
+                        //    LLInventoryModelBackgroundFetch::instance().onAISContentCalback(cat_id, children, response_id, type);
+                        //};
+                        F64 start_time = LLTimer::getTotalSeconds();
+                        AISAPI::completion_t cb = [cat_id, children, type, start_time](const LLUUID& response_id)
                         {
+                            LLInventoryModelBackgroundFetch::instance().onAISFetchResponse(start_time, response_id.notNull(), true);
                             LLInventoryModelBackgroundFetch::instance().onAISContentCalback(cat_id, children, response_id, type);
                         };
+                        // </FS>
 
                         AISAPI::ITEM_TYPE item_type = AISAPI::INVENTORY;
                         if (ALEXANDRIA_LINDEN_ID == cat->getOwnerID())
@@ -1123,10 +1178,18 @@ void LLInventoryModelBackgroundFetch::bulkFetchViaAis(const FetchQueueInfo& fetc
 
                         EFetchType type = fetch_info.mFetchType;
                         LLUUID cat_cb_id = cat_id;
-                        AISAPI::completion_t cb = [cat_cb_id, type](const LLUUID& response_id)
+                        // <FS> Adaptive AIS fetch
+                        //AISAPI::completion_t cb = [cat_cb_id, type](const LLUUID& response_id)
+                        //{
+                        //    LLInventoryModelBackgroundFetch::instance().onAISFolderCalback(cat_cb_id, response_id , type);
+                        //};
+                        F64 start_time = LLTimer::getTotalSeconds();
+                        AISAPI::completion_t cb = [cat_cb_id, type, start_time](const LLUUID& response_id)
                         {
+                            LLInventoryModelBackgroundFetch::instance().onAISFetchResponse(start_time, response_id.notNull(), false);
                             LLInventoryModelBackgroundFetch::instance().onAISFolderCalback(cat_cb_id, response_id , type);
                         };
+                        // </FS>
 
                         AISAPI::ITEM_TYPE item_type = AISAPI::INVENTORY;
                         if (ALEXANDRIA_LINDEN_ID == cat->getOwnerID())
@@ -1134,7 +1197,11 @@ void LLInventoryModelBackgroundFetch::bulkFetchViaAis(const FetchQueueInfo& fetc
                             item_type = AISAPI::LIBRARY;
                         }
 
-                        AISAPI::FetchCategoryChildren(cat_id , item_type , type == FT_RECURSIVE , cb, 0);
+                        // <FS> Adaptive AIS fetch
+                        //AISAPI::FetchCategoryChildren(cat_id , item_type , type == FT_RECURSIVE , cb, 0);
+                        AISAPI::FetchCategoryChildren(cat_id , item_type , type == FT_RECURSIVE , cb, 0,
+                                                      isPriorityFetch(fetch_info) ? LLCoprocedureManager::PRIORITY_NORMAL : LLCoprocedureManager::PRIORITY_LOW);
+                        // </FS>
                     }
                 }
                 else
@@ -1167,21 +1234,31 @@ void LLInventoryModelBackgroundFetch::bulkFetchViaAis(const FetchQueueInfo& fetc
             if (!itemp->isFinished() || fetch_info.mFetchType == FT_FORCED)
             {
                 mFetchCount++;
-                if (itemp->getPermissions().getOwner() == gAgent.getID())
-                {
-                    AISAPI::FetchItem(fetch_info.mUUID, AISAPI::INVENTORY, ais_simple_item_callback);
-                }
-                else
-                {
-                    AISAPI::FetchItem(fetch_info.mUUID, AISAPI::LIBRARY, ais_simple_item_callback);
-                }
+                // <FS> Adaptive AIS fetch
+                //if (itemp->getPermissions().getOwner() == gAgent.getID())
+                //{
+                //    AISAPI::FetchItem(fetch_info.mUUID, AISAPI::INVENTORY, ais_simple_item_callback);
+                //}
+                //else
+                //{
+                //    AISAPI::FetchItem(fetch_info.mUUID, AISAPI::LIBRARY, ais_simple_item_callback);
+                //}
+                AISAPI::FetchItem(fetch_info.mUUID,
+                                  itemp->getPermissions().getOwner() == gAgent.getID() ? AISAPI::INVENTORY : AISAPI::LIBRARY,
+                                  ais_simple_item_callback,
+                                  isPriorityFetch(fetch_info) ? LLCoprocedureManager::PRIORITY_NORMAL : LLCoprocedureManager::PRIORITY_LOW);
+                // </FS>
             }
         }
         else // We don't know it, assume incomplete
         {
             // Assume agent's inventory, library wouldn't have gotten here
             mFetchCount++;
-            AISAPI::FetchItem(fetch_info.mUUID, AISAPI::INVENTORY, ais_simple_item_callback);
+            // <FS> Adaptive AIS fetch
+            //AISAPI::FetchItem(fetch_info.mUUID, AISAPI::INVENTORY, ais_simple_item_callback);
+            AISAPI::FetchItem(fetch_info.mUUID, AISAPI::INVENTORY, ais_simple_item_callback,
+                              isPriorityFetch(fetch_info) ? LLCoprocedureManager::PRIORITY_NORMAL : LLCoprocedureManager::PRIORITY_LOW);
+            // </FS>
         }
     }
 
@@ -1191,6 +1268,64 @@ void LLInventoryModelBackgroundFetch::bulkFetchViaAis(const FetchQueueInfo& fetc
     }
 }
 
+// <FS> Adaptive AIS fetch
+// static
+bool LLInventoryModelBackgroundFetch::isPriorityFetch(const FetchQueueInfo& fetch_info)
+{
+    // Folders opened in the UI and single objects asked for by id; the
+    // recursive types come from the background crawl
+    return fetch_info.mFetchType == FT_DEFAULT || fetch_info.mFetchType == FT_FORCED;
+}
+
+void LLInventoryModelBackgroundFetch::onAISFetchResponse(F64 start_time, bool success, bool is_batch)
+{
+    static LLCachedControl<bool> adaptive_fetch(gSavedSettings, "FSAdaptiveAISFetch");
+    if (!adaptive_fetch || mAISFetchLimit <= 0.f)
+    {
+        return;
+    }
+
+    if (!success)
+    {
+        // Failures are mostly 503s and timeouts from an overloaded AIS
+        mAISFetchLimit = llmax(AIS_FETCH_MIN_LIMIT, mAISFetchLimit * 0.5f);
+        if (is_batch)
+        {
+            mAISBatchSize = llmax(1.f, mAISBatchSize * 0.5f);
+        }
+        LL_DEBUGS(LOG_INV, "AIS3") << "Fetch failed, window " << mAISFetchLimit << ", batch " << mAISBatchSize << LL_ENDL;
+        return;
+    }
+
+    const F64 latency = llmax(LLTimer::getTotalSeconds() - start_time, 0.001);
+    mAISMinLatency = mAISMinLatency > 0.0 ? llmin(mAISMinLatency, latency) : latency;
+    mAISLatency = mAISLatency > 0.0 ? mAISLatency * 0.8 + latency * 0.2 : latency;
+
+    if (mAISLatency > mAISMinLatency * AIS_QUEUEING_FACTOR && mAISLatency > AIS_BATCH_TARGET_SECONDS * 0.5)
+    {
+        // Requests queue up server side, more of them would not help
+        mAISFetchLimit = llmax(AIS_FETCH_MIN_LIMIT, mAISFetchLimit * 0.9f);
+    }
+    else
+    {
+        // Additive increase, about one request per full window
+        mAISFetchLimit += 1.f / llmax(mAISFetchLimit, 1.f);
+    }
+
+    if (is_batch)
+    {
+        if (latency < AIS_BATCH_TARGET_SECONDS)
+        {
+            mAISBatchSize = llmin(AIS_BATCH_MAX, mAISBatchSize + 1.f);
+        }
+        else if (latency > AIS_BATCH_TARGET_SECONDS * 2.0)
+        {
+            mAISBatchSize = llmax(1.f, mAISBatchSize * 0.75f);
+        }
+    }
+}
+// </FS>
+
 // Bundle up a bunch of requests to send all at once.
 void LLInventoryModelBackgroundFetch::bulkFetch()
 {
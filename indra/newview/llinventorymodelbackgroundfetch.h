@@ -112,6 +112,12 @@ protected:
     void onAISFolderCalback(const LLUUID& request_id, const LLUUID& response_id, EFetchType fetch_type);
     void bulkFetchViaAis();
     void bulkFetchViaAis(const FetchQueueInfo& fetch_info);
+    // <FS> Adaptive AIS fetch
+    // Feeds the response time of a fetch into the background window and
+    // batch size; failures (throttling, timeouts) shrink both.
+    void onAISFetchResponse(F64 start_time, bool success, bool is_batch);
+    static bool isPriorityFetch(const FetchQueueInfo& fetch_info);
+    // </FS>
     void bulkFetch();
 
     void backgroundFetch();
@@ -133,6 +139,13 @@ private:
     S32 mLastFetchCount; // for debug
     S32 mFetchFolderCount;
 
+    // <FS> Adaptive AIS fetch
+    F32 mAISFetchLimit;     // background requests in flight
+    F32 mAISBatchSize;      // folders per subset request
+    F64 mAISMinLatency;     // fastest response seen, seconds
+    F64 mAISLatency;        // smoothed response time, seconds
+    // </FS>
+
     LLFrameTimer mFetchTimer;
     F32 mMinTimeBetweenFetches;
     fetch_queue_t mFetchFolderQueue;
@@ -38,6 +38,7 @@
 // <FS:CR> Firectorm communications UI
 //#include "llfloaterimsessiontab.h"
 #include "fsfloaterim.h"
+#include "fschatlogwriter.h" // <FS/> Background transcript writing
 // </FS:CR>
 #include "llinstantmessage.h"
 #include "llsingleton.h" // for LLSingleton
@@ -356,6 +357,11 @@ void LLLogChat::renameLogFile(const std::string& old_filename, const std::string
     new_name += '.' + LL_TRANSCRIPT_FILE_EXTENSION;
     old_name += '.' + LL_TRANSCRIPT_FILE_EXTENSION;
 
+    // <FS> Background transcript writing
+    FSChatLogWriter::flush(new_name);
+    FSChatLogWriter::flush(old_name);
+    // </FS>
+
     if (!LLFile::isfile(new_name) && LLFile::isfile(old_name))
     {
         LLFile::rename(old_name, new_name);
@@ -438,12 +444,14 @@ void LLLogChat::saveHistory(const std::string& filename,
         return;
     }
 
-    llofstream file(LLLogChat::makeLogFileName(filename).c_str(), std::ios_base::app);
-    if (!file.is_open())
-    {
-        LL_WARNS() << "Couldn't open chat history log! - " + filename << LL_ENDL;
-        return;
-    }
+    // <FS> Background transcript writing
+    //llofstream file(LLLogChat::makeLogFileName(filename).c_str(), std::ios_base::app);
+    //if (!file.is_open())
+    //{
+    //    LL_WARNS() << "Couldn't open chat history log! - " + filename << LL_ENDL;
+    //    return;
+    //}
+    // </FS>
 
     LLSD item;
 
@@ -463,9 +471,14 @@ void LLLogChat::saveHistory(const std::string& filename,
         item["from"] = from;
     }
 
-    file << LLChatLogFormatter(item) << std::endl;
-
-    file.close();
+    // <FS> Background transcript writing
+    //file << LLChatLogFormatter(item) << std::endl;
+    //
+    //file.close();
+    std::ostringstream line;
+    line << LLChatLogFormatter(item) << '\n';
+    FSChatLogWriter::getInstance()->append(LLLogChat::makeLogFileName(filename), line.str());
+    // </FS>
 
     LLLogChat::getInstance()->triggerHistorySignal();
 }
@@ -485,6 +498,7 @@ void LLLogChat::loadChatHistory(const std::string& file_name, std::list<LLSD>& m
     llstat stat_data;
 
     std::string log_file_name = LLLogChat::makeLogFileName(file_name);
+    FSChatLogWriter::flush(log_file_name); // <FS/> Background transcript writing
     LL_DEBUGS("ChatHistory") << "First attempt to stat chat history file " << log_file_name << LL_ENDL;
 
     S32 no_stat = LLFile::stat(log_file_name, &stat_data);
@@ -733,6 +747,7 @@ std::string LLLogChat::oldLogFileName(std::string filename)
 
 bool LLLogChat::transcriptFilesExist()
 {
+    FSChatLogWriter::flushAll(); // <FS/> Background transcript writing
     std::string pattern = "*." + LL_TRANSCRIPT_FILE_EXTENSION;
     // get Users log directory
     std::string dirname = gDirUtilp->getPerAccountChatLogsDir();
@@ -755,6 +770,7 @@ bool LLLogChat::transcriptFilesExist()
 // static
 void LLLogChat::findTranscriptFiles(std::string pattern, std::vector<std::string>& list_of_transcriptions)
 {
+    FSChatLogWriter::flushAll(); // <FS/> Background transcript writing
     // get Users log directory
     std::string dirname = gDirUtilp->getPerAccountChatLogsDir();
 
@@ -805,6 +821,7 @@ bool LLLogChat::moveTranscripts(const std::string originDirectory,
                                 std::vector<std::string>& listOfFilesToMove,
                                 std::vector<std::string>& listOfFilesMoved)
 {
+    FSChatLogWriter::flushAll(); // <FS/> Background transcript writing
     std::string newFullPath;
     bool movedAllTranscripts = true;
     std::string backupFileName;
@@ -967,6 +984,7 @@ bool LLLogChat::isAdHocTranscriptExist(std::string file_name)
 // static
 bool LLLogChat::isTranscriptFileFound(std::string fullname)
 {
+    FSChatLogWriter::flush(fullname); // <FS/> Background transcript writing
     bool result = false;
     LLFILE * filep = LLFile::fopen(fullname, "rb");
     if (NULL != filep)
@@ -871,6 +871,7 @@ void LLMarketplaceData::getSLMListingsCoro(LLUUID folderId)
 
     std::string url = getSLMConnectURL("/listings");
 
+    httpAdapter->setResponseCache("SLMListings"); // <FS/> Conditional GET cache
     LLSD result = httpAdapter->getJsonAndSuspend(httpRequest, url, httpHeaders);
 
     setUpdating(folderId, false);
@@ -39,6 +39,10 @@
 #include "llhttpsdhandler.h"
 #include "httpcommon.h"
 #include "llcorehttputil.h"
+// <FS> Persistent material cache
+#include "lldir.h"
+#include "llviewercontrol.h"
+// </FS>
 
 /**
  * Materials cap parameters
@@ -61,6 +65,10 @@
 #define MATERIALS_POST_TIMEOUT                    (60.f * 5)
 #define MATERIALS_PUT_THROTTLE_SECS               1.f
 #define MATERIALS_PUT_MAX_ENTRIES                 50
+// <FS> Persistent material cache
+#define MATERIALS_CACHE_FILE                      "materials.cache"
+#define MATERIALS_CACHE_VERSION                   1
+// </FS>
 
 
 
@@ -143,6 +151,7 @@ LLMaterialMgr::LLMaterialMgr():
     mHttpPolicy = app_core_http.getPolicy(LLAppCoreHttp::AP_MATERIALS);
 
     mMaterials.insert(std::pair<LLMaterialID, LLMaterialPtr>(LLMaterialID::null, LLMaterialPtr(NULL)));
+    loadCache(); // <FS/> Persistent material cache
     gIdleCallbacks.addFunction(&LLMaterialMgr::onIdle, NULL);
     LLWorld::instance().setRegionRemovedCallback(boost::bind(&LLMaterialMgr::onRegionRemoved, this, _1));
 }
@@ -169,13 +178,148 @@ void LLMaterialMgr::markGetPending(const LLUUID& region_id, const LLMaterialID&
     {
         itPending->second = LLFrameTimer::getTotalSeconds();
     }
+    mGetPendingAnyRegion[material_id] = LLFrameTimer::getTotalSeconds(); // <FS/> Coalesce material requests across regions and faces
 }
 
+// <FS> Coalesce material requests across regions and faces
+bool LLMaterialMgr::isGetPending(const LLMaterialID& material_id) const
+{
+    auto itPending = mGetPendingAnyRegion.find(material_id);
+    return (mGetPendingAnyRegion.end() != itPending) && (LLFrameTimer::getTotalSeconds() < itPending->second + MATERIALS_POST_TIMEOUT);
+}
+
+void LLMaterialMgr::queueGet(const LLUUID& region_id, const LLMaterialID& material_id)
+{
+    if (isGetPending(region_id, material_id))
+    {
+        return;
+    }
+    if (isGetPending(material_id))
+    {
+        // Another region is already asked, ask this one if that region goes away
+        LL_DEBUGS("Materials") << "material id " << material_id << " already requested from another region" << LL_ENDL;
+        mGetWaitingRegions[material_id].insert(region_id);
+        return;
+    }
+
+    LL_DEBUGS("Materials") << "mGetQueue region " << region_id << " adding material id " << material_id << LL_ENDL;
+    mGetQueue[region_id].insert(material_id);
+    markGetPending(region_id, material_id);
+}
+
+LLMaterialMgr::material_map_t::const_iterator LLMaterialMgr::findMaterial(const LLMaterialID& material_id)
+{
+    material_map_t::const_iterator itMaterial = mMaterials.find(material_id);
+    if (mMaterials.end() == itMaterial)
+    {
+        auto itCached = mCachedMaterials.find(material_id);
+        if (mCachedMaterials.end() != itCached)
+        {
+            LL_DEBUGS("Materials") << "material id " << material_id << " found in the material cache" << LL_ENDL;
+            itMaterial = mMaterials.insert(std::make_pair(material_id, LLMaterialPtr(new LLMaterial(itCached->second)))).first;
+            mCachedMaterials.erase(itCached);
+        }
+    }
+    return itMaterial;
+}
+
+void LLMaterialMgr::loadCache()
+{
+    static LLCachedControl<U32> max_entries(gSavedSettings, "FSMaterialCacheMaxEntries");
+    if (!max_entries)
+    {
+        return;
+    }
+
+    const std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, MATERIALS_CACHE_FILE);
+    llifstream file(filename.c_str(), std::ios_base::in | std::ios_base::binary);
+    if (!file.is_open())
+    {
+        return;
+    }
+
+    LLSD data;
+    if (LLSDSerialize::fromBinary(data, file, LLSDSerialize::SIZE_UNLIMITED) == LLSDParser::PARSE_FAILURE
+        || data["version"].asInteger() != MATERIALS_CACHE_VERSION)
+    {
+        LL_WARNS("Materials") << "Ignoring unreadable material cache " << filename << LL_ENDL;
+        return;
+    }
+
+    const LLSD& materials = data["materials"];
+    for (LLSD::array_const_iterator it = materials.beginArray(); it != materials.endArray() && mCachedMaterials.size() < max_entries; ++it)
+    {
+        const LLSD& entry = *it;
+        if (entry["id"].isBinary() && entry["material"].isMap())
+        {
+            mCachedMaterials.insert(std::make_pair(LLMaterialID(entry["id"].asBinary()), entry["material"]));
+        }
+    }
+    LL_INFOS("Materials") << "Loaded " << mCachedMaterials.size() << " materials from the material cache" << LL_ENDL;
+}
+
+void LLMaterialMgr::saveCache()
+{
+    static LLCachedControl<U32> max_entries(gSavedSettings, "FSMaterialCacheMaxEntries");
+    const std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, MATERIALS_CACHE_FILE);
+    if (!max_entries)
+    {
+        LLFile::remove(filename, ENOENT);
+        return;
+    }
+
+    // Materials of this session first, then the ones of earlier sessions
+    // that were not seen this time
+    LLSD materials = LLSD::emptyArray();
+    for (const auto& [material_id, material] : mMaterials)
+    {
+        if (materials.size() >= max_entries)
+        {
+            break;
+        }
+        if (material.notNull() && !material_id.isNull() && !mLocalMaterials.count(material_id))
+        {
+            LLSD entry;
+            entry["id"] = material_id.asLLSD();
+            entry["material"] = material->asLLSD();
+            materials.append(entry);
+        }
+    }
+    for (const auto& [material_id, material_data] : mCachedMaterials)
+    {
+        if (materials.size() >= max_entries)
+        {
+            break;
+        }
+        LLSD entry;
+        entry["id"] = material_id.asLLSD();
+        entry["material"] = material_data;
+        materials.append(entry);
+    }
+
+    LLSD data;
+    data["version"] = MATERIALS_CACHE_VERSION;
+    data["materials"] = materials;
+
+    llofstream file(filename.c_str(), std::ios_base::out | std::ios_base::binary);
+    if (!file.is_open())
+    {
+        LL_WARNS("Materials") << "Unable to write material cache " << filename << LL_ENDL;
+        return;
+    }
+    LLSDSerialize::toBinary(data, file);
+    LL_INFOS("Materials") << "Saved " << materials.size() << " materials to the material cache" << LL_ENDL;
+}
+// </FS>
+
 const LLMaterialPtr LLMaterialMgr::get(const LLUUID& region_id, const LLMaterialID& material_id)
 {
     LL_DEBUGS("Materials") << "region " << region_id << " material id " << material_id << LL_ENDL;
     LLMaterialPtr material;
-    material_map_t::const_iterator itMaterial = mMaterials.find(material_id);
+    // <FS> Persistent material cache
+    //material_map_t::const_iterator itMaterial = mMaterials.find(material_id);
+    material_map_t::const_iterator itMaterial = findMaterial(material_id);
+    // </FS>
     if (mMaterials.end() != itMaterial)
     {
         material = itMaterial->second;
@@ -183,19 +327,22 @@ const LLMaterialPtr LLMaterialMgr::get(const LLUUID& region_id, const LLMaterial
     }
     else
     {
-        if (!isGetPending(region_id, material_id))
-        {
-            LL_DEBUGS("Materials") << " material pending " << material_id << LL_ENDL;
-            get_queue_t::iterator itQueue = mGetQueue.find(region_id);
-            if (mGetQueue.end() == itQueue)
-            {
-                LL_DEBUGS("Materials") << "mGetQueue add region " << region_id << " pending " << material_id << LL_ENDL;
-                std::pair<get_queue_t::iterator, bool> ret = mGetQueue.insert(std::pair<LLUUID, material_queue_t>(region_id, material_queue_t()));
-                itQueue = ret.first;
-            }
-            itQueue->second.insert(material_id);
-            markGetPending(region_id, material_id);
-        }
+        // <FS> Coalesce material requests across regions and faces
+        //if (!isGetPending(region_id, material_id))
+        //{
+        //    LL_DEBUGS("Materials") << " material pending " << material_id << LL_ENDL;
+        //    get_queue_t::iterator itQueue = mGetQueue.find(region_id);
+        //    if (mGetQueue.end() == itQueue)
+        //    {
+        //        LL_DEBUGS("Materials") << "mGetQueue add region " << region_id << " pending " << material_id << LL_ENDL;
+        //        std::pair<get_queue_t::iterator, bool> ret = mGetQueue.insert(std::pair<LLUUID, material_queue_t>(region_id, material_queue_t()));
+        //        itQueue = ret.first;
+        //    }
+        //    itQueue->second.insert(material_id);
+        //    markGetPending(region_id, material_id);
+        //}
+        queueGet(region_id, material_id);
+        // </FS>
         LL_DEBUGS("Materials") << " returning empty material " << LL_ENDL;
         material = LLMaterialPtr();
     }
@@ -206,7 +353,10 @@ boost::signals2::connection LLMaterialMgr::get(const LLUUID& region_id, const LL
 {
     boost::signals2::connection connection;
 
-    material_map_t::const_iterator itMaterial = mMaterials.find(material_id);
+    // <FS> Persistent material cache
+    //material_map_t::const_iterator itMaterial = mMaterials.find(material_id);
+    material_map_t::const_iterator itMaterial = findMaterial(material_id);
+    // </FS>
     if (itMaterial != mMaterials.end())
     {
         LL_DEBUGS("Materials") << "region " << region_id << " found materialid " << material_id << LL_ENDL;
@@ -217,19 +367,22 @@ boost::signals2::connection LLMaterialMgr::get(const LLUUID& region_id, const LL
     }
     else
     {
-        if (!isGetPending(region_id, material_id))
-        {
-            get_queue_t::iterator itQueue = mGetQueue.find(region_id);
-            if (mGetQueue.end() == itQueue)
-            {
-                LL_DEBUGS("Materials") << "mGetQueue inserting region "<<region_id << LL_ENDL;
-                std::pair<get_queue_t::iterator, bool> ret = mGetQueue.insert(std::pair<LLUUID, material_queue_t>(region_id, material_queue_t()));
-                itQueue = ret.first;
-            }
-            LL_DEBUGS("Materials") << "adding material id " << material_id << LL_ENDL;
-            itQueue->second.insert(material_id);
-            markGetPending(region_id, material_id);
-        }
+        // <FS> Coalesce material requests across regions and faces
+        //if (!isGetPending(region_id, material_id))
+        //{
+        //    get_queue_t::iterator itQueue = mGetQueue.find(region_id);
+        //    if (mGetQueue.end() == itQueue)
+        //    {
+        //        LL_DEBUGS("Materials") << "mGetQueue inserting region "<<region_id << LL_ENDL;
+        //        std::pair<get_queue_t::iterator, bool> ret = mGetQueue.insert(std::pair<LLUUID, material_queue_t>(region_id, material_queue_t()));
+        //        itQueue = ret.first;
+        //    }
+        //    LL_DEBUGS("Materials") << "adding material id " << material_id << LL_ENDL;
+        //    itQueue->second.insert(material_id);
+        //    markGetPending(region_id, material_id);
+        //}
+        queueGet(region_id, material_id);
+        // </FS>
 
         get_callback_map_t::iterator itCallback = mGetCallbacks.find(material_id);
         if (itCallback == mGetCallbacks.end())
@@ -247,7 +400,10 @@ boost::signals2::connection LLMaterialMgr::getTE(const LLUUID& region_id, const
 {
     boost::signals2::connection connection;
 
-    material_map_t::const_iterator itMaterial = mMaterials.find(material_id);
+    // <FS> Persistent material cache
+    //material_map_t::const_iterator itMaterial = mMaterials.find(material_id);
+    material_map_t::const_iterator itMaterial = findMaterial(material_id);
+    // </FS>
     if (itMaterial != mMaterials.end())
     {
         LL_DEBUGS("Materials") << "region " << region_id << " found materialid " << material_id << LL_ENDL;
@@ -258,19 +414,22 @@ boost::signals2::connection LLMaterialMgr::getTE(const LLUUID& region_id, const
     }
     else
     {
-        if (!isGetPending(region_id, material_id))
-        {
-            get_queue_t::iterator itQueue = mGetQueue.find(region_id);
-            if (mGetQueue.end() == itQueue)
-            {
-                LL_DEBUGS("Materials") << "mGetQueue inserting region "<<region_id << LL_ENDL;
-                std::pair<get_queue_t::iterator, bool> ret = mGetQueue.insert(std::pair<LLUUID, material_queue_t>(region_id, material_queue_t()));
-                itQueue = ret.first;
-            }
-            LL_DEBUGS("Materials") << "adding material id " << material_id << LL_ENDL;
-            itQueue->second.insert(material_id);
-            markGetPending(region_id, material_id);
-        }
+        // <FS> Coalesce material requests across regions and faces
+        //if (!isGetPending(region_id, material_id))
+        //{
+        //    get_queue_t::iterator itQueue = mGetQueue.find(region_id);
+        //    if (mGetQueue.end() == itQueue)
+        //    {
+        //        LL_DEBUGS("Materials") << "mGetQueue inserting region "<<region_id << LL_ENDL;
+        //        std::pair<get_queue_t::iterator, bool> ret = mGetQueue.insert(std::pair<LLUUID, material_queue_t>(region_id, material_queue_t()));
+        //        itQueue = ret.first;
+        //    }
+        //    LL_DEBUGS("Materials") << "adding material id " << material_id << LL_ENDL;
+        //    itQueue->second.insert(material_id);
+        //    markGetPending(region_id, material_id);
+        //}
+        queueGet(region_id, material_id);
+        // </FS>
 
         TEMaterialPair te_mat_pair;
         te_mat_pair.te = te;
@@ -362,6 +521,7 @@ void LLMaterialMgr::setLocalMaterial(const LLUUID& region_id, LLMaterialPtr mate
 
     LL_DEBUGS("Materials") << "region " << region_id << "new local material id " << material_id << LL_ENDL;
     mMaterials.insert(std::pair<LLMaterialID, LLMaterialPtr>(material_id, material_ptr));
+    mLocalMaterials.insert(material_id); // <FS/> Persistent material cache
 
     setMaterialCallbacks(material_id, material_ptr);
 
@@ -383,6 +543,10 @@ const LLMaterialPtr LLMaterialMgr::setMaterial(const LLUUID& region_id, const LL
     setMaterialCallbacks(material_id, itMaterial->second);
 
     mGetPending.erase(pending_material_t(region_id, material_id));
+    // <FS> Coalesce material requests across regions and faces
+    mGetPendingAnyRegion.erase(material_id);
+    mGetWaitingRegions.erase(material_id);
+    // </FS>
 
     return itMaterial->second;
 }
@@ -1001,10 +1165,15 @@ void LLMaterialMgr::clearGetQueues(const LLUUID& region_id)
 {
     mGetQueue.erase(region_id);
 
+    std::vector<LLMaterialID> orphaned; // <FS/> Coalesce material requests across regions and faces
     for (get_pending_map_t::iterator itPending = mGetPending.begin(); itPending != mGetPending.end();)
     {
         if (region_id == itPending->first.first)
         {
+            // <FS> Coalesce material requests across regions and faces
+            mGetPendingAnyRegion.erase(itPending->first.second);
+            orphaned.push_back(itPending->first.second);
+            // </FS>
             mGetPending.erase(itPending++);
         }
         else
@@ -1013,6 +1182,36 @@ void LLMaterialMgr::clearGetQueues(const LLUUID& region_id)
         }
     }
 
+    // <FS> Coalesce material requests across regions and faces
+    // Ask one of the regions that were waiting on the removed one instead
+    for (auto itWaiting = mGetWaitingRegions.begin(); itWaiting != mGetWaitingRegions.end();)
+    {
+        itWaiting->second.erase(region_id);
+        if (itWaiting->second.empty())
+        {
+            itWaiting = mGetWaitingRegions.erase(itWaiting);
+        }
+        else
+        {
+            ++itWaiting;
+        }
+    }
+    for (const LLMaterialID& material_id : orphaned)
+    {
+        auto itWaiting = mGetWaitingRegions.find(material_id);
+        if (mGetWaitingRegions.end() != itWaiting)
+        {
+            const LLUUID next_region_id = *itWaiting->second.begin();
+            itWaiting->second.erase(itWaiting->second.begin());
+            if (itWaiting->second.empty())
+            {
+                mGetWaitingRegions.erase(itWaiting);
+            }
+            queueGet(next_region_id, material_id);
+        }
+    }
+    // </FS>
+
     mGetAllQueue.erase(region_id);
     mGetAllRequested.erase(region_id);
     mGetAllPending.erase(region_id);
@@ -60,9 +60,19 @@ public:
     //explicitly add new material to material manager
     void setLocalMaterial(const LLUUID& region_id, LLMaterialPtr material_ptr);
 
+    // <FS> Persistent material cache
+    void saveCache();
+    // </FS>
+
 private:
     void clearGetQueues(const LLUUID& region_id);
     bool isGetPending(const LLUUID& region_id, const LLMaterialID& material_id) const;
+    // <FS> Coalesce material requests across regions and faces
+    bool isGetPending(const LLMaterialID& material_id) const;
+    void queueGet(const LLUUID& region_id, const LLMaterialID& material_id);
+    material_map_t::const_iterator findMaterial(const LLMaterialID& material_id);
+    void loadCache();
+    // </FS>
     bool isGetAllPending(const LLUUID& region_id) const;
     void markGetPending(const LLUUID& region_id, const LLMaterialID& material_id);
     const LLMaterialPtr setMaterial(const LLUUID& region_id, const LLMaterialID& material_id, const LLSD& material_data);
@@ -134,6 +144,17 @@ private:
     put_queue_t             mPutQueue;
     material_map_t          mMaterials;
 
+    // <FS> Coalesce material requests across regions and faces
+    // Material ids are hashes of the material, the same id is the same
+    // material in every region. Only one region is asked for it at a time.
+    std::map<LLMaterialID, F64> mGetPendingAnyRegion;
+    std::map<LLMaterialID, uuid_set_t> mGetWaitingRegions;
+    // Materials of earlier sessions, turned into LLMaterials when used
+    std::map<LLMaterialID, LLSD> mCachedMaterials;
+    // Made up ids of setLocalMaterial(), not worth keeping
+    std::set<LLMaterialID>  mLocalMaterials;
+    // </FS>
+
     LLCore::HttpRequest::ptr_t      mHttpRequest;
     LLCore::HttpHeaders::ptr_t      mHttpHeaders;
     LLCore::HttpOptions::ptr_t      mHttpOptions;
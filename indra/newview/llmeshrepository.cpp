@@ -33,6 +33,7 @@
 #include "llhttpconstants.h"
 #include "llmeshrepository.h"
 
+#include "hbxxh.h"
 #include "llagent.h"
 #include "llappviewer.h"
 #include "llbufferstream.h"
@@ -211,6 +212,8 @@
 //          std:: implementation and memory model.
 //     [4]  Appears to be covered by a mutex but doesn't need one.
 //     [5]  Read of a double-checked lock.
+//     [6]  Lock-free multi-producer queue (moodycamel::ConcurrentQueue),
+//          drained by the main thread only.
 //
 //   So, in addition to documentation, take this as a to-do/review
 //   list and see if you can improve things.  For porters to non-x86
@@ -257,14 +260,14 @@
 //     sMaxConcurrentRequests   mMutex        wo.main.none, ro.repo.none, ro.main.mMutex
 //     mMeshHeader              mHeaderMutex  rw.repo.mHeaderMutex, ro.main.mHeaderMutex, ro.main.none [0]
 //     mSkinRequests            mMutex        rw.repo.mMutex, ro.repo.none [5]
-//     mSkinInfoQ               mMutex        rw.repo.mMutex, rw.main.mMutex [5] (was:  [0])
+//     mSkinInfoQ               none          rw.repo.none, rw.main.none [6]
 //     mDecompositionRequests   mMutex        rw.repo.mMutex, ro.repo.none [5]
 //     mPhysicsShapeRequests    mMutex        rw.repo.mMutex, ro.repo.none [5]
-//     mDecompositionQ          mMutex        rw.repo.mMutex, rw.main.mMutex [5] (was:  [0])
+//     mDecompositionQ          none          rw.repo.none, rw.main.none [6]
 //     mHeaderReqQ              mMutex        ro.repo.none [5], rw.repo.mMutex, rw.any.mMutex
 //     mLODReqQ                 mMutex        ro.repo.none [5], rw.repo.mMutex, rw.any.mMutex
-//     mUnavailableQ            mMutex        rw.repo.none [0], ro.main.none [5], rw.main.mMutex
-//     mLoadedQ                 mMutex        rw.repo.mMutex, ro.main.none [5], rw.main.mMutex
+//     mUnavailableQ            none          rw.any.none [6], rw.main.none [6]
+//     mLoadedQ                 none          rw.repo.none [6], rw.main.none [6]
 //     mPendingLOD              mMutex        rw.repo.mMutex, rw.any.mMutex
 //     mGetMeshCapability       mMutex        rw.main.mMutex, ro.repo.mMutex (was:  [0])
 //     mGetMesh2Capability      mMutex        rw.main.mMutex, ro.repo.mMutex (was:  [0])
@@ -362,6 +365,29 @@ const S32 REQUEST2_HIGH_WATER_MAX = 100;
 const S32 REQUEST2_LOW_WATER_MIN = 16;
 const S32 REQUEST2_LOW_WATER_MAX = 50;
 
+// <FS> Persistent mesh header index, see LLMeshRepoThread::saveHeaderIndex()
+const U32 HEADER_INDEX_MAGIC = 0x49484D46;              // "FMHI"
+const U32 HEADER_INDEX_VERSION = 1;
+const std::string HEADER_INDEX_FILENAME = "mesh_header_index.dat";
+
+struct HeaderIndexRecord
+{
+    U8  mID[UUID_BYTES];
+    U32 mHeaderSize;
+    S32 mVersion;
+    S32 mSkinOffset;
+    S32 mSkinSize;
+    S32 mPhysicsConvexOffset;
+    S32 mPhysicsConvexSize;
+    S32 mPhysicsMeshOffset;
+    S32 mPhysicsMeshSize;
+    S32 mLodOffset[4];
+    S32 mLodSize[4];
+    U8  mCreatorId[UUID_BYTES];
+};
+static_assert(sizeof(HeaderIndexRecord) == 96, "HeaderIndexRecord must not be padded");
+// </FS>
+
 const U32 LARGE_MESH_FETCH_THRESHOLD = 1U << 21;        // Size at which requests goes to narrow/slow queue
 const long SMALL_MESH_XFER_TIMEOUT = 120L;              // Seconds to complete xfer, small mesh downloads
 const long LARGE_MESH_XFER_TIMEOUT = 600L;              // Seconds to complete xfer, large downloads
@@ -570,6 +596,9 @@ U32 LLMeshRepoThread::sMaxConcurrentRequests = 1;
 S32 LLMeshRepoThread::sRequestLowWater = REQUEST2_LOW_WATER_MIN;
 S32 LLMeshRepoThread::sRequestHighWater = REQUEST2_HIGH_WATER_MIN;
 S32 LLMeshRepoThread::sRequestWaterLevel = 0;
+U32 LLMeshRepoThread::sMaxSpeculativeBytes = 0;
+S32 LLMeshRepoThread::sSpeculativeBytes = MESH_HEADER_SIZE;
+U32 LLMeshRepoThread::sMaxHeaderIndexEntries = 0;
 
 // Base handler class for all mesh users of llcorehttp.
 // This is roughly equivalent to a Responder class in
@@ -657,10 +686,21 @@ public:
 class LLMeshLODHandler : public LLMeshHandlerBase
 {
 public:
+    // <FS> Coalesced mesh fetches: one request may carry several adjacent LOD blocks
+    struct block_t
+    {
+        S32 mLOD;
+        S32 mOffset;
+        S32 mSize;
+    };
+    typedef std::vector<block_t> block_list_t;
+    // </FS>
+
     LOG_CLASS(LLMeshLODHandler);
-    LLMeshLODHandler(const LLVolumeParams & mesh_params, S32 lod, U32 offset, U32 requested_bytes)
+    LLMeshLODHandler(const LLVolumeParams & mesh_params, const block_list_t & blocks, U32 offset, U32 requested_bytes)
         : LLMeshHandlerBase(offset, requested_bytes),
-          mLOD(lod)
+          mLOD(blocks.front().mLOD),
+          mBlocks(blocks)
     {
             mMeshParams = mesh_params;
             LLMeshRepoThread::incActiveLODRequests();
@@ -677,6 +717,7 @@ public:
 
 public:
     S32 mLOD;
+    block_list_t mBlocks; // <FS> Coalesced mesh fetches, mLOD first
 };
 
 
@@ -894,17 +935,20 @@ LLMeshRepoThread::~LLMeshRepoThread()
     mHttpRequestSet.clear();
     mHttpHeaders.reset();
 
-    while (!mSkinInfoQ.empty())
+    // <FS> Lock-free mesh result queues
+    LLPointer<LLMeshSkinInfo> skin_info;
+    while (mSkinInfoQ.try_dequeue(skin_info))
     {
-        llassert(mSkinInfoQ.front()->getNumRefs() == 1);
-        mSkinInfoQ.pop_front();
+        llassert(skin_info->getNumRefs() == 1);
+        skin_info = nullptr;
     }
 
-    while (!mDecompositionQ.empty())
+    LLModel::Decomposition* decomp = nullptr;
+    while (mDecompositionQ.try_dequeue(decomp))
     {
-        delete mDecompositionQ.front();
-        mDecompositionQ.pop_front();
+        delete decomp;
     }
+    // </FS>
 
     delete mHttpRequest;
     mHttpRequest = NULL;
@@ -982,8 +1026,10 @@ void LLMeshRepoThread::run()
                     // failed to load before, wait a bit
                     incomplete.push_front(req);
                 }
-                else if (!fetchMeshLOD(req.mMeshParams, req.mLOD, req.canRetry()))
+                else if (!fetchMeshLOD(req.mMeshParams, req.mLOD, req.canRetry(), req.mMergedLODs))
                 {
+                    // <FS> Coalesced mesh fetches: merged LODs were requeued on their own
+                    req.mMergedLODs = 0;
                     if (req.canRetry())
                     {
                         // failed, resubmit
@@ -993,8 +1039,7 @@ void LLMeshRepoThread::run()
                     else
                     {
                         // too many fails
-                        LLMutexLock lock(mMutex);
-                        mUnavailableQ.push_back(req);
+                        mUnavailableQ.enqueue(req);
                         LL_WARNS() << "Failed to load " << req.mMeshParams << " , skip" << LL_ENDL;
                     }
                 }
@@ -1091,8 +1136,7 @@ void LLMeshRepoThread::run()
                         }
                         else
                         {
-                            LLMutexLock locker(mMutex);
-                            mSkinUnavailableQ.push_back(req);
+                            mSkinUnavailableQ.enqueue(req);
                             LL_DEBUGS() << "mSkinReqQ failed: " << req.mId << LL_ENDL;
                         }
                     }
@@ -1234,6 +1278,20 @@ void LLMeshRepoThread::loadMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
     LLMutexLock lock(mMutex);
     LLMutexLock header_lock(mHeaderMutex);
     mesh_header_map::iterator iter = mMeshHeader.find(mesh_id);
+    // <FS> Persistent mesh header index: a header known from an earlier
+    // session is used as is, unless a header request is already under way
+    if (iter == mMeshHeader.end() && !mHeaderIndex.empty() && mPendingLOD.find(mesh_id) == mPendingLOD.end())
+    {
+        mesh_header_map::iterator index_iter = mHeaderIndex.find(mesh_id);
+        if (index_iter != mHeaderIndex.end())
+        {
+            iter = mMeshHeader.insert(*index_iter).first;
+            mIndexedHeaders.insert(mesh_id);
+            LLMeshRepository::sCacheBytesHeaders += index_iter->second.first;
+            mHeaderIndex.erase(index_iter);
+        }
+    }
+    // </FS>
     if (iter != mMeshHeader.end())
     { //if we have the header, request LOD byte range
 
@@ -1448,8 +1506,7 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id, bool can_retry)
                     {
                         LLAppViewer::instance()->outOfMemorySoftQuit();
                     } // else ignore failures for anomalously large data
-                    LLMutexLock locker(mMutex);
-                    mSkinUnavailableQ.emplace_back(mesh_id);
+                    mSkinUnavailableQ.enqueue(UUIDBasedRequest(mesh_id));
                     return true;
                 }
                 LLMeshRepository::sCacheBytesRead += size;
@@ -1506,20 +1563,17 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id, bool can_retry)
                 }
                 else
                 {
-                    LLMutexLock locker(mMutex);
-                    mSkinUnavailableQ.emplace_back(mesh_id);
+                    mSkinUnavailableQ.enqueue(UUIDBasedRequest(mesh_id));
                 }
             }
             else
             {
-                LLMutexLock locker(mMutex);
-                mSkinUnavailableQ.emplace_back(mesh_id);
+                mSkinUnavailableQ.enqueue(UUIDBasedRequest(mesh_id));
             }
         }
         else
         {
-            LLMutexLock locker(mMutex);
-            mSkinUnavailableQ.emplace_back(mesh_id);
+            mSkinUnavailableQ.enqueue(UUIDBasedRequest(mesh_id));
         }
     }
     else
@@ -1840,10 +1894,21 @@ bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params, bool c
         //within the first 4KB
         //NOTE -- this will break of headers ever exceed 4KB
 
-        LLMeshHandlerBase::ptr_t handler(new LLMeshHeaderHandler(mesh_params, 0, MESH_HEADER_SIZE));
+        // <FS> Coalesced mesh fetches: the skin block and the lowest LODs
+        // follow the header directly, so speculatively fetch as much as
+        // recent meshes needed. headerReceived() consumes whatever blocks
+        // arrived complete and saves their own round trips.
+        S32 request_bytes = MESH_HEADER_SIZE;
+        if (sMaxSpeculativeBytes > 0)
+        {
+            request_bytes = llclamp(sSpeculativeBytes, MESH_HEADER_SIZE, llmax((S32)sMaxSpeculativeBytes, MESH_HEADER_SIZE));
+        }
+        // </FS>
+
+        LLMeshHandlerBase::ptr_t handler(new LLMeshHeaderHandler(mesh_params, 0, request_bytes));
         // <FS:Ansariel> [UDP Assets]
         //LLCore::HttpHandle handle = getByteRange(http_url, 0, MESH_HEADER_SIZE, handler);
-        LLCore::HttpHandle handle = getByteRange(http_url, legacy_cap_version, 0, MESH_HEADER_SIZE, handler);
+        LLCore::HttpHandle handle = getByteRange(http_url, legacy_cap_version, 0, request_bytes, handler);
         // </FS:Ansariel> [UDP Assets]
         if (LLCORE_HTTP_HANDLE_INVALID == handle)
         {
@@ -1863,8 +1928,203 @@ bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params, bool c
     return retval;
 }
 
+// <FS> Coalesced mesh fetches
+// Mutex:  must not hold LLMeshRepoThread::mMutex on entry
+void LLMeshRepoThread::queueLODRequests(const LLVolumeParams& mesh_params, U32 lod_mask)
+{
+    if (!lod_mask)
+    {
+        return;
+    }
+
+    LLMutexLock lock(mMutex);
+    for (S32 i = 0; i < LLVolumeLODGroup::NUM_LODS; ++i)
+    {
+        if (lod_mask & (1 << i))
+        {
+            mLODReqQ.push(LODRequest(mesh_params, i));
+            LLMeshRepository::sLODProcessing++;
+        }
+    }
+}
+// </FS>
+
+// <FS> Persistent mesh header index
+// Drops a header taken from the index and requests it instead, together with
+// the given LODs. Returns false if the header was not taken from the index.
+//
+// Mutex:  acquires mMutex and mHeaderMutex
+bool LLMeshRepoThread::refetchIndexedHeader(const LLVolumeParams& mesh_params, S32 lod, U32 lod_mask)
+{
+    const LLUUID& mesh_id = mesh_params.getSculptID();
+    LLMutexLock lock(mMutex);
+    LLMutexLock header_lock(mHeaderMutex);
+    if (!mIndexedHeaders.erase(mesh_id))
+    {
+        return false;
+    }
+
+    LL_DEBUGS(LOG_MESH) << "Mesh " << mesh_id << " is not cached, requesting the header of the index entry again" << LL_ENDL;
+    mMeshHeader.erase(mesh_id);
+
+    pending_lod_map::iterator pending = mPendingLOD.find(mesh_id);
+    if (pending == mPendingLOD.end())
+    {
+        mHeaderReqQ.push(HeaderRequest(mesh_params));
+        pending = mPendingLOD.emplace(mesh_id, std::vector<S32>()).first;
+    }
+
+    lod_mask |= 1 << lod;
+    for (S32 i = 0; i < LLVolumeLODGroup::NUM_LODS; ++i)
+    {
+        if ((lod_mask & (1 << i)) && std::find(pending->second.begin(), pending->second.end(), i) == pending->second.end())
+        {
+            pending->second.push_back(i);
+        }
+    }
+    return true;
+}
+
+// Threads:  Trepo
+void LLMeshRepoThread::loadHeaderIndex()
+{
+    const std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, HEADER_INDEX_FILENAME);
+    LLFILE* file = LLFile::fopen(filename, "rb");
+    if (!file)
+    {
+        return;
+    }
+
+    mesh_header_map index;
+    U32 magic = 0;
+    U32 version = 0;
+    U64 count = 0;
+    if (fread(&magic, sizeof(magic), 1, file) == 1 && magic == HEADER_INDEX_MAGIC &&
+        fread(&version, sizeof(version), 1, file) == 1 && version == HEADER_INDEX_VERSION &&
+        fread(&count, sizeof(count), 1, file) == 1)
+    {
+        count = llmin(count, (U64)sMaxHeaderIndexEntries);
+        index.reserve((size_t)count);
+
+        HeaderIndexRecord record;
+        for (U64 i = 0; i < count && fread(&record, sizeof(record), 1, file) == 1; ++i)
+        {
+            LLUUID mesh_id;
+            memcpy(mesh_id.mData, record.mID, UUID_BYTES);
+
+            LLMeshHeader header;
+            header.mVersion = record.mVersion;
+            header.mSkinOffset = record.mSkinOffset;
+            header.mSkinSize = record.mSkinSize;
+            header.mPhysicsConvexOffset = record.mPhysicsConvexOffset;
+            header.mPhysicsConvexSize = record.mPhysicsConvexSize;
+            header.mPhysicsMeshOffset = record.mPhysicsMeshOffset;
+            header.mPhysicsMeshSize = record.mPhysicsMeshSize;
+            for (S32 lod = 0; lod < 4; ++lod)
+            {
+                header.mLodOffset[lod] = record.mLodOffset[lod];
+                header.mLodSize[lod] = record.mLodSize[lod];
+            }
+            memcpy(header.mCreatorId.mData, record.mCreatorId, UUID_BYTES);
+
+            if (record.mHeaderSize > 0 && header.mVersion <= MAX_MESH_VERSION)
+            {
+                index[mesh_id] = { record.mHeaderSize, header };
+            }
+        }
+    }
+    fclose(file);
+
+    LL_INFOS(LOG_MESH) << "Loaded " << index.size() << " mesh headers from " << filename << LL_ENDL;
+
+    LLMutexLock lock(mHeaderMutex);
+    mHeaderIndex.swap(index);
+}
+
+// Headers seen in this session are written first, the remaining room goes
+// to index entries that were not needed this time.
+//
+// Threads:  Tmain, after the repo thread stopped
+void LLMeshRepoThread::saveHeaderIndex()
+{
+    if (!sMaxHeaderIndexEntries)
+    {
+        return;
+    }
+
+    const std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, HEADER_INDEX_FILENAME);
+    LLFILE* file = LLFile::fopen(filename, "wb");
+    if (!file)
+    {
+        LL_WARNS(LOG_MESH) << "Unable to write mesh header index " << filename << LL_ENDL;
+        return;
+    }
+
+    LLMutexLock lock(mHeaderMutex);
+
+    std::vector<const mesh_header_map::value_type*> entries;
+    entries.reserve(llmin((size_t)sMaxHeaderIndexEntries, mMeshHeader.size() + mHeaderIndex.size()));
+    for (const mesh_header_map* headers : { &mMeshHeader, &mHeaderIndex })
+    {
+        for (const auto& entry : *headers)
+        {
+            if (entries.size() >= sMaxHeaderIndexEntries)
+            {
+                break;
+            }
+            const LLMeshHeader& header = entry.second.second;
+            if (entry.second.first > 0 && !header.m404 && header.mVersion <= MAX_MESH_VERSION)
+            {
+                entries.push_back(&entry);
+            }
+        }
+    }
+
+    bool success = true;
+    const U32 magic = HEADER_INDEX_MAGIC;
+    const U32 version = HEADER_INDEX_VERSION;
+    const U64 count = (U64)entries.size();
+    success &= fwrite(&magic, sizeof(magic), 1, file) == 1;
+    success &= fwrite(&version, sizeof(version), 1, file) == 1;
+    success &= fwrite(&count, sizeof(count), 1, file) == 1;
+    for (const auto* entry : entries)
+    {
+        if (!success)
+        {
+            break;
+        }
+
+        const LLMeshHeader& header = entry->second.second;
+        HeaderIndexRecord record;
+        memcpy(record.mID, entry->first.mData, UUID_BYTES);
+        record.mHeaderSize = entry->second.first;
+        record.mVersion = header.mVersion;
+        record.mSkinOffset = header.mSkinOffset;
+        record.mSkinSize = header.mSkinSize;
+        record.mPhysicsConvexOffset = header.mPhysicsConvexOffset;
+        record.mPhysicsConvexSize = header.mPhysicsConvexSize;
+        record.mPhysicsMeshOffset = header.mPhysicsMeshOffset;
+        record.mPhysicsMeshSize = header.mPhysicsMeshSize;
+        for (S32 lod = 0; lod < 4; ++lod)
+        {
+            record.mLodOffset[lod] = header.mLodOffset[lod];
+            record.mLodSize[lod] = header.mLodSize[lod];
+        }
+        memcpy(record.mCreatorId, header.mCreatorId.mData, UUID_BYTES);
+        success &= fwrite(&record, sizeof(record), 1, file) == 1;
+    }
+    fclose(file);
+
+    if (!success)
+    {
+        LL_WARNS(LOG_MESH) << "Failed to write mesh header index " << filename << LL_ENDL;
+        LLFile::remove(filename);
+    }
+}
+// </FS>
+
 //return false if failed to get mesh lod.
-bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod, bool can_retry)
+bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod, bool can_retry, U32 merged_lods)
 {
     LL_PROFILE_ZONE_SCOPED;
     if (!mHeaderMutex)
@@ -1874,11 +2134,16 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
 
     const LLUUID& mesh_id = mesh_params.getSculptID();
 
+    // <FS> Coalesced mesh fetches: any merged LOD this request does not end
+    // up carrying goes back to the queue as a request of its own
+    merged_lods &= ~(1 << lod);
+
     mHeaderMutex->lock();
     auto header_it = mMeshHeader.find(mesh_id);
     if (header_it == mMeshHeader.end())
     { //we have no header info for this mesh, do nothing
         mHeaderMutex->unlock();
+        queueLODRequests(mesh_params, merged_lods); // <FS/> Coalesced mesh fetches
         return false;
     }
     ++LLMeshRepository::sMeshRequestCount;
@@ -1891,6 +2156,16 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
         S32 version = header.mVersion;
         S32 offset = header_size + header.mLodOffset[lod];
         S32 size = header.mLodSize[lod];
+
+        // <FS> Coalesced mesh fetches
+        S32 lod_offsets[LLVolumeLODGroup::NUM_LODS];
+        S32 lod_sizes[LLVolumeLODGroup::NUM_LODS];
+        for (S32 i = 0; i < LLVolumeLODGroup::NUM_LODS; ++i)
+        {
+            lod_offsets[i] = header_size + header.mLodOffset[i];
+            lod_sizes[i] = header.mLodSize[i];
+        }
+        // </FS>
         mHeaderMutex->unlock();
 
         if (version <= MAX_MESH_VERSION && offset >= 0 && size > 0)
@@ -1912,8 +2187,8 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
                     {
                         LLAppViewer::instance()->outOfMemorySoftQuit();
                     } // else ignore failures for anomalously large data
-                    LLMutexLock lock(mMutex);
-                    mUnavailableQ.push_back(LODRequest(mesh_params, lod));
+                    queueLODRequests(mesh_params, merged_lods); // <FS/> Coalesced mesh fetches
+                    mUnavailableQ.enqueue(LODRequest(mesh_params, lod));
                     return true;
                 }
                 LLMeshRepository::sCacheBytesRead += size;
@@ -1936,6 +2211,7 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
 
                         LL_DEBUGS(LOG_MESH) << "Mesh/Cache: Mesh body for ID " << mesh_id << " - was retrieved from the cache." << LL_ENDL;
 
+                        queueLODRequests(mesh_params, merged_lods); // <FS/> Coalesced mesh fetches
                         return true;
                     }
                 }
@@ -1943,6 +2219,14 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
                 delete[] buffer;
             }
 
+            // <FS> Persistent mesh header index: blocks fetched without a
+            // cache entry can't be cached, let a header request create it
+            if (file.getSize() <= 0 && refetchIndexedHeader(mesh_params, lod, merged_lods))
+            {
+                return true;
+            }
+            // </FS>
+
             //reading from cache failed for whatever reason, fetch from sim
             std::string http_url;
             // <FS:Ansariel> [UDP Assets]
@@ -1955,11 +2239,52 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
             {
                 LL_DEBUGS(LOG_MESH) << "Mesh/Cache: Mesh body for ID " << mesh_id << " - was retrieved from the simulator." << LL_ENDL;
 
-                LLMeshHandlerBase::ptr_t handler(new LLMeshLODHandler(mesh_params, lod, offset, size));
+                // <FS> Coalesced mesh fetches: LOD blocks are stored one after
+                // another, so take along every merged LOD whose block directly
+                // precedes or follows the range fetched so far
+                LLMeshLODHandler::block_list_t blocks{ { lod, offset, size } };
+                S32 range_start = offset;
+                S32 range_end = offset + size;
+                for (bool grew = true; grew && merged_lods; )
+                {
+                    grew = false;
+                    for (S32 i = 0; i < LLVolumeLODGroup::NUM_LODS; ++i)
+                    {
+                        if (!(merged_lods & (1 << i)) || lod_sizes[i] <= 0)
+                        {
+                            continue;
+                        }
+
+                        if (lod_offsets[i] == range_end)
+                        {
+                            range_end += lod_sizes[i];
+                        }
+                        else if (lod_offsets[i] + lod_sizes[i] == range_start)
+                        {
+                            range_start = lod_offsets[i];
+                        }
+                        else
+                        {
+                            continue;
+                        }
+                        blocks.push_back({ i, lod_offsets[i], lod_sizes[i] });
+                        merged_lods &= ~(1 << i);
+                        grew = true;
+                    }
+                }
+                queueLODRequests(mesh_params, merged_lods);
+                if (blocks.size() > 1)
+                {
+                    LL_DEBUGS(LOG_MESH) << "Mesh/Cache: Coalesced " << blocks.size() << " LODs for ID " << mesh_id
+                                        << " into bytes [" << range_start << ".." << (range_end - 1) << "]" << LL_ENDL;
+                }
+
+                LLMeshHandlerBase::ptr_t handler(new LLMeshLODHandler(mesh_params, blocks, range_start, range_end - range_start));
                 // <FS:Ansariel> [UDP Assets]
                 //LLCore::HttpHandle handle = getByteRange(http_url, offset, size, handler);
-                LLCore::HttpHandle handle = getByteRange(http_url, legacy_cap_version, offset, size, handler);
+                LLCore::HttpHandle handle = getByteRange(http_url, legacy_cap_version, range_start, range_end - range_start, handler);
                 // </FS:Ansariel> [UDP Assets]
+                // </FS>
                 if (LLCORE_HTTP_HANDLE_INVALID == handle)
                 {
                     LL_WARNS(LOG_MESH) << "HTTP GET request failed for LOD on mesh " << mID
@@ -1967,6 +2292,13 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
                                        << " (" << mHttpStatus.toTerseString() << ")"
                                        << LL_ENDL;
                     retval = false;
+
+                    // <FS> Coalesced mesh fetches: the caller only retries the primary LOD
+                    for (size_t i = 1; i < blocks.size(); ++i)
+                    {
+                        queueLODRequests(mesh_params, 1 << blocks[i].mLOD);
+                    }
+                    // </FS>
                 }
                 else if (can_retry)
                 {
@@ -1976,20 +2308,22 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
                 }
                 else
                 {
-                    LLMutexLock lock(mMutex);
-                    mUnavailableQ.push_back(LODRequest(mesh_params, lod));
+                    for (const LLMeshLODHandler::block_t& block : blocks) // <FS/> Coalesced mesh fetches
+                    {
+                        mUnavailableQ.enqueue(LODRequest(mesh_params, block.mLOD));
+                    }
                 }
             }
             else
             {
-                LLMutexLock lock(mMutex);
-                mUnavailableQ.push_back(LODRequest(mesh_params, lod));
+                queueLODRequests(mesh_params, merged_lods); // <FS/> Coalesced mesh fetches
+                mUnavailableQ.enqueue(LODRequest(mesh_params, lod));
             }
         }
         else
         {
-            LLMutexLock lock(mMutex);
-            mUnavailableQ.push_back(LODRequest(mesh_params, lod));
+            queueLODRequests(mesh_params, merged_lods); // <FS/> Coalesced mesh fetches
+            mUnavailableQ.enqueue(LODRequest(mesh_params, lod));
         }
     }
     else
@@ -2007,6 +2341,11 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
 
     LLMeshHeader header;
 
+    // <FS> Coalesced mesh fetches: blocks may follow the header in data
+    U8* const asset_data = data;
+    const S32 asset_size = data_size;
+    // </FS>
+
     llssize header_size = 0;
     if (data_size > 0)
     {
@@ -2058,6 +2397,20 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
             LLMeshRepository::sCacheBytesHeaders += (U32)header_size;
         }
 
+        // <FS> Coalesced mesh fetches: returns the start of a block if the
+        // data we were handed already holds all of it
+        const bool header_valid = header_size > 0 && !header.m404 && header.mVersion <= MAX_MESH_VERSION;
+        auto block_in_data = [&](S32 offset, S32 size) -> U8*
+        {
+            S64 start = (S64)header_size + offset;
+            if (!header_valid || !asset_data || offset < 0 || size <= 0 || start + size > asset_size)
+            {
+                return nullptr;
+            }
+            return asset_data + start;
+        };
+        // </FS>
+
         // immediately request SkinInfo since we'll need it before we can render any LoD if it is present
         {
             LLMutexLock lock(gMeshRepo.mMeshMutex);
@@ -2068,22 +2421,67 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
             }
         }
 
-        fetchMeshSkinInfo(mesh_id);
+        // <FS> Coalesced mesh fetches
+        //fetchMeshSkinInfo(mesh_id);
+        U8* skin_data = block_in_data(header.mSkinOffset, header.mSkinSize);
+        if (!skin_data || !skinInfoReceived(mesh_id, skin_data, header.mSkinSize))
+        {
+            fetchMeshSkinInfo(mesh_id);
+        }
 
-        LLMutexLock lock(mMutex); // make sure only one thread access mPendingLOD at the same time.
+        std::vector<S32> pending_lods;
+        {
+            LLMutexLock lock(mMutex); // make sure only one thread access mPendingLOD at the same time.
 
-        //check for pending requests
-        pending_lod_map::iterator iter = mPendingLOD.find(mesh_id);
-        if (iter != mPendingLOD.end())
+            //check for pending requests
+            pending_lod_map::iterator iter = mPendingLOD.find(mesh_id);
+            if (iter != mPendingLOD.end())
+            {
+                pending_lods.swap(iter->second);
+                mPendingLOD.erase(iter);
+            }
+        }
+
+        if (header_valid && !pending_lods.empty())
         {
-            for (U32 i = 0; i < iter->second.size(); ++i)
+            // Learn how much of the asset a header request should take along:
+            // the header, the skin and the first LOD that was asked for
+            S32 needed = (S32)header_size + llmax(header.mSkinOffset + header.mSkinSize,
+                                                  header.mLodOffset[pending_lods.front()] + header.mLodSize[pending_lods.front()]);
+            needed = llclamp(needed, MESH_HEADER_SIZE, llmax((S32)sMaxSpeculativeBytes, MESH_HEADER_SIZE));
+            sSpeculativeBytes += (needed - sSpeculativeBytes) / 8;
+        }
+
+        // LODs that arrived along with the header are unpacked right away,
+        // the rest is fetched as one request so adjacent blocks share it
+        S32 first_lod = -1;
+        U32 merged_lods = 0;
+        for (S32 lod : pending_lods)
+        {
+            U8* lod_data = block_in_data(header.mLodOffset[lod], header.mLodSize[lod]);
+            if (lod_data && lodReceived(mesh_params, lod, lod_data, header.mLodSize[lod]) == MESH_OK)
             {
-                LODRequest req(mesh_params, iter->second[i]);
-                mLODReqQ.push(req);
-                LLMeshRepository::sLODProcessing++;
+                LL_DEBUGS(LOG_MESH) << "Mesh LOD " << lod << " for ID " << mesh_id << " arrived with the header" << LL_ENDL;
+                continue;
             }
-            mPendingLOD.erase(iter);
+
+            if (first_lod < 0)
+            {
+                first_lod = lod;
+            }
+            else if (lod != first_lod)
+            {
+                merged_lods |= 1 << lod;
+            }
+        }
+
+        if (first_lod >= 0)
+        {
+            LLMutexLock lock(mMutex);
+            mLODReqQ.push(LODRequest(mesh_params, first_lod, merged_lods));
+            LLMeshRepository::sLODProcessing++;
         }
+        // </FS>
     }
 
     return MESH_OK;
@@ -2096,12 +2494,17 @@ EMeshProcessingResult LLMeshRepoThread::lodReceived(const LLVolumeParams& mesh_p
         return MESH_NO_DATA;
     }
 
+    // <FS> Parse here to know whether the data is good, but leave the vertex
+    // cache optimization and tangent generation to the general thread pool
+    //if (volume->unpackVolumeFaces(data, data_size))
     LLPointer<LLVolume> volume = new LLVolume(mesh_params, LLVolumeLODGroup::getVolumeScaleFromDetail(lod));
-    if (volume->unpackVolumeFaces(data, data_size))
+    if (volume->unpackVolumeFaces(data, data_size, false))
+    // </FS>
     {
         if (volume->getNumFaces() > 0)
         {
             // if we have a valid SkinInfo, cache per-joint bounding boxes for this LOD
+            // (extents don't depend on vertex order, so this can precede the optimization)
             LLMeshSkinInfo* skin_info = mSkinMap[mesh_params.getSculptID()];
             if (skin_info && isAgentAvatarValid())
             {
@@ -2113,17 +2516,45 @@ EMeshProcessingResult LLMeshRepoThread::lodReceived(const LLVolumeParams& mesh_p
                 }
             }
 
-            LoadedMesh mesh(volume, mesh_params, lod);
+            // <FS> LLPointer is not thread safe, hand the worker a reference
+            // of its own and drop ours before it can run
+            LLVolume* volumep = volume.get();
+            volumep->ref();
+            volume = NULL;
+
+            auto optimize = [this, volumep, mesh_params, lod]()
             {
-                LLMutexLock lock(mMutex);
-                mLoadedQ.push_back(mesh);
-                // LLPointer is not thread safe, since we added this pointer into
-                // threaded list, make sure counter gets decreased inside mutex lock
-                // and won't affect mLoadedQ processing
-                volume = NULL;
-                // might be good idea to turn mesh into pointer to avoid making a copy
-                mesh.mVolume = NULL;
+                if (LLApp::isExiting())
+                {
+                    volumep->unref();
+                    return;
+                }
+
+                if (!volumep->cacheOptimize(true))
+                {
+                    // Out of memory? An empty volume is reported as unavailable
+                    LL_WARNS(LOG_MESH) << "Failed to optimize mesh " << mesh_params.getSculptID() << " LOD " << lod << LL_ENDL;
+                    volumep->getVolumeFaces().clear();
+                }
+
+                // <FS> Lock-free mesh result queues
+                // LLPointer is not thread safe: take the queue's reference here
+                // and drop ours before publishing. Moving the mesh into the queue
+                // leaves the count alone, so the main thread is the only one to
+                // touch it after the enqueue.
+                LoadedMesh mesh(volumep, mesh_params, lod);
+                volumep->unref();
+                mLoadedQ.enqueue(std::move(mesh));
+                // </FS>
+            };
+
+            LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+            if (!general_queue || !general_queue->tryPost(optimize))
+            {
+                // No pool or its queue is full, don't hold up the mesh
+                optimize();
             }
+            // </FS>
             return MESH_OK;
         }
     }
@@ -2135,6 +2566,27 @@ bool LLMeshRepoThread::skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 dat
 {
     LLSD skin;
 
+    // <FS> Shared skin info pool: a block seen before only needs a copy of
+    // its parsed skin info carrying this mesh's id
+    const U64 pool_key = data_size > 0 ? HBXXH64::digest(data, data_size) ^ (U64)data_size : 0;
+    skin_pool_t::iterator pooled = pool_key ? mSkinPool.find(pool_key) : mSkinPool.end();
+    if (pooled != mSkinPool.end())
+    {
+        LLPointer<LLMeshSkinInfo> info = new LLMeshSkinInfo(*pooled->second);
+        info->mMeshID = mesh_id;
+
+        if (isAgentAvatarValid())
+        {
+            LLSkinningUtil::initJointNums(info, gAgentAvatarp);
+        }
+
+        mSkinMap[mesh_id] = pooled->second;
+
+        mSkinInfoQ.enqueue(std::move(info));
+        return true;
+    }
+    // </FS>
+
     if (data_size > 0)
     {
         try
@@ -2167,14 +2619,29 @@ bool LLMeshRepoThread::skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 dat
 
         // copy the skin info for the background thread so we can use it
         // to calculate per-joint bounding boxes when volumes are loaded
-        mSkinMap[mesh_id] = new LLMeshSkinInfo(*info);
+        // <FS> Shared skin info pool: the copy is also the pooled one
+        //mSkinMap[mesh_id] = new LLMeshSkinInfo(*info);
+        LLPointer<LLMeshSkinInfo> shared_info = new LLMeshSkinInfo(*info);
+        mSkinMap[mesh_id] = shared_info;
 
+        if (pool_key)
         {
-            // Move the LLPointer in to the skin info queue to avoid reference
-            // count modification after we leave the lock
-            LLMutexLock lock(mMutex);
-            mSkinInfoQ.emplace_back(std::move(info));
+            // drop blocks no mesh refers to anymore once the pool doubled
+            if (mSkinPool.size() >= mSkinPoolPruneSize)
+            {
+                for (skin_pool_t::iterator iter = mSkinPool.begin(); iter != mSkinPool.end(); )
+                {
+                    iter = iter->second->getNumRefs() == 1 ? mSkinPool.erase(iter) : std::next(iter);
+                }
+                mSkinPoolPruneSize = llmax((size_t)1024, mSkinPool.size() * 2);
+            }
+            mSkinPool[pool_key] = shared_info;
         }
+        // </FS>
+
+        // Move the LLPointer in to the skin info queue to avoid reference
+        // count modification once the main thread can see it
+        mSkinInfoQ.enqueue(std::move(info));
     }
 
     return true;
@@ -2207,10 +2674,7 @@ bool LLMeshRepoThread::decompositionReceived(const LLUUID& mesh_id, U8* data, S3
     {
         LLModel::Decomposition* d = new LLModel::Decomposition(decomp);
         d->mMeshID = mesh_id;
-        {
-            LLMutexLock lock(mMutex);
-            mDecompositionQ.push_back(d);
-        }
+        mDecompositionQ.enqueue(d);
     }
 
     return true;
@@ -2256,10 +2720,7 @@ EMeshProcessingResult LLMeshRepoThread::physicsShapeReceived(const LLUUID& mesh_
         }
     }
 
-    {
-        LLMutexLock lock(mMutex);
-        mDecompositionQ.push_back(d);
-    }
+    mDecompositionQ.enqueue(d);
     return MESH_OK;
 }
 
@@ -3050,98 +3511,78 @@ void LLMeshRepoThread::notifyLoadedMeshes()
         return;
     }
 
-    if (!mLoadedQ.empty())
+    // <FS> Lock-free mesh result queues
+    // Take a snapshot of each queue; anything the repo thread adds while
+    // we are busy here is picked up on the next frame.
+    if (size_t count = mLoadedQ.size_approx())
     {
-        std::deque<LoadedMesh> loaded_queue;
+        std::vector<LoadedMesh> loaded_queue;
+        loaded_queue.reserve(count);
+        mLoadedQ.try_dequeue_bulk(std::back_inserter(loaded_queue), count);
+        update_metrics |= !loaded_queue.empty();
 
-        mMutex->lock();
-        if (!mLoadedQ.empty())
+        for (const auto& mesh : loaded_queue)
         {
-            loaded_queue.swap(mLoadedQ);
-            mMutex->unlock();
-
-            update_metrics = true;
-
-            // Process the elements free of the lock
-            for (const auto& mesh : loaded_queue)
+            if (mesh.mVolume->getNumVolumeFaces() > 0)
             {
-                if (mesh.mVolume->getNumVolumeFaces() > 0)
-                {
-                    gMeshRepo.notifyMeshLoaded(mesh.mMeshParams, mesh.mVolume);
-                }
-                else
-                {
-                    gMeshRepo.notifyMeshUnavailable(mesh.mMeshParams,
-                        LLVolumeLODGroup::getVolumeDetailFromScale(mesh.mVolume->getDetail()));
-                }
+                gMeshRepo.notifyMeshLoaded(mesh.mMeshParams, mesh.mVolume);
+            }
+            else
+            {
+                gMeshRepo.notifyMeshUnavailable(mesh.mMeshParams,
+                    LLVolumeLODGroup::getVolumeDetailFromScale(mesh.mVolume->getDetail()));
             }
         }
     }
 
-    if (!mUnavailableQ.empty())
+    if (size_t count = mUnavailableQ.size_approx())
     {
-        std::deque<LODRequest> unavil_queue;
+        std::vector<LODRequest> unavil_queue;
+        unavil_queue.reserve(count);
+        mUnavailableQ.try_dequeue_bulk(std::back_inserter(unavil_queue), count);
+        update_metrics |= !unavil_queue.empty();
 
-        mMutex->lock();
-        if (!mUnavailableQ.empty())
+        for (const auto& req : unavil_queue)
         {
-            unavil_queue.swap(mUnavailableQ);
-            mMutex->unlock();
-
-            update_metrics = true;
-
-            // Process the elements free of the lock
-            for (const auto& req : unavil_queue)
-            {
-                gMeshRepo.notifyMeshUnavailable(req.mMeshParams, req.mLOD);
-            }
+            gMeshRepo.notifyMeshUnavailable(req.mMeshParams, req.mLOD);
         }
     }
 
-    if (!mSkinInfoQ.empty() || !mSkinUnavailableQ.empty() || ! mDecompositionQ.empty())
+    if (size_t count = mSkinInfoQ.size_approx())
     {
-        if (mMutex->trylock())
-        {
-            std::deque<LLPointer<LLMeshSkinInfo>> skin_info_q;
-            std::deque<UUIDBasedRequest> skin_info_unavail_q;
-            std::list<LLModel::Decomposition*> decomp_q;
+        std::vector<LLPointer<LLMeshSkinInfo>> skin_info_q;
+        skin_info_q.reserve(count);
+        mSkinInfoQ.try_dequeue_bulk(std::back_inserter(skin_info_q), count);
 
-            if (! mSkinInfoQ.empty())
-            {
-                skin_info_q.swap(mSkinInfoQ);
-            }
-
-            if (! mSkinUnavailableQ.empty())
-            {
-                skin_info_unavail_q.swap(mSkinUnavailableQ);
-            }
+        for (const auto& info : skin_info_q)
+        {
+            gMeshRepo.notifySkinInfoReceived(info);
+        }
+    }
 
-            if (! mDecompositionQ.empty())
-            {
-                decomp_q.swap(mDecompositionQ);
-            }
+    if (size_t count = mSkinUnavailableQ.size_approx())
+    {
+        std::vector<UUIDBasedRequest> skin_info_unavail_q;
+        skin_info_unavail_q.reserve(count);
+        mSkinUnavailableQ.try_dequeue_bulk(std::back_inserter(skin_info_unavail_q), count);
 
-            mMutex->unlock();
+        for (const auto& req : skin_info_unavail_q)
+        {
+            gMeshRepo.notifySkinInfoUnavailable(req.mId);
+        }
+    }
 
-            // Process the elements free of the lock
-            while (! skin_info_q.empty())
-            {
-                gMeshRepo.notifySkinInfoReceived(skin_info_q.front());
-                skin_info_q.pop_front();
-            }
-            while (! skin_info_unavail_q.empty())
-            {
-                gMeshRepo.notifySkinInfoUnavailable(skin_info_unavail_q.front().mId);
-                skin_info_unavail_q.pop_front();
-            }
+    if (size_t count = mDecompositionQ.size_approx())
+    {
+        std::vector<LLModel::Decomposition*> decomp_q(count);
+        decomp_q.resize(mDecompositionQ.try_dequeue_bulk(decomp_q.begin(), count));
 
-            while (! decomp_q.empty())
-            {
-                gMeshRepo.notifyDecompositionReceived(decomp_q.front());
-                decomp_q.pop_front();
-            }
+        for (LLModel::Decomposition* decomp : decomp_q)
+        {
+            gMeshRepo.notifyDecompositionReceived(decomp);
         }
     }
+    // </FS>
 
     if (update_metrics)
     {
@@ -3360,10 +3801,9 @@ void LLMeshHeaderHandler::processFailure(LLCore::HttpStatus status)
                        << LL_ENDL;
 
     // Can't get the header so none of the LODs will be available
-    LLMutexLock lock(gMeshRepo.mThread->mMutex);
     for (int i(0); i < LLVolumeLODGroup::NUM_LODS; ++i)
     {
-        gMeshRepo.mThread->mUnavailableQ.push_back(LLMeshRepoThread::LODRequest(mMeshParams, i));
+        gMeshRepo.mThread->mUnavailableQ.enqueue(LLMeshRepoThread::LODRequest(mMeshParams, i));
     }
 }
 
@@ -3389,10 +3829,9 @@ void LLMeshHeaderHandler::processData(LLCore::BufferArray * /* body */, S32 /* b
                            << LL_ENDL;
 
         // Can't get the header so none of the LODs will be available
-        LLMutexLock lock(gMeshRepo.mThread->mMutex);
         for (int i(0); i < LLVolumeLODGroup::NUM_LODS; ++i)
         {
-            gMeshRepo.mThread->mUnavailableQ.push_back(LLMeshRepoThread::LODRequest(mMeshParams, i));
+            gMeshRepo.mThread->mUnavailableQ.enqueue(LLMeshRepoThread::LODRequest(mMeshParams, i));
         }
     }
     else if (data && data_size > 0)
@@ -3438,6 +3877,26 @@ void LLMeshHeaderHandler::processData(LLCore::BufferArray * /* body */, S32 /* b
             // only allocate as much space in the cache as is needed for the local cache
             data_size = llmin(data_size, bytes);
 
+            // <FS> Coalesced mesh fetches: a speculative header request usually
+            // ends in the middle of a block. Only cache the blocks that arrived
+            // complete so a partial one reads as missing instead of corrupt.
+            S32 complete_bytes = header_bytes;
+            auto add_block = [&](S32 offset, S32 size)
+            {
+                if (offset >= 0 && size > 0 && header_bytes + offset + size <= data_size)
+                {
+                    complete_bytes = llmax(complete_bytes, header_bytes + offset + size);
+                }
+            };
+            add_block(header.mSkinOffset, header.mSkinSize);
+            add_block(header.mPhysicsConvexOffset, header.mPhysicsConvexSize);
+            for (S32 i = 0; i < LLVolumeLODGroup::NUM_LODS; ++i)
+            {
+                add_block(header.mLodOffset[i], header.mLodSize[i]);
+            }
+            data_size = llmin(data_size, complete_bytes);
+            // </FS>
+
             LLFileSystem file(mesh_id, LLAssetType::AT_MESH, LLFileSystem::READ_WRITE);
             if (file.getMaxSize() >= bytes)
             {
@@ -3466,10 +3925,9 @@ void LLMeshHeaderHandler::processData(LLCore::BufferArray * /* body */, S32 /* b
             gMeshRepo.mThread->mHeaderMutex->unlock();
 
             // headerReceived() parsed header, but header's data is invalid so none of the LODs will be available
-            LLMutexLock lock(gMeshRepo.mThread->mMutex);
             for (int i(0); i < LLVolumeLODGroup::NUM_LODS; ++i)
             {
-                gMeshRepo.mThread->mUnavailableQ.push_back(LLMeshRepoThread::LODRequest(mMeshParams, i));
+                gMeshRepo.mThread->mUnavailableQ.enqueue(LLMeshRepoThread::LODRequest(mMeshParams, i));
             }
         }
     }
@@ -3482,7 +3940,10 @@ LLMeshLODHandler::~LLMeshLODHandler()
         if (! mProcessed)
         {
             LL_WARNS(LOG_MESH) << "Mesh LOD fetch canceled unexpectedly, retrying." << LL_ENDL;
-            gMeshRepo.mThread->lockAndLoadMeshLOD(mMeshParams, mLOD);
+            for (const block_t& block : mBlocks) // <FS/> Coalesced mesh fetches
+            {
+                gMeshRepo.mThread->lockAndLoadMeshLOD(mMeshParams, block.mLOD);
+            }
         }
         LLMeshRepoThread::decActiveLODRequests();
     }
@@ -3495,8 +3956,10 @@ void LLMeshLODHandler::processFailure(LLCore::HttpStatus status)
                        << " (" << status.toTerseString() << ").  Not retrying."
                        << LL_ENDL;
 
-    LLMutexLock lock(gMeshRepo.mThread->mMutex);
-    gMeshRepo.mThread->mUnavailableQ.push_back(LLMeshRepoThread::LODRequest(mMeshParams, mLOD));
+    for (const block_t& block : mBlocks) // <FS/> Coalesced mesh fetches
+    {
+        gMeshRepo.mThread->mUnavailableQ.enqueue(LLMeshRepoThread::LODRequest(mMeshParams, block.mLOD));
+    }
 }
 
 void LLMeshLODHandler::processData(LLCore::BufferArray * /* body */, S32 /* body_offset */,
@@ -3506,34 +3969,44 @@ void LLMeshLODHandler::processData(LLCore::BufferArray * /* body */, S32 /* body
     if ((!MESH_LOD_PROCESS_FAILED)
         && ((data != NULL) == (data_size > 0))) // if we have data but no size or have size but no data, something is wrong
     {
-        EMeshProcessingResult result = gMeshRepo.mThread->lodReceived(mMeshParams, mLOD, data, data_size);
-        if (result == MESH_OK)
+        // <FS> Coalesced mesh fetches: split the response into its LOD blocks
+        for (const block_t& block : mBlocks)
         {
-            // good fetch from sim, write to cache
-            LLFileSystem file(mMeshParams.getSculptID(), LLAssetType::AT_MESH, LLFileSystem::READ_WRITE);
+            S32 block_start = block.mOffset - (S32)mOffset;
+            S32 block_size = llmin(block.mSize, data_size - block_start);
+            EMeshProcessingResult result = MESH_NO_DATA;
+            if (block_start >= 0 && block_size > 0)
+            {
+                result = gMeshRepo.mThread->lodReceived(mMeshParams, block.mLOD, data + block_start, block_size);
+            }
+            if (result == MESH_OK)
+            {
+                // good fetch from sim, write to cache
+                LLFileSystem file(mMeshParams.getSculptID(), LLAssetType::AT_MESH, LLFileSystem::READ_WRITE);
 
-            S32 offset = mOffset;
-            S32 size = mRequestedBytes;
+                S32 offset = block.mOffset;
+                S32 size = block.mSize;
 
-            if (file.getSize() >= offset+size)
+                if (block_size == size && file.getSize() >= offset+size)
+                {
+                    file.seek(offset);
+                    file.write(data + block_start, size);
+                    LLMeshRepository::sCacheBytesWritten += size;
+                    ++LLMeshRepository::sCacheWrites;
+                }
+            }
+            else
             {
-                file.seek(offset);
-                file.write(data, size);
-                LLMeshRepository::sCacheBytesWritten += size;
-                ++LLMeshRepository::sCacheWrites;
+                LL_WARNS(LOG_MESH) << "Error during mesh LOD processing.  ID:  " << mMeshParams.getSculptID()
+                                   << ", Reason: " << result
+                                   << " LOD: " << block.mLOD
+                                   << " Data size: " << data_size
+                                   << " Not retrying."
+                                   << LL_ENDL;
+                gMeshRepo.mThread->mUnavailableQ.enqueue(LLMeshRepoThread::LODRequest(mMeshParams, block.mLOD));
             }
         }
-        else
-        {
-            LL_WARNS(LOG_MESH) << "Error during mesh LOD processing.  ID:  " << mMeshParams.getSculptID()
-                               << ", Reason: " << result
-                               << " LOD: " << mLOD
-                               << " Data size: " << data_size
-                               << " Not retrying."
-                               << LL_ENDL;
-            LLMutexLock lock(gMeshRepo.mThread->mMutex);
-            gMeshRepo.mThread->mUnavailableQ.push_back(LLMeshRepoThread::LODRequest(mMeshParams, mLOD));
-        }
+        // </FS>
     }
     else
     {
@@ -3542,8 +4015,10 @@ void LLMeshLODHandler::processData(LLCore::BufferArray * /* body */, S32 /* body
                            << " LOD: " << mLOD
                            << " Data size: " << data_size
                            << LL_ENDL;
-        LLMutexLock lock(gMeshRepo.mThread->mMutex);
-        gMeshRepo.mThread->mUnavailableQ.push_back(LLMeshRepoThread::LODRequest(mMeshParams, mLOD));
+        for (const block_t& block : mBlocks) // <FS/> Coalesced mesh fetches
+        {
+            gMeshRepo.mThread->mUnavailableQ.enqueue(LLMeshRepoThread::LODRequest(mMeshParams, block.mLOD));
+        }
     }
 }
 
@@ -3561,8 +4036,7 @@ void LLMeshSkinInfoHandler::processFailure(LLCore::HttpStatus status)
                        << ", Reason:  " << status.toString()
                        << " (" << status.toTerseString() << ").  Not retrying."
                        << LL_ENDL;
-        LLMutexLock lock(gMeshRepo.mThread->mMutex);
-        gMeshRepo.mThread->mSkinUnavailableQ.emplace_back(mMeshID);
+        gMeshRepo.mThread->mSkinUnavailableQ.enqueue(LLMeshRepoThread::UUIDBasedRequest(mMeshID));
 }
 
 void LLMeshSkinInfoHandler::processData(LLCore::BufferArray * /* body */, S32 /* body_offset */,
@@ -3592,8 +4066,7 @@ void LLMeshSkinInfoHandler::processData(LLCore::BufferArray * /* body */, S32 /*
         LL_WARNS(LOG_MESH) << "Error during mesh skin info processing.  ID:  " << mMeshID
                            << ", Unknown reason.  Not retrying."
                            << LL_ENDL;
-        LLMutexLock lock(gMeshRepo.mThread->mMutex);
-        gMeshRepo.mThread->mSkinUnavailableQ.emplace_back(mMeshID);
+        gMeshRepo.mThread->mSkinUnavailableQ.enqueue(LLMeshRepoThread::UUIDBasedRequest(mMeshID));
     }
 }
 
@@ -3749,6 +4222,7 @@ void LLMeshRepository::shutdown()
     {
         apr_sleep(10);
     }
+    mThread->saveHeaderIndex(); // <FS/> Persistent mesh header index
     delete mThread;
     mThread = NULL;
 
@@ -3982,6 +4456,26 @@ void LLMeshRepository::notifyLoadedMeshes()
     }
     // </FS:Ansariel> [UDP Assets]
 
+    // <FS> Coalesced mesh fetches
+    static LLCachedControl<U32> mesh_speculative_bytes(gSavedSettings, "FSMeshSpeculativeFetchBytes");
+    LLMeshRepoThread::sMaxSpeculativeBytes = mesh_speculative_bytes();
+    // </FS>
+
+    // <FS> Persistent mesh header index, read on the repo thread once the
+    // cache location is settled
+    static LLCachedControl<U32> mesh_header_index_entries(gSavedSettings, "FSMeshHeaderIndexMaxEntries");
+    LLMeshRepoThread::sMaxHeaderIndexEntries = mesh_header_index_entries();
+    static bool header_index_requested = false;
+    if (!header_index_requested && LLMeshRepoThread::sMaxHeaderIndexEntries > 0)
+    {
+        header_index_requested = true;
+        mThread->mWorkQueue.post([=]()
+            {
+                mThread->loadHeaderIndex();
+            });
+    }
+    // </FS>
+
     //clean up completed upload threads
     for (std::vector<LLMeshUploadThread*>::iterator iter = mUploads.begin(); iter != mUploads.end(); )
     {
@@ -4315,7 +4809,11 @@ void LLMeshRepository::notifyMeshLoaded(const LLVolumeParams& mesh_params, LLVol
             LLVolume* sys_volume = LLPrimitive::getVolumeManager()->refVolume(mesh_params, detail);
             if (sys_volume)
             {
-                sys_volume->copyVolumeFaces(volume);
+                // <FS> The faces were optimized off the main thread and the
+                // loaded volume is discarded afterwards, so just take them
+                //sys_volume->copyVolumeFaces(volume);
+                sys_volume->swapVolumeFaces(volume);
+                // </FS>
                 sys_volume->setMeshAssetLoaded(true);
                 LLPrimitive::getVolumeManager()->unrefVolume(sys_volume);
             }
@@ -41,6 +41,7 @@
 #include "httpheaders.h"
 #include "httphandler.h"
 #include "llthread.h"
+#include "concurrentqueue.h" // <FS/> Lock-free mesh result queues
 
 #define LLCONVEXDECOMPINTER_STATIC 1
 
@@ -272,6 +273,9 @@ public:
     static S32 sRequestLowWater;
     static S32 sRequestHighWater;
     static S32 sRequestWaterLevel;          // Stats-use only, may read outside of thread
+    static U32 sMaxSpeculativeBytes;        // <FS> Upper bound of a coalesced header request, 0 to disable
+    static S32 sSpeculativeBytes;           // <FS> Running estimate of header + first needed blocks, repo thread only
+    static U32 sMaxHeaderIndexEntries;      // <FS> Size of the persistent header index, 0 to disable
 
     LLMutex*    mMutex;
     LLMutex*    mHeaderMutex;
@@ -281,6 +285,13 @@ public:
     typedef boost::unordered_map<LLUUID, std::pair<U32, LLMeshHeader>> mesh_header_map; // pair is header_size and data
     mesh_header_map mMeshHeader;
 
+    // <FS> Persistent mesh header index. Mesh assets never change, so a header
+    // parsed in an earlier session is as good as a fetched one and lets LOD
+    // requests go out without a header request first.
+    mesh_header_map mHeaderIndex;           // mHeaderMutex
+    std::unordered_set<LLUUID> mIndexedHeaders; // mHeaderMutex, entries of mMeshHeader taken from mHeaderIndex
+    // </FS>
+
     class HeaderRequest : public RequestStats
     {
     public:
@@ -303,9 +314,10 @@ public:
         LLVolumeParams  mMeshParams;
         S32 mLOD;
         F32 mScore;
+        U32 mMergedLODs; // <FS> Bitmask of other LODs of the same mesh to fetch along with mLOD
 
-        LODRequest(const LLVolumeParams&  mesh_params, S32 lod)
-            : RequestStats(), mMeshParams(mesh_params), mLOD(lod), mScore(0.f)
+        LODRequest(const LLVolumeParams&  mesh_params, S32 lod, U32 merged_lods = 0)
+            : RequestStats(), mMeshParams(mesh_params), mLOD(lod), mScore(0.f), mMergedLODs(merged_lods)
         {
         }
     };
@@ -351,11 +363,17 @@ public:
     //set of requested skin info
     std::deque<UUIDBasedRequest> mSkinRequests;
 
+    // <FS> Lock-free mesh result queues
+    // The result queues below are filled from the repo thread and HTTP
+    // handlers and drained by the main thread in notifyLoadedMeshes().
     // list of completed skin info requests
-    std::deque<LLPointer<LLMeshSkinInfo>> mSkinInfoQ;
+    //std::deque<LLPointer<LLMeshSkinInfo>> mSkinInfoQ;
+    moodycamel::ConcurrentQueue<LLPointer<LLMeshSkinInfo>> mSkinInfoQ;
 
     // list of skin info requests that have failed or are unavailaibe
-    std::deque<UUIDBasedRequest> mSkinUnavailableQ;
+    //std::deque<UUIDBasedRequest> mSkinUnavailableQ;
+    moodycamel::ConcurrentQueue<UUIDBasedRequest> mSkinUnavailableQ;
+    // </FS>
 
     //set of requested decompositions
     std::set<UUIDBasedRequest> mDecompositionRequests;
@@ -364,7 +382,8 @@ public:
     std::set<UUIDBasedRequest> mPhysicsShapeRequests;
 
     // list of completed Decomposition info requests
-    std::list<LLModel::Decomposition*> mDecompositionQ;
+    //std::list<LLModel::Decomposition*> mDecompositionQ;
+    moodycamel::ConcurrentQueue<LLModel::Decomposition*> mDecompositionQ; // <FS/> Lock-free mesh result queues
 
     //queue of requested headers
     std::queue<HeaderRequest> mHeaderReqQ;
@@ -373,10 +392,12 @@ public:
     std::queue<LODRequest> mLODReqQ;
 
     //queue of unavailable LODs (either asset doesn't exist or asset doesn't have desired LOD)
-    std::deque<LODRequest> mUnavailableQ;
+    //std::deque<LODRequest> mUnavailableQ;
+    moodycamel::ConcurrentQueue<LODRequest> mUnavailableQ; // <FS/> Lock-free mesh result queues
 
     //queue of successfully loaded meshes
-    std::deque<LoadedMesh> mLoadedQ;
+    //std::deque<LoadedMesh> mLoadedQ;
+    moodycamel::ConcurrentQueue<LoadedMesh> mLoadedQ; // <FS/> Lock-free mesh result queues
 
     //map of pending header requests and currently desired LODs
     typedef std::unordered_map<LLUUID, std::vector<S32> > pending_lod_map;
@@ -387,6 +408,14 @@ public:
     typedef std::unordered_map<LLUUID, LLPointer<LLMeshSkinInfo>> skin_map;
     skin_map mSkinMap;
 
+    // <FS> Shared skin info pool. The meshes of a kit often carry the very
+    // same skin block, parse it once and let their mSkinMap entries share the
+    // result. Keyed by a hash of the compressed block, repo thread only.
+    typedef std::unordered_map<U64, LLPointer<LLMeshSkinInfo>> skin_pool_t;
+    skin_pool_t mSkinPool;
+    size_t mSkinPoolPruneSize = 1024;
+    // </FS>
+
     // workqueue for processing generic requests
     LL::WorkQueue mWorkQueue;
 
@@ -419,7 +448,13 @@ public:
     void loadMeshLOD(const LLVolumeParams& mesh_params, S32 lod);
 
     bool fetchMeshHeader(const LLVolumeParams& mesh_params, bool can_retry = true);
-    bool fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod, bool can_retry = true);
+    bool fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod, bool can_retry = true, U32 merged_lods = 0);
+    void queueLODRequests(const LLVolumeParams& mesh_params, U32 lod_mask); // <FS/> Coalesced mesh fetches
+    // <FS> Persistent mesh header index
+    void loadHeaderIndex();
+    void saveHeaderIndex();
+    bool refetchIndexedHeader(const LLVolumeParams& mesh_params, S32 lod, U32 lod_mask);
+    // </FS>
     EMeshProcessingResult headerReceived(const LLVolumeParams& mesh_params, U8* data, S32 data_size);
     EMeshProcessingResult lodReceived(const LLVolumeParams& mesh_params, S32 lod, U8* data, S32 data_size);
     bool skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
@@ -134,6 +134,13 @@ LLNetMap::LLNetMap (const Params & p)
     mObjectImageCenterGlobal( gAgentCamera.getCameraPositionGlobal() ),
     mObjectRawImagep(),
     mObjectImagep(),
+    // <FS> Object layer tiles
+    mCollectObjectPoints(false),
+    mObjectTilesTPM(0.f),
+    mObjectTilesCenterX(0),
+    mObjectTilesCenterY(0),
+    mObjectTilesValid(false),
+    // </FS>
 // [SL:KB] - Patch: World-MinimapOverlay | Checked: 2012-06-20 (Catznip-3.3)
     mParcelImageCenterGlobal( gAgentCamera.getCameraPositionGlobal() ),
     mParcelRawImagep(),
@@ -502,6 +509,17 @@ void LLNetMap::draw()
 //          new_center.mV[VZ] = 0.f;
 //          mObjectImageCenterGlobal = viewPosToGlobal(llfloor(new_center.mV[VX]), llfloor(new_center.mV[VY]));
 // [SL:KB] - Patch: World-MinimapOverlay | Checked: 2012-06-20 (Catznip-3.3)
+            // <FS> Object layer tiles
+            static LLCachedControl<bool> object_tiles(gSavedSettings, "FSNetMapObjectTiles");
+            if (object_tiles)
+            {
+                updateObjectTiles(posCenterGlobal);
+            }
+            else
+            {
+            mObjectTiles.clear();
+            mObjectTilesValid = false;
+            // </FS>
             mObjectImageCenterGlobal = posCenterGlobal;
 // [/SL:KB]
 
@@ -514,6 +532,7 @@ void LLNetMap::draw()
             gObjectList.renderObjectsForMap(*this);
 
             mObjectImagep->setSubImage(mObjectRawImagep, 0, 0, mObjectImagep->getWidth(), mObjectImagep->getHeight());
+            } // <FS/> Object layer tiles
 
             map_timer.reset();
         }
@@ -1315,6 +1334,22 @@ void LLNetMap::showAvatarInspector(const LLUUID& avatar_id)
 
 void LLNetMap::renderScaledPointGlobal( const LLVector3d& pos, const LLColor4U &color, F32 radius_meters )
 {
+    // <FS> Object layer tiles
+    if (mCollectObjectPoints)
+    {
+        ObjectPoint point;
+        point.mX = (S64)floor(pos.mdV[VX] * mObjectMapTPM + 0.5);
+        point.mY = (S64)floor(pos.mdV[VY] * mObjectMapTPM + 0.5);
+        point.mColor = color.asRGBA();
+        point.mDiameter = ll_round(2 * radius_meters * mObjectMapTPM);
+        if (point.mDiameter > 0)
+        {
+            mObjectPoints.push_back(point);
+        }
+        return;
+    }
+    // </FS>
+
     LLVector3 local_pos;
     local_pos.setVec( pos - mObjectImageCenterGlobal );
 
@@ -1409,6 +1444,147 @@ void LLNetMap::renderPoint(const LLVector3 &pos_local, const LLColor4U &color,
     }
 }
 
+// <FS> Object layer tiles
+namespace
+{
+    constexpr S32 OBJECT_TILE_PIXELS = 32;
+
+    inline S64 floor_div(S64 value, S64 divisor)
+    {
+        return (value >= 0) ? value / divisor : -((-value + divisor - 1) / divisor);
+    }
+
+    inline void hash_combine(U64& hash, U64 value)
+    {
+        hash = (hash ^ value) * 1099511628211ULL;
+    }
+}
+
+void LLNetMap::updateObjectTiles(const LLVector3d& pos_center_global)
+{
+    const S32 image_size = (S32)mObjectImagep->getWidth();
+    const S32 tiles_per_side = image_size / OBJECT_TILE_PIXELS;
+    if (mObjectMapTPM != mObjectTilesTPM)
+    {
+        // Zoomed, the grid changed
+        mObjectTiles.clear();
+        mObjectTilesTPM = mObjectMapTPM;
+        mObjectTilesValid = false;
+    }
+
+    const F64 tpm = mObjectMapTPM;
+    const S64 center_x = floor_div((S64)floor(pos_center_global.mdV[VX] * tpm), OBJECT_TILE_PIXELS) * OBJECT_TILE_PIXELS;
+    const S64 center_y = floor_div((S64)floor(pos_center_global.mdV[VY] * tpm), OBJECT_TILE_PIXELS) * OBJECT_TILE_PIXELS;
+    const bool moved = !mObjectTilesValid || center_x != mObjectTilesCenterX || center_y != mObjectTilesCenterY;
+    mObjectTilesCenterX = center_x;
+    mObjectTilesCenterY = center_y;
+    mObjectTilesValid = true;
+    mObjectImageCenterGlobal.setVec((F64)center_x / tpm, (F64)center_y / tpm, pos_center_global.mdV[VZ]);
+
+    mObjectPoints.clear();
+    mCollectObjectPoints = true;
+    gObjectList.renderObjectsForMap(*this);
+    mCollectObjectPoints = false;
+
+    // Points by the tiles they touch, in drawing order
+    const S64 origin_x = center_x - image_size / 2;
+    const S64 origin_y = center_y - image_size / 2;
+    std::vector<std::vector<U32>> tile_points(tiles_per_side * tiles_per_side);
+    for (U32 i = 0; i < (U32)mObjectPoints.size(); ++i)
+    {
+        const ObjectPoint& point = mObjectPoints[i];
+        const S64 left = point.mX - point.mDiameter / 2 - origin_x;
+        const S64 bottom = point.mY - point.mDiameter / 2 - origin_y;
+        const S64 first_x = llmax(floor_div(left, OBJECT_TILE_PIXELS), (S64)0);
+        const S64 last_x = llmin(floor_div(left + point.mDiameter - 1, OBJECT_TILE_PIXELS), (S64)tiles_per_side - 1);
+        const S64 first_y = llmax(floor_div(bottom, OBJECT_TILE_PIXELS), (S64)0);
+        const S64 last_y = llmin(floor_div(bottom + point.mDiameter - 1, OBJECT_TILE_PIXELS), (S64)tiles_per_side - 1);
+        for (S64 ty = first_y; ty <= last_y; ++ty)
+        {
+            for (S64 tx = first_x; tx <= last_x; ++tx)
+            {
+                tile_points[ty * tiles_per_side + tx].push_back(i);
+            }
+        }
+    }
+
+    LLImageDataLock lock(mObjectRawImagep);
+    U32* image_data = (U32*)mObjectRawImagep->getData();
+    S32 dirty_left = image_size, dirty_bottom = image_size, dirty_right = 0, dirty_top = 0;
+    std::unordered_map<U64, ObjectTile> tiles;
+    tiles.reserve(tile_points.size());
+    for (S32 ty = 0; ty < tiles_per_side; ++ty)
+    {
+        for (S32 tx = 0; tx < tiles_per_side; ++tx)
+        {
+            const S64 tile_x = origin_x + tx * OBJECT_TILE_PIXELS;
+            const S64 tile_y = origin_y + ty * OBJECT_TILE_PIXELS;
+            const U64 key = ((U64)(U32)floor_div(tile_x, OBJECT_TILE_PIXELS) << 32) | (U64)(U32)floor_div(tile_y, OBJECT_TILE_PIXELS);
+            const std::vector<U32>& points = tile_points[ty * tiles_per_side + tx];
+
+            U64 hash = 14695981039346656037ULL;
+            for (U32 i : points)
+            {
+                const ObjectPoint& point = mObjectPoints[i];
+                hash_combine(hash, (U64)point.mX);
+                hash_combine(hash, (U64)point.mY);
+                hash_combine(hash, ((U64)point.mColor << 32) | (U32)point.mDiameter);
+            }
+
+            ObjectTile tile;
+            bool redrawn = false;
+            auto cached = mObjectTiles.find(key);
+            if (cached != mObjectTiles.end() && cached->second.mHash == hash)
+            {
+                tile = std::move(cached->second);
+            }
+            else
+            {
+                tile.mHash = hash;
+                tile.mPixels.assign(OBJECT_TILE_PIXELS * OBJECT_TILE_PIXELS, 0);
+                for (U32 i : points)
+                {
+                    const ObjectPoint& point = mObjectPoints[i];
+                    const S64 left = point.mX - point.mDiameter / 2 - tile_x;
+                    const S64 bottom = point.mY - point.mDiameter / 2 - tile_y;
+                    const S32 x_begin = (S32)llmax(left, (S64)0);
+                    const S32 x_end = (S32)llmin(left + point.mDiameter, (S64)OBJECT_TILE_PIXELS);
+                    const S32 y_begin = (S32)llmax(bottom, (S64)0);
+                    const S32 y_end = (S32)llmin(bottom + point.mDiameter, (S64)OBJECT_TILE_PIXELS);
+                    for (S32 y = y_begin; y < y_end; ++y)
+                    {
+                        std::fill_n(tile.mPixels.begin() + y * OBJECT_TILE_PIXELS + x_begin, x_end - x_begin, point.mColor);
+                    }
+                }
+                redrawn = true;
+            }
+
+            if (redrawn || moved)
+            {
+                const S32 image_x = tx * OBJECT_TILE_PIXELS;
+                const S32 image_y = ty * OBJECT_TILE_PIXELS;
+                for (S32 y = 0; y < OBJECT_TILE_PIXELS; ++y)
+                {
+                    memcpy(image_data + (image_y + y) * image_size + image_x, tile.mPixels.data() + y * OBJECT_TILE_PIXELS, OBJECT_TILE_PIXELS * sizeof(U32));
+                }
+                dirty_left = llmin(dirty_left, image_x);
+                dirty_bottom = llmin(dirty_bottom, image_y);
+                dirty_right = llmax(dirty_right, image_x + OBJECT_TILE_PIXELS);
+                dirty_top = llmax(dirty_top, image_y + OBJECT_TILE_PIXELS);
+            }
+            tiles.emplace(key, std::move(tile));
+        }
+    }
+    // Tiles that scrolled out of the image are dropped
+    mObjectTiles.swap(tiles);
+
+    if (dirty_right > dirty_left)
+    {
+        mObjectImagep->setSubImage(mObjectRawImagep, dirty_left, dirty_bottom, dirty_right - dirty_left, dirty_top - dirty_bottom);
+    }
+}
+// </FS>
+
 // [SL:KB] - Patch: World-MinimapOverlay | Checked: 2012-06-20 (Catznip-3.3)
 void LLNetMap::renderPropertyLinesForRegion(const LLViewerRegion* pRegion, const LLColor4U& clrOverlay)
 {
@@ -1561,6 +1737,7 @@ void LLNetMap::createObjectImage()
 {
     if (createImage(mObjectRawImagep))
         mObjectImagep = LLViewerTextureManager::getLocalTexture( mObjectRawImagep.get(), false);
+    mObjectTilesValid = false; // <FS/> Object layer tiles
     // <FS:Ansariel> Synchronize scale throughout instances
     //setScale(mScale);
     setScale(sScale);
@@ -35,6 +35,11 @@
 #include "llpointer.h"
 #include "llcoord.h"
 
+// <FS> Object layer tiles
+#include <unordered_map>
+#include <vector>
+// </FS>
+
 class LLColor4U;
 class LLImageRaw;
 class LLViewerTexture;
@@ -147,6 +152,36 @@ private:
 
     static bool     outsideSlop(S32 x, S32 y, S32 start_x, S32 start_y, S32 slop);
 
+    // <FS> Object layer tiles
+    // The object layer is kept as square tiles on a grid of global pixel
+    // coordinates. Each refresh only rasterizes and uploads the tiles
+    // whose objects changed, and the image center snaps to the grid so
+    // the tiles survive moving around.
+    void            updateObjectTiles(const LLVector3d& pos_center_global);
+
+    struct ObjectPoint
+    {
+        S64         mX;         // global pixel coordinates
+        S64         mY;
+        U32         mColor;
+        S32         mDiameter;
+    };
+
+    struct ObjectTile
+    {
+        U64                 mHash;
+        std::vector<U32>    mPixels;
+    };
+
+    std::vector<ObjectPoint>                mObjectPoints;
+    bool                                    mCollectObjectPoints;
+    std::unordered_map<U64, ObjectTile>     mObjectTiles;
+    F32                                     mObjectTilesTPM;
+    S64                                     mObjectTilesCenterX;
+    S64                                     mObjectTilesCenterY;
+    bool                                    mObjectTilesValid;
+    // </FS>
+
 //  bool            mUpdateNow;
 // [SL:KB] - Patch: World-MinimapOverlay | Checked: 2012-06-20 (Catznip-3.3)
     bool            mUpdateObjectImage;
@@ -1819,6 +1819,17 @@ void LLPanelGroupMembersSubTab::updateMembers()
     if (mMemberProgress == gdatap->mMembers.begin())
     {
         mMembersList->deleteAllItems();
+
+        // <FS> Bulk name lookup
+        // Ask for all missing names at once instead of a batch per frame
+        uuid_vec_t member_ids;
+        member_ids.reserve(gdatap->mMembers.size());
+        for (const auto& member : gdatap->mMembers)
+        {
+            member_ids.push_back(member.first);
+        }
+        LLAvatarNameCache::getInstance()->getNames(member_ids);
+        // </FS>
     }
 
     // <FS:Ansariel> Clear old callbacks so we don't end up adding people twice
@@ -247,7 +247,45 @@ namespace LLPerfStats
         {
             updateAvatarParams();
         }
+
+        // <FS> Performance trace
+        if (FSPerfStatsTrace::isActive())
+        {
+            traceFrame();
+        }
+        // </FS>
+    }
+
+    // <FS> Performance trace
+    // static
+    void StatsRecorder::traceStat(const StatsRecord& upd)
+    {
+        FSPerfStatsTrace::Record record{};
+        record.mFrame = gFrameCount;
+        record.mKind = static_cast<U8>(FSPerfStatsTrace::EKind::Stat);
+        record.mStatType = static_cast<U8>(upd.statType);
+        record.mObjType = static_cast<U8>(upd.objType);
+        record.mFlags = (upd.isRigged ? 1 : 0) | (upd.isHUD ? 2 : 0);
+        record.mValue = upd.time;
+        record.mID = (upd.objType == ObjType_t::OT_AVATAR) ? upd.avID : upd.objID;
+        FSPerfStatsTrace::record(record);
+    }
+
+    // static
+    void StatsRecorder::traceFrame()
+    {
+        // State of the autotune after this frame, tuningFlag holds the changes it is about to apply
+        FSPerfStatsTrace::Record record{};
+        record.mFrame = gFrameCount;
+        record.mKind = static_cast<U8>(FSPerfStatsTrace::EKind::Frame);
+        record.mFlags = belowTargetFPS ? 1 : 0;
+        record.mCount = (U32)llmax<int64_t>(tunedAvatars.load(), 0);
+        record.mTuning = tunables.tuningFlag;
+        record.mValue = renderAvatarMaxART_ns;
+        record.mValue2 = meanFrameTime;
+        FSPerfStatsTrace::record(record);
     }
+    // </FS>
 
     // clear buffers when we change region or need a hard reset.
     // static
@@ -35,9 +35,11 @@
 #include "lluuid.h"
 #include "llfasttimer.h"
 #include "blockingconcurrentqueue.h" // <FS:Beq/> reinstate faster queues
+#include "fsperfstatstrace.h" // <FS/> Performance trace
 #include "llapp.h"
 #include "llprofiler.h"
 #include "pipeline.h"
+#include "llvramaccounting.h" // <FS/> VRAM accounting
 
 // <FS:Beq> Additional logging options. These can skew inworld numbers so onyl use for debugging and tracking issues
 #ifdef TRACY_ENABLE
@@ -68,6 +70,11 @@ namespace LLPerfStats
     // called once per main loop iteration
     void updateClass();
 
+    // <FS> VRAM accounting: GPU memory currently held by a category or owner
+    inline S64 getVRAMBytes(LLVRAMCategory category) { return LLVRAMAccounting::getBytes(category); }
+    inline S64 getVRAMBytes(LLVRAMOwner owner) { return LLVRAMAccounting::getBytes(owner); }
+    // </FS>
+
 // Note if changing these, they should correspond with the log range of the correpsonding sliders
     static constexpr U64 ART_UNLIMITED_NANOS{50000000};
     static constexpr U64 ART_MINIMUM_NANOS{100000};
@@ -197,6 +204,12 @@ namespace LLPerfStats
         static inline void send(StatsRecord && upd)
         {
             LL_PROFILE_ZONE_SCOPED_CATEGORY_STATS;
+            // <FS> Performance trace
+            if (FSPerfStatsTrace::isActive())
+            {
+                traceStat(upd);
+            }
+            // </FS>
             StatsRecorder::getInstance().processUpdate(upd);
         }
 
@@ -243,6 +256,10 @@ namespace LLPerfStats
         static int countNearbyAvatars(S32 distance);
         static U64 getMeanTotalFrameTime();
         static void updateMeanFrameTime(U64 tot_frame_time_raw);
+        // <FS> Performance trace
+        static void traceStat(const StatsRecord& upd);
+        static void traceFrame();
+        // </FS>
 // StatsArray is a uint64_t for each possible statistic type.
         using StatsArray    = std::array<uint64_t, static_cast<size_t>(LLPerfStats::StatType_t::STATS_COUNT)>;
         using StatsMap      = std::unordered_map<LLUUID, StatsArray, FSUUIDHash>; // <FS:Beq/>
@@ -110,6 +110,11 @@ public:
     // probe has had at least one full update and is ready to render
     bool mComplete = false;
 
+    // <FS> Probe scheduler
+    // static geometry within the probe's radius was rebuilt since its last update started
+    bool mSceneChanged = false;
+    // </FS>
+
     // fade in parameter for this probe
     F32 mFadeIn = 0.f;
 
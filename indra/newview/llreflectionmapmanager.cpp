@@ -33,6 +33,7 @@
 #include "llviewercamera.h"
 #include "llspatialpartition.h"
 #include "llviewerregion.h"
+#include "llvramaccounting.h" // <FS/> VRAM accounting
 #include "pipeline.h"
 #include "llviewershadermgr.h"
 #include "llviewercontrol.h"
@@ -168,7 +169,20 @@ struct CompareProbeDistance
 
 static F32 update_score(LLReflectionMap* p)
 {
-    return gFrameTimeSeconds - p->mLastUpdateTime  - p->mDistance*0.1f;
+    // <FS> Probe scheduler
+    // Age, weighted by how much of the view the probe can cover, plus a
+    // bonus when geometry in it changed since its last update
+    //return gFrameTimeSeconds - p->mLastUpdateTime  - p->mDistance*0.1f;
+    static LLCachedControl<F32> change_bonus(gSavedSettings, "FSReflectionProbeChangeBonus", 10.f);
+    F32 center_distance = llmax(p->mDistance + p->mRadius, p->mRadius, 0.01f);
+    F32 coverage = p->mRadius / center_distance; // 1 from inside the probe, falls off with distance
+    F32 score = (gFrameTimeSeconds - p->mLastUpdateTime) * (0.5f + coverage) - p->mDistance*0.1f;
+    if (p->mSceneChanged)
+    {
+        score += change_bonus;
+    }
+    return score;
+    // </FS>
 }
 
 // return true if a is higher priority for an update than b
@@ -216,6 +230,8 @@ void LLReflectionMapManager::update()
         return;
     }
 
+    FS_GPU_PASS_TIMER(gPipeline.mGPUPassTimer, FSGPUPassTimer::PASS_REFLECTION_PROBES, "reflection probes"); // <FS/> GPU pass timers
+
     if (mPaused && gFrameTimeSeconds > mResumeTime)
     {
         resume();
@@ -225,6 +241,7 @@ void LLReflectionMapManager::update()
 
     if (!mRenderTarget.isComplete())
     {
+        LLVRAMAccounting::Scope vram_scope({ LLVRAMCategory::REFLECTION_PROBE }); // <FS/> VRAM accounting
         U32 color_fmt = GL_RGB16F;
         U32 targetRes = mProbeResolution * 4; // super sample
         mRenderTarget.allocate(targetRes, targetRes, color_fmt, true);
@@ -232,6 +249,7 @@ void LLReflectionMapManager::update()
 
     if (mMipChain.empty())
     {
+        LLVRAMAccounting::Scope vram_scope({ LLVRAMCategory::REFLECTION_PROBE }); // <FS/> VRAM accounting
         U32 res = mProbeResolution;
         U32 count = (U32)(log2((F32)res) + 0.5f);
 
@@ -286,10 +304,23 @@ void LLReflectionMapManager::update()
     LLReflectionMap* oldestProbe = nullptr;
     LLReflectionMap* oldestOccluded = nullptr;
 
+    // <FS> Probe scheduler
+    readStepTimers();
+    static LLCachedControl<F32> gpu_budget(gSavedSettings, "FSReflectionProbeGPUBudget", 1.f);
+    F32 budget_left = gpu_budget;
+    // </FS>
+
     if (mUpdatingProbe != nullptr)
     {
         did_update = true;
-        doProbeUpdate();
+        // <FS> Probe scheduler, carry on with this probe while its steps fit in the budget
+        //doProbeUpdate();
+        do
+        {
+            budget_left -= getNextStepCost();
+            doProbeUpdate();
+        } while (mUpdatingProbe != nullptr && getNextStepCost() <= budget_left);
+        // </FS>
     }
 
     // update distance to camera for all probes
@@ -388,7 +419,10 @@ void LLReflectionMapManager::update()
         }
         else
         {
-            if (!did_update &&
+            // <FS> Probe scheduler, pick the next probe whenever none is in progress
+            //if (!did_update &&
+            if (mUpdatingProbe == nullptr &&
+            // </FS>
                 i < mReflectionProbeCount &&
                 (oldestProbe == nullptr ||
                     check_priority(probe, oldestProbe)))
@@ -426,8 +460,19 @@ void LLReflectionMapManager::update()
         mRadiancePass = mRealtimeRadiancePass;
         for (U32 i = 0; i < 6; ++i)
         {
+            // <FS> Probe scheduler
+            //updateProbeFace(closestDynamic, i);
+            beginStepTimer(STEP_FACE);
             updateProbeFace(closestDynamic, i);
+            endStepTimer();
+            // </FS>
         }
+        // <FS> Probe scheduler
+        beginStepTimer(STEP_FILTER);
+        filterProbe(closestDynamic);
+        endStepTimer();
+        budget_left -= mStepCost[STEP_FACE] * 6.f + mStepCost[STEP_FILTER];
+        // </FS>
         mRealtimeRadiancePass = !mRealtimeRadiancePass;
 
         // restore "isRadiancePass"
@@ -448,7 +493,11 @@ void LLReflectionMapManager::update()
     }
 
     // switch to updating the next oldest probe
-    if (!did_update && oldestProbe != nullptr)
+    // <FS> Probe scheduler, also when the last one finished with budget to spare
+    //if (!did_update && oldestProbe != nullptr)
+    if (mUpdatingProbe == nullptr && oldestProbe != nullptr &&
+        (!did_update || getNextStepCost() <= budget_left))
+    // </FS>
     {
         LLReflectionMap* probe = oldestProbe;
         llassert(probe->mCubeIndex != -1);
@@ -457,7 +506,15 @@ void LLReflectionMapManager::update()
 
         sUpdateCount++;
         mUpdatingProbe = probe;
-        doProbeUpdate();
+        // <FS> Probe scheduler
+        //doProbeUpdate();
+        probe->mSceneChanged = false;
+        do
+        {
+            budget_left -= getNextStepCost();
+            doProbeUpdate();
+        } while (mUpdatingProbe != nullptr && getNextStepCost() <= budget_left);
+        // </FS>
     }
 
     if (oldestOccluded)
@@ -655,11 +712,28 @@ void LLReflectionMapManager::doProbeUpdate()
     LL_PROFILE_ZONE_SCOPED_CATEGORY_DISPLAY;
     llassert(mUpdatingProbe != nullptr);
 
-    updateProbeFace(mUpdatingProbe, mUpdatingFace);
+    // <FS> Probe scheduler, filtering is a step of its own so it can land in another frame than the last face
+    //updateProbeFace(mUpdatingProbe, mUpdatingFace);
+    if (mUpdatingFace < 6)
+    {
+        beginStepTimer(STEP_FACE);
+        updateProbeFace(mUpdatingProbe, mUpdatingFace);
+        endStepTimer();
+    }
+    else
+    {
+        beginStepTimer(STEP_FILTER);
+        filterProbe(mUpdatingProbe);
+        endStepTimer();
+    }
+    // </FS>
 
     bool debug_updates = gPipeline.hasRenderDebugMask(LLPipeline::RENDER_DEBUG_PROBE_UPDATES) && mUpdatingProbe->mViewerObject;
 
-    if (++mUpdatingFace == 6)
+    // <FS> Probe scheduler
+    //if (++mUpdatingFace == 6)
+    if (++mUpdatingFace == 7)
+    // </FS>
     {
         if (debug_updates)
         {
@@ -692,6 +766,7 @@ void LLReflectionMapManager::doProbeUpdate()
 // The next six passes render the scene with both radiance and irradiance into the same scratch space cube map and generate a simple mip chain.
 // At the end of these passes, a radiance map is generated for this probe and placed into the radiance cube map array at the index for this probe.
 // In effect this simulates single-bounce lighting.
+// <FS/> The irradiance and radiance maps are generated by filterProbe() once the six faces are done.
 void LLReflectionMapManager::updateProbeFace(LLReflectionMap* probe, U32 face)
 {
     // hacky hot-swap of camera specific render targets
@@ -832,111 +907,231 @@ void LLReflectionMapManager::updateProbeFace(LLReflectionMap* probe, U32 face)
         gGL.getTexUnit(diffuseChannel)->unbind(LLTexUnit::TT_TEXTURE);
         gReflectionMipProgram.unbind();
     }
+}
 
-    if (face == 5)
-    {
-        mMipChain[0].bindTarget();
-        static LLStaticHashedString sSourceIdx("sourceIdx");
+// <FS> Probe scheduler
+// Formerly the end of updateProbeFace() for face 5
+void LLReflectionMapManager::filterProbe(LLReflectionMap* probe)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_DISPLAY;
 
-        if (isRadiancePass())
-        {
-            //generate radiance map (even if this is not the irradiance map, we need the mip chain for the irradiance map)
-            gRadianceGenProgram.bind();
-            mVertexBuffer->setBuffer();
+    S32 sourceIdx = mReflectionProbeCount;
 
-            S32 channel = gRadianceGenProgram.enableTexture(LLShaderMgr::REFLECTION_PROBES, LLTexUnit::TT_CUBE_MAP_ARRAY);
-            mTexture->bind(channel);
-            gRadianceGenProgram.uniform1i(sSourceIdx, sourceIdx);
-            gRadianceGenProgram.uniform1f(LLShaderMgr::REFLECTION_PROBE_MAX_LOD, mMaxProbeLOD);
-            gRadianceGenProgram.uniform1f(LLShaderMgr::REFLECTION_PROBE_STRENGTH, 1.f);
+    if (probe != mUpdatingProbe)
+    { // this is the "realtime" probe that's updating every frame, use the secondary scratch space channel
+        sourceIdx += 1;
+    }
 
-            U32 res = mMipChain[0].getWidth();
+    gGL.setColorMask(true, true);
+    LLGLDepthTest depth(GL_FALSE, GL_FALSE);
+    LLGLDisable cull(GL_CULL_FACE);
+    LLGLDisable blend(GL_BLEND);
 
-            for (int i = 0; i < mMipChain.size(); ++i)
-            {
-                LL_PROFILE_GPU_ZONE("probe radiance gen");
-                static LLStaticHashedString sMipLevel("mipLevel");
-                static LLStaticHashedString sRoughness("roughness");
-                static LLStaticHashedString sWidth("u_width");
+    mMipChain[0].bindTarget();
+    static LLStaticHashedString sSourceIdx("sourceIdx");
 
-                gRadianceGenProgram.uniform1f(sRoughness, (F32)i / (F32)(mMipChain.size() - 1));
-                gRadianceGenProgram.uniform1f(sMipLevel, (GLfloat)i);
-                gRadianceGenProgram.uniform1i(sWidth, mProbeResolution);
+    if (isRadiancePass())
+    {
+        //generate radiance map (even if this is not the irradiance map, we need the mip chain for the irradiance map)
+        gRadianceGenProgram.bind();
+        mVertexBuffer->setBuffer();
 
-                for (int cf = 0; cf < 6; ++cf)
-                { // for each cube face
-                    LLCoordFrame frame;
-                    frame.lookAt(LLVector3(0, 0, 0), LLCubeMapArray::sClipToCubeLookVecs[cf], LLCubeMapArray::sClipToCubeUpVecs[cf]);
+        S32 channel = gRadianceGenProgram.enableTexture(LLShaderMgr::REFLECTION_PROBES, LLTexUnit::TT_CUBE_MAP_ARRAY);
+        mTexture->bind(channel);
+        gRadianceGenProgram.uniform1i(sSourceIdx, sourceIdx);
+        gRadianceGenProgram.uniform1f(LLShaderMgr::REFLECTION_PROBE_MAX_LOD, mMaxProbeLOD);
+        gRadianceGenProgram.uniform1f(LLShaderMgr::REFLECTION_PROBE_STRENGTH, 1.f);
 
-                    F32 mat[16];
-                    frame.getOpenGLRotation(mat);
-                    gGL.loadMatrix(mat);
+        U32 res = mMipChain[0].getWidth();
 
-                    mVertexBuffer->drawArrays(gGL.TRIANGLE_STRIP, 0, 4);
+        for (int i = 0; i < mMipChain.size(); ++i)
+        {
+            LL_PROFILE_GPU_ZONE("probe radiance gen");
+            static LLStaticHashedString sMipLevel("mipLevel");
+            static LLStaticHashedString sRoughness("roughness");
+            static LLStaticHashedString sWidth("u_width");
 
-                    glCopyTexSubImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, i, 0, 0, probe->mCubeIndex * 6 + cf, 0, 0, res, res);
-                }
+            gRadianceGenProgram.uniform1f(sRoughness, (F32)i / (F32)(mMipChain.size() - 1));
+            gRadianceGenProgram.uniform1f(sMipLevel, (GLfloat)i);
+            gRadianceGenProgram.uniform1i(sWidth, mProbeResolution);
 
-                if (i != mMipChain.size() - 1)
-                {
-                    res /= 2;
-                    glViewport(0, 0, res, res);
-                }
+            for (int cf = 0; cf < 6; ++cf)
+            { // for each cube face
+                LLCoordFrame frame;
+                frame.lookAt(LLVector3(0, 0, 0), LLCubeMapArray::sClipToCubeLookVecs[cf], LLCubeMapArray::sClipToCubeUpVecs[cf]);
+
+                F32 mat[16];
+                frame.getOpenGLRotation(mat);
+                gGL.loadMatrix(mat);
+
+                mVertexBuffer->drawArrays(gGL.TRIANGLE_STRIP, 0, 4);
+
+                glCopyTexSubImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, i, 0, 0, probe->mCubeIndex * 6 + cf, 0, 0, res, res);
             }
 
-            gRadianceGenProgram.unbind();
+            if (i != mMipChain.size() - 1)
+            {
+                res /= 2;
+                glViewport(0, 0, res, res);
+            }
         }
-        else
+
+        gRadianceGenProgram.unbind();
+    }
+    else
+    {
+        //generate irradiance map
+        gIrradianceGenProgram.bind();
+        S32 channel = gIrradianceGenProgram.enableTexture(LLShaderMgr::REFLECTION_PROBES, LLTexUnit::TT_CUBE_MAP_ARRAY);
+        mTexture->bind(channel);
+
+        gIrradianceGenProgram.uniform1i(sSourceIdx, sourceIdx);
+        gIrradianceGenProgram.uniform1f(LLShaderMgr::REFLECTION_PROBE_MAX_LOD, mMaxProbeLOD);
+
+        mVertexBuffer->setBuffer();
+        int start_mip = 0;
+        // find the mip target to start with based on irradiance map resolution
+        for (start_mip = 0; start_mip < mMipChain.size(); ++start_mip)
         {
-            //generate irradiance map
-            gIrradianceGenProgram.bind();
-            S32 channel = gIrradianceGenProgram.enableTexture(LLShaderMgr::REFLECTION_PROBES, LLTexUnit::TT_CUBE_MAP_ARRAY);
-            mTexture->bind(channel);
-
-            gIrradianceGenProgram.uniform1i(sSourceIdx, sourceIdx);
-            gIrradianceGenProgram.uniform1f(LLShaderMgr::REFLECTION_PROBE_MAX_LOD, mMaxProbeLOD);
-
-            mVertexBuffer->setBuffer();
-            int start_mip = 0;
-            // find the mip target to start with based on irradiance map resolution
-            for (start_mip = 0; start_mip < mMipChain.size(); ++start_mip)
+            if (mMipChain[start_mip].getWidth() == LL_IRRADIANCE_MAP_RESOLUTION)
             {
-                if (mMipChain[start_mip].getWidth() == LL_IRRADIANCE_MAP_RESOLUTION)
-                {
-                    break;
-                }
+                break;
             }
+        }
 
-            //for (int i = start_mip; i < mMipChain.size(); ++i)
-            {
-                int i = start_mip;
-                LL_PROFILE_GPU_ZONE("probe irradiance gen");
-                glViewport(0, 0, mMipChain[i].getWidth(), mMipChain[i].getHeight());
-                for (int cf = 0; cf < 6; ++cf)
-                { // for each cube face
-                    LLCoordFrame frame;
-                    frame.lookAt(LLVector3(0, 0, 0), LLCubeMapArray::sClipToCubeLookVecs[cf], LLCubeMapArray::sClipToCubeUpVecs[cf]);
-
-                    F32 mat[16];
-                    frame.getOpenGLRotation(mat);
-                    gGL.loadMatrix(mat);
-
-                    mVertexBuffer->drawArrays(gGL.TRIANGLE_STRIP, 0, 4);
-
-                    S32 res = mMipChain[i].getWidth();
-                    mIrradianceMaps->bind(channel);
-                    glCopyTexSubImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, i - start_mip, 0, 0, probe->mCubeIndex * 6 + cf, 0, 0, res, res);
-                    mTexture->bind(channel);
-                }
+        //for (int i = start_mip; i < mMipChain.size(); ++i)
+        {
+            int i = start_mip;
+            LL_PROFILE_GPU_ZONE("probe irradiance gen");
+            glViewport(0, 0, mMipChain[i].getWidth(), mMipChain[i].getHeight());
+            for (int cf = 0; cf < 6; ++cf)
+            { // for each cube face
+                LLCoordFrame frame;
+                frame.lookAt(LLVector3(0, 0, 0), LLCubeMapArray::sClipToCubeLookVecs[cf], LLCubeMapArray::sClipToCubeUpVecs[cf]);
+
+                F32 mat[16];
+                frame.getOpenGLRotation(mat);
+                gGL.loadMatrix(mat);
+
+                mVertexBuffer->drawArrays(gGL.TRIANGLE_STRIP, 0, 4);
+
+                S32 res = mMipChain[i].getWidth();
+                mIrradianceMaps->bind(channel);
+                glCopyTexSubImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, i - start_mip, 0, 0, probe->mCubeIndex * 6 + cf, 0, 0, res, res);
+                mTexture->bind(channel);
             }
         }
+    }
+
+    mMipChain[0].flush();
+
+    gIrradianceGenProgram.unbind();
+}
+
+void LLReflectionMapManager::markSceneChanged(U32 partition_type, const LLVector4a* extents)
+{
+    if (partition_type == LLViewerRegion::PARTITION_AVATAR || partition_type == LLViewerRegion::PARTITION_CONTROL_AV)
+    {
+        return;
+    }
+
+    for (auto& probe : mProbes)
+    {
+        if (probe == mDefaultProbe || probe->mCubeIndex == -1 || probe->mSceneChanged)
+        {
+            continue;
+        }
 
-        mMipChain[0].flush();
+        // distance from the probe's origin to the closest point of the box
+        LLVector4a closest;
+        closest.setMax(extents[0], probe->mOrigin);
+        closest.setMin(closest, extents[1]);
+        closest.sub(probe->mOrigin);
+        if (closest.getLength3().getF32() <= probe->mRadius)
+        {
+            probe->mSceneChanged = true;
+        }
+    }
+}
 
-        gIrradianceGenProgram.unbind();
+F32 LLReflectionMapManager::getNextStepCost() const
+{
+    return mStepCost[(mUpdatingProbe != nullptr && mUpdatingFace == 6) ? STEP_FILTER : STEP_FACE];
+}
+
+void LLReflectionMapManager::beginStepTimer(U32 step)
+{
+    StepTimer& timer = mStepTimers[mNextStepTimer];
+    if (timer.mPending)
+    { // every timer still waits on its result, leave this step unmeasured
+        return;
     }
+
+    if (timer.mQueries[0] == 0)
+    {
+        glGenQueries(2, timer.mQueries);
+    }
+
+    glQueryCounter(timer.mQueries[0], GL_TIMESTAMP);
+    timer.mStep = step;
+    mActiveStepTimer = &timer;
+    mNextStepTimer = (mNextStepTimer + 1) % STEP_TIMER_COUNT;
 }
 
+void LLReflectionMapManager::endStepTimer()
+{
+    if (mActiveStepTimer)
+    {
+        glQueryCounter(mActiveStepTimer->mQueries[1], GL_TIMESTAMP);
+        mActiveStepTimer->mPending = true;
+        mActiveStepTimer = nullptr;
+    }
+}
+
+void LLReflectionMapManager::readStepTimers()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_DISPLAY;
+
+    for (StepTimer& timer : mStepTimers)
+    {
+        if (!timer.mPending)
+        {
+            continue;
+        }
+
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(timer.mQueries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_TRUE)
+        {
+            GLuint64 begin = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(timer.mQueries[0], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(timer.mQueries[1], GL_QUERY_RESULT, &end);
+            if (end > begin)
+            {
+                F32 ms = (F32)((end - begin) / 1000000.0);
+                mStepCost[timer.mStep] = lerp(mStepCost[timer.mStep], ms, 0.1f);
+            }
+            timer.mPending = false;
+        }
+    }
+}
+
+void LLReflectionMapManager::releaseStepTimers()
+{
+    for (StepTimer& timer : mStepTimers)
+    {
+        if (timer.mQueries[0] != 0)
+        {
+            glDeleteQueries(2, timer.mQueries);
+        }
+        timer = StepTimer();
+    }
+    mActiveStepTimer = nullptr;
+    mNextStepTimer = 0;
+}
+// </FS>
+
 void LLReflectionMapManager::reset()
 {
     mReset = true;
@@ -1507,6 +1702,8 @@ void LLReflectionMapManager::cleanup()
     glDeleteBuffers(1, &mUBO);
     mUBO = 0;
 
+    releaseStepTimers(); // <FS/> Probe scheduler
+
     // note: also called on teleport (not just shutdown), so make sure we're in a good "starting" state
     initCubeFree();
 }
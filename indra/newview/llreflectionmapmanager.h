@@ -109,6 +109,13 @@ public:
     // perform occlusion culling on all active reflection probes
     void doOcclusion();
 
+    // <FS> Probe scheduler
+    // Raise the update priority of the probes that overlap the extents
+    // (min, max, in agent space) of geometry of a partition of
+    // partition_type that was rebuilt
+    void markSceneChanged(U32 partition_type, const LLVector4a* extents);
+    // </FS>
+
     // *HACK: "cull" all reflection probes except the default one. Only call
     // this if you don't intend to call updateUniforms directly. Call again
     // with false when done.
@@ -161,6 +168,45 @@ private:
     // update the specified face of the specified probe
     void updateProbeFace(LLReflectionMap* probe, U32 face);
 
+    // <FS> Probe scheduler
+    // generate the irradiance or radiance map of the given probe from its six rendered faces
+    void filterProbe(LLReflectionMap* probe);
+
+    // The steps of a probe update are six face renders and a filter pass,
+    // for the irradiance then the radiance map. As many steps as fit in
+    // FSReflectionProbeGPUBudget run each frame, at least one. Their cost
+    // is learnt from timestamp queries read back a few frames later.
+    enum eUpdateStep
+    {
+        STEP_FACE = 0,
+        STEP_FILTER,
+        STEP_COUNT
+    };
+
+    struct StepTimer
+    {
+        GLuint  mQueries[2] = { 0, 0 }; // timestamps before and after the step
+        U32     mStep = STEP_FACE;
+        bool    mPending = false;
+    };
+
+    static constexpr U32 STEP_TIMER_COUNT = 32;
+
+    // estimated GPU time in ms of the next step of mUpdatingProbe
+    F32 getNextStepCost() const;
+    void beginStepTimer(U32 step);
+    void endStepTimer();
+    void readStepTimers();
+    void releaseStepTimers();
+
+    StepTimer mStepTimers[STEP_TIMER_COUNT];
+    StepTimer* mActiveStepTimer = nullptr;
+    U32 mNextStepTimer = 0;
+
+    // moving average of the GPU time of each kind of step in ms
+    F32 mStepCost[STEP_COUNT] = { 1.f, 1.f };
+    // </FS>
+
     // list of active reflection maps
     std::vector<LLPointer<LLReflectionMap> > mProbes;
 
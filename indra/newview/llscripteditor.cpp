@@ -49,7 +49,13 @@ LLScriptEditor::Params::Params()
 LLScriptEditor::LLScriptEditor(const Params& p)
 :   LLTextEditor(p)
 ,   mShowLineNumbers(p.show_line_numbers),
-    mUseDefaultFontSize(p.default_font_size)
+    mUseDefaultFontSize(p.default_font_size),
+    // <FS> Incremental syntax highlighting
+    mLexedFont(NULL),
+    mChangedStart(S32_MAX),
+    mChangedEnd(-1),
+    mChangedLength(0)
+    // </FS>
 {
     if (mShowLineNumbers)
     {
@@ -172,6 +178,7 @@ void LLScriptEditor::loadKeywords()
     {
         insert_it = mSegments.insert(insert_it, *list_it);
     }
+    setSegmentsLexed(); // <FS/> Incremental syntax highlighting
 }
 
 // <FS:Ansariel> Re-add legacy format support
@@ -199,6 +206,7 @@ void LLScriptEditor::loadKeywords(const std::string& filename,
         {
             insert_it = mSegments.insert(insert_it, *list_it);
         }
+        setSegmentsLexed(); // <FS/> Incremental syntax highlighting
     }
 }
 // </FS:Ansariel>
@@ -215,18 +223,129 @@ void LLScriptEditor::updateSegments()
 
         // HACK:  No non-ascii keywords for now
         segment_vec_t segment_list;
-        mKeywords.findSegments(&segment_list, getWText(), *this, style);
-
-        clearSegments();
-        for (segment_vec_t::iterator list_it = segment_list.begin(); list_it != segment_list.end(); ++list_it)
+        // <FS> Incremental syntax highlighting
+        //mKeywords.findSegments(&segment_list, getWText(), *this, style);
+        //
+        //clearSegments();
+        //for (segment_vec_t::iterator list_it = segment_list.begin(); list_it != segment_list.end(); ++list_it)
+        //{
+        //    insertSegment(*list_it);
+        //}
+        static LLCachedControl<bool> incremental_highlighting(gSavedSettings, "FSIncrementalSyntaxHighlighting", true);
+        S32 start = 0, end = 0;
+        const bool segments_lexed = mLexedSegment.notNull() && !mSegments.empty() && *mSegments.begin() == mLexedSegment &&
+                                    mLexedFont == getFont() && mLexedColor == mDefaultColor.get();
+        if (incremental_highlighting && segments_lexed && mChangedStart > mChangedEnd)
         {
-            insertSegment(*list_it);
+            // Reflow without an edit, the segments are still up to date
         }
+        else if (incremental_highlighting && segments_lexed &&
+                 mKeywords.findChangedSegments(&segment_list, getWText(), *this, style, mChangedStart, mChangedEnd, start, end))
+        {
+            replaceSegments(start, end, segment_list);
+        }
+        else
+        {
+            mKeywords.findSegments(&segment_list, getWText(), *this, style);
+
+            clearSegments();
+            for (segment_vec_t::iterator list_it = segment_list.begin(); list_it != segment_list.end(); ++list_it)
+            {
+                insertSegment(*list_it);
+            }
+        }
+        LLTextBase::updateSegments();
+        setSegmentsLexed();
+        // </FS>
     }
 
     LLTextBase::updateSegments();
 }
 
+// <FS> Incremental syntax highlighting
+void LLScriptEditor::onValueChange(S32 start, S32 end)
+{
+    LLTextEditor::onValueChange(start, end);
+
+    // Keep the tracked range in positions of the current text
+    const S32 length = getLength();
+    const S32 delta = length - mChangedLength;
+    mChangedLength = length;
+    if (mChangedStart > mChangedEnd)
+    {
+        mChangedStart = start;
+        mChangedEnd = end;
+        return;
+    }
+
+    if (delta >= 0)
+    {
+        // Inserted at start
+        mChangedStart += (mChangedStart >= start) ? delta : 0;
+        mChangedEnd += (mChangedEnd >= start) ? delta : 0;
+    }
+    else
+    {
+        // Removed from start on
+        const S32 removed_end = start - delta;
+        mChangedStart = (mChangedStart >= removed_end) ? mChangedStart + delta : llmin(mChangedStart, start);
+        mChangedEnd = (mChangedEnd >= removed_end) ? mChangedEnd + delta : llmin(mChangedEnd, start);
+    }
+    mChangedStart = llmin(mChangedStart, start);
+    mChangedEnd = llmax(mChangedEnd, end);
+}
+
+void LLScriptEditor::replaceSegments(S32 start, S32 end, const segment_vec_t& segment_list)
+{
+    // Cut [start, end) out of the segments, the ones around it may have
+    // been stretched over it by the edits
+    segment_set_t::iterator seg_it = getSegIterContaining(start);
+    while (seg_it != mSegments.end() && (*seg_it)->getStart() < end)
+    {
+        LLTextSegmentPtr segmentp = *seg_it;
+        if (segmentp->getStart() < start)
+        {
+            if (segmentp->getEnd() > end)
+            {
+                LLTextSegmentPtr remainder_segment = new LLNormalTextSegment(segmentp->getStyle(), end, segmentp->getEnd(), *this);
+                segmentp->setEnd(start);
+                mSegments.insert(remainder_segment);
+                remainder_segment->linkToDocument(this);
+                break;
+            }
+            segmentp->setEnd(start);
+            ++seg_it;
+        }
+        else if (segmentp->getEnd() <= end)
+        {
+            segmentp->unlinkFromDocument(this);
+            seg_it = mSegments.erase(seg_it);
+        }
+        else
+        {
+            segmentp->setStart(end);
+            break;
+        }
+    }
+
+    for (const LLTextSegmentPtr& segmentp : segment_list)
+    {
+        mSegments.insert(segmentp);
+        segmentp->linkToDocument(this);
+    }
+}
+
+void LLScriptEditor::setSegmentsLexed()
+{
+    mLexedSegment = mSegments.empty() ? NULL : *mSegments.begin();
+    mLexedFont = getFont();
+    mLexedColor = mDefaultColor.get();
+    mChangedStart = S32_MAX;
+    mChangedEnd = -1;
+    mChangedLength = getLength();
+}
+// </FS>
+
 void LLScriptEditor::clearSegments()
 {
     if (!mSegments.empty())
@@ -78,6 +78,11 @@ private:
     void    drawLineNumbers();
     /* virtual */ void  updateSegments();
     /* virtual */ void  drawSelectionBackground();
+    // <FS> Incremental syntax highlighting
+    /* virtual */ void  onValueChange(S32 start, S32 end);
+    void    replaceSegments(S32 start, S32 end, const segment_vec_t& segment_list);
+    void    setSegmentsLexed();
+    // </FS>
     // <FS:Ansariel> Doesn't exist
     //void  loadKeywords(const std::string& filename_keywords,
     //                   const std::string& filename_colors);
@@ -88,6 +93,19 @@ private:
     LLKeywords  mKeywords;
     bool        mShowLineNumbers;
     bool mUseDefaultFontSize;
+
+    // <FS> Incremental syntax highlighting
+    // First segment after the last lexing; anything that replaced the
+    // segments since, like setText(), also replaced this one
+    LLTextSegmentPtr    mLexedSegment;
+    const LLFontGL*     mLexedFont;
+    LLColor4            mLexedColor;
+    // Positions touched by edits since the last lexing, in current text
+    // positions; empty while mChangedStart > mChangedEnd
+    S32                 mChangedStart;
+    S32                 mChangedEnd;
+    S32                 mChangedLength;
+    // </FS>
 };
 
 #endif // LL_SCRIPTEDITOR_H
@@ -98,6 +98,7 @@
 #include "llvovolume.h"
 #include "pipeline.h"
 #include "llviewershadermgr.h"
+#include "llcallbacklist.h" // <FS/> Batched selection requests
 // #include "llpanelface.h"  // <FS:Zi> switchable edit texture/materials panel - include not needed
 // [RLVa:KB] - Checked: 2011-05-22 (RLVa-1.3.1a)
 #include "rlvactions.h"
@@ -121,6 +122,11 @@ LLViewerObject* getSelectedParentObject(LLViewerObject *object) ;
 constexpr F32 SILHOUETTE_UPDATE_THRESHOLD_SQUARED = 0.02f;
 constexpr S32 MAX_SILS_PER_FRAME = 50;
 constexpr S32 MAX_OBJECTS_PER_PACKET = 254;
+// <FS> Batched selection requests
+// ObjectProperties replies to a large selection arrive over many messages,
+// the floaters are refreshed once after the ones of a frame
+static bool sPropertiesRefreshPending = false;
+// </FS>
 // For linked sets
 // <FS:Ansariel> Moved to header to make them publically accessible
 //constexpr S32 MAX_CHILDREN_PER_TASK = 255;
@@ -5933,6 +5939,41 @@ void LLSelectMgr::sendListToRegions(LLObjectSelectionHandle selected_handle,
         return;
     }
 
+    // <FS> Batched selection requests, a new message is started whenever the
+    // region changes, so keep the objects of each region together instead of
+    // sending a packet per region change of an interleaved selection. The
+    // order within a region is kept. Links keep their order as a whole, the
+    // first object becomes the root.
+    if (!link_operation && nodes_to_send.size() > 1)
+    {
+        std::vector<LLSelectNode*> nodes;
+        nodes.reserve(nodes_to_send.size());
+        std::vector<LLViewerRegion*> regions;
+        while (!nodes_to_send.empty())
+        {
+            LLSelectNode* queued = nodes_to_send.front();
+            nodes_to_send.pop();
+            nodes.push_back(queued);
+            LLViewerRegion* region = queued->getObject()->getRegion();
+            if (std::find(regions.begin(), regions.end(), region) == regions.end())
+            {
+                regions.push_back(region);
+            }
+        }
+
+        for (LLViewerRegion* region : regions)
+        {
+            for (LLSelectNode* queued : nodes)
+            {
+                if (queued->getObject()->getRegion() == region)
+                {
+                    nodes_to_send.push(queued);
+                }
+            }
+        }
+    }
+    // </FS>
+
     node = nodes_to_send.front();
     nodes_to_send.pop();
 
@@ -6121,17 +6162,29 @@ void LLSelectMgr::processObjectProperties(LLMessageSystem* msg, void** user_data
         }
 
 
-        // Iterate through nodes at end, since it can be on both the regular AND hover list
-        struct f : public LLSelectedNodeFunctor
+        // <FS> Batched selection requests, look the node up in the selection's
+        // object map instead of walking the whole selection for every object
+        //// Iterate through nodes at end, since it can be on both the regular AND hover list
+        //struct f : public LLSelectedNodeFunctor
+        //{
+        //    LLUUID mID;
+        //    f(const LLUUID& id) : mID(id) {}
+        //    virtual bool apply(LLSelectNode* node)
+        //    {
+        //        return (node->getObject() && node->getObject()->mID == mID);
+        //    }
+        //} func(id);
+        //LLSelectNode* node = LLSelectMgr::getInstance()->getSelection()->getFirstNode(&func);
+        LLSelectNode* node = nullptr;
+        if (LLViewerObject* objectp = gObjectList.findObject(id))
         {
-            LLUUID mID;
-            f(const LLUUID& id) : mID(id) {}
-            virtual bool apply(LLSelectNode* node)
+            node = LLSelectMgr::getInstance()->getSelection()->findNode(objectp);
+            if (node && node->getObject() != objectp)
             {
-                return (node->getObject() && node->getObject()->mID == mID);
+                node = nullptr;
             }
-        } func(id);
-        LLSelectNode* node = LLSelectMgr::getInstance()->getSelection()->getFirstNode(&func);
+        }
+        // </FS>
 
         if (!node)
         {
@@ -6262,10 +6315,24 @@ void LLSelectMgr::processObjectProperties(LLMessageSystem* msg, void** user_data
         }
     }
 
-    dialog_refresh_all();
+    // <FS> Batched selection requests
+    //dialog_refresh_all();
+    //
+    //// hack for left-click buy object
+    //LLToolPie::selectionPropertiesReceived();
+    if (!sPropertiesRefreshPending)
+    {
+        sPropertiesRefreshPending = true;
+        doOnIdleOneTime([]()
+        {
+            sPropertiesRefreshPending = false;
+            dialog_refresh_all();
 
-    // hack for left-click buy object
-    LLToolPie::selectionPropertiesReceived();
+            // hack for left-click buy object
+            LLToolPie::selectionPropertiesReceived();
+        });
+    }
+    // </FS>
 }
 
 // static
@@ -33,6 +33,7 @@
 #include "llmeshrepository.h"
 #include "llvolume.h"
 #include "llrigginginfo.h"
+#include "llvolumesimd.h" // <FS/> Batched palette kernel
 
 #define DEBUG_SKINNING  LL_DEBUG
 
@@ -156,7 +157,11 @@ void LLSkinningUtil::initSkinningMatrixPalette(
         }
         else
         {
-            mat[j] = skin->mInvBindMatrix[j];
+            // <FS> Batched palette kernel
+            //mat[j] = skin->mInvBindMatrix[j];
+            // Leaves the inverse bind matrix after the batched multiply below
+            world[j].setIdentity();
+            // </FS>
 #if DEBUG_SKINNING
             // This  shouldn't  happen   -  in  mesh  upload,  skinned
             // rendering  should  be disabled  unless  all joints  are
@@ -173,16 +178,19 @@ void LLSkinningUtil::initSkinningMatrixPalette(
         }
     }
 
-    //NOTE: pointer striders used here as a micro-optimization over vector/array lookups
-    const LLMatrix4a* invBind = &(skin->mInvBindMatrix[0]);
-    const LLMatrix4a* w = world;
-    LLMatrix4a* m = mat;
-    LLMatrix4a* end = m + count;
-
-    while (m < end)
-    {
-        matMulUnsafe(*(invBind++), *(w++), *(m++));
-    }
+    // <FS> Batched palette kernel
+    ////NOTE: pointer striders used here as a micro-optimization over vector/array lookups
+    //const LLMatrix4a* invBind = &(skin->mInvBindMatrix[0]);
+    //const LLMatrix4a* w = world;
+    //LLMatrix4a* m = mat;
+    //LLMatrix4a* end = m + count;
+    //
+    //while (m < end)
+    //{
+    //    matMulUnsafe(*(invBind++), *(w++), *(m++));
+    //}
+    LLVolumeSIMD::multiplyMatrices(&(skin->mInvBindMatrix[0]), world, mat, count);
+    // </FS>
 }
 
 void LLSkinningUtil::checkSkinWeights(LLVector4a* weights, U32 num_vertices, const LLMeshSkinInfo* skin)
@@ -55,7 +55,9 @@
 #include "llviewertexturelist.h"
 #include "llwindow.h"
 #include "llworld.h"
+#include "workqueue.h" // <FS/> Encode snapshots in the background
 #include <boost/filesystem.hpp>
+#include <future> // <FS/> Encode snapshots in the background
 
 constexpr F32 AUTO_SNAPSHOT_TIME_DELAY = 1.f;
 
@@ -132,6 +134,7 @@ LLSnapshotLivePreview::~LLSnapshotLivePreview()
     mPreviewImage = NULL;
     mPreviewImageEncoded = NULL;
     mFormattedImage = NULL;
+    mPendingEncode.reset(); // <FS/> Encode snapshots in the background
 
     //  gIdleCallbacks.deleteFunction( &LLSnapshotLivePreview::onIdle, (void*)this );
     sList.erase(this);
@@ -234,6 +237,7 @@ bool LLSnapshotLivePreview::setSnapshotQuality(S32 quality, bool set_by_user)
             gSavedSettings.setS32("SnapshotQuality", quality);
         }
         mFormattedImage = NULL;     // Invalidate the already formatted image if any
+        mPendingEncode.reset(); // <FS/> Encode snapshots in the background
         return true;
     }
     return false;
@@ -754,6 +758,10 @@ bool LLSnapshotLivePreview::onIdle( void* snapshot_preview )
         previewp->mForceUpdateSnapshot = false;
     }
 
+    // <FS> Encode snapshots in the background
+    previewp->adoptFormattedImage(false);
+    // </FS>
+
     if (previewp->getSnapshotUpToDate() && previewp->getThumbnailUpToDate())
     {
         return false;
@@ -794,6 +802,7 @@ bool LLSnapshotLivePreview::onIdle( void* snapshot_preview )
             previewp->mPreviewImageEncoded = NULL;
             // Invalidate/delete any existing formatted image
             previewp->mFormattedImage = NULL;
+            previewp->mPendingEncode.reset(); // <FS/> Encode snapshots in the background
             // Update the data size
             previewp->estimateDataSize();
 
@@ -802,6 +811,12 @@ bool LLSnapshotLivePreview::onIdle( void* snapshot_preview )
             {
                 previewp->prepareFreezeFrame();
             }
+            // <FS> Encode snapshots in the background
+            else
+            {
+                previewp->startFormattedImageEncode();
+            }
+            // </FS>
 
             // The snapshot is updated now...
             previewp->mSnapshotUpToDate = true;
@@ -985,41 +1000,180 @@ void LLSnapshotLivePreview::estimateDataSize()
     mDataSize = (S32)((F32)mPreviewImage->getDataSize() / ratio);
 }
 
-LLPointer<LLImageFormatted> LLSnapshotLivePreview::getFormattedImage()
+// <FS> Encode snapshots in the background
+// An encode running on the General queue, for the snapshot taken last
+struct LLSnapshotLivePreview::PendingEncode
 {
-    if (!mFormattedImage)
+    LLPointer<LLImageFormatted> mImage;
+    std::promise<bool>          mPromise;
+    std::future<bool>           mResult;
+};
+
+// Split out of getFormattedImage()
+void LLSnapshotLivePreview::applyFilter()
+{
+    if (getFilter() != "")
     {
-        // Apply the filter to mPreviewImage
-        if (getFilter() != "")
+        std::string filter_path = LLImageFiltersManager::getInstance()->getFilterPath(getFilter());
+        if (filter_path != "")
         {
-            std::string filter_path = LLImageFiltersManager::getInstance()->getFilterPath(getFilter());
-            if (filter_path != "")
-            {
-                LLImageFilter filter(filter_path);
-                filter.executeFilter(mPreviewImage);
-            }
-            else
-            {
-                LL_WARNS("Snapshot") << "Couldn't find a path to the following filter : " << getFilter() << LL_ENDL;
-            }
+            LLImageFilter filter(filter_path);
+            filter.executeFilter(mPreviewImage);
+        }
+        else
+        {
+            LL_WARNS("Snapshot") << "Couldn't find a path to the following filter : " << getFilter() << LL_ENDL;
         }
+    }
+}
 
-        // Create the new formatted image of the appropriate format.
-        LLSnapshotModel::ESnapshotFormat format = getSnapshotFormat();
-        LL_DEBUGS("Snapshot") << "Encoding new image of format " << format << LL_ENDL;
+// Split out of getFormattedImage()
+LLPointer<LLImageFormatted> LLSnapshotLivePreview::createFormattedImage() const
+{
+    LLSnapshotModel::ESnapshotFormat format = getSnapshotFormat();
+    LL_DEBUGS("Snapshot") << "Encoding new image of format " << format << LL_ENDL;
 
-        switch (format)
+    switch (format)
+    {
+        case LLSnapshotModel::SNAPSHOT_FORMAT_PNG:
+            return new LLImagePNG();
+        case LLSnapshotModel::SNAPSHOT_FORMAT_JPEG:
+            return new LLImageJPEG(mSnapshotQuality);
+        case LLSnapshotModel::SNAPSHOT_FORMAT_BMP:
+        default:
+            return new LLImageBMP();
+    }
+}
+
+// Encodes a fresh snapshot on the General queue, so it is usually done by
+// the time it gets saved or sent
+void LLSnapshotLivePreview::startFormattedImageEncode()
+{
+    static LLCachedControl<bool> background_encode(gSavedSettings, "FSSnapshotBackgroundEncode", true);
+    if (!background_encode || mFormattedImage || mPendingEncode || getSnapshotType() == LLSnapshotModel::SNAPSHOT_TEXTURE)
+    {
+        return;
+    }
+
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    if (!general_queue)
+    {
+        return;
+    }
+
+    // The filter changes mPreviewImage, it runs here like it would in getFormattedImage()
+    applyFilter();
+
+    std::shared_ptr<PendingEncode> job = std::make_shared<PendingEncode>();
+    job->mImage = createFormattedImage();
+    job->mResult = job->mPromise.get_future();
+    LLPointer<LLImageRaw> raw = mPreviewImage;
+    bool posted = general_queue->post(
+        [job, raw]()
         {
-            case LLSnapshotModel::SNAPSHOT_FORMAT_PNG:
-                mFormattedImage = new LLImagePNG();
-                break;
-            case LLSnapshotModel::SNAPSHOT_FORMAT_JPEG:
-                mFormattedImage = new LLImageJPEG(mSnapshotQuality);
-                break;
-            case LLSnapshotModel::SNAPSHOT_FORMAT_BMP:
-                mFormattedImage = new LLImageBMP();
-                break;
+            LLImageDataSharedLock lock(raw);
+            job->mPromise.set_value(job->mImage->encode(raw, 0));
+        });
+    if (posted)
+    {
+        mPendingEncode = job;
+    }
+    else
+    {
+        // Nothing in the background, getFormattedImage() must not filter again
+        mFormattedImage = job->mImage;
+        LLImageDataSharedLock lock(mPreviewImage);
+        if (mFormattedImage->encode(mPreviewImage, 0))
+        {
+            mDataSize = mFormattedImage->getDataSize();
         }
+    }
+}
+
+// Takes the result of the background encode, if there is one and it is done
+// or wait is set
+bool LLSnapshotLivePreview::adoptFormattedImage(bool wait)
+{
+    if (!mPendingEncode)
+    {
+        return false;
+    }
+    if (!wait && mPendingEncode->mResult.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return false;
+    }
+
+    std::shared_ptr<PendingEncode> job;
+    job.swap(mPendingEncode);
+    bool success = false;
+    try
+    {
+        success = job->mResult.get();
+    }
+    catch (const std::future_error&)
+    {
+        // Dropped by the queue when shutting down
+        return false;
+    }
+
+    mFormattedImage = job->mImage;
+    if (success)
+    {
+        // We can update the data size precisely at that point
+        mDataSize = mFormattedImage->getDataSize();
+    }
+    return true;
+}
+// </FS>
+
+LLPointer<LLImageFormatted> LLSnapshotLivePreview::getFormattedImage()
+{
+    if (!mFormattedImage)
+    {
+        // <FS> Encode snapshots in the background
+        if (adoptFormattedImage(true))
+        {
+            return mFormattedImage;
+        }
+        // </FS>
+
+        // Apply the filter to mPreviewImage
+        // <FS> Encode snapshots in the background
+        //if (getFilter() != "")
+        //{
+        //    std::string filter_path = LLImageFiltersManager::getInstance()->getFilterPath(getFilter());
+        //    if (filter_path != "")
+        //    {
+        //        LLImageFilter filter(filter_path);
+        //        filter.executeFilter(mPreviewImage);
+        //    }
+        //    else
+        //    {
+        //        LL_WARNS("Snapshot") << "Couldn't find a path to the following filter : " << getFilter() << LL_ENDL;
+        //    }
+        //}
+        applyFilter();
+        // </FS>
+
+        // Create the new formatted image of the appropriate format.
+        // <FS> Encode snapshots in the background
+        //LLSnapshotModel::ESnapshotFormat format = getSnapshotFormat();
+        //LL_DEBUGS("Snapshot") << "Encoding new image of format " << format << LL_ENDL;
+        //
+        //switch (format)
+        //{
+        //    case LLSnapshotModel::SNAPSHOT_FORMAT_PNG:
+        //        mFormattedImage = new LLImagePNG();
+        //        break;
+        //    case LLSnapshotModel::SNAPSHOT_FORMAT_JPEG:
+        //        mFormattedImage = new LLImageJPEG(mSnapshotQuality);
+        //        break;
+        //    case LLSnapshotModel::SNAPSHOT_FORMAT_BMP:
+        //        mFormattedImage = new LLImageBMP();
+        //        break;
+        //}
+        mFormattedImage = createFormattedImage();
+        // </FS>
         if (mFormattedImage->encode(mPreviewImage, 0))
         {
             // We can update the data size precisely at that point
@@ -1041,6 +1195,7 @@ void LLSnapshotLivePreview::setSnapshotFormat(LLSnapshotModel::ESnapshotFormat f
     if (mSnapshotFormat != format)
     {
         mFormattedImage = NULL;     // Invalidate the already formatted image if any
+        mPendingEncode.reset(); // <FS/> Encode snapshots in the background
         mSnapshotFormat = format;
     }
 }
@@ -1085,7 +1240,12 @@ void LLSnapshotLivePreview::saveTexture(bool outfit_snapshot, std::string name)
     scaled->biasedScaleToPowerOfTwo(MAX_TEXTURE_SIZE);
     LL_DEBUGS("Snapshot") << "scaled texture to " << scaled->getWidth() << "x" << scaled->getHeight() << LL_ENDL;
 
-    if (formatted->encode(scaled, 0.0f))
+    // <FS> Encode snapshots in the background
+    //if (formatted->encode(scaled, 0.0f))
+    auto upload = [=](bool encoded)
+    {
+    if (encoded)
+    // </FS>
     {
         LLFileSystem fmt_file(new_asset_id, LLAssetType::AT_TEXTURE, LLFileSystem::WRITE);
         fmt_file.write(formatted->getData(), formatted->getDataSize());
@@ -1114,6 +1274,25 @@ void LLSnapshotLivePreview::saveTexture(bool outfit_snapshot, std::string name)
         LLNotificationsUtil::add("ErrorEncodingSnapshot");
         LL_WARNS("Snapshot") << "Error encoding snapshot" << LL_ENDL;
     }
+    // <FS> Encode snapshots in the background
+    };
+
+    // J2C encodes of large snapshots take a while, the upload starts once it is done
+    static LLCachedControl<bool> background_encode(gSavedSettings, "FSSnapshotBackgroundEncode", true);
+    LL::WorkQueue::ptr_t main_queue = LL::WorkQueue::getInstance("mainloop");
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    bool posted = background_encode && main_queue && general_queue && main_queue->postTo(
+        general_queue,
+        [formatted, scaled]() // Work done on general queue
+        {
+            return formatted->encode(scaled, 0.0f);
+        },
+        upload); // Callback to main thread
+    if (!posted)
+    {
+        upload(formatted->encode(scaled, 0.0f));
+    }
+    // </FS>
 
     add(LLStatViewer::SNAPSHOT, 1);
 
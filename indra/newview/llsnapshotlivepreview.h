@@ -127,6 +127,14 @@ public:
     static bool onIdle( void* snapshot_preview );
 
 private:
+    // <FS> Encode snapshots in the background
+    struct PendingEncode;
+    void applyFilter();
+    LLPointer<LLImageFormatted> createFormattedImage() const;
+    void startFormattedImageEncode();
+    bool adoptFormattedImage(bool wait);
+    // </FS>
+
     LLView*                     mViewContainer;
 
     LLColor4                    mColor;
@@ -164,6 +172,7 @@ private:
     LLPointer<LLImageRaw>       mPreviewImage;
     LLPointer<LLImageRaw>       mPreviewImageEncoded;
     LLPointer<LLImageFormatted> mFormattedImage;
+    std::shared_ptr<PendingEncode> mPendingEncode; // <FS/> Encode snapshots in the background, becomes mFormattedImage when done
     bool                        mAllowRenderUI;
     bool                        mAllowFullScreenPreview;
     LLFrameTimer                mSnapshotDelayTimer;
@@ -53,6 +53,7 @@
 #include "llvolumemgr.h"
 #include "llviewershadermgr.h"
 #include "llcontrolavatar.h"
+#include "llvramaccounting.h" // <FS/> VRAM accounting
 
 #include "llvotree.h"
 // <FS:Beq> improved normals debug
@@ -73,6 +74,43 @@ static F32 sCurMaxTexPriority = 1.f;
 // enable expensive sanity checks around redundant drawable and group insertion to LLCullResult
 #define LL_DEBUG_CULL_RESULT 0
 
+// <FS> VRAM accounting: vertex buffers of a group are accounted to its
+// partition and to whoever the partition belongs to
+static LLVRAMTag vram_tag(LLSpatialPartition* part)
+{
+    LLVRAMTag tag;
+    tag.mCategory = LLVRAMCategory::VERTEX_BUFFER;
+    tag.mDetail = (U8)part->mPartitionType;
+    tag.mOwner = LLVRAMOwner::REGION;
+    switch (part->mPartitionType)
+    {
+    case LLViewerRegion::PARTITION_HUD:
+    case LLViewerRegion::PARTITION_HUD_PARTICLE:
+        tag.mOwner = LLVRAMOwner::HUD;
+        break;
+    case LLViewerRegion::PARTITION_AVATAR:
+    case LLViewerRegion::PARTITION_CONTROL_AV:
+        tag.mOwner = LLVRAMOwner::AVATAR;
+        break;
+    default:
+        if (LLSpatialBridge* bridge = part->asBridge())
+        {
+            const LLViewerObject* vobj = bridge->mDrawable ? bridge->mDrawable->getVObj().get() : nullptr;
+            if (vobj && vobj->isHUDAttachment())
+            {
+                tag.mOwner = LLVRAMOwner::HUD;
+            }
+            else if (vobj && vobj->isAttachment())
+            {
+                tag.mOwner = LLVRAMOwner::AVATAR;
+            }
+        }
+        break;
+    }
+    return tag;
+}
+// </FS>
+
 //static counter for frame to switch LOD on
 
 void sg_assert(bool expr)
@@ -139,6 +177,7 @@ LLSpatialGroup::~LLSpatialGroup()
 void LLSpatialGroup::clearDrawMap()
 {
     mDrawMap.clear();
+    mMeshInstances.clear(); // <FS/> Mesh instancing
 }
 
 bool LLSpatialGroup::isHUDGroup()
@@ -326,8 +365,17 @@ void LLSpatialGroup::rebuildGeom()
 {
     if (!isDead())
     {
+        LLVRAMAccounting::Scope vram_scope(vram_tag(getSpatialPartition())); // <FS/> VRAM accounting
         getSpatialPartition()->rebuildGeom(this);
 
+        // <FS> Shadow cache and probe scheduler, bridges keep their extents in their own frame
+        gPipeline.dirtyShadowCache(getSpatialPartition(), getExtents());
+        if (!getSpatialPartition()->isBridge())
+        {
+            gPipeline.mReflectionMapManager.markSceneChanged(getSpatialPartition()->mPartitionType, getExtents());
+        }
+        // </FS>
+
         if (hasState(LLSpatialGroup::MESH_DIRTY))
         {
             gPipeline.markMeshDirty(this);
@@ -339,6 +387,7 @@ void LLSpatialGroup::rebuildMesh()
 {
     if (!isDead())
     {
+        LLVRAMAccounting::Scope vram_scope(vram_tag(getSpatialPartition())); // <FS/> VRAM accounting
         getSpatialPartition()->rebuildMesh(this);
     }
 }
@@ -431,6 +480,13 @@ bool LLSpatialGroup::removeObject(LLDrawable *drawablep, bool from_octree)
         drawablep->setGroup(NULL);
         setState(GEOM_DIRTY);
         gPipeline.markRebuild(this);
+        // <FS> Shadow cache and probe scheduler
+        gPipeline.dirtyShadowCache(getSpatialPartition(), drawablep->getSpatialExtents());
+        if (!getSpatialPartition()->isBridge())
+        {
+            gPipeline.mReflectionMapManager.markSceneChanged(getSpatialPartition()->mPartitionType, drawablep->getSpatialExtents());
+        }
+        // </FS>
 
         if (drawablep->isSpatialBridge())
         {
@@ -4135,6 +4191,7 @@ LLCullResult::LLCullResult()
     mRiggedAlphaGroupsAllocated = 0;
     mOcclusionGroupsAllocated = 0;
     mDrawableGroupsAllocated = 0;
+    mInstanceGroupsAllocated = 0; // <FS/> Mesh instancing
     mVisibleListAllocated = 0;
     mVisibleBridgeAllocated = 0;
 
@@ -4153,6 +4210,11 @@ LLCullResult::LLCullResult()
     mDrawableGroups.clear();
     mDrawableGroups.push_back(NULL);
     mDrawableGroupsEnd = &mDrawableGroups[0];
+    // <FS> Mesh instancing
+    mInstanceGroups.clear();
+    mInstanceGroups.push_back(NULL);
+    mInstanceGroupsEnd = &mInstanceGroups[0];
+    // </FS>
     mVisibleList.clear();
     mVisibleList.push_back(NULL);
     mVisibleListEnd = &mVisibleList[0];
@@ -4198,6 +4260,11 @@ void LLCullResult::clear()
     mDrawableGroupsSize = 0;
     mDrawableGroupsEnd = &mDrawableGroups[0];
 
+    // <FS> Mesh instancing
+    mInstanceGroupsSize = 0;
+    mInstanceGroupsEnd = &mInstanceGroups[0];
+    // </FS>
+
     mVisibleListSize = 0;
     mVisibleListEnd = &mVisibleList[0];
 
@@ -4268,6 +4335,18 @@ LLCullResult::sg_iterator LLCullResult::endDrawableGroups()
     return mDrawableGroupsEnd;
 }
 
+// <FS> Mesh instancing
+LLCullResult::sg_iterator LLCullResult::beginInstanceGroups()
+{
+    return &mInstanceGroups[0];
+}
+
+LLCullResult::sg_iterator LLCullResult::endInstanceGroups()
+{
+    return mInstanceGroupsEnd;
+}
+// </FS>
+
 LLCullResult::drawable_iterator LLCullResult::beginVisibleList()
 {
     return &mVisibleList[0];
@@ -4372,6 +4451,22 @@ void LLCullResult::pushDrawableGroup(LLSpatialGroup* group)
     mDrawableGroupsEnd = &mDrawableGroups[mDrawableGroupsSize];
 }
 
+// <FS> Mesh instancing
+void LLCullResult::pushInstanceGroup(LLSpatialGroup* group)
+{
+    if (mInstanceGroupsSize < mInstanceGroupsAllocated)
+    {
+        mInstanceGroups[mInstanceGroupsSize] = group;
+    }
+    else
+    {
+        pushBack(mInstanceGroups, mInstanceGroupsAllocated, group);
+    }
+    ++mInstanceGroupsSize;
+    mInstanceGroupsEnd = &mInstanceGroups[mInstanceGroupsSize];
+}
+// </FS>
+
 void LLCullResult::pushDrawable(LLDrawable* drawable)
 {
 #if LL_DEBUG_CULL_RESULT
@@ -4418,6 +4513,50 @@ void LLCullResult::pushDrawInfo(U32 type, LLDrawInfo* draw_info)
     mRenderMapEnd[type] = &(mRenderMap[type][mRenderMapSize[type]]);
 }
 
+// <FS> Parallel culling
+void LLCullResult::append(LLCullResult& other)
+{
+    for (sg_iterator i = other.beginVisibleGroups(); i != other.endVisibleGroups(); ++i)
+    {
+        pushVisibleGroup(*i);
+    }
+    for (sg_iterator i = other.beginAlphaGroups(); i != other.endAlphaGroups(); ++i)
+    {
+        pushAlphaGroup(*i);
+    }
+    for (sg_iterator i = other.beginRiggedAlphaGroups(); i != other.endRiggedAlphaGroups(); ++i)
+    {
+        pushRiggedAlphaGroup(*i);
+    }
+    for (sg_iterator i = other.beginOcclusionGroups(); i != other.endOcclusionGroups(); ++i)
+    {
+        pushOcclusionGroup(*i);
+    }
+    for (sg_iterator i = other.beginDrawableGroups(); i != other.endDrawableGroups(); ++i)
+    {
+        pushDrawableGroup(*i);
+    }
+    for (sg_iterator i = other.beginInstanceGroups(); i != other.endInstanceGroups(); ++i)
+    {
+        pushInstanceGroup(*i);
+    }
+    for (drawable_iterator i = other.beginVisibleList(); i != other.endVisibleList(); ++i)
+    {
+        pushDrawable(*i);
+    }
+    for (bridge_iterator i = other.beginVisibleBridge(); i != other.endVisibleBridge(); ++i)
+    {
+        pushBridge(*i);
+    }
+    for (U32 type = 0; type < LLRenderPass::NUM_RENDER_TYPES; ++type)
+    {
+        for (drawinfo_iterator i = other.beginRenderMap(type); i != other.endRenderMap(type); ++i)
+        {
+            pushDrawInfo(type, *i);
+        }
+    }
+}
+// </FS>
 
 void LLCullResult::assertDrawMapsEmpty()
 {
@@ -241,6 +241,23 @@ public:
     typedef std::unordered_map<LLFace*, buffer_list_t> buffer_texture_map_t;
     typedef std::unordered_map<U32, buffer_texture_map_t> buffer_map_t;
 
+    // <FS> Mesh instancing
+    // A face of a static mesh left out of the vertex buffers of the group, to
+    // be drawn by FSMeshInstancer together with the other faces of the same
+    // volume and material
+    struct MeshInstance
+    {
+        LLPointer<LLVolume>                 mVolume;        // shared by every object of the same mesh and LOD
+        S32                                 mVolumeFace;
+        LLPointer<LLFetchedGLTFMaterial>    mMaterial;
+        const LLMatrix4*                    mModelMatrix;   // region render matrix, as mModelMatrix of the draw info would be
+        F32                                 mTransform[12]; // region space, columns with the translation in w
+        F32                                 mNormal[12];    // inverse transpose of mTransform, columns
+        LLColor4                            mColor;
+    };
+    typedef std::vector<MeshInstance> mesh_instance_list_t;
+    // </FS>
+
     struct CompareDistanceGreater
     {
         bool operator()(const LLSpatialGroup* const& lhs, const LLSpatialGroup* const& rhs)
@@ -360,6 +377,7 @@ protected:
 public:
     LLPointer<LLVertexBuffer> mVertexBuffer;
     draw_map_t mDrawMap;
+    mesh_instance_list_t mMeshInstances; // <FS/> Mesh instancing
 
     bridge_list_t mBridgeList;
     buffer_map_t mBufferMap; //used by volume buffers to attempt to reuse vertex buffers
@@ -539,6 +557,11 @@ public:
     sg_iterator beginDrawableGroups();
     sg_iterator endDrawableGroups();
 
+    // <FS> Mesh instancing: groups with mesh instances to draw
+    sg_iterator beginInstanceGroups();
+    sg_iterator endInstanceGroups();
+    // </FS>
+
     drawable_iterator beginVisibleList();
     drawable_iterator endVisibleList();
 
@@ -553,10 +576,14 @@ public:
     void pushRiggedAlphaGroup(LLSpatialGroup* group);
     void pushOcclusionGroup(LLSpatialGroup* group);
     void pushDrawableGroup(LLSpatialGroup* group);
+    void pushInstanceGroup(LLSpatialGroup* group); // <FS/> Mesh instancing
     void pushDrawable(LLDrawable* drawable);
     void pushBridge(LLSpatialBridge* bridge);
     void pushDrawInfo(U32 type, LLDrawInfo* draw_info);
 
+    // <FS/> Parallel culling: push everything in other, in order
+    void append(LLCullResult& other);
+
     U32 getVisibleGroupsSize()      { return mVisibleGroupsSize; }
     U32 getAlphaGroupsSize()        { return mAlphaGroupsSize; }
     U32 getRiggedAlphaGroupsSize() { return mRiggedAlphaGroupsSize; }
@@ -576,6 +603,7 @@ private:
     U32                 mRiggedAlphaGroupsSize;
     U32                 mOcclusionGroupsSize;
     U32                 mDrawableGroupsSize;
+    U32                 mInstanceGroupsSize; // <FS/> Mesh instancing
     U32                 mVisibleListSize;
     U32                 mVisibleBridgeSize;
 
@@ -584,6 +612,7 @@ private:
     U32                 mRiggedAlphaGroupsAllocated;
     U32                 mOcclusionGroupsAllocated;
     U32                 mDrawableGroupsAllocated;
+    U32                 mInstanceGroupsAllocated; // <FS/> Mesh instancing
     U32                 mVisibleListAllocated;
     U32                 mVisibleBridgeAllocated;
 
@@ -599,6 +628,10 @@ private:
     sg_iterator         mOcclusionGroupsEnd;
     sg_list_t           mDrawableGroups;
     sg_iterator         mDrawableGroupsEnd;
+    // <FS> Mesh instancing
+    sg_list_t           mInstanceGroups;
+    sg_iterator         mInstanceGroupsEnd;
+    // </FS>
     drawable_list_t     mVisibleList;
     drawable_iterator   mVisibleListEnd;
     bridge_list_t       mVisibleBridge;
@@ -31,6 +31,7 @@
 
 #if LL_WINDOWS
 #   include <process.h>     // _spawnl()
+#   include <objbase.h>     // CoInitializeEx() // <FS/> Startup pipeline
 #else
 #   include <sys/stat.h>        // mkdir()
 #endif
@@ -129,6 +130,7 @@
 // <FS:Ansariel> [FS Login Panel]
 #include "llmutelist.h"
 #include "llavatarpropertiesprocessor.h"
+#include "llpacketring.h" // <FS/> Network thread
 #include "llpanelgrouplandmoney.h"
 #include "llpanelgroupnotices.h"
 #include "llparcel.h"
@@ -143,6 +145,7 @@
 #include "llstatview.h"
 #include "llstatusbar.h"        // sendMoneyBalanceRequest(), owns L$ balance
 #include "llsurface.h"
+#include "lltemplatemessagereader.h" // <FS/> Zero-copy message reader
 #include "lltexturecache.h"
 #include "lltexturefetch.h"
 #include "lltoolmgr.h"
@@ -240,6 +243,7 @@
 #include "fsfloaterwearablefavorites.h"
 #include "fslslbridge.h"
 #include "fsradar.h"
+#include "fsregionprefetch.h"
 #include "fsregistrarutils.h"
 #include "fsscriptlibrary.h"
 #include "lfsimfeaturehandler.h"
@@ -254,6 +258,9 @@
 #include "NACLantispam.h"
 #include "streamtitledisplay.h"
 #include "tea.h"
+#include "fshttpresponsecache.h" // <FS/> Conditional GET cache
+#include "fsstartuptasks.h" // <FS/> Startup pipeline
+#include "fsbenchmark.h" // <FS/> Benchmark mode
 
 //
 // exported globals
@@ -640,6 +647,8 @@ bool idle_startup()
 
     LLMortician::updateClass();
 
+    FSStartupTasks::instance().update(); // <FS/> Startup pipeline
+
     const std::string delims (" ");
     std::string system;
     size_t begIdx, endIdx;
@@ -814,6 +823,8 @@ bool idle_startup()
             const LLUseCircuitCodeResponder* responder = NULL;
             bool failure_is_fatal = true;
 
+            LLPacketRing::setUseReceiveThread(gSavedSettings.getBOOL("FSNetworkThread")); // <FS/> Network thread
+
             if(!start_messaging_system(
                    message_template_path,
                    port,
@@ -1008,70 +1019,154 @@ bool idle_startup()
         // or audio cues in connection UI.
         //-------------------------------------------------
 
+        // <FS> Startup pipeline
+        // The engine is created and started on the thread pool while the
+        // login screen comes up, and set up on the main thread once it runs.
+        //if (false == gSavedSettings.getBOOL("NoAudio"))
+        //{
+        //    delete gAudiop;
+        //    gAudiop = NULL;
+        //
+//#ifdef LL_FMODSTUDIO
+//#if !LL_WINDOWS
+        //    if (NULL == getenv("LL_BAD_FMODSTUDIO_DRIVER"))
+//#endif // !LL_WINDOWS
+        //    {
+        //        gAudiop = (LLAudioEngine *) new LLAudioEngine_FMODSTUDIO(gSavedSettings.getBOOL("FMODProfilerEnable"), gSavedSettings.getU32("FMODResampleMethod"));
+        //    }
+//#endif
+        //
+//#ifdef LL_OPENAL
+//#if !LL_WINDOWS
+        //    // if (NULL == getenv("LL_BAD_OPENAL_DRIVER"))
+        //    if (!gAudiop && NULL == getenv("LL_BAD_OPENAL_DRIVER"))
+//#endif // !LL_WINDOWS
+        //    {
+        //        gAudiop = (LLAudioEngine *) new LLAudioEngine_OpenAL();
+        //    }
+//#endif
+        //
+        //    if (gAudiop)
+        //    {
+//#if LL_WINDOWS
+        //        // FMOD Studio and FMOD Ex on Windows needs the window handle to stop playing audio
+        //        // when window is minimized. JC
+        //        void* window_handle = (HWND)gViewerWindow->getPlatformWindow();
+//#else
+        //        void* window_handle = NULL;
+//#endif
+        //        if (gAudiop->init(window_handle, LLAppViewer::instance()->getSecondLifeTitle()))
+        //        {
+        //            if (false == gSavedSettings.getBOOL("UseMediaPluginsForStreamingAudio"))
+        //            {
+        //                LL_INFOS("AppInit") << "Using default impl to render streaming audio" << LL_ENDL;
+        //                gAudiop->setStreamingAudioImpl(gAudiop->createDefaultStreamingAudioImpl());
+        //            }
+        //
+        //            // if the audio engine hasn't set up its own preferred handler for streaming audio
+        //            // then set up the generic streaming audio implementation which uses media plugins
+        //            if (NULL == gAudiop->getStreamingAudioImpl())
+        //            {
+        //                LL_INFOS("AppInit") << "Using media plugins to render streaming audio" << LL_ENDL;
+        //                gAudiop->setStreamingAudioImpl(new LLStreamingAudio_MediaPlugins());
+        //            }
+        //
+        //            // <FS:Ansariel> Output device selection
+        //            gAudiop->setDevice(LLUUID(gSavedSettings.getString("FSOutputDeviceUUID")));
+        //
+        //            gAudiop->setMuted(true);
+        //        }
+        //        else
+        //        {
+        //            LL_WARNS("AppInit") << "Unable to initialize audio engine" << LL_ENDL;
+        //            delete gAudiop;
+        //            gAudiop = NULL;
+        //        }
+        //    }
+        //}
+        //
+        //LL_INFOS("AppInit") << "Audio Engine Initialized." << LL_ENDL;
         if (false == gSavedSettings.getBOOL("NoAudio"))
         {
             delete gAudiop;
             gAudiop = NULL;
 
+            const bool fmod_profiler = gSavedSettings.getBOOL("FMODProfilerEnable");
+            const U32 fmod_resample_method = gSavedSettings.getU32("FMODResampleMethod");
+#if LL_WINDOWS
+            // FMOD Studio and FMOD Ex on Windows needs the window handle to stop playing audio
+            // when window is minimized. JC
+            void* window_handle = (HWND)gViewerWindow->getPlatformWindow();
+#else
+            void* window_handle = NULL;
+#endif
+            const std::string app_title = LLAppViewer::instance()->getSecondLifeTitle();
+            auto engine = std::make_shared<LLAudioEngine*>(nullptr);
+
+            FSStartupTasks::instance().add("audio_engine", FSStartupTasks::EThread::Pool,
+                [engine, fmod_profiler, fmod_resample_method, window_handle, app_title]()
+                {
+#if LL_WINDOWS
+                    // The engine may start COM, which needs to be set up on this thread
+                    CoInitializeEx(NULL, COINIT_MULTITHREADED);
+#endif
+                    LLAudioEngine* audiop = NULL;
 #ifdef LL_FMODSTUDIO
 #if !LL_WINDOWS
-            if (NULL == getenv("LL_BAD_FMODSTUDIO_DRIVER"))
+                    if (NULL == getenv("LL_BAD_FMODSTUDIO_DRIVER"))
 #endif // !LL_WINDOWS
-            {
-                gAudiop = (LLAudioEngine *) new LLAudioEngine_FMODSTUDIO(gSavedSettings.getBOOL("FMODProfilerEnable"), gSavedSettings.getU32("FMODResampleMethod"));
-            }
+                    {
+                        audiop = (LLAudioEngine *) new LLAudioEngine_FMODSTUDIO(fmod_profiler, fmod_resample_method);
+                    }
 #endif
 
 #ifdef LL_OPENAL
 #if !LL_WINDOWS
-            // if (NULL == getenv("LL_BAD_OPENAL_DRIVER"))
-            if (!gAudiop && NULL == getenv("LL_BAD_OPENAL_DRIVER"))
+                    if (!audiop && NULL == getenv("LL_BAD_OPENAL_DRIVER"))
 #endif // !LL_WINDOWS
-            {
-                gAudiop = (LLAudioEngine *) new LLAudioEngine_OpenAL();
-            }
+                    {
+                        audiop = (LLAudioEngine *) new LLAudioEngine_OpenAL();
+                    }
 #endif
 
-            if (gAudiop)
-            {
-#if LL_WINDOWS
-                // FMOD Studio and FMOD Ex on Windows needs the window handle to stop playing audio
-                // when window is minimized. JC
-                void* window_handle = (HWND)gViewerWindow->getPlatformWindow();
-#else
-                void* window_handle = NULL;
-#endif
-                if (gAudiop->init(window_handle, LLAppViewer::instance()->getSecondLifeTitle()))
-                {
-                    if (false == gSavedSettings.getBOOL("UseMediaPluginsForStreamingAudio"))
+                    if (audiop && !audiop->init(window_handle, app_title))
                     {
-                        LL_INFOS("AppInit") << "Using default impl to render streaming audio" << LL_ENDL;
-                        gAudiop->setStreamingAudioImpl(gAudiop->createDefaultStreamingAudioImpl());
+                        LL_WARNS("AppInit") << "Unable to initialize audio engine" << LL_ENDL;
+                        delete audiop;
+                        audiop = NULL;
                     }
+                    *engine = audiop;
+                });
 
-                    // if the audio engine hasn't set up its own preferred handler for streaming audio
-                    // then set up the generic streaming audio implementation which uses media plugins
-                    if (NULL == gAudiop->getStreamingAudioImpl())
+            FSStartupTasks::instance().add("audio_setup", FSStartupTasks::EThread::Main,
+                [engine]()
+                {
+                    gAudiop = *engine;
+                    if (gAudiop)
                     {
-                        LL_INFOS("AppInit") << "Using media plugins to render streaming audio" << LL_ENDL;
-                        gAudiop->setStreamingAudioImpl(new LLStreamingAudio_MediaPlugins());
-                    }
+                        if (false == gSavedSettings.getBOOL("UseMediaPluginsForStreamingAudio"))
+                        {
+                            LL_INFOS("AppInit") << "Using default impl to render streaming audio" << LL_ENDL;
+                            gAudiop->setStreamingAudioImpl(gAudiop->createDefaultStreamingAudioImpl());
+                        }
 
-                    // <FS:Ansariel> Output device selection
-                    gAudiop->setDevice(LLUUID(gSavedSettings.getString("FSOutputDeviceUUID")));
+                        // if the audio engine hasn't set up its own preferred handler for streaming audio
+                        // then set up the generic streaming audio implementation which uses media plugins
+                        if (NULL == gAudiop->getStreamingAudioImpl())
+                        {
+                            LL_INFOS("AppInit") << "Using media plugins to render streaming audio" << LL_ENDL;
+                            gAudiop->setStreamingAudioImpl(new LLStreamingAudio_MediaPlugins());
+                        }
 
-                    gAudiop->setMuted(true);
-                }
-                else
-                {
-                    LL_WARNS("AppInit") << "Unable to initialize audio engine" << LL_ENDL;
-                    delete gAudiop;
-                    gAudiop = NULL;
-                }
-            }
-        }
+                        gAudiop->setDevice(LLUUID(gSavedSettings.getString("FSOutputDeviceUUID")));
 
-        LL_INFOS("AppInit") << "Audio Engine Initialized." << LL_ENDL;
+                        gAudiop->setMuted(true);
+                    }
+                    LL_INFOS("AppInit") << "Audio Engine Initialized." << LL_ENDL;
+                },
+                { "audio_engine" });
+        }
+        // </FS>
 
         if (LLTimer::knownBadTimer())
         {
@@ -1304,6 +1399,7 @@ bool idle_startup()
 #endif
         display_startup();
         timeout.reset();
+        FSStartupTasks::instance().markLoginScreen(); // <FS/> Startup pipeline
         return false;
     }
 
@@ -1325,6 +1421,12 @@ bool idle_startup()
 
     if (STATE_LOGIN_CLEANUP == LLStartUp::getStartupState())
     {
+        // <FS> Startup pipeline
+        // Everything from here on may use the audio engine
+        FSStartupTasks::instance().wait("audio_setup");
+        FSStartupTasks::instance().markLoginStart();
+        // </FS>
+
         // <FS:Ansariel> Check for test build expiration
         if (is_testbuild_expired())
         {
@@ -1955,6 +2057,21 @@ bool idle_startup()
         // <FS:Ansariel> Restore original LLMessageSystem HTTP options for OpenSim
         gMessageSystem->setIsInSecondLife(LLGridManager::getInstance()->isInSecondLife());
 
+        // <FS> Startup pipeline
+        // The inventory caches are read while the world comes up, loading
+        // the skeleton joins it
+        {
+            auto agent_cache = LLInventoryModel::getCachePrefetch(gAgentID);
+            auto library_cache = LLInventoryModel::getCachePrefetch(gInventory.getLibraryOwnerID());
+            FSStartupTasks::instance().add("inventory_cache", FSStartupTasks::EThread::Pool,
+                [agent_cache, library_cache]()
+                {
+                    agent_cache();
+                    library_cache();
+                });
+        }
+        // </FS>
+
         // Finish agent initialization.  (Requires gSavedSettings, builds camera)
         gAgent.init();
         display_startup();
@@ -2036,6 +2153,14 @@ bool idle_startup()
         gAgent.setPositionAgent(agent_start_position_region);
 
         display_startup();
+
+        // <FS> Conditional GET cache, one directory per account
+        FSHttpResponseCache::instance().setEnabled(gSavedSettings.getBOOL("FSHttpResponseCache"));
+        FSHttpResponseCache::instance().setDirectory(
+            gSavedSettings.getBOOL("FSHttpResponseCache") ? gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "httpresponses", gAgentID.asString()) : std::string(),
+            (U64)gSavedSettings.getU32("FSHttpResponseCacheSize") * 1024 * 1024);
+        // </FS>
+
         LLStartUp::initExperiences();
 
         display_startup();
@@ -2171,6 +2296,8 @@ bool idle_startup()
         register_viewer_callbacks(gMessageSystem);
         display_startup();
 
+        LLTemplateMessageReader::setZeroCopy(gSavedSettings.getBOOL("FSZeroCopyMessageReader")); // <FS/> Zero-copy message reader
+
         // Debugging info parameters
         gMessageSystem->setMaxMessageTime( 0.5f );          // Spam if decoding all msgs takes more than 500 ms
         display_startup();
@@ -2551,6 +2678,8 @@ bool idle_startup()
     {
         LL_PROFILE_ZONE_NAMED("State inventory load skeleton")
 
+        FSStartupTasks::instance().wait("inventory_cache"); // <FS/> Startup pipeline
+
         LLSD response = LLLoginInstance::getInstance()->getResponse();
 
         LLSD inv_skel_lib = response["inventory-skel-lib"];
@@ -2573,6 +2702,7 @@ bool idle_startup()
                 LL_WARNS("AppInit") << "Problem loading inventory-skel-targets" << LL_ENDL;
             }
         }
+        LLInventoryModel::clearCachePrefetches(); // <FS/> Startup pipeline
         display_startup();
         LLStartUp::setStartupState(STATE_INVENTORY_SEND2);
         display_startup();
@@ -3224,7 +3354,10 @@ bool idle_startup()
         gAgent.observeFriends();
 
         // Start automatic replay if the flag is set.
-        if (gSavedSettings.getBOOL("StatsAutoRun") || gAgentPilot.getReplaySession())
+        // <FS> Benchmark mode, starts the playback itself once the scene has loaded
+        //if (gSavedSettings.getBOOL("StatsAutoRun") || gAgentPilot.getReplaySession())
+        if ((gSavedSettings.getBOOL("StatsAutoRun") || gAgentPilot.getReplaySession()) && !FSBenchmark::isEnabled())
+        // </FS>
         {
             LL_DEBUGS("AppInit") << "Starting automatic playback" << LL_ENDL;
             gAgentPilot.startPlayback();
@@ -3240,12 +3373,17 @@ bool idle_startup()
         // then the data is cached for the viewer's lifetime)
         LLProductInfoRequestManager::instance();
 
+        // <FS> Region prefetch, start recording per-region prefetch traces
+        FSRegionPrefetch::getInstance();
+        // </FS>
+
         // *FIX:Mani - What do I do here?
         // Need we really clear the Auth response data?
         // Clean up the userauth stuff.
         // LLUserAuth::getInstance()->reset();
 
         LLStartUp::setStartupState( STATE_STARTED );
+        FSStartupTasks::instance().markInWorld(); // <FS/> Startup pipeline
         display_startup();
 
         // <FS:Ansariel> Draw Distance stepping; originally based on SpeedRez by Henri Beauchamp, licensed under LGPL
@@ -109,6 +109,8 @@ LLSurface::LLSurface(U32 type, LLViewerRegion *regionp) :
 
 LLSurface::~LLSurface()
 {
+    gPipeline.mGPUTerrain.removeSurface(this); // <FS/> GPU terrain
+
     delete [] mSurfaceZ;
     mSurfaceZ = NULL;
 
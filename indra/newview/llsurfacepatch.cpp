@@ -1175,7 +1175,10 @@ void LLSurfacePatch::updateVisibility()
         new_render_level = mVisInfo.mRenderLevel = mSurfacep->getRenderLevel(max_render_stride);
         mVisInfo.mRenderStride = mSurfacep->getRenderStride(new_render_level);
 
-        if ((mVisInfo.mRenderStride != old_render_stride))
+        // <FS> GPU terrain, the mesh has every stride and nothing needs a rebuild
+        //if ((mVisInfo.mRenderStride != old_render_stride))
+        if ((mVisInfo.mRenderStride != old_render_stride) && !FSGPUTerrain::isEnabled())
+        // </FS>
             // The reason we check !mbIsVisible is because non-visible patches normals
             // are not updated when their data is changed.  When this changes we can get
             // rid of mbIsVisible altogether.
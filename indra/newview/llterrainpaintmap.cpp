@@ -41,9 +41,80 @@
 #include "llviewerregion.h"
 #include "llviewershadermgr.h"
 #include "llviewertexture.h"
+#include "llworld.h" // <FS/> Asynchronous paint map bake
 
-// static
-bool LLTerrainPaintMap::bakeHeightNoiseIntoPBRPaintMapRGB(const LLViewerRegion& region, LLViewerTexture& tex)
+// <FS> Asynchronous paint map bake
+// The bake used to run start to finish in bakeHeightNoiseIntoPBRPaintMapRGB.
+// It is now a PaintMapBake, which queued bakes step through a few patches
+// per frame, and the synchronous bake runs in one go.
+namespace
+{
+    // Patches evaluated, or drawn, per frame by a queued bake
+    constexpr U32 PATCHES_PER_SLICE = 32;
+
+    class PaintMapBake
+    {
+    public:
+        PaintMapBake(const LLViewerRegion& region, LLViewerTexture& tex, LLTerrainPaintMap::bake_callback_t callback);
+
+        // Evaluate or draw up to max_patches patches of region. Returns true
+        // once the bake is done, see isSuccess().
+        bool step(const LLViewerRegion& region, U32 max_patches);
+
+        // Call back with the result, once
+        void finish();
+
+        U64 getRegionHandle() const { return mRegionHandle; }
+        bool isSuccess() const { return mSuccess; }
+
+    private:
+        enum EStage
+        {
+            STAGE_GEOMETRY,
+            STAGE_DRAW,
+            STAGE_DONE
+        };
+
+        void addPatchGeometry(const LLSurface& surface, U32 patch_index);
+        bool beginDraw(const LLViewerRegion& region);
+        void drawPatches(const LLViewerRegion& region, U32 first, U32 count);
+        bool copyToTexture();
+
+        LLPointer<LLViewerTexture>          mTexture;
+        LLTerrainPaintMap::bake_callback_t  mCallback;
+        U64                                 mRegionHandle;
+        EStage                              mStage = STAGE_GEOMETRY;
+        U32                                 mNextPatch = 0;
+        bool                                mSuccess = false;
+
+        // Vertex and index counts adapted from LLVOSurfacePatch::getGeomSizesMain,
+        // with additional vertices added as we are including the north and east
+        // edges here.
+        U32                                 mPatchCount = 0;    // per edge
+        U32                                 mVertSize = 0;      // per patch edge
+        U32                                 mPatchVertices = 0;
+        U32                                 mPatchIndices = 0;
+
+        std::vector<U32>                    mIndices;
+        std::vector<LLVector4a>             mPositions;
+        std::vector<LLVector2>              mTexCoords1;
+        F32                                 mMinZ = F32_MAX;    // of the evaluated vertices
+        F32                                 mMaxZ = -F32_MAX;
+
+        LLPointer<LLVertexBuffer>           mBuffer;
+        LLRenderTarget                      mTarget;
+        glm::mat4                           mModelview;
+        F32                                 mNear = 0.f;
+        F32                                 mFar = 0.f;
+    };
+
+    std::vector<std::unique_ptr<PaintMapBake>> sBakes;
+}
+
+PaintMapBake::PaintMapBake(const LLViewerRegion& region, LLViewerTexture& tex, LLTerrainPaintMap::bake_callback_t callback)
+:   mTexture(&tex),
+    mCallback(callback),
+    mRegionHandle(region.getHandle())
 {
     llassert(tex.getComponents() == 3);
     llassert(tex.getWidth() > 0 && tex.getHeight() > 0);
@@ -52,177 +123,245 @@ bool LLTerrainPaintMap::bakeHeightNoiseIntoPBRPaintMapRGB(const LLViewerRegion&
     llassert(tex.getGLTexture());
 
     const LLSurface& surface = region.getLand();
-    const U32 patch_count = surface.getPatchesPerEdge();
+    mPatchCount = surface.getPatchesPerEdge();
 
     // *TODO: mHeightsGenerated isn't guaranteed to be true. Assume terrain is
     // loaded for now. Would be nice to fix the loading issue or find a better
     // heuristic to determine that the terrain is sufficiently loaded.
-#if 0
-    // Don't proceed if the region heightmap isn't loaded
-    for (U32 rj = 0; rj < patch_count; ++rj)
+
+    // Need to get the full resolution vertices in order to get an accurate
+    // paintmap. It's not sufficient to iterate over the surface patches, as
+    // they may be at lower LODs.
+    // The functionality here is a subset of
+    // LLVOSurfacePatch::getTerrainGeometry. Unlike said function, we don't
+    // care about stride length since we're always rendering at full
+    // resolution. We also don't care about normals/tangents because those
+    // don't contribute to the paintmap.
+    // *NOTE: The actual getTerrainGeometry fits the terrain vertices snugly
+    // under the 16-bit indices limit. For the sake of simplicity, that has not
+    // been replicated here.
+    const U32 patch_size = (U32)surface.getGridsPerPatchEdge();
+    mVertSize = patch_size + 1;
+    mPatchVertices = mVertSize * mVertSize;
+    mPatchIndices = 6 * (mVertSize - 1) * (mVertSize - 1);
+
+    const U32 patches = mPatchCount * mPatchCount;
+    mIndices.reserve(mPatchIndices * patches);
+    mPositions.reserve(mPatchVertices * patches);
+    mTexCoords1.reserve(mPatchVertices * patches);
+}
+
+bool PaintMapBake::step(const LLViewerRegion& region, U32 max_patches)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    const U32 patches = mPatchCount * mPatchCount;
+    if (mStage == STAGE_GEOMETRY)
+    {
+        const LLSurface& surface = region.getLand();
+        if ((U32)surface.getPatchesPerEdge() != mPatchCount || (U32)surface.getGridsPerPatchEdge() + 1 != mVertSize)
+        {
+            LL_WARNS() << "Region surface changed during paintmap bake" << LL_ENDL;
+            mStage = STAGE_DONE;
+            return true;
+        }
+
+        const U32 end = mNextPatch + llmin(max_patches, patches - mNextPatch);
+        for (; mNextPatch < end; ++mNextPatch)
+        {
+            addPatchGeometry(surface, mNextPatch);
+        }
+
+        if (mNextPatch < patches)
+        {
+            return false;
+        }
+
+        // Draw in the following slices, the geometry was enough for this one
+        mNextPatch = 0;
+        if (!beginDraw(region))
+        {
+            mStage = STAGE_DONE;
+            return true;
+        }
+        mStage = STAGE_DRAW;
+        return false;
+    }
+
+    if (mStage == STAGE_DRAW)
+    {
+        const U32 count = llmin(max_patches, patches - mNextPatch);
+        drawPatches(region, mNextPatch, count);
+        mNextPatch += count;
+
+        if (mNextPatch < patches)
+        {
+            return false;
+        }
+
+        mSuccess = copyToTexture();
+        mStage = STAGE_DONE;
+    }
+
+    return true;
+}
+
+void PaintMapBake::finish()
+{
+    // Nothing of the bake is needed past this point
+    mBuffer = nullptr;
+    mTarget.release();
+
+    if (mCallback)
+    {
+        LLTerrainPaintMap::bake_callback_t callback = mCallback;
+        mCallback = nullptr;
+        callback(mSuccess);
+    }
+}
+
+void PaintMapBake::addPatchGeometry(const LLSurface& surface, U32 patch_index)
+{
+    const U32 ri = patch_index % mPatchCount;
+    const U32 rj = patch_index / mPatchCount;
+    constexpr U32 stride = 1;
+
+    const U32 index_offset = (U32)mPositions.size();
+    for (U32 j = 0; j < (mVertSize - 1); ++j)
+    {
+        for (U32 i = 0; i < (mVertSize - 1); ++i)
+        {
+            // y
+            //    2....3
+            // ^  .    .
+            // |  0....1
+            // |
+            // ------->  x
+            //
+            // triangle 1: 0,1,2
+            // triangle 2: 1,3,2
+            // 0: vert0
+            // 1: vert0 + 1
+            // 2: vert0 + vert_size
+            // 3: vert0 + vert_size + 1
+            const U32 vert0 = index_offset + i + (j*mVertSize);
+            mIndices.push_back(vert0);
+            mIndices.push_back(vert0 + 1);
+            mIndices.push_back(vert0 + mVertSize);
+            mIndices.push_back(vert0 + 1);
+            mIndices.push_back(vert0 + mVertSize + 1);
+            mIndices.push_back(vert0 + mVertSize);
+        }
+    }
+
+    const LLSurfacePatch* patch = surface.getPatch(ri, rj);
+    for (U32 j = 0; j < mVertSize; ++j)
     {
-        for (U32 ri = 0; ri < patch_count; ++ri)
+        for (U32 i = 0; i < mVertSize; ++i)
         {
-            const LLSurfacePatch* patch = surface.getPatch(ri, rj);
-            if (!patch->isHeightsGenerated())
-            {
-                LL_WARNS() << "Region heightmap not fully loaded" << LL_ENDL;
-                return false;
-            }
+            LLVector3 scratch3;
+            LLVector3 pos3;
+            LLVector2 tex1_temp;
+            patch->eval(i, j, stride, &pos3, &scratch3, &tex1_temp);
+            mPositions.emplace_back();
+            mPositions.back().set(pos3.mV[VX], pos3.mV[VY], pos3.mV[VZ]);
+            mTexCoords1.push_back(tex1_temp);
+            mMinZ = llmin(mMinZ, pos3.mV[VZ]);
+            mMaxZ = llmax(mMaxZ, pos3.mV[VZ]);
         }
     }
-#endif
+}
 
-    // Bind the debug shader and render terrain to tex
+bool PaintMapBake::beginDraw(const LLViewerRegion& region)
+{
     // Use a scratch render target because its dimensions may exceed the standard bake target, and this is a one-off bake
-    LLRenderTarget scratch_target;
-    const S32 dim = llmin(tex.getWidth(), tex.getHeight());
-    scratch_target.allocate(dim, dim, GL_RGB, false, LLTexUnit::eTextureType::TT_TEXTURE,
-                                   LLTexUnit::eTextureMipGeneration::TMG_NONE);
-    if (!scratch_target.isComplete())
+    const S32 dim = llmin(mTexture->getWidth(), mTexture->getHeight());
+    mTarget.allocate(dim, dim, GL_RGB, false, LLTexUnit::eTextureType::TT_TEXTURE,
+                     LLTexUnit::eTextureMipGeneration::TMG_NONE);
+    if (!mTarget.isComplete())
     {
         llassert(false);
         LL_WARNS() << "Failed to allocate render target" << LL_ENDL;
         return false;
     }
-    gGL.getTexUnit(0)->disable();
-    stop_glerror();
 
-    scratch_target.bindTarget();
-    glClearColor(0, 0, 0, 0);
-    scratch_target.clear();
+    if (LLGLSLShader::sCurBoundShaderPtr == nullptr)
+    { // make sure a shader is bound to satisfy mVertexBuffer->setBuffer
+        gDebugProgram.bind();
+    }
+    mBuffer = new LLVertexBuffer(LLVertexBuffer::MAP_VERTEX | LLVertexBuffer::MAP_TEXCOORD1);
+    mBuffer->allocateBuffer((U32)mPositions.size(), (U32)mIndices.size()*2); // hack double index count... TODO: find a better way to indicate 32-bit indices will be used
+    mBuffer->setBuffer();
+    mBuffer->setIndexData(mIndices.data(), 0, (U32)mIndices.size());
+    mBuffer->setPositionData(mPositions.data(), 0, (U32)mPositions.size());
+    mBuffer->setTexCoord1Data(mTexCoords1.data(), 0, (U32)mTexCoords1.size());
+    mBuffer->unmapBuffer();
+    mBuffer->unbind();
 
-    // Render terrain heightmap to paint map via shader
+    // The buffer has it all
+    mIndices = std::vector<U32>();
+    mPositions = std::vector<LLVector4a>();
+    mTexCoords1 = std::vector<LLVector2>();
 
-    // Set up viewport, camera, and orthographic projection matrix. Position
-    // the camera such that the camera points straight down, and the region
-    // completely covers the "screen". Since orthographic projection does not
-    // distort, we arbitrarily choose the near plane and far plane to cover the
-    // full span of region heights, plus a small amount of padding to account
-    // for rounding errors.
+    // Set up camera and orthographic projection matrix. Position the camera
+    // such that the camera points straight down, and the region completely
+    // covers the "screen". Since orthographic projection does not distort,
+    // we arbitrarily choose the near plane and far plane to cover the full
+    // span of region heights, plus a small amount of padding to account for
+    // rounding errors.
+    // The vertices are region local, and so is the camera, which keeps the
+    // bake right when the agent space origin moves between slices.
     const F32 region_width = region.getWidth();
     const F32 region_half_width = region_width / 2.0f;
-    const F32 region_camera_height = surface.getMaxZ() + DEFAULT_NEAR_PLANE;
+    const F32 region_camera_height = mMaxZ + DEFAULT_NEAR_PLANE;
     LLViewerCamera camera;
-    const LLVector3 region_center = LLVector3(region_half_width, region_half_width, 0.0) + region.getOriginAgent();
+    const LLVector3 region_center = LLVector3(region_half_width, region_half_width, 0.0);
     const LLVector3 camera_origin = LLVector3(0.0f, 0.0f, region_camera_height) + region_center;
     camera.lookAt(camera_origin, region_center, LLVector3::y_axis);
-    camera.setAspect(F32(scratch_target.getHeight()) / F32(scratch_target.getWidth()));
-    const LLRect texture_rect(0, scratch_target.getHeight(), scratch_target.getWidth(), 0);
-    glViewport(texture_rect.mLeft, texture_rect.mBottom, texture_rect.getWidth(), texture_rect.getHeight());
+    camera.setAspect(F32(mTarget.getHeight()) / F32(mTarget.getWidth()));
     // Manually get modelview matrix from camera orientation.
-    glm::mat4 modelview(glm::make_mat4((GLfloat *) OGL_TO_CFR_ROTATION));
+    mModelview = glm::make_mat4((GLfloat *) OGL_TO_CFR_ROTATION);
     GLfloat ogl_matrix[16];
     camera.getOpenGLTransform(ogl_matrix);
-    modelview *= glm::make_mat4(ogl_matrix);
+    mModelview *= glm::make_mat4(ogl_matrix);
+    llassert(camera_origin.mV[VZ] >= mMaxZ);
+    mNear = camera_origin.mV[VZ] - mMaxZ;
+    constexpr F32 far_plane_delta = 0.25f;
+    mFar = camera_origin.mV[VZ] - mMinZ + far_plane_delta;
+
+    gGL.getTexUnit(0)->disable();
+    stop_glerror();
+
+    mTarget.bindTarget();
+    glClearColor(0, 0, 0, 0);
+    mTarget.clear();
+    mTarget.flush();
+
+    LLGLSLShader::unbind();
+
+    return true;
+}
+
+void PaintMapBake::drawPatches(const LLViewerRegion& region, U32 first, U32 count)
+{
+    mTarget.bindTarget();
+
+    // Render terrain heightmap to paint map via shader
+    const LLRect texture_rect(0, mTarget.getHeight(), mTarget.getWidth(), 0);
+    glViewport(texture_rect.mLeft, texture_rect.mBottom, texture_rect.getWidth(), texture_rect.getHeight());
     gGL.matrixMode(LLRender::MM_MODELVIEW);
-    gGL.loadMatrix(glm::value_ptr(modelview));
+    gGL.pushMatrix();
+    gGL.loadMatrix(glm::value_ptr(mModelview));
     // Override the projection matrix from the camera
     gGL.matrixMode(LLRender::MM_PROJECTION);
     gGL.pushMatrix();
     gGL.loadIdentity();
-    llassert(camera_origin.mV[VZ] >= surface.getMaxZ());
-    const F32 region_high_near = camera_origin.mV[VZ] - surface.getMaxZ();
-    constexpr F32 far_plane_delta = 0.25f;
-    const F32 region_low_far = camera_origin.mV[VZ] - surface.getMinZ() + far_plane_delta;
-    gGL.ortho(-region_half_width, region_half_width, -region_half_width, region_half_width, region_high_near, region_low_far);
+    const F32 region_half_width = region.getWidth() / 2.0f;
+    gGL.ortho(-region_half_width, region_half_width, -region_half_width, region_half_width, mNear, mFar);
     // No need to call camera.setPerspective because we don't need the clip planes. It would be inaccurate due to the perspective rendering anyway.
 
-    // Need to get the full resolution vertices in order to get an accurate
-    // paintmap. It's not sufficient to iterate over the surface patches, as
-    // they may be at lower LODs.
-    // The functionality here is a subset of
-    // LLVOSurfacePatch::getTerrainGeometry. Unlike said function, we don't
-    // care about stride length since we're always rendering at full
-    // resolution. We also don't care about normals/tangents because those
-    // don't contribute to the paintmap.
-    // *NOTE: The actual getTerrainGeometry fits the terrain vertices snugly
-    // under the 16-bit indices limit. For the sake of simplicity, that has not
-    // been replicated here.
-    std::vector<LLPointer<LLDrawInfo>> infos;
-    // Vertex and index counts adapted from LLVOSurfacePatch::getGeomSizesMain,
-    // with additional vertices added as we are including the north and east
-    // edges here.
-    const U32 patch_size = (U32)surface.getGridsPerPatchEdge();
-    constexpr U32 stride = 1;
-    const U32 vert_size = (patch_size / stride) + 1;
-    const U32 n = vert_size * vert_size;
-    const U32 ni = 6 * (vert_size - 1) * (vert_size - 1);
-    const U32 region_vertices = n * patch_count * patch_count;
-    const U32 region_indices = ni * patch_count * patch_count;
-    if (LLGLSLShader::sCurBoundShaderPtr == nullptr)
-    { // make sure a shader is bound to satisfy mVertexBuffer->setBuffer
-        gDebugProgram.bind();
-    }
-    LLPointer<LLVertexBuffer> buf = new LLVertexBuffer(LLVertexBuffer::MAP_VERTEX | LLVertexBuffer::MAP_TEXCOORD1);
-    {
-        buf->allocateBuffer(region_vertices, region_indices*2); // hack double index count... TODO: find a better way to indicate 32-bit indices will be used
-        buf->setBuffer();
-        U32 vertex_total = 0;
-        std::vector<U32> index_array(region_indices);
-        std::vector<LLVector4a> positions(region_vertices);
-        std::vector<LLVector2> texcoords1(region_vertices);
-        auto idx = index_array.begin();
-        auto pos = positions.begin();
-        auto tex1 = texcoords1.begin();
-        for (U32 rj = 0; rj < patch_count; ++rj)
-        {
-            for (U32 ri = 0; ri < patch_count; ++ri)
-            {
-                const U32 index_offset = vertex_total;
-                for (U32 j = 0; j < (vert_size - 1); ++j)
-                {
-                    for (U32 i = 0; i < (vert_size - 1); ++i)
-                    {
-                        // y
-                        //    2....3
-                        // ^  .    .
-                        // |  0....1
-                        // |
-                        // ------->  x
-                        //
-                        // triangle 1: 0,1,2
-                        // triangle 2: 1,3,2
-                        // 0: vert0
-                        // 1: vert0 + 1
-                        // 2: vert0 + vert_size
-                        // 3: vert0 + vert_size + 1
-                        const U32 vert0 = index_offset + i + (j*vert_size);
-                        *idx++ = vert0;
-                        *idx++ = vert0 + 1;
-                        *idx++ = vert0 + vert_size;
-                        *idx++ = vert0 + 1;
-                        *idx++ = vert0 + vert_size + 1;
-                        *idx++ = vert0 + vert_size;
-                    }
-                }
-
-                const LLSurfacePatch* patch = surface.getPatch(ri, rj);
-                for (U32 j = 0; j < vert_size; ++j)
-                {
-                    for (U32 i = 0; i < vert_size; ++i)
-                    {
-                        LLVector3 scratch3;
-                        LLVector3 pos3;
-                        LLVector2 tex1_temp;
-                        patch->eval(i, j, stride, &pos3, &scratch3, &tex1_temp);
-                        (*pos++).set(pos3.mV[VX], pos3.mV[VY], pos3.mV[VZ]);
-                        *tex1++ = tex1_temp;
-                        vertex_total++;
-                    }
-                }
-            }
-        }
-        buf->setIndexData(index_array.data(), 0, (U32)index_array.size());
-        buf->setPositionData(positions.data(), 0, (U32)positions.size());
-        buf->setTexCoord1Data(texcoords1.data(), 0, (U32)texcoords1.size());
-        buf->unmapBuffer();
-        buf->unbind();
-    }
-
-    // Draw the region in agent space at full resolution
+    // Draw the region at full resolution
     {
-
         LLGLSLShader::unbind();
         // *NOTE: A theoretical non-PBR terrain bake program would be
         // *slightly* different, due the texture terrain shader not having an
@@ -240,18 +379,16 @@ bool LLTerrainPaintMap::bakeHeightNoiseIntoPBRPaintMapRGB(const LLViewerRegion&
         gGL.getTexUnit(alpha_ramp)->bind(alpha_ramp_texture);
         gGL.getTexUnit(alpha_ramp)->setTextureAddressMode(LLTexUnit::TAM_CLAMP);
 
-        buf->setBuffer();
-        for (U32 rj = 0; rj < patch_count; ++rj)
+        mBuffer->setBuffer();
+        const U32 region_vertices = mPatchVertices * mPatchCount * mPatchCount;
+        const U32 region_indices = mPatchIndices * mPatchCount * mPatchCount;
+        for (U32 patch_index = first; patch_index < first + count; ++patch_index)
         {
-            for (U32 ri = 0; ri < patch_count; ++ri)
-            {
-                const U32 patch_index = ri + (rj * patch_count);
-                const U32 index_offset = ni * patch_index;
-                const U32 vertex_offset = n * patch_index;
-                llassert(index_offset + ni <= region_indices);
-                llassert(vertex_offset + n <= region_vertices);
-                buf->drawRange(LLRender::TRIANGLES, vertex_offset, vertex_offset + n - 1, ni, index_offset);
-            }
+            const U32 index_offset = mPatchIndices * patch_index;
+            const U32 vertex_offset = mPatchVertices * patch_index;
+            llassert(index_offset + mPatchIndices <= region_indices);
+            llassert(vertex_offset + mPatchVertices <= region_vertices);
+            mBuffer->drawRange(LLRender::TRIANGLES, vertex_offset, vertex_offset + mPatchVertices - 1, mPatchIndices, index_offset);
         }
 
         shader.disableTexture(LLViewerShaderMgr::TERRAIN_ALPHARAMP);
@@ -265,11 +402,22 @@ bool LLTerrainPaintMap::bakeHeightNoiseIntoPBRPaintMapRGB(const LLViewerRegion&
 
     gGL.matrixMode(LLRender::MM_PROJECTION);
     gGL.popMatrix();
+    gGL.matrixMode(LLRender::MM_MODELVIEW);
+    gGL.popMatrix();
 
     gGL.flush();
     LLVertexBuffer::unbind();
+
+    mTarget.flush();
+}
+
+bool PaintMapBake::copyToTexture()
+{
+    mTarget.bindTarget();
+
     // Final step: Copy the output to the terrain paintmap
-    const bool success = tex.getGLTexture()->setSubImageFromFrameBuffer(0, 0, 0, 0, dim, dim);
+    const S32 dim = llmin(mTexture->getWidth(), mTexture->getHeight());
+    const bool success = mTexture->getGLTexture()->setSubImageFromFrameBuffer(0, 0, 0, 0, dim, dim);
     if (!success)
     {
         LL_WARNS() << "Failed to copy framebuffer to paintmap" << LL_ENDL;
@@ -277,9 +425,59 @@ bool LLTerrainPaintMap::bakeHeightNoiseIntoPBRPaintMapRGB(const LLViewerRegion&
     glGenerateMipmap(GL_TEXTURE_2D);
     stop_glerror();
 
-    scratch_target.flush();
+    mTarget.flush();
 
     LLGLSLShader::unbind();
 
     return success;
 }
+
+// static
+bool LLTerrainPaintMap::bakeHeightNoiseIntoPBRPaintMapRGB(const LLViewerRegion& region, LLViewerTexture& tex)
+{
+    PaintMapBake bake(region, tex, nullptr);
+    while (!bake.step(region, U32_MAX))
+    {
+    }
+    bake.finish();
+    return bake.isSuccess();
+}
+
+// static
+void LLTerrainPaintMap::queueBakeHeightNoiseIntoPBRPaintMapRGB(const LLViewerRegion& region, LLViewerTexture& tex, bake_callback_t callback)
+{
+    sBakes.emplace_back(new PaintMapBake(region, tex, callback));
+}
+
+// static
+void LLTerrainPaintMap::updateBakes()
+{
+    if (sBakes.empty())
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED;
+
+    PaintMapBake& bake = *sBakes.front();
+    LLViewerRegion* region = LLWorld::getInstance()->getRegionFromHandle(bake.getRegionHandle());
+    if (!region || bake.step(*region, PATCHES_PER_SLICE))
+    {
+        if (!region)
+        {
+            LL_WARNS() << "Region left during paintmap bake" << LL_ENDL;
+        }
+
+        // Off the queue first, the callback may queue another bake
+        std::unique_ptr<PaintMapBake> done = std::move(sBakes.front());
+        sBakes.erase(sBakes.begin());
+        done->finish();
+    }
+}
+
+// static
+void LLTerrainPaintMap::cancelBakes()
+{
+    sBakes.clear();
+}
+// </FS>
@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <functional> // <FS/> Asynchronous paint map bake
+
 class LLViewerRegion;
 class LLViewerTexture;
 
@@ -39,4 +41,22 @@ public:
     // to type TERRAIN_PAINT_TYPE_PBR_PAINTMAP.
     // Returns true if successful
     static bool bakeHeightNoiseIntoPBRPaintMapRGB(const LLViewerRegion& region, LLViewerTexture& tex);
+
+    // <FS> Asynchronous paint map bake
+    typedef std::function<void(bool success)> bake_callback_t;
+
+    // Threads:  Tmain
+    // As bakeHeightNoiseIntoPBRPaintMapRGB, spread over the next frames so
+    // a region's worth of terrain does not stall one of them. tex is left
+    // alone until the bake is done, so a paint map already in use stays in
+    // use until callback is called. Bakes run one at a time, in order.
+    static void queueBakeHeightNoiseIntoPBRPaintMapRGB(const LLViewerRegion& region, LLViewerTexture& tex, bake_callback_t callback);
+
+    // Threads:  Tmain
+    // Run the next slice of the queued bakes, once per frame
+    static void updateBakes();
+
+    // Drop the queued bakes without calling back, before the GL context goes
+    static void cancelBakes();
+    // </FS>
 };
@@ -1233,11 +1233,18 @@ void LLTextureCache::writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool
 
     closeHeaderEntriesFile();
     mUpdatedEntryMap.erase(idx) ;
+    setCachedEntry(idx, entry);
 }
 
 //mHeaderMutex is locked before calling this.
 void LLTextureCache::readEntryFromHeaderImmediately(S32& idx, Entry& entry)
 {
+    if (idx >= 0 && idx < (S32)mEntries.size())
+    {
+        entry = mEntries[idx];
+        return;
+    }
+
     S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
     LLAPRFile* aprfile = openHeaderEntriesFile(true, offset);
     S32 bytes_read = aprfile->read((void*)&entry, (S32)sizeof(Entry));
@@ -1248,6 +1255,24 @@ void LLTextureCache::readEntryFromHeaderImmediately(S32& idx, Entry& entry)
         clearCorruptedCache() ; //clear the cache.
         idx = -1 ;//mark the idx invalid.
     }
+    else
+    {
+        setCachedEntry(idx, entry);
+    }
+}
+
+//mHeaderMutex is locked before calling this.
+void LLTextureCache::setCachedEntry(S32 idx, const Entry& entry)
+{
+    // Only ever grows by appending, so mEntries matches the start of the file
+    if (idx < (S32)mEntries.size())
+    {
+        mEntries[idx] = entry;
+    }
+    else if (idx == (S32)mEntries.size())
+    {
+        mEntries.push_back(entry);
+    }
 }
 
 //mHeaderMutex is locked before calling this.
@@ -1335,6 +1360,34 @@ U32 LLTextureCache::openAndReadEntries(std::vector<Entry>& entries)
     mFreeList.clear();
     mTexturesSizeTotal = 0;
 
+    if (!mUpdatedEntryMap.empty() && !mReadOnly)
+    {
+        openHeaderEntriesFile(false, 0);
+        updatedHeaderEntriesFile();
+        closeHeaderEntriesFile();
+    }
+
+    if (mEntries.size() == num_entries)
+    {
+        // The in-memory copy is complete, no need to read the file again
+        entries = mEntries;
+        for (U32 idx = 0; idx < num_entries; idx++)
+        {
+            const Entry& entry = entries[idx];
+            if (entry.mImageSize > entry.mBodySize)
+            {
+                mHeaderIDMap[entry.mID] = idx;
+                mTexturesSizeMap[entry.mID] = entry.mBodySize;
+                mTexturesSizeTotal += entry.mBodySize;
+            }
+            else
+            {
+                mFreeList.insert(idx);
+            }
+        }
+        return num_entries;
+    }
+
     LLAPRFile* aprfile = NULL;
     if(mUpdatedEntryMap.empty())
     {
@@ -1362,6 +1415,7 @@ U32 LLTextureCache::openAndReadEntries(std::vector<Entry>& entries)
             return 0;
         }
         entries.push_back(entry);
+        setCachedEntry(idx, entry);
 //      LL_INFOS() << "ENTRY: " << entry.mTime << " TEX: " << entry.mID << " IDX: " << idx << " Size: " << entry.mImageSize << LL_ENDL;
         if(entry.mImageSize > entry.mBodySize)
         {
@@ -1385,15 +1439,27 @@ void LLTextureCache::writeEntriesAndClose(const std::vector<Entry>& entries)
 
     if (!mReadOnly)
     {
-        LLAPRFile* aprfile = openHeaderEntriesFile(false, (S32)sizeof(EntriesInfo));
+        // Only rewrite the entries that differ from what is on disk
+        LLAPRFile* aprfile = openHeaderEntriesFile(false, 0);
         for (size_t idx=0; idx<num_entries; idx++)
         {
-            S32 bytes_written = aprfile->write((void*)(&entries[idx]), (S32)sizeof(Entry));
+            const Entry& entry = entries[idx];
+            if (idx < mEntries.size() &&
+                mEntries[idx].mID == entry.mID &&
+                mEntries[idx].mImageSize == entry.mImageSize &&
+                mEntries[idx].mBodySize == entry.mBodySize &&
+                mEntries[idx].mTime == entry.mTime)
+            {
+                continue;
+            }
+            aprfile->seek(APR_SET, (S32)(sizeof(EntriesInfo) + idx * sizeof(Entry)));
+            S32 bytes_written = aprfile->write((void*)(&entry), (S32)sizeof(Entry));
             if(bytes_written != sizeof(Entry))
             {
                 clearCorruptedCache() ; //clear the cache.
                 return ;
             }
+            setCachedEntry((S32)idx, entry);
         }
         closeHeaderEntriesFile();
     }
@@ -1444,6 +1510,7 @@ void LLTextureCache::updatedHeaderEntriesFile()
                 clearCorruptedCache() ; //clear the cache.
                 return ;
             }
+            setCachedEntry(iter->first, iter->second);
         }
         mUpdatedEntryMap.clear() ;
     }
@@ -1643,6 +1710,7 @@ void LLTextureCache::purgeAllTextures(bool purge_directories)
     mFreeList.clear();
     mTexturesSizeTotal = 0;
     mUpdatedEntryMap.clear();
+    mEntries.clear();
 
     // Info with 0 entries
     setEntriesHeader();
@@ -176,6 +176,7 @@ private:
     U32 openAndReadEntries(std::vector<Entry>& entries);
     void writeEntriesAndClose(const std::vector<Entry>& entries);
     void readEntryFromHeaderImmediately(S32& idx, Entry& entry) ;
+    void setCachedEntry(S32 idx, const Entry& entry);
     void writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool write_header = false) ;
     void removeEntry(S32 idx, Entry& entry, std::string& filename);
     void removeCachedTexture(const LLUUID& id) ;
@@ -241,6 +242,9 @@ private:
 
     typedef std::map<S32, Entry> idx_entry_map_t;
     idx_entry_map_t mUpdatedEntryMap;
+    // In-memory copy of the entries in mHeaderEntriesFileName, so that
+    // lookups under mHeaderMutex never have to touch the disk
+    std::vector<Entry> mEntries;
     typedef std::vector<std::pair<S32, Entry> > idx_entry_vector_t;
     idx_entry_vector_t mPurgeEntryList;
 
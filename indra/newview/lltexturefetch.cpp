@@ -37,6 +37,7 @@
 #include "llimage.h"
 #include "llimagej2c.h"
 #include "llimageworker.h"
+#include "llfilesystem.h"
 #include "llworkerthread.h"
 #include "message.h"
 
@@ -64,6 +65,13 @@
 #include "fsassetblacklist.h" //For Asset blacklist
 #include "llviewermenu.h"
 #include "llviewernetwork.h" // <FS:Ansariel> OpenSim compatibility
+#include "fstexturefetchtrace.h"
+
+#ifdef LL_USESYSTEMLIBS
+# include <zlib.h>
+#else
+# include "zlib-ng/zlib.h"
+#endif
 
 LLTrace::CountStatHandle<F64> LLTextureFetch::sCacheHit("texture_cache_hit");
 LLTrace::CountStatHandle<F64> LLTextureFetch::sCacheAttempt("texture_cache_attempt");
@@ -246,6 +254,11 @@ static const S32 HTTP_REQUESTS_RANGE_END_MAX = 20000000;
 static const S32 MAX_CAP_MISSING_RETRIES = 720;
 static const S32 CAP_MISSING_EXPIRATION_DELAY = 1; // seconds
 
+// Progressive fetch: the first request covers the j2c header and the lowest
+// resolution levels, only worth it when a lot more than that is wanted.
+static const S32 PROGRESSIVE_FETCH_FIRST_SIZE = 16 * 1024;
+static const S32 PROGRESSIVE_FETCH_MIN_SIZE = 4 * PROGRESSIVE_FETCH_FIRST_SIZE;
+
 //////////////////////////////////////////////////////////////////////////////
 namespace
 {
@@ -260,6 +273,103 @@ namespace
     // "delete" derives from Latin "deletus"
     void NoOpDeletor(LLCore::HttpHandler *)
     { /*NoOp*/ }
+
+    // Decoded texture cache: raw images already decoded from j2c, stored in
+    // the asset disk cache keyed by texture id and discard level so a revisit
+    // can skip the decode. The pixels are zlib compressed so they take as
+    // little as possible of the budget shared with the other assets; inflating
+    // them is still much cheaper than a j2c decode.
+    const U32 DECODED_CACHE_MAGIC = 0x5a545244; // "DRTZ"
+    const S32 DECODED_CACHE_MAX_BYTES = 1024 * 1024 * 4;
+
+    struct decoded_header_t
+    {
+        U32 mMagic;
+        U16 mFullWidth;     // Of the formatted image, to catch stale entries
+        U16 mFullHeight;
+        U16 mWidth;
+        U16 mHeight;
+        U8  mComponents;
+        U8  mDiscard;
+        U16 mPad;
+        U32 mCompressedSize;
+    };
+
+    LLUUID decoded_cache_id(const LLUUID& id, S32 discard)
+    {
+        return LLUUID::generateNewID(llformat("decoded_texture:%s:%d", id.asString().c_str(), discard));
+    }
+
+    // Threads:  Tid
+    LLPointer<LLImageRaw> read_decoded_cache(const LLUUID& id, const LLImageFormatted* image)
+    {
+        LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+        S32 discard = image->getDiscardLevel();
+        LLUUID cache_id = decoded_cache_id(id, discard);
+        if (!LLFileSystem::getExists(cache_id, LLAssetType::AT_TEXTURE))
+        {
+            return nullptr;
+        }
+
+        LLFileSystem file(cache_id, LLAssetType::AT_TEXTURE, LLFileSystem::READ);
+        decoded_header_t header;
+        if (!file.read((U8*)&header, sizeof(header)) || file.getLastBytesRead() != sizeof(header) ||
+            header.mMagic != DECODED_CACHE_MAGIC || header.mDiscard != discard ||
+            header.mFullWidth != image->getWidth() || header.mFullHeight != image->getHeight() ||
+            header.mComponents != image->getComponents())
+        {
+            return nullptr;
+        }
+
+        S32 data_size = (S32)header.mWidth * header.mHeight * header.mComponents;
+        S32 compressed_size = (S32)header.mCompressedSize;
+        if (data_size <= 0 || data_size > DECODED_CACHE_MAX_BYTES || compressed_size <= 0 || compressed_size >= data_size ||
+            file.getSize() != (S32)sizeof(header) + compressed_size)
+        {
+            return nullptr;
+        }
+
+        std::vector<U8> compressed(compressed_size);
+        if (!file.read(compressed.data(), compressed_size) || file.getLastBytesRead() != compressed_size)
+        {
+            return nullptr;
+        }
+
+        LLPointer<LLImageRaw> raw = new LLImageRaw(header.mWidth, header.mHeight, header.mComponents);
+        uLongf raw_size = data_size;
+        if (!raw->getData() ||
+            uncompress(raw->getData(), &raw_size, compressed.data(), compressed_size) != Z_OK || raw_size != (uLongf)data_size)
+        {
+            return nullptr;
+        }
+        return raw;
+    }
+
+    // Threads:  Tid
+    void write_decoded_cache(const LLUUID& id, const LLImageRaw* raw, S32 full_width, S32 full_height, S32 discard)
+    {
+        S32 data_size = raw->getDataSize();
+        if (!raw->getData() || data_size <= 0 || data_size > DECODED_CACHE_MAX_BYTES)
+        {
+            return;
+        }
+
+        std::vector<U8> data(sizeof(decoded_header_t) + compressBound(data_size));
+        uLongf compressed_size = (uLongf)(data.size() - sizeof(decoded_header_t));
+        if (compress2(data.data() + sizeof(decoded_header_t), &compressed_size, raw->getData(), data_size, Z_BEST_SPEED) != Z_OK ||
+            compressed_size >= (uLongf)data_size)
+        {
+            // Not worth taking asset cache space from, decode it again next time
+            return;
+        }
+
+        decoded_header_t header = { DECODED_CACHE_MAGIC, (U16)full_width, (U16)full_height,
+                                    (U16)raw->getWidth(), (U16)raw->getHeight(),
+                                    (U8)raw->getComponents(), (U8)discard, 0, (U32)compressed_size };
+        memcpy(data.data(), &header, sizeof(header));
+        data.resize(sizeof(header) + compressed_size);
+        LLFileSystem::writeAsync(decoded_cache_id(id, discard), LLAssetType::AT_TEXTURE, std::move(data), LLFileSystem::WRITE, nullptr);
+    }
 }
 
 static const char* e_state_name[] =
@@ -358,12 +468,21 @@ private:
             LLTextureFetchWorker* worker = mFetcher->getWorker(mID);
             if (worker)
             {
-                worker->callbackDecoded(success, error_message, raw, aux, request_id);
+                worker->callbackDecoded(success, error_message, raw, aux, request_id, mFromDecodedCache);
             }
         }
+
+        // Threads:  Tid
+        LLPointer<LLImageRaw> lookup(const LLImageFormatted* image)
+        {
+            LLPointer<LLImageRaw> raw = read_decoded_cache(mID, image);
+            mFromDecodedCache = raw.notNull();
+            return raw;
+        }
     private:
         LLTextureFetch* mFetcher;
         LLUUID mID;
+        bool mFromDecodedCache{ false };
     };
 
     struct Compare
@@ -402,7 +521,8 @@ public:
     void callbackCacheWrite(bool success);
 
     // Threads:  Tid
-    void callbackDecoded(bool success, const std::string& error_message, LLImageRaw* raw, LLImageRaw* aux, S32 decode_id);
+    void callbackDecoded(bool success, const std::string& error_message, LLImageRaw* raw, LLImageRaw* aux, S32 decode_id,
+                         bool from_decoded_cache);
 
     // Threads:  T*
     void setGetStatus(LLCore::HttpStatus status, const std::string& reason)
@@ -591,6 +711,9 @@ private:
     bool mWritten;
     bool mNeedsAux;
     bool mHaveAllData;
+    bool mProgressiveFetch;     // Current HTTP request only covers the start of the asset
+    bool mHaveInterimRaw;       // mRawImage is a coarse decode kept while the rest downloads
+    bool mUseDecodedCache;      // Current decode may be served from / stored in the decoded cache
     bool mInLocalCache;
     bool mInCache;
     bool                        mCanUseHTTP,
@@ -935,6 +1058,9 @@ LLTextureFetchWorker::LLTextureFetchWorker(LLTextureFetch* fetcher,
       mWritten(false),
       mNeedsAux(false),
       mHaveAllData(false),
+      mProgressiveFetch(false),
+      mHaveInterimRaw(false),
+      mUseDecodedCache(false),
       mInLocalCache(false),
       mInCache(false),
       mCanUseHTTP(true),
@@ -1096,6 +1222,13 @@ void LLTextureFetchWorker::setDesiredDiscard(S32 discard, S32 size)
 // Locks:  Mw
 void LLTextureFetchWorker::setImagePriority(F32 priority)
 {
+    // <FS> Decode priority
+    LLImageDecodeThread* decoder = LLAppViewer::getImageDecodeThread();
+    if (mDecodeHandle != 0 && priority != mImagePriority && decoder)
+    {
+        decoder->setPriority(mDecodeHandle, priority);
+    }
+    // </FS>
     mImagePriority = priority; //should map to max virtual size, abort if zero
 }
 
@@ -1239,6 +1372,8 @@ bool LLTextureFetchWorker::doWork(S32 param)
         mHttpReplySize = 0;
         mHttpReplyOffset = 0;
         mHaveAllData = false;
+        mProgressiveFetch = false;
+        mHaveInterimRaw = false;
         clearPackets(); // <FS:Ansariel> OpenSim compatibility
         mCacheReadHandle = LLTextureCache::nullHandle();
         mCacheWriteHandle = LLTextureCache::nullHandle();
@@ -1392,7 +1527,17 @@ bool LLTextureFetchWorker::doWork(S32 param)
         // </FS:Ansariel>
         {
             LLViewerRegion* region = getRegion();
-            if (region)
+            // <FS> Texture fetch replay serves everything from a local server
+            const std::string replay_url = mFetcher->isQAMode() ? mFetcher->getReplayAssetUrl() : std::string();
+            if (!replay_url.empty())
+            {
+                setUrl(replay_url + "/?texture_id=" + mID.asString());
+                mWriteToCacheState = CAN_WRITE;
+                mCanUseCapability = true;
+                mRegionRetryAttempt = 0;
+            }
+            // </FS>
+            else if (region) // <FS/> Texture fetch replay
             {
                 std::string http_url = region->getViewerAssetUrl();
                 // <FS:Ansariel> [UDP Assets]
@@ -1598,6 +1743,17 @@ bool LLTextureFetchWorker::doWork(S32 param)
         }
         mRequestedSize = mDesiredSize;
         mRequestedDiscard = mDesiredDiscard;
+
+        // Fetch the first few KB on their own so a coarse level can be decoded
+        // and shown while the rest of the data is requested.
+        static LLCachedControl<bool> progressive_fetch(gSavedSettings, "FSTextureProgressiveFetch", false);
+        mProgressiveFetch = progressive_fetch && !disable_range_req && cur_size == 0 && mFTType == FTT_DEFAULT &&
+                            mRequestedSize >= PROGRESSIVE_FETCH_MIN_SIZE;
+        if (mProgressiveFetch)
+        {
+            mRequestedSize = PROGRESSIVE_FETCH_FIRST_SIZE;
+        }
+
         mRequestedSize -= cur_size;
         mRequestedOffset = cur_size;
         if (mRequestedOffset)
@@ -1640,6 +1796,14 @@ bool LLTextureFetchWorker::doWork(S32 param)
         // Will call callbackHttpGet when curl request completes
         // Only server bake images use the returned headers currently, for getting retry-after field.
         LLCore::HttpOptions::ptr_t options = (mFTType == FTT_SERVER_BAKE) ? mFetcher->mHttpOptionsWithHeaders: mFetcher->mHttpOptions;
+        if (LLAppViewer::instance()->getAppCoreHttp().isMultiplexed(LLAppCoreHttp::AP_TEXTURE))
+        {
+            // Options are shared between requests, so weighted streams need their own.
+            // Priority is roughly the on-screen pixel area, map its log onto the weight range.
+            options = std::make_shared<LLCore::HttpOptions>();
+            options->setWantHeaders(mFTType == FTT_SERVER_BAKE);
+            options->setStreamWeight(1 + (S32)(log2f(llmax(mImagePriority, 1.f)) * 12.f));
+        }
         if (disable_range_req)
         {
             // 'Range:' requests may be disabled in which case all HTTP
@@ -1848,7 +2012,22 @@ bool LLTextureFetchWorker::doWork(S32 param)
                 mRequestedOffset += src_offset;
             }
 
-            U8 * buffer = (U8 *)ll_aligned_malloc_16(total_size);
+            // <FS> Zero-copy body handoff
+            //U8 * buffer = (U8 *)ll_aligned_malloc_16(total_size);
+            U8 * buffer(NULL);
+            if (cur_size == 0)
+            {
+                // The whole image is in the response, take its buffer over
+                // rather than copying it
+                size_t detached_size(0);
+                buffer = (U8 *)mHttpBufferArray->detachAlignedData(&detached_size);
+                llassert_always(!buffer || (S32)detached_size == total_size);
+            }
+            else
+            {
+                buffer = (U8 *)ll_aligned_malloc_16(total_size);
+            }
+            // </FS>
             if (!buffer)
             {
                 // abort. If we have no space for packet, we have not enough space to decode image
@@ -1885,7 +2064,13 @@ bool LLTextureFetchWorker::doWork(S32 param)
                 // Copy previously collected data into buffer
                 memcpy(buffer, mFormattedImage->getData(), cur_size);
             }
-            mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
+            // <FS> Zero-copy body handoff, a detached buffer already holds the body
+            //mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
+            if (cur_size > 0)
+            {
+                mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
+            }
+            // </FS>
 
             // NOTE: setData releases current data and owns new data (buffer)
             mFormattedImage->setData(buffer, total_size);
@@ -1897,6 +2082,20 @@ bool LLTextureFetchWorker::doWork(S32 param)
             mHttpReplyOffset = 0;
 
             mLoadedDiscard = mRequestedDiscard;
+            if (mProgressiveFetch)
+            {
+                // Only decode as far as the partial data allows
+                if (!mHaveAllData && mFormattedImage->getCodec() == IMG_CODEC_J2C && mFormattedImage->updateData())
+                {
+                    mLoadedDiscard = llmax(mLoadedDiscard, ((LLImageJ2C*)mFormattedImage.get())->calcDiscardLevelBytes(total_size));
+                }
+                if (mHaveAllData || mLoadedDiscard <= mDesiredDiscard || mFormattedImage->getCodec() != IMG_CODEC_J2C)
+                {
+                    // Nothing left to fetch, or no header to tell us what we can decode
+                    mProgressiveFetch = false;
+                    mLoadedDiscard = mRequestedDiscard;
+                }
+            }
             if (mLoadedDiscard < 0)
             {
                 LL_WARNS(LOG_TXT) << mID << " mLoadedDiscard is " << mLoadedDiscard
@@ -1965,6 +2164,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
         mDecodeTimer.reset();
         mRawImage = NULL;
         mAuxImage = NULL;
+        mHaveInterimRaw = false;
         llassert_always(mFormattedImage.notNull());
 
         // if we have the entire image data (and the image is not J2C), decode the full res image
@@ -1978,10 +2178,23 @@ bool LLTextureFetchWorker::doWork(S32 param)
         // In case worked manages to request decode, be shut down,
         // then init and request decode again with first decode
         // still in progress, assign a sufficiently unique id
+        LLPointer<DecodeResponder> responder = new DecodeResponder(mFetcher, mID, this);
+        static LLCachedControl<bool> decoded_cache(gSavedSettings, "FSTextureDecodedCache", false);
+        mUseDecodedCache = decoded_cache && mFTType == FTT_DEFAULT && !mNeedsAux && mFormattedImage->getCodec() == IMG_CODEC_J2C;
+        LLImageDecodeThread::lookup_t lookup;
+        if (mUseDecodedCache)
+        {
+            lookup = [responder](const LLImageFormatted* image) mutable { return responder->lookup(image); };
+        }
         mDecodeHandle = LLAppViewer::getImageDecodeThread()->decodeImage(mFormattedImage,
                                                                        discard,
                                                                        mNeedsAux,
-                                                                       new DecodeResponder(mFetcher, mID, this));
+                                                                       responder,
+                                                                       // <FS> Decode priority
+                                                                       //lookup);
+                                                                       lookup,
+                                                                       mImagePriority);
+                                                                       // </FS>
         if (mDecodeHandle == 0)
         {
             // Abort, failed to put into queue.
@@ -2102,6 +2315,21 @@ bool LLTextureFetchWorker::doWork(S32 param)
     if (mState == DONE)
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("tfwdw - DONE"); //<FS:Beq/> fix incorrect category
+        if (mProgressiveFetch)
+        {
+            mProgressiveFetch = false;
+            if (mDecodedDiscard >= 0 && mDesiredDiscard < mDecodedDiscard && !mHaveAllData && mCanUseHTTP)
+            {
+                // Coarse level is decoded and cached, fetch the rest of the data.
+                // Unlike a restart from INIT this keeps the raw image available to
+                // getRequestFinished() in the meantime.
+                mHaveInterimRaw = true;
+                setState(LOAD_FROM_NETWORK);
+                LL_DEBUGS(LOG_TXT) << mID << " progressive fetch, requesting the rest: "
+                                   << " mDecodedDiscard " << mDecodedDiscard << " mDesiredDiscard " << mDesiredDiscard << LL_ENDL;
+                return doWork(param);
+            }
+        }
         if (mDecodedDiscard >= 0 && mDesiredDiscard < mDecodedDiscard)
         {
             // More data was requested, return to INIT
@@ -2239,7 +2467,14 @@ void LLTextureFetchWorker::endWork(S32 param, bool aborted)
     LL_PROFILE_ZONE_SCOPED;
     if (mDecodeHandle != 0)
     {
+        // <FS> Decode priority
         // LL::ThreadPool has no operation to cancel a particular work item
+        // Drop it if it didn't start yet, its callback would be ignored anyway
+        if (LLImageDecodeThread* decoder = LLAppViewer::getImageDecodeThread())
+        {
+            decoder->cancel(mDecodeHandle);
+        }
+        // </FS>
         mDecodeHandle = 0;
     }
     mFormattedImage = NULL;
@@ -2560,7 +2795,8 @@ void LLTextureFetchWorker::callbackCacheWrite(bool success)
 //////////////////////////////////////////////////////////////////////////////
 
 // Threads:  Tid
-void LLTextureFetchWorker::callbackDecoded(bool success, const std::string &error_message, LLImageRaw* raw, LLImageRaw* aux, S32 decode_id)
+void LLTextureFetchWorker::callbackDecoded(bool success, const std::string &error_message, LLImageRaw* raw, LLImageRaw* aux, S32 decode_id,
+                                           bool from_decoded_cache)
 {
     LLMutexLock lock(&mWorkMutex);                                      // +Mw
     if (mDecodeHandle == 0)
@@ -2594,6 +2830,10 @@ void LLTextureFetchWorker::callbackDecoded(bool success, const std::string &erro
         {
             LL_WARNS_ONCE(LOG_TXT) << "Decoded higher resolution than requested" << LL_ENDL;
         }
+        if (!from_decoded_cache && mUseDecodedCache)
+        {
+            write_decoded_cache(mID, raw, mFormattedImage->getWidth(), mFormattedImage->getHeight(), mDecodedDiscard);
+        }
         LL_DEBUGS(LOG_TXT) << mID << ": Decode Finished. Discard: " << mDecodedDiscard
                            << " Raw Image: " << llformat("%dx%d",mRawImage->getWidth(),mRawImage->getHeight()) << LL_ENDL;
     }
@@ -2762,6 +3002,13 @@ S32 LLTextureFetch::createRequest(FTType f_type, const std::string& url, const L
         return CREATE_REQUEST_ERROR_DEFAULT;
     }
 
+    // <FS> Texture fetch trace
+    if (FSTextureFetchTrace::isRecording())
+    {
+        FSTextureFetchTrace::recordCreate(f_type, url, id, priority, w, h, c, desired_discard, needs_aux, can_use_http);
+    }
+    // </FS>
+
     if (f_type == FTT_SERVER_BAKE)
     {
         LL_DEBUGS("Avatar") << " requesting " << id << " " << w << "x" << h << " discard " << desired_discard << " type " << f_type << LL_ENDL;
@@ -3112,6 +3359,13 @@ bool LLTextureFetch::getRequestFinished(const LLUUID& id, S32& discard_level, S3
             LL_DEBUGS(LOG_TXT) << id << ": Request Finished. State: " << worker->mState << " Discard: " << discard_level << LL_ENDL;
             worker->unlockWorkMutex();                                  // -Mw
 
+            // <FS> Texture fetch trace
+            if (FSTextureFetchTrace::isRecording())
+            {
+                FSTextureFetchTrace::recordFinished(id, discard_level, worker_state, fetch_time);
+            }
+            // </FS>
+
             sample(sTexDecodeLatency, decode_time);
             sample(sTexFetchLatency, fetch_time);
             sample(sCacheReadLatency, cache_read_time);
@@ -3134,7 +3388,7 @@ bool LLTextureFetch::getRequestFinished(const LLUUID& id, S32& discard_level, S3
             worker->lockWorkMutex();                                    // +Mw
             if ((worker->mDecodedDiscard >= 0) &&
                 (worker->mDecodedDiscard < discard_level || discard_level < 0) &&
-                (worker->mState >= LLTextureFetchWorker::WAIT_ON_WRITE))
+                (worker->mState >= LLTextureFetchWorker::WAIT_ON_WRITE || worker->mHaveInterimRaw))
             {
                 // Not finished, but data is ready
                 discard_level = worker->mDecodedDiscard;
@@ -3156,6 +3410,12 @@ bool LLTextureFetch::getRequestFinished(const LLUUID& id, S32& discard_level, S3
 bool LLTextureFetch::updateRequestPriority(const LLUUID& id, F32 priority)
 {
     LL_PROFILE_ZONE_SCOPED;
+    // <FS> Texture fetch trace
+    if (FSTextureFetchTrace::isRecording())
+    {
+        FSTextureFetchTrace::recordPriority(id, priority);
+    }
+    // </FS>
     mRequestQueue.tryPost([=]()
         {
             LLTextureFetchWorker* worker = getWorker(id);
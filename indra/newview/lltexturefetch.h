@@ -204,6 +204,14 @@ public:
 
     bool isQAMode() const               { return mQAMode; }
 
+    // <FS> Texture fetch replay: when set (QA mode only), textures fetched
+    // by id use this base url instead of the region's asset capability.
+    // Threads:  Tmain for the setter, T* for the getter
+    // Locks:  Mfnq
+    void setReplayAssetUrl(const std::string& url) { LLMutexLock lock(&mNetworkQueueMutex); mReplayAssetUrl = url; }
+    std::string getReplayAssetUrl() { LLMutexLock lock(&mNetworkQueueMutex); return mReplayAssetUrl; }
+    // </FS>
+
     // ----------------------------------
     // HTTP resource waiting methods
 
@@ -381,6 +389,8 @@ private:
     // If true, modifies some behaviors that help with QA tasks.
     const bool mQAMode;
 
+    std::string mReplayAssetUrl;                                        // <FS/> Mfnq
+
     // Interfaces and objects into the core http library used
     // to make our HTTP requests.  These replace the various
     // LLCurl interfaces used in the past.
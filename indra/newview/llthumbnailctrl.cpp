@@ -191,6 +191,16 @@ void LLThumbnailCtrl::clearTexture()
     mInited = true; // nothing to do
 }
 
+// <FS> Release off-screen gallery thumbnails
+void LLThumbnailCtrl::releaseTexture()
+{
+    if (mInited && (mTexturep.notNull() || mImagep.notNull()))
+    {
+        unloadImage();
+    }
+}
+// </FS>
+
 // virtual
 // value might be a string or a UUID
 void LLThumbnailCtrl::setValue(const LLSD& value)
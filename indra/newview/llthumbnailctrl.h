@@ -69,6 +69,10 @@ public:
     virtual void setValue(const LLSD& value ) override;
     void setInitImmediately(bool val) { mInitImmediately = val; }
     void clearTexture();
+    // <FS> Release off-screen gallery thumbnails
+    // Drops the texture but keeps the value, the next draw loads it again
+    void releaseTexture();
+    // </FS>
 
     virtual bool handleHover(S32 x, S32 y, MASK mask) override;
 
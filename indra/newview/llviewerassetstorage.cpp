@@ -599,25 +599,60 @@ void LLViewerAssetStorage::assetRequestCoro(
             // case.
             LLUUID temp_id;
             temp_id.generate();
-            LLFileSystem vf(temp_id, atype, LLFileSystem::WRITE);
+            // <FS> Asynchronous cache writes, write the asset from the
+            // general queue and finish the request once it is on disk
+            //LLFileSystem vf(temp_id, atype, LLFileSystem::WRITE);
+            //req->mBytesFetched = size;
+            //if (!vf.write(raw.data(),size))
+            //{
+            //    // TODO asset-http: handle error
+            //    LL_WARNS("ViewerAsset") << "Failure in vf.write()" << LL_ENDL;
+            //    result_code = LL_ERR_ASSET_REQUEST_FAILED;
+            //    ext_status = LLExtStat::CACHE_CORRUPT;
+            //}
+            //else if (!vf.rename(uuid, atype))
+            //{
+            //    LL_WARNS("ViewerAsset") << "rename failed" << LL_ENDL;
+            //    result_code = LL_ERR_ASSET_REQUEST_FAILED;
+            //    ext_status = LLExtStat::CACHE_CORRUPT;
+            //}
+            //else
+            //{
+            //    mCountSucceeded++;
+            //}
             req->mBytesFetched = size;
-            if (!vf.write(raw.data(),size))
-            {
-                // TODO asset-http: handle error
-                LL_WARNS("ViewerAsset") << "Failure in vf.write()" << LL_ENDL;
-                result_code = LL_ERR_ASSET_REQUEST_FAILED;
-                ext_status = LLExtStat::CACHE_CORRUPT;
-            }
-            else if (!vf.rename(uuid, atype))
-            {
-                LL_WARNS("ViewerAsset") << "rename failed" << LL_ENDL;
-                result_code = LL_ERR_ASSET_REQUEST_FAILED;
-                ext_status = LLExtStat::CACHE_CORRUPT;
-            }
-            else
-            {
-                mCountSucceeded++;
-            }
+            LLFileSystem::writeAsync(temp_id, atype, raw, LLFileSystem::WRITE,
+                [this, temp_id, uuid, atype](bool success)
+                {
+                    if (LLApp::isExiting() || !gAssetStorage)
+                    {
+                        return;
+                    }
+
+                    S32 result_code = LL_ERR_NOERR;
+                    LLExtStat ext_status = LLExtStat::NONE;
+                    if (!success)
+                    {
+                        LL_WARNS("ViewerAsset") << "Failure in vf.write()" << LL_ENDL;
+                        result_code = LL_ERR_ASSET_REQUEST_FAILED;
+                        ext_status = LLExtStat::CACHE_CORRUPT;
+                    }
+                    else if (!LLFileSystem::renameFile(temp_id, atype, uuid, atype))
+                    {
+                        LL_WARNS("ViewerAsset") << "rename failed" << LL_ENDL;
+                        result_code = LL_ERR_ASSET_REQUEST_FAILED;
+                        ext_status = LLExtStat::CACHE_CORRUPT;
+                    }
+                    else
+                    {
+                        mCountSucceeded++;
+                    }
+
+                    // Clean up pending downloads and trigger callbacks
+                    removeAndCallbackPendingDownloads(uuid, atype, uuid, atype, result_code, ext_status);
+                });
+            return;
+            // </FS>
         }
         else
         {
@@ -482,6 +482,11 @@ void audio_update_volume(bool force_update)
 
         gAudiop->setMasterGain ( master_volume );
 
+        // <FS> Decoded sound cache
+        static LLCachedControl<U32> decoded_cache_mb(gSavedSettings, "FSDecodedSoundCacheMB");
+        gAudiop->setDecodedCacheLimit((size_t)decoded_cache_mb() * 1024 * 1024);
+        // </FS>
+
         const F32 AUDIO_LEVEL_DOPPLER = 1.f;
         gAudiop->setDopplerFactor(AUDIO_LEVEL_DOPPLER);
 
@@ -113,6 +113,8 @@
 #include "llpanelplaces.h"
 #include "llstatusbar.h"
 #include "llviewerinput.h"
+#include "llurlregistry.h" // <FS/> Combined URL matching
+#include "fsperfstatstrace.h" // <FS/> Performance trace
 #include "llviewerobjectlist.h"
 #include "llviewerregion.h"
 #include "NACLantispam.h"
@@ -555,6 +557,17 @@ static bool handleRenderDynamicLODChanged(const LLSD& newvalue)
     return true;
 }
 
+// <FS> Mesh instancing, the instance lists are made when the octree nodes are rebuilt
+static bool handleMeshInstancingChanged(const LLSD& newvalue)
+{
+    if (gPipeline.isInit())
+    {
+        gPipeline.rebuildDrawInfo();
+    }
+    return true;
+}
+// </FS>
+
 // static bool handleReflectionsEnabled(const LLSD& newvalue)
 // {
 //  // <FS:Beq> FIRE-33659 - everything is too dark when reflections are disabled.
@@ -1102,8 +1115,48 @@ void handleDiskCacheLowWaterPctChanged(const LLSD& newValue)
     const auto new_low = (F32)newValue.asReal();
     LLDiskCache::getInstance()->setLowWaterPercentage(new_low);
 }
+
+void handleDiskCachePackThresholdChanged(const LLSD& newValue)
+{
+    LLDiskCache::getInstance()->setPackThreshold((U32)newValue.asInteger());
+}
+
+void handleDiskCacheCompressAssetsChanged(const LLSD& newValue)
+{
+    LLDiskCache::getInstance()->setCompressAssets(newValue.asBoolean());
+}
 // </FS:Beq>
 
+// <FS> Combined URL matching
+static void handleCombinedUrlMatchingChanged(const LLSD& newValue)
+{
+    LLUrlRegistry::instance().setCombinedMatching(newValue.asBoolean());
+}
+// </FS>
+
+// <FS> Performance trace
+static void handlePerfStatsTraceChanged(const LLSD& newValue)
+{
+    if (!newValue.asBoolean())
+    {
+        if (FSPerfStatsTrace::instanceExists())
+        {
+            FSPerfStatsTrace::instance().stop();
+        }
+        return;
+    }
+
+    const bool binary = (gSavedSettings.getString("FSPerfStatsTraceFormat") == "binary");
+    const std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS,
+        "perfstats_" + LLDate::now().toHTTPDateString("%Y%m%d_%H%M%S") + (binary ? ".bin" : ".csv"));
+    if (!FSPerfStatsTrace::instance().start(filename, binary ? FSPerfStatsTrace::EFormat::Binary : FSPerfStatsTrace::EFormat::CSV,
+                                            (F64)LLTrace::BlockTimer::countsPerSecond()))
+    {
+        gSavedSettings.setBOOL("FSPerfStatsTrace", false);
+    }
+}
+// </FS>
+
 void handleTargetFPSChanged(const LLSD& newValue)
 {
     const auto targetFPS = gSavedSettings.getU32("TargetFPS");
@@ -1306,6 +1359,7 @@ void settings_setup_listeners()
     setting_setup_signal_listener(gSavedSettings, "RenderFogRatio", handleFogRatioChanged);
     setting_setup_signal_listener(gSavedSettings, "RenderMaxPartCount", handleMaxPartCountChanged);
     setting_setup_signal_listener(gSavedSettings, "RenderDynamicLOD", handleRenderDynamicLODChanged);
+    setting_setup_signal_listener(gSavedSettings, "FSMeshInstancing", handleMeshInstancingChanged); // <FS/> Mesh instancing
     setting_setup_signal_listener(gSavedSettings, "RenderVSyncEnable", handleVSyncChanged);
     setting_setup_signal_listener(gSavedSettings, "RenderDeferredNoise", handleReleaseGLBufferChanged);
     setting_setup_signal_listener(gSavedSettings, "RenderDebugPipeline", handleRenderDebugPipelineChanged);
@@ -1543,8 +1597,14 @@ void settings_setup_listeners()
     // <FS:Beq> Better asset cache purge control
     setting_setup_signal_listener(gSavedSettings, "FSDiskCacheHighWaterPercent", handleDiskCacheHighWaterPctChanged);
     setting_setup_signal_listener(gSavedSettings, "FSDiskCacheLowWaterPercent", handleDiskCacheLowWaterPctChanged);
+    setting_setup_signal_listener(gSavedSettings, "FSDiskCachePackThreshold", handleDiskCachePackThresholdChanged);
+    setting_setup_signal_listener(gSavedSettings, "FSDiskCacheCompressAssets", handleDiskCacheCompressAssetsChanged);
     // </FS:Beq>
 
+    // <FS/> Combined URL matching
+    setting_setup_signal_listener(gSavedSettings, "FSCombinedUrlMatching", handleCombinedUrlMatchingChanged);
+    setting_setup_signal_listener(gSavedSettings, "FSPerfStatsTrace", handlePerfStatsTraceChanged); // <FS/> Performance trace
+
     // <FS:Zi> Handle IME text input getting enabled or disabled
 #if LL_SDL2
     setting_setup_signal_listener(gSavedSettings, "SDL2IMEEnabled", handleSDL2IMEEnabledChanged);
@@ -50,6 +50,7 @@
 #include "llglheaders.h"
 #include "llgltfmateriallist.h"
 #include "llhudmanager.h"
+#include "lllocalcliprect.h" // <FS/> UI buffer
 #include "llimagepng.h"
 #include "llmachineid.h"
 #include "llmemory.h"
@@ -95,6 +96,10 @@
 // [/RLVa:KB]
 #include "llpresetsmanager.h"
 #include "fsdata.h"
+#include "llterrainpaintmap.h" // <FS/> Asynchronous paint map bake
+#include "lltexlayer.h" // <FS/> Async morph mask readback
+#include "fssettingkeys.h" // <FS/> Keyed settings access
+#include "fsframepacer.h" // <FS/> Frame pacing
 
 #include <filesystem>
 #include <iomanip>
@@ -224,7 +229,10 @@ void display_update_camera()
     F32 final_far = gAgentCamera.mDrawDistance;
     if (gCubeSnapshot)
     {
-        final_far = gSavedSettings.getF32("RenderReflectionProbeDrawDistance");
+        // <FS> Keyed settings access
+        //final_far = gSavedSettings.getF32("RenderReflectionProbeDrawDistance");
+        final_far = gSavedSettings.get(FSSetting::RenderReflectionProbeDrawDistance);
+        // </FS>
     }
     else if (CAMERA_MODE_CUSTOMIZE_AVATAR == gAgentCamera.getCameraMode())
 
@@ -709,14 +717,14 @@ void display(bool rebuild, F32 zoom_factor, int subfield, bool for_snapshot)
             LLPresetsManager::instance().setIsDrawDistanceSteppingActive(false);
             gSavedDrawDistance = 0.0f;
             gLastDrawDistanceStep = 0.0f;
-            gSavedSettings.setF32("FSSavedRenderFarClip", 0.0f);
+            gSavedSettings.set(FSSetting::FSSavedRenderFarClip, 0.0f);
         }
 
         if (gTeleportArrivalTimer.getElapsedTimeF32() >=
-            (F32)gSavedSettings.getU32("FSRenderFarClipSteppingInterval"))
+            (F32)gSavedSettings.get(FSSetting::FSRenderFarClipSteppingInterval))
         {
             gTeleportArrivalTimer.reset();
-            F32 current = gSavedSettings.getF32("RenderFarClip");
+            F32 current = gSavedSettings.get(FSSetting::RenderFarClip);
             if (gSavedDrawDistance > current)
             {
                 current *= 2.0f;
@@ -724,7 +732,7 @@ void display(bool rebuild, F32 zoom_factor, int subfield, bool for_snapshot)
                 {
                     current = gSavedDrawDistance;
                 }
-                gSavedSettings.setF32("RenderFarClip", current);
+                gSavedSettings.set(FSSetting::RenderFarClip, current);
                 gLastDrawDistanceStep = current;
             }
             if (current >= gSavedDrawDistance)
@@ -732,7 +740,7 @@ void display(bool rebuild, F32 zoom_factor, int subfield, bool for_snapshot)
                 LLPresetsManager::instance().setIsDrawDistanceSteppingActive(false);
                 gSavedDrawDistance = 0.0f;
                 gLastDrawDistanceStep = 0.0f;
-                gSavedSettings.setF32("FSSavedRenderFarClip", 0.0f);
+                gSavedSettings.set(FSSetting::FSSavedRenderFarClip, 0.0f);
             }
         }
     }
@@ -805,9 +813,13 @@ void display(bool rebuild, F32 zoom_factor, int subfield, bool for_snapshot)
         }
     }
 
+    LLTerrainPaintMap::updateBakes(); // <FS/> Asynchronous paint map bake
+    LLTexLayer::updateMorphReadbacks(); // <FS/> Async morph mask readback
+
     gViewerWindow->setup3DViewport();
 
     gPipeline.resetFrameStats();    // Reset per-frame statistics.
+    gPipeline.mGPUPassTimer.newFrame(); // <FS/> GPU pass timers
 
     if (!gDisconnected && !LLApp::isExiting())
     {
@@ -898,6 +910,18 @@ void display(bool rebuild, F32 zoom_factor, int subfield, bool for_snapshot)
                 gResizeScreenTexture = false;
             }
 
+            // <FS> Dynamic resolution, resizeScreenTexture() also puts the
+            // targets back to the scale after a snapshot resized them
+            if (!for_snapshot)
+            {
+                bool scale_changed = gPipeline.mDynamicResolution.update(gPipeline.mGPUPassTimer);
+                if (scale_changed || gPipeline.mDynamicResolution.isEnabled())
+                {
+                    gPipeline.resizeScreenTexture();
+                }
+            }
+            // </FS>
+
             gGL.setColorMask(true, true);
             glClearColor(0,0,0,0);
 
@@ -1392,7 +1416,34 @@ void render_hud_attachments()
     // smoothly interpolate current zoom level
     gAgentCamera.mHUDCurZoom = lerp(gAgentCamera.mHUDCurZoom, gAgentCamera.getAgentHUDTargetZoom(), LLSmoothInterpolation::getInterpolant(0.03f));
 
-    if (LLPipeline::sShowHUDAttachments && !gDisconnected && setup_hud_matrices())
+    // <FS> HUD cache, nothing on the HUD changed since it was drawn into the cache
+    //if (LLPipeline::sShowHUDAttachments && !gDisconnected && setup_hud_matrices())
+    if (LLPipeline::sShowHUDAttachments && !gDisconnected && gPipeline.mHUDCache.isCurrent() && setup_hud_matrices())
+    {
+        LLPipeline::sRenderingHUDs = true;
+        gPipeline.mHUDCache.composite();
+
+        // HUD text isn't cached, draw it as below
+        gPipeline.pushRenderTypeMask();
+        gPipeline.andRenderTypeMask(LLPipeline::END_RENDER_TYPES);
+        gPipeline.toggleRenderType(LLPipeline::RENDER_TYPE_HUD);
+        bool has_ui = gPipeline.hasRenderDebugFeatureMask(LLPipeline::RENDER_DEBUG_FEATURE_UI);
+        if (has_ui)
+        {
+            gPipeline.toggleRenderDebugFeature(LLPipeline::RENDER_DEBUG_FEATURE_UI);
+        }
+
+        render_hud_elements();
+
+        gPipeline.popRenderTypeMask();
+        if (has_ui)
+        {
+            gPipeline.toggleRenderDebugFeature(LLPipeline::RENDER_DEBUG_FEATURE_UI);
+        }
+        LLPipeline::sRenderingHUDs = false;
+    }
+    else if (LLPipeline::sShowHUDAttachments && !gDisconnected && setup_hud_matrices())
+    // </FS>
     {
         LLPipeline::sRenderingHUDs = true;
         LLCamera hud_cam = *LLViewerCamera::getInstance();
@@ -1467,7 +1518,13 @@ void render_hud_attachments()
 
         gPipeline.stateSort(hud_cam, result);
 
-        gPipeline.renderGeomPostDeferred(hud_cam);
+        // <FS> HUD cache
+        //gPipeline.renderGeomPostDeferred(hud_cam);
+        if (!gPipeline.mHUDCache.update([&hud_cam]() { gPipeline.renderGeomPostDeferred(hud_cam); }))
+        {
+            gPipeline.renderGeomPostDeferred(hud_cam);
+        }
+        // </FS>
 
         LLSpatialGroup::sNoDelete = false;
         //gPipeline.clearReferences();
@@ -1689,7 +1746,9 @@ void swap()
     LL_PROFILE_GPU_ZONE("swap");
     if (gDisplaySwapBuffers)
     {
+        FSFramePacer::instance().markSwapBegin(); // <FS/> Frame pacing
         gViewerWindow->getWindow()->swapBuffers();
+        FSFramePacer::instance().markPresent(); // <FS/> Frame pacing
     }
     gDisplaySwapBuffers = true;
 }
@@ -1815,6 +1874,59 @@ void render_ui_3d()
     stop_glerror();
 }
 
+// <FS> UI buffer
+// Reports what has to be redrawn into the UI buffer besides the views that
+// dirtied themselves: the floaters under the mouse and with keyboard focus,
+// which hover and cursor blinking change every frame, and the whole UI while
+// dragging, in mouselook and once per refresh interval, which catches the
+// animations no view reports. The whole UI is also redrawn when the buffer
+// wasn't used last frame or was reallocated since.
+static void dirty_ui_buffer()
+{
+    static LLCachedControl<F32> refresh_interval(gSavedSettings, "FSUIBufferRefreshInterval", 0.1f);
+    static LLFrameTimer refresh_timer;
+    static LLHandle<LLView> last_hover_view;
+    static LLHandle<LLView> last_focus_view;
+    static U32 last_frame = 0;
+    static U32 last_texture = 0;
+
+    const U32 frame = LLFrameTimer::getFrameCount();
+    const U32 texture = gPipeline.mUIScreen.getTexture();
+    const bool buffer_kept = (frame == last_frame + 1) && (texture == last_texture);
+    last_frame = frame;
+    last_texture = texture;
+
+    if (!buffer_kept
+        || refresh_timer.getElapsedTimeF32() >= refresh_interval
+        || gAgentCamera.cameraMouselook()
+        || gFocusMgr.getMouseCapture()
+        || gViewerWindow->getLeftMouseDown())
+    {
+        LLView::sDirtyRect = gViewerWindow->getWindowRectScaled();
+        LLView::sIsRectDirty = true;
+        refresh_timer.reset();
+        return;
+    }
+
+    const LLCoordGL mouse = gViewerWindow->getCurrentMouse();
+    LLView* views[] = {
+        last_hover_view.get(),
+        gViewerWindow->getRootView()->childFromPoint(mouse.mX, mouse.mY, true),
+        last_focus_view.get(),
+        dynamic_cast<LLView*>(gFocusMgr.getKeyboardFocus()) };
+    for (LLView* view : views)
+    {
+        if (view)
+        {
+            // Not the virtual one, LLButton drops its text buffer with it
+            view->LLView::dirtyRect();
+        }
+    }
+    last_hover_view = views[1] ? views[1]->getHandle() : LLHandle<LLView>();
+    last_focus_view = views[3] ? views[3]->getHandle() : LLHandle<LLView>();
+}
+// </FS>
+
 void render_ui_2d()
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_UI;
@@ -1871,8 +1983,13 @@ void render_ui_2d()
     }
 
 
-    if (LLPipeline::RenderUIBuffer)
+    // <FS> UI buffer
+    //if (LLPipeline::RenderUIBuffer)
+    LLView::sDirtyRectTracking = LLPipeline::RenderUIBuffer && gPipeline.mUIScreen.isComplete() && zoom_factor <= 1.f;
+    if (LLView::sDirtyRectTracking)
+    // </FS>
     {
+        dirty_ui_buffer(); // <FS/> UI buffer
         if (LLView::sIsRectDirty)
         {
             LLView::sIsRectDirty = false;
@@ -1888,7 +2005,9 @@ void render_ui_2d()
                 LLView::sDirtyRect.mBottom -= pad;
                 LLView::sDirtyRect.mTop += pad;
 
-                LLGLEnable scissor(GL_SCISSOR_TEST);
+                // <FS> UI buffer
+                //LLGLEnable scissor(GL_SCISSOR_TEST);
+                // </FS>
                 static LLRect last_rect = LLView::sDirtyRect;
 
                 //union with last rect to avoid mouse poop
@@ -1898,21 +2017,30 @@ void render_ui_2d()
                 LLView::sDirtyRect = last_rect;
                 last_rect = t_rect;
 
-                // <FS:Ansariel> Factor out instance() call
-                //last_rect.mLeft = LLRect::tCoordType(last_rect.mLeft / LLUI::getScaleFactor().mV[0]);
-                //last_rect.mRight = LLRect::tCoordType(last_rect.mRight / LLUI::getScaleFactor().mV[0]);
-                //last_rect.mTop = LLRect::tCoordType(last_rect.mTop / LLUI::getScaleFactor().mV[1]);
-                //last_rect.mBottom = LLRect::tCoordType(last_rect.mBottom / LLUI::getScaleFactor().mV[1]);
-                last_rect.mLeft = LLRect::tCoordType(last_rect.mLeft / ui_scale_factor.mV[0]);
-                last_rect.mRight = LLRect::tCoordType(last_rect.mRight / ui_scale_factor.mV[0]);
-                last_rect.mTop = LLRect::tCoordType(last_rect.mTop / ui_scale_factor.mV[1]);
-                last_rect.mBottom = LLRect::tCoordType(last_rect.mBottom / ui_scale_factor.mV[1]);
-
-                LLRect clip_rect(last_rect);
+                // <FS> UI buffer
+                // Both rects are in UI coordinates already, clip rects scale them
+                //// <FS:Ansariel> Factor out instance() call
+                ////last_rect.mLeft = LLRect::tCoordType(last_rect.mLeft / LLUI::getScaleFactor().mV[0]);
+                ////last_rect.mRight = LLRect::tCoordType(last_rect.mRight / LLUI::getScaleFactor().mV[0]);
+                ////last_rect.mTop = LLRect::tCoordType(last_rect.mTop / LLUI::getScaleFactor().mV[1]);
+                ////last_rect.mBottom = LLRect::tCoordType(last_rect.mBottom / LLUI::getScaleFactor().mV[1]);
+                //last_rect.mLeft = LLRect::tCoordType(last_rect.mLeft / ui_scale_factor.mV[0]);
+                //last_rect.mRight = LLRect::tCoordType(last_rect.mRight / ui_scale_factor.mV[0]);
+                //last_rect.mTop = LLRect::tCoordType(last_rect.mTop / ui_scale_factor.mV[1]);
+                //last_rect.mBottom = LLRect::tCoordType(last_rect.mBottom / ui_scale_factor.mV[1]);
+
+                //LLRect clip_rect(last_rect);
+
+                // Everything below clips against it, views that reach out
+                // of the dirty region must not draw over what is kept
+                LLScreenClipRect clip_rect(LLView::sDirtyRect);
+                // </FS>
 
                 glClear(GL_COLOR_BUFFER_BIT);
 
+                gGL.setPremultipliedAlphaTarget(true); // <FS/> UI buffer
                 gViewerWindow->draw();
+                gGL.setPremultipliedAlphaTarget(false); // <FS/> UI buffer
             }
 
             gPipeline.mUIScreen.flush();
@@ -1922,17 +2050,35 @@ void render_ui_2d()
         }
 
         LLGLDisable cull(GL_CULL_FACE);
-        LLGLDisable blend(GL_BLEND);
+        // <FS> UI buffer
+        // The buffer is premultiplied, blend it over the world like the
+        // UI would have been drawn
+        //LLGLDisable blend(GL_BLEND);
+        LLGLEnable blend(GL_BLEND);
+        gGL.blendFunc(LLRender::BF_ONE, LLRender::BF_ONE_MINUS_SOURCE_ALPHA);
+        gUIProgram.bind();
+        // </FS>
         S32 width = gViewerWindow->getWindowWidthScaled();
         S32 height = gViewerWindow->getWindowHeightScaled();
         gGL.getTexUnit(0)->bind(&gPipeline.mUIScreen);
         gGL.begin(LLRender::TRIANGLE_STRIP);
         gGL.color4f(1.f,1.f,1.f,1.f);
+        // <FS> UI buffer
+        //gGL.texCoord2f(0.f, 0.f);                 gGL.vertex2i(0, 0);
+        //gGL.texCoord2f((F32)width, 0.f);          gGL.vertex2i(width, 0);
+        //gGL.texCoord2f(0.f, (F32)height);         gGL.vertex2i(0, height);
+        //gGL.texCoord2f((F32)width, (F32)height);  gGL.vertex2i(width, height);
         gGL.texCoord2f(0.f, 0.f);                 gGL.vertex2i(0, 0);
-        gGL.texCoord2f((F32)width, 0.f);          gGL.vertex2i(width, 0);
-        gGL.texCoord2f(0.f, (F32)height);         gGL.vertex2i(0, height);
-        gGL.texCoord2f((F32)width, (F32)height);  gGL.vertex2i(width, height);
+        gGL.texCoord2f(1.f, 0.f);                 gGL.vertex2i(width, 0);
+        gGL.texCoord2f(0.f, 1.f);                 gGL.vertex2i(0, height);
+        gGL.texCoord2f(1.f, 1.f);                 gGL.vertex2i(width, height);
+        // </FS>
         gGL.end();
+        // <FS> UI buffer
+        gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+        gUIProgram.unbind();
+        gGL.setSceneBlendType(LLRender::BT_ALPHA);
+        // </FS>
     }
     else
     {
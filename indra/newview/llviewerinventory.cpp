@@ -548,6 +548,13 @@ bool LLViewerInventoryItem::unpackMessage(const LLSD& item)
     return rv;
 }
 
+// <FS> Background AIS parsing
+void LLViewerInventoryItem::localizeName()
+{
+    LLLocalizedInventoryItemsDictionary::getInstance()->localizeInventoryObjectName(mName);
+}
+// </FS>
+
 // virtual
 bool LLViewerInventoryItem::unpackMessage(LLMessageSystem* msg, const char* block, S32 block_num)
 {
@@ -2162,6 +2169,76 @@ void remove_inventory_items(const LLInventoryModel::item_array_t& items, LLPoint
 }
 // [/RLVa:KB]
 
+// <FS> Diff-based folder slams
+// Links of contents that folder_id doesn't hold yet. False when the folder
+// holds something contents doesn't, or our copy of it isn't complete, so
+// that only a slam brings it in line.
+static bool diff_folder_links(const LLUUID& folder_id, const LLSD& contents, LLSD& links_to_add)
+{
+    static LLCachedControl<bool> diff_slams(gSavedSettings, "FSDiffFolderSlams", true);
+    if (!diff_slams)
+    {
+        return false;
+    }
+
+    const LLViewerInventoryCategory* cat = gInventory.getCategory(folder_id);
+    LLInventoryModel::cat_array_t* cats = nullptr;
+    LLInventoryModel::item_array_t* items = nullptr;
+    gInventory.getDirectDescendentsOf(folder_id, cats, items);
+    if (!cat || cat->getVersion() == LLViewerInventoryCategory::VERSION_UNKNOWN || !cats || !items || !cats->empty()
+        || cat->getDescendentCount() != (S32)items->size())
+    {
+        return false;
+    }
+
+    typedef std::tuple<LLUUID, S32, std::string> link_key_t;
+    std::map<link_key_t, S32> current;
+    for (const LLPointer<LLViewerInventoryItem>& item : *items)
+    {
+        if (!item->getIsLinkType())
+        {
+            return false;
+        }
+        ++current[link_key_t(item->getLinkedUUID(), (S32)item->getActualType(), item->getActualDescription())];
+    }
+
+    links_to_add = LLSD::emptyArray();
+    for (const LLSD& entry : llsd::inArray(contents))
+    {
+        const S32 type = entry["type"].asInteger();
+        if (type != LLAssetType::AT_LINK && type != LLAssetType::AT_LINK_FOLDER)
+        {
+            return false;
+        }
+
+        auto it = current.find(link_key_t(entry["linked_id"].asUUID(), type, entry["desc"].asString()));
+        if (it != current.end() && it->second > 0)
+        {
+            --it->second;
+            continue;
+        }
+
+        LLSD link(entry);
+        if (!link.has("inv_type"))
+        {
+            const LLViewerInventoryItem* linked_item = gInventory.getItem(entry["linked_id"].asUUID());
+            link["inv_type"] = (S8)(type == LLAssetType::AT_LINK_FOLDER ? LLInventoryType::IT_CATEGORY
+                                    : linked_item ? linked_item->getInventoryType() : LLInventoryType::IT_NONE);
+        }
+        links_to_add.append(link);
+    }
+
+    for (const auto& link : current)
+    {
+        if (link.second > 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+// </FS>
+
 void slam_inventory_folder(const LLUUID& folder_id,
                            const LLSD& contents,
                            LLPointer<LLInventoryCallback> cb)
@@ -2170,6 +2247,25 @@ void slam_inventory_folder(const LLUUID& folder_id,
     if (AISAPI::isAvailable())
     {
     // </FS:Ansariel> [UDP-Msg]
+    // <FS> Diff-based folder slams
+    // A slam replaces every link, each one showing up as removed and added
+    // to the observers. When nothing has to go, create only what is missing,
+    // or nothing at all; cb still fires once it is released.
+    LLSD links_to_add;
+    if (diff_folder_links(folder_id, contents, links_to_add))
+    {
+        LL_DEBUGS(LOG_INV) << "folder " << folder_id << " already holds " << contents.size() - links_to_add.size()
+                           << " of " << contents.size() << " links, adding the rest" << LL_ENDL;
+        if (links_to_add.size() > 0)
+        {
+            LLSD new_inventory = LLSD::emptyMap();
+            new_inventory["links"] = links_to_add;
+            AISAPI::completion_t cr = boost::bind(&doInventoryCb, cb, _1);
+            AISAPI::CreateInventory(folder_id, new_inventory, cr);
+        }
+        return;
+    }
+    // </FS>
     LL_DEBUGS(LOG_INV) << "using AISv3 to slam folder, id " << folder_id
                        << " new contents: " << ll_pretty_print_sd(contents) << LL_ENDL;
 
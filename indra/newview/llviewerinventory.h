@@ -133,6 +133,11 @@ public:
     virtual bool unpackMessage(LLMessageSystem* msg, const char* block, S32 block_num = 0);
     virtual bool unpackMessage(const LLSD& item);
     virtual bool importLegacyStream(std::istream& input_stream);
+    // <FS> Background AIS parsing
+    // Main thread half of unpackMessage() for items unpacked elsewhere
+    // through LLInventoryItem::fromLLSD()
+    void localizeName();
+    // </FS>
 
     // new methods
     bool isFinished() const { return mIsComplete; }
@@ -245,6 +250,7 @@ public:
 
 private:
     friend class LLInventoryModel;
+    friend class AISUpdate; // <FS/> Background AIS parsing
     void localizeName(); // intended to be called from the LLInventoryModel
 
 protected:
@@ -84,6 +84,15 @@ extern bool gCubeSnapshot;
 // *TODO: Consider enabling mipmaps (they have been disabled for a long time). Likely has a significant performance impact for tiled/high texture repeat media. Mip generation in a shader may also be an option if necessary.
 constexpr bool USE_MIPMAPS = false;
 
+// <FS> Media frame throttling
+// Texture updates per second of in-world media, by what the pipeline and
+// the priority pass saw of it
+constexpr F32 SMALL_MEDIA_UPDATE_RATE = 10.f;
+constexpr F32 LOW_MEDIA_UPDATE_RATE = 15.f;
+constexpr F32 SLIDESHOW_MEDIA_UPDATE_RATE = 1.f;
+constexpr F32 HIDDEN_MEDIA_UPDATE_RATE = 0.5f;
+// </FS>
+
 void init_threaded_picker_load_dialog(LLPluginClassMedia* plugin, LLFilePicker::ELoadFilter filter, bool get_multiple)
 {
     (new LLMediaFilePicker(plugin, filter, get_multiple))->getFile(); // will delete itself
@@ -2921,11 +2930,24 @@ void LLViewerMediaImpl::update()
         return;
     }
 
+    // <FS> Media frame throttling
+    const F32 update_rate = getTextureUpdateRate();
+    mMediaSource->setFrameRateHint(update_rate);
+    // </FS>
+
     if(mSuspendUpdates || !mVisible)
     {
         return;
     }
 
+    // <FS> Media frame throttling
+    // Dirty rects keep accumulating in the plugin class until the next update
+    if (update_rate > 0.f && mTextureUpdateTimer.getElapsedTimeF32() < 1.f / update_rate)
+    {
+        return;
+    }
+    // </FS>
+
 
     LLViewerMediaTexture* media_tex;
     U8* data;
@@ -2938,6 +2960,8 @@ void LLViewerMediaImpl::update()
 
     if (preMediaTexUpdate(media_tex, data, data_width, data_height, x_pos, y_pos, width, height))
     {
+        mTextureUpdateTimer.reset(); // <FS/> Media frame throttling
+
         // Push update to worker thread
         auto main_queue = LLImageGLThread::sEnabledMedia ? mMainQueue.lock() : nullptr;
         if (main_queue)
@@ -3039,7 +3063,13 @@ void LLViewerMediaImpl::doMediaTexUpdate(LLViewerMediaTexture* media_tex, U8* da
     media_tex->createGLTexture(0, raw, 0, true, LLGLTexture::OTHER, true, &tex_name);
 
     // copy just the subimage covered by the image raw to GL
-    media_tex->setSubImage(data, data_width, data_height, x_pos, y_pos, width, height, tex_name);
+    // <FS> Media upload ring
+    //media_tex->setSubImage(data, data_width, data_height, x_pos, y_pos, width, height, tex_name);
+    if (!media_tex->getGLTexture()->setSubImageStreamed(data, data_width, data_height, x_pos, y_pos, width, height, tex_name))
+    {
+        media_tex->setSubImage(data, data_width, data_height, x_pos, y_pos, width, height, tex_name);
+    }
+    // </FS>
 
     if (sync)
     {
@@ -3622,6 +3652,40 @@ bool LLViewerMediaImpl::isUpdated()
 
 static LLTrace::BlockTimerStatHandle FTM_MEDIA_CALCULATE_INTEREST("Calculate Interest");
 
+// <FS> Media frame throttling
+// 0 is unlimited. Media the user works with, UI media and parcel media
+// always get every frame.
+F32 LLViewerMediaImpl::getTextureUpdateRate() const
+{
+    static LLCachedControl<bool> throttle(gSavedSettings, "FSMediaFrameThrottle");
+    static LLCachedControl<U32> small_area(gSavedSettings, "FSMediaFrameThrottleSmallArea");
+    if (!throttle || mUsedInUI || mHasFocus || mIsParcelMedia)
+    {
+        return 0.f;
+    }
+
+    if (!mVisible)
+    {
+        return HIDDEN_MEDIA_UPDATE_RATE;
+    }
+
+    const bool small = mInterest < (F64)small_area();
+    switch (mPriority)
+    {
+        case LLPluginClassMedia::PRIORITY_HIGH:
+            return 0.f;
+        case LLPluginClassMedia::PRIORITY_NORMAL:
+            return small ? SMALL_MEDIA_UPDATE_RATE : 0.f;
+        case LLPluginClassMedia::PRIORITY_LOW:
+            return small ? SMALL_MEDIA_UPDATE_RATE : LOW_MEDIA_UPDATE_RATE;
+        case LLPluginClassMedia::PRIORITY_SLIDESHOW:
+            return SLIDESHOW_MEDIA_UPDATE_RATE;
+        default:
+            return HIDDEN_MEDIA_UPDATE_RATE;
+    }
+}
+// </FS>
+
 void LLViewerMediaImpl::calculateInterest()
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_MEDIA; //LL_RECORD_BLOCK_TIME(FTM_MEDIA_CALCULATE_INTEREST);
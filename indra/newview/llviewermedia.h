@@ -363,6 +363,7 @@ public:
     // Updates the "interest" value in this object
     void calculateInterest();
     F64 getInterest() const { return mInterest; };
+    F32 getTextureUpdateRate() const; // <FS/> Media frame throttling
     F64 getApproximateTextureInterest();
     S32 getProximity() const { return mProximity; };
     F64 getProximityDistance() const { return mProximityDistance; };
@@ -453,6 +454,7 @@ private:
     S32 mTextureUsedHeight;
     bool mSuspendUpdates;
     bool mTextureUpdatePending = false;
+    LLFrameTimer mTextureUpdateTimer; // <FS/> Media frame throttling
     bool mVisible;
     ECursorType mLastSetCursor;
     EMediaNavState mMediaNavState;
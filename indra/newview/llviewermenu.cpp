@@ -167,6 +167,7 @@
 #include "fsfloatercontacts.h"
 #include "fsfloaterplacedetails.h"
 #include "fspose.h"
+#include "fsscenebundle.h" // <FS/> Scene capture
 #include "lfsimfeaturehandler.h"
 #include "llavatarpropertiesprocessor.h"
 #include "llcheckboxctrl.h"
@@ -1598,13 +1599,23 @@ class LLAdvancedTerrainCreateLocalPaintMap : public view_listener_t
         dim = 1 << U32(std::ceil(std::log2(dim)));
         LLPointer<LLImageRaw> image_raw = new LLImageRaw(dim,dim,3);
         LLPointer<LLViewerTexture> tex = LLViewerTextureManager::getLocalTexture(image_raw.get(), true);
-        const bool success = LLTerrainPaintMap::bakeHeightNoiseIntoPBRPaintMapRGB(*region, *tex);
-        // This calls gLocalTerrainMaterials.setPaintType
-        gSavedSettings.setBOOL("LocalTerrainPaintEnabled", true);
-        // If baking the paintmap failed, set the paintmap to nullptr. This
-        // causes LLDrawPoolTerrain to use a blank paintmap instead.
-        if (!success) { tex = nullptr; }
-        gLocalTerrainMaterials.setPaintMap(tex);
+        // <FS> Asynchronous paint map bake, the current paint map stays until the new one is done
+        //const bool success = LLTerrainPaintMap::bakeHeightNoiseIntoPBRPaintMapRGB(*region, *tex);
+        //// This calls gLocalTerrainMaterials.setPaintType
+        //gSavedSettings.setBOOL("LocalTerrainPaintEnabled", true);
+        //// If baking the paintmap failed, set the paintmap to nullptr. This
+        //// causes LLDrawPoolTerrain to use a blank paintmap instead.
+        //if (!success) { tex = nullptr; }
+        //gLocalTerrainMaterials.setPaintMap(tex);
+        LLTerrainPaintMap::queueBakeHeightNoiseIntoPBRPaintMapRGB(*region, *tex, [tex](bool success)
+        {
+            // This calls gLocalTerrainMaterials.setPaintType
+            gSavedSettings.setBOOL("LocalTerrainPaintEnabled", true);
+            // If baking the paintmap failed, set the paintmap to nullptr. This
+            // causes LLDrawPoolTerrain to use a blank paintmap instead.
+            gLocalTerrainMaterials.setPaintMap(success ? tex : LLPointer<LLViewerTexture>());
+        });
+        // </FS>
 
         return true;
     }
@@ -2699,6 +2710,34 @@ class LLAdvancedCheckAgentPilotLoop : public view_listener_t
     }
 };
 
+// <FS> Scene capture
+class FSAdvancedCaptureSceneBundle : public view_listener_t
+{
+    bool handleEvent(const LLSD& userdata)
+    {
+        std::string dir = gSavedSettings.getString("FSSceneCaptureDir");
+        if (dir.empty())
+        {
+            dir = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "");
+        }
+        dir = gDirUtilp->add(dir, "scene_" + LLDate::now().toHTTPDateString("%Y%m%d_%H%M%S"));
+        if (!FSSceneBundle::instance().capture(dir))
+        {
+            LL_WARNS("SceneBundle") << "Scene capture to " << dir << " did not start" << LL_ENDL;
+        }
+        return true;
+    }
+};
+
+class FSAdvancedEnableCaptureSceneBundle : public view_listener_t
+{
+    bool handleEvent(const LLSD& userdata)
+    {
+        return gAgent.getRegion() && !FSSceneBundle::instance().isCapturing();
+    }
+};
+// </FS>
+
 
 /////////////////////////
 // SHOW OBJECT UPDATES //
@@ -12741,6 +12780,10 @@ void initialize_menus()
     view_listener_t::addMenu(new LLAdvancedAgentPilot(), "Advanced.AgentPilot");
     view_listener_t::addMenu(new LLAdvancedToggleAgentPilotLoop(), "Advanced.ToggleAgentPilotLoop");
     view_listener_t::addMenu(new LLAdvancedCheckAgentPilotLoop(), "Advanced.CheckAgentPilotLoop");
+    // <FS> Scene capture
+    view_listener_t::addMenu(new FSAdvancedCaptureSceneBundle(), "Advanced.CaptureSceneBundle");
+    view_listener_t::addMenu(new FSAdvancedEnableCaptureSceneBundle(), "Advanced.EnableCaptureSceneBundle");
+    // </FS>
     view_listener_t::addMenu(new LLAdvancedViewerEventRecorder(), "Advanced.EventRecorder");
 
     // Advanced > Debugging
@@ -144,6 +144,7 @@
 #include "fscommon.h"
 #include "fsfloaterplacedetails.h"
 #include "fsradar.h"
+#include "fsregionprefetch.h"
 #include "fskeywords.h" // <FS:PP> FIRE-10178: Keyword Alerts in group IM do not work unless the group is in the foreground
 #include "fslslbridge.h"
 #include "fsmoneytracker.h"
@@ -3640,6 +3641,10 @@ void process_teleport_finish(LLMessageSystem* msg, void**)
     LLViewerRegion* regionp =  LLWorld::getInstance()->addRegion(region_handle, sim_host, region_size_x, region_size_y);
 // </FS:CR> Aurora Sim
 
+    // <FS> Region prefetch, warm up the caches with what we saw the last time we were there
+    FSRegionPrefetch::getInstance()->prefetchRegion(region_handle);
+    // </FS>
+
     // Ansariel: Disable teleport beacon after teleport
     if (gSavedSettings.getBOOL("FSDisableBeaconAfterTeleport"))
     {
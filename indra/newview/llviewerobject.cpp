@@ -105,6 +105,7 @@
 #include "llcleanup.h"
 #include "llmeshrepository.h"
 #include "llgltfmateriallist.h"
+#include "lllocalgltfmaterials.h" // <FS/> GLTF render material interning
 #include "llgl.h"
 #include "gltf/asset.h"
 // [RLVa:KB] - Checked: 2011-05-22 (RLVa-1.3.1a)
@@ -264,6 +265,16 @@ LLViewerObject *LLViewerObject::createObject(const LLUUID &id, const LLPCode pco
     return res;
 }
 
+// <FS> Slab pools
+// static
+LLSlabPool& LLViewerObject::getSlabPool()
+{
+    // never destroyed, objects can still be released during static destruction
+    static LLSlabPool* pool = new LLSlabPool(4096);
+    return *pool;
+}
+// </FS>
+
 LLViewerObject::LLViewerObject(const LLUUID &id, const LLPCode pcode, LLViewerRegion *regionp, bool is_global)
 :   LLPrimitive(),
     mChildList(),
@@ -331,7 +342,11 @@ LLViewerObject::LLViewerObject(const LLUUID &id, const LLPCode pcode, LLViewerRe
     mLastUpdateCached(false),
     mCachedMuteListUpdateTime(0),
     mCachedOwnerInMuteList(false),
-    mRiggedAttachedWarned(false)
+    mRiggedAttachedWarned(false),
+    // <FS> Incremental complexity
+    mRenderCostValid(false),
+    mRenderCost(0.f)
+    // </FS>
 {
     if (!is_global)
     {
@@ -706,6 +721,13 @@ void LLViewerObject::initObjectDataMap()
     sObjectDataMap["ParentID"] = count;//U32, when SpecialCode & 0x20 is set
     count += sizeof(U32);
 
+    // <FS> Fast binary unpacking
+    llassert(sObjectDataMap["LocalID"] == OBJECT_DATA_LOCAL_ID);
+    llassert(sObjectDataMap["CRC"] == OBJECT_DATA_CRC);
+    llassert(sObjectDataMap["SpecialCode"] == OBJECT_DATA_SPECIAL_CODE);
+    llassert(sObjectDataMap["ParentID"] == OBJECT_DATA_PARENT_ID);
+    // </FS>
+
     //-------
     //The rest items are not included here
     //-------
@@ -743,26 +765,70 @@ void LLViewerObject::unpackU8(LLDataPackerBinaryBuffer* dp, U8& value, std::stri
     dp->reset();
 }
 
+// <FS> Fast binary unpacking
 //static
-U32 LLViewerObject::unpackParentID(LLDataPackerBinaryBuffer* dp, U32& parent_id)
+void LLViewerObject::unpackUUID(LLDataPackerBinaryBuffer* dp, LLUUID& value, EObjectDataOffset offset)
 {
-    dp->shift(sObjectDataMap["SpecialCode"]);
-    U32 value;
-    dp->unpackU32(value, "SpecialCode");
+    dp->shift(offset);
+    if (dp->canRead(UUID_BYTES))
+    {
+        dp->readBytes(value.mData, UUID_BYTES);
+    }
+    dp->reset();
+}
 
+//static
+void LLViewerObject::unpackU32(LLDataPackerBinaryBuffer* dp, U32& value, EObjectDataOffset offset)
+{
+    dp->shift(offset);
+    if (dp->canRead(sizeof(U32)))
+    {
+        value = dp->readU32();
+    }
+    dp->reset();
+}
+// </FS>
+
+//static
+U32 LLViewerObject::unpackParentID(LLDataPackerBinaryBuffer* dp, U32& parent_id)
+{
+    // <FS> Fast binary unpacking
+    //dp->shift(sObjectDataMap["SpecialCode"]);
+    //U32 value;
+    //dp->unpackU32(value, "SpecialCode");
+    //
+    //parent_id = 0;
+    //if(value & 0x20)
+    //{
+    //    S32 offset = sObjectDataMap["ParentID"];
+    //    if(!(value & 0x80))
+    //    {
+    //        offset -= sizeof(LLVector3);
+    //    }
+    //
+    //    dp->shift(offset);
+    //    dp->unpackU32(parent_id, "ParentID");
+    //}
+    //dp->reset();
     parent_id = 0;
-    if(value & 0x20)
+    U32 value = 0;
+    unpackU32(dp, value, OBJECT_DATA_SPECIAL_CODE);
+    if (value & 0x20)
     {
-        S32 offset = sObjectDataMap["ParentID"];
-        if(!(value & 0x80))
+        S32 offset = OBJECT_DATA_PARENT_ID;
+        if (!(value & 0x80))
         {
             offset -= sizeof(LLVector3);
         }
 
         dp->shift(offset);
-        dp->unpackU32(parent_id, "ParentID");
+        if (dp->canRead(sizeof(U32)))
+        {
+            parent_id = dp->readU32();
+        }
+        dp->reset();
     }
-    dp->reset();
+    // </FS>
 
     return parent_id;
 }
@@ -987,6 +1053,12 @@ void LLViewerObject::addChild(LLViewerObject *childp)
         {
             mSeatCount++;
         }
+        // <FS> Incremental complexity
+        else
+        {
+            dirtyRenderCost();
+        }
+        // </FS>
     }
 
     mExtrap.changedlink(*this); // <FS:JN> if linking update, check for sitters
@@ -1022,6 +1094,12 @@ void LLViewerObject::removeChild(LLViewerObject *childp)
             {
                 mSeatCount--;
             }
+            // <FS> Incremental complexity
+            else
+            {
+                dirtyRenderCost();
+            }
+            // </FS>
             break;
         }
     }
@@ -1753,31 +1831,57 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                     ((LLVOAvatar*)this)->setFootPlane(collision_plane);
                 }
                 test_pos_parent = getPosition();
-                dp->unpackVector3(new_pos_parent, "Pos");
-                dp->unpackU16(val[VX], "VelX");
-                dp->unpackU16(val[VY], "VelY");
-                dp->unpackU16(val[VZ], "VelZ");
+                // <FS> Fast binary unpacking
+                // Compressed updates always come in a binary buffer. The motion
+                // block has a fixed layout, check its length once and read it
+                // without going through the virtual unpackers.
+                LLDataPackerBinaryBuffer* bdp = static_cast<LLDataPackerBinaryBuffer*>(dp);
+                constexpr S32 TERSE_MOTION_SIZE = sizeof(LLVector3) + 13 * sizeof(U16);
+                if (!bdp->canRead(TERSE_MOTION_SIZE))
+                {
+                    LL_WARNS("UpdateFail") << "Truncated terse update for " << getID() << LL_ENDL;
+                    return retval;
+                }
+                //dp->unpackVector3(new_pos_parent, "Pos");
+                //dp->unpackU16(val[VX], "VelX");
+                //dp->unpackU16(val[VY], "VelY");
+                //dp->unpackU16(val[VZ], "VelZ");
+                bdp->readF32s(new_pos_parent.mV, 3);
+                val[VX] = bdp->readU16();
+                val[VY] = bdp->readU16();
+                val[VZ] = bdp->readU16();
                 setVelocity(U16_to_F32(val[VX], -128.f, 128.f),
                             U16_to_F32(val[VY], -128.f, 128.f),
                             U16_to_F32(val[VZ], -128.f, 128.f));
-                dp->unpackU16(val[VX], "AccX");
-                dp->unpackU16(val[VY], "AccY");
-                dp->unpackU16(val[VZ], "AccZ");
+                //dp->unpackU16(val[VX], "AccX");
+                //dp->unpackU16(val[VY], "AccY");
+                //dp->unpackU16(val[VZ], "AccZ");
+                val[VX] = bdp->readU16();
+                val[VY] = bdp->readU16();
+                val[VZ] = bdp->readU16();
                 setAcceleration(U16_to_F32(val[VX], -64.f, 64.f),
                                 U16_to_F32(val[VY], -64.f, 64.f),
                                 U16_to_F32(val[VZ], -64.f, 64.f));
 
-                dp->unpackU16(val[VX], "ThetaX");
-                dp->unpackU16(val[VY], "ThetaY");
-                dp->unpackU16(val[VZ], "ThetaZ");
-                dp->unpackU16(val[VS], "ThetaS");
+                //dp->unpackU16(val[VX], "ThetaX");
+                //dp->unpackU16(val[VY], "ThetaY");
+                //dp->unpackU16(val[VZ], "ThetaZ");
+                //dp->unpackU16(val[VS], "ThetaS");
+                val[VX] = bdp->readU16();
+                val[VY] = bdp->readU16();
+                val[VZ] = bdp->readU16();
+                val[VS] = bdp->readU16();
                 new_rot.mQ[VX] = U16_to_F32(val[VX], -1.f, 1.f);
                 new_rot.mQ[VY] = U16_to_F32(val[VY], -1.f, 1.f);
                 new_rot.mQ[VZ] = U16_to_F32(val[VZ], -1.f, 1.f);
                 new_rot.mQ[VS] = U16_to_F32(val[VS], -1.f, 1.f);
-                dp->unpackU16(val[VX], "AccX");
-                dp->unpackU16(val[VY], "AccY");
-                dp->unpackU16(val[VZ], "AccZ");
+                //dp->unpackU16(val[VX], "AccX");
+                //dp->unpackU16(val[VY], "AccY");
+                //dp->unpackU16(val[VZ], "AccZ");
+                val[VX] = bdp->readU16();
+                val[VY] = bdp->readU16();
+                val[VZ] = bdp->readU16();
+                // </FS>
                 new_angv.set(U16_to_F32(val[VX], -64.f, 64.f),
                                     U16_to_F32(val[VY], -64.f, 64.f),
                                     U16_to_F32(val[VZ], -64.f, 64.f));
@@ -1797,9 +1901,22 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                     gFloaterTools->dirty();
                 }
 
-                dp->unpackU32(crc, "CRC");
+                // <FS> Fast binary unpacking
+                // Everything up to the owner has a fixed layout, check its
+                // length once and read it without the virtual unpackers
+                LLDataPackerBinaryBuffer* bdp = static_cast<LLDataPackerBinaryBuffer*>(dp);
+                constexpr S32 FULL_HEADER_SIZE = sizeof(U32) + 2 * sizeof(U8) + 3 * sizeof(LLVector3) + sizeof(U32) + UUID_BYTES;
+                if (!bdp->canRead(FULL_HEADER_SIZE))
+                {
+                    LL_WARNS("UpdateFail") << "Truncated full update for " << getID() << LL_ENDL;
+                    return retval;
+                }
+                //dp->unpackU32(crc, "CRC");
+                crc = bdp->readU32();
                 mTotalCRC = crc;
-                dp->unpackU8(material, "Material");
+                //dp->unpackU8(material, "Material");
+                material = bdp->readU8();
+                // </FS>
                 U8 old_material = getMaterial();
                 if (old_material != material)
                 {
@@ -1809,19 +1926,27 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
                         gPipeline.markMoved(mDrawable, false); // undamped
                     }
                 }
-                dp->unpackU8(click_action, "ClickAction");
+                // <FS> Fast binary unpacking
+                //dp->unpackU8(click_action, "ClickAction");
+                click_action = bdp->readU8();
                 setClickAction(click_action);
-                dp->unpackVector3(new_scale, "Scale");
-                dp->unpackVector3(new_pos_parent, "Pos");
+                //dp->unpackVector3(new_scale, "Scale");
+                //dp->unpackVector3(new_pos_parent, "Pos");
+                bdp->readF32s(new_scale.mV, 3);
+                bdp->readF32s(new_pos_parent.mV, 3);
                 LLVector3 vec;
-                dp->unpackVector3(vec, "Rot");
+                //dp->unpackVector3(vec, "Rot");
+                bdp->readF32s(vec.mV, 3);
                 new_rot.unpackFromVector3(vec);
                 setAcceleration(LLVector3::zero);
 
                 U32 value;
-                dp->unpackU32(value, "SpecialCode");
+                //dp->unpackU32(value, "SpecialCode");
+                value = bdp->readU32();
                 dp->setPassFlags(value);
-                dp->unpackUUID(owner_id, "Owner");
+                //dp->unpackUUID(owner_id, "Owner");
+                bdp->readBytes(owner_id.mData, UUID_BYTES);
+                // </FS>
 
                 mOwnerID = owner_id;
 
@@ -5714,8 +5839,20 @@ S32 LLViewerObject::setTEGLTFMaterialOverride(U8 te, LLGLTFMaterial* override_ma
     {
         if (override_mat)
         {
-            LLFetchedGLTFMaterial* render_mat = new LLFetchedGLTFMaterial(*src_mat);
+            // <FS> GLTF render material interning
+            //LLFetchedGLTFMaterial* render_mat = new LLFetchedGLTFMaterial(*src_mat);
+            LLPointer<LLFetchedGLTFMaterial> render_mat = new LLFetchedGLTFMaterial(*src_mat);
+            // </FS>
             render_mat->applyOverride(*override_mat);
+            // <FS> GLTF render material interning, faces with the same material and
+            // override share one render material. Local materials and textures update
+            // their render materials in place, those stay per face.
+            if (!src_mat->hasLocalTextures() && !override_mat->hasLocalTextures()
+                && !dynamic_cast<LLLocalGLTFMaterial*>(src_mat))
+            {
+                render_mat = gGLTFMaterialList.internRenderMaterial(render_mat);
+            }
+            // </FS>
             tep->setGLTFRenderMaterial(render_mat);
             retval = TEM_CHANGE_TEXTURE;
 
@@ -6234,6 +6371,7 @@ void LLViewerObject::setParticleSource(const LLPartSysData& particle_parameters,
     {
         deleteParticleSource();
     }
+    dirtyRenderCost(); // <FS/> Incremental complexity
 
     LLPointer<LLViewerPartSourceScript> pss = LLViewerPartSourceScript::createPSS(this, particle_parameters);
     mPartSourcep = pss;
@@ -6262,6 +6400,7 @@ void LLViewerObject::setParticleSource(const LLPartSysData& particle_parameters,
 void LLViewerObject::unpackParticleSource(const S32 block_num, const LLUUID& owner_id)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VIEWER;
+    dirtyRenderCost(); // <FS/> Incremental complexity
     if (!mPartSourcep.isNull() && mPartSourcep->isDead())
     {
         mPartSourcep = NULL;
@@ -6311,6 +6450,7 @@ void LLViewerObject::unpackParticleSource(const S32 block_num, const LLUUID& own
 void LLViewerObject::unpackParticleSource(LLDataPacker &dp, const LLUUID& owner_id, bool legacy)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VIEWER;
+    dirtyRenderCost(); // <FS/> Incremental complexity
     if (!mPartSourcep.isNull() && mPartSourcep->isDead())
     {
         mPartSourcep = NULL;
@@ -6362,6 +6502,7 @@ void LLViewerObject::deleteParticleSource()
     {
         mPartSourcep->setDead();
         mPartSourcep = NULL;
+        dirtyRenderCost(); // <FS/> Incremental complexity
     }
 }
 
@@ -6685,6 +6826,8 @@ void LLViewerObject::parameterChanged(U16 param_type, bool local_origin)
 
 void LLViewerObject::parameterChanged(U16 param_type, LLNetworkData* data, bool in_use, bool local_origin)
 {
+    dirtyRenderCost(); // <FS/> Incremental complexity
+
     if (local_origin)
     {
         // *NOTE: Do not send the render material ID in this way as it will get
@@ -7010,6 +7153,15 @@ void LLViewerObject::markForUpdate()
     }
 }
 
+// <FS> Incremental complexity
+void LLViewerObject::dirtyRenderCost()
+{
+    LLViewerObject* root = getRootEdit();
+    root->mRenderCostValid = false;
+    root->mRenderCostTextures.clear();
+}
+// </FS>
+
 bool LLViewerObject::isPermanentEnforced() const
 {
     return flagObjectPermanent() && (mRegionp != gAgent.getRegion()) && !gAgent.isGodlike();
@@ -7045,6 +7197,7 @@ void LLViewerObject::setRegion(LLViewerRegion *regionp)
 
     mLatestRecvPacketID = 0;
     mRegionp = regionp;
+    gObjectList.getAreaSearchIndex().onRegionChanged(this); // <FS/> Area search index
 
     for (child_list_t::iterator i = mChildList.begin(); i != mChildList.end(); ++i)
     {
@@ -56,6 +56,7 @@ namespace LL
 }
 
 #include "fsregioncross.h" // <FS:JN> Improved region crossing support
+#include "llslabpool.h" // <FS/> Slab pools
 
 class LLAgent;          // TODO: Get rid of this.
 class LLAudioSource;
@@ -125,6 +126,10 @@ class LLViewerObject
     public LLRefCount,
     public LLGLUpdate
 {
+    // <FS> Slab pools
+    LL_SLAB_POOL_NEW(getSlabPool())
+    static LLSlabPool& getSlabPool();
+    // </FS>
 protected:
     virtual ~LLViewerObject(); // use unref()
 
@@ -490,6 +495,7 @@ public:
 
     void recursiveMarkForUpdate();
     virtual void markForUpdate();
+    void dirtyRenderCost(); // <FS/> Incremental complexity
     void updateVolume(const LLVolumeParams& volume_params);
     virtual void updateSpatialExtents(LLVector4a& min, LLVector4a& max);
     virtual F32 getBinRadius();
@@ -674,6 +680,19 @@ public:
     static void unpackU32(LLDataPackerBinaryBuffer* dp, U32& value, std::string name);
     static void unpackU8(LLDataPackerBinaryBuffer* dp, U8& value, std::string name);
     static U32 unpackParentID(LLDataPackerBinaryBuffer* dp, U32& parent_id);
+    // <FS> Fast binary unpacking
+    // Offsets into compressed full updates, as laid out by initObjectDataMap()
+    enum EObjectDataOffset : S32
+    {
+        OBJECT_DATA_ID = 0,
+        OBJECT_DATA_LOCAL_ID = 16,
+        OBJECT_DATA_CRC = 22,
+        OBJECT_DATA_SPECIAL_CODE = 64,
+        OBJECT_DATA_PARENT_ID = 96
+    };
+    static void unpackUUID(LLDataPackerBinaryBuffer* dp, LLUUID& value, EObjectDataOffset offset);
+    static void unpackU32(LLDataPackerBinaryBuffer* dp, U32& value, EObjectDataOffset offset);
+    // </FS>
 
 public:
     //counter-translation
@@ -788,6 +807,16 @@ public:
 
     bool mRiggedAttachedWarned;
 
+    // <FS> Incremental complexity
+    // What LLVOAvatar::accountRenderComplexityForObject() last got for the
+    // linkset rooted here, kept until something in the linkset changes.
+    // Texture costs are not included, only the textures, their sizes can
+    // change while they load.
+    bool mRenderCostValid;
+    F32 mRenderCost;    // of the volumes, with the animated object surcharge
+    std::vector<LLConstPointer<LLViewerTexture> > mRenderCostTextures;
+    // </FS>
+
     // In bits
     S32             mBestUpdatePrecision;
 
@@ -36,6 +36,7 @@
 #include "llviewercontrol.h"
 #include "llface.h"
 #include "llvoavatar.h"
+#include "llcontrolavatar.h" // <FS/> Shared animesh poses
 #include "llviewerobject.h"
 #include "llviewerwindow.h"
 #include "llnetmap.h"
@@ -91,6 +92,9 @@
 
 #include "fsareasearch.h" // <FS:Cron> Added to provide the ability to update the impact costs in area search. </FS:Cron>
 #include "llavataractions.h"
+#include "threadpool.h" // <FS/> Parallel avatar updates
+#include "workqueue.h" // <FS/> Parallel avatar updates
+#include "fsanimationscheduler.h" // <FS/> Animation budget
 
 extern F32 gMinObjectDistance;
 extern bool gAnimateTextures;
@@ -441,6 +445,96 @@ LLViewerObject* LLViewerObjectList::processObjectUpdateFromCache(LLVOCacheEntry*
     return objectp;
 }
 
+// <FS> Parallel object update decoding
+namespace
+{
+    // Fewer blocks than this are parsed as they are applied
+    constexpr S32 MIN_DECODED_BLOCKS = 4;
+
+    struct DecodeJob
+    {
+        LLTEContents*       mContents;
+        S32*                mResults;
+        U32                 mCount;
+        std::atomic<U32>    mNext{ 0 };
+        std::atomic<U32>    mDone{ 0 };
+    };
+
+    void decode_texture_entries(DecodeJob& job)
+    {
+        for (U32 i = job.mNext++; i < job.mCount; i = job.mNext++)
+        {
+            LLTEContents& tec = job.mContents[i];
+            job.mResults[i] = tec.size > 0 ? LLPrimitive::parseTEContents(tec) : 0;
+            ++job.mDone;
+        }
+    }
+}
+
+// Parse the texture entries of all blocks of an ObjectUpdate message on the
+// main thread and as many "General" pool threads as are free. They are copied
+// out of the message on the main thread first. How many faces an object has
+// is only known once its volume is set, so all LLTEContents::MAX_TES are
+// parsed and LLVOVolume::processUpdateMessage() applies as many as it needs.
+void LLViewerObjectList::decodeTextureEntries(LLMessageSystem* mesgsys, S32 num_objects)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+
+    if ((S32)mDecodedTEs.size() < num_objects)
+    {
+        mDecodedTEs.resize(num_objects);
+    }
+    mDecodedTEResults.assign(num_objects, 0);
+
+    for (S32 i = 0; i < num_objects; ++i)
+    {
+        LLTEContents& tec = mDecodedTEs[i];
+        tec.size = mesgsys->getSizeFast(_PREHASH_ObjectData, i, _PREHASH_TextureEntry);
+        if (tec.size >= LLTEContents::MAX_TE_BUFFER)
+        {
+            LL_WARNS("TEXTUREENTRY") << "Excessive buffer size detected in Texture Entry! Truncating." << LL_ENDL;
+            tec.size = LLTEContents::MAX_TE_BUFFER - 1;
+        }
+
+        if (tec.size > 0)
+        {
+            mesgsys->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_TextureEntry, tec.packed_buffer, 0, i, LLTEContents::MAX_TE_BUFFER - 1);
+            // the last field is not zero terminated, see LLPrimitive::parseTEMessage()
+            tec.packed_buffer[tec.size] = 0x00;
+            ++tec.size;
+        }
+        tec.face_count = tec.size > 0 ? LLTEContents::MAX_TES : 0;
+    }
+
+    std::shared_ptr<DecodeJob> job = std::make_shared<DecodeJob>();
+    job->mContents = mDecodedTEs.data();
+    job->mResults = mDecodedTEResults.data();
+    job->mCount = num_objects;
+
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    LL::ThreadPoolBase::ptr_t general_pool = LL::ThreadPoolBase::getInstance("General");
+    U32 helpers = 0;
+    if (general_queue && general_pool)
+    {
+        helpers = llmin((U32)general_pool->getWidth(), job->mCount - 1);
+    }
+
+    for (U32 i = 0; i < helpers; ++i)
+    {
+        if (!general_queue->tryPost([job]() { decode_texture_entries(*job); }))
+        {
+            break;
+        }
+    }
+
+    decode_texture_entries(*job);
+    while (job->mDone < job->mCount)
+    {
+        std::this_thread::yield();
+    }
+}
+// </FS>
+
 void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
                                              void **user_data,
                                              const EObjectUpdateType update_type,
@@ -512,6 +606,15 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
     LLDataPackerBinaryBuffer compressed_dp(compressed_dpbuffer, 2048);
     LLViewerStatsRecorder& recorder = LLViewerStatsRecorder::instance();
 
+    // <FS> Parallel object update decoding
+    static LLCachedControl<bool> parallel_decoding(gSavedSettings, "FSParallelObjectUpdateDecoding", true);
+    const bool decoded = parallel_decoding && !compressed && update_type == OUT_FULL && num_objects >= MIN_DECODED_BLOCKS;
+    if (decoded)
+    {
+        decodeTextureEntries(mesgsys, num_objects);
+    }
+    // </FS>
+
     for (i = 0; i < num_objects; i++)
     {
         bool justCreated = false;
@@ -531,9 +634,21 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
                 U32 flags = 0;
                 mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, i);
 
-                compressed_dp.unpackUUID(fullid, "ID");
-                compressed_dp.unpackU32(local_id, "LocalID");
-                compressed_dp.unpackU8(pcode, "PCode");
+                // <FS> Fast binary unpacking
+                //compressed_dp.unpackUUID(fullid, "ID");
+                //compressed_dp.unpackU32(local_id, "LocalID");
+                //compressed_dp.unpackU8(pcode, "PCode");
+                if (compressed_dp.canRead(UUID_BYTES + sizeof(U32) + sizeof(U8)))
+                {
+                    compressed_dp.readBytes(fullid.mData, UUID_BYTES);
+                    local_id = compressed_dp.readU32();
+                    pcode = compressed_dp.readU8();
+                }
+                else
+                {
+                    pcode = 0;
+                }
+                // </FS>
 
                 if (pcode == 0)
                 {
@@ -744,7 +859,15 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
             {
                 objectp->mLocalID = local_id;
             }
+            // <FS> Parallel object update decoding
+            if (decoded)
+            {
+                LLVOVolume::sDecodedTE = &mDecodedTEs[i];
+                LLVOVolume::sDecodedTEResult = mDecodedTEResults[i];
+            }
+            // </FS>
             processUpdateCore(objectp, user_data, i, update_type, NULL, justCreated);
+            LLVOVolume::sDecodedTE = nullptr; // <FS/> Parallel object update decoding
         }
         recorder.objectUpdateEvent(update_type);
         objectp->setLastUpdateType(update_type);
@@ -919,6 +1042,107 @@ void LLViewerObjectList::updateApparentAngles(LLAgent &agent)
     LLVOAvatar::cullAvatarsByPixelArea();
 }
 
+// <FS> Parallel avatar updates
+namespace
+{
+    // Avatars are handed out one at a time. The job is shared with the
+    // helpers, so a helper the pool only gets to after the join has
+    // finished finds no avatar left and returns right away.
+    struct SkeletonJob
+    {
+        std::vector<LLVOAvatar*>    mAvatars;
+        std::atomic<U32>            mNext{ 0 };
+        std::atomic<U32>            mDone{ 0 };
+    };
+
+    void update_skeletons(SkeletonJob& job)
+    {
+        const U32 count = (U32)job.mAvatars.size();
+        for (U32 i = job.mNext++; i < count; i = job.mNext++)
+        {
+            job.mAvatars[i]->updateSkeleton();
+            ++job.mDone;
+        }
+    }
+
+    // Finish the idle updates of the avatars that left their skeleton
+    // pending. The skeletons are updated on the main thread and as many
+    // "General" pool threads as are free, each avatar only writing to its
+    // own joints, then the rest of the updates, which play sounds and move
+    // attachments, name tags and effects, run on the main thread in order.
+    void finish_avatar_updates(const std::vector<LLViewerObject*>& idle_list, U32 idle_count)
+    {
+        LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+
+        std::shared_ptr<SkeletonJob> job = std::make_shared<SkeletonJob>();
+        // Avatars copying the pose of another one wait for its skeleton
+        std::vector<LLVOAvatar*> pending;
+        std::vector<LLVOAvatar*> followers;
+        for (U32 i = 0; i < idle_count; ++i)
+        {
+            LLViewerObject* objectp = idle_list[i];
+            if (objectp->isAvatar() && ((LLVOAvatar*)objectp)->isSkeletonUpdatePending())
+            {
+                LLVOAvatar* avatarp = (LLVOAvatar*)objectp;
+                if (avatarp->isDead())
+                { // killed by a later idle update
+                    avatarp->finishIdleUpdate();
+                }
+                else
+                {
+                    pending.push_back(avatarp);
+                    if (avatarp->getSharedPoseSource())
+                    {
+                        followers.push_back(avatarp);
+                    }
+                    else
+                    {
+                        job->mAvatars.push_back(avatarp);
+                    }
+                }
+            }
+        }
+
+        if (pending.empty())
+        {
+            return;
+        }
+
+        LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+        LL::ThreadPoolBase::ptr_t general_pool = LL::ThreadPoolBase::getInstance("General");
+        U32 helpers = 0;
+        if (general_queue && general_pool && !job->mAvatars.empty())
+        {
+            helpers = llmin((U32)general_pool->getWidth(), (U32)job->mAvatars.size() - 1);
+        }
+
+        for (U32 i = 0; i < helpers; ++i)
+        {
+            if (!general_queue->tryPost([job]() { update_skeletons(*job); }))
+            {
+                break;
+            }
+        }
+
+        update_skeletons(*job);
+        while (job->mDone < (U32)job->mAvatars.size())
+        {
+            std::this_thread::yield();
+        }
+
+        for (LLVOAvatar* avatarp : followers)
+        {
+            avatarp->updateSkeleton();
+        }
+
+        for (LLVOAvatar* avatarp : pending)
+        {
+            avatarp->finishIdleUpdate();
+        }
+    }
+}
+// </FS>
+
 void LLViewerObjectList::update(LLAgent &agent)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
@@ -1025,6 +1249,14 @@ void LLViewerObjectList::update(LLAgent &agent)
 
     std::vector<LLViewerObject*>::iterator idle_end = idle_list.begin()+idle_count;
 
+    // <FS> Parallel avatar updates
+    // Avatars leave their skeleton to finish_avatar_updates() after the loop
+    static LLCachedControl<bool> parallel_avatars(gSavedSettings, "FSParallelAvatarUpdates", true);
+    LLVOAvatar::sDeferSkeletonUpdates = parallel_avatars && mNumAvatars > 1;
+    // </FS>
+
+    FSAnimationScheduler::instance().schedule(); // <FS/> Animation budget
+
     // <FS:Ansariel> Speed up debug settings
     //if (gSavedSettings.getBOOL("FreezeTime"))
     if (freezeTime)
@@ -1040,6 +1272,12 @@ void LLViewerObjectList::update(LLAgent &agent)
                 objectp->idleUpdate(agent, frame_time);
             }
         }
+
+        // <FS> Parallel avatar updates
+        LLVOAvatar::sDeferSkeletonUpdates = false;
+        finish_avatar_updates(idle_list, idle_count);
+        // </FS>
+        LLControlAvatar::clearSharedPoses(); // <FS/> Shared animesh poses
     }
     else
     {
@@ -1051,6 +1289,13 @@ void LLViewerObjectList::update(LLAgent &agent)
                 objectp->idleUpdate(agent, frame_time);
         }
 
+        // <FS> Parallel avatar updates
+        // Before the flexible objects, which follow the attachments
+        LLVOAvatar::sDeferSkeletonUpdates = false;
+        finish_avatar_updates(idle_list, idle_count);
+        // </FS>
+        LLControlAvatar::clearSharedPoses(); // <FS/> Shared animesh poses
+
         //update flexible objects
         LLVolumeImplFlexible::updateClass();
 
@@ -1478,6 +1723,7 @@ void LLViewerObjectList::cleanupReferences(LLViewerObject *objectp)
     LL_DEBUGS("ObjectUpdate") << " dereferencing id " << objectp->mID << LL_ENDL;
 
     mUUIDObjectMap.erase(objectp->mID);
+    mAreaSearchIndex.removeObject(objectp); // <FS/> Area search index
 
     //if (objectp->getRegion())
     //{
@@ -2145,6 +2391,7 @@ LLViewerObject *LLViewerObjectList::createObjectViewer(const LLPCode pcode, LLVi
     mUUIDObjectMap[fullid] = objectp;
 
     mObjects.push_back(objectp);
+    mAreaSearchIndex.addObject(objectp); // <FS/> Area search index
 
     updateActive(objectp);
 
@@ -2171,6 +2418,7 @@ LLViewerObject *LLViewerObjectList::createObjectFromCache(const LLPCode pcode, L
                     regionp->getHost().getAddress(),
                     regionp->getHost().getPort());
     mObjects.push_back(objectp);
+    mAreaSearchIndex.addObject(objectp); // <FS/> Area search index
 
     updateActive(objectp);
 
@@ -2224,6 +2472,7 @@ LLViewerObject *LLViewerObjectList::createObject(const LLPCode pcode, LLViewerRe
                     gMessageSystem->getSenderPort());
 
     mObjects.push_back(objectp);
+    mAreaSearchIndex.addObject(objectp); // <FS/> Area search index
 
     updateActive(objectp);
 
@@ -33,11 +33,13 @@
 // common includes
 #include "llstring.h"
 #include "lltrace.h"
+#include "lluuidflatmap.h" // <FS/> Flat UUID maps
 
 // project includes
 #include "llviewerobject.h"
 #include "lleventcoro.h"
 #include "llcoros.h"
+#include "fsareasearchindex.h" // <FS/> Area search index
 
 class LLCamera;
 class LLNetMap;
@@ -201,6 +203,14 @@ public:
     S32 mNumDeadObjectUpdates;
     S32 mNumDeadObjects;
 protected:
+    // <FS> Parallel object update decoding
+    void decodeTextureEntries(LLMessageSystem* mesgsys, S32 num_objects);
+
+    // of the ObjectUpdate message being processed, kept to reuse the memory
+    std::vector<LLTEContents> mDecodedTEs;
+    std::vector<S32> mDecodedTEResults;
+    // </FS>
+
     std::vector<U64>    mOrphanParents; // LocalID/ip,port of orphaned objects
     std::vector<OrphanInfo> mOrphanChildren;    // UUID's of orphaned objects
     S32 mNumOrphans;
@@ -218,7 +228,10 @@ protected:
     uuid_multiset_t   mDeadObjects;
     // </FS:Beq>
 
-    std::map<LLUUID, LLPointer<LLViewerObject> > mUUIDObjectMap;
+    // <FS> Flat UUID maps: findObject() runs for every object update
+    //std::map<LLUUID, LLPointer<LLViewerObject> > mUUIDObjectMap;
+    LLUUIDFlatMap<LLPointer<LLViewerObject> > mUUIDObjectMap;
+    // </FS>
 
     //set of objects that need to update their cost
     uuid_set_t   mStaleObjectCost;
@@ -260,6 +273,14 @@ public:
     void removeDerenderedItem( LLUUID const & );
 // </FS:ND>
 
+    // <FS> Area search index
+    FSAreaSearchIndex& getAreaSearchIndex() { return mAreaSearchIndex; }
+    void setAreaSearchIndexEnabled(bool enabled) { mAreaSearchIndex.setEnabled(enabled, mObjects); }
+private:
+    FSAreaSearchIndex mAreaSearchIndex;
+public:
+    // </FS>
+
 };
 
 
@@ -39,6 +39,7 @@
 //-----------------------------------------------------------------------------------
 U32 LLViewerOctreeEntryData::sCurVisible = 10; //reserve the low numbers for special use.
 bool LLViewerOctreeDebug::sInDebug = false;
+bool LLViewerOctreeCull::sUseBatchCulling = true; // <FS/> Batched culling
 
 static LLTrace::CountStatHandle<S32> sOcclusionQueries("occlusion_queries", "Number of occlusion queries executed"),
                                      sNumObjectsOccluded("occluded_objects", "Count of objects being occluded by a query"),
@@ -1201,6 +1202,25 @@ void LLOcclusionCullingGroup::doOcclusion(LLCamera* camera, const LLVector4a* sh
         {
             if (!isOcclusionState(QUERY_PENDING) || isOcclusionState(DISCARD_QUERY))
             {
+                // <FS> Hi-Z occlusion, water keeps its depth clamped queries
+                // and the object cache its region shifted ones
+                const bool is_water = mSpatialPartition->mDrawableType == LLPipeline::RENDER_TYPE_WATER ||
+                                      mSpatialPartition->mDrawableType == LLPipeline::RENDER_TYPE_VOIDWATER;
+                LLVector4a hiz_size;
+                hiz_size.set(SG_OCCLUSION_FUDGE, SG_OCCLUSION_FUDGE, OCCLUSION_FUDGE_Z);
+                hiz_size.add(bounds[1]);
+
+                if (!shift && !is_water && gPipeline.mHiZOcclusion.push(this, bounds[0], hiz_size))
+                {
+                    if (mOcclusionQuery[LLViewerCamera::sCurCameraID])
+                    {
+                        releaseOcclusionQueryObjectName(mOcclusionQuery[LLViewerCamera::sCurCameraID]);
+                        mOcclusionQuery[LLViewerCamera::sCurCameraID] = 0;
+                    }
+                    mOcclusionIssued[LLViewerCamera::sCurCameraID] = gFrameCount;
+                }
+                else
+                // </FS>
                 { //no query pending, or previous query to be discarded
                     LL_PROFILE_ZONE_NAMED_CATEGORY_OCTREE("doOcclusion - render");
 
@@ -1355,7 +1375,9 @@ void LLViewerOctreeCull::traverse(const OctreeNode* n)
         (mRes && group->hasState(LLViewerOctreeGroup::SKIP_FRUSTUM_CHECK)))
     {   //fully in, just add everything
         LL_PROFILE_ZONE_NAMED_CATEGORY_OCTREE("AllInside");
+        ++mDepth; // <FS/> Batched culling
         OctreeTraveler::traverse(n);
+        --mDepth; // <FS/> Batched culling
     }
     else
     {
@@ -1365,18 +1387,107 @@ void LLViewerOctreeCull::traverse(const OctreeNode* n)
         if (mRes)
         { //at least partially in, run on down
             LL_PROFILE_ZONE_NAMED_CATEGORY_OCTREE("PartiallyIn");
+            ++mDepth; // <FS/> Batched culling
             OctreeTraveler::traverse(n);
+            --mDepth; // <FS/> Batched culling
         }
 
         mRes = 0;
     }
 }
 
+// <FS> Batched culling
+S32 LLViewerOctreeCull::singleAABBInFrustumGroupBounds(const LLViewerOctreeGroup* group, eCullPlanes planes)
+{
+    switch (planes)
+    {
+        case CULL_AGENT_NO_FAR_CLIP:
+            return mCamera->AABBInFrustumNoFarClip(group->mBounds[0], group->mBounds[1]);
+        case CULL_REGION:
+            return mCamera->AABBInRegionFrustum(group->mBounds[0], group->mBounds[1]);
+        case CULL_REGION_NO_FAR_CLIP:
+            return mCamera->AABBInRegionFrustumNoFarClip(group->mBounds[0], group->mBounds[1]);
+        default:
+            return mCamera->AABBInFrustum(group->mBounds[0], group->mBounds[1]);
+    }
+}
+
+// Siblings are checked one after the other with the same planes, so the
+// first check of a child tests the group bounds of all children of its
+// parent at once and the others pick their result up from the batch.
+S32 LLViewerOctreeCull::batchAABBInFrustumGroupBounds(const LLViewerOctreeGroup* group, eCullPlanes planes)
+{
+    const OctreeNode* node = group->mOctreeNode;
+    const OctreeNode* parent = node ? node->getOctParent() : nullptr;
+    if (!sUseBatchCulling || !mDepth || !parent || parent->getChildCount() < 2)
+    {
+        return singleAABBInFrustumGroupBounds(group, planes);
+    }
+
+    if (mChildBatches.size() < mDepth)
+    {
+        mChildBatches.resize(mDepth);
+    }
+
+    ChildBatch& batch = mChildBatches[mDepth - 1];
+    if (batch.mParent != parent || batch.mPlanes != planes)
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_OCTREE("Batch cull");
+        LL_ALIGN_16(F32 center[3][8]);
+        LL_ALIGN_16(F32 radius[3][8]);
+        batch.mParent = parent;
+        batch.mPlanes = planes;
+        batch.mCount = llmin(parent->getChildCount(), 8U);
+        for (U32 i = 0; i < batch.mCount; ++i)
+        {
+            batch.mChild[i] = parent->getChild(i);
+            const LLViewerOctreeGroup* child = (const LLViewerOctreeGroup*) batch.mChild[i]->getListener(0);
+            for (S32 axis = 0; axis < 3; ++axis)
+            {
+                center[axis][i] = child->mBounds[0][axis];
+                radius[axis][i] = child->mBounds[1][axis];
+            }
+        }
+
+        const F32* const center_ptrs[3] = { center[0], center[1], center[2] };
+        const F32* const radius_ptrs[3] = { radius[0], radius[1], radius[2] };
+        switch (planes)
+        {
+            case CULL_AGENT_NO_FAR_CLIP:
+                mCamera->AABBInFrustumNoFarClipBatch(center_ptrs, radius_ptrs, batch.mCount, batch.mResult);
+                break;
+            case CULL_REGION:
+                mCamera->AABBInRegionFrustumBatch(center_ptrs, radius_ptrs, batch.mCount, batch.mResult);
+                break;
+            case CULL_REGION_NO_FAR_CLIP:
+                mCamera->AABBInRegionFrustumNoFarClipBatch(center_ptrs, radius_ptrs, batch.mCount, batch.mResult);
+                break;
+            default:
+                mCamera->AABBInFrustumBatch(center_ptrs, radius_ptrs, batch.mCount, batch.mResult);
+                break;
+        }
+    }
+
+    for (U32 i = 0; i < batch.mCount; ++i)
+    {
+        if (batch.mChild[i] == node)
+        {
+            return batch.mResult[i];
+        }
+    }
+
+    return singleAABBInFrustumGroupBounds(group, planes);
+}
+// </FS>
+
 //------------------------------------------
 //agent space group culling
 S32 LLViewerOctreeCull::AABBInFrustumNoFarClipGroupBounds(const LLViewerOctreeGroup* group)
 {
-    return mCamera->AABBInFrustumNoFarClip(group->mBounds[0], group->mBounds[1]);
+    // <FS> Batched culling
+    //return mCamera->AABBInFrustumNoFarClip(group->mBounds[0], group->mBounds[1]);
+    return batchAABBInFrustumGroupBounds(group, CULL_AGENT_NO_FAR_CLIP);
+    // </FS>
 }
 
 S32 LLViewerOctreeCull::AABBSphereIntersectGroupExtents(const LLViewerOctreeGroup* group)
@@ -1386,7 +1497,10 @@ S32 LLViewerOctreeCull::AABBSphereIntersectGroupExtents(const LLViewerOctreeGrou
 
 S32 LLViewerOctreeCull::AABBInFrustumGroupBounds(const LLViewerOctreeGroup* group)
 {
-    return mCamera->AABBInFrustum(group->mBounds[0], group->mBounds[1]);
+    // <FS> Batched culling
+    //return mCamera->AABBInFrustum(group->mBounds[0], group->mBounds[1]);
+    return batchAABBInFrustumGroupBounds(group, CULL_AGENT);
+    // </FS>
 }
 //------------------------------------------
 
@@ -1412,12 +1526,18 @@ S32 LLViewerOctreeCull::AABBInFrustumObjectBounds(const LLViewerOctreeGroup* gro
 //local regional space group culling
 S32 LLViewerOctreeCull::AABBInRegionFrustumNoFarClipGroupBounds(const LLViewerOctreeGroup* group)
 {
-    return mCamera->AABBInRegionFrustumNoFarClip(group->mBounds[0], group->mBounds[1]);
+    // <FS> Batched culling
+    //return mCamera->AABBInRegionFrustumNoFarClip(group->mBounds[0], group->mBounds[1]);
+    return batchAABBInFrustumGroupBounds(group, CULL_REGION_NO_FAR_CLIP);
+    // </FS>
 }
 
 S32 LLViewerOctreeCull::AABBInRegionFrustumGroupBounds(const LLViewerOctreeGroup* group)
 {
-    return mCamera->AABBInRegionFrustum(group->mBounds[0], group->mBounds[1]);
+    // <FS> Batched culling
+    //return mCamera->AABBInRegionFrustum(group->mBounds[0], group->mBounds[1]);
+    return batchAABBInFrustumGroupBounds(group, CULL_REGION);
+    // </FS>
 }
 
 S32 LLViewerOctreeCull::AABBRegionSphereIntersectGroupExtents(const LLViewerOctreeGroup* group, const LLVector3& shift)
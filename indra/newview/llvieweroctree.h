@@ -370,10 +370,16 @@ class LLViewerOctreeCull : public OctreeTraveler
 {
 public:
     LLViewerOctreeCull(LLCamera* camera)
-        : mCamera(camera), mRes(0) { }
+        : mCamera(camera), mRes(0), mDepth(0) { } // <FS/> Batched culling
 
     virtual void traverse(const OctreeNode* n);
 
+    // <FS> Batched culling
+    // Test the group bounds of all children of a node in one LLCamera batch
+    // call the first time one of them is checked
+    static bool sUseBatchCulling;
+    // </FS>
+
 protected:
     virtual bool earlyFail(LLViewerOctreeGroup* group);
 
@@ -397,6 +403,19 @@ protected:
     S32 AABBInRegionFrustumObjectBounds(const LLViewerOctreeGroup* group);
     S32 AABBRegionSphereIntersectObjectExtents(const LLViewerOctreeGroup* group, const LLVector3& shift);
 
+    // <FS> Batched culling
+    enum eCullPlanes
+    {
+        CULL_AGENT = 0,
+        CULL_AGENT_NO_FAR_CLIP,
+        CULL_REGION,
+        CULL_REGION_NO_FAR_CLIP
+    };
+
+    S32 singleAABBInFrustumGroupBounds(const LLViewerOctreeGroup* group, eCullPlanes planes);
+    S32 batchAABBInFrustumGroupBounds(const LLViewerOctreeGroup* group, eCullPlanes planes);
+    // </FS>
+
     virtual S32 frustumCheck(const LLViewerOctreeGroup* group) = 0;
     virtual S32 frustumCheckObjects(const LLViewerOctreeGroup* group) = 0;
 
@@ -409,6 +428,21 @@ protected:
 protected:
     LLCamera *mCamera;
     S32 mRes;
+
+    // <FS> Batched culling
+    // Results for the children of one node, one entry per traversal depth so
+    // the batch of a node survives the traversal of its first children
+    struct ChildBatch
+    {
+        const OctreeNode* mParent = nullptr;
+        eCullPlanes mPlanes = CULL_AGENT;
+        U32 mCount = 0;
+        const OctreeNode* mChild[8];
+        S32 mResult[8];
+    };
+    std::vector<ChildBatch> mChildBatches;
+    U32 mDepth;
+    // </FS>
 };
 
 //scan the octree, output the info of each node for debug use.
@@ -73,7 +73,16 @@ LLViewerParcelOverlay::LLViewerParcelOverlay(LLViewerRegion* region, F32 region_
 // </FS:CR> Aurora Sim
     mDirty( false ),
     mTimeSinceLastUpdate(),
-    mOverlayTextureIdx(-1)
+    mOverlayTextureIdx(-1),
+    // <FS> Incremental parcel overlay updates
+    // Everything is out of date until the first full update
+    mDirtyTextureRowBegin(0),
+    mDirtyTextureRowEnd(mParcelGridsPerEdge),
+    mDirtyLineRowBegin(0),
+    mDirtyLineRowEnd(mParcelGridsPerEdge),
+    mUpdateTextureRowBegin(0),
+    mUpdateTextureRowEnd(0)
+    // </FS>
 {
     if (!sColorSetInitialized)
     {
@@ -114,6 +123,8 @@ LLViewerParcelOverlay::LLViewerParcelOverlay(LLViewerRegion* region, F32 region_
         mOwnership[i] = PARCEL_PUBLIC;
     }
 
+    mRowEdgeStart.assign(mParcelGridsPerEdge + 1, 0); // <FS/> Incremental parcel overlay updates
+
     gPipeline.markGLRebuild(this);
 }
 
@@ -344,7 +355,17 @@ void LLViewerParcelOverlay::updateOverlayTexture()
     {
         if (!mDirty)
             return;
-        mOverlayTextureIdx = 0;
+        // <FS> Incremental parcel overlay updates
+        //mOverlayTextureIdx = 0;
+        if (mDirtyTextureRowBegin >= mDirtyTextureRowEnd)
+            return;
+        // Rows changing while this update runs are picked up by the next one
+        mUpdateTextureRowBegin = mDirtyTextureRowBegin;
+        mUpdateTextureRowEnd = mDirtyTextureRowEnd;
+        mDirtyTextureRowBegin = mParcelGridsPerEdge;
+        mDirtyTextureRowEnd = 0;
+        mOverlayTextureIdx = mUpdateTextureRowBegin * mParcelGridsPerEdge;
+        // </FS>
     }
 
     const LLColor4U avail = sAvailColor.get();
@@ -356,7 +377,10 @@ void LLViewerParcelOverlay::updateOverlayTexture()
 
     // Create the base texture.
     U8 *raw = mImageRaw->getData();
-    const S32 COUNT = mParcelGridsPerEdge * mParcelGridsPerEdge;
+    // <FS> Incremental parcel overlay updates
+    //const S32 COUNT = mParcelGridsPerEdge * mParcelGridsPerEdge;
+    const S32 COUNT = mUpdateTextureRowEnd * mParcelGridsPerEdge;
+    // </FS>
     S32 max = mOverlayTextureIdx + mParcelGridsPerEdge;
     if (max > COUNT) max = COUNT;
     S32 pixel_index = mOverlayTextureIdx*OVERLAY_IMG_COMPONENTS;
@@ -429,7 +453,10 @@ void LLViewerParcelOverlay::updateOverlayTexture()
         {
             mTexture->createGLTexture(0, mImageRaw);
         }
-        mTexture->setSubImage(mImageRaw, 0, 0, mParcelGridsPerEdge, mParcelGridsPerEdge);
+        // <FS> Incremental parcel overlay updates
+        //mTexture->setSubImage(mImageRaw, 0, 0, mParcelGridsPerEdge, mParcelGridsPerEdge);
+        mTexture->setSubImage(mImageRaw, 0, mUpdateTextureRowBegin, mParcelGridsPerEdge, mUpdateTextureRowEnd - mUpdateTextureRowBegin);
+        // </FS>
         mOverlayTextureIdx = -1;
     }
     else
@@ -450,12 +477,50 @@ void LLViewerParcelOverlay::uncompressLandOverlay(S32 chunk, U8 *packed_overlay)
     S32 chunk_size = size / mParcelOverLayChunks;
 // <FS:CR> Aurora Sim
 
-    memcpy(mOwnership + chunk*chunk_size, packed_overlay, chunk_size);      /*Flawfinder: ignore*/
+    // <FS> Incremental parcel overlay updates
+    //memcpy(mOwnership + chunk*chunk_size, packed_overlay, chunk_size);      /*Flawfinder: ignore*/
+    //
+    //// Force property lines and overlay texture to update
+    //setDirty();
 
-    // Force property lines and overlay texture to update
-    setDirty();
+    // The simulator resends unchanged chunks, only redo the rows that changed
+    U8* ownership = mOwnership + chunk * chunk_size;
+    S32 first = 0;
+    while (first < chunk_size && ownership[first] == packed_overlay[first])
+    {
+        ++first;
+    }
+    if (first < chunk_size)
+    {
+        S32 last = chunk_size - 1;
+        while (ownership[last] == packed_overlay[last])
+        {
+            --last;
+        }
+        memcpy(ownership + first, packed_overlay + first, last - first + 1);      /*Flawfinder: ignore*/
+
+        const S32 offset = chunk * chunk_size;
+        setRowsDirty((offset + first) / mParcelGridsPerEdge, (offset + last) / mParcelGridsPerEdge + 1);
+    }
+    else if (mDirtyTextureRowBegin < mDirtyTextureRowEnd || mDirtyLineRowBegin < mDirtyLineRowEnd)
+    {
+        // Nothing new, but the first update is still to come
+        mDirty = true;
+    }
+    // </FS>
 }
 
+// <FS> Incremental parcel overlay updates
+void LLViewerParcelOverlay::setRowsDirty(S32 begin, S32 end)
+{
+    mDirtyTextureRowBegin = llmin(mDirtyTextureRowBegin, begin);
+    mDirtyTextureRowEnd = llmax(mDirtyTextureRowEnd, end);
+    mDirtyLineRowBegin = llmin(mDirtyLineRowBegin, begin);
+    mDirtyLineRowEnd = llmax(mDirtyLineRowEnd, end);
+    mDirty = true;
+}
+// </FS>
+
 void LLViewerParcelOverlay::updatePropertyLines()
 {
     static LLCachedControl<bool> show(gSavedSettings, "ShowPropertyLines");
@@ -470,13 +535,24 @@ void LLViewerParcelOverlay::updatePropertyLines()
     colors[PARCEL_FOR_SALE] = sForSaleColor.get();
     colors[PARCEL_AUCTION] = sAuctionColor.get();
 
-    mEdges.clear();
+    // <FS> Incremental parcel overlay updates
+    //mEdges.clear();
+    // The north edges of a row depend on the row above it
+    const S32 first_row = llmax(mDirtyLineRowBegin - 1, 0);
+    const S32 end_row = mDirtyLineRowEnd;
+    std::vector<Edge> edges;
+    std::vector<U32> row_edge_count(llmax(end_row - first_row, 0), 0);
+    // </FS>
 
     const F32 GRID_STEP = PARCEL_GRID_STEP_METERS;
     const S32 GRIDS_PER_EDGE = mParcelGridsPerEdge;
 
-    for (S32 row = 0; row < GRIDS_PER_EDGE; row++)
+    // <FS> Incremental parcel overlay updates
+    //for (S32 row = 0; row < GRIDS_PER_EDGE; row++)
+    for (S32 row = first_row; row < end_row; row++)
+    // </FS>
     {
+        const size_t row_first_edge = edges.size(); // <FS/> Incremental parcel overlay updates
         for (S32 col = 0; col < GRIDS_PER_EDGE; col++)
         {
             U8 overlay = mOwnership[row*GRIDS_PER_EDGE+col];
@@ -501,43 +577,80 @@ void LLViewerParcelOverlay::updatePropertyLines()
             F32 bottom = row*GRID_STEP;
             F32 top = bottom+GRID_STEP;
 
+            // <FS> Incremental parcel overlay updates
             // West edge
             if (overlay & PARCEL_WEST_LINE)
             {
-                addPropertyLine(left, bottom, 0, 1, LINE_WIDTH, 0, color);
+                //addPropertyLine(left, bottom, 0, 1, LINE_WIDTH, 0, color);
+                addPropertyLine(edges, left, bottom, 0, 1, LINE_WIDTH, 0, color);
             }
 
             // East edge
             if (col == GRIDS_PER_EDGE - 1 || mOwnership[row * GRIDS_PER_EDGE + col + 1] & PARCEL_WEST_LINE)
             {
-                addPropertyLine(right, bottom, 0, 1, -LINE_WIDTH, 0, color);
+                //addPropertyLine(right, bottom, 0, 1, -LINE_WIDTH, 0, color);
+                addPropertyLine(edges, right, bottom, 0, 1, -LINE_WIDTH, 0, color);
             }
 
             // South edge
             if (overlay & PARCEL_SOUTH_LINE)
             {
-                addPropertyLine(left, bottom, 1, 0, 0, LINE_WIDTH, color);
+                //addPropertyLine(left, bottom, 1, 0, 0, LINE_WIDTH, color);
+                addPropertyLine(edges, left, bottom, 1, 0, 0, LINE_WIDTH, color);
             }
 
             // North edge
             if (row == GRIDS_PER_EDGE - 1 || mOwnership[(row + 1) * GRIDS_PER_EDGE + col] & PARCEL_SOUTH_LINE)
             {
-                addPropertyLine(left, top, 1, 0, 0, -LINE_WIDTH, color);
+                //addPropertyLine(left, top, 1, 0, 0, -LINE_WIDTH, color);
+                addPropertyLine(edges, left, top, 1, 0, 0, -LINE_WIDTH, color);
             }
+            // </FS>
+        }
+        row_edge_count[row - first_row] = (U32)(edges.size() - row_first_edge); // <FS/> Incremental parcel overlay updates
+    }
+
+    // <FS> Incremental parcel overlay updates
+    // Swap the edges of the rebuilt rows in and move the rows above along
+    if (first_row < end_row)
+    {
+        const U32 old_begin = mRowEdgeStart[first_row];
+        const U32 old_end = mRowEdgeStart[end_row];
+        mEdges.erase(mEdges.begin() + old_begin, mEdges.begin() + old_end);
+        mEdges.insert(mEdges.begin() + old_begin, std::make_move_iterator(edges.begin()), std::make_move_iterator(edges.end()));
+
+        for (S32 row = first_row; row < end_row; row++)
+        {
+            mRowEdgeStart[row + 1] = mRowEdgeStart[row] + row_edge_count[row - first_row];
+        }
+        const S64 shift = (S64)edges.size() - (S64)(old_end - old_begin);
+        for (S32 row = end_row + 1; row <= GRIDS_PER_EDGE; row++)
+        {
+            mRowEdgeStart[row] = (U32)(mRowEdgeStart[row] + shift);
         }
     }
+    mDirtyLineRowBegin = GRIDS_PER_EDGE;
+    mDirtyLineRowEnd = 0;
+    // </FS>
 
     // Everything's clean now
     mDirty = false;
 }
 
-void LLViewerParcelOverlay::addPropertyLine(F32 start_x, F32 start_y, F32 dx, F32 dy, F32 tick_dx, F32 tick_dy, const LLColor4U& color)
+// <FS> Incremental parcel overlay updates
+//void LLViewerParcelOverlay::addPropertyLine(F32 start_x, F32 start_y, F32 dx, F32 dy, F32 tick_dx, F32 tick_dy, const LLColor4U& color)
+void LLViewerParcelOverlay::addPropertyLine(std::vector<Edge>& edges, F32 start_x, F32 start_y, F32 dx, F32 dy, F32 tick_dx, F32 tick_dy, const LLColor4U& color)
+// </FS>
 {
     LLSurface& land = mRegion->getLand();
     F32 water_z = land.getWaterHeight();
 
-    mEdges.resize(mEdges.size() + 1);
-    Edge& edge = mEdges.back();
+    // <FS> Incremental parcel overlay updates
+    //mEdges.resize(mEdges.size() + 1);
+    //Edge& edge = mEdges.back();
+    edges.resize(edges.size() + 1);
+    Edge& edge = edges.back();
+    // </FS>
     edge.color = color;
 
     F32 outside_x = start_x;
@@ -637,7 +750,10 @@ void LLViewerParcelOverlay::addPropertyLine(F32 start_x, F32 start_y, F32 dx, F3
 
 void LLViewerParcelOverlay::setDirty()
 {
-    mDirty = true;
+    // <FS> Incremental parcel overlay updates
+    //mDirty = true;
+    setRowsDirty(0, mParcelGridsPerEdge);
+    // </FS>
 }
 
 void LLViewerParcelOverlay::updateGL()
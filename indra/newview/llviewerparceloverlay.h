@@ -101,7 +101,13 @@ private:
 
     U8      parcelFlags(S32 row, S32 col, U8 flags) const;
 
-    void    addPropertyLine(F32 start_x, F32 start_y, F32 dx, F32 dy, F32 tick_dx, F32 tick_dy, const LLColor4U& color);
+    // <FS> Incremental parcel overlay updates
+    //void    addPropertyLine(F32 start_x, F32 start_y, F32 dx, F32 dy, F32 tick_dx, F32 tick_dy, const LLColor4U& color);
+    struct Edge;
+    void    addPropertyLine(std::vector<Edge>& edges, F32 start_x, F32 start_y, F32 dx, F32 dy, F32 tick_dx, F32 tick_dy, const LLColor4U& color);
+    // Mark rows [begin, end) of the grid as changed
+    void    setRowsDirty(S32 begin, S32 end);
+    // </FS>
 
     void    updateOverlayTexture();
     void    updatePropertyLines();
@@ -136,6 +142,19 @@ private:
 
     std::vector<Edge> mEdges;
 
+    // <FS> Incremental parcel overlay updates
+    // Index of the first edge of each grid row in mEdges, and one past the last row
+    std::vector<U32> mRowEdgeStart;
+    // Grid rows [begin, end) whose texture pixels or property lines are out of date
+    S32             mDirtyTextureRowBegin;
+    S32             mDirtyTextureRowEnd;
+    S32             mDirtyLineRowBegin;
+    S32             mDirtyLineRowEnd;
+    // Grid rows [begin, end) of the texture update in progress
+    S32             mUpdateTextureRowBegin;
+    S32             mUpdateTextureRowEnd;
+    // </FS>
+
     static bool sColorSetInitialized;
     static LLUIColor sAvailColor;
     static LLUIColor sOwnedColor;
@@ -273,9 +273,52 @@ bool LLViewerPartGroup::addPart(LLViewerPart* part, F32 desired_size)
 }
 
 
+// <FS> SoA particle update
+// The particles of a group are updated in three passes. The first goes
+// particle by particle for the behaviors that need the source, callbacks or
+// wind, and gathers the state of every particle into the streams below,
+// component by component. The second integrates the streams four particles
+// at a time. The third writes the results back and kills or moves the
+// particles that are done or left the group.
+namespace
+{
+    enum EPartStream
+    {
+        PART_POS_X = 0,
+        PART_POS_Y,
+        PART_POS_Z,
+        PART_VEL_X,
+        PART_VEL_Y,
+        PART_VEL_Z,
+        PART_ACCEL_X,
+        PART_ACCEL_Y,
+        PART_ACCEL_Z,
+        PART_DT,
+        PART_MOVE,          // 1 to integrate, 0 when the position is set otherwise
+        PART_SCALE_START_X,
+        PART_SCALE_START_Y,
+        PART_SCALE_END_X,
+        PART_SCALE_END_Y,
+        PART_FRAC,          // of the max age
+        PART_BOUNCE_Z,      // height to bounce off
+        PART_DESIRED_SIZE,  // out
+        PART_STREAM_COUNT
+    };
+
+    // Main thread only, shared by the groups
+    std::vector<LLVector4a> sPartStreams[PART_STREAM_COUNT];
+    std::vector<U8> sPartOutside;   // per particle, left the group
+    std::vector<LLViewerPart*> sPartMoved;
+
+    inline F32& part_stream(EPartStream stream, U32 i)
+    {
+        return sPartStreams[stream][i / 4].getF32ptr()[i % 4];
+    }
+}
+
 void LLViewerPartGroup::updateParticles(const F32 lastdt)
 {
-    F32 dt;
+    LL_PROFILE_ZONE_SCOPED;
 
     LLVector3 gravity(0.f, 0.f, GRAVITY);
 
@@ -283,16 +326,28 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
 
     LLViewerCamera* camera = LLViewerCamera::getInstance();
     LLViewerRegion *regionp = getRegion();
-    // <FS:Beq> FIRE-34600 - Bugsplat AVX2 particle count mismatch    
-    // S32 end = (S32) mParticles.size();
-    bool changed = false;
-    // </FS:Beq>
-    for (S32 i = 0 ; i < (S32)mParticles.size();)
+
+    const U32 count = (U32)mParticles.size();
+    const U32 blocks = (count + 3) / 4;
+    for (U32 stream = 0; stream < PART_STREAM_COUNT; ++stream)
     {
-        LLVector3 a(0.f, 0.f, 0.f);
-        LLViewerPart* part = mParticles[i] ;
+        if (sPartStreams[stream].size() < blocks)
+        {
+            sPartStreams[stream].resize(blocks);
+        }
+        if (blocks > 0)
+        { // no garbage in the lanes past the last particle
+            sPartStreams[stream][blocks - 1].clear();
+        }
+    }
+    sPartOutside.resize(blocks * 4);
 
-        dt = lastdt + mSkippedTime - part->mSkipOffset;
+    // Behaviors particle by particle, and gather
+    for (U32 i = 0; i < count; ++i)
+    {
+        LLViewerPart* part = mParticles[i];
+
+        const F32 dt = lastdt + mSkippedTime - part->mSkipOffset;
         part->mSkipOffset = 0.f;
 
         // Update current time
@@ -336,35 +391,178 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
             part->mVelocity += step*delta_pos;
         }
 
-
+        bool move = true;
         if (part->mFlags & LLPartData::LL_PART_TARGET_LINEAR_MASK)
         {
             LLVector3 delta_pos = part->mPartSourcep->mTargetPosAgent - part->mPartSourcep->mPosAgent;
             part->mPosAgent = part->mPartSourcep->mPosAgent;
             part->mPosAgent += frac*delta_pos;
             part->mVelocity = delta_pos;
+            move = false;
         }
-        else
+
+        part_stream(PART_POS_X, i) = part->mPosAgent.mV[VX];
+        part_stream(PART_POS_Y, i) = part->mPosAgent.mV[VY];
+        part_stream(PART_POS_Z, i) = part->mPosAgent.mV[VZ];
+        part_stream(PART_VEL_X, i) = part->mVelocity.mV[VX];
+        part_stream(PART_VEL_Y, i) = part->mVelocity.mV[VY];
+        part_stream(PART_VEL_Z, i) = part->mVelocity.mV[VZ];
+        part_stream(PART_ACCEL_X, i) = part->mAccel.mV[VX];
+        part_stream(PART_ACCEL_Y, i) = part->mAccel.mV[VY];
+        part_stream(PART_ACCEL_Z, i) = part->mAccel.mV[VZ];
+        part_stream(PART_DT, i) = dt;
+        part_stream(PART_MOVE, i) = move ? 1.f : 0.f;
+        part_stream(PART_FRAC, i) = frac;
+
+        // Do scale interpolation, or keep the scale
+        const bool interp_scale = part->mFlags & LLPartData::LL_PART_INTERP_SCALE_MASK;
+        const LLVector2& scale_start = interp_scale ? part->mStartScale : part->mScale;
+        const LLVector2& scale_end = interp_scale ? part->mEndScale : part->mScale;
+        part_stream(PART_SCALE_START_X, i) = scale_start.mV[VX];
+        part_stream(PART_SCALE_START_Y, i) = scale_start.mV[VY];
+        part_stream(PART_SCALE_END_X, i) = scale_end.mV[VX];
+        part_stream(PART_SCALE_END_Y, i) = scale_end.mV[VY];
+
+        // Need to do point vs. plane check...
+        // For now, just check relative to object height...
+        part_stream(PART_BOUNCE_Z, i) = (part->mFlags & LLPartData::LL_PART_BOUNCE_MASK) ? part->mPartSourcep->mPosAgent.mV[VZ] : -F32_MAX;
+    }
+
+    // Integrate four at a time
+    {
+        LLVector4a camera_x, camera_y, camera_z;
+        camera_x.splat(camera->getOrigin().mV[VX]);
+        camera_y.splat(camera->getOrigin().mV[VY]);
+        camera_z.splat(camera->getOrigin().mV[VZ]);
+
+        LLVector4a min_x, min_y, min_z, max_x, max_y, max_z;
+        min_x.splat(mMinObjPos.mV[VX]);
+        min_y.splat(mMinObjPos.mV[VY]);
+        min_z.splat(mMinObjPos.mV[VZ]);
+        max_x.splat(mMaxObjPos.mV[VX]);
+        max_y.splat(mMaxObjPos.mV[VY]);
+        max_z.splat(mMaxObjPos.mV[VZ]);
+
+        LLVector4a zero, half, quarter, bounce_damp, max_size, min_group_size, max_group_size;
+        zero.clear();
+        half.splat(0.5f);
+        quarter.splat(0.25f);
+        bounce_damp.splat(-0.75f);
+        max_size.splat(PART_SIM_BOX_SIDE*2);
+        min_group_size.splat(mBoxRadius*0.5f);
+        max_group_size.splat(mBoxRadius*2.f);
+
+        LLVector4a* const pos[3] = { sPartStreams[PART_POS_X].data(), sPartStreams[PART_POS_Y].data(), sPartStreams[PART_POS_Z].data() };
+        LLVector4a* const vel[3] = { sPartStreams[PART_VEL_X].data(), sPartStreams[PART_VEL_Y].data(), sPartStreams[PART_VEL_Z].data() };
+        LLVector4a* const accel[3] = { sPartStreams[PART_ACCEL_X].data(), sPartStreams[PART_ACCEL_Y].data(), sPartStreams[PART_ACCEL_Z].data() };
+
+        for (U32 b = 0; b < blocks; ++b)
         {
+            const LLVector4a& dt = sPartStreams[PART_DT][b];
+            const LLVector4a& move = sPartStreams[PART_MOVE][b];
+
+            LLVector4a half_dt2;
+            half_dt2.setMul(dt, dt);
+            half_dt2.mul(half);
+
             // Do velocity interpolation
-            part->mPosAgent += dt*part->mVelocity;
-            part->mPosAgent += 0.5f*dt*dt*part->mAccel;
-            part->mVelocity += part->mAccel*dt;
-        }
+            for (U32 axis = 0; axis < 3; ++axis)
+            {
+                LLVector4a step;
+                step.setMul(vel[axis][b], dt);
+                LLVector4a accel_step;
+                accel_step.setMul(accel[axis][b], half_dt2);
+                step.add(accel_step);
+                step.mul(move);
+                pos[axis][b].add(step);
+
+                LLVector4a dv;
+                dv.setMul(accel[axis][b], dt);
+                dv.mul(move);
+                vel[axis][b].add(dv);
+            }
 
-        // Do a bounce test
-        if (part->mFlags & LLPartData::LL_PART_BOUNCE_MASK)
-        {
-            // Need to do point vs. plane check...
-            // For now, just check relative to object height...
-            F32 dz = part->mPosAgent.mV[VZ] - part->mPartSourcep->mPosAgent.mV[VZ];
-            if (dz < 0)
+            // Do a bounce test
+            {
+                LLVector4a dz;
+                dz.setSub(pos[VZ][b], sPartStreams[PART_BOUNCE_Z][b]);
+                const LLVector4Logical below = dz.lessThan(zero);
+
+                LLVector4a bounced;
+                bounced.setAdd(dz, dz);
+                bounced.setSub(pos[VZ][b], bounced);
+                pos[VZ][b].setSelectWithMask(below, bounced, pos[VZ][b]);
+
+                LLVector4a damped;
+                damped.setMul(vel[VZ][b], bounce_damp);
+                vel[VZ][b].setSelectWithMask(below, damped, vel[VZ][b]);
+            }
+
+            // Do scale interpolation
+            const LLVector4a& frac = sPartStreams[PART_FRAC][b];
+            LLVector4a scale_x, scale_y;
+            scale_x.setSub(sPartStreams[PART_SCALE_END_X][b], sPartStreams[PART_SCALE_START_X][b]);
+            scale_x.mul(frac);
+            scale_x.add(sPartStreams[PART_SCALE_START_X][b]);
+            scale_y.setSub(sPartStreams[PART_SCALE_END_Y][b], sPartStreams[PART_SCALE_START_Y][b]);
+            scale_y.mul(frac);
+            scale_y.add(sPartStreams[PART_SCALE_START_Y][b]);
+            sPartStreams[PART_SCALE_START_X][b] = scale_x;
+            sPartStreams[PART_SCALE_START_Y][b] = scale_y;
+
+            // calc_desired_size()
+            LLVector4a dx, dy, dz;
+            dx.setSub(pos[VX][b], camera_x);
+            dy.setSub(pos[VY][b], camera_y);
+            dz.setSub(pos[VZ][b], camera_z);
+            dx.mul(dx);
+            dy.mul(dy);
+            dz.mul(dz);
+            dx.add(dy);
+            dx.add(dz);
+            LLVector4a desired_size;
+            desired_size = _mm_sqrt_ps(dx);
+            desired_size.mul(quarter);
+
+            scale_x.mul(scale_x);
+            scale_y.mul(scale_y);
+            scale_x.add(scale_y);
+            LLVector4a min_size;
+            min_size = _mm_sqrt_ps(scale_x);
+            min_size.mul(half);
+
+            desired_size.setMax(desired_size, min_size);
+            desired_size.setMin(desired_size, max_size);
+            sPartStreams[PART_DESIRED_SIZE][b] = desired_size;
+
+            // posInGroup()
+            U32 outside = pos[VX][b].lessThan(min_x).getGatheredBits()
+                | pos[VY][b].lessThan(min_y).getGatheredBits()
+                | pos[VZ][b].lessThan(min_z).getGatheredBits()
+                | pos[VX][b].greaterThan(max_x).getGatheredBits()
+                | pos[VY][b].greaterThan(max_y).getGatheredBits()
+                | pos[VZ][b].greaterThan(max_z).getGatheredBits();
+            outside |= (desired_size.lessThan(min_group_size).getGatheredBits() | desired_size.greaterThan(max_group_size).getGatheredBits())
+                & desired_size.greaterThan(zero).getGatheredBits();
+
+            for (U32 lane = 0; lane < 4; ++lane)
             {
-                part->mPosAgent.mV[VZ] += -2.f*dz;
-                part->mVelocity.mV[VZ] *= -0.75f;
+                sPartOutside[b * 4 + lane] = (outside >> lane) & 1;
             }
         }
+    }
+
+    // Write back, kill and move
+    sPartMoved.clear();
+    U32 kept = 0;
+    for (U32 i = 0; i < count; ++i)
+    {
+        LLViewerPart* part = mParticles[i];
 
+        part->mPosAgent.set(part_stream(PART_POS_X, i), part_stream(PART_POS_Y, i), part_stream(PART_POS_Z, i));
+        part->mVelocity.set(part_stream(PART_VEL_X, i), part_stream(PART_VEL_Y, i), part_stream(PART_VEL_Z, i));
+        part->mScale.set(part_stream(PART_SCALE_START_X, i), part_stream(PART_SCALE_START_Y, i));
+        const F32 frac = part_stream(PART_FRAC, i);
 
         // Reset the offset from the source position
         if (part->mFlags & LLPartData::LL_PART_FOLLOW_SRC_MASK)
@@ -384,71 +582,41 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
             part->mColor += frac%(frac*part->mEndColor); // rgb,alpha
         }
 
-        // Do scale interpolation
-        if (part->mFlags & LLPartData::LL_PART_INTERP_SCALE_MASK)
-        {
-            part->mScale.setVec(part->mStartScale);
-            part->mScale *= 1.f - frac;
-            part->mScale += frac*part->mEndScale;
-        }
-
         // Do glow interpolation
         part->mGlow.mV[3] = (U8) ll_round(lerp(part->mStartGlow, part->mEndGlow, frac)*255.f);
 
         // Set the last update time to now.
-        part->mLastUpdateTime = cur_time;
-
+        part->mLastUpdateTime += part_stream(PART_DT, i);
 
         // Kill dead particles (either flagged dead, or too old)
         if ((part->mLastUpdateTime > part->mMaxAge) || (LLViewerPart::LL_PART_DEAD_MASK == part->mFlags))
         {
-            // <FS:Beq> FIRE-34600 - Bugsplat AVX2 particle count mismatch
-            // mParticles[i] = mParticles.back() ;
-            // mParticles.pop_back() ;
-            // delete part ;
-            vector_replace_with_last(mParticles, mParticles.begin() + i);
-            --LLViewerPartSim::sParticleCount; 
-            delete part ;
-            changed = true; 
-            // </FS:Beq>
+            --LLViewerPartSim::sParticleCount;
+            delete part;
+        }
+        else if (sPartOutside[i])
+        {
+            // Transfer particles between groups, once this group is consistent again
+            sPartMoved.push_back(part);
         }
         else
         {
-            F32 desired_size = calc_desired_size(camera, part->mPosAgent, part->mScale);
-            if (!posInGroup(part->mPosAgent, desired_size))
-            {
-                // Transfer particles between groups
-                // <FS:Beq> FIRE-34600 - Bugsplat AVX2 particle count mismatch
-                // LLViewerPartSim::getInstance()->put(part) ;
-                // mParticles[i] = mParticles.back() ;
-                // mParticles.pop_back() ;                
-                vector_replace_with_last(mParticles, mParticles.begin() + i); 
-                LLViewerPartSim::getInstance()->put(part) ; 
-                // Note: put() uses addpart when succesful, this increase sParticleCount by 1
-                // even though it has stayed the same. If it is not succesful then we need to decrease by 1
-                // so a decrement here works for both cases.
-                --LLViewerPartSim::sParticleCount; 
-                changed = true;
-                // </FS:Beq>
-            }
-            else
-            {
-                i++ ;
-            }
+            mParticles[kept++] = part;
         }
     }
 
-    // <FS:Beq> FIRE-34600 - Bugsplat AVX2 particle count mismatch
-    // S32 removed = end - (S32)mParticles.size();
-    // if (removed > 0)
-    // {
-    //     // we removed one or more particles, so flag this group for update
-    //     if (mVOPartGroupp.notNull())
-    //     {
-    //         gPipeline.markRebuild(mVOPartGroupp->mDrawable, LLDrawable::REBUILD_ALL);
-    //     }
-    //     LLViewerPartSim::decPartCount(removed);
-    // }    
+    const bool changed = kept != count;
+    mParticles.resize(kept);
+
+    for (LLViewerPart* part : sPartMoved)
+    {
+        LLViewerPartSim::getInstance()->put(part);
+        // Note: put() uses addpart when succesful, this increase sParticleCount by 1
+        // even though it has stayed the same. If it is not succesful then we need to decrease by 1
+        // so a decrement here works for both cases.
+        --LLViewerPartSim::sParticleCount;
+    }
+
     if (changed)
     {
         if (mVOPartGroupp.notNull())
@@ -456,7 +624,7 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
             gPipeline.markRebuild(mVOPartGroupp->mDrawable, LLDrawable::REBUILD_ALL);
         }
     }
-    // </FS:Beq>
+// </FS>
 
     // Kill the viewer object if this particle group is empty
     if (mParticles.empty())
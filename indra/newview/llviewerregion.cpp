@@ -77,6 +77,7 @@
 #include "llfloaterperms.h"
 #include "llvieweroctree.h"
 #include "llviewerdisplay.h"
+#include "llviewercamera.h" // <FS/> Prioritized cache misses
 #include "llviewerwindow.h"
 #include "llprogressview.h"
 #include "llcoros.h"
@@ -193,7 +194,12 @@ public:
         mLastCameraUpdate(0),
         mLastCameraOrigin(),
         mVOCachePartition(NULL),
-        mLandp(NULL)
+        mLandp(NULL),
+        // <FS> Region crossing preload
+        mPreloadRadius(0.f),
+        mPreloadFrame(0),
+        mPreloadGatherFrame(0)
+        // </FS>
     {}
 
     static void buildCapabilityNames(LLSD& capabilityNames);
@@ -227,6 +233,7 @@ public:
     LLVOCacheEntry::vocache_entry_priority_list_t mWaitingList; //transient list storing sorted visible entries waiting for object creation.
     std::set<U32>                          mNonCacheableCreatedList; //list of local ids of all non-cacheable objects
     LLVOCacheEntry::vocache_gltf_overrides_map_t mGLTFOverridesLLSD; // for materials
+    LLGLTFOverrideCacheBlobs mGLTFOverrideBlobs; // <FS/> Binary override cache, not decoded yet
 
     // time?
     // LRU info?
@@ -251,6 +258,15 @@ public:
     LLVector3   mLastCameraOrigin;
     U32         mLastCameraUpdate;
 
+    // <FS> Region crossing preload
+    std::vector<LLPointer<LLVOCacheEntry> > mPreloadEntries; // roots in the preload sphere, nearest first
+    LLVector3   mPreloadCenter;         // region local
+    LLVector3   mPreloadGatherCenter;   // what mPreloadEntries were gathered around
+    F32         mPreloadRadius;
+    U32         mPreloadFrame;          // of the last setPreloadSphere()
+    U32         mPreloadGatherFrame;
+    // </FS>
+
     static void        requestBaseCapabilitiesCoro(U64 regionHandle);
     static void        requestBaseCapabilitiesCompleteCoro(U64 regionHandle);
     static void        requestSimulatorFeatureCoro(std::string url, U64 regionHandle);
@@ -845,7 +861,10 @@ void LLViewerRegion::loadObjectCache()
         LLVOCache & vocache = LLVOCache::instance();
         // Without this a "corrupted" vocache persists until a cache clear or other rewrite. Mark as dirty hereif read fails to force a rewrite.
         mCacheDirty = !vocache.readFromCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap);
-        vocache.readGenericExtrasFromCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD, mImpl->mCacheMap);
+        // <FS> Binary override cache
+        //vocache.readGenericExtrasFromCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD, mImpl->mCacheMap);
+        vocache.readGenericExtrasFromCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD, mImpl->mGLTFOverrideBlobs, mImpl->mCacheMap);
+        // </FS>
 
         if (mImpl->mCacheMap.empty())
         {
@@ -875,8 +894,18 @@ void LLViewerRegion::saveObjectCache()
         LLVOCache & instance = LLVOCache::instance();
 
         instance.writeToCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap, mCacheDirty, removal_enabled);
-        instance.writeGenericExtrasToCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD, mCacheDirty, removal_enabled);
+        // <FS> Binary override cache
+        //instance.writeGenericExtrasToCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD, mCacheDirty, removal_enabled);
+        instance.writeGenericExtrasToCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD, mImpl->mGLTFOverrideBlobs, mCacheDirty, removal_enabled);
+        // </FS>
         mCacheDirty = false;
+
+        // <FS> Recently left regions
+        if (!LLAppViewer::instance()->isQuitting())
+        {
+            instance.rememberRegion(mHandle, mImpl->mCacheID, mImpl->mCacheMap, removal_enabled);
+        }
+        // </FS>
     }
 
     if (LLAppViewer::instance()->isQuitting())
@@ -892,6 +921,13 @@ void LLViewerRegion::saveObjectCache()
     }
 }
 
+// <FS> Scene capture
+bool LLViewerRegion::exportObjectCache(const std::string& filename) const
+{
+    return mCacheLoaded && LLVOCache::exportRegion(mImpl->mCacheID, mImpl->mCacheMap, filename);
+}
+// </FS>
+
 void LLViewerRegion::sendMessage()
 {
     gMessageSystem->sendMessage(mImpl->mHost);
@@ -1249,6 +1285,7 @@ void LLViewerRegion::killCacheEntry(LLVOCacheEntry* entry, bool for_rendering)
     }
     // Kill the assocaited overrides
     mImpl->mGLTFOverridesLLSD.erase(entry->getLocalID());
+    mImpl->mGLTFOverrideBlobs.erase(entry->getLocalID()); // <FS/> Binary override cache
     //will remove it from the object cache, real deletion
     entry->setState(LLVOCacheEntry::INACTIVE);
     entry->removeOctreeEntry();
@@ -1488,7 +1525,10 @@ void LLViewerRegion::updateVisibleEntries(F32 max_time)
         return;
     }
 
-    if(mImpl->mVisibleGroups.empty() && mImpl->mVisibleEntries.empty())
+    // <FS> Region crossing preload
+    //if(mImpl->mVisibleGroups.empty() && mImpl->mVisibleEntries.empty())
+    if(mImpl->mVisibleGroups.empty() && mImpl->mVisibleEntries.empty() && mImpl->mPreloadRadius <= 0.f)
+    // </FS>
     {
         return;
     }
@@ -1570,6 +1610,8 @@ void LLViewerRegion::updateVisibleEntries(F32 max_time)
         }
     }
 
+    updatePreloadEntries(projection_threshold); // <FS/> Region crossing preload
+
     if(needs_update)
     {
         mImpl->mLastCameraOrigin = camera_origin;
@@ -1579,6 +1621,115 @@ void LLViewerRegion::updateVisibleEntries(F32 max_time)
     return;
 }
 
+// <FS> Region crossing preload
+void LLViewerRegion::setPreloadSphere(const LLVector3& center_agent, F32 radius)
+{
+    if(radius <= 0.f)
+    {
+        mImpl->mPreloadRadius = 0.f;
+        mImpl->mPreloadEntries.clear();
+        return;
+    }
+
+    mImpl->mPreloadCenter = center_agent - getOriginAgent();
+    mImpl->mPreloadRadius = radius;
+    mImpl->mPreloadFrame = LLViewerOctreeEntryData::getCurrentFrame();
+}
+
+const std::vector<LLPointer<LLVOCacheEntry> >& LLViewerRegion::getPreloadEntries() const
+{
+    return mImpl->mPreloadEntries;
+}
+
+//put the cached roots in the preload sphere in the waiting list, as if they were in view
+void LLViewerRegion::updatePreloadEntries(F32 projection_threshold)
+{
+    if(mImpl->mPreloadRadius <= 0.f)
+    {
+        return;
+    }
+
+    // the sphere lapses when whoever set it stops refreshing it
+    const U32 PRELOAD_TIMEOUT_FRAMES = 30;
+    // gathering walks the whole cache, not more often than this
+    const U32 PRELOAD_GATHER_FRAMES = 32;
+    const size_t MAX_PRELOAD_ENTRIES = 256;
+
+    const U32 cur_frame = LLViewerOctreeEntryData::getCurrentFrame();
+    if(cur_frame - mImpl->mPreloadFrame > PRELOAD_TIMEOUT_FRAMES)
+    {
+        setPreloadSphere(LLVector3::zero, 0.f);
+        return;
+    }
+
+    const F32 radius = mImpl->mPreloadRadius;
+    LLVector4a center;
+    center.load3(mImpl->mPreloadCenter.mV);
+
+    if(cur_frame - mImpl->mPreloadGatherFrame > PRELOAD_GATHER_FRAMES
+        || (mImpl->mPreloadCenter - mImpl->mPreloadGatherCenter).lengthSquared() > radius * radius * 0.0625f)
+    {
+        mImpl->mPreloadGatherFrame = cur_frame;
+        mImpl->mPreloadGatherCenter = mImpl->mPreloadCenter;
+
+        std::vector<std::pair<F32, LLVOCacheEntry*> > found;
+        for(LLVOCacheEntry::vocache_entry_map_t::iterator iter = mImpl->mCacheMap.begin(); iter != mImpl->mCacheMap.end(); ++iter)
+        {
+            LLVOCacheEntry* entry = iter->second;
+            if(entry->getParentID() > 0 || !entry->getEntry() || !entry->isValid())
+            {
+                continue;
+            }
+
+            LLVector4a offset;
+            offset.setSub(entry->getPositionGroup(), center);
+            const F32 dist = llmax(offset.getLength3().getF32() - entry->getBinRadius(), 0.f);
+            if(dist < radius)
+            {
+                found.push_back(std::make_pair(dist, entry));
+            }
+        }
+
+        if(found.size() > MAX_PRELOAD_ENTRIES)
+        {
+            std::nth_element(found.begin(), found.begin() + MAX_PRELOAD_ENTRIES, found.end());
+            found.resize(MAX_PRELOAD_ENTRIES);
+        }
+        std::sort(found.begin(), found.end());
+
+        mImpl->mPreloadEntries.clear();
+        for(size_t i = 0; i < found.size(); ++i)
+        {
+            mImpl->mPreloadEntries.push_back(found[i].second);
+        }
+    }
+
+    for(size_t i = 0; i < mImpl->mPreloadEntries.size(); ++i)
+    {
+        LLVOCacheEntry* vo_entry = mImpl->mPreloadEntries[i];
+        if(!vo_entry->isValid() || vo_entry->getState() >= LLVOCacheEntry::WAITING || !vo_entry->getEntry())
+        {
+            continue;
+        }
+        if(mImpl->mWaitingList.find(vo_entry) != mImpl->mWaitingList.end())
+        {
+            continue; //in view already, changing its contribution would break the ordering
+        }
+
+        //what it would contribute seen from the middle of the sphere
+        LLVector4a offset;
+        offset.setSub(vo_entry->getPositionGroup(), center);
+        const F32 rad = vo_entry->getBinRadius();
+        const F32 contribution = (rad * rad) / llmax(offset.getLength3().getF32() - LLVOCacheEntry::sNearRadius, 1.f);
+        if(contribution > projection_threshold)
+        {
+            vo_entry->setSceneContribution(contribution);
+            mImpl->mWaitingList.insert(vo_entry);
+        }
+    }
+}
+// </FS>
+
 void LLViewerRegion::createVisibleObjects(F32 max_time)
 {
     if(mDead)
@@ -2918,8 +3069,14 @@ LLViewerRegion::eCacheUpdateResult LLViewerRegion::cacheFullUpdate(LLDataPackerB
     U32 crc;
     U32 local_id;
 
-    LLViewerObject::unpackU32(&dp, local_id, "LocalID");
-    LLViewerObject::unpackU32(&dp, crc, "CRC");
+    // <FS> Fast binary unpacking
+    //LLViewerObject::unpackU32(&dp, local_id, "LocalID");
+    //LLViewerObject::unpackU32(&dp, crc, "CRC");
+    local_id = 0;
+    crc = 0;
+    LLViewerObject::unpackU32(&dp, local_id, LLViewerObject::OBJECT_DATA_LOCAL_ID);
+    LLViewerObject::unpackU32(&dp, crc, LLViewerObject::OBJECT_DATA_CRC);
+    // </FS>
 
     LLVOCacheEntry* entry = getCacheEntry(local_id, false);
 
@@ -2977,6 +3134,7 @@ LLViewerRegion::eCacheUpdateResult LLViewerRegion::cacheFullUpdate(LLViewerObjec
 void LLViewerRegion::cacheFullUpdateGLTFOverride(const LLGLTFOverrideCacheEntry &override_data)
 {
     U32 local_id = override_data.mLocalId;
+    mImpl->mGLTFOverrideBlobs.erase(local_id); // <FS/> Binary override cache, superseded
     if (override_data.mSides.size() > 0)
     { // empty override means overrides were removed from this object
         mImpl->mGLTFOverridesLLSD[local_id] = override_data;
@@ -3013,12 +3171,112 @@ LLVOCacheEntry* LLViewerRegion::getCacheEntry(U32 local_id, bool valid)
     return NULL;
 }
 
-void LLViewerRegion::addCacheMiss(U32 id, LLViewerRegion::eCacheMissType cache_miss_type)
+// <FS> Prioritized cache misses
+//void LLViewerRegion::addCacheMiss(U32 id, LLViewerRegion::eCacheMissType cache_miss_type)
+void LLViewerRegion::addCacheMiss(U32 id, LLViewerRegion::eCacheMissType cache_miss_type, LLVOCacheEntry* entry)
+// </FS>
 {
     mRegionCacheMissCount++;
     mCacheMissList.push_back(CacheMissItem(id, cache_miss_type));
+    // <FS> Prioritized cache misses
+    // The object most likely hasn't gone far since it was cached
+    CacheMissItem& item = mCacheMissList.back();
+    item.mHasPosition = getCachedExtents(entry, item.mPositionRegion, item.mRadius);
+    // </FS>
+}
+
+// <FS> Prioritized cache misses
+bool LLViewerRegion::getCachedExtents(LLVOCacheEntry* entry, LLVector3& pos_region, F32& radius)
+{
+    if (!entry || !entry->getDP())
+    {
+        return false;
+    }
+
+    LLVector3 pos;
+    LLVector3 scale;
+    LLQuaternion rot;
+    const U32 parent_id = LLViewerObject::extractSpatialExtents(entry->getDP(), pos, scale, rot);
+    radius = scale.length() * 0.5f;
+
+    if (parent_id)
+    { // linksets are one level deep, the root is in the cache too or unknown
+        LLVOCacheEntry* parent = getCacheEntry(parent_id, false);
+        if (!parent || !parent->getDP())
+        {
+            return false;
+        }
+
+        LLVector3 parent_pos;
+        LLVector3 parent_scale;
+        LLQuaternion parent_rot;
+        if (LLViewerObject::extractSpatialExtents(parent->getDP(), parent_pos, parent_scale, parent_rot))
+        {
+            return false;
+        }
+        pos = parent_pos + pos * parent_rot;
+    }
+
+    pos_region = pos;
+    return pos_region.isFinite() && llfinite(radius);
+}
+
+// Objects in view go first, nearest first, then the objects nothing is known
+// about yet in the order they were missed, then the objects out of view.
+void LLViewerRegion::prioritizeCacheMisses()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+
+    constexpr F32 UNKNOWN_PRIORITY = 1.0e6f;
+    constexpr F32 OUT_OF_VIEW_PRIORITY = 2.0e6f;
+
+    const LLViewerCamera* camera = LLViewerCamera::getInstance();
+    const LLVector3 camera_origin = camera->getOrigin();
+    for (CacheMissItem& item : mCacheMissList)
+    {
+        if (!item.mHasPosition)
+        {
+            item.mPriority = UNKNOWN_PRIORITY;
+            continue;
+        }
+
+        const LLVector3 pos_agent = getPosAgentFromRegion(item.mPositionRegion);
+        const F32 distance = llmin(dist_vec(pos_agent, camera_origin), UNKNOWN_PRIORITY - 1.f);
+        item.mPriority = camera->sphereInFrustum(pos_agent, item.mRadius) ? distance : OUT_OF_VIEW_PRIORITY + distance;
+    }
+
+    // stable, misses of the same priority keep their order
+    mCacheMissList.sort(
+        [](const CacheMissItem& a, const CacheMissItem& b)
+        {
+            return a.mPriority < b.mPriority;
+        });
 }
 
+// How many objects go in one RequestMultipleObjects and how many of those
+// are sent at a time. A lost message holds up all of its objects until it is
+// resent, so they get smaller the more the circuit loses. The messages sent
+// each frame keep about FSCacheMissWindow of them in flight over a round
+// trip, the rest wait and are prioritized again with the next ones.
+void LLViewerRegion::getCacheMissBatching(S32& max_blocks, S32& max_messages)
+{
+    static LLCachedControl<U32> window(gSavedSettings, "FSCacheMissWindow", 8);
+
+    LLCircuitData* cdp = gMessageSystem->mCircuitInfo.findCircuit(mImpl->mHost);
+    if (!cdp)
+    {
+        return;
+    }
+
+    const F32 loss = (F32)cdp->getPacketsLost() / llmax((F32)cdp->getPacketsIn(), 1.f);
+    max_blocks = llclamp(ll_round(255.f * (1.f - loss * 10.f)), 32, 255);
+
+    const F32 rtt = llmax(cdp->getPingDelayAveraged().value() / 1000.f, 0.001f);
+    const F32 frame_time = llmax((F32)gFrameIntervalSeconds.value(), 0.001f);
+    max_messages = llmax(ll_round((F32)window * frame_time / rtt), 1);
+}
+// </FS>
+
 //check if a non-cacheable object is already created.
 bool LLViewerRegion::isNonCacheableObjectCreated(U32 local_id)
 {
@@ -3110,7 +3368,8 @@ bool LLViewerRegion::probeCache(U32 local_id, U32 crc, U32 flags, U8 &cache_miss
         {
             // LL_INFOS() << "CRC miss for " << local_id << LL_ENDL;
 
-            addCacheMiss(local_id, CACHE_MISS_TYPE_CRC);
+            //addCacheMiss(local_id, CACHE_MISS_TYPE_CRC);
+            addCacheMiss(local_id, CACHE_MISS_TYPE_CRC, entry); // <FS/> Prioritized cache misses
             cache_miss_type = CACHE_MISS_TYPE_CRC;
         }
     }
@@ -3140,8 +3399,23 @@ void LLViewerRegion::requestCacheMisses()
     bool start_new_message = true;
     S32 blocks = 0;
 
+    // <FS> Prioritized cache misses
+    static LLCachedControl<bool> prioritize(gSavedSettings, "FSPrioritizedCacheMisses", true);
+    S32 max_blocks = 255;
+    S32 max_messages = S32_MAX;
+    if (prioritize)
+    {
+        prioritizeCacheMisses();
+        getCacheMissBatching(max_blocks, max_messages);
+    }
+    S32 messages = 0;
+    S32 requested = 0;
+    CacheMissItem::cache_miss_list_t::iterator iter = mCacheMissList.begin();
+    // </FS>
+
     //send requests for all cache-missed objects
-    for (CacheMissItem::cache_miss_list_t::iterator iter = mCacheMissList.begin(); iter != mCacheMissList.end(); ++iter)
+    //for (CacheMissItem::cache_miss_list_t::iterator iter = mCacheMissList.begin(); iter != mCacheMissList.end(); ++iter)
+    for (; iter != mCacheMissList.end() && messages < max_messages; ++iter) // <FS/> Prioritized cache misses
     {
         if (start_new_message)
         {
@@ -3159,12 +3433,15 @@ void LLViewerRegion::requestCacheMisses()
         LL_DEBUGS("AnimatedObjects") << "Requesting cache missed object " << (*iter).mID << LL_ENDL;
 
         blocks++;
+        requested++; // <FS/> Prioritized cache misses
 
-        if (blocks >= 255)
+        //if (blocks >= 255)
+        if (blocks >= max_blocks) // <FS/> Prioritized cache misses
         {
             sendReliableMessage();
             start_new_message = true;
             blocks = 0;
+            messages++; // <FS/> Prioritized cache misses
         }
     }
 
@@ -3176,9 +3453,14 @@ void LLViewerRegion::requestCacheMisses()
 
     mCacheDirty = true ;
     // LL_INFOS() << "KILLDEBUG Sent cache miss full " << full_count << " crc " << crc_count << LL_ENDL;
-    LLViewerStatsRecorder::instance().requestCacheMissesEvent(static_cast<S32>(mCacheMissList.size()));
+    // <FS> Prioritized cache misses
+    //LLViewerStatsRecorder::instance().requestCacheMissesEvent(static_cast<S32>(mCacheMissList.size()));
+    //
+    //mCacheMissList.clear();
+    LLViewerStatsRecorder::instance().requestCacheMissesEvent(requested);
 
-    mCacheMissList.clear();
+    mCacheMissList.erase(mCacheMissList.begin(), iter);
+    // </FS>
 }
 
 void LLViewerRegion::dumpCache()
@@ -4073,6 +4355,17 @@ void LLViewerRegion::applyCacheMiscExtras(LLViewerObject* obj)
 
     U32 local_id = obj->getLocalID();
     auto iter = mImpl->mGLTFOverridesLLSD.find(local_id);
+    // <FS> Binary override cache
+    if (iter == mImpl->mGLTFOverridesLLSD.end())
+    {
+        // Decoded the first time its object shows up
+        LLGLTFOverrideCacheEntry entry;
+        if (mImpl->mGLTFOverrideBlobs.take(local_id, entry))
+        {
+            iter = mImpl->mGLTFOverridesLLSD.emplace(local_id, std::move(entry)).first;
+        }
+    }
+    // </FS>
     if (iter != mImpl->mGLTFOverridesLLSD.end())
     {
         // UUID can be inserted null, so backfill the UUID if it was left empty
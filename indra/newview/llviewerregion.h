@@ -118,6 +118,7 @@ public:
     // Call this after you have the region name and handle.
     void loadObjectCache();
     void saveObjectCache();
+    bool exportObjectCache(const std::string& filename) const; // <FS/> Scene capture, without clearing the entries
 
     void sendMessage(); // Send the current message to this region's simulator
     void sendReliableMessage(); // Send the current message to this region's simulator
@@ -452,6 +453,15 @@ public:
     bool isPaused() const {return mPaused;}
     S32  getLastUpdate() const {return mLastUpdate;}
 
+    // <FS> Region crossing preload
+    // Create the cached objects within radius of center_agent as if they
+    // were in view. Has to be set again every frame or it lapses, a radius
+    // of 0 clears it.
+    void setPreloadSphere(const LLVector3& center_agent, F32 radius);
+    // Roots of the cached objects in the preload sphere, nearest first
+    const std::vector<LLPointer<LLVOCacheEntry> >& getPreloadEntries() const;
+    // </FS>
+
     std::string getSimHostName();
 
     static bool isNewObjectCreationThrottleDisabled() {return sNewObjectCreationThrottle < 0;}
@@ -468,8 +478,15 @@ private:
     void killInvisibleObjects(F32 max_time);
     void createVisibleObjects(F32 max_time);
     void updateVisibleEntries(F32 max_time); //update visible entries
-
-    void addCacheMiss(U32 id, LLViewerRegion::eCacheMissType miss_type);
+    void updatePreloadEntries(F32 projection_threshold); // <FS/> Region crossing preload
+
+    // <FS> Prioritized cache misses
+    //void addCacheMiss(U32 id, LLViewerRegion::eCacheMissType miss_type);
+    void addCacheMiss(U32 id, LLViewerRegion::eCacheMissType miss_type, LLVOCacheEntry* entry = NULL);
+    bool getCachedExtents(LLVOCacheEntry* entry, LLVector3& pos_region, F32& radius);
+    void prioritizeCacheMisses();
+    void getCacheMissBatching(S32& max_blocks, S32& max_messages);
+    // </FS>
     void decodeBoundingInfo(LLVOCacheEntry* entry);
     bool isNonCacheableObjectCreated(U32 local_id);
 
@@ -637,6 +654,13 @@ public:
         U32                         mID;     //local object id
         LLViewerRegion::eCacheMissType  mType;  // cache miss type
 
+        // <FS> Prioritized cache misses
+        LLVector3                   mPositionRegion;        // of the cached copy, for CRC misses
+        F32                         mRadius = 0.f;
+        bool                        mHasPosition = false;
+        F32                         mPriority = 0.f;        // lower goes first
+        // </FS>
+
         typedef std::list<CacheMissItem> cache_miss_list_t;
     };
     CacheMissItem::cache_miss_list_t   mCacheMissList;
@@ -81,6 +81,11 @@ S32 clamp_terrain_mapping(S32 mapping)
 LLGLSLShader    gOcclusionProgram;
 LLGLSLShader    gSkinnedOcclusionProgram;
 LLGLSLShader    gOcclusionCubeProgram;
+LLGLSLShader    gHiZDownsampleProgram;  // <FS/> Hi-Z occlusion
+LLGLSLShader    gHiZOcclusionProgram;   // <FS/> Hi-Z occlusion
+LLGLSLShader    gHUDCacheTransmittanceProgram;  // <FS/> HUD cache
+LLGLSLShader    gHUDCacheColorProgram;  // <FS/> HUD cache
+LLGLSLShader    gEquirectProgram;       // <FS/> 360 snapshot conversion
 LLGLSLShader    gGlowCombineProgram;
 LLGLSLShader    gReflectionMipProgram;
 LLGLSLShader    gGaussianProgram;
@@ -152,6 +157,8 @@ LLGLSLShader            gDeferredBumpProgram;
 LLGLSLShader            gDeferredTerrainProgram;
 LLGLSLShader            gDeferredTreeProgram;
 LLGLSLShader            gDeferredTreeShadowProgram;
+LLGLSLShader            gDeferredTreeInstancedProgram;          // <FS/> Tree instancing
+LLGLSLShader            gDeferredTreeShadowInstancedProgram;    // <FS/> Tree instancing
 LLGLSLShader            gDeferredSkinnedTreeShadowProgram;
 LLGLSLShader            gDeferredAvatarProgram;
 LLGLSLShader            gDeferredAvatarAlphaProgram;
@@ -159,6 +166,7 @@ LLGLSLShader            gDeferredLightProgram;
 LLGLSLShader            gDeferredMultiLightProgram[16];
 LLGLSLShader            gDeferredSpotLightProgram;
 LLGLSLShader            gDeferredMultiSpotLightProgram;
+LLGLSLShader            gDeferredClusteredLightProgram; // <FS/> Clustered lighting
 LLGLSLShader            gDeferredSunProgram;
 LLGLSLShader            gDeferredSunProbeProgram;
 LLGLSLShader            gHazeProgram;
@@ -166,6 +174,8 @@ LLGLSLShader            gHazeWaterProgram;
 LLGLSLShader            gDeferredBlurLightProgram;
 LLGLSLShader            gDeferredSoftenProgram;
 LLGLSLShader            gDeferredShadowProgram;
+LLGLSLShader            gDeferredShadowInstancedProgram;    // <FS/> Mesh instancing
+LLGLSLShader            gDeferredShadowSkinTransformProgram;    // <FS/> Pre-skinned shadows
 LLGLSLShader            gDeferredSkinnedShadowProgram;
 LLGLSLShader            gDeferredShadowCubeProgram;
 LLGLSLShader            gDeferredShadowAlphaMaskProgram;
@@ -208,6 +218,9 @@ LLGLSLShader            gSMAAEdgeDetectProgram[4];
 LLGLSLShader            gSMAABlendWeightsProgram[4];
 LLGLSLShader            gSMAANeighborhoodBlendProgram[4];
 LLGLSLShader            gCASProgram;
+LLGLSLShader            gCASUpscaleProgram; // <FS/> Dynamic resolution
+LLGLSLShader            gFusedTonemapGammaProgram; // <FS/> Fused post processing
+LLGLSLShader            gFusedCASTonemapGammaProgram; // <FS/> Fused post processing
 LLGLSLShader            gDeferredPostNoDoFProgram;
 LLGLSLShader            gDeferredPostNoDoFNoiseProgram;
 LLGLSLShader            gDeferredWLSkyProgram;
@@ -235,6 +248,7 @@ LLGLSLShader            gHUDPBROpaqueProgram;
 LLGLSLShader            gPBRGlowProgram;
 LLGLSLShader            gPBRGlowSkinnedProgram;
 LLGLSLShader            gDeferredPBROpaqueProgram;
+LLGLSLShader            gDeferredPBROpaqueInstancedProgram; // <FS/> Mesh instancing
 LLGLSLShader            gDeferredSkinnedPBROpaqueProgram;
 LLGLSLShader            gHUDPBRAlphaProgram;
 LLGLSLShader            gDeferredPBRAlphaProgram;
@@ -451,9 +465,12 @@ void LLViewerShaderMgr::finalizeShaderList()
     mShaderList.push_back(&gNoPostTonemapProgram);
     mShaderList.push_back(&gDeferredPostGammaCorrectProgram); // for gamma
     mShaderList.push_back(&gLegacyPostGammaCorrectProgram);
+    mShaderList.push_back(&gFusedTonemapGammaProgram); // <FS/> Fused post processing
+    mShaderList.push_back(&gFusedCASTonemapGammaProgram); // <FS/> Fused post processing
     mShaderList.push_back(&gDeferredDiffuseProgram);
     mShaderList.push_back(&gDeferredBumpProgram);
     mShaderList.push_back(&gDeferredPBROpaqueProgram);
+    mShaderList.push_back(&gDeferredPBROpaqueInstancedProgram); // <FS/> Mesh instancing
 
     if (gSavedSettings.getBOOL("GLTFEnabled"))
     {
@@ -471,6 +488,7 @@ void LLViewerShaderMgr::finalizeShaderList()
     mShaderList.push_back(&gDeferredDiffuseAlphaMaskProgram);
     mShaderList.push_back(&gDeferredNonIndexedDiffuseAlphaMaskProgram);
     mShaderList.push_back(&gDeferredTreeProgram);
+    mShaderList.push_back(&gDeferredTreeInstancedProgram); // <FS/> Tree instancing
 
     // make sure there are no redundancies
     llassert(no_redundant_shaders(mShaderList));
@@ -640,7 +658,21 @@ void LLViewerShaderMgr::setShaders()
 
     gPipeline.mShadersLoaded = true;
 
-    bool loaded = loadShadersWater();
+    // <FS> Parallel shader compile, the programs of a group compile and link together
+    static LLCachedControl<bool> parallel_shader_compile(gSavedSettings, "FSParallelShaderCompile", true);
+    auto load_group = [this](bool (LLViewerShaderMgr::*load_shaders)())
+    {
+        if (parallel_shader_compile)
+        {
+            LLGLSLShader::beginDeferredLink();
+        }
+        bool group_loaded = (this->*load_shaders)();
+        return LLGLSLShader::finishDeferredLink() && group_loaded;
+    };
+
+    //bool loaded = loadShadersWater();
+    bool loaded = load_group(&LLViewerShaderMgr::loadShadersWater);
+    // </FS>
 
     if (loaded)
     {
@@ -654,7 +686,10 @@ void LLViewerShaderMgr::setShaders()
 
     if (loaded)
     {
-        loaded = loadShadersEffects();
+        // <FS> Parallel shader compile
+        //loaded = loadShadersEffects();
+        loaded = load_group(&LLViewerShaderMgr::loadShadersEffects);
+        // </FS>
         if (loaded)
         {
             LL_INFOS() << "Loaded effects shaders." << LL_ENDL;
@@ -668,7 +703,10 @@ void LLViewerShaderMgr::setShaders()
 
     if (loaded)
     {
-        loaded = loadShadersInterface();
+        // <FS> Parallel shader compile
+        //loaded = loadShadersInterface();
+        loaded = load_group(&LLViewerShaderMgr::loadShadersInterface);
+        // </FS>
         if (loaded)
         {
             LL_INFOS() << "Loaded interface shaders." << LL_ENDL;
@@ -686,7 +724,10 @@ void LLViewerShaderMgr::setShaders()
         mShaderLevel[SHADER_AVATAR] = 3;
         mMaxAvatarShaderLevel = 3;
 
-        if (loadShadersObject())
+        // <FS> Parallel shader compile
+        //if (loadShadersObject())
+        if (load_group(&LLViewerShaderMgr::loadShadersObject))
+        // </FS>
         { //hardware skinning is enabled and rigged attachment shaders loaded correctly
             // cloth is a class3 shader
             S32 avatar_class = 1;
@@ -694,7 +735,10 @@ void LLViewerShaderMgr::setShaders()
             // Set the actual level
             mShaderLevel[SHADER_AVATAR] = avatar_class;
 
-            loaded = loadShadersAvatar();
+            // <FS> Parallel shader compile
+            //loaded = loadShadersAvatar();
+            loaded = load_group(&LLViewerShaderMgr::loadShadersAvatar);
+            // </FS>
             llassert(loaded);
         }
         else
@@ -704,7 +748,10 @@ void LLViewerShaderMgr::setShaders()
     }
 
     llassert(loaded);
-    loaded = loaded && loadShadersDeferred();
+    // <FS> Parallel shader compile
+    //loaded = loaded && loadShadersDeferred();
+    loaded = loaded && load_group(&LLViewerShaderMgr::loadShadersDeferred);
+    // </FS>
     llassert(loaded);
 
     persistShaderCacheMetadata();
@@ -1110,6 +1157,8 @@ bool LLViewerShaderMgr::loadShadersDeferred()
     {
         gDeferredTreeProgram.unload();
         gDeferredTreeShadowProgram.unload();
+        gDeferredTreeInstancedProgram.unload();         // <FS/> Tree instancing
+        gDeferredTreeShadowInstancedProgram.unload();   // <FS/> Tree instancing
         gDeferredSkinnedTreeShadowProgram.unload();
         gDeferredDiffuseProgram.unload();
         gDeferredSkinnedDiffuseProgram.unload();
@@ -1128,10 +1177,13 @@ bool LLViewerShaderMgr::loadShadersDeferred()
         }
         gDeferredSpotLightProgram.unload();
         gDeferredMultiSpotLightProgram.unload();
+        gDeferredClusteredLightProgram.unload(); // <FS/> Clustered lighting
         gDeferredSunProgram.unload();
         gDeferredBlurLightProgram.unload();
         gDeferredSoftenProgram.unload();
         gDeferredShadowProgram.unload();
+        gDeferredShadowInstancedProgram.unload();    // <FS/> Mesh instancing
+        gDeferredShadowSkinTransformProgram.unload();    // <FS/> Pre-skinned shadows
         gDeferredSkinnedShadowProgram.unload();
         gDeferredShadowCubeProgram.unload();
         gDeferredShadowAlphaMaskProgram.unload();
@@ -1175,6 +1227,9 @@ bool LLViewerShaderMgr::loadShadersDeferred()
             gSMAANeighborhoodBlendProgram[i].unload();
         }
         gCASProgram.unload();
+        gCASUpscaleProgram.unload(); // <FS/> Dynamic resolution
+        gFusedTonemapGammaProgram.unload(); // <FS/> Fused post processing
+        gFusedCASTonemapGammaProgram.unload(); // <FS/> Fused post processing
         gEnvironmentMapProgram.unload();
         gDeferredWLSkyProgram.unload();
         gDeferredWLCloudProgram.unload();
@@ -1202,6 +1257,7 @@ bool LLViewerShaderMgr::loadShadersDeferred()
         gHUDPBROpaqueProgram.unload();
         gPBRGlowProgram.unload();
         gDeferredPBROpaqueProgram.unload();
+        gDeferredPBROpaqueInstancedProgram.unload(); // <FS/> Mesh instancing
         gGLTFPBRMetallicRoughnessProgram.unload();
         gDeferredSkinnedPBROpaqueProgram.unload();
         gDeferredPBRAlphaProgram.unload();
@@ -1408,6 +1464,27 @@ bool LLViewerShaderMgr::loadShadersDeferred()
         llassert(success);
     }
 
+    // <FS> Mesh instancing
+    if (success)
+    {
+        gDeferredPBROpaqueInstancedProgram.mName = "Deferred PBR Opaque Instanced Shader";
+        gDeferredPBROpaqueInstancedProgram.mFeatures.hasSrgb = true;
+
+        gDeferredPBROpaqueInstancedProgram.mShaderFiles.clear();
+        gDeferredPBROpaqueInstancedProgram.mShaderFiles.push_back(make_pair("deferred/pbropaqueV.glsl", GL_VERTEX_SHADER));
+        gDeferredPBROpaqueInstancedProgram.mShaderFiles.push_back(make_pair("deferred/pbropaqueF.glsl", GL_FRAGMENT_SHADER));
+        gDeferredPBROpaqueInstancedProgram.mShaderLevel = mShaderLevel[SHADER_DEFERRED];
+        gDeferredPBROpaqueInstancedProgram.clearPermutations();
+
+        add_common_permutations(&gDeferredPBROpaqueInstancedProgram);
+        gDeferredPBROpaqueInstancedProgram.addPermutation("INSTANCED", "1");
+        gDeferredPBROpaqueInstancedProgram.addPermutation("MAX_UBO_VEC4S", std::to_string(gGLManager.mMaxUniformBlockSize / 16));
+
+        success = gDeferredPBROpaqueInstancedProgram.createShader();
+        llassert(success);
+    }
+    // </FS>
+
     if (gSavedSettings.getBOOL("GLTFEnabled"))
     {
         if (success)
@@ -1608,6 +1685,38 @@ bool LLViewerShaderMgr::loadShadersDeferred()
         llassert(success);
     }
 
+    // <FS> Tree instancing
+    if (success)
+    {
+        gDeferredTreeInstancedProgram.mName = "Deferred Tree Instanced Shader";
+        gDeferredTreeInstancedProgram.mShaderFiles.clear();
+        gDeferredTreeInstancedProgram.mShaderFiles.push_back(make_pair("deferred/treeV.glsl", GL_VERTEX_SHADER));
+        gDeferredTreeInstancedProgram.mShaderFiles.push_back(make_pair("deferred/treeF.glsl", GL_FRAGMENT_SHADER));
+        gDeferredTreeInstancedProgram.mShaderLevel = mShaderLevel[SHADER_DEFERRED];
+        gDeferredTreeInstancedProgram.clearPermutations();
+
+        add_common_permutations(&gDeferredTreeInstancedProgram);
+        gDeferredTreeInstancedProgram.addPermutation("INSTANCED", "1");
+        gDeferredTreeInstancedProgram.addPermutation("MAX_UBO_VEC4S", std::to_string(gGLManager.mMaxUniformBlockSize / 16));
+
+        success = gDeferredTreeInstancedProgram.createShader();
+    }
+
+    if (success)
+    {
+        gDeferredTreeShadowInstancedProgram.mName = "Deferred Tree Shadow Instanced Shader";
+        gDeferredTreeShadowInstancedProgram.mShaderFiles.clear();
+        gDeferredTreeShadowInstancedProgram.mShaderFiles.push_back(make_pair("deferred/treeShadowV.glsl", GL_VERTEX_SHADER));
+        gDeferredTreeShadowInstancedProgram.mShaderFiles.push_back(make_pair("deferred/treeShadowF.glsl", GL_FRAGMENT_SHADER));
+        gDeferredTreeShadowInstancedProgram.mShaderLevel = mShaderLevel[SHADER_DEFERRED];
+        gDeferredTreeShadowInstancedProgram.clearPermutations();
+        gDeferredTreeShadowInstancedProgram.addPermutation("INSTANCED", "1");
+        gDeferredTreeShadowInstancedProgram.addPermutation("MAX_UBO_VEC4S", std::to_string(gGLManager.mMaxUniformBlockSize / 16));
+        success = gDeferredTreeShadowInstancedProgram.createShader();
+        llassert(success);
+    }
+    // </FS>
+
     if (success)
     {
         gDeferredSkinnedTreeShadowProgram.mName = "Deferred Skinned Tree Shadow Shader";
@@ -1680,6 +1789,32 @@ bool LLViewerShaderMgr::loadShadersDeferred()
         }
     }
 
+    // <FS> Clustered lighting
+    if (success)
+    {
+        gDeferredClusteredLightProgram.mName = "Deferred Clustered Light Shader";
+        gDeferredClusteredLightProgram.mFeatures.isDeferred = true;
+        gDeferredClusteredLightProgram.mFeatures.hasFullGBuffer = true;
+        gDeferredClusteredLightProgram.mFeatures.hasShadows = true;
+        gDeferredClusteredLightProgram.mFeatures.hasSrgb = true;
+
+        gDeferredClusteredLightProgram.clearPermutations();
+        gDeferredClusteredLightProgram.mShaderFiles.clear();
+        gDeferredClusteredLightProgram.mShaderFiles.push_back(make_pair("deferred/multiPointLightV.glsl", GL_VERTEX_SHADER));
+        gDeferredClusteredLightProgram.mShaderFiles.push_back(make_pair("deferred/clusteredLightF.glsl", GL_FRAGMENT_SHADER));
+        gDeferredClusteredLightProgram.mShaderLevel = mShaderLevel[SHADER_DEFERRED];
+        gDeferredClusteredLightProgram.addPermutation("CLUSTER_TILES_X", std::to_string(FSClusteredLights::TILES_X));
+        gDeferredClusteredLightProgram.addPermutation("CLUSTER_TILES_Y", std::to_string(FSClusteredLights::TILES_Y));
+        gDeferredClusteredLightProgram.addPermutation("CLUSTER_SLICES", std::to_string(FSClusteredLights::SLICES));
+        gDeferredClusteredLightProgram.addPermutation("CLUSTER_TEXTURE_WIDTH", std::to_string(FSClusteredLights::CLUSTER_TEXTURE_WIDTH));
+
+        add_common_permutations(&gDeferredClusteredLightProgram);
+
+        success = gDeferredClusteredLightProgram.createShader();
+        llassert(success);
+    }
+    // </FS>
+
     if (success)
     {
         gDeferredSpotLightProgram.mName = "Deferred SpotLight Shader";
@@ -2230,6 +2365,22 @@ bool LLViewerShaderMgr::loadShadersDeferred()
         llassert(success);
     }
 
+    // <FS> Mesh instancing
+    if (success)
+    {
+        gDeferredShadowInstancedProgram.mName = "Deferred Shadow Instanced Shader";
+        gDeferredShadowInstancedProgram.mShaderFiles.clear();
+        gDeferredShadowInstancedProgram.mShaderFiles.push_back(make_pair("deferred/shadowV.glsl", GL_VERTEX_SHADER));
+        gDeferredShadowInstancedProgram.mShaderFiles.push_back(make_pair("deferred/shadowF.glsl", GL_FRAGMENT_SHADER));
+        gDeferredShadowInstancedProgram.mShaderLevel = mShaderLevel[SHADER_DEFERRED];
+        gDeferredShadowInstancedProgram.clearPermutations();
+        gDeferredShadowInstancedProgram.addPermutation("INSTANCED", "1");
+        gDeferredShadowInstancedProgram.addPermutation("MAX_UBO_VEC4S", std::to_string(gGLManager.mMaxUniformBlockSize / 16));
+        success = gDeferredShadowInstancedProgram.createShader();
+        llassert(success);
+    }
+    // </FS>
+
     if (success)
     {
         gDeferredSkinnedShadowProgram.mName = "Deferred Skinned Shadow Shader";
@@ -2248,6 +2399,21 @@ bool LLViewerShaderMgr::loadShadersDeferred()
         llassert(success);
     }
 
+    // <FS> Pre-skinned shadows
+    if (success)
+    {
+        gDeferredShadowSkinTransformProgram.mName = "Deferred Shadow Skin Transform Shader";
+        gDeferredShadowSkinTransformProgram.mFeatures.hasObjectSkinning = true;
+        gDeferredShadowSkinTransformProgram.mShaderFiles.clear();
+        gDeferredShadowSkinTransformProgram.mShaderFiles.push_back(make_pair("deferred/shadowSkinTransformV.glsl", GL_VERTEX_SHADER));
+        gDeferredShadowSkinTransformProgram.mShaderFiles.push_back(make_pair("deferred/shadowF.glsl", GL_FRAGMENT_SHADER)); // never runs, the rasterizer is off
+        gDeferredShadowSkinTransformProgram.mShaderLevel = mShaderLevel[SHADER_DEFERRED];
+        gDeferredShadowSkinTransformProgram.mFeedbackVaryings.assign(1, "skinned_position");
+        success = gDeferredShadowSkinTransformProgram.createShader();
+        llassert(success);
+    }
+    // </FS>
+
     if (success)
     {
         gDeferredShadowCubeProgram.mName = "Deferred Shadow Cube Shader";
@@ -2721,6 +2887,70 @@ bool LLViewerShaderMgr::loadShadersDeferred()
         }
     }
 
+    // <FS> Dynamic resolution
+    if (success && gGLManager.mGLVersion > 4.05f)
+    {
+        gCASUpscaleProgram.mName = "Contrast Adaptive Sharpening Upscale Shader";
+        gCASUpscaleProgram.mFeatures.hasSrgb = true;
+        gCASUpscaleProgram.mShaderFiles.clear();
+        gCASUpscaleProgram.mShaderFiles.push_back(make_pair("deferred/postDeferredNoTCV.glsl", GL_VERTEX_SHADER));
+        gCASUpscaleProgram.mShaderFiles.push_back(make_pair("deferred/CASF.glsl", GL_FRAGMENT_SHADER));
+        gCASUpscaleProgram.mShaderLevel = mShaderLevel[SHADER_DEFERRED];
+        gCASUpscaleProgram.clearPermutations();
+        gCASUpscaleProgram.addPermutation("CAS_UPSCALE", "1");
+        success = gCASUpscaleProgram.createShader();
+        if (!success)
+        {
+            LL_WARNS() << "Failed to create shader '" << gCASUpscaleProgram.mName << "', disabling!" << LL_ENDL;
+            // upscaling falls back to copyRenderTarget
+            success = true;
+        }
+    }
+    // </FS>
+
+    // <FS> Fused post processing
+    if (success)
+    {
+        gFusedTonemapGammaProgram.mName = "Fused Tonemap Gamma Correction Post Process";
+        gFusedTonemapGammaProgram.mFeatures.hasSrgb = true;
+        gFusedTonemapGammaProgram.mFeatures.isDeferred = true;
+        gFusedTonemapGammaProgram.mShaderFiles.clear();
+        gFusedTonemapGammaProgram.clearPermutations();
+        gFusedTonemapGammaProgram.addPermutation("FUSED_GAMMA", "1");
+        gFusedTonemapGammaProgram.mShaderFiles.push_back(make_pair("deferred/postDeferredNoTCV.glsl", GL_VERTEX_SHADER));
+        gFusedTonemapGammaProgram.mShaderFiles.push_back(make_pair("deferred/postDeferredTonemap.glsl", GL_FRAGMENT_SHADER));
+        gFusedTonemapGammaProgram.mShaderLevel = mShaderLevel[SHADER_DEFERRED];
+        success = gFusedTonemapGammaProgram.createShader();
+        if (!success)
+        {
+            LL_WARNS() << "Failed to create shader '" << gFusedTonemapGammaProgram.mName << "', disabling!" << LL_ENDL;
+            // the separate passes are used instead
+            success = true;
+        }
+    }
+
+    if (success && gGLManager.mGLVersion > 4.05f)
+    {
+        gFusedCASTonemapGammaProgram.mName = "Fused Sharpening Tonemap Gamma Correction Post Process";
+        gFusedCASTonemapGammaProgram.mFeatures.hasSrgb = true;
+        gFusedCASTonemapGammaProgram.mFeatures.isDeferred = true;
+        gFusedCASTonemapGammaProgram.mShaderFiles.clear();
+        gFusedCASTonemapGammaProgram.clearPermutations();
+        gFusedCASTonemapGammaProgram.addPermutation("FUSED_TONEMAP", "1");
+        gFusedCASTonemapGammaProgram.mShaderFiles.push_back(make_pair("deferred/postDeferredNoTCV.glsl", GL_VERTEX_SHADER));
+        gFusedCASTonemapGammaProgram.mShaderFiles.push_back(make_pair("deferred/CASF.glsl", GL_FRAGMENT_SHADER));
+        gFusedCASTonemapGammaProgram.mShaderFiles.push_back(make_pair("deferred/postDeferredTonemap.glsl", GL_FRAGMENT_SHADER));
+        gFusedCASTonemapGammaProgram.mShaderLevel = mShaderLevel[SHADER_DEFERRED];
+        success = gFusedCASTonemapGammaProgram.createShader();
+        if (!success)
+        {
+            LL_WARNS() << "Failed to create shader '" << gFusedCASTonemapGammaProgram.mName << "', disabling!" << LL_ENDL;
+            // the separate passes are used instead
+            success = true;
+        }
+    }
+    // </FS>
+
     if (success)
     {
         gDeferredPostProgram.mName = "Deferred Post Shader";
@@ -3300,6 +3530,64 @@ bool LLViewerShaderMgr::loadShadersInterface()
         success = gOcclusionCubeProgram.createShader();
     }
 
+    // <FS> Hi-Z occlusion
+    if (success)
+    {
+        gHiZDownsampleProgram.mName = "Hi-Z Downsample Shader";
+        gHiZDownsampleProgram.mShaderFiles.clear();
+        gHiZDownsampleProgram.mShaderFiles.push_back(make_pair("interface/copyV.glsl", GL_VERTEX_SHADER));
+        gHiZDownsampleProgram.mShaderFiles.push_back(make_pair("interface/hizDownsampleF.glsl", GL_FRAGMENT_SHADER));
+        gHiZDownsampleProgram.mShaderLevel = mShaderLevel[SHADER_INTERFACE];
+        success = gHiZDownsampleProgram.createShader();
+    }
+
+    if (success)
+    {
+        gHiZOcclusionProgram.mName = "Hi-Z Occlusion Shader";
+        gHiZOcclusionProgram.mShaderFiles.clear();
+        gHiZOcclusionProgram.mShaderFiles.push_back(make_pair("interface/hizOcclusionV.glsl", GL_VERTEX_SHADER));
+        gHiZOcclusionProgram.mShaderFiles.push_back(make_pair("interface/hizOcclusionF.glsl", GL_FRAGMENT_SHADER));
+        gHiZOcclusionProgram.mShaderLevel = mShaderLevel[SHADER_INTERFACE];
+        success = gHiZOcclusionProgram.createShader();
+    }
+    // </FS>
+
+    // <FS> HUD cache
+    if (success)
+    {
+        gHUDCacheTransmittanceProgram.mName = "HUD Cache Transmittance Shader";
+        gHUDCacheTransmittanceProgram.mShaderFiles.clear();
+        gHUDCacheTransmittanceProgram.mShaderFiles.push_back(make_pair("interface/copyV.glsl", GL_VERTEX_SHADER));
+        gHUDCacheTransmittanceProgram.mShaderFiles.push_back(make_pair("interface/hudCacheF.glsl", GL_FRAGMENT_SHADER));
+        gHUDCacheTransmittanceProgram.clearPermutations();
+        gHUDCacheTransmittanceProgram.addPermutation("TRANSMITTANCE", "1");
+        gHUDCacheTransmittanceProgram.mShaderLevel = mShaderLevel[SHADER_INTERFACE];
+        success = gHUDCacheTransmittanceProgram.createShader();
+    }
+
+    if (success)
+    {
+        gHUDCacheColorProgram.mName = "HUD Cache Color Shader";
+        gHUDCacheColorProgram.mShaderFiles.clear();
+        gHUDCacheColorProgram.mShaderFiles.push_back(make_pair("interface/copyV.glsl", GL_VERTEX_SHADER));
+        gHUDCacheColorProgram.mShaderFiles.push_back(make_pair("interface/hudCacheF.glsl", GL_FRAGMENT_SHADER));
+        gHUDCacheColorProgram.mShaderLevel = mShaderLevel[SHADER_INTERFACE];
+        success = gHUDCacheColorProgram.createShader();
+    }
+    // </FS>
+
+    // <FS> 360 snapshot conversion
+    if (success)
+    {
+        gEquirectProgram.mName = "Equirectangular Conversion Shader";
+        gEquirectProgram.mShaderFiles.clear();
+        gEquirectProgram.mShaderFiles.push_back(make_pair("interface/copyV.glsl", GL_VERTEX_SHADER));
+        gEquirectProgram.mShaderFiles.push_back(make_pair("interface/equirectF.glsl", GL_FRAGMENT_SHADER));
+        gEquirectProgram.mShaderLevel = mShaderLevel[SHADER_INTERFACE];
+        success = gEquirectProgram.createShader();
+    }
+    // </FS>
+
     if (success)
     {
         gDebugProgram.mName = "Debug Shader";
@@ -153,6 +153,11 @@ extern LLVector4            gShinyOrigin;
 //utility shaders
 extern LLGLSLShader         gOcclusionProgram;
 extern LLGLSLShader         gOcclusionCubeProgram;
+extern LLGLSLShader         gHiZDownsampleProgram;  // <FS/> Hi-Z occlusion
+extern LLGLSLShader         gHiZOcclusionProgram;   // <FS/> Hi-Z occlusion
+extern LLGLSLShader         gHUDCacheTransmittanceProgram;  // <FS/> HUD cache
+extern LLGLSLShader         gHUDCacheColorProgram;  // <FS/> HUD cache
+extern LLGLSLShader         gEquirectProgram;       // <FS/> 360 snapshot conversion
 extern LLGLSLShader         gGlowCombineProgram;
 extern LLGLSLShader         gReflectionMipProgram;
 extern LLGLSLShader         gGaussianProgram;
@@ -227,10 +232,13 @@ extern LLGLSLShader         gDeferredBumpProgram;
 extern LLGLSLShader         gDeferredTerrainProgram;
 extern LLGLSLShader         gDeferredTreeProgram;
 extern LLGLSLShader         gDeferredTreeShadowProgram;
+extern LLGLSLShader         gDeferredTreeInstancedProgram;          // <FS/> Tree instancing
+extern LLGLSLShader         gDeferredTreeShadowInstancedProgram;    // <FS/> Tree instancing
 extern LLGLSLShader         gDeferredLightProgram;
 extern LLGLSLShader         gDeferredMultiLightProgram[LL_DEFERRED_MULTI_LIGHT_COUNT];
 extern LLGLSLShader         gDeferredSpotLightProgram;
 extern LLGLSLShader         gDeferredMultiSpotLightProgram;
+extern LLGLSLShader         gDeferredClusteredLightProgram; // <FS/> Clustered lighting
 extern LLGLSLShader         gDeferredSunProgram;
 extern LLGLSLShader         gDeferredSunProbeProgram;
 extern LLGLSLShader         gHazeProgram;
@@ -239,6 +247,8 @@ extern LLGLSLShader         gDeferredBlurLightProgram;
 extern LLGLSLShader         gDeferredAvatarProgram;
 extern LLGLSLShader         gDeferredSoftenProgram;
 extern LLGLSLShader         gDeferredShadowProgram;
+extern LLGLSLShader         gDeferredShadowInstancedProgram;    // <FS/> Mesh instancing
+extern LLGLSLShader         gDeferredShadowSkinTransformProgram;    // <FS/> Pre-skinned shadows
 extern LLGLSLShader         gDeferredShadowCubeProgram;
 extern LLGLSLShader         gDeferredShadowAlphaMaskProgram;
 extern LLGLSLShader         gDeferredShadowGLTFAlphaMaskProgram;
@@ -252,6 +262,9 @@ extern LLGLSLShader         gSMAAEdgeDetectProgram[4];
 extern LLGLSLShader         gSMAABlendWeightsProgram[4];
 extern LLGLSLShader         gSMAANeighborhoodBlendProgram[4];
 extern LLGLSLShader         gCASProgram;
+extern LLGLSLShader         gCASUpscaleProgram; // <FS/> Dynamic resolution
+extern LLGLSLShader         gFusedTonemapGammaProgram; // <FS/> Fused post processing
+extern LLGLSLShader         gFusedCASTonemapGammaProgram; // <FS/> Fused post processing
 extern LLGLSLShader         gDeferredPostNoDoFProgram;
 extern LLGLSLShader         gDeferredPostNoDoFNoiseProgram;
 extern LLGLSLShader         gDeferredPostGammaCorrectProgram;
@@ -297,6 +310,7 @@ extern LLGLSLShader         gDeferredMaterialProgram[LLMaterial::SHADER_COUNT*2]
 extern LLGLSLShader         gHUDPBROpaqueProgram;
 extern LLGLSLShader         gPBRGlowProgram;
 extern LLGLSLShader         gDeferredPBROpaqueProgram;
+extern LLGLSLShader         gDeferredPBROpaqueInstancedProgram; // <FS/> Mesh instancing
 extern LLGLSLShader         gDeferredPBRAlphaProgram;
 extern LLGLSLShader         gHUDPBRAlphaProgram;
 
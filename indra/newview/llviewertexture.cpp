@@ -351,6 +351,14 @@ LLViewerFetchedTexture* LLViewerTextureManager::getFetchedTextureFromMemory(cons
     return gTextureList.getImageFromMemory(data, size, mimetype);
 }
 
+// <FS> GLTF parallel image decode
+//static
+LLViewerFetchedTexture* LLViewerTextureManager::getFetchedTextureFromRaw(LLImageRaw* raw_image)
+{
+    return gTextureList.getImageFromRaw(raw_image);
+}
+// </FS>
+
 LLViewerFetchedTexture* LLViewerTextureManager::getFetchedTextureFromHost(const LLUUID& image_id, FTType f_type, LLHost host)
 {
     return gTextureList.getImageFromHost(image_id, f_type, host);
@@ -760,6 +768,14 @@ void LLViewerTexture::setBoostLevel(S32 level)
         {
             setNoDelete();
         }
+
+        // <FS> VRAM accounting: the texture memory follows the boost level,
+        // categories past the boost levels like media stay what they are
+        if (mGLTexturep && mGLTexturep->getCategory() < LLViewerTexture::BOOST_MAX_LEVEL)
+        {
+            mGLTexturep->setCategory(level);
+        }
+        // </FS>
     }
 
     // strongly encourage anything boosted to load at full res
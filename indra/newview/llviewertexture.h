@@ -443,6 +443,7 @@ public:
 
     bool mCreatePending = false;    // if true, this is in gTextureList.mCreateTextureList
     mutable bool mDownScalePending = false; // if true, this is in gTextureList.mDownScaleQueue
+    bool mUrgentPending = false;    // if true, this is in gTextureList.mUrgentQueue
 
     // <FS:Techwolf Lupindo> texture comment decoder
     std::map<std::string,std::string> mComment;
@@ -727,6 +728,11 @@ public:
     // WARNING: caller is responsible for deleting the returned image
     static LLViewerFetchedTexture* getFetchedTextureFromMemory(const U8* data, U32 size, std::string_view mimetype);
 
+    // <FS> GLTF parallel image decode
+    // texture from an image that was already decoded, e.g. on a worker thread
+    static LLViewerFetchedTexture* getFetchedTextureFromRaw(LLImageRaw* raw_image);
+    // </FS>
+
     static void init() ;
     static void cleanup() ;
 };
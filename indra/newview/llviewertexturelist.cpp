@@ -363,6 +363,11 @@ void LLViewerTextureList::shutdown()
         mCreateTextureList.front()->mCreatePending = false;
         mCreateTextureList.pop();
     }
+    for (UrgentEntry& entry : mUrgentQueue)
+    {
+        entry.mImage->mUrgentPending = false;
+    }
+    mUrgentQueue.clear();
     mFastCacheList.clear();
 
     mUUIDMap.clear();
@@ -541,19 +546,37 @@ LLImageRaw* LLViewerTextureList::getRawImageFromMemory(const U8* data, U32 size,
 LLViewerFetchedTexture* LLViewerTextureList::getImageFromMemory(const U8* data, U32 size, std::string_view mimetype)
 {
     LLPointer<LLImageRaw> raw_image = getRawImageFromMemory(data, size, mimetype);
-    if (raw_image.notNull())
-    {
-        LLViewerFetchedTexture* imagep = new LLViewerFetchedTexture(raw_image, FTT_LOCAL_FILE, true);
-        addImage(imagep, TEX_LIST_STANDARD);
+    // <FS> GLTF parallel image decode
+    //if (raw_image.notNull())
+    //{
+    //    LLViewerFetchedTexture* imagep = new LLViewerFetchedTexture(raw_image, FTT_LOCAL_FILE, true);
+    //    addImage(imagep, TEX_LIST_STANDARD);
+    //
+    //    imagep->dontDiscard();
+    //    imagep->setBoostLevel(LLViewerFetchedTexture::BOOST_PREVIEW);
+    //    return imagep;
+    //}
+    //else
+    //{
+    //    return nullptr;
+    //}
+    return getImageFromRaw(raw_image);
+}
 
-        imagep->dontDiscard();
-        imagep->setBoostLevel(LLViewerFetchedTexture::BOOST_PREVIEW);
-        return imagep;
-    }
-    else
+LLViewerFetchedTexture* LLViewerTextureList::getImageFromRaw(LLImageRaw* raw_image)
+{
+    if (!raw_image)
     {
         return nullptr;
     }
+
+    LLViewerFetchedTexture* imagep = new LLViewerFetchedTexture(raw_image, FTT_LOCAL_FILE, true);
+    addImage(imagep, TEX_LIST_STANDARD);
+
+    imagep->dontDiscard();
+    imagep->setBoostLevel(LLViewerFetchedTexture::BOOST_PREVIEW);
+    return imagep;
+    // </FS>
 }
 
 LLViewerFetchedTexture* LLViewerTextureList::getImage(const LLUUID &image_id,
@@ -682,13 +705,23 @@ LLViewerFetchedTexture* LLViewerTextureList::createImage(const LLUUID &image_id,
 void LLViewerTextureList::findTexturesByID(const LLUUID &image_id, std::vector<LLViewerFetchedTexture*> &output)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
-    LLTextureKey search_key(image_id, TEX_LIST_STANDARD);
-    uuid_map_t::iterator iter = mUUIDMap.lower_bound(search_key);
-    while (iter != mUUIDMap.end() && iter->first.textureId == image_id)
-    {
-        output.push_back(iter->second);
-        iter++;
+    // <FS> Flat UUID maps: no ordered range to walk, look up each list type
+    //LLTextureKey search_key(image_id, TEX_LIST_STANDARD);
+    //uuid_map_t::iterator iter = mUUIDMap.lower_bound(search_key);
+    //while (iter != mUUIDMap.end() && iter->first.textureId == image_id)
+    //{
+    //    output.push_back(iter->second);
+    //    iter++;
+    //}
+    for (ETexListType tex_type : { TEX_LIST_STANDARD, TEX_LIST_SCALE })
+    {
+        uuid_map_t::iterator iter = mUUIDMap.find(LLTextureKey(image_id, tex_type));
+        if (iter != mUUIDMap.end())
+        {
+            output.push_back(iter->second);
+        }
     }
+    // </FS>
 }
 
 LLViewerFetchedTexture *LLViewerTextureList::findImage(const LLTextureKey &search_key)
@@ -1202,12 +1235,17 @@ F32 LLViewerTextureList::updateImagesFetchTextures(F32 max_time)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
 
-    typedef std::vector<LLPointer<LLViewerFetchedTexture> > entries_list_t;
+    // <FS> Memory accounting
+    //typedef std::vector<LLPointer<LLViewerFetchedTexture> > entries_list_t;
+    // Rebuilt every frame, scratch memory from the frame arena
+    typedef std::vector<LLPointer<LLViewerFetchedTexture>, LLFrameAllocator<LLPointer<LLViewerFetchedTexture> > > entries_list_t;
+    // </FS>
     entries_list_t entries;
 
     // update N textures at beginning of mImageList
     U32 update_count = 0;
     static const S32 MIN_UPDATE_COUNT = gSavedSettings.getS32("TextureFetchUpdateMinCount");       // default: 32
+    static LLCachedControl<S32> max_update_count(gSavedSettings, "FSTextureFetchUpdateMaxCount", 512);
 
     // NOTE:  a texture may be deleted as a side effect of some of these updates
     // Deletion rules check ref count, so be careful not to hold any LLPointer references to the textures here other than the one in entries.
@@ -1219,14 +1257,48 @@ F32 LLViewerTextureList::updateImagesFetchTextures(F32 max_time)
         // we are over memory target, update more agresively
         update_count = (S32)(update_count * LLViewerTexture::sDesiredDiscardBias);
     }
+    if (max_update_count > 0)
+    {
+        // hard per frame budget, so the cost doesn't keep growing with the number of textures
+        update_count = llmin(update_count, (U32)llmax((S32)max_update_count, MIN_UPDATE_COUNT));
+    }
     update_count = llmin(update_count, (U32) mUUIDMap.size());
 
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("vtluift - urgent");
+
+        // up to half of the budget goes to the textures furthest from their desired resolution
+        U32 urgent_count = llmin(update_count / 2, (U32)mUrgentQueue.size());
+        entries.reserve(update_count);
+        while (urgent_count-- > 0)
+        {
+            std::pop_heap(mUrgentQueue.begin(), mUrgentQueue.end());
+            LLPointer<LLViewerFetchedTexture> imagep = std::move(mUrgentQueue.back().mImage);
+            mUrgentQueue.pop_back();
+            imagep->mUrgentPending = false;
+            if (imagep->isInImageList() && imagep->getGLTexture())
+            {
+                entries.push_back(std::move(imagep));
+                --update_count;
+            }
+        }
+    }
+    size_t urgent_entries = entries.size();
+
     { // copy entries out of UUID map to avoid iterator invalidation from deletion inside updateImageDecodeProiroty or updateFetch below
         LL_PROFILE_ZONE_NAMED_CATEGORY_TEXTURE("vtluift - copy");
 
         // copy entries out of UUID map for updating
-        entries.reserve(update_count);
-        uuid_map_t::iterator iter = mUUIDMap.upper_bound(mLastUpdateKey);
+        // <FS> Flat UUID maps: carry on after the last one updated, from the
+        // start if it is gone. Erasing doesn't move the others, only a
+        // growing map reorders them.
+        //uuid_map_t::iterator iter = mUUIDMap.upper_bound(mLastUpdateKey);
+        uuid_map_t::iterator iter = mUUIDMap.find(mLastUpdateKey);
+        if (iter != mUUIDMap.end())
+        {
+            ++iter;
+        }
+        // </FS>
         while (update_count-- > 0)
         {
             if (iter == mUUIDMap.end())
@@ -1244,18 +1316,28 @@ F32 LLViewerTextureList::updateImagesFetchTextures(F32 max_time)
 
     LLTimer timer;
 
-    for (auto& imagep : entries)
+    for (size_t i = 0; i < entries.size(); ++i)
     {
-        mLastUpdateKey = LLTextureKey(imagep->getID(), (ETexListType)imagep->getTextureListType());
+        LLPointer<LLViewerFetchedTexture>& imagep = entries[i];
+        if (i >= urgent_entries)
+        {
+            mLastUpdateKey = LLTextureKey(imagep->getID(), (ETexListType)imagep->getTextureListType());
+        }
 
         if (imagep->getNumRefs() > 1) // make sure this image hasn't been deleted before attempting to update (may happen as a side effect of some other image updating)
         {
             updateImageDecodePriority(imagep);
             imagep->updateFetch();
+            queueUrgentUpdate(imagep);
         }
 
         if (timer.getElapsedTimeF32() > max_time)
         {
+            // out of time, urgent textures we didn't get to keep their place
+            for (size_t j = i + 1; j < urgent_entries; ++j)
+            {
+                queueUrgentUpdate(entries[j]);
+            }
             break;
         }
     }
@@ -1263,6 +1345,27 @@ F32 LLViewerTextureList::updateImagesFetchTextures(F32 max_time)
     return timer.getElapsedTimeF32();
 }
 
+void LLViewerTextureList::queueUrgentUpdate(LLViewerFetchedTexture* imagep)
+{
+    if (imagep->mUrgentPending || imagep->isDeleted() || !imagep->isInImageList())
+    {
+        return;
+    }
+
+    S32 desired_discard = imagep->getDesiredDiscardLevel();
+    S32 current_discard = imagep->hasGLTexture() ? imagep->getDiscardLevel() : MAX_DISCARD_LEVEL + 1;
+    if (desired_discard < 0 || current_discard <= desired_discard)
+    {
+        return;
+    }
+
+    // screen space error: missing mip levels, weighted by how much of the screen the texture covers
+    F32 error = (F32)(current_discard - desired_discard) * log2f(llmax(imagep->mMaxVirtualSize, 2.f));
+    imagep->mUrgentPending = true;
+    mUrgentQueue.push_back({ error, imagep });
+    std::push_heap(mUrgentQueue.begin(), mUrgentQueue.end());
+}
+
 void LLViewerTextureList::updateImagesUpdateStats()
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
@@ -28,6 +28,7 @@
 #define LL_LLVIEWERTEXTURELIST_H
 
 #include "lluuid.h"
+#include "lluuidflatmap.h" // <FS/> Flat UUID maps
 //#include "message.h"
 #include "llgl.h"
 #include "llviewertexture.h"
@@ -83,8 +84,25 @@ struct LLTextureKey
             return key1.textureType < key2.textureType;
         }
     }
+
+    // <FS> Flat UUID maps
+    friend bool operator==(const LLTextureKey& key1, const LLTextureKey& key2)
+    {
+        return key1.textureType == key2.textureType && key1.textureId == key2.textureId;
+    }
+    // </FS>
 };
 
+// <FS> Flat UUID maps
+struct LLTextureKeyHash
+{
+    size_t operator()(const LLTextureKey& key) const
+    {
+        return FSUUIDHash()(key.textureId) ^ (size_t)key.textureType;
+    }
+};
+// </FS>
+
 class LLViewerTextureList
 {
     friend class LLTextureView;
@@ -156,6 +174,7 @@ private:
     F32  updateImagesFetchTextures(F32 max_time);
     void updateImagesUpdateStats();
     F32  updateImagesLoadingFastCache(F32 max_time);
+    void queueUrgentUpdate(LLViewerFetchedTexture* imagep);
 
     void addImage(LLViewerFetchedTexture *image, ETexListType tex_type);
     void deleteImage(LLViewerFetchedTexture *image);
@@ -197,6 +216,7 @@ private:    // PoundLife - Improved Object Inspect
 
     LLImageRaw* getRawImageFromMemory(const U8* data, U32 size, std::string_view mimetype);
     LLViewerFetchedTexture* getImageFromMemory(const U8* data, U32 size, std::string_view mimetype);
+    LLViewerFetchedTexture* getImageFromRaw(LLImageRaw* raw_image); // <FS/> GLTF parallel image decode
 
     LLViewerFetchedTexture* createImage(const LLUUID &image_id,
                                      FTType f_type,
@@ -223,6 +243,16 @@ public:
     // images that must be downscaled quickly so we don't run out of memory
     image_queue_t mDownScaleQueue;
 
+    // images whose loaded resolution is well below what their size on screen
+    // asks for, updated ahead of the round robin sweep, largest error first
+    struct UrgentEntry
+    {
+        F32 mError;
+        LLPointer<LLViewerFetchedTexture> mImage;
+        bool operator<(const UrgentEntry& rhs) const { return mError < rhs.mError; }
+    };
+    std::vector<UrgentEntry> mUrgentQueue; // binary heap
+
     image_list_t mCallbackList;
     image_list_t mFastCacheList;
 
@@ -236,7 +266,11 @@ public:
     static U32 sNumFastCacheReads;
 
 private:
-    typedef std::map< LLTextureKey, LLPointer<LLViewerFetchedTexture> > uuid_map_t;
+    // <FS> Flat UUID maps: findImage() runs for every texture entry of
+    // every object. The fetch update walks the map from mLastUpdateKey.
+    //typedef std::map< LLTextureKey, LLPointer<LLViewerFetchedTexture> > uuid_map_t;
+    typedef boost::unordered_flat_map< LLTextureKey, LLPointer<LLViewerFetchedTexture>, LLTextureKeyHash > uuid_map_t;
+    // </FS>
     uuid_map_t mUUIDMap;
     LLTextureKey mLastUpdateKey;
 
@@ -732,6 +732,12 @@ public:
             addText(xpos, ypos, llformat("%d Texture Matrix Ops", gPipeline.mTextureMatrixOps));
             ypos += y_inc;
 
+            // <FS> Multi-draw batching
+            addText(xpos, ypos, llformat("%d Merged Draws", gPipeline.mMergedDrawCount));
+            ypos += y_inc;
+            gPipeline.mMergedDrawCount = 0;
+            // </FS>
+
             gPipeline.mTextureMatrixOps = 0;
             gPipeline.mMatrixOpCount = 0;
 
@@ -6086,6 +6092,129 @@ bool LLViewerWindow::thumbnailSnapshot(LLImageRaw *raw, S32 preview_width, S32 p
 // Saves the image from the screen to a raw image
 // Since the required size might be bigger than the available screen, this method rerenders the scene in parts (called subimages) and copy
 // the results over to the final raw image.
+// <FS> Asynchronous snapshot readback
+namespace
+{
+    // Reads snapshot tiles back through two pixel buffers. A tile is copied
+    // into the image once the next one has been rendered, so the GPU is never
+    // drained to hand over a tile while the viewer waits.
+    class SnapshotReadback
+    {
+    public:
+        SnapshotReadback(LLImageRaw* raw)
+        :   mRaw(raw),
+            mNext(0),
+            mFailed(false)
+        {
+        }
+
+        ~SnapshotReadback()
+        {
+            if (mTiles[0].mBuffer)
+            {
+                glDeleteBuffers(1, &mTiles[0].mBuffer);
+            }
+            if (mTiles[1].mBuffer)
+            {
+                glDeleteBuffers(1, &mTiles[1].mBuffer);
+            }
+        }
+
+        // Starts reading a tile of the current framebuffer, offset is where
+        // its first row goes in the image, in bytes
+        void read(S32 x, S32 y, U32 width, U32 height, S32 offset)
+        {
+            Tile& tile = mTiles[mNext];
+            if (!tile.mBuffer)
+            {
+                glGenBuffers(1, &tile.mBuffer);
+            }
+
+            const U32 size = width * height * 4;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, tile.mBuffer);
+            if (tile.mSize < size)
+            {
+                glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+                tile.mSize = size;
+            }
+            glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            tile.mFence.placeFence();
+            tile.mWidth = width;
+            tile.mHeight = height;
+            tile.mOffset = offset;
+            tile.mPending = true;
+
+            // The one before had the time this tile took to render
+            mNext ^= 1;
+            copy(mTiles[mNext]);
+        }
+
+        // Copies what is still outstanding, false when a tile was lost
+        bool finish()
+        {
+            // Nothing rendered after the last tile that would flush its fence
+            glFlush();
+            copy(mTiles[mNext ^ 1]);
+            return !mFailed;
+        }
+
+    private:
+        struct Tile
+        {
+            U32             mBuffer = 0;
+            U32             mSize = 0;
+            U32             mWidth = 0;
+            U32             mHeight = 0;
+            S32             mOffset = 0;
+            bool            mPending = false;
+            LLGLSyncFence   mFence;
+        };
+
+        void copy(Tile& tile)
+        {
+            if (!tile.mPending)
+            {
+                return;
+            }
+            tile.mPending = false;
+
+            tile.mFence.wait();
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, tile.mBuffer);
+            const U8* pixels = (const U8*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, tile.mWidth * tile.mHeight * 4, GL_MAP_READ_BIT);
+            if (!pixels)
+            {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+                mFailed = true;
+                return;
+            }
+
+            const S32 components = mRaw->getComponents();
+            const S32 stride = mRaw->getWidth() * components;
+            for (U32 row = 0; row < tile.mHeight; ++row)
+            {
+                const U8* src = pixels + row * tile.mWidth * 4;
+                U8* dst = mRaw->getData() + tile.mOffset + row * stride;
+                for (U32 x = 0; x < tile.mWidth; ++x, src += 4, dst += components)
+                {
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                    dst[2] = src[2];
+                }
+            }
+
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+
+        LLImageRaw* mRaw;
+        Tile        mTiles[2];
+        U32         mNext;
+        bool        mFailed;
+    };
+}
+// </FS>
+
 bool LLViewerWindow::rawSnapshot(LLImageRaw *raw, S32 image_width, S32 image_height,
     bool keep_window_aspect, bool is_texture, bool show_ui, bool show_hud, bool do_rebuild, bool no_post, LLSnapshotModel::ESnapshotLayerType type, S32 max_size)
 {
@@ -6257,6 +6386,12 @@ bool LLViewerWindow::rawSnapshot(LLImageRaw *raw, S32 image_width, S32 image_hei
     F32 depth_conversion_factor_1 = (LLViewerCamera::getInstance()->getFar() + LLViewerCamera::getInstance()->getNear()) / (2.f * LLViewerCamera::getInstance()->getFar() * LLViewerCamera::getInstance()->getNear());
     F32 depth_conversion_factor_2 = (LLViewerCamera::getInstance()->getFar() - LLViewerCamera::getInstance()->getNear()) / (2.f * LLViewerCamera::getInstance()->getFar() * LLViewerCamera::getInstance()->getNear());
 
+    // <FS> Asynchronous snapshot readback
+    static LLCachedControl<bool> async_readback(gSavedSettings, "FSSnapshotAsyncReadback", true);
+    const bool use_async_readback = async_readback && type == LLSnapshotModel::SNAPSHOT_TYPE_COLOR && raw->getComponents() >= 3 && !LLRender::sNsightDebugSupport;
+    SnapshotReadback readback(raw);
+    // </FS>
+
     // Subimages are in fact partial rendering of the final view. This happens when the final view is bigger than the screen.
     // In most common cases, scale_factor is 1 and there's no more than 1 iteration on x and y
     for (int subimage_y = 0; subimage_y < scale_factor; ++subimage_y)
@@ -6291,6 +6426,20 @@ bool LLViewerWindow::rawSnapshot(LLImageRaw *raw, S32 image_width, S32 image_hei
                     swap();
                 }
 
+                // <FS> Asynchronous snapshot readback
+                if (use_async_readback)
+                {
+                    S32 tile_offset = (
+                                       (window_width * subimage_x) // subimage start in x...
+                                       + (raw->getWidth() * window_height * subimage_y) // ...plus subimage start in y...
+                                       - output_buffer_offset_x // ...minus buffer padding x...
+                                       - (output_buffer_offset_y * (raw->getWidth()))  // ...minus buffer padding y...
+                                       ) * raw->getComponents();
+                    readback.read(subimage_x_offset, subimage_y_offset, read_width, read_height, tile_offset);
+                    LLAppViewer::instance()->pingMainloopTimeout("LLViewerWindow::rawSnapshot");
+                }
+                else
+                // </FS>
                 for (U32 out_y = 0; out_y < read_height ; out_y++)
                 {
                     S32 output_buffer_offset = (
@@ -6385,6 +6534,10 @@ bool LLViewerWindow::rawSnapshot(LLImageRaw *raw, S32 image_width, S32 image_hei
         output_buffer_offset_y += subimage_y_offset;
     }
 
+    // <FS> Asynchronous snapshot readback
+    bool readback_ok = readback.finish();
+    // </FS>
+
     gDisplaySwapBuffers = false;
     gSnapshotNoPost = false;
     gDepthDirty = true;
@@ -6421,6 +6574,10 @@ bool LLViewerWindow::rawSnapshot(LLImageRaw *raw, S32 image_width, S32 image_hei
         ret = raw->scale( image_width, image_height, false );
     }
 
+    // <FS> Asynchronous snapshot readback
+    ret = ret && readback_ok;
+    // </FS>
+
     setCursor(UI_CURSOR_ARROW);
 
     if (do_rebuild)
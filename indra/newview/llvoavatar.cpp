@@ -136,6 +136,7 @@
 #include "fslslbridge.h" // <FS:PP> Movelock position refresh
 
 #include "fsdiscordconnect.h" // <FS:LO> tapping a place that happens on landing in world to start up discord
+#include "fsanimationscheduler.h" // <FS/> Animation budget
 
 extern F32 SPEED_ADJUST_MAX;
 extern F32 SPEED_ADJUST_MAX_SEC;
@@ -643,6 +644,7 @@ F32 LLVOAvatar::sGreyUpdateTime = 0.f;
 LLPointer<LLViewerTexture> LLVOAvatar::sCloudTexture = NULL;
 std::vector<LLUUID> LLVOAvatar::sAVsIgnoringARTLimit;
 S32 LLVOAvatar::sAvatarsNearby = 0;
+bool LLVOAvatar::sDeferSkeletonUpdates = false; // <FS/> Parallel avatar updates
 
 //-----------------------------------------------------------------------------
 // Helper functions
@@ -702,6 +704,12 @@ LLVOAvatar::LLVOAvatar(const LLUUID& id,
     mVisibilityRank(0),
     mNeedsSkin(false),
     mLastSkinTime(0.f),
+    mSkeletonUpdatePending(false), // <FS/> Parallel avatar updates
+    mSkeletonSitGroundConstrained(false), // <FS/> Parallel avatar updates
+    mDeferredDetailedUpdate(false), // <FS/> Parallel avatar updates
+    mAnimationPeriod(1), // <FS/> Animation budget
+    mAnimationPhase(0), // <FS/> Animation budget
+    mAnimationCost(0.f), // <FS/> Animation budget
     mUpdatePeriod(1),
     mOverallAppearance(AOA_INVISIBLE),
     mVisualComplexityStale(true),
@@ -919,6 +927,8 @@ LLVOAvatar::~LLVOAvatar()
     std::for_each(mAttachmentPoints.begin(), mAttachmentPoints.end(), DeletePairedPointer());
     mAttachmentPoints.clear();
 
+    gPipeline.mImpostorAtlas.free(mImpostorSlot); // <FS/> Impostor atlas
+
     mDead = true;
 
     mAnimationSources.clear();
@@ -1212,6 +1222,7 @@ void LLVOAvatar::resetImpostors()
     {
         LLVOAvatar* avatar = (LLVOAvatar*)character;
         avatar->mImpostor.release();
+        gPipeline.mImpostorAtlas.free(avatar->mImpostorSlot); // <FS/> Impostor atlas
         avatar->mNeedsImpostorUpdate = true;
         avatar->mLastImpostorUpdateReason = 1;
     }
@@ -2957,6 +2968,38 @@ void LLVOAvatar::idleUpdate(LLAgent &agent, const F64 &time)
     mLastRootPos = mRoot->getWorldPosition();
     bool detailed_update = updateCharacter(agent);
 
+    // <FS> Parallel avatar updates
+    if (mSkeletonUpdatePending)
+    {
+        // LLViewerObjectList calls finishIdleUpdate() once the skeletons are done
+        mDeferredDetailedUpdate = detailed_update;
+        return;
+    }
+
+    idleUpdatePostCharacter(detailed_update);
+}
+
+void LLVOAvatar::finishIdleUpdate()
+{
+    if (!mSkeletonUpdatePending)
+    {
+        return;
+    }
+    mSkeletonUpdatePending = false;
+
+    if (isDead())
+    {
+        return;
+    }
+
+    finishCharacterUpdate(mDeferredDetailedUpdate);
+    idleUpdatePostCharacter(mDeferredDetailedUpdate);
+}
+
+// What idleUpdate() does once the character is updated
+void LLVOAvatar::idleUpdatePostCharacter(bool detailed_update)
+{
+    // </FS>
     static LLUICachedControl<bool> visualizers_in_calls("ShowVoiceVisualizersInCalls", false);
     bool voice_enabled = (visualizers_in_calls || LLVoiceClient::getInstance()->inProximalChannel()) &&
                          LLVoiceClient::getInstance()->getVoiceEnabled(mID);
@@ -5476,6 +5519,11 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
     // store data relevant to motions
     mSpeed = speed;
 
+    // <FS> Parallel avatar updates
+    mMotionController.setDeferPoseApply(sDeferSkeletonUpdates);
+    mSkeletonSitGroundConstrained = was_sit_ground_constrained;
+    // </FS>
+
     // update animations
     if (!visible && !isSelf()) // NOTE: never do a "hidden update" for self avatar as it interrupts controller processing
     {
@@ -5485,14 +5533,60 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
     {
         updateMotions(LLCharacter::FORCE_UPDATE);
     }
-    else
+    // <FS> Animation budget
+    //else
+    //{
+    //    // Might be better to do HIDDEN_UPDATE if cloud
+    //    updateMotions(LLCharacter::NORMAL_UPDATE);
+    //}
+    // <FS> Shared animesh poses
+    else if (findSharedPose())
+    {
+        // updateSkeleton() copies the pose
+    }
+    // </FS>
+    else if (FSAnimationScheduler::instance().shouldAnimate(this))
     {
         // Might be better to do HIDDEN_UPDATE if cloud
+        const F64 start = LLTimer::getElapsedSeconds();
         updateMotions(LLCharacter::NORMAL_UPDATE);
+        FSAnimationScheduler::instance().recordCost(this, LLTimer::getElapsedSeconds() - start);
+        shareEvaluatedPose(); // <FS/> Shared animesh poses
+    }
+    // Otherwise the joints keep last frame's pose and the motions get the
+    // time in between on their next update
+    // </FS>
+
+    // <FS> Parallel avatar updates
+    mMotionController.setDeferPoseApply(false);
+    if (sDeferSkeletonUpdates)
+    {
+        // LLViewerObjectList runs updateSkeleton() for all the pending
+        // avatars side by side, then finishIdleUpdate()
+        mSkeletonUpdatePending = true;
+        return visible;
     }
 
+    updateSkeleton();
+    finishCharacterUpdate(visible);
+
+    return visible;
+}
+
+void LLVOAvatar::updateSkeleton()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+
+    // Left by updateMotions() when deferred
+    mMotionController.applyPendingPose();
+    // </FS>
+    copySharedPose(); // <FS/> Shared animesh poses
+
     // Special handling for sitting on ground.
-    if (!getParent() && (isSitting() || was_sit_ground_constrained))
+    // <FS> Parallel avatar updates
+    //if (!getParent() && (isSitting() || was_sit_ground_constrained))
+    if (!getParent() && (isSitting() || mSkeletonSitGroundConstrained))
+    // </FS>
     {
 
         F32 off_z = (F32)LLVector3d(getHoverOffset()).mdV[VZ];
@@ -5506,6 +5600,50 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
         }
     }
 
+    // <FS> Parallel avatar updates
+    // Moved ahead of the head offset and footsteps, which only read joint
+    // positions that are brought up to date on the way anyway
+    // Update child joints as needed.
+    mRoot->updateWorldMatrixChildren();
+}
+
+// The rest of updateCharacter() once the skeleton is updated, plays sounds
+// <FS> Shared animesh poses
+// Takes the local joint transforms left by the motions of the source.
+// Attachment overrides and scale were matched by findSharedPose(), only
+// the root of the two characters differs.
+void LLVOAvatar::copySharedPose()
+{
+    if (mSharedPoseSource.isNull())
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR;
+    if (!mSharedPoseSource->isDead())
+    {
+        const avatar_joint_list_t& source = mSharedPoseSource->mSkeleton;
+        const size_t count = llmin(source.size(), mSkeleton.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            LLAvatarJoint* joint = mSkeleton[i];
+            LLAvatarJoint* source_joint = source[i];
+            if (joint && source_joint)
+            {
+                joint->setPosition(source_joint->getPosition());
+                joint->setRotation(source_joint->getRotation());
+                joint->setScale(source_joint->getScale());
+            }
+        }
+    }
+    mSharedPoseSource = NULL;
+}
+// </FS>
+
+void LLVOAvatar::finishCharacterUpdate(bool visible)
+{
+    // </FS>
+
     // update head position
     updateHeadOffset();
 
@@ -5513,7 +5651,8 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
     updateFootstepSounds();
 
     // Update child joints as needed.
-    mRoot->updateWorldMatrixChildren();
+    // <FS/> Parallel avatar updates, moved to updateSkeleton()
+    //mRoot->updateWorldMatrixChildren();
 
     if (visible)
     {
@@ -5521,7 +5660,9 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
         mNeedsSkin = true;
     }
 
-    return visible;
+    // <FS> Parallel avatar updates
+    //return visible;
+    // </FS>
 }
 
 //-----------------------------------------------------------------------------
@@ -6056,7 +6197,11 @@ U32 LLVOAvatar::renderRigid()
 U32 LLVOAvatar::renderImpostor(LLColor4U color, S32 diffuse_channel)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_AVATAR; // <FS:Beq/> Tracy accounting for render tracking
-    if (!mImpostor.isComplete())
+    // <FS> Impostor atlas
+    //if (!mImpostor.isComplete())
+    bool in_atlas = gPipeline.mImpostorAtlas.isValid(mImpostorSlot);
+    if (!in_atlas && !mImpostor.isComplete())
+    // </FS>
     {
         return 0;
     }
@@ -6091,6 +6236,15 @@ U32 LLVOAvatar::renderImpostor(LLColor4U color, S32 diffuse_channel)
         gGL.end();
         gGL.flush();
     }
+
+    // <FS> Impostor atlas
+    if (in_atlas)
+    { // drawn with the rest of its page at the end of the pass
+        gPipeline.mImpostorAtlas.queue(mImpostorSlot, color, pos + left - up, pos - left - up, pos - left + up, pos + left + up);
+        return 6;
+    }
+    // </FS>
+
     {
     gGL.flush();
 
@@ -12157,6 +12311,21 @@ void LLVOAvatar::accountRenderComplexityForObject(
                 F32 attachment_children_cost = 0;
                             const F32 animated_object_attachment_surcharge = 1000;
 
+                // <FS> Incremental complexity
+                // The volume costs only change with the linkset, reuse them
+                // until it does, see LLViewerObject::dirtyRenderCost()
+                static LLCachedControl<bool> incremental_complexity(gSavedSettings, "FSIncrementalComplexity", true);
+                if (incremental_complexity && attached_object->mRenderCostValid)
+                {
+                    attachment_volume_cost = attached_object->mRenderCost;
+                    for (const LLConstPointer<LLViewerTexture>& texture : attached_object->mRenderCostTextures)
+                    {
+                        textures.insert(texture.get());
+                    }
+                }
+                else
+                {
+                // </FS>
                 if (volume->isAnimatedObjectFast())
                 {
                     attachment_volume_cost += animated_object_attachment_surcharge;
@@ -12175,6 +12344,15 @@ void LLVOAvatar::accountRenderComplexityForObject(
                         attachment_children_cost += child->getRenderCost(textures);
                     }
                 }
+                // <FS> Incremental complexity
+                if (incremental_complexity)
+                {
+                    attached_object->mRenderCost = attachment_volume_cost + attachment_children_cost;
+                    attached_object->mRenderCostTextures.assign(textures.begin(), textures.end());
+                    attached_object->mRenderCostValid = true;
+                }
+                }
+                // </FS>
 
                 for (LLVOVolume::texture_cost_t::iterator volume_texture = textures.begin();
                     volume_texture != textures.end();
@@ -54,6 +54,7 @@
 #include "llvovolume.h"
 #include "llavatarrendernotifier.h"
 #include "llmodel.h"
+#include "fsimpostoratlas.h" // <FS/> Impostor atlas
 
 extern const LLUUID ANIM_AGENT_BODY_NOISE;
 extern const LLUUID ANIM_AGENT_BREATHE_ROT;
@@ -285,6 +286,37 @@ public:
     void            updateTimeStep();
     void            updateRootPositionAndRotation(LLAgent &agent, F32 speed, bool was_sit_ground_constrained);
 
+    // <FS> Parallel avatar updates
+    // Threads:  any
+    // The part of updateCharacter() that only writes to the joints of this
+    // avatar: the blended pose and the joint world matrices. Called by
+    // updateCharacter(), or by LLViewerObjectList on the General thread pool
+    // for the avatars that left it pending.
+    void            updateSkeleton();
+
+    // Threads:  Tmain
+    // The rest of an idleUpdate() that left its skeleton for updateSkeleton()
+    void            finishIdleUpdate();
+    bool            isSkeletonUpdatePending() const { return mSkeletonUpdatePending; }
+
+    // Set by LLViewerObjectList around its idle updates, updateCharacter()
+    // then leaves the skeleton pending instead of updating it
+    static bool     sDeferSkeletonUpdates;
+
+    void            finishCharacterUpdate(bool visible);
+    void            idleUpdatePostCharacter(bool detailed_update);
+    // </FS>
+
+    // <FS> Shared animesh poses
+    // Instead of running its own motions, updateCharacter() can take the pose
+    // of an identical character evaluated earlier in the frame. It is copied
+    // by updateSkeleton(), which has to wait for the source's skeleton.
+    virtual bool    findSharedPose() { return false; }
+    virtual void    shareEvaluatedPose() {}
+    LLVOAvatar*     getSharedPoseSource() const { return mSharedPoseSource; }
+    void            copySharedPose();
+    // </FS>
+
     void            idleUpdateVoiceVisualizer(bool voice_enabled, const LLVector3 &position);
     void            idleUpdateMisc(bool detailed_update);
     virtual void    idleUpdateAppearanceAnimation();
@@ -576,6 +608,7 @@ public:
 
 private:
     friend class LLPipeline;
+    friend class FSAnimationScheduler; // <FS/> Animation budget
     AvatarOverallAppearance mOverallAppearance;
     F32         mAttachmentSurfaceArea; //estimated surface area of attachments
     U32         mAttachmentVisibleTriangleCount;
@@ -585,6 +618,21 @@ private:
     bool        mNeedsSkin; // avatar has been animated and verts have not been updated
     F32         mLastSkinTime; //value of gFrameTimeSeconds at last skin update
 
+    // <FS> Parallel avatar updates
+    bool        mSkeletonUpdatePending;         // updateCharacter() left the skeleton for updateSkeleton()
+    bool        mSkeletonSitGroundConstrained;  // as updateCharacter() found it, for updateSkeleton()
+    bool        mDeferredDetailedUpdate;        // updateCharacter() result, for finishIdleUpdate()
+    // </FS>
+
+    LLPointer<LLVOAvatar> mSharedPoseSource;    // <FS/> Shared animesh poses, set by findSharedPose()
+
+    // <FS> Animation budget
+    // See FSAnimationScheduler
+    U32         mAnimationPeriod;   // frames between evaluations of the motions
+    U32         mAnimationPhase;
+    F32         mAnimationCost;     // seconds per evaluation, smoothed
+    // </FS>
+
     S32         mUpdatePeriod;
     S32         mNumInitFaces; //number of faces generated when creating the avatar drawable, does not inculde splitted faces due to long vertex buffer.
 
@@ -677,6 +725,7 @@ public:
     static void resetImpostors();
     static void updateImpostors();
     LLRenderTarget mImpostor;
+    FSImpostorAtlas::Slot mImpostorSlot; // <FS/> Impostor atlas, used instead of mImpostor when valid
 // [RLVa:KB] - Checked: RLVa-2.4 (@setcam_avdist)
     mutable bool mNeedsImpostorUpdate;
 // [/RLVa:KB]
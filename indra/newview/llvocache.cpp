@@ -35,6 +35,8 @@
 #include "llsdserialize.h"
 #include "llagent.h" // <FS:Beq/> For gAgent
 #include "llworld.h" // For LLWorld::getInstance()
+#include "workqueue.h" // <FS/> Object cache prefetch
+#include "llmemorystream.h" // <FS/> Binary override cache
 
 //static variables
 U32 LLVOCacheEntry::sMinFrameRange = 0;
@@ -59,7 +61,36 @@ bool check_write(LLAPRFile* apr_file, void* src, S32 n_bytes)
 
 // Material Override Cache needs a version label, so we can upgrade this later.
 const std::string LLGLTFOverrideCacheEntry::VERSION_LABEL = {"GLTFCacheVer"};
-const int LLGLTFOverrideCacheEntry::VERSION = 1;
+// <FS> Binary override cache
+//const int LLGLTFOverrideCacheEntry::VERSION = 1;
+const int LLGLTFOverrideCacheEntry::VERSION = 2;
+
+namespace
+{
+    // Extras files written before the binary format, they are read once
+    // and rewritten as binary
+    constexpr int LLSD_EXTRAS_VERSION = 1;
+
+    // local id, object id and side count
+    constexpr U32 BINARY_ENTRY_HEADER_SIZE = sizeof(U32) + UUID_BYTES + sizeof(U32);
+    // side index and size of its LLSD
+    constexpr U32 BINARY_SIDE_HEADER_SIZE = sizeof(S32) + sizeof(U32);
+
+    template <typename T>
+    void append_value(std::string& out, T value)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    T read_value(const U8* data)
+    {
+        T value;
+        memcpy(&value, data, sizeof(T));
+        return value;
+    }
+}
+// </FS>
 
 bool LLGLTFOverrideCacheEntry::fromLLSD(const LLSD& data)
 {
@@ -153,6 +184,106 @@ LLSD LLGLTFOverrideCacheEntry::toLLSD() const
     return data;
 }
 
+// <FS> Binary override cache
+bool LLGLTFOverrideCacheEntry::fromBinary(const U8* data, U32 size, U64 region_handle)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+
+    if (size < BINARY_ENTRY_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    mRegionHandle = region_handle;
+    mLocalId = read_value<U32>(data);
+    memcpy(mObjectId.mData, data + sizeof(U32), UUID_BYTES);
+    const U32 num_sides = read_value<U32>(data + sizeof(U32) + UUID_BYTES);
+
+    U32 offset = BINARY_ENTRY_HEADER_SIZE;
+    for (U32 i = 0; i < num_sides; ++i)
+    {
+        if (size - offset < BINARY_SIDE_HEADER_SIZE)
+        {
+            return false;
+        }
+        const S32 side_idx = read_value<S32>(data + offset);
+        const U32 llsd_size = read_value<U32>(data + offset + sizeof(S32));
+        offset += BINARY_SIDE_HEADER_SIZE;
+        if (size - offset < llsd_size)
+        {
+            return false;
+        }
+
+        LLSD side_llsd;
+        LLMemoryStream stream(data + offset, (S32)llsd_size);
+        if (LLSDSerialize::fromBinary(side_llsd, stream, llsd_size) == LLSDParser::PARSE_FAILURE)
+        {
+            return false;
+        }
+        offset += llsd_size;
+
+        LLGLTFMaterial* override_mat = new LLGLTFMaterial();
+        override_mat->applyOverrideLLSD(side_llsd);
+        mSides[side_idx] = side_llsd;
+        mGLTFMaterial[side_idx] = override_mat;
+    }
+
+    return offset == size;
+}
+
+void LLGLTFOverrideCacheEntry::toBinary(std::string& out) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+
+    llassert(mSides.size() == mGLTFMaterial.size());
+    append_value<U32>(out, mLocalId);
+    out.append(reinterpret_cast<const char*>(mObjectId.mData), UUID_BYTES);
+    append_value<U32>(out, (U32)mSides.size());
+
+    std::ostringstream side_stream;
+    for (auto const & side : mSides)
+    {
+        side_stream.str("");
+        LLSDSerialize::toBinary(side.second, side_stream);
+        const std::string side_data = side_stream.str();
+        append_value<S32>(out, side.first);
+        append_value<U32>(out, (U32)side_data.size());
+        out.append(side_data);
+    }
+}
+
+//---------------------------------------------------------------------------
+// LLGLTFOverrideCacheBlobs
+//---------------------------------------------------------------------------
+
+void LLGLTFOverrideCacheBlobs::clear()
+{
+    mBlobs.clear();
+    mBuffer = nullptr;
+}
+
+bool LLGLTFOverrideCacheBlobs::take(U32 local_id, LLGLTFOverrideCacheEntry& entry)
+{
+    auto iter = mBlobs.find(local_id);
+    if (iter == mBlobs.end())
+    {
+        return false;
+    }
+
+    const Blob blob = iter->second;
+    const bool success = entry.fromBinary(mBuffer->getData() + blob.mOffset, blob.mSize, mRegionHandle);
+    LL_WARNS_IF(!success, "GLTF") << "Broken override cache entry for local id " << local_id << LL_ENDL;
+
+    mBlobs.erase(iter);
+    if (mBlobs.empty())
+    {
+        // Everything was decoded, the file contents aren't needed anymore
+        mBuffer = nullptr;
+    }
+    return success;
+}
+// </FS>
+
 //---------------------------------------------------------------------------
 // LLVOCacheEntry
 //---------------------------------------------------------------------------
@@ -211,25 +342,28 @@ LLVOCacheEntry::LLVOCacheEntry(LLAPRFile* apr_file)
     mDP.assignBuffer(mBuffer, 0);
 
     success = check_read(apr_file, (void *)data_buffer, ENTRY_HEADER_SIZE);
-    if (success)
-    {
-        memcpy(&mLocalID, data_buffer, sizeof(U32));
-        memcpy(&mCRC, data_buffer + sizeof(U32), sizeof(U32));
-        memcpy(&mHitCount, data_buffer + (2 * sizeof(U32)), sizeof(S32));
-        memcpy(&mDupeCount, data_buffer + (3 * sizeof(U32)), sizeof(S32));
-        memcpy(&mCRCChangeCount, data_buffer + (4 * sizeof(U32)), sizeof(S32));
-        memcpy(&size, data_buffer + (5 * sizeof(U32)), sizeof(S32));
-
-        // Corruption in the cache entries
-        if ((size > MAX_ENTRY_BODY_SIZE) || (size < 1))
-        {
-            // We've got a bogus size, skip reading it.
-            // We won't bother seeking, because the rest of this file
-            // is likely bogus, and will be tossed anyway.
-            LL_WARNS() << "Bogus cache entry, size " << size << ", aborting!" << LL_ENDL;
-            success = false;
-        }
-    }
+    // <FS> Shared object cache file
+    //if (success)
+    //{
+    //    memcpy(&mLocalID, data_buffer, sizeof(U32));
+    //    memcpy(&mCRC, data_buffer + sizeof(U32), sizeof(U32));
+    //    memcpy(&mHitCount, data_buffer + (2 * sizeof(U32)), sizeof(S32));
+    //    memcpy(&mDupeCount, data_buffer + (3 * sizeof(U32)), sizeof(S32));
+    //    memcpy(&mCRCChangeCount, data_buffer + (4 * sizeof(U32)), sizeof(S32));
+    //    memcpy(&size, data_buffer + (5 * sizeof(U32)), sizeof(S32));
+    //
+    //    // Corruption in the cache entries
+    //    if ((size > MAX_ENTRY_BODY_SIZE) || (size < 1))
+    //    {
+    //        // We've got a bogus size, skip reading it.
+    //        // We won't bother seeking, because the rest of this file
+    //        // is likely bogus, and will be tossed anyway.
+    //        LL_WARNS() << "Bogus cache entry, size " << size << ", aborting!" << LL_ENDL;
+    //        success = false;
+    //    }
+    //}
+    success = success && unpackHeader(data_buffer, size);
+    // </FS>
     if(success && size > 0)
     {
         mBuffer = new U8[size];
@@ -261,9 +395,121 @@ LLVOCacheEntry::LLVOCacheEntry(LLAPRFile* apr_file)
     }
 }
 
+// <FS> Shared object cache file
+LLVOCacheEntry::LLVOCacheEntry(LLVOCacheFileBuffer* file_buffer, S32& offset)
+:   LLViewerOctreeEntryData(LLViewerOctreeEntry::LLVOCACHEENTRY),
+    mBuffer(NULL),
+    mUpdateFlags(-1),
+    mState(INACTIVE),
+    mSceneContrib(0.f),
+    mValid(false),
+    mParentID(0),
+    mBSphereRadius(-1.0f)
+{
+    S32 size = -1;
+    bool success = offset + ENTRY_HEADER_SIZE <= file_buffer->getSize()
+        && unpackHeader(file_buffer->getData() + offset, size);
+
+    mDP.assignBuffer(mBuffer, 0);
+
+    if (success)
+    {
+        offset += ENTRY_HEADER_SIZE;
+        if (offset + size <= file_buffer->getSize())
+        {
+            mFileBuffer = file_buffer;
+            mBuffer = file_buffer->getData() + offset;
+            mDP.assignBuffer(mBuffer, size);
+            offset += size;
+        }
+        else
+        {
+            LL_WARNS() << "Error loading cache entry for " << mLocalID << ", size " << size << " aborting!" << LL_ENDL;
+            success = false;
+        }
+    }
+
+    if (!success)
+    {
+        mLocalID = 0;
+        mCRC = 0;
+        mHitCount = 0;
+        mDupeCount = 0;
+        mCRCChangeCount = 0;
+        mBuffer = NULL;
+        mEntry = NULL;
+        mState = INACTIVE;
+    }
+}
+
+bool LLVOCacheEntry::unpackHeader(const U8* data_buffer, S32& size)
+{
+    memcpy(&mLocalID, data_buffer, sizeof(U32));
+    memcpy(&mCRC, data_buffer + sizeof(U32), sizeof(U32));
+    memcpy(&mHitCount, data_buffer + (2 * sizeof(U32)), sizeof(S32));
+    memcpy(&mDupeCount, data_buffer + (3 * sizeof(U32)), sizeof(S32));
+    memcpy(&mCRCChangeCount, data_buffer + (4 * sizeof(U32)), sizeof(S32));
+    memcpy(&size, data_buffer + (5 * sizeof(U32)), sizeof(S32));
+
+    // Corruption in the cache entries
+    if ((size > MAX_ENTRY_BODY_SIZE) || (size < 1))
+    {
+        // We've got a bogus size, skip reading it.
+        // We won't bother seeking, because the rest of this file
+        // is likely bogus, and will be tossed anyway.
+        LL_WARNS() << "Bogus cache entry, size " << size << ", aborting!" << LL_ENDL;
+        return false;
+    }
+    return true;
+}
+
+void LLVOCacheEntry::freeBuffer()
+{
+    if (mFileBuffer.notNull())
+    {
+        mDP.releaseBuffer();
+        mFileBuffer = NULL;
+    }
+    else
+    {
+        mDP.freeBuffer();
+    }
+    mBuffer = NULL;
+}
+// </FS>
+
+// <FS> Recently left regions
+LLVOCacheEntry* LLVOCacheEntry::clone() const
+{
+    LLVOCacheEntry* entry = new LLVOCacheEntry();
+    entry->mLocalID = mLocalID;
+    entry->mCRC = mCRC;
+    entry->mHitCount = mHitCount;
+    entry->mDupeCount = mDupeCount;
+    entry->mCRCChangeCount = mCRCChangeCount;
+
+    const S32 size = mDP.getBufferSize();
+    if (mFileBuffer.notNull())
+    { // the file buffer is never written to, share it
+        entry->mFileBuffer = mFileBuffer;
+        entry->mBuffer = mBuffer;
+    }
+    else if (size > 0)
+    {
+        entry->mBuffer = new U8[size];
+        memcpy(entry->mBuffer, mBuffer, size);
+    }
+    entry->mDP.assignBuffer(entry->mBuffer, entry->mBuffer ? size : 0);
+    return entry;
+}
+// </FS>
+
 LLVOCacheEntry::~LLVOCacheEntry()
 {
-    mDP.freeBuffer();
+    // <FS> Shared object cache file
+    //mDP.freeBuffer();
+    freeBuffer();
+    // </FS>
 }
 
 void LLVOCacheEntry::updateEntry(U32 crc, LLDataPackerBinaryBuffer &dp)
@@ -274,7 +520,10 @@ void LLVOCacheEntry::updateEntry(U32 crc, LLDataPackerBinaryBuffer &dp)
         mCRCChangeCount++;
     }
 
-    mDP.freeBuffer();
+    // <FS> Shared object cache file
+    //mDP.freeBuffer();
+    freeBuffer();
+    // </FS>
 
     llassert_always(dp.getBufferSize() > 0);
     mBuffer = new U8[dp.getBufferSize()];
@@ -313,7 +562,7 @@ void LLVOCacheEntry::setOctreeEntry(LLViewerOctreeEntry* entry)
     if(!entry && mDP.getBufferSize() > 0)
     {
         LLUUID fullid;
-        LLViewerObject::unpackUUID(&mDP, fullid, "ID");
+        LLViewerObject::unpackUUID(&mDP, fullid, LLViewerObject::OBJECT_DATA_ID); // <FS/> Fast binary unpacking
 
         LLViewerObject* obj = gObjectList.findObject(fullid);
         if(obj && obj->mDrawable)
@@ -1177,7 +1426,9 @@ LLVOCache::LLVOCache(bool read_only) :
     mReadOnly(read_only),
     mNumEntries(0),
     mCacheSize(1),
-    mEnabled(true)
+    mEnabled(true),
+    mPrefetchSerial(0), // <FS/> Object cache prefetch
+    mRecentRegionBytes(0) // <FS/> Recently left regions
 {
 #ifndef LL_TEST
     mEnabled = gSavedSettings.getBOOL("ObjectCacheEnabled");
@@ -1316,6 +1567,9 @@ void LLVOCache::removeEntry(HeaderEntryInfo* entry)
     getObjectCacheFilename(entry->mHandle, filename);
     LL_INFOS() << "Removing entry for region with filename" << filename << LL_ENDL;
 
+    dropPrefetch(entry->mHandle); // <FS/> Object cache prefetch
+    dropRecentRegion(entry->mHandle); // <FS/> Recently left regions
+
     // make sure corresponding LLViewerRegion also clears its in-memory cache
     LLViewerRegion* regionp = LLWorld::instance().getRegionFromHandle(entry->mHandle);
     if (regionp)
@@ -1358,7 +1612,11 @@ void LLVOCache::clearCacheInMemory()
         mHandleEntryMap.clear();
         mNumEntries = 0 ;
     }
-
+    mPrefetches.clear(); // <FS/> Object cache prefetch
+    // <FS> Recently left regions
+    mRecentRegions.clear();
+    mRecentRegionBytes = 0;
+    // </FS>
 }
 
 void LLVOCache::getObjectCacheFilename(U64 handle, std::string& filename)
@@ -1568,6 +1826,47 @@ bool LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::voca
         return false; // arguably no a problem, but we'll mark this as dirty anyway.
     }
 
+    // <FS> Recently left regions
+    // Take the entries kept from the last visit, the file holds the same
+    recent_region_list_t::iterator recent = findRecentRegion(handle);
+    if (recent != mRecentRegions.end())
+    {
+        RecentRegion region = std::move(*recent);
+        mRecentRegions.erase(recent);
+        mRecentRegionBytes -= region.mBytes;
+        if (region.mCacheID == id)
+        {
+            dropPrefetch(handle);
+            for (auto& entry : region.mEntries)
+            {
+                cache_entry_map[entry.first] = entry.second;
+            }
+            LL_DEBUGS("VOCache") << "Took " << region.mEntries.size() << " entries of recently left region " << handle << LL_ENDL;
+            return true;
+        }
+    }
+    // </FS>
+
+    // <FS> Object cache prefetch
+    // Take the entries read in the background, unless they aren't there yet
+    // or are of another version of the region, then read the file as before
+    prefetch_list_t::iterator prefetched = findPrefetch(handle);
+    if (prefetched != mPrefetches.end())
+    {
+        Prefetch prefetch = std::move(prefetched->second);
+        mPrefetches.erase(prefetched);
+        if (prefetch.mDone && prefetch.mResult.mSuccess && prefetch.mResult.mCacheID == id)
+        {
+            for (auto& entry : prefetch.mResult.mEntries)
+            {
+                cache_entry_map[entry.first] = entry.second;
+            }
+            LL_DEBUGS("VOCache") << "Took " << prefetch.mResult.mEntries.size() << " prefetched entries for handle " << handle << LL_ENDL;
+            return true;
+        }
+    }
+    // </FS>
+
     bool success = true ;
     S32 num_entries = 0 ; // lifted out of inner loop.
     std::string filename; // lifted out of loop
@@ -1592,6 +1891,30 @@ bool LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::voca
             {
                 success = check_read(&apr_file, &num_entries, sizeof(S32)) ;
 
+                // <FS> Shared object cache file
+                // Read all entries at once, they point into the one buffer
+                static LLCachedControl<bool> shared_file(gSavedSettings, "FSSharedObjectCacheFile", true);
+                const S32 body_size = LLAPRFile::size(filename, mLocalAPRFilePoolp) - UUID_BYTES - (S32)sizeof(S32);
+                if (success && shared_file && body_size > 0)
+                {
+                    LLPointer<LLVOCacheFileBuffer> file_buffer = new LLVOCacheFileBuffer(body_size);
+                    success = check_read(&apr_file, file_buffer->getData(), body_size);
+
+                    S32 offset = 0;
+                    for (S32 i = 0; success && i < num_entries && offset < body_size; i++)
+                    {
+                        LLPointer<LLVOCacheEntry> entry = new LLVOCacheEntry(file_buffer, offset);
+                        if (!entry->getLocalID())
+                        {
+                            LL_WARNS() << "Aborting cache file load for " << filename << ", cache file corruption!" << LL_ENDL;
+                            success = false ;
+                            break ;
+                        }
+                        cache_entry_map[entry->getLocalID()] = entry;
+                    }
+                }
+                else
+                // </FS>
                 if(success)
                 {
                     for (S32 i = 0; i < num_entries && apr_file.eof() != APR_EOF; i++)
@@ -1622,8 +1945,275 @@ bool LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::voca
     return success;
 }
 
+// <FS> Object cache prefetch
+void LLVOCache::prefetch(U64 handle)
+{
+    static LLCachedControl<bool> enabled(gSavedSettings, "FSObjectCachePrefetch", true);
+    static LLCachedControl<U32> max_regions(gSavedSettings, "FSObjectCachePrefetchRegions", 16);
+
+    if (!enabled || !mEnabled || !mInitialized || mHandleEntryMap.find(handle) == mHandleEntryMap.end())
+    {
+        return;
+    }
+    if (findRecentRegion(handle) != mRecentRegions.end())
+    {
+        return; // <FS/> Recently left regions, nothing to read
+    }
+
+    prefetch_list_t::iterator prefetched = findPrefetch(handle);
+    if (prefetched != mPrefetches.end())
+    { // announced again, keep it longer
+        mPrefetches.splice(mPrefetches.begin(), mPrefetches, prefetched);
+        return;
+    }
+
+    std::string filename;
+    getObjectCacheFilename(handle, filename);
+
+    const U32 serial = ++mPrefetchSerial;
+    mPrefetches.emplace_front(handle, Prefetch());
+    mPrefetches.front().second.mSerial = serial;
+    while (mPrefetches.size() > llmax((U32)max_regions, 1U))
+    {
+        mPrefetches.pop_back();
+    }
+
+    LL::WorkQueue::ptr_t main_queue = LL::WorkQueue::getInstance("mainloop");
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    bool posted = main_queue && general_queue && main_queue->postTo(
+        general_queue,
+        [filename]() // Work done on general queue
+        {
+            return readPrefetch(filename);
+        },
+        [handle, serial](PrefetchResult result) // Callback to main thread
+        {
+            if (LLVOCache::instanceExists())
+            {
+                LLVOCache::instance().prefetchDone(handle, serial, std::move(result));
+            }
+        });
+    if (!posted)
+    {
+        mPrefetches.pop_front();
+    }
+}
+
+// static
+LLVOCache::PrefetchResult LLVOCache::readPrefetch(const std::string& filename)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+
+    // Same layout readFromCache() reads, with plain stdio, the APR pool
+    // belongs to the main thread
+    PrefetchResult result;
+    LLFILE* fp = LLFile::fopen(filename, "rb");
+    if (!fp)
+    {
+        return result;
+    }
+
+    S32 num_entries = 0;
+    S32 body_size = 0;
+    bool success = fread(result.mCacheID.mData, 1, UUID_BYTES, fp) == UUID_BYTES
+        && fread(&num_entries, 1, sizeof(S32), fp) == sizeof(S32);
+    if (success)
+    {
+        const long start = ftell(fp);
+        success = fseek(fp, 0, SEEK_END) == 0;
+        body_size = success ? (S32)(ftell(fp) - start) : 0;
+        success = success && body_size > 0 && fseek(fp, start, SEEK_SET) == 0;
+    }
+
+    LLPointer<LLVOCacheFileBuffer> file_buffer;
+    if (success)
+    {
+        file_buffer = new LLVOCacheFileBuffer(body_size);
+        success = fread(file_buffer->getData(), 1, body_size, fp) == (size_t)body_size;
+    }
+    fclose(fp);
+
+    S32 offset = 0;
+    for (S32 i = 0; success && i < num_entries && offset < body_size; i++)
+    {
+        LLPointer<LLVOCacheEntry> entry = new LLVOCacheEntry(file_buffer, offset);
+        if (!entry->getLocalID())
+        {
+            success = false;
+            break;
+        }
+        result.mEntries[entry->getLocalID()] = entry;
+    }
+
+    result.mSuccess = success;
+    if (!success)
+    { // readFromCache() reads the file again and deals with it
+        result.mEntries.clear();
+    }
+    return result;
+}
+
+void LLVOCache::prefetchDone(U64 handle, U32 serial, PrefetchResult&& result)
+{
+    prefetch_list_t::iterator prefetched = findPrefetch(handle);
+    if (prefetched == mPrefetches.end() || prefetched->second.mSerial != serial)
+    { // dropped or evicted meanwhile
+        return;
+    }
+    prefetched->second.mDone = true;
+    prefetched->second.mResult = std::move(result);
+}
+
+LLVOCache::prefetch_list_t::iterator LLVOCache::findPrefetch(U64 handle)
+{
+    return std::find_if(mPrefetches.begin(), mPrefetches.end(),
+        [handle](const prefetch_list_t::value_type& prefetch)
+        {
+            return prefetch.first == handle;
+        });
+}
+
+void LLVOCache::dropPrefetch(U64 handle)
+{
+    prefetch_list_t::iterator prefetched = findPrefetch(handle);
+    if (prefetched != mPrefetches.end())
+    {
+        mPrefetches.erase(prefetched);
+    }
+}
+// </FS>
+
+// <FS> Recently left regions
+void LLVOCache::rememberRegion(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, bool removal_enabled)
+{
+    static LLCachedControl<U32> max_regions(gSavedSettings, "FSRecentRegions", 4);
+
+    dropRecentRegion(handle);
+    if (!mEnabled || !mInitialized || !max_regions || mHandleEntryMap.find(handle) == mHandleEntryMap.end())
+    {
+        return;
+    }
+
+    mRecentRegions.emplace_front();
+    RecentRegion& region = mRecentRegions.front();
+    region.mHandle = handle;
+    region.mCacheID = id;
+    for (const auto& entry : cache_entry_map)
+    {
+        if (!removal_enabled || entry.second->isValid())
+        {
+            LLVOCacheEntry* copy = entry.second->clone();
+            region.mEntries[entry.first] = copy;
+            region.mBytes += sizeof(LLVOCacheEntry) + (copy->getDP() ? copy->getDP()->getBufferSize() : 0);
+        }
+    }
+    mRecentRegionBytes += region.mBytes;
+
+    trimRecentRegions();
+}
+
+// <FS> Scene capture
+//static
+bool LLVOCache::exportRegion(const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, const std::string& filename)
+{
+    LLFILE* fp = LLFile::fopen(filename, "wb");
+    if (!fp)
+    {
+        LL_WARNS("VOCache") << "Unable to write " << filename << LL_ENDL;
+        return false;
+    }
+
+    // The count goes in front, it is known once the entries are written
+    S32 num_entries = 0;
+    bool success = fwrite(id.mData, 1, UUID_BYTES, fp) == UUID_BYTES
+        && fwrite(&num_entries, 1, sizeof(S32), fp) == sizeof(S32);
+
+    std::vector<U8> data_buffer(ENTRY_HEADER_SIZE + MAX_ENTRY_BODY_SIZE);
+    for (const auto& entry : cache_entry_map)
+    {
+        if (!success)
+        {
+            break;
+        }
+        const S32 size = entry.second->writeToBuffer(data_buffer.data());
+        if (size > ENTRY_HEADER_SIZE)
+        {
+            success = fwrite(data_buffer.data(), 1, size, fp) == (size_t)size;
+            ++num_entries;
+        }
+    }
+
+    success = success && fseek(fp, UUID_BYTES, SEEK_SET) == 0
+        && fwrite(&num_entries, 1, sizeof(S32), fp) == sizeof(S32);
+    fclose(fp);
+
+    if (!success)
+    {
+        LL_WARNS("VOCache") << "Failed to write " << filename << LL_ENDL;
+        LLFile::remove(filename);
+    }
+    return success;
+}
+
+bool LLVOCache::importRegion(U64 handle, const std::string& filename)
+{
+    if (!mEnabled || !mInitialized || mReadOnly)
+    {
+        return false;
+    }
+
+    PrefetchResult result = readPrefetch(filename);
+    if (!result.mSuccess)
+    {
+        LL_WARNS("VOCache") << "Unable to read object cache entries from " << filename << LL_ENDL;
+        return false;
+    }
+
+    dropRecentRegion(handle);
+    writeToCache(handle, result.mCacheID, result.mEntries, true, false);
+    LL_INFOS("VOCache") << "Imported " << result.mEntries.size() << " entries for handle " << handle << " from " << filename << LL_ENDL;
+    return true;
+}
+// </FS>
+
+LLVOCache::recent_region_list_t::iterator LLVOCache::findRecentRegion(U64 handle)
+{
+    return std::find_if(mRecentRegions.begin(), mRecentRegions.end(),
+        [handle](const RecentRegion& region)
+        {
+            return region.mHandle == handle;
+        });
+}
+
+void LLVOCache::dropRecentRegion(U64 handle)
+{
+    recent_region_list_t::iterator recent = findRecentRegion(handle);
+    if (recent != mRecentRegions.end())
+    {
+        mRecentRegionBytes -= recent->mBytes;
+        mRecentRegions.erase(recent);
+    }
+}
+
+void LLVOCache::trimRecentRegions()
+{
+    static LLCachedControl<U32> max_regions(gSavedSettings, "FSRecentRegions", 4);
+    static LLCachedControl<U32> max_mb(gSavedSettings, "FSRecentRegionsMemoryMB", 64);
+
+    const size_t max_bytes = (size_t)max_mb * 1024 * 1024;
+    while (!mRecentRegions.empty() && (mRecentRegions.size() > max_regions || mRecentRegionBytes > max_bytes))
+    {
+        mRecentRegionBytes -= mRecentRegions.back().mBytes;
+        mRecentRegions.pop_back();
+    }
+}
+// </FS>
+
 // We now pass in the cache entry map, so that we can remove entries from extras that are no longer in the primary cache.
-void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map)
+// <FS> Binary override cache
+//void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map)
+void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, LLGLTFOverrideCacheBlobs& cache_extras_blobs, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map)
+// </FS>
 {
 	LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
     int loaded= 0;
@@ -1673,7 +2263,22 @@ void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCac
     }
     // For future versions we may call a legacy handler here, but realistically we'll just consider this cache out of date.
     // The important thing is to make sure it gets removed.
-    if(versionNumber != LLGLTFOverrideCacheEntry::VERSION)
+    // <FS> Binary override cache
+    //if(versionNumber != LLGLTFOverrideCacheEntry::VERSION)
+    if (versionNumber == LLGLTFOverrideCacheEntry::VERSION)
+    {
+        // Only indexed here, the entries are decoded when their objects show up
+        if (!readBinaryGenericExtras(handle, id, in, cache_extras_blobs, cache_entry_map))
+        {
+            in.close();
+            cache_extras_blobs.clear();
+            removeGenericExtrasForHandle(handle);
+        }
+        return;
+    }
+    // LLSD files are read as before and rewritten as binary right away
+    if (versionNumber != LLSD_EXTRAS_VERSION)
+    // </FS>
     {
         LL_WARNS() << "Unexpected version number " << versionNumber << " for extras cache for handle " << handle << LL_ENDL;
         in.close();
@@ -1761,8 +2366,98 @@ void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCac
         }
     }
     LL_DEBUGS("GLTF") << "Completed reading extras cache for handle " << handle << ", " << loaded << " loaded, " << discarded << " discarded" << LL_ENDL;
+
+    // <FS> Binary override cache
+    // A failed read closed the file and removed it already
+    if (in.is_open())
+    {
+        in.close();
+        LL_INFOS("GLTF") << "Converting extras cache for handle " << handle << " to the binary format" << LL_ENDL;
+        writeGenericExtrasToCache(handle, id, cache_extras_entry_map, cache_extras_blobs, true, false);
+    }
+    // </FS>
 }
 
+// <FS> Binary override cache
+bool LLVOCache::readBinaryGenericExtras(U64 handle, const LLUUID& id, std::istream& in, LLGLTFOverrideCacheBlobs& cache_extras_blobs, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+
+    cache_extras_blobs.clear();
+    cache_extras_blobs.mRegionHandle = handle;
+
+    const std::streampos start = in.tellg();
+    in.seekg(0, std::ios::end);
+    const std::streamoff file_size = in.tellg() - start;
+    in.seekg(start);
+    if (!in.good() || file_size < (std::streamoff)(UUID_BYTES + sizeof(U32)) || file_size > S32_MAX)
+    {
+        LL_WARNS() << "Failed reading extras cache for handle " << handle << ", unexpected size " << file_size << LL_ENDL;
+        return false;
+    }
+
+    const U32 size = (U32)file_size;
+    LLPointer<LLVOCacheFileBuffer> file_buffer = new LLVOCacheFileBuffer((S32)size);
+    in.read(reinterpret_cast<char*>(file_buffer->getData()), size);
+    if (!in.good())
+    {
+        LL_WARNS() << "Failed reading extras cache for handle " << handle << LL_ENDL;
+        return false;
+    }
+
+    const U8* data = file_buffer->getData();
+    LLUUID cache_id;
+    memcpy(cache_id.mData, data, UUID_BYTES);
+    if (cache_id != id)
+    {
+        LL_WARNS() << "Cache ID doesn't match for this region, deleting it" << LL_ENDL;
+        return false;
+    }
+
+    const U32 num_entries = read_value<U32>(data + UUID_BYTES);
+    U32 offset = UUID_BYTES + sizeof(U32);
+    U32 loaded = 0;
+    U32 discarded = 0;
+    for (U32 i = 0; i < num_entries; ++i)
+    {
+        if (size - offset < sizeof(U32))
+        {
+            LL_WARNS() << "Failed reading extras cache for handle " << handle << ", entry number " << i << " truncated" << LL_ENDL;
+            cache_extras_blobs.clear();
+            return false;
+        }
+        const U32 entry_size = read_value<U32>(data + offset);
+        offset += sizeof(U32);
+        if (entry_size < BINARY_ENTRY_HEADER_SIZE || size - offset < entry_size)
+        {
+            LL_WARNS() << "Failed reading extras cache for handle " << handle << ", entry number " << i << " truncated" << LL_ENDL;
+            cache_extras_blobs.clear();
+            return false;
+        }
+
+        // only add entries that exist in the primary cache, as the LLSD format does
+        const U32 local_id = read_value<U32>(data + offset);
+        if (cache_entry_map.find(local_id) != cache_entry_map.end())
+        {
+            cache_extras_blobs.mBlobs[local_id] = { offset, entry_size };
+            loaded++;
+        }
+        else
+        {
+            discarded++;
+        }
+        offset += entry_size;
+    }
+
+    if (!cache_extras_blobs.mBlobs.empty())
+    {
+        cache_extras_blobs.mBuffer = file_buffer;
+    }
+    LL_DEBUGS("GLTF") << "Completed indexing extras cache for handle " << handle << ", " << loaded << " loaded, " << discarded << " discarded" << LL_ENDL;
+    return true;
+}
+// </FS>
+
 void LLVOCache::purgeEntries(U32 size)
 {
 	LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
@@ -1797,6 +2492,8 @@ void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry:
         return ;
     }
 
+    dropPrefetch(handle); // <FS/> Object cache prefetch, the file changes
+
     HeaderEntryInfo* entry;
     handle_entry_map_t::iterator iter = mHandleEntryMap.find(handle) ;
     if(iter == mHandleEntryMap.end()) //new entry
@@ -1934,7 +2631,10 @@ void LLVOCache::removeGenericExtrasForHandle(U64 handle)
     }
 }
 
-void LLVOCache::writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, bool dirty_cache, bool removal_enabled)
+// <FS> Binary override cache
+//void LLVOCache::writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, bool dirty_cache, bool removal_enabled)
+void LLVOCache::writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLGLTFOverrideCacheBlobs& cache_extras_blobs, bool dirty_cache, bool removal_enabled)
+// </FS>
 {
 	LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
     if(!mEnabled)
@@ -1962,22 +2662,79 @@ void LLVOCache::writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LL
     // legacy versions will be treated as version 0.
     out << LLGLTFOverrideCacheEntry::VERSION_LABEL << ":" << LLGLTFOverrideCacheEntry::VERSION << '\n';
 
-    out << id << '\n';
-    if(!out.good())
-    {
-        LL_WARNS() << "Failed writing extras cache for handle " << handle << LL_ENDL;
-        removeGenericExtrasForHandle(handle);
-        return;
-    }
-    // Because we don't write out all the entries we need to record a placeholder and rewrite this later
-    auto num_entries_placeholder = out.tellp();
-    out << std::setw(10) << std::setfill('0') << 0 << '\n';
-    if(!out.good())
-    {
-        LL_WARNS() << "Failed writing extras cache for handle " << handle << LL_ENDL;
-        removeGenericExtrasForHandle(handle);
-        return;
-    }
+    // <FS> Binary override cache
+    // The region id and entry count, then each entry's size and data. The
+    // entries that were never decoded are copied over as they are.
+    //out << id << '\n';
+    //if(!out.good())
+    //{
+        //LL_WARNS() << "Failed writing extras cache for handle " << handle << LL_ENDL;
+        //removeGenericExtrasForHandle(handle);
+        //return;
+    //}
+    //// Because we don't write out all the entries we need to record a placeholder and rewrite this later
+    //auto num_entries_placeholder = out.tellp();
+    //out << std::setw(10) << std::setfill('0') << 0 << '\n';
+    //if(!out.good())
+    //{
+        //LL_WARNS() << "Failed writing extras cache for handle " << handle << LL_ENDL;
+        //removeGenericExtrasForHandle(handle);
+        //return;
+    //}
+
+    //// get ViewerRegion pointer from handle
+    //LLViewerRegion* pRegion = LLWorld::getInstance()->getRegionFromHandle(handle);
+
+    //U32 num_entries = 0;
+    //U32 skipped = 0;
+    //size_t inmem_entries = cache_extras_entry_map.size();
+    //for (auto [local_id, entry] : cache_extras_entry_map)
+    //{
+        //// Only write out GLTFOverrides that we can actually apply again on import.
+        //// worst case we have an extra cache miss.
+        //// Note: A null mObjectId is valid when in memory as we might have a data race between GLTF of the object itself.
+        //// This remains a valid state to persist as it is consistent with the localid checks on import with the main cache.
+        //// the mObjectId will be updated if/when the local object is updated from the gObject list (due to full update)
+        //if(entry.mObjectId.isNull() && pRegion)
+        //{
+            //gObjectList.getUUIDFromLocal( entry.mObjectId, local_id, pRegion->getHost().getAddress(), pRegion->getHost().getPort() );
+        //}
+
+        //if( entry.mSides.size() > 0 &&
+            //entry.mSides.size() == entry.mGLTFMaterial.size()
+          //)
+        //{
+            //LLSD entry_llsd = entry.toLLSD();
+            //entry_llsd["local_id"] = (S32)local_id;
+            //LLSDSerialize::serialize(entry_llsd, out, LLSDSerialize::LLSD_XML);
+            //out << '\n';
+            //if(!out.good())
+            //{
+                //// We're not in a good place when this happens so we might as well nuke the file.
+                //LL_WARNS() << "Failed writing extras cache for handle " << handle << ". Corrupted cache file " << filename << " removed." << LL_ENDL;
+                //removeGenericExtrasForHandle(handle);
+                //return;
+            //}
+            //num_entries++;
+        //}
+        //else
+        //{
+            //skipped++;
+        //}
+    //}
+    //// Rewrite the placeholder
+    //out.seekp(num_entries_placeholder);
+    //out << std::setw(10) << std::setfill('0') << num_entries << '\n';
+    //if(!out.good())
+    //{
+        //LL_WARNS() << "Failed writing extras cache for handle " << handle << LL_ENDL;
+        //removeGenericExtrasForHandle(handle);
+        //return;
+    //}
+    //LL_DEBUGS("GLTF") << "Completed writing extras cache for handle " << handle << ", " << num_entries << " entries. Total in RAM: " << inmem_entries << " skipped (no persist): " << skipped << LL_ENDL;
+    std::string data;
+    data.append(reinterpret_cast<const char*>(id.mData), UUID_BYTES);
+    append_value<U32>(data, 0); // entry count, filled in below
 
     // get ViewerRegion pointer from handle
     LLViewerRegion* pRegion = LLWorld::getInstance()->getRegionFromHandle(handle);
@@ -1988,10 +2745,7 @@ void LLVOCache::writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LL
     for (auto [local_id, entry] : cache_extras_entry_map)
     {
         // Only write out GLTFOverrides that we can actually apply again on import.
-        // worst case we have an extra cache miss.
-        // Note: A null mObjectId is valid when in memory as we might have a data race between GLTF of the object itself.
-        // This remains a valid state to persist as it is consistent with the localid checks on import with the main cache.
-        // the mObjectId will be updated if/when the local object is updated from the gObject list (due to full update)
+        // A null mObjectId is valid, it is backfilled when the object shows up.
         if(entry.mObjectId.isNull() && pRegion)
         {
             gObjectList.getUUIDFromLocal( entry.mObjectId, local_id, pRegion->getHost().getAddress(), pRegion->getHost().getPort() );
@@ -2001,17 +2755,12 @@ void LLVOCache::writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LL
             entry.mSides.size() == entry.mGLTFMaterial.size()
           )
         {
-            LLSD entry_llsd = entry.toLLSD();
-            entry_llsd["local_id"] = (S32)local_id;
-            LLSDSerialize::serialize(entry_llsd, out, LLSDSerialize::LLSD_XML);
-            out << '\n';
-            if(!out.good())
-            {
-                // We're not in a good place when this happens so we might as well nuke the file.
-                LL_WARNS() << "Failed writing extras cache for handle " << handle << ". Corrupted cache file " << filename << " removed." << LL_ENDL;
-                removeGenericExtrasForHandle(handle);
-                return;
-            }
+            entry.mLocalId = local_id;
+            const size_t size_pos = data.size();
+            append_value<U32>(data, 0);
+            entry.toBinary(data);
+            const U32 entry_size = (U32)(data.size() - size_pos - sizeof(U32));
+            memcpy(&data[size_pos], &entry_size, sizeof(U32));
             num_entries++;
         }
         else
@@ -2019,14 +2768,30 @@ void LLVOCache::writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LL
             skipped++;
         }
     }
-    // Rewrite the placeholder
-    out.seekp(num_entries_placeholder);
-    out << std::setw(10) << std::setfill('0') << num_entries << '\n';
+
+    U32 undecoded_entries = 0;
+    for (const auto& [local_id, blob] : cache_extras_blobs.mBlobs)
+    {
+        if (cache_extras_entry_map.find(local_id) == cache_extras_entry_map.end())
+        {
+            append_value<U32>(data, blob.mSize);
+            data.append(reinterpret_cast<const char*>(cache_extras_blobs.mBuffer->getData() + blob.mOffset), blob.mSize);
+            undecoded_entries++;
+        }
+    }
+    num_entries += undecoded_entries;
+    memcpy(&data[UUID_BYTES], &num_entries, sizeof(U32));
+
+    out.write(data.data(), data.size());
     if(!out.good())
     {
-        LL_WARNS() << "Failed writing extras cache for handle " << handle << LL_ENDL;
+        // We're not in a good place when this happens so we might as well nuke the file.
+        LL_WARNS() << "Failed writing extras cache for handle " << handle << ". Corrupted cache file " << filename << " removed." << LL_ENDL;
+        out.close();
         removeGenericExtrasForHandle(handle);
         return;
     }
-    LL_DEBUGS("GLTF") << "Completed writing extras cache for handle " << handle << ", " << num_entries << " entries. Total in RAM: " << inmem_entries << " skipped (no persist): " << skipped << LL_ENDL;
+    LL_DEBUGS("GLTF") << "Completed writing extras cache for handle " << handle << ", " << num_entries << " entries, " << undecoded_entries
+                      << " of them never decoded. Total in RAM: " << inmem_entries << " skipped (no persist): " << skipped << LL_ENDL;
+    // </FS>
 }
@@ -34,6 +34,7 @@
 #include "llapr.h"
 #include "llgltfmaterial.h"
 
+#include <list>
 #include <unordered_map>
 
 //---------------------------------------------------------------------------
@@ -47,6 +48,13 @@ public:
     static const int VERSION;
     bool fromLLSD(const LLSD& data);
     LLSD toLLSD() const;
+    // <FS> Binary override cache
+    // Entry layout of the binary extras file: local id, object id, side
+    // count, then each side's index and binary LLSD. The region handle is
+    // not part of it, all entries of a file share it.
+    bool fromBinary(const U8* data, U32 size, U64 region_handle);
+    void toBinary(std::string& out) const;
+    // </FS>
 
     LLUUID mObjectId;
     U32    mLocalId = 0;
@@ -55,6 +63,54 @@ public:
     U64 mRegionHandle = 0;
 };
 
+// <FS> Shared object cache file
+// The entries of a region's object cache file, read in one go. The entries
+// read from it point into it instead of having their own copy, until they
+// are updated.
+class LLVOCacheFileBuffer : public LLRefCount
+{
+public:
+    LLVOCacheFileBuffer(S32 size) : mData(new U8[size]), mSize(size) {}
+
+    U8* getData() const { return mData; }
+    S32 getSize() const { return mSize; }
+
+protected:
+    ~LLVOCacheFileBuffer() { delete[] mData; }
+
+private:
+    U8* mData;
+    S32 mSize;
+};
+// </FS>
+
+// <FS> Binary override cache
+// Overrides of a binary extras file that were not looked up yet, by local
+// id. They are decoded when their object shows up, and written back to the
+// file as they are if it never does.
+class LLGLTFOverrideCacheBlobs
+{
+public:
+    struct Blob
+    {
+        U32 mOffset;
+        U32 mSize;
+    };
+    typedef std::unordered_map<U32, Blob> blob_map_t;
+
+    void clear();
+    void erase(U32 local_id) { mBlobs.erase(local_id); }
+
+    // Moves the override of local_id into entry, false if there is none or
+    // it doesn't decode
+    bool take(U32 local_id, LLGLTFOverrideCacheEntry& entry);
+
+    LLPointer<LLVOCacheFileBuffer> mBuffer;
+    blob_map_t mBlobs;
+    U64 mRegionHandle = 0;
+};
+// </FS>
+
 class LLVOCacheEntry
 :   public LLViewerOctreeEntryData
 {
@@ -110,7 +166,9 @@ protected:
 public:
     LLVOCacheEntry(U32 local_id, U32 crc, LLDataPackerBinaryBuffer &dp);
     LLVOCacheEntry(LLAPRFile* apr_file);
+    LLVOCacheEntry(LLVOCacheFileBuffer* file_buffer, S32& offset); // <FS/> Shared object cache file
     LLVOCacheEntry();
+    LLVOCacheEntry* clone() const; // <FS/> Recently left regions, fresh as if read from the cache file
 
     void updateEntry(U32 crc, LLDataPackerBinaryBuffer &dp);
 
@@ -164,6 +222,10 @@ public:
 
 private:
     void updateParentBoundingInfo(const LLVOCacheEntry* child);
+    // <FS> Shared object cache file
+    bool unpackHeader(const U8* data_buffer, S32& size);
+    void freeBuffer();
+    // </FS>
 
 public:
     typedef std::map<U32, LLPointer<LLVOCacheEntry> >      vocache_entry_map_t;
@@ -183,6 +245,7 @@ protected:
     S32                         mCRCChangeCount;
     LLDataPackerBinaryBuffer    mDP;
     U8                          *mBuffer;
+    LLPointer<LLVOCacheFileBuffer> mFileBuffer; // <FS/> Shared object cache file, owns mBuffer when set
 
     F32                         mSceneContrib; //projected scene contributuion of this object.
     U32                         mState; //high 16 bits reserved for special use.
@@ -293,16 +356,47 @@ public:
     void removeCache(ELLPath location, bool started = false) ;
 
     bool readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map) ;
-    void readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map);
+    // <FS> Binary override cache
+    //void readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map);
+    void readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, LLGLTFOverrideCacheBlobs& cache_extras_blobs, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map);
+    // </FS>
 
     void writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, bool dirty_cache, bool removal_enabled);
-    void writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, bool dirty_cache, bool removal_enabled);
+    // <FS> Binary override cache
+    //void writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, bool dirty_cache, bool removal_enabled);
+    void writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLGLTFOverrideCacheBlobs& cache_extras_blobs, bool dirty_cache, bool removal_enabled);
+    // </FS>
     void removeEntry(U64 handle) ;
     void removeGenericExtrasForHandle(U64 handle);
 
     U32 getCacheEntries() { return mNumEntries; }
     U32 getCacheEntriesMax() { return mCacheSize; }
 
+    // <FS> Object cache prefetch
+    // Threads:  Tmain
+    // Start reading and parsing the cache file of a region announced by the
+    // simulator on the General pool, readFromCache() takes the entries from
+    // there instead of reading the file itself.
+    void prefetch(U64 handle);
+    // </FS>
+
+    // <FS> Recently left regions
+    // Threads:  Tmain
+    // Keep copies of the entries of a region that is being left in memory,
+    // within FSRecentRegionsMemoryMB, so readFromCache() takes them without
+    // going back to the file if the agent returns. Same entries as
+    // writeToCache() writes.
+    void rememberRegion(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, bool removal_enabled);
+    // </FS>
+
+    // <FS> Scene capture
+    // Threads:  Tmain
+    // Write the entries of a region to a file laid out like the cache files,
+    // and put the entries of such a file into the cache for a region handle.
+    static bool exportRegion(const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, const std::string& filename);
+    bool importRegion(U64 handle, const std::string& filename);
+    // </FS>
+
 private:
     void setDirNames(ELLPath location);
     // determine the cache filename for the region from the region handle
@@ -317,6 +411,49 @@ private:
     void purgeEntries(U32 size);
     bool updateEntry(const HeaderEntryInfo* entry);
 
+    // <FS> Binary override cache
+    // Index the entries of a binary extras file, in is past the version line
+    bool readBinaryGenericExtras(U64 handle, const LLUUID& id, std::istream& in, LLGLTFOverrideCacheBlobs& cache_extras_blobs, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map);
+    // </FS>
+
+    // <FS> Object cache prefetch
+    struct PrefetchResult
+    {
+        bool mSuccess = false;
+        LLUUID mCacheID;
+        LLVOCacheEntry::vocache_entry_map_t mEntries;
+    };
+    struct Prefetch
+    {
+        U32 mSerial = 0;
+        bool mDone = false;
+        PrefetchResult mResult;
+    };
+    typedef std::list<std::pair<U64, Prefetch> > prefetch_list_t;
+
+    // Threads:  Tgeneral
+    static PrefetchResult readPrefetch(const std::string& filename);
+    // Threads:  Tmain
+    void prefetchDone(U64 handle, U32 serial, PrefetchResult&& result);
+    prefetch_list_t::iterator findPrefetch(U64 handle);
+    void dropPrefetch(U64 handle);
+    // </FS>
+
+    // <FS> Recently left regions
+    struct RecentRegion
+    {
+        U64 mHandle = 0;
+        LLUUID mCacheID;
+        LLVOCacheEntry::vocache_entry_map_t mEntries;
+        size_t mBytes = 0;
+    };
+    typedef std::list<RecentRegion> recent_region_list_t;
+
+    recent_region_list_t::iterator findRecentRegion(U64 handle);
+    void dropRecentRegion(U64 handle);
+    void trimRecentRegions();
+    // </FS>
+
 private:
     bool                 mEnabled;
     bool                 mInitialized ;
@@ -329,6 +466,10 @@ private:
     LLVolatileAPRPool*   mLocalAPRFilePoolp ;
     header_entry_queue_t mHeaderEntryQueue;
     handle_entry_map_t   mHandleEntryMap;
+    prefetch_list_t      mPrefetches; // <FS/> Object cache prefetch, most recently announced in front
+    U32                  mPrefetchSerial; // <FS/> Object cache prefetch
+    recent_region_list_t mRecentRegions; // <FS/> Recently left regions, most recently left in front
+    size_t               mRecentRegionBytes; // <FS/> Recently left regions
 };
 
 #endif
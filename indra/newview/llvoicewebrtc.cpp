@@ -89,6 +89,11 @@ namespace {
 
     const uint32_t PEER_GAIN_CONVERSION_FACTOR = 220;
 
+    // <FS> Power changes smaller than this (in 1/128 level steps) are not
+    // passed on from the data channel
+    const S32 POWER_REPORT_THRESHOLD = 4;
+    // </FS>
+
     static const std::string REPORTED_VOICE_SERVER_TYPE = "Secondlife WebRTC Gateway";
 
     // Don't send positional updates more frequently than this:
@@ -220,7 +225,11 @@ LLWebRTCVoiceClient::LLWebRTCVoiceClient() :
     mIsProcessingChannels(false),
     mIsCoroutineActive(false),
     mWebRTCPump("WebRTCClientPump"),
-    mWebRTCDeviceInterface(nullptr)
+    mWebRTCDeviceInterface(nullptr),
+    // <FS> Off-main-thread data channel processing
+    mDeferParticipantNotify(0),
+    mParticipantsChanged(false)
+    // </FS>
 {
     sShuttingDown = false;
 
@@ -379,6 +388,15 @@ void LLWebRTCVoiceClient::removeObserver(LLVoiceClientParticipantObserver *obser
 void LLWebRTCVoiceClient::notifyParticipantObservers()
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VOICE;
+
+    // <FS> Off-main-thread data channel processing
+    if (mDeferParticipantNotify > 0)
+    {
+        mParticipantsChanged = true;
+        return;
+    }
+    mParticipantsChanged = false;
+    // </FS>
     for (observer_set_t::iterator it = mParticipantObservers.begin(); it != mParticipantObservers.end();)
     {
         LLVoiceClientParticipantObserver *observer = *it;
@@ -388,6 +406,20 @@ void LLWebRTCVoiceClient::notifyParticipantObservers()
     }
 }
 
+// <FS> Off-main-thread data channel processing
+void LLWebRTCVoiceClient::deferParticipantNotifications(bool defer)
+{
+    if (defer)
+    {
+        ++mDeferParticipantNotify;
+    }
+    else if (mDeferParticipantNotify > 0 && --mDeferParticipantNotify == 0 && mParticipantsChanged && !sShuttingDown)
+    {
+        notifyParticipantObservers();
+    }
+}
+// </FS>
+
 void LLWebRTCVoiceClient::addObserver(LLVoiceClientStatusObserver *observer)
 {
     mStatusObservers.insert(observer);
@@ -2678,6 +2710,7 @@ bool LLVoiceWebRTCConnection::connectionStateMachine()
     if (!mShutDown)
     {
         processIceUpdates();
+        processDataUpdates(); // <FS/> Off-main-thread data channel processing
     }
 
     switch (getVoiceConnectionState())
@@ -2886,7 +2919,11 @@ bool LLVoiceWebRTCConnection::connectionStateMachine()
 // llwebrtc callback
 void LLVoiceWebRTCConnection::OnDataReceived(const std::string& data, bool binary)
 {
-    LL::WorkQueue::postMaybe(mMainQueue, [=] { LLVoiceWebRTCConnection::OnDataReceivedImpl(data, binary); });
+    // <FS> Parse and diff data channel updates on the webrtc thread, the
+    // voice loop applies what changed
+    //LL::WorkQueue::postMaybe(mMainQueue, [=] { LLVoiceWebRTCConnection::OnDataReceivedImpl(data, binary); });
+    OnDataReceivedImpl(data, binary);
+    // </FS>
 }
 
 //
@@ -2894,15 +2931,14 @@ void LLVoiceWebRTCConnection::OnDataReceived(const std::string& data, bool binar
 // before the webrtc connection itself is shut down, so
 // we shouldn't be getting this callback on a nonexistant
 // this pointer.
+// <FS> Runs on the webrtc thread. Power, voice activity and moderator
+// mute updates that don't change what the viewer shows are dropped here,
+// the rest is merged per participant until processDataUpdates() picks it
+// up. At 50+ participants most power updates are noise.
 void LLVoiceWebRTCConnection::OnDataReceivedImpl(const std::string &data, bool binary)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VOICE;
 
-    if (mShutDown)
-    {
-        return;
-    }
-
     if (binary)
     {
         LL_WARNS("Voice") << "Binary data received from data channel." << LL_ENDL;
@@ -2911,124 +2947,226 @@ void LLVoiceWebRTCConnection::OnDataReceivedImpl(const std::string &data, bool b
 
     boost::system::error_code ec;
     boost::json::value voice_data_parsed = boost::json::parse(data, ec);
-    if (!ec)  // don't collect comments
+    if (ec)  // don't collect comments
     {
-        if (!voice_data_parsed.is_object())
+        return;
+    }
+    if (!voice_data_parsed.is_object())
+    {
+        LL_WARNS("Voice") << "Expected object from data channel:" << data << LL_ENDL;
+        return;
+    }
+
+    std::vector<std::pair<LLUUID, ParticipantUpdate>> updates;
+    for (auto &participant_elem : voice_data_parsed.as_object())
+    {
+        LLUUID agent_id(std::string(participant_elem.key()));
+        if (agent_id.isNull())
         {
-            LL_WARNS("Voice") << "Expected object from data channel:" << data << LL_ENDL;
-            return;
+           // probably a test client.
+           continue;
         }
-        boost::json::object voice_data = voice_data_parsed.as_object();
-        bool new_participant = false;
-        boost::json::object mute;
-        boost::json::object user_gain;
-        for (auto &participant_elem : voice_data)
+
+        if (!participant_elem.value().is_object())
         {
-            boost::json::string participant_id(participant_elem.key());
-            LLUUID agent_id(participant_id.c_str());
-            if (agent_id.isNull())
-            {
-               // probably a test client.
-               continue;
-            }
+            continue;
+        }
+
+        const boost::json::object& participant_obj = participant_elem.value().as_object();
+        ParticipantUpdate update;
+        ReportedState& reported = mReportedStates[agent_id];
 
-            if (!participant_elem.value().is_object())
+        if (const boost::json::value* join = participant_obj.if_contains("j"); join && join->is_object())
+        {
+            // a new participant has announced that they're joining.
+            update.mJoined = true;
+            if (const boost::json::value* primary = join->as_object().if_contains("p"); primary && primary->is_bool())
             {
-                continue;
+                update.mPrimary = primary->as_bool();
             }
+            // whatever comes next applies to a participant that may have just been created
+            reported = ReportedState();
+        }
 
-            boost::json::object participant_obj = participant_elem.value().as_object();
-
-            LLWebRTCVoiceClient::participantStatePtr_t participant =
-                LLWebRTCVoiceClient::getInstance()->findParticipantByID(mChannelID, agent_id);
-            bool joined  = false;
-            bool primary = false;  // we ignore any 'joins' reported about participants
-                                   // that come from voice servers that aren't their primary
-                                   // voice server.  This will happen with cross-region voice
-                                   // where a participant on a neighboring region may be
-                                   // connected to multiple servers.  We don't want to
-                                   // add new identical participants from all of those servers.
-            if (participant_obj.contains("j") &&
-                participant_obj["j"].is_object())
+        if (const boost::json::value* leave = participant_obj.if_contains("l"); leave && leave->is_bool() && leave->as_bool())
+        {
+            // an existing participant is leaving.
+            update.mLeft = true;
+            mReportedStates.erase(agent_id);
+        }
+        else
+        {
+            // server sends up power as an integer which is level * 128 to save
+            // character count.
+            if (const boost::json::value* power = participant_obj.if_contains("p"); power && power->is_number())
             {
-                // a new participant has announced that they're joining.
-                joined  = true;
-                if (participant_elem.value().as_object()["j"].as_object().contains("p") &&
-                    participant_elem.value().as_object()["j"].as_object()["p"].is_bool())
+                S32 value = (S32)power->to_number<double>();
+                if (reported.mPower < 0 || (value == 0) != (reported.mPower == 0) ||
+                    llabs(value - reported.mPower) >= POWER_REPORT_THRESHOLD)
                 {
-                    primary = participant_elem.value().as_object()["j"].as_object()["p"].as_bool();
+                    update.mPower = value;
+                    reported.mPower = value;
                 }
+            }
 
-                // track incoming participants that are muted so we can mute their connections (or set their volume)
-                bool isMuted = LLMuteList::getInstance()->isMuted(agent_id, LLMute::flagVoiceChat);
-                if (isMuted)
+            if (const boost::json::value* speaking = participant_obj.if_contains("v"); speaking && speaking->is_bool())
+            {
+                S8 value = speaking->as_bool() ? 1 : 0;
+                if (value != reported.mSpeaking)
                 {
-                    mute[participant_id] = true;
+                    update.mSpeaking = value;
+                    reported.mSpeaking = value;
                 }
-                F32 volume;
-                if(LLSpeakerVolumeStorage::getInstance()->getSpeakerVolume(agent_id, volume))
+            }
+
+            if (const boost::json::value* muted = participant_obj.if_contains("m"); muted && muted->is_bool())
+            {
+                S8 value = muted->as_bool() ? 1 : 0;
+                if (value != reported.mModeratorMuted)
                 {
-                    user_gain[participant_id] = (uint32_t)(volume * 200);
+                    update.mModeratorMuted = value;
+                    reported.mModeratorMuted = value;
                 }
             }
+        }
+
+        if (update.mJoined || update.mLeft || update.mPower >= 0 || update.mSpeaking >= 0 || update.mModeratorMuted >= 0)
+        {
+            updates.emplace_back(agent_id, update);
+        }
+    }
+
+    if (updates.empty())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mPendingUpdatesMutex);
+    for (const auto& [agent_id, update] : updates)
+    {
+        ParticipantUpdate& pending = mPendingUpdates[agent_id];
+        if (update.mLeft)
+        {
+            pending = update;
+            continue;
+        }
+        if (update.mJoined)
+        {
+            pending.mJoined = true;
+            pending.mPrimary |= update.mPrimary;
+            pending.mLeft = false;
+        }
+        if (update.mPower >= 0)
+        {
+            pending.mPower = update.mPower;
+        }
+        if (update.mSpeaking >= 0)
+        {
+            pending.mSpeaking = update.mSpeaking;
+        }
+        if (update.mModeratorMuted >= 0)
+        {
+            pending.mModeratorMuted = update.mModeratorMuted;
+        }
+    }
+}
 
-            new_participant |= joined;
-            if (!participant && joined && (primary || !isSpatial()))
+// Applies the updates collected since the last pass of the voice loop, with
+// a single participant notification for all of them.
+void LLVoiceWebRTCConnection::processDataUpdates()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_VOICE;
+
+    std::map<LLUUID, ParticipantUpdate> updates;
+    {
+        std::lock_guard<std::mutex> lock(mPendingUpdatesMutex);
+        updates.swap(mPendingUpdates);
+    }
+    if (updates.empty() || mShutDown)
+    {
+        return;
+    }
+
+    LLWebRTCVoiceClient* voice_client = LLWebRTCVoiceClient::getInstance();
+    voice_client->deferParticipantNotifications(true);
+
+    boost::json::object mute;
+    boost::json::object user_gain;
+    for (const auto& [agent_id, update] : updates)
+    {
+        boost::json::string participant_id(agent_id.asString());
+        LLWebRTCVoiceClient::participantStatePtr_t participant = voice_client->findParticipantByID(mChannelID, agent_id);
+
+        if (update.mJoined)
+        {
+            // track incoming participants that are muted so we can mute their connections (or set their volume)
+            bool isMuted = LLMuteList::getInstance()->isMuted(agent_id, LLMute::flagVoiceChat);
+            if (isMuted)
+            {
+                mute[participant_id] = true;
+            }
+            F32 volume;
+            if(LLSpeakerVolumeStorage::getInstance()->getSpeakerVolume(agent_id, volume))
             {
-                participant = LLWebRTCVoiceClient::getInstance()->addParticipantByID(mChannelID, agent_id, mRegionID);
+                user_gain[participant_id] = (uint32_t)(volume * 200);
             }
 
-            if (participant)
+            // we ignore any 'joins' reported about participants that come
+            // from voice servers that aren't their primary voice server.
+            if (!participant && (update.mPrimary || !isSpatial()))
             {
-                if (participant_obj.contains("l") && participant_obj["l"].is_bool() && participant_obj["l"].as_bool())
-                {
-                    // an existing participant is leaving.
-                    if (agent_id != gAgentID)
-                    {
-                        LLWebRTCVoiceClient::getInstance()->removeParticipantByID(mChannelID, agent_id, mRegionID);
-                    }
-                }
-                else
-                {
-                    // we got a 'power' update.
-                    if (participant_obj.contains("p") && participant_obj["p"].is_number())
-                    {
-                        // server sends up power as an integer which is level * 128 to save
-                        // character count.
-                        participant->mLevel = (F32)participant_obj["p"].as_int64()/128.0f;
-                    }
+                participant = voice_client->addParticipantByID(mChannelID, agent_id, mRegionID);
+            }
+        }
 
-                    if (participant_obj.contains("v") && participant_obj["v"].is_bool())
-                    {
-                        participant->mIsSpeaking = participant_obj["v"].as_bool();
-                    }
+        if (!participant)
+        {
+            continue;
+        }
 
-                    if (participant_obj.contains("m") && participant_obj["m"].is_bool())
-                    {
-                        participant->mIsModeratorMuted = participant_obj["m"].as_bool();
-                    }
-                }
+        if (update.mLeft)
+        {
+            if (agent_id != gAgentID)
+            {
+                voice_client->removeParticipantByID(mChannelID, agent_id, mRegionID);
             }
+            continue;
         }
 
-        // tell the simulator to set the mute and volume data for this
-        // participant, if there are any updates.
-        boost::json::object root;
-        if (mute.size() > 0)
+        if (update.mPower >= 0)
         {
-            root["m"] = mute;
+            participant->mLevel = (F32)update.mPower / 128.0f;
         }
-        if (user_gain.size() > 0)
+        if (update.mSpeaking >= 0)
         {
-            root["ug"] = user_gain;
+            participant->mIsSpeaking = update.mSpeaking != 0;
         }
-        if (root.size() > 0)
+        if (update.mModeratorMuted >= 0)
         {
-            std::string json_data = boost::json::serialize(root);
-            mWebRTCDataInterface->sendData(json_data, false);
+            participant->mIsModeratorMuted = update.mModeratorMuted != 0;
         }
     }
+
+    voice_client->deferParticipantNotifications(false);
+
+    // tell the simulator to set the mute and volume data for this
+    // participant, if there are any updates.
+    boost::json::object root;
+    if (mute.size() > 0)
+    {
+        root["m"] = mute;
+    }
+    if (user_gain.size() > 0)
+    {
+        root["ug"] = user_gain;
+    }
+    if (root.size() > 0 && mWebRTCDataInterface)
+    {
+        std::string json_data = boost::json::serialize(root);
+        mWebRTCDataInterface->sendData(json_data, false);
+    }
 }
+// </FS>
 
 //
 // The LLWebRTCVoiceConnection object will not be deleted
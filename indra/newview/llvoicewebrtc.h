@@ -41,6 +41,7 @@ class LLWebRTCProtocolParser;
 #include "llparcel.h"
 #include "llmutelist.h"
 #include <queue>
+#include <mutex> // <FS/> Off-main-thread data channel processing
 #include "boost/json.hpp"
 
 #ifdef LL_USESYSTEMLIBS
@@ -527,6 +528,16 @@ private:
 
     void notifyParticipantObservers();
 
+    // <FS> Off-main-thread data channel processing
+public:
+    // While deferred, participant changes are collected and observers are
+    // notified once when the last deferral ends. Main thread only.
+    void deferParticipantNotifications(bool defer);
+private:
+    S32  mDeferParticipantNotify;
+    bool mParticipantsChanged;
+    // </FS>
+
     typedef std::set<LLVoiceClientStatusObserver*> status_observer_set_t;
     status_observer_set_t mStatusObservers;
 
@@ -606,6 +617,7 @@ class LLVoiceWebRTCConnection :
     //@}
 
     void OnDataReceivedImpl(const std::string &data, bool binary);
+    void processDataUpdates(); // <FS/> Off-main-thread data channel processing
 
     void sendJoin();
     void sendData(const std::string &data);
@@ -716,6 +728,30 @@ class LLVoiceWebRTCConnection :
     llwebrtc::LLWebRTCPeerConnectionInterface *mWebRTCPeerConnectionInterface;
     llwebrtc::LLWebRTCAudioInterface *mWebRTCAudioInterface;
     llwebrtc::LLWebRTCDataInterface  *mWebRTCDataInterface;
+
+    // <FS> Off-main-thread data channel processing
+    // What changed for a participant since the voice loop last looked,
+    // negative values didn't change
+    struct ParticipantUpdate
+    {
+        bool mJoined = false;
+        bool mPrimary = false;
+        bool mLeft = false;
+        S32  mPower = -1;
+        S8   mSpeaking = -1;
+        S8   mModeratorMuted = -1;
+    };
+    // What was last passed on for a participant, webrtc thread only
+    struct ReportedState
+    {
+        S32 mPower = -1;
+        S8  mSpeaking = -1;
+        S8  mModeratorMuted = -1;
+    };
+    std::mutex                              mPendingUpdatesMutex;
+    std::map<LLUUID, ParticipantUpdate>     mPendingUpdates;
+    std::map<LLUUID, ReportedState>         mReportedStates;
+    // </FS>
 };
 
 
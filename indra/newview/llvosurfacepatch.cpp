@@ -1051,6 +1051,13 @@ void LLTerrainPartition::getGeometry(LLSpatialGroup* group)
             LLVOSurfacePatch* patchp = (LLVOSurfacePatch*) facep->getViewerObject();
             patchp->getTerrainGeometry(vertices, normals, texcoords2, indices);
 
+            // <FS> GPU terrain
+            if (FSGPUTerrain::isEnabled())
+            {
+                gPipeline.mGPUTerrain.dirtyPatch(patchp->getPatch());
+            }
+            // </FS>
+
             indices_index += facep->getIndicesCount();
             index_offset += facep->getGeomCount();
         }
@@ -54,6 +54,7 @@
 #include "llnotificationsutil.h"
 #include "raytrace.h"
 #include "llglslshader.h"
+#include "fstreeinstancer.h" // <FS/> Tree instancing
 
 extern LLPipeline gPipeline;
 
@@ -87,6 +88,7 @@ LLVOTree::LLVOTree(const LLUUID &id, const LLPCode pcode, LLViewerRegion *region
     mFrameCount = 0;
     mWind = mRegionp->mWind.getVelocity(getPositionRegion());
     mTrunkLOD = 0;
+    mInstanced = false; // <FS/> Tree instancing
 
     // if assert triggers, idleUpdate() needs to be revised and adjusted to new LOD levels
     llassert(sMAX_NUM_TREE_LOD_LEVELS == LLVolumeLODGroup::NUM_LODS);
@@ -386,7 +388,10 @@ void LLVOTree::idleUpdate(LLAgent &agent, const F64 &time)
     {
         gPipeline.markRebuild(mDrawable, LLDrawable::REBUILD_ALL);
     }
-    else if (trunk_LOD != mTrunkLOD)
+    // <FS> Tree instancing
+    //else if (trunk_LOD != mTrunkLOD)
+    else if (trunk_LOD != mTrunkLOD || mInstanced != FSTreeInstancer::isEnabled())
+    // </FS>
     {
         gPipeline.markRebuild(mDrawable, LLDrawable::REBUILD_ALL);
     }
@@ -931,6 +936,61 @@ void LLVOTree::updateMesh()
 
     LLFace* facep = mDrawable->getFace(0);
     if (!facep) return;
+
+    // <FS> Tree instancing
+    mInstanced = FSTreeInstancer::isEnabled();
+    if (mInstanced)
+    {
+        // what would have been baked into the vertices, the shared mesh is in tree space
+        for (U32 i = 0; i < 3; ++i)
+        {
+            F32* dst = mInstanceTransform + i * 4;
+            dst[0] = scale_mat.mMatrix[i][0];
+            dst[1] = scale_mat.mMatrix[i][1];
+            dst[2] = scale_mat.mMatrix[i][2];
+            dst[3] = scale_mat.mMatrix[3][i];
+        }
+
+        LLPointer<LLVertexBuffer> mesh = gPipeline.mTreeInstancer.getMesh(mSpecies, mTrunkLOD);
+        if (mesh.isNull())
+        {
+            mesh = new LLVertexBuffer(LLDrawPoolTree::VERTEX_DATA_MASK);
+            if (!mesh->allocateBuffer(vert_count, index_count))
+            {
+                LL_WARNS() << "Failed to allocate shared tree mesh of "
+                    << vert_count << " vertices and "
+                    << index_count << " indices" << LL_ENDL;
+                facep->setVertexBuffer(NULL);
+                mReferenceBuffer->unmapBuffer();
+                return;
+            }
+
+            LLStrider<LLVector3> vertices;
+            LLStrider<LLVector3> normals;
+            LLStrider<LLVector2> tex_coords;
+            LLStrider<LLColor4U> colors;
+            LLStrider<U16> indices;
+            U16 idx_offset = 0;
+
+            mesh->getVertexStrider(vertices);
+            mesh->getNormalStrider(normals);
+            mesh->getTexCoord0Strider(tex_coords);
+            mesh->getColorStrider(colors);
+            mesh->getIndexStrider(indices);
+
+            LLMatrix4 tree_space;
+            genBranchPipeline(vertices, normals, tex_coords, colors, indices, idx_offset, tree_space, mTrunkLOD, stop_depth, mDepth, mTrunkDepth, 1.0, mTwist, droop, mBranches, alpha);
+
+            mesh->unmapBuffer();
+            gPipeline.mTreeInstancer.setMesh(mSpecies, mTrunkLOD, mesh);
+        }
+
+        facep->setVertexBuffer(mesh);
+        mReferenceBuffer->unmapBuffer();
+        return;
+    }
+    // </FS>
+
     LLVertexBuffer* buff = new LLVertexBuffer(LLDrawPoolTree::VERTEX_DATA_MASK);
     if (!buff->allocateBuffer(vert_count, index_count))
     {
@@ -79,6 +79,13 @@ public:
 
     void destroyVB() { mReferenceBuffer = NULL; }
 
+    // <FS> Tree instancing
+    // Drawn with the shared mesh of its species in its face, see FSTreeInstancer
+    bool isInstanced() const { return mInstanced; }
+    // Tree to region transform, 3 columns with the translation in w
+    const F32* getInstanceTransform() const { return mInstanceTransform; }
+    // </FS>
+
     void appendMesh(LLStrider<LLVector3>& vertices,
                          LLStrider<LLVector3>& normals,
                          LLStrider<LLVector2>& tex_coords,
@@ -187,6 +194,11 @@ protected:
 
     U32 mFrameCount;
 
+    // <FS> Tree instancing
+    bool            mInstanced;
+    F32             mInstanceTransform[12];
+    // </FS>
+
     typedef std::map<U32, TreeSpeciesData*> SpeciesMap;
     // <FS:Ansariel> FIRE-7802: Grass and tree selection in build tool
     //static SpeciesMap sSpeciesTable;
@@ -43,6 +43,9 @@
 #include "llvolumeoctree.h"
 #include "llvolumemgr.h"
 #include "llvolumemessage.h"
+#include "llvolumesimd.h" // <FS/> Vertex stream kernels
+#include "threadpool.h" // <FS/> Threaded geometry fill
+#include "workqueue.h" // <FS/> Threaded geometry fill
 #include "material_codes.h"
 #include "message.h"
 #include "llpluginclassmedia.h" // for code in the mediaEvent handler
@@ -105,6 +108,10 @@ F32 LLVOVolume::sLODFactor = 1.f;
 F32 LLVOVolume::sLODSlopDistanceFactor = 0.5f; //Changing this to zero, effectively disables the LOD transition slop
 F32 LLVOVolume::sDistanceFactor = 1.0f;
 S32 LLVOVolume::sNumLODChanges = 0;
+// <FS> Parallel object update decoding
+LLTEContents* LLVOVolume::sDecodedTE = nullptr;
+S32 LLVOVolume::sDecodedTEResult = 0;
+// </FS>
 S32 LLVOVolume::mRenderComplexity_last = 0;
 S32 LLVOVolume::mRenderComplexity_current = 0;
 LLPointer<LLObjectMediaDataClient> LLVOVolume::sObjectMediaClient = NULL;
@@ -482,7 +489,22 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
         // Unpack texture entry data
         //
 
-        S32 result = unpackTEMessage(mesgsys, _PREHASH_ObjectData, (S32) block_num);
+        // <FS> Parallel object update decoding
+        //S32 result = unpackTEMessage(mesgsys, _PREHASH_ObjectData, (S32) block_num);
+        S32 result = 0;
+        if (sDecodedTE)
+        {
+            if (sDecodedTEResult)
+            {
+                sDecodedTE->face_count = llmin((U32)getNumTEs(), (U32)LLTEContents::MAX_TES);
+                result = applyParsedTEMessage(*sDecodedTE);
+            }
+        }
+        else
+        {
+            result = unpackTEMessage(mesgsys, _PREHASH_ObjectData, (S32) block_num);
+        }
+        // </FS>
         //<FS:Beq> Improved bad object handling courtesy of Drake.
         if (TEM_INVALID == result)
         {
@@ -715,10 +737,34 @@ void LLVOVolume::onDrawableUpdateFromServer()
     }
 }
 
+// <FS> Texture animation matrix
+// Closed form of what animateTextures() used to build with LLMatrix4
+// operations: translate by -0.5, rotate by -rot around z, scale, then
+// translate by the offset + 0.5. Texture coordinates are row vectors.
+static void set_texture_anim_matrix(LLMatrix4& tex_mat, F32 off_s, F32 off_t, F32 scale_s, F32 scale_t, F32 cos_rot, F32 sin_rot)
+{
+    tex_mat.setIdentity();
+    tex_mat.mMatrix[0][0] = cos_rot * scale_s;
+    tex_mat.mMatrix[0][1] = -sin_rot * scale_t;
+    tex_mat.mMatrix[1][0] = sin_rot * scale_s;
+    tex_mat.mMatrix[1][1] = cos_rot * scale_t;
+    tex_mat.mMatrix[3][0] = off_s + 0.5f - 0.5f * (cos_rot + sin_rot) * scale_s;
+    tex_mat.mMatrix[3][1] = off_t + 0.5f - 0.5f * (cos_rot - sin_rot) * scale_t;
+}
+// </FS>
+
 void LLVOVolume::animateTextures()
 {
     if (!mDead && mDrawable) // <FS:Beq/> FIRE-34601 - bugsplat accessing null drawable.
     {
+        // <FS> Texture animation matrix
+        // Running animations of objects that were culled last frame catch
+        // up once they are back in view, smooth ones accumulate their time
+        if (mTexAnimMode && !mDrawable->isVisible())
+        {
+            return;
+        }
+        // </FS>
         shrinkWrap();
         F32 off_s = 0.f, off_t = 0.f, scale_s = 1.f, scale_t = 1.f, rot = 0.f;
         S32 result = mTextureAnimp->animateTextures(off_s, off_t, scale_s, scale_t, rot);
@@ -738,6 +784,13 @@ void LLVOVolume::animateTextures()
                 start = end = mTextureAnimp->mFace;
             }
 
+            // <FS> Texture animation matrix
+            // Faces mostly share the rotation, only take its sine and cosine when it changes
+            F32 last_rot = 0.f;
+            F32 cos_rot = 1.f;
+            F32 sin_rot = 0.f;
+            // </FS>
+
             for (S32 i = start; i <= end; i++)
             {
                 LLFace* facep = mDrawable->getFace(i);
@@ -767,6 +820,7 @@ void LLVOVolume::animateTextures()
                 if (!facep->mTextureMatrix)
                 {
                     facep->mTextureMatrix = new LLMatrix4();
+                    dirtyRenderCost(); // <FS/> Incremental complexity
                     if (facep->getVirtualSize() > MIN_TEX_ANIM_SIZE)
                     {
                         // Fix the one edge case missed in
@@ -778,24 +832,33 @@ void LLVOVolume::animateTextures()
                     }
                 }
 
-                LLMatrix4& tex_mat = *facep->mTextureMatrix;
-                tex_mat.setIdentity();
-                LLVector3 trans ;
-
-                    trans.set(LLVector3(off_s+0.5f, off_t+0.5f, 0.f));
-                    tex_mat.translate(LLVector3(-0.5f, -0.5f, 0.f));
-
-                LLVector3 scale(scale_s, scale_t, 1.f);
-                LLQuaternion quat;
-                quat.setQuat(rot, 0, 0, -1.f);
-
-                tex_mat.rotate(quat);
-
-                LLMatrix4 mat;
-                mat.initAll(scale, LLQuaternion(), LLVector3());
-                tex_mat *= mat;
-
-                tex_mat.translate(trans);
+                // <FS> Texture animation matrix
+                //LLMatrix4& tex_mat = *facep->mTextureMatrix;
+                //tex_mat.setIdentity();
+                //LLVector3 trans ;
+                //
+                //    trans.set(LLVector3(off_s+0.5f, off_t+0.5f, 0.f));
+                //    tex_mat.translate(LLVector3(-0.5f, -0.5f, 0.f));
+                //
+                //LLVector3 scale(scale_s, scale_t, 1.f);
+                //LLQuaternion quat;
+                //quat.setQuat(rot, 0, 0, -1.f);
+                //
+                //tex_mat.rotate(quat);
+                //
+                //LLMatrix4 mat;
+                //mat.initAll(scale, LLQuaternion(), LLVector3());
+                //tex_mat *= mat;
+                //
+                //tex_mat.translate(trans);
+                if (rot != last_rot)
+                {
+                    last_rot = rot;
+                    cos_rot = cosf(rot);
+                    sin_rot = sinf(rot);
+                }
+                set_texture_anim_matrix(*facep->mTextureMatrix, off_s, off_t, scale_s, scale_t, cos_rot, sin_rot);
+                // </FS>
             }
         }
         else
@@ -1132,6 +1195,7 @@ void LLVOVolume::setScale(const LLVector3 &scale, bool damped)
     {
         // store local radius
         LLViewerObject::setScale(scale);
+        dirtyRenderCost(); // <FS/> Incremental complexity
 
         if (mVolumeImpl)
         {
@@ -1381,6 +1445,8 @@ void LLVOVolume::updateSculptTexture()
 
 void LLVOVolume::updateVisualComplexity()
 {
+    dirtyRenderCost(); // <FS/> Incremental complexity
+
     LLVOAvatar* avatar = getAvatarAncestor();
     if (avatar)
     {
@@ -1556,6 +1622,23 @@ S32 LLVOVolume::computeLODDetail(F32 distance, F32 radius, F32 lod_factor)
         // We've got LOD in the profile, and in the twist.  Use radius.
         F32 tan_angle = (lod_factor*radius)/distance;
         cur_detail = LLVolumeLODGroup::getDetailFromTan(ll_round(tan_angle, 0.01f));
+
+        // <FS> LOD hysteresis
+        // Keep the current LOD until the object is clearly past a threshold,
+        // objects right at one would switch back and forth and get their
+        // geometry rebuilt every time
+        static LLCachedControl<F32> lod_hysteresis(gSavedSettings, "FSVolumeLODHysteresis", 0.1f);
+        if (cur_detail != mLOD && lod_hysteresis > 0.f)
+        {
+            const F32 hysteresis = llmin((F32)lod_hysteresis, 0.5f);
+            S32 lowest = LLVolumeLODGroup::getDetailFromTan(ll_round(tan_angle * (1.f - hysteresis), 0.01f));
+            S32 highest = LLVolumeLODGroup::getDetailFromTan(ll_round(tan_angle * (1.f + hysteresis), 0.01f));
+            if (mLOD >= lowest && mLOD <= highest)
+            {
+                cur_detail = mLOD;
+            }
+        }
+        // </FS>
     }
     else
     {
@@ -2249,6 +2332,13 @@ bool LLVOVolume::updateGeometry(LLDrawable *drawable)
         mDrawable->clearState(LLDrawable::REBUILD_RIGGED);
     }
 
+    // <FS> Incremental complexity
+    if (mVolumeChanged || mFaceMappingChanged || mLODChanged || mSculptChanged || mColorChanged)
+    {
+        dirtyRenderCost();
+    }
+    // </FS>
+
     if (mVolumeImpl != NULL)
     {
         bool res;
@@ -5210,7 +5300,13 @@ void LLRiggedVolume::update(
 
     LLMatrix4a mat[kMaxJoints];
     U32 maxJoints = LLSkinningUtil::getMeshJointCount(skin);
-    LLSkinningUtil::initSkinningMatrixPalette(mat, maxJoints, skin, avatar);
+    // <FS> Batched palette kernel
+    //LLSkinningUtil::initSkinningMatrixPalette(mat, maxJoints, skin, avatar);
+    // Share the palette the draw pools build for this skin on this avatar
+    // each frame instead of building another one per rigged volume
+    const LLMeshSkinInfo::matrix_list_t& palette = avatar->updateSkinInfoMatrixPalette(skin).mMatrixPalette;
+    memcpy(mat, palette.data(), sizeof(LLMatrix4a) * llmin((size_t)maxJoints, palette.size()));
+    // </FS>
     const LLMatrix4a bind_shape_matrix = skin->mBindShapeMatrix;
 
     S32 rigged_vert_count = 0;
@@ -5277,21 +5373,25 @@ void LLRiggedVolume::update(
                 else
             #endif
                 {
-                    for (S32 j = 0; j < dst_face.mNumVertices; ++j)
-                    {
-                        LLMatrix4a final_mat;
-                        // <FS:ND> Use the SSE2 version
-                        // LLSkinningUtil::getPerVertexSkinMatrix(weight[j].getF32ptr(), mat, false, final_mat, max_joints);
-                        FSSkinningUtil::getPerVertexSkinMatrixSSE(weight[j], mat, false, final_mat, max_joints);
-                        // </FS:ND>
-
-                        LLVector4a& v = vol_face.mPositions[j];
-                        LLVector4a t;
-                        LLVector4a dst;
-                        bind_shape_matrix.affineTransform(v, t);
-                        final_mat.affineTransform(t, dst);
-                        pos[j] = dst;
-                    }
+                    // <FS> Vertex stream kernels
+                    //for (S32 j = 0; j < dst_face.mNumVertices; ++j)
+                    //{
+                    //    LLMatrix4a final_mat;
+                    //    // <FS:ND> Use the SSE2 version
+                    //    // LLSkinningUtil::getPerVertexSkinMatrix(weight[j].getF32ptr(), mat, false, final_mat, max_joints);
+                    //    FSSkinningUtil::getPerVertexSkinMatrixSSE(weight[j], mat, false, final_mat, max_joints);
+                    //    // </FS:ND>
+                    //
+                    //    LLVector4a& v = vol_face.mPositions[j];
+                    //    LLVector4a t;
+                    //    LLVector4a dst;
+                    //    bind_shape_matrix.affineTransform(v, t);
+                    //    final_mat.affineTransform(t, dst);
+                    //    pos[j] = dst;
+                    //}
+                    LLVolumeSIMD::transformPositions(bind_shape_matrix, vol_face.mPositions, pos, dst_face.mNumVertices);
+                    LLVolumeSIMD::skinPositions(mat, max_joints, weight, pos, pos, dst_face.mNumVertices);
+                    // </FS>
                 }
 
                 //update bounding box
@@ -5299,19 +5399,27 @@ void LLRiggedVolume::update(
                 LLVector4a& min = dst_face.mExtents[0];
                 LLVector4a& max = dst_face.mExtents[1];
 
-                min = pos[0];
-                max = pos[1];
+                // <FS> Vertex stream kernels
+                //min = pos[0];
+                //max = pos[1];
+                //if (i==0)
+                //{
+                //    box_min = min;
+                //    box_max = max;
+                //}
+                //
+                //for (S32 j = 1; j < dst_face.mNumVertices; ++j)
+                //{
+                //    min.setMin(min, pos[j]);
+                //    max.setMax(max, pos[j]);
+                //}
+                LLVolumeSIMD::getMinMax(pos, dst_face.mNumVertices, min, max);
                 if (i==0)
                 {
                     box_min = min;
                     box_max = max;
                 }
-
-                for (S32 j = 1; j < dst_face.mNumVertices; ++j)
-                {
-                    min.setMin(min, pos[j]);
-                    max.setMax(max, pos[j]);
-                }
+                // </FS>
 
                 box_min.setMin(min,box_min);
                 box_max.setMax(max,box_max);
@@ -5321,23 +5429,31 @@ void LLRiggedVolume::update(
 
             }
 
+            // <FS> Flat picking hierarchy
+            // Picking builds its hierarchy on demand, only stale ones are dropped here
+            //if (rebuild_face_octrees)
+            //{
+            //    dst_face.destroyOctree();
+            //    // <FS:ND> Create a debug log for octree insertions if requested.
+            //    static LLCachedControl<bool> debugOctree(gSavedSettings,"FSCreateOctreeLog");
+            //    bool _debugOT( debugOctree );
+            //    if( _debugOT )
+            //        nd::octree::debug::gOctreeDebug += 1;
+            //    // </FS:ND>
+            //
+            //    dst_face.createOctree();
+            //
+            //    // <FS:ND> Reset octree log
+            //    if( _debugOT )
+            //        nd::octree::debug::gOctreeDebug -= 1;
+            //    // </FS:ND>
+            //}
+            dst_face.destroyBVH();
             if (rebuild_face_octrees)
             {
                 dst_face.destroyOctree();
-                // <FS:ND> Create a debug log for octree insertions if requested.
-                static LLCachedControl<bool> debugOctree(gSavedSettings,"FSCreateOctreeLog");
-                bool _debugOT( debugOctree );
-                if( _debugOT )
-                    nd::octree::debug::gOctreeDebug += 1;
-                // </FS:ND>
-
-                dst_face.createOctree();
-
-                // <FS:ND> Reset octree log
-                if( _debugOT )
-                    nd::octree::debug::gOctreeDebug -= 1;
-                // </FS:ND>
             }
+            // </FS>
         }
     }
     mExtraDebugText = llformat("rigged %d/%d - box (%f %f %f) (%f %f %f)",
@@ -5856,6 +5972,71 @@ static inline void add_face(T*** list, U32* count, T* face)
     }
 }
 
+// <FS> Mesh instancing
+// Opaque PBR faces of static meshes go to the instance list of the group
+// instead of its vertex buffers, FSMeshInstancer draws every face of the same
+// volume and material in one call. Returns false when the face isn't eligible.
+static bool add_mesh_instance(LLSpatialGroup* group, LLDrawable* drawablep, LLVOVolume* vobj, LLFace* facep, LLFetchedGLTFMaterial* gltf_mat)
+{
+    static LLCachedControl<bool> mesh_instancing(gSavedSettings, "FSMeshInstancing", true);
+    if (!mesh_instancing
+        || !gDeferredPBROpaqueInstancedProgram.isComplete()
+        || !gDeferredShadowInstancedProgram.isComplete())
+    {
+        return false;
+    }
+
+    const LLTextureEntry* te = facep->getTextureEntry();
+    LLVolume* volume = vobj->getVolume();
+    S32 te_idx = facep->getTEOffset();
+
+    if (!te || !volume || !gltf_mat
+        || gltf_mat->mAlphaMode != LLGLTFMaterial::ALPHA_MODE_OPAQUE
+        || te->getGlow() > 0.f
+        || !vobj->isMesh()
+        || vobj->isAttachment()
+        || vobj->isSelected()
+        || vobj->mTextureAnimp
+        || drawablep->isActive()
+        || drawablep->isState(LLDrawable::ANIMATED_CHILD)
+        || facep->isState(LLFace::RIGGED)
+        || facep->hasMedia()
+        || te_idx < 0 || te_idx >= volume->getNumVolumeFaces())
+    {
+        return false;
+    }
+
+    LLSpatialGroup::MeshInstance instance;
+    instance.mVolume = volume;
+    instance.mVolumeFace = te_idx;
+    instance.mMaterial = gltf_mat;
+    instance.mModelMatrix = &drawablep->getRegion()->mRenderMatrix;
+    instance.mColor = gltf_mat->mBaseColor;
+
+    // same matrices getGeometryVolume() would bake into the vertices
+    const LLMatrix4& mat = vobj->getRelativeXform();
+    const LLMatrix3& norm = vobj->getRelativeXformInvTrans();
+    for (U32 i = 0; i < 3; ++i)
+    {
+        F32* dst = instance.mTransform + i * 4;
+        dst[0] = mat.mMatrix[i][0];
+        dst[1] = mat.mMatrix[i][1];
+        dst[2] = mat.mMatrix[i][2];
+        dst[3] = mat.mMatrix[3][i];
+
+        dst = instance.mNormal + i * 4;
+        dst[0] = norm.mMatrix[i][0];
+        dst[1] = norm.mMatrix[i][1];
+        dst[2] = norm.mMatrix[i][2];
+        dst[3] = 0.f;
+    }
+
+    group->mMeshInstances.push_back(instance);
+    facep->setState(LLFace::MESH_INSTANCE);
+    return true;
+}
+// </FS>
+
 void LLVolumeGeometryManager::rebuildGeom(LLSpatialGroup* group)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
@@ -6090,6 +6271,7 @@ void LLVolumeGeometryManager::rebuildGeom(LLSpatialGroup* group)
                 //ALWAYS null out vertex buffer on rebuild -- if the face lands in a render
                 // batch, it will recover its vertex buffer reference from the spatial group
                 facep->setVertexBuffer(NULL);
+                facep->clearState(LLFace::MESH_INSTANCE); // <FS/> Mesh instancing
 
                 //sum up face verts and indices
                 drawablep->updateFaceSize(i);
@@ -6261,7 +6443,10 @@ void LLVolumeGeometryManager::rebuildGeom(LLSpatialGroup* group)
                                             should_render = false;
                                         }
                                     }
-                                    if (should_render)
+                                    // <FS> Mesh instancing
+                                    //if (should_render)
+                                    if (should_render && (bridge || rigged || !add_mesh_instance(group, drawablep, vobj, facep, (LLFetchedGLTFMaterial*)gltf_mat)))
+                                    // </FS>
                                     {
                                         add_face(sPbrFaces, pbr_count, facep);
                                     }
@@ -6459,6 +6644,14 @@ void LLVolumeGeometryManager::rebuildMesh(LLSpatialGroup* group)
                         if (face)
                         {
                             LLVertexBuffer* buff = face->getVertexBuffer();
+                            // <FS> Mesh instancing
+                            if (face->isState(LLFace::MESH_INSTANCE))
+                            { // the instance list of the group is only made by a full rebuild
+                                group->dirtyGeom();
+                                gPipeline.markRebuild(group);
+                            }
+                            else
+                            // </FS>
                             if (buff)
                             {
                                 if (!face->getGeometryVolume(*volume, // volume
@@ -6511,6 +6704,13 @@ struct CompareBatchBreaker
         {
             return lte->getFullbright() < rte->getFullbright();
         }
+        // <FS> GLTF render material interning, faces sharing a render material
+        // end up next to each other and in the same draw info
+        else if (lte->getGLTFRenderMaterial() != rte->getGLTFRenderMaterial())
+        {
+            return lte->getGLTFRenderMaterial() < rte->getGLTFRenderMaterial();
+        }
+        // </FS>
         else if (lte->getMaterialID() != rte->getMaterialID())
         {
             return lte->getMaterialID() < rte->getMaterialID();
@@ -6552,6 +6752,134 @@ struct CompareBatchBreakerRigged
     }
 };
 
+// <FS> Threaded geometry fill
+namespace
+{
+    // Don't bother the pool for fewer faces than this
+    constexpr U32 MIN_THREADED_FILL_FACES = 32;
+
+    // A face genDrawInfo() registered but left to fill_geometry_parallel()
+    struct GeometryFill
+    {
+        LLFace* mFace;
+        U16     mIndexOffset;
+    };
+
+    // The faces of one vertex buffer are filled by one thread, so a buffer's
+    // mapped regions never see two. The job is shared with the helpers like
+    // the parallel cull's in pipeline.cpp.
+    struct GeometryFillJob
+    {
+        std::vector<GeometryFill>   mFaces;
+        std::vector<U32>            mBufferStart{ 0 }; // first face of each buffer, then mFaces.size()
+        std::atomic<U32>            mNext{ 0 };
+        std::atomic<U32>            mDone{ 0 };
+
+        U32 getBufferCount() const  { return (U32)mBufferStart.size() - 1; }
+
+        void endBuffer()
+        {
+            if (mBufferStart.back() != (U32)mFaces.size())
+            {
+                mBufferStart.push_back((U32)mFaces.size());
+            }
+        }
+    };
+
+    void fill_face_geometry(LLFace* facep, U16 index_offset)
+    {
+        LLVOVolume* vobj = facep->getDrawable()->getVOVolume();
+        if (!facep->getGeometryVolume(*vobj->getVolume(), facep->getTEOffset(),
+            vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), index_offset, true))
+        {
+            LL_WARNS() << "Failed to get geometry for face!" << LL_ENDL;
+        }
+    }
+
+    void fill_geometry(GeometryFillJob& job)
+    {
+        const U32 count = job.getBufferCount();
+        for (U32 i = job.mNext++; i < count; i = job.mNext++)
+        {
+            for (U32 f = job.mBufferStart[i]; f < job.mBufferStart[i + 1]; ++f)
+            {
+                fill_face_geometry(job.mFaces[f].mFace, job.mFaces[f].mIndexOffset);
+            }
+            ++job.mDone;
+        }
+    }
+
+    // Off the main thread getGeometryVolume() may only write the face and its
+    // own vertex buffer. Animated children swap their relative transform
+    // around the fill, registerFace() reads the TEXTURE_ANIM state the fill
+    // may clear, and selected faces clone or free a GL buffer. Tangents are
+    // generated here since the volume can be shared between objects.
+    bool prepare_threaded_fill(LLFace* facep, U32 mask)
+    {
+        LLDrawable* drawablep = facep->getDrawable();
+        const LLTextureEntry* te = facep->getTextureEntry();
+        if (drawablep->isState(LLDrawable::ANIMATED_CHILD) ||
+            facep->isState(LLFace::TEXTURE_ANIM) ||
+            !te || te->isSelected() || facep->hasGLTFSelectionBuffer())
+        {
+            return false;
+        }
+
+        LLVolume* volume = drawablep->getVOVolume()->getVolume();
+        S32 te_idx = facep->getTEOffset();
+        if (te_idx >= 0 && te_idx < volume->getNumVolumeFaces() &&
+            ((mask & LLVertexBuffer::MAP_TANGENT) || te->getBumpmap() || te->getTexGen() != LLTextureEntry::TEX_GEN_DEFAULT))
+        {
+            volume->genTangents(te_idx);
+        }
+        return true;
+    }
+
+    // Fill on the main thread and as many "General" pool threads as are
+    // free. The main thread takes the first buffer before any helper starts,
+    // which also sets up the function statics of getGeometryVolume().
+    void fill_geometry_parallel(std::shared_ptr<GeometryFillJob> job)
+    {
+        LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
+        job->endBuffer();
+        const U32 count = job->getBufferCount();
+        if (count == 0)
+        {
+            return;
+        }
+
+        U32 helpers = 0;
+        LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+        LL::ThreadPoolBase::ptr_t general_pool = LL::ThreadPoolBase::getInstance("General");
+        if (general_queue && general_pool && job->mFaces.size() >= MIN_THREADED_FILL_FACES)
+        {
+            helpers = llmin((U32)general_pool->getWidth(), count - 1);
+        }
+
+        U32 first = job->mNext++;
+        for (U32 f = job->mBufferStart[first]; f < job->mBufferStart[first + 1]; ++f)
+        {
+            fill_face_geometry(job->mFaces[f].mFace, job->mFaces[f].mIndexOffset);
+        }
+        ++job->mDone;
+
+        for (U32 i = 0; i < helpers; ++i)
+        {
+            if (!general_queue->tryPost([job]() { fill_geometry(*job); }))
+            {
+                break;
+            }
+        }
+
+        fill_geometry(*job);
+        while (job->mDone < count)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+// </FS>
+
 U32 LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFace** faces, U32 face_count, bool distance_sort, bool batch_textures, bool rigged)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_VOLUME;
@@ -6598,6 +6926,15 @@ U32 LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFace
 
     bool flexi = false;
 
+    // <FS> Threaded geometry fill
+    static LLCachedControl<bool> threaded_fill(gSavedSettings, "FSThreadedGeometryFill", true);
+    std::shared_ptr<GeometryFillJob> fill_job;
+    if (threaded_fill && face_count >= MIN_THREADED_FILL_FACES)
+    {
+        fill_job = std::make_shared<GeometryFillJob>();
+    }
+    // </FS>
+
     while (face_iter != end_faces)
     {
         //pull off next face
@@ -6775,6 +7112,13 @@ U32 LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFace
             buffer_map[mask][*face_iter].push_back(buffer);
         }
 
+        // <FS> Threaded geometry fill
+        if (fill_job)
+        {
+            fill_job->endBuffer();
+        }
+        // </FS>
+
         //add face geometry
 
         U32 indices_index = 0;
@@ -6806,6 +7150,14 @@ U32 LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFace
                 //for debugging, set last time face was updated vs moved
                 facep->updateRebuildFlags();
 
+                // <FS> Threaded geometry fill, registering the face doesn't
+                // need its vertices so they can be filled after the loop
+                if (fill_job && prepare_threaded_fill(facep, mask))
+                {
+                    fill_job->mFaces.push_back({ facep, index_offset });
+                }
+                else
+                // </FS>
                 { //copy face geometry into vertex buffer
                     LLDrawable* drawablep = facep->getDrawable();
                     LLVOVolume* vobj = drawablep->getVOVolume();
@@ -7186,6 +7538,13 @@ U32 LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFace
         }
     }
 
+    // <FS> Threaded geometry fill
+    if (fill_job)
+    {
+        fill_geometry_parallel(fill_job);
+    }
+    // </FS>
+
     group->mBufferMap[mask].clear();
     for (LLSpatialGroup::buffer_texture_map_t::iterator i = buffer_map[mask].begin(); i != buffer_map[mask].end(); ++i)
     {
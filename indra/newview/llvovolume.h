@@ -506,6 +506,15 @@ public:
 
     static LLPointer<LLObjectMediaDataClient> sObjectMediaClient;
     static LLPointer<LLObjectMediaNavigateClient> sObjectMediaNavigateClient;
+
+    // <FS> Parallel object update decoding
+    // Texture entries of the ObjectUpdate block being processed, parsed by
+    // LLViewerObjectList ahead of time for LLTEContents::MAX_TES faces, and
+    // what LLPrimitive::parseTEContents() returned for them. Read from the
+    // message when null.
+    static LLTEContents* sDecodedTE;
+    static S32 sDecodedTEResult;
+    // </FS>
 protected:
     static S32 sNumLODChanges;
 
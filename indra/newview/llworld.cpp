@@ -69,6 +69,7 @@
 #include <cstring>
 
 #include "fscommon.h"
+#include "fsregioncrosspreload.h" // <FS/> Region crossing preload
 #include "llselectmgr.h"
 
 //
@@ -603,6 +604,14 @@ LLViewerRegion* LLWorld::addRegion(const U64 &region_handle, const LLHost &host,
     mActiveRegionList.push_back(regionp);
     mCulledRegionList.push_back(regionp);
 
+    // <FS> Object cache prefetch
+    // The handshake that loads the cache of the region comes later
+    if (LLVOCache::instanceExists())
+    {
+        LLVOCache::instance().prefetch(region_handle);
+    }
+    // </FS>
+
 
     // Find all the adjacent regions, and attach them.
     // Generate handles for all of the adjacent regions, and attach them in the correct way.
@@ -1129,6 +1138,7 @@ void LLWorld::updateRegions(F32 max_update_time)
         LLViewerRegion::sLastCameraUpdated = LLViewerOctreeEntryData::getCurrentFrame() + 1;
     }
     LLViewerRegion::calcNewObjectCreationThrottle();
+    FSRegionCrossPreload::instance().update(); // <FS/> Region crossing preload
     if(LLViewerRegion::isNewObjectCreationThrottleDisabled())
     {
         max_update_time = llmax(max_update_time, 1.0f); //seconds, loosen the time throttle.
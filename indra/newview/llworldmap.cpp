@@ -310,7 +310,10 @@ void LLWorldMap::clearImageRefs()
 {
     // We clear the reference to the images we're holding.
     // Images hold by the world mipmap first
-    mWorldMipmap.reset();
+    // <FS> World map tile cache
+    //mWorldMipmap.reset();
+    mWorldMipmap.trim();
+    // </FS>
 
     // Images hold by the region map
     LLSimInfo* sim_info = NULL;
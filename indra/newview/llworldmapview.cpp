@@ -122,6 +122,12 @@ std::map<std::string,std::string> LLWorldMapView::sStringsMap;
 const F32 DRAW_TEXT_THRESHOLD = 96.f;       // Don't draw text under that resolution value (res = width region in meters)
 const S32 DRAW_SIMINFO_THRESHOLD = 3;       // Max level for which we load or display sim level information (level in LLWorldMipmap sense)
 const S32 DRAW_LANDFORSALE_THRESHOLD = 2;   // Max level for which we load or display land for sale picture data (level in LLWorldMipmap sense)
+// <FS> World map tile priority
+// Fetch priority of visible tiles, from the edge of the view to its center. Both are above
+// the size of a tile so every tile still loads at full resolution.
+const F32 TILE_PRIORITY_EDGE = 512.f * 512.f;
+const F32 TILE_PRIORITY_CENTER = 2048.f * 2048.f;
+// </FS>
 
 // When on, draw an outline for each mipmap tile gotten from S3
 #define DEBUG_DRAW_TILE 0
@@ -792,6 +798,10 @@ bool LLWorldMapView::drawMipmapLevel(S32 width, S32 height, S32 level, bool load
     // Dimension of the screen in meter at that scale
     LLVector3d pos_SW = viewPosToGlobal(0, 0);
     LLVector3d pos_NE = viewPosToGlobal(width, height);
+    // <FS> World map tile priority
+    const LLVector3d view_center = (pos_SW + pos_NE) * 0.5;
+    const F64 view_radius = llmax((pos_NE - pos_SW).magVec() * 0.5, 1.0);
+    // </FS>
     // Add external band of tiles on the outskirt so to hit the partially displayed tiles right and top
     pos_NE[VX] += tile_width;
     pos_NE[VY] += tile_width;
@@ -814,6 +824,17 @@ bool LLWorldMapView::drawMipmapLevel(S32 width, S32 height, S32 level, bool load
             // </FS:Ansariel>
             if (simimage)
             {
+                // <FS> World map tile priority
+                // Load the tiles in the middle of the view first
+                if (load)
+                {
+                    const F64 dx = grid_x * REGION_WIDTH_METERS + tile_width * 0.5 - view_center[VX];
+                    const F64 dy = grid_y * REGION_WIDTH_METERS + tile_width * 0.5 - view_center[VY];
+                    const F32 closeness = 1.f - llclamp((F32)(sqrt(dx * dx + dy * dy) / view_radius), 0.f, 1.f);
+                    simimage->resetTextureStats();
+                    simimage->addTextureStats(lerp(TILE_PRIORITY_EDGE, TILE_PRIORITY_CENTER, closeness));
+                }
+                // </FS>
                 // Checks that the image has a valid texture
                 if (simimage->hasGLTexture())
                 {
@@ -44,7 +44,8 @@
 #define DEBUG_TILES_STAT 0
 
 LLWorldMipmap::LLWorldMipmap() :
-    mCurrentLevel(0)
+    mCurrentLevel(0),
+    mDrawCount(0) // <FS/> World map tile cache
 {
 }
 
@@ -59,6 +60,7 @@ void LLWorldMipmap::reset()
     for (int level = 0; level < MAP_LEVELS; level++)
     {
         mWorldObjectsMipMap[level].clear();
+        mLastDrawn[level].clear(); // <FS/> World map tile cache
     }
 }
 
@@ -73,6 +75,7 @@ void LLWorldMipmap::equalizeBoostLevels()
     S32 nb_tiles = 0;
     S32 nb_visible = 0;
 #endif // DEBUG_TILES_STAT
+    ++mDrawCount; // <FS/> World map tile cache
     // For each level
     for (S32 level = 0; level < MAP_LEVELS; level++)
     {
@@ -86,6 +89,12 @@ void LLWorldMipmap::equalizeBoostLevels()
             {
                 // If level was BOOST_MAP_VISIBLE, the tile has been used in the last draw so keep it high
                 img->setBoostLevel(LLGLTexture::BOOST_MAP);
+                // <FS> World map tile cache
+                // Tiles drawn this time get their priority from the view, the others finish
+                // loading behind them
+                img->resetTextureStats();
+                img->addTextureStats((F32)(MAP_TILE_SIZE * MAP_TILE_SIZE));
+                // </FS>
             }
             else
             {
@@ -115,18 +124,91 @@ void LLWorldMipmap::equalizeBoostLevels()
 // This method should be used when the mipmap is not actively used for a while, e.g., the map UI is hidden
 void LLWorldMipmap::dropBoostLevels()
 {
-    // For each level
+    // <FS> World map tile cache
+    //// For each level
+    //for (S32 level = 0; level < MAP_LEVELS; level++)
+    //{
+    //    sublevel_tiles_t& level_mipmap = mWorldObjectsMipMap[level];
+    //    // For each tile
+    //    for (sublevel_tiles_t::iterator iter = level_mipmap.begin(); iter != level_mipmap.end(); iter++)
+    //    {
+    //        LLPointer<LLViewerFetchedTexture> img = iter->second;
+    //        img->setBoostLevel(LLGLTexture::BOOST_NONE);
+    //    }
+    //}
+    keepRecentTiles(false);
+    // </FS>
+}
+
+// <FS> World map tile cache
+// This method should be used when the mipmap is not going to be used for a long while, e.g., the map UI is closed
+void LLWorldMipmap::trim()
+{
+    keepRecentTiles(true);
+}
+
+void LLWorldMipmap::keepRecentTiles(bool release_others)
+{
+    tile_stamps_t loaded;
+    for (S32 level = 0; level < MAP_LEVELS; level++)
+    {
+        const sublevel_stamps_t& level_stamps = mLastDrawn[level];
+        for (const auto& [handle, img] : mWorldObjectsMipMap[level])
+        {
+            sublevel_stamps_t::const_iterator stamp = level_stamps.find(handle);
+            if (stamp != level_stamps.end() && img->hasGLTexture() && !img->isMissingAsset())
+            {
+                loaded.push_back({ stamp->second, level, handle });
+            }
+        }
+    }
+    const size_t max_tiles = selectRecentTiles(loaded, gSavedSettings.getU32("FSWorldMapTileCacheSize"));
+    std::set<std::pair<S32, U64> > keep;
+    for (size_t i = 0; i < max_tiles; ++i)
+    {
+        keep.insert({ loaded[i].mLevel, loaded[i].mHandle });
+    }
+
     for (S32 level = 0; level < MAP_LEVELS; level++)
     {
         sublevel_tiles_t& level_mipmap = mWorldObjectsMipMap[level];
-        // For each tile
-        for (sublevel_tiles_t::iterator iter = level_mipmap.begin(); iter != level_mipmap.end(); iter++)
+        sublevel_tiles_t::iterator it = level_mipmap.begin();
+        while (it != level_mipmap.end())
         {
-            LLPointer<LLViewerFetchedTexture> img = iter->second;
-            img->setBoostLevel(LLGLTexture::BOOST_NONE);
+            LLViewerFetchedTexture* img = it->second.get();
+            if (keep.count({ level, it->first }))
+            {
+                // Boosted so it stays decoded at full resolution, with the lowest priority a tile gets
+                img->setBoostLevel(LLGLTexture::BOOST_MAP);
+                img->resetTextureStats();
+                img->addTextureStats((F32)(MAP_TILE_SIZE * MAP_TILE_SIZE));
+                ++it;
+            }
+            else if (release_others)
+            {
+                mLastDrawn[level].erase(it->first);
+                level_mipmap.erase(it++);
+            }
+            else
+            {
+                img->setBoostLevel(LLGLTexture::BOOST_NONE);
+                ++it;
+            }
         }
     }
+
+    LL_DEBUGS("WorldMap") << "Kept " << keep.size() << " of " << loaded.size() << " loaded world map tiles" << LL_ENDL;
+}
+
+// static
+size_t LLWorldMipmap::selectRecentTiles(tile_stamps_t& tiles, size_t budget)
+{
+    const size_t count = llmin(budget, tiles.size());
+    std::partial_sort(tiles.begin(), tiles.begin() + count, tiles.end(),
+        [](const TileStamp& a, const TileStamp& b) { return a.mDrawn > b.mDrawn; });
+    return count;
 }
+// </FS>
 
 LLPointer<LLViewerFetchedTexture> LLWorldMipmap::getObjectsTile(U32 grid_x, U32 grid_y, S32 level, bool load)
 {
@@ -181,6 +263,7 @@ LLPointer<LLViewerFetchedTexture> LLWorldMipmap::getObjectsTile(U32 grid_x, U32
         if (load)
         {
             img->setBoostLevel(LLGLTexture::BOOST_MAP_VISIBLE);
+            mLastDrawn[level-1][handle] = mDrawCount; // <FS/> World map tile cache
         }
         return img;
     }
@@ -235,6 +318,7 @@ void LLWorldMipmap::cleanMissedTilesFromLevel(S32 level)
         LLPointer<LLViewerFetchedTexture> img = it->second;
         if (img->isMissingAsset())
         {
+            mLastDrawn[level-1].erase(it->first); // <FS/> World map tile cache
             level_mipmap.erase(it++);
         }
         else
@@ -28,6 +28,7 @@
 #define LL_LLWORLDMIPMAP_H
 
 #include <map>
+#include <vector> // <FS/> World map tile cache
 
 #include "llmemory.h"           // LLPointer
 #include "indra_constants.h"    // REGION_WIDTH_UNITS
@@ -65,6 +66,10 @@ public:
     void    equalizeBoostLevels();
     // Drop the boost levels to none (used when hiding the map)
     void    dropBoostLevels();
+    // <FS> World map tile cache
+    // Release all tiles but the most recently drawn ones (used when closing the map)
+    void    trim();
+    // </FS>
     // Get the tile smart pointer, does the loading if necessary
     LLPointer<LLViewerFetchedTexture> getObjectsTile(U32 grid_x, U32 grid_y, S32 level, bool load = true);
 
@@ -77,12 +82,29 @@ public:
     // Load the relevant tile from S3
     static LLPointer<LLViewerFetchedTexture> loadObjectsTile(U32 grid_x, U32 grid_y, S32 level);
 
+    // <FS> World map tile cache
+    // A loaded tile: draw count at which it was last requested, mipmap level and region handle
+    struct TileStamp
+    {
+        U32 mDrawn;
+        S32 mLevel;
+        U64 mHandle;
+    };
+    typedef std::vector<TileStamp> tile_stamps_t;
+    // Move the most recently drawn tiles first and return how many of them fit in the budget
+    static size_t selectRecentTiles(tile_stamps_t& tiles, size_t budget);
+    // </FS>
+
 private:
     // Get a handle (key) from grid coordinates
     U64     convertGridToHandle(U32 grid_x, U32 grid_y) { return to_region_handle(grid_x * REGION_WIDTH_UNITS, grid_y * REGION_WIDTH_UNITS); }
 
     // Clear a level from its "missing" tiles
     void cleanMissedTilesFromLevel(S32 level);
+    // <FS> World map tile cache
+    // Keep the most recently drawn loaded tiles decoded, release or unboost the others
+    void keepRecentTiles(bool release_others);
+    // </FS>
 
     // The mipmap is organized by resolution level (MAP_LEVELS of them). Each resolution level is an std::map
     // using a region_handle as a key and storing a smart pointer to the image as a value.
@@ -91,6 +113,13 @@ private:
 //  sublevel_tiles_t mWorldTerrainMipMap[MAP_LEVELS];
 
     S32 mCurrentLevel;      // The level last accessed by a getObjectsTile()
+
+    // <FS> World map tile cache
+    // Draw count at which each tile was last requested, used to pick the tiles to keep
+    typedef std::map<U64, U32> sublevel_stamps_t;
+    sublevel_stamps_t mLastDrawn[MAP_LEVELS];
+    U32 mDrawCount;
+    // </FS>
 };
 
 #endif // LL_LLWORLDMIPMAP_H
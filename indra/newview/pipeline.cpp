@@ -40,6 +40,7 @@
 #include "llpointer.h"
 #include "llprimitive.h"
 #include "llvolume.h"
+#include "llvramaccounting.h" // <FS/> VRAM accounting
 #include "material_codes.h"
 #include "v3color.h"
 #include "llui.h"
@@ -63,6 +64,7 @@
 #include "lldrawpoolwater.h"
 #include "llface.h"
 #include "llfeaturemanager.h"
+#include "llflexibleobject.h" // <FS/> Parallel flexi updates
 #include "llfloatertelehub.h"
 #include "llfloaterreg.h"
 #include "llhudmanager.h"
@@ -129,6 +131,12 @@
 #include "llenvironment.h"
 #include "llsettingsvo.h"
 
+#include "llterrainpaintmap.h" // <FS/> Asynchronous paint map bake
+#include "lltexlayer.h" // <FS/> Async morph mask readback
+#include "threadpool.h" // <FS/> Parallel culling
+#include "workqueue.h" // <FS/> Parallel culling
+#include "llradixsort.h" // <FS/> Radix sorted alpha groups
+
 #include "SMAAAreaTex.h"
 #include "SMAASearchTex.h"
 
@@ -339,6 +347,7 @@ bool    LLPipeline::sBakeSunlight = false;
 bool    LLPipeline::sNoAlpha = false;
 bool    LLPipeline::sUseFarClip = true;
 bool    LLPipeline::sShadowRender = false;
+U32     LLPipeline::sShadowGeometry = LLPipeline::SHADOW_GEOMETRY_ALL; // <FS/> Shadow cache
 bool    LLPipeline::sRenderGlow = false;
 bool    LLPipeline::sReflectionRender = false;
 bool    LLPipeline::sDistortionRender = false;
@@ -369,6 +378,115 @@ static LLPipelineListener sPipelineListener;
 
 static LLCullResult* sCull = NULL;
 
+// <FS> Parallel culling
+namespace
+{
+    // What one thread taking part in a parallel cull found
+    struct CullSlot
+    {
+        LLCullResult    mResult;
+        S32             mVisibleNodes = 0;
+    };
+
+    // Set while a thread culls a partition, markNotCulled() pushes here
+    // instead of sCull
+    thread_local CullSlot* sThreadCullSlot = nullptr;
+
+    // Partitions are handed out one at a time. The job is shared with the
+    // helpers, so a helper the pool only gets to after the cull has finished
+    // finds no partition left and never touches the camera or the slots.
+    struct CullJob
+    {
+        std::vector<LLSpatialPartition*>    mParts;
+        std::vector<CullSlot*>              mSlots;
+        LLCamera*                           mCamera = nullptr;
+        std::atomic<U32>                    mNext{ 0 };
+        std::atomic<U32>                    mDone{ 0 };
+        std::atomic<U32>                    mNextSlot{ 1 }; // slot 0 is the main thread's
+    };
+
+    void cull_partitions(CullJob& job, CullSlot* slot)
+    {
+        const U32 count = (U32)job.mParts.size();
+        for (U32 i = job.mNext++; i < count; i = job.mNext++)
+        {
+            if (!slot)
+            {
+                slot = job.mSlots[job.mNextSlot++];
+            }
+
+            sThreadCullSlot = slot;
+            job.mParts[i]->cull(*job.mCamera);
+            sThreadCullSlot = nullptr;
+            ++job.mDone;
+        }
+    }
+
+    // Cull parts on the main thread and as many "General" pool threads as
+    // are free, then append what they found to sCull. Only safe when the
+    // cull reads no occlusion queries and updates no distances, see
+    // LLPipeline::updateCull().
+    void cull_partitions_parallel(LLCamera& camera, std::vector<LLSpatialPartition*>& parts, S32& num_visible_nodes)
+    {
+        LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+        static std::vector<std::unique_ptr<CullSlot>> slots; // Tmain only
+
+        // rebound up front so partitions culled side by side only read
+        // each other's bounds
+        for (LLSpatialPartition* part : parts)
+        {
+            ((LLSpatialGroup*)part->mOctree->getListener(0))->rebound();
+        }
+
+        LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+        LL::ThreadPoolBase::ptr_t general_pool = LL::ThreadPoolBase::getInstance("General");
+        U32 helpers = 0;
+        if (general_queue && general_pool && parts.size() > 1)
+        {
+            helpers = llmin((U32)general_pool->getWidth(), (U32)parts.size() - 1);
+        }
+
+        while (slots.size() < helpers + 1)
+        {
+            slots.push_back(std::make_unique<CullSlot>());
+        }
+
+        std::shared_ptr<CullJob> job = std::make_shared<CullJob>();
+        job->mParts.swap(parts);
+        job->mCamera = &camera;
+        for (U32 i = 0; i <= helpers; ++i)
+        {
+            slots[i]->mResult.clear();
+            slots[i]->mVisibleNodes = 0;
+            job->mSlots.push_back(slots[i].get());
+        }
+
+        for (U32 i = 0; i < helpers; ++i)
+        {
+            if (!general_queue->tryPost([job]() { cull_partitions(*job, nullptr); }))
+            {
+                break;
+            }
+        }
+
+        // The main thread works too, so a busy pool costs nothing but the
+        // partitions a helper has already started on
+        cull_partitions(*job, job->mSlots[0]);
+        while (job->mDone < (U32)job->mParts.size())
+        {
+            std::this_thread::yield();
+        }
+
+        for (CullSlot* slot : job->mSlots)
+        {
+            sCull->append(slot->mResult);
+            num_visible_nodes += slot->mVisibleNodes;
+            slot->mResult.clear();
+        }
+    }
+}
+// </FS>
+
 void validate_framebuffer_object();
 
 // Add color attachments for deferred rendering
@@ -410,6 +528,7 @@ LLPipeline::LLPipeline() :
     mBackfaceCull(false),
     mMatrixOpCount(0),
     mTextureMatrixOps(0),
+    mMergedDrawCount(0), // <FS/> Multi-draw batching
     mNumVisibleNodes(0),
     mNumVisibleFaces(0),
     mPoissonOffset(0),
@@ -753,6 +872,15 @@ void LLPipeline::cleanup()
 
     mReflectionMapManager.cleanup();
     mHeroProbeManager.cleanup();
+    mHiZOcclusion.release(); // <FS/> Hi-Z occlusion
+    mGPUPassTimer.release(); // <FS/> GPU pass timers
+    mImpostorAtlas.release(); // <FS/> Impostor atlas
+    mMeshInstancer.release(); // <FS/> Mesh instancing
+    mGPUTerrain.release(); // <FS/> GPU terrain
+    mTreeInstancer.release(); // <FS/> Tree instancing
+    mClusteredLights.release(); // <FS/> Clustered lighting
+    mHUDCache.release(); // <FS/> HUD cache
+    mSkinCache.release(); // <FS/> Pre-skinned shadows
 }
 
 //============================================================================
@@ -814,15 +942,34 @@ void LLPipeline::resizeScreenTexture()
         }
 // [/SL:KB]
 
+        // <FS> Dynamic resolution, the same scaling as allocateScreenBufferInternal()
+        const F32 dynamic_scale = mDynamicResolution.getScale();
+        if (dynamic_scale < 1.f)
+        {
+            scaledResX = llmax((GLuint)(scaledResX * dynamic_scale), 1U);
+            scaledResY = llmax((GLuint)(scaledResY * dynamic_scale), 1U);
+        }
+        // </FS>
+
 //      if (gResizeScreenTexture || (resX != mRT->screen.getWidth()) || (resY != mRT->screen.getHeight()))
 // [SL:KB] - Patch: Settings-RenderResolutionMultiplier | Checked: Catznip-5.4
         if (gResizeScreenTexture || (scaledResX != mRT->screen.getWidth()) || (scaledResY != mRT->screen.getHeight()))
 // [/SL:KB]
         {
             releaseScreenBuffers();
-            releaseSunShadowTargets();
-            releaseSpotShadowTargets();
+            // <FS> Dynamic resolution, shadow maps don't follow the scale
+            //releaseSunShadowTargets();
+            //releaseSpotShadowTargets();
+            //allocateScreenBuffer(resX,resY);
+            if (gResizeScreenTexture)
+            {
+                releaseSunShadowTargets();
+                releaseSpotShadowTargets();
+            }
+            mDynamicScreenScale = dynamic_scale;
             allocateScreenBuffer(resX,resY);
+            mDynamicScreenScale = 1.f;
+            // </FS>
             gResizeScreenTexture = false;
         }
     }
@@ -945,6 +1092,17 @@ bool LLPipeline::allocateScreenBufferInternal(U32 resX, U32 resY)
     }
 // [/SL:KB]
 
+    // <FS> Dynamic resolution, only the world targets follow the scale,
+    // shadow maps and the upscale target keep the unscaled size
+    const U32 unscaled_res_x = resX;
+    const U32 unscaled_res_y = resY;
+    if (mRT == &mMainRT && mDynamicScreenScale < 1.f)
+    {
+        resX = llmax((U32)(resX * mDynamicScreenScale), 1U);
+        resY = llmax((U32)(resY * mDynamicScreenScale), 1U);
+    }
+    // </FS>
+
     S32 shadow_detail = RenderShadowDetail;
     bool ssao = RenderDeferredSSAO;
 
@@ -970,7 +1128,10 @@ bool LLPipeline::allocateScreenBufferInternal(U32 resX, U32 resY)
         mRT->deferredLight.release();
     }
 
-    allocateShadowBuffer(resX, resY);
+    // <FS> Dynamic resolution
+    //allocateShadowBuffer(resX, resY);
+    allocateShadowBuffer(unscaled_res_x, unscaled_res_y);
+    // </FS>
 
     if (!gCubeSnapshot) // hack to not re-allocate various targets for cube snapshots
     {
@@ -978,7 +1139,10 @@ bool LLPipeline::allocateScreenBufferInternal(U32 resX, U32 resY)
         if (RenderUIBuffer)
         {
             LL_PROFILE_ZONE_NAMED_CATEGORY_DISPLAY("UIBuffer"); // <FS:Beq/> improve Tracy scoping 
-            if (!mUIScreen.allocate(resX, resY, GL_RGBA))
+            // <FS> Dynamic resolution, the UI is drawn at window size
+            //if (!mUIScreen.allocate(resX, resY, GL_RGBA))
+            if (!mUIScreen.allocate(unscaled_res_x, unscaled_res_y, GL_RGBA))
+            // </FS>
             {
                 return false;
             }
@@ -1016,6 +1180,19 @@ bool LLPipeline::allocateScreenBufferInternal(U32 resX, U32 resY)
         {LL_PROFILE_ZONE_NAMED_CATEGORY_DISPLAY("mPostMapBuffer"); // <FS:Beq/> improve Tracy scoping 
         mPostMap.allocate(resX, resY, screenFormat);
         } // <FS:Beq/> improve Tracy scoping 
+
+        // <FS> Dynamic resolution, kept at the unscaled size while enabled
+        // so a change of scale doesn't reallocate it
+        if (mDynamicResolution.isEnabled())
+        {
+            LL_PROFILE_ZONE_NAMED_CATEGORY_DISPLAY("UpscaleBuffer");
+            if (!mUpscaleMap.allocate(unscaled_res_x, unscaled_res_y, GL_RGBA)) return false;
+        }
+        else
+        {
+            mUpscaleMap.release();
+        }
+        // </FS>
         // used to scale down textures
         // See LLViwerTextureList::updateImagesCreateTextures and LLImageGL::scaleDown
         {LL_PROFILE_ZONE_NAMED_CATEGORY_DISPLAY("DownResBuffer");// <FS:Beq/> create an independent preview screen target
@@ -1299,6 +1476,8 @@ void LLPipeline::releaseGLBuffers()
 
     mPostMap.release();
 
+    mUpscaleMap.release(); // <FS/> Dynamic resolution
+
     mFXAAMap.release();
 
     mUIScreen.release();
@@ -1318,6 +1497,15 @@ void LLPipeline::releaseGLBuffers()
 
     gBumpImageList.destroyGL();
     LLVOAvatar::resetImpostors();
+    mImpostorAtlas.release(); // <FS/> Impostor atlas
+    mMeshInstancer.release(); // <FS/> Mesh instancing
+    mGPUTerrain.release(); // <FS/> GPU terrain
+    mTreeInstancer.release(); // <FS/> Tree instancing
+    mClusteredLights.release(); // <FS/> Clustered lighting
+    mHUDCache.release(); // <FS/> HUD cache
+    mSkinCache.release(); // <FS/> Pre-skinned shadows
+    LLTerrainPaintMap::cancelBakes(); // <FS/> Asynchronous paint map bake
+    LLTexLayer::cancelMorphReadbacks(); // <FS/> Async morph mask readback
 }
 
 void LLPipeline::releaseLUTBuffers()
@@ -1357,6 +1545,9 @@ void LLPipeline::releaseScreenBuffers()
     mHeroProbeRT.deferredLight.release();
 
     mPreviewScreen.release(); // <FS:Beq/> dedicated preview target
+
+    mHiZOcclusion.release(); // <FS/> Hi-Z occlusion
+    mGPUPassTimer.release(); // <FS/> GPU pass timers
 }
 
 void LLPipeline::releaseSunShadowTarget(U32 index)
@@ -1371,7 +1562,65 @@ void LLPipeline::releaseSunShadowTargets()
     {
         releaseSunShadowTarget(i);
     }
+
+    releaseShadowCache(); // <FS/> Shadow cache
+}
+
+// <FS> Shadow cache
+// Spatial bridges hold the moving, physical and attached objects
+static bool is_dynamic_partition(U32 partition_type)
+{
+    return partition_type == LLViewerRegion::PARTITION_BRIDGE ||
+        partition_type == LLViewerRegion::PARTITION_AVATAR ||
+        partition_type == LLViewerRegion::PARTITION_CONTROL_AV;
+}
+
+// True when every point of the split's visible point cloud lands on the
+// shadow map of view_proj
+static bool shadow_cache_covers(const glm::mat4& view_proj, const std::vector<LLVector3>& points)
+{
+    for (const LLVector3& point : points)
+    {
+        glm::vec4 p = view_proj * glm::vec4(glm::make_vec3(point.mV), 1.f);
+        if (p.w <= 0.f || fabsf(p.x) > p.w || fabsf(p.y) > p.w)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LLPipeline::releaseShadowCache()
+{
+    for (ShadowCascadeCache& cache : mShadowCache)
+    {
+        cache.mStatic.release();
+        cache.mValid = false;
+    }
+}
+
+void LLPipeline::dirtyShadowCache(LLSpatialPartition* partition, const LLVector4a* extents)
+{
+    if (partition->isBridge() || is_dynamic_partition(partition->mPartitionType))
+    {
+        return;
+    }
+
+    LLVector4a center, size;
+    center.setAdd(extents[0], extents[1]);
+    center.mul(0.5f);
+    size.setSub(extents[1], extents[0]);
+    size.mul(0.5f);
+
+    for (ShadowCascadeCache& cache : mShadowCache)
+    {
+        if (cache.mValid && cache.mCamera.AABBInFrustum(center, size))
+        {
+            cache.mValid = false;
+        }
+    }
 }
+// </FS>
 
 void LLPipeline::releaseSpotShadowTargets()
 {
@@ -2156,9 +2405,97 @@ void LLPipeline::updateMoveNormalAsync(LLDrawable* drawablep)
     }
 }
 
+// <FS> Parallel move updates
+namespace
+{
+    // Fewer moved drawables than this are not worth waking the pool for
+    constexpr U32 MIN_PARALLEL_MOVES = 64;
+
+    // The targets are handed out one at a time. A helper the pool only starts
+    // after the others are done finds nothing left and only reads mCount.
+    struct MoveJob
+    {
+        LLDrawable::drawable_vector_t           mDrawables;
+        std::vector<LLDrawable::XformTarget>    mTargets;
+        U32                                     mCount = 0;
+        F32                                     mLerpAmt = 0.f;
+        std::atomic<U32>                        mNext{ 0 };
+        std::atomic<U32>                        mDone{ 0 };
+    };
+
+    void compute_move_targets(MoveJob& job)
+    {
+        for (U32 i = job.mNext++; i < job.mCount; i = job.mNext++)
+        {
+            LLDrawable* drawablep = job.mDrawables[i].get();
+            drawablep->computeXformTarget(drawablep->isState(LLDrawable::MOVE_UNDAMPED), job.mLerpAmt, job.mTargets[i]);
+            ++job.mDone;
+        }
+    }
+
+    // Work out where the drawables of moved_list that updateMove() would
+    // move go, on the main thread and as many "General" pool threads as are
+    // free. Avatars are left out, moving an animesh moves its avatar.
+    std::shared_ptr<MoveJob> compute_move_targets_parallel(const LLDrawable::drawable_vector_t& moved_list)
+    {
+        LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+
+        std::shared_ptr<MoveJob> job = std::make_shared<MoveJob>();
+        job->mDrawables.reserve(moved_list.size());
+        for (LLDrawable* drawablep : moved_list)
+        {
+            if (drawablep && !drawablep->isDead() && !drawablep->isState(LLDrawable::EARLY_MOVE)
+                && drawablep->getVObj().notNull() && !drawablep->isAvatar() && !drawablep->isSpatialBridge())
+            {
+                job->mDrawables.push_back(drawablep);
+            }
+        }
+        job->mCount = (U32)job->mDrawables.size();
+        job->mTargets.resize(job->mCount);
+        job->mLerpAmt = LLDrawable::getDampingInterpolant(); // its cache isn't thread safe
+
+        LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+        LL::ThreadPoolBase::ptr_t general_pool = LL::ThreadPoolBase::getInstance("General");
+        U32 helpers = 0;
+        if (general_queue && general_pool && job->mCount >= MIN_PARALLEL_MOVES)
+        {
+            helpers = llmin((U32)general_pool->getWidth(), job->mCount / MIN_PARALLEL_MOVES);
+        }
+
+        for (U32 i = 0; i < helpers; ++i)
+        {
+            if (!general_queue->tryPost([job]() { compute_move_targets(*job); }))
+            {
+                break;
+            }
+        }
+
+        compute_move_targets(*job);
+        while (job->mDone < job->mCount)
+        {
+            std::this_thread::yield();
+        }
+        return job;
+    }
+}
+// </FS>
+
 void LLPipeline::updateMovedList(LLDrawable::drawable_vector_t& moved_list)
 {
     LL_PROFILE_ZONE_SCOPED;
+
+    // <FS> Parallel move updates
+    // The targets only depend on each drawable and its object, the moves
+    // themselves touch the octrees and the build queues and stay in order
+    static LLCachedControl<bool> parallel_moves(gSavedSettings, "FSParallelMoveUpdates", true);
+    std::shared_ptr<MoveJob> job;
+    if (parallel_moves && moved_list.size() >= MIN_PARALLEL_MOVES)
+    {
+        job = compute_move_targets_parallel(moved_list);
+    }
+    U32 next_target = 0;
+    // </FS>
+
     for (LLDrawable::drawable_vector_t::iterator iter = moved_list.begin();
          iter != moved_list.end(); )
     {
@@ -2169,10 +2506,21 @@ void LLPipeline::updateMovedList(LLDrawable::drawable_vector_t& moved_list)
             iter = moved_list.erase(curiter);
             continue;
         }
+        // <FS> Parallel move updates
+        // drawables moved along the way have none or are no longer next
+        const LLDrawable::XformTarget* target = nullptr;
+        if (job && next_target < job->mCount && job->mDrawables[next_target] == drawablep)
+        {
+            target = &job->mTargets[next_target++];
+        }
+        // </FS>
         bool done = true;
         if (!drawablep->isDead() && (!drawablep->isState(LLDrawable::EARLY_MOVE)))
         {
-            done = drawablep->updateMove();
+            // <FS> Parallel move updates
+            //done = drawablep->updateMove();
+            done = target ? drawablep->updateMoveTo(*target) : drawablep->updateMove();
+            // </FS>
         }
         drawablep->clearState(LLDrawable::EARLY_MOVE | LLDrawable::MOVE_UNDAMPED);
         if (done)
@@ -2195,6 +2543,13 @@ void LLPipeline::updateMovedList(LLDrawable::drawable_vector_t& moved_list)
             iter = moved_list.erase(curiter);
         }
     }
+
+    // <FS> Parallel move updates
+    if (job)
+    { // let go of the drawables here, a late helper may still hold the job
+        job->mDrawables.clear();
+    }
+    // </FS>
 }
 
 void LLPipeline::updateMove()
@@ -2561,6 +2916,8 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, bool hud_att
     LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE; //LL_RECORD_BLOCK_TIME(FTM_CULL);
     LL_PROFILE_GPU_ZONE("updateCull"); // should always be zero GPU time, but drop a timer to flush stuff out
 
+    mHiZOcclusion.resolve(); // <FS/> Hi-Z occlusion
+
     bool water_clip = isWaterClip();
 
     if (water_clip)
@@ -2595,6 +2952,17 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, bool hud_att
 
     sCull->clear();
 
+    // <FS> Parallel culling
+    // Partitions can only be culled side by side when nothing reads
+    // occlusion queries (GL) and markNotCulled() doesn't update distances
+    // (LOD changes, rebuilds). That leaves the shadow and reflection probe
+    // passes; the main camera always culls serially, occlusion or not.
+    static LLCachedControl<bool> parallel_culling(gSavedSettings, "FSParallelCulling", true);
+    const bool cull_parallel = parallel_culling && sUseOcclusion < 2 &&
+        (LLViewerCamera::sCurCameraID != LLViewerCamera::CAMERA_WORLD || gCubeSnapshot);
+    std::vector<LLSpatialPartition*> parallel_parts;
+    // </FS>
+
     for (LLWorld::region_list_t::const_iterator iter = LLWorld::getInstance()->getRegionList().begin();
             iter != LLWorld::getInstance()->getRegionList().end(); ++iter)
     {
@@ -2607,7 +2975,25 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, bool hud_att
             {
                 if (!hud_attachments ? LLViewerRegion::PARTITION_BRIDGE == i || hasRenderType(part->mDrawableType) : hasRenderType(part->mDrawableType))
                 {
-                    part->cull(camera);
+                    // <FS> Shadow cache, cached cascades cull their static and moving parts apart
+                    if (sShadowGeometry != SHADOW_GEOMETRY_ALL &&
+                        is_dynamic_partition(i) != (sShadowGeometry == SHADOW_GEOMETRY_DYNAMIC))
+                    {
+                        continue;
+                    }
+                    // </FS>
+
+                    // <FS> Parallel culling
+                    //part->cull(camera);
+                    if (cull_parallel)
+                    {
+                        parallel_parts.push_back(part);
+                    }
+                    else
+                    {
+                        part->cull(camera);
+                    }
+                    // </FS>
                 }
             }
         }
@@ -2622,6 +3008,14 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, bool hud_att
         }
     }
 
+    // <FS> Parallel culling
+    // After the object cache culls, which move the camera's region planes
+    if (!parallel_parts.empty())
+    {
+        cull_partitions_parallel(camera, parallel_parts, mNumVisibleNodes);
+    }
+    // </FS>
+
     if (hasRenderType(LLPipeline::RENDER_TYPE_SKY) &&
         gSky.mVOSkyp.notNull() &&
         gSky.mVOSkyp->mDrawable.notNull())
@@ -2658,13 +3052,23 @@ void LLPipeline::markNotCulled(LLSpatialGroup* group, LLCamera& camera)
 
     assertInitialized();
 
+    // <FS> Parallel culling
+    LLCullResult* cull = sThreadCullSlot ? &sThreadCullSlot->mResult : sCull;
+    // </FS>
+
     if (!group->getSpatialPartition()->mRenderByGroup)
     { //render by drawable
-        sCull->pushDrawableGroup(group);
+        // <FS> Parallel culling
+        //sCull->pushDrawableGroup(group);
+        cull->pushDrawableGroup(group);
+        // </FS>
     }
     else
     {   //render by group
-        sCull->pushVisibleGroup(group);
+        // <FS> Parallel culling
+        //sCull->pushVisibleGroup(group);
+        cull->pushVisibleGroup(group);
+        // </FS>
     }
 
     if (group->needsUpdate() ||
@@ -2674,7 +3078,17 @@ void LLPipeline::markNotCulled(LLSpatialGroup* group, LLCamera& camera)
         // an occlusion query to find out if it's an occluder
         markOccluder(group);
     }
-    mNumVisibleNodes++;
+    // <FS> Parallel culling
+    //mNumVisibleNodes++;
+    if (sThreadCullSlot)
+    {
+        sThreadCullSlot->mVisibleNodes++;
+    }
+    else
+    {
+        mNumVisibleNodes++;
+    }
+    // </FS>
 }
 
 void LLPipeline::markOccluder(LLSpatialGroup* group)
@@ -2760,6 +3174,8 @@ void LLPipeline::doOcclusion(LLCamera& camera)
 
         LLGLDisable cull(GL_CULL_FACE);
 
+        mHiZOcclusion.beginTest(mRT->deferredScreen); // <FS/> Hi-Z occlusion
+
         gOcclusionCubeProgram.bind();
 
         if (mCubeVB.isNull())
@@ -2789,6 +3205,8 @@ void LLPipeline::doOcclusion(LLCamera& camera)
             }
         }
 
+        mHiZOcclusion.endTest(); // <FS/> Hi-Z occlusion
+
         gGL.setColorMask(true, true);
     }
 }
@@ -2933,6 +3351,15 @@ void LLPipeline::updateGeom(F32 max_dtime)
     // for now, only LLVOVolume does this to throttle LOD changes
     LLVOVolume::preUpdateGeom();
 
+    // <FS/> Parallel flexi updates, step the flexis queued for a rebuild before writing their geometry
+    LLVolumeImplFlexible::simulatePending();
+
+    // <FS> Rigged rebuild budget
+    static LLCachedControl<bool> rigged_budget(gSavedSettings, "FSRiggedRebuildBudget", true);
+    static LLCachedControl<F32> rigged_budget_ms(gSavedSettings, "FSRiggedRebuildBudgetMs", 2.f);
+    mRiggedBuildQ.clear();
+    // </FS>
+
     // Iterate through all drawables on the priority build queue,
     for (LLDrawable::drawable_list_t::iterator iter = mBuildQ1.begin();
          iter != mBuildQ1.end();)
@@ -2941,6 +3368,22 @@ void LLPipeline::updateGeom(F32 max_dtime)
         LLDrawable* drawablep = *curiter;
         if (drawablep && !drawablep->isDead())
         {
+            // <FS> Rigged rebuild budget
+            // Rigged meshes of avatars are rebuilt after everything else,
+            // as far as the budget goes, and keep their old geometry until then
+            if (rigged_budget)
+            {
+                LLVOVolume* vobj = drawablep->getVOVolume();
+                LLVOAvatar* avatar = vobj ? vobj->getAvatar() : nullptr;
+                if (avatar && vobj->isRiggedMeshFast() && !drawablep->isUnload())
+                {
+                    // own avatar first, then by size on screen
+                    mRiggedBuildQ.emplace_back(avatar->isSelf() ? F32_MAX : avatar->getPixelArea(), curiter);
+                    continue;
+                }
+            }
+            // </FS>
+
             if (drawablep->isUnload())
             {
                 drawablep->unload();
@@ -2959,6 +3402,45 @@ void LLPipeline::updateGeom(F32 max_dtime)
         }
     }
 
+    // <FS> Rigged rebuild budget
+    if (!mRiggedBuildQ.empty())
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_PIPELINE("rigged rebuild budget");
+
+        std::stable_sort(mRiggedBuildQ.begin(), mRiggedBuildQ.end(),
+            [](const std::pair<F32, LLDrawable::drawable_list_t::iterator>& a,
+               const std::pair<F32, LLDrawable::drawable_list_t::iterator>& b)
+            {
+                return a.first > b.first;
+            });
+
+        LLTimer rigged_timer;
+        const F32 budget = rigged_budget_ms / 1000.f;
+        for (auto& entry : mRiggedBuildQ)
+        {
+            // at least one a frame, so the queue always drains
+            if (&entry != &mRiggedBuildQ.front() && rigged_timer.getElapsedTimeF32() > budget)
+            {
+                break;
+            }
+
+            LLDrawable* drawablep = *entry.second;
+            if (drawablep->isDead())
+            {
+                mBuildQ1.erase(entry.second);
+            }
+            else if (updateDrawableGeom(drawablep))
+            {
+                drawablep->clearState(LLDrawable::IN_REBUILD_Q);
+                mBuildQ1.erase(entry.second);
+            }
+        }
+
+        // the rest stays in mBuildQ1 for the next frames
+        mRiggedBuildQ.clear();
+    }
+    // </FS>
+
     updateMovedList(mMovedBridge);
 }
 
@@ -3004,6 +3486,15 @@ void LLPipeline::markVisible(LLDrawable *drawablep, LLCamera& camera)
     }
 }
 
+// <FS> Mirror reuse
+static void mark_hero_changed(LLDrawable* drawablep)
+{
+    LLVector4a center;
+    center.load3(drawablep->getPositionAgent().mV);
+    gPipeline.mHeroProbeManager.markChanged(center, drawablep->getRadius());
+}
+// </FS>
+
 void LLPipeline::markMoved(LLDrawable *drawablep, bool damped_motion)
 {
     if (!drawablep)
@@ -3037,6 +3528,8 @@ void LLPipeline::markMoved(LLDrawable *drawablep, bool damped_motion)
             mMovedList.push_back(drawablep);
         }
         drawablep->setState(LLDrawable::ON_MOVE_LIST);
+        mark_hero_changed(drawablep); // <FS/> Mirror reuse
+        mHUDCache.markChanged(drawablep->getSpatialGroup()); // <FS/> HUD cache
     }
     if (! damped_motion)
     {
@@ -3109,6 +3602,13 @@ void LLPipeline::shiftObjects(const LLVector3 &offset)
 
     mReflectionMapManager.shift(offseta);
 
+    // <FS> Shadow cache, the cached projections are in the old agent frame
+    for (ShadowCascadeCache& cache : mShadowCache)
+    {
+        cache.mValid = false;
+    }
+    // </FS>
+
     LLHUDText::shiftAll(offset);
     LLHUDNameTag::shiftAll(offset);
 
@@ -3178,6 +3678,11 @@ void LLPipeline::markRebuild(LLSpatialGroup* group)
 
             mGroupQ1.push_back(group);
             group->setState(LLSpatialGroup::IN_BUILD_Q1);
+            // <FS> Mirror reuse
+            const LLVector4a* bounds = group->getBounds();
+            mHeroProbeManager.markChanged(bounds[0], bounds[1].getLength3().getF32());
+            // </FS>
+            mHUDCache.markChanged(group); // <FS/> HUD cache
         }
     }
 }
@@ -3190,6 +3695,8 @@ void LLPipeline::markRebuild(LLDrawable *drawablep, LLDrawable::EDrawableFlags f
         {
             mBuildQ1.push_back(drawablep);
             drawablep->setState(LLDrawable::IN_REBUILD_Q); // mark drawable as being in priority queue
+            mark_hero_changed(drawablep); // <FS/> Mirror reuse
+            mHUDCache.markChanged(drawablep->getSpatialGroup()); // <FS/> HUD cache
         }
 
         // <FS:Ansariel> FIRE-16485: Crash when calling texture refresh on an object that has a blacklisted copy
@@ -3665,6 +4172,33 @@ void renderSoundHighlights(LLDrawable *drawablep)
     }
 }
 
+// <FS> Radix sorted alpha groups
+// Same order as LLSpatialGroup::CompareDepthGreater, farthest first. The keys
+// hold the depth in the high half and the position in the list in the low
+// half, groups at the same depth keep their cull order.
+static void sort_alpha_groups(LLCullResult::sg_iterator begin, LLCullResult::sg_iterator end)
+{
+    static std::vector<U64> keys;
+    static std::vector<U64> scratch;
+    static std::vector<LLSpatialGroup*> groups;
+
+    const U32 count = (U32)(end - begin);
+    keys.resize(count);
+    for (U32 i = 0; i < count; ++i)
+    {
+        keys[i] = ((U64)~ll_float_sort_key(begin[i]->mDepth) << 32) | i;
+    }
+
+    ll_radix_sort(keys, scratch);
+
+    groups.assign(begin, end);
+    for (U32 i = 0; i < count; ++i)
+    {
+        begin[i] = groups[(U32)keys[i]];
+    }
+}
+// </FS>
+
 void LLPipeline::postSort(LLCamera &camera)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
@@ -3672,6 +4206,15 @@ void LLPipeline::postSort(LLCamera &camera)
     assertInitialized();
     sVolumeSAFrame = 0.f; //ZK LBG
 
+    // <FS> Render submit thread, the uploads of the rebuilds below are sent
+    // from the submit thread while the frame goes on
+    LLGLSubmitThread* submit_thread = LLGLSubmitThread::getInstance();
+    if (submit_thread)
+    {
+        submit_thread->beginRecording();
+    }
+    // </FS>
+
     LL_PUSH_CALLSTACKS();
 
     if (!gCubeSnapshot)
@@ -3742,6 +4285,20 @@ void LLPipeline::postSort(LLCamera &camera)
             }
         }
 
+        // <FS> Mesh instancing
+        if (!group->mMeshInstances.empty() && hasRenderType(LLPipeline::RENDER_TYPE_PASS_GLTF_PBR))
+        {
+            sCull->pushInstanceGroup(group);
+            if (!sShadowRender && !sReflectionRender && !gCubeSnapshot)
+            {
+                for (const LLSpatialGroup::MeshInstance& instance : group->mMeshInstances)
+                {
+                    addTrianglesDrawn(instance.mVolume->getVolumeFace(instance.mVolumeFace).mNumIndices);
+                }
+            }
+        }
+        // </FS>
+
         if (hasRenderType(LLPipeline::RENDER_TYPE_PASS_ALPHA))
         {
             LL_PROFILE_ZONE_NAMED_CATEGORY_PIPELINE("Collect Alpha groups");
@@ -3820,7 +4377,10 @@ void LLPipeline::postSort(LLCamera &camera)
     if (!sShadowRender)
     {
         // order alpha groups by distance
-        std::sort(sCull->beginAlphaGroups(), sCull->endAlphaGroups(), LLSpatialGroup::CompareDepthGreater());
+        // <FS> Radix sorted alpha groups
+        //std::sort(sCull->beginAlphaGroups(), sCull->endAlphaGroups(), LLSpatialGroup::CompareDepthGreater());
+        sort_alpha_groups(sCull->beginAlphaGroups(), sCull->endAlphaGroups());
+        // </FS>
 
         // order rigged alpha groups by avatar attachment order
         std::sort(sCull->beginRiggedAlphaGroups(), sCull->endRiggedAlphaGroups(), LLSpatialGroup::CompareRenderOrder());
@@ -3948,6 +4508,14 @@ void LLPipeline::postSort(LLCamera &camera)
     }
 
     LLVertexBuffer::flushBuffers();
+
+    // <FS> Render submit thread
+    if (submit_thread)
+    {
+        submit_thread->submit();
+    }
+    // </FS>
+
     // LLSpatialGroup::sNoDelete = false;
     LL_PUSH_CALLSTACKS();
 }
@@ -4104,6 +4672,7 @@ void LLPipeline::renderGeomDeferred(LLCamera& camera, bool do_occlusion)
     LLAppViewer::instance()->pingMainloopTimeout("Pipeline:RenderGeomDeferred");
     LL_PROFILE_ZONE_SCOPED_CATEGORY_DRAWPOOL; //LL_RECORD_BLOCK_TIME(FTM_RENDER_GEOMETRY);
     LL_PROFILE_GPU_ZONE("renderGeomDeferred");
+    FSGPUPassTimer::Scope gpu_pass(mGPUPassTimer, FSGPUPassTimer::PASS_DEFERRED); // <FS/> GPU pass timers
 
     llassert(!sRenderingHUDs);
 
@@ -7425,6 +7994,84 @@ void LLPipeline::gammaCorrect(LLRenderTarget* src, LLRenderTarget* dst)
     dst->flush();
 }
 
+// <FS> Fused post processing
+bool LLPipeline::tonemapSharpenGammaCorrect(LLRenderTarget* src, LLRenderTarget* dst)
+{
+    static LLCachedControl<bool> fused(gSavedSettings, "FSFusedPostProcess", true);
+    static LLCachedControl<bool> buildNoPost(gSavedSettings, "RenderDisablePostProcessing", false);
+    static LLCachedControl<bool> should_auto_adjust(gSavedSettings, "RenderSkyAutoAdjustLegacy", false);
+    static LLCachedControl<F32> cas_sharpness(gSavedSettings, "RenderCASSharpness", 0.4f);
+
+    if (!fused || src->getWidth() != dst->getWidth() || src->getHeight() != dst->getHeight())
+    {
+        return false;
+    }
+
+    // the no post tonemap and the legacy gamma are left to the separate passes
+    LLSettingsSky::ptr_t psky = LLEnvironment::instance().getCurrentSky();
+    if (gSnapshotNoPost || psky->getReflectionProbeAmbiance(should_auto_adjust) == 0.f || (buildNoPost && gFloaterTools->isAvailable()))
+    {
+        return false;
+    }
+
+    const bool sharpen = cas_sharpness > 0.f;
+    LLGLSLShader& shader = sharpen ? gFusedCASTonemapGammaProgram : gFusedTonemapGammaProgram;
+    if (!shader.isComplete())
+    {
+        return false;
+    }
+
+    dst->bindTarget();
+    {
+        LL_PROFILE_GPU_ZONE("tonemap sharpen gamma correct");
+
+        LLGLDepthTest depth(GL_FALSE, GL_FALSE);
+
+        shader.bind();
+
+        shader.bindTexture(LLShaderMgr::DEFERRED_DIFFUSE, src, false, LLTexUnit::TFO_POINT);
+        shader.bindTexture(LLShaderMgr::EXPOSURE_MAP, &mExposureMap);
+        shader.uniform2f(LLShaderMgr::DEFERRED_SCREEN_RES, (GLfloat)src->getWidth(), (GLfloat)src->getHeight());
+
+        // as in tonemap()
+        static LLCachedControl<F32> exposure(gSavedSettings, "RenderExposure", 1.f);
+        static LLCachedControl<U32> tonemap_type_setting(gSavedSettings, "RenderTonemapType", 0U);
+        static LLStaticHashedString s_exposure("exposure");
+        static LLStaticHashedString tonemap_mix("tonemap_mix");
+        static LLStaticHashedString tonemap_type("tonemap_type");
+
+        shader.uniform1f(s_exposure, llclamp(exposure(), 0.5f, 4.f));
+        shader.uniform1i(tonemap_type, tonemap_type_setting);
+        shader.uniform1f(tonemap_mix, psky->getTonemapMix());
+
+        if (sharpen)
+        { // as in applyCAS()
+            static LLStaticHashedString cas_param_0("cas_param_0");
+            static LLStaticHashedString cas_param_1("cas_param_1");
+            static LLStaticHashedString out_screen_res("out_screen_res");
+
+            varAU4(const0);
+            varAU4(const1);
+            CasSetup(const0, const1,
+                cas_sharpness(),
+                (AF1)src->getWidth(), (AF1)src->getHeight(),
+                (AF1)dst->getWidth(), (AF1)dst->getHeight());
+
+            shader.uniform4uiv(cas_param_0, 1, const0);
+            shader.uniform4uiv(cas_param_1, 1, const1);
+            shader.uniform2f(out_screen_res, (AF1)dst->getWidth(), (AF1)dst->getHeight());
+        }
+
+        mScreenTriangleVB->setBuffer();
+        mScreenTriangleVB->drawArrays(LLRender::TRIANGLES, 0, 3);
+
+        shader.unbind();
+    }
+    dst->flush();
+    return true;
+}
+// </FS>
+
 void LLPipeline::copyScreenSpaceReflections(LLRenderTarget* src, LLRenderTarget* dst)
 {
 
@@ -7565,13 +8212,22 @@ void LLPipeline::generateGlow(LLRenderTarget* src)
 void LLPipeline::applyCAS(LLRenderTarget* src, LLRenderTarget* dst)
 {
     static LLCachedControl<F32> cas_sharpness(gSavedSettings, "RenderCASSharpness", 0.4f);
-    if (cas_sharpness == 0.0f || !gCASProgram.isComplete())
+    // <FS> Dynamic resolution, CAS also scales up to a larger dst
+    //if (cas_sharpness == 0.0f || !gCASProgram.isComplete())
+    //{
+    //    gPipeline.copyRenderTarget(src, dst);
+    //    return;
+    //}
+    //
+    //LLGLSLShader* sharpen_shader = &gCASProgram;
+    const bool upscale = src->getWidth() != dst->getWidth() || src->getHeight() != dst->getHeight();
+    LLGLSLShader* sharpen_shader = upscale ? &gCASUpscaleProgram : &gCASProgram;
+    if ((cas_sharpness == 0.0f && !upscale) || !sharpen_shader->isComplete())
     {
         gPipeline.copyRenderTarget(src, dst);
         return;
     }
-
-    LLGLSLShader* sharpen_shader = &gCASProgram;
+    // </FS>
 
     // Bind setup:
     dst->bindTarget();
@@ -8345,6 +9001,7 @@ void LLPipeline::renderFinalize()
 
     LL_RECORD_BLOCK_TIME(FTM_RENDER_BLOOM);
     LL_PROFILE_GPU_ZONE("renderFinalize");
+    FSGPUPassTimer::Scope gpu_pass(mGPUPassTimer, FSGPUPassTimer::PASS_POST); // <FS/> GPU pass timers
 
     gGL.color4f(1, 1, 1, 1);
     LLGLDepthTest depth(GL_FALSE);
@@ -8359,6 +9016,12 @@ void LLPipeline::renderFinalize()
     static LLCachedControl<bool> has_hdr(gSavedSettings, "RenderHDREnabled", true);
     bool hdr = gGLManager.mGLVersion > 4.05f && has_hdr();
 
+    // <FS> Dynamic resolution, the world was rendered below the size of the upscale target
+    const bool upscale = mUpscaleMap.isComplete()
+        && (mUpscaleMap.getWidth() > mRT->screen.getWidth() || mUpscaleMap.getHeight() > mRT->screen.getHeight());
+    // </FS>
+
+    bool fused = false; // <FS/> Fused post processing
     if (hdr)
     {
         copyScreenSpaceReflections(&mRT->screen, &mSceneMap);
@@ -8367,14 +9030,38 @@ void LLPipeline::renderFinalize()
 
         generateExposure(&mLuminanceMap, &mExposureMap);
 
-        tonemap(&mRT->screen, &mPostMap);
+        // <FS> Fused post processing, SMAA finds its edges before gamma correction
+        fused = !upscale && RenderFSAAType != 2 && tonemapSharpenGammaCorrect(&mRT->screen, &mPostMap);
+        if (!fused)
+        {
+        // </FS>
+            tonemap(&mRT->screen, &mPostMap);
 
-        applyCAS(&mPostMap, &mRT->screen);
+            // <FS> Dynamic resolution, sharpened on the way up below instead
+            //applyCAS(&mPostMap, &mRT->screen);
+            if (upscale)
+            {
+                copyRenderTarget(&mPostMap, &mRT->screen);
+            }
+            else
+            {
+                applyCAS(&mPostMap, &mRT->screen);
+            }
+            // </FS>
+        } // <FS/> Fused post processing
     }
 
-    generateSMAABuffers(&mRT->screen);
+    // <FS> Fused post processing
+    //generateSMAABuffers(&mRT->screen);
+    //
+    //gammaCorrect(&mRT->screen, &mPostMap);
+    if (!fused)
+    {
+        generateSMAABuffers(&mRT->screen);
 
-    gammaCorrect(&mRT->screen, &mPostMap);
+        gammaCorrect(&mRT->screen, &mPostMap);
+    }
+    // </FS>
 
     LLVertexBuffer::unbind();
 
@@ -8430,6 +9117,14 @@ void LLPipeline::renderFinalize()
 
     finalBuffer = activeBuffer;
     // </FS:Beq>
+
+    // <FS> Dynamic resolution
+    if (upscale)
+    {
+        applyCAS(finalBuffer, &mUpscaleMap);
+        finalBuffer = &mUpscaleMap;
+    }
+    // </FS>
     if (RenderBufferVisualization > -1)
     {
         switch (RenderBufferVisualization)
@@ -8847,6 +9542,7 @@ void LLPipeline::renderDeferredLighting()
 
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_PIPELINE("deferred");
+        FSGPUPassTimer::Scope gpu_pass(mGPUPassTimer, FSGPUPassTimer::PASS_LIGHTING); // <FS/> GPU pass timers
         LLViewerCamera *camera = LLViewerCamera::getInstance();
 
         if (gPipeline.hasRenderType(LLPipeline::RENDER_TYPE_HUD))
@@ -9045,10 +9741,22 @@ void LLPipeline::renderDeferredLighting()
                 // It is calculated from mLights
                 // mNearbyLights also provides fade value to gracefully fade-out out of range lights
                 S32 count = 0;
+
+                // <FS> Clustered lighting
+                // point lights cost little per light when clustered, they get a limit of their own
+                static LLCachedControl<S32> clustered_light_count(gSavedSettings, "FSClusteredLightCount", 1024);
+                const bool clustered = FSClusteredLights::isEnabled();
+                const S32 light_limit = clustered ? (S32)clustered_light_count : (S32)local_light_count;
+                mClusteredLights.clear();
+                // </FS>
+
                 for (light_set_t::iterator iter = mNearbyLights.begin(); iter != mNearbyLights.end(); ++iter)
                 {
                     count++;
-                    if (count > local_light_count)
+                    // <FS> Clustered lighting
+                    //if (count > local_light_count)
+                    if (count > light_limit)
+                    // </FS>
                     { //stop collecting lights once we hit the limit
                         break;
                     }
@@ -9101,6 +9809,17 @@ void LLPipeline::renderDeferredLighting()
 
                     sVisibleLightCount++;
 
+                    // <FS> Clustered lighting
+                    if (clustered && !volume->isLightSpotlight())
+                    {
+                        glm::vec3 vc = mul_mat4_vec3(mat, glm::make_vec3(c));
+                        if (mClusteredLights.add(LLVector3(glm::value_ptr(vc)), s, col, volume->getLightFalloff(DEFERRED_LIGHT_FALLOFF)))
+                        {
+                            continue;
+                        }
+                    }
+                    // </FS>
+
                     if (camera->getOrigin().mV[0] > c[0] + s + 0.2f || camera->getOrigin().mV[0] < c[0] - s - 0.2f ||
                         camera->getOrigin().mV[1] > c[1] + s + 0.2f || camera->getOrigin().mV[1] < c[1] - s - 0.2f ||
                         camera->getOrigin().mV[2] > c[2] + s + 0.2f || camera->getOrigin().mV[2] < c[2] - s - 0.2f)
@@ -9145,6 +9864,29 @@ void LLPipeline::renderDeferredLighting()
                 unbindDeferredShader(gDeferredLightProgram);
             }
 
+            // <FS> Clustered lighting
+            if (!mClusteredLights.empty())
+            {
+                LL_PROFILE_ZONE_NAMED_CATEGORY_PIPELINE("renderDeferredLighting - clustered lights");
+                LL_PROFILE_GPU_ZONE("clustered lights");
+
+                if (mClusteredLights.prepare(get_current_projection(), camera->getNear()))
+                {
+                    LLGLDepthTest depth(GL_FALSE);
+                    bindDeferredShader(gDeferredClusteredLightProgram);
+                    mClusteredLights.bind(gDeferredClusteredLightProgram);
+                    gDeferredClusteredLightProgram.uniform1i(LLShaderMgr::CLASSIC_MODE, (psky->canAutoAdjust()) ? 1 : 0);
+
+                    mScreenTriangleVB->setBuffer();
+                    mScreenTriangleVB->drawArrays(LLRender::TRIANGLES, 0, 3);
+
+                    mClusteredLights.unbind(gDeferredClusteredLightProgram);
+                    unbindDeferredShader(gDeferredClusteredLightProgram);
+                }
+                mClusteredLights.clear();
+            }
+            // </FS>
+
             if (!spot_lights.empty())
             {
                 LL_PROFILE_ZONE_NAMED_CATEGORY_PIPELINE("renderDeferredLighting - projectors");
@@ -9270,6 +10012,7 @@ void LLPipeline::renderDeferredLighting()
     }
 
     {  // render non-deferred geometry (alpha, fullbright, glow)
+        FS_GPU_PASS_TIMER(mGPUPassTimer, FSGPUPassTimer::PASS_ALPHA, "alpha"); // <FS/> GPU pass timers
         LLGLDisable blend(GL_BLEND);
 
         pushRenderTypeMask();
@@ -9907,12 +10650,37 @@ void LLPipeline::renderShadow(const glm::mat4& view, const glm::mat4& proj, LLCa
         LL_PROFILE_GPU_ZONE("shadow simple");
         gGL.getTexUnit(0)->disable();
 
-        for (U32 type : types)
+        // <FS> Pre-skinned shadows
+        //for (U32 type : types)
+        //{
+        //    renderObjects(type, false, false, rigged);
+        //}
+        //
+        //renderGLTFObjects(LLRenderPass::PASS_GLTF_PBR, false, rigged);
+        static LLCachedControl<bool> pre_skinned(gSavedSettings, "FSPreSkinnedShadows", true);
+        if (rigged && pre_skinned)
+        {
+            mSkinCache.renderShadow(types, (U32)LL_ARRAY_SIZE(types));
+            LL::GLTFSceneManager::instance().render(true, true);
+        }
+        else
         {
-            renderObjects(type, false, false, rigged);
+            for (U32 type : types)
+            {
+                renderObjects(type, false, false, rigged);
+            }
+
+            renderGLTFObjects(LLRenderPass::PASS_GLTF_PBR, false, rigged);
         }
+        // </FS>
 
-        renderGLTFObjects(LLRenderPass::PASS_GLTF_PBR, false, rigged);
+        // <FS> Mesh instancing
+        if (!rigged)
+        {
+            gDeferredShadowInstancedProgram.bind();
+            mMeshInstancer.render(true);
+        }
+        // </FS>
 
         gGL.getTexUnit(0)->enable(LLTexUnit::TT_TEXTURE);
     }
@@ -10265,6 +11033,7 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
 
     LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE; //LL_RECORD_BLOCK_TIME(FTM_GEN_SUN_SHADOW);
     LL_PROFILE_GPU_ZONE("generateSunShadow");
+    FSGPUPassTimer::Scope gpu_pass(mGPUPassTimer, FSGPUPassTimer::PASS_SHADOW); // <FS/> GPU pass timers
 
     LLDisableOcclusionCulling no_occlusion;
 
@@ -10485,6 +11254,19 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
     // convenience array of 4 near clip plane distances
     F32 dist[] = { near_clip, mSunClipPlanes.mV[0], mSunClipPlanes.mV[1], mSunClipPlanes.mV[2], mSunClipPlanes.mV[3] };
 
+    // <FS> Shadow cache
+    static LLCachedControl<bool> shadow_cache(gSavedSettings, "FSShadowCache", true);
+    static LLCachedControl<F32> shadow_cache_sun_angle(gSavedSettings, "FSShadowCacheSunAngle", 0.5f);
+    static LLCachedControl<F32> shadow_cache_padding(gSavedSettings, "FSShadowCachePadding", 0.25f);
+    if (!shadow_cache && mShadowCache[0].mStatic.isComplete())
+    {
+        releaseShadowCache();
+    }
+    // Reflection probes have their own targets and splits, the debug view freezes the frusta
+    const bool use_shadow_cache = shadow_cache && !gCubeSnapshot && !hasRenderDebugMask(RENDER_DEBUG_SHADOW_FRUSTA);
+    const F32 sun_moved_dot = cosf(llclamp((F32)shadow_cache_sun_angle, 0.f, 90.f) * DEG_TO_RAD);
+    // </FS>
+
     if (mSunDiffuse == LLColor4::black)
     { //sun diffuse is totally black shadows don't matter
         skipRenderingShadows();
@@ -10574,6 +11356,10 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
                 mShadowFrustPoints[j] = fp;
             }
 
+            // <FS> Shadow cache
+            ShadowCascadeCache* cache = (use_shadow_cache && j >= (S32)SHADOW_CACHE_FIRST_SPLIT) ? &mShadowCache[j - SHADOW_CACHE_FIRST_SPLIT] : nullptr;
+            // </FS>
+
 
             //find a good origin for shadow projection
             LLVector3 origin;
@@ -10683,10 +11469,21 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
                 mShadowError.mV[j] /= wpf.size();
                 mShadowError.mV[j] /= size.mV[0];
 
-                if (mShadowError.mV[j] > RenderShadowErrorCutoff)
+                // <FS> Shadow cache, cached cascades stay orthographic so their projection doesn't follow the camera
+                //if (mShadowError.mV[j] > RenderShadowErrorCutoff)
+                if (mShadowError.mV[j] > RenderShadowErrorCutoff || cache)
+                // </FS>
                 { //just use ortho projection
                     mShadowFOV.mV[j] = -1.f;
                     origin.clearVec();
+                    // <FS> Shadow cache, leave room for the camera to move before the cascade must be rendered again
+                    if (cache)
+                    {
+                        LLVector3 pad = size * llmax((F32)shadow_cache_padding, 0.f) * 2.f;
+                        min -= pad;
+                        max += pad;
+                    }
+                    // </FS>
                     proj[j] = glm::ortho(min.mV[0], max.mV[0],
                                         min.mV[1], max.mV[1],
                                         -max.mV[2], -min.mV[2]);
@@ -10813,6 +11610,23 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
                 }
             }
 
+            // <FS> Shadow cache
+            // Keep the static depth while the sun holds still and its
+            // projection still covers everything this split can see
+            bool render_static = true;
+            if (cache && cache->mValid && cache->mLightDir * lightDir >= sun_moved_dot &&
+                shadow_cache_covers(cache->mProj * cache->mView, fp))
+            {
+                render_static = false;
+                view[j] = cache->mView;
+                proj[j] = cache->mProj;
+                eye = cache->mEye;
+                center = cache->mCenter;
+                mShadowError.mV[j] = cache->mError;
+                mShadowFOV.mV[j] = cache->mFOV;
+            }
+            // </FS>
+
             //shadow_cam.setFar(128.f);
             shadow_cam.setOriginAndLookAt(eye, up, center);
 
@@ -10844,16 +11658,74 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
 
             stop_glerror();
 
-            mRT->shadow[j].bindTarget();
-            mRT->shadow[j].getViewport(gGLViewport);
-            mRT->shadow[j].clear();
-
+            // <FS> Shadow cache
+            if (cache)
             {
-                static LLCullResult result[4];
-                renderShadow(view[j], proj[j], shadow_cam, result[j], true);
+                LLRenderTarget& shadow_target = mRT->shadow[j];
+                if (cache->mStatic.getWidth() != shadow_target.getWidth() || cache->mStatic.getHeight() != shadow_target.getHeight())
+                {
+                    cache->mStatic.allocate(shadow_target.getWidth(), shadow_target.getHeight(), 0, true);
+                    render_static = true;
+                }
+
+                cache->mStatic.bindTarget();
+                if (render_static)
+                {
+                    cache->mStatic.getViewport(gGLViewport);
+                    cache->mStatic.clear();
+
+                    cache->mView = view[j];
+                    cache->mProj = proj[j];
+                    cache->mCamera = shadow_cam;
+                    cache->mLightDir = lightDir;
+                    cache->mEye = eye;
+                    cache->mCenter = center;
+                    cache->mError = mShadowError.mV[j];
+                    cache->mFOV = mShadowFOV.mV[j];
+                    cache->mValid = true;
+
+                    pushRenderTypeMask();
+                    clearRenderTypeMask(RENDER_TYPE_AVATAR, RENDER_TYPE_CONTROL_AV, END_RENDER_TYPES);
+                    sShadowGeometry = SHADOW_GEOMETRY_STATIC;
+                    static LLCullResult static_result[4 - SHADOW_CACHE_FIRST_SPLIT];
+                    renderShadow(view[j], proj[j], shadow_cam, static_result[j - SHADOW_CACHE_FIRST_SPLIT], true);
+                    sShadowGeometry = SHADOW_GEOMETRY_ALL;
+                    popRenderTypeMask();
+                }
+
+                // Start from the static depth, then add what moves
+                gGL.getTexUnit(0)->bindManual(LLTexUnit::TT_TEXTURE, shadow_target.getDepth());
+                glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, shadow_target.getWidth(), shadow_target.getHeight());
+                gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+                cache->mStatic.flush();
+
+                shadow_target.bindTarget();
+                shadow_target.getViewport(gGLViewport);
+
+                pushRenderTypeMask();
+                clearRenderTypeMask(RENDER_TYPE_TERRAIN, RENDER_TYPE_TREE, RENDER_TYPE_GRASS, RENDER_TYPE_WATER, RENDER_TYPE_VOIDWATER, END_RENDER_TYPES);
+                sShadowGeometry = SHADOW_GEOMETRY_DYNAMIC;
+                static LLCullResult dynamic_result[4 - SHADOW_CACHE_FIRST_SPLIT];
+                renderShadow(view[j], proj[j], shadow_cam, dynamic_result[j - SHADOW_CACHE_FIRST_SPLIT], true);
+                sShadowGeometry = SHADOW_GEOMETRY_ALL;
+                popRenderTypeMask();
+
+                shadow_target.flush();
             }
+            else
+            // </FS>
+            {
+                mRT->shadow[j].bindTarget();
+                mRT->shadow[j].getViewport(gGLViewport);
+                mRT->shadow[j].clear();
 
-            mRT->shadow[j].flush();
+                {
+                    static LLCullResult result[4];
+                    renderShadow(view[j], proj[j], shadow_cam, result[j], true);
+                }
+
+                mRT->shadow[j].flush();
+            }
 
             if (!gPipeline.hasRenderDebugMask(LLPipeline::RENDER_DEBUG_SHADOW_FRUSTA) && !gCubeSnapshot)
             {
@@ -11307,6 +12179,7 @@ void LLPipeline::generateImpostor(LLVOAvatar* avatar, bool preview_avatar, bool
     LLVector2 tdim;
     U32 resY = 0;
     U32 resX = 0;
+    LLRenderTarget* impostor_target = &avatar->mImpostor; // <FS/> Impostor atlas
 
     if (!preview_avatar)
     {
@@ -11366,6 +12239,24 @@ void LLPipeline::generateImpostor(LLVOAvatar* avatar, bool preview_avatar, bool
 
         if (!for_profile)
         {
+            LLVRAMAccounting::Scope vram_scope({ LLVRAMCategory::IMPOSTOR, 0, LLVRAMOwner::AVATAR }); // <FS/> VRAM accounting
+            // <FS> Impostor atlas
+            static LLCachedControl<bool> use_atlas(gSavedSettings, "FSImpostorAtlas", true);
+            LLRenderTarget* atlas_target = nullptr;
+            if (use_atlas && mImpostorAtlas.allocate(avatar->mImpostorSlot, resX, resY))
+            {
+                atlas_target = mImpostorAtlas.getTarget(avatar->mImpostorSlot);
+            }
+
+            if (atlas_target)
+            {
+                avatar->mImpostor.release();
+                impostor_target = atlas_target;
+            }
+            else
+            {
+            mImpostorAtlas.free(avatar->mImpostorSlot);
+            // </FS>
             if (!avatar->mImpostor.isComplete())
             {
                 avatar->mImpostor.allocate(resX, resY, GL_RGBA, true);
@@ -11383,8 +12274,12 @@ void LLPipeline::generateImpostor(LLVOAvatar* avatar, bool preview_avatar, bool
             {
                 avatar->mImpostor.resize(resX, resY);
             }
+            // <FS> Impostor atlas
+            }
 
-            avatar->mImpostor.bindTarget();
+            //avatar->mImpostor.bindTarget();
+            impostor_target->bindTarget();
+            // </FS>
         }
     }
 
@@ -11403,7 +12298,10 @@ void LLPipeline::generateImpostor(LLVOAvatar* avatar, bool preview_avatar, bool
     }
     else
     {
-        avatar->mImpostor.clear();
+        // <FS> Impostor atlas
+        //avatar->mImpostor.clear();
+        impostor_target->clear();
+        // </FS>
         renderGeomDeferred(camera);
 
         renderGeomPostDeferred(camera);
@@ -11495,7 +12393,10 @@ void LLPipeline::generateImpostor(LLVOAvatar* avatar, bool preview_avatar, bool
 
     if (!preview_avatar && !for_profile)
     {
-        avatar->mImpostor.flush();
+        // <FS> Impostor atlas
+        //avatar->mImpostor.flush();
+        impostor_target->flush();
+        // </FS>
         avatar->setImpostorDim(tdim);
     }
 
@@ -11554,6 +12455,24 @@ LLCullResult::drawinfo_iterator LLPipeline::endRenderMap(U32 type)
     return sCull->endRenderMap(type);
 }
 
+// <FS> Mesh instancing
+LLCullResult::sg_iterator LLPipeline::beginInstanceGroups()
+{
+    if (!sCull)
+        return {};
+
+    return sCull->beginInstanceGroups();
+}
+
+LLCullResult::sg_iterator LLPipeline::endInstanceGroups()
+{
+    if (!sCull)
+        return {};
+
+    return sCull->endInstanceGroups();
+}
+// </FS>
+
 LLCullResult::sg_iterator LLPipeline::beginAlphaGroups()
 {
     // <FS:ND>  FIRE-31942, sCull can be invalid if triggering 360 snapshosts fast enough  (due to snapshots running in their own co routine)
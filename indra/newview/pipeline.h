@@ -40,6 +40,16 @@
 #include "llrendertarget.h"
 #include "llreflectionmapmanager.h"
 #include "llheroprobemanager.h"
+#include "fshizocclusion.h" // <FS/> Hi-Z occlusion
+#include "fsgpupasstimer.h" // <FS/> GPU pass timers
+#include "fsimpostoratlas.h" // <FS/> Impostor atlas
+#include "fsmeshinstancer.h" // <FS/> Mesh instancing
+#include "fsdynamicresolution.h" // <FS/> Dynamic resolution
+#include "fsgputerrain.h" // <FS/> GPU terrain
+#include "fstreeinstancer.h" // <FS/> Tree instancing
+#include "fsclusteredlights.h" // <FS/> Clustered lighting
+#include "fshudcache.h" // <FS/> HUD cache
+#include "fsskincache.h" // <FS/> Pre-skinned shadows
 
 #include <stack>
 
@@ -157,6 +167,10 @@ public:
     void generateExposure(LLRenderTarget* src, LLRenderTarget* dst, bool use_history = true);
     void tonemap(LLRenderTarget* src, LLRenderTarget* dst);
     void gammaCorrect(LLRenderTarget* src, LLRenderTarget* dst);
+    // <FS> Fused post processing
+    // tonemap, applyCAS and gammaCorrect in one pass, false when they can't be fused
+    bool tonemapSharpenGammaCorrect(LLRenderTarget* src, LLRenderTarget* dst);
+    // </FS>
     void generateGlow(LLRenderTarget* src);
     void applyCAS(LLRenderTarget* src, LLRenderTarget* dst);
     void applyFXAA(LLRenderTarget* src, LLRenderTarget* dst);
@@ -379,6 +393,10 @@ public:
     bool hasRenderBatches(const U32 type) const;
     LLCullResult::drawinfo_iterator beginRenderMap(U32 type);
     LLCullResult::drawinfo_iterator endRenderMap(U32 type);
+    // <FS> Mesh instancing
+    LLCullResult::sg_iterator beginInstanceGroups();
+    LLCullResult::sg_iterator endInstanceGroups();
+    // </FS>
     LLCullResult::sg_iterator beginAlphaGroups();
     LLCullResult::sg_iterator endAlphaGroups();
     LLCullResult::sg_iterator beginRiggedAlphaGroups();
@@ -472,6 +490,25 @@ public:
 
     LLReflectionMapManager mReflectionMapManager;
     LLHeroProbeManager mHeroProbeManager;
+    FSHiZOcclusion mHiZOcclusion; // <FS/> Hi-Z occlusion
+    FSGPUPassTimer mGPUPassTimer; // <FS/> GPU pass timers
+    FSImpostorAtlas mImpostorAtlas; // <FS/> Impostor atlas
+    FSMeshInstancer mMeshInstancer; // <FS/> Mesh instancing
+    FSGPUTerrain mGPUTerrain; // <FS/> GPU terrain
+    FSTreeInstancer mTreeInstancer; // <FS/> Tree instancing
+    FSClusteredLights mClusteredLights; // <FS/> Clustered lighting
+    FSHUDCache mHUDCache; // <FS/> HUD cache
+    FSSkinCache mSkinCache; // <FS/> Pre-skinned shadows
+    FSDynamicResolution mDynamicResolution; // <FS/> Dynamic resolution
+
+    // <FS> Shadow cache
+    // Threads:  Tmain
+    // Forget the cached far shadow cascades that static geometry within
+    // extents (min, max) of partition may have changed. Spatial bridges are
+    // ignored, their extents are in the bridge's own frame.
+    void dirtyShadowCache(LLSpatialPartition* partition, const LLVector4a* extents);
+    void releaseShadowCache();
+    // </FS>
 
 private:
     void unloadShaders();
@@ -650,6 +687,7 @@ public:
     bool                     mBackfaceCull;
     S32                      mMatrixOpCount;
     S32                      mTextureMatrixOps;
+    S32                      mMergedDrawCount; // <FS/> Multi-draw batching, draws folded into a multi-draw
     S32                      mNumVisibleNodes;
 
     S32                      mDebugTextureUploadCost;
@@ -672,6 +710,15 @@ public:
     static bool             sNoAlpha;
     static bool             sUseFarClip;
     static bool             sShadowRender;
+    // <FS> Shadow cache, which geometry a shadow pass culls
+    enum eShadowGeometry
+    {
+        SHADOW_GEOMETRY_ALL,
+        SHADOW_GEOMETRY_STATIC,     // everything that is not in a spatial bridge or an avatar
+        SHADOW_GEOMETRY_DYNAMIC     // only spatial bridges and avatars
+    };
+    static U32              sShadowGeometry;
+    // </FS>
     static bool             sDynamicLOD;
     static bool             sPickAvatar;
     static bool             sReflectionRender;
@@ -748,6 +795,14 @@ public:
     // tonemapped and gamma corrected render ready for post
     LLRenderTarget          mPostMap;
 
+    // <FS> Dynamic resolution
+    // the final render scaled up to the unscaled resolution
+    LLRenderTarget          mUpscaleMap;
+    // scale allocateScreenBufferInternal() applies to the world targets,
+    // only set while resizeScreenTexture() allocates them
+    F32                     mDynamicScreenScale = 1.f;
+    // </FS>
+
     // FXAA helper target
     LLRenderTarget          mFXAAMap;
     LLRenderTarget          mSMAABlendBuffer;
@@ -787,6 +842,29 @@ public:
     glm::mat4               mSunShadowMatrix[6];
     glm::mat4               mShadowModelview[6];
     glm::mat4               mShadowProjection[6];
+
+    // <FS> Shadow cache
+    // Depth of the static geometry of a far sun shadow cascade with the
+    // projection it was rendered with. It is re-rendered when the sun moves,
+    // when the projection no longer covers what the split can see or when
+    // static geometry in its frustum changes. Every frame starts from a copy
+    // of it and adds the moving objects and avatars.
+    struct ShadowCascadeCache
+    {
+        LLRenderTarget  mStatic;
+        glm::mat4       mView;
+        glm::mat4       mProj;
+        LLCamera        mCamera;
+        LLVector3       mLightDir;
+        LLVector3       mEye;
+        LLVector3       mCenter;
+        F32             mError = 0.f;
+        F32             mFOV = 0.f;
+        bool            mValid = false;
+    };
+    static constexpr U32    SHADOW_CACHE_FIRST_SPLIT = 2;
+    ShadowCascadeCache      mShadowCache[4 - SHADOW_CACHE_FIRST_SPLIT];
+    // </FS>
     glm::mat4               mReflectionModelView;
 
     LLPointer<LLDrawable>   mShadowSpotLight[2];
@@ -885,6 +963,10 @@ protected:
     // Different queues of drawables being processed.
     //
     LLDrawable::drawable_list_t     mBuildQ1; // priority
+    // <FS> Rigged rebuild budget
+    // rigged faces of avatars waiting in mBuildQ1 this frame, by pixel area of their avatar
+    std::vector<std::pair<F32, LLDrawable::drawable_list_t::iterator> > mRiggedBuildQ;
+    // </FS>
     LLSpatialGroup::sg_vector_t     mGroupQ1; //priority
 
     LLSpatialGroup::sg_vector_t     mGroupSaveQ1; // a place to save mGroupQ1 until it is safe to unref
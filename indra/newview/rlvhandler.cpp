@@ -153,6 +153,10 @@ RlvHandler::RlvHandler() : m_fCanCancelTp(true), m_posSitSource(), m_pGCTimer(NU
 
     // Array auto-initialization to 0 is still not supported in VS2013
     memset(m_Behaviours, 0, sizeof(S16) * RLV_BHVR_COUNT);
+    // <FS> Behaviour count tables
+    memset(m_HeldCommands, 0, sizeof(S16) * RLV_BHVR_COUNT);
+    memset(m_HeldExceptions, 0, sizeof(S16) * RLV_BHVR_COUNT);
+    // </FS>
 }
 
 RlvHandler::~RlvHandler()
@@ -184,6 +188,10 @@ void RlvHandler::cleanup()
     RLV_ASSERT(m_Objects.empty());
     RLV_ASSERT(m_Exceptions.empty());
     RLV_ASSERT(std::all_of(m_Behaviours, m_Behaviours + RLV_BHVR_COUNT, [](S16 cnt) { return !cnt; }));
+    // <FS> Behaviour count tables
+    RLV_ASSERT(std::all_of(m_HeldCommands, m_HeldCommands + RLV_BHVR_COUNT, [](S16 cnt) { return !cnt; }));
+    RLV_ASSERT(std::all_of(m_HeldExceptions, m_HeldExceptions + RLV_BHVR_COUNT, [](S16 cnt) { return !cnt; }));
+    // </FS>
     RLV_ASSERT(m_CurCommandStack.empty());
     RLV_ASSERT(m_CurObjectStack.empty());
 
@@ -216,6 +224,9 @@ void RlvHandler::cleanup()
 
 bool RlvHandler::findBehaviour(ERlvBehaviour eBhvr, std::list<const RlvObject*>& lObjects) const
 {
+    // <FS/> Behaviour count tables
+    if (!isCommandHeld(eBhvr))
+        return false;
     lObjects.clear();
     for (const auto& objEntry : m_Objects)
         if (objEntry.second.hasBehaviour(eBhvr, false))
@@ -233,6 +244,9 @@ bool RlvHandler::hasBehaviour(const LLUUID& idRlvObj, ERlvBehaviour eBhvr, const
 
 bool RlvHandler::hasBehaviourExcept(ERlvBehaviour eBhvr, const std::string& strOption, const LLUUID& idObj) const
 {
+    // <FS/> Behaviour count tables
+    if (!isCommandHeld(eBhvr))
+        return false;
     for (rlv_object_map_t::const_iterator itObj = m_Objects.begin(); itObj != m_Objects.end(); ++itObj)
         if ( (idObj != itObj->second.getObjectID()) && (itObj->second.hasBehaviour(eBhvr, strOption, false)) )
             return true;
@@ -242,6 +256,9 @@ bool RlvHandler::hasBehaviourExcept(ERlvBehaviour eBhvr, const std::string& strO
 // Checked: 2011-04-11 (RLVa-1.3.0h) | Added: RLVa-1.3.0h
 bool RlvHandler::hasBehaviourRoot(const LLUUID& idObjRoot, ERlvBehaviour eBhvr, const std::string& strOption) const
 {
+    // <FS/> Behaviour count tables
+    if (!isCommandHeld(eBhvr))
+        return false;
     for (rlv_object_map_t::const_iterator itObj = m_Objects.begin(); itObj != m_Objects.end(); ++itObj)
         if ( (idObjRoot == itObj->second.getRootID()) && (itObj->second.hasBehaviour(eBhvr, strOption, false)) )
             return true;
@@ -250,6 +267,9 @@ bool RlvHandler::hasBehaviourRoot(const LLUUID& idObjRoot, ERlvBehaviour eBhvr,
 
 bool RlvHandler::ownsBehaviour(const LLUUID& idObj, ERlvBehaviour eBhvr) const
 {
+    // <FS/> Behaviour count tables
+    if (!isCommandHeld(eBhvr))
+        return false;
     bool fHasBhvr = false;
     for (const auto& objEntry : m_Objects)
     {
@@ -270,10 +290,18 @@ bool RlvHandler::ownsBehaviour(const LLUUID& idObj, ERlvBehaviour eBhvr) const
 void RlvHandler::addException(const LLUUID& idObj, ERlvBehaviour eBhvr, const RlvExceptionOption& varOption)
 {
     m_Exceptions.insert(std::make_pair(eBhvr, RlvException(idObj, eBhvr, varOption)));
+    // <FS/> Behaviour count tables
+    m_HeldExceptions[eBhvr]++;
 }
 
 bool RlvHandler::isException(ERlvBehaviour eBhvr, const RlvExceptionOption& varOption, ERlvExceptionCheck eCheckType) const
 {
+    // <FS> Behaviour count tables
+    // Nothing can match without any exceptions so skip collecting the restricted objects for a strict check
+    if (!hasException(eBhvr))
+        return false;
+    // </FS>
+
     // We need to "strict check" exceptions only if: the restriction is actually in place *and* (isPermissive(eBhvr) == false)
     if (ERlvExceptionCheck::Default == eCheckType)
         eCheckType = ( (hasBehaviour(eBhvr)) && (!isPermissive(eBhvr)) ) ? ERlvExceptionCheck::Strict : ERlvExceptionCheck::Permissive;
@@ -322,6 +350,8 @@ void RlvHandler::removeException(const LLUUID& idObj, ERlvBehaviour eBhvr, const
         if ( (itException->second.idObject == idObj) && (itException->second.varOption == varOption) )
         {
             m_Exceptions.erase(itException);
+            // <FS/> Behaviour count tables
+            m_HeldExceptions[eBhvr]--;
             break;
         }
     }
@@ -515,6 +545,9 @@ ERlvCmdRet RlvHandler::processCommand(std::reference_wrapper<const RlvCommand> r
                     itObj = m_Objects.insert(std::pair<LLUUID, RlvObject>(idCurObj, RlvObject(idCurObj))).first;
                     rlvCmd = itObj->second.addCommand(rlvCmd, fAdded);
                 }
+                // <FS/> Behaviour count tables
+                if (fAdded)
+                    onCommandAdded(eBhvr);
 
                 RLV_DEBUGS << "\t- " << ( (fAdded) ? "adding behaviour" : "skipping duplicate" ) << RLV_ENDL;
 
@@ -525,7 +558,11 @@ ERlvCmdRet RlvHandler::processCommand(std::reference_wrapper<const RlvCommand> r
                     if (!RLV_RET_SUCCEEDED(eRet))
                     {
                         RlvCommand rlvCmdRem(rlvCmd, RLV_TYPE_REMOVE);
-                        itObj->second.removeCommand(rlvCmdRem);
+                        // <FS> Behaviour count tables
+                        //itObj->second.removeCommand(rlvCmdRem);
+                        if (itObj->second.removeCommand(rlvCmdRem))
+                            onCommandRemoved(eBhvr);
+                        // </FS>
                         if (itObj->second.m_Commands.empty())
                         {
                             RLV_DEBUGS << "\t- command list empty => removing " << idCurObj << RLV_ENDL;
@@ -545,6 +582,9 @@ ERlvCmdRet RlvHandler::processCommand(std::reference_wrapper<const RlvCommand> r
                 rlv_object_map_t::iterator itObj = m_Objects.find(idCurObj); bool fRemoved = false;
                 if (itObj != m_Objects.end())
                     fRemoved = itObj->second.removeCommand(rlvCmd);
+                // <FS/> Behaviour count tables
+                if (fRemoved)
+                    onCommandRemoved(rlvCmd.get().getBehaviourType());
 
                 RLV_DEBUGS << "\t- " << ( (fRemoved) ? "removing behaviour"
                                                      : "skipping remove (unset behaviour or unknown object)") << RLV_ENDL;
@@ -1301,7 +1341,10 @@ bool RlvHandler::filterChat(std::string& strUTF8Text, bool fFilterEmote) const
 // Checked: 2010-11-29 (RLVa-1.3.0c) | Added: RLVa-1.3.0c
 bool RlvHandler::hasException(ERlvBehaviour eBhvr) const
 {
-    return (m_Exceptions.find(eBhvr) != m_Exceptions.end());
+    // <FS> Behaviour count tables
+    //return (m_Exceptions.find(eBhvr) != m_Exceptions.end());
+    return (eBhvr < RLV_BHVR_COUNT) && (0 != m_HeldExceptions[eBhvr]);
+    // </FS>
 }
 
 // Checked: 2010-02-27 (RLVa-1.2.0b) | Modified: RLVa-1.2.0a
@@ -247,6 +247,15 @@ protected:
     rlv_blocked_object_list_t m_BlockedObjects;     // List of (attached) objects that can't issue commands
     rlv_exception_map_t   m_Exceptions;             // Map of currently active restriction exceptions (ERlvBehaviour -> RlvException)
     S16                   m_Behaviours[RLV_BHVR_COUNT];
+    // <FS> Behaviour count tables
+    // Unlike m_Behaviours (which counts reference counted restrictions and is adjusted by individual handlers) these mirror the
+    // object command lists and the exception map exactly so the lookups that walk them can bail out early in the common case
+    S16                   m_HeldCommands[RLV_BHVR_COUNT];   // Number of commands held across all objects, any option
+    S16                   m_HeldExceptions[RLV_BHVR_COUNT]; // Number of entries in m_Exceptions
+    void                  onCommandAdded(ERlvBehaviour eBhvr)   { if (eBhvr < RLV_BHVR_COUNT) m_HeldCommands[eBhvr]++; }
+    void                  onCommandRemoved(ERlvBehaviour eBhvr) { if (eBhvr < RLV_BHVR_COUNT) m_HeldCommands[eBhvr]--; }
+    bool                  isCommandHeld(ERlvBehaviour eBhvr) const { return (eBhvr < RLV_BHVR_COUNT) && (0 != m_HeldCommands[eBhvr]); }
+    // </FS>
 
     rlv_command_list_t    m_Retained;
     RlvGCTimer*           m_pGCTimer;
@@ -32,3 +32,11 @@ void LLViewerTexture::setBoostLevel(int level)
 {
 }
 
+void LLViewerTexture::addTextureStats(F32 virtual_size, bool needs_gltexture) const
+{
+}
+
+void LLViewerTexture::resetTextureStats()
+{
+}
+
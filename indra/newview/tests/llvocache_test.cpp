@@ -57,7 +57,7 @@ LLViewerObjectList::~LLViewerObjectList() = default;
 LLDebugBeacon::~LLDebugBeacon() = default;
 LLViewerObjectList gObjectList{};
 LLViewerCamera::eCameraID LLViewerCamera::sCurCameraID{};
-void LLViewerObject::unpackUUID(LLDataPackerBinaryBuffer *dp, LLUUID &value, std::string name) {}
+void LLViewerObject::unpackUUID(LLDataPackerBinaryBuffer *dp, LLUUID &value, EObjectDataOffset offset) {}
 
 bool LLViewerRegion::addVisibleGroup(LLViewerOctreeGroup*) { return false; }
 U32 LLViewerRegion::getNumOfVisibleGroups() const { return 0; }
@@ -144,4 +144,36 @@ namespace tut
 
         LLVOCache::instance().readGenericExtrasFromCache(region_handle, region_id, extras);
     }
+
+    template<> template<>
+    void vocacheTestObject::test<3>()
+    {
+        LLSD entry_llsd;
+        std::istringstream in_llsd(override_llsd_text[0]);
+        ensure("llsd deserialize succeeds", LLSDSerialize::deserialize(entry_llsd, in_llsd, override_llsd_text[0].length()));
+        entry_llsd["local_id"] = 42;
+        entry_llsd["region_handle_x"] = 256000;
+        entry_llsd["region_handle_y"] = 256256;
+
+        LLGLTFOverrideCacheEntry entry{};
+        ensure("fromLLSD() succeeds", entry.fromLLSD(entry_llsd));
+
+        std::string data;
+        entry.toBinary(data);
+
+        LLGLTFOverrideCacheEntry other{};
+        ensure("fromBinary() succeeds", other.fromBinary(reinterpret_cast<const U8*>(data.data()), (U32)data.size(), entry.mRegionHandle));
+        ensure_equals("local_id match", other.mLocalId, 42);
+        ensure_equals("object_id match", other.mObjectId, entry.mObjectId);
+        ensure_equals("region handle match", other.mRegionHandle, entry.mRegionHandle);
+        ensure_equals("sides count", other.mSides.size(), entry.mSides.size());
+        ensure_equals("materials count", other.mGLTFMaterial.size(), entry.mGLTFMaterial.size());
+        for (const auto& side : entry.mSides)
+        {
+            ensure_equals("side override match", other.mSides[side.first], side.second);
+        }
+
+        LLGLTFOverrideCacheEntry truncated{};
+        ensure("truncated entry is rejected", !truncated.fromBinary(reinterpret_cast<const U8*>(data.data()), (U32)data.size() - 1, entry.mRegionHandle));
+    }
 }
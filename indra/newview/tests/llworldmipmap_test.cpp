@@ -43,12 +43,14 @@
 // * A simulator for a class can be implemented here. Please comment and document thoroughly.
 
 void LLGLTexture::setBoostLevel(S32 ) { }
+bool LLGLTexture::hasGLTexture() const { return false; }
 LLViewerFetchedTexture* LLViewerTextureManager::getFetchedTextureFromUrl(const std::string&, FTType, bool, LLGLTexture::EBoostLevel, S8,
                                                                          LLGLint, LLGLenum, const LLUUID& ) { return NULL; }
 
 LLControlGroup::LLControlGroup(const std::string& name) : LLInstanceTracker<LLControlGroup, std::string>(name) { }
 LLControlGroup::~LLControlGroup() { }
 std::string LLControlGroup::getString(std::string_view) { return std::string("test_url"); }
+U32 LLControlGroup::getU32(std::string_view) { return 0; }
 LLControlGroup gSavedSettings("test_settings");
 
 // End Stubbing
@@ -162,4 +164,41 @@ namespace tut
             fail("reset() test failed");
         }
     }
+    // Test 7 : trim() and selectRecentTiles()
+    template<> template<>
+    void worldmipmap_object_t::test<7>()
+    {
+        // Tiles drawn out of order, one per level and region
+        LLWorldMipmap::tile_stamps_t tiles;
+        const U32 drawn[] = { 3, 9, 1, 7, 5, 8, 2, 6 };
+        for (S32 i = 0; i < 8; i++)
+        {
+            tiles.push_back({ drawn[i], i % LLWorldMipmap::MAP_LEVELS, (U64)i });
+        }
+
+        size_t kept = LLWorldMipmap::selectRecentTiles(tiles, 3);
+        ensure_equals("selectRecentTiles() keeps the budget", kept, (size_t)3);
+        ensure_equals("selectRecentTiles() test 1 failed", tiles[0].mDrawn, (U32)9);
+        ensure_equals("selectRecentTiles() test 2 failed", tiles[1].mDrawn, (U32)8);
+        ensure_equals("selectRecentTiles() test 3 failed", tiles[2].mDrawn, (U32)7);
+        ensure_equals("selectRecentTiles() keeps the tile handle", tiles[0].mHandle, (U64)1);
+        for (size_t i = kept; i < tiles.size(); i++)
+        {
+            ensure("selectRecentTiles() drops older tiles", tiles[i].mDrawn < 7);
+        }
+
+        kept = LLWorldMipmap::selectRecentTiles(tiles, 20);
+        ensure_equals("selectRecentTiles() budget above tile count", kept, tiles.size());
+        kept = LLWorldMipmap::selectRecentTiles(tiles, 0);
+        ensure_equals("selectRecentTiles() empty budget", kept, (size_t)0);
+
+        try
+        {
+            mMap->trim();
+        }
+        catch (...)
+        {
+            fail("trim() test failed");
+        }
+    }
 }
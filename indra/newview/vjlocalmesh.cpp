@@ -301,16 +301,12 @@ void LLLocalMeshObject::normalizeFaceValues(LLLocalMeshFileLOD lod_iter)
     }
 }
 
-void LLLocalMeshObject::fillVolume(LLLocalMeshFileLOD lod)
+void LLLocalMeshObject::buildVolumeFaces(LLLocalMeshFileLOD lod)
 {
-    // check if we have data for [lod]
-    if (mFaces[lod].empty())
-    {
-        return;
-    }
-
     // generate face data
-    std::vector<LLVolumeFace> new_faces;
+    std::vector<LLVolumeFace>& new_faces = mVolumeFaces[lod];
+    new_faces.clear();
+    new_faces.reserve(mFaces[lod].size());
 
     for (auto& current_submesh : mFaces[lod])
     {
@@ -374,12 +370,27 @@ void LLLocalMeshObject::fillVolume(LLLocalMeshFileLOD lod)
 
         new_faces.push_back(new_face);
     }
+}
+
+void LLLocalMeshObject::fillVolume(LLLocalMeshFileLOD lod)
+{
+    // check if we have data for [lod]
+    if (mFaces[lod].empty())
+    {
+        return;
+    }
+
+    // normally done by the loader thread
+    if (mVolumeFaces[lod].empty())
+    {
+        buildVolumeFaces(lod);
+    }
 
     // push data into relevant lod
     LLVolume* current_volume = LLPrimitive::getVolumeManager()->refVolume(mVolumeParams, lod);
     if (current_volume)
     {
-        current_volume->copyFacesFrom(new_faces);
+        current_volume->copyFacesFrom(mVolumeFaces[lod]);
         current_volume->setMeshAssetLoaded(true);
         LLPrimitive::getVolumeManager()->unrefVolume(current_volume);
     }
@@ -570,11 +581,39 @@ void LLLocalMeshFile::reloadLocalMeshObjects(bool initial_load)
     // if we are here we can assume at least mFilenames[3] is present
     // here we'll define a lambda to call through std::async, accessible through mAsyncFuture.
     // the lamnda returns bool if change happened, individual lod logs, and their status.
-    auto lambda_loadfiles = [&]() mutable -> LLLocalMeshLoaderReply
+    // everything is loaded into mLoadingObjectList, the objects in use stay untouched
+    // until reloadLocalMeshObjectsCallback swaps the new ones in on the main thread.
+    mLoadingObjectList.clear();
+    auto previous_success = mLoadedSuccessfully;
+    auto lambda_loadfiles = [this, previous_success]() mutable -> LLLocalMeshLoaderReply
     {
         bool change_happened = false;
         std::vector<std::string> log;
-        std::array<bool, 4> lod_success = {false, false, false, false};
+        std::array<bool, 4> lod_success = previous_success;
+
+        // has any of the files been modified since we last checked?
+        // lower lods are loaded into the objects made from LOD3, so any change reloads them all.
+        bool any_modified = false;
+        for (signed int lod_idx = LOCAL_LOD_HIGH; lod_idx >= LOCAL_LOD_LOWEST; --lod_idx)
+        {
+            if (!mFilenames[lod_idx].empty() && updateLastModified(static_cast<LLLocalMeshFileLOD>(lod_idx)))
+            {
+                any_modified = true;
+            }
+        }
+
+        if (!any_modified)
+        {
+            log.push_back("[ LLLocalMeshFile ] Files were not modified, skipping.");
+            LLLocalMeshLoaderReply result;
+            result.mReloaded = false;
+            result.mChanged = false;
+            result.mLog = log;
+            result.mStatus = lod_success;
+            return result;
+        }
+
+        lod_success = {false, false, false, false};
 
         // iterate over every lod
         // we're counting back because LOD3 is most likely to have showstopper problems,
@@ -591,23 +630,8 @@ void LLLocalMeshFile::reloadLocalMeshObjects(bool initial_load)
                 continue;
             }
 
-            // has the file been modified since we last checked?
-            bool file_modified = updateLastModified(current_lod);
-            if (!file_modified)
-            {
-                log.push_back("[ LLLocalMeshFile ] File for LOD " + std::to_string(lod_idx) + " was not modified, skipping.");
-                lod_success[lod_idx] = mLoadedSuccessfully[lod_idx];
-                continue;
-            }
-
             // up until here, skipping loading a lod is fine, after here - it's a sign of an error.
 
-            // clear the old objects, if any.
-            if (lod_idx == LLLocalMeshFileLOD::LOCAL_LOD_HIGH)
-            {
-                mLoadedObjectList.clear();
-            }
-
             log.push_back("[ LLLocalMeshFile ] Attempting to load file for LOD " + std::to_string(lod_idx));
             switch (mExtension)
             {
@@ -647,7 +671,7 @@ void LLLocalMeshFile::reloadLocalMeshObjects(bool initial_load)
 
 
         // just in case, recheck if we actually ended up loading anything
-        auto& object_list = getObjectVector();
+        auto& object_list = getLoadingObjectVector();
         if (object_list.empty())
         {
             log.push_back("[ LLLocalMeshFile ] ERROR, no objects loaded, stopping.");
@@ -662,7 +686,20 @@ void LLLocalMeshFile::reloadLocalMeshObjects(bool initial_load)
             change_happened = false;
         }
 
+        // build the volume faces here rather than when the objects get applied
+        for (auto& local_object : object_list)
+        {
+            for (size_t lod_iter = 0; lod_iter < 4; ++lod_iter)
+            {
+                if (lod_success[lod_iter])
+                {
+                    local_object->buildVolumeFaces(static_cast<LLLocalMeshFileLOD>(lod_iter));
+                }
+            }
+        }
+
         LLLocalMeshLoaderReply result;
+        result.mReloaded = true;
         result.mChanged = change_happened;
         result.mLog = log;
         result.mStatus = lod_success;
@@ -706,6 +743,13 @@ void LLLocalMeshFile::reloadLocalMeshObjectsCallback()
     mLoadingLog.insert(mLoadingLog.end(), reply.mLog.begin(), reply.mLog.end());
     mLoadedSuccessfully = reply.mStatus;
 
+    // the loader is done with the new objects, they replace the old ones now
+    if (reply.mReloaded)
+    {
+        mLoadedObjectList.swap(mLoadingObjectList);
+    }
+    mLoadingObjectList.clear();
+
     // if LOD3 is ok, we're technically fine.
     if (mLoadedSuccessfully[3])
     {
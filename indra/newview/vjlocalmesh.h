@@ -102,6 +102,7 @@ class LLLocalMeshObject
         void normalizeFaceValues(LLLocalMeshFileLOD lod_iter);
 
         // applying local object to viewer object
+        void buildVolumeFaces(LLLocalMeshFileLOD lod);
         void fillVolume(LLLocalMeshFileLOD lod);
         void attachSkinInfo();
 
@@ -121,6 +122,9 @@ class LLLocalMeshObject
     private:
         // internal data keeping
         std::array<std::vector<std::unique_ptr<LLLocalMeshFace>>, 4> mFaces;
+        // volume faces per lod, built by the loader thread so applying
+        // the object only has to copy them into the volume
+        std::array<std::vector<LLVolumeFace>, 4> mVolumeFaces;
         std::pair<LLVector4, LLVector4> mObjectBoundingBox;
         std::string     mObjectName;
         LLVector4       mObjectTranslation;
@@ -169,6 +173,7 @@ class LLLocalMeshFile
 
         struct LLLocalMeshLoaderReply
         {
+            bool mReloaded;
             bool mChanged;
             std::vector<std::string> mLog;
             std::array<bool, 4> mStatus;
@@ -188,6 +193,8 @@ class LLLocalMeshFile
         void reloadLocalMeshObjectsCallback();
         bool updateLastModified(LLLocalMeshFileLOD lod);
         std::vector<std::unique_ptr<LLLocalMeshObject>>& getObjectVector() { return mLoadedObjectList; };
+        // objects being loaded, only touched by the loader until they replace the loaded ones
+        std::vector<std::unique_ptr<LLLocalMeshObject>>& getLoadingObjectVector() { return mLoadingObjectList; };
 
         // info getters
         bool notifyNeedsUIUpdate();
@@ -216,6 +223,7 @@ class LLLocalMeshFile
 
         std::future<LLLocalMeshLoaderReply> mAsyncFuture;
         std::vector<std::unique_ptr<LLLocalMeshObject>> mLoadedObjectList;
+        std::vector<std::unique_ptr<LLLocalMeshObject>> mLoadingObjectList;
         std::vector<LLUUID> mSavedObjectSculptIDs;
 };
 
@@ -197,7 +197,7 @@ LLLocalMeshImportDAE::loadFile_return LLLocalMeshImportDAE::loadFile(LLLocalMesh
                 // normalizeFaceValues is necessary for skin calculations down below,
                 // but we also have to do it once per each lod so we'll call it foreach lod.
 
-                auto& object_vector = data->getObjectVector();
+                auto& object_vector = data->getLoadingObjectVector();
                 object_vector.push_back(std::move(current_object));
                 mesh_usage_tracker.push_back(mesh_current);
             }
@@ -211,7 +211,7 @@ LLLocalMeshImportDAE::loadFile_return LLLocalMeshImportDAE::loadFile(LLLocalMesh
         // parsing a lower lod file, into objects made during LOD3 parsing
         else
         {
-            auto& object_vector = data->getObjectVector();
+            auto& object_vector = data->getLoadingObjectVector();
             if (object_vector.size() <= mesh_index)
             {
                 pushLog("DAE Importer", "LOD" + std::to_string(mLod) + " is requesting an object that LOD3 did not have or failed to load, skipping.");
@@ -241,7 +241,7 @@ LLLocalMeshImportDAE::loadFile_return LLLocalMeshImportDAE::loadFile(LLLocalMesh
     }
 
     // check if we managed to load any objects at all, if not - no point continuing.
-    if (data->getObjectVector().empty())
+    if (data->getLoadingObjectVector().empty())
     {
         pushLog("DAE Importer", "No objects have been successfully loaded, stopping.");
         return loadFile_return(false, mLoadingLog);
@@ -296,7 +296,7 @@ LLLocalMeshImportDAE::loadFile_return LLLocalMeshImportDAE::loadFile(LLLocalMesh
             continue;
         }
 
-        auto& object_vector = data->getObjectVector();
+        auto& object_vector = data->getLoadingObjectVector();
         if (current_object_iter >= object_vector.size())
         {
             pushLog("DAE Importer", "Requested object out of bounds, skipping.");
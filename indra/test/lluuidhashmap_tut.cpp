@@ -0,0 +1,282 @@
+/**
+ * @file lluuidhashmap_tut.cpp
+ * @brief Lookup traffic of LLUUID keyed maps, ordered against flat hash
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include <tut/tut.hpp>
+
+#include "linden_common.h"
+#include "llpointer.h"
+#include "llrefcount.h"
+#include "lluuid.h"
+#include "lluuidflatmap.h"
+#include "lltut.h"
+
+#include <boost/unordered/unordered_flat_map.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+namespace
+{
+    // Stands in for an inventory object, the maps hold LLPointers to them
+    class TestObject : public LLRefCount
+    {
+    public:
+        TestObject(const LLUUID& id, const LLUUID& parent) : mID(id), mParent(parent) {}
+        LLUUID mID;
+        LLUUID mParent;
+    };
+
+    typedef std::map<LLUUID, LLPointer<TestObject> > ordered_map_t;
+    typedef boost::unordered_flat_map<LLUUID, LLPointer<TestObject> > flat_map_t;
+
+    // A mid sized inventory
+    constexpr U32 ITEM_COUNT = 60000;
+    constexpr U32 CATEGORY_COUNT = 4000;
+    constexpr U32 LOOKUP_COUNT = 400000;
+
+    LLUUID make_id(U32 n)
+    {
+        // Spread the bits like random ids do, without depending on generate()
+        U32 words[4] = { n * 2654435761u, n ^ 0x5bd1e995u, (n << 13) ^ 0x9e3779b9u, ~n };
+        LLUUID id;
+        memcpy(id.mData, words, sizeof(words));
+        return id;
+    }
+
+    // Lookup traffic of a COF update or an RLVa pass: mostly hits on items,
+    // object lookups that miss the item map before trying categories, and
+    // parent walks through the category map.
+    template <typename MAP>
+    U32 run_traffic(const MAP& items, const MAP& cats, const std::vector<LLUUID>& item_ids,
+                    const std::vector<LLUUID>& cat_ids, double& seconds)
+    {
+        U32 found = 0;
+        U32 state = 12345;
+        auto start = std::chrono::steady_clock::now();
+        for (U32 i = 0; i < LOOKUP_COUNT; ++i)
+        {
+            state = state * 1664525u + 1013904223u;
+            switch (state >> 30)
+            {
+            case 0:
+            case 1:
+                {   // item by id, then its parent folder
+                    auto it = items.find(item_ids[(state >> 8) % item_ids.size()]);
+                    if (it != items.end())
+                    {
+                        found += (U32)(cats.find(it->second->mParent) != cats.end());
+                    }
+                }
+                break;
+            case 2:
+                {   // getObject() on a category
+                    const LLUUID& id = cat_ids[(state >> 8) % cat_ids.size()];
+                    if (items.find(id) == items.end())
+                    {
+                        found += (U32)(cats.find(id) != cats.end());
+                    }
+                }
+                break;
+            default:
+                // miss, like an asset id or an object that was not fetched
+                found += (U32)(items.find(make_id(ITEM_COUNT + CATEGORY_COUNT + (state >> 8))) != items.end());
+                break;
+            }
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return found;
+    }
+
+    // Object list traffic: findObject() for every object update, mostly hits,
+    // with objects coming and going
+    template <typename MAP>
+    U32 run_object_traffic(MAP& objects, const std::vector<LLUUID>& ids, double& seconds)
+    {
+        U32 found = 0;
+        U32 state = 54321;
+        auto start = std::chrono::steady_clock::now();
+        for (U32 i = 0; i < LOOKUP_COUNT; ++i)
+        {
+            state = state * 1664525u + 1013904223u;
+            const LLUUID& id = ids[(state >> 8) % ids.size()];
+            if ((state >> 28) == 0)
+            {
+                // killed and then seen again
+                objects.erase(id);
+                objects[id] = new TestObject(id, LLUUID::null);
+            }
+            auto it = objects.find(id);
+            found += (U32)(it != objects.end());
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return found;
+    }
+}
+
+namespace tut
+{
+    struct uuidhashmap_data
+    {
+        uuidhashmap_data()
+        {
+            for (U32 i = 0; i < CATEGORY_COUNT; ++i)
+            {
+                cat_ids.push_back(make_id(i));
+            }
+            for (U32 i = 0; i < ITEM_COUNT; ++i)
+            {
+                item_ids.push_back(make_id(CATEGORY_COUNT + i));
+            }
+        }
+
+        template <typename MAP>
+        void fill(MAP& items, MAP& cats)
+        {
+            for (U32 i = 0; i < CATEGORY_COUNT; ++i)
+            {
+                cats[cat_ids[i]] = new TestObject(cat_ids[i], cat_ids[i / 8]);
+            }
+            for (U32 i = 0; i < ITEM_COUNT; ++i)
+            {
+                items[item_ids[i]] = new TestObject(item_ids[i], cat_ids[i % CATEGORY_COUNT]);
+            }
+        }
+
+        std::vector<LLUUID> cat_ids;
+        std::vector<LLUUID> item_ids;
+    };
+    typedef test_group<uuidhashmap_data> uuidhashmap_test;
+    typedef uuidhashmap_test::object uuidhashmap_object_t;
+    tut::uuidhashmap_test tutil("uuidhashmap");
+
+    template<> template<>
+    void uuidhashmap_object_t::test<1>()
+    {
+        set_test_name("flat map finds what the ordered map finds");
+
+        ordered_map_t ordered_items, ordered_cats;
+        flat_map_t flat_items, flat_cats;
+        fill(ordered_items, ordered_cats);
+        fill(flat_items, flat_cats);
+        ensure_equals("item count", flat_items.size(), ordered_items.size());
+        ensure_equals("category count", flat_cats.size(), ordered_cats.size());
+
+        for (const auto& entry : ordered_items)
+        {
+            auto it = flat_items.find(entry.first);
+            ensure("item present", it != flat_items.end());
+            ensure("same item", it->second->mID == entry.second->mID);
+        }
+
+        // Erasing by key, as deleteObject() does
+        for (U32 i = 0; i < ITEM_COUNT; i += 3)
+        {
+            ordered_items.erase(item_ids[i]);
+            flat_items.erase(item_ids[i]);
+        }
+        ensure_equals("count after erase", flat_items.size(), ordered_items.size());
+        ensure("erased item gone", !flat_items.contains(item_ids[0]));
+        ensure("kept item present", flat_items.contains(item_ids[1]));
+    }
+
+    template<> template<>
+    void uuidhashmap_object_t::test<2>()
+    {
+        set_test_name("lookup traffic");
+
+        ordered_map_t ordered_items, ordered_cats;
+        flat_map_t flat_items, flat_cats;
+        fill(ordered_items, ordered_cats);
+        fill(flat_items, flat_cats);
+
+        double ordered_seconds = 0.0;
+        double flat_seconds = 0.0;
+        const U32 ordered_found = run_traffic(ordered_items, ordered_cats, item_ids, cat_ids, ordered_seconds);
+        const U32 flat_found = run_traffic(flat_items, flat_cats, item_ids, cat_ids, flat_seconds);
+        ensure_equals("same lookups succeed", flat_found, ordered_found);
+
+        // Timing depends on the machine, it is reported and not checked
+        LL_INFOS() << LOOKUP_COUNT << " lookups over " << ITEM_COUNT << " items: std::map "
+                   << ordered_seconds * 1000.0 << " ms, unordered_flat_map " << flat_seconds * 1000.0 << " ms" << LL_ENDL;
+    }
+
+    template<> template<>
+    void uuidhashmap_object_t::test<3>()
+    {
+        set_test_name("LLUUIDFlatMap and LLUUIDFlatSet");
+
+        LLUUIDFlatMap<LLPointer<TestObject> > flat;
+        LLUUIDFlatSet set;
+        for (U32 i = 0; i < ITEM_COUNT; ++i)
+        {
+            flat[item_ids[i]] = new TestObject(item_ids[i], cat_ids[i % CATEGORY_COUNT]);
+            set.insert(item_ids[i]);
+        }
+        ensure_equals("map size", flat.size(), (size_t)ITEM_COUNT);
+        ensure_equals("set size", set.size(), (size_t)ITEM_COUNT);
+        for (U32 i = 0; i < ITEM_COUNT; i += 7)
+        {
+            ensure("map finds", flat.find(item_ids[i])->second->mID == item_ids[i]);
+            ensure("set finds", set.contains(item_ids[i]));
+        }
+        ensure("map misses", !flat.contains(cat_ids[0]));
+        ensure("set misses", !set.contains(cat_ids[0]));
+        ensure("null key", !flat.contains(LLUUID::null));
+    }
+
+    template<> template<>
+    void uuidhashmap_object_t::test<4>()
+    {
+        set_test_name("object list traffic");
+
+        std::map<LLUUID, LLPointer<TestObject> > ordered;
+        boost::unordered_map<LLUUID, LLPointer<TestObject> > chained;
+        LLUUIDFlatMap<LLPointer<TestObject> > flat;
+        for (U32 i = 0; i < ITEM_COUNT; ++i)
+        {
+            LLPointer<TestObject> object = new TestObject(item_ids[i], LLUUID::null);
+            ordered[item_ids[i]] = object;
+            chained[item_ids[i]] = object;
+            flat[item_ids[i]] = object;
+        }
+
+        double ordered_seconds = 0.0;
+        double chained_seconds = 0.0;
+        double flat_seconds = 0.0;
+        const U32 ordered_found = run_object_traffic(ordered, item_ids, ordered_seconds);
+        const U32 chained_found = run_object_traffic(chained, item_ids, chained_seconds);
+        const U32 flat_found = run_object_traffic(flat, item_ids, flat_seconds);
+        ensure_equals("chained finds the same", chained_found, ordered_found);
+        ensure_equals("flat finds the same", flat_found, ordered_found);
+
+        // Timing depends on the machine, it is reported and not checked
+        LL_INFOS() << LOOKUP_COUNT << " object lookups over " << ITEM_COUNT << " objects: std::map "
+                   << ordered_seconds * 1000.0 << " ms, boost::unordered_map " << chained_seconds * 1000.0
+                   << " ms, LLUUIDFlatMap " << flat_seconds * 1000.0 << " ms" << LL_ENDL;
+    }
+}